@@ -143,6 +143,45 @@ namespace direct_bt {
             : AttException("AttValueException", m, file, line) {}
     };
 
+    /**
+     * Result of a GATT request via the non-throwing API variants,
+     * e.g. GATTHandler::readValueStatus() or GATTCharacteristic::writeValueStatus().
+     * <p>
+     * Transport failures, see isGATTTransportFailure(), are thrown as exceptions by the convenience API,
+     * while all other failures are returned as <code>false</code>.
+     * </p>
+     */
+    enum class GATTStatus : uint8_t {
+        SUCCESS                 = 0,
+        /** Not connected or in IO error state. */
+        INVALID_STATE           = 1,
+        /** PDU exceeds the used ATT_MTU. */
+        PDU_TOO_LARGE           = 2,
+        /** L2CAP write failed, the connection has been closed. */
+        IO_ERROR                = 3,
+        /** L2CAP write count mismatch, the connection has been closed. */
+        WRITE_COUNT_MISMATCH    = 4,
+        /** No reply received, including all retries. */
+        TIMEOUT                 = 5,
+        /** Server replied with an ATT_ERROR_RSP. */
+        ERROR_RSP               = 6,
+        /** Server replied with an unexpected PDU or echoed a mismatching prepared value. */
+        UNEXPECTED_REPLY        = 7,
+        /** Empty value or invalid size given. */
+        INVALID_VALUE           = 8,
+        /** Value fill aborted the write, see GATTCharacteristic::ValueFill. */
+        ABORTED                 = 9,
+        /** Unexpected internal failure. */
+        INTERNAL_ERROR          = 10
+    };
+    std::string getGATTStatusString(const GATTStatus s);
+
+    /** Returns true if the given GATTStatus denotes a transport failure, which the convenience API throws. */
+    constexpr bool isGATTTransportFailure(const GATTStatus s) {
+        return GATTStatus::INVALID_STATE == s || GATTStatus::PDU_TOO_LARGE == s || GATTStatus::IO_ERROR == s ||
+               GATTStatus::WRITE_COUNT_MISMATCH == s || GATTStatus::TIMEOUT == s || GATTStatus::INTERNAL_ERROR == s;
+    }
+
     /**
      * ATT PDU Overview
      * ================
@@ -335,16 +374,46 @@ namespace direct_bt {
                         ", size[total="+std::to_string(pdu.getSize())+", param "+std::to_string(getPDUParamSize())+"]";
             }
             virtual std::string valueString() const {
-                return "size "+std::to_string(getPDUValueSize())+", data "
-                        +bytesHexString(pdu.get_ptr(), getPDUValueOffset(), getPDUValueSize(), true /* lsbFirst */, true /* leading0X */);
+                std::string res("size "+std::to_string(getPDUValueSize())+", data ");
+                appendBytesHexString(res, pdu.get_ptr(), getPDUValueOffset(), getPDUValueSize(), true /* lsbFirst */, true /* leading0X */);
+                return res;
+            }
+
+            friend class AttPDUPool;
+
+            /**
+             * Re-initializes this instance with a copy of the given PDU for recycling, see AttPDUPool,
+             * reusing the persistent memory if its capacity permits.
+             * <p>
+             * Specializations shall perform their constructor's validation.
+             * </p>
+             */
+            virtual void reset(const uint8_t* source, const int size) {
+                const int sz = std::max(1, size);
+                if( pdu.getCapacity() < sz ) {
+                    pdu.resize(sz, sz);
+                } else {
+                    pdu.resize(sz);
+                }
+                memcpy(pdu.get_wptr(), source, sz);
+                setTimestampNS( getCurrentNanoseconds() );
+                pdu.check_range(0, getPDUMinSize());
             }
 
         public:
-            /** actual received PDU */
-            POctets pdu;
+            enum PDUConst : int {
+                /** Inline PDU storage capacity covering the maximum ATT_MTU of 512 (Vol 3, Part G 5.2.1), avoiding heap allocations. */
+                PDU_INLINE_CAPACITY = 512
+            };
+
+            /** actual received or sent PDU */
+            SOctets<PDU_INLINE_CAPACITY> pdu;
+
+            /** creation or kernel receive timestamp in nanoseconds, see getCurrentNanoseconds() */
+            int64_t ts_creation_ns;
 
-            /** creation timestamp in milliseconds */
-            const int64_t ts_creation;
+            /** creation or kernel receive timestamp in milliseconds, derived from ts_creation_ns */
+            int64_t ts_creation;
 
             /**
              * Return a newly created specialized instance pointer to base class.
@@ -356,19 +425,22 @@ namespace direct_bt {
 
             /** Persistent memory, w/ ownership ..*/
             AttPDUMsg(const uint8_t* source, const int size)
-                : pdu(source, std::max(1, size)), ts_creation(getCurrentMilliseconds())
+                : pdu(source, std::max(1, size)), ts_creation_ns(getCurrentNanoseconds()), ts_creation(ts_creation_ns / 1000000)
             {
                 pdu.check_range(0, getPDUMinSize());
             }
 
             /** Persistent memory, w/ ownership ..*/
             AttPDUMsg(const Opcode opc, const int size)
-                : pdu(std::max(1, size)), ts_creation(getCurrentMilliseconds())
+                : pdu(std::max(1, size)), ts_creation_ns(getCurrentNanoseconds()), ts_creation(ts_creation_ns / 1000000)
             {
                 pdu.put_uint8(0, opc);
                 pdu.check_range(0, getPDUMinSize());
             }
 
+            /** Sets the monotonic timestamp in nanoseconds, e.g. the kernel receive timestamp, also updating ts_creation. */
+            void setTimestampNS(const int64_t ns) { ts_creation_ns = ns; ts_creation = ns / 1000000; }
+
             AttPDUMsg(const AttPDUMsg &o) noexcept = default;
             AttPDUMsg(AttPDUMsg &&o) noexcept = default;
             AttPDUMsg& operator=(const AttPDUMsg &o) noexcept = default;
@@ -488,6 +560,37 @@ namespace direct_bt {
                 return mtu - getAuthSigSize() - getPDUValueOffset();
             }
 
+            /**
+             * Returns true if this PDU is the response to a request of the given opcode,
+             * i.e. the request's response opcode or an ATT_ERROR_RSP caused by the request opcode.
+             * <p>
+             * ATT Protocol PDUs Vol 3, Part F 3.4.8 Attribute Opcode Summary
+             * </p>
+             */
+            bool isReplyTo(const Opcode reqOpcode) const {
+                const Opcode opc = getOpcode();
+                if( ATT_ERROR_RSP == opc ) {
+                    return pdu.getSize() > 1 && reqOpcode == pdu.get_uint8(1);
+                }
+                switch( reqOpcode ) {
+                    case ATT_EXCHANGE_MTU_REQ:
+                    case ATT_FIND_INFORMATION_REQ:
+                    case ATT_FIND_BY_TYPE_VALUE_REQ:
+                    case ATT_READ_BY_TYPE_REQ:
+                    case ATT_READ_REQ:
+                    case ATT_READ_BLOB_REQ:
+                    case ATT_READ_MULTIPLE_REQ:
+                    case ATT_READ_BY_GROUP_TYPE_REQ:
+                    case ATT_WRITE_REQ:
+                    case ATT_PREPARE_WRITE_REQ:
+                    case ATT_EXECUTE_WRITE_REQ:
+                    case ATT_READ_MULTIPLE_VARIABLE_REQ:
+                        return reqOpcode + 1 == opc;
+                    default:
+                        return false;
+                }
+            }
+
             virtual std::string getName() const {
                 return "AttPDUMsg";
             }
@@ -505,6 +608,12 @@ namespace direct_bt {
      */
     class AttPDUUndefined: public AttPDUMsg
     {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_PDU_UNDEFINED);
+            }
+
         public:
             AttPDUUndefined(const uint8_t* source, const int length) : AttPDUMsg(source, length) {
                 checkOpcode(ATT_PDU_UNDEFINED);
@@ -526,6 +635,12 @@ namespace direct_bt {
      */
     class AttErrorRsp: public AttPDUMsg
     {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_ERROR_RSP);
+            }
+
         public:
             enum ErrorCode : uint8_t {
                 INVALID_HANDLE              = 0x01,
@@ -600,6 +715,12 @@ namespace direct_bt {
         private:
             uint8_t _data[1+2];
 
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_EXCHANGE_MTU_RSP);
+            }
+
         public:
             AttExchangeMTU(const uint8_t* source, const int length) : AttPDUMsg(source, length) {
                 checkOpcode(ATT_EXCHANGE_MTU_RSP);
@@ -680,14 +801,17 @@ namespace direct_bt {
      */
     class AttReadRsp: public AttPDUMsg
     {
-        private:
-            const TOctetSlice view;
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_READ_RSP);
+            }
 
         public:
             static bool instanceOf();
 
             AttReadRsp(const uint8_t* source, const int length)
-            : AttPDUMsg(source, length), view(pdu, getPDUValueOffset(), getPDUValueSize()) {
+            : AttPDUMsg(source, length) {
                 checkOpcode(ATT_READ_RSP);
             }
 
@@ -696,7 +820,7 @@ namespace direct_bt {
 
             uint8_t const * getValuePtr() const { return pdu.get_ptr(getPDUValueOffset()); }
 
-            TOctetSlice const & getValue() const { return view; }
+            TOctetSlice getValue() const { return TOctetSlice(pdu, getPDUValueOffset(), getPDUValueSize()); }
 
             std::string getName() const override {
                 return "AttReadRsp";
@@ -704,7 +828,7 @@ namespace direct_bt {
 
         protected:
             std::string valueString() const override {
-                return "size "+std::to_string(getPDUValueSize())+", data "+view.toString();
+                return "size "+std::to_string(getPDUValueSize())+", data "+getValue().toString();
             }
     };
 
@@ -765,14 +889,17 @@ namespace direct_bt {
      */
     class AttReadBlobRsp: public AttPDUMsg
     {
-        private:
-            const TOctetSlice view;
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_READ_BLOB_RSP);
+            }
 
         public:
             static bool instanceOf();
 
             AttReadBlobRsp(const uint8_t* source, const int length)
-            : AttPDUMsg(source, length), view(pdu, getPDUValueOffset(), getPDUValueSize()) {
+            : AttPDUMsg(source, length) {
                 checkOpcode(ATT_READ_BLOB_RSP);
             }
 
@@ -781,7 +908,7 @@ namespace direct_bt {
 
             uint8_t const * getValuePtr() const { return pdu.get_ptr(getPDUValueOffset()); }
 
-            TOctetSlice const & getValue() const { return view; }
+            TOctetSlice getValue() const { return TOctetSlice(pdu, getPDUValueOffset(), getPDUValueSize()); }
 
             std::string getName() const override {
                 return "AttReadBlobRsp";
@@ -789,7 +916,7 @@ namespace direct_bt {
 
         protected:
             std::string valueString() const override {
-                return "size "+std::to_string(getPDUValueSize())+", data "+view.toString();
+                return "size "+std::to_string(getPDUValueSize())+", data "+getValue().toString();
             }
     };
 
@@ -816,11 +943,18 @@ namespace direct_bt {
             : AttPDUMsg(ATT_WRITE_REQ, 1+2+value.getSize()), view(pdu, getPDUValueOffset(), getPDUValueSize())
             {
                 pdu.put_uint16(1, handle);
-                for(int i=0; i<value.getSize(); i++) {
-                    pdu.put_uint8(3+i, value.get_uint8(i));
+                if( 0 < value.getSize() ) {
+                    memcpy(pdu.get_wptr() + 3, value.get_ptr(), value.getSize());
                 }
             }
 
+            /** Leaves the value of given size uninitialized, to be filled in place via getValueWPtr(). */
+            AttWriteReq(const uint16_t handle, const int valueSize)
+            : AttPDUMsg(ATT_WRITE_REQ, 1+2+valueSize), view(pdu, getPDUValueOffset(), getPDUValueSize())
+            {
+                pdu.put_uint16(1, handle);
+            }
+
             /** opcode + handle */
             int getPDUValueOffset() const override { return 1 + 2; }
 
@@ -830,6 +964,8 @@ namespace direct_bt {
 
             uint8_t const * getValuePtr() const { return pdu.get_ptr(getPDUValueOffset()); }
 
+            uint8_t * getValueWPtr() { return pdu.get_wptr() + getPDUValueOffset(); }
+
             TOctetSlice const & getValue() const { return view; }
 
             std::string getName() const override {
@@ -854,6 +990,12 @@ namespace direct_bt {
      */
     class AttWriteRsp : public AttPDUMsg
     {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_WRITE_RSP);
+            }
+
         public:
             AttWriteRsp(const uint8_t* source, const int length)
             : AttPDUMsg(source, length) {
@@ -888,11 +1030,18 @@ namespace direct_bt {
             : AttPDUMsg(ATT_WRITE_CMD, 1+2+value.getSize()), view(pdu, getPDUValueOffset(), getPDUValueSize())
             {
                 pdu.put_uint16(1, handle);
-                for(int i=0; i<value.getSize(); i++) {
-                    pdu.put_uint8(3+i, value.get_uint8(i));
+                if( 0 < value.getSize() ) {
+                    memcpy(pdu.get_wptr() + 3, value.get_ptr(), value.getSize());
                 }
             }
 
+            /** Leaves the value of given size uninitialized, to be filled in place via getValueWPtr(). */
+            AttWriteCmd(const uint16_t handle, const int valueSize)
+            : AttPDUMsg(ATT_WRITE_CMD, 1+2+valueSize), view(pdu, getPDUValueOffset(), getPDUValueSize())
+            {
+                pdu.put_uint16(1, handle);
+            }
+
             /** opcode + handle */
             int getPDUValueOffset() const override { return 1 + 2; }
 
@@ -902,6 +1051,8 @@ namespace direct_bt {
 
             uint8_t const * getValuePtr() const { return pdu.get_ptr(getPDUValueOffset()); }
 
+            uint8_t * getValueWPtr() { return pdu.get_wptr() + getPDUValueOffset(); }
+
             TOctetSlice const & getValue() const { return view; }
 
             std::string getName() const override {
@@ -914,6 +1065,178 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.6.1
+     * <p>
+     * ATT_PREPARE_WRITE_REQ
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.4 Write Long Characteristic Values
+     * </p>
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.5 Reliable Writes
+     * </p>
+     */
+    class AttPrepareWriteReq : public AttPDUMsg
+    {
+        private:
+            const TOctetSlice view;
+
+        public:
+            AttPrepareWriteReq(const uint16_t handle, const uint16_t value_offset, const TROOctets & value)
+            : AttPDUMsg(ATT_PREPARE_WRITE_REQ, 1+2+2+value.getSize()), view(pdu, getPDUValueOffset(), getPDUValueSize())
+            {
+                pdu.put_uint16(1, handle);
+                pdu.put_uint16(3, value_offset);
+                if( 0 < value.getSize() ) {
+                    memcpy(pdu.get_wptr() + 5, value.get_ptr(), value.getSize());
+                }
+            }
+
+            /** opcode + handle + value_offset */
+            int getPDUValueOffset() const override { return 1 + 2 + 2; }
+
+            uint16_t getHandle() const {
+                return pdu.get_uint16( 1 );
+            }
+
+            uint16_t getValueOffset() const {
+                return pdu.get_uint16( 1 + 2 );
+            }
+
+            TOctetSlice const & getValue() const { return view; }
+
+            std::string getName() const override {
+                return "AttPrepareWriteReq";
+            }
+
+        protected:
+            std::string valueString() const override {
+                return "handle "+uint16HexString(getHandle(), true)+", valueOffset "+uint16HexString(getValueOffset(), true)+", data "+view.toString();
+            }
+    };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.6.2
+     * <p>
+     * ATT_PREPARE_WRITE_RSP, echoing the received ATT_PREPARE_WRITE_REQ parameter.
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.4 Write Long Characteristic Values
+     * </p>
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.5 Reliable Writes
+     * </p>
+     */
+    class AttPrepareWriteRsp : public AttPDUMsg
+    {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_PREPARE_WRITE_RSP);
+            }
+
+        public:
+            AttPrepareWriteRsp(const uint8_t* source, const int length)
+            : AttPDUMsg(source, length) {
+                checkOpcode(ATT_PREPARE_WRITE_RSP);
+            }
+
+            /** opcode + handle + value_offset */
+            int getPDUValueOffset() const override { return 1 + 2 + 2; }
+
+            uint16_t getHandle() const {
+                return pdu.get_uint16( 1 );
+            }
+
+            uint16_t getValueOffset() const {
+                return pdu.get_uint16( 1 + 2 );
+            }
+
+            TOctetSlice getValue() const { return TOctetSlice(pdu, getPDUValueOffset(), getPDUValueSize()); }
+
+            std::string getName() const override {
+                return "AttPrepareWriteRsp";
+            }
+
+        protected:
+            std::string valueString() const override {
+                return "handle "+uint16HexString(getHandle(), true)+", valueOffset "+uint16HexString(getValueOffset(), true)+", data "+getValue().toString();
+            }
+    };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.6.3
+     * <p>
+     * ATT_EXECUTE_WRITE_REQ, writing or cancelling all prepared values.
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.4 Write Long Characteristic Values
+     * </p>
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.5 Reliable Writes
+     * </p>
+     */
+    class AttExecuteWriteReq : public AttPDUMsg
+    {
+        public:
+            /**
+             * @param commit if true, all prepared values are written, otherwise all prepared values are cancelled.
+             */
+            AttExecuteWriteReq(const bool commit)
+            : AttPDUMsg(ATT_EXECUTE_WRITE_REQ, 1+1)
+            {
+                pdu.put_uint8(1, commit ? 0x01 : 0x00);
+            }
+
+            /** opcode + flags */
+            int getPDUValueOffset() const override { return 1 + 1; }
+
+            bool isCommit() const {
+                return 0x01 == pdu.get_uint8( 1 );
+            }
+
+            std::string getName() const override {
+                return "AttExecuteWriteReq";
+            }
+
+        protected:
+            std::string valueString() const override {
+                return "commit "+std::to_string(isCommit());
+            }
+    };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.6.4
+     * <p>
+     * ATT_EXECUTE_WRITE_RSP
+     * </p>
+     */
+    class AttExecuteWriteRsp : public AttPDUMsg
+    {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_EXECUTE_WRITE_RSP);
+            }
+
+        public:
+            AttExecuteWriteRsp(const uint8_t* source, const int length)
+            : AttPDUMsg(source, length) {
+                checkOpcode(ATT_EXECUTE_WRITE_RSP);
+            }
+
+            /** opcode */
+            int getPDUValueOffset() const override { return 1; }
+
+            std::string getName() const override {
+                return "AttExecuteWriteRsp";
+            }
+    };
+
     /**
      * ATT Protocol PDUs Vol 3, Part F 3.4.7.1 and 3.4.7.2
      * <p>
@@ -932,12 +1255,15 @@ namespace direct_bt {
      */
     class AttHandleValueRcv: public AttPDUMsg
     {
-        private:
-            const TOctetSlice view;
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_HANDLE_VALUE_NTF, ATT_HANDLE_VALUE_IND);
+            }
 
         public:
             AttHandleValueRcv(const uint8_t* source, const int length)
-            : AttPDUMsg(source, length), view(pdu, getPDUValueOffset(), getPDUValueSize()) {
+            : AttPDUMsg(source, length) {
                 checkOpcode(ATT_HANDLE_VALUE_NTF, ATT_HANDLE_VALUE_IND);
             }
 
@@ -950,7 +1276,7 @@ namespace direct_bt {
 
             uint8_t const * getValuePtr() const { return pdu.get_ptr(getPDUValueOffset()); }
 
-            TOctetSlice const & getValue() const { return view; }
+            TOctetSlice getValue() const { return TOctetSlice(pdu, getPDUValueOffset(), getPDUValueSize()); }
 
             bool isNotification() const {
                 return ATT_HANDLE_VALUE_NTF == getOpcode();
@@ -966,7 +1292,7 @@ namespace direct_bt {
 
         protected:
             std::string valueString() const override {
-                return "handle "+uint16HexString(getHandle(), true)+", size "+std::to_string(getPDUValueSize())+", data "+view.toString();
+                return "handle "+uint16HexString(getHandle(), true)+", size "+std::to_string(getPDUValueSize())+", data "+getValue().toString();
             }
     };
 
@@ -999,6 +1325,264 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.4.7 and 3.4.4.11
+     * <p>
+     * ATT_READ_MULTIPLE_REQ or ATT_READ_MULTIPLE_VARIABLE_REQ
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.4 Read Multiple Characteristic Values
+     * </p>
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.5 Read Multiple Variable Length Characteristic Values
+     * </p>
+     */
+    class AttReadMultipleReq : public AttPDUMsg
+    {
+        public:
+            /**
+             * @param handles the value handles, at least two
+             * @param variableLength if true, ATT_READ_MULTIPLE_VARIABLE_REQ is used, otherwise ATT_READ_MULTIPLE_REQ
+             */
+            AttReadMultipleReq(const std::vector<uint16_t> & handles, const bool variableLength)
+            : AttPDUMsg(variableLength ? ATT_READ_MULTIPLE_VARIABLE_REQ : ATT_READ_MULTIPLE_REQ, 1+2*handles.size())
+            {
+                for(size_t i=0; i<handles.size(); i++) {
+                    pdu.put_uint16(1+2*i, handles[i]);
+                }
+            }
+
+            /** opcode */
+            int getPDUValueOffset() const override { return 1; }
+
+            int getHandleCount() const {
+                return getPDUValueSize() / 2;
+            }
+
+            uint16_t getHandle(const int idx) const {
+                return pdu.get_uint16( 1 + 2*idx );
+            }
+
+            bool isVariableLength() const {
+                return ATT_READ_MULTIPLE_VARIABLE_REQ == getOpcode();
+            }
+
+            std::string getName() const override {
+                return "AttReadMultipleReq";
+            }
+
+        protected:
+            std::string valueString() const override {
+                std::string res = "variable "+std::to_string(isVariableLength())+", handles[";
+                const int count = getHandleCount();
+                for(int i=0; i<count; i++) {
+                    res += uint16HexString(getHandle(i), true)+",";
+                }
+                return res+"]";
+            }
+    };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.4.8
+     * <p>
+     * ATT_READ_MULTIPLE_RSP
+     * </p>
+     * <p>
+     * The value holds the concatenated fixed length values of the requested handles,
+     * truncated to ATT_MTU - 1.
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.4 Read Multiple Characteristic Values
+     * </p>
+     */
+    class AttReadMultipleRsp: public AttPDUMsg
+    {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_READ_MULTIPLE_RSP);
+            }
+
+        public:
+            AttReadMultipleRsp(const uint8_t* source, const int length)
+            : AttPDUMsg(source, length) {
+                checkOpcode(ATT_READ_MULTIPLE_RSP);
+            }
+
+            /** opcode */
+            int getPDUValueOffset() const override { return 1; }
+
+            uint8_t const * getValuePtr() const { return pdu.get_ptr(getPDUValueOffset()); }
+
+            TOctetSlice getValue() const { return TOctetSlice(pdu, getPDUValueOffset(), getPDUValueSize()); }
+
+            std::string getName() const override {
+                return "AttReadMultipleRsp";
+            }
+
+        protected:
+            std::string valueString() const override {
+                return "size "+std::to_string(getPDUValueSize())+", data "+getValue().toString();
+            }
+    };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.4.12 and 3.4.7.4
+     * <p>
+     * ATT_READ_MULTIPLE_VARIABLE_RSP, a list of length-value tuples, or
+     * ATT_MULTIPLE_HANDLE_VALUE_NTF, a list of handle-length-value tuples.
+     * </p>
+     * <p>
+     * The last value may be truncated to fit into ATT_MTU,
+     * see isValueTruncated().
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.5 Read Multiple Variable Length Characteristic Values
+     * </p>
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.10.2 Multiple Variable Length Notifications
+     * </p>
+     */
+    class AttMultipleValueList: public AttPDUMsg
+    {
+        private:
+            /** PDU offset of each tuple's length field */
+            std::vector<int> tupleOffsets;
+
+            bool hasHandle() const {
+                return ATT_MULTIPLE_HANDLE_VALUE_NTF == getOpcode();
+            }
+
+            int getTupleHeaderSize() const {
+                return hasHandle() ? 2 + 2 : 2;
+            }
+
+            void parseTuples() {
+                const int lenFieldOffset = hasHandle() ? 2 : 0;
+                const int hdrSize = getTupleHeaderSize();
+                const int end = getPDUValueOffset() + getPDUValueSize();
+                int offset = getPDUValueOffset();
+                tupleOffsets.clear(); // keeps capacity
+                while( offset + hdrSize <= end ) {
+                    tupleOffsets.push_back(offset + lenFieldOffset);
+                    offset += hdrSize + pdu.get_uint16(offset + lenFieldOffset);
+                }
+            }
+
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttPDUMsg::reset(source, length);
+                checkOpcode(ATT_READ_MULTIPLE_VARIABLE_RSP, ATT_MULTIPLE_HANDLE_VALUE_NTF);
+                parseTuples();
+            }
+
+        public:
+            AttMultipleValueList(const uint8_t* source, const int length)
+            : AttPDUMsg(source, length) {
+                checkOpcode(ATT_READ_MULTIPLE_VARIABLE_RSP, ATT_MULTIPLE_HANDLE_VALUE_NTF);
+                parseTuples();
+            }
+
+            /** opcode */
+            int getPDUValueOffset() const override { return 1; }
+
+            bool isNotification() const { return hasHandle(); }
+
+            int getValueCount() const { return tupleOffsets.size(); }
+
+            /** Returns the value handle of the given tuple, only valid for ATT_MULTIPLE_HANDLE_VALUE_NTF, otherwise zero. */
+            uint16_t getValueHandle(const int idx) const {
+                return hasHandle() ? pdu.get_uint16( tupleOffsets.at(idx) - 2 ) : 0;
+            }
+
+            /** Returns the complete attribute value length of the given tuple, which may exceed the contained value size. */
+            int getValueLength(const int idx) const {
+                return pdu.get_uint16( tupleOffsets.at(idx) );
+            }
+
+            /** Returns true if the contained value of the given tuple is shorter than getValueLength(). */
+            bool isValueTruncated(const int idx) const {
+                return getValue(idx).getSize() < getValueLength(idx);
+            }
+
+            /** Returns the contained value of the given tuple, truncated to the PDU size. */
+            TOctetSlice getValue(const int idx) const {
+                const int offset = tupleOffsets.at(idx) + 2;
+                const int end = getPDUValueOffset() + getPDUValueSize();
+                return TOctetSlice(pdu, offset, std::min(getValueLength(idx), end - offset));
+            }
+
+            std::string getName() const override {
+                return "AttMultipleValueList";
+            }
+
+        protected:
+            std::string valueString() const override {
+                std::string res = "size "+std::to_string(getPDUValueSize())+", values[count "+std::to_string(getValueCount())+": ";
+                const int count = getValueCount();
+                for(int i=0; i<count; i++) {
+                    res += std::to_string(i)+"[";
+                    if( hasHandle() ) {
+                        res += "handle "+uint16HexString(getValueHandle(i), true)+", ";
+                    }
+                    res += "len "+std::to_string(getValueLength(i))+", data "+getValue(i).toString()+"],";
+                }
+                return res+"]";
+            }
+    };
+
+    /**
+     * Lightweight view of one AttElementList element, referencing the PDU's memory.
+     * <p>
+     * An element starts with its handle, followed by an optional group end handle and its value,
+     * the UUID being decoded lazily into the compact uuid_value_t.
+     * Field reads are not range checked, as the element extent has been validated by its PDU.
+     * </p>
+     */
+    class AttElementSlice
+    {
+        private:
+            uint8_t const * ptr;
+            int size;
+            int valueOffset;
+
+        public:
+            AttElementSlice(uint8_t const * ptr, const int size, const int valueOffset) noexcept
+            : ptr(ptr), size(size), valueOffset(valueOffset) {}
+
+            /** Returns the element size, i.e. handle(s) and value. */
+            int getSize() const noexcept { return size; }
+
+            uint8_t get_uint8(const int i) const noexcept { return ptr[i]; }
+            uint16_t get_uint16(const int i) const noexcept { return direct_bt::get_uint16(ptr, i, true /* littleEndian */); }
+
+            /** Returns the leading attribute handle, e.g. the group start handle. */
+            uint16_t getHandle() const noexcept { return get_uint16(0); }
+
+            /** Returns the group end handle of an AttReadByGroupTypeRsp element, otherwise getHandle(). */
+            uint16_t getEndHandle() const noexcept { return 4 <= valueOffset ? get_uint16(2) : getHandle(); }
+
+            uint8_t const * getValuePtr() const noexcept { return ptr + valueOffset; }
+            int getValueSize() const noexcept { return size - valueOffset; }
+
+            /**
+             * Returns the UUID covering the element octets [i..getSize()).
+             * @throws IllegalArgumentException if the remaining size is not a UUID size
+             */
+            uuid_value_t getUUID(const int i) const {
+                return uuid_value_t(uuid_t::toTypeSize(size - i), ptr, i);
+            }
+
+            /**
+             * Returns the UUID element value, e.g. of AttReadByGroupTypeRsp or AttFindInfoRsp.
+             * @throws IllegalArgumentException if the value size is not a UUID size
+             */
+            uuid_value_t getUUID() const { return getUUID(valueOffset); }
+    };
+
     class AttElementList : public AttPDUMsg
     {
         protected:
@@ -1020,6 +1604,26 @@ namespace direct_bt {
             }
 
         public:
+            /**
+             * Forward iterator over all elements as AttElementSlice,
+             * allowing zero-copy range based iteration of this PDU.
+             */
+            class const_iterator {
+                private:
+                    uint8_t const * ptr;
+                    int elementSize;
+                    int valueOffset;
+
+                public:
+                    const_iterator(uint8_t const * ptr, const int elementSize, const int valueOffset) noexcept
+                    : ptr(ptr), elementSize(elementSize), valueOffset(valueOffset) {}
+
+                    AttElementSlice operator*() const noexcept { return AttElementSlice(ptr, elementSize, valueOffset); }
+                    const_iterator& operator++() noexcept { ptr += elementSize; return *this; }
+                    bool operator==(const const_iterator &o) const noexcept { return ptr == o.ptr; }
+                    bool operator!=(const const_iterator &o) const noexcept { return ptr != o.ptr; }
+            };
+
             virtual ~AttElementList() {}
 
             virtual int getElementTotalSize() const = 0;
@@ -1034,6 +1638,15 @@ namespace direct_bt {
                 return pdu.get_ptr(getElementPDUOffset(elementIdx));
             }
 
+            const_iterator begin() const {
+                const int esz = getElementTotalSize();
+                return const_iterator(pdu.get_ptr() + getPDUValueOffset(), esz, esz - getElementValueSize());
+            }
+            const_iterator end() const {
+                const int esz = getElementTotalSize();
+                return const_iterator(pdu.get_ptr() + getElementPDUOffset(getElementCount()), esz, esz - getElementValueSize());
+            }
+
             std::string getName() const override {
                 return "AttElementList";
             }
@@ -1131,13 +1744,25 @@ namespace direct_bt {
      */
     class AttReadByTypeRsp: public AttElementList
     {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttElementList::reset(source, length);
+                checkOpcode(ATT_READ_BY_TYPE_RSP);
+
+                if( getPDUValueSize() % getElementTotalSize() != 0 ) {
+                    throw AttValueException("PDUReadByTypeRsp: Invalid packet size: pdu-value-size "+std::to_string(getPDUValueSize())+
+                            " not multiple of element-size "+std::to_string(getElementTotalSize()), E_FILE_LINE);
+                }
+            }
+
         public:
             /**
              * element := { uint16_t handle, uint8_t value[value-size] }
              */
             class Element {
                 private:
-                    const TOctetSlice view;
+                    /** Element extent validated once, fields are read unchecked */
+                    const TOctetReader view;
 
                 public:
                     Element(const AttReadByTypeRsp & p, const int idx)
@@ -1154,8 +1779,9 @@ namespace direct_bt {
                     int getValueSize() const { return view.getSize() - 2 /* handle size */; }
 
                     std::string toString() const {
-                        return "handle "+uint16HexString(getHandle(), true)+
-                               ", data "+bytesHexString(getValuePtr(), 0, getValueSize(), true /* lsbFirst */, true /* leading0X */);
+                        std::string res("handle "+uint16HexString(getHandle(), true)+", data ");
+                        appendBytesHexString(res, getValuePtr(), 0, getValueSize(), true /* lsbFirst */, true /* leading0X */);
+                        return res;
                     }
             };
 
@@ -1232,13 +1858,25 @@ namespace direct_bt {
      */
     class AttReadByGroupTypeRsp : public AttElementList
     {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttElementList::reset(source, length);
+                checkOpcode(ATT_READ_BY_GROUP_TYPE_RSP);
+
+                if( getPDUValueSize() % getElementTotalSize() != 0 ) {
+                    throw AttValueException("PDUReadByGroupTypeRsp: Invalid packet size: pdu-value-size "+std::to_string(getPDUValueSize())+
+                            " not multiple of element-size "+std::to_string(getElementTotalSize()), E_FILE_LINE);
+                }
+            }
+
         public:
             /**
              * element := { uint16_t startHandle, uint16_t endHandle, uint8_t value[value-size] }
              */
             class Element {
                 private:
-                    const TOctetSlice view;
+                    /** Element extent validated once, fields are read unchecked */
+                    const TOctetReader view;
 
                 public:
                     Element(const AttReadByGroupTypeRsp & p, const int idx)
@@ -1313,8 +1951,9 @@ namespace direct_bt {
         protected:
             std::string elementString(const int idx) const override {
                 Element e = getElement(idx);
-                return "handle ["+uint16HexString(e.getStartHandle(), true)+".."+uint16HexString(e.getEndHandle(), true)+
-                       "], data "+bytesHexString(e.getValuePtr(), 0, e.getValueSize(), true /* lsbFirst */, true /* leading0X */);
+                std::string res("handle ["+uint16HexString(e.getStartHandle(), true)+".."+uint16HexString(e.getEndHandle(), true)+"], data ");
+                appendBytesHexString(res, e.getValuePtr(), 0, e.getValueSize(), true /* lsbFirst */, true /* leading0X */);
+                return res;
             }
     };
 
@@ -1391,6 +2030,16 @@ namespace direct_bt {
                 throw AttValueException("PDUFindInfoRsp: Invalid format "+std::to_string(f)+", not UUID16 (1) or UUID128 (2)", E_FILE_LINE);
             }
 
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttElementList::reset(source, length);
+                checkOpcode(ATT_FIND_INFORMATION_RSP);
+                if( getPDUValueSize() % getElementTotalSize() != 0 ) {
+                    throw AttValueException("PDUFindInfoRsp: Invalid packet size: pdu-value-size "+std::to_string(getPDUValueSize())+
+                            " not multiple of element-size "+std::to_string(getElementTotalSize()), E_FILE_LINE);
+                }
+            }
+
         public:
             /**
              * element := { uint16_t handle, UUID value }, with a UUID of UUID16 or UUID128
@@ -1460,6 +2109,188 @@ namespace direct_bt {
                        ", uuid "+e.uuid.get()->toString();
             }
     };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.3.3
+     * <p>
+     * ATT_FIND_BY_TYPE_VALUE_REQ
+     * </p>
+     * <p>
+     * The attribute value is the UUID of the service being searched for, in little endian.
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.4.2 Discover Primary Service by Service UUID
+     * </p>
+     */
+    class AttFindByTypeValueReq : public AttPDUMsg
+    {
+        public:
+            AttFindByTypeValueReq(const uint16_t startHandle, const uint16_t endHandle, const uuid16_t & attType, const uuid_t & value)
+            : AttPDUMsg(ATT_FIND_BY_TYPE_VALUE_REQ, 1+2+2+2+value.getTypeSize())
+            {
+                pdu.put_uint16(1, startHandle);
+                pdu.put_uint16(3, endHandle);
+                pdu.put_uint16(5, attType.value);
+                pdu.put_uuid(7, value);
+            }
+
+            /** opcode + handle_start + handle_end + attribute type */
+            int getPDUValueOffset() const override { return 1 + 2 + 2 + 2; }
+
+            uint16_t getStartHandle() const {
+                return pdu.get_uint16( 1 );
+            }
+
+            uint16_t getEndHandle() const {
+                return pdu.get_uint16( 1 + 2 );
+            }
+
+            uint16_t getAttributeType() const {
+                return pdu.get_uint16( 1 + 2 + 2 );
+            }
+
+            std::string getName() const override {
+                return "AttFindByTypeValueReq";
+            }
+
+        protected:
+            std::string valueString() const override {
+                std::string res("handle ["+uint16HexString(getStartHandle(), true)+".."+uint16HexString(getEndHandle(), true)+
+                                "], type "+uint16HexString(getAttributeType(), true)+", value ");
+                appendBytesHexString(res, pdu.get_ptr(), getPDUValueOffset(), getPDUValueSize(), true /* lsbFirst */, true /* leading0X */);
+                return res;
+            }
+    };
+
+    /**
+     * ATT Protocol PDUs Vol 3, Part F 3.4.3.4
+     * <p>
+     * ATT_FIND_BY_TYPE_VALUE_RSP
+     * </p>
+     * <p>
+     * Contains a list of elements, each comprised of { found_handle, group_end_handle } pair.
+     * <pre>
+     *  element := { uint16_t foundHandle, uint16_t groupEndHandle }
+     * </pre>
+     * </p>
+     * Used in:
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.4.2 Discover Primary Service by Service UUID
+     * </p>
+     */
+    class AttFindByTypeValueRsp: public AttElementList
+    {
+        protected:
+            void reset(const uint8_t* source, const int length) override {
+                AttElementList::reset(source, length);
+                checkOpcode(ATT_FIND_BY_TYPE_VALUE_RSP);
+                if( 0 == getPDUValueSize() || getPDUValueSize() % getElementTotalSize() != 0 ) {
+                    throw AttValueException("AttFindByTypeValueRsp: Invalid packet size: pdu-value-size "+std::to_string(getPDUValueSize())+
+                            " not multiple of element-size "+std::to_string(getElementTotalSize()), E_FILE_LINE);
+                }
+            }
+
+        public:
+            AttFindByTypeValueRsp(const uint8_t* source, const int length) : AttElementList(source, length) {
+                checkOpcode(ATT_FIND_BY_TYPE_VALUE_RSP);
+                if( 0 == getPDUValueSize() || getPDUValueSize() % getElementTotalSize() != 0 ) {
+                    throw AttValueException("AttFindByTypeValueRsp: Invalid packet size: pdu-value-size "+std::to_string(getPDUValueSize())+
+                            " not multiple of element-size "+std::to_string(getElementTotalSize()), E_FILE_LINE);
+                }
+            }
+
+            /** opcode */
+            int getPDUValueOffset() const override { return 1; }
+
+            /** Returns size of each element, i.e. handle pair. */
+            int getElementTotalSize() const override { return 2 + 2; }
+
+            /** Net element-value size, i.e. the group end handle. */
+            int getElementValueSize() const override { return 2; }
+
+            int getElementCount() const override {
+                return getPDUValueSize()  / getElementTotalSize();
+            }
+
+            uint16_t getElementFoundHandle(const int elementIdx) const {
+                return pdu.get_uint16( getElementPDUOffset(elementIdx) );
+            }
+
+            uint16_t getElementGroupEndHandle(const int elementIdx) const {
+                return pdu.get_uint16( getElementPDUOffset(elementIdx) + 2 );
+            }
+
+            std::string getName() const override {
+                return "AttFindByTypeValueRsp";
+            }
+
+        protected:
+            std::string elementString(const int idx) const override {
+                return "handle ["+uint16HexString(getElementFoundHandle(idx), true)+".."+uint16HexString(getElementGroupEndHandle(idx), true)+"]";
+            }
+    };
+
+    /**
+     * Fixed capacity pool of recycled specialized AttPDUMsg instances,
+     * see AttPDUMsg::getSpecialized().
+     * <p>
+     * Each pooled instance's persistent memory is sized to the given PDU capacity, usually the maximum ATT_MTU,
+     * and a received PDU is specialized in place by copying it into a recycled instance.
+     * An instance is only being recycled if its shared reference is no more used outside of this pool,
+     * hence a steady state reader does not allocate memory for its received PDUs.
+     * The pool falls back to a non pooled instance if exhausted.
+     * </p>
+     * <p>
+     * Not thread safe, i.e. getSpecialized() shall only be called by one thread at a time, the reader.
+     * The returned references can be passed to and released by any thread.
+     * </p>
+     */
+    class AttPDUPool {
+        private:
+            enum Kind : int {
+                GENERIC = 0, UNDEFINED, ERROR_RSP, EXCHANGE_MTU, FIND_INFO_RSP, FIND_BY_TYPE_VALUE_RSP, READ_BY_TYPE_RSP,
+                READ_RSP, READ_BLOB_RSP, READ_MULTIPLE_RSP, READ_BY_GROUP_TYPE_RSP, WRITE_RSP, PREPARE_WRITE_RSP,
+                EXECUTE_WRITE_RSP, MULTIPLE_VALUE_LIST, HANDLE_VALUE_RCV, COUNT
+            };
+            const int capacity;
+            const int pduCapacity;
+            std::vector<std::shared_ptr<AttPDUMsg>> pool[Kind::COUNT];
+            int nextIdx[Kind::COUNT];
+            int allocCount;
+            int fallbackCount;
+
+            template<typename T>
+            std::shared_ptr<AttPDUMsg> acquire(const Kind kind, const uint8_t * buffer, int const buffer_size);
+
+        public:
+            /**
+             * @param capacity maximum number of recycled instances per specialized AttPDUMsg type
+             * @param pduCapacity persistent memory capacity of each pooled instance, e.g. the maximum ATT_MTU
+             */
+            AttPDUPool(const int capacity, const int pduCapacity);
+
+            AttPDUPool(const AttPDUPool&) = delete;
+            void operator=(const AttPDUPool&) = delete;
+
+            /**
+             * Return a recycled or newly pooled specialized instance like AttPDUMsg::getSpecialized().
+             */
+            std::shared_ptr<AttPDUMsg> getSpecialized(const uint8_t * buffer, int const buffer_size);
+
+            int getCapacity() const { return capacity; }
+
+            /** Returns the number of pooled instances allocated so far */
+            int getAllocCount() const { return allocCount; }
+
+            /** Returns the number of non pooled instances allocated due to exhaustion */
+            int getFallbackCount() const { return fallbackCount; }
+
+            std::string toString() const {
+                return "AttPDUPool[capacity "+std::to_string(capacity)+", pdu "+std::to_string(pduCapacity)+
+                       ", allocated "+std::to_string(allocCount)+", fallback "+std::to_string(fallbackCount)+"]";
+            }
+    };
 }
 
 /** \example dbt_scanner10.cpp
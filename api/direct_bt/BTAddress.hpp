@@ -29,6 +29,7 @@
 #include <cstring>
 #include <string>
 #include <cstdint>
+#include <functional>
 
 namespace direct_bt {
 
@@ -145,27 +146,144 @@ namespace direct_bt {
     struct __attribute__((packed)) EUI48 {
         uint8_t b[6]; // == sizeof(EUI48)
 
+        /** Length of the string representation '01:02:03:0A:0B:0C', excluding EOS. */
+        enum Defaults : int32_t { STRING_LENGTH = 17 };
+
         EUI48() { bzero(b, sizeof(EUI48)); }
         EUI48(const uint8_t * b);
-        EUI48(const std::string mac);
+        /** Byte-wise constructor, with b0 being the least significant byte, i.e. the last one in the string representation. */
+        constexpr EUI48(const uint8_t b0, const uint8_t b1, const uint8_t b2, const uint8_t b3, const uint8_t b4, const uint8_t b5) noexcept
+        : b{b0, b1, b2, b3, b4, b5} {}
+        /**
+         * Parses the given string in format '01:02:03:0A:0B:0C', case insensitive.
+         * @throws IllegalArgumentException if the string is not in the expected format
+         * @see scanString()
+         */
+        EUI48(const std::string & mac);
         EUI48(const EUI48 &o) noexcept = default;
         EUI48(EUI48 &&o) noexcept = default;
         EUI48& operator=(const EUI48 &o) noexcept = default;
         EUI48& operator=(EUI48 &&o) noexcept = default;
 
+        /**
+         * Returns the value of the given hex digit or -1 if not a hex digit.
+         */
+        static constexpr int hexDigit(const char c) noexcept {
+            return ( '0' <= c && c <= '9' ) ? c - '0' :
+                   ( 'a' <= ( c | 0x20 ) && ( c | 0x20 ) <= 'f' ) ? ( c | 0x20 ) - 'a' + 10 : -1;
+        }
+
+        /**
+         * Returns the value of the hex octet at str[i], str[i+1] or -1 if not a hex octet.
+         */
+        static constexpr int hexOctet(const char * str, const int i) noexcept {
+            return ( 0 > hexDigit(str[i]) || 0 > hexDigit(str[i+1]) ) ? -1 : ( hexDigit(str[i]) << 4 ) | hexDigit(str[i+1]);
+        }
+
+        /**
+         * Parses the given string of length len in format '01:02:03:0A:0B:0C', case insensitive, into res.
+         * <p>
+         * Allocation free and not throwing, hence suitable for lookups by string.
+         * </p>
+         * @return true if successful, otherwise false leaving res untouched.
+         */
+        static bool scanString(const char * str, const size_t len, EUI48 & res) noexcept {
+            if( STRING_LENGTH != len ) {
+                return false;
+            }
+            uint8_t v[6];
+            for(int i=0; i<6; i++) {
+                const int o = hexOctet(str, i*3);
+                if( 0 > o || ( i < 5 && ':' != str[i*3+2] ) ) {
+                    return false;
+                }
+                v[5-i] = static_cast<uint8_t>(o);
+            }
+            memcpy(res.b, v, sizeof(v));
+            return true;
+        }
+        static bool scanString(const std::string & str, EUI48 & res) noexcept {
+            return scanString(str.c_str(), str.length(), res);
+        }
+
+        /**
+         * Writes the string representation '01:02:03:0A:0B:0C' into dest including a trailing EOS,
+         * hence dest must hold at least STRING_LENGTH+1 chars.
+         * <p>
+         * Allocation free, e.g. for logging.
+         * </p>
+         * @return dest
+         */
+        char * toChars(char * dest) const noexcept {
+            static const char hex[] = "0123456789ABCDEF";
+            for(int i=0; i<6; i++) {
+                const uint8_t v = b[5-i];
+                dest[i*3]   = hex[v >> 4];
+                dest[i*3+1] = hex[v & 0x0f];
+                dest[i*3+2] = ':';
+            }
+            dest[STRING_LENGTH] = 0;
+            return dest;
+        }
+
+        /**
+         * Returns all 48 bits packed into the lower bits of an uint64_t, b[0] being the least significant byte,
+         * allowing single integer comparison and hashing.
+         */
+        uint64_t toUint64() const noexcept {
+            return   static_cast<uint64_t>(b[0])        | ( static_cast<uint64_t>(b[1]) << 8 )  |
+                   ( static_cast<uint64_t>(b[2]) << 16 ) | ( static_cast<uint64_t>(b[3]) << 24 ) |
+                   ( static_cast<uint64_t>(b[4]) << 32 ) | ( static_cast<uint64_t>(b[5]) << 40 );
+        }
+
         BLERandomAddressType getBLERandomAddressType(const BDAddressType addressType) const;
         std::string toString() const;
     };
 
+    /** Orders byte-wise, b[0] first, as previously done via memcmp. */
     inline bool operator<(const EUI48& lhs, const EUI48& rhs)
-    { return memcmp(&lhs, &rhs, sizeof(EUI48))<0; }
+    { return __builtin_bswap64(lhs.toUint64()) < __builtin_bswap64(rhs.toUint64()); }
 
     inline bool operator==(const EUI48& lhs, const EUI48& rhs)
-    { return !memcmp(&lhs, &rhs, sizeof(EUI48)); }
+    { return lhs.toUint64() == rhs.toUint64(); }
 
     inline bool operator!=(const EUI48& lhs, const EUI48& rhs)
     { return !(lhs == rhs); }
 
+    /**
+     * Returns a well distributed hash of the given EUI48,
+     * mixing all 48 bits via a 64 bit finalizer, see std::hash<EUI48>.
+     */
+    inline std::size_t hashEUI48(const EUI48& a) {
+        uint64_t v = a.toUint64();
+        v ^= v >> 33;
+        v *= UINT64_C(0xff51afd7ed558ccd);
+        v ^= v >> 33;
+        return static_cast<std::size_t>(v);
+    }
+
+    /**
+     * Key of a device address including its BDAddressType,
+     * e.g. for hash indices of devices or connections, see std::hash<BDAddressKey>.
+     */
+    struct BDAddressKey {
+        EUI48 address;
+        BDAddressType addressType;
+
+        BDAddressKey(const EUI48 & address_, const BDAddressType addressType_)
+        : address(address_), addressType(addressType_) {}
+
+        bool operator==(const BDAddressKey& rhs) const
+        { return address == rhs.address && addressType == rhs.addressType; }
+
+        bool operator!=(const BDAddressKey& rhs) const
+        { return !(*this == rhs); }
+
+        std::size_t hash() const {
+            return hashEUI48(address) ^ ( static_cast<std::size_t>(addressType) * 0x9E3779B9U );
+        }
+    };
+
     /** EUI48 MAC address matching any device, i.e. '0:0:0:0:0:0'. */
     extern const EUI48 EUI48_ANY_DEVICE;
     /** EUI48 MAC address matching all device, i.e. 'ff:ff:ff:ff:ff:ff'. */
@@ -175,4 +293,13 @@ namespace direct_bt {
 
 } // namespace direct_bt
 
+namespace std {
+    template<> struct hash<direct_bt::EUI48> {
+        std::size_t operator()(direct_bt::EUI48 const & a) const noexcept { return direct_bt::hashEUI48(a); }
+    };
+    template<> struct hash<direct_bt::BDAddressKey> {
+        std::size_t operator()(direct_bt::BDAddressKey const & k) const noexcept { return k.hash(); }
+    };
+}
+
 #endif /* BT_ADDRESS_HPP_ */
@@ -115,6 +115,10 @@ extern "C" {
 #define SOL_SCO		17
 #define SOL_RFCOMM	18
 
+#ifndef SOL_BLUETOOTH
+#define SOL_BLUETOOTH	274
+#endif
+
 #define BT_SECURITY	4
 struct bt_security {
 	__u8 level;
@@ -31,6 +31,8 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <atomic>
+#include <mutex>
 
 #include "OctetTypes.hpp"
 #include "BTAddress.hpp"
@@ -418,6 +420,86 @@ namespace direct_bt {
     // *************************************************
     // *************************************************
 
+    /**
+     * Writer of 'Advertising Data' (AD) structures, i.e. length, GAP_T type and data,
+     * into a caller provided TOctets buffer w/o any allocation.
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part C Generic Access Profile (GAP): 11 Advertising and Scan Response Data Format
+     * </p>
+     * <p>
+     * Fields exceeding the remaining capacity are not written and set hasOverflow().
+     * addField() returns the location of the field's data, which may be rewritten in place later on,
+     * e.g. for a sensor value changing between LEAdvertiser::updateData() calls while the layout stays the same.
+     * </p>
+     */
+    class ADWriter
+    {
+    private:
+        TOctets & buffer;
+        int size;
+        bool overflow;
+
+    public:
+        /** Writes into the given buffer, its size is the capacity. */
+        ADWriter(TOctets & buffer_) noexcept
+        : buffer(buffer_), size(0), overflow(false) {}
+
+        /** Drops all written fields. */
+        void clear() noexcept { size = 0; overflow = false; }
+
+        /** Returns the number of written octets. */
+        int getSize() const noexcept { return size; }
+        int getCapacity() const noexcept { return buffer.getSize(); }
+        int getRemaining() const noexcept { return buffer.getSize() - size; }
+
+        /** Returns true if any field has been dropped due to insufficient capacity. */
+        bool hasOverflow() const noexcept { return overflow; }
+
+        /** Returns a view of the written octets, valid as long as the buffer. */
+        TROOctets getData() const noexcept { return TROOctets(buffer.get_ptr(), size); }
+
+        /**
+         * Appends a field of given type and data length.
+         * @return the location of the field's data of given length, or nullptr if exceeding the remaining capacity
+         */
+        uint8_t * addField(const GAP_T type, const int length) noexcept;
+
+        /** Appends a field of given type and data, returns false if exceeding the remaining capacity. */
+        bool add(const GAP_T type, const uint8_t * data, const int length) noexcept;
+
+        /** Appends the FLAGS field, e.g. AD_FLAGS_GENERAL_MODE_BIT */
+        bool addFlags(const uint8_t flags) noexcept;
+
+        /**
+         * Appends the complete name, or the shortened name truncated to the remaining capacity.
+         * @return false if not even one character fits
+         */
+        bool addName(const std::string & name) noexcept;
+
+        bool addTxPower(const int8_t txPower) noexcept;
+
+        bool addAppearance(const AppearanceCat appearance) noexcept;
+
+        /** Appends a complete service UUID list of the given single UUID of its size. */
+        bool addServiceUUID(const uuid_t & uuid) noexcept;
+
+        /**
+         * Appends service data of the given 16 bit service UUID.
+         * @return the location of the service data of given length, or nullptr if exceeding the remaining capacity
+         */
+        uint8_t * addServiceData(const uint16_t uuid16, const int length) noexcept;
+
+        /**
+         * Appends manufacturer specific data of the given company.
+         * @return the location of the data of given length, or nullptr if exceeding the remaining capacity
+         */
+        uint8_t * addManufacturerData(const uint16_t company, const int length) noexcept;
+    };
+
+    // *************************************************
+    // *************************************************
+    // *************************************************
+
     /**
      * Bit mask of 'Extended Inquiry Response' (EIR) data fields,
      * indicating a set of related data.
@@ -457,6 +539,8 @@ namespace direct_bt {
     std::string getEIRDataBitString(const EIRDataType bit);
     std::string getEIRDataMaskString(const EIRDataType mask);
 
+    class EInfoReportPool; // forward
+
     /**
      * Collection of 'Advertising Data' (AD)
      * or 'Extended Inquiry Response' (EIR) information.
@@ -486,12 +570,12 @@ namespace direct_bt {
         EUI48 address;
 
         uint8_t flags = 0;
-        std::string name;
-        std::string name_short;
+        mutable std::string name;
+        mutable std::string name_short;
         int8_t rssi = 127; // The core spec defines 127 as the "not available" value
         int8_t tx_power = 127; // The core spec defines 127 as the "not available" value
-        std::shared_ptr<ManufactureSpecificData> msd = nullptr;
-        std::vector<std::shared_ptr<uuid_t>> services;
+        mutable std::shared_ptr<ManufactureSpecificData> msd = nullptr;
+        mutable std::vector<uuid_value_t> services;
         uint32_t device_class = 0;
         AppearanceCat appearance = AppearanceCat::UNKNOWN;
         POctets hash;
@@ -501,16 +585,28 @@ namespace direct_bt {
         uint16_t did_product = 0;
         uint16_t did_version = 0;
 
+        /** Lazy read_data(): Copy of the AD/EIR data, covering a legacy advertising report inline. */
+        SOctets<31> lazy_data;
+        /** Lazy read_data(): Element offsets within lazy_data of the last name, short name and manufacturer data, or -1. */
+        int16_t lazy_name_offset = -1;
+        int16_t lazy_name_short_offset = -1;
+        int16_t lazy_msd_offset = -1;
+        /** Lazy read_data(): Pending EIRDataType fields to be materialized on access, i.e. NAME, NAME_SHORT, MANUF_DATA and SERVICE_UUID. */
+        mutable std::atomic<uint32_t> lazy_pending;
+        mutable std::mutex mtx_lazy;
+
         void set(EIRDataType bit) { eir_data_mask = eir_data_mask | bit; }
         void setFlags(uint8_t f) { flags = f; set(EIRDataType::FLAGS); }
         void setName(const uint8_t *buffer, int buffer_len);
         void setShortName(const uint8_t *buffer, int buffer_len);
-        void setTxPower(int8_t v) { tx_power = v; set(EIRDataType::TX_POWER); }
         void setManufactureSpecificData(uint16_t const company, uint8_t const * const data, int const data_len) {
             msd = std::shared_ptr<ManufactureSpecificData>(new ManufactureSpecificData(company, data, data_len));
             set(EIRDataType::MANUF_DATA);
         }
-        void addService(std::shared_ptr<uuid_t> const &uuid);
+        void addService(uuid_value_t const &uuid) { addService(services, uuid); }
+        static void addService(std::vector<uuid_value_t> & list, uuid_value_t const &uuid);
+        /** Adds all service UUIDs of the given UUID list element to the list, returns false if the element type is no UUID list. */
+        static bool addServices(std::vector<uuid_value_t> & list, const uint8_t elem_type, uint8_t const * elem_data, const int elem_len);
         void setDeviceClass(uint32_t c) { device_class= c; set(EIRDataType::DEVICE_CLASS); }
         void setAppearance(AppearanceCat a) { appearance= a; set(EIRDataType::APPEARANCE); }
         void setHash(const uint8_t * h) { hash.resize(16); memcpy(hash.get_wptr(), h, 16); set(EIRDataType::HASH); }
@@ -523,11 +619,38 @@ namespace direct_bt {
             set(EIRDataType::DEVICE_ID);
         }
 
-        int next_data_elem(uint8_t *eir_elem_len, uint8_t *eir_elem_type, uint8_t const **eir_elem_data,
-                           uint8_t const * data, int offset, int const size);
+        static int next_data_elem(uint8_t *eir_elem_len, uint8_t *eir_elem_type, uint8_t const **eir_elem_data,
+                                  uint8_t const * data, int offset, int const size);
+
+        /** Materializes the given pending lazy fields of read_data(), see isLazyPending(). */
+        void materialize_lazy(const uint32_t fields) const;
+        inline void materialize(const EIRDataType fields) const {
+            if( 0 != ( lazy_pending.load() & static_cast<uint32_t>(fields) ) ) {
+                materialize_lazy(static_cast<uint32_t>(fields));
+            }
+        }
+        inline void materialize() const {
+            if( 0 != lazy_pending.load() ) {
+                materialize_lazy(UINT32_MAX);
+            }
+        }
 
     public:
-        EInfoReport() : hash(16, 0), randomizer(16, 0) {}
+        EInfoReport() : hash(16, 0), randomizer(16, 0), lazy_data(), lazy_pending(0) {}
+
+        /**
+         * Copies the given report, materializing its pending lazy read_data() fields first,
+         * e.g. to rewrite a report shared with other consumers.
+         */
+        EInfoReport(const EInfoReport & o);
+
+        void operator=(const EInfoReport&) = delete;
+
+        /**
+         * Resets all fields to their initial state, retaining allocated capacity,
+         * allowing to recycle this instance, see EInfoReportPool.
+         */
+        void reset();
 
         void setSource(Source s) { source = s; }
         void setTimestamp(uint64_t ts) { timestamp = ts; }
@@ -536,6 +659,7 @@ namespace direct_bt {
         void setAddressType(BDAddressType at);
         void setAddress(EUI48 const &a) { address = a; set(EIRDataType::BDADDR); }
         void setRSSI(int8_t v) { rssi = v; set(EIRDataType::RSSI); }
+        void setTxPower(int8_t v) { tx_power = v; set(EIRDataType::TX_POWER); }
 
         /**
          * Reads a complete Advertising Data (AD) Report
@@ -545,8 +669,12 @@ namespace direct_bt {
          * <p>
          * https://www.bluetooth.com/specifications/archived-specifications/
          * </p>
+         * @param lazy if true, uses the lazy parse mode of read_data()
+         * @param timestamp monotonic timestamp in milliseconds of all reports, e.g. of the HCIEvent, zero for the current time
+         * @param pool optional EInfoReportPool to recycle the returned instances from, defaults to nullptr for new instances
          */
-        static std::vector<std::shared_ptr<EInfoReport>> read_ad_reports(uint8_t const * data, uint8_t const data_length);
+        static std::vector<std::shared_ptr<EInfoReport>> read_ad_reports(uint8_t const * data, uint8_t const data_length, const bool lazy=false,
+                                                                         const uint64_t timestamp=0, EInfoReportPool * pool=nullptr);
 
         /**
          * Reads the Extended Inquiry Response (EIR) or Advertising Data (AD) segments
@@ -572,8 +700,18 @@ namespace direct_bt {
          * <p>
          * https://www.bluetooth.com/specifications/archived-specifications/
          * </p>
+         * <p>
+         * In lazy mode, the data is copied and indexed in one allocation free pass,
+         * decoding all fixed size fields and the EIRDataType mask.
+         * The name, short name, ManufactureSpecificData and service UUIDs are each only materialized
+         * on their first access, saving their allocations for consumers only requiring e.g. address and RSSI.
+         * </p>
+         * @param lazy if true, defer materialization of variable sized fields to their first access, defaults to false.
          */
-        int read_data(uint8_t const * data, uint8_t const data_length);
+        int read_data(uint8_t const * data, int const data_length, const bool lazy=false);
+
+        /** Returns true if lazy read_data() fields are still pending materialization. */
+        bool isLazyPending() const { return 0 != lazy_pending.load(); }
 
         Source getSource() const { return source; }
         uint64_t getTimestamp() const { return timestamp; }
@@ -585,13 +723,34 @@ namespace direct_bt {
         uint8_t getADAddressType() const { return ad_address_type; }
         BDAddressType getAddressType() const { return addressType; }
         EUI48 const & getAddress() const { return address; }
-        std::string const & getName() const { return name; }
-        std::string const & getShortName() const { return name_short; }
+        std::string const & getName() const { materialize(EIRDataType::NAME); return name; }
+        std::string const & getShortName() const { materialize(EIRDataType::NAME_SHORT); return name_short; }
+
+        /**
+         * Returns true if the complete name equals the given name.
+         * <p>
+         * A pending lazy name is compared on its raw bytes w/o being materialized,
+         * allowing to skip decoding an unchanged name of a repeated advertising report.
+         * </p>
+         */
+        bool isNameEqual(const std::string & other) const;
         int8_t getRSSI() const { return rssi; }
         int8_t getTxPower() const { return tx_power; }
 
-        std::shared_ptr<ManufactureSpecificData> getManufactureSpecificData() const { return msd; }
-        std::vector<std::shared_ptr<uuid_t>> getServices() const { return services; }
+        std::shared_ptr<ManufactureSpecificData> getManufactureSpecificData() const { materialize(EIRDataType::MANUF_DATA); return msd; }
+        /** Returns the advertised service UUIDs as compact uuid_value_t */
+        std::vector<uuid_value_t> const & getServices() const { materialize(EIRDataType::SERVICE_UUID); return services; }
+
+        /**
+         * Moves the complete name out of this report, leaving it empty.
+         * <p>
+         * The take*() methods shall only be used by the sole owner of this report, see DBTDevice::update(EInfoReport&&).
+         * </p>
+         */
+        std::string takeName() { materialize(EIRDataType::NAME); return std::move(name); }
+        std::string takeShortName() { materialize(EIRDataType::NAME_SHORT); return std::move(name_short); }
+        std::shared_ptr<ManufactureSpecificData> takeManufactureSpecificData() { materialize(EIRDataType::MANUF_DATA); return std::move(msd); }
+        std::vector<uuid_value_t> takeServices() { materialize(EIRDataType::SERVICE_UUID); return std::move(services); }
 
         uint32_t getDeviceClass() const { return device_class; }
         AppearanceCat getAppearance() const { return appearance; }
@@ -608,6 +767,59 @@ namespace direct_bt {
         std::string toString(const bool includeServices=true) const;
     };
 
+    /**
+     * All EInfoReport of one HCI LE_ADVERTISING_REPORT event,
+     * i.e. BT Core Spec v5.2: Vol 4, Part E HCI: 7.7.65.2 LE Advertising Report event,
+     * or of one HCI read batch of periodic advertising reports, see PeriodicAdvSyncTable.
+     */
+    typedef std::vector<std::shared_ptr<EInfoReport>> EInfoReportBatch;
+
+    /**
+     * Fixed capacity pool of recycled EInfoReport instances, see EInfoReport::read_ad_reports().
+     * <p>
+     * Like HCIEventPool, an instance is only being recycled if its shared reference is no more used outside of this pool,
+     * hence a steady state HCI reader thread does not allocate memory for its advertising reports.
+     * The pool falls back to a non pooled instance if exhausted.
+     * </p>
+     * <p>
+     * Not thread safe, i.e. acquire() shall only be called from one thread, the HCI reader.
+     * The returned references can be passed to and released by any thread.
+     * </p>
+     */
+    class EInfoReportPool {
+        private:
+            const int capacity;
+            std::vector<std::shared_ptr<EInfoReport>> pool;
+            int nextIdx;
+            int allocCount;
+            int fallbackCount;
+
+        public:
+            /**
+             * @param capacity maximum number of recycled instances
+             */
+            EInfoReportPool(const int capacity);
+
+            EInfoReportPool(const EInfoReportPool&) = delete;
+            void operator=(const EInfoReportPool&) = delete;
+
+            /** Returns a recycled and reset or a new EInfoReport instance. */
+            std::shared_ptr<EInfoReport> acquire();
+
+            int getCapacity() const { return capacity; }
+
+            /** Returns the number of pooled instances allocated so far */
+            int getAllocCount() const { return allocCount; }
+
+            /** Returns the number of non pooled instances allocated due to exhaustion */
+            int getFallbackCount() const { return fallbackCount; }
+
+            std::string toString() const {
+                return "EInfoReportPool[capacity "+std::to_string(capacity)+", allocated "+std::to_string(allocCount)+
+                       ", fallback "+std::to_string(fallbackCount)+"]";
+            }
+    };
+
     // *************************************************
     // *************************************************
     // *************************************************
@@ -44,6 +44,22 @@ namespace direct_bt {
      */
     int64_t getCurrentMilliseconds();
 
+    /**
+     * Returns current monotonic time in microseconds.
+     */
+    int64_t getCurrentMicroseconds();
+
+    /**
+     * Returns current monotonic time in nanoseconds.
+     */
+    int64_t getCurrentNanoseconds();
+
+    /**
+     * Converts the given past CLOCK_REALTIME timestamp in nanoseconds, e.g. a kernel socket receive timestamp,
+     * to the monotonic clock of getCurrentNanoseconds().
+     */
+    int64_t getMonotonicNanoseconds(const int64_t realtimeNS);
+
     #define E_FILE_LINE __FILE__,__LINE__
 
     class RuntimeException : public std::exception {
@@ -415,6 +431,25 @@ namespace direct_bt {
      */
     std::string bytesHexString(const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, const bool leading0X=true);
 
+    /**
+     * Writes the 2 * length uppercase hex characters of the given bytes into the caller provided buffer,
+     * using a lookup table of all byte values w/o any allocation.
+     * <p>
+     * Orders the bytes as bytesHexString() and writes no EOS.
+     * </p>
+     * @return pointer past the last written character
+     */
+    char * bytesHexChars(const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, char * dest) noexcept;
+
+    /**
+     * Appends the bytesHexString() of the given bytes to dest, growing dest at most once.
+     * <p>
+     * Allows toString() implementations to compose their output in place,
+     * avoiding the temporary string of bytesHexString() and its concatenation.
+     * </p>
+     */
+    void appendBytesHexString(std::string & dest, const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, const bool leading0X=true);
+
     std::string int32SeparatedString(const int32_t v, const char separator=',');
     std::string uint32SeparatedString(const uint32_t v, const char separator=',');
     std::string uint64SeparatedString(const uint64_t v, const char separator=',');
@@ -0,0 +1,174 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BEACON_MATCHER_HPP_
+#define BEACON_MATCHER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+#include "BTAddress.hpp"
+
+namespace direct_bt {
+
+    enum class BeaconType : uint8_t {
+        /** Registered custom pattern, BeaconRecord::data holds the field data following the prefix */
+        CUSTOM        = 0,
+        /** Apple iBeacon, BeaconRecord::id holds the proximity UUID */
+        IBEACON       = 1,
+        /** Eddystone-UID, BeaconRecord::id holds the 10 octet namespace followed by the 6 octet instance */
+        EDDYSTONE_UID = 2,
+        /** Eddystone-URL, BeaconRecord::data holds the URL scheme prefix followed by the encoded URL */
+        EDDYSTONE_URL = 3,
+        /** Eddystone-TLM, BeaconRecord::data holds the telemetry following the frame type */
+        EDDYSTONE_TLM = 4
+    };
+    std::string getBeaconTypeString(const BeaconType v);
+
+    /**
+     * Compact decoded beacon frame of one advertising report, see BeaconMatcher.
+     * <p>
+     * Multi-byte values are in host byte order, byte arrays in their transmitted order.
+     * </p>
+     */
+    struct BeaconRecord {
+        /** Maximum length of data */
+        static constexpr int MAX_DATA_LEN = 26;
+
+        uint64_t timestamp;
+        EUI48 address;
+        /** Address type of the advertising report, see EInfoReport::setADAddressType() */
+        uint8_t ad_address_type;
+        BeaconType type;
+        /** Index of the matched pattern within its BeaconMatcher */
+        uint16_t pattern;
+        /** Received signal strength in dBm, 127 if not available */
+        int8_t rssi;
+        /** Calibrated TX power of the frame in dBm, at 1m for iBeacon and 0m for Eddystone, 127 if not available */
+        int8_t txPower;
+        uint16_t major;
+        uint16_t minor;
+        uint8_t id[16];
+        uint8_t dataLength;
+        uint8_t data[MAX_DATA_LEN];
+
+        std::string toString() const;
+    };
+
+    /**
+     * Compiled matcher table of beacon frame patterns, matching raw AD data
+     * and decoding it into a BeaconRecord w/o creating any EInfoReport or DBTDevice.
+     * <p>
+     * A pattern matches a manufacturer specific data field by its company identifier
+     * or a 16-bit UUID service data field by its UUID, followed by the given prefix of up to MAX_PREFIX_LEN octets.
+     * The first matching field of the AD data wins, the longest prefix wins among the patterns of one key.
+     * </p>
+     * <p>
+     * Patterns are compiled into a 16-bit key bitmap rejecting most fields with one bit test,
+     * followed by a binary search of the sorted patterns, hence the cost is independent of the number of patterns.
+     * </p>
+     * <p>
+     * The matcher shall be fully set up before being shared as immutable, see HCIHandler::setBeaconMatcher().
+     * </p>
+     */
+    class BeaconMatcher {
+        public:
+            static constexpr int MAX_PREFIX_LEN = 8;
+
+        private:
+            enum class Kind : uint8_t { MANUFACTURER = 0, SERVICE_DATA = 1 };
+
+            struct Pattern {
+                Kind kind;
+                uint16_t key;
+                uint8_t prefixLength;
+                uint8_t prefix[MAX_PREFIX_LEN];
+                BeaconType type;
+                uint16_t index;
+            };
+
+            /** Sorted by kind, key and descending prefix length */
+            std::vector<Pattern> patterns;
+            /** One bit per 16-bit key of each Kind */
+            std::vector<uint64_t> keyBits;
+            bool consume;
+
+            int add(const Kind kind, const uint16_t key, const uint8_t * prefix, const int prefixLength, const BeaconType type);
+            bool testKey(const Kind kind, const uint16_t key) const {
+                const int bit = ( static_cast<int>(kind) << 16 ) | key;
+                return 0 != ( keyBits[bit >> 6] & ( static_cast<uint64_t>(1) << ( bit & 63 ) ) );
+            }
+            bool matchField(const Kind kind, const uint16_t key, const uint8_t * data, const int length, BeaconRecord & rec) const;
+            static bool decode(const Pattern & p, const uint8_t * data, const int length, BeaconRecord & rec);
+
+        public:
+            /**
+             * @param consume_ if true, matched advertising reports are consumed by the beacon path,
+             *        i.e. not delivered as EInfoReport, avoiding any DBTDevice creation.
+             */
+            BeaconMatcher(const bool consume_=true);
+
+            /** Returns true if matched advertising reports are consumed by the beacon path. */
+            bool isConsuming() const { return consume; }
+
+            /** Returns the number of patterns. */
+            int size() const { return static_cast<int>(patterns.size()); }
+
+            /**
+             * Adds a pattern of a manufacturer specific data field of the given company.
+             * @return the pattern index, reported via BeaconRecord::pattern
+             */
+            int addManufacturer(const uint16_t company, const std::vector<uint8_t> & prefix, const BeaconType type=BeaconType::CUSTOM);
+
+            /**
+             * Adds a pattern of a 16-bit UUID service data field of the given UUID.
+             * @return the pattern index, reported via BeaconRecord::pattern
+             */
+            int addServiceData(const uint16_t uuid16, const std::vector<uint8_t> & prefix, const BeaconType type=BeaconType::CUSTOM);
+
+            /** Adds the iBeacon pattern, company 0x004C with prefix 0x02 0x15. */
+            int addIBeacon();
+
+            /** Adds the Eddystone-UID, -URL and -TLM patterns, service data 0xFEAA with the frame type prefix. */
+            void addEddystone();
+
+            /**
+             * Matches the given raw AD data against all patterns.
+             * <p>
+             * Only the decoded fields and pattern of the given BeaconRecord are set,
+             * the report fields like address and RSSI are left to the caller.
+             * </p>
+             * @return true if matched and rec has been set
+             */
+            bool match(const uint8_t * data, const int length, BeaconRecord & rec) const;
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* BEACON_MATCHER_HPP_ */
@@ -0,0 +1,124 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef BONDING_KEY_STORE_HPP_
+#define BONDING_KEY_STORE_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <map>
+
+#include <mutex>
+
+#include "BTAddress.hpp"
+#include "OctetTypes.hpp"
+#include "MgmtTypes.hpp"
+
+namespace direct_bt {
+
+    /**
+     * In-memory and optional on-disk store of the SMP keys of bonded devices, keyed by the local adapter address.
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part H SMP: 2.4.1 Definition of Keys
+     * </p>
+     * <p>
+     * Keys are kept in the order of their last update, most recent last,
+     * allowing DBTManager to bulk-load the most recently bonded devices
+     * if the kernel's command size limit is exceeded, see MgmtLoadLongTermKeyCmd::MAX_KEY_COUNT.
+     * </p>
+     * <p>
+     * All keys of one adapter are stored in one serialized record, which is also written to
+     * '<directory>/<adapter-address>.keys' with owner read/write permissions only if a directory is given.
+     * </p>
+     */
+    class BondingKeyStore {
+        public:
+            enum Defaults : uint8_t {
+                /** Serialized record format version */
+                RECORD_VERSION = 1
+            };
+
+        private:
+            struct AdapterKeys {
+                std::vector<MgmtLongTermKeyInfo> ltks;
+                std::vector<MgmtIdentityResolvingKeyInfo> irks;
+            };
+            const std::string directory;
+            std::mutex mtx_keys;
+            std::map<EUI48, AdapterKeys> keys;
+
+            std::string getFilename(const EUI48 & adapter) const;
+            /** Returns the adapter's keys, read from disk if not yet present. Caller shall hold mtx_keys. */
+            AdapterKeys & getAdapterKeys(const EUI48 & adapter);
+            bool writeRecord(const EUI48 & adapter, const AdapterKeys & ak);
+
+        public:
+            /**
+             * @param directory the directory for on-disk records, empty for an in-memory store only
+             */
+            BondingKeyStore(const std::string & directory);
+
+            /** Returns the serialized record of the given keys. */
+            static std::shared_ptr<const POctets> serialize(const std::vector<MgmtLongTermKeyInfo> & ltks,
+                                                            const std::vector<MgmtIdentityResolvingKeyInfo> & irks);
+
+            /**
+             * Restores the keys of the given serialized record.
+             * @return true if successful, otherwise false w/ a corrupt record
+             */
+            static bool deserialize(const TROOctets & record, std::vector<MgmtLongTermKeyInfo> & ltks,
+                                    std::vector<MgmtIdentityResolvingKeyInfo> & irks);
+
+            /**
+             * Stores the given Long Term Key of the given adapter,
+             * replacing a previous key of the same device and role.
+             */
+            void putLongTermKey(const EUI48 & adapter, const MgmtLongTermKeyInfo & key);
+
+            /**
+             * Stores the given Identity Resolving Key of the given adapter,
+             * replacing a previous key of the same identity address.
+             */
+            void putIdentityResolvingKey(const EUI48 & adapter, const MgmtIdentityResolvingKeyInfo & key);
+
+            /** Removes all keys of the given device of the given adapter, returns the number of removed keys. */
+            int remove(const EUI48 & adapter, const EUI48 & address, const BDAddressType addressType);
+
+            /** Returns true if a Long Term Key of the given device of the given adapter is stored. */
+            bool isBonded(const EUI48 & adapter, const EUI48 & address, const BDAddressType addressType);
+
+            /** Returns up to maxCount of the most recently stored Long Term Keys of the given adapter. */
+            std::vector<MgmtLongTermKeyInfo> getLongTermKeys(const EUI48 & adapter, const size_t maxCount);
+
+            /** Returns up to maxCount of the most recently stored Identity Resolving Keys of the given adapter. */
+            std::vector<MgmtIdentityResolvingKeyInfo> getIdentityResolvingKeys(const EUI48 & adapter, const size_t maxCount);
+    };
+
+} // namespace direct_bt
+
+#endif /* BONDING_KEY_STORE_HPP_ */
@@ -0,0 +1,171 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COW_VECTOR_HPP_
+#define COW_VECTOR_HPP_
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace direct_bt {
+
+    /**
+     * Copy-on-write vector, allowing lock-free iteration of an immutable snapshot,
+     * while mutators publish a new version.
+     * <p>
+     * Readers retrieve the current snapshot via get_snapshot() w/o locking, e.g. via for_each_cow().
+     * A snapshot stays valid and unchanged for its holder, regardless of concurrent mutations,
+     * i.e. a callback may add or remove elements while being iterated.
+     * </p>
+     * <p>
+     * Mutators are serialized via the write mutex, copying the current version,
+     * modifying the copy and publishing it via std::atomic_store.
+     * Compound mutations may hold get_write_mutex() and operate via copy_store() and set_store().
+     * </p>
+     * <p>
+     * Intended for rarely mutated and frequently iterated lists, e.g. listener and callback lists.
+     * </p>
+     */
+    template <typename Value_type> class COWVector {
+        public:
+            typedef std::vector<Value_type> storage_t;
+            typedef std::shared_ptr<const storage_t> snapshot_t;
+
+        private:
+            snapshot_t store_ref;
+            std::recursive_mutex mtx_write;
+
+        public:
+            COWVector() : store_ref(new storage_t()) {}
+
+            COWVector(const COWVector&) = delete;
+            void operator=(const COWVector&) = delete;
+
+            /** Returns the current immutable version, w/o locking. */
+            snapshot_t get_snapshot() const {
+                return std::atomic_load(&store_ref);
+            }
+
+            /** Returns the write mutex serializing all mutations. */
+            std::recursive_mutex & get_write_mutex() { return mtx_write; }
+
+            /** Returns a mutable copy of the current version, caller shall hold get_write_mutex(). */
+            std::shared_ptr<storage_t> copy_store() {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+                return std::shared_ptr<storage_t>( new storage_t( *store_ref ) );
+            }
+
+            /** Publishes the given new version, caller shall hold get_write_mutex(). */
+            void set_store(std::shared_ptr<storage_t> && new_store) {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+                std::atomic_store(&store_ref, snapshot_t( std::move(new_store) ) );
+            }
+
+            size_t size() const { return get_snapshot()->size(); }
+
+            bool empty() const { return get_snapshot()->empty(); }
+
+            void clear() {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+                std::atomic_store(&store_ref, snapshot_t( new storage_t() ) );
+            }
+
+            void push_back(const Value_type & x) {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+                std::shared_ptr<storage_t> new_store = copy_store();
+                new_store->push_back(x);
+                set_store(std::move(new_store));
+            }
+
+            /**
+             * Adds the given element if not already contained, using the given binary equality predicate.
+             * <p>
+             * Returns true if newly added, otherwise false.
+             * </p>
+             */
+            template<class BinaryPredicate>
+            bool push_back_unique(const Value_type & x, BinaryPredicate equal) {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+                snapshot_t store = get_snapshot();
+                for(auto it = store->begin(); it != store->end(); ++it) {
+                    if( equal(*it, x) ) {
+                        return false; // already included
+                    }
+                }
+                push_back(x);
+                return true;
+            }
+
+            /**
+             * Erases the first or all elements matching the given unary predicate.
+             * <p>
+             * Returns the number of erased elements.
+             * </p>
+             */
+            template<class UnaryPredicate>
+            int erase_matching(const bool all, UnaryPredicate p) {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+                std::shared_ptr<storage_t> new_store = copy_store();
+                int count = 0;
+                for(auto it = new_store->begin(); it != new_store->end(); ) {
+                    if( p(*it) ) {
+                        it = new_store->erase(it);
+                        count++;
+                        if( !all ) {
+                            break;
+                        }
+                    } else {
+                        ++it;
+                    }
+                }
+                if( 0 < count ) {
+                    set_store(std::move(new_store));
+                }
+                return count;
+            }
+    };
+
+    /**
+     * Custom for_each template, performing UnaryFunction on all elements of the current COWVector snapshot,
+     * without locking.
+     * <p>
+     * The container may be modified within lambda 'callback', not affecting the iterated snapshot.
+     * </p>
+     */
+    template<class Value_type, class UnaryFunction>
+    UnaryFunction for_each_cow(const COWVector<Value_type> & cow, UnaryFunction f)
+    {
+        const typename COWVector<Value_type>::snapshot_t snapshot = cow.get_snapshot();
+        for(auto it = snapshot->begin(); it != snapshot->end(); ++it) {
+            f(*it);
+        }
+        return f; // implicit move since C++11
+    }
+
+} // namespace direct_bt
+
+#endif /* COW_VECTOR_HPP_ */
@@ -31,16 +31,33 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
 
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <thread>
 
 #include "DBTTypes.hpp"
+#include "COWVector.hpp"
+#include "ShardedHashMap.hpp"
+#include "DiscoveryFilter.hpp"
+#include "DeviceUpdateCoalescer.hpp"
+#include "ScanScheduler.hpp"
+#include "DeviceJournal.hpp"
+#include "DeviceSighting.hpp"
+#include "InternTable.hpp"
+#include "DBTMetrics.hpp"
+#include "DBTMutex.hpp"
 
 #include "DBTDevice.hpp"
 
 #include "HCIHandler.hpp"
 #include "DBTManager.hpp"
+#include "RPAResolver.hpp"
+#include "LEAdvertiser.hpp"
 
 namespace direct_bt {
 
@@ -102,6 +119,41 @@ namespace direct_bt {
              */
             virtual void deviceFound(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) = 0;
 
+            /**
+             * Custom decision whether a newly found device shall be retained as DBTDevice,
+             * only queried if DeviceEvictionPolicy::MAX_SIGHTINGS is enabled.
+             * <p>
+             * The device is retained and deviceFound() called if any listener returns true,
+             * otherwise it is merely tracked as a slim DeviceSighting, see DBTAdapter::getDeviceSightings().
+             * The method is queried again if a later report of the sighting carries new EIRDataType.
+             * </p>
+             * <p>
+             * Called on the HCI event reader thread, hence shall not block.
+             * </p>
+             * <p>
+             * Defaults to true;
+             * </p>
+             * @param eir the report of the newly found device
+             */
+            virtual bool retainDevice(const EInfoReport & eir) {
+                (void)eir;
+                return true;
+            }
+
+            /**
+             * Returns the DeviceUpdatePolicy of this listener's deviceUpdated() notifications.
+             * <p>
+             * User may override this method to coalesce frequent updates, e.g. of the RSSI,
+             * in which case deferred updates are delivered on the adapter's DeviceUpdateCoalescer thread.
+             * </p>
+             * <p>
+             * Defaults to DeviceUpdatePolicy::getDefault().
+             * </p>
+             */
+            virtual DeviceUpdatePolicy getDeviceUpdatePolicy() const {
+                return DeviceUpdatePolicy::getDefault();
+            }
+
             /**
              * An already discovered DBTDevice has been updated.
              * @param device the updated device
@@ -144,6 +196,232 @@ namespace direct_bt {
             { return !(*this == rhs); }
     };
 
+    /**
+     * Per device outcome of DBTAdapter::connectDevices(),
+     * holding the last completed Stage and the latency of each stage in milliseconds.
+     */
+    class ConnectPipelineReport {
+        public:
+            enum class Stage : uint8_t {
+                /** Nothing completed */
+                NONE = 0,
+                /** HCI connection established */
+                HCI_CONNECTED = 1,
+                /** GATTHandler connected, including the MTU exchange */
+                GATT_CONNECTED = 2,
+                /** GATT services discovered */
+                GATT_DISCOVERED = 3,
+                /** Recorded SessionDevice listener and subscriptions restored, see DBTAdapter::resumeSession() */
+                SESSION_RESTORED = 4
+            };
+            static std::string getStageString(const Stage v);
+
+            std::shared_ptr<DBTDevice> device;
+            /** Last completed stage */
+            Stage stage = Stage::NONE;
+            /** HCIStatusCode of the HCI connection stage */
+            HCIStatusCode status = HCIStatusCode::UNKNOWN;
+            /** Time waiting for a permit to create the HCI connection */
+            uint64_t queuedMS = 0;
+            uint64_t hciConnectMS = 0;
+            uint64_t gattConnectMS = 0;
+            uint64_t gattDiscoveryMS = 0;
+            uint64_t restoreMS = 0;
+            uint64_t totalMS = 0;
+
+            ConnectPipelineReport(const std::shared_ptr<DBTDevice> & device) : device(device) {}
+
+            std::string toString() const;
+    };
+
+    /**
+     * Recorded GATT session state of one connected device, see DBTAdapter::getSession() and DBTAdapter::resumeSession().
+     * <p>
+     * The device's own DBTProfile stays attached to the device instance, hence is part of the session.
+     * </p>
+     */
+    class SessionDevice {
+        public:
+            /**
+             * Characteristic with enabled notification and/or indication,
+             * identified by its value handle, which is stable while the device's attribute database is unchanged.
+             */
+            struct Subscription {
+                uint16_t valueHandle;
+                bool notify;
+                bool indicate;
+            };
+            typedef std::map<uint16_t, std::vector<std::shared_ptr<GATTCharacteristicListener>>> BoundListenerMap;
+
+            std::shared_ptr<DBTDevice> device;
+            /** Monotonic timestamp in milliseconds of the recording */
+            uint64_t timestamp = 0;
+            std::vector<Subscription> subscriptions;
+            /** Listener added via DBTDevice::addCharacteristicListener() */
+            std::vector<std::shared_ptr<GATTCharacteristicListener>> listeners;
+            /** Listener bound to value handles via GATTHandler::addCharacteristicListener(l, valueHandles) */
+            BoundListenerMap boundListeners;
+
+            SessionDevice(const std::shared_ptr<DBTDevice> & device) : device(device) {}
+
+            std::string toString() const;
+    };
+
+    /**
+     * Recorded session of all connected devices of one DBTAdapter, see DBTAdapter::getSession().
+     */
+    class DBTSession {
+        public:
+            /** Monotonic timestamp in milliseconds of the recording */
+            uint64_t timestamp = 0;
+            std::vector<SessionDevice> devices;
+
+            bool isEmpty() const { return devices.empty(); }
+
+            std::string toString() const;
+    };
+
+    // *************************************************
+    // *************************************************
+    // *************************************************
+
+    /**
+     * Eviction policy of DBTAdapter's discovered and shared devices,
+     * bounding their memory during long running discovery, e.g. with keepAlive.
+     * <p>
+     * Connected devices are never evicted. Shared devices are only evicted
+     * if no longer discovered and not referenced outside of DBTAdapter.
+     * </p>
+     * <p>
+     * The policy is disabled by default.
+     * </p>
+     */
+    class DeviceEvictionPolicy {
+        public:
+            /**
+             * Maximum number of discovered devices, evicting the least recently updated ones, defaults to 0 for unlimited.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.devices.max'.
+             * </p>
+             */
+            const int32_t MAX_DEVICES;
+
+            /**
+             * Time to live in milliseconds since a device's last update, defaults to 0 for unlimited.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.devices.ttl'.
+             * </p>
+             */
+            const int32_t DEVICE_TTL;
+
+            /**
+             * Time to live in milliseconds since the last update of a device using a
+             * non-resolvable private random address (BLERandomAddressType::UNRESOLVABLE_PRIVAT),
+             * which is never re-used. Defaults to 0 for using DEVICE_TTL.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.devices.ttl.nrpa'.
+             * </p>
+             */
+            const int32_t NRPA_TTL;
+
+            /**
+             * Minimum interval in milliseconds between two time to live sweeps
+             * triggered by device discovery, defaults to 1000.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.devices.sweep'.
+             * </p>
+             */
+            const int32_t SWEEP_INTERVAL;
+
+            /**
+             * Maximum number of DeviceSighting, defaults to 0 for disabled.
+             * <p>
+             * If enabled, newly found devices are tracked as slim DeviceSighting
+             * and only allocated as DBTDevice if retained by an AdapterStatusListener,
+             * see AdapterStatusListener::retainDevice() and DBTAdapter::retainSighting().
+             * Sightings expire with the same time to live as devices.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.adapter.sightings.max'.
+             * </p>
+             */
+            const int32_t MAX_SIGHTINGS;
+
+            /** Reads the environment variables 'direct_bt.adapter.devices.*' and 'direct_bt.adapter.sightings.max' */
+            DeviceEvictionPolicy();
+
+            DeviceEvictionPolicy(const int32_t maxDevices, const int32_t deviceTTL, const int32_t nrpaTTL, const int32_t sweepInterval,
+                                 const int32_t maxSightings=0);
+
+            bool isEnabled() const { return 0 < MAX_DEVICES || 0 < DEVICE_TTL || 0 < NRPA_TTL; }
+
+            /** Returns the time to live in milliseconds of a device by its BLERandomAddressType, 0 for unlimited. */
+            int32_t getTTL(const BLERandomAddressType leRandomAddressType) const {
+                return ( BLERandomAddressType::UNRESOLVABLE_PRIVAT == leRandomAddressType && 0 < NRPA_TTL ) ? NRPA_TTL : DEVICE_TTL;
+            }
+
+            /** Returns true if the given device's time to live has expired at ts_now. */
+            bool isExpired(const DBTDevice & device, const uint64_t ts_now) const;
+
+            std::string toString() const;
+    };
+
+    /**
+     * Reconnect statistics of one device of DBTAdapter's auto-connect set,
+     * see DBTAdapter::addAutoConnectDevice().
+     */
+    class AutoConnectStats {
+        public:
+            EUI48 address;
+            BDAddressType addressType;
+            /** Time in monotonic milliseconds when added to the auto-connect set */
+            uint64_t ts_added;
+            /** Time in monotonic milliseconds when the device has been added or disconnected the last time, i.e. its reconnect start */
+            uint64_t ts_lost;
+            bool connected;
+            /** Number of completed connections */
+            uint32_t connectCount;
+            /** Last, maximum and summed up reconnect latency in milliseconds, i.e. from ts_lost to connection completion */
+            uint64_t lastLatencyMS;
+            uint64_t maxLatencyMS;
+            uint64_t sumLatencyMS;
+
+            AutoConnectStats(const EUI48 & address_, const BDAddressType addressType_, const uint64_t timestamp)
+            : address(address_), addressType(addressType_), ts_added(timestamp), ts_lost(timestamp), connected(false),
+              connectCount(0), lastLatencyMS(0), maxLatencyMS(0), sumLatencyMS(0) {}
+
+            uint64_t getAverageLatencyMS() const { return 0 < connectCount ? sumLatencyMS / connectCount : 0; }
+
+            std::string toString() const;
+    };
+
+    /**
+     * Discovery state transition latencies of DBTAdapter, see DBTAdapter::getDiscoveryStats().
+     * <p>
+     * All latencies are in milliseconds, measured up to the native discovering event of the transition.
+     * </p>
+     */
+    class DiscoveryStats {
+        public:
+            /** Latency of the last startDiscovery() */
+            uint64_t lastStartMS;
+            /** Latency of the last stopDiscovery() */
+            uint64_t lastStopMS;
+            /** Number of kept-alive discovery restarts after the native discovery ended */
+            uint32_t restartCount;
+            /** Last, maximum and summed up kept-alive discovery restart latency, i.e. native scanning downtime */
+            uint64_t lastRestartMS;
+            uint64_t maxRestartMS;
+            uint64_t sumRestartMS;
+
+            DiscoveryStats()
+            : lastStartMS(0), lastStopMS(0), restartCount(0), lastRestartMS(0), maxRestartMS(0), sumRestartMS(0) {}
+
+            uint64_t getAverageRestartMS() const { return 0 < restartCount ? sumRestartMS / restartCount : 0; }
+
+            std::string toString() const;
+    };
+
     // *************************************************
     // *************************************************
     // *************************************************
@@ -154,40 +432,191 @@ namespace direct_bt {
      * Controlling Environment variables:
      * <pre>
      * - 'direct_bt.debug.adapter.event': Debug messages about events, see debug_events
+     * - 'direct_bt.adapter.connect.pending': Maximum number of concurrently pending HCI connection creations
+     *   of connectDevices(), defaults to 1 as most controllers only accept one pending LE Create Connection.
+     * - 'direct_bt.adapter.devices.*': DeviceEvictionPolicy of discovered and shared devices
+     * - 'direct_bt.adapter.sightings.max': Maximum number of DeviceSighting, see DeviceEvictionPolicy::MAX_SIGHTINGS
+     * - 'direct_bt.adapter.devices.journal': Number of retained discovered device changes for getDiscoveredDevicesDelta(), defaults to 1024.
+     * - 'direct_bt.adapter.scan.*': ScanScheduler adapting the discovery's scan parameter
+     * - 'direct_bt.adapter.updates.*': Default DeviceUpdatePolicy of AdapterStatusListener::deviceUpdated()
+     * - 'direct_bt.adapter.rpa': Resolve resolvable private addresses to their identity device via the RPAResolver,
+     *   holding the IRKs of the DBTManager::getBondingKeyStore(), defaults to true.
+     * - 'direct_bt.adapter.session.resume': Automatic session resumption after a power cycle, see setSessionResumption(), defaults to false.
+     * - 'direct_bt.adapter.session.window': Maximum age in milliseconds of a device's disconnect before the power off
+     *   to be part of the resumed session, defaults to 5000.
      * </pre>
      * </p>
      */
     class DBTAdapter : public DBTObject
     {
         private:
-            /** Returns index >= 0 if found, otherwise -1 */
-            static int findDeviceIdx(std::vector<std::shared_ptr<DBTDevice>> & devices, EUI48 const & mac, const BDAddressType macType);
-            static std::shared_ptr<DBTDevice> findDevice(std::vector<std::shared_ptr<DBTDevice>> & devices, EUI48 const & mac, const BDAddressType macType);
-            std::shared_ptr<DBTDevice> findDevice(std::vector<std::shared_ptr<DBTDevice>> & devices, DBTDevice const & device);
+            /** Hash index of a device list by address and address type, see ShardedHashMap. */
+            typedef ShardedHashMap<BDAddressKey, std::shared_ptr<DBTDevice>> DeviceIndex;
+
+            static BDAddressKey getDeviceKey(DBTDevice const & device) {
+                return BDAddressKey(device.getAddress(), device.getAddressType());
+            }
 
             const bool debug_event;
+            const bool rpaResolution;
+            const DeviceEvictionPolicy evictionPolicy;
+            const ScanScheduler scanScheduler;
             DBTManager& mgmt;
+            /** Default DBTProfile of all devices, published via std::atomic_store(), may be nullptr */
+            std::shared_ptr<const DBTProfile> profile = nullptr;
+            RPAResolver rpaResolver;
+            LEAdvertiser advertiser;
             std::shared_ptr<AdapterInfo> adapterInfo;
             BTMode btMode = BTMode::NONE;
             NameAndShortName localName;
             std::atomic<ScanType> currentMetaScanType; // = ScanType::NONE
             std::atomic<ScanType> currentNativeScanType; // = ScanType::NONE
             std::atomic<bool> keepDiscoveringAlive; //  = false;
+            /** Requested and currently used scan parameter of the discovery, guarded by mtx_discovery */
+            ScanParameter scanRequested;
+            ScanParameter scanCurrent;
+            HCILEOwnAddressType scanOwnAddressType = HCILEOwnAddressType::PUBLIC;
+            /** Number of LE connections being created while discovery is paused, see ScanScheduler::PAUSE_ON_CONNECT */
+            std::atomic<int> scanPauseCount;
 
             std::shared_ptr<HCIHandler> hci;
             std::vector<std::shared_ptr<DBTDevice>> connectedDevices;
             std::vector<std::shared_ptr<DBTDevice>> discoveredDevices; // all discovered devices
             std::vector<std::shared_ptr<DBTDevice>> sharedDevices; // all active shared devices
-            std::vector<std::shared_ptr<AdapterStatusListener>> statusListenerList;
+            /**
+             * Lookup indices of above device lists, mutated together with their list while holding its mutex,
+             * but queried concurrently w/o the list mutex, e.g. for each advertising report.
+             */
+            DeviceIndex connectedDevicesIndex;
+            DeviceIndex discoveredDevicesIndex;
+            DeviceIndex sharedDevicesIndex;
+            /** Changes of discoveredDevices, mutated together with the list while holding mtx_discoveredDevices */
+            DeviceJournal<DBTDevice> discoveredDevicesJournal;
+            /** Slim sightings of found but not retained devices, see DeviceEvictionPolicy::MAX_SIGHTINGS */
+            DeviceSightingTable sightings;
+            /** Interned names and ManufactureSpecificData of all devices, see getInternTable() */
+            InternTable internTable;
+            /** Device memory gauges labeled by dev_id, nullptr if DBTMetrics is disabled, see updateDeviceMetrics() */
+            MetricGauge * metricDevices = nullptr;
+            MetricGauge * metricDeviceBytes = nullptr;
+            MetricGauge * metricSightings = nullptr;
+            MetricGauge * metricSightingBytes = nullptr;
+            /** Copy-on-write AdapterStatusListener list, iterated w/o locking when sending events */
+            COWVector<std::shared_ptr<AdapterStatusListener>> statusListenerList;
             std::recursive_mutex mtx_hci;
             std::recursive_mutex mtx_connectedDevices;
-            std::recursive_mutex mtx_discoveredDevices;
-            std::recursive_mutex mtx_sharedDevices;
-            std::recursive_mutex mtx_statusListenerList;
+            DBTRecursiveMutex mtx_discoveredDevices { "adapter_discovered" };
+            DBTRecursiveMutex mtx_sharedDevices { "adapter_shared" };
             std::recursive_mutex mtx_discovery;
+            /** Timestamp of the last DeviceEvictionPolicy sweep */
+            std::atomic<uint64_t> ts_last_eviction;
+            /** Copy-on-write DiscoveryFilter, accessed via std::atomic_load() and std::atomic_store() */
+            std::shared_ptr<const DiscoveryFilter> discoveryFilter;
+            /** Addresses whitelisted by setDiscoveryFilter(), guarded by mtx_discoveryFilter */
+            std::vector<BDAddressKey> discoveryFilterWhitelist;
+            std::mutex mtx_discoveryFilter;
+            /**
+             * Deferred adapter tasks processed by the single adapter worker thread,
+             * avoiding HCI commands on the HCI reader thread and per event thread creation.
+             * Pending tasks are coalesced.
+             */
+            enum class WorkerTask : uint32_t {
+                NONE                 = 0,
+                /** poweredOff() */
+                POWERED_OFF          = ( 1 << 0 ),
+                /** checkScanParameter() */
+                CHECK_SCAN_PARAMETER = ( 1 << 1 ),
+                /** startDiscoveryBackground() */
+                START_DISCOVERY      = ( 1 << 2 ),
+                /** resumeSession() of the session recorded at poweredOff() */
+                RESUME_SESSION       = ( 1 << 3 ),
+                /** keepAliveNextDevice() */
+                KEEP_ALIVE           = ( 1 << 4 )
+            };
+            uint32_t workerTasks;
+            bool workerRunning;
+            std::thread worker;
+            std::mutex mtx_worker;
+            std::condition_variable cv_worker;
+
+            /** Keep-alive of all connected devices, see startKeepAlive(), guarded by mtx_keepAlive */
+            TimerWheel::TimerID keepAliveTimer = 0;
+            KeepAliveMode keepAliveMode = KeepAliveMode::RSSI;
+            std::atomic<uint32_t> keepAliveIntervalMS { 0 };
+            /** Round-robin index of the next connected device to ping */
+            size_t keepAliveNext = 0;
+            std::mutex mtx_keepAlive;
+
+            /** Discovery transition timestamps and statistics, guarded by mtx_discoveryStats */
+            uint64_t ts_discovery_start_req;
+            uint64_t ts_discovery_stop_req;
+            uint64_t ts_discovery_native_off;
+            DiscoveryStats discoveryStats;
+            std::mutex mtx_discoveryStats;
+
+            /** Auto-connect set, see addAutoConnectDevice() */
+            std::unordered_map<BDAddressKey, AutoConnectStats> autoConnectDevices;
+            std::mutex mtx_autoConnect;
+
+            /** Automatic session resumption, see setSessionResumption() */
+            std::atomic<bool> sessionResumption { DBTEnv::getBooleanProperty("direct_bt.adapter.session.resume", false) };
+            const int32_t sessionWindowMS = DBTEnv::getInt32Property("direct_bt.adapter.session.window", 5000, 0 /* min */, 600000 /* max */);
+            /** True while poweredOff() disconnects all devices */
+            std::atomic<bool> poweringOff { false };
+            /** SessionDevice recorded at their unsolicited disconnect, guarded by mtx_session */
+            std::unordered_map<BDAddressKey, SessionDevice> sessionRecords;
+            /** Session recorded at poweredOff(), resumed once powered on again, guarded by mtx_session */
+            DBTSession pendingSession;
+            std::mutex mtx_session;
+
+            /** Returns the current SessionDevice state of the given connected device. */
+            static SessionDevice captureSessionDevice(const std::shared_ptr<DBTDevice> & device);
+
+            /**
+             * Records the session of the given device about to disconnect, called by DBTDevice::disconnect().
+             * <p>
+             * Only unsolicited disconnects, i.e. reported by the controller, caused by an IO error or a power off,
+             * are recorded. An application requested disconnect drops the device's record.
+             * </p>
+             */
+            void recordSessionDevice(DBTDevice & device, const bool unsolicited);
+
+            /** Restores the recorded listener and subscriptions of the given SessionDevice to the connected device, returns true if all succeeded. */
+            bool restoreSessionDevice(const SessionDevice & sd, DBTDevice & device);
+
+            /** Resumes the pendingSession if enabled, called by the worker once powered on. */
+            void resumePendingSession();
+
+            std::vector<ConnectPipelineReport> connectDevicesImpl(const std::vector<std::shared_ptr<DBTDevice>> & devices,
+                                                                  const int maxConcurrency, const bool discoverGATT,
+                                                                  const std::vector<bool> & awaitAutoConnect,
+                                                                  const std::function<bool(ConnectPipelineReport &)> & restore);
+            /** Coalescing deviceUpdated() notifications per AdapterStatusListener::getDeviceUpdatePolicy() */
+            DeviceUpdateCoalescer updateCoalescer;
 
             bool validateDevInfo();
 
+            /** Applies the DeviceEvictionPolicy if enabled and either its sweep interval elapsed or MAX_DEVICES is exceeded. */
+            void checkDeviceEviction(const uint64_t ts_now);
+
+            /** Retrieves the device memory gauges from DBTMetrics if enabled, called by the constructors. */
+            void initDeviceMetrics();
+
+            /** Updates the device memory gauges if enabled, to be called after adding or removing shared devices or sightings. */
+            void updateDeviceMetrics();
+
+            /** Returns true if any AdapterStatusListener::retainDevice() returns true for the given report. */
+            bool isDeviceRetained(const EInfoReport & eir);
+
+            /**
+             * Creates and adds a new discovered and shared DBTDevice of the given report,
+             * applies the DeviceEvictionPolicy and notifies AdapterStatusListener::deviceFound().
+             * <p>
+             * Returns the concurrently added discovered device instead, if existing.
+             * </p>
+             */
+            std::shared_ptr<DBTDevice> addNewDevice(const EInfoReport & eir);
+
             /**
              * Closes all connections, stops discovery and cleans up all references.
              * <p>
@@ -208,6 +637,7 @@ namespace direct_bt {
                                                       uint16_t latency, uint16_t supervision_timeout);
             friend HCIStatusCode DBTDevice::connectBREDR(const uint16_t pkt_type, const uint16_t clock_offset, const uint8_t role_switch);
             friend std::vector<std::shared_ptr<GATTService>> DBTDevice::getGATTServices();
+            friend void DBTDevice::readGATTGenericAccess(std::vector<GATTServiceRef> & gattServices);
 
             bool addConnectedDevice(const std::shared_ptr<DBTDevice> & device);
             bool removeConnectedDevice(const DBTDevice & device);
@@ -222,20 +652,76 @@ namespace direct_bt {
             void removeSharedDevice(const DBTDevice & device);
             std::shared_ptr<DBTDevice> findSharedDevice (EUI48 const & mac, const BDAddressType macType);
 
-            bool mgmtEvDeviceDiscoveringMgmt(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvNewSettingsMgmt(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvLocalNameChangedMgmt(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceFoundHCI(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceDisconnectedMgmt(std::shared_ptr<MgmtEvent> e);
+            bool mgmtEvDeviceDiscoveringMgmt(const MgmtEvtDiscovering &event);
+            bool mgmtEvNewSettingsMgmt(const MgmtEvtNewSettings &event);
+            bool mgmtEvLocalNameChangedMgmt(const MgmtEvtLocalNameChanged &event);
+            bool mgmtEvDeviceFoundHCI(const MgmtEvtDeviceFound &deviceFoundEvent);
+            bool advertisingReportBatchHCI(const EInfoReportBatch & batch);
+            /**
+             * Processing one found device's EInfoReport, shared by MgmtEvtDeviceFound and EInfoReportBatch delivery.
+             * <p>
+             * If movable, the given EInfoReport is solely owned by this adapter
+             * and its heap payload may be moved into an existing DBTDevice via DBTDevice::update(EInfoReport&&).
+             * Otherwise the given EInfoReport is left unmodified, i.e. a resolved RPA is rewritten in a private copy.
+             * </p>
+             */
+            void deviceFoundEIR(const std::shared_ptr<EInfoReport> & eir, const bool movable);
+            bool mgmtEvDeviceDisconnectedMgmt(const MgmtEvtDeviceDisconnected &event);
+            bool mgmtEvNewIdentityResolvingKeyMgmt(const MgmtEvtNewIdentityResolvingKey &event);
+            bool mgmtEvDeviceUnpairedMgmt(const MgmtEvtDeviceUnpaired &event);
+
+            /**
+             * Returns the identity of the given address if it is a resolvable private address of a known IRK,
+             * otherwise the given address, see RPAResolver.
+             */
+            BDAddressKey resolveIdentity(const EUI48 & address, const BDAddressType addressType);
 
-            bool mgmtEvDeviceDiscoveringHCI(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceConnectedHCI(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvConnectFailedHCI(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceDisconnectedHCI(std::shared_ptr<MgmtEvent> e);
+            bool mgmtEvDeviceDiscoveringHCI(const MgmtEvtDiscovering &event);
+            bool mgmtEvDeviceConnectedHCI(const MgmtEvtDeviceConnected &event);
+            bool mgmtEvConnectFailedHCI(const MgmtEvtDeviceConnectFailed &event);
+            bool mgmtEvDeviceDisconnectedHCI(const MgmtEvtDeviceDisconnected &event);
 
             void startDiscoveryBackground();
             void checkDiscoveryState();
 
+            /** Posts the given task to the adapter worker thread, starting the latter if required. */
+            void postWorkerTask(const WorkerTask task);
+            void workerImpl();
+            /** Stops the adapter worker thread, waiting for its current task to complete. */
+            void stopWorker();
+
+            /** Returns the delay until the next device's keep-alive ping, spreading the interval across all connected devices. */
+            uint32_t getKeepAliveDelay();
+            /** Pings the next connected device round-robin, performed on the adapter worker thread. */
+            void keepAliveNextDevice();
+
+            /** Tracks discovery transition latencies of a native discovering event. */
+            void discoveringChanged(const bool enabled, const uint64_t timestamp);
+
+            /** Sets the scan parameter adapted by the ScanScheduler, caller shall hold mtx_discovery and scanning shall be disabled. */
+            HCIStatusCode applyScanParameter(HCIHandler & hci);
+
+            /**
+             * Restarts native scanning if the adapted scan parameter differs from the current one,
+             * with kept-alive discovery applying the new one via startDiscoveryBackground().
+             */
+            void checkScanParameter();
+
+            /**
+             * Pauses kept-alive discovery for an LE connection creation if ScanScheduler::PAUSE_ON_CONNECT is enabled.
+             * @return true if paused, requiring a resumeDiscoveryAfterConnect() call
+             */
+            bool pauseDiscoveryForConnect();
+
+            /** Resumes discovery paused by pauseDiscoveryForConnect(), once all pending connections completed. */
+            void resumeDiscoveryAfterConnect();
+
+            /** Tracks the connection state of an auto-connect device, see addAutoConnectDevice(). */
+            void autoConnectChanged(const DBTDevice & device, const bool connected, const uint64_t timestamp);
+
+            /** Resumes discovery if paused for the given device's connection creation and adapts the scan parameter. */
+            void connectCompleted(const std::shared_ptr<DBTDevice> & device);
+
             void sendDeviceUpdated(std::string cause, std::shared_ptr<DBTDevice> device, uint64_t timestamp, EIRDataType updateMask);
 
         public:
@@ -306,6 +792,11 @@ namespace direct_bt {
              */
             std::string getShortName() const { return adapterInfo->getShortName(); }
 
+            /**
+             * Returns the ControllerCaps of this adapter, probed once its HCIHandler has been opened via getHCI().
+             */
+            const ControllerCaps & getControllerCaps() const { return adapterInfo->getControllerCaps(); }
+
             /**
              * Returns the local friendly name and short_name. Contains empty strings if not set.
              * <p>
@@ -348,6 +839,15 @@ namespace direct_bt {
              */
             std::shared_ptr<HCIHandler> getHCI();
 
+            /**
+             * Attaches the given DBTProfile as the default of all devices of this adapter w/o their own,
+             * see DBTDevice::setProfile(), or removes it if nullptr.
+             */
+            void setProfile(std::shared_ptr<const DBTProfile> p) { std::atomic_store(&profile, p); }
+
+            /** Returns the default DBTProfile of all devices, may be nullptr. */
+            std::shared_ptr<const DBTProfile> getProfile() const { return std::atomic_load(&profile); }
+
             /**
              * Returns true, if the adapter's device is already whitelisted.
              */
@@ -361,6 +861,11 @@ namespace direct_bt {
              * <p>
              * Method will reject duplicate devices, in which case it should be removed first.
              * </p>
+             * <p>
+             * Uses the kernel's Mgmt commands via DBTManager, managing the controller's white list for the kernel's auto-connect.
+             * HCIHandler::le_add_to_white_list() and HCIHandler::le_conn_update() issue the HCI commands directly
+             * and pipelined for bulk provisioning w/o the kernel's auto-connect.
+             * </p>
              *
              * @param address
              * @param address_type
@@ -380,6 +885,37 @@ namespace direct_bt {
             /** Remove the given device from the adapter's autoconnect whitelist. */
             bool removeDeviceFromWhitelist(const EUI48 &address, const BDAddressType address_type);
 
+            /**
+             * Adds the given LE device to the managed auto-connect set,
+             * i.e. to the controller's whitelist via addDeviceToWhitelist() using HCIWhitelistConnectType::HCI_AUTO_CONN_ALWAYS.
+             * <p>
+             * The kernel connects the device whenever it comes into range and reconnects it after each disconnect,
+             * without application driven DBTDevice::connectLE() calls.
+             * Connections are reported via AdapterStatusListener::deviceConnected() as usual,
+             * the reconnect latencies are tracked, see getAutoConnectStats().
+             * </p>
+             * <p>
+             * The controller's whitelist size limits the size of the set.
+             * </p>
+             * @return true if the device has been added or already is part of the set, otherwise false.
+             */
+            bool addAutoConnectDevice(const EUI48 &address, const BDAddressType address_type,
+                                      const uint16_t conn_interval_min=0x000F, const uint16_t conn_interval_max=0x000F,
+                                      const uint16_t conn_latency=0x0000, const uint16_t timeout=number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10);
+
+            /**
+             * Removes the given device from the auto-connect set and the controller's whitelist.
+             * An existing connection is not affected.
+             * @return true if the device was part of the set
+             */
+            bool removeAutoConnectDevice(const EUI48 &address, const BDAddressType address_type);
+
+            /** Removes all devices from the auto-connect set, returns their number. */
+            int removeAllAutoConnectDevices();
+
+            /** Returns the statistics of all devices of the auto-connect set. */
+            std::vector<AutoConnectStats> getAutoConnectStats();
+
             // device discovery aka device scanning
 
             /**
@@ -504,12 +1040,232 @@ namespace direct_bt {
              */
             std::vector<std::shared_ptr<DBTDevice>> getDiscoveredDevices() const;
 
+            /**
+             * Returns discovered devices from the last discovery as getDiscoveredDevices(),
+             * as well as the list's version for a subsequent getDiscoveredDevicesDelta().
+             */
+            std::vector<std::shared_ptr<DBTDevice>> getDiscoveredDevices(uint64_t & version) const;
+
+            /**
+             * Retrieves the discovered devices added and removed since the given version,
+             * avoiding to copy the whole list for periodic polling.
+             * <p>
+             * The version is incremented with each added or removed device, see DeviceJournal.
+             * Removed devices are retained by the bounded journal, see 'direct_bt.adapter.devices.journal'.
+             * </p>
+             * @param since the last known version, e.g. retrieved via getDiscoveredDevices(uint64_t &)
+             * @param version receives the current version
+             * @param added receives the devices added since the given version
+             * @param removed receives the devices removed since the given version
+             * @return true if the delta is available, otherwise false if the given version is no more covered,
+             *         e.g. after removeDiscoveredDevices(), and the whole list shall be retrieved again.
+             */
+            bool getDiscoveredDevicesDelta(const uint64_t since, uint64_t & version,
+                                           std::vector<std::shared_ptr<DBTDevice>> & added,
+                                           std::vector<std::shared_ptr<DBTDevice>> & removed) const;
+
             /** Discards all discovered devices. Returns number of removed discovered devices. */
             int removeDiscoveredDevices();
 
             /** Returns shared DBTDevice if found, otherwise nullptr */
             std::shared_ptr<DBTDevice> findDiscoveredDevice (EUI48 const & mac, const BDAddressType macType);
 
+            /**
+             * Sets the DiscoveryFilter applied to newly found devices before their DBTDevice gets created,
+             * replacing the previous one. An empty DiscoveryFilter disables filtering.
+             * <p>
+             * Already discovered and shared devices are not subject to the filter.
+             * </p>
+             * <p>
+             * If useWhitelist is true and the filter solely consists of LE addresses, see DiscoveryFilter::isAddressOnly(),
+             * these addresses are also added to the controller's whitelist via addDeviceToWhitelist()
+             * using HCIWhitelistConnectType::HCI_AUTO_CONN_REPORT.
+             * Addresses whitelisted by a previous filter are removed from the whitelist.
+             * </p>
+             * @return true if the filter has been set and all whitelisting succeeded, otherwise false.
+             */
+            bool setDiscoveryFilter(const DiscoveryFilter & filter, const bool useWhitelist=false);
+
+            /** Returns the current DiscoveryFilter, never nullptr. */
+            std::shared_ptr<const DiscoveryFilter> getDiscoveryFilter() const {
+                return std::atomic_load(&discoveryFilter);
+            }
+
+            /** Returns the number of connected devices. */
+            int getConnectedDeviceCount() {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
+                return static_cast<int>( connectedDevices.size() );
+            }
+
+            /** Returns the discovery state transition latencies. */
+            DiscoveryStats getDiscoveryStats() {
+                const std::lock_guard<std::mutex> lock(mtx_discoveryStats); // RAII-style acquire and relinquish via destructor
+                return discoveryStats;
+            }
+
+            /** Returns the ScanScheduler adapting the discovery's scan parameter. */
+            const ScanScheduler & getScanScheduler() const { return scanScheduler; }
+
+            /** Returns the scan parameter currently used by the discovery, adapted by the ScanScheduler. */
+            ScanParameter getCurrentScanParameter() {
+                const std::lock_guard<std::recursive_mutex> lock(mtx_discovery); // RAII-style acquire and relinquish via destructor
+                return scanCurrent;
+            }
+
+            /** Returns the DeviceEvictionPolicy of discovered and shared devices. */
+            const DeviceEvictionPolicy & getDeviceEvictionPolicy() const { return evictionPolicy; }
+
+            /**
+             * Returns a copy of all DeviceSighting of found devices not retained as DBTDevice,
+             * empty if DeviceEvictionPolicy::MAX_SIGHTINGS is disabled.
+             */
+            std::vector<DeviceSighting> getDeviceSightings() const { return sightings.getSightings(); }
+
+            /** Returns the number of DeviceSighting, see getDeviceSightings(). */
+            size_t getDeviceSightingCount() const { return sightings.size(); }
+
+            /**
+             * Returns the InternTable deduplicating the names and small ManufactureSpecificData
+             * of all devices of this adapter, see DBTDevice::AdvertisedData.
+             */
+            InternTable & getInternTable() { return internTable; }
+
+            /**
+             * Retains the DeviceSighting of the given address as a discovered DBTDevice,
+             * notifying AdapterStatusListener::deviceFound().
+             * <p>
+             * The new DBTDevice only holds the sighting's last RSSI and TX power,
+             * further data is gathered by subsequent reports.
+             * </p>
+             * @return the new DBTDevice, the already discovered or shared DBTDevice, or nullptr if neither a sighting nor a device exists.
+             */
+            std::shared_ptr<DBTDevice> retainSighting(const EUI48 & address, const BDAddressType addressType);
+
+            /**
+             * Returns the RPAResolver mapping resolvable private addresses to their identity device
+             * before any DBTDevice allocation, see 'direct_bt.adapter.rpa'.
+             * <p>
+             * It holds the IRKs of the DBTManager::getBondingKeyStore() and newly distributed ones.
+             * </p>
+             */
+            RPAResolver & getRPAResolver() { return rpaResolver; }
+
+            /**
+             * Returns the LEAdvertiser of this adapter, managing its LE extended advertising sets.
+             * <p>
+             * All advertising sets are dropped when the adapter is powered off.
+             * </p>
+             */
+            LEAdvertiser & getAdvertiser() { return advertiser; }
+
+            /**
+             * Applies the DeviceEvictionPolicy at given timestamp,
+             * removing expired and exceeding least recently updated discovered devices
+             * as well as no longer discovered and otherwise unreferenced shared devices.
+             * <p>
+             * Connected devices are never evicted.
+             * </p>
+             * @return number of evicted devices
+             */
+            int evictDevices(const uint64_t ts_now);
+
+            /**
+             * Connects all given devices using a bounded pool of concurrent pipelines,
+             * each performing DBTDevice::connectDefault(), DBTDevice::connectGATT() incl. MTU exchange
+             * and optionally DBTDevice::getGATTServices().
+             * <p>
+             * Only up to 'direct_bt.adapter.connect.pending' HCI connection creations are pending at once,
+             * respecting the controller's limit, while the GATT stages of other devices proceed concurrently.
+             * Already connected devices skip the HCI stage.
+             * </p>
+             * <p>
+             * The number of pipelines is capped via ControllerCaps::getMaxConcurrentConnections().
+             * </p>
+             * <p>
+             * Method blocks until all pipelines have completed or failed.
+             * </p>
+             * @param devices the devices to connect
+             * @param maxConcurrency maximum number of concurrent pipelines, at least one
+             * @param discoverGATT if true, the GATT services are discovered as the last stage
+             * @return one ConnectPipelineReport per given device in the same order
+             */
+            std::vector<ConnectPipelineReport> connectDevices(const std::vector<std::shared_ptr<DBTDevice>> & devices,
+                                                              const int maxConcurrency=4, const bool discoverGATT=true);
+
+            /**
+             * Enables or disables the automatic session resumption after a power cycle of this adapter,
+             * e.g. after an HCI reset.
+             * <p>
+             * If enabled, poweredOff() records all devices connected at the power off or disconnected unsolicited
+             * up to 'direct_bt.adapter.session.window' milliseconds before, see getSession().
+             * Once powered on again, the recorded session is resumed on the adapter's worker thread via resumeSession(),
+             * while the application receives the usual AdapterStatusListener events.
+             * </p>
+             */
+            void setSessionResumption(const bool enable) { sessionResumption = enable; }
+
+            /**
+             * Starts the periodic keep-alive of all connected devices via DBTDevice::ping() using the given KeepAliveMode,
+             * replacing a running keep-alive.
+             * <p>
+             * The pings are spread evenly across the given interval, i.e. one device is pinged
+             * every intervalMS divided by the number of connected devices, instead of all at once.
+             * They are scheduled on DBTManager::getTimerWheel() and performed on the adapter's worker thread.
+             * </p>
+             * <p>
+             * KeepAliveMode::RSSI and KeepAliveMode::LINK don't spend any air time,
+             * where an unreachable device is detected by the connection's supervision timeout.
+             * </p>
+             * @param mode the KeepAliveMode
+             * @param intervalMS the ping period of each device in milliseconds, at least 100
+             * @return false if intervalMS is less than 100, otherwise true
+             */
+            bool startKeepAlive(const KeepAliveMode mode, const uint32_t intervalMS);
+
+            /** Stops the periodic keep-alive, waiting for a running timer callback to complete. */
+            void stopKeepAlive();
+
+            bool isKeepAliveRunning();
+
+            bool isSessionResumptionEnabled() const { return sessionResumption; }
+
+            /**
+             * Returns the current session of all connected devices,
+             * i.e. their enabled notifications and indications and their GATTCharacteristicListener.
+             * <p>
+             * The session may be passed to resumeSession() after the devices have been disconnected,
+             * e.g. by a power cycle or re-plugging the adapter.
+             * </p>
+             */
+            DBTSession getSession();
+
+            /** Returns a copy of the session recorded at the last power off, pending its resumption. */
+            DBTSession getPendingSession();
+
+            /**
+             * Reconnects all devices of the given session in parallel via the connectDevices() pipelines,
+             * restoring each device's GATTCharacteristicListener and re-enabling its notifications and indications.
+             * <p>
+             * Devices of the auto-connect set, see addAutoConnectDevice(), are reconnected by the kernel,
+             * hence are awaited instead of connected.
+             * GATT services are restored from the GATTCache if GATTEnv::GATT_CACHE is enabled, otherwise rediscovered.
+             * Client Characteristic Configuration descriptors are written pipelined
+             * via GATTHandler::configNotificationIndication(const std::vector<GATTCharacteristicRef> &, const bool, const bool).
+             * </p>
+             * <p>
+             * Devices of another DBTAdapter instance, e.g. before re-plugging a USB adapter, are resumed
+             * via a new device instance of this adapter with the same DBTProfile.
+             * </p>
+             * <p>
+             * Method blocks until all pipelines have completed or failed.
+             * </p>
+             * @param session the session to resume
+             * @param maxConcurrency maximum number of concurrent pipelines, at least one
+             * @return one ConnectPipelineReport per session device in the same order,
+             *         ConnectPipelineReport::Stage::SESSION_RESTORED if successful
+             */
+            std::vector<ConnectPipelineReport> resumeSession(const DBTSession & session, const int maxConcurrency=4);
+
             std::string toString() const override;
 
             /**
@@ -0,0 +1,138 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_ADAPTER_GROUP_HPP_
+#define DBT_ADAPTER_GROUP_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+#include "DBTAdapter.hpp"
+
+namespace direct_bt {
+
+    /**
+     * Group of DBTAdapter, aggregating their discovery and balancing new connections across them.
+     * <p>
+     * Device sightings of all adapters are merged by address.
+     * Its AdapterStatusListener receive deviceFound() once per address of the first sighting adapter
+     * and deviceUpdated() of that adapter only, while all other notifications are forwarded from every adapter.
+     * </p>
+     * <p>
+     * A new connection is created on the adapter with the most free connection capacity
+     * which has seen the device, preferring the stronger RSSI when equal, see selectDevice().
+     * </p>
+     * <p>
+     * Controlling Environment variables:
+     * <pre>
+     * - 'direct_bt.group.connections.max': Connection capacity per adapter, defaults to 5.
+     * </pre>
+     * </p>
+     */
+    class DBTAdapterGroup {
+        private:
+            class GroupListener; // forward
+
+            /** Sightings of one address by each adapter */
+            struct Sighting {
+                /** Index of the first sighting adapter, owning deviceFound() and deviceUpdated() */
+                int primary;
+                std::vector<std::weak_ptr<DBTDevice>> devices;
+            };
+
+            std::vector<std::shared_ptr<DBTAdapter>> adapters;
+            std::vector<std::shared_ptr<GroupListener>> groupListeners;
+            COWVector<std::shared_ptr<AdapterStatusListener>> statusListenerList;
+            std::unordered_map<BDAddressKey, Sighting> sightings;
+            std::mutex mtx_sightings;
+
+            void deviceFound(const int adapterIdx, std::shared_ptr<DBTDevice> device, const uint64_t timestamp);
+            bool isPrimary(const int adapterIdx, const DBTDevice & device);
+
+            DBTAdapterGroup(const DBTAdapterGroup&) = delete;
+            void operator=(const DBTAdapterGroup&) = delete;
+
+        public:
+            /** Connection capacity per adapter */
+            const int32_t MAX_CONNECTIONS;
+
+            /** Creates a group of the given valid adapters. */
+            DBTAdapterGroup(const std::vector<std::shared_ptr<DBTAdapter>> & adapters);
+
+            /** Creates a group of all adapters known to the given DBTManager. */
+            DBTAdapterGroup(DBTManager & mgmt);
+
+            /** Removes the group's listener from all adapters. */
+            ~DBTAdapterGroup();
+
+            const std::vector<std::shared_ptr<DBTAdapter>> & getAdapters() const { return adapters; }
+
+            /** Add the given listener to the group, see class description. */
+            bool addStatusListener(std::shared_ptr<AdapterStatusListener> l);
+
+            bool removeStatusListener(const AdapterStatusListener * l);
+
+            /**
+             * Starts the discovery on all adapters, see DBTAdapter::startDiscovery().
+             * @return number of adapters with started discovery
+             */
+            int startDiscovery(const bool keepAlive=true, const HCILEOwnAddressType own_mac_type=HCILEOwnAddressType::PUBLIC,
+                               const uint16_t le_scan_interval=48, const uint16_t le_scan_window=48);
+
+            /** Stops the discovery on all adapters, returns the number of adapters with stopped discovery. */
+            int stopDiscovery();
+
+            /** Returns the number of distinct addresses sighted by any adapter. */
+            size_t getSightingCount();
+
+            /**
+             * Returns the device of the adapter best suited for a new connection to the given address,
+             * or the device of the adapter already connected to it. Returns nullptr if no adapter has sighted it.
+             * <p>
+             * Adapters at MAX_CONNECTIONS are only chosen if no other adapter sighted the device.
+             * </p>
+             */
+            std::shared_ptr<DBTDevice> selectDevice(const EUI48 & address, const BDAddressType addressType);
+
+            /**
+             * Creates an LE connection to the given address on the adapter chosen by selectDevice(),
+             * see DBTDevice::connectDefault().
+             */
+            HCIStatusCode connect(const EUI48 & address, const BDAddressType addressType);
+
+            /** Returns the total number of connected devices of all adapters. */
+            int getConnectedDeviceCount();
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* DBT_ADAPTER_GROUP_HPP_ */
@@ -0,0 +1,318 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_BROKER_HPP_
+#define DBT_BROKER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+#include "BTAddress.hpp"
+#include "BTTypes.hpp"
+#include "OctetTypes.hpp"
+#include "GATTCharacteristic.hpp"
+
+namespace direct_bt {
+
+    class HCIHandler; // forward
+
+    /**
+     * Shared memory layout of the broker ring, see DBTBrokerPublisher.
+     * <p>
+     * One publisher process writes records into a broadcast ring of fixed size slots,
+     * which any number of client processes map read-only.
+     * Each client keeps its own read position, i.e. the publisher never waits for clients
+     * and a client lagging more than the ring's capacity loses the overwritten records.
+     * </p>
+     * <p>
+     * Producer threads claim record number <code>n</code> via Header::writeCount.
+     * Each slot carries a sequence number, odd while being written and <code>2*n+2</code>
+     * after record <code>n</code> has been written (seqlock).
+     * A client validates the sequence before and after copying a record,
+     * detecting a not yet completed or a concurrent overwrite w/o writing to the shared memory.
+     * </p>
+     */
+    class DBTBrokerRing {
+        public:
+            enum Defaults : int32_t {
+                /** Maximum record data size, larger values are truncated, see Record::origLength. */
+                SLOT_DATA_SIZE = 248,
+                MAGIC = 0x44425442, // 'DBTB'
+                VERSION = 1
+            };
+
+            enum class RecordType : uint8_t {
+                NONE = 0,
+                /** Advertising sighting, data holds the AD/EIR fields re-encoded from the EInfoReport. */
+                ADV_SIGHTING = 1,
+                /** GATT notification, data holds the characteristic value. */
+                GATT_NOTIFICATION = 2,
+                /** GATT indication, data holds the characteristic value. */
+                GATT_INDICATION = 3
+            };
+
+            struct Record {
+                /** Monotonic timestamp in milliseconds, see getCurrentMilliseconds(). */
+                uint64_t timestamp;
+                EUI48 address;
+                /** BDAddressType */
+                uint8_t addressType;
+                RecordType type;
+                /** Characteristic value handle of a GATT record. */
+                uint16_t handle;
+                /** RSSI of an advertising sighting. */
+                int8_t rssi;
+                /** AD_PDU_Type of an advertising sighting. */
+                uint8_t evtType;
+                /** Original data length before truncation to SLOT_DATA_SIZE. */
+                uint16_t origLength;
+                uint16_t length;
+                uint8_t data[SLOT_DATA_SIZE];
+
+                BDAddressType getAddressType() const { return static_cast<BDAddressType>(addressType); }
+
+                /** Returns a view of the record's data. */
+                TROOctets getData() const { return TROOctets(data, length); }
+
+                /** Decodes the data of an ADV_SIGHTING record into the given EInfoReport, returning the number of fields. */
+                int decode(EInfoReport & eir) const;
+
+                std::string toString() const;
+            };
+
+            struct Slot {
+                std::atomic<uint64_t> sequence;
+                Record record;
+            };
+
+            struct Header {
+                uint32_t magic;
+                uint32_t version;
+                uint32_t slotCount;
+                uint32_t slotSize;
+                /** Number of claimed records, i.e. the next record number. */
+                std::atomic<uint64_t> writeCount;
+                /** Futex word of waiting clients, incremented after each publish call. */
+                std::atomic<int> futexWord;
+                uint32_t reserved;
+            };
+            static_assert(sizeof(std::atomic<int>) == sizeof(int), "std::atomic<int> not usable as futex word");
+            static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "std::atomic<uint64_t> not lock-free");
+
+            /** Returns the shared memory size of the given slot count. */
+            static size_t getMapSize(const uint32_t slotCount) {
+                return sizeof(Header) + slotCount * sizeof(Slot);
+            }
+    };
+
+    /**
+     * Broker mode publisher, sharing advertising sightings and GATT notifications
+     * of this direct_bt process with other processes via a shared memory ring, see DBTBrokerRing.
+     * <p>
+     * Only one process can own the HCI user channel and Mgmt socket,
+     * hence this process publishes what others subscribe to via DBTBrokerClient
+     * w/o any socket fan-out per record.
+     * </p>
+     * <p>
+     * The ring is a sealed memfd, handed to each connecting client via SCM_RIGHTS
+     * over a unix domain socket at the given path, served by a background thread.
+     * Sealing with F_SEAL_FUTURE_WRITE, if supported by the kernel, prevents clients from mapping it writable.
+     * </p>
+     * <p>
+     * Publishing is thread safe and never blocks. Read-only clients cannot announce waiting,
+     * hence each publish call issues one futex wake-up, i.e. once per advertising report batch.
+     * </p>
+     * <p>
+     * Controlling Environment variables:
+     * <pre>
+     * - 'direct_bt.broker.slots': Number of ring slots, rounded up to a power of two, defaults to 1024.
+     * </pre>
+     * </p>
+     */
+    class DBTBrokerPublisher {
+        private:
+            const std::string path;
+            const uint32_t slotCount;
+            int memfd;
+            int serverSocket;
+            size_t mapSize;
+            uint8_t * map;
+            DBTBrokerRing::Header * header;
+            DBTBrokerRing::Slot * slots;
+            uint64_t slotMask;
+            std::atomic<uint64_t> clientCount;
+            std::atomic<bool> running;
+            std::thread serverThread;
+            HCIHandler * hci;
+
+            class NotificationListener : public GATTCharacteristicValueListener {
+                private:
+                    DBTBrokerPublisher & publisher;
+                public:
+                    NotificationListener(DBTBrokerPublisher & p) : publisher(p) {}
+
+                    void notificationValueReceived(GATTCharacteristicRef charDecl,
+                                                   const TROOctets & charValue, const uint64_t timestamp) override;
+                    void indicationValueReceived(GATTCharacteristicRef charDecl,
+                                                 const TROOctets & charValue, const uint64_t timestamp,
+                                                 const bool confirmationSent) override;
+            };
+            std::shared_ptr<NotificationListener> notificationListener;
+
+            /** Claims the next slot, marked as being written, returning its record number in n. */
+            DBTBrokerRing::Slot & claim(uint64_t & n);
+            void commit(DBTBrokerRing::Slot & slot, const uint64_t n);
+            void encode(const EInfoReport & eir);
+            void wake();
+
+            bool advertisingReportBatchHCI(const EInfoReportBatch & batch);
+            void serverImpl();
+
+            DBTBrokerPublisher(const DBTBrokerPublisher&) = delete;
+            void operator=(const DBTBrokerPublisher&) = delete;
+
+        public:
+            /**
+             * Creates the shared memory ring and starts serving clients at the given unix domain socket path.
+             * <p>
+             * An existing file at path is replaced.
+             * </p>
+             * @param path unix domain socket path clients connect to
+             * @param slotCount number of ring slots, rounded up to a power of two, zero for the environment default
+             * @throws InternalError if the ring or socket could not be created
+             */
+            DBTBrokerPublisher(const std::string & path, const uint32_t slotCount=0);
+
+            /** Stops serving, detaches from the HCIHandler and unmaps the ring. Mapped clients keep their mapping. */
+            ~DBTBrokerPublisher();
+
+            const std::string & getPath() const { return path; }
+            uint32_t getSlotCount() const { return slotCount; }
+
+            /** Returns the number of published records. */
+            uint64_t getWriteCount() const { return header->writeCount.load(); }
+
+            /** Returns the number of clients served the ring so far. */
+            uint64_t getClientCount() const { return clientCount.load(); }
+
+            /**
+             * Publishes all advertising reports of the given HCIHandler via its AdvertisingReportBatchCallback,
+             * replacing a previous attachment.
+             */
+            void attach(HCIHandler & hci);
+
+            /** Stops publishing advertising reports of the attached HCIHandler, if any. */
+            void detach();
+
+            /**
+             * Returns the GATTCharacteristicListener publishing all notifications and indications,
+             * to be added to each connected DBTDevice via DBTDevice::addCharacteristicListener().
+             */
+            std::shared_ptr<GATTCharacteristicListener> getNotificationListener() const { return notificationListener; }
+
+            /**
+             * Publishes the given advertising reports, issuing one wake-up.
+             * <p>
+             * Each report is re-encoded into AD/EIR fields via ADWriter, see DBTBrokerRing::Record::decode().
+             * </p>
+             */
+            void publish(const EInfoReportBatch & batch);
+
+            /** Publishes the given advertising report. */
+            void publish(const EInfoReport & eir);
+
+            /** Publishes the given GATT notification or indication value. */
+            void publish(const EUI48 & address, const BDAddressType addressType, const uint16_t handle,
+                         const TROOctets & value, const uint64_t timestamp, const bool indication);
+
+            std::string toString() const;
+    };
+
+    /**
+     * Broker mode client, mapping the shared memory ring of a DBTBrokerPublisher read-only.
+     * <p>
+     * Reading a record never enters the kernel unless waiting for new records
+     * and copies at most one slot from the mapping, validated against a concurrent overwrite.
+     * </p>
+     * <p>
+     * A new client starts reading at the most recent published record.
+     * Records overwritten before being read are counted, see getLostCount().
+     * </p>
+     * <p>
+     * Each instance is used by one thread only.
+     * </p>
+     */
+    class DBTBrokerClient {
+        private:
+            int memfd;
+            size_t mapSize;
+            const uint8_t * map;
+            const DBTBrokerRing::Header * header;
+            const DBTBrokerRing::Slot * slots;
+            uint64_t slotMask;
+            /** Next record number to read. */
+            uint64_t readPos;
+            uint64_t readCount;
+            uint64_t lostCount;
+
+            DBTBrokerClient(const DBTBrokerClient&) = delete;
+            void operator=(const DBTBrokerClient&) = delete;
+
+        public:
+            /**
+             * Connects to the DBTBrokerPublisher at the given unix domain socket path and maps its ring.
+             * @throws InternalError if connecting, receiving or mapping the ring failed, or the ring is incompatible
+             */
+            DBTBrokerClient(const std::string & path);
+
+            ~DBTBrokerClient();
+
+            uint32_t getSlotCount() const { return header->slotCount; }
+
+            /** Returns the number of published records available for reading. */
+            uint64_t getAvailable() const;
+
+            /** Returns the number of records overwritten before being read. */
+            uint64_t getLostCount() const { return lostCount; }
+
+            /** Returns the number of read records. */
+            uint64_t getReadCount() const { return readCount; }
+
+            /**
+             * Copies the next record into dest, waiting for it up to the given timeout.
+             * @param dest the destination record
+             * @param timeoutMS zero for no waiting, negative for waiting infinitely
+             * @return true if a record has been read, otherwise false on timeout
+             */
+            bool next(DBTBrokerRing::Record & dest, const int timeoutMS=0);
+    };
+
+} // namespace direct_bt
+
+#endif /* DBT_BROKER_HPP_ */
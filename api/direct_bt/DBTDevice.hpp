@@ -40,6 +40,9 @@
 #include "HCIComm.hpp"
 
 #include "GATTHandler.hpp"
+#include "DBTProfile.hpp"
+#include "DBTMutex.hpp"
+#include "InternTable.hpp"
 
 namespace direct_bt {
 
@@ -49,52 +52,138 @@ namespace direct_bt {
 
     class DBTAdapter; // forward
 
+    /**
+     * Outcome of DBTDevice::connectAndOpenGATT(), holding the time spent in each step in microseconds.
+     */
+    class GATTOpenReport {
+        public:
+            /** HCIStatusCode of the LE connection */
+            HCIStatusCode status = HCIStatusCode::UNKNOWN;
+            /** The connected GATTHandler, nullptr on failure */
+            std::shared_ptr<GATTHandler> gatt;
+            /** DBTDevice::connectLE() until the LE connection completed */
+            uint64_t hciConnectUS = 0;
+            /** LE connection completed until the GATTHandler's L2CAP connect started */
+            uint64_t dispatchUS = 0;
+            /** L2CAP open, see GATTHandler::getConnectL2CAPTime() */
+            uint64_t l2capConnectUS = 0;
+            /** MTU exchange, see GATTHandler::getConnectMTUTime() */
+            uint64_t mtuExchangeUS = 0;
+            uint64_t totalUS = 0;
+
+            std::string toString() const;
+    };
+
     class DBTDevice : public DBTObject
     {
         friend DBTAdapter; // managing us: ctor and update(..) during discovery
         friend GATTHandler; // may issue detailed disconnect(..)
 
+        public:
+            /**
+             * Immutable snapshot of the advertised device data as recognized at discovery, connect and GATT discovery.
+             * <p>
+             * Updates publish a new snapshot, hence a retrieved instance stays consistent
+             * and may be read without locking.
+             * </p>
+             * <p>
+             * The name and small ManufactureSpecificData are interned via DBTAdapter::getInternTable(),
+             * i.e. shared by all devices and snapshots carrying equal values and compared by pointer.
+             * </p>
+             */
+            class AdvertisedData {
+                public:
+                    /** Interned name, never nullptr */
+                    InternTable::StringRef name = InternTable::getEmptyString();
+                    int8_t rssi = 127; // The core spec defines 127 as the "not available" value
+                    /** Smoothed RSSI, see RSSIHistory */
+                    int8_t rssi_smoothed = 127;
+                    int8_t tx_power = 127; // The core spec defines 127 as the "not available" value
+                    AppearanceCat appearance = AppearanceCat::UNKNOWN;
+                    std::shared_ptr<ManufactureSpecificData> msd = nullptr;
+                    std::vector<uuid_value_t> services;
+
+                    /** Find advertised service (GAP discovery) index, returns index >= 0 if found, otherwise -1. */
+                    int findService(uuid_value_t const &uuid) const;
+            };
+
         private:
             DBTAdapter & adapter;
-            uint64_t ts_last_discovery;
-            uint64_t ts_last_update;
-            std::string name;
-            int8_t rssi = 127; // The core spec defines 127 as the "not available" value
-            int8_t tx_power = 127; // The core spec defines 127 as the "not available" value
-            AppearanceCat appearance = AppearanceCat::UNKNOWN;
+            std::atomic<uint64_t> ts_last_discovery;
+            std::atomic<uint64_t> ts_last_update;
+            /** Link establishment timestamp in microseconds until GATT is connected, zero otherwise */
+            std::atomic<uint64_t> ts_connected_us;
             std::atomic<uint16_t> hciConnHandle;
-            std::shared_ptr<ManufactureSpecificData> advMSD = nullptr;
-            std::vector<std::shared_ptr<uuid_t>> advServices;
+            /** Copy-on-write AdvertisedData, published via std::atomic_store() while holding mtx_data */
+            std::shared_ptr<const AdvertisedData> advData;
+            /** RSSI samples, guarded by mtx_data */
+            RSSIHistory rssiHistory;
+            /** Advertising interval estimation from discovery timestamps, guarded by mtx_data */
+            AdvIntervalEstimator advInterval;
+            /** Smoothed RSSI at the last notified RSSI update, guarded by mtx_data */
+            int8_t rssi_notified = RSSIHistory::RSSI_NONE;
             std::shared_ptr<GATTHandler> gattHandler = nullptr;
             std::shared_ptr<GenericAccess> gattGenericAccess = nullptr;
-            std::recursive_mutex mtx_connect;
-            std::recursive_mutex mtx_data;
-            std::recursive_mutex mtx_gatt;
+            /** Own DBTProfile, published via std::atomic_store(), may be nullptr */
+            std::shared_ptr<const DBTProfile> profile = nullptr;
+            DBTRecursiveMutex mtx_connect { "device_connect" };
+            DBTRecursiveMutex mtx_data { "device_data" };
+            DBTRecursiveMutex mtx_gatt { "device_gatt" };
             std::atomic<bool> isConnected;
             /** atomic: allowDisconnect = isConnected || 'isConnectIssued' */
             std::atomic<bool> allowDisconnect;
+            /** atomic: kept-alive discovery has been paused for this device's connection creation, see DBTAdapter::pauseDiscoveryForConnect() */
+            std::atomic<bool> discoveryPaused;
             DBTDevice(DBTAdapter & adapter, EInfoReport const & r);
 
-            /** Add advertised service (GAP discovery) */
-            bool addAdvService(std::shared_ptr<uuid_t> const &uuid);
-            /** Add advertised service (GAP discovery) */
-            bool addAdvServices(std::vector<std::shared_ptr<uuid_t>> const & services);
+            /** Add advertised services (GAP discovery) to the given unpublished AdvertisedData */
+            static bool addAdvServices(AdvertisedData & ad, std::vector<uuid_value_t> const & services);
+
             /**
-             * Find advertised service (GAP discovery) index
-             * @return index >= 0 if found, otherwise -1
+             * Adds the given RSSI sample to rssiHistory, caller shall hold mtx_data.
+             * @param changed true if the RSSI differs from the current one
+             * @return true if an RSSI update shall be notified, i.e. changed or the smoothed RSSI
+             *         passed HCIEnv::HCI_RSSI_DELTA since its last notification if enabled.
              */
-            int findAdvService(std::shared_ptr<uuid_t> const &uuid) const;
+            bool addRSSISample(const uint64_t timestamp, const int8_t rssi, const bool changed);
 
-            EIRDataType update(EInfoReport const & data);
+            /** Publishes the given AdvertisedData, caller shall hold mtx_data. */
+            void setAdvertisedData(std::shared_ptr<const AdvertisedData> ad) { std::atomic_store(&advData, ad); }
+
+            /** Updates this device with the given report, movable is either nullptr or the solely owned data. */
+            EIRDataType update(EInfoReport const & data, EInfoReport * movable);
+            EIRDataType update(EInfoReport const & data) { return update(data, nullptr); }
+            /**
+             * Updates this device with the given solely owned report,
+             * moving the changed name, ManufactureSpecificData and services instead of copying them.
+             */
+            EIRDataType update(EInfoReport && data) { return update(data, &data); }
             EIRDataType update(GenericAccess const &data, const uint64_t timestamp);
 
             void releaseSharedInstance() const;
             void notifyDisconnected();
             void notifyConnected(const uint16_t handle);
 
+            /** Pending connectAndOpenGATT(), guarded by mtx_gattOpen */
+            std::mutex mtx_gattOpen;
+            std::shared_ptr<std::promise<GATTOpenReport>> gattOpenPromise;
+            uint16_t gattOpenClientMTU = 0;
+            uint64_t gattOpenT0 = 0;
+            /** Chains the established LE connection into connectGATT() of a pending connectAndOpenGATT() on its own thread. */
+            void openPendingGATT();
+
+            /** Reads the GenericAccess of the discovered services, updating this device. Caller shall hold mtx_gatt. */
+            void readGATTGenericAccess(std::vector<GATTServiceRef> & gattServices);
+            /** Completes a pending connectAndOpenGATT() with the given failure status. */
+            void failPendingGATT(const HCIStatusCode status);
+
             HCIStatusCode disconnect(const bool fromDisconnectCB, const bool ioErrorCause,
                                      const HCIStatusCode reason=HCIStatusCode::REMOTE_USER_TERMINATED_CONNECTION );
 
+            /** Applies the given LE link profile, see optimizeForThroughput() and optimizeForLatency(). */
+            HCIStatusCode optimizeLink(const char * profile, const bool maxDataLength,
+                                       const uint16_t conn_interval_min, const uint16_t conn_interval_max);
+
         public:
             const uint64_t ts_creation;
             /** Device mac address */
@@ -166,19 +255,39 @@ namespace direct_bt {
              */
             BLERandomAddressType getBLERandomAddressType() const { return leRandomAddressType; }
 
+            /**
+             * Returns the current immutable AdvertisedData snapshot, never nullptr.
+             * <p>
+             * Lock-free, use a single snapshot for a consistent view on multiple fields.
+             * </p>
+             */
+            std::shared_ptr<const AdvertisedData> getAdvertisedData() const { return std::atomic_load(&advData); }
+
             /** Return RSSI of device as recognized at discovery and connect. */
-            int8_t getRSSI() const { return rssi; }
+            int8_t getRSSI() const { return getAdvertisedData()->rssi; }
+
+            /** Return the smoothed RSSI of device, see RSSIHistory and HCIEnv::HCI_RSSI_WEIGHT. */
+            int8_t getSmoothedRSSI() const { return getAdvertisedData()->rssi_smoothed; }
+
+            /** Return a copy of the recent RSSI samples, oldest first, see RSSIHistory::CAPACITY. */
+            std::vector<RSSIHistory::Sample> getRSSIHistory() const;
+
+            /**
+             * Return the estimated advertising interval in milliseconds from this device's discovery timestamps,
+             * or zero if unknown, see AdvIntervalEstimator and connectLEAuto().
+             */
+            uint32_t getAdvertisingInterval() const;
 
             /** Return Tx Power of device as recognized at discovery and connect. */
-            int8_t getTxPower() const { return tx_power; }
+            int8_t getTxPower() const { return getAdvertisedData()->tx_power; }
 
             /** Return AppearanceCat of device as recognized at discovery, connect and GATT discovery. */
-            AppearanceCat getAppearance() const { return appearance; }
+            AppearanceCat getAppearance() const { return getAdvertisedData()->appearance; }
 
-            std::string const getName() const;
+            std::string const getName() const { return *getAdvertisedData()->name; }
 
             /** Return shared ManufactureSpecificData as recognized at discovery, pre GATT discovery. */
-            std::shared_ptr<ManufactureSpecificData> const getManufactureSpecificData() const;
+            std::shared_ptr<ManufactureSpecificData> const getManufactureSpecificData() const { return getAdvertisedData()->msd; }
 
             /**
              * Return a list of advertised services as recognized at discovery, pre GATT discovery.
@@ -187,7 +296,7 @@ namespace direct_bt {
              * use {@link #getGATTServices()}.
              * </p>
              */
-            std::vector<std::shared_ptr<uuid_t>> getAdvertisedServices() const;
+            std::vector<uuid_value_t> getAdvertisedServices() const { return getAdvertisedData()->services; }
 
             std::string toString() const override { return toString(false); }
 
@@ -246,6 +355,25 @@ namespace direct_bt {
                                     const uint16_t conn_interval_min=0x000F, const uint16_t conn_interval_max=0x000F,
                                     const uint16_t conn_latency=0x0000, const uint16_t supervision_timeout=number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10);
 
+            /**
+             * Establish a HCI BDADDR_LE_PUBLIC or BDADDR_LE_RANDOM connection to this device
+             * via connectLE(), using the LE scan interval and window minimizing the expected connect latency
+             * for this device's estimated advertising interval.
+             * <p>
+             * The scan window equals the scan interval, i.e. scans continuously,
+             * and covers one advertising interval plus advDelay, see AdvIntervalEstimator::getConnectScanWindow().
+             * Without an estimate, see getAdvertisingInterval(), the connectLE() defaults are used.
+             * </p>
+             *
+             * @param conn_interval_min in units of 1.25ms, default value 15 for 19.75ms
+             * @param conn_interval_max in units of 1.25ms, default value 15 for 19.75ms
+             * @param conn_latency slave latency in units of connection events, default value 0
+             * @param supervision_timeout in units of 10ms, default value 1000 for 10000ms or 10s.
+             * @return HCIStatusCode::SUCCESS if the command has been accepted, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode connectLEAuto(const uint16_t conn_interval_min=0x000F, const uint16_t conn_interval_max=0x000F,
+                                        const uint16_t conn_latency=0x0000, const uint16_t supervision_timeout=number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10);
+
             /**
              * Establish a HCI BDADDR_BREDR connection to this device.
              * <p>
@@ -290,6 +418,50 @@ namespace direct_bt {
              */
             HCIStatusCode connectDefault();
 
+            /**
+             * Attaches the given DBTProfile to this device, overriding its adapter's profile and the global defaults,
+             * or removes it if nullptr.
+             * <p>
+             * Applies with the next connectDefault() and connectGATT().
+             * </p>
+             */
+            void setProfile(std::shared_ptr<const DBTProfile> p) { std::atomic_store(&profile, p); }
+
+            /** Returns this device's own DBTProfile, may be nullptr. */
+            std::shared_ptr<const DBTProfile> getProfile() const { return std::atomic_load(&profile); }
+
+            /** Returns this device's own DBTProfile if set, otherwise its adapter's DBTProfile, may be nullptr. */
+            std::shared_ptr<const DBTProfile> getEffectiveProfile() const;
+
+
+            /**
+             * Tunes the established LE connection for bulk transfer throughput.
+             * <p>
+             * Requests the controller's maximum LL PDU size via HCIHandler::le_set_data_length(), see ControllerCaps::getDataLenTxOctets(),
+             * the LE 2M PHY via HCIHandler::le_set_phy()
+             * and a short connection interval of [7.5..15]ms w/o slave latency via HCIHandler::le_conn_update().
+             * </p>
+             * <p>
+             * Steps not supported by the local controller are skipped.
+             * The link layer applies the new parameter asynchronously, as negotiated with the peer.
+             * </p>
+             * @return HCIStatusCode::SUCCESS if all supported requests have been accepted, otherwise the first failed HCIStatusCode.
+             */
+            HCIStatusCode optimizeForThroughput();
+
+            /**
+             * Tunes the established LE connection for minimum round-trip latency.
+             * <p>
+             * Requests the LE 2M PHY via HCIHandler::le_set_phy() for shorter air time
+             * and the minimum connection interval of 7.5ms w/o slave latency via HCIHandler::le_conn_update().
+             * </p>
+             * <p>
+             * Steps not supported by the local controller are skipped.
+             * The link layer applies the new parameter asynchronously, as negotiated with the peer.
+             * </p>
+             * @return HCIStatusCode::SUCCESS if all supported requests have been accepted, otherwise the first failed HCIStatusCode.
+             */
+            HCIStatusCode optimizeForLatency();
 
             /** Return the HCI connection handle to the LE or BREDR peer, zero if not connected. */
             uint16_t getConnectionHandle() const { return hciConnHandle; }
@@ -345,12 +517,58 @@ namespace direct_bt {
              * and closed @ disconnect() or explicitly @ disconnectGATT().
              * May return nullptr if not connected or failure.
              * </p>
+             * @param clientMTU requested client ATT_MTU in the range [23..512], zero to use GATTEnv::GATT_CLIENT_MTU (default).
+             *        Only used if a new GATT connection is established.
+             */
+            std::shared_ptr<GATTHandler> connectGATT(const uint16_t clientMTU=0);
+
+            /**
+             * Establishes the LE connection via connectLE() and chains its completion directly into connectGATT(),
+             * i.e. the L2CAP open and MTU exchange.
+             * <p>
+             * Returns immediately. The GATT connect is started by the LE connection complete event
+             * on a dedicated thread, i.e. w/o a user thread waiting for AdapterStatusListener::deviceConnected()
+             * and w/o blocking the HCI event reader.
+             * </p>
+             * <p>
+             * The returned future is satisfied w/ the GATTOpenReport,
+             * immediately if connectLE() has been rejected,
+             * otherwise once the GATT connect completed or the LE connection failed.
+             * If the controller reports neither, e.g. on a lost event, the future is not satisfied,
+             * hence callers shall use a bounded wait.
+             * </p>
+             * <p>
+             * A new request replaces a still pending one, which is completed w/ HCIStatusCode::UNSPECIFIED_ERROR.
+             * </p>
+             * @param clientMTU requested client ATT_MTU, see connectGATT()
              */
-            std::shared_ptr<GATTHandler> connectGATT();
+            std::future<GATTOpenReport> connectAndOpenGATT(const uint16_t clientMTU=0);
+
+            /**
+             * Cancels a pending connectGATT(..) from another thread,
+             * i.e. its L2CAP connect fails promptly instead of waiting for GATTEnv::GATT_L2CAP_CONNECT_TIMEOUT.
+             * <p>
+             * Doesn't wait for the GATT lock held by connectGATT(..), no-op if no connect is pending.
+             * </p>
+             */
+            void cancelConnectGATT();
 
             /** Returns already opened GATTHandler, see connectGATT(..) and disconnectGATT(). */
             std::shared_ptr<GATTHandler> getGATTHandler();
 
+            /**
+             * Copies the traffic accounting of this device's connection into res,
+             * i.e. ATT PDUs and bytes in and out per opcode, notifications, retries, timeouts and round-trip times.
+             * <p>
+             * Allows to identify peripherals saturating a shared adapter.
+             * </p>
+             * @param res the snapshot to be filled
+             * @param link if true, the link level counters of the tracked HCIConnection, see HCIHandler::getTrafficSnapshot(),
+             *        otherwise the counters of the opened GATTHandler, see GATTHandler::getTrafficStats().
+             * @return true if the connection exists and res has been filled, otherwise false
+             */
+            bool getTrafficSnapshot(TrafficSnapshot & res, const bool link=false);
+
             /**
              * Returns a list of shared GATTService available on this device if successful,
              * otherwise returns an empty list if an error occurred.
@@ -361,6 +579,10 @@ namespace direct_bt {
              * In case no GATT connection has been established yet or disconnectGATT() has been called thereafter,
              * connectGATT(..) will be performed.
              * </p>
+             * <p>
+             * After a discovery the GenericAccess service values are read and applied to this device,
+             * unless GATTEnv::GATT_GENERIC_ACCESS_LAZY defers them to getGATTGenericAccess().
+             * </p>
              */
             std::vector<std::shared_ptr<GATTService>> getGATTServices();
 
@@ -372,7 +594,12 @@ namespace direct_bt {
              */
             std::shared_ptr<GATTService> findGATTService(std::shared_ptr<uuid_t> const &uuid);
 
-            /** Returns the shared GenericAccess instance, retrieved by {@link #getGATTServices()} or nullptr if not available. */
+            /**
+             * Returns the shared GenericAccess instance, retrieved by {@link #getGATTServices()} or nullptr if not available.
+             * <p>
+             * With GATTEnv::GATT_GENERIC_ACCESS_LAZY, the GenericAccess is read by the first call after a discovery.
+             * </p>
+             */
             std::shared_ptr<GenericAccess> getGATTGenericAccess();
 
             /**
@@ -389,9 +616,24 @@ namespace direct_bt {
              * GATT services must have been initialized via {@link #getGATTServices()}, otherwise {@code false} is being returned.
              * </p>
              * @return {@code true} if successful, otherwise false in case no GATT services exists or is not connected .. etc.
+             * @see ping()
              */
             bool pingGATT();
 
+            /**
+             * Validates whether the connected device is still reachable using the given KeepAliveMode.
+             * <p>
+             * KeepAliveMode::GATT issues pingGATT(), while KeepAliveMode::RSSI and KeepAliveMode::LINK
+             * only use controller level state w/o any air time, relying on the connection's supervision timeout.
+             * </p>
+             * <p>
+             * In case the controller reports the connection handle as unknown, a disconnect will be issued.
+             * </p>
+             * @return true if the device is still connected, otherwise false
+             * @see DBTAdapter::startKeepAlive()
+             */
+            bool ping(const KeepAliveMode mode);
+
             /**
              * Explicit disconnecting an open GATTHandler, which is usually performed via disconnect()
              * <p>
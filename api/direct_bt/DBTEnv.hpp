@@ -78,7 +78,8 @@ namespace direct_bt {
             }
 
             /**
-             * Returns the value of the environment's variable 'name'.
+             * Returns the value of the property 'name' set via setProperty() or getExplodingProperties(),
+             * otherwise the value of the environment's variable 'name'.
              * <p>
              * Note that only '[org.]tinyb.*' and 'direct_bt.*' Java JVM properties are passed via 'org.tinyb.BluetoothFactory'
              * </p>
@@ -129,6 +130,28 @@ namespace direct_bt {
             static uint32_t getUint32Property(const std::string & name, const uint32_t default_value,
                                               const uint32_t min_allowed=0, const uint32_t max_allowed=UINT32_MAX);
 
+            /** Listener of properties changed via setProperty(), see addPropertyListener(). */
+            typedef void (*PropertyListener)(const std::string & name);
+
+            /**
+             * Sets the property 'name' to the given value at runtime, overriding the environment's variable 'name',
+             * and notifies all PropertyListener, allowing to tune a running process w/o restart.
+             * <p>
+             * HCIEnv, GATTEnv and MgmtEnv reload their runtime adjustable properties,
+             * applied to live handlers where safe, e.g. timeouts with the next command.
+             * Capacities are applied to handlers created thereafter, e.g. the next GATT connection.
+             * All other properties are only read once at startup.
+             * </p>
+             * <p>
+             * The environment itself is not modified, i.e. it is safe to call concurrently with getProperty().
+             * </p>
+             * @return true if the property has been set, otherwise false if the name is empty or contains '='
+             */
+            static bool setProperty(const std::string & name, const std::string & value);
+
+            /** Adds the given PropertyListener, notified by setProperty(). */
+            static void addPropertyListener(PropertyListener l);
+
             /**
              * Fetches exploding variable-name (prefixDomain) values.
              * <p>
@@ -226,6 +249,117 @@ namespace direct_bt {
             const bool VERBOSE;
     };
 
+    /**
+     * Scheduling options of one reader thread type,
+     * read from the environment variables below the given property prefix.
+     * <p>
+     * Example for prefix 'direct_bt.hci.reader':
+     * <pre>
+     *   "direct_bt.hci.reader.sched.fifo" := "50"
+     *   "direct_bt.hci.reader.cpus"       := "2:3"
+     *   "direct_bt.hci.reader.name"       := "dbt_hci"
+     * </pre>
+     * </p>
+     */
+    class DBTThreadOptions {
+        public:
+            /**
+             * SCHED_FIFO priority, defaults to 0 for the default SCHED_OTHER policy.
+             * <p>
+             * Environment variable is '<prefix>.sched.fifo', range [1..99] enables SCHED_FIFO.
+             * </p>
+             */
+            const int32_t FIFO_PRIORITY;
+
+            /**
+             * CPU affinity set as list of cpu indices or ranges, e.g. '0:2-3', defaults to empty for no affinity.
+             * <p>
+             * List elements are separated by colon ':' or comma ','.
+             * The colon shall be used within exploded properties, see DBTEnv::getExplodingProperties().
+             * </p>
+             * <p>
+             * Environment variable is '<prefix>.cpus'.
+             * </p>
+             */
+            const std::string CPU_AFFINITY;
+
+            /**
+             * Thread name, truncated to 15 characters.
+             * <p>
+             * Environment variable is '<prefix>.name'.
+             * </p>
+             */
+            const std::string NAME;
+
+            DBTThreadOptions(const std::string & prefix, const std::string & defaultName);
+
+            /**
+             * Applies these options to the calling thread.
+             * <p>
+             * Failures, e.g. missing CAP_SYS_NICE for SCHED_FIFO, are logged and ignored.
+             * </p>
+             * @return true if all options could be applied, otherwise false
+             */
+            bool applyToCurrentThread() const;
+
+            std::string toString() const;
+    };
+
+    /**
+     * Overflow policy and limits of one reader ring, i.e. the action taken by its producer on a full ring,
+     * read from the environment variables below the given property prefix.
+     * <p>
+     * Example for prefix 'direct_bt.gatt.ring':
+     * <pre>
+     *   "direct_bt.gatt.ring.policy"   := "block"
+     *   "direct_bt.gatt.ring.timeout"  := "500"
+     *   "direct_bt.gatt.ring.max"      := "1024"
+     * </pre>
+     * </p>
+     */
+    class DBTRingOptions {
+        public:
+            enum class OverflowPolicy : uint8_t {
+                /** Drop a quarter of the oldest elements to make room, property value 'drop_oldest'. */
+                DROP_OLDEST = 0,
+                /** Drop the new element, property value 'drop_newest'. */
+                DROP_NEWEST = 1,
+                /** Block the producer up to BLOCK_TIMEOUT, then drop the new element, property value 'block'. */
+                BLOCK = 2,
+                /** Double the capacity up to MAX_CAPACITY, then drop the new element, property value 'grow'. */
+                GROW = 3
+            };
+            static std::string getOverflowPolicyString(const OverflowPolicy v);
+
+            /**
+             * Overflow policy.
+             * <p>
+             * Environment variable is '<prefix>.policy', one of 'drop_oldest', 'drop_newest', 'block' or 'grow'.
+             * </p>
+             */
+            const OverflowPolicy POLICY;
+
+            /**
+             * Maximum time in milliseconds the producer blocks on a full ring with OverflowPolicy::BLOCK, zero blocks infinitely.
+             * <p>
+             * Environment variable is '<prefix>.timeout'.
+             * </p>
+             */
+            const int32_t BLOCK_TIMEOUT;
+
+            /**
+             * Maximum capacity a ring may grow to with OverflowPolicy::GROW.
+             * <p>
+             * Environment variable is '<prefix>.max'.
+             * </p>
+             */
+            const int32_t MAX_CAPACITY;
+
+            DBTRingOptions(const std::string & prefix, const OverflowPolicy defaultPolicy, const int32_t defaultTimeout, const int32_t defaultMaxCapacity);
+
+            std::string toString() const;
+    };
+
 } // namespace direct_bt
 
 #endif /* DBT_ENV_HPP_ */
@@ -29,11 +29,13 @@
 #include <cstring>
 #include <string>
 #include <cstdint>
+#include <vector>
 #include <array>
 
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <future>
 
 #include "DBTEnv.hpp"
 #include "BTTypes.hpp"
@@ -42,7 +44,10 @@
 #include "HCIComm.hpp"
 #include "JavaUplink.hpp"
 #include "MgmtTypes.hpp"
-#include "LFRingbuffer.hpp"
+#include "BondingKeyStore.hpp"
+#include "DBTMetrics.hpp"
+#include "DBTMutex.hpp"
+#include "TimerWheel.hpp"
 
 namespace direct_bt {
 
@@ -60,6 +65,8 @@ namespace direct_bt {
         private:
             MgmtEnv();
 
+            static void onPropertyChanged(const std::string & name);
+
         public:
             /** Global Debug flag, retrieved first to triggers DBTEnv initialization. */
             const bool DEBUG_GLOBAL;
@@ -73,24 +80,22 @@ namespace direct_bt {
              * <p>
              * Environment variable is 'direct_bt.mgmt.reader.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t MGMT_READER_THREAD_POLL_TIMEOUT;
+            std::atomic<int32_t> MGMT_READER_THREAD_POLL_TIMEOUT;
 
             /**
              * Timeout for mgmt command replies, defaults to 3s.
              * <p>
              * Environment variable is 'direct_bt.mgmt.cmd.timeout'.
              * </p>
-             */
-            const int32_t MGMT_COMMAND_REPLY_TIMEOUT;
-
-            /**
-             * Small ringbuffer capacity for synchronized commands, defaults to 64 messages.
              * <p>
-             * Environment variable is 'direct_bt.mgmt.ringsize'.
+             * Runtime adjustable, see reload().
              * </p>
              */
-            const int32_t MGMT_EVT_RING_CAPACITY;
+            std::atomic<int32_t> MGMT_COMMAND_REPLY_TIMEOUT;
 
             /**
              * Debug all Mgmt event communication
@@ -100,11 +105,96 @@ namespace direct_bt {
              */
             const bool DEBUG_EVENT;
 
-        private:
-            /** Maximum number of packets to wait for until matching a sequential command. Won't block as timeout will limit. */
-            const int32_t MGMT_READ_PACKET_MAX_RETRY;
+            /**
+             * Scheduling options of the mgmt reader thread, thread name defaults to 'dbt_mgmt_rdr'.
+             * <p>
+             * Environment variables are 'direct_bt.mgmt.reader.sched.fifo', 'direct_bt.mgmt.reader.cpus' and 'direct_bt.mgmt.reader.name',
+             * see DBTThreadOptions.
+             * </p>
+             */
+            const DBTThreadOptions MGMT_READER_THREAD_OPTIONS;
+
+            /**
+             * Defer each adapter's mode setup and power-on until its first DBTAdapter instantiation, defaults to false.
+             * <p>
+             * Only the adapter information is read at DBTManager construction.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.adapter.lazy'.
+             * </p>
+             */
+            const bool MGMT_ADAPTER_INIT_LAZY;
+
+            /**
+             * Issue the independent mgmt commands of the adapter initialization back-to-back
+             * and across all adapters before collecting their replies, defaults to true.
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.adapter.pipelined'.
+             * </p>
+             */
+            const bool MGMT_ADAPTER_INIT_PIPELINED;
+
+            /**
+             * Use kernel receive timestamps for MgmtEvent, defaults to true.
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.timestamps'.
+             * </p>
+             */
+            const bool MGMT_RX_TIMESTAMPS;
+
+            /**
+             * Allow handing over the mgmt reader thread to the application's external event loop, defaults to false.
+             * <p>
+             * If enabled, the reader thread polls with a short timeout of DBTManager::Defaults::EXTERNAL_HANDOVER_TIMEOUT,
+             * allowing DBTManager::attachExternalReader() to take over promptly.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.reader.external'.
+             * </p>
+             */
+            const bool MGMT_READER_EXTERNAL;
+
+            /**
+             * Directory of the persistent BondingKeyStore, defaults to empty, i.e. bonding keys are kept in memory only.
+             * <p>
+             * The stored keys of each adapter are bulk-loaded at its initialization,
+             * allowing reconnected bonded devices to be encrypted without pairing.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.bonding.dir'.
+             * </p>
+             */
+            const std::string MGMT_BONDING_KEY_DIR;
+
+            /**
+             * Tick resolution in milliseconds of the library's TimerWheel, see DBTManager::getTimerWheel(), defaults to 10ms.
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.timer.tick'.
+             * </p>
+             */
+            const int32_t MGMT_TIMER_TICK;
+
+            /**
+             * Timeout for the completion of DBTManager::pairDevice(), defaults to 30s.
+             * <p>
+             * Environment variable is 'direct_bt.mgmt.pair.timeout'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> MGMT_PAIR_DEVICE_TIMEOUT;
 
         public:
+            /**
+             * Re-reads all runtime adjustable properties from the environment,
+             * invoked by DBTEnv::setProperty() for each property below 'direct_bt.mgmt'.
+             * <p>
+             * Live handlers use the new values with their next operation.
+             * </p>
+             */
+            void reload();
+
             static MgmtEnv& get() {
                 /**
                  * Thread safe starting with C++11 6.7:
@@ -121,10 +211,43 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * Startup timing of DBTManager, see DBTManager::getStartupStats().
+     * <p>
+     * All durations are in milliseconds.
+     * </p>
+     */
+    class ManagerStartupStats {
+        public:
+            /** Monotonic timestamp of the DBTManager construction start, see getCurrentMilliseconds(). */
+            uint64_t ts_start;
+            /** Duration of opening the control channel, reading version, commands and index list. */
+            uint64_t td_open;
+            /** Duration of the adapter initialization at construction, excluding lazily initialized adapters. */
+            uint64_t td_adapters;
+            /** Total duration of the DBTManager construction. */
+            uint64_t td_total;
+            /**
+             * Per adapter initialization duration with index == dev_id, zero while not initialized.
+             * For the pipelined path, this is the duration of the batch the adapter was initialized with.
+             */
+            std::vector<uint64_t> td_adapter;
+            /** Time to the first enabled native discovery of any adapter since ts_start, zero if none yet. */
+            uint64_t td_first_discovery;
+            bool lazy;
+            bool pipelined;
+
+            ManagerStartupStats()
+            : ts_start(0), td_open(0), td_adapters(0), td_total(0), td_first_discovery(0), lazy(false), pipelined(false) {}
+
+            std::string toString() const;
+    };
+
     /**
      * A thread safe singleton handler of the Linux Kernel's BlueZ manager control channel.
      * <p>
-     * Implementation utilizes a lock free ringbuffer receiving data within its separate thread.
+     * Implementation receives data within its separate thread,
+     * delivering command replies to their pending request by opcode and dev_id, see sendAsync().
      * </p>
      * <p>
      * Controlling Environment variables, see {@link MgmtEnv}.
@@ -134,7 +257,10 @@ namespace direct_bt {
         public:
             enum Defaults : int32_t {
                 /* BT Core Spec v5.2: Vol 3, Part F 3.2.8: Maximum length of an attribute value. */
-                ClientMaxMTU = 512
+                ClientMaxMTU = 512,
+
+                /** Poll timeout in milliseconds of the reader thread if MgmtEnv::MGMT_READER_EXTERNAL is enabled */
+                EXTERNAL_HANDOVER_TIMEOUT = 100
             };
 
             static const pid_t pidSelf;
@@ -155,24 +281,79 @@ namespace direct_bt {
             POctets rbuffer;
             HCIComm comm;
 
-            LFRingbuffer<std::shared_ptr<MgmtEvent>, nullptr> mgmtEventRing;
             std::thread mgmtReaderThread;
             std::atomic<bool> mgmtReaderRunning;
             std::atomic<bool> mgmtReaderShallStop;
+            /** True once reading has been handed over to the external event loop, see attachExternalReader() */
+            std::atomic<bool> mgmtReaderExternal;
+            /** Dispatch metric of the external event loop, see processReadable() */
+            LatencyHistogram * metricExternalDispatch;
             std::mutex mtx_mgmtReaderInit;
             std::condition_variable cv_mgmtReaderInit;
-            std::recursive_mutex mtx_sendReply; // for sendWithReply
 
-            /** One MgmtAdapterEventCallbackList per event type, allowing multiple callbacks to be invoked for each event */
-            std::array<MgmtAdapterEventCallbackList, static_cast<uint16_t>(MgmtEvent::Opcode::MGMT_EVENT_TYPE_COUNT)> mgmtAdapterEventCallbackLists;
-            std::recursive_mutex mtx_callbackLists;
+            /** A sent command awaiting its CMD_COMPLETE or CMD_STATUS reply */
+            struct PendingReply {
+                const MgmtOpcode opcode;
+                const uint16_t dev_id;
+                /** Send timestamp in microseconds, see getCurrentMicroseconds() */
+                const uint64_t ts_sent;
+                std::promise<std::shared_ptr<MgmtEvent>> promise;
+
+                PendingReply(const MgmtOpcode opcode_, const uint16_t dev_id_)
+                : opcode(opcode_), dev_id(dev_id_), ts_sent(getCurrentMicroseconds()) {}
+            };
+            /** In-flight commands in send order, guarded by mtx_pendingReplies */
+            std::vector<std::shared_ptr<PendingReply>> pendingReplies;
+            std::mutex mtx_pendingReplies;
+            std::mutex mtx_write; // for comm.write
+
+            /** Completes the first pending request matching the given reply, returns false if none matched. */
+            bool completePendingReply(std::shared_ptr<MgmtEvent> & reply);
+            /** Removes the given pending request, returns false if already completed. */
+            bool removePendingReply(const std::shared_ptr<PendingReply> & pending);
+            /** Completes all pending requests with a nullptr reply. */
+            void clearPendingReplies();
+
+            /**
+             * MgmtAdapterEventCallbackList of one event type, indexed by the adapter dev_id.
+             * <p>
+             * Callbacks for all adapters, i.e. dev_id < 0, are kept in the wildcard list,
+             * all others in the list with index == dev_id.
+             * Both levels are copy-on-write, hence the mgmt reader thread dispatches lock-free.
+             * </p>
+             */
+            struct MgmtAdapterEventCallbackIndex {
+                MgmtAdapterEventCallbackList wildcard;
+                COWVector<std::shared_ptr<MgmtAdapterEventCallbackList>> byDevID;
+            };
+            /** One MgmtAdapterEventCallbackIndex per event type, allowing multiple callbacks to be invoked for each event */
+            std::array<MgmtAdapterEventCallbackIndex, static_cast<uint16_t>(MgmtEvent::Opcode::MGMT_EVENT_TYPE_COUNT)> mgmtAdapterEventCallbackLists;
+            DBTRecursiveMutex mtx_callbackLists { "mgmt_callbacks" };
             inline void checkMgmtEventCallbackListsIndex(const MgmtEvent::Opcode opc) const {
                 if( static_cast<uint16_t>(opc) >= mgmtAdapterEventCallbackLists.size() ) {
                     throw IndexOutOfBoundsException(static_cast<uint16_t>(opc), 1, mgmtAdapterEventCallbackLists.size(), E_FILE_LINE);
                 }
             }
+            /** Returns the callback list of the given event type and dev_id, created if absent. Caller shall hold mtx_callbackLists. */
+            MgmtAdapterEventCallbackList & getMgmtEventCallbackList(const MgmtEvent::Opcode opc, const int dev_id);
+            /** Invokes all callbacks of the given list, returns the number of invoked callbacks. */
+            int invokeMgmtEventCallbacks(const MgmtAdapterEventCallbackList::snapshot_t & list, const MgmtEvent & event);
 
             std::vector<std::shared_ptr<AdapterInfo>> adapterInfos;
+            /** Adapter setup done with index == dev_id, guarded by mtx_adapterInit */
+            std::vector<bool> adapterInitDone;
+            mutable std::mutex mtx_adapterInfos;
+            std::mutex mtx_adapterInit;
+
+            ManagerStartupStats startupStats;
+            mutable std::mutex mtx_startupStats;
+            std::atomic<bool> firstDiscoveryDone;
+
+            BondingKeyStore bondingKeys;
+            TimerWheel timerWheel;
+
+            /** Dispatches one read MgmtEvent of the given length from rbuffer, called by the reader thread or external event loop */
+            void dispatchEvent(const int len, const uint64_t timestampNS, LatencyHistogram * metricDispatch);
             void mgmtReaderThreadImpl();
 
             /**
@@ -181,6 +362,20 @@ namespace direct_bt {
              */
             std::shared_ptr<MgmtEvent> sendWithReply(MgmtCommand &req);
 
+            /**
+             * Waits for the given sendAsync() reply up to the given timeout in milliseconds,
+             * returning nullptr on timeout.
+             */
+            std::shared_ptr<MgmtEvent> waitForReply(const MgmtCommand &req, std::shared_ptr<PendingReply> & pending,
+                                                    std::future<std::shared_ptr<MgmtEvent>> & reply, const int32_t timeoutMS);
+            std::future<std::shared_ptr<MgmtEvent>> sendAsync(MgmtCommand &req, std::shared_ptr<PendingReply> & pending);
+
+            /**
+             * Sends all given commands back-to-back before collecting their replies,
+             * returning the replies in request order with nullptr for a missing or invalid reply.
+             */
+            std::vector<std::shared_ptr<MgmtEvent>> sendWithReplies(const std::vector<std::shared_ptr<MgmtCommand>> &reqs);
+
             /**
              * Instantiate singleton.
              * @param btMode default {@link BTMode}, adapters are tried to be initialized.
@@ -190,23 +385,35 @@ namespace direct_bt {
             void operator=(const DBTManager&) = delete;
 
             void setAdapterMode(const uint16_t dev_id, const uint8_t ssp, const uint8_t bredr, const uint8_t le);
+            std::shared_ptr<AdapterInfo> readAdapterInfo(const uint16_t dev_id);
             std::shared_ptr<AdapterInfo> initAdapter(const uint16_t dev_id, const BTMode btMode);
+            void addAdapterModeCommands(std::vector<std::shared_ptr<MgmtCommand>> &reqs, const uint16_t dev_id, const BTMode btMode);
+            /**
+             * Adds the LOAD_LONG_TERM_KEYS and LOAD_IRKS commands of the stored bonding keys of the given adapter, if any.
+             */
+            void addBondingKeyCommands(std::vector<std::shared_ptr<MgmtCommand>> &reqs, const uint16_t dev_id, const EUI48 &adapterAddress);
+            bool initAdaptersPipelined(const std::vector<uint16_t> &dev_ids, const BTMode btMode);
+            void setAdapterInfo(const uint16_t dev_id, std::shared_ptr<AdapterInfo> adapterInfo);
             void shutdownAdapter(const uint16_t dev_id);
 
-            bool mgmtEvClassOfDeviceChangedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceDiscoveringCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceFoundCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceDisconnectedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceConnectedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvConnectFailedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceBlockedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceUnblockedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceUnpairedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvNewConnectionParamCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceWhitelistAddedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvDeviceWhilelistRemovedCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvPinCodeRequestCB(std::shared_ptr<MgmtEvent> e);
-            bool mgmtEvUserPasskeyRequestCB(std::shared_ptr<MgmtEvent> e);
+            bool mgmtEvClassOfDeviceChangedCB(const MgmtEvent& e);
+            bool mgmtEvDeviceDiscoveringCB(const MgmtEvtDiscovering &event);
+            bool mgmtEvDeviceFoundCB(const MgmtEvtDeviceFound &event);
+            bool mgmtEvDeviceDisconnectedCB(const MgmtEvtDeviceDisconnected &event);
+            bool mgmtEvDeviceConnectedCB(const MgmtEvtDeviceConnected &event);
+            bool mgmtEvConnectFailedCB(const MgmtEvtDeviceConnectFailed &event);
+            bool mgmtEvDeviceBlockedCB(const MgmtEvtDeviceBlocked &event);
+            bool mgmtEvDeviceUnblockedCB(const MgmtEvtDeviceUnblocked &event);
+            bool mgmtEvDeviceUnpairedCB(const MgmtEvtDeviceUnpaired &event);
+            bool mgmtEvNewConnectionParamCB(const MgmtEvtNewConnectionParam &event);
+            bool mgmtEvDeviceWhitelistAddedCB(const MgmtEvtDeviceWhitelistAdded &event);
+            bool mgmtEvDeviceWhilelistRemovedCB(const MgmtEvtDeviceWhitelistRemoved &event);
+            bool mgmtEvFirstDiscoveringCB(const MgmtEvtDiscovering &event);
+            bool mgmtEvPinCodeRequestCB(const MgmtEvtPinCodeRequest &event);
+            bool mgmtEvUserPasskeyRequestCB(const MgmtEvtUserPasskeyRequest &event);
+            bool mgmtEvNewLongTermKeyCB(const MgmtEvtNewLongTermKey &event);
+            bool mgmtEvNewIdentityResolvingKeyCB(const MgmtEvtNewIdentityResolvingKey &event);
+            bool mgmtEvDeviceUnpairedKeysCB(const MgmtEvtDeviceUnpaired &event);
 
         public:
             /**
@@ -251,8 +458,38 @@ namespace direct_bt {
                 return comm.isOpen();
             }
 
+            /**
+             * Hands over reading from the internal reader thread to the application's external event loop,
+             * which shall poll getFD() for readability and call processReadable() on its own thread.
+             * <p>
+             * Requires MgmtEnv::MGMT_READER_EXTERNAL, blocks until the reader thread has ended,
+             * i.e. up to Defaults::EXTERNAL_HANDOVER_TIMEOUT.
+             * </p>
+             * <p>
+             * Blocking commands still wait for their reply on the calling thread,
+             * hence shall not be issued by the external event loop.
+             * </p>
+             * @return true if reading is driven externally, otherwise false
+             */
+            bool attachExternalReader();
+
+            /** Returns true if reading has been handed over to the external event loop, see attachExternalReader(). */
+            bool isExternalReader() const { return mgmtReaderExternal; }
+
+            /** Returns the descriptor readable if MgmtEvent are pending, i.e. the mgmt control channel socket or its io_uring, see HCIComm::poll_dd(). */
+            int getFD() const { return comm.poll_dd(); }
+
+            /**
+             * Reads and dispatches all pending MgmtEvent on the calling thread, see attachExternalReader().
+             * <p>
+             * Shall be called by one thread at a time if getFD() is readable, returns immediately otherwise.
+             * </p>
+             * @return number of dispatched events, or -1 on error or if not attached, in which case the external event loop shall remove getFD().
+             */
+            int processReadable();
+
             std::string toString() const override {
-                return "MgmtHandler[BTMode "+getBTModeString(defaultBTMode)+", "+std::to_string(adapterInfos.size())+" adapter, "+javaObjectToString()+"]";
+                return "MgmtHandler[BTMode "+getBTModeString(defaultBTMode)+", "+std::to_string(getAdapterCount())+" adapter, "+javaObjectToString()+"]";
             }
 
             /** retrieve information gathered at startup */
@@ -260,12 +497,47 @@ namespace direct_bt {
             /**
              * Returns list of AdapterInfo with index == dev_id.
              */
-            const std::vector<std::shared_ptr<AdapterInfo>> getAdapterInfos() const { return adapterInfos; }
+            const std::vector<std::shared_ptr<AdapterInfo>> getAdapterInfos() const {
+                const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
+                return adapterInfos;
+            }
 
             /**
              * Returns number of AdapterInfo with index == dev_id.
              */
-            int getAdapterCount() const { return adapterInfos.size(); }
+            int getAdapterCount() const {
+                const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
+                return adapterInfos.size();
+            }
+
+            /**
+             * Performs the adapter's mode setup and power-on if deferred, see MgmtEnv::MGMT_ADAPTER_INIT_LAZY.
+             * <p>
+             * Called by DBTAdapter before retrieving its AdapterInfo.
+             * </p>
+             * @return true if the adapter is initialized, otherwise false
+             */
+            bool ensureAdapterInitialized(const int dev_id);
+
+            /**
+             * Sends the given command without waiting for its reply.
+             * <p>
+             * The returned future receives the reply matching the command's opcode and dev_id,
+             * or nullptr if the command could not be sent or this instance is being closed.
+             * Replies of concurrent in-flight commands of the same opcode and dev_id are delivered in send order.
+             * </p>
+             * <p>
+             * The pending command expires after the given timeout, completing the future with nullptr.
+             * Hence an abandoned command, e.g. after the caller's std::future::wait_for() gave up,
+             * never takes the reply of a later command of the same opcode and dev_id.
+             * </p>
+             * @param req the command
+             * @param timeoutMS reply timeout in milliseconds, a negative value uses MgmtEnv::MGMT_COMMAND_REPLY_TIMEOUT
+             */
+            std::future<std::shared_ptr<MgmtEvent>> sendAsync(MgmtCommand &req, const int32_t timeoutMS=-1);
+
+            /** Returns a snapshot of the startup timing. */
+            ManagerStartupStats getStartupStats() const;
 
             /**
              * Returns the AdapterInfo index (== dev_id) with the given address or -1 if not found.
@@ -285,7 +557,7 @@ namespace direct_bt {
             /**
              * Returns the default AdapterInfo (0 == index == dev_id) or nullptr if no adapter is available.
              */
-            std::shared_ptr<AdapterInfo> getDefaultAdapterInfo() const { return adapterInfos.size() > 0 ? getAdapterInfo(0) : nullptr; }
+            std::shared_ptr<AdapterInfo> getDefaultAdapterInfo() const { return getAdapterCount() > 0 ? getAdapterInfo(0) : nullptr; }
 
             bool setMode(const int dev_id, const MgmtOpcode opc, const uint8_t mode);
 
@@ -312,6 +584,16 @@ namespace direct_bt {
                                  const uint16_t conn_interval_min=0x000F, const uint16_t conn_interval_max=0x000F,
                                  const uint16_t conn_latency=0x0000, const uint16_t timeout=number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10);
 
+            /**
+             * Uploads the given connection parameter for multiple devices at once,
+             * using one LOAD_CONN_PARAM command per MgmtLoadConnParamCmd::MAX_PARAM_COUNT devices.
+             * <p>
+             * Note that the kernel replaces all previously loaded and unused connection parameter.
+             * </p>
+             * @return true if all commands succeeded
+             */
+            bool uploadConnParam(const int dev_id, const std::vector<std::shared_ptr<MgmtConnParam>> & connParams);
+
             /**
              * Returns true, if the adapter's device is already whitelisted.
              */
@@ -328,9 +610,29 @@ namespace direct_bt {
              */
             bool addDeviceToWhitelist(const int dev_id, const EUI48 &address, const BDAddressType address_type, const HCIWhitelistConnectType ctype);
 
+            /**
+             * Add the given devices to the adapter's autoconnect whitelist,
+             * having all commands in flight before collecting their replies.
+             * <p>
+             * Make sure {@link uploadConnParam(..)} is invoked first, otherwise performance will lack.
+             * </p>
+             * <p>
+             * Already whitelisted devices are skipped.
+             * </p>
+             * @return number of added devices
+             */
+            int addDevicesToWhitelist(const int dev_id, const std::vector<BDAddressKey> & devices, const HCIWhitelistConnectType ctype);
+
             /** Remove the given device from the adapter's autoconnect whitelist. */
             bool removeDeviceFromWhitelist(const int dev_id, const EUI48 &address, const BDAddressType address_type);
 
+            /**
+             * Remove the given devices from the adapter's autoconnect whitelist,
+             * having all commands in flight before collecting their replies.
+             * @return number of removed devices
+             */
+            int removeDevicesFromWhitelist(const int dev_id, const std::vector<BDAddressKey> & devices);
+
             /** Remove all previously added devices from the autoconnect whitelist. Returns number of removed devices. */
             int removeAllDevicesFromWhitelist();
 
@@ -341,6 +643,65 @@ namespace direct_bt {
             std::shared_ptr<ConnectionInfo> getConnectionInfo(const int dev_id, const EUI48 &address, const BDAddressType address_type);
             std::shared_ptr<NameAndShortName> setLocalName(const int dev_id, const std::string & name, const std::string & short_name);
 
+            /** Returns the BondingKeyStore, see MgmtEnv::MGMT_BONDING_KEY_DIR. */
+            BondingKeyStore & getBondingKeyStore() { return bondingKeys; }
+
+            /**
+             * Returns the library's TimerWheel of tick resolution MgmtEnv::MGMT_TIMER_TICK,
+             * serving the timeouts and periodic tasks of all direct_bt subsystems and the application with one thread.
+             * <p>
+             * Its callbacks shall not block. The TimerWheel is stopped by close().
+             * </p>
+             */
+            TimerWheel & getTimerWheel() { return timerWheel; }
+
+            /**
+             * Pairs with the given connected device via SMP, blocking until pairing completed
+             * or MgmtEnv::MGMT_PAIR_DEVICE_TIMEOUT expired, in which case pairing is cancelled.
+             * <p>
+             * Distributed keys of a bonded device are stored in the BondingKeyStore
+             * via the NEW_LONG_TERM_KEY and NEW_IRK events.
+             * </p>
+             * <p>
+             * To encrypt the link immediately at the next connection of the bonded device,
+             * set the ATT channel's security level, see L2CAPSocketOptions::SECURITY_LEVEL.
+             * </p>
+             * @return MgmtStatus::SUCCESS if paired, MgmtStatus::TIMEOUT on timeout, otherwise the kernel's status
+             */
+            MgmtStatus pairDevice(const int dev_id, const EUI48 &address, const BDAddressType address_type,
+                                  const SMPIOCapability iocap=SMPIOCapability::NO_INPUT_NO_OUTPUT);
+
+            /**
+             * Removes the given device's pairing and keys from the kernel and the BondingKeyStore.
+             * @param disconnect if true, disconnects the device if connected
+             */
+            bool unpairDevice(const int dev_id, const EUI48 &address, const BDAddressType address_type, const bool disconnect);
+
+            /**
+             * Loads the given Long Term Keys to the kernel in one command, replacing all previously loaded keys of the adapter.
+             * <p>
+             * At most MgmtLoadLongTermKeyCmd::MAX_KEY_COUNT keys can be loaded.
+             * </p>
+             */
+            bool loadLongTermKeys(const int dev_id, const std::vector<MgmtLongTermKeyInfo> & keys);
+
+            /**
+             * Loads the given Identity Resolving Keys to the kernel in one command, replacing all previously loaded keys of the adapter.
+             * <p>
+             * At most MgmtLoadIdentityResolvingKeyCmd::MAX_KEY_COUNT keys can be loaded.
+             * </p>
+             */
+            bool loadIdentityResolvingKeys(const int dev_id, const std::vector<MgmtIdentityResolvingKeyInfo> & keys);
+
+            /**
+             * Loads the keys of the BondingKeyStore to the kernel, having both commands in flight before collecting their replies.
+             * <p>
+             * Performed at adapter initialization.
+             * If more keys are stored than a command can carry, the most recently stored ones are loaded.
+             * </p>
+             */
+            bool loadBondingKeys(const int dev_id);
+
             /** MgmtEventCallback handling  */
 
             /**
@@ -350,19 +711,39 @@ namespace direct_bt {
              * The adapter dev_id allows filtering the events only directed to the given adapter.
              * Use dev_id <code>-1</code> to receive the event for all adapter.
              * </p>
+             * <p>
+             * Callbacks for all adapter are invoked before the ones of the event's adapter.
+             * </p>
              */
             void addMgmtEventCallback(const int dev_id, const MgmtEvent::Opcode opc, const MgmtEventCallback &cb);
             /** Returns count of removed given MgmtEventCallback from the named MgmtEvent::Opcode list. */
             int removeMgmtEventCallback(const MgmtEvent::Opcode opc, const MgmtEventCallback &cb);
             /** Returns count of removed MgmtEventCallback from the named MgmtEvent::Opcode list matching the given adapter dev_id . */
             int removeMgmtEventCallback(const int dev_id);
+
+            /**
+             * Appends the given typed MgmtEventHandler for the given adapter dev_id to the E::getStaticOpcode() list,
+             * if it is not present already, see addMgmtEventCallback().
+             * <p>
+             * The handler receives the specialized event type E, mapped to its opcode at compile time.
+             * </p>
+             */
+            template<typename E>
+            void addMgmtEventHandler(const int dev_id, const MgmtEventHandler<E> &handler) {
+                addMgmtEventCallback(dev_id, E::getStaticOpcode(), bindMgmtEventHandler<E>(handler));
+            }
+            /** Returns count of removed given typed MgmtEventHandler from the E::getStaticOpcode() list. */
+            template<typename E>
+            int removeMgmtEventHandler(const MgmtEventHandler<E> &handler) {
+                return removeMgmtEventCallback(E::getStaticOpcode(), bindMgmtEventHandler<E>(handler));
+            }
             /** Removes all MgmtEventCallbacks from the to the named MgmtEvent::Opcode list. */
             void clearMgmtEventCallbacks(const MgmtEvent::Opcode opc);
             /** Removes all MgmtEventCallbacks from all MgmtEvent::Opcode lists. */
             void clearAllMgmtEventCallbacks();
 
             /** Manually send a MgmtEvent to all of its listeners. */
-            void sendMgmtEvent(std::shared_ptr<MgmtEvent> event);
+            void sendMgmtEvent(const std::shared_ptr<MgmtEvent> & event);
     };
 
 } // namespace direct_bt
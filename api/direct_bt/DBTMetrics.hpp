@@ -0,0 +1,283 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_METRICS_HPP_
+#define DBT_METRICS_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <mutex>
+
+namespace direct_bt {
+
+    /**
+     * Immutable copy of one LatencyHistogram, see DBTMetrics::getSnapshot().
+     */
+    struct LatencySnapshot {
+        std::string name;
+        /** Formatted label, e.g. <code>opcode="READ_INFO"</code>, may be empty. */
+        std::string label;
+        /** Number of successful operations, i.e. sum of all buckets */
+        uint64_t count;
+        /** Number of failed operations, not part of the buckets */
+        uint64_t errors;
+        /** Sum of all recorded latencies in microseconds */
+        uint64_t sum;
+        /** Maximum recorded latency in microseconds */
+        uint64_t max;
+        std::vector<uint64_t> buckets;
+
+        /** Returns the mean latency in microseconds. */
+        double getMean() const { return 0 < count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+        /** Returns the exclusive upper bound in microseconds of the bucket holding the given quantile in [0..1]. */
+        uint64_t getPercentile(const double q) const;
+
+        std::string toString() const;
+    };
+
+    /**
+     * Lock-free log-linear latency histogram with microsecond resolution.
+     * <p>
+     * Latencies below SUB_BUCKET_COUNT microseconds are counted exactly,
+     * each following power of two range is split into SUB_BUCKET_COUNT linear buckets,
+     * i.e. a relative error of at most 1/SUB_BUCKET_COUNT.
+     * Latencies beyond the last bucket are counted in the last bucket.
+     * </p>
+     */
+    class LatencyHistogram {
+        public:
+            enum Defaults : int32_t {
+                SUB_BUCKET_BITS = 3,
+                SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+                /** Covering up to 2^36 microseconds, about 19 hours */
+                BUCKET_COUNT = ( 36 - SUB_BUCKET_BITS + 1 ) * SUB_BUCKET_COUNT
+            };
+
+            static int getBucketIndex(const uint64_t usec) {
+                if( usec < SUB_BUCKET_COUNT ) {
+                    return static_cast<int>(usec);
+                }
+                const int e = 63 - __builtin_clzll(usec); // >= SUB_BUCKET_BITS
+                const int index = ( e - SUB_BUCKET_BITS + 1 ) * SUB_BUCKET_COUNT + static_cast<int>( ( usec >> ( e - SUB_BUCKET_BITS ) ) & ( SUB_BUCKET_COUNT - 1 ) );
+                return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+            }
+            /** Returns the inclusive lower bound in microseconds of the given bucket. */
+            static uint64_t getBucketLowerBound(const int index);
+            /** Returns the exclusive upper bound in microseconds of the given bucket. */
+            static uint64_t getBucketUpperBound(const int index);
+
+        private:
+            std::atomic<uint64_t> buckets[BUCKET_COUNT];
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> errors;
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> max;
+
+            LatencyHistogram(const LatencyHistogram&) = delete;
+            void operator=(const LatencyHistogram&) = delete;
+
+        public:
+            LatencyHistogram();
+
+            /** Records one successful operation of the given latency in microseconds. */
+            void record(const uint64_t usec) {
+                buckets[getBucketIndex(usec)].fetch_add(1, std::memory_order_relaxed);
+                count.fetch_add(1, std::memory_order_relaxed);
+                sum.fetch_add(usec, std::memory_order_relaxed);
+                uint64_t m = max.load(std::memory_order_relaxed);
+                while( usec > m && !max.compare_exchange_weak(m, usec, std::memory_order_relaxed) ) { }
+            }
+
+            /** Records one failed operation, not adding to the latency distribution. */
+            void recordError() {
+                errors.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * Records the operation started at t0, see getCurrentMicroseconds(),
+             * as a latency sample if successful, otherwise as an error.
+             */
+            void recordSince(const uint64_t t0, const bool success);
+
+            uint64_t getCount() const { return count.load(); }
+            uint64_t getErrorCount() const { return errors.load(); }
+
+            /** Copies the current state, concurrent recordings may be partially observed. */
+            void getSnapshot(LatencySnapshot & res) const;
+    };
+
+    /**
+     * Smoothed round-trip time estimator of one peer, deriving its reply timeout.
+     * <p>
+     * Follows RFC 6298 (TCP retransmission timer):
+     * The first sample R sets SRTT = R and RTTVAR = R/2,
+     * each further sample updates RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R| and SRTT = 7/8 SRTT + 1/8 R.
+     * The timeout is SRTT + 4 RTTVAR.
+     * </p>
+     * <p>
+     * Callers shall not add samples of retried requests, as their reply can't be associated (Karn's algorithm).
+     * </p>
+     */
+    class RTTEstimator {
+        private:
+            mutable std::mutex mtx;
+            /** Smoothed RTT and its variation in microseconds */
+            uint64_t srtt;
+            uint64_t rttvar;
+            uint64_t samples;
+
+        public:
+            RTTEstimator() noexcept : srtt(0), rttvar(0), samples(0) {}
+
+            /** Adds the given round-trip time sample in microseconds. */
+            void addSample(const uint64_t rttUSec) noexcept;
+
+            /** Removes all samples. */
+            void reset() noexcept;
+
+            uint64_t getSampleCount() const noexcept;
+
+            /** Returns the smoothed round-trip time SRTT in microseconds, zero w/o samples. */
+            uint64_t getSmoothedRTT() const noexcept;
+
+            /** Returns the round-trip time variation RTTVAR in microseconds, zero w/o samples. */
+            uint64_t getRTTVariation() const noexcept;
+
+            /**
+             * Returns the timeout SRTT + 4 RTTVAR in milliseconds, clamped to [minMS..maxMS],
+             * or defaultMS w/o samples.
+             */
+            int32_t getTimeout(const int32_t defaultMS, const int32_t minMS, const int32_t maxMS) const noexcept;
+
+            std::string toString() const;
+    };
+
+    /**
+     * Lock-free gauge of a current value, e.g. a number of objects or their memory footprint in bytes.
+     */
+    class MetricGauge {
+        private:
+            std::atomic<int64_t> value;
+
+        public:
+            MetricGauge() noexcept : value(0) {}
+
+            void set(const int64_t v) { value.store(v, std::memory_order_relaxed); }
+            void add(const int64_t d) { value.fetch_add(d, std::memory_order_relaxed); }
+            int64_t get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    /**
+     * Runtime registry of named LatencyHistogram metrics, exportable in the Prometheus text format.
+     * <p>
+     * Recording is lock-free, only looking up a histogram locks the registry.
+     * Returned histograms stay valid for the lifetime of the registry,
+     * hence callers on hot paths should retain them.
+     * </p>
+     * <p>
+     * Recorded metrics:
+     * <pre>
+     * - hci_command{opcode}: HCI command to command complete, see HCIHandler
+     * - hci_reader_dispatch: HCI reader thread processing time per packet
+     * - mgmt_command{opcode}: Mgmt command to reply, see DBTManager
+     * - mgmt_reader_dispatch: Mgmt reader thread processing time per event
+     * - gatt_read{device}, gatt_write{device}, gatt_discovery{device}: GATT operations, see GATTHandler
+     * - gatt_rtt{device}: GATT request to reply round-trip time, see GATTHandler::getRTTEstimator()
+     * - gatt_connect_ready{device}: Link established until GATT connected, see DBTDevice
+     * - lock_wait{lock}, lock_hold{lock}: Contended lock wait and lock hold times, only with DBT_LOCK_METRICS, see DBTRecursiveMutex
+     * </pre>
+     * </p>
+     * <p>
+     * Recorded gauges:
+     * <pre>
+     * - adapter_devices{dev_id}, adapter_device_bytes{dev_id}: Shared DBTDevice instances and their approximate footprint, see DBTAdapter
+     * - adapter_sightings{dev_id}, adapter_sighting_bytes{dev_id}: Slim DeviceSighting entries and their approximate footprint, see DeviceSightingTable
+     * </pre>
+     * </p>
+     * <p>
+     * Controlling Environment variables:
+     * <pre>
+     * - 'direct_bt.metrics': Enable recording of metrics, defaults to true.
+     * </pre>
+     * </p>
+     */
+    class DBTMetrics {
+        private:
+            const bool enabled;
+            /** name -> label -> histogram, guarded by mtx_registry */
+            std::map<std::string, std::map<std::string, std::unique_ptr<LatencyHistogram>>> registry;
+            /** name -> label -> gauge, guarded by mtx_registry */
+            std::map<std::string, std::map<std::string, std::unique_ptr<MetricGauge>>> gauges;
+            mutable std::mutex mtx_registry;
+
+            DBTMetrics(const DBTMetrics&) = delete;
+            void operator=(const DBTMetrics&) = delete;
+
+        public:
+            DBTMetrics(const bool enabled);
+
+            static DBTMetrics& get();
+
+            bool isEnabled() const { return enabled; }
+
+            /**
+             * Returns the histogram of the given name and optional label, created if not existing.
+             * @param name metric name, prefixed with 'direct_bt_' in the Prometheus export
+             * @param labelName optional label name, e.g. 'opcode'
+             * @param labelValue label value, only used with a labelName
+             */
+            LatencyHistogram& getHistogram(const std::string & name, const std::string & labelName="", const std::string & labelValue="");
+
+            /**
+             * Returns the gauge of the given name and optional label, created if not existing.
+             * @param name metric name, prefixed with 'direct_bt_' in the Prometheus export
+             * @param labelName optional label name, e.g. 'dev_id'
+             * @param labelValue label value, only used with a labelName
+             */
+            MetricGauge& getGauge(const std::string & name, const std::string & labelName="", const std::string & labelValue="");
+
+            /** Returns snapshots of all histograms, ordered by name and label. */
+            std::vector<LatencySnapshot> getSnapshot() const;
+
+            /**
+             * Returns all histograms in the Prometheus text exposition format.
+             * <p>
+             * Each histogram is exported as 'direct_bt_<name>_microseconds' with bucket bounds at powers of two,
+             * its error count as 'direct_bt_<name>_errors_total'.
+             * Each gauge is exported as 'direct_bt_<name>'.
+             * </p>
+             */
+            std::string toPrometheus() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* DBT_METRICS_HPP_ */
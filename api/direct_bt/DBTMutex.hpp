@@ -0,0 +1,137 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_MUTEX_HPP_
+#define DBT_MUTEX_HPP_
+
+#include <cstdint>
+#include <mutex>
+
+#ifdef DBT_LOCK_METRICS
+    #include "BasicTypes.hpp"
+    #include "DBTMetrics.hpp"
+#endif
+
+namespace direct_bt {
+
+#ifdef DBT_LOCK_METRICS
+
+    /**
+     * Named recursive mutex, recording its wait and hold times as DBTMetrics if compiled with DBT_LOCK_METRICS.
+     * <p>
+     * Recorded metrics, aggregated over all instances of the same name:
+     * <pre>
+     * - lock_wait{lock}: Wait time of each contended acquisition, i.e. its count is the contention count
+     * - lock_hold{lock}: Hold time of each outermost acquisition, i.e. its count is the acquisition count
+     * </pre>
+     * Recursive acquisitions of the owning thread are neither waited for nor recorded.
+     * </p>
+     * <p>
+     * Without DBT_LOCK_METRICS, this is a plain std::recursive_mutex w/o any overhead.
+     * DBT_LOCK_METRICS changes the class layout, hence shall be defined for the library and all its users alike,
+     * see CMake option DBT_LOCK_METRICS.
+     * </p>
+     */
+    class DBTRecursiveMutex {
+        private:
+            std::recursive_mutex mtx;
+            LatencyHistogram * metricWait;
+            LatencyHistogram * metricHold;
+            /** Recursion depth and outermost acquisition time, only accessed by the owning thread */
+            int depth;
+            uint64_t t_acquired;
+
+            void acquired(const uint64_t t0) {
+                if( 0 == depth++ ) {
+                    t_acquired = t0;
+                }
+            }
+
+        public:
+            explicit DBTRecursiveMutex(const char * name)
+            : metricWait(nullptr), metricHold(nullptr), depth(0), t_acquired(0)
+            {
+                DBTMetrics & m = DBTMetrics::get();
+                if( m.isEnabled() ) {
+                    metricWait = &m.getHistogram("lock_wait", "lock", name);
+                    metricHold = &m.getHistogram("lock_hold", "lock", name);
+                }
+            }
+
+            DBTRecursiveMutex(const DBTRecursiveMutex&) = delete;
+            void operator=(const DBTRecursiveMutex&) = delete;
+
+            void lock() {
+                if( nullptr == metricWait ) {
+                    mtx.lock();
+                    depth++;
+                    return;
+                }
+                if( mtx.try_lock() ) {
+                    acquired(0 == depth ? getCurrentMicroseconds() : 0);
+                    return;
+                }
+                const uint64_t t0 = getCurrentMicroseconds();
+                mtx.lock();
+                const uint64_t t1 = getCurrentMicroseconds();
+                metricWait->record(t1 - t0);
+                acquired(t1);
+            }
+
+            bool try_lock() {
+                if( !mtx.try_lock() ) {
+                    return false;
+                }
+                acquired(nullptr != metricHold && 0 == depth ? getCurrentMicroseconds() : 0);
+                return true;
+            }
+
+            void unlock() {
+                if( 0 == --depth && nullptr != metricHold ) {
+                    metricHold->record(getCurrentMicroseconds() - t_acquired);
+                }
+                mtx.unlock();
+            }
+    };
+
+#else /* DBT_LOCK_METRICS */
+
+    /**
+     * Named recursive mutex, a plain std::recursive_mutex w/o DBT_LOCK_METRICS.
+     * <p>
+     * If compiled with DBT_LOCK_METRICS, its wait and hold times are recorded as DBTMetrics
+     * 'lock_wait{lock}' and 'lock_hold{lock}', see CMake option DBT_LOCK_METRICS.
+     * </p>
+     */
+    class DBTRecursiveMutex : public std::recursive_mutex {
+        public:
+            explicit DBTRecursiveMutex(const char * name) { (void)name; }
+    };
+
+#endif /* DBT_LOCK_METRICS */
+
+} // namespace direct_bt
+
+#endif /* DBT_MUTEX_HPP_ */
@@ -0,0 +1,106 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_PROFILE_HPP_
+#define DBT_PROFILE_HPP_
+
+#include <string>
+#include <cstdint>
+#include <memory>
+
+#include "GATTHandler.hpp"
+
+namespace direct_bt {
+
+    /**
+     * Performance profile of one device class, overriding the global HCIEnv and GATTEnv defaults
+     * for devices it has been attached to via DBTDevice::setProfile() or DBTAdapter::setProfile().
+     * <p>
+     * Allows to mix low latency control devices and bulk transfer data loggers on the same gateway,
+     * each with its own tuning.
+     * </p>
+     * <p>
+     * Each unset field, i.e. zero or negative if documented, falls back to the global default.
+     * A device uses its own profile, otherwise its adapter's profile, see DBTDevice::getEffectiveProfile().
+     * Changes of an attached profile apply with the next connectLE()/connectDefault() and connectGATT(),
+     * hence a profile shall be treated as immutable once attached.
+     * </p>
+     */
+    class DBTProfile {
+        public:
+            /** Name used for logging, e.g. 'control' or 'logger'. */
+            std::string name;
+
+            /** Requested client ATT_MTU, see DBTDevice::connectGATT(), zero for GATTEnv::GATT_CLIENT_MTU. */
+            uint16_t clientMTU = 0;
+
+            /** LE scan interval in units of 0.625ms, zero for the connectLE() default. */
+            uint16_t le_scan_interval = 0;
+            /** LE scan window in units of 0.625ms, zero for the connectLE() default. */
+            uint16_t le_scan_window = 0;
+            /** Minimum connection interval in units of 1.25ms, zero for the connectLE() default. */
+            uint16_t conn_interval_min = 0;
+            /** Maximum connection interval in units of 1.25ms, zero for the connectLE() default. */
+            uint16_t conn_interval_max = 0;
+            /** Slave latency in units of connection events, negative for the connectLE() default. */
+            int32_t conn_latency = -1;
+            /** Supervision timeout in units of 10ms, zero for the connectLE() default. */
+            uint16_t supervision_timeout = 0;
+
+            /** GATT read reply timeout in milliseconds, zero for GATTEnv::GATT_READ_COMMAND_REPLY_TIMEOUT. */
+            int32_t readTimeout = 0;
+            /** GATT write reply timeout in milliseconds, zero for GATTEnv::GATT_WRITE_COMMAND_REPLY_TIMEOUT. */
+            int32_t writeTimeout = 0;
+            /** GATT initial reply timeout in milliseconds, zero for GATTEnv::GATT_INITIAL_COMMAND_REPLY_TIMEOUT. */
+            int32_t initialTimeout = 0;
+
+            /** ATT PDU reply ring capacity, zero for GATTEnv::ATTPDU_RING_CAPACITY. */
+            int32_t attPDURingCapacity = 0;
+
+            /**
+             * SCHED_FIFO priority [1..99] of the device's own L2CAP reader thread, zero for SCHED_OTHER,
+             * negative for GATTEnv::L2CAP_READER_THREAD_OPTIONS.
+             * <p>
+             * Not applicable to the shared reactor or HCI reader, see GATTEnv::GATT_READER_REACTOR_THREADS.
+             * </p>
+             */
+            int32_t readerFIFOPriority = -1;
+
+            /** If true, notifyDispatch overrides GATTEnv::GATT_NOTIFY_DISPATCH. */
+            bool hasNotifyDispatch = false;
+            GATTEnv::NotifyDispatch notifyDispatch = GATTEnv::NotifyDispatch::READER;
+
+            DBTProfile() {}
+            DBTProfile(const std::string & name_) : name(name_) {}
+
+            /** Applies readerFIFOPriority to the calling thread if set, see DBTThreadOptions::applyToCurrentThread(). */
+            bool applyReaderPriorityToCurrentThread() const;
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* DBT_PROFILE_HPP_ */
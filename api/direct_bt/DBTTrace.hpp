@@ -0,0 +1,126 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_TRACE_HPP_
+#define DBT_TRACE_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <atomic>
+
+namespace direct_bt {
+
+    /** Origin of a TraceRecord, i.e. the protocol and direction. */
+    enum class TraceSource : uint8_t {
+        MGMT_CMD = 0,
+        MGMT_EVT = 1,
+        HCI_CMD  = 2,
+        HCI_EVT  = 3
+    };
+    std::string getTraceSourceString(const TraceSource s);
+
+    /**
+     * Binary trace record of one command or event header, see DBTTrace.
+     */
+    struct TraceRecord {
+        /** Monotonic timestamp in milliseconds, see getCurrentMilliseconds(). */
+        uint64_t timestamp;
+        /** MgmtOpcode, MgmtEvent::Opcode, HCIOpcode or HCIEventType depending on source */
+        uint16_t opcode;
+        /** MgmtOpcode of a Mgmt CMD_COMPLETE or CMD_STATUS reply, HCIMetaEventType of a HCI LE_META event, otherwise zero. */
+        uint16_t subcode;
+        /** Adapter dev_id */
+        uint16_t dev_id;
+        /** Parameter size in bytes */
+        uint16_t size;
+        TraceSource source;
+
+        /** Formats this record, only to be used when dumping. */
+        std::string toString() const;
+    };
+
+    /**
+     * Lock-free binary trace ringbuffer of the most recent Mgmt and HCI command and event headers.
+     * <p>
+     * Recording merely stores a fixed size TraceRecord, hence is intended to be always-on.
+     * String formatting only happens when dumping the trace, e.g. after a failure.
+     * </p>
+     * <p>
+     * Concurrent writers claim their slot atomically, a concurrent dump may observe a partially written record.
+     * </p>
+     * <p>
+     * Controlling Environment variables:
+     * <pre>
+     * - 'direct_bt.trace.size': Number of recorded records, defaults to 1024. Zero disables tracing.
+     * </pre>
+     * </p>
+     */
+    class DBTTrace {
+        private:
+            std::vector<TraceRecord> ring;
+            std::atomic<uint64_t> writeCount;
+
+            DBTTrace(const DBTTrace&) = delete;
+            void operator=(const DBTTrace&) = delete;
+
+        public:
+            /** Creates a trace of the given capacity, zero disables tracing. */
+            DBTTrace(const size_t capacity);
+
+            static DBTTrace& get();
+
+            bool isEnabled() const { return 0 < ring.size(); }
+
+            size_t capacity() const { return ring.size(); }
+
+            /** Returns the number of records written since creation, including overwritten ones. */
+            uint64_t getWriteCount() const { return writeCount.load(); }
+
+            void record(const TraceSource source, const uint64_t timestamp, const uint16_t opcode, const uint16_t subcode,
+                        const uint16_t dev_id, const uint16_t size) {
+                if( 0 < ring.size() ) {
+                    TraceRecord & r = ring[ writeCount.fetch_add(1) % ring.size() ];
+                    r.timestamp = timestamp;
+                    r.opcode = opcode;
+                    r.subcode = subcode;
+                    r.dev_id = dev_id;
+                    r.size = size;
+                    r.source = source;
+                }
+            }
+
+            /** Returns a copy of the recorded records, oldest first. */
+            std::vector<TraceRecord> getRecords() const;
+
+            /** Formats and prints all recorded records, oldest first. */
+            void dump(FILE *out=stderr) const;
+    };
+
+} // namespace direct_bt
+
+#endif /* DBT_TRACE_HPP_ */
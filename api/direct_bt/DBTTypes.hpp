@@ -27,6 +27,7 @@
 #define DBT_TYPES_HPP_
 
 #include <mutex>
+#include <algorithm>
 #include <atomic>
 
 #include "UUID.hpp"
@@ -43,35 +44,36 @@ namespace direct_bt {
     class DBTAdapter; // forward
     class DBTDevice; // forward
 
+    /**
+     * Base of all native objects exposed to the API and JNI, providing the object's validity.
+     * <p>
+     * isValid() and checkValid() are a single atomic acquire load, hence lock-free
+     * and never contending with a concurrent invalidation by the object's destruction.
+     * </p>
+     * <p>
+     * The object's teardown is deferred by its shared ownership, i.e. the owning DBTAdapter or DBTManager
+     * and all std::shared_ptr references, while the validity flag only guards against entry points
+     * reaching an already destructed object.
+     * </p>
+     */
     class DBTObject : public JavaUplink
     {
         protected:
             std::atomic_bool valid;
-            std::mutex lk;
 
             DBTObject() : valid(true) {}
 
-            bool lock() {
-                 if (valid) {
-                     lk.lock();
-                     return true;
-                 } else {
-                     return false;
-                 }
-             }
-
-             void unlock() {
-                 lk.unlock();
-             }
+            /** Marks this object invalid, visible to all subsequent isValid() loads. */
+            void invalidate() { valid.store(false, std::memory_order_release); }
 
         public:
             virtual std::string toString() const { return "DBTObject["+aptrHexString(this)+"]"; }
 
             virtual ~DBTObject() {
-                valid = false;
+                invalidate();
             }
 
-            inline bool isValid() const { return valid.load(); }
+            inline bool isValid() const { return valid.load(std::memory_order_acquire); }
 
             /**
              * Throws an IllegalStateException if isValid() == false
@@ -117,6 +119,138 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * Fixed size ring of the most recent RSSI samples of one device,
+     * maintaining an exponentially weighted moving average (EWMA) as the smoothed RSSI.
+     * <p>
+     * Not thread safe, the owner shall synchronize access.
+     * </p>
+     */
+    class RSSIHistory
+    {
+        public:
+            struct Sample {
+                /** Timestamp in monotonic milliseconds, see BasicTypes::getCurrentMilliseconds() */
+                uint64_t timestamp;
+                int8_t rssi;
+            };
+            enum Defaults : int {
+                CAPACITY = 16
+            };
+            /** The core spec defines 127 as the "not available" value */
+            static constexpr int8_t RSSI_NONE = 127;
+
+        private:
+            Sample samples[CAPACITY];
+            int count;
+            int next;
+            /** Weight of a new sample in percent [1..100], 100 disables smoothing */
+            int32_t weight;
+            float smoothed;
+
+        public:
+            RSSIHistory(const int32_t weight_=100)
+            : count(0), next(0), weight( std::max<int32_t>(1, std::min<int32_t>(100, weight_)) ), smoothed(0) {}
+
+            /** Adds the given sample, ignoring RSSI_NONE, and updates the smoothed RSSI. */
+            void add(const uint64_t timestamp, const int8_t rssi);
+
+            /** Drops all samples. */
+            void clear() { count = 0; next = 0; smoothed = 0; }
+
+            int getWeight() const { return weight; }
+            int size() const { return count; }
+            bool isEmpty() const { return 0 == count; }
+
+            /** Returns the i-th sample, 0 being the oldest, size()-1 the most recent. */
+            const Sample & get(const int i) const { return samples[ ( next - count + i + CAPACITY ) % CAPACITY ]; }
+
+            /** Returns the most recent RSSI or RSSI_NONE if empty. */
+            int8_t getLast() const { return 0 < count ? get(count-1).rssi : RSSI_NONE; }
+
+            /** Returns the rounded smoothed RSSI or RSSI_NONE if empty. */
+            int8_t getSmoothed() const;
+
+            /** Returns all samples, oldest first. */
+            std::vector<Sample> toVector() const;
+
+            std::string toString() const;
+    };
+
+    /**
+     * Advertising interval estimation of one device from its discovery timestamps.
+     * <p>
+     * Each advertising event is sent at advInterval plus a pseudo random advDelay of [0..10]ms,
+     * see BT Core Spec v5.2: Vol 6, Part B Link Layer: 4.4.2.2 Advertising Interval.
+     * Hence the gap between two received events is at least the advertising interval,
+     * or a multiple of it if events have been missed while the scanner was off or on another channel.
+     * </p>
+     * <p>
+     * The estimate is the minimum of the most recent CAPACITY gaps,
+     * ignoring gaps below MIN_INTERVAL_MS, i.e. a scan response or another PDU of the same event,
+     * and above MAX_INTERVAL_MS, i.e. a pause in discovery.
+     * </p>
+     * <p>
+     * No estimate is available if the controller filters duplicate reports.
+     * </p>
+     * <p>
+     * Not thread safe, the owner shall synchronize access.
+     * </p>
+     */
+    class AdvIntervalEstimator
+    {
+        public:
+            enum Defaults : int {
+                CAPACITY = 8,
+                /** Minimum legacy advertising interval of 20ms */
+                MIN_INTERVAL_MS = 20,
+                /** Maximum legacy advertising interval of 10.24s */
+                MAX_INTERVAL_MS = 10240,
+                /** Maximum advDelay added to each advertising event */
+                MAX_ADV_DELAY_MS = 10
+            };
+
+        private:
+            uint32_t gaps[CAPACITY];
+            int count;
+            int next;
+            uint64_t lastTimestamp;
+
+        public:
+            AdvIntervalEstimator()
+            : count(0), next(0), lastTimestamp(0) {}
+
+            /** Adds the given discovery timestamp in monotonic milliseconds, see BasicTypes::getCurrentMilliseconds(). */
+            void add(const uint64_t timestamp);
+
+            /** Drops all samples. */
+            void clear() { count = 0; next = 0; lastTimestamp = 0; }
+
+            /** Returns the number of recent gaps the estimate is based on. */
+            int size() const { return count; }
+
+            /** Returns the estimated advertising interval in milliseconds or zero if unknown. */
+            uint32_t getInterval() const;
+
+            /**
+             * Returns the LE scan interval and window in units of 0.625ms for connecting to a device
+             * advertising at the given interval in milliseconds, see DBTDevice::connectLEAuto().
+             * <p>
+             * Scanning continuously with a window covering one full advertising interval plus advDelay
+             * guarantees the first window to receive an advertising event, independent of the controller's
+             * channel switching between windows. Hence the expected connect latency is half the advertising interval
+             * and bounded by one interval plus advDelay.
+             * </p>
+             * <p>
+             * An unknown interval, i.e. zero, results in the connectLE() default of 48 for 30ms.
+             * The result is clamped to [48..0x4000], never shorter than the default.
+             * </p>
+             */
+            static uint16_t getConnectScanWindow(const uint32_t advIntervalMS);
+
+            std::string toString() const;
+    };
+
     class NameAndShortName
     {
         friend class DBTManager; // top manager
@@ -145,6 +279,26 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * Liveness check of a connected device, see DBTDevice::ping() and DBTAdapter::startKeepAlive().
+     */
+    enum class KeepAliveMode : uint8_t {
+        /** ATT read of the Generic Access Appearance via DBTDevice::pingGATT(), spending air time and peer processing. */
+        GATT = 0,
+        /**
+         * HCI Read RSSI of the connection w/o air time, answered by the local controller.
+         * Fails with HCIStatusCode::UNKNOWN_CONNECTION_IDENTIFIER once the controller dropped the link,
+         * e.g. after its supervision timeout, detecting a disconnect event missed by the host.
+         */
+        RSSI = 1,
+        /**
+         * Connection state maintained by disconnect events only w/o any command,
+         * i.e. liveness bound by the connection's supervision timeout.
+         */
+        LINK = 2
+    };
+    std::string getKeepAliveModeString(const KeepAliveMode mode);
+
     enum class AdapterSetting : uint32_t {
         NONE               =          0,
         POWERED            = 0x00000001,
@@ -188,6 +342,124 @@ namespace direct_bt {
     /** Maps the given {@link AdapterSetting} to {@link BTMode} */
     BTMode getAdapterSettingsBTMode(const AdapterSetting settingMask);
 
+    /**
+     * Capabilities of the local controller, probed once by HCIHandler at open time
+     * and stored in its AdapterInfo, see AdapterInfo::getControllerCaps().
+     * <p>
+     * The tuning methods size ring capacities, the pipelining depth of GATT requests,
+     * the number of concurrent connection pipelines and the LE data length
+     * according to the controller's actual limits, falling back to the configured value if unknown.
+     * </p>
+     * <p>
+     * A zero value denotes an unknown capability, i.e. its probing command is not supported by the controller
+     * or the LE buffers are shared with BR/EDR.
+     * </p>
+     */
+    class ControllerCaps
+    {
+        public:
+            enum Defaults : int32_t {
+                /** Upper bound of getPipelineDepth() */
+                MAX_PIPELINE_DEPTH = 32,
+                /** Number of full controller buffers a reply ring shall hold, see getRingCapacity() */
+                RING_BUFFER_FACTOR = 4,
+                /** Upper bound of getRingCapacity() */
+                MAX_RING_CAPACITY = 1024,
+                /** LE data length in octets of HCIHandler::le_set_data_length() if unknown */
+                DEF_DATA_LEN_TX_OCTETS = 251,
+                /** LE data length transmit time in microseconds of HCIHandler::le_set_data_length() if unknown */
+                DEF_DATA_LEN_TX_TIME = 2120
+            };
+
+            /** LE feature bits, BT Core Spec v5.2: Vol 6, Part B Link Layer: 4.6 Feature Support */
+            enum class LEFeature : uint8_t {
+                ENCRYPTION      =  0,
+                DATA_LEN_EXT    =  5,
+                LL_PRIVACY      =  6,
+                PHY_2M          =  8,
+                PHY_CODED       = 11,
+                EXT_ADV         = 12,
+                PERIODIC_ADV    = 13
+            };
+
+            /** True if READ_LOCAL_VERSION succeeded, otherwise all values are zero */
+            bool probed;
+            uint8_t hci_version;
+            uint16_t hci_revision;
+            uint8_t lmp_version;
+            uint16_t lmp_subversion;
+            uint16_t manufacturer;
+            /** LE_Features bit-mask of LE_Read_Local_Supported_Features */
+            uint64_t le_features;
+            /** Maximum length of one LE ACL data packet of LE_Read_Buffer_Size */
+            uint16_t le_acl_mtu;
+            /** Number of LE ACL data packets buffered by the controller of LE_Read_Buffer_Size */
+            uint8_t le_acl_pkts;
+            /** Number of LE_Read_White_List_Size entries */
+            uint8_t white_list_size;
+            /** Number of LE_Read_Resolving_List_Size entries */
+            uint8_t resolv_list_size;
+            /** Supported maximum transmit and receive data length in octets and microseconds of LE_Read_Maximum_Data_Length */
+            uint16_t max_tx_octets;
+            uint16_t max_tx_time;
+            uint16_t max_rx_octets;
+            uint16_t max_rx_time;
+
+            ControllerCaps()
+            : probed(false), hci_version(0), hci_revision(0), lmp_version(0), lmp_subversion(0), manufacturer(0),
+              le_features(0), le_acl_mtu(0), le_acl_pkts(0), white_list_size(0), resolv_list_size(0),
+              max_tx_octets(0), max_tx_time(0), max_rx_octets(0), max_rx_time(0) {}
+
+            bool isLEFeatureSupported(const LEFeature f) const {
+                return 0 != ( le_features & ( static_cast<uint64_t>(1) << static_cast<uint8_t>(f) ) );
+            }
+
+            /**
+             * Returns the number of outstanding pipelined requests of one connection for the configured window.
+             * <p>
+             * A positive window is capped to the controller's LE ACL buffer count,
+             * as further requests only queue up in the host.
+             * A zero window selects the LE ACL buffer count, capped to MAX_PIPELINE_DEPTH.
+             * </p>
+             * <p>
+             * If the buffer count is unknown, a positive window is returned unchanged and a zero window results in 1.
+             * </p>
+             */
+            int32_t getPipelineDepth(const int32_t configured) const;
+
+            /**
+             * Returns the capacity of a per connection reply ring for the configured capacity,
+             * grown to hold RING_BUFFER_FACTOR times the controller's LE ACL buffer count, capped to MAX_RING_CAPACITY.
+             * <p>
+             * The configured capacity is never reduced.
+             * </p>
+             */
+            int32_t getRingCapacity(const int32_t configured) const;
+
+            /**
+             * Returns the number of concurrent connection pipelines for the requested number, at least one.
+             * <p>
+             * The GATT stage of each connection occupies at least one of the controller's LE ACL buffers,
+             * hence the requested number is capped to the LE ACL buffer count if known.
+             * </p>
+             */
+            int getMaxConcurrentConnections(const int requested) const;
+
+            /**
+             * Returns the LE data length in octets for HCIHandler::le_set_data_length(),
+             * i.e. the controller's maximum supported transmit octets or DEF_DATA_LEN_TX_OCTETS if unknown.
+             */
+            uint16_t getDataLenTxOctets() const;
+
+            /**
+             * Returns the LE data length transmit time in microseconds for HCIHandler::le_set_data_length(),
+             * i.e. the controller's maximum supported transmit time or DEF_DATA_LEN_TX_TIME if unknown.
+             */
+            uint16_t getDataLenTxTime() const;
+
+            std::string toString() const;
+    };
+
     class AdapterInfo
     {
         friend class DBTManager; // top manager
@@ -205,6 +477,7 @@ namespace direct_bt {
             uint32_t dev_class;
             std::string name;
             std::string short_name;
+            ControllerCaps controllerCaps;
 
             /**
              * Sets the current_setting and returns the changed AdapterSetting bit-mask.
@@ -221,6 +494,7 @@ namespace direct_bt {
             void setDevClass(const uint32_t v) { dev_class = v; }
             void setName(const std::string v) { name = v; }
             void setShortName(const std::string v) { short_name = v; }
+            void setControllerCaps(const ControllerCaps & v) { controllerCaps = v; }
 
         public:
             AdapterInfo(const int dev_id, const EUI48 & address,
@@ -244,11 +518,17 @@ namespace direct_bt {
             /** Map {@link #getCurrentSetting()} to {@link BTMode} */
             BTMode getCurrentBTMode() const { return getAdapterSettingsBTMode(current_setting); }
 
+            /**
+             * Returns the ControllerCaps probed by the adapter's HCIHandler,
+             * ControllerCaps::probed is false until the HCIHandler has been opened.
+             */
+            const ControllerCaps & getControllerCaps() const { return controllerCaps; }
+
             std::string toString() const {
                 return "Adapter[id "+std::to_string(dev_id)+", address "+address.toString()+", version "+std::to_string(version)+
                         ", manuf "+std::to_string(manufacturer)+
                         ", settings[sup "+getAdapterSettingsString(supported_setting)+", cur "+getAdapterSettingsString(current_setting)+
-                        "], name '"+name+"', shortName '"+short_name+"']";
+                        "], name '"+name+"', shortName '"+short_name+"', "+controllerCaps.toString()+"]";
             }
     };
 
@@ -0,0 +1,223 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DBT_WORKFLOW_HPP_
+#define DBT_WORKFLOW_HPP_
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+
+#include "DBTEnv.hpp"
+
+namespace direct_bt {
+
+    /**
+     * Fixed number of worker threads executing posted jobs in order,
+     * shared by many DBTWorkflow.
+     */
+    class DBTExecutor {
+        private:
+            const int threadCount;
+            const DBTThreadOptions threadOptions;
+            std::mutex mtx_jobs;
+            std::condition_variable cv_jobs;
+            std::deque<std::function<void()>> jobs;
+            std::vector<std::thread::id> workerIds;
+            int workersRunning;
+            bool running;
+            std::atomic<uint64_t> executedCount;
+
+            DBTExecutor(const int threadCount, const DBTThreadOptions & threadOptions);
+
+            void workerImpl();
+
+        public:
+            /** Returns a new started executor with the given number of worker threads, at least one. */
+            static std::shared_ptr<DBTExecutor> create(const int threadCount, const DBTThreadOptions & threadOptions);
+
+            /**
+             * Returns the executor shared by default by all DBTWorkflow.
+             * <p>
+             * Its number of worker threads is given by the environment variable 'direct_bt.workflow.threads',
+             * default 2, range [1..64], its DBTThreadOptions by the prefix 'direct_bt.workflow'.
+             * </p>
+             */
+            static std::shared_ptr<DBTExecutor> getShared();
+
+            DBTExecutor(const DBTExecutor&) = delete;
+            void operator=(const DBTExecutor&) = delete;
+
+            /**
+             * Queues the given job, executed by the next idle worker thread.
+             * @return false if this executor has been stopped, dropping the job
+             */
+            bool post(std::function<void()> job);
+
+            /**
+             * Stops all workers, discarding all queued jobs.
+             * @param wait if true, waits until all workers have ended their current job, unless called by a worker itself.
+             */
+            void stop(const bool wait);
+
+            bool isRunning();
+            int getThreadCount() const { return threadCount; }
+            int getQueueSize();
+            uint64_t getExecutedCount() const { return executedCount; }
+
+            std::string toString();
+    };
+
+    /**
+     * Sequence of asynchronous steps, performed one after another w/o blocking a thread in between,
+     * i.e. the C++11 counterpart of a coroutine awaiting each asynchronous operation.
+     * <p>
+     * Each Step is run on a DBTExecutor thread, starts its asynchronous operation
+     * and returns. Its operation's completion, e.g. a GATTHandler::ReadValueCallback
+     * or an AdapterStatusListener event, calls Continuation::resume() to run the next step
+     * or Continuation::fail() to abort the workflow. Thousands of workflows hence share
+     * the few threads of their executor, while they await their operations.
+     * </p>
+     * <p>
+     * Blocking operations, e.g. DBTDevice::connectGATT(), may be sequenced via thenBlocking(),
+     * occupying an executor thread for their duration.
+     * </p>
+     * <p>
+     * Example, reading a value after connecting GATT:
+     * <pre>
+     *   std::shared_ptr<POctets> value = std::make_shared<POctets>(0);
+     *   std::shared_ptr<DBTWorkflow> wf = DBTWorkflow::create();
+     *   wf->thenBlocking([device]() { return nullptr != device->connectGATT(); }, "connectGATT")
+     *      .then([device, handle, value](const DBTWorkflow::Continuation & next) {
+     *           device->getGATTHandler()->readValueAsync(handle, -1, [next, value](std::shared_ptr<POctets> v) {
+     *               if( nullptr == v ) { next.fail("readValue"); } else { *value = *v; next.resume(); }
+     *           });
+     *       });
+     *   wf->start([value](const bool success, const std::string & cause) { ... });
+     * </pre>
+     * </p>
+     */
+    class DBTWorkflow : public std::enable_shared_from_this<DBTWorkflow> {
+        public:
+            /**
+             * Handle of one awaiting step, resuming its workflow.
+             * <p>
+             * Copies refer to the same step and may be called from any thread,
+             * only the first resume() or fail() of a step is effective.
+             * A workflow whose all continuations are destroyed w/o being called ends w/o completion.
+             * </p>
+             */
+            class Continuation {
+                friend class DBTWorkflow;
+                private:
+                    std::shared_ptr<DBTWorkflow> workflow;
+                    size_t step;
+
+                    Continuation(std::shared_ptr<DBTWorkflow> workflow, const size_t step)
+                    : workflow(workflow), step(step) {}
+
+                public:
+                    /** Runs the next step, or completes the workflow successfully after its last step. */
+                    void resume() const;
+
+                    /** Completes the workflow unsuccessfully with the given cause, skipping all remaining steps. */
+                    void fail(const std::string & cause) const;
+            };
+
+            /** Step starting an asynchronous operation, whose completion calls the given Continuation. */
+            typedef std::function<void(const Continuation & next)> Step;
+
+            /** Blocking step, returning true on success. */
+            typedef std::function<bool()> BlockingStep;
+
+            /**
+             * Workflow completion, invoked exactly once on an executor thread,
+             * or on the resuming thread if the executor has been stopped meanwhile.
+             * Receives the cause of the failing step or its exception, otherwise an empty cause.
+             */
+            typedef std::function<void(const bool success, const std::string & cause)> Completion;
+
+        private:
+            const std::shared_ptr<DBTExecutor> executor;
+            std::vector<Step> steps;
+            Completion completion;
+            std::atomic<bool> started;
+            std::atomic<bool> done;
+            /** Index of the step awaiting its continuation, claimed by its first resume() or fail() */
+            std::atomic<size_t> current;
+
+            DBTWorkflow(std::shared_ptr<DBTExecutor> executor);
+
+            void run(const size_t step);
+            void proceed(const size_t step, const bool success, const std::string & cause);
+            void complete(const bool success, const std::string & cause);
+
+        public:
+            /** Returns a new workflow w/o steps, performed by the given executor. */
+            static std::shared_ptr<DBTWorkflow> create(std::shared_ptr<DBTExecutor> executor=DBTExecutor::getShared());
+
+            DBTWorkflow(const DBTWorkflow&) = delete;
+            void operator=(const DBTWorkflow&) = delete;
+
+            /**
+             * Appends the given asynchronous step, ignored after start().
+             */
+            DBTWorkflow & then(Step step);
+
+            /**
+             * Appends the given blocking step, ignored after start().
+             * <p>
+             * The workflow fails with the given cause if the step returns false.
+             * </p>
+             */
+            DBTWorkflow & thenBlocking(BlockingStep step, const std::string & cause);
+
+            /**
+             * Starts this workflow with its first step, invoking the given completion after its last.
+             * @return false if already started or if the executor has been stopped
+             */
+            bool start(Completion completion);
+
+            bool isStarted() const { return started; }
+
+            /** Returns true if this workflow has completed, successfully or not. */
+            bool isDone() const { return done; }
+
+            size_t getStepCount() const { return steps.size(); }
+
+            /** Returns the number of resumed or failed steps, i.e. the index of the awaiting step while running. */
+            size_t getFinishedStepCount() const { return current; }
+    };
+
+} // namespace direct_bt
+
+#endif /* DBT_WORKFLOW_HPP_ */
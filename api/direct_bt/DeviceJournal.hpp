@@ -0,0 +1,143 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEVICE_JOURNAL_HPP_
+#define DEVICE_JOURNAL_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+namespace direct_bt {
+
+    /**
+     * Bounded journal of a device list's changes, i.e. its added and removed elements tagged with the list's version.
+     * <p>
+     * Allows a client to retrieve the net changes since its last known version via getChanges(),
+     * instead of copying the whole list, e.g. for periodic polling of thousands of discovered devices.
+     * </p>
+     * <p>
+     * Only the last capacity changes are retained, a client lagging further behind
+     * has to retrieve the whole list again.
+     * </p>
+     * <p>
+     * Not thread safe, shall be guarded by the mutex of the journaled list.
+     * </p>
+     */
+    template<typename T> class DeviceJournal {
+        public:
+            typedef std::shared_ptr<T> element_t;
+
+        private:
+            struct Change {
+                uint64_t version;
+                element_t element;
+                bool added;
+            };
+            const size_t capacity;
+            std::deque<Change> changes;
+            /** Current version */
+            uint64_t version;
+            /** Oldest version changes can be retrieved from */
+            uint64_t baseVersion;
+
+            void push(const element_t & e, const bool added) {
+                changes.push_back( Change { ++version, e, added } );
+                while( changes.size() > capacity ) {
+                    baseVersion = changes.front().version;
+                    changes.pop_front();
+                }
+            }
+
+        public:
+            explicit DeviceJournal(const size_t capacity_)
+            : capacity(0 < capacity_ ? capacity_ : 1), version(0), baseVersion(0) {}
+
+            /** Returns the current version, incremented with each change. Initial version is zero. */
+            uint64_t getVersion() const { return version; }
+
+            /** Returns the number of retained changes. */
+            size_t size() const { return changes.size(); }
+
+            void added(const element_t & e) { push(e, true); }
+
+            void removed(const element_t & e) { push(e, false); }
+
+            /**
+             * Drops all changes and increments the version, e.g. if the list has been cleared.
+             * <p>
+             * Changes since any older version are no more available.
+             * </p>
+             */
+            void reset() {
+                changes.clear();
+                baseVersion = ++version;
+            }
+
+            /**
+             * Retrieves the net changes since the given version, in order of their first change.
+             * <p>
+             * An element added and removed since the given version is omitted, as is an element removed and added again.
+             * </p>
+             * @param since the client's last known version
+             * @param added receives the elements added since the given version
+             * @param removed receives the elements removed since the given version
+             * @return true if the changes are available, otherwise false
+             *         if the given version is older than the retained changes or newer than the current version.
+             */
+            bool getChanges(const uint64_t since, std::vector<element_t> & added, std::vector<element_t> & removed) const {
+                if( since < baseVersion || since > version ) {
+                    return false;
+                }
+                std::vector<std::pair<element_t, int>> net;
+                std::unordered_map<const T*, size_t> index;
+                for(auto it = changes.begin(); it != changes.end(); ++it) {
+                    if( it->version <= since ) {
+                        continue;
+                    }
+                    auto idx = index.find(it->element.get());
+                    if( index.end() == idx ) {
+                        index[it->element.get()] = net.size();
+                        net.push_back( std::make_pair(it->element, it->added ? 1 : -1) );
+                    } else {
+                        net[idx->second].second += it->added ? 1 : -1;
+                    }
+                }
+                for(auto it = net.begin(); it != net.end(); ++it) {
+                    if( 0 < it->second ) {
+                        added.push_back(it->first);
+                    } else if( 0 > it->second ) {
+                        removed.push_back(it->first);
+                    }
+                }
+                return true;
+            }
+    };
+
+} // namespace direct_bt
+
+#endif /* DEVICE_JOURNAL_HPP_ */
@@ -0,0 +1,143 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEVICE_SIGHTING_HPP_
+#define DEVICE_SIGHTING_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+#include "BTAddress.hpp"
+#include "BTTypes.hpp"
+
+namespace direct_bt {
+
+    /**
+     * Slim record of a merely discovered device, not retained as a DBTDevice, see DeviceSightingTable.
+     * <p>
+     * Holds no heap allocated data, i.e. neither name, manufacturer data nor services,
+     * those are only available via the EInfoReport offered to AdapterStatusListener::retainDevice().
+     * </p>
+     */
+    struct DeviceSighting {
+        /** Time of the first report in monotonic milliseconds */
+        uint64_t ts_first;
+        /** Time of the last report in monotonic milliseconds */
+        uint64_t ts_last;
+        /** Accumulated EIRDataType of all reports */
+        EIRDataType eirMask;
+        /** Number of reports */
+        uint32_t count;
+        EUI48 address;
+        BDAddressType addressType;
+        /** AD_PDU_Type of the last report */
+        AD_PDU_Type evtType;
+        /** RSSI of the last report */
+        int8_t rssi;
+        /** Last reported TX power, valid if eirMask contains EIRDataType::TX_POWER */
+        int8_t tx_power;
+
+        std::string toString() const;
+    };
+
+    /**
+     * Bounded table of DeviceSighting by address and address type,
+     * tracking discovered devices w/o the footprint of a DBTDevice, see DBTAdapter::getDeviceSightings().
+     * <p>
+     * Exceeding its capacity, the least recently seen eighth of all sightings is evicted at once,
+     * amortizing the eviction cost across subsequent insertions.
+     * </p>
+     * <p>
+     * Thread safe.
+     * </p>
+     */
+    class DeviceSightingTable {
+        private:
+            const size_t capacity;
+            mutable std::mutex mtx;
+            std::unordered_map<BDAddressKey, DeviceSighting> sightings;
+
+            /** Evicts the least recently seen sightings exceeding capacity, caller holds mtx. */
+            void trim();
+
+        public:
+            /** Approximate footprint of one sighting in bytes, i.e. its hash node w/o buckets. */
+            static constexpr size_t ENTRY_SIZE = sizeof(void*) + sizeof(std::size_t) + sizeof(BDAddressKey) + sizeof(DeviceSighting);
+
+            /**
+             * @param capacity maximum number of sightings, zero disables the table
+             */
+            explicit DeviceSightingTable(const int32_t capacity);
+
+            DeviceSightingTable(const DeviceSightingTable&) = delete;
+            void operator=(const DeviceSightingTable&) = delete;
+
+            bool isEnabled() const { return 0 < capacity; }
+            size_t getCapacity() const { return capacity; }
+
+            /**
+             * Records the given report, creating a new sighting if not existing.
+             * @param eir the report
+             * @param created set to true if a new sighting has been created, otherwise false
+             * @return the EIRDataType of the report not seen before by this sighting,
+             *         i.e. all of the report's data for a new sighting
+             */
+            EIRDataType add(const EInfoReport & eir, bool & created);
+
+            /** Returns true and a copy of the sighting if existing, otherwise false. */
+            bool get(const EUI48 & address, const BDAddressType addressType, DeviceSighting & res) const;
+
+            /** Removes the sighting, returns true if existing. */
+            bool remove(const EUI48 & address, const BDAddressType addressType);
+
+            /**
+             * Removes all sightings not seen for their time to live.
+             * @param ts_now current time in monotonic milliseconds
+             * @param ttl time to live in milliseconds since the last report, zero for unlimited
+             * @param nrpaTTL time to live of non-resolvable private addresses, zero for using ttl
+             * @return number of removed sightings
+             */
+            int evictExpired(const uint64_t ts_now, const int32_t ttl, const int32_t nrpaTTL);
+
+            void clear();
+
+            size_t size() const;
+
+            /** Returns the approximate memory footprint in bytes, see ENTRY_SIZE. */
+            size_t getMemoryFootprint() const;
+
+            /** Returns a copy of all sightings in no particular order. */
+            std::vector<DeviceSighting> getSightings() const;
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* DEVICE_SIGHTING_HPP_ */
@@ -0,0 +1,161 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DEVICE_UPDATE_COALESCER_HPP_
+#define DEVICE_UPDATE_COALESCER_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "BTTypes.hpp"
+
+namespace direct_bt {
+
+    class DBTDevice; // forward
+    class AdapterStatusListener; // forward
+
+    /**
+     * Delivery policy of AdapterStatusListener::deviceUpdated() notifications of one listener,
+     * see AdapterStatusListener::getDeviceUpdatePolicy().
+     * <p>
+     * If minIntervalMS is greater than zero, updates of one device are delivered at most once per minIntervalMS,
+     * merging the update masks of deferred updates. Deferred updates are delivered on the timer thread of DeviceUpdateCoalescer.
+     * </p>
+     * <p>
+     * Updates containing a bit of immediateMask are delivered without delay, including all pending bits.
+     * </p>
+     */
+    class DeviceUpdatePolicy {
+        public:
+            uint32_t minIntervalMS;
+            EIRDataType immediateMask;
+
+            DeviceUpdatePolicy(const uint32_t minIntervalMS_=0, const EIRDataType immediateMask_=EIRDataType::NONE)
+            : minIntervalMS(minIntervalMS_), immediateMask(immediateMask_) {}
+
+            bool isCoalescing() const { return 0 < minIntervalMS; }
+
+            /**
+             * Returns the default policy, read once from the environment variables
+             * <pre>
+             * - 'direct_bt.adapter.updates.interval': minIntervalMS, defaults to 0, i.e. no coalescing
+             * - 'direct_bt.adapter.updates.immediate': immediateMask as EIRDataType bits, defaults to
+             *   NAME | NAME_SHORT | MANUF_DATA | SERVICE_UUID | APPEARANCE, i.e. all but RSSI and TX_POWER.
+             * </pre>
+             */
+            static const DeviceUpdatePolicy & getDefault();
+
+            std::string toString() const;
+    };
+
+    /**
+     * Coalesces AdapterStatusListener::deviceUpdated() notifications per listener and device
+     * according to each listener's DeviceUpdatePolicy.
+     * <p>
+     * Its single timer thread is started with the first deferred update.
+     * </p>
+     */
+    class DeviceUpdateCoalescer {
+        private:
+            struct Entry {
+                std::shared_ptr<AdapterStatusListener> listener;
+                std::weak_ptr<DBTDevice> device;
+                uint32_t minIntervalMS;
+                EIRDataType pendingMask;
+                uint64_t pendingTimestamp;
+                /** Time of last delivery in monotonic milliseconds */
+                uint64_t ts_last_sent;
+            };
+            typedef std::pair<const AdapterStatusListener *, const DBTDevice *> key_t;
+
+            /**
+             * State shared with the timer thread, which holds a reference until it has ended.
+             * <p>
+             * Hence the timer thread may outlive this instance if detached by stop() from within a callback.
+             * </p>
+             */
+            struct State {
+                std::mutex mtx_entries;
+                std::condition_variable cv_entries;
+                std::map<key_t, Entry> entries;
+                bool running;
+                bool stopped;
+
+                State() : running(false), stopped(false) {}
+            };
+
+            const std::shared_ptr<State> state;
+            std::thread timerThread;
+
+            static void deliver(const std::shared_ptr<AdapterStatusListener> & l, const std::shared_ptr<DBTDevice> & device,
+                                const EIRDataType updateMask, const uint64_t timestamp);
+            static void timerImpl(const std::shared_ptr<State> s);
+
+            DeviceUpdateCoalescer(const DeviceUpdateCoalescer&) = delete;
+            void operator=(const DeviceUpdateCoalescer&) = delete;
+
+        public:
+            DeviceUpdateCoalescer() : state(std::make_shared<State>()) {}
+
+            /** Stops the timer thread, see stop(). */
+            ~DeviceUpdateCoalescer();
+
+            /**
+             * Delivers the given update to the listener immediately or defers it, merging it with pending updates.
+             * <p>
+             * Caller shall have tested AdapterStatusListener::matchDevice() already.
+             * </p>
+             */
+            void update(const std::shared_ptr<AdapterStatusListener> & l, const DeviceUpdatePolicy & policy,
+                        const std::shared_ptr<DBTDevice> & device, const EIRDataType updateMask, const uint64_t timestamp);
+
+            /** Drops all pending updates of the given listener. */
+            void removeListener(const AdapterStatusListener * l);
+
+            /** Drops all pending updates. */
+            void clear();
+
+            /**
+             * Drops all pending updates and stops the timer thread, waiting for a current delivery to complete.
+             * <p>
+             * If called from within a deferred delivery, the timer thread ends after the callback has returned.
+             * </p>
+             */
+            void stop();
+
+            /** Returns the number of tracked listener and device pairs. */
+            size_t size();
+    };
+
+} // namespace direct_bt
+
+#endif /* DEVICE_UPDATE_COALESCER_HPP_ */
@@ -0,0 +1,150 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef DISCOVERY_FILTER_HPP_
+#define DISCOVERY_FILTER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include "UUID.hpp"
+#include "BTAddress.hpp"
+#include "BTTypes.hpp"
+
+namespace direct_bt {
+
+    class DBTDevice; // forward
+
+    /**
+     * Declarative discovery filter, evaluated against the received EInfoReport
+     * before a new DBTDevice gets created by DBTAdapter.
+     * <p>
+     * Each non empty criteria must be satisfied by the EInfoReport (AND),
+     * while satisfying one of its values is sufficient (OR):
+     * <pre>
+     * - addresses: address and address type, BDAddressType::BDADDR_UNDEFINED matches any type
+     * - address types: BDAddressType of the report
+     * - services: advertised service UUIDs
+     * - companies: company identifier of the manufacturer specific data
+     * - name prefixes: complete or short local name
+     * - minimum RSSI
+     * </pre>
+     * An empty filter matches all reports.
+     * </p>
+     * <p>
+     * A criteria relying on advertising data absent in the EInfoReport rejects it,
+     * e.g. a name prefix only matches once the name has been advertised,
+     * which may be the later scan response.
+     * </p>
+     */
+    class DiscoveryFilter {
+        public:
+            /** RSSI value denoting no minimum RSSI */
+            static constexpr int8_t RSSI_NONE = INT8_MIN;
+
+        private:
+            std::unordered_set<BDAddressKey> addresses;
+            std::vector<BDAddressType> addressTypes;
+            std::vector<uuid_value_t> services;
+            std::vector<uint16_t> companies;
+            std::vector<std::string> namePrefixes;
+            int8_t minRSSI;
+
+            static bool hasPrefix(const std::string & name, const std::string & prefix) {
+                return name.size() >= prefix.size() && 0 == name.compare(0, prefix.size(), prefix);
+            }
+
+        public:
+            DiscoveryFilter() : minRSSI(RSSI_NONE) {}
+
+            /** Adds the given address, BDAddressType::BDADDR_UNDEFINED matches any address type. */
+            DiscoveryFilter & addAddress(const EUI48 & address, const BDAddressType addressType=BDAddressType::BDADDR_UNDEFINED) {
+                addresses.insert(BDAddressKey(address, addressType));
+                return *this;
+            }
+            DiscoveryFilter & addAddressType(const BDAddressType addressType) {
+                addressTypes.push_back(addressType);
+                return *this;
+            }
+            DiscoveryFilter & addService(const uuid_value_t & uuid) {
+                services.push_back(uuid);
+                return *this;
+            }
+            /** Adds the given company identifier of the manufacturer specific data */
+            DiscoveryFilter & addCompany(const uint16_t company) {
+                companies.push_back(company);
+                return *this;
+            }
+            /** Adds the given prefix of the complete or short local name */
+            DiscoveryFilter & addNamePrefix(const std::string & prefix) {
+                namePrefixes.push_back(prefix);
+                return *this;
+            }
+            /** Sets the minimum RSSI in dBm, RSSI_NONE for none. */
+            DiscoveryFilter & setMinRSSI(const int8_t rssi) {
+                minRSSI = rssi;
+                return *this;
+            }
+
+            const std::unordered_set<BDAddressKey> & getAddresses() const { return addresses; }
+            const std::vector<BDAddressType> & getAddressTypes() const { return addressTypes; }
+            const std::vector<uuid_value_t> & getServices() const { return services; }
+            const std::vector<uint16_t> & getCompanies() const { return companies; }
+            const std::vector<std::string> & getNamePrefixes() const { return namePrefixes; }
+            int8_t getMinRSSI() const { return minRSSI; }
+
+            /** Returns true if no criteria has been set, i.e. all reports match. */
+            bool isEmpty() const {
+                return addresses.empty() && addressTypes.empty() && services.empty() &&
+                       companies.empty() && namePrefixes.empty() && RSSI_NONE == minRSSI;
+            }
+
+            /**
+             * Returns true if only addresses of defined LE address types are set,
+             * i.e. the filter is fully covered by the controller's whitelist.
+             */
+            bool isAddressOnly() const;
+
+            /** Returns true if the given EInfoReport satisfies all set criteria. */
+            bool match(const EInfoReport & eir) const;
+
+            /**
+             * Returns true if the given DBTDevice satisfies all set criteria,
+             * evaluated against its accumulated DBTDevice::getAdvertisedData() snapshot.
+             * <p>
+             * Allows AdapterStatusListener::matchDevice() to reuse a DiscoveryFilter,
+             * dropping events of irrelevant devices before they reach the listener.
+             * </p>
+             */
+            bool match(const DBTDevice & device) const;
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* DISCOVERY_FILTER_HPP_ */
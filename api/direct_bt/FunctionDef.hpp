@@ -32,6 +32,10 @@
 #include <cstdint>
 #include <vector>
 #include <functional>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <cstddef>
 
 #include "BasicTypes.hpp"
 
@@ -305,75 +309,341 @@ namespace direct_bt {
             }
     };
 
+    template<typename R, typename... A> class FunctionDef;
+
+    /**
+     * InvocationFunc wrapping a FunctionDef, as returned by FunctionDef::cloneFunction().
+     * <p>
+     * Passing it back to FunctionDef::FunctionDef(InvocationFunc<R, A...> *) unwraps the FunctionDef,
+     * hence preserving its identity for equality.
+     * </p>
+     */
+    template<typename R, typename... A>
+    class DelegateInvocationFunc : public InvocationFunc<R, A...> {
+        private:
+            FunctionDef<R, A...> delegate;
+
+        public:
+            enum Defaults : int32_t { TYPE = 20 };
+
+            DelegateInvocationFunc(const FunctionDef<R, A...> & _delegate)
+            : delegate(_delegate) {
+            }
+
+            const FunctionDef<R, A...> & getDelegate() const { return delegate; }
+
+            int getType() const override { return TYPE; }
+
+            InvocationFunc<R, A...> * clone() const override { return new DelegateInvocationFunc(*this); }
+
+            R invoke(A... args) override {
+                return delegate.invoke(std::forward<A>(args)...);
+            }
+
+            bool operator==(const InvocationFunc<R, A...>& rhs) const override
+            {
+                if( &rhs == this ) {
+                    return true;
+                }
+                if( getType() != rhs.getType() ) {
+                    return false;
+                }
+                return delegate == static_cast<const DelegateInvocationFunc<R, A...>*>(&rhs)->delegate;
+            }
+
+            bool operator!=(const InvocationFunc<R, A...>& rhs) const override
+            {
+                return !( *this == rhs );
+            }
+
+            std::string toString() const override {
+                return "DelegateInvocation "+delegate.toString();
+            }
+    };
+
+    /**
+     * Function delegate with identity, see InvocationFunc for the rationale.
+     * <p>
+     * The callable target, i.e. a member-function plus object, a plain function, a capture or a std::function,
+     * is stored in-place within a small inline buffer of INLINE_SIZE bytes,
+     * only larger targets are heap allocated.
+     * Invocation uses one statically bound function pointer per target type,
+     * copy, destruction, equality and toString a static per target type table.
+     * Hence neither creating, copying nor invoking a FunctionDef with an inline target
+     * involves the heap, reference counting or virtual dispatch.
+     * </p>
+     * <p>
+     * Two FunctionDef are equal if their targets have the same type and identity,
+     * e.g. same object and member-function.
+     * </p>
+     */
     template<typename R, typename... A>
     class FunctionDef {
+        public:
+            enum Defaults : int32_t {
+                /** Inline target storage in bytes, fitting a std::function plus identity on common 64-bit platforms. */
+                INLINE_SIZE = 6 * sizeof(void*)
+            };
+
         private:
-            std::shared_ptr<InvocationFunc<R, A...>> func;
+            typedef typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type Storage;
+            typedef R (*Invoker)(Storage & s, A... args);
+
+            /** Static per target type operations */
+            struct Manager {
+                /** Copy constructs into uninitialized dest */
+                void (*copy)(Storage & dest, const Storage & src);
+                /** Move constructs into uninitialized dest and destructs src */
+                void (*move)(Storage & dest, Storage & src);
+                void (*destroy)(Storage & s);
+                /** Called for same target types only */
+                bool (*equals)(const Storage & a, const Storage & b);
+                std::string (*toString)(const Storage & s);
+            };
+
+            template<typename F, bool inplace = ( sizeof(F) <= sizeof(Storage) && alignof(F) <= alignof(Storage) &&
+                                                  std::is_nothrow_move_constructible<F>::value ) >
+            struct Target;
+
+            /** Target stored inline */
+            template<typename F> struct Target<F, true> {
+                static F & get(Storage & s) { return *reinterpret_cast<F*>(&s); }
+                static const F & get(const Storage & s) { return *reinterpret_cast<const F*>(&s); }
+                static void create(Storage & s, F && f) { new (&s) F(std::move(f)); }
+                static void copy(Storage & dest, const Storage & src) { new (&dest) F(get(src)); }
+                static void move(Storage & dest, Storage & src) { new (&dest) F(std::move(get(src))); get(src).~F(); }
+                static void destroy(Storage & s) { get(s).~F(); }
+            };
+
+            /** Target stored on the heap */
+            template<typename F> struct Target<F, false> {
+                static F * & ptr(Storage & s) { return *reinterpret_cast<F**>(&s); }
+                static F * ptr(const Storage & s) { return *reinterpret_cast<F* const *>(&s); }
+                static F & get(Storage & s) { return *ptr(s); }
+                static const F & get(const Storage & s) { return *ptr(s); }
+                static void create(Storage & s, F && f) { ptr(s) = new F(std::move(f)); }
+                static void copy(Storage & dest, const Storage & src) { ptr(dest) = new F(get(src)); }
+                static void move(Storage & dest, Storage & src) { ptr(dest) = ptr(src); ptr(src) = nullptr; }
+                static void destroy(Storage & s) { delete ptr(s); }
+            };
+
+            template<typename F> struct Ops {
+                static R invoke(Storage & s, A... args) { return Target<F>::get(s).invoke(std::forward<A>(args)...); }
+                static bool equals(const Storage & a, const Storage & b) { return Target<F>::get(a) == Target<F>::get(b); }
+                static std::string toString(const Storage & s) { return Target<F>::get(s).toString(); }
+                static const Manager * manager() {
+                    static const Manager m = { Target<F>::copy, Target<F>::move, Target<F>::destroy, equals, toString };
+                    return &m;
+                }
+            };
+
+            struct NullTarget {
+                R invoke(A...) { return R(); }
+                bool operator==(const NullTarget &) const { return true; }
+                std::string toString() const { return "NullInvocation"; }
+            };
+
+            template<typename C> struct MemberTarget {
+                C* base;
+                R(C::*member)(A...);
+
+                R invoke(A... args) { return (base->*member)(std::forward<A>(args)...); }
+                bool operator==(const MemberTarget & o) const { return base == o.base && member == o.member; }
+                std::string toString() const {
+                    // hack to convert member pointer to void *: '*((void**)&member)'
+                    return "ClassInvocation "+uint64HexString((uint64_t)base)+"->"+aptrHexString( *((void**)&member) );
+                }
+            };
+
+            struct PlainTarget {
+                R(*function)(A...);
+
+                R invoke(A... args) { return (*function)(std::forward<A>(args)...); }
+                bool operator==(const PlainTarget & o) const { return function == o.function; }
+                std::string toString() const {
+                    // hack to convert function pointer to void *: '*((void**)&function)'
+                    return "PlainInvocation "+aptrHexString( *((void**)&function) );
+                }
+            };
+
+            template<typename I> struct CaptureTarget {
+                I data;
+                R(*function)(I&, A...);
+                bool dataIsIdentity;
+
+                R invoke(A... args) { return (*function)(data, std::forward<A>(args)...); }
+                bool operator==(const CaptureTarget & o) const {
+                    return dataIsIdentity == o.dataIsIdentity && function == o.function && ( !dataIsIdentity || data == o.data );
+                }
+                std::string toString() const {
+                    // hack to convert function pointer to void *: '*((void**)&function)'
+                    return "CaptureInvocation "+aptrHexString( *((void**)&function) );
+                }
+            };
+
+            struct StdTarget {
+                uint64_t id;
+                std::function<R(A...)> function;
+
+                R invoke(A... args) { return function(std::forward<A>(args)...); }
+                bool operator==(const StdTarget & o) const { return id == o.id; }
+                std::string toString() const { return "StdInvocation "+uint64HexString( id ); }
+            };
+
+            /** Externally provided InvocationFunc */
+            struct SharedTarget {
+                std::shared_ptr<InvocationFunc<R, A...>> func;
+
+                R invoke(A... args) { return func->invoke(std::forward<A>(args)...); }
+                bool operator==(const SharedTarget & o) const { return *func == *o.func; }
+                std::string toString() const { return func->toString(); }
+            };
+
+            mutable Storage storage;
+            Invoker invoker;
+            const Manager * manager;
+
+            template<typename F> void init(F && f) {
+                Target<F>::create(storage, std::move(f));
+                invoker = Ops<F>::invoke;
+                manager = Ops<F>::manager();
+            }
+
+            void initFrom(InvocationFunc<R, A...> * _funcPtr, std::shared_ptr<InvocationFunc<R, A...>> _func) {
+                if( nullptr != _funcPtr && DelegateInvocationFunc<R, A...>::TYPE == _funcPtr->getType() ) {
+                    const FunctionDef & d = static_cast<DelegateInvocationFunc<R, A...>*>(_funcPtr)->getDelegate();
+                    d.manager->copy(storage, d.storage);
+                    invoker = d.invoker;
+                    manager = d.manager;
+                } else {
+                    init( SharedTarget { std::move(_func) } );
+                }
+            }
 
         public:
             /**
              * Constructs an instance with a null function.
              */
-            FunctionDef()
-            : func(std::shared_ptr<InvocationFunc<R, A...>>( new NullInvocationFunc<R, A...>() ))
-            {};
+            FunctionDef() { init( NullTarget() ); }
 
             /**
              * Constructs an instance using the shared InvocationFunc<R, A...> function.
+             * <p>
+             * A DelegateInvocationFunc, see cloneFunction(), is unwrapped.
+             * </p>
              */
-            FunctionDef(std::shared_ptr<InvocationFunc<R, A...>> _func)
-            : func(_func) { }
+            FunctionDef(std::shared_ptr<InvocationFunc<R, A...>> _func) { initFrom(_func.get(), _func); }
 
             /**
              * Constructs an instance by wrapping the given naked InvocationFunc<R, A...> function pointer
              * in a shared_ptr and taking ownership.
              * <p>
+             * A DelegateInvocationFunc, see cloneFunction(), is unwrapped.
+             * </p>
+             * <p>
              * A convenience method.
              * </p.
              */
-            FunctionDef(InvocationFunc<R, A...> * _funcPtr)
-            : func(std::shared_ptr<InvocationFunc<R, A...>>(_funcPtr)) { }
+            FunctionDef(InvocationFunc<R, A...> * _funcPtr) { initFrom(_funcPtr, std::shared_ptr<InvocationFunc<R, A...>>(_funcPtr)); }
 
-            FunctionDef(const FunctionDef &o) = default;
-            FunctionDef(FunctionDef &&o) = default;
-            FunctionDef& operator=(const FunctionDef &o) = default;
-            FunctionDef& operator=(FunctionDef &&o) = default;
+            FunctionDef(const FunctionDef &o)
+            : invoker(o.invoker), manager(o.manager) {
+                manager->copy(storage, o.storage);
+            }
+
+            FunctionDef(FunctionDef &&o) noexcept
+            : invoker(o.invoker), manager(o.manager) {
+                manager->move(storage, o.storage);
+                o.init( NullTarget() );
+            }
+
+            FunctionDef& operator=(const FunctionDef &o) {
+                if( this != &o ) {
+                    Storage tmp;
+                    o.manager->copy(tmp, o.storage); // may throw, leaving this instance intact
+                    manager->destroy(storage);
+                    o.manager->move(storage, tmp);
+                    invoker = o.invoker;
+                    manager = o.manager;
+                }
+                return *this;
+            }
+
+            FunctionDef& operator=(FunctionDef &&o) noexcept {
+                if( this != &o ) {
+                    manager->destroy(storage);
+                    o.manager->move(storage, o.storage);
+                    invoker = o.invoker;
+                    manager = o.manager;
+                    o.init( NullTarget() );
+                }
+                return *this;
+            }
+
+            ~FunctionDef() {
+                manager->destroy(storage);
+            }
 
             bool operator==(const FunctionDef<R, A...>& rhs) const
-            { return *func == *rhs.func; }
+            { return manager == rhs.manager && manager->equals(storage, rhs.storage); }
 
             bool operator!=(const FunctionDef<R, A...>& rhs) const
-            { return *func != *rhs.func; }
+            { return !( *this == rhs ); }
 
-            /** Returns the shared InvocationFunc<R, A...> function */
-            std::shared_ptr<InvocationFunc<R, A...>> getFunction() { return func; }
+            /** Returns a new shared InvocationFunc<R, A...> function, see cloneFunction(). */
+            std::shared_ptr<InvocationFunc<R, A...>> getFunction() { return std::shared_ptr<InvocationFunc<R, A...>>( cloneFunction() ); }
 
-            /** Returns a new instance of the held InvocationFunc<R, A...> function. */
-            InvocationFunc<R, A...> * cloneFunction() const { return func->clone(); }
+            /**
+             * Returns a new DelegateInvocationFunc<R, A...> of this instance,
+             * which identity is preserved when passed back to FunctionDef(InvocationFunc<R, A...> *).
+             */
+            InvocationFunc<R, A...> * cloneFunction() const { return new DelegateInvocationFunc<R, A...>(*this); }
 
             std::string toString() const {
-                return "FunctionDef["+func->toString()+"]";
+                return "FunctionDef["+manager->toString(storage)+"]";
             }
 
-            R invoke(A... args) {
-                return func->invoke(args...);
+            R invoke(A... args) const {
+                return invoker(storage, std::forward<A>(args)...);
             }
+
+            template<typename C>
+            static FunctionDef createMember(C *base, R(C::*mfunc)(A...)) {
+                return FunctionDef( MemberTarget<C> { base, mfunc }, 0 );
+            }
+
+            static FunctionDef createPlain(R(*func)(A...)) {
+                return FunctionDef( PlainTarget { func }, 0 );
+            }
+
+            template<typename I>
+            static FunctionDef createCapture(I&& data, R(*func)(I&, A...), bool dataIsIdentity) {
+                return FunctionDef( CaptureTarget<I> { std::move(data), func, dataIsIdentity }, 0 );
+            }
+
+            static FunctionDef createStd(uint64_t id, std::function<R(A...)> func) {
+                return FunctionDef( StdTarget { id, std::move(func) }, 0 );
+            }
+
+        private:
+            template<typename F>
+            FunctionDef(F && target, int) { init( std::move(target) ); }
     };
 
     template<typename R, typename C, typename... A>
     inline FunctionDef<R, A...>
     bindMemberFunc(C *base, R(C::*mfunc)(A...)) {
-        return FunctionDef<R, A...>( new ClassInvocationFunc<R, C, A...>(base, mfunc) );
+        return FunctionDef<R, A...>::createMember(base, mfunc);
     }
 
     template<typename R, typename... A>
     inline FunctionDef<R, A...>
     bindPlainFunc(R(*func)(A...)) {
-        return FunctionDef<R, A...>( new PlainInvocationFunc<R, A...>(func) );
+        return FunctionDef<R, A...>::createPlain(func);
     }
 
     /**
-     * <code>const I& data</code> will be copied into the InvocationFunc<..> specialization
+     * <code>const I& data</code> will be copied into the FunctionDef<..>
      * and hence captured by copy.
      * <p>
      * The function call will have the reference of the copied data being passed for efficiency.
@@ -382,11 +652,11 @@ namespace direct_bt {
     template<typename R, typename I, typename... A>
     inline FunctionDef<R, A...>
     bindCaptureFunc(const I& data, R(*func)(I&, A...), bool dataIsIdentity=true) {
-        return FunctionDef<R, A...>( new CaptureInvocationFunc<R, I, A...>(data, func, dataIsIdentity) );
+        return FunctionDef<R, A...>::createCapture(I(data), func, dataIsIdentity);
     }
 
     /**
-     * <code>I&& data</code> will be moved into the InvocationFunc<..> specialization.
+     * <code>I&& data</code> will be moved into the FunctionDef<..>.
      * <p>
      * The function call will have the reference of the copied data being passed for efficiency.
      * </p>
@@ -394,18 +664,18 @@ namespace direct_bt {
     template<typename R, typename I, typename... A>
     inline FunctionDef<R, A...>
     bindCaptureFunc(I&& data, R(*func)(I&, A...), bool dataIsIdentity=true) {
-        return FunctionDef<R, A...>( new CaptureInvocationFunc<R, I, A...>(std::move(data), func, dataIsIdentity) );
+        return FunctionDef<R, A...>::createCapture(std::move(data), func, dataIsIdentity);
     }
 
     template<typename R, typename... A>
     inline FunctionDef<R, A...>
     bindStdFunc(uint64_t id, std::function<R(A...)> func) {
-        return FunctionDef<R, A...>( new StdInvocationFunc<R, A...>(id, func) );
+        return FunctionDef<R, A...>::createStd(id, std::move(func));
     }
     template<typename R, typename... A>
     inline FunctionDef<R, A...>
     bindStdFunc(uint64_t id) {
-        return FunctionDef<R, A...>( new StdInvocationFunc<R, A...>(id) );
+        return FunctionDef<R, A...>::createStd(id, std::function<R(A...)>());
     }
 
 } // namespace direct_bt
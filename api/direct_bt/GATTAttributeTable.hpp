@@ -0,0 +1,152 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GATT_ATTRIBUTE_TABLE_HPP_
+#define GATT_ATTRIBUTE_TABLE_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+
+#include "UUID.hpp"
+
+#include "GATTService.hpp"
+
+/**
+ * - - - - - - - - - - - - - - -
+ *
+ * Module GATTAttributeTable:
+ *
+ * - BT Core Spec v5.2: Vol 3, Part G GATT: 2.6 GATT Profile Hierarchy
+ */
+namespace direct_bt {
+
+    /**
+     * Compact and flat attribute table of one device's discovered GATT database,
+     * i.e. all service, characteristic and descriptor declarations in handle order
+     * stored in one contiguous array of trivially copyable entries.
+     * <p>
+     * Each entry references its enclosing declaration by index,
+     * allowing cache friendly lookups and traversal w/o chasing the object tree's shared and weak references.
+     * The GATTService, GATTCharacteristic and GATTDescriptor instances remain the public object API
+     * and are resolved from a table Attribute handle on demand.
+     * </p>
+     * <p>
+     * Immutable once built, hence safe to be shared across threads.
+     * </p>
+     */
+    class GATTAttributeTable {
+        public:
+            enum class Kind : uint8_t {
+                SERVICE         = 0,
+                CHARACTERISTIC  = 1,
+                DESCRIPTOR      = 2
+            };
+
+            struct Entry {
+                /** Service type, characteristic value type or descriptor type */
+                uuid_value_t uuid;
+                /** Service start handle, characteristic declaration handle or descriptor handle */
+                uint16_t handle;
+                /** Service end handle, characteristic value handle or the descriptor handle */
+                uint16_t aux_handle;
+                /** Index of the enclosing entry, -1 for services */
+                int32_t parent;
+                Kind kind;
+                /** Characteristic GATTCharacteristic::PropertyBitVal, service isPrimary as 1, otherwise 0 */
+                uint8_t properties;
+            };
+
+            /**
+             * Lightweight handle of one table entry, valid as long as its table.
+             */
+            class Attribute {
+                private:
+                    const GATTAttributeTable * table;
+                    int index;
+
+                public:
+                    Attribute(const GATTAttributeTable * table, const int index) noexcept
+                    : table(table), index(index) {}
+
+                    /** Returns true if referencing an entry, false if returned by a failed lookup. */
+                    bool isValid() const noexcept { return 0 <= index; }
+                    int getIndex() const noexcept { return index; }
+
+                    const Entry & getEntry() const noexcept { return table->entries[index]; }
+                    Kind getKind() const noexcept { return getEntry().kind; }
+                    uint16_t getHandle() const noexcept { return getEntry().handle; }
+                    const uuid_value_t & getUUID() const noexcept { return getEntry().uuid; }
+
+                    /** Returns the enclosing attribute, invalid for a service. */
+                    Attribute getParent() const noexcept { return Attribute(table, getEntry().parent); }
+
+                    /** Returns the GATTService, if getKind() is Kind::SERVICE, otherwise nullptr. */
+                    GATTServiceRef getService() const;
+                    /** Returns the GATTCharacteristic, if getKind() is Kind::CHARACTERISTIC, otherwise nullptr. */
+                    GATTCharacteristicRef getCharacteristic() const;
+                    /** Returns the GATTDescriptor, if getKind() is Kind::DESCRIPTOR, otherwise nullptr. */
+                    GATTDescriptorRef getDescriptor() const;
+            };
+
+        private:
+            std::vector<Entry> entries;
+            /** Object of each entry, same index */
+            std::vector<std::shared_ptr<DBTObject>> objects;
+            /** Indices of all characteristic entries sorted by their value handle */
+            std::vector<int32_t> valueHandleIndex;
+            uint16_t serviceChangedHandle;
+            /** True if entries are in ascending handle order, as delivered by discovery and GATTCache */
+            bool handleOrdered;
+
+        public:
+            /** Builds the table of the given discovered services. */
+            GATTAttributeTable(const std::vector<GATTServiceRef> & services);
+
+            int size() const noexcept { return static_cast<int>(entries.size()); }
+            Attribute get(const int i) const noexcept { return Attribute(this, i); }
+
+            /** Returns the attribute declared at the given handle, invalid if none. O(log n) if entries are in handle order, otherwise O(n). */
+            Attribute findByHandle(const uint16_t handle) const noexcept;
+
+            /** Returns the characteristic of the given value handle, invalid if none. O(log n) */
+            Attribute findCharacteristicByValueHandle(const uint16_t valueHandle) const noexcept;
+
+            /** Returns the characteristic of the given value handle or nullptr, see findCharacteristicByValueHandle(). */
+            GATTCharacteristicRef getCharacteristicByValueHandle(const uint16_t valueHandle) const {
+                return findCharacteristicByValueHandle(valueHandle).getCharacteristic();
+            }
+
+            /** Returns the Service Changed Characteristic value handle, zero if none. */
+            uint16_t getServiceChangedHandle() const noexcept { return serviceChangedHandle; }
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* GATT_ATTRIBUTE_TABLE_HPP_ */
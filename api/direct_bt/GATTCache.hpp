@@ -0,0 +1,140 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GATT_CACHE_HPP_
+#define GATT_CACHE_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <map>
+
+#include <mutex>
+
+#include "BTAddress.hpp"
+#include "OctetTypes.hpp"
+
+#include "GATTService.hpp"
+
+/**
+ * - - - - - - - - - - - - - - -
+ *
+ * Module GATTCache:
+ *
+ * - BT Core Spec v5.2: Vol 3, Part G GATT: 2.5.2 Attribute Caching
+ */
+namespace direct_bt {
+
+    class DBTDevice; // forward
+
+    /**
+     * In-memory and optional on-disk cache of discovered GATT attribute databases, keyed by device address.
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 2.5.2 Attribute Caching
+     * </p>
+     * <p>
+     * A cached database is only accepted if it can be validated,
+     * i.e. if its Database Hash matches the device's current one,
+     * or if the device offers no Database Hash but a Service Changed Characteristic
+     * whose indication invalidates the cache entry via invalidate().
+     * </p>
+     * <p>
+     * Each entry is stored in one serialized record, which is also written to
+     * '<directory>/<address>.gatt' if a directory is given.
+     * </p>
+     */
+    class GATTCache {
+        public:
+            enum Defaults : uint8_t {
+                /** Serialized record format version */
+                RECORD_VERSION = 1,
+                /** Database Hash size, BT Core Spec v5.2: Vol 3, Part G GATT: 7.3 */
+                DB_HASH_SIZE = 16
+            };
+
+        private:
+            const std::string directory;
+            std::mutex mtx_records;
+            std::map<EUI48, std::shared_ptr<const POctets>> records;
+
+            std::string getFilename(const EUI48 & address) const;
+            std::shared_ptr<const POctets> readRecord(const EUI48 & address);
+            bool writeRecord(const EUI48 & address, const POctets & record);
+
+        public:
+            /**
+             * @param directory the directory for on-disk records, empty for an in-memory cache only
+             */
+            GATTCache(const std::string & directory);
+
+            /**
+             * Returns the serialized record of the given services and database hash.
+             * @param dbHash the Database Hash, empty if not available
+             * @param services the discovered services
+             */
+            static std::shared_ptr<const POctets> serialize(const TROOctets & dbHash, const std::vector<GATTServiceRef> & services);
+
+            /**
+             * Restores the services of the given serialized record, associated with the given device.
+             * @param record the serialized record
+             * @param device the device to associate the restored services with
+             * @param dbHash receives the stored Database Hash, empty if none was stored
+             * @param services receives the restored services
+             * @return true if successful, otherwise false w/ a corrupt record
+             */
+            static bool deserialize(const TROOctets & record, const std::shared_ptr<DBTDevice> & device,
+                                    POctets & dbHash, std::vector<GATTServiceRef> & services);
+
+            /**
+             * Stores the discovered services of the given device.
+             * @param address the device address
+             * @param dbHash the Database Hash, empty if not available
+             * @param services the discovered services
+             */
+            void put(const EUI48 & address, const TROOctets & dbHash, const std::vector<GATTServiceRef> & services);
+
+            /**
+             * Restores the cached services of the given device, if valid.
+             * @param address the device address
+             * @param dbHash the device's current Database Hash or nullptr if not available
+             * @param device the device to associate the restored services with
+             * @param services receives the restored services
+             * @return true if a valid entry has been restored, otherwise false
+             */
+            bool get(const EUI48 & address, const TROOctets * dbHash, const std::shared_ptr<DBTDevice> & device,
+                     std::vector<GATTServiceRef> & services);
+
+            /** Removes the cached services of the given device, in-memory and on-disk. */
+            void invalidate(const EUI48 & address);
+
+            /** Removes all in-memory entries, keeping the on-disk records. */
+            void clear();
+    };
+
+} // namespace direct_bt
+
+#endif /* GATT_CACHE_HPP_ */
@@ -34,6 +34,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <functional>
 
 #include "UUID.hpp"
 #include "BTTypes.hpp"
@@ -74,6 +75,8 @@ namespace direct_bt {
      * </p>
      */
     class GATTCharacteristic : public DBTObject {
+        friend class GATTHandler; // notification and indication enabled state
+
         private:
             /** Characteristics's service weak back-reference */
             std::weak_ptr<GATTService> wbr_service;
@@ -143,12 +146,34 @@ namespace direct_bt {
             /* Characteristics Value Type UUID */
             std::shared_ptr<const uuid_t> value_type;
 
+            /** Lazily cached string representations of value_type, see getValueTypeString(). */
+            uuid_string_cache valueTypeStrings;
+
             /** List of Characteristic Descriptions as shared reference */
             std::vector<GATTDescriptorRef> descriptorList;
 
             /* Optional Client Characteristic Configuration index within descriptorList */
             int clientCharacteristicsConfigIndex = -1;
 
+            /**
+             * Opt-in value cache, disabled by default, see GATTValueCache::setTTL().
+             * <p>
+             * Updated by received notifications and indications, hence subscribed values may be read w/o air time.
+             * Mutable as it is not part of the declaration.
+             * </p>
+             */
+            mutable GATTValueCache valueCache;
+
+            /**
+             * Length of the last completely read value, zero if unknown.
+             * <p>
+             * Used to presize the result buffer of a read w/o given expected length,
+             * see GATTHandler::readCharacteristicValue().
+             * Mutable as it is not part of the declaration.
+             * </p>
+             */
+            mutable std::atomic<int> valueLength { 0 };
+
             GATTCharacteristic(const GATTServiceRef & service, const uint16_t service_handle, const uint16_t handle,
                                    const PropertyBitVal properties, const uint16_t value_handle, std::shared_ptr<const uuid_t> value_type)
             : wbr_service(service), service_handle(service_handle), handle(handle),
@@ -161,6 +186,12 @@ namespace direct_bt {
                 return std::string(JAVA_DBT_PACKAGE "DBTGattCharacteristic");
             }
 
+            /**
+             * Returns the cached string representation of the value type UUID,
+             * see uuid_t::toUUID128String() if uuid128 is true, otherwise uuid_t::toString().
+             */
+            const std::string & getValueTypeString(const bool uuid128) const { return valueTypeStrings.get(*value_type, uuid128); }
+
             std::shared_ptr<GATTService> getServiceUnchecked() const { return wbr_service.lock(); }
             std::shared_ptr<GATTService> getServiceChecked() const;
             std::shared_ptr<DBTDevice> getDeviceUnchecked() const;
@@ -168,6 +199,12 @@ namespace direct_bt {
 
             bool hasProperties(const PropertyBitVal v) const { return v == ( properties & v ); }
 
+            /** Returns true if notifications have been enabled via configNotificationIndication(..) or enableNotificationOrIndication(..). */
+            bool isNotificationEnabled() const { return enabledNotifyState; }
+
+            /** Returns true if indications have been enabled via configNotificationIndication(..) or enableNotificationOrIndication(..). */
+            bool isIndicationEnabled() const { return enabledIndicateState; }
+
             std::string getPropertiesString() const {
                 return getPropertiesString(properties);
             }
@@ -198,6 +235,10 @@ namespace direct_bt {
              * Notification and/or indication configuration is only performed per characteristic if changed.
              * </p>
              * <p>
+             * If the descriptors have not been discovered, the ClientCharacteristicConfiguration descriptor
+             * is located on demand via GATTHandler::findClientCharacteristicConfig().
+             * </p>
+             * <p>
              * It is recommended to utilize notification over indication, as its link-layer handshake
              * and higher potential bandwidth may deliver material higher performance.
              * </p>
@@ -351,6 +392,9 @@ namespace direct_bt {
              * if required until the response returns zero.
              * </p>
              * <p>
+             * A fresh value of the enabled valueCache is appended w/o air time.
+             * </p>
+             * <p>
              * Convenience delegation call to GATTHandler via DBTDevice
              * <p>
              * </p>
@@ -359,6 +403,29 @@ namespace direct_bt {
              */
             bool readValue(POctets & res, int expectedLength=-1);
 
+            /**
+             * Non-throwing readValue(POctets &, int), returning the GATTStatus instead,
+             * see GATTHandler::readCharacteristicValueStatus().
+             * <p>
+             * If the DBTDevice's GATTHandler is null, i.e. not connected, GATTStatus::INVALID_STATE is returned.
+             * </p>
+             */
+            GATTStatus readValueStatus(POctets & res, int expectedLength=-1) noexcept;
+
+            /**
+             * Reads the value into the given reusable buffer like readValue(POctets &, int),
+             * replacing its content instead of appending.
+             * <p>
+             * The buffer's size is reset to zero while its capacity is kept,
+             * which is presized to the expected length or the last known value length if required.
+             * Hence a periodic read loop using the same buffer does not allocate after its first read.
+             * </p>
+             * <p>
+             * If the DBTDevice's GATTHandler is null, i.e. not connected, an IllegalStateException is thrown.
+             * </p>
+             */
+            bool readValueInto(POctets & buf, int expectedLength=-1);
+
             /**
              * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.3 Write Characteristic Value
              * <p>
@@ -380,6 +447,43 @@ namespace direct_bt {
              * </p>
              */
             bool writeValueNoResp(const TROOctets & value);
+
+            /**
+             * Fills the value to be written in place, e.g. copying a Java array region directly into the ATT PDU.
+             * @param dest the destination of the value
+             * @param size the value size
+             * @return false if the value could not be provided, aborting the write
+             */
+            typedef std::function<bool(uint8_t * dest, const int size)> ValueFill;
+
+            /**
+             * Writes the value of given size with or w/o response, filled in place via the given ValueFill,
+             * see GATTHandler::writeCharacteristicValue(const GATTCharacteristic &, const int, const ValueFill &, const bool).
+             * <p>
+             * Convenience delegation call to GATTHandler via DBTDevice
+             * <p>
+             * </p>
+             * If the DBTDevice's GATTHandler is null, i.e. not connected, an IllegalStateException is thrown.
+             * </p>
+             */
+            bool writeValue(const int valueSize, const ValueFill & fill, const bool withResponse);
+
+            /**
+             * Non-throwing writeValue(const TROOctets &) or writeValueNoResp(const TROOctets &), depending on withResponse,
+             * returning the GATTStatus instead, see GATTHandler::writeCharacteristicValueStatus().
+             * <p>
+             * If the DBTDevice's GATTHandler is null, i.e. not connected, GATTStatus::INVALID_STATE is returned.
+             * </p>
+             */
+            GATTStatus writeValueStatus(const TROOctets & value, const bool withResponse) noexcept;
+
+            /**
+             * Non-throwing writeValue(const int, const ValueFill &, const bool), returning the GATTStatus instead.
+             * <p>
+             * If the DBTDevice's GATTHandler is null, i.e. not connected, GATTStatus::INVALID_STATE is returned.
+             * </p>
+             */
+            GATTStatus writeValueStatus(const int valueSize, const ValueFill & fill, const bool withResponse) noexcept;
     };
     typedef std::shared_ptr<GATTCharacteristic> GATTCharacteristicRef;
 
@@ -409,7 +513,22 @@ namespace direct_bt {
      * </p>
      */
     class GATTCharacteristicListener {
+        private:
+            const bool valueView;
+
+        protected:
+            /** Constructor for GATTCharacteristicValueListener, receiving non-owning value views. */
+            GATTCharacteristicListener(const bool valueView_) : valueView(valueView_) {}
+
         public:
+            GATTCharacteristicListener() : valueView(false) {}
+
+            /**
+             * Returns true if this instance is a GATTCharacteristicValueListener,
+             * receiving non-owning value views instead of an owning copy.
+             */
+            bool isValueViewListener() const { return valueView; }
+
             /**
              * Custom filter for all event methods,
              * which will not be called if this method returns false.
@@ -431,7 +550,7 @@ namespace direct_bt {
              * with the given {@link GATTCharacteristic}.
              * @param charDecl {@link GATTCharacteristic} related to this notification
              * @param charValue the notification value
-             * @param timestamp the indication monotonic timestamp, see getCurrentMilliseconds()
+             * @param timestamp the monotonic receive timestamp in milliseconds, i.e. the kernel receive time if available, see getCurrentMilliseconds()
              */
             virtual void notificationReceived(GATTCharacteristicRef charDecl,
                                               std::shared_ptr<TROOctets> charValue, const uint64_t timestamp) = 0;
@@ -441,7 +560,7 @@ namespace direct_bt {
              * with the given {@link GATTCharacteristic}.
              * @param charDecl {@link GATTCharacteristic} related to this indication
              * @param charValue the indication value
-             * @param timestamp the indication monotonic timestamp, see {@link BluetoothUtils#getCurrentMilliseconds()}
+             * @param timestamp the monotonic receive timestamp in milliseconds, i.e. the kernel receive time if available, see getCurrentMilliseconds()
              * @param confirmationSent if true, the native stack has sent the confirmation, otherwise user is required to do so.
              */
             virtual void indicationReceived(GATTCharacteristicRef charDecl,
@@ -463,6 +582,60 @@ namespace direct_bt {
             { return !(*this == rhs); }
     };
 
+    /**
+     * {@link GATTCharacteristicListener} variant receiving a non-owning view of the notification
+     * or indication value, referencing the reader's receive buffer.
+     * <p>
+     * The value is only valid for the duration of the callback, hence no value copy
+     * is created for instances of this listener type.
+     * Listener retaining the value shall copy it or use {@link GATTCharacteristicListener}.
+     * </p>
+     */
+    class GATTCharacteristicValueListener : public GATTCharacteristicListener {
+        public:
+            GATTCharacteristicValueListener() : GATTCharacteristicListener(true) {}
+
+            /**
+             * Called from native BLE stack, initiated by a received notification associated
+             * with the given {@link GATTCharacteristic}.
+             * @param charDecl {@link GATTCharacteristic} related to this notification
+             * @param charValue the notification value, only valid during this callback
+             * @param timestamp the monotonic receive timestamp in milliseconds, i.e. the kernel receive time if available, see getCurrentMilliseconds()
+             */
+            virtual void notificationValueReceived(GATTCharacteristicRef charDecl,
+                                                   const TROOctets & charValue, const uint64_t timestamp) = 0;
+
+            /**
+             * Called from native BLE stack, initiated by a received indication associated
+             * with the given {@link GATTCharacteristic}.
+             * @param charDecl {@link GATTCharacteristic} related to this indication
+             * @param charValue the indication value, only valid during this callback
+             * @param timestamp the monotonic receive timestamp in milliseconds, i.e. the kernel receive time if available, see getCurrentMilliseconds()
+             * @param confirmationSent if true, the native stack has sent the confirmation, otherwise user is required to do so.
+             */
+            virtual void indicationValueReceived(GATTCharacteristicRef charDecl,
+                                                 const TROOctets & charValue, const uint64_t timestamp,
+                                                 const bool confirmationSent) = 0;
+
+            /** Not called for this listener type, see notificationValueReceived(). */
+            void notificationReceived(GATTCharacteristicRef charDecl,
+                                      std::shared_ptr<TROOctets> charValue, const uint64_t timestamp) override {
+                (void)charDecl;
+                (void)charValue;
+                (void)timestamp;
+            }
+
+            /** Not called for this listener type, see indicationValueReceived(). */
+            void indicationReceived(GATTCharacteristicRef charDecl,
+                                    std::shared_ptr<TROOctets> charValue, const uint64_t timestamp,
+                                    const bool confirmationSent) override {
+                (void)charDecl;
+                (void)charValue;
+                (void)timestamp;
+                (void)confirmationSent;
+            }
+    };
+
     class AssociatedGATTCharacteristicListener : public GATTCharacteristicListener{
         private:
             const GATTCharacteristic * associatedCharacteristic;
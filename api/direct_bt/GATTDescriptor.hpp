@@ -56,6 +56,60 @@ namespace direct_bt {
     class GATTCharacteristic; // forward
     typedef std::shared_ptr<GATTCharacteristic> GATTCharacteristicRef;
 
+    /**
+     * Opt-in cache of the last known value of a GATTCharacteristic or GATTDescriptor.
+     * <p>
+     * The cache is fed by completed reads and,
+     * for characteristics, by received notifications and indications.
+     * A fresh cached value serves a read w/o air time, see GATTHandler::readCharacteristicValue()
+     * and GATTHandler::readDescriptorValue().
+     * Writes invalidate the cached value, as the server may interpret the written value.
+     * </p>
+     * <p>
+     * All methods are thread safe.
+     * </p>
+     */
+    class GATTValueCache {
+        public:
+            enum TTL : int32_t {
+                /** Cache disabled, the default */
+                DISABLED = 0,
+                /** Cached value never expires, e.g. for static characteristics */
+                PERMANENT = -1
+            };
+
+        private:
+            mutable std::mutex mtx_value;
+            int32_t ttlMS;
+            std::shared_ptr<const POctets> value;
+            uint64_t timestamp;
+
+        public:
+            GATTValueCache() : ttlMS(TTL::DISABLED), value(nullptr), timestamp(0) {}
+
+            /**
+             * Sets the time to live of a cached value in milliseconds,
+             * TTL::PERMANENT for no expiry or TTL::DISABLED to disable and clear the cache.
+             */
+            void setTTL(const int32_t ttlMS);
+
+            int32_t getTTL() const;
+
+            bool isEnabled() const { return TTL::DISABLED != getTTL(); }
+
+            /** Stores the given value received at the given timestamp in milliseconds, if enabled. */
+            void put(const TROOctets & v, const uint64_t timestamp);
+
+            /**
+             * Appends a fresh cached value to res.
+             * @return true if a fresh value has been appended, otherwise false and res is unchanged.
+             */
+            bool get(POctets & res) const;
+
+            /** Clears the cached value. */
+            void invalidate();
+    };
+
     /**
      * BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3 Characteristic Descriptor
      */
@@ -112,6 +166,9 @@ namespace direct_bt {
             /** Type of descriptor */
             std::shared_ptr<const uuid_t> type;
 
+            /** Lazily cached string representations of type, see getTypeString(). */
+            uuid_string_cache typeStrings;
+
             /**
              * Characteristic Descriptor Handle
              * <p>
@@ -123,6 +180,12 @@ namespace direct_bt {
             /* Characteristics Descriptor's Value */
             POctets value;
 
+            /**
+             * Opt-in value cache, disabled by default, see GATTValueCache::setTTL().
+             * Mutable as it is not part of the declaration.
+             */
+            mutable GATTValueCache valueCache;
+
             GATTDescriptor(const GATTCharacteristicRef & characteristic, const std::shared_ptr<const uuid_t> & type,
                            const uint16_t handle)
             : wbr_characteristic(characteristic), type(type), handle(handle), value(0) {}
@@ -134,6 +197,12 @@ namespace direct_bt {
                 return std::string(JAVA_DBT_PACKAGE "DBTGattDescriptor");
             }
 
+            /**
+             * Returns the cached string representation of the descriptor type UUID,
+             * see uuid_t::toUUID128String() if uuid128 is true, otherwise uuid_t::toString().
+             */
+            const std::string & getTypeString(const bool uuid128) const { return typeStrings.get(*type, uuid128); }
+
             std::shared_ptr<GATTCharacteristic> getCharacteristicUnchecked() const { return wbr_characteristic.lock(); }
             std::shared_ptr<GATTCharacteristic> getCharacteristicChecked() const;
             std::shared_ptr<DBTDevice> getDeviceChecked() const;
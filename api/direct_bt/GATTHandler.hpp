@@ -31,10 +31,15 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <map>
 
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <deque>
+#include <functional>
+#include <future>
+#include <condition_variable>
 
 #include "DBTEnv.hpp"
 #include "UUID.hpp"
@@ -42,7 +47,14 @@
 #include "L2CAPComm.hpp"
 #include "ATTPDUTypes.hpp"
 #include "GATTTypes.hpp"
+#include "GATTCache.hpp"
+#include "GATTAttributeTable.hpp"
 #include "LFRingbuffer.hpp"
+#include "OverflowRingbuffer.hpp"
+#include "COWVector.hpp"
+#include "DBTMetrics.hpp"
+#include "DBTMutex.hpp"
+#include "TrafficStats.hpp"
 
 /**
  * - - - - - - - - - - - - - - -
@@ -56,6 +68,10 @@
 namespace direct_bt {
 
     class DBTDevice; // forward
+    class HCIHandler; // forward
+    class GATTHandler; // forward
+    class GATTWriteStream; // forward
+    class DBTProfile; // forward
 
     /**
      * GATT Singleton runtime environment properties
@@ -67,6 +83,8 @@ namespace direct_bt {
         private:
             GATTEnv();
 
+            static void onPropertyChanged(const std::string & name);
+
             const bool exploding; // just to trigger exploding properties
 
         public:
@@ -75,40 +93,415 @@ namespace direct_bt {
              * <p>
              * Environment variable is 'direct_bt.gatt.reader.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t L2CAP_READER_THREAD_POLL_TIMEOUT;
+            std::atomic<int32_t> L2CAP_READER_THREAD_POLL_TIMEOUT;
 
             /**
              * Timeout for GATT read command replies, defaults to 500ms.
              * <p>
              * Environment variable is 'direct_bt.gatt.read.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t GATT_READ_COMMAND_REPLY_TIMEOUT;
+            std::atomic<int32_t> GATT_READ_COMMAND_REPLY_TIMEOUT;
 
             /**
              * Timeout for GATT write command replies, defaults to 500ms.
              * <p>
              * Environment variable is 'direct_bt.gatt.write.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t GATT_WRITE_COMMAND_REPLY_TIMEOUT;
+            std::atomic<int32_t> GATT_WRITE_COMMAND_REPLY_TIMEOUT;
 
             /**
              * Timeout for l2cap _initial_ command reply, defaults to 2500ms.
              * <p>
              * Environment variable is 'direct_bt.gatt.init.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_INITIAL_COMMAND_REPLY_TIMEOUT;
+
+            /**
+             * Number of times the reply timeout of a request is extended after it expired, defaults to 0.
+             * <p>
+             * The timeout of each retry is the previous one multiplied by GATT_COMMAND_RETRY_BACKOFF.
+             * The request itself is never resent, as only one request may be outstanding per ATT bearer,
+             * see BT Core Spec v5.2: Vol 3, Part F 3.3.2.
+             * Pipelined requests as well as ATT_EXECUTE_WRITE_REQ are never retried.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cmd.retries'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_COMMAND_RETRIES;
+
+            /**
+             * Timeout multiplier of each request retry, defaults to 2, see GATT_COMMAND_RETRIES.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cmd.retry.backoff'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_COMMAND_RETRY_BACKOFF;
+
+            /**
+             * Number of consecutive requests failing w/ a reply timeout after all retries
+             * escalating to a disconnect, defaults to 1, i.e. the first one.
+             * <p>
+             * A request failing below this count throws a BluetoothException w/o disconnecting.
+             * Any received reply resets the count.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cmd.timeout.disconnect'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_COMMAND_TIMEOUT_DISCONNECT;
+
+            /**
+             * Derive the reply timeout of each request from the device's round-trip times, defaults to false.
+             * <p>
+             * If true, a request's reply timeout is SRTT + 4 RTTVAR of the GATTHandler's RTTEstimator,
+             * clamped to [GATT_ADAPTIVE_TIMEOUT_MIN..GATT_ADAPTIVE_TIMEOUT_MAX].
+             * The configured timeouts are used until the first round-trip time has been measured.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cmd.timeout.adaptive'.
+             * </p>
+             */
+            const bool GATT_ADAPTIVE_TIMEOUT;
+
+            /**
+             * Minimum adaptive reply timeout, defaults to 100ms, see GATT_ADAPTIVE_TIMEOUT.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cmd.timeout.min'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_ADAPTIVE_TIMEOUT_MIN;
+
+            /**
+             * Maximum adaptive reply timeout, defaults to the ATT transaction timeout of 30000ms, see GATT_ADAPTIVE_TIMEOUT.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part F 3.3.3 Transaction
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cmd.timeout.max'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_ADAPTIVE_TIMEOUT_MAX;
+
+            /**
+             * Timeout of each L2CAP connect attempt, defaults to 5000ms, see L2CAPComm::connect().
+             * <p>
+             * Replaces the kernel's considerably longer timeout for unreachable devices.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.connect.timeout'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> GATT_L2CAP_CONNECT_TIMEOUT;
+
+            /**
+             * Socket tuning options of each GATT L2CAP channel, all defaulting to the kernel's defaults.
+             * <p>
+             * Environment variables are 'direct_bt.gatt.l2cap.sndbuf', 'direct_bt.gatt.l2cap.rcvbuf', 'direct_bt.gatt.l2cap.priority',
+             * 'direct_bt.gatt.l2cap.security' and 'direct_bt.gatt.l2cap.defer', see L2CAPSocketOptions.
+             * </p>
+             */
+            const L2CAPSocketOptions L2CAP_SOCKET_OPTIONS;
+
+            /**
+             * Maximum number of outstanding ATT_PREPARE_WRITE_REQ of a long write, defaults to 1.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part F 3.3.2 requires a client to wait for each response
+             * before sending the next request, i.e. a value of 1.
+             * Larger values pipeline the prepare requests and should only be used with servers tolerating them.
+             * The maximum is 32.
+             * </p>
+             * <p>
+             * The window is capped to the controller's LE ACL buffer count and zero selects the latter,
+             * see ControllerCaps::getPipelineDepth().
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.write.prepare.window'.
+             * </p>
+             */
+            const int32_t GATT_PREPARE_WRITE_WINDOW;
+
+            /**
+             * Maximum number of outstanding ATT_READ_BLOB_REQ of a long read, defaults to 1.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part F 3.3.2 requires a client to wait for each response
+             * before sending the next request, i.e. a value of 1.
+             * Larger values pipeline the blob requests at successive offsets and should only be used with servers tolerating them.
+             * A server rejecting a pipelined request falls back to stop-and-wait for the remaining connection.
+             * The maximum is 32.
+             * </p>
+             * <p>
+             * The window is capped to the controller's LE ACL buffer count and zero selects the latter,
+             * see ControllerCaps::getPipelineDepth().
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.read.blob.window'.
+             * </p>
+             */
+            const int32_t GATT_READ_BLOB_WINDOW;
+
+            /**
+             * Maximum number of outstanding Client Characteristic Configuration ATT_WRITE_REQ
+             * of GATTHandler::configNotificationIndication(const std::vector<GATTCharacteristicRef> &, const bool, const bool), defaults to 1.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part F 3.3.2 requires a client to wait for each response
+             * before sending the next request, i.e. a value of 1.
+             * Larger values pipeline the writes of multiple characteristics and should only be used with servers tolerating them.
+             * The maximum is 32.
+             * </p>
+             * <p>
+             * The window is capped to the controller's LE ACL buffer count and zero selects the latter,
+             * see ControllerCaps::getPipelineDepth().
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.write.cccd.window'.
+             * </p>
+             */
+            const int32_t GATT_CCCD_WRITE_WINDOW;
+
+            /**
+             * Maximum number of outstanding ATT_READ_REQ of GATTHandler::prefetchValues(), defaults to 1.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part F 3.3.2 requires a client to wait for each response
+             * before sending the next request, i.e. a value of 1.
+             * Larger values pipeline the reads of multiple characteristics and should only be used with servers tolerating them.
+             * The maximum is 32.
+             * </p>
+             * <p>
+             * The window is capped to the controller's LE ACL buffer count and zero selects the latter,
+             * see ControllerCaps::getPipelineDepth().
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.read.window'.
+             * </p>
+             */
+            const int32_t GATT_READ_WINDOW;
+
+            /**
+             * Maximum latency in milliseconds of a queued write without response, defaults to 0 disabling the write queue.
+             * <p>
+             * If greater zero, GATTHandler::writeCharacteristicValueNoResp() queues its ATT_WRITE_CMD
+             * w/o acquiring the command lock and returns immediately.
+             * The queue is drained by one writer thread, flushing all queued writes in order
+             * as soon as GATT_WRITE_QUEUE_BATCH writes are queued or the oldest has been queued for the given latency.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.write.queue.latency'.
+             * </p>
              */
-            const int32_t GATT_INITIAL_COMMAND_REPLY_TIMEOUT;
+            const int32_t GATT_WRITE_QUEUE_LATENCY;
+
+            /**
+             * Number of queued writes without response triggering an immediate flush, defaults to 16.
+             * <p>
+             * The queue holds at most four times this number, blocking writers until flushed.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.write.queue.batch'.
+             * </p>
+             */
+            const int32_t GATT_WRITE_QUEUE_BATCH;
 
             /**
              * Medium ringbuffer capacity, defaults to 128 messages.
              * <p>
+             * Grown per connection to the controller's LE ACL buffer count, see ControllerCaps::getRingCapacity().
+             * </p>
+             * <p>
              * Environment variable is 'direct_bt.gatt.ringsize'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> ATTPDU_RING_CAPACITY;
+
+            /**
+             * Overflow policy of the ATT PDU reply ringbuffer, defaults to 'block' for up to 500 ms.
+             * <p>
+             * A full ring only holds stale replies, discarded before the next request,
+             * hence its reader shall not block indefinitely.
+             * </p>
+             * <p>
+             * Environment variables are 'direct_bt.gatt.ring.policy', 'direct_bt.gatt.ring.timeout' and 'direct_bt.gatt.ring.max',
+             * see DBTRingOptions.
+             * </p>
              */
-            const int32_t ATTPDU_RING_CAPACITY;
+            const DBTRingOptions ATTPDU_RING_OPTIONS;
+
+            /**
+             * Receive ATT PDUs via the adapter's HCI reader thread instead of an own L2CAP reader thread,
+             * if the HCIHandler demultiplexes ACL data (see HCIEnv::HCI_ACL_DEMUX), defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.reader.hci'.
+             * </p>
+             */
+            const bool GATT_READER_VIA_HCI;
+
+            /**
+             * Number of worker threads of the L2CAPReactor shared by all GATTHandler instead of an own L2CAP reader thread each,
+             * defaults to 0 for disabled. The maximum is 16.
+             * <p>
+             * GATTEnv::GATT_READER_VIA_HCI takes precedence, if available.
+             * The reactor's workers use GATTEnv::L2CAP_READER_THREAD_OPTIONS.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.reader.reactor'.
+             * </p>
+             */
+            const int32_t GATT_READER_REACTOR_THREADS;
+
+            /**
+             * Receive ATT PDUs of all GATTHandler via the shared L2CAPReactor w/o worker threads,
+             * driven by the application's external event loop, see GATTHandler::getExternalReactor().
+             * Defaults to false.
+             * <p>
+             * GATTEnv::GATT_READER_VIA_HCI takes precedence, if available.
+             * The external event loop shall not call blocking GATT operations itself,
+             * as their replies are received via the same loop.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.reader.external'.
+             * </p>
+             */
+            const bool GATT_READER_EXTERNAL;
+
+            /**
+             * Scheduling options of each L2CAP reader thread, thread name defaults to 'dbt_gatt_rdr'.
+             * <p>
+             * Environment variables are 'direct_bt.gatt.reader.sched.fifo', 'direct_bt.gatt.reader.cpus' and 'direct_bt.gatt.reader.name',
+             * see DBTThreadOptions.
+             * </p>
+             */
+            const DBTThreadOptions L2CAP_READER_THREAD_OPTIONS;
+
+            /**
+             * Use the GATTCache, restoring validated attribute databases instead of discovering them, defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cache'.
+             * </p>
+             */
+            const bool GATT_CACHE;
+
+            /**
+             * Directory of the GATTCache's on-disk records, defaults to none, i.e. an in-memory cache only.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.cache.dir'.
+             * </p>
+             */
+            const std::string GATT_CACHE_DIR;
+
+            /**
+             * Discover all characteristics and descriptors of all services in one sweep each,
+             * instead of discovering them per service and characteristic, defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.discover.batched'.
+             * </p>
+             */
+            const bool GATT_DISCOVER_BATCHED;
+
+            /** Dispatch mode of received notifications and indications, see GATT_NOTIFY_DISPATCH. */
+            enum class NotifyDispatch : uint8_t {
+                /** GATTCharacteristicListener are invoked on the L2CAP reader thread */
+                READER = 0,
+                /** Queued to one GATTNotificationExecutor per GATTHandler */
+                DEVICE = 1,
+                /** Queued to one GATTNotificationExecutor shared by all GATTHandler */
+                SHARED = 2
+            };
+
+            /**
+             * Dispatch mode of received notifications and indications, defaults to NotifyDispatch::READER.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.notify.dispatch' with value 'reader', 'device' or 'shared'.
+             * </p>
+             */
+            const NotifyDispatch GATT_NOTIFY_DISPATCH;
+
+            /**
+             * Capacity of a GATTNotificationExecutor's queue, defaults to 256.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.notify.queue'.
+             * </p>
+             */
+            const int32_t GATT_NOTIFY_QUEUE_CAPACITY;
+
+            /**
+             * Overflow policy of a GATTNotificationExecutor's queue:
+             * If true, the oldest queued value is dropped, otherwise the newly received value. Defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.notify.drop.oldest'.
+             * </p>
+             */
+            const bool GATT_NOTIFY_DROP_OLDEST;
+
+            /**
+             * Cache the values of the static GenericAccess and DeviceInformation service characteristics
+             * permanently per device, see GATTValueCache, defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.gatt.value.cache.static'.
+             * </p>
+             */
+            const bool GATT_VALUE_CACHE_STATIC;
+
+            /**
+             * Defer reading the GenericAccess service values from DBTDevice::getGATTServices()
+             * to the first DBTDevice::getGATTGenericAccess() call, defaults to false.
+             * <p>
+             * Saves the GenericAccess read round-trips and the resulting AdapterStatusListener::deviceUpdated()
+             * on each connect, if the application doesn't use them.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.genericaccess.lazy'.
+             * </p>
+             */
+            const bool GATT_GENERIC_ACCESS_LAZY;
+
+            /**
+             * Requested client ATT_MTU of the MTU exchange at GATTHandler::connect(), defaults to 512.
+             * <p>
+             * The range is [23..512], i.e. [GATTHandler::Defaults::MIN_ATT_MTU..GATTHandler::Defaults::MAX_ATT_MTU].
+             * May be overridden per device via DBTDevice::connectGATT(const uint16_t) or GATTHandler::setClientMTU().
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.gatt.mtu'.
+             * </p>
+             */
+            const int32_t GATT_CLIENT_MTU;
 
             /**
              * Debug all GATT Data communication
@@ -119,6 +512,15 @@ namespace direct_bt {
             const bool DEBUG_DATA;
 
         public:
+            /**
+             * Re-reads all runtime adjustable properties from the environment,
+             * invoked by DBTEnv::setProperty() for each property below 'direct_bt.gatt'.
+             * <p>
+             * Live handlers use the new values with their next operation.
+             * </p>
+             */
+            void reload();
+
             static GATTEnv& get() {
                 /**
                  * Thread safe starting with C++11 6.7:
@@ -135,6 +537,81 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * Executor invoking GATTCharacteristicListener for received notifications and indications
+     * off the L2CAP reader thread, see GATTEnv::GATT_NOTIFY_DISPATCH.
+     * <p>
+     * Received values are queued in a bounded LFRingbuffer and dispatched in order by one worker thread.
+     * On overflow a value is dropped and counted, see GATTEnv::GATT_NOTIFY_DROP_OLDEST.
+     * </p>
+     */
+    class GATTNotificationExecutor {
+        public:
+            /** One received notification or indication, owning a copy of its value. */
+            class Event {
+                public:
+                    const std::weak_ptr<GATTHandler> handler;
+                    const bool isNotification;
+                    const uint16_t handle;
+                    const POctets value;
+                    const uint64_t timestamp;
+                    const bool cfmSent;
+
+                    Event(const std::weak_ptr<GATTHandler> & handler, const bool isNotification, const uint16_t handle,
+                          const TROOctets & value, const uint64_t timestamp, const bool cfmSent)
+                    : handler(handler), isNotification(isNotification), handle(handle), value(value),
+                      timestamp(timestamp), cfmSent(cfmSent) {}
+            };
+
+        private:
+            LFRingbuffer<std::shared_ptr<const Event>, nullptr> queue;
+            const bool dropOldest;
+            std::atomic<bool> running;
+            std::atomic<uint64_t> enqueuedCount;
+            std::atomic<uint64_t> droppedCount;
+            std::thread::id workerId;
+            std::mutex mtx_worker;
+            std::condition_variable cv_worker;
+            bool workerEnded;
+
+            GATTNotificationExecutor(const int capacity, const bool dropOldest);
+
+            void workerImpl();
+
+        public:
+            /** Returns a new started executor with given queue capacity and overflow policy. */
+            static std::shared_ptr<GATTNotificationExecutor> create(const int capacity, const bool dropOldest);
+
+            /** Returns the executor shared by all GATTHandler, see GATTEnv::NotifyDispatch::SHARED. */
+            static std::shared_ptr<GATTNotificationExecutor> getShared();
+
+            GATTNotificationExecutor(const GATTNotificationExecutor&) = delete;
+            void operator=(const GATTNotificationExecutor&) = delete;
+
+            /**
+             * Queues the given event.
+             * <p>
+             * Returns false if a value has been dropped due to overflow or if the executor has been stopped,
+             * i.e. the given event for the drop-newest policy and the oldest for the drop-oldest policy.
+             * </p>
+             */
+            bool enqueue(const std::shared_ptr<const Event> & e);
+
+            /**
+             * Stops the worker, discarding all queued events.
+             * @param wait if true, waits until the worker has ended its current dispatch, unless called by the worker itself.
+             */
+            void stop(const bool wait);
+
+            bool isRunning() const { return running; }
+            int getQueueSize() const { return queue.getSize(); }
+            int getQueueCapacity() const { return queue.capacity(); }
+            uint64_t getEnqueuedCount() const { return enqueuedCount; }
+            uint64_t getDroppedCount() const { return droppedCount; }
+
+            std::string toString() const;
+    };
+
     /**
      * A thread safe GATT handler associated to one device via one L2CAP connection.
      * <p>
@@ -145,6 +622,9 @@ namespace direct_bt {
      * </p>
      */
     class GATTHandler {
+        friend class GATTWriteStream;
+        friend class GATTNotificationExecutor;
+
         public:
             enum class Defaults : int32_t {
                 /* BT Core Spec v5.2: Vol 3, Part F 3.2.8: Maximum length of an attribute value. */
@@ -157,41 +637,267 @@ namespace direct_bt {
 
        private:
             const GATTEnv & env;
+            /** The device's DBTProfile at construction, may be nullptr */
+            const std::shared_ptr<const DBTProfile> profile;
+            /** The adapter's ControllerCaps at construction */
+            const ControllerCaps controllerCaps;
+            /** GATTEnv pipelining windows sized via ControllerCaps::getPipelineDepth() */
+            const int32_t prepareWriteWindow;
+            const int32_t readBlobWindow;
+            const int32_t cccdWriteWindow;
+            const int32_t readWindow;
 
             /** GATTHandle's device weak back-reference */
             std::weak_ptr<DBTDevice> wbr_device;
 
             const std::string deviceString;
-            std::recursive_mutex mtx_command;
+            /** Latency metrics of this device, see DBTMetrics */
+            LatencyHistogram & metricRead;
+            LatencyHistogram & metricWrite;
+            LatencyHistogram & metricDiscovery;
+            /** Round-trip time of each non-retried request */
+            LatencyHistogram & metricRTT;
+            RTTEstimator rttEstimator;
+            DBTRecursiveMutex mtx_command { "gatt_command" };
+            /** L2CAP reader buffer, only accessed by the reader thread and resized by it to rbufferTargetSize */
             POctets rbuffer;
 
             L2CAPComm l2cap;
             std::atomic<bool> isConnected; // reflects state
             std::atomic<bool> hasIOError;  // reflects state
 
-            LFRingbuffer<std::shared_ptr<const AttPDUMsg>, nullptr> attPDURing;
+            /** Recycled received ATT PDUs, only used by the one active reader */
+            AttPDUPool attPDUPool;
+            /** Replies, produced by the one active reader and consumed by the requester holding mtx_command. */
+            OverflowRingbuffer<std::shared_ptr<const AttPDUMsg>, nullptr> attPDURing;
             std::atomic<pthread_t> l2capReaderThreadId;
             std::atomic<bool> l2capReaderRunning;
             std::atomic<bool> l2capReaderShallStop;
             std::mutex mtx_l2capReaderInit;
             std::condition_variable cv_l2capReaderInit;
+            /** HCIHandler delivering our ATT PDUs if GATTEnv::GATT_READER_VIA_HCI is in use, otherwise empty */
+            std::weak_ptr<HCIHandler> hciReader;
+            uint16_t hciReaderHandle;
+            /** Shared L2CAPReactor delivering our ATT PDUs if GATTEnv::GATT_READER_REACTOR_THREADS is in use, otherwise empty */
+            std::shared_ptr<L2CAPReactor> reactorReader;
+            uint64_t reactorReaderId;
 
             /** send immediate confirmation of indication events from device, defaults to true. */
             bool sendIndicationConfirmation = true;
-            std::vector<std::shared_ptr<GATTCharacteristicListener>> characteristicListenerList;
-            std::recursive_mutex mtx_eventListenerList;
+            /** Copy-on-write GATTCharacteristicListener list, iterated w/o locking by the notification dispatch */
+            COWVector<std::shared_ptr<GATTCharacteristicListener>> characteristicListenerList;
+            /** Characteristic value handle to its bound GATTCharacteristicListener, see boundListenerIndex */
+            typedef std::map<uint16_t, std::vector<std::shared_ptr<GATTCharacteristicListener>>> BoundListenerIndex;
+            /**
+             * Immutable snapshot of listener bound to value handles via addCharacteristicListener(l, valueHandles),
+             * replaced under characteristicListenerList's write mutex and read via std::atomic_load w/o locking.
+             */
+            std::shared_ptr<const BoundListenerIndex> boundListenerIndex;
+            /** Guards sendIndicationConfirmation */
+            DBTRecursiveMutex mtx_eventListenerList { "gatt_listener" };
 
             uint16_t serverMTU;
             uint16_t usedMTU;
+            /** Requested client ATT_MTU of the next MTU exchange */
+            uint16_t clientMTU;
+            /**
+             * Size of rbuffer to be applied by the reader thread before its next read:
+             * The larger of clientMTU and usedMTU while an MTU exchange is pending, otherwise usedMTU.
+             */
+            std::atomic<int> rbufferTargetSize;
+            /** false if the server rejected ATT_READ_MULTIPLE_VARIABLE_REQ, reset on connect() */
+            bool readMultipleVariableSupported;
+            /** false if the server rejected a pipelined ATT_READ_BLOB_REQ, reset on connect() */
+            bool readBlobPipelineSupported;
             std::vector<GATTServiceRef> services;
+            /** Database Hash of the services as stored in the GATTCache, empty if none */
+            POctets cacheDBHash;
+
+            /**
+             * Flat attribute table of the discovered services,
+             * rebuilt by discoverCompletePrimaryServices() and read via std::atomic_load w/o locking.
+             */
+            std::shared_ptr<const GATTAttributeTable> attributeTable;
+            void updateAttributeTable();
+
+            /** Service Changed Characteristic value handle of the services, zero if none, updated with attributeTable */
+            std::atomic<uint16_t> serviceChangedHandle;
+
+            /**
+             * Reads the Database Hash Characteristic value via ATT_READ_BY_TYPE_REQ,
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 7.3 Database Hash
+             * @return true if the device exposes a Database Hash, otherwise false
+             */
+            bool readDatabaseHash(POctets & res);
+
+            /**
+             * Discovers all descriptors within the given handle range via ATT_FIND_INFORMATION_REQ,
+             * assigning each to its enclosing characteristic of the given services.
+             * Declarations and characteristic values within the range are skipped.
+             */
+            bool discoverDescriptorRange(std::vector<GATTServiceRef> & services, const uint16_t startHandle, const uint16_t endHandle);
 
             std::shared_ptr<DBTDevice> getDevice() const { return wbr_device.lock(); }
 
-            bool validateConnected();
+            bool validateConnected();
+
+            /**
+             * Removes all listener bound to the given value handle, or to any handle if zero, for which match returns true.
+             * @return number of removed bindings
+             */
+            int unbindCharacteristicListener(const uint16_t valueHandle, std::function<bool(const std::shared_ptr<GATTCharacteristicListener> &)> match);
+
+            static void invokeCharacteristicListener(GATTCharacteristicListener & l, GATTCharacteristicRef decl, std::shared_ptr<TROOctets> & data,
+                                                     const bool isNotification, const TROOctets & value, const uint64_t timestamp, const bool cfmSent);
+
+            /**
+             * Dispatches one received notification or indication value to the listener bound to its handle
+             * and to all matching unbound GATTCharacteristicListener.
+             */
+            void dispatchHandleValue(const bool isNotification, const uint16_t handle, const TROOctets & value,
+                                     const uint64_t timestamp, const bool cfmSent);
+
+            /** Weak reference to this instance, set by create() and referenced by queued GATTNotificationExecutor::Event */
+            std::weak_ptr<GATTHandler> wbr_self;
+            /** Per GATTHandler executor if GATTEnv::NotifyDispatch::DEVICE is in use, read via std::atomic_load */
+            std::shared_ptr<GATTNotificationExecutor> notificationExecutor;
+            /** Number of this GATTHandler's notification and indication values dropped by its GATTNotificationExecutor */
+            std::atomic<uint64_t> notificationDropCount;
+            /**
+             * Delivers one received notification or indication value as configured by GATTEnv::GATT_NOTIFY_DISPATCH,
+             * i.e. dispatches it directly or queues it to the GATTNotificationExecutor.
+             */
+            void deliverHandleValue(const bool isNotification, const uint16_t handle, const TROOctets & value,
+                                    const uint64_t timestamp, const bool cfmSent);
+            /** Dispatches one received ATT PDU of the given monotonic receive timestamp in nanoseconds, called by the L2CAP, HCI or reactor reader thread */
+            void processAttPDU(const uint8_t * data, const int len, const uint64_t timestampNS);
+            void l2capReaderThreadImpl();
+            /** L2CAPFrameCallback of the HCIHandler's reader thread, if GATTEnv::GATT_READER_VIA_HCI is in use */
+            bool l2capFrameReceived(uint16_t handle, uint16_t cid, const TROOctets & payload);
+            /** Registers l2capFrameReceived() at the adapter's HCIHandler, returns true if successful. */
+            bool startHCIReader();
+            /** L2CAPReactor::ReadCallback of the shared reactor, if GATTEnv::GATT_READER_REACTOR_THREADS is in use */
+            bool l2capReactorReceived(const uint8_t * data, int len);
+            /** Registers our L2CAP channel at the shared L2CAPReactor, returns true if successful. */
+            bool startReactorReader();
+            /** Removes our L2CAP channel from the shared L2CAPReactor, if registered. */
+            void stopReactorReader(const bool wait);
+
+            /**
+             * Sends the given PDU, returning GATTStatus::SUCCESS or the transport failure.
+             * <p>
+             * On an L2CAP write error the connection is closed.
+             * </p>
+             */
+            GATTStatus sendImpl(const AttPDUMsg & msg);
+            /** Throwing sendImpl(), see throwOnTransportFailure(). */
+            void send(const AttPDUMsg & msg);
+            /**
+             * Throws the exception of the given transport failure, see isGATTTransportFailure(), otherwise returns.
+             * <p>
+             * GATTStatus::INVALID_STATE throws an IllegalStateException, GATTStatus::PDU_TOO_LARGE an IllegalArgumentException
+             * and all other transport failures a BluetoothException.
+             * </p>
+             */
+            void throwOnTransportFailure(const GATTStatus status, const char * what, const char* file, int line) const;
+            /** Duration of the last connect()'s L2CAP open and MTU exchange in microseconds */
+            uint64_t connectL2CAPUS;
+            uint64_t connectMTUUS;
+
+            /** Number of consecutive requests failed w/ a reply timeout, reset by any received reply */
+            std::atomic<int> consecutiveReplyTimeouts;
+            /**
+             * Opcodes of requests abandoned after a reply timeout w/o disconnect, oldest first, guarded by mtx_command.
+             * Their late replies are discarded, see discardAbandonedReply().
+             */
+            std::deque<AttPDUMsg::Opcode> abandonedRequests;
+            /** Total number of request retries and of requests failed w/ a reply timeout */
+            std::atomic<uint64_t> replyRetryCount;
+            std::atomic<uint64_t> replyTimeoutCount;
+            /** Traffic accounting of this connection, see getTrafficStats() */
+            TrafficStats traffic;
+
+            /**
+             * Receives the reply to the outstanding request of the given opcode, see AttPDUMsg::isReplyTo().
+             * <p>
+             * Stale replies not matching the request and late replies to abandoned requests are discarded.
+             * On timeout the wait is extended as configured by GATTEnv::GATT_COMMAND_RETRIES.
+             * If no retry remains, GATTStatus::TIMEOUT is returned and the connection is closed
+             * as configured by GATTEnv::GATT_COMMAND_TIMEOUT_DISCONNECT, otherwise the request is abandoned.
+             * A timed out pipelined request always closes the connection.
+             * </p>
+             * @param reqOpcode the outstanding request's opcode
+             * @param req the outstanding request for logging, or nullptr if pipelined
+             * @param timeout the total timeout in milliseconds
+             * @param res the received reply, valid if GATTStatus::SUCCESS is returned
+             */
+            GATTStatus receiveReplyImpl(const AttPDUMsg::Opcode reqOpcode, const AttPDUMsg * req, const int timeout,
+                                        std::shared_ptr<const AttPDUMsg> & res);
+            /** Throwing receiveReplyImpl(), never returning nullptr. */
+            std::shared_ptr<const AttPDUMsg> receiveReply(const AttPDUMsg::Opcode reqOpcode, const AttPDUMsg * req, const int timeout);
+
+            /** Returns true and discards the given reply if it is the late reply to the oldest abandoned request. */
+            bool discardAbandonedReply(const AttPDUMsg & pdu);
+
+            /** Discards all pending stale replies, e.g. received after a previous request timed out. */
+            void discardStaleReplies();
+
+            /** Queued ATT_WRITE_CMD of writeCharacteristicValueNoResp(), see GATTEnv::GATT_WRITE_QUEUE_LATENCY */
+            std::mutex mtx_writeQueue;
+            std::condition_variable cv_writeQueue;
+            std::deque<std::shared_ptr<const AttWriteCmd>> writeQueue;
+            /** Monotonic timestamp in milliseconds of the oldest queued write */
+            uint64_t writeQueueT0;
+            std::thread writeQueueWorker;
+            bool writeQueueWorkerShallStop;
+            /** Serializes flushWriteQueue() of the worker and the command path, preserving the write order */
+            std::mutex mtx_writeQueueFlush;
+            void writeQueueWorkerImpl();
+            /** Queues the given write, starting the worker if required. Blocks while the queue is full. */
+            GATTStatus queueWrite(const uint16_t handle, const TROOctets & value);
+            /** Sends all queued writes, returns the number of sent writes. */
+            int flushWriteQueue();
+            /**
+             * Stops the write queue worker, dropping all queued writes.
+             * @param wait if true, waits until the worker has ended, unless called by the worker itself.
+             */
+            void stopWriteQueueWorker(const bool wait);
+
+            /** Sends the given ATT_WRITE_CMD after flushing queued writes, recording its metric since t0. */
+            GATTStatus sendWriteCmd(const AttWriteCmd & req, const uint64_t t0);
+            /** Sends the given ATT_WRITE_REQ awaiting its reply, recording its metric since t0. */
+            GATTStatus sendWriteReq(const AttWriteReq & req, const uint64_t t0);
 
-            void l2capReaderThreadImpl();
+            GATTStatus readValueImpl(const uint16_t handle, POctets & res, int expectedLength);
+            GATTStatus readCharacteristicValueImpl(const GATTCharacteristic & c, POctets & res, int expectedLength);
+            GATTStatus writeValueImpl(const uint16_t handle, const TROOctets & value, const bool withResponse);
+            GATTStatus writeLongValueImpl(const uint16_t handle, const TROOctets & value, const bool reliable);
+            GATTStatus writeCharacteristicValueImpl(const GATTCharacteristic & c, const TROOctets & value, const bool withResponse);
+            GATTStatus writeCharacteristicValueImpl(const GATTCharacteristic & c, const int valueSize,
+                                                    const GATTCharacteristic::ValueFill & fill, const bool withResponse);
 
-            void send(const AttPDUMsg & msg);
+            /**
+             * Reads the values of the given handles via ATT_READ_REQ, keeping up to GATTEnv::GATT_READ_WINDOW requests outstanding,
+             * appending one value per handle to res, nullptr if the server rejected the read.
+             */
+            void readValuesPipelined(const std::vector<uint16_t> & handles, std::vector<std::shared_ptr<POctets>> & res);
+
+            /** Serializes async requests of readValueAsync() and writeValueAsync() */
+            std::mutex mtx_async;
+            std::condition_variable cv_async;
+            std::deque<std::function<void()>> asyncJobs;
+            std::thread asyncWorker;
+            bool asyncWorkerShallStop;
+            void asyncWorkerImpl();
+            void postAsync(std::function<void()> job);
+            /**
+             * Stops the async worker, breaking the promises of all pending async requests.
+             * @param wait if true, waits until the worker has ended its current job, unless called by the worker itself.
+             */
+            void stopAsyncWorker(const bool wait);
+            /** Sends the given request after flushing queued writes and receives its reply via receiveReplyImpl(). */
+            GATTStatus sendWithReplyImpl(const AttPDUMsg & msg, const int timeout, std::shared_ptr<const AttPDUMsg> & res);
+            /** Throwing sendWithReplyImpl(), never returning nullptr. */
             std::shared_ptr<const AttPDUMsg> sendWithReply(const AttPDUMsg & msg, const int timeout);
 
             /**
@@ -202,8 +908,32 @@ namespace direct_bt {
              */
             uint16_t exchangeMTU(const uint16_t clientMaxMTU);
 
+            /**
+             * Exchanges the MTU with clientMTU, updating serverMTU, usedMTU and rbufferTargetSize.
+             * <p>
+             * Returns false if the exchange failed, leaving usedMTU unchanged.
+             * </p>
+             */
+            bool negotiateMTU();
+
         public:
-            GATTHandler(const std::shared_ptr<DBTDevice> & device);
+            /**
+             * @param device the associated device
+             * @param clientMTU requested client ATT_MTU in the range [23..512], zero to use GATTEnv::GATT_CLIENT_MTU (default)
+             */
+            GATTHandler(const std::shared_ptr<DBTDevice> & device, const uint16_t clientMTU=0);
+
+            /**
+             * Returns a new GATTHandler holding a weak reference to itself,
+             * required to dispatch notifications and indications off the L2CAP reader thread, see GATTEnv::GATT_NOTIFY_DISPATCH.
+             * <p>
+             * An instance created by the constructor drops notifications and indications
+             * if GATTEnv::NotifyDispatch::DEVICE or GATTEnv::NotifyDispatch::SHARED is in use.
+             * </p>
+             * @param device the associated device
+             * @param clientMTU requested client ATT_MTU in the range [23..512], zero to use GATTEnv::GATT_CLIENT_MTU (default)
+             */
+            static std::shared_ptr<GATTHandler> create(const std::shared_ptr<DBTDevice> & device, const uint16_t clientMTU=0);
 
             ~GATTHandler();
 
@@ -211,12 +941,24 @@ namespace direct_bt {
             bool getHasIOError() const { return hasIOError; }
             std::string getStateString() const { return L2CAPComm::getStateString(isConnected, hasIOError); }
 
+            /**
+             * Returns the number of octets queued on the L2CAP socket but not yet sent to the controller,
+             * allowing to pace write without response streams, or -1 if not connected. See L2CAPComm::getSendQueueSize().
+             */
+            int getSendQueueSize() const { return l2cap.getSendQueueSize(); }
+
             /**
              * After successful l2cap connection, the MTU will be exchanged.
              * See getServerMTU() and getUsedMTU(), the latter is in use.
              */
             bool connect();
 
+            /**
+             * Cancels a pending L2CAP connect of connect() from another thread w/o locking,
+             * i.e. connect() fails promptly, see L2CAPComm::cancelConnect().
+             */
+            void cancelConnect() { l2cap.cancelConnect(); }
+
             /**
              * Disconnect this GATTHandler and optionally the associated device
              * @param disconnectDevice if true, associated device will also be disconnected, otherwise not.
@@ -230,10 +972,35 @@ namespace direct_bt {
             uint16_t getServerMTU() const { return serverMTU; }
             uint16_t getUsedMTU()  const { return usedMTU; }
 
+            /** Returns the overflow counters of the ATT PDU reply ringbuffer, see GATTEnv::ATTPDU_RING_OPTIONS. */
+            const RingStats & getAttPDURingStats() const { return attPDURing.getStats(); }
+            uint16_t getClientMTU() const { return clientMTU; }
+
+            /**
+             * Sets the requested client ATT_MTU used by the next MTU exchange, see connect() and updateMTU().
+             * @param mtu in the range [23..512], throws IllegalArgumentException otherwise
+             */
+            void setClientMTU(const uint16_t mtu);
+
+            /**
+             * Retriggers the MTU exchange using getClientMTU() on the connected GATTHandler,
+             * e.g. after a larger client MTU has been set to benefit from a link layer data length or PHY update.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part F 3.4.2.1 allows the client to send the request only once per connection,
+             * hence servers may reject a repeated exchange. The previous used MTU is retained in such case.
+             * </p>
+             * @return the used MTU after the exchange, or zero if not connected or on failure
+             */
+            uint16_t updateMTU();
+
             /**
              * Find and return the GATTCharacterisicsDecl within internal primary services
              * via given characteristic value handle.
              * <p>
+             * Uses a binary search on the GATTAttributeTable built by discoverCompletePrimaryServices(),
+             * falling back to a linear search of all services if not found.
+             * </p>
+             * <p>
              * Returns nullptr if not found.
              * </p>
              */
@@ -263,10 +1030,20 @@ namespace direct_bt {
              * <p>
              * BT Core Spec v5.2: Vol 3, Part G GATT: 4.4.1 Discover All Primary Services
              * </p>
+             * <p>
+             * If GATTEnv::GATT_CACHE is enabled, a validated attribute database of the GATTCache is restored instead,
+             * see BT Core Spec v5.2: Vol 3, Part G GATT: 2.5.2 Attribute Caching.
+             * A new discovery result is stored in the GATTCache.
+             * </p>
              * Method returns reference to GATTHandler internal data.
              */
             std::vector<GATTServiceRef> & discoverCompletePrimaryServices();
 
+            /**
+             * Returns the GATTCache used by discoverCompletePrimaryServices() if GATTEnv::GATT_CACHE is enabled.
+             */
+            static GATTCache & getCache();
+
             /**
              * Returns a reference of the internal kept GATTService list.
              * <p>
@@ -275,6 +1052,40 @@ namespace direct_bt {
              */
             std::vector<GATTServiceRef> & getServices() { return services; }
 
+            /**
+             * Returns the compact GATTAttributeTable of the discovered services,
+             * or nullptr if discoverCompletePrimaryServices() has not completed.
+             */
+            std::shared_ptr<const GATTAttributeTable> getAttributeTable() const { return std::atomic_load(&attributeTable); }
+
+            /**
+             * Lazy discovery of the primary service of given type _only_, without its characteristics.
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 4.4.2 Discover Primary Service by Service UUID
+             * </p>
+             * <p>
+             * A service already contained in getServices() is returned as is,
+             * otherwise the discovered service is added to getServices().
+             * </p>
+             * <p>
+             * Returns nullptr if not found.
+             * </p>
+             */
+            GATTServiceRef findService(const uuid_t & type);
+
+            /**
+             * Lazy discovery of the characteristic of given value type within given service,
+             * including its descriptors.
+             * <p>
+             * The service's characteristic declarations are discovered once if not yet done,
+             * the descriptors of the returned characteristic _only_ if it has none yet.
+             * </p>
+             * <p>
+             * Returns nullptr if not found.
+             * </p>
+             */
+            GATTCharacteristicRef findCharacteristic(GATTServiceRef service, const uuid_t & value_type);
+
             /**
              * Discover all primary services _only_.
              * <p>
@@ -299,6 +1110,24 @@ namespace direct_bt {
              */
             bool discoverDescriptors(GATTServiceRef & service);
 
+            /**
+             * Discover all characteristics of all given services using one ATT_READ_BY_TYPE_REQ sweep
+             * over the services' handle range, assigning each characteristic to its enclosing service.
+             * <p>
+             * Used by discoverCompletePrimaryServices() if GATTEnv::GATT_DISCOVER_BATCHED is enabled.
+             * </p>
+             */
+            bool discoverAllCharacteristics(std::vector<GATTServiceRef> & services);
+
+            /**
+             * Discover all descriptors of all given services' characteristics using one ATT_FIND_INFORMATION_REQ sweep
+             * over the services' handle range, assigning each descriptor to its enclosing characteristic.
+             * <p>
+             * Used by discoverCompletePrimaryServices() if GATTEnv::GATT_DISCOVER_BATCHED is enabled.
+             * </p>
+             */
+            bool discoverAllDescriptors(std::vector<GATTServiceRef> & services);
+
             /**
              * Generic read GATT value and long value
              * <p>
@@ -312,9 +1141,121 @@ namespace direct_bt {
              * If expectedLength > 0, then long values using multiple ATT_READ_BLOB_REQ/RSP will be used
              * if required until the response returns zero.
              * </p>
+             * <p>
+             * Transport failures are thrown, see readValueStatus().
+             * </p>
              */
             bool readValue(const uint16_t handle, POctets & res, int expectedLength=-1);
 
+            /**
+             * Non-throwing readValue(const uint16_t, POctets &, int), returning the GATTStatus instead.
+             * <p>
+             * A partially read long value is returned as GATTStatus::SUCCESS, like readValue() returns true,
+             * while an empty value is returned as GATTStatus::INVALID_VALUE.
+             * </p>
+             */
+            GATTStatus readValueStatus(const uint16_t handle, POctets & res, int expectedLength=-1) noexcept;
+
+        private:
+            /**
+             * Continues a long read at the given offset with up to GATTEnv::GATT_READ_BLOB_WINDOW outstanding ATT_READ_BLOB_REQ.
+             * <p>
+             * Sets done to true if the value has been read completely,
+             * otherwise to false with the offset of the remaining value to be read via stop-and-wait.
+             * </p>
+             * @return GATTStatus::SUCCESS or the transport failure
+             */
+            GATTStatus readLongValuePipelined(const uint16_t handle, POctets & res, int & offset, const int expectedLength, bool & done);
+
+        public:
+
+            /**
+             * Asynchronous readValue(), performed by this GATTHandler's async worker thread
+             * in the order of all async requests.
+             * <p>
+             * The future holds the read value or nullptr on failure,
+             * or a std::future_error with std::future_errc::broken_promise if disconnected before being performed.
+             * </p>
+             * @throws IllegalStateException if not connected
+             */
+            std::future<std::shared_ptr<POctets>> readValueAsync(const uint16_t handle, int expectedLength=-1);
+
+            /** Completion of readValueAsync(const uint16_t, int, ReadValueCallback), receiving the read value or nullptr on failure. */
+            typedef std::function<void(std::shared_ptr<POctets> value)> ReadValueCallback;
+
+            /**
+             * Asynchronous readValue() like readValueAsync(const uint16_t, int),
+             * but completing via the given callback instead of a std::future,
+             * i.e. no thread needs to block waiting for the result.
+             * <p>
+             * The callback is invoked exactly once on the async worker thread,
+             * with nullptr if the read failed or was dropped by a disconnect before being performed.
+             * If not connected, it is invoked on the calling thread with nullptr.
+             * </p>
+             */
+            void readValueAsync(const uint16_t handle, int expectedLength, ReadValueCallback cb);
+
+            /**
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.5 Read Multiple Variable Length Characteristic Values
+             * <p>
+             * Reads the values of all given handles with as few ATT_READ_MULTIPLE_VARIABLE_REQ/RSP round trips
+             * as the used ATT_MTU allows, storing one value per handle to res at the handle's index.
+             * Values truncated by the ATT_MTU are completed via readValue().
+             * </p>
+             * <p>
+             * If the server doesn't support ATT_READ_MULTIPLE_VARIABLE_REQ,
+             * each value is read via readValue() for the remaining connection.
+             * </p>
+             * @param handles the value handles
+             * @param res the value storage, resized to the number of handles
+             * @return true if all values have been read, otherwise false while res holds nullptr for each unread value.
+             */
+            bool readValues(const std::vector<uint16_t> & handles, std::vector<std::shared_ptr<POctets>> & res);
+
+            /**
+             * Batch callback of prefetchValues(), receiving the characteristics and their values in the same order.
+             * A value is nullptr if it could not be read.
+             */
+            typedef std::function<void(const std::vector<GATTCharacteristicRef> & characteristics,
+                                       const std::vector<std::shared_ptr<POctets>> & values)> PrefetchCallback;
+
+            /**
+             * Reads the values of the given characteristics in one optimized sequence,
+             * filling their GATTValueCache and delivering all values via one PrefetchCallback invocation.
+             * <p>
+             * Values still held by a characteristic's GATTValueCache are not read.
+             * All other values are read via readValues(const std::vector<uint16_t> &, std::vector<std::shared_ptr<POctets>> &)
+             * if ATT_READ_MULTIPLE_VARIABLE_REQ is supported, otherwise and for the remainder after a rejected request
+             * via ATT_READ_REQ keeping up to GATTEnv::GATT_READ_WINDOW requests outstanding.
+             * Long values are completed via readValue().
+             * </p>
+             * @param characteristics the characteristics to read
+             * @param cb the callback invoked on the calling thread once all values have been read, may be nullptr
+             * @return the number of values available, i.e. characteristics.size() if all have been read
+             */
+            int prefetchValues(const std::vector<GATTCharacteristicRef> & characteristics, PrefetchCallback cb);
+
+            /**
+             * Reads the values of all characteristics of the discovered services having the PropertyBitVal::Read property,
+             * see prefetchValues(const std::vector<GATTCharacteristicRef> &, PrefetchCallback).
+             */
+            int prefetchValues(PrefetchCallback cb);
+
+            /**
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.4 Read Multiple Characteristic Values
+             * <p>
+             * Reads the values of all given handles of known fixed length with as few ATT_READ_MULTIPLE_REQ/RSP
+             * round trips as the used ATT_MTU allows, storing one value per handle to res at the handle's index.
+             * Values not fitting into one ATT_MTU are read via readValue().
+             * </p>
+             * @param handles the value handles
+             * @param valueLengths the fixed value length of each handle
+             * @param res the value storage, resized to the number of handles
+             * @return true if all values have been read, otherwise false while res holds nullptr for each unread value.
+             */
+            bool readValues(const std::vector<uint16_t> & handles, const std::vector<int> & valueLengths,
+                            std::vector<std::shared_ptr<POctets>> & res);
+
             /**
              * BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.1 Read Characteristic Value
              * <p>
@@ -331,9 +1272,16 @@ namespace direct_bt {
              * If expectedLength > 0, then long values using multiple ATT_READ_BLOB_REQ/RSP will be used
              * if required until the response returns zero.
              * </p>
+             * <p>
+             * The result is appended to res, which capacity is grown once to the expected length
+             * or if not given, to the characteristic's last completely read value length.
+             * </p>
              */
             bool readCharacteristicValue(const GATTCharacteristic & c, POctets & res, int expectedLength=-1);
 
+            /** Non-throwing readCharacteristicValue(), returning the GATTStatus instead, see readValueStatus(). */
+            GATTStatus readCharacteristicValueStatus(const GATTCharacteristic & c, POctets & res, int expectedLength=-1) noexcept;
+
             /**
              * BT Core Spec v5.2: Vol 3, Part G GATT: 4.12.1 Read Characteristic Descriptor
              * <p>
@@ -350,14 +1298,73 @@ namespace direct_bt {
              * If expectedLength > 0, then long values using multiple ATT_READ_BLOB_REQ/RSP will be used
              * if required until the response returns zero.
              * </p>
+             * <p>
+             * The result is appended to the descriptor's value, whether read or served by its GATTValueCache.
+             * </p>
              */
             bool readDescriptorValue(GATTDescriptor & cd, int expectedLength=-1);
 
             /**
              * Generic write GATT value and long value
+             * <p>
+             * If withResponse is true and the value exceeds the used ATT_MTU - 3,
+             * writeLongValue() is used.
+             * </p>
              */
             bool writeValue(const uint16_t handle, const TROOctets & value, const bool withResponse);
 
+            /**
+             * Non-throwing writeValue(const uint16_t, const TROOctets &, const bool), returning the GATTStatus instead.
+             * <p>
+             * Routine failures like a reply timeout, an L2CAP write error or a disconnected state
+             * are returned w/o throwing, avoiding the exception cost e.g. during reconnect storms.
+             * </p>
+             */
+            GATTStatus writeValueStatus(const uint16_t handle, const TROOctets & value, const bool withResponse) noexcept;
+
+            /**
+             * Asynchronous writeValue() of a copy of the given value, performed by this GATTHandler's async worker thread
+             * in the order of all async requests.
+             * <p>
+             * The future holds the writeValue() result,
+             * or a std::future_error with std::future_errc::broken_promise if disconnected before being performed.
+             * </p>
+             * @throws IllegalStateException if not connected
+             */
+            std::future<bool> writeValueAsync(const uint16_t handle, const TROOctets & value, const bool withResponse);
+
+            /** Completion of writeValueAsync(const uint16_t, const TROOctets &, const bool, WriteValueCallback), receiving the writeValue() result. */
+            typedef std::function<void(bool success)> WriteValueCallback;
+
+            /**
+             * Asynchronous writeValue() of a copy of the given value like writeValueAsync(const uint16_t, const TROOctets &, const bool),
+             * but completing via the given callback instead of a std::future.
+             * <p>
+             * The callback is invoked exactly once on the async worker thread,
+             * with false if the write failed or was dropped by a disconnect before being performed.
+             * If not connected, it is invoked on the calling thread with false.
+             * </p>
+             */
+            void writeValueAsync(const uint16_t handle, const TROOctets & value, const bool withResponse, WriteValueCallback cb);
+
+            /**
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.4 Write Long Characteristic Values
+             * <p>
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.5 Reliable Writes
+             * </p>
+             * <p>
+             * Writes the value via ATT_PREPARE_WRITE_REQ chunks of the used ATT_MTU - 5,
+             * keeping up to GATTEnv::GATT_PREPARE_WRITE_WINDOW requests outstanding,
+             * followed by one ATT_EXECUTE_WRITE_REQ.
+             * </p>
+             * <p>
+             * If reliable is true, each echoed prepared value is verified
+             * and all prepared values are cancelled on a mismatch.
+             * </p>
+             * @return true if the value has been written, otherwise false and all prepared values have been cancelled.
+             */
+            bool writeLongValue(const uint16_t handle, const TROOctets & value, const bool reliable);
+
             /**
              * BT Core Spec v5.2: Vol 3, Part G GATT: 4.12.3 Write Characteristic Descriptors
              * <p>
@@ -376,9 +1383,40 @@ namespace direct_bt {
 
             /**
              * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.1 Write Characteristic Value Without Response
+             * <p>
+             * If GATTEnv::GATT_WRITE_QUEUE_LATENCY is greater zero, the write is queued
+             * w/o acquiring the command lock and sent by the write queue worker.
+             * Queued writes are flushed before any request of the command path, preserving their order.
+             * </p>
              */
             bool writeCharacteristicValueNoResp(const GATTCharacteristic & c, const TROOctets & value);
 
+            /**
+             * Non-throwing writeCharacteristicValue() or writeCharacteristicValueNoResp(), depending on withResponse,
+             * returning the GATTStatus instead, see writeValueStatus().
+             */
+            GATTStatus writeCharacteristicValueStatus(const GATTCharacteristic & c, const TROOctets & value, const bool withResponse) noexcept;
+
+            /**
+             * Writes the characteristic value of given size with or w/o response,
+             * filled in place into the ATT_WRITE_REQ or ATT_WRITE_CMD PDU by the given GATTCharacteristic::ValueFill.
+             * <p>
+             * Hence a value provided by a foreign buffer, e.g. a Java array region, is copied only once.
+             * A long value exceeding the used ATT_MTU - 3 or a queued write command, see writeCharacteristicValueNoResp(),
+             * is filled into an intermediate buffer instead.
+             * </p>
+             * @return false if the write failed or the fill aborted it
+             */
+            bool writeCharacteristicValue(const GATTCharacteristic & c, const int valueSize,
+                                          const GATTCharacteristic::ValueFill & fill, const bool withResponse);
+
+            /**
+             * Non-throwing writeCharacteristicValue(const GATTCharacteristic &, const int, const GATTCharacteristic::ValueFill &, const bool),
+             * returning the GATTStatus instead, i.e. GATTStatus::ABORTED if the fill aborted the write.
+             */
+            GATTStatus writeCharacteristicValueStatus(const GATTCharacteristic & c, const int valueSize,
+                                                      const GATTCharacteristic::ValueFill & fill, const bool withResponse) noexcept;
+
             /**
              * BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3 Client Characteristic Configuration
              * <p>
@@ -394,6 +1432,36 @@ namespace direct_bt {
              */
             bool configNotificationIndication(GATTDescriptor & cd, const bool enableNotification, const bool enableIndication);
 
+            /**
+             * Returns the Client Characteristic Configuration descriptor of the given characteristic,
+             * locating it on demand if its descriptors have not been discovered.
+             * <p>
+             * The descriptor is located via ATT_FIND_INFORMATION_REQ over the characteristic's descriptor handle range,
+             * i.e. usually one request, w/o discovering the descriptors of all services or reading their values.
+             * A located descriptor is added to the characteristic and stored in the GATTCache, if enabled,
+             * hence subsequent connections w/ a valid cache entry need no request at all.
+             * </p>
+             * @return the Client Characteristic Configuration descriptor or nullptr if the characteristic has none.
+             */
+            GATTDescriptorRef findClientCharacteristicConfig(GATTCharacteristicRef c);
+
+            /**
+             * BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3 Client Characteristic Configuration
+             * <p>
+             * Bulk variant of GATTCharacteristic::configNotificationIndication(bool, bool, bool[]) for the given characteristics,
+             * masking the requests with each characteristic's PropertyBitVal::Notify and PropertyBitVal::Indicate
+             * and skipping unchanged characteristics.
+             * </p>
+             * <p>
+             * Client Characteristic Configuration descriptors are located via findClientCharacteristicConfig()
+             * and written keeping up to GATTEnv::GATT_CCCD_WRITE_WINDOW ATT_WRITE_REQ outstanding.
+             * </p>
+             * @return the number of characteristics in the requested state,
+             * i.e. characteristics.size() if all have been configured successfully.
+             */
+            int configNotificationIndication(const std::vector<GATTCharacteristicRef> & characteristics,
+                                             const bool enableNotification, const bool enableIndication);
+
             /**
              * Add the given listener to the list if not already present.
              * <p>
@@ -403,6 +1471,32 @@ namespace direct_bt {
              */
             bool addCharacteristicListener(std::shared_ptr<GATTCharacteristicListener> l);
 
+            /**
+             * Add the given listener bound to the given characteristic value handles.
+             * <p>
+             * Notifications and indications of a bound value handle are delivered via a handle lookup
+             * to its bound listener only, without calling GATTCharacteristicListener::match(..).
+             * A listener may be bound to multiple handles as well as being added unbound,
+             * see addCharacteristicListener(std::shared_ptr<GATTCharacteristicListener>).
+             * </p>
+             * <p>
+             * Returns true if the given listener has been newly bound to at least one of the given handles,
+             * otherwise false.
+             * </p>
+             */
+            bool addCharacteristicListener(std::shared_ptr<GATTCharacteristicListener> l, const std::vector<uint16_t> & valueHandles);
+
+            /** Returns a copy of all listener added via addCharacteristicListener(std::shared_ptr<GATTCharacteristicListener>). */
+            std::vector<std::shared_ptr<GATTCharacteristicListener>> getCharacteristicListeners() const {
+                return *characteristicListenerList.get_snapshot();
+            }
+
+            /** Returns a copy of all listener bound to value handles via addCharacteristicListener(l, valueHandles), by value handle. */
+            std::map<uint16_t, std::vector<std::shared_ptr<GATTCharacteristicListener>>> getBoundCharacteristicListeners() const {
+                std::shared_ptr<const BoundListenerIndex> index = std::atomic_load(&boundListenerIndex);
+                return nullptr != index ? *index : BoundListenerIndex();
+            }
+
             /**
              * Remove the given listener from the list.
              * <p>
@@ -413,7 +1507,7 @@ namespace direct_bt {
             bool removeCharacteristicListener(std::shared_ptr<GATTCharacteristicListener> l);
 
             /**
-             * Remove the given listener from the list.
+             * Remove the given listener from the list, including all its value handle bindings.
              * <p>
              * Returns true if the given listener is an element of the list and has been removed,
              * otherwise false.
@@ -427,6 +1521,7 @@ namespace direct_bt {
              * <p>
              * Implementation tests all listener's GATTCharacteristicListener::match(const GATTCharacteristic & characteristic)
              * to match with the given associated characteristic.
+             * Listener bound to the characteristic's value handle are unbound from it.
              * </p>
              * @param associatedCharacteristic the match criteria to remove any GATTCharacteristicListener from the list
              * @return number of removed listener.
@@ -465,6 +1560,76 @@ namespace direct_bt {
              */
             bool getSendIndicationConfirmation();
 
+            /**
+             * Returns the GATTNotificationExecutor in use as configured by GATTEnv::GATT_NOTIFY_DISPATCH,
+             * or nullptr if GATTCharacteristicListener are invoked on the L2CAP reader thread.
+             */
+            std::shared_ptr<GATTNotificationExecutor> getNotificationExecutor();
+
+            /**
+             * Returns the number of this GATTHandler's notification and indication values
+             * dropped due to a GATTNotificationExecutor queue overflow.
+             */
+            uint64_t getNotificationDropCount() const { return notificationDropCount; }
+
+            /** Returns the number of extended reply timeouts, see GATTEnv::GATT_COMMAND_RETRIES. */
+            uint64_t getReplyRetryCount() const { return replyRetryCount; }
+
+            /** Returns the number of requests failed w/ a reply timeout after all retries. */
+            uint64_t getReplyTimeoutCount() const { return replyTimeoutCount; }
+
+            /** Returns the duration of the last connect()'s L2CAP open including its reader start in microseconds. */
+            uint64_t getConnectL2CAPTime() const { return connectL2CAPUS; }
+
+            /** Returns the duration of the last connect()'s MTU exchange in microseconds. */
+            uint64_t getConnectMTUTime() const { return connectMTUUS; }
+
+            /**
+             * Returns the shared L2CAPReactor w/o worker threads if GATTEnv::GATT_READER_EXTERNAL is enabled, otherwise nullptr.
+             * <p>
+             * The application's event loop polls L2CAPReactor::getFD() for readability
+             * and calls L2CAPReactor::process() to receive the ATT PDUs of all connected GATTHandler on its own thread.
+             * </p>
+             */
+            static std::shared_ptr<L2CAPReactor> getExternalReactor();
+
+            /** Returns the round-trip time estimation of this device's requests. */
+            const RTTEstimator & getRTTEstimator() const { return rttEstimator; }
+
+            /**
+             * Returns this connection's traffic accounting, i.e. ATT PDUs and bytes in and out per opcode,
+             * notifications, retries, timeouts and round-trip times.
+             * <p>
+             * Use TrafficStats::getSnapshot() to read the counters from any thread.
+             * </p>
+             */
+            TrafficStats & getTrafficStats() { return traffic; }
+
+            /**
+             * Returns the reply timeout in use for a request of the given configured timeout,
+             * i.e. the adaptive timeout if GATTEnv::GATT_ADAPTIVE_TIMEOUT is enabled, otherwise the given one.
+             */
+            int32_t getReplyTimeout(const int32_t configuredTimeout) const {
+                return env.GATT_ADAPTIVE_TIMEOUT ?
+                       rttEstimator.getTimeout(configuredTimeout, env.GATT_ADAPTIVE_TIMEOUT_MIN, env.GATT_ADAPTIVE_TIMEOUT_MAX) :
+                       configuredTimeout;
+            }
+
+            /** Returns the DBTProfile in use, resolved at construction via DBTDevice::getEffectiveProfile(), may be nullptr. */
+            std::shared_ptr<const DBTProfile> getProfile() const { return profile; }
+
+            /** Returns DBTProfile::readTimeout if set, otherwise GATTEnv::GATT_READ_COMMAND_REPLY_TIMEOUT. */
+            int32_t getReadCommandReplyTimeout() const;
+
+            /** Returns DBTProfile::writeTimeout if set, otherwise GATTEnv::GATT_WRITE_COMMAND_REPLY_TIMEOUT. */
+            int32_t getWriteCommandReplyTimeout() const;
+
+            /** Returns DBTProfile::initialTimeout if set, otherwise GATTEnv::GATT_INITIAL_COMMAND_REPLY_TIMEOUT. */
+            int32_t getInitialCommandReplyTimeout() const;
+
+            /** Returns DBTProfile::notifyDispatch if set, otherwise GATTEnv::GATT_NOTIFY_DISPATCH. */
+            GATTEnv::NotifyDispatch getNotifyDispatch() const;
+
             /*****************************************************/
             /** Higher level semantic functionality **/
             /*****************************************************/
@@ -489,6 +1654,76 @@ namespace direct_bt {
             bool ping();
     };
 
+    /**
+     * Streaming write without response of a large value to one characteristic value handle,
+     * chunked into ATT_WRITE_CMD PDUs of the used ATT_MTU.
+     * <p>
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.1 Write Characteristic Value without Response
+     * </p>
+     * <p>
+     * PDUs are written non-blocking, keeping the L2CAP socket's send queue full
+     * and only polling for writable state once it is exhausted.
+     * Such backpressure events and their waiting time are counted,
+     * allowing to monitor the achieved throughput, e.g. for firmware uploads.
+     * </p>
+     * <p>
+     * Since write without response has no ATT transaction, other GATT commands
+     * may be interleaved by other threads while streaming.
+     * </p>
+     */
+    class GATTWriteStream {
+        private:
+            std::shared_ptr<GATTHandler> gatt;
+            const uint16_t handle;
+            const int32_t stallTimeoutMS;
+            POctets pdu;
+
+            uint64_t bytesWritten;
+            uint64_t pduCount;
+            uint64_t backpressureCount;
+            uint64_t backpressureMS;
+            uint64_t elapsedMS;
+
+        public:
+            /**
+             * @param gatt the connected GATTHandler
+             * @param handle the characteristic value handle to write to
+             * @param stallTimeoutMS maximum time to wait for a full send queue to become writable again
+             */
+            GATTWriteStream(std::shared_ptr<GATTHandler> gatt, const uint16_t handle, const int32_t stallTimeoutMS);
+
+            /**
+             * Writes the complete given value, blocking until all PDUs have been queued.
+             * <p>
+             * On an I/O error the GATTHandler disconnects, as with {@link GATTHandler#writeValue()}.
+             * </p>
+             * @return true if all octets have been written, otherwise false due to an I/O error or stalled send queue.
+             */
+            bool write(const TROOctets & value);
+
+            uint16_t getHandle() const { return handle; }
+
+            /** Returns the total number of written value octets. */
+            uint64_t getBytesWritten() const { return bytesWritten; }
+
+            /** Returns the total number of written ATT_WRITE_CMD PDUs. */
+            uint64_t getPDUCount() const { return pduCount; }
+
+            /** Returns the number of times the send queue was full. */
+            uint64_t getBackpressureCount() const { return backpressureCount; }
+
+            /** Returns the total time in milliseconds spent waiting for a full send queue. */
+            uint64_t getBackpressureMS() const { return backpressureMS; }
+
+            /** Returns the total time in milliseconds spent within write(). */
+            uint64_t getElapsedMS() const { return elapsedMS; }
+
+            /** Returns the achieved throughput in octets per second over getElapsedMS(). */
+            uint64_t getThroughput() const { return 0 < elapsedMS ? ( bytesWritten * 1000 ) / elapsedMS : 0; }
+
+            std::string toString() const;
+    };
+
 } // namespace direct_bt
 
 #endif /* GATT_HANDLER_HPP_ */
@@ -48,12 +48,20 @@ namespace direct_bt {
 enum GattServiceType : uint16_t {
     /** The generic_access service contains generic information about the device. All available Characteristics are readonly. */
     GENERIC_ACCESS                              = 0x1800,
+    /** The generic_attribute service exposes the Service Changed and Database Hash Characteristics. */
+    GENERIC_ATTRIBUTE                           = 0x1801,
     /** The Health Thermometer service exposes temperature and other data from a thermometer intended for healthcare and fitness applications. */
     HEALTH_THERMOMETER                          = 0x1809,
 	/** The Device Information Service exposes manufacturer and/or vendor information about a device. */
 	DEVICE_INFORMATION                          = 0x180A,
     /** The Battery Service exposes the state of a battery within a device. */
     BATTERY_SERVICE                             = 0x180F,
+    /** The Heart Rate service exposes heart rate and other data from a Heart Rate Sensor intended for fitness applications. */
+    HEART_RATE                                  = 0x180D,
+    /** The Blood Pressure service exposes blood pressure and other data from a blood pressure monitor. */
+    BLOOD_PRESSURE                              = 0x1810,
+    /** The Cycling Power service exposes power- and force-related data and optionally speed- and cadence-related data from a Cycling Power sensor. */
+    CYCLING_POWER                               = 0x1818,
 };
 std::string GattServiceTypeToString(const GattServiceType v);
 
@@ -73,6 +81,14 @@ enum GattCharacteristicType : uint16_t {
     RECONNECTION_ADDRESS                        = 0x2A03,
     PERIPHERAL_PREFERRED_CONNECTION_PARAMETERS  = 0x2A04,
 
+    //
+    // GENERIC_ATTRIBUTE
+    //
+    /** Indicated by the server on any change of its attribute database */
+    SERVICE_CHANGED                             = 0x2A05,
+    /** 128-bit hash of the server's attribute database, BT Core Spec v5.2: Vol 3, Part G GATT: 7.3 */
+    DATABASE_HASH                               = 0x2B2A,
+
     /** Mandatory: sint16 10^-2: Celsius */
     TEMPERATURE                                 = 0x2A6E,
 
@@ -102,6 +118,24 @@ enum GattCharacteristicType : uint16_t {
 	MANUFACTURER_NAME_STRING 					= 0x2A29,
 	REGULATORY_CERT_DATA_LIST 					= 0x2A2A,
 	PNP_ID 										= 0x2A50,
+
+    //
+    // HEART_RATE
+    //
+    HEART_RATE_MEASUREMENT                      = 0x2A37,
+    /** Mandatory: 8bit: 0 other, 1 chest, 2 wrist, 3 finger, 4 hand, 5 ear lobe, 6 foot */
+    BODY_SENSOR_LOCATION                        = 0x2A38,
+
+    //
+    // BLOOD_PRESSURE
+    //
+    BLOOD_PRESSURE_MEASUREMENT                  = 0x2A35,
+    INTERMEDIATE_CUFF_PRESSURE                  = 0x2A36,
+
+    //
+    // CYCLING_POWER
+    //
+    CYCLING_POWER_MEASUREMENT                   = 0x2A63,
 };
 std::string GattCharacteristicTypeToString(const GattCharacteristicType v);
 
@@ -190,12 +224,18 @@ extern const std::vector<const GattServiceCharacteristic*> GATT_SERVICES;
 /**
  * Find the GattServiceCharacteristic entry by given uuid16,
  * denominating either a GattServiceType or GattCharacteristicType.
+ * <p>
+ * O(log n) lookup via a uuid16 sorted index of GATT_SERVICES.
+ * </p>
  */
 const GattServiceCharacteristic * findGattServiceChar(const uint16_t uuid16);
 
 /**
  * Find the GattCharacteristicSpec entry by given uuid16,
  * denominating either a GattCharacteristicType.
+ * <p>
+ * O(log n) lookup via a uuid16 sorted index of GATT_SERVICES.
+ * </p>
  */
 const GattCharacteristicSpec * findGattCharSpec(const uint16_t uuid16);
 
@@ -317,6 +357,228 @@ class TemperatureMeasurementCharateristic {
         std::string toString() const;
 };
 
+/**
+ * Zero allocation view of a Heart Rate Measurement value, parsed in place from the given notification buffer.
+ * <p>
+ * The referenced buffer must outlive this instance and the field accessors are only valid if isValid().
+ * </p>
+ * <p>
+ * https://www.bluetooth.com/wp-content/uploads/Sitecore-Media-Library/Gatt/Xml/Characteristics/org.bluetooth.characteristic.heart_rate_measurement.xml
+ * </p>
+ */
+class HeartRateMeasurement {
+    public:
+        enum Bits : uint8_t {
+            /** bit 0: If set, heart rate value is uint16, otherwise uint8. */
+            VALUE_FORMAT_UINT16         = 1,
+            /** bit 1: If set, skin contact is detected. Only meaningful if SENSOR_CONTACT_SUPPORTED is set. */
+            SENSOR_CONTACT_DETECTED     = 2,
+            /** bit 2: If set, sensor contact feature is supported. */
+            SENSOR_CONTACT_SUPPORTED    = 4,
+            /** bit 3: If set, energy expended field present, otherwise not. */
+            HAS_ENERGY_EXPENDED         = 8,
+            /** bit 4: If set, one or more RR-interval values are present, otherwise not. */
+            HAS_RR_INTERVALS            = 16
+        };
+
+    private:
+        const uint8_t * data;
+        int size;
+        int rrOffset;
+        bool valid;
+
+    public:
+        HeartRateMeasurement(const uint8_t * source, const int size) noexcept;
+        HeartRateMeasurement(const TROOctets &source) noexcept
+        : HeartRateMeasurement(source.get_ptr(), source.getSize()) {}
+
+        /** Returns true if the referenced buffer holds all fields indicated by its flags. */
+        bool isValid() const noexcept { return valid; }
+
+        uint8_t getFlags() const noexcept { return data[0]; }
+        bool isSensorContactSupported() const noexcept { return 0 != ( getFlags() & Bits::SENSOR_CONTACT_SUPPORTED ); }
+        bool isSensorContactDetected() const noexcept { return 0 != ( getFlags() & Bits::SENSOR_CONTACT_DETECTED ); }
+        bool hasEnergyExpended() const noexcept { return 0 != ( getFlags() & Bits::HAS_ENERGY_EXPENDED ); }
+        bool hasRRIntervals() const noexcept { return 0 != ( getFlags() & Bits::HAS_RR_INTERVALS ); }
+
+        /** Heart rate in beats per minute. */
+        uint16_t getHeartRate() const noexcept {
+            return 0 != ( getFlags() & Bits::VALUE_FORMAT_UINT16 ) ? get_uint16(data, 1, true /* littleEndian */) : data[1];
+        }
+
+        /** Accumulated energy expended in kilo Joules, if hasEnergyExpended(). */
+        uint16_t getEnergyExpended() const noexcept {
+            return get_uint16(data, 0 != ( getFlags() & Bits::VALUE_FORMAT_UINT16 ) ? 3 : 2, true /* littleEndian */);
+        }
+
+        /** Number of RR-interval values, zero if !hasRRIntervals(). */
+        int getRRIntervalCount() const noexcept { return hasRRIntervals() ? ( size - rrOffset ) / 2 : 0; }
+
+        /** Raw RR-interval value at given index [0..getRRIntervalCount()-1] in units of 1/1024 seconds. */
+        uint16_t getRRInterval(const int i) const noexcept { return get_uint16(data, rrOffset + 2*i, true /* littleEndian */); }
+
+        /**
+         * Copies up to maxCount raw RR-interval values in units of 1/1024 seconds into dest.
+         * @return number of copied values
+         */
+        int getRRIntervals(uint16_t * dest, const int maxCount) const noexcept;
+
+        /**
+         * Decodes up to maxCount RR-interval values in seconds into dest.
+         * @return number of decoded values
+         */
+        int getRRIntervalsSeconds(float * dest, const int maxCount) const noexcept;
+
+        std::string toString() const;
+};
+
+/**
+ * Zero allocation view of a Blood Pressure Measurement value, parsed in place from the given notification buffer.
+ * <p>
+ * Also used for the Intermediate Cuff Pressure, which has the same format.
+ * The referenced buffer must outlive this instance and the field accessors are only valid if isValid().
+ * </p>
+ * <p>
+ * https://www.bluetooth.com/wp-content/uploads/Sitecore-Media-Library/Gatt/Xml/Characteristics/org.bluetooth.characteristic.blood_pressure_measurement.xml
+ * </p>
+ */
+class BloodPressureMeasurement {
+    public:
+        enum Bits : uint8_t {
+            /** bit 0: If set, pressure values are in kPa, otherwise mmHg. */
+            IS_UNIT_KPA                 = 1,
+            /** bit 1: If set, timestamp field present, otherwise not. */
+            HAS_TIMESTAMP               = 2,
+            /** bit 2: If set, pulse rate field present, otherwise not. */
+            HAS_PULSE_RATE              = 4,
+            /** bit 3: If set, user ID field present, otherwise not. */
+            HAS_USER_ID                 = 8,
+            /** bit 4: If set, measurement status field present, otherwise not. */
+            HAS_MEASUREMENT_STATUS      = 16
+        };
+
+    private:
+        const uint8_t * data;
+        int8_t pulseRateOffset;
+        int8_t userIDOffset;
+        int8_t statusOffset;
+        bool valid;
+
+    public:
+        BloodPressureMeasurement(const uint8_t * source, const int size) noexcept;
+        BloodPressureMeasurement(const TROOctets &source) noexcept
+        : BloodPressureMeasurement(source.get_ptr(), source.getSize()) {}
+
+        /** Returns true if the referenced buffer holds all fields indicated by its flags. */
+        bool isValid() const noexcept { return valid; }
+
+        uint8_t getFlags() const noexcept { return data[0]; }
+        bool isKPa() const noexcept { return 0 != ( getFlags() & Bits::IS_UNIT_KPA ); }
+        bool hasTimestamp() const noexcept { return 0 != ( getFlags() & Bits::HAS_TIMESTAMP ); }
+        bool hasPulseRate() const noexcept { return 0 != ( getFlags() & Bits::HAS_PULSE_RATE ); }
+        bool hasUserID() const noexcept { return 0 != ( getFlags() & Bits::HAS_USER_ID ); }
+        bool hasMeasurementStatus() const noexcept { return 0 != ( getFlags() & Bits::HAS_MEASUREMENT_STATUS ); }
+
+        /** Systolic pressure in kPa if isKPa(), otherwise mmHg. */
+        float getSystolic() const noexcept { return ieee11073::FloatTypes::float16_IEEE11073_to_IEEE754(get_uint16(data, 1, true /* littleEndian */)); }
+        /** Diastolic pressure in kPa if isKPa(), otherwise mmHg. */
+        float getDiastolic() const noexcept { return ieee11073::FloatTypes::float16_IEEE11073_to_IEEE754(get_uint16(data, 3, true /* littleEndian */)); }
+        /** Mean arterial pressure in kPa if isKPa(), otherwise mmHg. */
+        float getMeanArterialPressure() const noexcept { return ieee11073::FloatTypes::float16_IEEE11073_to_IEEE754(get_uint16(data, 5, true /* littleEndian */)); }
+
+        /** Decodes systolic, diastolic and mean arterial pressure into dest in one batch. */
+        void getCompoundValue(float dest[3]) const noexcept {
+            ieee11073::FloatTypes::float16_IEEE11073_to_IEEE754(data+1, dest, 3);
+        }
+
+        /** Timestamp, if hasTimestamp(). */
+        ieee11073::AbsoluteTime getTimestamp() const { return ieee11073::AbsoluteTime(data+7, 7); }
+
+        /** Pulse rate in beats per minute, if hasPulseRate(). */
+        float getPulseRate() const noexcept { return ieee11073::FloatTypes::float16_IEEE11073_to_IEEE754(get_uint16(data, pulseRateOffset, true /* littleEndian */)); }
+
+        /** User ID, if hasUserID(). 0xFF denotes an unknown user. */
+        uint8_t getUserID() const noexcept { return data[userIDOffset]; }
+
+        /** Measurement status bitfield, if hasMeasurementStatus(). */
+        uint16_t getMeasurementStatus() const noexcept { return get_uint16(data, statusOffset, true /* littleEndian */); }
+
+        std::string toString() const;
+};
+
+/**
+ * Zero allocation view of a Cycling Power Measurement value, parsed in place from the given notification buffer.
+ * <p>
+ * The referenced buffer must outlive this instance and the field accessors are only valid if isValid().
+ * </p>
+ * <p>
+ * https://www.bluetooth.com/wp-content/uploads/Sitecore-Media-Library/Gatt/Xml/Characteristics/org.bluetooth.characteristic.cycling_power_measurement.xml
+ * </p>
+ */
+class CyclingPowerMeasurement {
+    public:
+        enum Bits : uint16_t {
+            HAS_PEDAL_POWER_BALANCE         = 1 << 0,
+            /** If set, pedal power balance refers to the left pedal, otherwise unknown. */
+            PEDAL_POWER_BALANCE_LEFT        = 1 << 1,
+            HAS_ACCUMULATED_TORQUE          = 1 << 2,
+            /** If set, accumulated torque is crank based, otherwise wheel based. */
+            ACCUMULATED_TORQUE_CRANK        = 1 << 3,
+            HAS_WHEEL_REVOLUTION_DATA       = 1 << 4,
+            HAS_CRANK_REVOLUTION_DATA       = 1 << 5,
+            HAS_EXTREME_FORCE_MAGNITUDES    = 1 << 6,
+            HAS_EXTREME_TORQUE_MAGNITUDES   = 1 << 7,
+            HAS_EXTREME_ANGLES              = 1 << 8,
+            HAS_TOP_DEAD_SPOT_ANGLE         = 1 << 9,
+            HAS_BOTTOM_DEAD_SPOT_ANGLE      = 1 << 10,
+            HAS_ACCUMULATED_ENERGY          = 1 << 11,
+            OFFSET_COMPENSATION_INDICATOR   = 1 << 12
+        };
+
+    private:
+        const uint8_t * data;
+        int8_t pedalPowerBalanceOffset;
+        int8_t accumulatedTorqueOffset;
+        int8_t wheelRevolutionOffset;
+        int8_t crankRevolutionOffset;
+        int8_t accumulatedEnergyOffset;
+        bool valid;
+
+    public:
+        CyclingPowerMeasurement(const uint8_t * source, const int size) noexcept;
+        CyclingPowerMeasurement(const TROOctets &source) noexcept
+        : CyclingPowerMeasurement(source.get_ptr(), source.getSize()) {}
+
+        /** Returns true if the referenced buffer holds all fields indicated by its flags. */
+        bool isValid() const noexcept { return valid; }
+
+        uint16_t getFlags() const noexcept { return get_uint16(data, 0, true /* littleEndian */); }
+        bool isSet(const Bits bit) const noexcept { return 0 != ( getFlags() & bit ); }
+
+        /** Instantaneous power in Watts. */
+        int16_t getInstantaneousPower() const noexcept { return static_cast<int16_t>(get_uint16(data, 2, true /* littleEndian */)); }
+
+        /** Pedal power balance in percent, if HAS_PEDAL_POWER_BALANCE. */
+        float getPedalPowerBalance() const noexcept { return data[pedalPowerBalanceOffset] / 2.0f; }
+
+        /** Accumulated torque in Newton meters, if HAS_ACCUMULATED_TORQUE. */
+        float getAccumulatedTorque() const noexcept { return get_uint16(data, accumulatedTorqueOffset, true /* littleEndian */) / 32.0f; }
+
+        /** Cumulative wheel revolutions, if HAS_WHEEL_REVOLUTION_DATA. */
+        uint32_t getCumulativeWheelRevolutions() const noexcept { return get_uint32(data, wheelRevolutionOffset, true /* littleEndian */); }
+        /** Last wheel event time in units of 1/2048 seconds, if HAS_WHEEL_REVOLUTION_DATA. */
+        uint16_t getLastWheelEventTime() const noexcept { return get_uint16(data, wheelRevolutionOffset+4, true /* littleEndian */); }
+
+        /** Cumulative crank revolutions, if HAS_CRANK_REVOLUTION_DATA. */
+        uint16_t getCumulativeCrankRevolutions() const noexcept { return get_uint16(data, crankRevolutionOffset, true /* littleEndian */); }
+        /** Last crank event time in units of 1/1024 seconds, if HAS_CRANK_REVOLUTION_DATA. */
+        uint16_t getLastCrankEventTime() const noexcept { return get_uint16(data, crankRevolutionOffset+2, true /* littleEndian */); }
+
+        /** Accumulated energy in kilo Joules, if HAS_ACCUMULATED_ENERGY. */
+        uint16_t getAccumulatedEnergy() const noexcept { return get_uint16(data, accumulatedEnergyOffset, true /* littleEndian */); }
+
+        std::string toString() const;
+};
 
 /* Application error */
 
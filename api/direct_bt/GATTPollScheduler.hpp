@@ -0,0 +1,199 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GATT_POLL_SCHEDULER_HPP_
+#define GATT_POLL_SCHEDULER_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <set>
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+#include "OctetTypes.hpp"
+
+#include "GATTCharacteristic.hpp"
+
+/**
+ * - - - - - - - - - - - - - - -
+ *
+ * Module GATTPollScheduler:
+ *
+ * - Periodic GATT characteristic value reads across many connected devices
+ */
+namespace direct_bt {
+
+    class DBTDevice; // forward
+
+    /**
+     * Periodically reads registered characteristic values of many connected devices on a small fixed thread pool.
+     * <p>
+     * Each entry is a characteristic polled at its own period, delivering the read value to its callback.
+     * All entries of one device due within the coalescing window are read together
+     * via GATTHandler::readValues(), i.e. ATT_READ_MULTIPLE_VARIABLE_REQ if supported.
+     * Only one read per device is performed at a time, as a GATTHandler serializes its ATT requests anyway.
+     * </p>
+     * <p>
+     * Initial deadlines of new entries are staggered by Defaults::STAGGER_MS
+     * to spread the reads of equal periods across connection events.
+     * </p>
+     * <p>
+     * Each entry tracks its deadlines, i.e. the start jitter of its reads, their latency and missed periods,
+     * see Statistics.
+     * </p>
+     */
+    class GATTPollScheduler {
+        public:
+            enum Defaults : int32_t {
+                /** Default number of worker threads */
+                THREAD_COUNT = 2,
+                /** Default coalescing window in milliseconds */
+                COALESCE_MS = 20,
+                /** Initial deadline stagger of consecutive entries in milliseconds, about one 7.5ms connection event */
+                STAGGER_MS = 8
+            };
+
+            /**
+             * Poll callback receiving the read value or nullptr if the read failed,
+             * invoked on a worker thread of the scheduler.
+             */
+            typedef std::function<void(GATTCharacteristicRef characteristic, std::shared_ptr<const POctets> value, const uint64_t timestamp)> PollCallback;
+
+            /** Deadline statistics of one entry or all entries. */
+            class Statistics {
+                public:
+                    /** Number of completed reads, including failed reads */
+                    uint64_t count;
+                    /** Number of failed reads */
+                    uint64_t failedCount;
+                    /** Number of periods missed, i.e. reads completed after their next deadline */
+                    uint64_t missedCount;
+                    /** Sum and maximum of read start delays after their deadlines in milliseconds */
+                    uint64_t jitterSumMS;
+                    uint64_t jitterMaxMS;
+                    /** Sum and maximum of read durations in milliseconds */
+                    uint64_t latencySumMS;
+                    uint64_t latencyMaxMS;
+
+                    Statistics()
+                    : count(0), failedCount(0), missedCount(0), jitterSumMS(0), jitterMaxMS(0), latencySumMS(0), latencyMaxMS(0) {}
+
+                    void add(const Statistics & o);
+
+                    std::string toString() const;
+            };
+
+        private:
+            struct Entry {
+                GATTCharacteristicRef characteristic;
+                std::weak_ptr<DBTDevice> device;
+                const DBTDevice * deviceKey;
+                uint32_t periodMS;
+                PollCallback callback;
+                uint64_t deadline;
+                Statistics stats;
+            };
+            struct Job {
+                int id;
+                GATTCharacteristicRef characteristic;
+                PollCallback callback;
+                uint64_t deadline;
+                uint32_t periodMS;
+            };
+
+            const int coalesceMS;
+            std::mutex mtx_entries;
+            std::condition_variable cv_entries;
+            std::map<int, Entry> entries;
+            /** Devices currently read by a worker */
+            std::set<const DBTDevice *> busyDevices;
+            int nextId;
+            bool running;
+            std::vector<std::thread> workers;
+
+            void workerImpl();
+            void poll(std::vector<Job> & jobs, const std::shared_ptr<DBTDevice> & device, const uint64_t t0);
+
+            GATTPollScheduler(const GATTPollScheduler&) = delete;
+            void operator=(const GATTPollScheduler&) = delete;
+
+        public:
+            /**
+             * Starts the scheduler's worker threads.
+             * @param threadCount number of worker threads, at least one
+             * @param coalesceMS entries of one device due within this window are read together
+             */
+            GATTPollScheduler(const int threadCount=THREAD_COUNT, const int coalesceMS=COALESCE_MS);
+
+            /** Stops the scheduler, see stop(). */
+            ~GATTPollScheduler();
+
+            /**
+             * Stops all worker threads, waiting for their current reads to complete.
+             * Registered entries are retained but no more polled.
+             */
+            void stop();
+
+            /**
+             * Registers the given characteristic to be read periodically.
+             * <p>
+             * The characteristic's device shall be connected via DBTDevice::connectGATT(),
+             * reads of a disconnected device fail.
+             * </p>
+             * @param characteristic the characteristic to read, shall be readable
+             * @param periodMS the period in milliseconds, greater than zero
+             * @param callback the callback receiving each read value
+             * @return the entry id, greater than zero
+             * @throws IllegalArgumentException if characteristic is null, its device is gone or periodMS is zero
+             */
+            int add(GATTCharacteristicRef characteristic, const uint32_t periodMS, PollCallback callback);
+
+            /** Removes the given entry, returns true if it existed. */
+            bool remove(const int id);
+
+            /** Removes all entries of the given device, returns the number of removed entries. */
+            int removeAll(const DBTDevice & device);
+
+            /** Returns the number of registered entries. */
+            int size();
+
+            /** Returns the statistics of the given entry, all zero if it doesn't exist. */
+            Statistics getStatistics(const int id);
+
+            /** Returns the accumulated statistics of all registered entries. */
+            Statistics getStatistics();
+    };
+
+} // namespace direct_bt
+
+#endif /* GATT_POLL_SCHEDULER_HPP_ */
@@ -0,0 +1,354 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GATT_SERVER_HPP_
+#define GATT_SERVER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+#include "UUID.hpp"
+#include "OctetTypes.hpp"
+#include "BTAddress.hpp"
+#include "COWVector.hpp"
+
+#include "GATTService.hpp"
+#include "GATTCharacteristic.hpp"
+#include "GATTDescriptor.hpp"
+#include "GATTAttributeTable.hpp"
+#include "L2CAPComm.hpp"
+
+/**
+ * - - - - - - - - - - - - - - -
+ *
+ * Module GATTServer:
+ *
+ * - BT Core Spec v5.2: Vol 3, Part F Attribute Protocol (ATT), server role
+ * - BT Core Spec v5.2: Vol 3, Part G GATT: 3 Service Interoperability Requirements
+ */
+namespace direct_bt {
+
+    class GATTServer; // forward
+
+    /**
+     * Receives client initiated changes of a GATTServer.
+     * <p>
+     * All methods are called on the serving reactor thread of the client's connection
+     * and shall return promptly. They shall not call GATTServer::stop().
+     * </p>
+     */
+    class GATTServerListener {
+        public:
+            virtual ~GATTServerListener() {}
+
+            /**
+             * A client has written the value of the given characteristic via ATT_WRITE_REQ or ATT_WRITE_CMD.
+             * @return true to accept and store the value, false to reject it with ATT error NO_WRITE_PERM.
+             */
+            virtual bool writeRequest(GATTServer & server, const uint64_t connectionId,
+                                      GATTCharacteristicRef characteristic, const TROOctets & value) {
+                (void)server; (void)connectionId; (void)characteristic; (void)value;
+                return true;
+            }
+
+            /**
+             * A client has written the Client Characteristic Configuration of the given characteristic.
+             */
+            virtual void subscriptionChanged(GATTServer & server, const uint64_t connectionId,
+                                             GATTCharacteristicRef characteristic, const bool notify, const bool indicate) {
+                (void)server; (void)connectionId; (void)characteristic; (void)notify; (void)indicate;
+            }
+
+            /**
+             * The given connection has been closed by the client or due to an I/O error.
+             */
+            virtual void connectionClosed(GATTServer & server, const uint64_t connectionId) {
+                (void)server; (void)connectionId;
+            }
+    };
+
+    /**
+     * GATT server of the peripheral role, exposing a local attribute database to connected clients.
+     * <p>
+     * The database is built via addService() before start(), assigning all handles in ascending order,
+     * and represented by the same GATTService, GATTCharacteristic and GATTDescriptor types as discovered remote databases.
+     * A Client Characteristic Configuration descriptor is added to each characteristic with the Notify or Indicate property.
+     * Characteristic values are replaced lock-free via setValue(); declarations are immutable once started.
+     * </p>
+     * <p>
+     * Client connections are ATT L2CAP channels, either accepted after listen() or handed over via addConnection().
+     * Their requests are served by an own L2CAPReactor, see property 'direct_bt.gatt.server.reactor'.
+     * </p>
+     * <p>
+     * Notification fan-out: notify() and indicate() encode the ATT_HANDLE_VALUE_NTF or ATT_HANDLE_VALUE_IND PDU once
+     * and enqueue the same immutable instance to all subscribed connections.
+     * Each connection sends it non-blocking, limited to its negotiated ATT_MTU w/o copying.
+     * A connection's notification queue is bounded by property 'direct_bt.gatt.server.queue',
+     * dropping its oldest notification if full, so a slow client does not stall the others.
+     * Indications are queued separately, with at most one outstanding per connection until its ATT_HANDLE_VALUE_CFM.
+     * Backlogged connections are flushed by the server's sender thread once writable.
+     * </p>
+     * <p>
+     * Not supported are prepared and signed writes, ATT_READ_MULTIPLE_REQ and security requirements,
+     * i.e. all attributes are readable and writable w/o authentication as permitted by their characteristic properties.
+     * Advertising is not part of this module, see DBTAdapter.
+     * </p>
+     */
+    class GATTServer {
+        public:
+            enum Defaults : int32_t {
+                /** Server ATT_MTU offered in the MTU exchange, BT Core Spec v5.2: Vol 3, Part F ATT: 3.2.9 Long attribute values */
+                SERVER_ATT_MTU = 512,
+                /** Default ATT_MTU, BT Core Spec v5.2: Vol 3, Part G GATT: 5.2.1 ATT_MTU */
+                DEFAULT_ATT_MTU = 23,
+                /** Default notification queue capacity per connection */
+                QUEUE_CAPACITY = 64
+            };
+            static inline int number(const Defaults d) { return static_cast<int>(d); }
+
+            /** Declaration of one characteristic to be added via addService() */
+            struct CharacteristicSpec {
+                std::shared_ptr<const uuid_t> type;
+                GATTCharacteristic::PropertyBitVal properties;
+                /** Initial value */
+                POctets value;
+
+                CharacteristicSpec(std::shared_ptr<const uuid_t> type, const GATTCharacteristic::PropertyBitVal properties,
+                                   const TROOctets & value)
+                : type(type), properties(properties), value(value) {}
+            };
+
+            /** Counters of one connection, see getConnectionStats() */
+            struct ConnectionStats {
+                uint64_t id;
+                uint16_t mtu;
+                int queued;
+                uint64_t sent;
+                uint64_t dropped;
+            };
+
+        private:
+            enum class AttrKind : uint8_t {
+                SERVICE     = 0,
+                CHAR_DECL   = 1,
+                CHAR_VALUE  = 2,
+                DESCRIPTOR  = 3
+            };
+
+            /** One attribute of the database, indexed by its handle */
+            struct Attr {
+                /** Attribute type, i.e. the declaration type, the characteristic value type or the descriptor type */
+                uuid_value_t type;
+                AttrKind kind;
+                /** Characteristic properties of CHAR_VALUE and DESCRIPTOR, otherwise zero */
+                uint8_t properties;
+                /** Service end handle of SERVICE, value handle of a Client Characteristic Configuration DESCRIPTOR */
+                uint16_t aux_handle;
+            };
+
+            class Connection {
+                public:
+                    const uint64_t id;
+                    /** the client's socket, owned and closed by this instance */
+                    const int fd;
+                    std::atomic<uint16_t> mtu;
+                    /** Client Characteristic Configuration value per attribute handle */
+                    std::unique_ptr<std::atomic<uint8_t>[]> ccc;
+                    std::atomic<bool> open;
+                    std::atomic<uint64_t> reactorId;
+                    /** true if queued PDUs wait for the socket to become writable, served by the sender thread */
+                    std::atomic<bool> backlogged;
+
+                    std::mutex mtx_queue;
+                    /** pending notifications and responses, the latter are never dropped */
+                    std::deque<std::pair<std::shared_ptr<const POctets>, bool /* droppable */>> queue;
+                    std::deque<std::shared_ptr<const POctets>> indications;
+                    bool indicationPending;
+                    std::atomic<uint64_t> sent;
+                    std::atomic<uint64_t> dropped;
+
+                    Connection(const uint64_t id, const int fd, const int handleCount);
+                    ~Connection();
+            };
+
+            const int queueCapacity;
+            std::vector<GATTServiceRef> services;
+            std::unique_ptr<GATTAttributeTable> table;
+            /** Attribute per handle, index zero is unused */
+            std::vector<Attr> attrs;
+            /** Value per handle, accessed via std::atomic_load and std::atomic_store */
+            std::vector<std::shared_ptr<const POctets>> values;
+
+            std::shared_ptr<L2CAPReactor> reactor;
+            COWVector<std::shared_ptr<Connection>> connections;
+            COWVector<std::shared_ptr<GATTServerListener>> listeners;
+            std::atomic<uint64_t> nextConnectionId;
+            std::atomic<bool> running;
+            std::mutex mtx_lifecycle;
+
+            /** eventfd waking the sender thread to rescan backlogged connections */
+            int wakefd;
+            /** eventfd signaled once by stop(), never consumed */
+            int stopfd;
+            std::thread senderThread;
+            int listenfd;
+            std::thread acceptThread;
+
+            uint16_t nextHandle() const { return static_cast<uint16_t>(attrs.size()); }
+            void addAttr(const uuid_value_t & type, const AttrKind kind, const uint8_t properties, const uint16_t aux_handle,
+                         std::shared_ptr<const POctets> value);
+
+            /** Returns the value of the given handle as seen by the given connection */
+            std::shared_ptr<const POctets> readValue(const Connection & c, const uint16_t handle) const;
+
+            bool received(const std::shared_ptr<Connection> & c, const uint8_t * data, const int len);
+            void handleRequest(Connection & c, const uint8_t * pdu, const int len);
+            void handleWrite(Connection & c, const uint8_t opcode, const uint8_t * pdu, const int len);
+            void closed(const std::shared_ptr<Connection> & c);
+
+            void sendError(Connection & c, const uint8_t reqOpcode, const uint16_t handle, const uint8_t errorCode);
+            /** Sends queued PDUs non-blocking, returns true if the connection is backlogged. Caller holds mtx_queue. */
+            bool flushLocked(Connection & c);
+            void flush(Connection & c);
+            void enqueue(Connection & c, std::shared_ptr<const POctets> pdu, const bool notification);
+            void wakeSender();
+            void senderImpl();
+            void acceptImpl();
+            int fanOut(const uint16_t valueHandle, const TROOctets & value, const bool indication);
+
+        public:
+            /**
+             * Creates a new stopped server with an empty database.
+             * @param queueCapacity notification queue capacity per connection, defaults to property 'direct_bt.gatt.server.queue'
+             */
+            GATTServer(const int queueCapacity=-1);
+
+            GATTServer(const GATTServer&) = delete;
+            void operator=(const GATTServer&) = delete;
+
+            /** Calls stop() */
+            ~GATTServer();
+
+            /**
+             * Adds a service with the given characteristics to the database, assigning the next free handles.
+             * <p>
+             * Layout per characteristic: declaration, value and, if Notify or Indicate, its Client Characteristic Configuration.
+             * </p>
+             * @throws IllegalStateException if started
+             */
+            GATTServiceRef addService(std::shared_ptr<const uuid_t> type, const bool isPrimary, const std::vector<CharacteristicSpec> & characteristics);
+
+            /** Returns all added services */
+            const std::vector<GATTServiceRef> & getServices() const { return services; }
+
+            /** Returns the attribute table of the database, nullptr until started */
+            const GATTAttributeTable * getAttributeTable() const { return table.get(); }
+
+            /** Returns the characteristic of the given value type, first match, or nullptr */
+            GATTCharacteristicRef findCharacteristic(const uuid_t & type) const;
+
+            /**
+             * Builds the attribute table and starts the reactor and sender thread.
+             * @return true if running
+             */
+            bool start();
+
+            /**
+             * Closes the listening socket and all connections, stops the reactor and joins the server's threads.
+             * <p>
+             * Shall not be called from a GATTServerListener callback.
+             * </p>
+             */
+            void stop();
+
+            bool isRunning() const { return running; }
+
+            /**
+             * Opens a listening L2CAP ATT socket on the given adapter and accepts all incoming client connections.
+             * @param adapterAddress the local adapter address
+             * @param pubaddrAdapter true if the adapter address is public, otherwise random
+             * @return true if listening, false on error or if not running
+             */
+            bool listen(const EUI48 & adapterAddress, const bool pubaddrAdapter);
+
+            /**
+             * Serves the given connected ATT channel.
+             * @param fd the connected socket, ownership is taken and closed on removal, also on failure.
+             * @return the connection id, or zero on failure
+             */
+            uint64_t addConnection(const int fd);
+
+            /** Closes the given connection, returns false if unknown. */
+            bool removeConnection(const uint64_t connectionId);
+
+            int getConnectionCount() const { return static_cast<int>(connections.size()); }
+
+            /** Returns the current counters of all connections */
+            std::vector<ConnectionStats> getConnectionStats() const;
+
+            bool addListener(std::shared_ptr<GATTServerListener> l);
+            bool removeListener(std::shared_ptr<GATTServerListener> l);
+
+            /**
+             * Replaces the stored value of the given characteristic value handle, lock-free.
+             * <p>
+             * The value is served to reads, subscribers are not informed, see notify().
+             * </p>
+             * @return false if the handle is not a characteristic value
+             */
+            bool setValue(const uint16_t valueHandle, const TROOctets & value);
+
+            /** Returns the stored value of the given characteristic value handle, or nullptr */
+            std::shared_ptr<const POctets> getValue(const uint16_t valueHandle) const;
+
+            /**
+             * Stores the given value via setValue() and sends it as ATT_HANDLE_VALUE_NTF to all connections
+             * having notifications enabled, encoding the PDU once.
+             * <p>
+             * A connection with a smaller ATT_MTU receives the value truncated to ATT_MTU-3.
+             * </p>
+             * @return the number of connections the notification has been queued for, or -1 if the handle is not a characteristic value
+             */
+            int notify(const uint16_t valueHandle, const TROOctets & value);
+
+            /**
+             * Stores the given value via setValue() and sends it as ATT_HANDLE_VALUE_IND to all connections
+             * having indications enabled, see notify().
+             * @return the number of connections the indication has been queued for, or -1 if the handle is not a characteristic value
+             */
+            int indicate(const uint16_t valueHandle, const TROOctets & value);
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* GATT_SERVER_HPP_ */
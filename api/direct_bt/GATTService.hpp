@@ -100,6 +100,9 @@ namespace direct_bt {
             /** Service type UUID */
             std::shared_ptr<const uuid_t> type;
 
+            /** Lazily cached string representations of type, see getTypeString(). */
+            uuid_string_cache typeStrings;
+
             /** List of Characteristic Declarations as shared reference */
             std::vector<GATTCharacteristicRef> characteristicList;
 
@@ -116,6 +119,12 @@ namespace direct_bt {
                 return std::string(JAVA_DBT_PACKAGE "DBTGattService");
             }
 
+            /**
+             * Returns the cached string representation of the service type UUID,
+             * see uuid_t::toUUID128String() if uuid128 is true, otherwise uuid_t::toString().
+             */
+            const std::string & getTypeString(const bool uuid128) const { return typeStrings.get(*type, uuid128); }
+
             std::shared_ptr<DBTDevice> getDeviceUnchecked() const { return wbr_device.lock(); }
             std::shared_ptr<DBTDevice> getDeviceChecked() const;
 
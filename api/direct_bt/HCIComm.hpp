@@ -36,6 +36,7 @@
 #include "BTIoctl.hpp"
 #include "HCIIoctl.hpp"
 #include "HCITypes.hpp"
+#include "IOUring.hpp"
 
 /**
  * - - - - - - - - - - - - - - -
@@ -48,43 +49,152 @@ namespace direct_bt {
 
     /**
      * Read/Write HCI communication channel.
+     * <p>
+     * The channel's descriptor is opened by the pluggable transport, see setTransport(),
+     * by default a bound Linux Bluetooth HCI socket.
+     * </p>
+     * <p>
+     * If enabled via the property 'direct_bt.io_uring', packets are received by an IOUringReceiver,
+     * see IOUringReceiver::isEnabled(). Writes are synchronous in either case.
+     * </p>
      */
     class HCIComm {
+        public:
+            /**
+             * Transport opening the packet descriptor of an HCIComm for the given dev_id and channel,
+             * returning a negative value with errno set on failure.
+             * <p>
+             * The descriptor must preserve packet boundaries, e.g. one end of a SOCK_SEQPACKET socketpair
+             * connected to a simulated controller. Packets are exchanged including their HCI packet type,
+             * as on the raw channel.
+             * </p>
+             */
+            typedef int (*TransportOpenFunc)(const uint16_t dev_id, const uint16_t channel);
+
+            /**
+             * Sets the transport used by all subsequently constructed HCIComm instances,
+             * nullptr restores the default Linux Bluetooth HCI socket.
+             * <p>
+             * Intended for simulated controllers in benchmarks and tests.
+             * </p>
+             */
+            static void setTransport(TransportOpenFunc open);
+
         private:
             static int hci_open_dev(const uint16_t dev_id, const uint16_t channel);
             static int hci_close_dev(int dd);
+            static int transport_open(const uint16_t dev_id, const uint16_t channel, bool & kernelSocket);
 
             std::recursive_mutex mtx_write;
             const uint16_t dev_id;
             const uint16_t channel;
+            bool kernelSocket;
             int _dd; // the hci socket
+            int wakefd; // eventfd waking a blocked read, see interrupt()
+            std::unique_ptr<IOUringReceiver> receiver;
+
+            /**
+             * Polls the socket together with wakefd up to timeoutMS.
+             * @return positive if readable, otherwise -1 with errno set, ETIMEDOUT if timed out or ECANCELED if interrupted.
+             */
+            int wait_readable(const int32_t timeoutMS);
 
         public:
             /** Constructing a new HCI communication channel instance */
-            HCIComm(const uint16_t dev_id, const uint16_t channel)
-            : dev_id(dev_id), channel(channel), _dd(-1) {
-                _dd = hci_open_dev(dev_id, channel);
-            }
+            HCIComm(const uint16_t dev_id, const uint16_t channel);
 
             /**
              * Releases this instance after issuing {@link #close()}.
              */
-            ~HCIComm() { close(); }
+            ~HCIComm();
+
+            /**
+             * Enables kernel receive timestamps, i.e. HCI_TIME_STAMP on the raw channel, otherwise SO_TIMESTAMPNS.
+             * @return true if enabled
+             */
+            bool enableRxTimestamps();
+
+            /**
+             * Returns the kernel receive timestamp attached to the given received message as monotonic nanoseconds,
+             * i.e. a HCI_CMSG_TSTAMP or SCM_TIMESTAMPNS control message, or the given default if none is attached.
+             */
+            static uint64_t getRxTimestamp(struct msghdr * msg, const uint64_t def);
 
             /** Closing the HCI channel, locking {@link #mutex_write()}. */
             void close();
 
+            /**
+             * Wakes up a read blocked in its poll at once, w/o locking {@link #mutex_write()},
+             * failing with errno ECANCELED.
+             * <p>
+             * The wakeup is consumed by that read, or by the next read waiting with a timeout if none is blocked.
+             * Intended to stop a reader thread after setting its stop flag, instead of waiting for its poll timeout.
+             * </p>
+             * <p>
+             * A read via an IOUringReceiver is woken up by close() only.
+             * </p>
+             */
+            void interrupt();
+
             bool isOpen() const { return 0 <= _dd; }
 
+            /**
+             * Returns true if the descriptor is a Linux Bluetooth HCI socket,
+             * false if opened by a transport set via setTransport(), not supporting the HCI socket options.
+             */
+            bool isKernelSocket() const { return kernelSocket; }
+
             /** Return this HCI device descriptor, for multithreading access use {@link #dd()}. */
             int dd() const { return _dd; }
 
+            /**
+             * Return the descriptor to poll for readability, i.e. the IOUringReceiver descriptor if used, otherwise dd().
+             */
+            int poll_dd() const { return nullptr != receiver ? receiver->getFD() : _dd; }
+
+            /** Returns true if packets are received by an IOUringReceiver. */
+            bool isIOUring() const { return nullptr != receiver; }
+
             /** Return the recursive write mutex for multithreading access. */
             std::recursive_mutex & mutex_write() { return mtx_write; }
 
+            enum Defaults : int32_t {
+                /** Maximum number of packets read via read_batch(..) within one wakeup. */
+                MAX_READ_BATCH = 64
+            };
+
             /** Generic read w/ own timeoutMS, w/o locking suitable for a unique ringbuffer sink. */
             int read(uint8_t* buffer, const int capacity, const int32_t timeoutMS);
 
+            /**
+             * Generic read w/ own timeoutMS like read(..), also receiving the packet's timestamp.
+             * @param timestamp receiving the kernel receive timestamp as monotonic nanoseconds if enabled via enableRxTimestamps(),
+             *        otherwise the time right after reading, see getCurrentNanoseconds().
+             */
+            int read(uint8_t* buffer, const int capacity, const int32_t timeoutMS, uint64_t & timestamp);
+
+            /**
+             * Generic batch read w/ own timeoutMS, w/o locking suitable for a unique ringbuffer sink.
+             * <p>
+             * Drains all pending packets up to the given count within one wakeup,
+             * i.e. one poll and one recvmmsg for all packets.
+             * </p>
+             * @param buffers count consecutive buffers of buffer_capacity each, one packet per buffer
+             * @param buffer_capacity capacity of each buffer
+             * @param lengths receiving the length of each read packet
+             * @param count maximum number of packets to read, capped to MAX_READ_BATCH
+             * @param timeoutMS poll timeout for the first packet
+             * @param incoming optional, receiving the HCI_CMSG_DIR direction of each read packet,
+             *        i.e. 1 if received from the controller, 0 if sent to the controller or -1 if unknown.
+             *        Requires enabled HCI_DATA_DIR socket option.
+             * @param timestamps optional, receiving the kernel receive timestamp of each read packet as monotonic nanoseconds
+             *        if enabled via enableRxTimestamps(), otherwise the time right after reading, see getCurrentNanoseconds().
+             * @return number of read packets, zero for a spurious wakeup,
+             *         or -1 on error, timeout (errno ETIMEDOUT) or interrupt() (errno ECANCELED)
+             */
+            int read_batch(uint8_t* buffers, const int buffer_capacity, int* lengths, const int count, const int32_t timeoutMS,
+                           int* incoming=nullptr, uint64_t* timestamps=nullptr);
+
             /** Generic write, locking {@link #mutex_write()}. */
             int write(const uint8_t* buffer, const int size);
 
@@ -30,10 +30,13 @@
 #include <string>
 #include <cstdint>
 #include <array>
+#include <vector>
+#include <unordered_map>
 
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <condition_variable>
 
 #include "DBTEnv.hpp"
 #include "BTTypes.hpp"
@@ -43,7 +46,12 @@
 #include "JavaUplink.hpp"
 #include "HCITypes.hpp"
 #include "MgmtTypes.hpp"
-#include "LFRingbuffer.hpp"
+#include "OverflowRingbuffer.hpp"
+#include "DBTMetrics.hpp"
+#include "DBTMutex.hpp"
+#include "TrafficStats.hpp"
+#include "PeriodicAdvSync.hpp"
+#include "BeaconMatcher.hpp"
 
 /**
  * - - - - - - - - - - - - - - -
@@ -58,22 +66,28 @@ namespace direct_bt {
         private:
             EUI48 address; // immutable
             BDAddressType addressType; // immutable
-            uint16_t handle; // mutable
+            /** mutable, atomic as read lock-free via HCIHandler::findTrackerConnection() */
+            std::atomic<uint16_t> handle;
+            TrafficStats traffic;
 
         public:
             HCIConnection(const EUI48 &address, const BDAddressType addressType, const uint16_t handle)
             : address(address), addressType(addressType), handle(handle) {}
 
-            HCIConnection(const HCIConnection &o) = default;
-            HCIConnection(HCIConnection &&o) = default;
-            HCIConnection& operator=(const HCIConnection &o) = default;
-            HCIConnection& operator=(HCIConnection &&o) = default;
+            HCIConnection(const HCIConnection &o) = delete;
+            HCIConnection& operator=(const HCIConnection &o) = delete;
 
             const EUI48 & getAddress() const { return address; }
             BDAddressType getAddressType() const { return addressType; }
-            uint16_t getHandle() const { return handle; }
+            uint16_t getHandle() const { return handle.load(std::memory_order_relaxed); }
 
-            void setHandle(uint16_t newHandle) { handle = newHandle; }
+            /**
+             * Returns the link level traffic accounting of this connection,
+             * i.e. the ATT PDUs and bytes of its ACL data in and out, see HCIHandler::getTrafficSnapshot().
+             */
+            TrafficStats & getTrafficStats() { return traffic; }
+
+            void setHandle(uint16_t newHandle) { handle.store(newHandle, std::memory_order_relaxed); }
 
             bool equals(const EUI48 & otherAddress, const BDAddressType otherAddressType) const
             { return address == otherAddress && addressType == otherAddressType; }
@@ -85,14 +99,75 @@ namespace direct_bt {
             { return !(*this == rhs); }
 
             std::string toString() const {
-                return "HCIConnection[handle "+uint16HexString(handle)+
+                return "HCIConnection[handle "+uint16HexString(getHandle())+
                        ", address="+address.toString()+", addressType "+getBDAddressTypeString(addressType)+"]";
             }
     };
     typedef std::shared_ptr<HCIConnection> HCIConnectionRef;
 
+    /**
+     * Link quality of one tracked connection, see HCIHandler::read_link_quality_all().
+     */
+    struct HCILinkQuality {
+        EUI48 address;
+        BDAddressType addressType;
+        uint16_t handle;
+        /** Status of the Read RSSI command, HCIStatusCode::INTERNAL_TIMEOUT if no reply has been received */
+        HCIStatusCode rssiStatus;
+        /** RSSI in dBm, 127 if not available */
+        int8_t rssi;
+        /** Status of the Read Transmit Power Level command, HCIStatusCode::INTERNAL_TIMEOUT if no reply has been received */
+        HCIStatusCode txPowerStatus;
+        /** Current transmit power level in dBm, 127 if not available */
+        int8_t txPower;
+
+        HCILinkQuality(const EUI48 & address_, const BDAddressType addressType_, const uint16_t handle_)
+        : address(address_), addressType(addressType_), handle(handle_),
+          rssiStatus(HCIStatusCode::INTERNAL_TIMEOUT), rssi(127),
+          txPowerStatus(HCIStatusCode::INTERNAL_TIMEOUT), txPower(127) {}
+
+        std::string toString() const {
+            return "HCILinkQuality[handle "+uint16HexString(handle)+
+                   ", address="+address.toString()+", addressType "+getBDAddressTypeString(addressType)+
+                   ", rssi "+std::to_string(rssi)+" ("+getHCIStatusCodeString(rssiStatus)+
+                   "), tx-power "+std::to_string(txPower)+" ("+getHCIStatusCodeString(txPowerStatus)+")]";
+        }
+    };
+
     class HCIHandler; // forward
 
+    /**
+     * Reply callback for asynchronous HCI commands, see HCIHandler::sendCommandAsync().
+     * <p>
+     * Receives the completing CMD_COMPLETE or CMD_STATUS HCIEvent,
+     * or nullptr in case of a timeout or closed HCIHandler.
+     * </p>
+     */
+    typedef FunctionDef<bool, std::shared_ptr<HCIEvent>> HCICommandReplyCallback;
+
+    /**
+     * Callback receiving one complete EInfoReportBatch within one invocation,
+     * avoiding the per report MgmtEvtDeviceFound allocation and dispatch.
+     */
+    typedef FunctionDef<bool, const EInfoReportBatch &> AdvertisingReportBatchCallback;
+    typedef COWVector<AdvertisingReportBatchCallback> AdvertisingReportBatchCallbackList;
+
+    /**
+     * Callback receiving all BeaconRecord decoded within one HCI read batch, see HCIHandler::setBeaconMatcher().
+     */
+    typedef FunctionDef<bool, const std::vector<BeaconRecord> &> BeaconRecordCallback;
+    typedef COWVector<BeaconRecordCallback> BeaconRecordCallbackList;
+
+    /**
+     * Complete L2CAP basic frame received via the HCI ACL data channel,
+     * passing the connection handle, the L2CAP channel id and the L2CAP payload.
+     * <p>
+     * The payload references the reader's receive buffer or the connection's preallocated
+     * reassembly buffer, hence it is only valid during the callback.
+     * </p>
+     */
+    typedef FunctionDef<bool, uint16_t /* handle */, uint16_t /* cid */, const TROOctets &> L2CAPFrameCallback;
+
     /**
      * HCI Singleton runtime environment properties
      * <p>
@@ -105,6 +180,8 @@ namespace direct_bt {
         private:
             HCIEnv();
 
+            static void onPropertyChanged(const std::string & name);
+
             const bool exploding; // just to trigger exploding properties
 
         public:
@@ -113,16 +190,22 @@ namespace direct_bt {
              * <p>
              * Environment variable is 'direct_bt.hci.reader.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t HCI_READER_THREAD_POLL_TIMEOUT;
+            std::atomic<int32_t> HCI_READER_THREAD_POLL_TIMEOUT;
 
             /**
              * Timeout for HCI command status replies, excluding command complete, defaults to 3s.
              * <p>
              * Environment variable is 'direct_bt.hci.cmd.status.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t HCI_COMMAND_STATUS_REPLY_TIMEOUT;
+            std::atomic<int32_t> HCI_COMMAND_STATUS_REPLY_TIMEOUT;
 
             /**
              * Timeout for HCI command complete replies, defaults to 10s.
@@ -130,16 +213,149 @@ namespace direct_bt {
              * <p>
              * Environment variable is 'direct_bt.hci.cmd.complete.timeout'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
              */
-            const int32_t HCI_COMMAND_COMPLETE_REPLY_TIMEOUT;
+            std::atomic<int32_t> HCI_COMMAND_COMPLETE_REPLY_TIMEOUT;
 
             /**
              * Small ringbuffer capacity for synchronized commands, defaults to 64 messages.
              * <p>
              * Environment variable is 'direct_bt.hci.ringsize'.
              * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> HCI_EVT_RING_CAPACITY;
+
+            /**
+             * Overflow policy of the ringbuffer for synchronized commands, defaults to 'drop_newest'
+             * as stale replies are discarded before each command anyway.
+             * <p>
+             * Environment variables are 'direct_bt.hci.ring.policy', 'direct_bt.hci.ring.timeout' and 'direct_bt.hci.ring.max',
+             * see DBTRingOptions.
+             * </p>
+             */
+            const DBTRingOptions HCI_EVT_RING_OPTIONS;
+
+            /**
+             * Maximum number of HCI packets drained by the HCI reader thread within one wakeup, defaults to 16.
+             * <p>
+             * Environment variable is 'direct_bt.hci.reader.batch'.
+             * </p>
+             */
+            const int32_t HCI_READER_BATCH_SIZE;
+
+            /**
+             * Demultiplex received HCI ACL data per connection handle within the HCI reader thread,
+             * delivering complete L2CAP frames to the registered L2CAPFrameCallback, defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.hci.acl'.
+             * </p>
+             */
+            const bool HCI_ACL_DEMUX;
+
+            /**
+             * Use kernel receive timestamps for HCIEvent and derived timestamps, defaults to true.
+             * <p>
+             * Environment variable is 'direct_bt.hci.timestamps'.
+             * </p>
              */
-            const int32_t HCI_EVT_RING_CAPACITY;
+            const bool HCI_RX_TIMESTAMPS;
+
+            /**
+             * Use the LE extended scanning commands if supported by the controller, defaults to true.
+             * <p>
+             * Environment variable is 'direct_bt.hci.scan.ext'.
+             * </p>
+             */
+            const bool HCI_EXT_SCAN;
+
+            /**
+             * Scheduling options of the HCI reader thread, thread name defaults to 'dbt_hci_rdr'.
+             * <p>
+             * Environment variables are 'direct_bt.hci.reader.sched.fifo', 'direct_bt.hci.reader.cpus' and 'direct_bt.hci.reader.name',
+             * see DBTThreadOptions.
+             * </p>
+             */
+            const DBTThreadOptions HCI_READER_THREAD_OPTIONS;
+
+            /**
+             * Allow handing over the HCI reader thread to the application's external event loop, defaults to false.
+             * <p>
+             * If enabled, the reader thread polls with a short timeout of HCIHandler::Defaults::EXTERNAL_HANDOVER_TIMEOUT,
+             * allowing HCIHandler::attachExternalReader() to take over promptly.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.hci.reader.external'.
+             * </p>
+             */
+            const bool HCI_READER_EXTERNAL;
+
+            /**
+             * Time window of the advertising report duplicate suppression cache in milliseconds, defaults to 0 for disabled.
+             * <p>
+             * Within this window unchanged legacy advertising reports are dropped before being parsed,
+             * or delivered as RSSI-only EInfoReport if their RSSI changed by at least HCI_ADV_DEDUP_RSSI_DELTA.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.hci.adv.dedup.window'.
+             * </p>
+             */
+            const int32_t HCI_ADV_DEDUP_WINDOW;
+
+            /**
+             * Minimum RSSI change in dBm of an otherwise unchanged advertising report to be delivered, defaults to 5.
+             * <p>
+             * Environment variable is 'direct_bt.hci.adv.dedup.rssi'.
+             * </p>
+             */
+            const int32_t HCI_ADV_DEDUP_RSSI_DELTA;
+
+            /**
+             * Number of advertisers held by the advertising report duplicate suppression cache, defaults to 256.
+             * <p>
+             * Environment variable is 'direct_bt.hci.adv.dedup.size'.
+             * </p>
+             */
+            const int32_t HCI_ADV_DEDUP_CACHE_SIZE;
+
+            /**
+             * Parse advertising reports in lazy mode, defaults to false.
+             * <p>
+             * If true, EInfoReport::read_data() only indexes the AD data and decodes its fixed size fields,
+             * the name, ManufactureSpecificData and service UUIDs are materialized on first access.
+             * </p>
+             * <p>
+             * Environment variable is 'direct_bt.hci.eir.lazy'.
+             * </p>
+             */
+            const bool HCI_EIR_LAZY;
+
+            /**
+             * Weight in percent of a new RSSI sample for each device's smoothed RSSI,
+             * an exponentially weighted moving average, see RSSIHistory.
+             * Defaults to 100, i.e. no smoothing.
+             * <p>
+             * Environment variable is 'direct_bt.hci.rssi.weight'.
+             * </p>
+             */
+            const int32_t HCI_RSSI_WEIGHT;
+
+            /**
+             * Minimum change in dBm of a device's smoothed RSSI since its last notification
+             * to notify an RSSI update via AdapterStatusListener::deviceUpdated().
+             * Defaults to 0, i.e. notify each changed RSSI.
+             * <p>
+             * Environment variable is 'direct_bt.hci.rssi.delta'.
+             * </p>
+             * <p>
+             * Runtime adjustable, see reload().
+             * </p>
+             */
+            std::atomic<int32_t> HCI_RSSI_DELTA;
 
             /**
              * Debug all HCI event communication
@@ -151,9 +367,18 @@ namespace direct_bt {
 
         private:
             /** Maximum number of packets to wait for until matching a sequential command. Won't block as timeout will limit. */
-            const int32_t HCI_READ_PACKET_MAX_RETRY;
+            std::atomic<int32_t> HCI_READ_PACKET_MAX_RETRY;
 
         public:
+            /**
+             * Re-reads all runtime adjustable properties from the environment,
+             * invoked by DBTEnv::setProperty() for each property below 'direct_bt.hci'.
+             * <p>
+             * Live handlers use the new values with their next operation.
+             * </p>
+             */
+            void reload();
+
             static HCIEnv& get() {
                 /**
                  * Thread safe starting with C++11 6.7:
@@ -182,7 +407,19 @@ namespace direct_bt {
     class HCIHandler {
         public:
             enum Defaults : int32_t {
-                HCI_MAX_MTU = static_cast<uint8_t>(HCIConstU8::PACKET_MAX_SIZE)
+                HCI_MAX_MTU = static_cast<uint8_t>(HCIConstU8::PACKET_MAX_SIZE),
+
+                /** Maximum HCI ACL data packet size including HCIPacketType */
+                HCI_MAX_ACL_MTU = 1 + HCI_MAX_FRAME_SIZE,
+
+                /** Maximum reassembled extended advertising data length, BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.66 */
+                HCI_MAX_EXT_ADV_DATA = 1650,
+
+                /** Number of concurrently reassembled fragmented extended advertising reports */
+                HCI_EXT_ADV_FRAGMENT_SLOTS = 4,
+
+                /** Poll timeout in milliseconds of the reader thread if HCIEnv::HCI_READER_EXTERNAL is enabled */
+                EXTERNAL_HANDOVER_TIMEOUT = 100
             };
 
             static const pid_t pidSelf;
@@ -193,7 +430,13 @@ namespace direct_bt {
             const HCIEnv & env;
             const BTMode btMode;
             const uint16_t dev_id;
+            /** Size of each receive buffer, HCI_MAX_MTU or HCI_MAX_ACL_MTU if demultiplexing ACL data */
+            const int rbufferSlotSize;
+            /** Preallocated HCI_READER_BATCH_SIZE receive buffers of rbufferSlotSize each */
             POctets rbuffer;
+            int rbufferLengths[HCIComm::MAX_READ_BATCH];
+            int rbufferIncoming[HCIComm::MAX_READ_BATCH];
+            uint64_t rbufferTimestamps[HCIComm::MAX_READ_BATCH];
             HCIComm comm;
             std::recursive_mutex mtx;
             hci_ufilter filter_mask;
@@ -214,16 +457,68 @@ namespace direct_bt {
             inline static void filter_all_opcbit(uint64_t &mask) { mask=0xffffffffffffffffUL; }
             inline static void filter_set_opcbit(HCIOpcodeBit opcbit, uint64_t &mask) { set_bit_uint64(number(opcbit), mask); }
 
-            LFRingbuffer<std::shared_ptr<HCIEvent>, nullptr> hciEventRing;
+            /** Recycled HCIEvent instances for the reader thread, capacity of HCIEnv::HCI_EVT_RING_CAPACITY per event type. */
+            HCIEventPool hciEventPool;
+            /** Recycled EInfoReport instances of advertising reports for the reader thread, capacity of HCIEnv::HCI_EVT_RING_CAPACITY. */
+            EInfoReportPool eirPool;
+            /** Command replies, produced by the reader thread and consumed by the one command sender holding mtx_sendReply. */
+            OverflowRingbuffer<std::shared_ptr<HCIEvent>, nullptr> hciEventRing;
             std::atomic<pthread_t> hciReaderThreadId;
             std::atomic<bool> hciReaderRunning;
             std::atomic<bool> hciReaderShallStop;
+            /** True once reading has been handed over to the external event loop, see attachExternalReader() */
+            std::atomic<bool> hciReaderExternal;
+            /** Dispatch metric of the external event loop, see processReadable() */
+            LatencyHistogram * metricExternalDispatch;
             std::mutex mtx_hciReaderInit;
             std::condition_variable cv_hciReaderInit;
-            std::recursive_mutex mtx_sendReply; // for sendWith*Reply, process*Command, ..
+            DBTRecursiveMutex mtx_sendReply { "hci_send_reply" }; // for sendWith*Reply, process*Command, ..
+
+            /** Pending asynchronous command, see sendCommandAsync() */
+            struct PendingCommand {
+                HCIOpcode opcode;
+                bool expectComplete;
+                uint64_t deadline;
+                HCICommandReplyCallback cb;
+
+                PendingCommand(const HCIOpcode opcode_, const bool expectComplete_, const uint64_t deadline_, const HCICommandReplyCallback & cb_)
+                : opcode(opcode_), expectComplete(expectComplete_), deadline(deadline_), cb(cb_) {}
+            };
+            std::vector<PendingCommand> pendingCmdList;
+            std::mutex mtx_pendingCmdList;
+            std::condition_variable cv_cmdCredits;
+            /** Controller's remaining Num_HCI_Command_Packets credit, updated by each CMD_COMPLETE and CMD_STATUS. */
+            int cmdCredits;
 
-            std::vector<HCIConnectionRef> connectionList;
-            std::recursive_mutex mtx_connectionList;
+            /**
+             * Completes a pending asynchronous command matching the given CMD_COMPLETE or CMD_STATUS opcode.
+             * Updates the command credit in all cases.
+             * @return true if consumed by a pending asynchronous command, otherwise false
+             */
+            bool completePendingCommand(std::shared_ptr<HCIEvent> event);
+            /** Completes all pending asynchronous commands exceeding their deadline with nullptr */
+            void expirePendingCommands(const bool all);
+
+            /** Key of the connection address index */
+            typedef BDAddressKey TrackerAddressKey;
+            typedef std::unordered_map<TrackerAddressKey, HCIConnectionRef> TrackerAddressIndex;
+
+            /** 12 bit HCI connection handle space */
+            static const int CONNECTION_HANDLE_INDEX_SIZE = 0x1000;
+
+            /**
+             * Tracked connections indexed by their non zero 12 bit connection handle.
+             * Elements are read via std::atomic_load w/o locking mtx_connectionList.
+             */
+            std::vector<HCIConnectionRef> connectionHandleIndex;
+            /**
+             * Copy on write index of all tracked connections by address and address type,
+             * read via std::atomic_load w/o locking mtx_connectionList.
+             */
+            std::shared_ptr<const TrackerAddressIndex> connectionAddressIndex;
+            /** Serializes modifications of the tracker indices */
+            DBTRecursiveMutex mtx_connectionList { "hci_connections" };
+            void setTrackerHandleIndex(const uint16_t handle, const HCIConnectionRef & conn);
             /**
              * Returns a newly added HCIConnectionRef tracker connection with given parameters, if not existing yet.
              * <p>
@@ -244,26 +539,227 @@ namespace direct_bt {
 
             /** One MgmtAdapterEventCallbackList per event type, allowing multiple callbacks to be invoked for each event */
             std::array<MgmtEventCallbackList, static_cast<uint16_t>(MgmtEvent::Opcode::MGMT_EVENT_TYPE_COUNT)> mgmtEventCallbackLists;
-            std::recursive_mutex mtx_callbackLists;
+            DBTRecursiveMutex mtx_callbackLists { "hci_callbacks" };
             inline void checkMgmtEventCallbackListsIndex(const MgmtEvent::Opcode opc) const {
                 if( static_cast<uint16_t>(opc) >= mgmtEventCallbackLists.size() ) {
                     throw IndexOutOfBoundsException(static_cast<uint16_t>(opc), 1, mgmtEventCallbackLists.size(), E_FILE_LINE);
                 }
             }
+            AdvertisingReportBatchCallbackList advReportBatchCallbackList;
+            /** Periodic advertising syncs, routing their reports on the reader thread */
+            PeriodicAdvSyncTable periodicAdvSyncs;
+            /** Serializes le_create_periodic_sync(), as the controller allows only one outstanding request */
+            std::mutex mtx_periodicAdvCreate;
+            /** True once periodic advertising syncs are used, enabling their meta events */
+            std::atomic<bool> listenPeriodicAdv { false };
+
+            /** Immutable BeaconMatcher, published via std::atomic_store(), may be nullptr */
+            std::shared_ptr<const BeaconMatcher> beaconMatcher = nullptr;
+            BeaconRecordCallbackList beaconRecordCallbackList;
+            /** BeaconRecord of the current read batch, only used by the reader thread */
+            std::vector<BeaconRecord> beaconRecords;
+
+            /**
+             * Matches the given raw AD data of one advertising report via the BeaconMatcher,
+             * appending the BeaconRecord if matched, called by the reader thread.
+             * @return true if matched
+             */
+            bool matchBeacon(const BeaconMatcher & matcher, const uint8_t * data, const int length,
+                             const EUI48 & address, const uint8_t ad_address_type, const int8_t rssi, const uint64_t timestamp);
+
+            /**
+             * Matches all reports of one LE_ADVERTISING_REPORT event via the BeaconMatcher.
+             * @param consumed returns the addresses of the matched reports, if consuming
+             * @param consumedCount returns the number of consumed reports
+             * @return the number of reports of the event
+             */
+            int matchBeacons(const BeaconMatcher & matcher, const uint8_t * data, const int data_length, const uint64_t timestamp,
+                             EUI48 * consumed, int & consumedCount);
+
+            /** Delivers the BeaconRecord of the current read batch to all BeaconRecordCallback, called by the reader thread. */
+            void sendBeaconRecords();
+            bool hasMgmtEventCallback(const MgmtEvent::Opcode opc) const;
+
+            /** Per connection handle L2CAP frame reassembly of the HCI ACL data demultiplexer */
+            struct ACLChannel {
+                const uint16_t cid;
+                L2CAPFrameCallback cb;
+                /** Preallocated reassembly buffer for one L2CAP basic frame including its header */
+                POctets frame;
+                /** Received bytes of the current frame */
+                int filled;
+                /** Size of the current frame, zero if no frame is pending */
+                int expected;
+
+                ACLChannel(const uint16_t cid_, const L2CAPFrameCallback & cb_, const int maxPayloadSize)
+                : cid(cid_), cb(cb_), frame(number(HCIConstU8::L2CAP_BASIC_HDR_SIZE) + maxPayloadSize), filled(0), expected(0) {}
+            };
+            /** ACLChannel by connection handle, guarded by mtx_callbackLists */
+            std::unordered_map<uint16_t, std::shared_ptr<ACLChannel>> aclChannels;
+            /** True if HCIEnv::HCI_ACL_DEMUX and the HCI_DATA_DIR socket option could be enabled */
+            bool aclDemux;
+
+            /** LE features of the controller, read once by the constructor */
+            bool leExtAdvSupported;
+            bool leCodedPHYSupported;
+            bool le2MPHYSupported;
+            bool leDataLenExtSupported;
+            /** Capabilities of the controller, probed once by the constructor */
+            ControllerCaps controllerCaps;
+
+            /** Pending fragmented extended advertising data of one advertiser and advertising set */
+            struct ExtAdvFragment {
+                bool inUse;
+                /** Timestamp of the first fragment */
+                uint64_t timestamp;
+                EUI48 address;
+                uint8_t addressType;
+                uint8_t sid;
+                /** Preallocated reassembly buffer of HCI_MAX_EXT_ADV_DATA capacity */
+                POctets data;
+
+                ExtAdvFragment()
+                : inUse(false), timestamp(0), address(), addressType(0), sid(0), data(HCI_MAX_EXT_ADV_DATA, 0) {}
+            };
+            /** Duplicate advertising report suppression, only used by the reader thread */
+            HCIAdvDedupCache advDedupCache;
+            /** Pending advDedupCache clear request of another thread, served by the reader thread, see clearAdvDedupCache() */
+            std::atomic<bool> advDedupCacheClearReq;
+
+            /**
+             * Reads all LE_ADVERTISING_REPORT reports of one event like EInfoReport::read_ad_reports(),
+             * however, skipping duplicates and reducing RSSI changes to RSSI-only reports via advDedupCache.
+             * <p>
+             * Only parses the event completely, if at least one report is new.
+             * </p>
+             * @param timestamp monotonic timestamp in milliseconds of the event
+             */
+            EInfoReportBatch read_ad_reports_dedup(uint8_t const * data, const int data_length, const uint64_t timestamp);
+
+            /** HCI_EXT_ADV_FRAGMENT_SLOTS reassembly slots, only used by the reader thread */
+            std::vector<ExtAdvFragment> extAdvFragments;
+
+            /**
+             * Reads all LE_EXT_ADV_REPORT reports of one event, reassembling fragmented advertising data
+             * across events per advertiser address and advertising set id.
+             * <p>
+             * Only complete or truncated reports are returned, called by the reader thread.
+             * </p>
+             * @param timestamp monotonic timestamp in milliseconds of the event
+             */
+            EInfoReportBatch read_ext_ad_reports(uint8_t const * data, const int data_length, const uint64_t timestamp);
+
+            /**
+             * Derives and installs the tightest kernel hci_ufilter and own LE_META filter
+             * from the registered MgmtEventCallback and AdvertisingReportBatchCallback,
+             * hence unwanted events won't wake up the reader thread.
+             * <p>
+             * Events required for sequential command processing are always enabled.
+             * </p>
+             * <p>
+             * Caller shall hold mtx_callbackLists.
+             * </p>
+             * @return false if installing the kernel filter failed, otherwise true
+             */
+            bool updateEventFilter();
+
+            /** Translator of one received HCIEvent into its MgmtEvent, may return nullptr. */
+            typedef std::shared_ptr<MgmtEvent> (HCIHandler::*HCIEventTranslator)(std::shared_ptr<HCIEvent> ev);
+
+            /**
+             * One entry of the declarative HCIEvent to MgmtEvent translation table.
+             * <p>
+             * New translated events are added to HCIHandler::translations only,
+             * using translateStruct() or translateMetaStruct() for their typed packed-struct translator.
+             * </p>
+             */
+            struct HCIEventTranslation {
+                HCIEventType evt;
+                /** HCIMetaEventType::INVALID if evt is not HCIEventType::LE_META */
+                HCIMetaEventType met;
+                MgmtEvent::Opcode opc;
+                /** nullptr if the event is not translated by the reader, e.g. command replies */
+                HCIEventTranslator translator;
+            };
+            static const HCIEventTranslation translations[];
+
+            /** Returns the HCIEventTranslation of the given event type or nullptr. */
+            static const HCIEventTranslation * findTranslation(HCIEventType evt, HCIMetaEventType met);
+
             std::shared_ptr<MgmtEvent> translate(std::shared_ptr<HCIEvent> ev);
 
+            /**
+             * Generic translator validating the packed struct of the given HCIEvent,
+             * passing the typed view to the per-event translator fn.
+             */
+            template<typename hci_event_struct,
+                     std::shared_ptr<MgmtEvent> (HCIHandler::*fn)(const HCIEvent & ev, const hci_event_struct & s, const HCIStatusCode status)>
+            std::shared_ptr<MgmtEvent> translateStruct(std::shared_ptr<HCIEvent> ev);
+
+            /** Meta event variant of translateStruct() */
+            template<typename hci_event_struct,
+                     std::shared_ptr<MgmtEvent> (HCIHandler::*fn)(const HCIEvent & ev, const hci_event_struct & s, const HCIStatusCode status)>
+            std::shared_ptr<MgmtEvent> translateMetaStruct(std::shared_ptr<HCIEvent> ev);
+
+            std::shared_ptr<MgmtEvent> translateConnComplete(const HCIEvent & ev, const hci_ev_conn_complete & s, const HCIStatusCode status);
+            std::shared_ptr<MgmtEvent> translateDisconnComplete(const HCIEvent & ev, const hci_ev_disconn_complete & s, const HCIStatusCode status);
+            std::shared_ptr<MgmtEvent> translateLEConnComplete(const HCIEvent & ev, const hci_ev_le_conn_complete & s, const HCIStatusCode status);
+
+            /**
+             * Delivers the given EInfoReportBatch to all AdvertisingReportBatchCallback within one invocation each.
+             * <p>
+             * Only if DEVICE_FOUND MgmtEventCallback are registered,
+             * each EInfoReport is also sent as one MgmtEvtDeviceFound.
+             * </p>
+             */
+            void sendAdvertisingReportBatch(const EInfoReportBatch & batch);
+
+            /** Processes one received HCI packet, called by the reader thread */
+            void processPacket(const uint8_t * buffer, const int len, const uint64_t timestampNS);
+            /** Reassembles and delivers one received HCI ACL data packet to its ACLChannel, called by the reader thread */
+            void processACLData(const uint8_t * buffer, const int len);
+            /** Counts one received or sent HCI ACL data packet at its HCIConnection's TrafficStats, called by the reader thread */
+            void countACLTraffic(const uint8_t * buffer, const int len, const bool incoming);
+            /** Dispatches count packets of one read batch, called by the reader thread or external event loop */
+            void dispatchBatch(const int count, LatencyHistogram * metricDispatch);
             void hciReaderThreadImpl();
 
+            /** Probes the optional ControllerCaps buffer, list and data length sizes, called by the constructor */
+            void probeControllerCaps();
+
             bool sendCommand(HCICommand &req);
+            /** Discards all pending stale replies, e.g. received after a previous command timed out. Consumer side of hciEventRing. */
+            void discardStaleReplies();
             std::shared_ptr<HCIEvent> getNextReply(HCICommand &req, int32_t & retryCount, const int32_t replyTimeoutMS);
 
             std::shared_ptr<HCIEvent> sendWithCmdCompleteReply(HCICommand &req, HCICommandCompleteEvent **res);
 
             std::shared_ptr<HCIEvent> processCommandStatus(HCICommand &req, HCIStatusCode *status);
 
+            /**
+             * Sends all given commands via sendCommandAsync() w/o waiting for each reply,
+             * then waits for all replies within timeoutMS.
+             * <p>
+             * Replies are matched to the commands in send order per opcode, as the controller processes commands in order.
+             * </p>
+             * @return the HCIStatusCode of each command in the given order,
+             *         HCIStatusCode::INTERNAL_TIMEOUT if no reply has been received
+             *         and HCIStatusCode::INTERNAL_FAILURE if the command could not be sent.
+             */
+            std::vector<HCIStatusCode> processCommandsPipelined(std::vector<std::shared_ptr<HCICommand>> & reqs,
+                                                                const bool expectComplete, const int32_t timeoutMS, const char * caller);
+
+            /**
+             * Sends the given command and copies the HCICommandCompleteEvent's return parameter into the given HCIReplyView.
+             * <p>
+             * The reply event is released before returning, hence returned to the event pool
+             * instead of being kept alive by the caller while accessing the reply.
+             * </p>
+             * @return the reply's HCIStatusCode if valid, HCIStatusCode::INTERNAL_TIMEOUT if no reply has been received
+             *         or HCIStatusCode::INTERNAL_FAILURE if the reply is undersized.
+             */
             template<typename hci_cmd_event_struct>
-            std::shared_ptr<HCIEvent> processCommandComplete(HCICommand &req,
-                                                             const hci_cmd_event_struct **res, HCIStatusCode *status);
+            HCIStatusCode processCommandComplete(HCICommand &req, HCIReplyView<hci_cmd_event_struct> & res);
 
             template<typename hci_cmd_event_struct>
             const hci_cmd_event_struct* getReplyStruct(std::shared_ptr<HCIEvent> event, HCIEventType evc, HCIStatusCode *status);
@@ -286,6 +782,9 @@ namespace direct_bt {
 
             BTMode getBTMode() { return btMode; }
 
+            /** Returns the overflow counters of the command reply ringbuffer, see HCIEnv::HCI_EVT_RING_OPTIONS. */
+            const RingStats & getEventRingStats() const { return hciEventRing.getStats(); }
+
             /** Returns true if this mgmt instance is open and hence valid, otherwise false */
             bool isOpen() const {
                 return comm.isOpen();
@@ -308,6 +807,10 @@ namespace direct_bt {
              * <p>
              * Scan parameters control advertising (AD) Protocol Data Unit (PDU) delivery behavior.
              * </p>
+             * <p>
+             * Issues le_set_ext_scan_param() on the LE 1M and, if supported, the LE Coded PHY instead,
+             * if the controller supports extended advertising and HCIEnv::HCI_EXT_SCAN is enabled.
+             * </p>
              *
              * @param le_scan_active true enables delivery of active scanning PDUs, otherwise no scanning PDUs shall be sent (default)
              * @param own_mac_type HCILEOwnAddressType::PUBLIC (default) or random/private.
@@ -325,11 +828,223 @@ namespace direct_bt {
              * <p>
              * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.11 LE Set Scan Enable command
              * </p>
+             * <p>
+             * Issues le_enable_ext_scan() instead, if the controller supports extended advertising
+             * and HCIEnv::HCI_EXT_SCAN is enabled.
+             * </p>
              * @param enable true to enable discovery, otherwise false
              * @param filter_dup true to filter out duplicate AD PDUs (default), otherwise all will be reported.
              */
             HCIStatusCode le_enable_scan(const bool enable, const bool filter_dup=true);
 
+            /**
+             * Forgets all advertisers of the duplicate advertising report suppression,
+             * i.e. the next report of each advertiser is parsed completely again.
+             * <p>
+             * Shall be called whenever the discovered devices are removed,
+             * as their following reports would otherwise be dropped as duplicates or reduced to RSSI-only updates.
+             * Also performed when LE scanning gets enabled.
+             * </p>
+             * <p>
+             * The cache is cleared by the reader thread before processing its next advertising report.
+             * </p>
+             */
+            void clearAdvDedupCache() { advDedupCacheClearReq = true; }
+
+            /** Returns true if the controller supports LE extended advertising, i.e. extended scanning and reports. */
+            bool isLEExtAdvSupported() const { return leExtAdvSupported; }
+
+            /** Returns true if the controller supports the LE Coded PHY. */
+            bool isLECodedPHYSupported() const { return leCodedPHYSupported; }
+
+            /** Returns true if the controller supports the LE 2M PHY. */
+            bool isLE2MPHYSupported() const { return le2MPHYSupported; }
+
+            /** Returns true if the controller supports the LE Data Packet Length Extension, i.e. LL PDUs up to 251 bytes. */
+            bool isLEDataLenExtSupported() const { return leDataLenExtSupported; }
+
+            /**
+             * Returns the ControllerCaps probed at open time,
+             * i.e. the LE buffer size, LE features, white and resolving list sizes and the maximum LE data length.
+             */
+            const ControllerCaps & getControllerCaps() const { return controllerCaps; }
+
+            /**
+             * Sets LE extended scanning parameters, used by le_set_scan_param() if supported and enabled via HCIEnv::HCI_EXT_SCAN.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.64 LE Set Extended Scan Parameters command
+             * </p>
+             * Scan parameters are applied to all given PHYs.
+             * @param le_scan_active true enables delivery of active scanning PDUs, otherwise no scanning PDUs shall be sent (default)
+             * @param own_mac_type HCILEOwnAddressType::PUBLIC (default) or random/private.
+             * @param le_scan_interval in units of 0.625ms, default value 18 for 11.25ms, min value 4 for 2.5ms -> 0xffff for 40.96s
+             * @param le_scan_window in units of 0.625ms, default value 18 for 11.25ms,  min value 4 for 2.5ms -> 0xffff for 40.96s. Shall be <= le_scan_interval
+             * @param filter_policy 0x00 accepts all PDUs (default), 0x01 only of whitelisted, ...
+             * @param le_scan_phys bit mask of LE_SCAN_PHY_1M (default) and LE_SCAN_PHY_CODED
+             */
+            HCIStatusCode le_set_ext_scan_param(const bool le_scan_active=false,
+                                                const HCILEOwnAddressType own_mac_type=HCILEOwnAddressType::PUBLIC,
+                                                const uint16_t le_scan_interval=18, const uint16_t le_scan_window=18,
+                                                const uint8_t filter_policy=0x00, const uint8_t le_scan_phys=LE_SCAN_PHY_1M);
+
+            /**
+             * Starts or stops LE extended scanning, used by le_enable_scan() if supported and enabled via HCIEnv::HCI_EXT_SCAN.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.65 LE Set Extended Scan Enable command
+             * </p>
+             * @param enable true to enable discovery, otherwise false
+             * @param filter_dup true to filter out duplicate AD PDUs (default), otherwise all will be reported.
+             * @param duration in units of 10ms, zero to scan continuously (default)
+             * @param period in units of 1.28s, zero to scan continuously (default)
+             */
+            HCIStatusCode le_enable_ext_scan(const bool enable, const bool filter_dup=true,
+                                             const uint16_t duration=0, const uint16_t period=0);
+
+            /**
+             * Reads the maximum number of advertising sets supported by the controller.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.58 LE Read Number of Supported Advertising Sets command
+             * </p>
+             */
+            HCIStatusCode le_read_num_supported_adv_sets(uint8_t & num_sets);
+
+            /**
+             * Reads the maximum advertising data length supported by the controller.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.57 LE Read Maximum Advertising Data Length command
+             * </p>
+             */
+            HCIStatusCode le_read_max_adv_data_len(uint16_t & max_len);
+
+            /**
+             * Sets the parameters of the given advertising set, creating the set if not existing.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.53 LE Set Extended Advertising Parameters command
+             * </p>
+             * Shall not be called while the set is enabled.
+             * @param handle the advertising set handle [0x00..0xEF]
+             * @param evt_properties advertising event properties bit mask, see AdvertisingParameter
+             * @param interval_min minimum advertising interval in units of 0.625ms [0x20..0xFFFFFF]
+             * @param interval_max maximum advertising interval in units of 0.625ms [interval_min..0xFFFFFF]
+             * @param own_mac_type own address type, a random address requires le_set_adv_set_random_addr()
+             * @param channel_map bit mask of the primary advertising channels 37, 38 and 39
+             * @param tx_power requested TX power in dBm, 0x7F for no preference
+             * @param primary_phy 0x01 for the LE 1M or 0x03 for the LE Coded PHY
+             * @param secondary_phy 0x01 for the LE 1M, 0x02 for the LE 2M or 0x03 for the LE Coded PHY
+             * @param sid advertising SID [0x0..0xF]
+             * @param selected_tx_power returns the TX power in dBm selected by the controller
+             */
+            HCIStatusCode le_set_ext_adv_params(const uint8_t handle, const uint16_t evt_properties,
+                                                const uint32_t interval_min, const uint32_t interval_max,
+                                                const HCILEOwnAddressType own_mac_type, const uint8_t channel_map,
+                                                const int8_t tx_power, const uint8_t primary_phy, const uint8_t secondary_phy,
+                                                const uint8_t sid, int8_t & selected_tx_power);
+
+            /**
+             * Sets the advertising or scan response data of the given advertising set.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.54 LE Set Extended Advertising Data command
+             * </p>
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.55 LE Set Extended Scan Response Data command
+             * </p>
+             * Data exceeding HCILESetExtAdvDataCmd::MAX_DATA_LEN is sent in fragments,
+             * which is only allowed while the set is disabled.
+             * Otherwise the data is replaced with one command, also while the set is enabled.
+             * @param scanRsp if true the scan response data, otherwise the advertising data
+             * @param handle the advertising set handle
+             * @param data the data of given length, up to le_read_max_adv_data_len()
+             * @param length the data length
+             */
+            HCIStatusCode le_set_ext_adv_data(const bool scanRsp, const uint8_t handle, const uint8_t * data, const int length);
+
+            /**
+             * Enables or disables the given advertising sets.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.56 LE Set Extended Advertising Enable command
+             * </p>
+             * @param enable true to enable, otherwise false
+             * @param sets the advertising sets, disabling w/o any set disables all sets
+             * @param count number of sets
+             */
+            HCIStatusCode le_enable_ext_adv(const bool enable, const HCILESetExtAdvEnableCmd::Set * sets, const int count);
+
+            /**
+             * Removes the given disabled advertising set.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.59 LE Remove Advertising Set command
+             * </p>
+             */
+            HCIStatusCode le_remove_adv_set(const uint8_t handle);
+
+            /**
+             * Removes all disabled advertising sets.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.60 LE Clear Advertising Sets command
+             * </p>
+             */
+            HCIStatusCode le_clear_adv_sets();
+
+            /**
+             * Sets the random device address of the given advertising set.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.52 LE Set Advertising Set Random Address command
+             * </p>
+             */
+            HCIStatusCode le_set_adv_set_random_addr(const uint8_t handle, const EUI48 & address);
+
+            /**
+             * Synchronizes to the periodic advertising of the given advertiser,
+             * routing its reports to the given listener, see PeriodicAdvSyncTable.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.67 LE Periodic Advertising Create Sync command
+             * </p>
+             * <p>
+             * Blocks until the sync has been established, failed or timed out, in which case the request is cancelled.
+             * Concurrent calls are serialized, as the controller allows only one outstanding request.
+             * Requires extended scanning being enabled, see le_enable_ext_scan(), to receive the advertiser's AUX_ADV_IND.
+             * </p>
+             * @param sid advertising SID of the periodic advertiser [0x0..0xF]
+             * @param address address of the periodic advertiser
+             * @param address_type address type of the periodic advertiser
+             * @param listener the listener receiving the reports of this sync
+             * @param sync_handle returns the sync handle if successful
+             * @param skip number of periodic advertising events to skip after a successful receive [0x0000..0x01F3]
+             * @param sync_timeout sync timeout in units of 10ms [0x000A..0x4000]
+             * @param timeoutMS maximum time to wait for the sync being established
+             * @return HCIStatusCode::SUCCESS if the sync has been established, otherwise HCIStatusCode may disclose reason for failure.
+             */
+            HCIStatusCode le_create_periodic_sync(const uint8_t sid, const EUI48 & address, const HCILEPeerAddressType address_type,
+                                                  const std::shared_ptr<PeriodicAdvSyncListener> & listener, uint16_t & sync_handle,
+                                                  const uint16_t skip=0, const uint16_t sync_timeout=0x0064,
+                                                  const int32_t timeoutMS=5000);
+
+            /**
+             * Terminates the given periodic advertising sync.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.69 LE Periodic Advertising Terminate Sync command
+             * </p>
+             */
+            HCIStatusCode le_terminate_periodic_sync(const uint16_t sync_handle);
+
+            /** Returns a snapshot of all established periodic advertising syncs. */
+            std::vector<PeriodicAdvSyncInfo> getPeriodicAdvSyncs() { return periodicAdvSyncs.getSyncs(); }
+
+            /**
+             * Attaches the given immutable BeaconMatcher to the advertising report path, or removes it if nullptr.
+             * <p>
+             * The raw AD data of each LE_ADVERTISING_REPORT and LE_EXT_ADV_REPORT is matched
+             * before any EInfoReport is created, matched reports are delivered as BeaconRecord
+             * to the BeaconRecordCallback once per HCI read batch.
+             * If the matcher is consuming, see BeaconMatcher::isConsuming(), matched reports are not
+             * delivered as EInfoReport, hence DBTAdapter won't create a DBTDevice for them.
+             * </p>
+             */
+            void setBeaconMatcher(std::shared_ptr<const BeaconMatcher> m) { std::atomic_store(&beaconMatcher, m); }
+
+            /** Returns the attached BeaconMatcher, may be nullptr. */
+            std::shared_ptr<const BeaconMatcher> getBeaconMatcher() const { return std::atomic_load(&beaconMatcher); }
+
             /**
              * Establish a connection to the given LE peer.
              * <p>
@@ -377,6 +1092,210 @@ namespace direct_bt {
                                      const uint16_t conn_handle, const EUI48 &peer_bdaddr, const BDAddressType peer_mac_type,
                                      const HCIStatusCode reason=HCIStatusCode::REMOTE_USER_TERMINATED_CONNECTION);
 
+            /**
+             * Request new connection parameter of an established LE connection.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.18 LE Connection Update command
+             * </p>
+             * <p>
+             * Only the command status is awaited, the negotiated parameter are applied asynchronously
+             * by the link layer and reported via the LE Connection Update Complete event.
+             * </p>
+             * @param conn_handle the LE connection handle
+             * @param conn_interval_min in units of 1.25ms, min value 6 for 7.5ms
+             * @param conn_interval_max in units of 1.25ms, shall be >= conn_interval_min
+             * @param conn_latency slave latency in units of connection events
+             * @param supervision_timeout in units of 10ms
+             * @return HCIStatusCode::SUCCESS if the command has been accepted, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode le_conn_update(const uint16_t conn_handle,
+                                         const uint16_t conn_interval_min, const uint16_t conn_interval_max,
+                                         const uint16_t conn_latency=0x0000, const uint16_t supervision_timeout=number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10);
+
+            /**
+             * Request the same new connection parameter for all given established LE connections,
+             * pipelining the LE Connection Update commands up to the controller's command credit.
+             * <p>
+             * See le_conn_update(const uint16_t, const uint16_t, const uint16_t, const uint16_t, const uint16_t)
+             * for the parameter and the asynchronous completion.
+             * </p>
+             * <p>
+             * Shall not be called on the HCI reader thread, e.g. from within a callback.
+             * </p>
+             * @param conn_handles the LE connection handles
+             * @param timeoutMS timeout for all command status replies, defaults to HCIEnv::HCI_COMMAND_STATUS_REPLY_TIMEOUT if negative
+             * @return the HCIStatusCode of each given connection handle in the same order
+             */
+            std::vector<HCIStatusCode> le_conn_update(const std::vector<uint16_t> & conn_handles,
+                                                      const uint16_t conn_interval_min, const uint16_t conn_interval_max,
+                                                      const uint16_t conn_latency=0x0000, const uint16_t supervision_timeout=number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10,
+                                                      const int32_t timeoutMS=-1);
+
+            /**
+             * Removes all devices from the controller's white list.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.15 LE Clear White List command
+             * </p>
+             * <p>
+             * The white list commands modify the controller's white list directly, bypassing the kernel's Mgmt
+             * device list as used by DBTAdapter::addDeviceToWhitelist() via DBTManager, which remains the default.
+             * The kernel rewrites the controller's white list whenever it updates its background scan,
+             * hence the direct commands suit applications performing white list scanning or connecting via HCIHandler only.
+             * </p>
+             * <p>
+             * The controller rejects white list changes with HCIStatusCode::COMMAND_DISALLOWED
+             * while the white list is in use by scanning, advertising or a pending LE Create Connection.
+             * </p>
+             */
+            HCIStatusCode le_clear_white_list();
+
+            /**
+             * Adds the given LE device to the controller's white list, see le_clear_white_list() for details.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.16 LE Add Device To White List command
+             * </p>
+             * @param address the device address
+             * @param address_type either BDAddressType::BDADDR_LE_PUBLIC or BDAddressType::BDADDR_LE_RANDOM
+             */
+            HCIStatusCode le_add_to_white_list(const EUI48 & address, const BDAddressType address_type);
+
+            /**
+             * Removes the given LE device from the controller's white list, see le_clear_white_list() for details.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.17 LE Remove Device From White List command
+             * </p>
+             * @param address the device address
+             * @param address_type either BDAddressType::BDADDR_LE_PUBLIC or BDAddressType::BDADDR_LE_RANDOM
+             */
+            HCIStatusCode le_del_from_white_list(const EUI48 & address, const BDAddressType address_type);
+
+            /**
+             * Adds all given LE devices to the controller's white list,
+             * pipelining the commands up to the controller's command credit, see le_clear_white_list() for details.
+             * <p>
+             * The controller's white list capacity is given by ControllerCaps::white_list_size,
+             * additional devices are rejected with HCIStatusCode::MEMORY_CAPACITY_EXCEEDED.
+             * </p>
+             * <p>
+             * Shall not be called on the HCI reader thread, e.g. from within a callback.
+             * </p>
+             * @param devices the LE devices
+             * @param timeoutMS timeout for all replies, defaults to HCIEnv::HCI_COMMAND_COMPLETE_REPLY_TIMEOUT if negative
+             * @return the HCIStatusCode of each given device in the same order
+             */
+            std::vector<HCIStatusCode> le_add_to_white_list(const std::vector<BDAddressKey> & devices, const int32_t timeoutMS=-1);
+
+            /**
+             * Removes all given LE devices from the controller's white list,
+             * pipelining the commands up to the controller's command credit, see le_add_to_white_list().
+             * @param devices the LE devices
+             * @param timeoutMS timeout for all replies, defaults to HCIEnv::HCI_COMMAND_COMPLETE_REPLY_TIMEOUT if negative
+             * @return the HCIStatusCode of each given device in the same order
+             */
+            std::vector<HCIStatusCode> le_del_from_white_list(const std::vector<BDAddressKey> & devices, const int32_t timeoutMS=-1);
+
+            /**
+             * Suggest the maximum LL PDU payload size and transmission time of an established LE connection.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.33 LE Set Data Length command
+             * </p>
+             * <p>
+             * Requires isLEDataLenExtSupported(), otherwise HCIStatusCode::UNSUPPORTED_FEATURE_OR_PARAM_VALUE is returned.
+             * </p>
+             * @param conn_handle the LE connection handle
+             * @param tx_octets maximum LL PDU payload in bytes, range [27..251], default 251
+             * @param tx_time maximum LL PDU transmission time in microseconds, range [328..17040], default 2120 for 251 bytes on 1M PHY
+             * @return HCIStatusCode::SUCCESS if the command has been completed, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode le_set_data_length(const uint16_t conn_handle, const uint16_t tx_octets=251, const uint16_t tx_time=2120);
+
+            /**
+             * Reads the current transmitter and receiver PHY of an established LE connection.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.47 LE Read PHY command
+             * </p>
+             * @param conn_handle the LE connection handle
+             * @param tx_phy the transmitter PHY, 1 for LE 1M, 2 for LE 2M and 3 for LE Coded
+             * @param rx_phy the receiver PHY, 1 for LE 1M, 2 for LE 2M and 3 for LE Coded
+             * @return HCIStatusCode::SUCCESS if the command has been completed, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode le_read_phy(const uint16_t conn_handle, uint8_t & tx_phy, uint8_t & rx_phy);
+
+            /**
+             * Request the preferred transmitter and receiver PHYs of an established LE connection.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.49 LE Set PHY command
+             * </p>
+             * <p>
+             * Only the command status is awaited, the PHY update procedure completes asynchronously
+             * and is reported via the LE PHY Update Complete event.
+             * </p>
+             * @param conn_handle the LE connection handle
+             * @param tx_phys bit mask of HCI_LE_SET_PHY_1M, HCI_LE_SET_PHY_2M and HCI_LE_SET_PHY_CODED
+             * @param rx_phys bit mask of HCI_LE_SET_PHY_1M, HCI_LE_SET_PHY_2M and HCI_LE_SET_PHY_CODED
+             * @return HCIStatusCode::SUCCESS if the command has been accepted, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode le_set_phy(const uint16_t conn_handle, const uint8_t tx_phys, const uint8_t rx_phys);
+
+            /**
+             * Reads the RSSI of an established connection.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.5.4 Read RSSI command
+             * </p>
+             * @param conn_handle the connection handle
+             * @param rssi the RSSI in dBm, 127 if not available
+             * @return HCIStatusCode::SUCCESS if the command has been completed, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode read_rssi(const uint16_t conn_handle, int8_t & rssi);
+
+            /**
+             * Reads the transmit power level of an established connection.
+             * <p>
+             * BT Core Spec v5.2: Vol 4, Part E HCI: 7.3.35 Read Transmit Power Level command
+             * </p>
+             * @param conn_handle the connection handle
+             * @param maxLevel if true reads the maximum, otherwise the current transmit power level
+             * @param tx_power the transmit power level in dBm, 127 if not available
+             * @return HCIStatusCode::SUCCESS if the command has been completed, otherwise HCIStatusCode may disclose reason for rejection.
+             */
+            HCIStatusCode read_tx_power_level(const uint16_t conn_handle, const bool maxLevel, int8_t & tx_power);
+
+            /**
+             * Reads the RSSI and optionally the current transmit power level of all tracked connections
+             * with a valid handle, returning one HCILinkQuality per connection.
+             * <p>
+             * All commands are pipelined via sendCommandAsync(), bound by the controller's command credit only,
+             * instead of one blocking round-trip per connection and value.
+             * Replies are matched by the connection handle they carry.
+             * </p>
+             * <p>
+             * Shall not be called on the HCI reader thread, e.g. from within a callback.
+             * </p>
+             * @param readTxPower if true, also reads the current transmit power level
+             * @param timeoutMS timeout for all replies, defaults to HCIEnv::HCI_COMMAND_COMPLETE_REPLY_TIMEOUT if negative
+             * @return the HCILinkQuality of each polled connection, entries w/o reply keep HCIStatusCode::INTERNAL_TIMEOUT
+             */
+            std::vector<HCILinkQuality> read_link_quality_all(const bool readTxPower=true, const int32_t timeoutMS=-1);
+
+            /**
+             * Sends the given HCICommand asynchronously w/o waiting for its reply.
+             * <p>
+             * Multiple commands may be outstanding up to the controller's Num_HCI_Command_Packets credit.
+             * If no credit is available, this method blocks until one is granted or timeoutMS has passed.
+             * </p>
+             * <p>
+             * The reply is matched by opcode and delivered to the given callback from the HCI reader thread.
+             * The callback receives nullptr if no reply has been received within timeoutMS.
+             * </p>
+             * @param req the HCICommand to send
+             * @param expectComplete if true, the command completes with CMD_COMPLETE and a successful CMD_STATUS is treated as pending,
+             *        otherwise the command completes with CMD_STATUS.
+             * @param cb the reply callback
+             * @param timeoutMS timeout for the credit and reply
+             * @return true if the command has been sent, otherwise false and the callback won't be invoked.
+             */
+            bool sendCommandAsync(HCICommand &req, const bool expectComplete, const HCICommandReplyCallback & cb, const int32_t timeoutMS);
+
             /** MgmtEventCallback handling  */
 
             /**
@@ -386,13 +1305,126 @@ namespace direct_bt {
             void addMgmtEventCallback(const MgmtEvent::Opcode opc, const MgmtEventCallback &cb);
             /** Returns count of removed given MgmtEventCallback from the named MgmtEvent::Opcode list. */
             int removeMgmtEventCallback(const MgmtEvent::Opcode opc, const MgmtEventCallback &cb);
+
+            /**
+             * Appends the given typed MgmtEventHandler to the E::getStaticOpcode() list,
+             * if it is not present already, see addMgmtEventCallback().
+             * <p>
+             * The handler receives the specialized event type E, mapped to its opcode at compile time.
+             * </p>
+             */
+            template<typename E>
+            void addMgmtEventHandler(const MgmtEventHandler<E> &handler) {
+                addMgmtEventCallback(E::getStaticOpcode(), bindMgmtEventHandler<E>(handler));
+            }
+            /** Returns count of removed given typed MgmtEventHandler from the E::getStaticOpcode() list. */
+            template<typename E>
+            int removeMgmtEventHandler(const MgmtEventHandler<E> &handler) {
+                return removeMgmtEventCallback(E::getStaticOpcode(), bindMgmtEventHandler<E>(handler));
+            }
             /** Removes all MgmtEventCallbacks from the to the named MgmtEvent::Opcode list. */
             void clearMgmtEventCallbacks(const MgmtEvent::Opcode opc);
             /** Removes all MgmtEventCallbacks from all MgmtEvent::Opcode lists. */
             void clearAllMgmtEventCallbacks();
 
             /** Manually send a MgmtEvent to all of its listeners. */
-            void sendMgmtEvent(std::shared_ptr<MgmtEvent> event);
+            void sendMgmtEvent(const std::shared_ptr<MgmtEvent> & event);
+
+            /** AdvertisingReportBatchCallback handling  */
+
+            /**
+             * Appends the given AdvertisingReportBatchCallback to the list, if it is not present already.
+             * <p>
+             * All EInfoReport of one LE_ADVERTISING_REPORT are passed within one invocation.
+             * The per report MgmtEvtDeviceFound is only produced for registered DEVICE_FOUND MgmtEventCallback.
+             * </p>
+             */
+            void addAdvertisingReportBatchCallback(const AdvertisingReportBatchCallback &cb);
+            /** Returns count of removed given AdvertisingReportBatchCallback from the list */
+            int removeAdvertisingReportBatchCallback(const AdvertisingReportBatchCallback &cb);
+            /** Removes all AdvertisingReportBatchCallback from the list */
+            void clearAdvertisingReportBatchCallbacks();
+
+            /** BeaconRecordCallback handling  */
+
+            /**
+             * Appends the given BeaconRecordCallback to the list, if it is not present already, see setBeaconMatcher().
+             */
+            void addBeaconRecordCallback(const BeaconRecordCallback &cb);
+            /** Returns count of removed given BeaconRecordCallback from the list */
+            int removeBeaconRecordCallback(const BeaconRecordCallback &cb);
+            /** Removes all BeaconRecordCallback from the list */
+            void clearBeaconRecordCallbacks();
+
+            /** L2CAPFrameCallback handling  */
+
+            /**
+             * Returns true if HCI ACL data is demultiplexed within the HCI reader thread,
+             * see HCIEnv::HCI_ACL_DEMUX.
+             */
+            bool isACLDemuxEnabled() const { return aclDemux; }
+
+            /**
+             * Sets the L2CAPFrameCallback for the given connection handle and L2CAP channel id,
+             * replacing a previously set one. A reassembly buffer for L2CAP frames
+             * of up to maxPayloadSize is preallocated once.
+             * <p>
+             * Only L2CAP frames received from the controller are delivered.
+             * </p>
+             * @return false if ACL data demultiplexing is disabled, see isACLDemuxEnabled(), otherwise true
+             */
+            bool setL2CAPFrameCallback(const uint16_t handle, const uint16_t cid, const int maxPayloadSize, const L2CAPFrameCallback &cb);
+            /** Returns true if the L2CAPFrameCallback of the given connection handle has been removed */
+            bool removeL2CAPFrameCallback(const uint16_t handle);
+            /** Removes all L2CAPFrameCallback */
+            void clearL2CAPFrameCallbacks();
+
+            /**
+             * Hands over reading from the internal reader thread to the application's external event loop,
+             * which shall poll getFD() for readability and call processReadable() and processTimeouts() on its own thread.
+             * <p>
+             * Requires HCIEnv::HCI_READER_EXTERNAL, blocks until the reader thread has ended,
+             * i.e. up to Defaults::EXTERNAL_HANDOVER_TIMEOUT.
+             * </p>
+             * <p>
+             * Blocking commands like sendWithCmdCompleteReply() still wait for their reply on the calling thread,
+             * hence shall not be issued by the external event loop.
+             * </p>
+             * @return true if reading is driven externally, otherwise false
+             */
+            bool attachExternalReader();
+
+            /** Returns true if reading has been handed over to the external event loop, see attachExternalReader(). */
+            bool isExternalReader() const { return hciReaderExternal; }
+
+            /** Returns the descriptor readable if HCI packets are pending, i.e. the HCI socket or its io_uring, see HCIComm::poll_dd(). */
+            int getFD() const { return comm.poll_dd(); }
+
+            /**
+             * Reads and dispatches all pending HCI packets on the calling thread, see attachExternalReader().
+             * <p>
+             * Shall be called by one thread at a time if getFD() is readable, returns immediately otherwise.
+             * </p>
+             * @return number of dispatched packets, or -1 on error or if not attached, in which case the external event loop shall remove getFD().
+             */
+            int processReadable();
+
+            /**
+             * Expires all timed out asynchronous commands on the calling thread, see attachExternalReader() and sendCommandAsync().
+             * @return milliseconds until the next pending command expires, or -1 if none is pending.
+             */
+            int32_t processTimeouts();
+
+            /**
+             * Copies the link level TrafficStats of the tracked connection to the given device into res.
+             * <p>
+             * Counting requires ACL data demultiplexing to be active, see setL2CAPFrameCallback().
+             * ATT PDUs and their bytes are counted by their first ACL fragment's L2CAP header.
+             * Retries, timeouts and round-trip times are only counted by GATTHandler::getTrafficStats().
+             * </p>
+             * @return true if a connection is tracked, otherwise false
+             */
+            bool getTrafficSnapshot(const EUI48 & address, const BDAddressType addressType, TrafficSnapshot & res);
 
             /**
              * FIXME / TODO: Privacy Mode / Pairing / Bonding
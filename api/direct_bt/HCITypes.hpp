@@ -28,7 +28,11 @@
 
 #include <cstring>
 #include <string>
+#include <memory>
 #include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 
 #include <mutex>
 
@@ -180,6 +184,8 @@ namespace direct_bt {
         SCO_HDR_SIZE      = 1+3,
         /** HCIPacketType::EVENT header size including HCIPacketType */
         EVENT_HDR_SIZE    = 1+2,
+        /** L2CAP basic frame header size within HCIPacketType::ACLDATA, i.e. length and channel id */
+        L2CAP_BASIC_HDR_SIZE = 4,
         /** Total packet size, guaranteed to be handled by adapter. */
         PACKET_MAX_SIZE   = 255
     };
@@ -318,7 +324,9 @@ namespace direct_bt {
         DISCONNECT                  = 0x0406,
         SET_EVENT_MASK              = 0x0C01,/**< SET_EVENT_MASK */
         RESET                       = 0x0C03,
+        READ_TX_POWER               = 0x0C2D,
         READ_LOCAL_VERSION          = 0x1001,
+        READ_RSSI                   = 0x1405,
         LE_SET_EVENT_MASK           = 0x2001,/**< LE_SET_EVENT_MASK */
         LE_READ_BUFFER_SIZE         = 0x2002,
         LE_READ_LOCAL_FEATURES      = 0x2003,
@@ -338,7 +346,27 @@ namespace direct_bt {
         LE_DEL_FROM_WHITE_LIST      = 0x2012,
         LE_CONN_UPDATE              = 0x2013,
         LE_READ_REMOTE_FEATURES     = 0x2016,
-        LE_START_ENC                = 0x2019
+        LE_START_ENC                = 0x2019,
+        LE_SET_DATA_LEN             = 0x2022,
+        LE_READ_RESOLV_LIST_SIZE    = 0x202a,
+        LE_READ_MAX_DATA_LEN        = 0x202f,
+        LE_READ_PHY                 = 0x2030,
+        LE_SET_DEFAULT_PHY          = 0x2031,
+        LE_SET_PHY                  = 0x2032,
+        LE_SET_ADV_SET_RANDOM_ADDR  = 0x2035,
+        LE_SET_EXT_ADV_PARAMS       = 0x2036,
+        LE_SET_EXT_ADV_DATA         = 0x2037,
+        LE_SET_EXT_SCAN_RSP_DATA    = 0x2038,
+        LE_SET_EXT_ADV_ENABLE       = 0x2039,
+        LE_READ_MAX_ADV_DATA_LEN    = 0x203a,
+        LE_READ_NUM_SUPPORTED_ADV_SETS = 0x203b,
+        LE_REMOVE_ADV_SET           = 0x203c,
+        LE_CLEAR_ADV_SETS           = 0x203d,
+        LE_SET_EXT_SCAN_PARAMS      = 0x2041,
+        LE_SET_EXT_SCAN_ENABLE      = 0x2042,
+        LE_PERIODIC_ADV_CREATE_SYNC = 0x2044,
+        LE_PERIODIC_ADV_CREATE_SYNC_CANCEL = 0x2045,
+        LE_PERIODIC_ADV_TERMINATE_SYNC = 0x2046
         // etc etc - incomplete
     };
     inline uint16_t number(const HCIOpcode rhs) {
@@ -372,7 +400,29 @@ namespace direct_bt {
         LE_DEL_FROM_WHITE_LIST      = 36,
         LE_CONN_UPDATE              = 37,
         LE_READ_REMOTE_FEATURES     = 38,
-        LE_START_ENC                = 39
+        LE_START_ENC                = 39,
+        LE_SET_DATA_LEN             = 40,
+        LE_READ_PHY                 = 41,
+        LE_SET_DEFAULT_PHY          = 42,
+        LE_SET_PHY                  = 43,
+        LE_SET_EXT_SCAN_PARAMS      = 44,
+        LE_SET_EXT_SCAN_ENABLE      = 45,
+        LE_SET_ADV_SET_RANDOM_ADDR  = 46,
+        LE_SET_EXT_ADV_PARAMS       = 47,
+        LE_SET_EXT_ADV_DATA         = 48,
+        LE_SET_EXT_SCAN_RSP_DATA    = 49,
+        LE_SET_EXT_ADV_ENABLE       = 50,
+        LE_READ_MAX_ADV_DATA_LEN    = 51,
+        LE_READ_NUM_SUPPORTED_ADV_SETS = 52,
+        LE_REMOVE_ADV_SET           = 53,
+        LE_CLEAR_ADV_SETS           = 54,
+        LE_PERIODIC_ADV_CREATE_SYNC = 55,
+        LE_PERIODIC_ADV_CREATE_SYNC_CANCEL = 56,
+        LE_PERIODIC_ADV_TERMINATE_SYNC = 57,
+        READ_TX_POWER               = 58,
+        READ_RSSI                   = 59,
+        LE_READ_RESOLV_LIST_SIZE    = 60,
+        LE_READ_MAX_DATA_LEN        = 61
         // etc etc - incomplete
     };
     inline uint8_t number(const HCIOpcodeBit rhs) {
@@ -393,7 +443,8 @@ namespace direct_bt {
     class HCIPacket
     {
         protected:
-            POctets pdu;
+            /** Inline storage up to HCIConstU8::PACKET_MAX_SIZE, i.e. no heap allocation. */
+            SOctets<static_cast<int>(HCIConstU8::PACKET_MAX_SIZE)> pdu;
 
             inline static void checkPacketType(const HCIPacketType type) {
                 switch(type) {
@@ -409,8 +460,24 @@ namespace direct_bt {
                 }
             }
 
+            /**
+             * Re-initializes this packet with a copy of the given packet data,
+             * reusing the persistent memory if its capacity permits.
+             */
+            void reset(const uint8_t *packet_data, const uint8_t total_packet_size) {
+                if( pdu.getCapacity() < total_packet_size ) {
+                    pdu.resize(total_packet_size, number(HCIConstU8::PACKET_MAX_SIZE));
+                } else {
+                    pdu.resize(total_packet_size);
+                }
+                if( total_packet_size > 0 ) {
+                    memcpy(pdu.get_wptr(), packet_data, total_packet_size);
+                }
+                checkPacketType(getPacketType());
+            }
+
         public:
-            HCIPacket(const HCIPacketType type, const uint8_t total_packet_size)
+            HCIPacket(const HCIPacketType type, const uint16_t total_packet_size)
             : pdu(total_packet_size)
             {
                 pdu.put_uint8 (0, number(type));
@@ -461,8 +528,12 @@ namespace direct_bt {
             }
             virtual std::string valueString() const {
                 const int psz = getParamSize();
-                const std::string ps = psz > 0 ? bytesHexString(getParam(), 0, psz, true /* lsbFirst */, true /* leading0X */) : "";
-                return "param[size "+std::to_string(getParamSize())+", data "+ps+"], tsz "+std::to_string(getTotalSize());
+                std::string res("param[size "+std::to_string(psz)+", data ");
+                if( psz > 0 ) {
+                    appendBytesHexString(res, getParam(), 0, psz, true /* lsbFirst */, true /* leading0X */);
+                }
+                res.append("], tsz "+std::to_string(getTotalSize()));
+                return res;
             }
 
         public:
@@ -471,7 +542,7 @@ namespace direct_bt {
             HCICommand(const HCIOpcode opc, const uint8_t param_size)
             : HCIPacket(HCIPacketType::COMMAND, number(HCIConstU8::COMMAND_HDR_SIZE)+param_size)
             {
-                checkOpcode(opc, HCIOpcode::SPECIAL, HCIOpcode::LE_START_ENC);
+                checkOpcode(opc, HCIOpcode::SPECIAL, HCIOpcode::LE_PERIODIC_ADV_TERMINATE_SYNC);
 
                 pdu.put_uint16(1, static_cast<uint16_t>(opc));
                 pdu.put_uint8(3, param_size);
@@ -517,6 +588,159 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.64 LE Set Extended Scan Parameters command
+     * <pre>
+        Size 3 + 5 * number of PHYs
+        __u8     own_addr_type;
+        __u8     filter_policy;
+        __u8     scanning_phys;
+        struct {
+            __u8     type;
+            __le16   interval;
+            __le16   window;
+        } phy_params[number of PHYs];
+     * </pre>
+     * The same scan parameter are used for all given scanning PHYs.
+     */
+    class HCILESetExtScanParamsCmd : public HCICommand
+    {
+        public:
+            /** Returns the number of PHYs set in the given scanning_phys bit mask */
+            static int getPHYCount(const uint8_t scanning_phys) {
+                int count = 0;
+                for(int i=0; i<8; i++) {
+                    if( 0 != ( scanning_phys & ( 1 << i ) ) ) {
+                        count++;
+                    }
+                }
+                return count;
+            }
+
+            HCILESetExtScanParamsCmd(const uint8_t own_addr_type, const uint8_t filter_policy, const uint8_t scanning_phys,
+                                     const uint8_t scan_type, const uint16_t interval, const uint16_t window)
+            : HCICommand(HCIOpcode::LE_SET_EXT_SCAN_PARAMS, 3 + 5 * getPHYCount(scanning_phys))
+            {
+                const int base = number(HCIConstU8::COMMAND_HDR_SIZE);
+                pdu.put_uint8(base, own_addr_type);
+                pdu.put_uint8(base+1, filter_policy);
+                pdu.put_uint8(base+2, scanning_phys);
+                const int phy_count = getPHYCount(scanning_phys);
+                for(int i=0; i<phy_count; i++) {
+                    const int o = base + 3 + 5 * i;
+                    pdu.put_uint8(o, scan_type);
+                    pdu.put_uint16(o+1, interval);
+                    pdu.put_uint16(o+3, window);
+                }
+            }
+    };
+
+    /**
+     * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.54 LE Set Extended Advertising Data command
+     * <p>
+     * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.55 LE Set Extended Scan Response Data command
+     * </p>
+     * <pre>
+        Size 4 + length
+        __u8     handle;
+        __u8     operation;
+        __u8     frag_pref;
+        __u8     length;
+        __u8     data[length];
+     * </pre>
+     * Unlike hci_cp_le_set_ext_adv_data, the command carries up to MAX_DATA_LEN octets of one fragment.
+     */
+    class HCILESetExtAdvDataCmd : public HCICommand
+    {
+        public:
+            /** Maximum data length of one command */
+            static constexpr int MAX_DATA_LEN = 251;
+
+            /** Operation: intermediate fragment */
+            static constexpr uint8_t OP_INTERMEDIATE = 0x00;
+            /** Operation: first fragment */
+            static constexpr uint8_t OP_FIRST = 0x01;
+            /** Operation: last fragment */
+            static constexpr uint8_t OP_LAST = 0x02;
+            /** Operation: complete data, the only one allowed while the set is enabled */
+            static constexpr uint8_t OP_COMPLETE = 0x03;
+            /** Operation: unchanged data, only updating the advertising DID */
+            static constexpr uint8_t OP_UNCHANGED = 0x04;
+
+            /** Fragment preference: the controller may fragment all data */
+            static constexpr uint8_t FRAG_ALLOWED = 0x00;
+            /** Fragment preference: the controller should not fragment or should minimize fragmentation */
+            static constexpr uint8_t FRAG_MINIMIZE = 0x01;
+
+            /**
+             * @param scanRsp if true LE_SET_EXT_SCAN_RSP_DATA, otherwise LE_SET_EXT_ADV_DATA
+             * @param handle the advertising set handle
+             * @param operation one of the OP_ values
+             * @param frag_pref FRAG_ALLOWED or FRAG_MINIMIZE
+             * @param data the fragment of given length, copied
+             * @param length the fragment length, shall not exceed MAX_DATA_LEN
+             */
+            HCILESetExtAdvDataCmd(const bool scanRsp, const uint8_t handle, const uint8_t operation, const uint8_t frag_pref,
+                                  const uint8_t * data, const int length)
+            : HCICommand(scanRsp ? HCIOpcode::LE_SET_EXT_SCAN_RSP_DATA : HCIOpcode::LE_SET_EXT_ADV_DATA,
+                         static_cast<uint8_t>( 4 + std::min(std::max(0, length), MAX_DATA_LEN) ))
+            {
+                if( 0 > length || MAX_DATA_LEN < length ) {
+                    throw IllegalArgumentException("Data length "+std::to_string(length)+" not within [0.."+
+                                                   std::to_string(MAX_DATA_LEN)+"]", E_FILE_LINE);
+                }
+                const int base = number(HCIConstU8::COMMAND_HDR_SIZE);
+                pdu.put_uint8(base, handle);
+                pdu.put_uint8(base+1, operation);
+                pdu.put_uint8(base+2, frag_pref);
+                pdu.put_uint8(base+3, static_cast<uint8_t>(length));
+                if( 0 < length ) {
+                    memcpy(pdu.get_wptr(base+4), data, length);
+                }
+            }
+    };
+
+    /**
+     * BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.56 LE Set Extended Advertising Enable command
+     * <pre>
+        Size 2 + 4 * num_of_sets
+        __u8     enable;
+        __u8     num_of_sets;
+        struct {
+            __u8     handle;
+            __le16   duration;
+            __u8     max_events;
+        } sets[num_of_sets];
+     * </pre>
+     * Disabling w/o any set disables all sets.
+     */
+    class HCILESetExtAdvEnableCmd : public HCICommand
+    {
+        public:
+            /** One advertising set to enable or disable */
+            struct Set {
+                uint8_t handle;
+                /** Duration in units of 10ms, zero to advertise until disabled */
+                uint16_t duration;
+                /** Maximum number of extended advertising events, zero for no limit */
+                uint8_t max_events;
+            };
+
+            HCILESetExtAdvEnableCmd(const bool enable, const Set * sets, const int count)
+            : HCICommand(HCIOpcode::LE_SET_EXT_ADV_ENABLE, static_cast<uint8_t>( 2 + 4 * count ))
+            {
+                const int base = number(HCIConstU8::COMMAND_HDR_SIZE);
+                pdu.put_uint8(base, enable ? 0x01 : 0x00);
+                pdu.put_uint8(base+1, static_cast<uint8_t>(count));
+                for(int i=0; i<count; i++) {
+                    const int o = base + 2 + 4 * i;
+                    pdu.put_uint8(o, sets[i].handle);
+                    pdu.put_uint16(o+1, sets[i].duration);
+                    pdu.put_uint8(o+3, sets[i].max_events);
+                }
+            }
+    };
+
     /**
      * Generic HCICommand wrapper for any HCI IOCTL structure
      * @tparam hcistruct the template typename, e.g. 'hci_cp_create_conn' for 'struct hci_cp_create_conn'
@@ -555,6 +779,9 @@ namespace direct_bt {
     class HCIEvent : public HCIPacket
     {
         protected:
+            /** creation or kernel receive timestamp in nanoseconds, see getCurrentNanoseconds() */
+            uint64_t ts_creation_ns;
+            /** creation or kernel receive timestamp in milliseconds, derived from ts_creation_ns */
             uint64_t ts_creation;
 
             inline static void checkEventType(const HCIEventType has, const HCIEventType min, const HCIEventType max)
@@ -579,12 +806,31 @@ namespace direct_bt {
             virtual std::string valueString() const {
                 const int d_sz_base = getBaseParamSize();
                 const int d_sz = getParamSize();
-                const std::string d_str = d_sz > 0 ? bytesHexString(getParam(), 0, d_sz, true /* lsbFirst */, true /* leading0X */) : "";
-                return "data[size "+std::to_string(d_sz)+"/"+std::to_string(d_sz_base)+", data "+d_str+"], tsz "+std::to_string(getTotalSize());
+                std::string res("data[size "+std::to_string(d_sz)+"/"+std::to_string(d_sz_base)+", data ");
+                if( d_sz > 0 ) {
+                    appendBytesHexString(res, getParam(), 0, d_sz, true /* lsbFirst */, true /* leading0X */);
+                }
+                res.append("], tsz "+std::to_string(getTotalSize()));
+                return res;
             }
 
             uint8_t getBaseParamSize() const { return pdu.get_uint8(2); }
 
+            friend class HCIEventPool;
+
+            /**
+             * Re-initializes this instance with the given packet data for recycling, see HCIEventPool.
+             * <p>
+             * Specializations shall perform their constructor's validation.
+             * </p>
+             */
+            virtual void reset(const uint8_t* buffer, const int buffer_len) {
+                HCIPacket::reset(buffer, buffer_len);
+                setTimestampNS( getCurrentNanoseconds() );
+                checkEventType(getEventType(), HCIEventType::INQUIRY_COMPLETE, HCIEventType::AMP_Receiver_Report);
+                pdu.check_range(0, number(HCIConstU8::EVENT_HDR_SIZE)+getBaseParamSize());
+            }
+
         public:
 
             /**
@@ -597,7 +843,7 @@ namespace direct_bt {
 
             /** Persistent memory, w/ ownership ..*/
             HCIEvent(const uint8_t* buffer, const int buffer_len)
-            : HCIPacket(buffer, buffer_len), ts_creation(getCurrentMilliseconds())
+            : HCIPacket(buffer, buffer_len), ts_creation_ns(getCurrentNanoseconds()), ts_creation(ts_creation_ns / 1000000)
             {
                 checkEventType(getEventType(), HCIEventType::INQUIRY_COMPLETE, HCIEventType::AMP_Receiver_Report);
                 pdu.check_range(0, number(HCIConstU8::EVENT_HDR_SIZE)+getBaseParamSize());
@@ -605,7 +851,8 @@ namespace direct_bt {
 
             /** Enabling manual construction of event without given value.  */
             HCIEvent(const HCIEventType evt, const uint16_t param_size=0)
-            : HCIPacket(HCIPacketType::EVENT, number(HCIConstU8::EVENT_HDR_SIZE)+param_size), ts_creation(getCurrentMilliseconds())
+            : HCIPacket(HCIPacketType::EVENT, number(HCIConstU8::EVENT_HDR_SIZE)+param_size),
+              ts_creation_ns(getCurrentNanoseconds()), ts_creation(ts_creation_ns / 1000000)
             {
                 checkEventType(evt, HCIEventType::INQUIRY_COMPLETE, HCIEventType::AMP_Receiver_Report);
                 pdu.put_uint8(1, number(evt));
@@ -623,7 +870,12 @@ namespace direct_bt {
 
             virtual ~HCIEvent() {}
 
+            /** Returns the monotonic timestamp in milliseconds, see getCurrentMilliseconds(). */
             uint64_t getTimestamp() const { return ts_creation; }
+            /** Returns the monotonic timestamp in nanoseconds, see getCurrentNanoseconds(). */
+            uint64_t getTimestampNS() const { return ts_creation_ns; }
+            /** Sets the monotonic timestamp in nanoseconds, e.g. the kernel receive timestamp, also updating getTimestamp(). */
+            void setTimestampNS(const uint64_t ns) { ts_creation_ns = ns; ts_creation = ns / 1000000; }
 
             HCIEventType getEventType() const { return static_cast<HCIEventType>( pdu.get_uint8(1) ); }
             std::string getEventTypeString() const { return getHCIEventTypeString(getEventType()); }
@@ -701,6 +953,12 @@ namespace direct_bt {
                         ", reason "+uint8HexString(static_cast<uint8_t>(getReason()), true)+" "+getHCIStatusCodeString(getReason());
             }
 
+            void reset(const uint8_t* buffer, const int buffer_len) override {
+                HCIEvent::reset(buffer, buffer_len);
+                checkEventType(getEventType(), HCIEventType::DISCONN_COMPLETE);
+                pdu.check_range(0, number(HCIConstU8::EVENT_HDR_SIZE)+4);
+            }
+
         public:
             HCIDisconnectionCompleteEvent(const uint8_t* buffer, const int buffer_len)
             : HCIEvent(buffer, buffer_len)
@@ -736,6 +994,12 @@ namespace direct_bt {
                         ", ncmd "+std::to_string(getNumCommandPackets());
             }
 
+            void reset(const uint8_t* buffer, const int buffer_len) override {
+                HCIEvent::reset(buffer, buffer_len);
+                checkEventType(getEventType(), HCIEventType::CMD_COMPLETE);
+                pdu.check_range(0, number(HCIConstU8::EVENT_HDR_SIZE)+3);
+            }
+
         public:
             HCICommandCompleteEvent(const uint8_t* buffer, const int buffer_len)
             : HCIEvent(buffer, buffer_len)
@@ -772,6 +1036,62 @@ namespace direct_bt {
             }
     };
 
+    /**
+     * Typed copy of a HCICommandCompleteEvent's return parameter,
+     * i.e. a HCI IOCTL 'command complete' reply struct having a HCIStatusCode uint8_t status field.
+     * <p>
+     * The reply struct is held by value in this fixed-size instance, e.g. on the caller's stack.
+     * Hence the pooled HCIEvent can be released right after set() instead of being kept alive by the caller,
+     * rendering synchronous command sequences allocation free.
+     * </p>
+     * <p>
+     * The reply struct size is validated against the maximum return parameter size at compile time
+     * and against the received return parameter size at runtime.
+     * </p>
+     * @tparam hcistruct the template typename, e.g. 'hci_rp_read_rssi' for 'struct hci_rp_read_rssi'
+     */
+    template<typename hcistruct>
+    class HCIReplyView
+    {
+        static_assert(std::is_trivially_copyable<hcistruct>::value, "hcistruct must be trivially copyable");
+        static_assert(1 == sizeof(hcistruct::status), "hcistruct must have a uint8_t status field");
+        static_assert(sizeof(hcistruct) <= static_cast<uint8_t>(HCIConstU8::PACKET_MAX_SIZE) - static_cast<uint8_t>(HCIConstU8::EVENT_HDR_SIZE) - 3,
+                      "hcistruct exceeds the maximum HCICommandCompleteEvent return parameter size");
+
+        private:
+            hcistruct data;
+            bool valid;
+
+        public:
+            HCIReplyView() : valid(false) {
+                std::memset(&data, 0, sizeof(data));
+            }
+
+            /** Invalidates this instance. */
+            void clear() { valid = false; }
+
+            /**
+             * Copies the return parameter of the given HCICommandCompleteEvent.
+             * @return false and invalidating this instance if the return parameter is undersized, otherwise true
+             */
+            bool set(const HCICommandCompleteEvent & ev) {
+                valid = ev.getReturnParamSize() >= sizeof(hcistruct);
+                if( valid ) {
+                    std::memcpy(&data, ev.getReturnParam(), sizeof(hcistruct));
+                }
+                return valid;
+            }
+
+            bool isValid() const { return valid; }
+
+            /** Returns the reply's status if valid, otherwise HCIStatusCode::INTERNAL_FAILURE. */
+            HCIStatusCode getStatus() const { return valid ? static_cast<HCIStatusCode>( data.status ) : HCIStatusCode::INTERNAL_FAILURE; }
+
+            /** Returns the reply struct, only meaningful if isValid(). */
+            const hcistruct & get() const { return data; }
+            const hcistruct * operator->() const { return &data; }
+    };
+
     /**
      * BT Core Spec v5.2: Vol 4, Part E HCI: 7.7.15 Command Status event
      * <p>
@@ -791,6 +1111,12 @@ namespace direct_bt {
                         ", status "+uint8HexString(static_cast<uint8_t>(getStatus()), true)+" "+getHCIStatusCodeString(getStatus());
             }
 
+            void reset(const uint8_t* buffer, const int buffer_len) override {
+                HCIEvent::reset(buffer, buffer_len);
+                checkEventType(getEventType(), HCIEventType::CMD_STATUS);
+                pdu.check_range(0, number(HCIConstU8::EVENT_HDR_SIZE)+4);
+            }
+
         public:
             HCICommandStatusEvent(const uint8_t* buffer, const int buffer_len)
             : HCIEvent(buffer, buffer_len)
@@ -841,6 +1167,11 @@ namespace direct_bt {
                 return "event="+uint8HexString(number(getMetaEventType()))+" "+getMetaEventTypeString()+" (le-meta)";
             }
 
+            void reset(const uint8_t* buffer, const int buffer_len) override {
+                HCIEvent::reset(buffer, buffer_len);
+                checkEventType(getEventType(), HCIEventType::LE_META);
+            }
+
         public:
             /** Passing through preset buffer of this type */
             HCIMetaEvent(const uint8_t* buffer, const int buffer_len)
@@ -906,6 +1237,129 @@ namespace direct_bt {
             hcistruct * getWStruct() { return (hcistruct *)( pdu.get_wptr(number(HCIConstU8::EVENT_HDR_SIZE)+1) ); }
     };
 
+    /**
+     * Fixed capacity pool of recycled specialized HCIEvent instances,
+     * see HCIEvent::getSpecialized().
+     * <p>
+     * An instance is only being recycled if its shared reference is no more used outside of this pool,
+     * hence a steady state HCI reader thread does not allocate memory for its received events.
+     * The pool falls back to a non pooled instance if exhausted.
+     * </p>
+     * <p>
+     * Not thread safe, i.e. getSpecialized() shall only be called from one thread, the HCI reader.
+     * The returned references can be passed to and released by any thread.
+     * </p>
+     */
+    class HCIEventPool {
+        private:
+            enum Kind : int {
+                GENERIC = 0, DISCONN_COMPLETE = 1, CMD_COMPLETE = 2, CMD_STATUS = 3, LE_META = 4, COUNT = 5
+            };
+            const int capacity;
+            std::vector<std::shared_ptr<HCIEvent>> pool[Kind::COUNT];
+            int nextIdx[Kind::COUNT];
+            int allocCount;
+            int fallbackCount;
+
+            template<typename T>
+            std::shared_ptr<HCIEvent> acquire(const Kind kind, const uint8_t * buffer, int const buffer_size);
+
+        public:
+            /**
+             * @param capacity maximum number of recycled instances per specialized HCIEvent type
+             */
+            HCIEventPool(const int capacity);
+
+            HCIEventPool(const HCIEventPool&) = delete;
+            void operator=(const HCIEventPool&) = delete;
+
+            /**
+             * Return a recycled or newly pooled specialized instance like HCIEvent::getSpecialized(),
+             * or nullptr if buffer is not an event.
+             */
+            std::shared_ptr<HCIEvent> getSpecialized(const uint8_t * buffer, int const buffer_size);
+
+            int getCapacity() const { return capacity; }
+
+            /** Returns the number of pooled instances allocated so far */
+            int getAllocCount() const { return allocCount; }
+
+            /** Returns the number of non pooled instances allocated due to exhaustion */
+            int getFallbackCount() const { return fallbackCount; }
+
+            std::string toString() const {
+                return "HCIEventPool[capacity "+std::to_string(capacity)+", allocated "+std::to_string(allocCount)+
+                       ", fallback "+std::to_string(fallbackCount)+"]";
+            }
+    };
+
+    /**
+     * Direct mapped cache of recently received advertising reports,
+     * suppressing unchanged advertising data before it gets parsed.
+     * <p>
+     * Entries are keyed by address, address type and AD PDU type,
+     * each holding a hash of the raw AD payload, the last delivered RSSI and the time of the last full report.
+     * </p>
+     * <p>
+     * Not thread safe, to be used by the HCI reader thread only.
+     * </p>
+     */
+    class HCIAdvDedupCache
+    {
+        public:
+            enum class Result : uint8_t {
+                /** New or changed advertising data or expired entry, report shall be parsed completely. */
+                NEW,
+                /** Unchanged advertising data with RSSI changed by at least the threshold, RSSI-only update. */
+                RSSI_UPDATE,
+                /** Unchanged advertising data and RSSI, report shall be dropped. */
+                DUPLICATE
+            };
+
+        private:
+            struct Entry {
+                EUI48 address;
+                uint8_t addressType;
+                uint8_t evtType;
+                bool valid;
+                int8_t rssi;
+                uint32_t adHash;
+                uint64_t timestamp;
+            };
+            std::vector<Entry> entries;
+            const int32_t windowMS;
+            const int rssiDelta;
+            uint64_t dropCount;
+            uint64_t rssiUpdateCount;
+
+        public:
+            /**
+             * @param capacity number of cached advertisers
+             * @param windowMS maximum age of a full report before the next one is parsed again, zero disables the cache
+             * @param rssiDelta minimum RSSI change in dBm causing an RSSI-only update
+             */
+            HCIAdvDedupCache(const int capacity, const int32_t windowMS, const int rssiDelta);
+
+            bool isEnabled() const { return 0 < windowMS && entries.size() > 0; }
+
+            /**
+             * Returns how the given raw advertising report shall be handled and updates the cache accordingly.
+             */
+            Result check(const EUI48 & address, const uint8_t addressType, const uint8_t evtType,
+                         const uint8_t * ad_data, const int ad_data_len, const int8_t rssi, const uint64_t timestamp);
+
+            void clear();
+
+            uint64_t getDropCount() const { return dropCount; }
+            uint64_t getRSSIUpdateCount() const { return rssiUpdateCount; }
+
+            std::string toString() const {
+                return "HCIAdvDedupCache[capacity "+std::to_string(entries.size())+", window "+std::to_string(windowMS)+
+                       "ms, rssi-delta "+std::to_string(rssiDelta)+", dropped "+std::to_string(dropCount)+
+                       ", rssi-updates "+std::to_string(rssiUpdateCount)+"]";
+            }
+    };
+
 } // namespace direct_bt
 
 #endif /* HCI_TYPES_HPP_ */
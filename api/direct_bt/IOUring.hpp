@@ -0,0 +1,171 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef IO_URING_HPP_
+#define IO_URING_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+struct msghdr;
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace direct_bt {
+
+    /**
+     * io_uring based packet receiver of one socket,
+     * an alternative to the poll() and recvmmsg() reading of HCIComm and L2CAPComm.
+     * <p>
+     * One multishot recvmsg request stays armed at the socket, where the kernel
+     * stores each received packet into a buffer taken from a registered provided buffer ring.
+     * Completed packets are taken from the shared completion ring w/o any system call,
+     * i.e. a system call is only required to wait for packets if none is pending.
+     * </p>
+     * <p>
+     * Requires Linux 6.0 or later, see isSupported(),
+     * and is enabled for HCIComm and L2CAPComm via the property 'direct_bt.io_uring', see isEnabled().
+     * </p>
+     * <p>
+     * Shall be used by one reader thread, only cancel() may be called by another thread.
+     * The packets are copied from the kernel buffers into the caller's buffers,
+     * hence the existing read APIs are retained.
+     * </p>
+     */
+    class IOUringReceiver {
+        public:
+            enum Defaults : int32_t {
+                /** Number of provided kernel buffers, i.e. maximum number of pending received packets. */
+                BUFFER_COUNT = 128
+            };
+
+        private:
+            const int sockFD;
+            const int payloadSize;
+            const int controlSize;
+            const int slotSize;
+            int ringFD;
+
+            void * sqRing;
+            size_t sqRingSize;
+            void * cqRing;
+            size_t cqRingSize;
+            struct io_uring_sqe * sqes;
+            size_t sqesSize;
+            unsigned * sqTail;
+            unsigned * sqMask;
+            unsigned * sqArray;
+            unsigned * cqHead;
+            unsigned * cqTail;
+            unsigned * cqMask;
+            struct io_uring_cqe * cqes;
+
+            struct io_uring_buf_ring * bufRing;
+            size_t bufRingSize;
+            uint8_t * bufPool;
+            uint16_t bufTail;
+
+            std::unique_ptr<struct msghdr> msgTemplate;
+            std::mutex mtx_submit;
+            bool armed;
+            bool eof;
+            std::atomic<bool> cancelled;
+
+            IOUringReceiver(const int sockFD, const int payloadSize, const int controlSize);
+
+            bool setup();
+            bool submit(const uint8_t opcode, const uint64_t userData);
+            void recycle(const uint16_t bid);
+
+        public:
+            /**
+             * Returns true if the running kernel supports io_uring multishot recvmsg w/ provided buffer rings,
+             * probed once by receiving a packet over a socketpair.
+             */
+            static bool isSupported();
+
+            /**
+             * Returns true if enabled via the property 'direct_bt.io_uring', defaults to false,
+             * and isSupported().
+             */
+            static bool isEnabled();
+
+            /**
+             * Returns a new armed receiver of the given socket, or nullptr if io_uring is not available.
+             * @param sockFD the packet socket, not owned by the receiver
+             * @param payloadSize maximum packet size, larger packets are truncated
+             * @param controlSize maximum size of the received control messages, may be zero
+             */
+            static std::unique_ptr<IOUringReceiver> create(const int sockFD, const int payloadSize, const int controlSize);
+
+            IOUringReceiver(const IOUringReceiver&) = delete;
+            void operator=(const IOUringReceiver&) = delete;
+
+            /** Releases the ring and its buffers, the socket shall be closed or cancel() been called before. */
+            ~IOUringReceiver();
+
+            /** Returns the io_uring descriptor, readable while a received packet is pending. */
+            int getFD() const { return ringFD; }
+
+            /** Returns the socket descriptor. */
+            int getSocketFD() const { return sockFD; }
+
+            /** Returns the maximum size of the received control messages of each packet. */
+            int getControlSize() const { return controlSize; }
+
+            /**
+             * Batch receive of pending packets, taking all pending packets up to the given count w/o a system call.
+             * <p>
+             * After the socket reached end of file, a zero length packet is returned on each call.
+             * </p>
+             * @param buffers count consecutive buffers of buffer_capacity each, one packet per buffer
+             * @param buffer_capacity capacity of each buffer, larger packets are truncated
+             * @param lengths receiving the length of each received packet
+             * @param count maximum number of packets to receive
+             * @param timeoutMS timeout waiting for the first packet, zero to wait w/o timeout
+             * @param controls optional count consecutive buffers of getControlSize() each, receiving the control messages of each packet
+             * @param controlLengths receiving the length of each packet's control messages if controls is given
+             * @return number of received packets, zero for a spurious wakeup,
+             *         or -1 on error with errno set, i.e. ETIMEDOUT on timeout, EINTR if interrupted and ECANCELED after cancel()
+             */
+            int receive(uint8_t* buffers, const int buffer_capacity, int* lengths, const int count, const int32_t timeoutMS,
+                        uint8_t* controls=nullptr, int* controlLengths=nullptr);
+
+            /**
+             * Cancels the armed receive request, releasing the socket and waking up a blocked receive(),
+             * which fails with errno ECANCELED from here on.
+             * <p>
+             * Shall be called before closing the socket, may be called from any thread.
+             * </p>
+             */
+            void cancel();
+    };
+
+} // namespace direct_bt
+
+#endif /* IO_URING_HPP_ */
@@ -0,0 +1,118 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef INTERN_TABLE_HPP_
+#define INTERN_TABLE_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+#include <mutex>
+
+#include "BTTypes.hpp"
+
+namespace direct_bt {
+
+    /**
+     * Interning table of device names and small ManufactureSpecificData payloads,
+     * deduplicating the identical values carried by thousands of discovered devices, see DBTAdapter::getInternTable().
+     * <p>
+     * Entries are immutable and reference counted, keyed by their content hash.
+     * The table only holds weak references, i.e. an entry is released with its last user
+     * and expired slots are swept once the table doubled its size since the last sweep.
+     * </p>
+     * <p>
+     * Equal content results in the same instance, hence interned values are compared by pointer.
+     * ManufactureSpecificData exceeding MAX_MSD_SIZE is passed through unchanged,
+     * as such payloads usually carry per device data.
+     * </p>
+     * <p>
+     * Thread safe.
+     * </p>
+     */
+    class InternTable {
+        public:
+            typedef std::shared_ptr<const std::string> StringRef;
+            /** Shared ManufactureSpecificData, shall not be modified once interned */
+            typedef std::shared_ptr<ManufactureSpecificData> MSDRef;
+
+            /** Maximum ManufactureSpecificData payload size in bytes being interned */
+            static constexpr size_t MAX_MSD_SIZE = 32;
+
+        private:
+            /** Minimum table size triggering a sweep of expired entries */
+            static constexpr size_t MIN_SWEEP_SIZE = 64;
+
+            std::mutex mtx;
+            std::unordered_multimap<size_t, std::weak_ptr<const std::string>> strings;
+            std::unordered_multimap<size_t, std::weak_ptr<ManufactureSpecificData>> msds;
+            size_t stringsSweepSize = MIN_SWEEP_SIZE;
+            size_t msdsSweepSize = MIN_SWEEP_SIZE;
+
+        public:
+            /** Returns the shared empty string instance, never interned. */
+            static const StringRef & getEmptyString();
+
+            InternTable() {}
+
+            InternTable(const InternTable&) = delete;
+            void operator=(const InternTable&) = delete;
+
+            /**
+             * Returns the interned instance equal to the given string, adding it if not existing.
+             * <p>
+             * The empty string results in getEmptyString().
+             * </p>
+             */
+            StringRef intern(std::string && s);
+            StringRef intern(const std::string & s) { return intern(std::string(s)); }
+
+            /**
+             * Returns the interned instance equal to the given ManufactureSpecificData, adding it if not existing.
+             * <p>
+             * nullptr and payloads exceeding MAX_MSD_SIZE are returned unchanged.
+             * </p>
+             */
+            MSDRef intern(const MSDRef & msd);
+
+            /** Returns the number of table slots of strings, including expired but not yet swept entries. */
+            size_t getStringCount();
+
+            /** Returns the number of table slots of ManufactureSpecificData, including expired but not yet swept entries. */
+            size_t getMSDCount();
+
+            /** Removes all expired entries. */
+            void sweep();
+
+            void clear();
+
+            std::string toString();
+    };
+
+} // namespace direct_bt
+
+#endif /* INTERN_TABLE_HPP_ */
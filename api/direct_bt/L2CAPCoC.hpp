@@ -0,0 +1,157 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef L2CAP_COC_HPP_
+#define L2CAP_COC_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "OctetTypes.hpp"
+#include "L2CAPComm.hpp"
+
+/**
+ * - - - - - - - - - - - - - - -
+ *
+ * Module L2CAPCoC:
+ *
+ * - BT Core Spec v5.2: Vol 3, Part A: 3.4 LE Credit Based Flow Control Mode
+ * - BT Core Spec v5.2: Vol 3, Part A: 4.22 L2CAP_LE_CREDIT_BASED_CONNECTION_REQ
+ */
+namespace direct_bt {
+
+    class DBTDevice; // forward
+
+    /**
+     * LE credit based connection oriented channel (CoC) to a remote's PSM,
+     * offering a streaming read and write interface w/o ATT overhead, e.g. for bulk log or firmware transfers.
+     * <p>
+     * The kernel performs the credit based flow control, segmenting each written SDU into K-frames
+     * of the negotiated MPS and reassembling the received ones.
+     * Hence write() chunks the stream into SDUs of the remote's MTU, see getSendMTU(),
+     * and read() serves the stream from whole received SDUs of up to getReceiveMTU() octets.
+     * </p>
+     * <p>
+     * One reader and one writer thread may operate concurrently.
+     * </p>
+     */
+    class L2CAPCoC {
+        public:
+            enum Defaults : int32_t {
+                /** Minimum MTU of an LE credit based channel, BT Core Spec v5.2: Vol 3, Part A: 4.22 */
+                MIN_MTU = 23,
+                /** Maximum MTU of an LE credit based channel, BT Core Spec v5.2: Vol 3, Part A: 4.22 */
+                MAX_MTU = 65535
+            };
+            static inline int number(const Defaults d) { return static_cast<int>(d); }
+
+        private:
+            const std::string deviceString;
+            L2CAPComm l2cap;
+            POctets rbuffer;
+            int rpos;
+
+            uint64_t bytesRead;
+            uint64_t bytesWritten;
+            uint64_t sduReadCount;
+            uint64_t sduWriteCount;
+            uint64_t backpressureCount;
+
+            static L2CAPSocketOptions toSocketOptions(const uint16_t receiveMTU, const int32_t securityLevel);
+
+        public:
+            /**
+             * Constructing a closed channel, use connect() to open.
+             * @param device the connected LE device
+             * @param psm the remote's SIG assigned or dynamic LE PSM in the range [0x0001..0x00ff]
+             * @param receiveMTU the maximum SDU size accepted from the remote in the range [23..65535], zero for the kernel's default
+             * @param securityLevel the minimum BT_SECURITY level, -1 for the kernel's default, see L2CAPSocketOptions::SECURITY_LEVEL
+             * @throws IllegalArgumentException if psm or receiveMTU are out of range
+             */
+            L2CAPCoC(const std::shared_ptr<DBTDevice> & device, const uint16_t psm, const uint16_t receiveMTU=0,
+                     const int32_t securityLevel=-1);
+
+            L2CAPCoC(const L2CAPCoC&) = delete;
+            void operator=(const L2CAPCoC&) = delete;
+
+            /**
+             * Opens the channel, see L2CAPComm::connect().
+             * @param timeoutMS timeout of each connect attempt in milliseconds
+             */
+            bool connect(const int32_t timeoutMS=L2CAPComm::number(L2CAPComm::Defaults::L2CAP_CONNECT_TIMEOUT));
+
+            /** Cancels a pending connect() from another thread, see L2CAPComm::cancelConnect(). */
+            void cancelConnect() { l2cap.cancelConnect(); }
+
+            /** Closes the channel, discarding buffered read data. */
+            bool disconnect();
+
+            bool isOpen() const { return l2cap.isOpen(); }
+            bool getHasIOError() const { return l2cap.getHasIOError(); }
+
+            uint16_t getPSM() const { return l2cap.getPSM(); }
+
+            /** Returns the maximum SDU size accepted by the remote, or -1 if not open. */
+            int getSendMTU() const { return l2cap.getSendMTU(); }
+
+            /** Returns the maximum SDU size accepted from the remote, or -1 if not open. */
+            int getReceiveMTU() const { return l2cap.getReceiveMTU(); }
+
+            /** Returns the number of written octets not yet sent to the controller, see L2CAPComm::getSendQueueSize(). */
+            int getSendQueueSize() const { return l2cap.getSendQueueSize(); }
+
+            /**
+             * Writes the given octets, chunked into SDUs of up to getSendMTU() octets.
+             * <p>
+             * Blocks while the remote grants no credits and the socket's send queue is full,
+             * up to timeoutMS for each SDU.
+             * </p>
+             * @return number of written octets, less than length if the send queue stalled for timeoutMS, or -1 on error
+             */
+            int write(const uint8_t * data, const int length, const int32_t timeoutMS);
+
+            /**
+             * Reads up to capacity octets of the stream, waiting up to timeoutMS for the next SDU
+             * if no buffered octets of a previous SDU are left.
+             * @return number of read octets, zero on timeout, or -1 on error or if the remote closed the channel
+             */
+            int read(uint8_t * buffer, const int capacity, const int32_t timeoutMS);
+
+            uint64_t getBytesRead() const { return bytesRead; }
+            uint64_t getBytesWritten() const { return bytesWritten; }
+            uint64_t getSDUReadCount() const { return sduReadCount; }
+            uint64_t getSDUWriteCount() const { return sduWriteCount; }
+
+            /** Returns the number of times the send queue was full. */
+            uint64_t getBackpressureCount() const { return backpressureCount; }
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* L2CAP_COC_HPP_ */
@@ -31,12 +31,20 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <map>
 
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <condition_variable>
 
 #include "UUID.hpp"
 #include "BTTypes.hpp"
+#include "DBTEnv.hpp"
+#include "FunctionDef.hpp"
+#include "IOUring.hpp"
+
+struct epoll_event; // forward, <sys/epoll.h>
 
 /**
  * - - - - - - - - - - - - - - -
@@ -49,13 +57,117 @@ namespace direct_bt {
 
     class DBTDevice; // forward
 
+    /**
+     * L2CAP socket tuning options, applied by L2CAPComm::connect() before connecting the socket.
+     * <p>
+     * A negative value or false keeps the kernel's default.
+     * </p>
+     */
+    class L2CAPSocketOptions {
+        public:
+            /**
+             * SO_SNDBUF send buffer size in bytes, defaults to -1.
+             * <p>
+             * Environment variable is '<prefix>.sndbuf'.
+             * </p>
+             */
+            const int32_t SEND_BUFFER_SIZE;
+
+            /**
+             * SO_RCVBUF receive buffer size in bytes, defaults to -1.
+             * <p>
+             * Environment variable is '<prefix>.rcvbuf'.
+             * </p>
+             */
+            const int32_t RECEIVE_BUFFER_SIZE;
+
+            /**
+             * SO_PRIORITY in the range [0..6] of the socket's packets, defaults to -1.
+             * <p>
+             * Environment variable is '<prefix>.priority'.
+             * </p>
+             */
+            const int32_t PRIORITY;
+
+            /**
+             * BT_SECURITY level in the range [BT_SECURITY_LOW..BT_SECURITY_FIPS], defaults to -1.
+             * <p>
+             * A level above the link's current one lets the kernel encrypt or pair the link while connecting.
+             * </p>
+             * <p>
+             * Environment variable is '<prefix>.security'.
+             * </p>
+             */
+            const int32_t SECURITY_LEVEL;
+
+            /**
+             * BT_DEFER_SETUP, defaults to false.
+             * <p>
+             * Environment variable is '<prefix>.defer'.
+             * </p>
+             */
+            const bool DEFER_SETUP;
+
+            /**
+             * BT_RCVMTU, i.e. the SDU size in octets accepted from the remote
+             * of an LE credit based connection oriented channel, defaults to -1.
+             * <p>
+             * Not used by the fixed ATT channel, whose MTU is negotiated via ATT_EXCHANGE_MTU.
+             * </p>
+             * <p>
+             * Environment variable is '<prefix>.rcvmtu'.
+             * </p>
+             */
+            const int32_t RECEIVE_MTU;
+
+            /**
+             * SO_TIMESTAMPNS kernel receive timestamps, see L2CAPComm::read(), defaults to true.
+             * <p>
+             * Environment variable is '<prefix>.timestamps'.
+             * </p>
+             */
+            const bool RX_TIMESTAMPS;
+
+            /** Constructs options keeping all kernel defaults. */
+            L2CAPSocketOptions();
+
+            /** Constructs options of the given values, a negative value or false keeps the kernel's default. */
+            L2CAPSocketOptions(const int32_t sendBufferSize, const int32_t receiveBufferSize, const int32_t priority,
+                               const int32_t securityLevel, const bool deferSetup, const int32_t receiveMTU,
+                               const bool rxTimestamps=false);
+
+            /** Constructs options from the environment variables of the given prefix. */
+            L2CAPSocketOptions(const std::string & prefix);
+
+            /**
+             * Applies these options to the given socket.
+             * <p>
+             * Failures are logged and ignored.
+             * </p>
+             * @return true if all options could be applied, otherwise false
+             */
+            bool applyTo(const int dd) const;
+
+            std::string toString() const;
+    };
+
     /**
      * Read/Write L2CAP communication channel.
+     * <p>
+     * If enabled via the property 'direct_bt.io_uring', packets are received by an IOUringReceiver,
+     * lazily created by the first read of the connected channel, see IOUringReceiver::isEnabled().
+     * Its maximum packet size is the capacity of the first read.
+     * Writes are synchronous in either case.
+     * </p>
      */
     class L2CAPComm {
         public:
             enum class Defaults : int {
-                L2CAP_CONNECT_MAX_RETRY = 3
+                L2CAP_CONNECT_MAX_RETRY = 3,
+                /** Default timeout of each connect attempt in milliseconds, see connect(). */
+                L2CAP_CONNECT_TIMEOUT = 5000,
+                /** Maximum number of packets read via read_batch(..) within one wakeup. */
+                MAX_READ_BATCH = 64
             };
             static inline int number(const Defaults d) { return static_cast<int>(d); }
 
@@ -63,8 +175,21 @@ namespace direct_bt {
                 return "State[connected "+std::to_string(isConnected)+", ioError "+std::to_string(hasIOError)+"]";
             }
 
+            /**
+             * Transport returning the connected packet descriptor of an L2CAPComm to the given device, psm and cid,
+             * or a negative value with errno set on failure, see HCIComm::TransportOpenFunc.
+             */
+            typedef int (*TransportConnectFunc)(const DBTDevice & device, const uint16_t psm, const uint16_t cid);
+
+            /**
+             * Sets the transport used by connect(), e.g. connecting to a simulated peripheral,
+             * nullptr restores the default Linux Bluetooth L2CAP socket.
+             */
+            static void setTransport(TransportConnectFunc connect);
+
         private:
-            static int l2cap_open_dev(const EUI48 & adapterAddress, const uint16_t psm, const uint16_t cid, const bool pubaddr);
+            static int l2cap_open_dev(const EUI48 & adapterAddress, const uint16_t cid, const bool pubaddr,
+                                      const L2CAPSocketOptions & options);
             static int l2cap_close_dev(int dd);
 
             std::recursive_mutex mtx_write;
@@ -72,15 +197,50 @@ namespace direct_bt {
             const std::string deviceString;
             const uint16_t psm;
             const uint16_t cid;
+            const L2CAPSocketOptions options;
             std::atomic<int> _dd; // the l2cap socket
             std::atomic<bool> isConnected; // reflects state
             std::atomic<bool> hasIOError;  // reflects state
             std::atomic<bool> interruptFlag; // for forced disconnect
-            std::atomic<pthread_t> tid_connect;
+            int cancelfd; // eventfd waking a pending connect or read, see cancelConnect()
+            std::mutex mtx_receiver;
+            std::unique_ptr<IOUringReceiver> receiver; // created by the reader, cancelled by disconnect()
+            bool receiverTried;
+
+            /** Returns the IOUringReceiver if enabled, lazily created by the reader w/ the given maximum packet size. */
+            IOUringReceiver * getReceiver(const int capacity);
+
+            /** Batch read via the given IOUringReceiver, see read_batch(). */
+            int receive(IOUringReceiver * r, uint8_t* buffers, const int buffer_capacity, int* lengths, const int count,
+                        const int32_t timeoutMS, uint64_t* timestamps);
+
+            /**
+             * Waits for the pending non-blocking connect up to timeoutMS or its cancellation.
+             * @return zero if connected, -2 if timed out (errno ETIMEDOUT), otherwise -1 with errno set, ECANCELED if cancelled.
+             */
+            int connect_wait(const int32_t timeoutMS);
+
+            /**
+             * Polls the socket together with cancelfd up to timeoutMS.
+             * @return positive if readable, otherwise -1 with errno set, ETIMEDOUT if timed out or ECANCELED if cancelled.
+             */
+            int wait_readable(const int32_t timeoutMS);
 
         public:
-            /** Constructing a closed L2CAP channel, use {@link #connect()} to open. */
-            L2CAPComm(std::shared_ptr<DBTDevice> device, const uint16_t psm, const uint16_t cid);
+            /**
+             * Constructing a closed L2CAP channel, use {@link #connect()} to open.
+             * <p>
+             * Either a fixed channel is given by its cid with psm L2CAP_PSM_UNDEF, e.g. L2CAP_CID_ATT,
+             * or an LE credit based connection oriented channel by the remote's psm with cid zero.
+             * </p>
+             */
+            L2CAPComm(std::shared_ptr<DBTDevice> device, const uint16_t psm, const uint16_t cid,
+                      const L2CAPSocketOptions & options=L2CAPSocketOptions());
+
+            L2CAPComm(const L2CAPComm&) = delete;
+            void operator=(const L2CAPComm&) = delete;
+
+            ~L2CAPComm();
 
             std::shared_ptr<DBTDevice> getDevice() { return device; }
 
@@ -93,23 +253,226 @@ namespace direct_bt {
              * <p>
              * BT Core Spec v5.2: Vol 3, Part A: L2CAP_CONNECTION_REQ
              * </p>
+             * <p>
+             * The connect is performed non-blocking, waiting up to timeoutMS for each attempt
+             * instead of the kernel's timeout. A kernel timeout is retried up to
+             * Defaults::L2CAP_CONNECT_MAX_RETRY times, an own timeout fails with errno ETIMEDOUT.
+             * The wait is aborted by cancelConnect() or disconnect() from another thread, failing with errno ECANCELED.
+             * </p>
+             * @param timeoutMS timeout of each connect attempt in milliseconds
              */
-            bool connect();
+            bool connect(const int32_t timeoutMS=number(Defaults::L2CAP_CONNECT_TIMEOUT));
 
-            /** Closing the L2CAP channel, locking {@link #mutex_write()}. */
+            /**
+             * Cancels a pending connect(), w/o locking {@link #mutex_write()},
+             * i.e. the connecting thread returns promptly with a failure.
+             * <p>
+             * A read blocked in its poll is woken up as well, failing with errno ECANCELED
+             * until the next connect(), hence disconnect() stops a reader thread at once.
+             * </p>
+             */
+            void cancelConnect();
+
+            /** Closing the L2CAP channel, cancelling a pending connect() before locking {@link #mutex_write()}. */
             bool disconnect();
 
             bool isOpen() const { return 0 <= _dd; }
             int dd() const { return _dd; }
 
+            const L2CAPSocketOptions & getSocketOptions() const { return options; }
+
+            uint16_t getPSM() const { return psm; }
+            uint16_t getCID() const { return cid; }
+
+            /** Returns the connected channel's BT_SNDMTU, i.e. the maximum SDU size accepted by the remote, or -1 on error. */
+            int getSendMTU() const;
+
+            /** Returns the connected channel's BT_RCVMTU, i.e. the maximum SDU size accepted from the remote, or -1 on error. */
+            int getReceiveMTU() const;
+
+            /**
+             * Returns the number of octets in the socket's send queue not yet sent to the controller via SIOCOUTQ,
+             * allowing to pace streamed writes, or -1 if not open or on error.
+             */
+            int getSendQueueSize() const;
+
             /** Return the recursive write mutex for multithreading access. */
             std::recursive_mutex & mutex_write() { return mtx_write; }
 
             /** Generic read w/ own timeoutMS, w/o locking suitable for a unique ringbuffer sink. */
             int read(uint8_t* buffer, const int capacity, const int32_t timeoutMS);
 
+            /**
+             * Generic read w/ own timeoutMS like read(..), also receiving the packet's timestamp.
+             * @param timestamp receiving the kernel receive timestamp as monotonic nanoseconds if enabled via L2CAPSocketOptions::RX_TIMESTAMPS,
+             *        otherwise the time right after reading, see getCurrentNanoseconds().
+             */
+            int read(uint8_t* buffer, const int capacity, const int32_t timeoutMS, uint64_t & timestamp);
+
+            /**
+             * Generic batch read w/ own timeoutMS, w/o locking suitable for a unique ringbuffer sink.
+             * <p>
+             * Drains all pending packets up to the given count within one wakeup,
+             * i.e. one poll and one recvmmsg for all packets.
+             * </p>
+             * @param buffers count consecutive buffers of buffer_capacity each, one packet per buffer
+             * @param buffer_capacity capacity of each buffer
+             * @param lengths receiving the length of each read packet
+             * @param count maximum number of packets to read, capped to Defaults::MAX_READ_BATCH
+             * @param timeoutMS poll timeout for the first packet
+             * @return number of read packets, zero for a spurious wakeup, or -1 on error, timeout (errno ETIMEDOUT) or cancellation (errno ECANCELED)
+             */
+            int read_batch(uint8_t* buffers, const int buffer_capacity, int* lengths, const int count, const int32_t timeoutMS);
+
             /** Generic write, locking {@link #mutex_write()}. */
             int write(const uint8_t *buffer, const int length);
+
+            /**
+             * Non-blocking write, locking {@link #mutex_write()}.
+             * <p>
+             * If the socket's send queue is full, polls for writable state up to timeoutMS
+             * and increments the optional waitCount.
+             * </p>
+             * @return number of written octets, zero if the send queue remained full for timeoutMS (errno ETIMEDOUT) or -1 on error
+             */
+            int write_nonblock(const uint8_t *buffer, const int length, const int32_t timeoutMS, int* waitCount=nullptr);
+    };
+
+    /**
+     * Shared epoll based reader of many L2CAP channels on a small fixed number of worker threads,
+     * replacing one blocking reader thread per channel.
+     * <p>
+     * Each registered channel is armed one-shot, i.e. it is served by one worker at a time
+     * and its packets are delivered in read order.
+     * A worker drains up to L2CAPComm::Defaults::MAX_READ_BATCH pending packets of a channel per wakeup
+     * before re-arming it, keeping busy channels from starving others.
+     * </p>
+     * <p>
+     * The reactor reads from its own duplicate of the registered socket,
+     * hence a channel closed by its owner can't be confused with a reused descriptor.
+     * The owner shall remove its channel before closing it.
+     * </p>
+     * <p>
+     * A reactor w/o worker threads is driven by an external event loop,
+     * which polls getFD() for readability and calls process() on its own thread.
+     * </p>
+     */
+    class L2CAPReactor {
+        public:
+            enum Defaults : int32_t {
+                /** Maximum number of ready channels taken by one worker per epoll_wait */
+                MAX_EVENTS = 16
+            };
+            static inline int number(const Defaults d) { return static_cast<int>(d); }
+
+            /**
+             * Receives one packet of a registered channel, called by the serving worker thread.
+             * <p>
+             * A negative length and null data signal an I/O error or hangup of the channel.
+             * </p>
+             * @return true to keep the channel registered, otherwise it is removed
+             */
+            typedef FunctionDef<bool, const uint8_t *, int> ReadCallback;
+
+        private:
+            class Entry {
+                public:
+                    const uint64_t id;
+                    /** duplicate of the registered socket, owned and closed by this entry */
+                    const int fd;
+                    const int capacity;
+                    const ReadCallback callback;
+                    /** worker thread currently serving this entry, or the default id if idle */
+                    std::thread::id worker;
+
+                    Entry(const uint64_t id, const int fd, const int capacity, const ReadCallback & callback)
+                    : id(id), fd(fd), capacity(capacity), callback(callback) {}
+                    ~Entry();
+            };
+
+            const int threadCount;
+            const DBTThreadOptions threadOptions;
+            int epfd;
+            int wakefd;
+            std::atomic<bool> running;
+            uint64_t nextId;
+            std::map<uint64_t, std::shared_ptr<Entry>> entries;
+            std::mutex mtx_entries;
+            std::condition_variable cv_entries;
+            /** Read buffer of process(), only used by the external event loop */
+            std::vector<uint8_t> processBuffer;
+
+            L2CAPReactor(const int threadCount, const DBTThreadOptions & threadOptions);
+
+            void workerImpl();
+            /** Serves the given ready events on the calling thread, returns the number of served channels */
+            int dispatch(const struct epoll_event * events, const int count, std::vector<uint8_t> & buffer);
+            void serve(const std::shared_ptr<Entry> & e, const uint32_t events, std::vector<uint8_t> & buffer);
+
+        public:
+            /**
+             * Returns a new started reactor with the given number of worker threads,
+             * each applying the given thread options.
+             * <p>
+             * With zero threadCount no worker is started, see process().
+             * </p>
+             * <p>
+             * If the epoll instance can't be created, the returned reactor is not running and refuses all channels.
+             * </p>
+             */
+            static std::shared_ptr<L2CAPReactor> create(const int threadCount, const DBTThreadOptions & threadOptions);
+
+            L2CAPReactor(const L2CAPReactor&) = delete;
+            void operator=(const L2CAPReactor&) = delete;
+
+            ~L2CAPReactor();
+
+            /**
+             * Registers the given L2CAP socket.
+             * @param dd the open socket, remains owned by the caller
+             * @param capacity maximum packet size to read
+             * @param callback receiving each read packet
+             * @return the registration id, or zero on failure
+             */
+            uint64_t add(const int dd, const int capacity, const ReadCallback & callback);
+
+            /**
+             * Removes the given registration.
+             * @param wait if true, waits until the serving worker has returned from the callback, unless called by that worker itself.
+             * @return true if the registration has been removed, false if not registered.
+             */
+            bool remove(const uint64_t id, const bool wait);
+
+            /**
+             * Stops all workers and removes all registrations, not waiting for the workers to end.
+             */
+            void stop();
+
+            /**
+             * Returns the epoll file descriptor of this reactor, readable if any registered channel is ready.
+             * <p>
+             * Used by an external event loop, which may add it to its own epoll instance, see process().
+             * </p>
+             */
+            int getFD() const { return epfd; }
+
+            /**
+             * Serves all ready channels on the calling thread, i.e. the external event loop of a reactor w/o worker threads.
+             * <p>
+             * Shall be called by one thread at a time, if getFD() is readable or periodically.
+             * Each ready channel's ReadCallback is invoked as by a worker thread.
+             * </p>
+             * @param timeoutMS maximum time to wait for a ready channel, zero to return immediately
+             * @return number of served channels, or -1 on error or if not running,
+             *         in which case the external event loop shall remove getFD().
+             */
+            int process(const int32_t timeoutMS);
+
+            bool isRunning() const { return running; }
+            int getThreadCount() const { return threadCount; }
+            int size();
+
+            std::string toString();
     };
 
 } // namespace direct_bt
@@ -0,0 +1,219 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LE_ADVERTISER_HPP_
+#define LE_ADVERTISER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+
+#include "BTAddress.hpp"
+#include "OctetTypes.hpp"
+#include "HCITypes.hpp"
+
+namespace direct_bt {
+
+    class DBTAdapter; // forward
+    class HCIHandler; // forward
+
+    /**
+     * LE extended advertising set parameter, see HCIHandler::le_set_ext_adv_params().
+     */
+    class AdvertisingParameter {
+        public:
+            /** Advertising event property bits */
+            static constexpr uint16_t CONNECTABLE  = 0x0001;
+            static constexpr uint16_t SCANNABLE    = 0x0002;
+            static constexpr uint16_t DIRECTED     = 0x0004;
+            static constexpr uint16_t HIGH_DUTY    = 0x0008;
+            /** Use legacy advertising PDUs, limiting the data to 31 octets */
+            static constexpr uint16_t LEGACY       = 0x0010;
+            static constexpr uint16_t ANONYMOUS    = 0x0020;
+            static constexpr uint16_t INCL_TXPOWER = 0x0040;
+
+            /** Minimum advertising interval in units of 0.625ms, i.e. 20ms */
+            static constexpr uint32_t MIN_INTERVAL = 0x000020;
+            /** Maximum advertising interval in units of 0.625ms, i.e. ~10485s */
+            static constexpr uint32_t MAX_INTERVAL = 0xFFFFFF;
+            /** Maximum legacy advertising and scan response data length */
+            static constexpr int LEGACY_MAX_DATA_LEN = 31;
+
+            /** Advertising event property bit mask */
+            uint16_t properties;
+            /** Minimum advertising interval in units of 0.625ms */
+            uint32_t interval_min;
+            /** Maximum advertising interval in units of 0.625ms, shall be >= interval_min */
+            uint32_t interval_max;
+            /** Bit mask of the primary advertising channels 37, 38 and 39 */
+            uint8_t channel_map;
+            HCILEOwnAddressType own_address_type;
+            /** Requested TX power in dBm, 127 for no preference */
+            int8_t tx_power;
+            /** 0x01 LE 1M or 0x03 LE Coded PHY */
+            uint8_t primary_phy;
+            /** 0x01 LE 1M, 0x02 LE 2M or 0x03 LE Coded PHY */
+            uint8_t secondary_phy;
+            /** Advertising SID [0x0..0xF] */
+            uint8_t sid;
+
+            /** Defaults to connectable and scannable legacy advertising at 100ms on all channels */
+            AdvertisingParameter(const uint16_t properties_=CONNECTABLE|SCANNABLE|LEGACY,
+                                 const uint32_t interval_min_=0x00A0, const uint32_t interval_max_=0x00A0)
+            : properties(properties_), interval_min(interval_min_), interval_max(interval_max_),
+              channel_map(0x07), own_address_type(HCILEOwnAddressType::PUBLIC), tx_power(127),
+              primary_phy(0x01), secondary_phy(0x01), sid(0) {}
+
+            bool isLegacy() const { return 0 != ( properties & LEGACY ); }
+
+            /** Returns the maximum advertising and scan response data length of one command. */
+            int getMaxDataLength() const { return isLegacy() ? LEGACY_MAX_DATA_LEN : HCILESetExtAdvDataCmd::MAX_DATA_LEN; }
+
+            bool isValid() const {
+                return MIN_INTERVAL <= interval_min && interval_min <= interval_max && interval_max <= MAX_INTERVAL &&
+                       0 != ( channel_map & 0x07 ) && 0x0F >= sid;
+            }
+
+            std::string toString() const;
+    };
+
+    /**
+     * LE advertiser of DBTAdapter, managing multiple concurrently running extended advertising sets.
+     * <p>
+     * The advertising and scan response data of an enabled set is replaced in place
+     * via one HCIHandler::le_set_ext_adv_data() command w/o stopping the set,
+     * hence a frequently changing payload, e.g. a sensor value encoded via ADWriter, costs no advertising gap.
+     * The data is limited to AdvertisingParameter::getMaxDataLength() while the set is enabled.
+     * </p>
+     * <p>
+     * Changing the interval via setInterval() briefly disables only the given set,
+     * as the controller rejects parameter changes of an enabled set, BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.53.
+     * </p>
+     * <p>
+     * Requires HCIHandler::isLEExtAdvSupported(), otherwise HCIStatusCode::UNSUPPORTED_FEATURE_OR_PARAM_VALUE is returned.
+     * </p>
+     */
+    class LEAdvertiser {
+        private:
+            struct Set {
+                uint8_t handle;
+                bool enabled;
+                int8_t selected_tx_power;
+                uint16_t duration;
+                uint8_t max_events;
+                AdvertisingParameter param;
+            };
+
+            DBTAdapter & adapter;
+            std::recursive_mutex mtx;
+            std::vector<Set> sets;
+            /** Number of supported sets, read once, zero if not yet read */
+            int maxSets;
+
+            Set * findSet(const uint8_t handle);
+            HCIStatusCode enableImpl(HCIHandler & hci, Set & s, const bool enable);
+            HCIStatusCode setDataImpl(const bool scanRsp, const uint8_t handle, const uint8_t * data, const int length);
+
+        public:
+            LEAdvertiser(DBTAdapter & adapter_)
+            : adapter(adapter_), maxSets(0) {}
+
+            LEAdvertiser(const LEAdvertiser&) = delete;
+            void operator=(const LEAdvertiser&) = delete;
+
+            /**
+             * Returns the number of advertising sets supported by the controller, zero if not supported.
+             */
+            int getMaxSets();
+
+            /** Returns the number of created advertising sets. */
+            int getSetCount();
+
+            /**
+             * Creates a new disabled advertising set with the given parameter.
+             * @param param the advertising parameter
+             * @param handle returns the handle of the new set
+             * @return HCIStatusCode::LIMIT_REACHED if getMaxSets() are in use
+             */
+            HCIStatusCode createSet(const AdvertisingParameter & param, uint8_t & handle);
+
+            /**
+             * Replaces the advertising data of the given set, also while enabled.
+             */
+            HCIStatusCode setData(const uint8_t handle, const TROOctets & data);
+
+            /**
+             * Replaces the scan response data of the given scannable set, also while enabled.
+             */
+            HCIStatusCode setScanResponseData(const uint8_t handle, const TROOctets & data);
+
+            /**
+             * Changes the advertising interval of the given set in units of 0.625ms,
+             * briefly disabling the set if enabled.
+             */
+            HCIStatusCode setInterval(const uint8_t handle, const uint32_t interval_min, const uint32_t interval_max);
+
+            /**
+             * Sets the random address of the given set, used with HCILEOwnAddressType::RANDOM.
+             */
+            HCIStatusCode setRandomAddress(const uint8_t handle, const EUI48 & address);
+
+            /**
+             * Enables the given set.
+             * @param handle the advertising set handle
+             * @param duration advertising duration in units of 10ms, zero for no limit
+             * @param max_events maximum number of advertising events, zero for no limit
+             */
+            HCIStatusCode enable(const uint8_t handle, const uint16_t duration=0, const uint8_t max_events=0);
+
+            /** Disables the given set. */
+            HCIStatusCode disable(const uint8_t handle);
+
+            /** Returns true if the given set is enabled. */
+            bool isEnabled(const uint8_t handle);
+
+            /**
+             * Returns the TX power in dBm selected by the controller for the given set, 127 if not available.
+             */
+            int8_t getSelectedTxPower(const uint8_t handle);
+
+            /** Disables and removes the given set. */
+            HCIStatusCode removeSet(const uint8_t handle);
+
+            /** Disables and removes all sets. */
+            HCIStatusCode clear();
+
+            /**
+             * Forgets all sets w/o issuing HCI commands, used by DBTAdapter when powered off,
+             * as the controller drops its advertising sets.
+             */
+            void close();
+    };
+
+} // namespace direct_bt
+
+#endif /* LE_ADVERTISER_HPP_ */
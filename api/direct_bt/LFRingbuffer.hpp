@@ -146,7 +146,7 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
                 int localWritePos = writePos;
                 for(int i=0; i<copyFromCount; i++) {
                     localWritePos = (localWritePos + 1) % capacityPlusOne;
-                    array[localWritePos] = copyFrom[i];
+                    RingbufferElement<T>::assign(array[localWritePos], copyFrom[i]);
                     size++;
                 }
                 writePos = localWritePos;
@@ -176,19 +176,61 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
                 }
             }
             localReadPos = (localReadPos + 1) % capacityPlusOne;
-            T r = array[localReadPos];
-            if( !peek ) {
-                array[localReadPos] = nullelem;
-                {
-                    std::unique_lock<std::mutex> lockWrite(syncWrite); // RAII-style acquire and relinquish via destructor
-                    size--;
-                    readPos = localReadPos;
-                    cvWrite.notify_all(); // notify waiting putter
-                }
+            if( peek ) {
+                T r = nullelem;
+                RingbufferElement<T>::assign(r, static_cast<const T &>(array[localReadPos]));
+                return r;
+            }
+            T r = std::move(array[localReadPos]);
+            array[localReadPos] = nullelem;
+            {
+                std::unique_lock<std::mutex> lockWrite(syncWrite); // RAII-style acquire and relinquish via destructor
+                size--;
+                readPos = localReadPos;
+                cvWrite.notify_all(); // notify waiting putter
             }
             return r;
         }
 
+        int getAllImpl(T * dest, const int max, const int timeoutMS) {
+            std::unique_lock<std::mutex> lockMultiRead(syncMultiRead); // RAII-style acquire and relinquish via destructor
+
+            int localReadPos = readPos;
+            if( 0 >= max ) {
+                return 0;
+            }
+            if( localReadPos == writePos ) {
+                if( 0 > timeoutMS ) {
+                    return 0;
+                }
+                std::unique_lock<std::mutex> lockRead(syncRead); // RAII-style acquire and relinquish via destructor
+                while( localReadPos == writePos ) {
+                    if( 0 == timeoutMS ) {
+                        cvRead.wait(lockRead);
+                    } else {
+                        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+                        std::cv_status s = cvRead.wait_until(lockRead, t0 + std::chrono::milliseconds(timeoutMS));
+                        if( std::cv_status::timeout == s && localReadPos == writePos ) {
+                            return 0;
+                        }
+                    }
+                }
+            }
+            const int count = std::min(max, ( writePos - localReadPos + capacityPlusOne ) % capacityPlusOne);
+            for(int i=0; i<count; i++) {
+                localReadPos = (localReadPos + 1) % capacityPlusOne;
+                dest[i] = std::move(array[localReadPos]);
+                array[localReadPos] = nullelem;
+            }
+            {
+                std::unique_lock<std::mutex> lockWrite(syncWrite); // RAII-style acquire and relinquish via destructor
+                size -= count;
+                readPos = localReadPos;
+                cvWrite.notify_all(); // notify waiting putter, once per batch
+            }
+            return count;
+        }
+
         int dropImpl (const int count) {
             // locks ringbuffer completely (read/write), hence no need for local copy nor wait/sync etc
             std::unique_lock<std::mutex> lockMultiRead(syncMultiRead); // RAII-style acquire and relinquish via destructor
@@ -207,7 +249,9 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
             return dropCount;
         }
 
-        bool putImpl(const T &e, const bool sameRef, const bool blocking, const int timeoutMS) /* throws InterruptedException */ {
+        /** Copies or moves <code>e</code> into the buffer, depending on its value category, only if successful. */
+        template<typename U>
+        bool putImpl(U && e, const bool sameRef, const bool blocking, const int timeoutMS) /* throws InterruptedException */ {
             std::unique_lock<std::mutex> lockMultiWrite(syncMultiWrite); // RAII-style acquire and relinquish via destructor
 
             int localWritePos = writePos;
@@ -231,7 +275,7 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
                 }
             }
             if( !sameRef ) {
-                array[localWritePos] = e;
+                RingbufferElement<T>::assign(array[localWritePos], std::forward<U>(e));
             }
             {
                 std::unique_lock<std::mutex> lockRead(syncRead); // RAII-style acquire and relinquish via destructor
@@ -242,6 +286,27 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
             return true;
         }
 
+        int putAllImpl(const T * src, const int count) {
+            std::unique_lock<std::mutex> lockMultiWrite(syncMultiWrite); // RAII-style acquire and relinquish via destructor
+
+            int localWritePos = writePos;
+            const int n = std::min(count, ( readPos - localWritePos - 1 + 2*capacityPlusOne ) % capacityPlusOne);
+            if( 0 >= n ) {
+                return 0;
+            }
+            for(int i=0; i<n; i++) {
+                localWritePos = (localWritePos + 1) % capacityPlusOne;
+                RingbufferElement<T>::assign(array[localWritePos], src[i]);
+            }
+            {
+                std::unique_lock<std::mutex> lockRead(syncRead); // RAII-style acquire and relinquish via destructor
+                size += n;
+                writePos = localWritePos;
+                cvRead.notify_all(); // notify waiting getter, once per batch
+            }
+            return n;
+        }
+
     public:
         std::string toString() const override {
             const std::string es = isEmpty() ? ", empty" : "";
@@ -392,6 +457,10 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
             return getImpl(true, true, timeoutMS);
         }
 
+        int getAll(T * dest, const int max, const int timeoutMS=-1) override {
+            return getAllImpl(dest, max, timeoutMS);
+        }
+
         int drop(const int count) override {
             return dropImpl(count);
         }
@@ -401,15 +470,27 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
         }
 
         bool putBlocking(const T & e, const int timeoutMS=0) override {
-            return !putImpl(e, false, true, timeoutMS);
+            return putImpl(e, false, true, timeoutMS);
+        }
+
+        bool put(T && e) override {
+            return putImpl(std::move(e), false, false, 0);
+        }
+
+        bool putBlocking(T && e, const int timeoutMS=0) override {
+            return putImpl(std::move(e), false, true, timeoutMS);
+        }
+
+        int putAll(const T * src, const int count) override {
+            return putAllImpl(src, count);
         }
 
         bool putSame() override {
-            return putImpl(nullelem, true, false, 0);
+            return putImpl(T(nullelem), true, false, 0);
         }
 
         bool putSameBlocking(const int timeoutMS=0) override {
-            return putImpl(nullelem, true, true, timeoutMS);
+            return putImpl(T(nullelem), true, true, timeoutMS);
         }
 
         void waitForFreeSlots(const int count) override /* throws InterruptedException */ {
@@ -453,7 +534,7 @@ template <typename T, std::nullptr_t nullelem> class LFRingbuffer : public Ringb
                 for(int i=0; i<_size; i++) {
                     localWritePos = (localWritePos + 1) % capacityPlusOne;
                     oldReadPos = (oldReadPos + 1) % oldCapacityPlusOne;
-                    array[localWritePos] = oldArray[oldReadPos];
+                    array[localWritePos] = std::move(oldArray[oldReadPos]);
                 }
                 writePos = localWritePos;
             }
@@ -0,0 +1,471 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MPMCRINGBUFFER_HPP_
+#define MPMCRINGBUFFER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+
+#include "BasicTypes.hpp"
+
+#include "Ringbuffer.hpp"
+
+namespace direct_bt {
+
+/**
+ * Bounded multi-producer / multi-consumer implementation of {@link Ringbuffer},
+ * following Dmitry Vyukov's bounded MPMC queue with one sequence number per slot.
+ * <p>
+ * Producers and consumers only contend on their own position via compare-and-swap,
+ * a slot's sequence number hands the element over between both sides.
+ * Hence, other than LFRingbuffer, no producer or consumer ever serializes through a mutex.
+ * Both positions are padded to their own cache line.
+ * </p>
+ * <p>
+ * The slot of position <code>pos</code> is <code>pos % capacity</code>, its sequence number
+ * <ul>
+ *   <li>equals <code>pos</code> if the slot is free for the producer claiming <code>pos</code>,</li>
+ *   <li>equals <code>pos + 1</code> if the slot is filled for the consumer claiming <code>pos</code>.</li>
+ * </ul>
+ * </p>
+ * <p>
+ * Blocking operations only fall back to a mutex and condition variable while the queue is empty or full,
+ * the opposite side only takes the mutex to notify if a waiter has been announced.
+ * </p>
+ * <p>
+ * Batch operations {@link #putAll(const T*, int) putAll(..)}, {@link #putBlocking(const T*, int, int) putBlocking(..)}
+ * and {@link #getAll(T*, int, int) getAll(..)} claim a contiguous range of slots with one compare-and-swap and notify waiters once.
+ * </p>
+ * <p>
+ * Implementation is thread safe, except:
+ * <ul>
+ *   <li>{@link #peek() peek*(..)} must not run concurrently with another consumer.</li>
+ *   <li>{@link #reset(Object[]) reset(..)}, {@link #recapacity(int) recapacity(..)} and copying
+ *       require neither producer nor consumer being active.</li>
+ * </ul>
+ * </p>
+ */
+template <typename T, std::nullptr_t nullelem> class MPMCRingbuffer : public Ringbuffer<T> {
+    private:
+        enum Defaults : int32_t {
+            CACHE_LINE_SIZE = 64
+        };
+
+        struct Slot {
+            std::atomic<uint64_t> sequence;
+            T value;
+
+            Slot() : sequence(0), value(nullelem) {}
+        };
+
+        /* final */ int cap;  // not final due to grow
+        /* final */ Slot * array; // not final due to grow
+
+        uint8_t padding0[CACHE_LINE_SIZE];
+        /** Next position to be claimed by a producer. */
+        std::atomic<uint64_t> writePos;
+        uint8_t padding1[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+        /** Next position to be claimed by a consumer. */
+        std::atomic<uint64_t> readPos;
+        uint8_t padding2[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+
+        std::mutex syncRead, syncWrite;
+        std::condition_variable cvRead, cvWrite;
+        std::atomic<int> readWaiters;
+        std::atomic<int> writeWaiters;
+        std::atomic<uint32_t> readEpoch;
+        std::atomic<uint32_t> writeEpoch;
+
+        Slot * newArray(const int count) {
+            Slot * a = new Slot[count];
+            for(int i=0; i<count; i++) {
+                a[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            return a;
+        }
+        void freeArray(Slot * a) {
+            delete[] a;
+        }
+
+        Slot & slotOf(const uint64_t pos) const { return array[pos % static_cast<uint64_t>(cap)]; }
+
+        /**
+         * Claims up to <code>count</code> contiguous free slots for writing.
+         * @return number of claimed slots starting at <code>pos</code>, zero if full.
+         */
+        int claimWrite(const int count, uint64_t & pos) {
+            pos = writePos.load(std::memory_order_relaxed);
+            for(;;) {
+                int n = 0;
+                while( n < count && n < cap && slotOf(pos+n).sequence.load(std::memory_order_acquire) == pos+n ) {
+                    n++;
+                }
+                if( 0 == n ) {
+                    const uint64_t seq = slotOf(pos).sequence.load(std::memory_order_acquire);
+                    if( seq < pos ) {
+                        return 0; // full: slot not yet released by its consumer
+                    }
+                    pos = writePos.load(std::memory_order_relaxed); // lost race against another producer
+                } else if( writePos.compare_exchange_weak(pos, pos+n, std::memory_order_relaxed) ) {
+                    return n;
+                }
+            }
+        }
+
+        /**
+         * Claims up to <code>count</code> contiguous filled slots for reading.
+         * @return number of claimed slots starting at <code>pos</code>, zero if empty.
+         */
+        int claimRead(const int count, uint64_t & pos) {
+            pos = readPos.load(std::memory_order_relaxed);
+            for(;;) {
+                int n = 0;
+                while( n < count && n < cap && slotOf(pos+n).sequence.load(std::memory_order_acquire) == pos+n+1 ) {
+                    n++;
+                }
+                if( 0 == n ) {
+                    const uint64_t seq = slotOf(pos).sequence.load(std::memory_order_acquire);
+                    if( seq < pos+1 ) {
+                        return 0; // empty: slot not yet filled by its producer
+                    }
+                    pos = readPos.load(std::memory_order_relaxed); // lost race against another consumer
+                } else if( readPos.compare_exchange_weak(pos, pos+n, std::memory_order_relaxed) ) {
+                    return n;
+                }
+            }
+        }
+
+        /** Wakes blocked consumers, if any announced themselves. */
+        void notifyReaders() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if( 0 < readWaiters.load(std::memory_order_relaxed) ) {
+                std::unique_lock<std::mutex> lockRead(syncRead); // RAII-style acquire and relinquish via destructor
+                readEpoch++;
+                cvRead.notify_all();
+            }
+        }
+
+        /** Wakes blocked producers, if any announced themselves. */
+        void notifyWriters() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if( 0 < writeWaiters.load(std::memory_order_relaxed) ) {
+                std::unique_lock<std::mutex> lockWrite(syncWrite); // RAII-style acquire and relinquish via destructor
+                writeEpoch++;
+                cvWrite.notify_all();
+            }
+        }
+
+        /** Moves from a mutable <code>e</code>, copies from a const <code>e</code>, only the claimed elements. */
+        template<typename E>
+        int putImpl(E * e, const int count, const bool sameRef) {
+            uint64_t pos;
+            const int n = claimWrite(count, pos);
+            for(int i=0; i<n; i++) {
+                Slot & s = slotOf(pos+i);
+                if( !sameRef ) {
+                    RingbufferElement<T>::store(s.value, e[i]);
+                }
+                s.sequence.store(pos+i+1, std::memory_order_release);
+            }
+            if( 0 < n ) {
+                notifyReaders();
+            }
+            return n;
+        }
+
+        int getImpl(T * e, const int count) {
+            uint64_t pos;
+            const int n = claimRead(count, pos);
+            for(int i=0; i<n; i++) {
+                Slot & s = slotOf(pos+i);
+                if( nullptr != e ) {
+                    e[i] = std::move(s.value);
+                }
+                s.value = nullelem;
+                s.sequence.store(pos+i+cap, std::memory_order_release);
+            }
+            if( 0 < n ) {
+                notifyWriters();
+            }
+            return n;
+        }
+
+        /**
+         * Repeats <code>op</code> until it succeeds or the timeout expired, <code>timeoutMS</code> of zero blocks infinitely.
+         * <p>
+         * The waiter is announced before each attempt and only sleeps if the opposite side's notification epoch
+         * is unchanged since, hence no notification can be lost.
+         * <code>op</code> runs without holding the lock, as it notifies the opposite side itself.
+         * </p>
+         */
+        template<typename Op>
+        bool blockingImpl(std::mutex & sync, std::condition_variable & cv, std::atomic<int> & waiters, std::atomic<uint32_t> & epoch,
+                          const int timeoutMS, Op op) {
+            if( op() ) {
+                return true;
+            }
+            const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMS);
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool res;
+            for(;;) {
+                const uint32_t e = epoch.load(std::memory_order_seq_cst);
+                if( ( res = op() ) ) {
+                    break;
+                }
+                std::unique_lock<std::mutex> lock(sync); // RAII-style acquire and relinquish via destructor
+                bool timeout = false;
+                while( e == epoch.load(std::memory_order_relaxed) && !timeout ) {
+                    if( 0 == timeoutMS ) {
+                        cv.wait(lock);
+                    } else {
+                        timeout = std::cv_status::timeout == cv.wait_until(lock, t1);
+                    }
+                }
+                if( timeout ) {
+                    lock.unlock();
+                    res = op();
+                    break;
+                }
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return res;
+        }
+
+        void resetImpl(const T * copyFrom, const int copyFromCount) /* throws IllegalArgumentException */ {
+            clear();
+            if( nullptr != copyFrom && 0 < copyFromCount ) {
+                if( copyFromCount > cap ) {
+                    throw IllegalArgumentException("copyFrom array length "+std::to_string(copyFromCount)+" > capacity "+toString(), E_FILE_LINE);
+                }
+                putImpl(copyFrom, copyFromCount, false);
+            }
+        }
+
+    public:
+        std::string toString() const override {
+            const std::string es = isEmpty() ? ", empty" : "";
+            const std::string fs = isFull() ? ", full" : "";
+            return "MPMCRingbuffer<?>[size "+std::to_string(getSize())+" / "+std::to_string(cap)+
+                    ", writePos "+std::to_string(writePos)+", readPos "+std::to_string(readPos)+es+fs+"]";
+        }
+
+        void dump(FILE *stream, std::string prefix) const override {
+            fprintf(stream, "%s %s\n", prefix.c_str(), toString().c_str());
+        }
+
+        /**
+         * Create a full ring buffer instance w/ the given array's net capacity and content.
+         * @param copyFrom mandatory source array determining ring buffer's net {@link #capacity()} and initial content.
+         */
+        MPMCRingbuffer(const std::vector<T> & copyFrom) /* throws IllegalArgumentException */
+        : cap(std::max<int>(1, copyFrom.size())), array(newArray(cap)), writePos(0), readPos(0), readWaiters(0), writeWaiters(0), readEpoch(0), writeEpoch(0)
+        {
+            resetImpl(copyFrom.data(), copyFrom.size());
+        }
+
+        MPMCRingbuffer(const T * copyFrom, const int copyFromSize) /* throws IllegalArgumentException */
+        : cap(std::max(1, copyFromSize)), array(newArray(cap)), writePos(0), readPos(0), readWaiters(0), writeWaiters(0), readEpoch(0), writeEpoch(0)
+        {
+            resetImpl(copyFrom, copyFromSize);
+        }
+
+        /**
+         * Create an empty ring buffer instance w/ the given net <code>capacity</code>, at least one.
+         * @param capacity the initial net capacity of the ring buffer
+         */
+        MPMCRingbuffer(const int capacity)
+        : cap(std::max(1, capacity)), array(newArray(cap)), writePos(0), readPos(0), readWaiters(0), writeWaiters(0), readEpoch(0), writeEpoch(0)
+        { }
+
+        ~MPMCRingbuffer() {
+            freeArray(array);
+        }
+
+        MPMCRingbuffer(const MPMCRingbuffer &_source) = delete;
+        MPMCRingbuffer& operator=(const MPMCRingbuffer &_source) = delete;
+
+        int capacity() const override { return cap; }
+
+        void clear() override {
+            while( 0 < getImpl(nullptr, cap) ) { }
+        }
+
+        void reset(const T * copyFrom, const int copyFromCount) override {
+            resetImpl(copyFrom, copyFromCount);
+        }
+
+        void reset(const std::vector<T> & copyFrom) override {
+            resetImpl(copyFrom.data(), copyFrom.size());
+        }
+
+        int getSize() const override {
+            const uint64_t r = readPos.load(std::memory_order_acquire);
+            const uint64_t w = writePos.load(std::memory_order_acquire);
+            return w > r ? static_cast<int>( std::min<uint64_t>(w - r, cap) ) : 0;
+        }
+
+        int getFreeSlots() const override { return cap - getSize(); }
+
+        bool isEmpty() const override { return 0 == getSize(); }
+
+        bool isFull() const override { return cap == getSize(); }
+
+        T get() override {
+            T r = nullelem;
+            getImpl(&r, 1);
+            return r;
+        }
+
+        T getBlocking(const int timeoutMS=0) override /* throws InterruptedException */ {
+            T r = nullelem;
+            blockingImpl(syncRead, cvRead, readWaiters, readEpoch, timeoutMS, [&]() { return 0 < getImpl(&r, 1); });
+            return r;
+        }
+
+        int getAll(T * dest, const int max, const int timeoutMS=-1) override {
+            if( 0 > timeoutMS ) {
+                return getImpl(dest, max);
+            }
+            int n = 0;
+            blockingImpl(syncRead, cvRead, readWaiters, readEpoch, timeoutMS, [&]() { return 0 < ( n = getImpl(dest, max) ); });
+            return n;
+        }
+
+        /** Must not run concurrently with another consumer. */
+        T peek() override {
+            const uint64_t pos = readPos.load(std::memory_order_relaxed);
+            const Slot & s = slotOf(pos);
+            if( s.sequence.load(std::memory_order_acquire) != pos+1 ) {
+                return nullelem;
+            }
+            T r = nullelem;
+            RingbufferElement<T>::assign(r, s.value);
+            return r;
+        }
+
+        /** Must not run concurrently with another consumer. */
+        T peekBlocking(const int timeoutMS=0) override /* throws InterruptedException */ {
+            T r = nullelem;
+            blockingImpl(syncRead, cvRead, readWaiters, readEpoch, timeoutMS, [&]() { return nullptr != ( r = peek() ); });
+            return r;
+        }
+
+        int drop(const int count) override {
+            int n = 0;
+            int c;
+            while( n < count && 0 < ( c = getImpl(nullptr, count - n) ) ) {
+                n += c;
+            }
+            return n;
+        }
+
+        bool put(const T & e) override {
+            return 1 == putImpl(&e, 1, false);
+        }
+
+        bool putBlocking(const T & e, const int timeoutMS=0) override {
+            return blockingImpl(syncWrite, cvWrite, writeWaiters, writeEpoch, timeoutMS, [&]() { return 1 == putImpl(&e, 1, false); });
+        }
+
+        bool put(T && e) override {
+            return 1 == putImpl(&e, 1, false);
+        }
+
+        bool putBlocking(T && e, const int timeoutMS=0) override {
+            return blockingImpl(syncWrite, cvWrite, writeWaiters, writeEpoch, timeoutMS, [&]() { return 1 == putImpl(&e, 1, false); });
+        }
+
+        /**
+         * Enqueues all <code>count</code> elements from <code>src</code>, in order,
+         * blocking for free slots as required.
+         * <p>
+         * Elements of one batch may be interleaved with those of other producers if the buffer runs full.
+         * </p>
+         * @return number of enqueued elements, less than <code>count</code> if timeout occurred
+         */
+        int putBlocking(const T * src, const int count, const int timeoutMS=0) {
+            int n = 0;
+            while( n < count ) {
+                int c = 0;
+                if( !blockingImpl(syncWrite, cvWrite, writeWaiters, writeEpoch, timeoutMS, [&]() { return 0 < ( c = putImpl(src+n, count-n, false) ); }) ) {
+                    break;
+                }
+                n += c;
+            }
+            return n;
+        }
+
+        int putAll(const T * src, const int count) override {
+            return putImpl(src, count, false);
+        }
+
+        bool putSame() override {
+            return 1 == putImpl(static_cast<const T *>(nullptr), 1, true);
+        }
+
+        bool putSameBlocking(const int timeoutMS=0) override {
+            return blockingImpl(syncWrite, cvWrite, writeWaiters, writeEpoch, timeoutMS, [&]() { return 1 == putImpl(static_cast<const T *>(nullptr), 1, true); });
+        }
+
+        void waitForFreeSlots(const int count) override /* throws InterruptedException */ {
+            blockingImpl(syncWrite, cvWrite, writeWaiters, writeEpoch, 0, [&]() { return getFreeSlots() >= count; });
+        }
+
+        /** Requires neither producer nor consumer being active. */
+        void recapacity(const int newCapacity) override {
+            if( cap == newCapacity ) {
+                return;
+            }
+            const int _size = getSize();
+            if( _size > newCapacity ) {
+                throw IllegalArgumentException("amount "+std::to_string(newCapacity)+" < size, "+toString(), E_FILE_LINE);
+            }
+            if( 0 >= newCapacity ) {
+                throw IllegalArgumentException("amount "+std::to_string(newCapacity)+" <= 0, "+toString(), E_FILE_LINE);
+            }
+            std::vector<T> saved(_size);
+            const int n = getImpl(saved.data(), _size);
+
+            freeArray(array);
+            cap = newCapacity;
+            array = newArray(cap);
+            writePos.store(0, std::memory_order_relaxed);
+            readPos.store(0, std::memory_order_relaxed);
+            putImpl(saved.data(), n, false);
+        }
+};
+
+} /* namespace direct_bt */
+
+#endif /* MPMCRINGBUFFER_HPP_ */
@@ -40,6 +40,7 @@
 #include "DBTTypes.hpp"
 
 #include "FunctionDef.hpp"
+#include "COWVector.hpp"
 
 namespace direct_bt {
 
@@ -68,7 +69,9 @@ namespace direct_bt {
 
 
     enum MgmtConst : int {
-        MGMT_HEADER_SIZE       = 6
+        MGMT_HEADER_SIZE       = 6,
+        /** Inline storage capacity of MgmtCommand, covering the largest fixed size command MgmtOpcode::SET_LOCAL_NAME. */
+        MGMT_COMMAND_INLINE_SIZE = MGMT_HEADER_SIZE + MGMT_MAX_NAME_LENGTH + MGMT_MAX_SHORT_NAME_LENGTH
     };
 
     enum class MgmtStatus : uint8_t {
@@ -180,7 +183,8 @@ namespace direct_bt {
     class MgmtCommand
     {
         protected:
-            POctets pdu;
+            /** Inline storage up to MGMT_COMMAND_INLINE_SIZE, i.e. no heap allocation for most commands. */
+            SOctets<MGMT_COMMAND_INLINE_SIZE> pdu;
 
             inline static void checkOpcode(const MgmtOpcode has, const MgmtOpcode min, const MgmtOpcode max)
             {
@@ -196,8 +200,12 @@ namespace direct_bt {
             }
             virtual std::string valueString() const {
                 const int psz = getParamSize();
-                const std::string ps = psz > 0 ? bytesHexString(getParam(), 0, psz, true /* lsbFirst */, true /* leading0X */) : "";
-                return "param[size "+std::to_string(getParamSize())+", data "+ps+"], tsz "+std::to_string(getTotalSize());
+                std::string res("param[size "+std::to_string(psz)+", data ");
+                if( psz > 0 ) {
+                    appendBytesHexString(res, getParam(), 0, psz, true /* lsbFirst */, true /* leading0X */);
+                }
+                res.append("], tsz "+std::to_string(getTotalSize()));
+                return res;
             }
 
         public:
@@ -455,6 +463,11 @@ namespace direct_bt {
             }
 
         public:
+            enum Defaults : int32_t {
+                /* The kernel rejects control channel packets exceeding HCI_MAX_FRAME_SIZE. */
+                MAX_PARAM_COUNT = ( HCI_MAX_FRAME_SIZE - MGMT_HEADER_SIZE - 2 ) / 15
+            };
+
             MgmtLoadConnParamCmd(const uint16_t dev_id, const MgmtConnParam & connParam)
             : MgmtCommand(MgmtOpcode::LOAD_CONN_PARAM, dev_id, 2 + 15)
             {
@@ -496,12 +509,259 @@ namespace direct_bt {
             uint16_t getTimeout(int idx) const { return pdu.get_uint16(MGMT_HEADER_SIZE + 2 + 15*idx + 6 + 1 + 2 + 2 + 2); }
     };
 
+    /**
+     * SMP IO Capability of the local device used for pairing,
+     * BT Core Spec v5.2: Vol 3, Part H SMP: 2.3.2 IO Capabilities.
+     */
+    enum class SMPIOCapability : uint8_t {
+        DISPLAY_ONLY        = 0x00,
+        DISPLAY_YES_NO      = 0x01,
+        KEYBOARD_ONLY       = 0x02,
+        NO_INPUT_NO_OUTPUT  = 0x03,
+        KEYBOARD_DISPLAY    = 0x04
+    };
+    inline uint8_t number(const SMPIOCapability rhs) {
+        return static_cast<uint8_t>(rhs);
+    }
+
+    /**
+     * Long Term Key type of MgmtLongTermKeyInfo.
+     */
+    enum class MgmtLTKType : uint8_t {
+        UNAUTHENTICATED      = 0x00,
+        AUTHENTICATED        = 0x01,
+        UNAUTHENTICATED_P256 = 0x02,
+        AUTHENTICATED_P256   = 0x03,
+        DEBUG_P256           = 0x04
+    };
+
+    /**
+     * mgmt_ltk_info, 36 bytes.
+     * <p>
+     * Multi-byte fields are stored in host byte order and serialized in little endian.
+     * </p>
+     */
+    struct MgmtLongTermKeyInfo {
+        EUI48 address;
+        uint8_t address_type;
+        /** MgmtLTKType */
+        uint8_t key_type;
+        /** 1 if the key is used while being the connection's master, i.e. the initiator */
+        uint8_t master;
+        uint8_t enc_size;
+        uint16_t ediv;
+        uint64_t rand;
+        uint8_t ltk[16];
+
+        enum : int { SIZE = 6+1+1+1+1+2+8+16 };
+
+        /** Serializes this key at the given offset in little endian, i.e. the mgmt_ltk_info layout. */
+        void put(POctets & out, const int offset) const {
+            out.put_eui48(offset, address);
+            out.put_uint8(offset+6, address_type);
+            out.put_uint8(offset+7, key_type);
+            out.put_uint8(offset+8, master);
+            out.put_uint8(offset+9, enc_size);
+            out.put_uint16(offset+10, ediv);
+            out.put_uint32(offset+12, static_cast<uint32_t>(rand));
+            out.put_uint32(offset+16, static_cast<uint32_t>(rand >> 32));
+            memcpy(out.get_wptr() + offset + 20, ltk, sizeof(ltk));
+        }
+        /** Returns the key at the given offset in the mgmt_ltk_info layout. */
+        static MgmtLongTermKeyInfo get(const TROOctets & in, const int offset) {
+            in.check_range(offset, SIZE);
+            MgmtLongTermKeyInfo r;
+            r.address = EUI48(in.get_ptr() + offset);
+            r.address_type = in.get_uint8(offset+6);
+            r.key_type = in.get_uint8(offset+7);
+            r.master = in.get_uint8(offset+8);
+            r.enc_size = in.get_uint8(offset+9);
+            r.ediv = in.get_uint16(offset+10);
+            r.rand = static_cast<uint64_t>(in.get_uint32(offset+12)) | ( static_cast<uint64_t>(in.get_uint32(offset+16)) << 32 );
+            memcpy(r.ltk, in.get_ptr() + offset + 20, sizeof(r.ltk));
+            return r;
+        }
+        std::string toString() const {
+            return "LTK[address "+address.toString()+", addressType "+getBDAddressTypeString(static_cast<BDAddressType>(address_type))+
+                   ", type "+std::to_string(key_type)+", master "+std::to_string(master)+", encSize "+std::to_string(enc_size)+"]";
+        }
+    } __packed;
+
+    /**
+     * mgmt_irk_info, 23 bytes.
+     */
+    struct MgmtIdentityResolvingKeyInfo {
+        /** The identity address */
+        EUI48 address;
+        uint8_t address_type;
+        uint8_t irk[16];
+
+        enum : int { SIZE = 6+1+16 };
+
+        /** Serializes this key at the given offset, i.e. the mgmt_irk_info layout. */
+        void put(POctets & out, const int offset) const {
+            out.put_eui48(offset, address);
+            out.put_uint8(offset+6, address_type);
+            memcpy(out.get_wptr() + offset + 7, irk, sizeof(irk));
+        }
+        /** Returns the key at the given offset in the mgmt_irk_info layout. */
+        static MgmtIdentityResolvingKeyInfo get(const TROOctets & in, const int offset) {
+            in.check_range(offset, SIZE);
+            MgmtIdentityResolvingKeyInfo r;
+            r.address = EUI48(in.get_ptr() + offset);
+            r.address_type = in.get_uint8(offset+6);
+            memcpy(r.irk, in.get_ptr() + offset + 7, sizeof(r.irk));
+            return r;
+        }
+        std::string toString() const {
+            return "IRK[address "+address.toString()+", addressType "+getBDAddressTypeString(static_cast<BDAddressType>(address_type))+"]";
+        }
+    } __packed;
+
+    /**
+     * uint16_t key_count                          2
+     * MgmtLongTermKeyInfo keys[]                 36 = 1x
+     * <p>
+     * The kernel replaces all previously loaded Long Term Keys of the adapter.
+     * </p>
+     */
+    class MgmtLoadLongTermKeyCmd : public MgmtCommand
+    {
+        protected:
+            std::string valueString() const override {
+                const int keyCount = getKeyCount();
+                std::string ps = "count "+std::to_string(keyCount)+": ";
+                for(int i=0; i<keyCount; i++) {
+                    if( 0 < i ) {
+                        ps.append(", ");
+                    }
+                    ps.append( getKey(i).toString() );
+                }
+                return "param[size "+std::to_string(getParamSize())+", data["+ps+"]], tsz "+std::to_string(getTotalSize());
+            }
+
+        public:
+            enum Defaults : int32_t {
+                /* The kernel rejects control channel packets exceeding HCI_MAX_FRAME_SIZE. */
+                MAX_KEY_COUNT = ( HCI_MAX_FRAME_SIZE - MGMT_HEADER_SIZE - 2 ) / MgmtLongTermKeyInfo::SIZE
+            };
+
+            MgmtLoadLongTermKeyCmd(const uint16_t dev_id, const std::vector<MgmtLongTermKeyInfo> & keys)
+            : MgmtCommand(MgmtOpcode::LOAD_LONG_TERM_KEYS, dev_id, 2 + keys.size() * MgmtLongTermKeyInfo::SIZE)
+            {
+                int offset = MGMT_HEADER_SIZE;
+                pdu.put_uint16(offset, keys.size()); offset+= 2;
+
+                for(const MgmtLongTermKeyInfo & key : keys) {
+                    key.put(pdu, offset); offset+= MgmtLongTermKeyInfo::SIZE;
+                }
+            }
+            uint16_t getKeyCount() const { return pdu.get_uint16(MGMT_HEADER_SIZE); }
+
+            MgmtLongTermKeyInfo getKey(int idx) const { return MgmtLongTermKeyInfo::get(pdu, MGMT_HEADER_SIZE + 2 + MgmtLongTermKeyInfo::SIZE*idx); }
+    };
+
+    /**
+     * uint16_t irk_count                          2
+     * MgmtIdentityResolvingKeyInfo irks[]        23 = 1x
+     * <p>
+     * The kernel replaces all previously loaded Identity Resolving Keys of the adapter.
+     * </p>
+     */
+    class MgmtLoadIdentityResolvingKeyCmd : public MgmtCommand
+    {
+        protected:
+            std::string valueString() const override {
+                const int keyCount = getKeyCount();
+                std::string ps = "count "+std::to_string(keyCount)+": ";
+                for(int i=0; i<keyCount; i++) {
+                    if( 0 < i ) {
+                        ps.append(", ");
+                    }
+                    ps.append( getKey(i).toString() );
+                }
+                return "param[size "+std::to_string(getParamSize())+", data["+ps+"]], tsz "+std::to_string(getTotalSize());
+            }
+
+        public:
+            enum Defaults : int32_t {
+                /* The kernel rejects control channel packets exceeding HCI_MAX_FRAME_SIZE. */
+                MAX_KEY_COUNT = ( HCI_MAX_FRAME_SIZE - MGMT_HEADER_SIZE - 2 ) / MgmtIdentityResolvingKeyInfo::SIZE
+            };
+
+            MgmtLoadIdentityResolvingKeyCmd(const uint16_t dev_id, const std::vector<MgmtIdentityResolvingKeyInfo> & keys)
+            : MgmtCommand(MgmtOpcode::LOAD_IRKS, dev_id, 2 + keys.size() * MgmtIdentityResolvingKeyInfo::SIZE)
+            {
+                int offset = MGMT_HEADER_SIZE;
+                pdu.put_uint16(offset, keys.size()); offset+= 2;
+
+                for(const MgmtIdentityResolvingKeyInfo & key : keys) {
+                    key.put(pdu, offset); offset+= MgmtIdentityResolvingKeyInfo::SIZE;
+                }
+            }
+            uint16_t getKeyCount() const { return pdu.get_uint16(MGMT_HEADER_SIZE); }
+
+            MgmtIdentityResolvingKeyInfo getKey(int idx) const { return MgmtIdentityResolvingKeyInfo::get(pdu, MGMT_HEADER_SIZE + 2 + MgmtIdentityResolvingKeyInfo::SIZE*idx); }
+    };
+
+    /**
+     * mgmt_addr_info { EUI48, uint8_t type },
+     * uint8_t io_capability
+     */
+    class MgmtPairDeviceCmd : public MgmtCommand
+    {
+        protected:
+            std::string valueString() const override {
+                const std::string ps = "address "+getAddress().toString()+", addressType "+getBDAddressTypeString(getAddressType())+
+                                       ", ioCapability "+std::to_string(number(getIOCapability()));
+                return "param[size "+std::to_string(getParamSize())+", data["+ps+"]], tsz "+std::to_string(getTotalSize());
+            }
+
+        public:
+            MgmtPairDeviceCmd(const uint16_t dev_id, const EUI48 &address, const BDAddressType addressType, const SMPIOCapability iocap)
+            : MgmtCommand(MgmtOpcode::PAIR_DEVICE, dev_id, 6+1+1)
+            {
+                pdu.put_eui48(MGMT_HEADER_SIZE, address);
+                pdu.put_uint8(MGMT_HEADER_SIZE+6, addressType);
+                pdu.put_uint8(MGMT_HEADER_SIZE+6+1, number(iocap));
+            }
+            const EUI48 getAddress() const { return EUI48(pdu.get_ptr(MGMT_HEADER_SIZE)); } // mgmt_addr_info
+            BDAddressType getAddressType() const { return static_cast<BDAddressType>(pdu.get_uint8(MGMT_HEADER_SIZE+6)); } // mgmt_addr_info
+            SMPIOCapability getIOCapability() const { return static_cast<SMPIOCapability>(pdu.get_uint8(MGMT_HEADER_SIZE+6+1)); }
+    };
+
+    /**
+     * mgmt_addr_info { EUI48, uint8_t type },
+     * uint8_t disconnect
+     */
+    class MgmtUnpairDeviceCmd : public MgmtCommand
+    {
+        protected:
+            std::string valueString() const override {
+                const std::string ps = "address "+getAddress().toString()+", addressType "+getBDAddressTypeString(getAddressType())+
+                                       ", disconnect "+std::to_string(getDisconnect());
+                return "param[size "+std::to_string(getParamSize())+", data["+ps+"]], tsz "+std::to_string(getTotalSize());
+            }
+
+        public:
+            MgmtUnpairDeviceCmd(const uint16_t dev_id, const EUI48 &address, const BDAddressType addressType, const bool disconnect)
+            : MgmtCommand(MgmtOpcode::UNPAIR_DEVICE, dev_id, 6+1+1)
+            {
+                pdu.put_eui48(MGMT_HEADER_SIZE, address);
+                pdu.put_uint8(MGMT_HEADER_SIZE+6, addressType);
+                pdu.put_uint8(MGMT_HEADER_SIZE+6+1, disconnect ? 1 : 0);
+            }
+            const EUI48 getAddress() const { return EUI48(pdu.get_ptr(MGMT_HEADER_SIZE)); } // mgmt_addr_info
+            BDAddressType getAddressType() const { return static_cast<BDAddressType>(pdu.get_uint8(MGMT_HEADER_SIZE+6)); } // mgmt_addr_info
+            bool getDisconnect() const { return 0 != pdu.get_uint8(MGMT_HEADER_SIZE+6+1); }
+    };
+
     /**
      * uint16_t opcode,
      * uint16_t dev-id,
      * uint16_t param_size
      */
-    class MgmtEvent
+    class MgmtEvent : public std::enable_shared_from_this<MgmtEvent>
     {
         public:
             enum class Opcode : uint16_t {
@@ -552,6 +812,9 @@ namespace direct_bt {
         protected:
             /** actual received mgmt event */
             POctets pdu;
+            /** creation or kernel receive timestamp in nanoseconds, see getCurrentNanoseconds() */
+            uint64_t ts_creation_ns;
+            /** creation or kernel receive timestamp in milliseconds, derived from ts_creation_ns */
             uint64_t ts_creation;
 
             static void checkOpcode(const Opcode has, const Opcode min, const Opcode max)
@@ -576,8 +839,12 @@ namespace direct_bt {
             }
             virtual std::string valueString() const {
                 const int d_sz = getDataSize();
-                const std::string d_str = d_sz > 0 ? bytesHexString(getData(), 0, d_sz, true /* lsbFirst */, true /* leading0X */) : "";
-                return "data[size "+std::to_string(d_sz)+", data "+d_str+"], tsz "+std::to_string(getTotalSize());
+                std::string res("data[size "+std::to_string(d_sz)+", data ");
+                if( d_sz > 0 ) {
+                    appendBytesHexString(res, getData(), 0, d_sz, true /* lsbFirst */, true /* leading0X */);
+                }
+                res.append("], tsz "+std::to_string(getTotalSize()));
+                return res;
             }
 
         public:
@@ -592,13 +859,13 @@ namespace direct_bt {
 
             /** Persistent memory, w/ ownership ..*/
             MgmtEvent(const uint8_t* buffer, const int buffer_len)
-            : pdu(buffer, buffer_len), ts_creation(getCurrentMilliseconds())
+            : pdu(buffer, buffer_len), ts_creation_ns(getCurrentNanoseconds()), ts_creation(ts_creation_ns / 1000000)
             {
                 pdu.check_range(0, MGMT_HEADER_SIZE+getParamSize());
                 checkOpcode(getOpcode(), Opcode::CMD_COMPLETE, Opcode::PHY_CONFIGURATION_CHANGED);
             }
             MgmtEvent(const Opcode opc, const uint16_t dev_id, const uint16_t param_size=0)
-            : pdu(MGMT_HEADER_SIZE+param_size), ts_creation(getCurrentMilliseconds())
+            : pdu(MGMT_HEADER_SIZE+param_size), ts_creation_ns(getCurrentNanoseconds()), ts_creation(ts_creation_ns / 1000000)
             {
                 // checkOpcode(opc, READ_VERSION, SET_BLOCKED_KEYS);
 
@@ -615,9 +882,23 @@ namespace direct_bt {
             }
             virtual ~MgmtEvent() {}
 
+            /**
+             * Returns a shared reference to this instance, allowing a MgmtEventCallback to retain the event beyond its invocation.
+             * <p>
+             * Only valid while this instance is owned by a std::shared_ptr,
+             * as guaranteed for all events dispatched to a MgmtEventCallback.
+             * </p>
+             */
+            std::shared_ptr<const MgmtEvent> retain() const { return shared_from_this(); }
+
             int getTotalSize() const { return pdu.getSize(); }
 
+            /** Returns the monotonic timestamp in milliseconds, see getCurrentMilliseconds(). */
             uint64_t getTimestamp() const { return ts_creation; }
+            /** Returns the monotonic timestamp in nanoseconds, see getCurrentNanoseconds(). */
+            uint64_t getTimestampNS() const { return ts_creation_ns; }
+            /** Sets the monotonic timestamp in nanoseconds, e.g. the kernel receive timestamp, also updating getTimestamp(). */
+            void setTimestampNS(const uint64_t ns) { ts_creation_ns = ns; ts_creation = ns / 1000000; }
             Opcode getOpcode() const { return static_cast<Opcode>( pdu.get_uint16(0) ); }
             std::string getOpcodeString() const { return getOpcodeString(getOpcode()); }
             uint16_t getDevID() const { return pdu.get_uint16(2); }
@@ -713,6 +994,8 @@ namespace direct_bt {
     class MgmtEvtDiscovering : public MgmtEvent
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DISCOVERING; }
 
         protected:
             std::string baseString() const override {
@@ -748,6 +1031,8 @@ namespace direct_bt {
     class MgmtEvtNewSettings : public MgmtEvent
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::NEW_SETTINGS; }
 
         protected:
             std::string baseString() const override {
@@ -778,6 +1063,8 @@ namespace direct_bt {
     class MgmtEvtNewConnectionParam : public MgmtEvent
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::NEW_CONN_PARAM; }
 
         protected:
             std::string baseString() const override {
@@ -833,6 +1120,9 @@ namespace direct_bt {
             }
 
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_FOUND; }
+
             MgmtEvtDeviceFound(const uint8_t* buffer, const int buffer_len)
             : MgmtEvent(buffer, buffer_len)
             {
@@ -886,6 +1176,9 @@ namespace direct_bt {
             }
 
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_CONNECTED; }
+
             MgmtEvtDeviceConnected(const uint8_t* buffer, const int buffer_len)
             : MgmtEvent(buffer, buffer_len), hci_conn_handle(0xffff)
             {
@@ -932,6 +1225,9 @@ namespace direct_bt {
             }
 
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::CONNECT_FAILED; }
+
             MgmtEvtDeviceConnectFailed(const uint8_t* buffer, const int buffer_len)
             : MgmtEvent(buffer, buffer_len), hciStatus(HCIStatusCode::UNKNOWN)
             {
@@ -964,6 +1260,9 @@ namespace direct_bt {
     class MgmtEvtDeviceDisconnected : public MgmtEvent
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_DISCONNECTED; }
+
             enum class DisconnectReason : uint8_t {
                 UNKNOWN        = 0x00,
                 TIMEOUT        = 0x01,
@@ -1046,6 +1345,8 @@ namespace direct_bt {
     class MgmtEvtPinCodeRequest : public MgmtEvent
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::PIN_CODE_REQUEST; }
 
         protected:
             std::string baseString() const override {
@@ -1077,6 +1378,8 @@ namespace direct_bt {
     class MgmtEvtDeviceWhitelistAdded : public MgmtEvent
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_WHITELIST_ADDED; }
 
         protected:
             std::string baseString() const override {
@@ -1132,6 +1435,9 @@ namespace direct_bt {
     class MgmtEvtDeviceWhitelistRemoved : public MgmtEvtAdressInfoMeta
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_WHITELIST_REMOVED; }
+
             MgmtEvtDeviceWhitelistRemoved(const uint8_t* buffer, const int buffer_len)
             : MgmtEvtAdressInfoMeta(Opcode::DEVICE_WHITELIST_REMOVED, buffer, buffer_len)
             { }
@@ -1143,6 +1449,9 @@ namespace direct_bt {
     class MgmtEvtDeviceUnpaired : public MgmtEvtAdressInfoMeta
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_UNPAIRED; }
+
             MgmtEvtDeviceUnpaired(const uint8_t* buffer, const int buffer_len)
             : MgmtEvtAdressInfoMeta(Opcode::DEVICE_UNPAIRED, buffer, buffer_len)
             { }
@@ -1154,6 +1463,9 @@ namespace direct_bt {
     class MgmtEvtDeviceBlocked : public MgmtEvtAdressInfoMeta
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_BLOCKED; }
+
             MgmtEvtDeviceBlocked(const uint8_t* buffer, const int buffer_len)
             : MgmtEvtAdressInfoMeta(Opcode::DEVICE_BLOCKED, buffer, buffer_len)
             { }
@@ -1165,6 +1477,9 @@ namespace direct_bt {
     class MgmtEvtDeviceUnblocked : public MgmtEvtAdressInfoMeta
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::DEVICE_UNBLOCKED; }
+
             MgmtEvtDeviceUnblocked(const uint8_t* buffer, const int buffer_len)
             : MgmtEvtAdressInfoMeta(Opcode::DEVICE_UNBLOCKED, buffer, buffer_len)
             { }
@@ -1176,11 +1491,78 @@ namespace direct_bt {
     class MgmtEvtUserPasskeyRequest: public MgmtEvtAdressInfoMeta
     {
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::USER_PASSKEY_REQUEST; }
+
             MgmtEvtUserPasskeyRequest(const uint8_t* buffer, const int buffer_len)
             : MgmtEvtAdressInfoMeta(Opcode::USER_PASSKEY_REQUEST, buffer, buffer_len)
             { }
     };
 
+    /**
+     * uint8_t store_hint,
+     * MgmtLongTermKeyInfo key
+     */
+    class MgmtEvtNewLongTermKey : public MgmtEvent
+    {
+        protected:
+            std::string baseString() const override {
+                return MgmtEvent::baseString()+", store-hint "+std::to_string(getStoreHint())+", "+getKey().toString();
+            }
+
+        public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::NEW_LONG_TERM_KEY; }
+
+            MgmtEvtNewLongTermKey(const uint8_t* buffer, const int buffer_len)
+            : MgmtEvent(buffer, buffer_len)
+            {
+                checkOpcode(getOpcode(), Opcode::NEW_LONG_TERM_KEY);
+                pdu.check_range(0, MGMT_HEADER_SIZE+1+MgmtLongTermKeyInfo::SIZE);
+            }
+            /** Returns true if the key shall be stored persistently, i.e. the device is bonded. */
+            bool getStoreHint() const { return 0 != pdu.get_uint8(MGMT_HEADER_SIZE); }
+            MgmtLongTermKeyInfo getKey() const { return MgmtLongTermKeyInfo::get(pdu, MGMT_HEADER_SIZE+1); }
+
+            int getDataOffset() const override { return MGMT_HEADER_SIZE+1+MgmtLongTermKeyInfo::SIZE; }
+            int getDataSize() const override { return getParamSize()-1-MgmtLongTermKeyInfo::SIZE; }
+            const uint8_t* getData() const override { return getDataSize()>0 ? pdu.get_ptr(getDataOffset()) : nullptr; }
+    };
+
+    /**
+     * uint8_t store_hint,
+     * EUI48 rpa,
+     * MgmtIdentityResolvingKeyInfo key
+     */
+    class MgmtEvtNewIdentityResolvingKey : public MgmtEvent
+    {
+        protected:
+            std::string baseString() const override {
+                return MgmtEvent::baseString()+", store-hint "+std::to_string(getStoreHint())+
+                       ", rpa "+getRandomPrivateAddress().toString()+", "+getKey().toString();
+            }
+
+        public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::NEW_IRK; }
+
+            MgmtEvtNewIdentityResolvingKey(const uint8_t* buffer, const int buffer_len)
+            : MgmtEvent(buffer, buffer_len)
+            {
+                checkOpcode(getOpcode(), Opcode::NEW_IRK);
+                pdu.check_range(0, MGMT_HEADER_SIZE+1+6+MgmtIdentityResolvingKeyInfo::SIZE);
+            }
+            /** Returns true if the key shall be stored persistently, i.e. the device is bonded. */
+            bool getStoreHint() const { return 0 != pdu.get_uint8(MGMT_HEADER_SIZE); }
+            /** Returns the resolvable private address the key has been distributed with, EUI48_ANY_DEVICE if none. */
+            const EUI48 getRandomPrivateAddress() const { return EUI48(pdu.get_ptr(MGMT_HEADER_SIZE+1)); }
+            MgmtIdentityResolvingKeyInfo getKey() const { return MgmtIdentityResolvingKeyInfo::get(pdu, MGMT_HEADER_SIZE+1+6); }
+
+            int getDataOffset() const override { return MGMT_HEADER_SIZE+1+6+MgmtIdentityResolvingKeyInfo::SIZE; }
+            int getDataSize() const override { return getParamSize()-1-6-MgmtIdentityResolvingKeyInfo::SIZE; }
+            const uint8_t* getData() const override { return getDataSize()>0 ? pdu.get_ptr(getDataOffset()) : nullptr; }
+    };
+
     /**
      * uint8_t name[MGMT_MAX_NAME_LENGTH];
      * uint8_t short_name[MGMT_MAX_SHORT_NAME_LENGTH];
@@ -1193,6 +1575,9 @@ namespace direct_bt {
             }
 
         public:
+            /** Returns the Opcode of this event type, allowing compile-time MgmtEventHandler dispatch. */
+            static constexpr Opcode getStaticOpcode() { return Opcode::LOCAL_NAME_CHANGED; }
+
             static int namesDataSize() { return MgmtConstU16::MGMT_MAX_NAME_LENGTH + MgmtConstU16::MGMT_MAX_SHORT_NAME_LENGTH; }
             static int getRequiredSize() { return MGMT_HEADER_SIZE + namesDataSize(); }
 
@@ -1249,8 +1634,42 @@ namespace direct_bt {
 
     };
 
-    typedef FunctionDef<bool, std::shared_ptr<MgmtEvent>> MgmtEventCallback;
-    typedef std::vector<MgmtEventCallback> MgmtEventCallbackList;
+    /**
+     * MgmtEvent callback, passing the event by reference for the duration of the invocation only.
+     * <p>
+     * Use MgmtEvent::retain() to keep the event beyond the invocation.
+     * </p>
+     */
+    typedef FunctionDef<bool, const MgmtEvent&> MgmtEventCallback;
+    typedef COWVector<MgmtEventCallback> MgmtEventCallbackList;
+
+    /**
+     * Typed MgmtEventCallback for the specialized MgmtEvent type E, e.g. MgmtEvtDeviceFound.
+     * <p>
+     * The event type E provides its Opcode via E::getStaticOpcode() at compile time,
+     * see DBTManager::addMgmtEventHandler() and HCIHandler::addMgmtEventHandler().
+     * </p>
+     */
+    template<typename E> using MgmtEventHandler = FunctionDef<bool, const E&>;
+
+    /**
+     * Returns a MgmtEventCallback delegating to the given typed MgmtEventHandler,
+     * which identity is the one of the given handler.
+     * <p>
+     * The event is passed downcast to E without runtime type check,
+     * hence the returned MgmtEventCallback shall only be registered for E::getStaticOpcode().
+     * </p>
+     */
+    template<typename E>
+    inline MgmtEventCallback bindMgmtEventHandler(const MgmtEventHandler<E> & handler) {
+        static_assert(std::is_base_of<MgmtEvent, E>::value, "E must be a MgmtEvent");
+        static_assert(static_cast<uint16_t>(E::getStaticOpcode()) < static_cast<uint16_t>(MgmtEvent::Opcode::MGMT_EVENT_TYPE_COUNT),
+                      "E::getStaticOpcode() exceeds MgmtEventCallbackList index");
+        bool(*typedInvoke)(MgmtEventHandler<E>&, const MgmtEvent&) = [](MgmtEventHandler<E>& h, const MgmtEvent& e)->bool {
+            return h.invoke(static_cast<const E&>(e));
+        };
+        return bindCaptureFunc(handler, typedInvoke);
+    }
 
     class MgmtAdapterEventCallback {
         private:
@@ -1274,6 +1693,9 @@ namespace direct_bt {
             /** MgmtEventCallback reference */
             MgmtEventCallback& getCallback() { return callback; }
 
+            /** MgmtEventCallback reference */
+            const MgmtEventCallback& getCallback() const { return callback; }
+
             bool operator==(const MgmtAdapterEventCallback& rhs) const
             { return dev_id == rhs.dev_id && callback == rhs.callback; }
 
@@ -1285,7 +1707,7 @@ namespace direct_bt {
             }
     };
 
-    typedef std::vector<MgmtAdapterEventCallback> MgmtAdapterEventCallbackList;
+    typedef COWVector<MgmtAdapterEventCallback> MgmtAdapterEventCallbackList;
 
 } // namespace direct_bt
 
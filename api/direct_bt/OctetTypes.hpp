@@ -32,6 +32,7 @@
 #include <cstdint>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
 
 #include <mutex>
 #include <atomic>
@@ -143,6 +144,21 @@ namespace direct_bt {
                 return _data + i;
             }
 
+            /**
+             * Returns a copy of the packed struct T at octet offset i, e.g. one of the HCIIoctl.hpp HCI or Mgmt structs.
+             * <p>
+             * The whole extent of T is checked once and copied via memcpy, hence no alignment requirements apply.
+             * </p>
+             */
+            template<typename T>
+            T get_struct(const int i) const {
+                static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+                check_range(i, sizeof(T));
+                T res;
+                memcpy(&res, _data + i, sizeof(T));
+                return res;
+            }
+
             bool operator==(const TROOctets& rhs) const {
                 return _size == rhs._size && 0 == memcmp(_data, rhs._data, _size);
             }
@@ -151,7 +167,9 @@ namespace direct_bt {
             }
 
             std::string toString() const {
-                return "size "+std::to_string(_size)+", ro: "+bytesHexString(_data, 0, _size, true /* lsbFirst */, true /* leading0X */);
+                std::string res("size "+std::to_string(_size)+", ro: ");
+                appendBytesHexString(res, _data, 0, _size, true /* lsbFirst */, true /* leading0X */);
+                return res;
             }
     };
 
@@ -213,6 +231,14 @@ namespace direct_bt {
                 direct_bt::put_uuid(data(), i, v, true /* littleEndian */);
             }
 
+            /** Copies the packed struct T to octet offset i, checking its whole extent once. See TROOctets::get_struct(). */
+            template<typename T>
+            void put_struct(const int i, const T & v) {
+                static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+                check_range(i, sizeof(T));
+                memcpy(data() + i, &v, sizeof(T));
+            }
+
             uint8_t * get_wptr() { return data(); }
             uint8_t * get_wptr(const int i) {
                 check_range(i, 1);
@@ -220,7 +246,9 @@ namespace direct_bt {
             }
 
             std::string toString() const {
-                return "size "+std::to_string(getSize())+", rw: "+bytesHexString(get_ptr(), 0, getSize(), true /* lsbFirst */, true /* leading0X */);
+                std::string res("size "+std::to_string(getSize())+", rw: ");
+                appendBytesHexString(res, get_ptr(), 0, getSize(), true /* lsbFirst */, true /* leading0X */);
+                return res;
             }
     };
 
@@ -257,7 +285,80 @@ namespace direct_bt {
             }
 
             std::string toString() const {
-                return "offset "+std::to_string(offset)+", size "+std::to_string(size)+": "+bytesHexString(parent.get_ptr(), offset, size, true /* lsbFirst */, true /* leading0X */);
+                std::string res("offset "+std::to_string(offset)+", size "+std::to_string(size)+": ");
+                appendBytesHexString(res, parent.get_ptr(), offset, size, true /* lsbFirst */, true /* leading0X */);
+                return res;
+            }
+    };
+
+    /**
+     * Read cursor over a range of TROOctets, validating the whole extent once at construction.
+     * <p>
+     * All subsequent field reads are unchecked against the validated extent,
+     * avoiding the redundant per field range check of TROOctets when parsing a struct of known size,
+     * e.g. an ATT PDU element or HCI event parameter.
+     * Caller must not read beyond getSize(), which is not checked.
+     * </p>
+     * <p>
+     * Besides the random access get_* methods, the sequential read_* methods consume the field at the current position.
+     * </p>
+     */
+    class TOctetReader
+    {
+        private:
+            uint8_t const * _data;
+            int _size;
+            int _pos;
+
+        public:
+            /** Validates the range [offset..offset+len) of given source, throws IndexOutOfBoundsException otherwise. */
+            TOctetReader(const TROOctets &source, const int offset, const int len)
+            : _data( ( source.check_range(offset, len), source.get_ptr() + offset ) ), _size( len ), _pos( 0 ) {}
+
+            /** Covers the whole given source. */
+            TOctetReader(const TROOctets &source) noexcept
+            : _data( source.get_ptr() ), _size( source.getSize() ), _pos( 0 ) {}
+
+            TOctetReader(const TOctetReader &o) noexcept = default;
+            TOctetReader& operator=(const TOctetReader &o) noexcept = default;
+
+            int getSize() const { return _size; }
+            int getPosition() const { return _pos; }
+            int getRemaining() const { return _size - _pos; }
+
+            uint8_t get_uint8(const int i) const { return _data[i]; }
+            int8_t get_int8(const int i) const { return direct_bt::get_int8(_data, i); }
+            uint16_t get_uint16(const int i) const { return direct_bt::get_uint16(_data, i, true /* littleEndian */); }
+            uint32_t get_uint32(const int i) const { return direct_bt::get_uint32(_data, i, true /* littleEndian */); }
+            uint128_t get_uint128(const int i) const { return direct_bt::get_uint128(_data, i, true /* littleEndian */); }
+            EUI48 get_eui48(const int i) const { return EUI48(_data+i); }
+            uuid16_t get_uuid16(const int i) const { return uuid16_t(get_uint16(i)); }
+            std::shared_ptr<const uuid_t> get_uuid(const int i, const uuid_t::TypeSize tsize) const {
+                return uuid_t::create(tsize, _data, i, true /* littleEndian */);
+            }
+            uint8_t const * get_ptr(const int i) const { return _data + i; }
+
+            /** Returns a copy of the packed struct T at octet offset i, see TROOctets::get_struct(). */
+            template<typename T>
+            T get_struct(const int i) const {
+                static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+                T res;
+                memcpy(&res, _data + i, sizeof(T));
+                return res;
+            }
+
+            void skip(const int count) { _pos += count; }
+            uint8_t read_uint8() { const uint8_t v = get_uint8(_pos); _pos += 1; return v; }
+            uint16_t read_uint16() { const uint16_t v = get_uint16(_pos); _pos += 2; return v; }
+            uint32_t read_uint32() { const uint32_t v = get_uint32(_pos); _pos += 4; return v; }
+            EUI48 read_eui48() { const EUI48 v = get_eui48(_pos); _pos += sizeof(EUI48); return v; }
+            template<typename T>
+            T read_struct() { const T v = get_struct<T>(_pos); _pos += sizeof(T); return v; }
+
+            std::string toString() const {
+                std::string res("pos "+std::to_string(_pos)+", size "+std::to_string(_size)+": ");
+                appendBytesHexString(res, _data, 0, _size, true /* lsbFirst */, true /* leading0X */);
+                return res;
             }
     };
 
@@ -266,11 +367,51 @@ namespace direct_bt {
      * <p>
      * GATT value (Vol 3, Part F 3.2.4)
      * </p>
+     * <p>
+     * Uses an inline storage as long as the requested capacity fits, otherwise the heap.
+     * The inline storage is either the own small buffer of Defaults::INLINE_CAPACITY octets,
+     * covering the majority of characteristic values, EIR fields and HCI event parameter,
+     * or the larger fixed storage of a derived SOctets.
+     * </p>
      */
     class POctets : public TOctets
     {
+        public:
+            enum Defaults : int {
+                /** Capacity of the own small inline storage, e.g. covering uuid128_t, keys and most characteristic values. */
+                INLINE_CAPACITY = 24
+            };
+
         private:
             int capacity;
+            /** Inline storage in use, either small_storage or owned by derived SOctets. */
+            uint8_t * const sbo_data;
+            const int sbo_capacity;
+            uint8_t small_storage[INLINE_CAPACITY];
+
+            bool isInline(const uint8_t * ptr) const { return ptr == sbo_data; }
+
+            static bool useStorage(const uint8_t * inlineStorage, const int inlineCapacity) {
+                return nullptr != inlineStorage && inlineCapacity > INLINE_CAPACITY;
+            }
+
+            /** Returns the inline storage if newCapacity fits, otherwise a new heap allocation. */
+            uint8_t * allocData(const int newCapacity) {
+                if( newCapacity <= sbo_capacity ) {
+                    return sbo_data;
+                }
+                return static_cast<uint8_t*>( std::malloc(newCapacity) );
+            }
+
+            int allocCapacity(const uint8_t * ptr, const int newCapacity) const {
+                return isInline(ptr) ? sbo_capacity : newCapacity;
+            }
+
+            void freeData(uint8_t * ptr) {
+                if( !isInline(ptr) ) {
+                    free(ptr);
+                }
+            }
 
             void release() {
                 uint8_t * ptr = get_wptr();
@@ -278,33 +419,94 @@ namespace direct_bt {
                     throw InternalError("POctets::release: Null memory", E_FILE_LINE);
                 }
                 TRACE_PRINT("POctets release: %p", ptr);
-                free(ptr);
+                freeData(ptr);
                 setData(nullptr, 0);
                 capacity=0;
             }
 
+            /** Replaces the released memory with a copy of the given data. */
+            void assign(const uint8_t * source, const int size) {
+                uint8_t * ptr = allocData(size);
+                setData(ptr, size);
+                capacity = allocCapacity(ptr, size);
+                if( size > 0 ) {
+                    std::memcpy(ptr, source, size);
+                }
+            }
+
+            /** Moves the given origin's memory into this released instance, leaving origin empty. */
+            void take(POctets &o) {
+                uint8_t * ptr = o.get_wptr();
+                if( o.isInline(ptr) ) {
+                    // inline storage can't be moved, copy
+                    assign(ptr, o.getSize());
+                    o.setSize(0);
+                } else {
+                    setData(ptr, o.getSize());
+                    capacity = o.capacity;
+                    // purge origin
+                    o.setData(o.sbo_data, 0);
+                    o.capacity = o.sbo_capacity;
+                }
+            }
+
+        protected:
+            /**
+             * New buffer using the given inline storage if capacity fits (heap otherwise), used by SOctets.
+             * <p>
+             * The inline storage must outlive this instance.
+             * If nullptr or not larger than Defaults::INLINE_CAPACITY, the own small storage is used.
+             * </p>
+             */
+            POctets(uint8_t * inlineStorage, const int inlineCapacity, const int _capacity, const int _size)
+            : TOctets( nullptr, 0 ), capacity( 0 ),
+              sbo_data( useStorage(inlineStorage, inlineCapacity) ? inlineStorage : small_storage ),
+              sbo_capacity( useStorage(inlineStorage, inlineCapacity) ? inlineCapacity : INLINE_CAPACITY )
+            {
+                if( _capacity < _size ) {
+                    throw IllegalArgumentException("capacity "+std::to_string(_capacity)+" < size "+std::to_string(_size), E_FILE_LINE);
+                }
+                uint8_t * ptr = allocData(_capacity);
+                setData(ptr, _size);
+                capacity = allocCapacity(ptr, _capacity);
+                TRACE_PRINT("POctets ctor-sbo: %p", get_wptr());
+            }
+
+            /** Copy of the given data using the given inline storage if size fits (heap otherwise), used by SOctets. */
+            POctets(uint8_t * inlineStorage, const int inlineCapacity, const uint8_t *_source, const int _size)
+            : POctets(inlineStorage, inlineCapacity, _size, _size)
+            {
+                if( _size > 0 ) {
+                    std::memcpy(get_wptr(), _source, _size);
+                }
+            }
+
+            /** Moved given origin using the given inline storage, used by SOctets. */
+            POctets(uint8_t * inlineStorage, const int inlineCapacity, POctets &&o)
+            : TOctets( nullptr, 0 ), capacity( 0 ),
+              sbo_data( useStorage(inlineStorage, inlineCapacity) ? inlineStorage : small_storage ),
+              sbo_capacity( useStorage(inlineStorage, inlineCapacity) ? inlineCapacity : INLINE_CAPACITY )
+            {
+                take(o);
+                TRACE_PRINT("POctets ctor-move-sbo: %p", get_wptr());
+            }
+
         public:
-            /** Takes ownership (malloc and copy, free) ..*/
+            /** Takes ownership (inline or malloc and copy, free) ..*/
             POctets(const uint8_t *_source, const int _size)
-            : TOctets( static_cast<uint8_t*>( std::malloc(_size) ), _size),
-              capacity( _size )
+            : POctets(nullptr, 0, _source, _size)
             {
-                std::memcpy(get_wptr(), _source, _size);
                 TRACE_PRINT("POctets ctor0: %p", get_wptr());
             }
 
-            /** New buffer (malloc, free) */
+            /** New buffer (inline or malloc, free) */
             POctets(const int _capacity, const int _size)
-            : TOctets( static_cast<uint8_t*>( std::malloc(_capacity) ), _size),
-              capacity( _capacity )
+            : POctets(nullptr, 0, _capacity, _size)
             {
-                if( capacity < getSize() ) {
-                    throw IllegalArgumentException("capacity "+std::to_string(capacity)+" < size "+std::to_string(getSize()), E_FILE_LINE);
-                }
                 TRACE_PRINT("POctets ctor1: %p", get_wptr());
             }
 
-            /** New buffer (malloc, free) */
+            /** New buffer (inline or malloc, free) */
             POctets(const int size)
             : POctets(size, size)
             {
@@ -312,21 +514,14 @@ namespace direct_bt {
             }
 
             POctets(const POctets &_source) noexcept
-            : TOctets( static_cast<uint8_t*>( std::malloc(_source.getSize()) ), _source.getSize()),
-              capacity( _source.getSize() )
+            : POctets(nullptr, 0, _source.get_ptr(), _source.getSize())
             {
-                std::memcpy(get_wptr(), _source.get_ptr(), _source.getSize());
                 TRACE_PRINT("POctets ctor-cpy0: %p", get_wptr());
             }
 
             POctets(POctets &&o) noexcept
-            : TOctets( o.get_wptr(), o.getSize()),
-              capacity( o.getCapacity() )
+            : POctets(nullptr, 0, std::move(o))
             {
-                // moved origin data references
-                // purge origin
-                o.setData(nullptr, 0);
-                o.capacity = 0;
                 TRACE_PRINT("POctets ctor-move0: %p", get_wptr());
             }
 
@@ -335,32 +530,32 @@ namespace direct_bt {
                     return *this;
                 }
                 release();
-                setData(static_cast<uint8_t*>( std::malloc(_source.getSize()) ), _source.getSize());
-                capacity = _source.getSize();
-                std::memcpy(get_wptr(), _source.get_ptr(), _source.getSize());
+                assign(_source.get_ptr(), _source.getSize());
                 TRACE_PRINT("POctets assign0: %p", get_wptr());
                 return *this;
             }
 
             POctets& operator=(POctets &&o) noexcept {
-                // move origin data references
-                setData(o.get_wptr(), o.getSize());
-                capacity = o.capacity;
-                // purge origin
-                o.setData(nullptr, 0);
-                o.capacity = 0;
+                if( this == &o ) {
+                    return *this;
+                }
+                release();
+                take(o);
                 TRACE_PRINT("POctets assign-move0: %p", get_wptr());
                 return *this;
             }
 
-            ~POctets() { release(); }
+            ~POctets() {
+                uint8_t * ptr = get_wptr();
+                if( nullptr != ptr ) {
+                    release();
+                }
+            }
 
             /** Makes a persistent POctets by copying the data from TROOctets. */
             POctets(const TROOctets & _source)
-            : TOctets( static_cast<uint8_t*>( std::malloc(_source.getSize()) ), _source.getSize()),
-              capacity( _source.getSize() )
+            : POctets(nullptr, 0, _source.get_ptr(), _source.getSize())
             {
-                std::memcpy(get_wptr(), _source.get_ptr(), _source.getSize());
                 TRACE_PRINT("POctets ctor-cpy1: %p", get_wptr());
             }
 
@@ -369,27 +564,21 @@ namespace direct_bt {
                     return *this;
                 }
                 release();
-                setData(static_cast<uint8_t*>( std::malloc(_source.getSize()) ), _source.getSize());
-                capacity = _source.getSize();
-                std::memcpy(get_wptr(), _source.get_ptr(), _source.getSize());
+                assign(_source.get_ptr(), _source.getSize());
                 TRACE_PRINT("POctets assign1: %p", get_wptr());
                 return *this;
             }
 
             /** Makes a persistent POctets by copying the data from TOctetSlice. */
             POctets(const TOctetSlice & _source)
-            : TOctets( static_cast<uint8_t*>( std::malloc(_source.getSize()) ), _source.getSize()),
-              capacity( _source.getSize() )
+            : POctets(nullptr, 0, _source.getParent().get_ptr() + _source.getOffset(), _source.getSize())
             {
-                std::memcpy(get_wptr(), _source.getParent().get_ptr() + _source.getOffset(), _source.getSize());
                 TRACE_PRINT("POctets ctor-cpy2: %p", get_wptr());
             }
 
             POctets& operator=(const TOctetSlice &_source) {
                 release();
-                setData(static_cast<uint8_t*>( std::malloc(_source.getSize()) ), _source.getSize());
-                capacity = _source.getSize();
-                std::memcpy(get_wptr(), _source.get_ptr(0), _source.getSize());
+                assign(_source.getParent().get_ptr() + _source.getOffset(), _source.getSize());
                 TRACE_PRINT("POctets assign2: %p", get_wptr());
                 return *this;
             }
@@ -427,14 +616,16 @@ namespace direct_bt {
                 if( newCapacity == capacity ) {
                     return *this;
                 }
-                uint8_t* data2 = static_cast<uint8_t*>( std::malloc(newCapacity) );
-                if( getSize() > 0 ) {
-                    memcpy(data2, get_ptr(), getSize());
+                uint8_t* data2 = allocData(newCapacity);
+                if( data2 != get_wptr() ) {
+                    if( getSize() > 0 ) {
+                        memcpy(data2, get_ptr(), getSize());
+                    }
+                    TRACE_PRINT("POctets recapacity: %p -> %p", get_wptr(), data2);
+                    freeData(get_wptr());
+                    setData(data2, getSize());
                 }
-                TRACE_PRINT("POctets recapacity: %p -> %p", get_wptr(), data2);
-                free(get_wptr());
-                setData(data2, getSize());
-                capacity = newCapacity;
+                capacity = allocCapacity(data2, newCapacity);
                 return *this;
             }
 
@@ -464,11 +655,78 @@ namespace direct_bt {
             }
 
             std::string toString() const {
-                return "size "+std::to_string(getSize())+", capacity "+std::to_string(getCapacity())+", l->h: "+bytesHexString(get_ptr(), 0, getSize(), true /* lsbFirst */, true /* leading0X */);
+                std::string res("size "+std::to_string(getSize())+", capacity "+std::to_string(getCapacity())+", l->h: ");
+                appendBytesHexString(res, get_ptr(), 0, getSize(), true /* lsbFirst */, true /* leading0X */);
+                return res;
             }
     };
 
 
+    /**
+     * Inline storage base of SOctets, initialized before its POctets base.
+     */
+    template<int InlineCapacity>
+    class SOctetsStorage {
+        protected:
+            uint8_t sbo_storage[InlineCapacity];
+    };
+
+    /**
+     * Persistent octet data using a fixed inline storage of InlineCapacity octets,
+     * i.e. small buffer optimized POctets.
+     * <p>
+     * Requires no heap allocation as long as the capacity doesn't exceed InlineCapacity,
+     * hence suitable for stack allocated outgoing PDUs of bounded size.
+     * </p>
+     */
+    template<int InlineCapacity>
+    class SOctets : private SOctetsStorage<InlineCapacity>, public POctets
+    {
+        public:
+            /** Copy of given data (inline if size fits) */
+            SOctets(const uint8_t *_source, const int _size)
+            : POctets(this->sbo_storage, InlineCapacity, _source, _size) {}
+
+            /** New buffer (inline if capacity fits) */
+            SOctets(const int _capacity, const int _size)
+            : POctets(this->sbo_storage, InlineCapacity, _capacity, _size) {}
+
+            /** New buffer (inline if size fits) */
+            SOctets(const int size)
+            : POctets(this->sbo_storage, InlineCapacity, size, size) {}
+
+            /** New buffer of zero size using the inline storage */
+            SOctets()
+            : POctets(this->sbo_storage, InlineCapacity, InlineCapacity, 0) {}
+
+            SOctets(const SOctets &_source)
+            : POctets(this->sbo_storage, InlineCapacity, _source.get_ptr(), _source.getSize()) {}
+
+            SOctets(SOctets &&o)
+            : POctets(this->sbo_storage, InlineCapacity, std::move(o)) {}
+
+            /** Makes a persistent SOctets by copying the data from TROOctets. */
+            SOctets(const TROOctets & _source)
+            : POctets(this->sbo_storage, InlineCapacity, _source.get_ptr(), _source.getSize()) {}
+
+            SOctets& operator=(const SOctets &_source) {
+                POctets::operator=(_source);
+                return *this;
+            }
+            SOctets& operator=(SOctets &&o) {
+                POctets::operator=(std::move(o));
+                return *this;
+            }
+            SOctets& operator=(const TROOctets &_source) {
+                POctets::operator=(_source);
+                return *this;
+            }
+
+            ~SOctets() {}
+
+            static constexpr int getInlineCapacity() { return InlineCapacity; }
+    };
+
 }
 
 
@@ -0,0 +1,224 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef OVERFLOWRINGBUFFER_HPP_
+#define OVERFLOWRINGBUFFER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+#include "BasicTypes.hpp"
+#include "DBTEnv.hpp"
+
+#include "Ringbuffer.hpp"
+#include "LFRingbuffer.hpp"
+#include "SPSCRingbuffer.hpp"
+
+namespace direct_bt {
+
+/**
+ * Producer side overflow counters of one OverflowRingbuffer.
+ */
+struct RingStats {
+    /** Maximum observed size after an offer. */
+    std::atomic<int32_t> highWater;
+    /** Number of dropped elements, old or new. */
+    std::atomic<uint64_t> drops;
+    /** Number of offers blocked on a full ring. */
+    std::atomic<uint64_t> blocked;
+    /** Accumulated time in microseconds offers were blocked on a full ring. */
+    std::atomic<uint64_t> blockedMicros;
+    /** Number of capacity increases. */
+    std::atomic<int32_t> grows;
+
+    RingStats() : highWater(0), drops(0), blocked(0), blockedMicros(0), grows(0) {}
+
+    std::string toString() const {
+        return "RingStats[highWater "+std::to_string(highWater)+", drops "+std::to_string(drops)+
+               ", blocked "+std::to_string(blocked)+" / "+std::to_string(blockedMicros)+" us, grows "+std::to_string(grows)+"]";
+    }
+};
+
+/**
+ * {@link Ringbuffer} applying a configurable DBTRingOptions::OverflowPolicy
+ * to its producer's {@link #offer(T&&) offer(..)} and maintaining RingStats,
+ * allowing to size reader rings from production data.
+ * <p>
+ * All {@link Ringbuffer} operations are delegated unchanged to the implementation.
+ * </p>
+ * <p>
+ * A ring with one producer and one consumer thread uses the wait-free SPSCRingbuffer
+ * for DBTRingOptions::OverflowPolicy::DROP_NEWEST and DBTRingOptions::OverflowPolicy::BLOCK.
+ * DBTRingOptions::OverflowPolicy::DROP_OLDEST and DBTRingOptions::OverflowPolicy::GROW
+ * remove or resize from the producer side and hence always use the LFRingbuffer.
+ * </p>
+ */
+template <typename T, std::nullptr_t nullelem> class OverflowRingbuffer : public Ringbuffer<T> {
+    private:
+        const DBTRingOptions options;
+        std::unique_ptr<Ringbuffer<T>> ring;
+        RingStats stats;
+
+        static Ringbuffer<T> * createRing(const int capacity, const DBTRingOptions & options, const bool spsc) {
+            if( spsc && ( DBTRingOptions::OverflowPolicy::DROP_NEWEST == options.POLICY ||
+                          DBTRingOptions::OverflowPolicy::BLOCK == options.POLICY ) )
+            {
+                return new SPSCRingbuffer<T, nullelem>(capacity);
+            }
+            return new LFRingbuffer<T, nullelem>(capacity);
+        }
+
+        void updateHighWater() {
+            const int32_t size = ring->getSize();
+            int32_t hw = stats.highWater.load(std::memory_order_relaxed);
+            while( size > hw && !stats.highWater.compare_exchange_weak(hw, size, std::memory_order_relaxed) ) { }
+        }
+
+    public:
+        /**
+         * @param capacity initial net capacity
+         * @param options_ the overflow policy and limits
+         * @param spsc pass true if the ring is only used by one producer and one consumer thread at a time,
+         *        allowing the wait-free SPSCRingbuffer if supported by the policy.
+         */
+        OverflowRingbuffer(const int capacity, const DBTRingOptions & options_, const bool spsc)
+        : options(options_), ring(createRing(capacity, options_, spsc))
+        { }
+
+        const DBTRingOptions & getOptions() const { return options; }
+
+        const RingStats & getStats() const { return stats; }
+
+        /**
+         * Enqueues the given element by moving it into the buffer, applying the overflow policy on a full ring.
+         * <p>
+         * Returns true if successful, otherwise false if the new element has been dropped and <code>e</code> is left untouched.
+         * </p>
+         */
+        bool offer(T && e) {
+            if( ring->put(std::move(e)) ) {
+                updateHighWater();
+                return true;
+            }
+            switch( options.POLICY ) {
+                case DBTRingOptions::OverflowPolicy::DROP_OLDEST:
+                    do {
+                        stats.drops += ring->drop( std::max(1, ring->capacity()/4) );
+                    } while( !ring->put(std::move(e)) );
+                    updateHighWater();
+                    return true;
+
+                case DBTRingOptions::OverflowPolicy::BLOCK: {
+                    const uint64_t t0 = getCurrentMicroseconds();
+                    const bool res = ring->putBlocking(std::move(e), options.BLOCK_TIMEOUT);
+                    stats.blocked++;
+                    stats.blockedMicros += getCurrentMicroseconds() - t0;
+                    if( res ) {
+                        updateHighWater();
+                        return true;
+                    }
+                    break;
+                }
+
+                case DBTRingOptions::OverflowPolicy::GROW: {
+                    const int cap = ring->capacity();
+                    if( cap < options.MAX_CAPACITY ) {
+                        ring->recapacity( std::min(options.MAX_CAPACITY, 2*cap) );
+                        stats.grows++;
+                        if( ring->put(std::move(e)) ) {
+                            updateHighWater();
+                            return true;
+                        }
+                    }
+                    break;
+                }
+
+                default:
+                    break;
+            }
+            stats.drops++;
+            return false;
+        }
+
+        std::string toString() const override {
+            return "OverflowRingbuffer["+ring->toString()+", "+options.toString()+", "+stats.toString()+"]";
+        }
+
+        void dump(FILE *stream, std::string prefix) const override { ring->dump(stream, prefix); }
+
+        int capacity() const override { return ring->capacity(); }
+
+        void clear() override { ring->clear(); }
+
+        void reset(const T * copyFrom, const int copyFromCount) override { ring->reset(copyFrom, copyFromCount); }
+
+        void reset(const std::vector<T> & copyFrom) override { ring->reset(copyFrom); }
+
+        int getSize() const override { return ring->getSize(); }
+
+        int getFreeSlots() const override { return ring->getFreeSlots(); }
+
+        bool isEmpty() const override { return ring->isEmpty(); }
+
+        bool isFull() const override { return ring->isFull(); }
+
+        T get() override { return ring->get(); }
+
+        T getBlocking(const int timeoutMS=0) override { return ring->getBlocking(timeoutMS); }
+
+        int getAll(T * dest, const int max, const int timeoutMS=-1) override { return ring->getAll(dest, max, timeoutMS); }
+
+        T peek() override { return ring->peek(); }
+
+        T peekBlocking(const int timeoutMS=0) override { return ring->peekBlocking(timeoutMS); }
+
+        int drop(const int count) override { return ring->drop(count); }
+
+        bool put(const T & e) override { return ring->put(e); }
+
+        bool put(T && e) override { return ring->put(std::move(e)); }
+
+        bool putBlocking(const T & e, const int timeoutMS=0) override { return ring->putBlocking(e, timeoutMS); }
+
+        bool putBlocking(T && e, const int timeoutMS=0) override { return ring->putBlocking(std::move(e), timeoutMS); }
+
+        int putAll(const T * src, const int count) override { return ring->putAll(src, count); }
+
+        bool putSame() override { return ring->putSame(); }
+
+        bool putSameBlocking(const int timeoutMS=0) override { return ring->putSameBlocking(timeoutMS); }
+
+        void waitForFreeSlots(const int count) override { ring->waitForFreeSlots(count); }
+
+        void recapacity(const int newCapacity) override { ring->recapacity(newCapacity); }
+};
+
+} /* namespace direct_bt */
+
+#endif /* OVERFLOWRINGBUFFER_HPP_ */
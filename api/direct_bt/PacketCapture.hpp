@@ -0,0 +1,163 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PACKET_CAPTURE_HPP_
+#define PACKET_CAPTURE_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+namespace direct_bt {
+
+    /**
+     * Binary packet capture of all HCI, L2CAP and Mgmt traffic into rolling btsnoop files,
+     * using the Linux Bluetooth Monitor datalink (2001), i.e. readable by Wireshark and btmon.
+     * <p>
+     * Producers copy each packet into a preallocated slot of a bounded lock-free queue,
+     * dropping the packet if the queue is full.
+     * A background writer thread drains the queue into memory mapped files of fixed size,
+     * rolling over to the next of a fixed number of files.
+     * </p>
+     * <p>
+     * L2CAP socket data lacks its ACL and L2CAP headers, which are synthesized
+     * from the device's connection handle and the socket's channel id.
+     * </p>
+     * <p>
+     * Controlling Environment variables:
+     * <pre>
+     * - 'direct_bt.capture': File path prefix, files are named '<prefix>.<index>.btsnoop'. Capture is disabled if not set.
+     * - 'direct_bt.capture.file.size': Size of each file in bytes, defaults to 16 MiB.
+     * - 'direct_bt.capture.files': Number of rolling files, defaults to 4.
+     * - 'direct_bt.capture.slots': Number of queued packets, rounded up to a power of two, defaults to 1024.
+     * </pre>
+     * </p>
+     */
+    class PacketCapture {
+        public:
+            /** Linux Bluetooth Monitor opcodes, used as btsnoop record flags */
+            enum class Opcode : uint16_t {
+                COMMAND_PKT  =  2,
+                EVENT_PKT    =  3,
+                ACL_TX_PKT   =  4,
+                ACL_RX_PKT   =  5,
+                CTRL_COMMAND = 16,
+                CTRL_EVENT   = 17
+            };
+
+            enum Defaults : int32_t {
+                /* Maximum captured packet size: HCI_MAX_FRAME_SIZE plus synthesized headers, larger packets are truncated. */
+                SLOT_DATA_SIZE = 1040,
+                /* Monitor index of packets not related to an adapter */
+                INDEX_NONE = 0xffff
+            };
+
+        private:
+            struct Slot {
+                std::atomic<size_t> sequence;
+                uint64_t timestamp; // microseconds since epoch
+                uint32_t flags;
+                uint32_t orig_len;
+                uint32_t incl_len;
+                uint8_t data[SLOT_DATA_SIZE];
+            };
+
+            const std::string path;
+            const size_t fileSize;
+            const int fileCount;
+            const size_t slotMask;
+            std::unique_ptr<Slot[]> slots;
+            std::atomic<size_t> enqueuePos;
+            size_t dequeuePos;
+            std::atomic<uint64_t> dropCount;
+            std::atomic<uint64_t> writeCount;
+
+            std::atomic<bool> running;
+            std::thread writerThread;
+
+            int fileIndex;
+            int fd;
+            uint8_t * map;
+            size_t mapUsed;
+
+            bool openFile();
+            void closeFile();
+            void writeRecord(const Slot & slot);
+            void writerImpl();
+
+            PacketCapture(const PacketCapture&) = delete;
+            void operator=(const PacketCapture&) = delete;
+
+        public:
+            /**
+             * Creates and starts a capture with the given parameter, an empty path disables capturing.
+             */
+            PacketCapture(const std::string & path, const size_t fileSize, const int fileCount, const size_t slotCount);
+
+            /** Stops the writer after draining all queued packets and closes the current file. */
+            ~PacketCapture();
+
+            /** Returns the capture configured by the environment, see class description. */
+            static PacketCapture& get();
+
+            bool isEnabled() const { return running; }
+
+            /** Returns the file name of the given rolling index. */
+            std::string getFileName(const int index) const;
+
+            /** Returns the number of packets dropped due to a full queue. */
+            uint64_t getDropCount() const { return dropCount.load(); }
+
+            /** Returns the number of packets written to file. */
+            uint64_t getWriteCount() const { return writeCount.load(); }
+
+            /**
+             * Queues one packet, composed of an optional prefix and the payload, without blocking.
+             * @return false if capture is disabled or the queue is full
+             */
+            bool capture(const uint16_t index, const Opcode opcode, const uint8_t * prefix, const int prefixLen,
+                         const uint8_t * data, const int len);
+
+            /** Captures a HCI packet starting with its H4 packet type, as used on the HCI raw channel. */
+            void captureHCI(const uint16_t dev_id, const uint8_t * buffer, const int len, const bool incoming);
+
+            /** Captures a Mgmt command or event, starting with its Mgmt header. */
+            void captureMgmt(const uint8_t * buffer, const int len, const bool incoming);
+
+            /** Captures L2CAP socket data as ACL data, synthesizing the ACL and L2CAP basic header. */
+            void captureL2CAP(const uint16_t dev_id, const uint16_t handle, const uint16_t cid,
+                              const uint8_t * buffer, const int len, const bool incoming);
+
+            /** Stops the writer after draining all queued packets and closes the current file. */
+            void stop();
+    };
+
+} // namespace direct_bt
+
+#endif /* PACKET_CAPTURE_HPP_ */
@@ -0,0 +1,157 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PACKET_REPLAY_HPP_
+#define PACKET_REPLAY_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "BTAddress.hpp"
+
+namespace direct_bt {
+
+    class DBTDevice; // forward
+
+    /**
+     * Replays a btsnoop file recorded by PacketCapture into direct_bt,
+     * injecting the received HCI events and ATT PDUs below HCIComm and L2CAPComm via their pluggable transports,
+     * see HCIComm::setTransport() and L2CAPComm::setTransport().
+     * <p>
+     * Hence the replayed packets are processed by the regular HCIHandler and GATTHandler reader threads,
+     * allowing to reproduce recorded load offline at the original or an accelerated speed.
+     * </p>
+     * <p>
+     * The trace is memory mapped read-only. Replay starts once an HCIComm of the given dev_id has been opened
+     * while this replay is started, i.e. by constructing an HCIHandler, e.g. via DBTAdapter.
+     * </p>
+     * <p>
+     * Only unsolicited packets are replayed: HCI events except CMD_COMPLETE and CMD_STATUS,
+     * as well as ATT notifications and indications of a connected ATT channel.
+     * Commands and requests of the host are answered locally:
+     * HCI commands by a successful CMD_COMPLETE with zeroed return parameter, or CMD_STATUS for the asynchronous commands,
+     * ATT_EXCHANGE_MTU_REQ by echoing the MTU and all other ATT requests by ATT_ERROR_RSP 'request not supported'.
+     * Mgmt events are not replayed.
+     * </p>
+     * <p>
+     * Only one replay can be started at a time.
+     * </p>
+     */
+    class PacketReplay {
+        public:
+            enum Defaults : int32_t {
+                /* Monitor index matching all adapters of the trace */
+                INDEX_ANY = 0xffff
+            };
+
+        private:
+            const std::string path;
+            const double speed;
+            const uint16_t dev_id;
+            const uint16_t traceIndex;
+
+            int fd;
+            uint8_t * map;
+            size_t mapSize;
+
+            std::atomic<int> hciFD; // replay end of the HCI channel
+            std::atomic<int> attFD; // replay end of the ATT channel
+            std::atomic<bool> running;
+            std::atomic<bool> done;
+            std::atomic<uint64_t> hciCount;
+            std::atomic<uint64_t> attCount;
+            std::atomic<uint64_t> skipCount;
+
+            std::mutex mtx_state;
+            std::condition_variable cv_state;
+            std::thread replayThread;
+            std::thread responderThread;
+
+            static int openHCI(const uint16_t dev_id, const uint16_t channel);
+            static int connectL2CAP(const DBTDevice & device, const uint16_t psm, const uint16_t cid);
+
+            void replayImpl();
+            void responderImpl();
+            void respondHCI(const uint8_t * buffer, const int len);
+            void respondATT(const uint8_t * buffer, const int len);
+
+            PacketReplay(const PacketReplay&) = delete;
+            void operator=(const PacketReplay&) = delete;
+
+        public:
+            /**
+             * Maps the given btsnoop file using the Linux Bluetooth Monitor datalink, see PacketCapture.
+             * @param path the btsnoop file
+             * @param speed replay speed factor of the recorded timing, e.g. 1.0 for the original and 10.0 for ten times faster,
+             *        zero or negative to replay as fast as possible
+             * @param dev_id the adapter's dev_id receiving the replay
+             * @param traceIndex the trace's monitor index to replay, INDEX_ANY for all
+             */
+            PacketReplay(const std::string & path, const double speed=1.0, const uint16_t dev_id=0, const uint16_t traceIndex=INDEX_ANY);
+
+            /** Stops the replay, see stop(), and unmaps the trace. */
+            ~PacketReplay();
+
+            /** Returns true if the trace has been mapped and is a btsnoop monitor trace. */
+            bool isValid() const { return nullptr != map; }
+
+            /**
+             * Installs the transports and starts the replay, waiting for the HCI channel to be opened.
+             * @return false if the trace is invalid or another replay is running
+             */
+            bool start();
+
+            /** Stops the replay, closes the injected channels and restores the default transports. */
+            void stop();
+
+            /** Returns true if all packets of the trace have been replayed. */
+            bool isDone() const { return done; }
+
+            /**
+             * Waits until all packets of the trace have been replayed or the timeout expired.
+             * @param timeoutMS timeout in milliseconds, zero for infinite
+             * @return true if done
+             */
+            bool waitUntilDone(const int32_t timeoutMS);
+
+            /** Returns the number of replayed HCI events. */
+            uint64_t getHCICount() const { return hciCount.load(); }
+
+            /** Returns the number of replayed ATT PDUs. */
+            uint64_t getATTCount() const { return attCount.load(); }
+
+            /** Returns the number of skipped packets, i.e. solicited or lacking a receiving channel. */
+            uint64_t getSkipCount() const { return skipCount.load(); }
+    };
+
+} // namespace direct_bt
+
+#endif /* PACKET_REPLAY_HPP_ */
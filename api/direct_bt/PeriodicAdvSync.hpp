@@ -0,0 +1,189 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PERIODIC_ADV_SYNC_HPP_
+#define PERIODIC_ADV_SYNC_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+
+#include "BTTypes.hpp"
+#include "OctetTypes.hpp"
+#include "HCITypes.hpp"
+
+namespace direct_bt {
+
+    /**
+     * Established periodic advertising sync, see HCIHandler::le_create_periodic_sync().
+     * <p>
+     * BT Core Spec v5.2: Vol 4, Part E HCI: 7.7.65.14 LE Periodic Advertising Sync Established event
+     * </p>
+     */
+    class PeriodicAdvSyncInfo {
+        public:
+            uint16_t handle;
+            /** Advertising SID of the periodic advertiser */
+            uint8_t sid;
+            /** Address type of the periodic advertiser, see EInfoReport::setADAddressType() */
+            uint8_t ad_address_type;
+            EUI48 address;
+            /** Advertiser PHY, 0x01 LE 1M, 0x02 LE 2M or 0x03 LE Coded */
+            uint8_t phy;
+            /** Periodic advertising interval in units of 1.25ms */
+            uint16_t interval;
+
+            PeriodicAdvSyncInfo()
+            : handle(0), sid(0), ad_address_type(0), address(), phy(0), interval(0) {}
+
+            std::string toString() const;
+    };
+
+    /**
+     * Listener of one periodic advertising sync, see HCIHandler::le_create_periodic_sync().
+     * <p>
+     * All methods are invoked on the HCI reader thread, hence shall return quickly.
+     * </p>
+     */
+    class PeriodicAdvSyncListener {
+        public:
+            /**
+             * Receives all complete periodic advertising reports of the given sync
+             * received within one HCI read batch, reassembled from their fragments.
+             */
+            virtual void periodicAdvReports(const PeriodicAdvSyncInfo & sync, const EInfoReportBatch & reports) = 0;
+
+            /**
+             * The given sync has been lost, e.g. due to its sync timeout, and has been removed already.
+             */
+            virtual void periodicAdvSyncLost(const PeriodicAdvSyncInfo & sync) { (void)sync; }
+
+            virtual ~PeriodicAdvSyncListener() {}
+    };
+
+    /**
+     * Routing table of the periodic advertising syncs of one HCIHandler,
+     * parsing the periodic advertising HCI LE meta events on the HCI reader thread.
+     * <p>
+     * Each report is routed via its sync handle in constant time to the sync's own PeriodicAdvSyncListener.
+     * Reports are reassembled from their fragments per sync
+     * and held back until flush() at the end of each HCI read batch,
+     * delivering one EInfoReportBatch per sync and read batch.
+     * </p>
+     * <p>
+     * The controller allows only one outstanding create sync request,
+     * tracked via beginCreate(), awaitCreate() and endCreate().
+     * </p>
+     */
+    class PeriodicAdvSyncTable {
+        private:
+            struct Entry {
+                PeriodicAdvSyncInfo info;
+                std::shared_ptr<PeriodicAdvSyncListener> listener;
+                /** Reassembly of fragmented reports, reader thread only */
+                POctets fragment;
+                bool fragmentPending;
+                /** Complete reports of the current read batch, reader thread only */
+                EInfoReportBatch batch;
+
+                Entry(const int fragmentCapacity)
+                : info(), listener(nullptr), fragment(fragmentCapacity, 0), fragmentPending(false), batch() {}
+            };
+
+            const int fragmentCapacity;
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::unordered_map<uint16_t, std::shared_ptr<Entry>> syncs;
+            /** Entries with reports of the current read batch, reader thread only */
+            std::vector<std::shared_ptr<Entry>> dirty;
+            /** The one outstanding create sync request, if any */
+            std::shared_ptr<Entry> pending;
+            bool pendingDone;
+            HCIStatusCode pendingStatus;
+
+            std::shared_ptr<Entry> find(const uint16_t handle);
+            void flush(Entry & e);
+
+        public:
+            /** Maximum periodic advertising data length, BT Core Spec v5.2: Vol 6, Part B: 2.3.4.9 */
+            static constexpr int MAX_DATA_LEN = 1650;
+
+            PeriodicAdvSyncTable(const int fragmentCapacity_=MAX_DATA_LEN)
+            : fragmentCapacity(fragmentCapacity_), pending(nullptr), pendingDone(false), pendingStatus(HCIStatusCode::UNKNOWN) {}
+
+            PeriodicAdvSyncTable(const PeriodicAdvSyncTable&) = delete;
+            void operator=(const PeriodicAdvSyncTable&) = delete;
+
+            /**
+             * Registers the outstanding create sync request of the given advertiser.
+             * @return false if another create sync request is outstanding
+             */
+            bool beginCreate(const uint8_t sid, const uint8_t ad_address_type, const EUI48 & address,
+                             const std::shared_ptr<PeriodicAdvSyncListener> & listener);
+
+            /**
+             * Waits for the LE_PERIODIC_ADV_SYNC_ESTABLISHED event of the outstanding create sync request.
+             * @param timeoutMS maximum time to wait
+             * @param handle returns the sync handle if successful
+             * @return the event's status or HCIStatusCode::INTERNAL_TIMEOUT
+             */
+            HCIStatusCode awaitCreate(const int32_t timeoutMS, uint16_t & handle);
+
+            /** Drops the outstanding create sync request. */
+            void endCreate();
+
+            /** Removes the given sync, e.g. after terminating it. Returns true if removed. */
+            bool remove(const uint16_t handle);
+
+            /** Removes all syncs and any outstanding create sync request. */
+            void clear();
+
+            /** Returns the number of established syncs. */
+            int size();
+
+            /** Returns a snapshot of all established syncs. */
+            std::vector<PeriodicAdvSyncInfo> getSyncs();
+
+            /** Parses the LE_PERIODIC_ADV_SYNC_ESTABLISHED meta event parameter, reader thread only. */
+            void processSyncEstablished(const uint8_t * data, const int data_length);
+
+            /** Parses the LE_PERIODIC_ADV_REPORT meta event parameter, reader thread only. */
+            void processReport(const uint8_t * data, const int data_length, const uint64_t timestamp);
+
+            /** Parses the LE_PERIODIC_ADV_SYNC_LOST meta event parameter, reader thread only. */
+            void processSyncLost(const uint8_t * data, const int data_length);
+
+            /** Delivers the held back reports of the current read batch, reader thread only. */
+            void flush();
+    };
+
+} // namespace direct_bt
+
+#endif /* PERIODIC_ADV_SYNC_HPP_ */
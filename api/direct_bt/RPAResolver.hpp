@@ -0,0 +1,164 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef RPA_RESOLVER_HPP_
+#define RPA_RESOLVER_HPP_
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include <mutex>
+
+#include "BTAddress.hpp"
+#include "MgmtTypes.hpp"
+
+namespace direct_bt {
+
+    /**
+     * AES-128 block cipher, encryption only, as required by the SMP security function e().
+     * <p>
+     * FIPS-197, BT Core Spec v5.2: Vol 3, Part H SMP: 2.2.1 Security function e
+     * </p>
+     * <p>
+     * Uses the AES-NI or ARMv8 Cryptography Extension instructions if enabled at compile time,
+     * i.e. if <code>__AES__</code> or <code>__ARM_FEATURE_CRYPTO</code> is defined, otherwise a portable implementation.
+     * </p>
+     */
+    class AES128 {
+        public:
+            enum Defaults : int {
+                BLOCK_SIZE = 16,
+                ROUNDS = 10
+            };
+
+        private:
+            /** Expanded key schedule, (ROUNDS+1) round keys in FIPS-197 byte order */
+            uint8_t roundKeys[(ROUNDS+1)*BLOCK_SIZE];
+
+        public:
+            /**
+             * @param key the 128-bit key, most significant octet first as in FIPS-197
+             */
+            AES128(const uint8_t key[BLOCK_SIZE]);
+
+            /**
+             * Encrypts the given block, most significant octet first as in FIPS-197.
+             * In and out may be the same buffer.
+             */
+            void encrypt(const uint8_t in[BLOCK_SIZE], uint8_t out[BLOCK_SIZE]) const;
+
+            /** Returns true if the hardware accelerated implementation is used. */
+            static bool isAccelerated();
+    };
+
+    /**
+     * Resolves resolvable private addresses (RPA) to their identity address
+     * via an Identity Resolving Key (IRK) table and an address to identity cache.
+     * <p>
+     * BT Core Spec v5.2: Vol 6, Part B LL: 1.3.2.3 Private address resolution
+     * and Vol 3, Part H SMP: 2.2.2 Random Address Hash function ah.
+     * </p>
+     * <p>
+     * Each new RPA costs one AES-128 operation per IRK until resolved,
+     * after which it is served from the cache, as are unresolvable RPAs.
+     * The cache is cleared if it exceeds CACHE_CAPACITY or the IRK table changes.
+     * </p>
+     */
+    class RPAResolver {
+        public:
+            enum Defaults : int32_t {
+                CACHE_CAPACITY = 1024
+            };
+
+        private:
+            struct IRKEntry {
+                BDAddressKey identity;
+                AES128 cipher;
+                /** Most recently resolved RPA, EUI48_ANY_DEVICE if none */
+                EUI48 lastRPA;
+
+                IRKEntry(const BDAddressKey & identity_, const AES128 & cipher_)
+                : identity(identity_), cipher(cipher_), lastRPA(EUI48_ANY_DEVICE) {}
+            };
+            mutable std::mutex mtx_irks;
+            std::vector<IRKEntry> irks;
+            /** RPA to index in irks, -1 for an unresolvable RPA */
+            std::unordered_map<EUI48, int> cache;
+
+        public:
+            RPAResolver() {}
+
+            /** Returns true if the given address is a resolvable private address. */
+            static bool isResolvablePrivateAddress(const EUI48 & address, const BDAddressType addressType) {
+                return BLERandomAddressType::RESOLVABLE_PRIVAT == address.getBLERandomAddressType(addressType);
+            }
+
+            /**
+             * SMP random address hash function ah, returning the 24-bit hash of the 24-bit prand.
+             * @param cipher AES128 instance of the IRK
+             * @param prand the random part of the RPA, i.e. its three most significant octets
+             */
+            static uint32_t ah(const AES128 & cipher, const uint32_t prand);
+
+            /**
+             * Returns the AES128 instance of the given IRK as distributed via SMP or Mgmt, i.e. least significant octet first.
+             */
+            static AES128 createCipher(const uint8_t irk[AES128::BLOCK_SIZE]);
+
+            /** Adds or replaces the IRK of the given identity. */
+            void add(const MgmtIdentityResolvingKeyInfo & key);
+
+            /** Removes the IRK of the given identity, returns true if removed. */
+            bool remove(const EUI48 & address, const BDAddressType addressType);
+
+            /** Removes all IRKs. */
+            void clear();
+
+            /** Returns the number of IRKs. */
+            size_t size() const;
+
+            /**
+             * Resolves the given address to its identity.
+             * @param address the address to resolve
+             * @param addressType the address type
+             * @param identity receives the identity address if resolved
+             * @return true if the given address is a resolvable private address resolved by a known IRK, otherwise false
+             */
+            bool resolve(const EUI48 & address, const BDAddressType addressType, BDAddressKey & identity);
+
+            /**
+             * Retrieves the most recently resolved RPA of the given identity, e.g. to connect to the identity.
+             * @return true if the identity has a resolved RPA, otherwise false
+             */
+            bool getPrivateAddress(const EUI48 & address, const BDAddressType addressType, EUI48 & rpa) const;
+    };
+
+} // namespace direct_bt
+
+#endif /* RPA_RESOLVER_HPP_ */
@@ -30,11 +30,37 @@
 #include <string>
 #include <memory>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 
 #include "BasicTypes.hpp"
 
 namespace direct_bt {
 
+/**
+ * Element assignment used by {@link Ringbuffer} implementations,
+ * allowing move-only element types like <code>std::unique_ptr</code>.
+ * <p>
+ * Copying a move-only element, i.e. via the <code>const T &</code> put variants, peek or reset,
+ * throws an UnsupportedOperationException.
+ * </p>
+ */
+template <class T> struct RingbufferElement {
+    static void assign(T & dest, T && src) { dest = std::move(src); }
+    static void assign(T & dest, const T & src) { copy(dest, src, std::is_copy_assignable<T>()); }
+
+    /** Moves from a mutable source, copies from a const source. */
+    static void store(T & dest, T & src) { dest = std::move(src); }
+    static void store(T & dest, const T & src) { copy(dest, src, std::is_copy_assignable<T>()); }
+
+    private:
+        static void copy(T & dest, const T & src, std::true_type) { dest = src; }
+        static void copy(T & dest, const T & src, std::false_type) {
+            (void)dest;
+            (void)src;
+            throw UnsupportedOperationException("Ringbuffer: copy of move-only element", E_FILE_LINE);
+        }
+};
 
 /**
  * Ring buffer interface, a.k.a circular buffer.
@@ -46,6 +72,13 @@ namespace direct_bt {
  * or using a preset array for circular access of same objects.
  * </p>
  * <p>
+ * Element type <code>T</code> must be default constructible and constructible as well as assignable
+ * from the implementation's <code>nullelem</code>, denoting an empty slot.
+ * Besides pointer and smart pointer types, this allows plain value types providing such an empty state.<br>
+ * Move-only types are supported via the <code>T &&</code> put variants and get,
+ * while copying operations throw an UnsupportedOperationException, see RingbufferElement.
+ * </p>
+ * <p>
  * Synchronization and hence thread safety details belong to the implementation.
  * </p>
  */
@@ -146,6 +179,20 @@ template <class T> class Ringbuffer {
          */
         virtual int drop(const int count) = 0;
 
+        /**
+         * Dequeues up to <code>max</code> oldest elements into <code>dest</code> at once,
+         * amortizing synchronization and wake-up of a blocked putter across the whole batch.
+         * <p>
+         * <code>timeoutMS</code> defaults to a negative value, i.e. non blocking and returning immediately.<br>
+         * Zero blocks infinitely until at least one element becomes available via put,
+         * otherwise this methods blocks for the given milliseconds.
+         * </p>
+         * @param dest destination array of at least <code>max</code> elements
+         * @param max maximum number of elements to dequeue
+         * @return number of dequeued elements, zero if empty or timeout occurred.
+         */
+        virtual int getAll(T * dest, const int max, const int timeoutMS=-1) = 0;
+
         /**
          * Enqueues the given element.
          * <p>
@@ -157,6 +204,18 @@ template <class T> class Ringbuffer {
          */
         virtual bool put(const T & e) = 0;
 
+        /**
+         * Enqueues the given element by moving it into the buffer,
+         * avoiding e.g. reference count traffic of shared pointer or supporting move-only types.
+         * <p>
+         * Returns true if successful, otherwise false in case buffer is full and <code>e</code> is left untouched.
+         * </p>
+         * <p>
+         * Method is non blocking and returns immediately;.
+         * </p>
+         */
+        virtual bool put(T && e) = 0;
+
         /**
          * Enqueues the given element.
          * <p>
@@ -170,6 +229,29 @@ template <class T> class Ringbuffer {
          */
         virtual bool putBlocking(const T & e, const int timeoutMS=0) = 0;
 
+        /**
+         * Enqueues the given element by moving it into the buffer.
+         * <p>
+         * <code>timeoutMS</code> defaults to zero,
+         * i.e. infinitive blocking until a free slot becomes available via get.<br>
+         * Otherwise this methods blocks for the given milliseconds.
+         * </p>
+         * <p>
+         * Returns true if successful, otherwise false in case timeout occurred and <code>e</code> is left untouched.
+         * </p>
+         */
+        virtual bool putBlocking(T && e, const int timeoutMS=0) = 0;
+
+        /**
+         * Enqueues up to <code>count</code> elements of <code>src</code> in order at once,
+         * amortizing synchronization and wake-up of a blocked getter across the whole batch.
+         * <p>
+         * Method is non blocking and returns immediately.
+         * </p>
+         * @return number of enqueued elements, less than <code>count</code> if buffer became full.
+         */
+        virtual int putAll(const T * src, const int count) = 0;
+
         /**
          * Enqueues the same element at it's write position, if not full.
          * <p>
@@ -0,0 +1,466 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SPSCRINGBUFFER_HPP_
+#define SPSCRINGBUFFER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <climits>
+#include <ctime>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "BasicTypes.hpp"
+
+#include "Ringbuffer.hpp"
+
+namespace direct_bt {
+
+/**
+ * Wait-free single-producer / single-consumer implementation of {@link Ringbuffer}.
+ * <p>
+ * Implementation utilizes the <i>Always Keep One Slot Open</i>,
+ * hence implementation maintains an internal array of <code>capacity</code> <i>plus one</i>!
+ * </p>
+ * <p>
+ * Implementation is thread safe only if:
+ * <ul>
+ *   <li>{@link #get() get*(..)}, {@link #peek() peek*(..)}, {@link #drop(int) drop(..)} and {@link #clear()}
+ *       are only called by one consumer thread at a time.</li>
+ *   <li>{@link #put(Object) put*(..)} and {@link #waitForFreeSlots(int) waitForFreeSlots(..)}
+ *       are only called by one producer thread at a time.</li>
+ *   <li>{@link #reset(Object[]) reset(..)} and {@link #recapacity(int) recapacity(..)}
+ *       are only called while neither producer nor consumer is active.</li>
+ * </ul>
+ * Handing over either role to another thread requires an external happens-before relation,
+ * e.g. joining the previous thread.
+ * </p>
+ * <p>
+ * The read position is only written by the consumer and the write position only by the producer,
+ * each published with release and observed with acquire semantics.
+ * Both reside on their own cache line to avoid false sharing.
+ * </p>
+ * <p>
+ * Non blocking operations never acquire a lock nor enter the kernel.
+ * Blocking operations spin for a short while and then sleep on the opposite position via a futex,
+ * announced by a waiter flag. The opposite side only issues the wake-up system call if that flag is set.
+ * </p>
+ * <p>
+ * Characteristics:
+ * <ul>
+ *   <li>Read position points to the last read element.</li>
+ *   <li>Write position points to the last written element.</li>
+ * </ul>
+ * <table border="1">
+ *   <tr><td>Empty</td><td>writePos == readPos</td><td>size == 0</td></tr>
+ *   <tr><td>Full</td><td>writePos == readPos - 1</td><td>size == capacity</td></tr>
+ * </table>
+ * </p>
+ */
+template <typename T, std::nullptr_t nullelem> class SPSCRingbuffer : public Ringbuffer<T> {
+    private:
+        enum Defaults : int32_t {
+            CACHE_LINE_SIZE = 64,
+            /** Number of position polls before a blocking operation sleeps on the futex. */
+            SPIN_COUNT = 128,
+            /** FUTEX_WAIT | FUTEX_PRIVATE_FLAG, <linux/futex.h> clashes with linux_kernel_types.hpp. */
+            FUTEX_OP_WAIT_PRIVATE = 128,
+            /** FUTEX_WAKE | FUTEX_PRIVATE_FLAG */
+            FUTEX_OP_WAKE_PRIVATE = 129
+        };
+
+        /* final */ int capacityPlusOne;  // not final due to grow
+        /* final */ T * array; // not final due to grow
+
+        uint8_t padding0[CACHE_LINE_SIZE];
+        /** Consumer owned, also the futex word a blocked producer sleeps on. */
+        std::atomic<int> readPos;
+        /** Consumer owned, set while the consumer sleeps on writePos. */
+        std::atomic<int> readWaiting;
+        uint8_t padding1[CACHE_LINE_SIZE - 2*sizeof(std::atomic<int>)];
+        /** Producer owned, also the futex word a blocked consumer sleeps on. */
+        std::atomic<int> writePos;
+        /** Producer owned, set while the producer sleeps on readPos. */
+        std::atomic<int> writeWaiting;
+        uint8_t padding2[CACHE_LINE_SIZE - 2*sizeof(std::atomic<int>)];
+
+        static_assert(sizeof(std::atomic<int>) == sizeof(int), "std::atomic<int> not usable as futex word");
+
+        T * newArray(const int count) {
+            return new T[count];
+        }
+        void freeArray(T * a) {
+            delete[] a;
+        }
+
+        static void futexWait(std::atomic<int> & word, const int expected, const int timeoutMS) {
+            struct timespec ts;
+            struct timespec * tsp = nullptr;
+            if( 0 < timeoutMS ) {
+                ts.tv_sec = timeoutMS / 1000;
+                ts.tv_nsec = ( timeoutMS % 1000 ) * 1000000L;
+                tsp = &ts;
+            }
+            // Returns immediately with EAGAIN if word != expected, spurious wake-ups are handled by the caller
+            ::syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_OP_WAIT_PRIVATE, expected, tsp, nullptr, 0);
+        }
+
+        static void futexWake(std::atomic<int> & word) {
+            ::syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_OP_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        /**
+         * Blocks until the opposite position <code>pos</code> differs from <code>unchanged</code>
+         * or the timeout expired. <code>timeoutMS</code> of zero blocks infinitely.
+         * @return the last observed value of <code>pos</code>
+         */
+        static int waitWhile(std::atomic<int> & pos, std::atomic<int> & waiting, const int unchanged, const int timeoutMS) {
+            int v;
+            for(int i=0; i<SPIN_COUNT; i++) {
+                v = pos.load(std::memory_order_acquire);
+                if( unchanged != v ) {
+                    return v;
+                }
+            }
+            const uint64_t t0 = 0 < timeoutMS ? getCurrentMilliseconds() : 0;
+            for(;;) {
+                // Dekker style handshake w/ the opposite side's position store and waiting load, both sequentially consistent
+                waiting.store(1, std::memory_order_seq_cst);
+                v = pos.load(std::memory_order_seq_cst);
+                if( unchanged != v ) {
+                    break;
+                }
+                int left = 0;
+                if( 0 < timeoutMS ) {
+                    left = timeoutMS - static_cast<int>( getCurrentMilliseconds() - t0 );
+                    if( 0 >= left ) {
+                        break;
+                    }
+                }
+                futexWait(pos, unchanged, left);
+            }
+            waiting.store(0, std::memory_order_relaxed);
+            return v;
+        }
+
+        /** Publishes the new position and wakes the opposite side if it sleeps on it. */
+        static void publish(std::atomic<int> & pos, const int value, std::atomic<int> & oppositeWaiting) {
+            pos.store(value, std::memory_order_seq_cst);
+            if( 0 != oppositeWaiting.load(std::memory_order_seq_cst) ) {
+                futexWake(pos);
+            }
+        }
+
+        int sizeOf(const int localReadPos, const int localWritePos) const {
+            return ( localWritePos - localReadPos + capacityPlusOne ) % capacityPlusOne;
+        }
+
+        void resetImpl(const T * copyFrom, const int copyFromCount) /* throws IllegalArgumentException */ {
+            dropImpl(capacityPlusOne);
+
+            // fill with copyFrom elements
+            if( nullptr != copyFrom && 0 < copyFromCount ) {
+                if( copyFromCount > capacityPlusOne-1 ) {
+                    throw IllegalArgumentException("copyFrom array length "+std::to_string(copyFromCount)+" > capacity "+toString(), E_FILE_LINE);
+                }
+                int localWritePos = writePos.load(std::memory_order_relaxed);
+                for(int i=0; i<copyFromCount; i++) {
+                    localWritePos = (localWritePos + 1) % capacityPlusOne;
+                    RingbufferElement<T>::assign(array[localWritePos], copyFrom[i]);
+                }
+                writePos.store(localWritePos, std::memory_order_release);
+            }
+        }
+
+        T getImpl(const bool blocking, const bool peek, const int timeoutMS) {
+            int localReadPos = readPos.load(std::memory_order_relaxed); // own position
+            if( localReadPos == writePos.load(std::memory_order_acquire) ) {
+                if( !blocking || localReadPos == waitWhile(writePos, readWaiting, localReadPos, timeoutMS) ) {
+                    return nullelem;
+                }
+            }
+            localReadPos = (localReadPos + 1) % capacityPlusOne;
+            if( peek ) {
+                T r = nullelem;
+                RingbufferElement<T>::assign(r, static_cast<const T &>(array[localReadPos]));
+                return r;
+            }
+            T r = std::move(array[localReadPos]);
+            array[localReadPos] = nullelem;
+            publish(readPos, localReadPos, writeWaiting); // notify waiting putter
+            return r;
+        }
+
+        int getAllImpl(T * dest, const int max, const int timeoutMS) {
+            int localReadPos = readPos.load(std::memory_order_relaxed); // own position
+            int localWritePos = writePos.load(std::memory_order_acquire);
+            if( 0 >= max ) {
+                return 0;
+            }
+            if( localReadPos == localWritePos ) {
+                if( 0 > timeoutMS || localReadPos == ( localWritePos = waitWhile(writePos, readWaiting, localReadPos, timeoutMS) ) ) {
+                    return 0;
+                }
+            }
+            const int count = std::min(max, sizeOf(localReadPos, localWritePos));
+            for(int i=0; i<count; i++) {
+                localReadPos = (localReadPos + 1) % capacityPlusOne;
+                dest[i] = std::move(array[localReadPos]);
+                array[localReadPos] = nullelem;
+            }
+            publish(readPos, localReadPos, writeWaiting); // notify waiting putter, once per batch
+            return count;
+        }
+
+        int dropImpl (const int count) {
+            int localReadPos = readPos.load(std::memory_order_relaxed); // own position
+            const int dropCount = std::min(count, sizeOf(localReadPos, writePos.load(std::memory_order_acquire)));
+            if( 0 >= dropCount ) {
+                return 0;
+            }
+            for(int i=0; i<dropCount; i++) {
+                localReadPos = (localReadPos + 1) % capacityPlusOne;
+                array[localReadPos] = nullelem;
+            }
+            publish(readPos, localReadPos, writeWaiting); // notify waiting putter
+            return dropCount;
+        }
+
+        /** Copies or moves <code>e</code> into the buffer, depending on its value category, only if successful. */
+        template<typename U>
+        bool putImpl(U && e, const bool sameRef, const bool blocking, const int timeoutMS) /* throws InterruptedException */ {
+            const int localWritePos = ( writePos.load(std::memory_order_relaxed) + 1 ) % capacityPlusOne; // own position
+            if( localWritePos == readPos.load(std::memory_order_acquire) ) {
+                // readPos only moves forward, i.e. any change frees our slot
+                if( !blocking || localWritePos == waitWhile(readPos, writeWaiting, localWritePos, timeoutMS) ) {
+                    return false;
+                }
+            }
+            if( !sameRef ) {
+                RingbufferElement<T>::assign(array[localWritePos], std::forward<U>(e));
+            }
+            publish(writePos, localWritePos, readWaiting); // notify waiting getter
+            return true;
+        }
+
+        int putAllImpl(const T * src, const int count) {
+            int localWritePos = writePos.load(std::memory_order_relaxed); // own position
+            const int n = std::min(count, capacityPlusOne - 1 - sizeOf(readPos.load(std::memory_order_acquire), localWritePos));
+            if( 0 >= n ) {
+                return 0;
+            }
+            for(int i=0; i<n; i++) {
+                localWritePos = (localWritePos + 1) % capacityPlusOne;
+                RingbufferElement<T>::assign(array[localWritePos], src[i]);
+            }
+            publish(writePos, localWritePos, readWaiting); // notify waiting getter, once per batch
+            return n;
+        }
+
+    public:
+        std::string toString() const override {
+            const std::string es = isEmpty() ? ", empty" : "";
+            const std::string fs = isFull() ? ", full" : "";
+            return "SPSCRingbuffer<?>[size "+std::to_string(getSize())+" / "+std::to_string(capacityPlusOne-1)+
+                    ", writePos "+std::to_string(writePos)+", readPos "+std::to_string(readPos)+es+fs+"]";
+        }
+
+        void dump(FILE *stream, std::string prefix) const override {
+            fprintf(stream, "%s %s\n", prefix.c_str(), toString().c_str());
+        }
+
+        /**
+         * Create a full ring buffer instance w/ the given array's net capacity and content.
+         * <p>
+         * {@link #isFull()} returns true on the newly created full ring buffer.
+         * </p>
+         * @param copyFrom mandatory source array determining ring buffer's net {@link #capacity()} and initial content.
+         */
+        SPSCRingbuffer(const std::vector<T> & copyFrom) /* throws IllegalArgumentException */
+        : capacityPlusOne(copyFrom.size() + 1), array(newArray(capacityPlusOne)),
+          readPos(0), readWaiting(0), writePos(0), writeWaiting(0)
+        {
+            resetImpl(copyFrom.data(), copyFrom.size());
+        }
+
+        SPSCRingbuffer(const T * copyFrom, const int copyFromSize) /* throws IllegalArgumentException */
+        : capacityPlusOne(copyFromSize + 1), array(newArray(capacityPlusOne)),
+          readPos(0), readWaiting(0), writePos(0), writeWaiting(0)
+        {
+            resetImpl(copyFrom, copyFromSize);
+        }
+
+        /**
+         * Create an empty ring buffer instance w/ the given net <code>capacity</code>.
+         * <p>
+         * {@link #isEmpty()} returns true on the newly created empty ring buffer.
+         * </p>
+         * @param capacity the initial net capacity of the ring buffer
+         */
+        SPSCRingbuffer(const int capacity)
+        : capacityPlusOne(capacity + 1), array(newArray(capacityPlusOne)),
+          readPos(0), readWaiting(0), writePos(0), writeWaiting(0)
+        { }
+
+        ~SPSCRingbuffer() {
+            freeArray(array);
+        }
+
+        SPSCRingbuffer(const SPSCRingbuffer &_source) = delete;
+        SPSCRingbuffer& operator=(const SPSCRingbuffer &_source) = delete;
+
+        int capacity() const override { return capacityPlusOne-1; }
+
+        /** Consumer operation, drops all elements. */
+        void clear() override {
+            dropImpl(capacityPlusOne);
+        }
+
+        /** Requires neither producer nor consumer being active. */
+        void reset(const T * copyFrom, const int copyFromCount) override {
+            resetImpl(copyFrom, copyFromCount);
+        }
+
+        /** Requires neither producer nor consumer being active. */
+        void reset(const std::vector<T> & copyFrom) override {
+            resetImpl(copyFrom.data(), copyFrom.size());
+        }
+
+        int getSize() const override {
+            return sizeOf(readPos.load(std::memory_order_acquire), writePos.load(std::memory_order_acquire));
+        }
+
+        int getFreeSlots() const override { return capacityPlusOne - 1 - getSize(); }
+
+        bool isEmpty() const override { return writePos.load(std::memory_order_acquire) == readPos.load(std::memory_order_acquire); }
+
+        bool isFull() const override {
+            return ( writePos.load(std::memory_order_acquire) + 1 ) % capacityPlusOne == readPos.load(std::memory_order_acquire);
+        }
+
+        T get() override { return getImpl(false, false, 0); }
+
+        T getBlocking(const int timeoutMS=0) override /* throws InterruptedException */ {
+            return getImpl(true, false, timeoutMS);
+        }
+
+        T peek() override {
+            return getImpl(false, true, 0);
+        }
+
+        T peekBlocking(const int timeoutMS=0) override /* throws InterruptedException */ {
+            return getImpl(true, true, timeoutMS);
+        }
+
+        /** Consumer operation. */
+        int getAll(T * dest, const int max, const int timeoutMS=-1) override {
+            return getAllImpl(dest, max, timeoutMS);
+        }
+
+        /** Consumer operation. */
+        int drop(const int count) override {
+            return dropImpl(count);
+        }
+
+        bool put(const T & e) override {
+            return putImpl(e, false, false, 0);
+        }
+
+        bool putBlocking(const T & e, const int timeoutMS=0) override {
+            return putImpl(e, false, true, timeoutMS);
+        }
+
+        bool put(T && e) override {
+            return putImpl(std::move(e), false, false, 0);
+        }
+
+        bool putBlocking(T && e, const int timeoutMS=0) override {
+            return putImpl(std::move(e), false, true, timeoutMS);
+        }
+
+        int putAll(const T * src, const int count) override {
+            return putAllImpl(src, count);
+        }
+
+        bool putSame() override {
+            return putImpl(T(nullelem), true, false, 0);
+        }
+
+        bool putSameBlocking(const int timeoutMS=0) override {
+            return putImpl(T(nullelem), true, true, timeoutMS);
+        }
+
+        /** Producer operation. */
+        void waitForFreeSlots(const int count) override /* throws InterruptedException */ {
+            int localReadPos = readPos.load(std::memory_order_acquire);
+            while( capacityPlusOne - 1 - sizeOf(localReadPos, writePos.load(std::memory_order_relaxed)) < count ) {
+                localReadPos = waitWhile(readPos, writeWaiting, localReadPos, 0);
+            }
+        }
+
+        /** Requires neither producer nor consumer being active. */
+        void recapacity(const int newCapacity) override {
+            if( capacityPlusOne == newCapacity+1 ) {
+                return;
+            }
+            const int _size = getSize();
+            if( _size > newCapacity ) {
+                throw IllegalArgumentException("amount "+std::to_string(newCapacity)+" < size, "+toString(), E_FILE_LINE);
+            }
+            if( 0 > newCapacity ) {
+                throw IllegalArgumentException("amount "+std::to_string(newCapacity)+" < 0, "+toString(), E_FILE_LINE);
+            }
+
+            // save current data
+            const int oldCapacityPlusOne = capacityPlusOne;
+            T * oldArray = array;
+            int oldReadPos = readPos;
+
+            // new blank resized array
+            capacityPlusOne = newCapacity + 1;
+            array = newArray(capacityPlusOne);
+
+            // copy saved data
+            int localWritePos = 0;
+            for(int i=0; i<_size; i++) {
+                localWritePos = (localWritePos + 1) % capacityPlusOne;
+                oldReadPos = (oldReadPos + 1) % oldCapacityPlusOne;
+                array[localWritePos] = std::move(oldArray[oldReadPos]);
+            }
+            readPos.store(0, std::memory_order_relaxed);
+            writePos.store(localWritePos, std::memory_order_release);
+            freeArray(oldArray); // and release
+        }
+};
+
+} /* namespace direct_bt */
+
+#endif /* SPSCRINGBUFFER_HPP_ */
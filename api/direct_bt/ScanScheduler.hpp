@@ -0,0 +1,143 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SCAN_SCHEDULER_HPP_
+#define SCAN_SCHEDULER_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+namespace direct_bt {
+
+    /**
+     * LE scan parameter, see HCIHandler::le_set_scan_param().
+     */
+    class ScanParameter {
+        public:
+            /** Minimum scan interval and window in units of 0.625ms, i.e. 2.5ms */
+            static constexpr uint16_t MIN_VALUE = 0x0004;
+            /** Maximum scan interval and window in units of 0.625ms, i.e. 10.24s */
+            static constexpr uint16_t MAX_VALUE = 0x4000;
+
+            bool active;
+            /** Scan interval in units of 0.625ms */
+            uint16_t interval;
+            /** Scan window in units of 0.625ms, shall be <= interval */
+            uint16_t window;
+
+            ScanParameter(const bool active_=false, const uint16_t interval_=18, const uint16_t window_=18)
+            : active(active_), interval(interval_), window(window_) {}
+
+            /** Returns window / interval in percent. */
+            int getDutyCycle() const { return 0 < interval ? ( 100 * window ) / interval : 0; }
+
+            bool operator==(const ScanParameter & rhs) const {
+                return active == rhs.active && interval == rhs.interval && window == rhs.window;
+            }
+            bool operator!=(const ScanParameter & rhs) const { return !(*this == rhs); }
+
+            std::string toString() const;
+    };
+
+    /**
+     * Adapts the LE scan parameter of DBTAdapter's discovery to the connected devices and a power budget,
+     * avoiding scanning starving the connection events of connected devices.
+     * <p>
+     * The scan window is reduced to the duty cycle
+     * <pre>
+     *   min( DUTY_CYCLE_MAX, max( DUTY_CYCLE_MIN, 100 - connectedCount * DUTY_CYCLE_PER_CONNECTION ) )
+     * </pre>
+     * of the requested scan interval, while the requested window is never exceeded.
+     * Active scanning may be switched to passive while devices are connected, see PASSIVE_WHEN_CONNECTED.
+     * </p>
+     * <p>
+     * If PAUSE_ON_CONNECT is enabled, DBTAdapter pauses its kept-alive discovery
+     * while connections are being created via DBTDevice::connectLE().
+     * </p>
+     */
+    class ScanScheduler {
+        public:
+            /**
+             * Maximum scan duty cycle in percent, i.e. the power budget, defaults to 100.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.scan.duty.max'.
+             * </p>
+             */
+            const int32_t DUTY_CYCLE_MAX;
+
+            /**
+             * Minimum scan duty cycle in percent with connected devices, defaults to 10.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.scan.duty.min'.
+             * </p>
+             */
+            const int32_t DUTY_CYCLE_MIN;
+
+            /**
+             * Duty cycle reduction in percent per connected device, defaults to 0, i.e. disabled.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.scan.duty.conn'.
+             * </p>
+             */
+            const int32_t DUTY_CYCLE_PER_CONNECTION;
+
+            /**
+             * Use passive scanning while devices are connected, saving the scan request airtime, defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.scan.passive.conn'.
+             * </p>
+             */
+            const bool PASSIVE_WHEN_CONNECTED;
+
+            /**
+             * Pause kept-alive discovery while creating LE connections, defaults to false.
+             * <p>
+             * Environment variable is 'direct_bt.adapter.scan.pause'.
+             * </p>
+             */
+            const bool PAUSE_ON_CONNECT;
+
+            /** Reads the environment variables 'direct_bt.adapter.scan.*' */
+            ScanScheduler();
+
+            ScanScheduler(const int32_t dutyCycleMax, const int32_t dutyCycleMin, const int32_t dutyCyclePerConnection,
+                          const bool passiveWhenConnected, const bool pauseOnConnect);
+
+            /** Returns true if the scan parameter depends on the number of connected devices. */
+            bool isAdaptive() const { return 0 < DUTY_CYCLE_PER_CONNECTION || PASSIVE_WHEN_CONNECTED; }
+
+            /** Returns the duty cycle in percent for the given number of connected devices. */
+            int32_t getDutyCycle(const int connectedCount) const;
+
+            /** Returns the adapted scan parameter of the requested one for the given number of connected devices. */
+            ScanParameter adapt(const ScanParameter & requested, const int connectedCount) const;
+
+            std::string toString() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* SCAN_SCHEDULER_HPP_ */
@@ -0,0 +1,116 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SHARDED_HASH_MAP_HPP_
+#define SHARDED_HASH_MAP_HPP_
+
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+
+namespace direct_bt {
+
+    /**
+     * Hash map partitioned into ShardCount independently locked shards,
+     * allowing concurrent lookups and mutations of different keys.
+     * <p>
+     * Each operation only holds the mutex of the key's shard for the duration of the map access,
+     * hence Value_type shall be cheap to copy, e.g. a std::shared_ptr.
+     * get() returns a copy, or a default constructed Value_type if not found.
+     * </p>
+     * <p>
+     * Intended as the lookup index of frequently queried and moderately mutated sets,
+     * e.g. the discovered devices of DBTAdapter looked up for each advertising report.
+     * </p>
+     */
+    template <typename Key_type, typename Value_type, typename Hash_type = std::hash<Key_type>, int ShardCount = 16>
+    class ShardedHashMap {
+        static_assert( 0 < ShardCount && 0 == ( ShardCount & ( ShardCount - 1 ) ), "ShardCount must be a power of two" );
+
+        private:
+            typedef std::unordered_map<Key_type, Value_type, Hash_type> storage_t;
+
+            struct Shard {
+                std::mutex mtx;
+                storage_t map;
+            };
+            Shard shards[ShardCount];
+
+            Shard & getShard(const Key_type & key) {
+                const std::size_t h = Hash_type()(key);
+                return shards[ ( h ^ ( h >> 17 ) ) & ( ShardCount - 1 ) ];
+            }
+
+        public:
+            ShardedHashMap() {}
+
+            ShardedHashMap(const ShardedHashMap&) = delete;
+            void operator=(const ShardedHashMap&) = delete;
+
+            /** Returns a copy of the mapped value, or a default constructed Value_type if not found. */
+            Value_type get(const Key_type & key) {
+                Shard & s = getShard(key);
+                const std::lock_guard<std::mutex> lock(s.mtx); // RAII-style acquire and relinquish via destructor
+                auto it = s.map.find(key);
+                return it != s.map.end() ? it->second : Value_type();
+            }
+
+            /** Adds the given mapping if key is not contained yet, returns true if added. */
+            bool put(const Key_type & key, const Value_type & value) {
+                Shard & s = getShard(key);
+                const std::lock_guard<std::mutex> lock(s.mtx); // RAII-style acquire and relinquish via destructor
+                return s.map.insert( std::make_pair(key, value) ).second;
+            }
+
+            /** Removes the mapping of the given key, returns true if removed. */
+            bool remove(const Key_type & key) {
+                Shard & s = getShard(key);
+                const std::lock_guard<std::mutex> lock(s.mtx); // RAII-style acquire and relinquish via destructor
+                return 0 < s.map.erase(key);
+            }
+
+            /** Removes all mappings, one shard at a time. */
+            void clear() {
+                for(int i=0; i<ShardCount; i++) {
+                    const std::lock_guard<std::mutex> lock(shards[i].mtx); // RAII-style acquire and relinquish via destructor
+                    shards[i].map.clear();
+                }
+            }
+
+            /** Returns the number of mappings, summed up one shard at a time. */
+            std::size_t size() {
+                std::size_t res = 0;
+                for(int i=0; i<ShardCount; i++) {
+                    const std::lock_guard<std::mutex> lock(shards[i].mtx); // RAII-style acquire and relinquish via destructor
+                    res += shards[i].map.size();
+                }
+                return res;
+            }
+    };
+
+} // namespace direct_bt
+
+#endif /* SHARDED_HASH_MAP_HPP_ */
@@ -0,0 +1,201 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TIMER_WHEEL_HPP_
+#define TIMER_WHEEL_HPP_
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+
+namespace direct_bt {
+
+    /**
+     * Hierarchical timer wheel, serving all timeouts and periodic tasks of its users with one thread.
+     * <p>
+     * LEVELS wheels of SLOTS slots each cover SLOTS^LEVELS ticks of the given resolution,
+     * where a timer is placed in the lowest wheel covering its remaining delay
+     * and cascaded down a wheel when the lower wheel wraps around.
+     * Longer delays are placed in the highest wheel's farthest slot and re-cascaded.
+     * </p>
+     * <p>
+     * Inserting and cancelling a timer is O(1), i.e. linking and unlinking a slot list node.
+     * The thread sleeps until the next non-empty slot or cascade is due and
+     * not at all while no timer is scheduled, i.e. it never polls.
+     * It is started with the first scheduled timer.
+     * </p>
+     * <p>
+     * Callbacks are invoked on the timer thread one after another, hence shall not block.
+     * A callback returns the delay of its next invocation in milliseconds, or zero to end the timer,
+     * supporting periodic tasks with a fixed or adaptive period.
+     * Callbacks may schedule and cancel timers, including their own.
+     * </p>
+     * <p>
+     * The library instance is owned by DBTManager, see DBTManager::getTimerWheel().
+     * </p>
+     */
+    class TimerWheel {
+        public:
+            /** Unique timer identifier, zero is invalid. */
+            typedef uint64_t TimerID;
+
+            /** Timer callback, returning the delay of its next invocation in milliseconds, or zero to end the timer. */
+            typedef std::function<uint32_t()> Callback;
+
+            enum Defaults : uint32_t {
+                /** Number of wheels */
+                LEVELS = 4,
+                /** Number of slots per wheel, power of two */
+                SLOTS = 64,
+                SLOT_BITS = 6
+            };
+
+        private:
+            static constexpr uint32_t NIL = UINT32_MAX;
+
+            struct Node {
+                Callback cb;
+                /** Absolute expiry tick */
+                uint64_t expires;
+                uint32_t prev;
+                uint32_t next;
+                /** Incremented with each reuse, invalidating stale TimerIDs */
+                uint32_t generation;
+                /** Level and slot while linked, otherwise level is NIL */
+                uint32_t level;
+                uint32_t slot;
+            };
+
+            const uint32_t tickMS;
+            std::mutex mtx;
+            std::condition_variable cv;
+            /** Signals the end of the running callback to cancel(id, true) */
+            std::condition_variable cv_done;
+            std::vector<Node> nodes;
+            uint32_t freeList;
+            uint32_t heads[LEVELS][SLOTS];
+            /** Non-empty slots per level */
+            uint64_t occupied[LEVELS];
+            size_t count;
+            /** Monotonic millisecond time of tick zero */
+            uint64_t t0;
+            /** Last processed tick */
+            uint64_t currentTick;
+            /** Tick the thread sleeps until, UINT64_MAX if idle */
+            uint64_t wakeTick;
+            /** Node of the running callback or NIL */
+            uint32_t running;
+            uint32_t runningGeneration;
+            bool runningCancelled;
+            bool threadRunning;
+            bool shallStop;
+            std::thread thread;
+            std::thread::id threadId;
+            uint64_t expiredCount;
+            uint64_t wakeupCount;
+
+            static TimerID toID(const uint32_t idx, const uint32_t generation) {
+                return ( static_cast<uint64_t>(generation) << 32 ) | ( idx + 1 );
+            }
+            uint64_t getNowTick() const;
+            void link(const uint32_t idx);
+            void unlink(const uint32_t idx);
+            uint32_t allocNode();
+            void freeNode(const uint32_t idx);
+            /** Cascades the slot of the given level due at the current tick into the lower levels. */
+            void cascade(const uint32_t level);
+            /** Returns the next tick with a non-empty level 0 slot or a non-empty slot to be cascaded, UINT64_MAX if none. */
+            uint64_t getNextTick() const;
+            /** Runs all timers of the current tick's level 0 slot, unlocking the given lock while invoking a callback. */
+            void expire(std::unique_lock<std::mutex> & lock);
+            void threadImpl();
+
+            TimerWheel(const TimerWheel&) = delete;
+            void operator=(const TimerWheel&) = delete;
+
+        public:
+            /**
+             * @param tickMS tick resolution in milliseconds, at least one.
+             *        Each timer expires at the first tick not earlier than its delay.
+             */
+            TimerWheel(const uint32_t tickMS=10);
+
+            /** Stops the thread, see stop(). */
+            ~TimerWheel();
+
+            uint32_t getTickMS() const { return tickMS; }
+
+            /**
+             * Schedules the given callback to be invoked after the given delay.
+             * @param delayMS delay in milliseconds, zero expires with the next tick
+             * @param cb the callback, returning the delay of its next invocation or zero to end the timer
+             * @return the timer's identifier, zero if stopped
+             */
+            TimerID schedule(const uint32_t delayMS, Callback cb);
+
+            /**
+             * Cancels the given timer.
+             * <p>
+             * A callback being invoked is not interrupted, but not rescheduled anymore.
+             * </p>
+             * @param id the timer identifier
+             * @param wait if true, waits until the timer's running callback has returned, unless called by the timer thread
+             * @return true if the timer was scheduled or running, otherwise false, e.g. already ended
+             */
+            bool cancel(const TimerID id, const bool wait=false);
+
+            /** Returns true if the given timer is scheduled or its callback is being invoked. */
+            bool isScheduled(const TimerID id);
+
+            /** Returns the number of scheduled timers. */
+            size_t size();
+
+            /** Returns the number of invoked callbacks. */
+            uint64_t getExpiredCount();
+
+            /** Returns the number of thread wake-ups, including those due to a newly scheduled earlier timer. */
+            uint64_t getWakeupCount();
+
+            /**
+             * Cancels all timers and stops the thread, waiting for a running callback to return.
+             * <p>
+             * Further timers are not scheduled.
+             * </p>
+             */
+            void stop();
+
+            std::string toString();
+    };
+
+} // namespace direct_bt
+
+#endif /* TIMER_WHEEL_HPP_ */
@@ -0,0 +1,166 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TRAFFIC_STATS_HPP_
+#define TRAFFIC_STATS_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+
+namespace direct_bt {
+
+    /**
+     * Immutable snapshot of TrafficStats, see TrafficStats::getSnapshot().
+     */
+    class TrafficSnapshot {
+        public:
+            /** Counters of one ATT opcode, see AttPDUMsg::Opcode */
+            struct OpcodeCount {
+                uint8_t opcode;
+                uint64_t pdusIn;
+                uint64_t bytesIn;
+                uint64_t pdusOut;
+                uint64_t bytesOut;
+            };
+
+            /** Monotonic timestamp in milliseconds of the last TrafficStats::reset() or its construction */
+            uint64_t startTime;
+            /** Monotonic timestamp in milliseconds of this snapshot */
+            uint64_t timestamp;
+            uint64_t pdusIn;
+            uint64_t bytesIn;
+            uint64_t pdusOut;
+            uint64_t bytesOut;
+            /** Received ATT_HANDLE_VALUE_NTF and ATT_HANDLE_VALUE_IND */
+            uint64_t notifications;
+            /** Request retries and requests failed w/ a reply timeout */
+            uint64_t retries;
+            uint64_t timeouts;
+            /** Number and sum in microseconds of round-trip time samples */
+            uint64_t rttSamples;
+            uint64_t rttSum;
+            /** Counters of all ATT opcodes seen at least once, ordered by opcode */
+            std::vector<OpcodeCount> opcodes;
+
+            TrafficSnapshot() noexcept
+            : startTime(0), timestamp(0), pdusIn(0), bytesIn(0), pdusOut(0), bytesOut(0),
+              notifications(0), retries(0), timeouts(0), rttSamples(0), rttSum(0) {}
+
+            /** Returns the average round-trip time in microseconds, zero w/o samples. */
+            uint64_t getAverageRTT() const noexcept { return 0 < rttSamples ? rttSum / rttSamples : 0; }
+
+            /** Returns the received notifications and indications per second since startTime. */
+            double getNotificationRate() const noexcept;
+
+            /**
+             * Returns the received notifications and indications per second since the given earlier snapshot
+             * of the same TrafficStats, allowing to sample a current rate.
+             */
+            double getNotificationRate(const TrafficSnapshot & earlier) const noexcept;
+
+            std::string toString() const;
+    };
+
+    /**
+     * Traffic accounting of one connection, i.e. ATT PDUs and bytes in and out per ATT opcode,
+     * received notifications, request retries, timeouts and round-trip times.
+     * <p>
+     * Counting uses relaxed atomics only, hence is cheap on the reader and writer paths
+     * and getSnapshot() may be called from any thread.
+     * Counters of one snapshot are not mutually consistent, e.g. pdusIn may already include a PDU
+     * not yet contained in its opcode's pdusIn.
+     * </p>
+     * <p>
+     * Maintained per GATTHandler, see GATTHandler::getTrafficStats(),
+     * and per HCIConnection, see HCIHandler::getTrafficSnapshot().
+     * </p>
+     */
+    class TrafficStats {
+        private:
+            std::atomic<uint64_t> startTime;
+            std::atomic<uint64_t> pdusIn;
+            std::atomic<uint64_t> bytesIn;
+            std::atomic<uint64_t> pdusOut;
+            std::atomic<uint64_t> bytesOut;
+            std::atomic<uint64_t> notifications;
+            std::atomic<uint64_t> retries;
+            std::atomic<uint64_t> timeouts;
+            std::atomic<uint64_t> rttSamples;
+            std::atomic<uint64_t> rttSum;
+            std::atomic<uint64_t> opcodePDUsIn[256];
+            std::atomic<uint64_t> opcodeBytesIn[256];
+            std::atomic<uint64_t> opcodePDUsOut[256];
+            std::atomic<uint64_t> opcodeBytesOut[256];
+
+            static inline void inc(std::atomic<uint64_t> & v, const uint64_t n) noexcept {
+                v.fetch_add(n, std::memory_order_relaxed);
+            }
+
+        public:
+            TrafficStats() noexcept;
+
+            TrafficStats(const TrafficStats&) = delete;
+            void operator=(const TrafficStats&) = delete;
+
+            /** Counts one received ATT PDU of the given opcode and size in bytes, including the opcode. */
+            void countIn(const uint8_t opcode, const uint64_t bytes) noexcept {
+                inc(pdusIn, 1);
+                inc(bytesIn, bytes);
+                inc(opcodePDUsIn[opcode], 1);
+                inc(opcodeBytesIn[opcode], bytes);
+                if( 0x1B == opcode || 0x1D == opcode ) { // ATT_HANDLE_VALUE_NTF or ATT_HANDLE_VALUE_IND
+                    inc(notifications, 1);
+                }
+            }
+
+            /** Counts one sent ATT PDU of the given opcode and size in bytes, including the opcode. */
+            void countOut(const uint8_t opcode, const uint64_t bytes) noexcept {
+                inc(pdusOut, 1);
+                inc(bytesOut, bytes);
+                inc(opcodePDUsOut[opcode], 1);
+                inc(opcodeBytesOut[opcode], bytes);
+            }
+
+            void countRetry() noexcept { inc(retries, 1); }
+
+            void countTimeout() noexcept { inc(timeouts, 1); }
+
+            /** Adds the given round-trip time sample in microseconds. */
+            void addRTT(const uint64_t rttUSec) noexcept {
+                inc(rttSamples, 1);
+                inc(rttSum, rttUSec);
+            }
+
+            /** Zeroes all counters and restarts the notification rate period. */
+            void reset() noexcept;
+
+            TrafficSnapshot getSnapshot() const;
+    };
+
+} // namespace direct_bt
+
+#endif /* TRAFFIC_STATS_HPP_ */
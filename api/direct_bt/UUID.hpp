@@ -31,6 +31,7 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <atomic>
 
 #include "BasicTypes.hpp"
 
@@ -65,6 +66,15 @@ protected:
 public:
     static TypeSize toTypeSize(const int size);
     static std::shared_ptr<const uuid_t> create(TypeSize const t, uint8_t const * const buffer, int const byte_offset, bool const littleEndian);
+    /**
+     * Returns a new uuid_t instance parsed from the given string,
+     * i.e. 4 hex digits for uuid16_t, 8 hex digits for uuid32_t
+     * or the 36 characters uuid128_t format '00000000-0000-1000-8000-00805F9B34FB'.
+     * <p>
+     * Throws IllegalArgumentException if the string is not in either format.
+     * </p>
+     */
+    static std::shared_ptr<const uuid_t> create(const std::string & str);
 
     virtual ~uuid_t() {}
 
@@ -237,6 +247,117 @@ inline uuid128_t get_uuid128(uint8_t const * buffer, int const byte_offset, bool
     return uuid128_t(get_uint128(buffer, byte_offset, littleEndian));
 }
 
+/**
+ * Compact, trivially copyable UUID value of fixed size, i.e. the uuid_t::TypeSize tag
+ * and the 16 octet storage of its little endian value, zero padded.
+ * <p>
+ * Intended for containers and lookups of many UUIDs, e.g. advertised services,
+ * avoiding the heap allocation and virtual dispatch of uuid_t instances.
+ * </p>
+ */
+class uuid_value_t {
+private:
+    uuid_t::TypeSize type;
+    uint64_t words[2];
+
+public:
+    /** Zero uuid16_t value */
+    constexpr uuid_value_t() noexcept : type(uuid_t::TypeSize::UUID16_SZ), words{0, 0} {}
+
+    /** Value of given octets of TypeSize at byte_offset, read in little endian order */
+    uuid_value_t(uuid_t::TypeSize const t, uint8_t const * const buffer, int const byte_offset) noexcept
+    : type(t), words{0, 0}
+    {
+        memcpy(words, buffer + byte_offset, t);
+    }
+
+    /** Value of the given uuid_t */
+    uuid_value_t(uuid_t const & u) noexcept
+    : type(u.getTypeSize()), words{0, 0}
+    {
+        put_uuid(reinterpret_cast<uint8_t*>(words), 0, u, true /* littleEndian */);
+    }
+
+    constexpr uuid_t::TypeSize getTypeSize() const noexcept { return type; }
+
+    /** returns the pointer to the little endian uuid data of size getTypeSize() */
+    const uint8_t * data() const noexcept { return reinterpret_cast<const uint8_t*>(words); }
+
+    constexpr bool operator==(uuid_value_t const &o) const noexcept {
+        return type == o.type && words[0] == o.words[0] && words[1] == o.words[1];
+    }
+    constexpr bool operator!=(uuid_value_t const &o) const noexcept {
+        return !(*this == o);
+    }
+
+    constexpr std::size_t hash() const noexcept {
+        return static_cast<std::size_t>( ( words[0] ^ ( words[1] * UINT64_C(0x9E3779B97F4A7C15) ) ) ^ static_cast<uint64_t>(type) );
+    }
+
+    /** Returns a newly created uuid_t instance of this value. */
+    std::shared_ptr<const uuid_t> toUUID() const { return uuid_t::create(type, data(), 0, true /* littleEndian */); }
+
+    std::string toString() const;
+    std::string toUUID128String(uuid128_t const & base_uuid=BT_BASE_UUID, int const le_octet_index=12) const;
+};
+
+/**
+ * Lazily created and cached string representations of one uuid_t,
+ * i.e. uuid_t::toString() and uuid_t::toUUID128String().
+ * <p>
+ * Lock-free and thread safe, each string is created at most once per racing thread
+ * and the first one published is kept.
+ * A copy starts with an empty cache.
+ * </p>
+ */
+class uuid_string_cache {
+private:
+    mutable std::atomic<const std::string*> strings[2];
+
+public:
+    uuid_string_cache() noexcept : strings{ {nullptr}, {nullptr} } {}
+    uuid_string_cache(const uuid_string_cache &) noexcept : uuid_string_cache() {}
+    uuid_string_cache& operator=(const uuid_string_cache &o) noexcept {
+        if( this != &o ) {
+            clear();
+        }
+        return *this;
+    }
+    ~uuid_string_cache() noexcept { clear(); }
+
+    /** Drops the cached strings, e.g. after the associated uuid_t has been changed. Not thread safe. */
+    void clear() noexcept {
+        for(int i=0; i<2; i++) {
+            delete strings[i].exchange(nullptr);
+        }
+    }
+
+    /**
+     * Returns the cached string of the given uuid, created on first call.
+     * @param uuid the associated uuid_t, shall not change while cached
+     * @param uuid128 if true, returns uuid_t::toUUID128String(), otherwise uuid_t::toString()
+     */
+    const std::string & get(const uuid_t & uuid, const bool uuid128) const {
+        std::atomic<const std::string*> & slot = strings[uuid128 ? 1 : 0];
+        const std::string * s = slot.load(std::memory_order_acquire);
+        if( nullptr == s ) {
+            const std::string * n = new std::string( uuid128 ? uuid.toUUID128String() : uuid.toString() );
+            if( slot.compare_exchange_strong(s, n, std::memory_order_acq_rel, std::memory_order_acquire) ) {
+                s = n;
+            } else {
+                delete n; // other thread won, s holds its string
+            }
+        }
+        return *s;
+    }
+};
+
 } /* namespace direct_bt */
 
+namespace std {
+    template<> struct hash<direct_bt::uuid_value_t> {
+        std::size_t operator()(direct_bt::uuid_value_t const & u) const noexcept { return u.hash(); }
+    };
+}
+
 #endif /* UUID_HPP_ */
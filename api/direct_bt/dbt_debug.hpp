@@ -41,19 +41,55 @@ extern "C" {
 
 // #define PERF_PRINT_ON 1
 
+/**
+ * Compile time log level, see DBT_LOG_LEVEL.
+ * <p>
+ * Messages above the compiled DBT_LOG_LEVEL compile away,
+ * including the evaluation of their arguments, e.g. toString() calls.
+ * </p>
+ */
+#define DBT_LOG_LEVEL_NONE  0
+#define DBT_LOG_LEVEL_ERROR 1
+#define DBT_LOG_LEVEL_WARN  2
+#define DBT_LOG_LEVEL_INFO  3
+#define DBT_LOG_LEVEL_DEBUG 4
+
+/** Compiled log level, defaults to DBT_LOG_LEVEL_DEBUG, i.e. all messages subject to their runtime condition. */
+#ifndef DBT_LOG_LEVEL
+    #define DBT_LOG_LEVEL DBT_LOG_LEVEL_DEBUG
+#endif
+
 namespace direct_bt {
 
-    /** Use for environment-variable DBTEnv::DEBUG conditional debug messages, prefix '[elapsed_time] Debug: '. */
-    void DBG_PRINT(const char * format, ...);
+    /** Unconditional implementation of DBG_PRINT, prefix '[elapsed_time] Debug: '. */
+    void DBG_PRINT_impl(const char * format, ...);
+
+    /** Unconditional implementation of INFO_PRINT, prefix '[elapsed_time] Info: '. */
+    void INFO_PRINT_impl(const char * format, ...);
 
-    /** Use for environment-variable DBTEnv::VERBOSE conditional info messages, prefix '[elapsed_time] Info: '. */
-    void INFO_PRINT(const char * format, ...);
+    #if DBT_LOG_LEVEL >= DBT_LOG_LEVEL_DEBUG
+        /** Use for environment-variable DBTEnv::DEBUG conditional debug messages, prefix '[elapsed_time] Debug: '. Arguments are only evaluated if enabled. */
+        #define DBG_PRINT(...) do { if( direct_bt::DBTEnv::get().DEBUG ) { direct_bt::DBG_PRINT_impl(__VA_ARGS__); } } while(0)
+
+        /** Use for conditional plain messages, prefix '[elapsed_time] '. Arguments are only evaluated if the condition holds. */
+        #define COND_PRINT(C, ...) do { if( C ) { direct_bt::PLAIN_PRINT(__VA_ARGS__); } } while(0)
+    #else
+        #define DBG_PRINT(...) do { if( false ) { direct_bt::DBG_PRINT_impl(__VA_ARGS__); } } while(0)
+        #define COND_PRINT(C, ...) do { if( false && (C) ) { direct_bt::PLAIN_PRINT(__VA_ARGS__); } } while(0)
+    #endif
+
+    #if DBT_LOG_LEVEL >= DBT_LOG_LEVEL_INFO
+        /** Use for environment-variable DBTEnv::VERBOSE conditional info messages, prefix '[elapsed_time] Info: '. Arguments are only evaluated if enabled. */
+        #define INFO_PRINT(...) do { if( direct_bt::DBTEnv::get().VERBOSE ) { direct_bt::INFO_PRINT_impl(__VA_ARGS__); } } while(0)
+    #else
+        #define INFO_PRINT(...) do { if( false ) { direct_bt::INFO_PRINT_impl(__VA_ARGS__); } } while(0)
+    #endif
 
     #ifdef PERF_PRINT_ON
         #define PERF_TS_T0()  const uint64_t _t0 = direct_bt::getCurrentMilliseconds()
 
-        #define PERF_TS_TD(m)  { const uint64_t _td = direct_bt::getCurrentMilliseconds() - _t0; \
-                                 fprintf(stderr, "[%'9" PRIu64 "] %s done in %d ms,\n", direct_bt::DBTEnv::getElapsedMillisecond(), (m), (int)_td); }
+        #define PERF_TS_TD(m)  do { const uint64_t _td = direct_bt::getCurrentMilliseconds() - _t0; \
+                                    fprintf(stderr, "[%'9" PRIu64 "] %s done in %d ms,\n", direct_bt::DBTEnv::getElapsedMillisecond(), (m), (int)_td); } while(0)
     #else
         #define PERF_TS_T0()
         #define PERF_TS_TD(m)
@@ -65,8 +101,12 @@ namespace direct_bt {
     /** Use for unconditional error messages, prefix '[elapsed_time] Error @ file:line: '. Function also appends last errno and strerror(errno). */
     void ERR_PRINT2(const char *file, const int line, const char * format, ...);
 
-    /** Use for unconditional error messages, prefix '[elapsed_time] Error @ FILE:LINE: '. Function also appends last errno and strerror(errno). */
-    #define ERR_PRINT(...) { ERR_PRINT2(__FILE__, __LINE__, __VA_ARGS__); }
+    #if DBT_LOG_LEVEL >= DBT_LOG_LEVEL_ERROR
+        /** Use for unconditional error messages, prefix '[elapsed_time] Error @ FILE:LINE: '. Function also appends last errno and strerror(errno). */
+        #define ERR_PRINT(...) do { direct_bt::ERR_PRINT2(__FILE__, __LINE__, __VA_ARGS__); } while(0)
+    #else
+        #define ERR_PRINT(...) do { if( false ) { direct_bt::ERR_PRINT2(__FILE__, __LINE__, __VA_ARGS__); } } while(0)
+    #endif
 
     /** Use for unconditional warning messages, prefix '[elapsed_time] Warning @ file:line: ' */
     void WARN_PRINTv(const char *file, const int line, const char * format, va_list args);
@@ -74,15 +114,16 @@ namespace direct_bt {
     /** Use for unconditional warning messages, prefix '[elapsed_time] Warning @ file:line: ' */
     void WARN_PRINT2(const char *file, const int line, const char * format, ...);
 
-    /** Use for unconditional warning messages, prefix '[elapsed_time] Warning @ FILE:LINE: ' */
-    #define WARN_PRINT(...) { WARN_PRINT2(__FILE__, __LINE__, __VA_ARGS__); }
+    #if DBT_LOG_LEVEL >= DBT_LOG_LEVEL_WARN
+        /** Use for unconditional warning messages, prefix '[elapsed_time] Warning @ FILE:LINE: ' */
+        #define WARN_PRINT(...) do { direct_bt::WARN_PRINT2(__FILE__, __LINE__, __VA_ARGS__); } while(0)
+    #else
+        #define WARN_PRINT(...) do { if( false ) { direct_bt::WARN_PRINT2(__FILE__, __LINE__, __VA_ARGS__); } } while(0)
+    #endif
 
     /** Use for unconditional plain messages, prefix '[elapsed_time] '. */
     void PLAIN_PRINT(const char * format, ...);
 
-    /** Use for conditional plain messages, prefix '[elapsed_time] '. */
-    void COND_PRINT(const bool condition, const char * format, ...);
-
     template<class ListElemType>
     inline void printSharedPtrList(std::string prefix, std::vector<std::shared_ptr<ListElemType>> & list) {
         fprintf(stderr, "%s: Start: %zd elements\n", prefix.c_str(), (size_t)list.size());
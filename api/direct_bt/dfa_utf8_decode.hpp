@@ -36,6 +36,13 @@
 
 uint32_t dfa_utf8_decode(uint32_t & state, uint32_t & codep, const uint32_t byte_value);
 
+/**
+ * Returns the number of leading ASCII bytes within buffer
+ * in the range up to buffer_size or until EOS,
+ * testing eight bytes at once.
+ */
+size_t dfa_utf8_ascii_prefix(const uint8_t *buffer, const size_t buffer_size);
+
 /**
  * Returns all valid consecutive UTF-8 characters within buffer
  * in the range up to buffer_size or until EOS.
@@ -44,6 +51,9 @@ uint32_t dfa_utf8_decode(uint32_t & state, uint32_t & codep, const uint32_t byte
  * the content will be cut off and the decoding loop ends.
  * </p>
  * <p>
+ * A leading pure ASCII sequence is copied directly, see dfa_utf8_ascii_prefix().
+ * </p>
+ * <p>
  * Method utilizes a finite state machine detecting variable length UTF-8 codes.
  * See Bjoern Hoehrmann's site <http://bjoern.hoehrmann.de/utf-8/decoder/dfa/> for details.
  * </p>
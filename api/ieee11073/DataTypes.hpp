@@ -133,6 +133,27 @@ namespace ieee11073 {
              * </p>
              */
             static float float32_IEEE11073_to_IEEE754(const uint32_t raw_bt_float32_le);
+
+            /**
+             * Converts count contiguous 'IEEE-11073 16-bit SFLOAT' values to std IEEE754 floats,
+             * e.g. sample arrays of a health sensor notification.
+             * <p>
+             * src_le holds 2 * count bytes in little-endian, dest shall hold count floats.
+             * Results are identical to float16_IEEE11073_to_IEEE754(const uint16_t),
+             * decoded 4 values at once via SSE2 or AArch64 NEON if available.
+             * </p>
+             */
+            static void float16_IEEE11073_to_IEEE754(const uint8_t * src_le, float * dest, const size_t count);
+
+            /**
+             * Converts count contiguous 'IEEE-11073 32-bit FLOAT' values to std IEEE754 floats.
+             * <p>
+             * src_le holds 4 * count bytes in little-endian, dest shall hold count floats.
+             * Results are identical to float32_IEEE11073_to_IEEE754(const uint32_t),
+             * decoded 4 values at once via SSE2 or AArch64 NEON if available.
+             * </p>
+             */
+            static void float32_IEEE11073_to_IEEE754(const uint8_t * src_le, float * dest, const size_t count);
     };
 
 } // namespace direct_bt
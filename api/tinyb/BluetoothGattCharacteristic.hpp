@@ -63,6 +63,7 @@ protected:
         BluetoothObject *parent = nullptr);
 
     std::function<void(std::vector<unsigned char> &)> value_changed_callback;
+    std::function<void(const unsigned char *, size_t)> value_changed_raw_callback;
 
     bool start_notify ();
     bool stop_notify ();
@@ -133,6 +134,17 @@ public:
      */
     bool enable_value_notifications(
         std::function<void(std::vector<unsigned char> &value)> callback);
+    /**
+     * Enables notifications (including at BLE level) for changes of the
+     * value of the characteristic and triggers the callback when the
+     * value changes, passing a view of the received bytes without copying them.
+     * Uninstalls the previous value callback, if any was installed.
+     * @param callback A function of the form void(const unsigned char *, size_t), where
+     * the data pointer and size describe the new value. The data is owned by the
+     * received D-Bus message and is only valid for the duration of the callback.
+     */
+    bool enable_raw_value_notifications(
+        std::function<void(const unsigned char *data, size_t size)> callback);
     /**
      * Disables notifications for changes of the value of the characteristic
      * and uninstalls any callback (including BLE level).
@@ -27,6 +27,7 @@
 #include "BluetoothEvent.hpp"
 #include <vector>
 #include <list>
+#include <mutex>
 
 class tinyb::BluetoothManager: public BluetoothObject
 {
@@ -41,6 +42,8 @@ private:
     std::unique_ptr<BluetoothAdapter> default_adapter;
     static BluetoothManager *bluetooth_manager;
     std::list<std::shared_ptr<BluetoothEvent>> event_list;
+    /** Guards event_list, modified by the callers of find() and iterated by the manager thread */
+    std::mutex event_list_lock;
 
     BluetoothManager();
     BluetoothManager(const BluetoothManager &object);
@@ -74,16 +77,19 @@ public:
       * matches an incoming event its' callback will be triggered. Events can be
       * the addition of a new Device, GattService, GattCharacteristic, etc. */
     void add_event(std::shared_ptr<BluetoothEvent> &event) {
+        std::lock_guard<std::mutex> lock(event_list_lock);
         event_list.push_back(event);
     }
 
     /** Remove event to checked against events generated by BlueZ.
       */
     void remove_event(std::shared_ptr<BluetoothEvent> &event) {
+        std::lock_guard<std::mutex> lock(event_list_lock);
         event_list.remove(event);
     }
 
     void remove_event(BluetoothEvent &event) {
+        std::lock_guard<std::mutex> lock(event_list_lock);
         for(auto it = event_list.begin(); it != event_list.end(); ++it) {
             if ((*it).get() == &event) {
                 event_list.remove(*it);
@@ -122,7 +128,8 @@ public:
     /** Find a BluetoothObject of a type matching type. If parameters name,
       * identifier and parent are not null, the returned object will have to
       * match them.
-      * It will first check for existing objects. It will not turn on discovery
+      * It will first check for existing objects via the object index, see get_object(),
+      * then wait for the matching object being added. It will not turn on discovery
       * or connect to devices.
       * @parameter type specify the type of the object you are
       * waiting for, NONE means anything.
@@ -167,6 +174,9 @@ public:
     /** Return a BluetoothObject of a type matching type. If parameters name,
       * identifier and parent are not null, the returned object will have to
       * match them. Only objects which are already in the system will be returned.
+      * Candidates are looked up by type, identifier and parent in an index of the
+      * managed objects, maintained from the object manager's signals,
+      * hence only the candidates are instantiated and matched.
       * @parameter type specify the type of the object you are
       * waiting for, NONE means anything.
       * @parameter name optionally specify the name of the object you are
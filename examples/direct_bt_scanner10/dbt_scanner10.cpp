@@ -25,6 +25,8 @@
 
 #include <direct_bt/DirectBT.hpp>
 #include <cinttypes>
+#include <algorithm>
+#include <map>
 
 #include "direct_bt/dfa_utf8_decode.hpp"
 
@@ -41,6 +43,11 @@ using namespace direct_bt;
  * <p>
  * This example represents the recommended utilization of Direct-BT.
  * </p>
+ * <p>
+ * With '-bench' or '-bench_out <file>', each of the '-count' iterations disconnects after processing
+ * and the latency distributions of discovery, LE connect, L2CAP open, MTU exchange, service discovery
+ * and first read are written as JSON or CSV at the end, allowing to track regressions across releases and hardware.
+ * </p>
  */
 
 static int64_t timestamp_t0;
@@ -57,6 +64,116 @@ static bool SHOW_UPDATE_EVENTS = false;
 
 static EUI48 waitForDevice = EUI48_ANY_DEVICE;
 
+/**
+ * Benchmark mode, collecting per-stage latency distributions over all MULTI_MEASUREMENTS iterations
+ * and emitting them as JSON or CSV at the end, see writeBenchResults().
+ */
+static bool BENCH_MODE = false;
+static std::string BENCH_OUTPUT; // empty for stdout, CSV if ending with '.csv', otherwise JSON
+
+/** Latency samples in microseconds of one benchmark stage. */
+struct BenchStage {
+    const char * name;
+    const char * description;
+    std::vector<uint64_t> samples;
+    uint64_t errors;
+};
+
+enum BenchStageIndex : int {
+    BENCH_DISCOVERY = 0, BENCH_LE_CONNECT, BENCH_L2CAP_OPEN, BENCH_MTU, BENCH_SERVICE_DISCOVERY, BENCH_FIRST_READ, BENCH_STAGE_COUNT
+};
+
+static BenchStage benchStages[BENCH_STAGE_COUNT] = {
+    { "discovery", "discovery start to device found", {}, 0 },
+    { "le_connect", "LE connect command to connected", {}, 0 },
+    { "l2cap_open", "L2CAP ATT channel open incl. reader start", {}, 0 },
+    { "mtu", "ATT MTU exchange", {}, 0 },
+    { "service_discovery", "primary services, characteristics and descriptors", {}, 0 },
+    { "first_read", "first characteristic value read", {}, 0 }
+};
+static std::mutex mtx_bench;
+static std::atomic<uint64_t> benchDiscoveryStart(0); // microseconds
+static std::map<EUI48, uint64_t> benchConnectStart; // microseconds per device
+
+static void benchRecord(const BenchStageIndex stage, const uint64_t usec) {
+    if( BENCH_MODE ) {
+        const std::lock_guard<std::mutex> lock(mtx_bench); // RAII-style acquire and relinquish via destructor
+        benchStages[stage].samples.push_back(usec);
+    }
+}
+
+static void benchRecordError(const BenchStageIndex stage) {
+    if( BENCH_MODE ) {
+        const std::lock_guard<std::mutex> lock(mtx_bench); // RAII-style acquire and relinquish via destructor
+        benchStages[stage].errors++;
+    }
+}
+
+/** Returns the nearest-rank percentile of the sorted samples, q in [0..1]. */
+static uint64_t benchPercentile(const std::vector<uint64_t> & sorted, const double q) {
+    if( 0 == sorted.size() ) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>( q * sorted.size() + 0.999999 );
+    rank = std::max<size_t>(1, std::min<size_t>(rank, sorted.size()));
+    return sorted[rank-1];
+}
+
+/**
+ * Writes the per-stage latency distributions in microseconds to BENCH_OUTPUT or stdout,
+ * as CSV with one header line and one line per stage, or as one JSON object.
+ */
+static void writeBenchResults(const std::string & adapterAddress) {
+    FILE * out = stdout;
+    if( BENCH_OUTPUT.size() > 0 ) {
+        out = fopen(BENCH_OUTPUT.c_str(), "w");
+        if( nullptr == out ) {
+            perror("Could not open benchmark output");
+            return;
+        }
+    }
+    const bool csv = BENCH_OUTPUT.size() >= 4 && 0 == BENCH_OUTPUT.compare(BENCH_OUTPUT.size()-4, 4, ".csv");
+    const std::lock_guard<std::mutex> lock(mtx_bench); // RAII-style acquire and relinquish via destructor
+    if( csv ) {
+        fprintf(out, "stage,count,errors,min_us,mean_us,p50_us,p90_us,p99_us,max_us\n");
+    } else {
+        fprintf(out, "{\n  \"adapter\": \"%s\",\n  \"unit\": \"us\",\n  \"stages\": [\n", adapterAddress.c_str());
+    }
+    for(int i=0; i<BENCH_STAGE_COUNT; i++) {
+        std::vector<uint64_t> sorted = benchStages[i].samples;
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t sum = 0;
+        for(uint64_t v : sorted) {
+            sum += v;
+        }
+        const size_t count = sorted.size();
+        const uint64_t min = 0 < count ? sorted.front() : 0;
+        const uint64_t max = 0 < count ? sorted.back() : 0;
+        const uint64_t mean = 0 < count ? sum / count : 0;
+        const uint64_t p50 = benchPercentile(sorted, 0.50);
+        const uint64_t p90 = benchPercentile(sorted, 0.90);
+        const uint64_t p99 = benchPercentile(sorted, 0.99);
+        if( csv ) {
+            fprintf(out, "%s,%zu,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                    benchStages[i].name, count, benchStages[i].errors, min, mean, p50, p90, p99, max);
+        } else {
+            fprintf(out, "    { \"stage\": \"%s\", \"description\": \"%s\", \"count\": %zu, \"errors\": %" PRIu64 ", "
+                         "\"min\": %" PRIu64 ", \"mean\": %" PRIu64 ", \"p50\": %" PRIu64 ", \"p90\": %" PRIu64 ", \"p99\": %" PRIu64 ", \"max\": %" PRIu64 " }%s\n",
+                    benchStages[i].name, benchStages[i].description, count, benchStages[i].errors,
+                    min, mean, p50, p90, p99, max, i < BENCH_STAGE_COUNT-1 ? "," : "");
+        }
+    }
+    if( !csv ) {
+        fprintf(out, "  ]\n}\n");
+    }
+    if( stdout != out ) {
+        fclose(out);
+        fprintf(stderr, "****** Benchmark results written to %s\n", BENCH_OUTPUT.c_str());
+    } else {
+        fflush(out);
+    }
+}
+
 static void connectDiscoveredDevice(std::shared_ptr<DBTDevice> device);
 
 static void processConnectedDevice(std::shared_ptr<DBTDevice> device);
@@ -122,6 +239,9 @@ class MyAdapterStatusListener : public AdapterStatusListener {
 
     void discoveringChanged(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) override {
         fprintf(stderr, "****** DISCOVERING: enabled %d, keepAlive %d: %s\n", enabled, keepAlive, a.toString().c_str());
+        if( enabled ) {
+            benchDiscoveryStart = getCurrentMicroseconds();
+        }
         (void)timestamp;
     }
 
@@ -146,6 +266,9 @@ class MyAdapterStatusListener : public AdapterStatusListener {
                 const uint64_t td = getCurrentMilliseconds() - timestamp_t0; // adapter-init -> now
                 fprintf(stderr, "PERF: adapter-init -> FOUND__-0  %" PRIu64 " ms\n", td);
             }
+            if( 0 < benchDiscoveryStart ) {
+                benchRecord(BENCH_DISCOVERY, getCurrentMicroseconds() - benchDiscoveryStart);
+            }
             std::thread dc(::connectDiscoveredDevice, device);
             dc.detach();
         } else {
@@ -177,6 +300,20 @@ class MyAdapterStatusListener : public AdapterStatusListener {
                 const uint64_t td = getCurrentMilliseconds() - timestamp_t0; // adapter-init -> now
                 fprintf(stderr, "PERF: adapter-init -> CONNECTED-0  %" PRIu64 " ms\n", td);
             }
+            if( BENCH_MODE ) {
+                uint64_t t0 = 0;
+                {
+                    const std::lock_guard<std::mutex> lock(mtx_bench); // RAII-style acquire and relinquish via destructor
+                    auto it = benchConnectStart.find(device->getAddress());
+                    if( it != benchConnectStart.end() ) {
+                        t0 = it->second;
+                        benchConnectStart.erase(it);
+                    }
+                }
+                if( 0 < t0 ) {
+                    benchRecord(BENCH_LE_CONNECT, getCurrentMicroseconds() - t0);
+                }
+            }
             addToDevicesProcessing(device->getAddress());
             std::thread dc(::processConnectedDevice, device);
             dc.detach();
@@ -241,7 +378,14 @@ static void connectDiscoveredDevice(std::shared_ptr<DBTDevice> device) {
     device->getAdapter().stopDiscovery();
     HCIStatusCode res;
     if( !USE_WHITELIST ) {
+        if( BENCH_MODE ) {
+            const std::lock_guard<std::mutex> lock(mtx_bench); // RAII-style acquire and relinquish via destructor
+            benchConnectStart[device->getAddress()] = getCurrentMicroseconds();
+        }
         res = device->connectDefault();
+        if( HCIStatusCode::SUCCESS != res ) {
+            benchRecordError(BENCH_LE_CONNECT);
+        }
     } else {
         res = HCIStatusCode::SUCCESS;
     }
@@ -263,13 +407,29 @@ static void processConnectedDevice(std::shared_ptr<DBTDevice> device) {
     fprintf(stderr, "****** Processing Device: GATT start: %s\n", device->getAddressString().c_str());
     device->getAdapter().printSharedPtrListOfDevices();
     try {
+        bool firstRead = true;
+        const uint64_t t4us = getCurrentMicroseconds();
         std::vector<GATTServiceRef> primServices = device->getGATTServices(); // implicit GATT connect...
         if( 0 == primServices.size() ) {
             fprintf(stderr, "****** Processing Device: getServices() failed %s\n", device->toString().c_str());
+            benchRecordError(BENCH_SERVICE_DISCOVERY);
             goto exit;
         }
 
         const uint64_t t5 = getCurrentMilliseconds();
+        if( BENCH_MODE ) {
+            const uint64_t t5us = getCurrentMicroseconds();
+            std::shared_ptr<GATTHandler> gatt = device->getGATTHandler();
+            if( nullptr != gatt ) {
+                // getGATTServices() includes the implicit connectGATT(), i.e. L2CAP open and MTU exchange
+                const uint64_t tdL2CAP = gatt->getConnectL2CAPTime();
+                const uint64_t tdMTU = gatt->getConnectMTUTime();
+                const uint64_t td45 = t5us - t4us;
+                benchRecord(BENCH_L2CAP_OPEN, tdL2CAP);
+                benchRecord(BENCH_MTU, tdMTU);
+                benchRecord(BENCH_SERVICE_DISCOVERY, td45 > tdL2CAP + tdMTU ? td45 - tdL2CAP - tdMTU : 0);
+            }
+        }
         {
             const uint64_t td01 = t1 - timestamp_t0; // adapter-init -> processing-start
             const uint64_t td15 = t5 - t1; // get-gatt-services
@@ -307,7 +467,17 @@ static void processConnectedDevice(std::shared_ptr<DBTDevice> device) {
                 fprintf(stderr, "  [%2.2d.%2.2d] Decla: %s\n", (int)i, (int)j, serviceChar.toString().c_str());
                 if( serviceChar.hasProperties(GATTCharacteristic::PropertyBitVal::Read) ) {
                     POctets value(GATTHandler::number(GATTHandler::Defaults::MAX_ATT_MTU), 0);
-                    if( serviceChar.readValue(value) ) {
+                    const uint64_t t6us = getCurrentMicroseconds();
+                    const bool readOK = serviceChar.readValue(value);
+                    if( firstRead ) {
+                        if( readOK ) {
+                            benchRecord(BENCH_FIRST_READ, getCurrentMicroseconds() - t6us);
+                        } else {
+                            benchRecordError(BENCH_FIRST_READ);
+                        }
+                        firstRead = false;
+                    }
+                    if( readOK ) {
                         std::string sval = dfa_utf8_decode(value.get_ptr(), value.getSize());
                         fprintf(stderr, "  [%2.2d.%2.2d] Value: %s ('%s')\n", (int)i, (int)j, value.toString().c_str(), sval.c_str());
                     }
@@ -389,7 +559,7 @@ void test(int dev_id) {
     if( USE_WHITELIST ) {
         for (auto it = WHITELIST.begin(); it != WHITELIST.end(); ++it) {
             std::shared_ptr<EUI48> wlmac = *it;
-            bool res = adapter.addDeviceToWhitelist(*wlmac, BDAddressType::BDADDR_LE_PUBLIC, HCIWhitelistConnectType::HCI_AUTO_CONN_ALWAYS);
+            bool res = adapter.addAutoConnectDevice(*wlmac, BDAddressType::BDADDR_LE_PUBLIC);
             fprintf(stderr, "Added to WHITELIST: res %d, address %s\n", res, wlmac->toString().c_str());
         }
     } else {
@@ -414,6 +584,16 @@ void test(int dev_id) {
     }
     fprintf(stderr, "****** EOL Adapter's Devices\n");
     adapter.printSharedPtrListOfDevices();
+    if( USE_WHITELIST ) {
+        const std::vector<AutoConnectStats> stats = adapter.getAutoConnectStats();
+        for (auto it = stats.begin(); it != stats.end(); ++it) {
+            fprintf(stderr, "****** %s\n", it->toString().c_str());
+        }
+        adapter.removeAllAutoConnectDevices();
+    }
+    if( BENCH_MODE ) {
+        writeBenchResults(adapter.getAddressString());
+    }
 }
 
 int main(int argc, char *argv[])
@@ -451,16 +631,24 @@ int main(int argc, char *argv[])
             MULTI_MEASUREMENTS = atoi(argv[++i]);
         } else if( !strcmp("-single", argv[i]) ) {
             MULTI_MEASUREMENTS = -1;
+        } else if( !strcmp("-bench", argv[i]) ) {
+            BENCH_MODE = true;
+            KEEP_CONNECTED = false; // each iteration connects anew
+        } else if( !strcmp("-bench_out", argv[i]) && argc > (i+1) ) {
+            BENCH_MODE = true;
+            KEEP_CONNECTED = false; // each iteration connects anew
+            BENCH_OUTPUT = std::string(argv[++i]);
         }
     }
     fprintf(stderr, "pid %d\n", getpid());
 
-    fprintf(stderr, "Run with '[-dev_id <adapter-index>] [-btmode <BT-MODE>] [-mac <device_address>] [-disconnect] [-count <number>] [-single] (-wl <device_address>)* [-show_update_events]'\n");
+    fprintf(stderr, "Run with '[-dev_id <adapter-index>] [-btmode <BT-MODE>] [-mac <device_address>] [-disconnect] [-count <number>] [-single] (-wl <device_address>)* [-show_update_events] [-bench] [-bench_out <file.json|file.csv>]'\n");
 
     fprintf(stderr, "MULTI_MEASUREMENTS %d\n", MULTI_MEASUREMENTS);
     fprintf(stderr, "KEEP_CONNECTED %d\n", KEEP_CONNECTED);
     fprintf(stderr, "REMOVE_DEVICE %d\n", REMOVE_DEVICE);
     fprintf(stderr, "USE_WHITELIST %d\n", USE_WHITELIST);
+    fprintf(stderr, "BENCH_MODE %d, output '%s'\n", BENCH_MODE, BENCH_OUTPUT.c_str());
     fprintf(stderr, "dev_id %d\n", dev_id);
     fprintf(stderr, "btmode %s\n", getBTModeString(btMode).c_str());
     fprintf(stderr, "waitForDevice: %s\n", waitForDevice.toString().c_str());
@@ -39,4 +39,14 @@ namespace tinyb {
     GBytes *from_vector_to_gbytes(const std::vector<unsigned char>& array);
     std::vector<unsigned char> from_iter_to_vector(GVariant *iter);
     void handle_error(GError *error);
+
+    /**
+     * Returns a new reference to the interface proxy of the given object path from the ObjectManager's cache,
+     * or nullptr if the object or interface is not known yet.
+     *
+     * The cached proxies' properties are kept up to date by the PropertiesChanged signals
+     * processed on the BluetoothManager's GMainContext thread, i.e. no D-Bus round-trip is required
+     * as for a new proxy via *_proxy_new_for_bus_sync().
+     */
+    GDBusInterface *get_cached_interface(const gchar *object_path, const gchar *interface_name);
 };
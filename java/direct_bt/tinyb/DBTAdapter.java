@@ -26,6 +26,7 @@
 package direct_bt.tinyb;
 
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.Collections;
 import java.util.Iterator;
 import java.util.List;
@@ -350,6 +351,57 @@ public class DBTAdapter extends DBTObject implements BluetoothAdapter
     // std::vector<std::shared_ptr<direct_bt::HCIDevice>> discoveredDevices = adapter.getDiscoveredDevices();
     private native List<BluetoothDevice> getDiscoveredDevicesImpl();
 
+    /**
+     * Native discovered devices retrieved via {@link DBTAdapter#getDiscoveredDevicesDelta(long)}.
+     */
+    public static final class DiscoveredDevicesDelta {
+        /** The native discovered device list's version, to be passed to the next {@link DBTAdapter#getDiscoveredDevicesDelta(long)}. */
+        public final long version;
+        /**
+         * True if the delta since the requested version was not available,
+         * hence {@link #added} holds all discovered devices and shall replace the caller's list.
+         */
+        public final boolean complete;
+        public final List<BluetoothDevice> added;
+        public final List<BluetoothDevice> removed;
+
+        DiscoveredDevicesDelta(final long version, final boolean complete, final BluetoothDevice[] added, final BluetoothDevice[] removed) {
+            this.version = version;
+            this.complete = complete;
+            this.added = Arrays.asList(added);
+            this.removed = Arrays.asList(removed);
+        }
+
+        @Override
+        public String toString() {
+            return "DiscoveredDevicesDelta[version "+version+", complete "+complete+", added "+added.size()+", removed "+removed.size()+"]";
+        }
+    }
+
+    /**
+     * Retrieves the native discovered devices added and removed since the given version.
+     * <p>
+     * Periodic polling only transfers the changes instead of the whole list,
+     * each list being created via one native array. Pass zero for the initial call.
+     * </p>
+     * <p>
+     * If the delta is not available, e.g. the discovered devices have been cleared or too many changes occurred,
+     * all discovered devices are returned, see {@link DiscoveredDevicesDelta#complete}.
+     * </p>
+     * @param since the last known version, i.e. {@link DiscoveredDevicesDelta#version} of the previous call
+     */
+    public DiscoveredDevicesDelta getDiscoveredDevicesDelta(final long since) throws BluetoothException {
+        final long[] version = { 0 };
+        final BluetoothDevice[][] delta = getDiscoveredDevicesDeltaImpl(since, version);
+        if( null != delta ) {
+            return new DiscoveredDevicesDelta(version[0], false, delta[0], delta[1]);
+        }
+        final BluetoothDevice[] all = getDiscoveredDevicesArrayImpl(version);
+        return new DiscoveredDevicesDelta(version[0], true, all, new BluetoothDevice[0]);
+    }
+    private native DBTDevice[] getDiscoveredDevicesArrayImpl(long[] version) throws BluetoothException;
+    private native DBTDevice[][] getDiscoveredDevicesDeltaImpl(long since, long[] version) throws BluetoothException;
+
     @Override
     public int removeDevices() throws BluetoothException {
         final int cj = removeDiscoveredDevices();
@@ -376,7 +428,31 @@ public class DBTAdapter extends DBTObject implements BluetoothAdapter
     }
 
     @Override
-    public native boolean addStatusListener(final AdapterStatusListener l, final BluetoothDevice deviceMatch);
+    public boolean addStatusListener(final AdapterStatusListener l, final BluetoothDevice deviceMatch) {
+        return addStatusListenerImpl(l, deviceMatch, null, null, null, null, DBTDeviceFilter.RSSI_NONE);
+    }
+
+    /**
+     * Add the given {@link AdapterStatusListener} to the list if not already present,
+     * only receiving {@code device*} events of devices matching the given {@link DBTDeviceFilter}.
+     * <p>
+     * The filter is evaluated natively, hence events of irrelevant devices never cross JNI.
+     * The filter is copied at registration, later changes have no effect.
+     * </p>
+     * @param l A {@link AdapterStatusListener} instance
+     * @param filter the {@link DBTDeviceFilter}, pass {@code null} for no filtering
+     * @return true if the given listener is not element of the list and has been newly added, otherwise false.
+     */
+    public boolean addStatusListener(final AdapterStatusListener l, final DBTDeviceFilter filter) {
+        if( null == filter ) {
+            return addStatusListenerImpl(l, null, null, null, null, null, DBTDeviceFilter.RSSI_NONE);
+        }
+        return addStatusListenerImpl(l, null, filter.getAddresses(), filter.getServices(), filter.getCompanies(),
+                                     filter.getNamePrefixes(), filter.getMinRSSI());
+    }
+    private native boolean addStatusListenerImpl(final AdapterStatusListener l, final BluetoothDevice deviceMatch,
+                                                 final String[] addresses, final String[] services, final short[] companies,
+                                                 final String[] namePrefixes, final byte minRSSI);
 
     @Override
     public native boolean removeStatusListener(final AdapterStatusListener l);
@@ -0,0 +1,172 @@
+/**
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package direct_bt.tinyb;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Reusable snapshot of a {@link DBTDevice}'s advertised data,
+ * filled by one native call via {@link #update(DBTDevice)}.
+ * <p>
+ * Replaces separate calls of {@link DBTDevice#getRSSI()}, {@link DBTDevice#getTxPower()},
+ * {@link DBTDevice#getManufacturerData()} etc., each being a native transition and potentially allocating Java objects.
+ * Only {@link #getName()} and {@link #getServiceUUID(int)} create a Java object, when called.
+ * </p>
+ * <p>
+ * The snapshot is stored in a direct {@link ByteBuffer} of fixed layout, little endian:
+ * <pre>
+ *   0: int64  last discovery timestamp
+ *   8: int64  last update timestamp
+ *  16: int8   RSSI
+ *  17: int8   smoothed RSSI
+ *  18: int8   TX power
+ *  19: uint8  1 if manufacturer specific data is available, otherwise 0
+ *  20: uint16 appearance
+ *  22: uint16 manufacturer company identifier
+ *  24: uint16 name length N, UTF-8
+ *  26: uint16 manufacturer data length M
+ *  28: uint16 service count S
+ *  30: uint16 reserved
+ *  32: name[N], manufacturer data[M], S x ( uint8 uuid size, uuid[16] little endian, zero padded )
+ * </pre>
+ * </p>
+ */
+public class DBTAdvertisedSnapshot {
+    /** Fixed header size in bytes. */
+    public static final int HEADER_SIZE = 32;
+    /** Size of one service UUID entry in bytes. */
+    public static final int SERVICE_ENTRY_SIZE = 17;
+
+    private ByteBuffer buffer;
+    private int size = 0;
+
+    /** @param capacity initial buffer capacity, grown on demand by {@link #update(DBTDevice)} */
+    public DBTAdvertisedSnapshot(final int capacity) {
+        buffer = ByteBuffer.allocateDirect(Math.max(HEADER_SIZE, capacity)).order(ByteOrder.LITTLE_ENDIAN);
+    }
+
+    /** Using an initial capacity of 256 bytes. */
+    public DBTAdvertisedSnapshot() {
+        this(256);
+    }
+
+    /**
+     * Updates this snapshot with the given device's advertised data.
+     * <p>
+     * Issues one native call, or two if the buffer needs to grow.
+     * </p>
+     */
+    public void update(final DBTDevice device) {
+        int res = device.getAdvertisedSnapshotImpl(buffer, 0);
+        if( 0 > res ) {
+            buffer = ByteBuffer.allocateDirect(-res).order(ByteOrder.LITTLE_ENDIAN);
+            res = device.getAdvertisedSnapshotImpl(buffer, 0);
+        }
+        size = res;
+    }
+
+    /** Returns true if this snapshot holds valid data, i.e. {@link #update(DBTDevice)} has been called. */
+    public final boolean isValid() { return HEADER_SIZE <= size; }
+
+    /** Returns the underlying direct buffer, valid up to {@link #getSize()}. */
+    public final ByteBuffer getBuffer() { return buffer; }
+
+    /** Returns the size of the snapshot in bytes. */
+    public final int getSize() { return size; }
+
+    public final long getLastDiscoveryTimestamp() { return buffer.getLong(0); }
+    public final long getLastUpdateTimestamp() { return buffer.getLong(8); }
+    public final short getRSSI() { return buffer.get(16); }
+    public final short getSmoothedRSSI() { return buffer.get(17); }
+    public final short getTxPower() { return buffer.get(18); }
+    public final int getAppearance() { return buffer.getShort(20) & 0xffff; }
+
+    public final boolean hasManufacturerData() { return 0 != buffer.get(19); }
+    public final short getManufacturerId() { return buffer.getShort(22); }
+
+    private int getNameLength() { return buffer.getShort(24) & 0xffff; }
+    private int getManufacturerDataLength() { return buffer.getShort(26) & 0xffff; }
+
+    /** Returns the device name, creating a new String. */
+    public final String getName() {
+        final int len = getNameLength();
+        final byte[] b = new byte[len];
+        for(int i=0; i<len; i++) {
+            b[i] = buffer.get(HEADER_SIZE + i);
+        }
+        return new String(b, StandardCharsets.UTF_8);
+    }
+
+    /**
+     * Copies the manufacturer specific data into the given array.
+     * @return the number of copied bytes, or the negative required size if dst is too small.
+     */
+    public final int getManufacturerData(final byte[] dst) {
+        final int len = getManufacturerDataLength();
+        if( len > dst.length ) {
+            return -len;
+        }
+        final int off = HEADER_SIZE + getNameLength();
+        for(int i=0; i<len; i++) {
+            dst[i] = buffer.get(off + i);
+        }
+        return len;
+    }
+
+    public final int getServiceCount() { return buffer.getShort(28) & 0xffff; }
+
+    /**
+     * Returns the service UUID string at the given index, creating a new String.
+     * <p>
+     * 16 and 32 bit UUIDs are expanded to their 128 bit representation
+     * if {@link DBTManager#getUnifyUUID128Bit()} is enabled.
+     * </p>
+     */
+    public final String getServiceUUID(final int index) {
+        if( 0 > index || index >= getServiceCount() ) {
+            throw new IndexOutOfBoundsException("index "+index+", count "+getServiceCount());
+        }
+        final int off = HEADER_SIZE + getNameLength() + getManufacturerDataLength() + index * SERVICE_ENTRY_SIZE;
+        final int type = buffer.get(off);
+        if( 16 == type ) {
+            final StringBuilder sb = new StringBuilder(36);
+            for(int i=15; i>=0; i--) {
+                sb.append(String.format("%02x", buffer.get(off + 1 + i)));
+                if( 12 == i || 10 == i || 8 == i || 6 == i ) {
+                    sb.append('-');
+                }
+            }
+            return sb.toString();
+        }
+        final long v = 2 == type ? ( buffer.getShort(off + 1) & 0xffffL ) : ( buffer.getInt(off + 1) & 0xffffffffL );
+        if( DBTManager.getUnifyUUID128Bit() ) {
+            return String.format("%08x-0000-1000-8000-00805f9b34fb", v);
+        }
+        return 2 == type ? String.format("%04x", v) : String.format("%08x", v);
+    }
+};
@@ -26,6 +26,7 @@
 package direct_bt.tinyb;
 
 import java.lang.ref.WeakReference;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.Map;
@@ -642,6 +643,30 @@ public class DBTDevice extends DBTObject implements BluetoothDevice
     @Override
     public native short getTxPower ();
 
+    /**
+     * Writes all advertised data of this device into the given direct buffer at offset,
+     * using the fixed layout of {@link DBTAdvertisedSnapshot}.
+     * @return the written size in bytes, or the negative required size if the buffer is too small.
+     * @see DBTAdvertisedSnapshot#update(DBTDevice)
+     */
+    /* pp */ native int getAdvertisedSnapshotImpl(final ByteBuffer buffer, final int offset);
+
+    /**
+     * Returns the traffic statistics of this device's connection,
+     * allowing to identify peripherals saturating a shared adapter.
+     * <p>
+     * Elements in order: start and snapshot timestamp in milliseconds, received ATT PDUs and bytes,
+     * sent ATT PDUs and bytes, received notifications and indications, request retries, request timeouts,
+     * number and sum of round-trip time samples in microseconds,
+     * followed by five elements per seen ATT opcode: opcode, received PDUs and bytes, sent PDUs and bytes.
+     * </p>
+     * @param link if true, the link level statistics of the HCI connection,
+     *        which requires ACL data demultiplexing and lacks retries, timeouts and round-trip times,
+     *        otherwise the statistics of the GATT connection.
+     * @return the statistics or null if not connected
+     */
+    public native long[] getTrafficStatistics(final boolean link);
+
     /**
      * {@inheritDoc}
      * <p>
@@ -0,0 +1,128 @@
+/**
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package direct_bt.tinyb;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.UUID;
+
+import org.tinyb.AdapterStatusListener;
+
+/**
+ * Declarative device filter for {@link DBTAdapter#addStatusListener(AdapterStatusListener, DBTDeviceFilter)},
+ * evaluated natively via the native {@code DiscoveryFilter} before any {@code device*} event crosses JNI.
+ * <p>
+ * Each non empty criteria must be satisfied by the device (AND),
+ * while satisfying one of its values is sufficient (OR):
+ * <pre>
+ * - addresses: device address of any address type
+ * - services: advertised service UUIDs
+ * - companies: company identifier of the manufacturer specific data
+ * - name prefixes: device name
+ * - minimum RSSI
+ * </pre>
+ * An empty filter matches all devices.
+ * </p>
+ * <p>
+ * Criteria are evaluated against the device's accumulated advertised data,
+ * hence a device may only match after a later {@code deviceUpdated} event,
+ * e.g. once its scan response with the name has been received.
+ * </p>
+ * <p>
+ * Service UUIDs are compared in their advertised size,
+ * i.e. SIG assigned services shall be given in their 16 bit form, e.g. {@code "180d"}.
+ * </p>
+ */
+public class DBTDeviceFilter {
+    /** RSSI value denoting no minimum RSSI, same as the native {@code DiscoveryFilter::RSSI_NONE}. */
+    public static final byte RSSI_NONE = Byte.MIN_VALUE;
+
+    private final List<String> addresses = new ArrayList<String>();
+    private final List<String> services = new ArrayList<String>();
+    private final List<Short> companies = new ArrayList<Short>();
+    private final List<String> namePrefixes = new ArrayList<String>();
+    private byte minRSSI = RSSI_NONE;
+
+    /** Adds the given address in format {@code 01:02:03:0A:0B:0C}, matching any address type. */
+    public DBTDeviceFilter addAddress(final String address) {
+        addresses.add(address);
+        return this;
+    }
+
+    /** Adds the given service UUID string of 4, 8 or 36 characters, i.e. its 16 bit, 32 bit or 128 bit form. */
+    public DBTDeviceFilter addService(final String uuid) {
+        services.add(uuid);
+        return this;
+    }
+
+    /** Adds the given 128 bit service UUID. */
+    public DBTDeviceFilter addService(final UUID uuid) {
+        services.add(uuid.toString());
+        return this;
+    }
+
+    /** Adds the given company identifier of the manufacturer specific data. */
+    public DBTDeviceFilter addCompany(final int company) {
+        companies.add( Short.valueOf( (short)company ) );
+        return this;
+    }
+
+    /** Adds the given prefix of the device name. */
+    public DBTDeviceFilter addNamePrefix(final String prefix) {
+        namePrefixes.add(prefix);
+        return this;
+    }
+
+    /** Sets the minimum RSSI in dBm, {@link #RSSI_NONE} for none. */
+    public DBTDeviceFilter setMinRSSI(final byte rssi) {
+        minRSSI = rssi;
+        return this;
+    }
+
+    /** Returns true if no criteria has been set, i.e. all devices match. */
+    public boolean isEmpty() {
+        return addresses.isEmpty() && services.isEmpty() && companies.isEmpty() &&
+               namePrefixes.isEmpty() && RSSI_NONE == minRSSI;
+    }
+
+    /* pp */ String[] getAddresses() { return addresses.toArray(new String[addresses.size()]); }
+    /* pp */ String[] getServices() { return services.toArray(new String[services.size()]); }
+    /* pp */ short[] getCompanies() {
+        final short[] res = new short[companies.size()];
+        for(int i=0; i<res.length; i++) {
+            res[i] = companies.get(i).shortValue();
+        }
+        return res;
+    }
+    /* pp */ String[] getNamePrefixes() { return namePrefixes.toArray(new String[namePrefixes.size()]); }
+    /* pp */ byte getMinRSSI() { return minRSSI; }
+
+    @Override
+    public String toString() {
+        return "DBTDeviceFilter[addresses "+addresses+", services "+services+", companies "+companies.size()+
+               ", names "+namePrefixes+", rssi "+( RSSI_NONE != minRSSI ? String.valueOf(minRSSI) : "none" )+"]";
+    }
+}
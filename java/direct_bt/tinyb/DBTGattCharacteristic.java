@@ -26,8 +26,10 @@
 package direct_bt.tinyb;
 
 import java.lang.ref.WeakReference;
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 import java.util.List;
+import java.util.concurrent.CompletableFuture;
 
 import org.tinyb.BluetoothException;
 import org.tinyb.BluetoothFactory;
@@ -74,7 +76,11 @@ public class DBTGattCharacteristic extends DBTObject implements BluetoothGattCha
     /* Optional Client Characteristic Configuration index within descriptorList */
     private final int clientCharacteristicsConfigIndex;
 
-    /* pp */ final List<BluetoothGattDescriptor> descriptorList;
+    /**
+     * Lazily created on first access via {@link #getDescriptors()},
+     * i.e. the Java peers and their native global references of untouched descriptors are never created.
+     */
+    private volatile List<BluetoothGattDescriptor> descriptorList = null;
 
     boolean enabledNotifyState = false;
     boolean enabledIndicateState = false;
@@ -115,7 +121,6 @@ public class DBTGattCharacteristic extends DBTObject implements BluetoothGattCha
         this.value_type_uuid = value_type_uuid;
         this.value_handle = value_handle;
         this.clientCharacteristicsConfigIndex = clientCharacteristicsConfigIndex;
-        this.descriptorList = getDescriptorsImpl();
 
         if( ( BluetoothFactory.DEBUG || BluetoothFactory.DIRECTBT_CHARACTERISTIC_VALUE_CACHE_NOTIFICATION_COMPAT ) &&
             ( hasNotify || hasIndicate )
@@ -240,8 +245,80 @@ public class DBTGattCharacteristic extends DBTObject implements BluetoothGattCha
         return res;
     }
 
+    /**
+     * Writes the remaining bytes of the given direct {@link ByteBuffer}, i.e. from its position up to its limit,
+     * like {@link #writeValue(byte[], boolean)}.
+     * <p>
+     * The native memory of the direct buffer is copied once only, directly into the ATT PDU.
+     * The buffer's position is not changed.
+     * </p>
+     * @param value direct buffer holding the value
+     * @param withResponse if true, writes with response
+     * @throws IllegalArgumentException if the buffer is not direct
+     */
+    public final boolean writeValue(final ByteBuffer value, final boolean withResponse) throws BluetoothException {
+        if( !value.isDirect() ) {
+            throw new IllegalArgumentException("ByteBuffer not direct: "+value);
+        }
+        final boolean res = writeValueDirectImpl(value, value.position(), value.remaining(), withResponse);
+        if( BluetoothFactory.DIRECTBT_CHARACTERISTIC_VALUE_CACHE_NOTIFICATION_COMPAT && res ) {
+            final byte[] copy = new byte[value.remaining()];
+            value.duplicate().get(copy);
+            updateCachedValue(copy, false);
+        }
+        return res;
+    }
+
+    /**
+     * Asynchronous {@link #readValue()}, performed by the device's native GATT async worker
+     * in the order of all async requests.
+     * <p>
+     * The returned future is completed from the native reply path, i.e. no Java thread blocks
+     * per outstanding request. It completes exceptionally with a {@link BluetoothException}
+     * if the read failed, the device is not connected or has been disconnected before the request was performed.
+     * </p>
+     * <p>
+     * The cached value of {@link #getValue()} is not updated.
+     * </p>
+     */
+    public final CompletableFuture<byte[]> readValueAsync() throws BluetoothException {
+        final CompletableFuture<byte[]> future = new CompletableFuture<byte[]>();
+        readValueAsyncImpl(future);
+        return future;
+    }
+
+    /**
+     * Asynchronous {@link #writeValue(byte[], boolean)}, performed by the device's native GATT async worker
+     * in the order of all async requests.
+     * <p>
+     * The returned future is completed from the native reply path with {@link Boolean#TRUE} on success.
+     * It completes exceptionally with a {@link BluetoothException}
+     * if the write failed, the device is not connected or has been disconnected before the request was performed.
+     * </p>
+     * <p>
+     * The given value is copied, the cached value of {@link #getValue()} is not updated.
+     * </p>
+     */
+    public final CompletableFuture<Boolean> writeValueAsync(final byte[] value, final boolean withResponse) throws BluetoothException {
+        final CompletableFuture<Boolean> future = new CompletableFuture<Boolean>();
+        writeValueAsyncImpl(value, withResponse, future);
+        return future;
+    }
+
     @Override
-    public final List<BluetoothGattDescriptor> getDescriptors() { return descriptorList; }
+    public final List<BluetoothGattDescriptor> getDescriptors() {
+        List<BluetoothGattDescriptor> res = descriptorList;
+        if( null == res ) {
+            synchronized( this ) {
+                res = descriptorList;
+                if( null == res ) {
+                    res = getDescriptorsImpl();
+                    descriptorList = res;
+                }
+            }
+        }
+        return res;
+    }
 
     @Override
     public final synchronized boolean configNotificationIndication(final boolean enableNotification, final boolean enableIndication, final boolean enabledState[/*2*/])
@@ -383,6 +460,12 @@ public class DBTGattCharacteristic extends DBTObject implements BluetoothGattCha
 
     private native boolean writeValueImpl(byte[] argValue, boolean withResponse) throws BluetoothException;
 
+    private native boolean writeValueDirectImpl(ByteBuffer argValue, int offset, int length, boolean withResponse) throws BluetoothException;
+
+    private native void readValueAsyncImpl(CompletableFuture<byte[]> future) throws BluetoothException;
+
+    private native void writeValueAsyncImpl(byte[] argValue, boolean withResponse, CompletableFuture<Boolean> future) throws BluetoothException;
+
     private native List<BluetoothGattDescriptor> getDescriptorsImpl();
 
     @Override
@@ -425,9 +508,10 @@ public class DBTGattCharacteristic extends DBTObject implements BluetoothGattCha
         if( !anyType && !descType ) {
             return null;
         }
-        final int size = descriptorList.size();
+        final List<BluetoothGattDescriptor> descriptors = getDescriptors();
+        final int size = descriptors.size();
         for(int i = 0; i < size; i++ ) {
-            final DBTGattDescriptor descr = (DBTGattDescriptor) descriptorList.get(i);
+            final DBTGattDescriptor descr = (DBTGattDescriptor) descriptors.get(i);
             if( null == uuid || descr.getUUID().equals(uuid) ) {
                 return descr;
             }
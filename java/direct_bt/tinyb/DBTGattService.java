@@ -45,7 +45,15 @@ public class DBTGattService extends DBTObject implements BluetoothGattService
     private final String type_uuid;
     private final short handleStart;
     private final short handleEnd;
-    /* pp */ final List<BluetoothGattCharacteristic> characteristicList;
+    /**
+     * Lazily created on first access via {@link #getCharacteristics()},
+     * i.e. the Java peers and their native global references of untouched characteristics and descriptors are never created.
+     * <p>
+     * The native characteristic listener also calls {@link #getCharacteristics()} on demand,
+     * in case a notification or indication arrives for a characteristic w/o Java peer.
+     * </p>
+     */
+    private volatile List<BluetoothGattCharacteristic> characteristicList = null;
 
    /* pp */ DBTGattService(final long nativeInstance, final DBTDevice device, final boolean isPrimary,
                            final String type_uuid, final short handleStart, final short handleEnd)
@@ -56,7 +64,6 @@ public class DBTGattService extends DBTObject implements BluetoothGattService
         this.type_uuid = type_uuid;
         this.handleStart = handleStart;
         this.handleEnd = handleEnd;
-        this.characteristicList = getCharacteristicsImpl();
     }
 
     @Override
@@ -101,7 +108,19 @@ public class DBTGattService extends DBTObject implements BluetoothGattService
     public final boolean getPrimary() { return isPrimary; }
 
     @Override
-    public final List<BluetoothGattCharacteristic> getCharacteristics() { return characteristicList; }
+    public final List<BluetoothGattCharacteristic> getCharacteristics() {
+        List<BluetoothGattCharacteristic> res = characteristicList;
+        if( null == res ) {
+            synchronized( this ) {
+                res = characteristicList;
+                if( null == res ) {
+                    res = getCharacteristicsImpl();
+                    characteristicList = res;
+                }
+            }
+        }
+        return res;
+    }
 
     /**
      * Returns the service start handle.
@@ -174,9 +193,10 @@ public class DBTGattService extends DBTObject implements BluetoothGattService
         if( !anyType && !charType && !descType ) {
             return null;
         }
-        final int characteristicSize = characteristicList.size();
+        final List<BluetoothGattCharacteristic> characteristics = getCharacteristics();
+        final int characteristicSize = characteristics.size();
         for(int charIdx = 0; charIdx < characteristicSize; charIdx++ ) {
-            final DBTGattCharacteristic characteristic = (DBTGattCharacteristic) characteristicList.get(charIdx);
+            final DBTGattCharacteristic characteristic = (DBTGattCharacteristic) characteristics.get(charIdx);
             if( ( anyType || charType ) && ( null == uuid || characteristic.getUUID().equals(uuid) ) ) {
                 return characteristic;
             }
@@ -153,6 +153,23 @@ public class DBTManager implements BluetoothManager
      */
     public static void setUnifyUUID128Bit(final boolean v) { unifyUUID128Bit=v; }
 
+    /**
+     * Returns the statistics of the optional native-to-Java callback dispatch threads,
+     * enabled via environment variable 'direct_bt.jni.dispatch.threads' and
+     * sized via 'direct_bt.jni.dispatch.queue'.
+     * <p>
+     * If enabled, listener upcalls are queued to permanently attached callback threads
+     * instead of being issued on the native reader threads,
+     * hence Java GC pauses or slow handlers don't stall Bluetooth I/O.
+     * </p>
+     * <p>
+     * Elements in order: thread count (zero if disabled), queue capacity per thread,
+     * current queue depth, maximum queue depth, dispatched upcalls, stalls due to a full queue,
+     * mean and maximum latency from queuing to execution in microseconds.
+     * </p>
+     */
+    public static native long[] getCallbackDispatchStatistics();
+
     private long nativeInstance;
     private static DBTManager inst;
     private final List<BluetoothAdapter> adapters = new ArrayList<BluetoothAdapter>();
@@ -27,6 +27,7 @@
  */
 
 #include <cstdio>
+#include <vector>
 
 #include "JNIMem.hpp"
 
@@ -40,9 +41,31 @@
 JavaVM* vm;
 thread_local JNIEnvContainer jni_env;
 
+/** Function local static, being constructed before use by any static initializer. */
+static std::vector<JNIOnLoadCallback> & getJNIOnLoadCallbacks() {
+    static std::vector<JNIOnLoadCallback> callbacks;
+    return callbacks;
+}
+
+bool registerJNIOnLoadCallback(JNIOnLoadCallback cb) {
+    getJNIOnLoadCallbacks().push_back(cb);
+    return true;
+}
+
 jint JNI_OnLoad(JavaVM *initVM, void *reserved) {
     (void)reserved; // warning
     vm = initVM;
+    JNIEnv *env = nullptr;
+    if( JNI_OK == vm->GetEnv((void **) &env, JNI_VERSION_1_8) ) {
+        for(JNIOnLoadCallback cb : getJNIOnLoadCallbacks()) {
+            try {
+                cb(env);
+            } catch (std::exception &e) {
+                fprintf(stderr, "JNI_OnLoad: Callback failed: %s\n", e.what());
+                env->ExceptionClear();
+            }
+        }
+    }
     return JNI_VERSION_1_8;
 }
 
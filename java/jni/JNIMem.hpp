@@ -36,6 +36,21 @@
 
 extern JavaVM* vm;
 
+/**
+ * Callback invoked once within JNI_OnLoad, e.g. to initialize a library's JNI ID cache.
+ * <p>
+ * Thrown exceptions are caught and logged, a callback shall support lazy initialization as a fallback.
+ * </p>
+ */
+typedef void (*JNIOnLoadCallback)(JNIEnv *env);
+
+/**
+ * Registers the given JNIOnLoadCallback, to be used from a static initializer
+ * of the JNI library so it gets invoked by JNI_OnLoad.
+ * @return true for convenience, allowing a static variable initialization
+ */
+bool registerJNIOnLoadCallback(JNIOnLoadCallback cb);
+
 
 /* 
  * This class provides a lifetime-managed JNIEnv object, which attaches or
@@ -36,22 +36,40 @@
 
 using namespace direct_bt;
 
-static const std::string _adapterSettingsClassName("org/tinyb/AdapterSettings");
-static const std::string _adapterSettingsClazzCtorArgs("(I)V");
-static const std::string _eirDataTypeSetClassName("org/tinyb/EIRDataTypeSet");
-static const std::string _eirDataTypeSetClazzCtorArgs("(I)V");
-static const std::string _hciStatusCodeClassName("org/tinyb/HCIStatusCode");
-static const std::string _hciStatusCodeClazzGetArgs("(B)Lorg/tinyb/HCIStatusCode;");
-static const std::string _deviceClazzCtorArgs("(JLdirect_bt/tinyb/DBTAdapter;Ljava/lang/String;IILjava/lang/String;J)V");
-
-static const std::string _adapterSettingsChangedMethodArgs("(Lorg/tinyb/BluetoothAdapter;Lorg/tinyb/AdapterSettings;Lorg/tinyb/AdapterSettings;Lorg/tinyb/AdapterSettings;J)V");
-static const std::string _discoveringChangedMethodArgs("(Lorg/tinyb/BluetoothAdapter;ZZJ)V");
-static const std::string _deviceFoundMethodArgs("(Lorg/tinyb/BluetoothDevice;J)V");
-static const std::string _deviceUpdatedMethodArgs("(Lorg/tinyb/BluetoothDevice;Lorg/tinyb/EIRDataTypeSet;J)V");
-static const std::string _deviceConnectedMethodArgs("(Lorg/tinyb/BluetoothDevice;SJ)V");
-static const std::string _deviceDisconnectedMethodArgs("(Lorg/tinyb/BluetoothDevice;Lorg/tinyb/HCIStatusCode;SJ)V");
-
-class JNIAdapterStatusListener : public AdapterStatusListener {
+/**
+ * Returns the existing Java device instance or creates a new one, which is associated to the native device.
+ * <p>
+ * The returned reference is owned by the native device's JavaGlobalObj, i.e. it shall not be deleted.
+ * </p>
+ */
+static jobject getJavaDevicePeer(JNIEnv *env, const DirectBTJNICache & ids, jobject jadapter,
+                                 const std::shared_ptr<DBTDevice> & device, const uint64_t timestamp)
+{
+    std::shared_ptr<JavaAnonObj> jDeviceRef0 = device->getJavaObject();
+    if( JavaGlobalObj::isValid(jDeviceRef0) ) {
+        // Reuse Java instance
+        return JavaGlobalObj::GetObject(jDeviceRef0);
+    }
+    // New Java instance
+    // Device(final long nativeInstance, final Adapter adptr, final String address, final int intAddressType, final String name)
+    const jstring addr = from_string_to_jstring(env, device->getAddressString());
+    const jstring name = from_string_to_jstring(env, device->getName());
+    java_exception_check_and_throw(env, E_FILE_LINE);
+    jobject tmp_jdevice = env->NewObject(ids.deviceClazz.getClass(), ids.deviceCtor,
+            (jlong)device.get(), jadapter, addr,
+            device->getAddressType(), device->getBLERandomAddressType(),
+            name, (jlong)timestamp);
+    java_exception_check_and_throw(env, E_FILE_LINE);
+    JNIGlobalRef::check(tmp_jdevice, E_FILE_LINE);
+    std::shared_ptr<JavaAnonObj> jDeviceRef1 = device->getJavaObject();
+    JavaGlobalObj::check(jDeviceRef1, E_FILE_LINE);
+    env->DeleteLocalRef(tmp_jdevice);
+    env->DeleteLocalRef(addr);
+    env->DeleteLocalRef(name);
+    return JavaGlobalObj::GetObject(jDeviceRef1);
+}
+
+class JNIAdapterStatusListener : public AdapterStatusListener, public std::enable_shared_from_this<JNIAdapterStatusListener> {
   private:
     /**
         package org.tinyb;
@@ -69,301 +87,369 @@ class JNIAdapterStatusListener : public AdapterStatusListener {
             public void deviceDisconnected(final BluetoothDevice device, final HCIStatusCode reason, final short handle, final long timestamp) { }
 
         };
+
+        public abstract class AdapterStatusBatchListener extends AdapterStatusListener {
+            private final int batchSize;
+            private final int batchDelay;
+            private final BluetoothDevice[] devices;
+            private final int[] updateMasks;
+            private final long[] timestamps;
+            private final byte[] rssi;
+
+            public void devicesDiscovered(final BluetoothDevice[] devices, final int[] updateMasks,
+                                          final long[] timestamps, final byte[] rssi, final int count) { }
+        };
     */
     static std::atomic<int> iname_next;
     int const iname;
     DBTDevice const * const deviceMatchRef;
+    /** Native device filter, evaluated in matchDevice() before any device event crosses JNI */
+    const DiscoveryFilter deviceFilter;
     std::shared_ptr<JavaAnonObj> adapterObjRef;
-    JNIGlobalRef adapterSettingsClazzRef;
-    jmethodID adapterSettingsClazzCtor;
-    JNIGlobalRef eirDataTypeSetClazzRef;
-    jmethodID eirDataTypeSetClazzCtor;
-    JNIGlobalRef hciErrorCodeClazzRef;
-    jmethodID hciErrorCodeClazzGet;
-    JNIGlobalRef deviceClazzRef;
-    jmethodID deviceClazzCtor;
-    jfieldID deviceClazzTSLastDiscoveryField;
-    jfieldID deviceClazzTSLastUpdateField;
-    jfieldID deviceClazzConnectionHandleField;
+    const DirectBTJNICache & ids; // global class references, method and field IDs
     JNIGlobalRef listenerObjRef;
-    jmethodID  mAdapterSettingsChanged = nullptr;
-    jmethodID  mDiscoveringChanged = nullptr;
-    jmethodID  mDeviceFound = nullptr;
-    jmethodID  mDeviceUpdated = nullptr;
-    jmethodID  mDeviceConnected= nullptr;
-    jmethodID  mDeviceDisconnected = nullptr;
 
-  public:
+    /** AdapterStatusBatchListener only: Queued deviceFound (zero mask) and deviceUpdated events */
+    struct BatchEvent {
+        std::shared_ptr<DBTDevice> device;
+        EIRDataType updateMask;
+        uint64_t timestamp;
+    };
+    std::mutex mtx_batch;
+    std::vector<BatchEvent> batchQueue;
+    std::vector<jint> batchUpdateMasks;
+    std::vector<jlong> batchTimestamps;
+    std::vector<jbyte> batchRSSI;
+    size_t batchSize = 0;
+    uint64_t batchDelay = 0;
+    JNIGlobalRef batchDevicesRef;
+    JNIGlobalRef batchUpdateMasksRef;
+    JNIGlobalRef batchTimestampsRef;
+    JNIGlobalRef batchRSSIRef;
+
+    bool isBatching() const { return 0 < batchSize; }
+
+    jobject getJavaArrayField(JNIEnv *env, jfieldID f) {
+        jobject o = env->GetObjectField(listenerObjRef.getObject(), f);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        JNIGlobalRef::check(o, E_FILE_LINE);
+        return o;
+    }
 
-    std::string toString() const override {
-        const std::string devMatchAddr = nullptr != deviceMatchRef ? deviceMatchRef->address.toString() : "nil";
-        return "JNIAdapterStatusListener[this "+aptrHexString(this)+", iname "+std::to_string(iname)+", devMatchAddr "+devMatchAddr+"]";
+    void initBatching(JNIEnv *env) {
+        if( !env->IsInstanceOf(listenerObjRef.getObject(), ids.adapterStatusBatchListenerClazz.getClass()) ) {
+            return;
+        }
+        const jint jbatchSize = env->GetIntField(listenerObjRef.getObject(), ids.batchSizeField);
+        const jint jbatchDelay = env->GetIntField(listenerObjRef.getObject(), ids.batchDelayField);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+
+        jobject o = getJavaArrayField(env, ids.batchDevicesField);
+        batchDevicesRef = JNIGlobalRef(o);
+        env->DeleteLocalRef(o);
+        o = getJavaArrayField(env, ids.batchUpdateMasksField);
+        batchUpdateMasksRef = JNIGlobalRef(o);
+        env->DeleteLocalRef(o);
+        o = getJavaArrayField(env, ids.batchTimestampsField);
+        batchTimestampsRef = JNIGlobalRef(o);
+        env->DeleteLocalRef(o);
+        o = getJavaArrayField(env, ids.batchRSSIField);
+        batchRSSIRef = JNIGlobalRef(o);
+        env->DeleteLocalRef(o);
+
+        batchDelay = static_cast<uint64_t>(jbatchDelay);
+        batchQueue.reserve(jbatchSize);
+        batchUpdateMasks.resize(jbatchSize);
+        batchTimestamps.resize(jbatchSize);
+        batchRSSI.resize(jbatchSize);
+        batchSize = static_cast<size_t>(jbatchSize); // enables batching
     }
 
-    JNIAdapterStatusListener(JNIEnv *env, DBTAdapter *adapter, jobject statusListener, const DBTDevice * _deviceMatchRef)
-    : iname(iname_next.fetch_add(1)), deviceMatchRef(_deviceMatchRef), listenerObjRef(statusListener)
-    {
-        adapterObjRef = adapter->getJavaObject();
-        JavaGlobalObj::check(adapterObjRef, E_FILE_LINE);
+    /** Returns the existing Java device instance or creates a new one, which is associated to the native device. */
+    jobject getJavaDevice(JNIEnv *env, const std::shared_ptr<DBTDevice> & device, const uint64_t timestamp) {
+        return getJavaDevicePeer(env, ids, JavaGlobalObj::GetObject(adapterObjRef), device, timestamp);
+    }
 
-        jclass listenerClazz = search_class(env, listenerObjRef.getObject());
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == listenerClazz ) {
-            throw InternalError("AdapterStatusListener not found", E_FILE_LINE);
+    /** Delivers all queued events with one upcall, caller must hold mtx_batch. */
+    void flushBatchLocked(JNIEnv *env) {
+        const size_t count = batchQueue.size();
+        if( 0 == count ) {
+            return;
         }
-
-        // adapterSettingsClazzRef, adapterSettingsClazzCtor
-        {
-            jclass adapterSettingsClazz = search_class(env, _adapterSettingsClassName.c_str());
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            if( nullptr == adapterSettingsClazz ) {
-                throw InternalError("DBTDevice::java_class not found: "+_adapterSettingsClassName, E_FILE_LINE);
+        jobjectArray jdevices = static_cast<jobjectArray>(batchDevicesRef.getObject());
+        for(size_t i=0; i<count; i++) {
+            const BatchEvent & e = batchQueue[i];
+            jobject jdevice = getJavaDevice(env, e.device, e.timestamp);
+            if( EIRDataType::NONE == e.updateMask ) {
+                env->SetLongField(jdevice, ids.deviceTSLastDiscoveryField, (jlong)e.device->getLastDiscoveryTimestamp());
+            } else {
+                env->SetLongField(jdevice, ids.deviceTSLastUpdateField, (jlong)e.timestamp);
             }
-            adapterSettingsClazzRef = JNIGlobalRef(adapterSettingsClazz);
-            env->DeleteLocalRef(adapterSettingsClazz);
-        }
-        adapterSettingsClazzCtor = search_method(env, adapterSettingsClazzRef.getClass(), "<init>", _adapterSettingsClazzCtorArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == adapterSettingsClazzCtor ) {
-            throw InternalError("AdapterSettings ctor not found: "+_adapterSettingsClassName+".<init>"+_adapterSettingsClazzCtorArgs, E_FILE_LINE);
-        }
-
-        // eirDataTypeSetClazzRef, eirDataTypeSetClazzCtor
-        {
-            jclass eirDataTypeSetClazz = search_class(env, _eirDataTypeSetClassName.c_str());
             java_exception_check_and_throw(env, E_FILE_LINE);
-            if( nullptr == eirDataTypeSetClazz ) {
-                throw InternalError("DBTDevice::java_class not found: "+_eirDataTypeSetClassName, E_FILE_LINE);
-            }
-            eirDataTypeSetClazzRef = JNIGlobalRef(eirDataTypeSetClazz);
-            env->DeleteLocalRef(eirDataTypeSetClazz);
+            env->SetObjectArrayElement(jdevices, (jsize)i, jdevice);
+            batchUpdateMasks[i] = (jint)e.updateMask;
+            batchTimestamps[i] = (jlong)e.timestamp;
+            batchRSSI[i] = (jbyte)e.device->getRSSI();
         }
-        eirDataTypeSetClazzCtor = search_method(env, eirDataTypeSetClazzRef.getClass(), "<init>", _eirDataTypeSetClazzCtorArgs.c_str(), false);
+        env->SetIntArrayRegion(static_cast<jintArray>(batchUpdateMasksRef.getObject()), 0, (jsize)count, batchUpdateMasks.data());
+        env->SetLongArrayRegion(static_cast<jlongArray>(batchTimestampsRef.getObject()), 0, (jsize)count, batchTimestamps.data());
+        env->SetByteArrayRegion(static_cast<jbyteArray>(batchRSSIRef.getObject()), 0, (jsize)count, batchRSSI.data());
         java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == eirDataTypeSetClazzCtor ) {
-            throw InternalError("EIRDataType ctor not found: "+_eirDataTypeSetClassName+".<init>"+_eirDataTypeSetClazzCtorArgs, E_FILE_LINE);
-        }
+        batchQueue.clear();
 
-        // hciErrorCodeClazzRef, hciErrorCodeClazzGet
-        {
-            jclass hciErrorCodeClazz = search_class(env, _hciStatusCodeClassName.c_str());
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            if( nullptr == hciErrorCodeClazz ) {
-                throw InternalError("DBTDevice::java_class not found: "+_hciStatusCodeClassName, E_FILE_LINE);
-            }
-            hciErrorCodeClazzRef = JNIGlobalRef(hciErrorCodeClazz);
-            env->DeleteLocalRef(hciErrorCodeClazz);
-        }
-        hciErrorCodeClazzGet = search_method(env, hciErrorCodeClazzRef.getClass(), "get", _hciStatusCodeClazzGetArgs.c_str(), true);
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.devicesDiscovered,
+                            jdevices, batchUpdateMasksRef.getObject(), batchTimestampsRef.getObject(), batchRSSIRef.getObject(), (jint)count);
         java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == hciErrorCodeClazzGet ) {
-            throw InternalError("EIRDataType ctor not found: "+_hciStatusCodeClassName+".get"+_hciStatusCodeClazzGetArgs, E_FILE_LINE);
+        for(size_t i=0; i<count; i++) {
+            env->SetObjectArrayElement(jdevices, (jsize)i, nullptr); // don't hold on to devices between batches
         }
+    }
 
-        // deviceClazzRef, deviceClazzCtor
+    void queueBatchEvent(std::shared_ptr<DBTDevice> & device, const EIRDataType updateMask, const uint64_t timestamp) {
+        const std::lock_guard<std::mutex> lock(mtx_batch); // RAII-style acquire and relinquish via destructor
+        batchQueue.push_back( BatchEvent { device, updateMask, timestamp } );
+        if( batchQueue.size() >= batchSize ||
+            static_cast<uint64_t>(getCurrentMilliseconds()) - batchQueue[0].timestamp >= batchDelay )
         {
-            jclass deviceClazz = search_class(env, DBTDevice::java_class().c_str());
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            if( nullptr == deviceClazz ) {
-                throw InternalError("DBTDevice::java_class not found: "+DBTDevice::java_class(), E_FILE_LINE);
-            }
-            deviceClazzRef = JNIGlobalRef(deviceClazz);
-            env->DeleteLocalRef(deviceClazz);
-        }
-        deviceClazzCtor = search_method(env, deviceClazzRef.getClass(), "<init>", _deviceClazzCtorArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == deviceClazzCtor ) {
-            throw InternalError("DBTDevice::java_class ctor not found: "+DBTDevice::java_class()+".<init>"+_deviceClazzCtorArgs, E_FILE_LINE);
-        }
-        deviceClazzTSLastDiscoveryField = env->GetFieldID(deviceClazzRef.getClass(), "ts_last_discovery", "J");
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == deviceClazzTSLastDiscoveryField ) {
-            throw InternalError("DBTDevice::java_class field not found: "+DBTDevice::java_class()+".ts_last_discovery", E_FILE_LINE);
-        }
-        deviceClazzTSLastUpdateField = env->GetFieldID(deviceClazzRef.getClass(), "ts_last_update", "J");
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == deviceClazzTSLastUpdateField ) {
-            throw InternalError("DBTDevice::java_class field not found: "+DBTDevice::java_class()+".ts_last_update", E_FILE_LINE);
-        }
-        deviceClazzConnectionHandleField = env->GetFieldID(deviceClazzRef.getClass(), "hciConnHandle", "S");
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == deviceClazzConnectionHandleField ) {
-            throw InternalError("DBTDevice::java_class field not found: "+DBTDevice::java_class()+".hciConnHandle", E_FILE_LINE);
+            flushBatchLocked(*jni_env);
         }
+    }
 
-        mAdapterSettingsChanged = search_method(env, listenerClazz, "adapterSettingsChanged", _adapterSettingsChangedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mAdapterSettingsChanged ) {
-            throw InternalError("AdapterStatusListener has no adapterSettingsChanged"+_adapterSettingsChangedMethodArgs+" method, for "+adapter->toString(), E_FILE_LINE);
-        }
-        mDiscoveringChanged = search_method(env, listenerClazz, "discoveringChanged", _discoveringChangedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mDiscoveringChanged ) {
-            throw InternalError("AdapterStatusListener has no discoveringChanged"+_discoveringChangedMethodArgs+" method, for "+adapter->toString(), E_FILE_LINE);
-        }
-        mDeviceFound = search_method(env, listenerClazz, "deviceFound", _deviceFoundMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mDeviceFound ) {
-            throw InternalError("AdapterStatusListener has no deviceFound"+_deviceFoundMethodArgs+" method, for "+adapter->toString(), E_FILE_LINE);
-        }
-        mDeviceUpdated = search_method(env, listenerClazz, "deviceUpdated", _deviceUpdatedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mDeviceUpdated ) {
-            throw InternalError("AdapterStatusListener has no deviceUpdated"+_deviceUpdatedMethodArgs+" method, for "+adapter->toString(), E_FILE_LINE);
-        }
-        mDeviceConnected = search_method(env, listenerClazz, "deviceConnected", _deviceConnectedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mDeviceConnected ) {
-            throw InternalError("AdapterStatusListener has no deviceConnected"+_deviceConnectedMethodArgs+" method, for "+adapter->toString(), E_FILE_LINE);
-        }
-        mDeviceDisconnected = search_method(env, listenerClazz, "deviceDisconnected", _deviceDisconnectedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mDeviceDisconnected ) {
-            throw InternalError("AdapterStatusListener has no deviceDisconnected"+_deviceDisconnectedMethodArgs+" method, for "+adapter->toString(), E_FILE_LINE);
+    /** Delivers pending batched events ahead of any other event, preserving their order. */
+    void flushBatch() {
+        if( isBatching() ) {
+            const std::lock_guard<std::mutex> lock(mtx_batch); // RAII-style acquire and relinquish via destructor
+            flushBatchLocked(*jni_env);
         }
     }
 
+  public:
+
+    std::string toString() const override {
+        const std::string devMatchAddr = nullptr != deviceMatchRef ? deviceMatchRef->address.toString() : "nil";
+        return "JNIAdapterStatusListener[this "+aptrHexString(this)+", iname "+std::to_string(iname)+", devMatchAddr "+devMatchAddr+
+               ", "+deviceFilter.toString()+"]";
+    }
+
+    JNIAdapterStatusListener(JNIEnv *env, DBTAdapter *adapter, jobject statusListener, const DBTDevice * _deviceMatchRef,
+                             const DiscoveryFilter & _deviceFilter)
+    : iname(iname_next.fetch_add(1)), deviceMatchRef(_deviceMatchRef), deviceFilter(_deviceFilter), ids(DirectBTJNICache::get(env)), listenerObjRef(statusListener)
+    {
+        adapterObjRef = adapter->getJavaObject();
+        JavaGlobalObj::check(adapterObjRef, E_FILE_LINE);
+
+        initBatching(env);
+    }
+
     bool matchDevice(const DBTDevice & device) override {
-        if( nullptr == deviceMatchRef ) {
-            return true;
+        if( nullptr != deviceMatchRef && device != *deviceMatchRef ) {
+            return false;
         }
-        return device == *deviceMatchRef;
+        return deviceFilter.isEmpty() || deviceFilter.match(device);
     }
 
-    void adapterSettingsChanged(DBTAdapter const &a, const AdapterSetting oldmask, const AdapterSetting newmask,
-                                const AdapterSetting changedmask, const uint64_t timestamp) override {
+  private:
+
+    void adapterSettingsChangedImpl(DBTAdapter const &a, const AdapterSetting oldmask, const AdapterSetting newmask,
+                                    const AdapterSetting changedmask, const uint64_t timestamp) {
+        flushBatch();
         JNIEnv *env = *jni_env;
         (void)a;
-        jobject adapterSettingOld = env->NewObject(adapterSettingsClazzRef.getClass(), adapterSettingsClazzCtor,  (jint)oldmask);
+        jobject adapterSettingOld = env->NewObject(ids.adapterSettingsClazz.getClass(), ids.adapterSettingsCtor,  (jint)oldmask);
         java_exception_check_and_throw(env, E_FILE_LINE);
         JNIGlobalRef::check(adapterSettingOld, E_FILE_LINE);
 
-        jobject adapterSettingNew = env->NewObject(adapterSettingsClazzRef.getClass(), adapterSettingsClazzCtor,  (jint)newmask);
+        jobject adapterSettingNew = env->NewObject(ids.adapterSettingsClazz.getClass(), ids.adapterSettingsCtor,  (jint)newmask);
         java_exception_check_and_throw(env, E_FILE_LINE);
         JNIGlobalRef::check(adapterSettingNew, E_FILE_LINE);
 
-        jobject adapterSettingChanged = env->NewObject(adapterSettingsClazzRef.getClass(), adapterSettingsClazzCtor,  (jint)changedmask);
+        jobject adapterSettingChanged = env->NewObject(ids.adapterSettingsClazz.getClass(), ids.adapterSettingsCtor,  (jint)changedmask);
         java_exception_check_and_throw(env, E_FILE_LINE);
         JNIGlobalRef::check(adapterSettingChanged, E_FILE_LINE);
 
-        env->CallVoidMethod(listenerObjRef.getObject(), mAdapterSettingsChanged,
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.adapterSettingsChanged,
                 JavaGlobalObj::GetObject(adapterObjRef), adapterSettingOld, adapterSettingNew, adapterSettingChanged, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
     }
 
-    void discoveringChanged(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) override {
+    void discoveringChangedImpl(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) {
+        flushBatch();
         JNIEnv *env = *jni_env;
         (void)a;
-        env->CallVoidMethod(listenerObjRef.getObject(), mDiscoveringChanged, JavaGlobalObj::GetObject(adapterObjRef),
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.discoveringChanged, JavaGlobalObj::GetObject(adapterObjRef),
                             (jboolean)enabled, (jboolean)keepAlive, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
     }
 
-    void deviceFound(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) override {
-        JNIEnv *env = *jni_env;
-        jobject jdevice;
-        std::shared_ptr<JavaAnonObj> jDeviceRef0 = device->getJavaObject();
-        if( JavaGlobalObj::isValid(jDeviceRef0) ) {
-            // Reuse Java instance
-            jdevice = JavaGlobalObj::GetObject(jDeviceRef0);
-        } else {
-            // New Java instance
-            // Device(final long nativeInstance, final Adapter adptr, final String address, final int intAddressType, final String name)
-            const jstring addr = from_string_to_jstring(env, device->getAddressString());
-            const jstring name = from_string_to_jstring(env, device->getName());
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            jobject tmp_jdevice = env->NewObject(deviceClazzRef.getClass(), deviceClazzCtor,
-                    (jlong)device.get(), JavaGlobalObj::GetObject(adapterObjRef), addr,
-                    device->getAddressType(), device->getBLERandomAddressType(),
-                    name, (jlong)timestamp);
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            JNIGlobalRef::check(tmp_jdevice, E_FILE_LINE);
-            std::shared_ptr<JavaAnonObj> jDeviceRef1 = device->getJavaObject();
-            JavaGlobalObj::check(jDeviceRef1, E_FILE_LINE);
-            jdevice = JavaGlobalObj::GetObject(jDeviceRef1);
-            env->DeleteLocalRef(tmp_jdevice);
+    void deviceFoundImpl(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) {
+        if( isBatching() ) {
+            queueBatchEvent(device, EIRDataType::NONE, timestamp);
+            return;
         }
-        env->SetLongField(jdevice, deviceClazzTSLastDiscoveryField, (jlong)device->getLastDiscoveryTimestamp());
+        JNIEnv *env = *jni_env;
+        jobject jdevice = getJavaDevice(env, device, timestamp);
+        env->SetLongField(jdevice, ids.deviceTSLastDiscoveryField, (jlong)device->getLastDiscoveryTimestamp());
         java_exception_check_and_throw(env, E_FILE_LINE);
-        env->CallVoidMethod(listenerObjRef.getObject(), mDeviceFound, jdevice, (jlong)timestamp);
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.deviceFound, jdevice, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
     }
 
-    void deviceUpdated(std::shared_ptr<DBTDevice> device, const EIRDataType updateMask, const uint64_t timestamp) override {
+    void deviceUpdatedImpl(std::shared_ptr<DBTDevice> device, const EIRDataType updateMask, const uint64_t timestamp) {
+        if( isBatching() ) {
+            queueBatchEvent(device, updateMask, timestamp);
+            return;
+        }
         JNIEnv *env = *jni_env;
         std::shared_ptr<JavaAnonObj> jDeviceRef = device->getJavaObject();
         JavaGlobalObj::check(jDeviceRef, E_FILE_LINE);
-        env->SetLongField(JavaGlobalObj::GetObject(jDeviceRef), deviceClazzTSLastUpdateField, (jlong)timestamp);
+        env->SetLongField(JavaGlobalObj::GetObject(jDeviceRef), ids.deviceTSLastUpdateField, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
 
-        jobject eirDataTypeSet = env->NewObject(eirDataTypeSetClazzRef.getClass(), eirDataTypeSetClazzCtor, (jint)updateMask);
+        jobject eirDataTypeSet = env->NewObject(ids.eirDataTypeSetClazz.getClass(), ids.eirDataTypeSetCtor, (jint)updateMask);
         java_exception_check_and_throw(env, E_FILE_LINE);
         JNIGlobalRef::check(eirDataTypeSet, E_FILE_LINE);
 
-        env->CallVoidMethod(listenerObjRef.getObject(), mDeviceUpdated, JavaGlobalObj::GetObject(jDeviceRef), eirDataTypeSet, (jlong)timestamp);
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.deviceUpdated, JavaGlobalObj::GetObject(jDeviceRef), eirDataTypeSet, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
     }
 
-    void deviceConnected(std::shared_ptr<DBTDevice> device, const uint16_t handle, const uint64_t timestamp) override {
+    void deviceConnectedImpl(std::shared_ptr<DBTDevice> device, const uint16_t handle, const uint64_t timestamp) {
+        flushBatch();
         JNIEnv *env = *jni_env;
 
-        jobject jdevice;
-        std::shared_ptr<JavaAnonObj> jDeviceRef0 = device->getJavaObject();
-        if( JavaGlobalObj::isValid(jDeviceRef0) ) {
-            // Reuse Java instance
-            jdevice = JavaGlobalObj::GetObject(jDeviceRef0);
-        } else {
-            // New Java instance
-            // Device(final long nativeInstance, final Adapter adptr, final String address, final int intAddressType, final String name)
-            const jstring addr = from_string_to_jstring(env, device->getAddressString());
-            const jstring name = from_string_to_jstring(env, device->getName());
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            jobject tmp_jdevice = env->NewObject(deviceClazzRef.getClass(), deviceClazzCtor,
-                    (jlong)device.get(), JavaGlobalObj::GetObject(adapterObjRef), addr,
-                    device->getAddressType(), device->getBLERandomAddressType(),
-                    name, (jlong)timestamp);
-            java_exception_check_and_throw(env, E_FILE_LINE);
-            JNIGlobalRef::check(tmp_jdevice, E_FILE_LINE);
-            std::shared_ptr<JavaAnonObj> jDeviceRef1 = device->getJavaObject();
-            JavaGlobalObj::check(jDeviceRef1, E_FILE_LINE);
-            jdevice = JavaGlobalObj::GetObject(jDeviceRef1);
-            env->DeleteLocalRef(tmp_jdevice);
-        }
-        env->SetShortField(jdevice, deviceClazzConnectionHandleField, (jshort)handle);
+        jobject jdevice = getJavaDevice(env, device, timestamp);
+        env->SetShortField(jdevice, ids.deviceConnectionHandleField, (jshort)handle);
         java_exception_check_and_throw(env, E_FILE_LINE);
-        env->SetLongField(jdevice, deviceClazzTSLastDiscoveryField, (jlong)device->getLastDiscoveryTimestamp());
+        env->SetLongField(jdevice, ids.deviceTSLastDiscoveryField, (jlong)device->getLastDiscoveryTimestamp());
         java_exception_check_and_throw(env, E_FILE_LINE);
-        env->SetLongField(jdevice, deviceClazzTSLastUpdateField, (jlong)timestamp);
+        env->SetLongField(jdevice, ids.deviceTSLastUpdateField, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
 
-        env->CallVoidMethod(listenerObjRef.getObject(), mDeviceConnected, jdevice, (jshort)handle, (jlong)timestamp);
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.deviceConnected, jdevice, (jshort)handle, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
     }
-    void deviceDisconnected(std::shared_ptr<DBTDevice> device, const HCIStatusCode reason, const uint16_t handle, const uint64_t timestamp) override {
+    void deviceDisconnectedImpl(std::shared_ptr<DBTDevice> device, const HCIStatusCode reason, const uint16_t handle, const uint64_t timestamp) {
+        flushBatch();
         JNIEnv *env = *jni_env;
 
         std::shared_ptr<JavaAnonObj> jDeviceRef = device->getJavaObject();
         JavaGlobalObj::check(jDeviceRef, E_FILE_LINE);
         jobject jdevice = JavaGlobalObj::GetObject(jDeviceRef);
-        env->SetLongField(jdevice, deviceClazzTSLastUpdateField, (jlong)timestamp);
+        env->SetLongField(jdevice, ids.deviceTSLastUpdateField, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
 
-        jobject hciErrorCode = env->CallStaticObjectMethod(hciErrorCodeClazzRef.getClass(), hciErrorCodeClazzGet, (jbyte)static_cast<uint8_t>(reason));
+        jobject hciErrorCode = env->CallStaticObjectMethod(ids.hciStatusCodeClazz.getClass(), ids.hciStatusCodeGet, (jbyte)static_cast<uint8_t>(reason));
         java_exception_check_and_throw(env, E_FILE_LINE);
         JNIGlobalRef::check(hciErrorCode, E_FILE_LINE);
 
-        env->SetShortField(jdevice, deviceClazzConnectionHandleField, (jshort)0); // zero out, disconnected
+        env->SetShortField(jdevice, ids.deviceConnectionHandleField, (jshort)0); // zero out, disconnected
         java_exception_check_and_throw(env, E_FILE_LINE);
-        env->SetLongField(jdevice, deviceClazzTSLastUpdateField, (jlong)timestamp);
+        env->SetLongField(jdevice, ids.deviceTSLastUpdateField, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
 
-        env->CallVoidMethod(listenerObjRef.getObject(), mDeviceDisconnected, jdevice, hciErrorCode, (jshort)handle, (jlong)timestamp);
+        env->CallVoidMethod(listenerObjRef.getObject(), ids.deviceDisconnected, jdevice, hciErrorCode, (jshort)handle, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
     }
+
+  public:
+
+    // Upcalls are passed to DirectBTJNIDispatcher if enabled, keeping this listener alive until delivered.
+
+    void adapterSettingsChanged(DBTAdapter const &a, const AdapterSetting oldmask, const AdapterSetting newmask,
+                                const AdapterSetting changedmask, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNIAdapterStatusListener> self = shared_from_this();
+            const DBTAdapter * ap = &a;
+            dispatcher.dispatch(this, [self, ap, oldmask, newmask, changedmask, timestamp]() {
+                self->adapterSettingsChangedImpl(*ap, oldmask, newmask, changedmask, timestamp);
+            });
+        } else {
+            adapterSettingsChangedImpl(a, oldmask, newmask, changedmask, timestamp);
+        }
+    }
+
+    void discoveringChanged(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNIAdapterStatusListener> self = shared_from_this();
+            const DBTAdapter * ap = &a;
+            dispatcher.dispatch(this, [self, ap, enabled, keepAlive, timestamp]() {
+                self->discoveringChangedImpl(*ap, enabled, keepAlive, timestamp);
+            });
+        } else {
+            discoveringChangedImpl(a, enabled, keepAlive, timestamp);
+        }
+    }
+
+    void deviceFound(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNIAdapterStatusListener> self = shared_from_this();
+            dispatcher.dispatch(this, [self, device, timestamp]() {
+                self->deviceFoundImpl(device, timestamp);
+            });
+        } else {
+            deviceFoundImpl(device, timestamp);
+        }
+    }
+
+    void deviceUpdated(std::shared_ptr<DBTDevice> device, const EIRDataType updateMask, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNIAdapterStatusListener> self = shared_from_this();
+            dispatcher.dispatch(this, [self, device, updateMask, timestamp]() {
+                self->deviceUpdatedImpl(device, updateMask, timestamp);
+            });
+        } else {
+            deviceUpdatedImpl(device, updateMask, timestamp);
+        }
+    }
+
+    void deviceConnected(std::shared_ptr<DBTDevice> device, const uint16_t handle, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNIAdapterStatusListener> self = shared_from_this();
+            dispatcher.dispatch(this, [self, device, handle, timestamp]() {
+                self->deviceConnectedImpl(device, handle, timestamp);
+            });
+        } else {
+            deviceConnectedImpl(device, handle, timestamp);
+        }
+    }
+
+    void deviceDisconnected(std::shared_ptr<DBTDevice> device, const HCIStatusCode reason, const uint16_t handle, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNIAdapterStatusListener> self = shared_from_this();
+            dispatcher.dispatch(this, [self, device, reason, handle, timestamp]() {
+                self->deviceDisconnectedImpl(device, reason, handle, timestamp);
+            });
+        } else {
+            deviceDisconnectedImpl(device, reason, handle, timestamp);
+        }
+    }
 };
 std::atomic<int> JNIAdapterStatusListener::iname_next(0);
 
-jboolean Java_direct_1bt_tinyb_DBTAdapter_addStatusListener(JNIEnv *env, jobject obj, jobject statusListener, jobject jdeviceMatch)
+static void addFilterStrings(JNIEnv *env, jobjectArray jarray, const std::function<void(const std::string &)> & add) {
+    if( nullptr == jarray ) {
+        return;
+    }
+    const jsize count = env->GetArrayLength(jarray);
+    for(jsize i=0; i<count; i++) {
+        jstring jstr = static_cast<jstring>( env->GetObjectArrayElement(jarray, i) );
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        if( nullptr != jstr ) {
+            add( from_jstring_to_string(env, jstr) );
+            env->DeleteLocalRef(jstr);
+        }
+    }
+}
+
+jboolean Java_direct_1bt_tinyb_DBTAdapter_addStatusListenerImpl(JNIEnv *env, jobject obj, jobject statusListener, jobject jdeviceMatch,
+                                                                jobjectArray jaddresses, jobjectArray jservices, jshortArray jcompanies,
+                                                                jobjectArray jnamePrefixes, jbyte minRSSI)
 {
     try {
         if( nullptr == statusListener ) {
@@ -386,8 +472,23 @@ jboolean Java_direct_1bt_tinyb_DBTAdapter_addStatusListener(JNIEnv *env, jobject
             JavaGlobalObj::check(deviceMatchRef->getJavaObject(), E_FILE_LINE);
         }
 
+        DiscoveryFilter deviceFilter;
+        addFilterStrings(env, jaddresses, [&](const std::string & s) { deviceFilter.addAddress(EUI48(s)); });
+        addFilterStrings(env, jservices, [&](const std::string & s) { deviceFilter.addService( uuid_value_t( *uuid_t::create(s) ) ); });
+        addFilterStrings(env, jnamePrefixes, [&](const std::string & s) { deviceFilter.addNamePrefix(s); });
+        if( nullptr != jcompanies ) {
+            const jsize count = env->GetArrayLength(jcompanies);
+            std::vector<jshort> companies(count);
+            env->GetShortArrayRegion(jcompanies, 0, count, companies.data());
+            java_exception_check_and_throw(env, E_FILE_LINE);
+            for(jsize i=0; i<count; i++) {
+                deviceFilter.addCompany( static_cast<uint16_t>(companies[i]) );
+            }
+        }
+        deviceFilter.setMinRSSI(minRSSI);
+
         std::shared_ptr<AdapterStatusListener> l =
-                std::shared_ptr<AdapterStatusListener>( new JNIAdapterStatusListener(env, adapter, statusListener, deviceMatchRef) );
+                std::shared_ptr<AdapterStatusListener>( new JNIAdapterStatusListener(env, adapter, statusListener, deviceMatchRef, deviceFilter) );
 
         if( adapter->addStatusListener( l ) ) {
             setInstance(env, statusListener, l.get());
@@ -571,6 +672,74 @@ jobject Java_direct_1bt_tinyb_DBTAdapter_getDiscoveredDevicesImpl(JNIEnv *env, j
     return nullptr;
 }
 
+/** Returns a new Java DBTDevice array of the given devices' peers, created via one NewObjectArray(). */
+static jobjectArray toJavaDeviceArray(JNIEnv *env, const DirectBTJNICache & ids, jobject jadapter,
+                                      const std::vector<std::shared_ptr<DBTDevice>> & devices)
+{
+    const jsize count = (jsize)devices.size();
+    jobjectArray jdevices = env->NewObjectArray(count, ids.deviceClazz.getClass(), nullptr);
+    java_exception_check_and_throw(env, E_FILE_LINE);
+    for(jsize i=0; i<count; i++) {
+        const std::shared_ptr<DBTDevice> & device = devices[i];
+        env->SetObjectArrayElement(jdevices, i, getJavaDevicePeer(env, ids, jadapter, device, device->getLastDiscoveryTimestamp()));
+    }
+    java_exception_check_and_throw(env, E_FILE_LINE);
+    return jdevices;
+}
+
+static void setVersion(JNIEnv *env, jlongArray jversion, const uint64_t version) {
+    if( nullptr == jversion || 1 > env->GetArrayLength(jversion) ) {
+        throw IllegalArgumentException("version array null or empty", E_FILE_LINE);
+    }
+    const jlong v = (jlong)version;
+    env->SetLongArrayRegion(jversion, 0, 1, &v);
+    java_exception_check_and_throw(env, E_FILE_LINE);
+}
+
+jobjectArray Java_direct_1bt_tinyb_DBTAdapter_getDiscoveredDevicesArrayImpl(JNIEnv *env, jobject obj, jlongArray jversion)
+{
+    try {
+        DBTAdapter *adapter = getDBTObject<DBTAdapter>(env, obj);
+        JavaGlobalObj::check(adapter->getJavaObject(), E_FILE_LINE);
+        const DirectBTJNICache & ids = DirectBTJNICache::get(env);
+        uint64_t version;
+        std::vector<std::shared_ptr<DBTDevice>> devices = adapter->getDiscoveredDevices(version);
+        setVersion(env, jversion, version);
+        return toJavaDeviceArray(env, ids, obj, devices);
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+    return nullptr;
+}
+
+jobjectArray Java_direct_1bt_tinyb_DBTAdapter_getDiscoveredDevicesDeltaImpl(JNIEnv *env, jobject obj, jlong since, jlongArray jversion)
+{
+    try {
+        DBTAdapter *adapter = getDBTObject<DBTAdapter>(env, obj);
+        JavaGlobalObj::check(adapter->getJavaObject(), E_FILE_LINE);
+        const DirectBTJNICache & ids = DirectBTJNICache::get(env);
+        uint64_t version;
+        std::vector<std::shared_ptr<DBTDevice>> added, removed;
+        if( !adapter->getDiscoveredDevicesDelta((uint64_t)since, version, added, removed) ) {
+            setVersion(env, jversion, version);
+            return nullptr;
+        }
+        setVersion(env, jversion, version);
+        jobjectArray jres = env->NewObjectArray(2, ids.deviceArrayClazz.getClass(), nullptr);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        jobjectArray jadded = toJavaDeviceArray(env, ids, obj, added);
+        env->SetObjectArrayElement(jres, 0, jadded);
+        env->DeleteLocalRef(jadded);
+        jobjectArray jremoved = toJavaDeviceArray(env, ids, obj, removed);
+        env->SetObjectArrayElement(jres, 1, jremoved);
+        env->DeleteLocalRef(jremoved);
+        return jres;
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+    return nullptr;
+}
+
 jint Java_direct_1bt_tinyb_DBTAdapter_removeDevicesImpl(JNIEnv *env, jobject obj)
 {
     try {
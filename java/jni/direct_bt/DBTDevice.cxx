@@ -37,10 +37,51 @@
 
 using namespace direct_bt;
 
-static const std::string _notificationReceivedMethodArgs("(Lorg/tinyb/BluetoothGattCharacteristic;[BJ)V");
-static const std::string _indicationReceivedMethodArgs("(Lorg/tinyb/BluetoothGattCharacteristic;[BJZ)V");
+/**
+ * Returns the Java peer of the given characteristic, creating it on demand if not yet existing.
+ * <p>
+ * Java characteristic peers are created lazily by DBTGattService.getCharacteristics(),
+ * hence a notification or indication may arrive for a characteristic never accessed from Java,
+ * e.g. with a CCCD enabled by a session resumption or persisted by a bonded device.
+ * </p>
+ * <p>
+ * The missing peers are created by calling DBTDevice.checkServiceCache(true), materializing the service peers if none exist,
+ * and DBTGattService.getCharacteristics() of the characteristic's service.
+ * </p>
+ * @return the Java characteristic or nullptr if its peer could not be created
+ */
+static jobject getCharacteristicJavaObject(JNIEnv *env, GATTCharacteristic & characteristic) {
+    if( nullptr != characteristic.getJavaObject() ) {
+        return JavaGlobalObj::GetObject(characteristic.getJavaObject());
+    }
+    std::shared_ptr<GATTService> service = characteristic.getServiceChecked();
+    if( nullptr == service->getJavaObject() ) {
+        std::shared_ptr<DBTDevice> device = service->getDeviceChecked();
+        JavaGlobalObj::check(device->getJavaObject(), E_FILE_LINE);
+        jobject jdevice = JavaGlobalObj::GetObject(device->getJavaObject());
+        jclass deviceClazz = env->GetObjectClass(jdevice);
+        jmethodID mCheckServiceCache = search_method(env, deviceClazz, "checkServiceCache", "(Z)Z", false);
+        env->CallBooleanMethod(jdevice, mCheckServiceCache, JNI_TRUE);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        env->DeleteLocalRef(deviceClazz);
+        if( nullptr == service->getJavaObject() ) {
+            return nullptr;
+        }
+    }
+    jobject jservice = JavaGlobalObj::GetObject(service->getJavaObject());
+    jclass serviceClazz = env->GetObjectClass(jservice);
+    jmethodID mGetCharacteristics = search_method(env, serviceClazz, "getCharacteristics", "()Ljava/util/List;", false);
+    jobject jlist = env->CallObjectMethod(jservice, mGetCharacteristics);
+    java_exception_check_and_throw(env, E_FILE_LINE);
+    env->DeleteLocalRef(jlist);
+    env->DeleteLocalRef(serviceClazz);
+    if( nullptr == characteristic.getJavaObject() ) {
+        return nullptr;
+    }
+    return JavaGlobalObj::GetObject(characteristic.getJavaObject());
+}
 
-class JNICharacteristicListener : public GATTCharacteristicListener {
+class JNICharacteristicListener : public GATTCharacteristicListener, public std::enable_shared_from_this<JNICharacteristicListener> {
   private:
     /**
         package org.tinyb;
@@ -58,6 +99,20 @@ class JNICharacteristicListener : public GATTCharacteristicListener {
             }
 
         };
+
+        public abstract class GATTCharacteristicBufferListener extends GATTCharacteristicListener {
+            private final ByteBuffer buffer; // direct
+
+            public void notificationReceived(final BluetoothGattCharacteristic charDecl,
+                                             final ByteBuffer value, final int offset, final int length,
+                                             final long timestamp) {
+            }
+
+            public void indicationReceived(final BluetoothGattCharacteristic charDecl,
+                                           final ByteBuffer value, final int offset, final int length,
+                                           final long timestamp, final boolean confirmationSent) {
+            }
+        };
     */
     const GATTCharacteristic * associatedCharacteristicRef;
     JNIGlobalRef listenerObj; // keep listener instance alive
@@ -65,32 +120,67 @@ class JNICharacteristicListener : public GATTCharacteristicListener {
     jmethodID  mNotificationReceived = nullptr;
     jmethodID  mIndicationReceived = nullptr;
 
+    /** GATTCharacteristicBufferListener only: Direct ByteBuffer used as a ring of values, no allocation per event */
+    JNIGlobalRef bufferObj;
+    uint8_t * bufferPtr = nullptr;
+    size_t bufferCapacity = 0;
+    size_t bufferWritePos = 0;
+    jmethodID  mNotificationReceivedBuffer = nullptr;
+    jmethodID  mIndicationReceivedBuffer = nullptr;
+
+    /**
+     * Copies the value into the ring buffer, returning its offset
+     * or -1 if no buffer is used or the value exceeds its capacity.
+     * <p>
+     * Callbacks of one listener are issued from its GATTHandler's reader thread
+     * or its bound DirectBTJNIDispatcher thread only, no locking required.
+     * </p>
+     */
+    jint putBuffer(const TROOctets & value) {
+        const size_t size = value.getSize();
+        if( nullptr == bufferPtr || size > bufferCapacity ) {
+            return -1;
+        }
+        if( bufferWritePos + size > bufferCapacity ) {
+            bufferWritePos = 0;
+        }
+        const size_t offset = bufferWritePos;
+        memcpy(bufferPtr + offset, value.get_ptr(), size);
+        bufferWritePos += size;
+        return (jint)offset;
+    }
+
   public:
 
     JNICharacteristicListener(JNIEnv *env, DBTDevice *device, jobject listener, GATTCharacteristic * associatedCharacteristicRef)
     : associatedCharacteristicRef(associatedCharacteristicRef),
       listenerObj(listener)
     {
-        jclass listenerClazz = search_class(env, listenerObj.getObject());
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == listenerClazz ) {
-            throw InternalError("CharacteristicListener not found", E_FILE_LINE);
-        }
+        const DirectBTJNICache & ids = DirectBTJNICache::get(env);
 
         if( nullptr != associatedCharacteristicRef ) {
             JavaGlobalObj::check(associatedCharacteristicRef->getJavaObject(), E_FILE_LINE);
             associatedCharacteristicObj = JavaGlobalObj::GetJavaObject(associatedCharacteristicRef->getJavaObject()); // new global ref
         }
 
-        mNotificationReceived = search_method(env, listenerClazz, "notificationReceived", _notificationReceivedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mNotificationReceived ) {
-            throw InternalError("GATTCharacteristicListener has no notificationReceived"+_notificationReceivedMethodArgs+" method, for "+device->toString(), E_FILE_LINE);
-        }
-        mIndicationReceived = search_method(env, listenerClazz, "indicationReceived", _indicationReceivedMethodArgs.c_str(), false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mNotificationReceived ) {
-            throw InternalError("GATTCharacteristicListener has no indicationReceived"+_indicationReceivedMethodArgs+" method, for "+device->toString(), E_FILE_LINE);
+        mNotificationReceived = ids.notificationReceived;
+        mIndicationReceived = ids.indicationReceived;
+
+        if( env->IsInstanceOf(listenerObj.getObject(), ids.characteristicBufferListenerClazz.getClass()) ) {
+            jobject jbuffer = env->GetObjectField(listenerObj.getObject(), ids.bufferField);
+            java_exception_check_and_throw(env, E_FILE_LINE);
+            JNIGlobalRef::check(jbuffer, E_FILE_LINE);
+            bufferObj = JNIGlobalRef(jbuffer); // keep buffer alive while writing into it
+            env->DeleteLocalRef(jbuffer);
+            bufferPtr = (uint8_t *) env->GetDirectBufferAddress(bufferObj.getObject());
+            const jlong capacity = env->GetDirectBufferCapacity(bufferObj.getObject());
+            if( nullptr == bufferPtr || 0 >= capacity ) {
+                throw InternalError("GATTCharacteristicBufferListener buffer is not direct, for "+device->toString(), E_FILE_LINE);
+            }
+            bufferCapacity = (size_t)capacity;
+
+            mNotificationReceivedBuffer = ids.notificationReceivedBuffer;
+            mIndicationReceivedBuffer = ids.indicationReceivedBuffer;
         }
     }
 
@@ -101,13 +191,25 @@ class JNICharacteristicListener : public GATTCharacteristicListener {
         return characteristic == *associatedCharacteristicRef;
     }
 
-    void notificationReceived(GATTCharacteristicRef charDecl,
-                              std::shared_ptr<TROOctets> charValue, const uint64_t timestamp) override {
+  private:
+
+    void notificationReceivedImpl(GATTCharacteristicRef charDecl,
+                                  std::shared_ptr<TROOctets> charValue, const uint64_t timestamp) {
         JNIEnv *env = *jni_env;
-        JavaGlobalObj::check(charDecl->getJavaObject(), E_FILE_LINE);
-        jobject jCharDecl = JavaGlobalObj::GetObject(charDecl->getJavaObject());
+        jobject jCharDecl = getCharacteristicJavaObject(env, *charDecl);
+        if( nullptr == jCharDecl ) {
+            WARN_PRINT("JNICharacteristicListener: No Java peer, dropped notification: %s", charDecl->toString().c_str());
+            return;
+        }
 
         const size_t value_size = charValue->getSize();
+        const jint offset = putBuffer(*charValue);
+        if( 0 <= offset ) {
+            env->CallVoidMethod(listenerObj.getObject(), mNotificationReceivedBuffer,
+                                jCharDecl, bufferObj.getObject(), offset, (jint)value_size, (jlong)timestamp);
+            java_exception_check_and_throw(env, E_FILE_LINE);
+            return;
+        }
         jbyteArray jvalue = env->NewByteArray((jsize)value_size);
         env->SetByteArrayRegion(jvalue, 0, (jsize)value_size, (const jbyte *)charValue->get_ptr());
         java_exception_check_and_throw(env, E_FILE_LINE);
@@ -116,16 +218,27 @@ class JNICharacteristicListener : public GATTCharacteristicListener {
         env->CallVoidMethod(listenerObj.getObject(), mNotificationReceived,
                             jCharDecl, jvalue, (jlong)timestamp);
         java_exception_check_and_throw(env, E_FILE_LINE);
+        env->DeleteLocalRef(jvalue);
     }
 
-    void indicationReceived(GATTCharacteristicRef charDecl,
-                            std::shared_ptr<TROOctets> charValue, const uint64_t timestamp,
-                            const bool confirmationSent) override {
+    void indicationReceivedImpl(GATTCharacteristicRef charDecl,
+                                std::shared_ptr<TROOctets> charValue, const uint64_t timestamp,
+                                const bool confirmationSent) {
         JNIEnv *env = *jni_env;
-        JavaGlobalObj::check(charDecl->getJavaObject(), E_FILE_LINE);
-        jobject jCharDecl = JavaGlobalObj::GetObject(charDecl->getJavaObject());
+        jobject jCharDecl = getCharacteristicJavaObject(env, *charDecl);
+        if( nullptr == jCharDecl ) {
+            WARN_PRINT("JNICharacteristicListener: No Java peer, dropped indication: %s", charDecl->toString().c_str());
+            return;
+        }
 
         const size_t value_size = charValue->getSize();
+        const jint offset = putBuffer(*charValue);
+        if( 0 <= offset ) {
+            env->CallVoidMethod(listenerObj.getObject(), mIndicationReceivedBuffer,
+                                jCharDecl, bufferObj.getObject(), offset, (jint)value_size, (jlong)timestamp, (jboolean)confirmationSent);
+            java_exception_check_and_throw(env, E_FILE_LINE);
+            return;
+        }
         jbyteArray jvalue = env->NewByteArray((jsize)value_size);
         env->SetByteArrayRegion(jvalue, 0, (jsize)value_size, (const jbyte *)charValue->get_ptr());
         java_exception_check_and_throw(env, E_FILE_LINE);
@@ -134,6 +247,38 @@ class JNICharacteristicListener : public GATTCharacteristicListener {
         env->CallVoidMethod(listenerObj.getObject(), mIndicationReceived,
                             jCharDecl, jvalue, (jlong)timestamp, (jboolean)confirmationSent);
         java_exception_check_and_throw(env, E_FILE_LINE);
+        env->DeleteLocalRef(jvalue);
+    }
+
+  public:
+
+    // Upcalls are passed to DirectBTJNIDispatcher if enabled, keeping this listener alive until delivered.
+
+    void notificationReceived(GATTCharacteristicRef charDecl,
+                              std::shared_ptr<TROOctets> charValue, const uint64_t timestamp) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNICharacteristicListener> self = shared_from_this();
+            dispatcher.dispatch(this, [self, charDecl, charValue, timestamp]() {
+                self->notificationReceivedImpl(charDecl, charValue, timestamp);
+            });
+        } else {
+            notificationReceivedImpl(charDecl, charValue, timestamp);
+        }
+    }
+
+    void indicationReceived(GATTCharacteristicRef charDecl,
+                            std::shared_ptr<TROOctets> charValue, const uint64_t timestamp,
+                            const bool confirmationSent) override {
+        DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        if( dispatcher.isEnabled() ) {
+            std::shared_ptr<JNICharacteristicListener> self = shared_from_this();
+            dispatcher.dispatch(this, [self, charDecl, charValue, timestamp, confirmationSent]() {
+                self->indicationReceivedImpl(charDecl, charValue, timestamp, confirmationSent);
+            });
+        } else {
+            indicationReceivedImpl(charDecl, charValue, timestamp, confirmationSent);
+        }
     }
 };
 
@@ -391,8 +536,7 @@ jobject Java_direct_1bt_tinyb_DBTDevice_getServicesImpl(JNIEnv *env, jobject obj
                     jobject jdevice = JavaGlobalObj::GetObject(device->getJavaObject());
                     const jboolean isPrimary = service->isPrimary;
                     const jstring uuid = from_string_to_jstring(env,
-                            directBTJNISettings.getUnifyUUID128Bit() ? service->type->toUUID128String() :
-                                                                       service->type->toString());
+                            service->getTypeString(directBTJNISettings.getUnifyUUID128Bit()));
                     java_exception_check_and_throw(env, E_FILE_LINE);
 
                     jobject jservice = env->NewObject(clazz, clazz_ctor, (jlong)service, jdevice, isPrimary,
@@ -401,6 +545,9 @@ jobject Java_direct_1bt_tinyb_DBTDevice_getServicesImpl(JNIEnv *env, jobject obj
                     JNIGlobalRef::check(jservice, E_FILE_LINE);
                     std::shared_ptr<JavaAnonObj> jServiceRef = service->getJavaObject();
                     JavaGlobalObj::check(jServiceRef, E_FILE_LINE);
+                    // the global reference holds the Java peer, release the per service local references
+                    env->DeleteLocalRef(jservice);
+                    env->DeleteLocalRef(uuid);
 
                     return JavaGlobalObj::GetObject(jServiceRef);
                 };
@@ -546,6 +693,97 @@ jobject Java_direct_1bt_tinyb_DBTDevice_getManufacturerData(JNIEnv *env, jobject
     return nullptr;
 }
 
+jlongArray Java_direct_1bt_tinyb_DBTDevice_getTrafficStatistics(JNIEnv *env, jobject obj, jboolean link)
+{
+    try {
+        DBTDevice *device = getDBTObject<DBTDevice>(env, obj);
+        JavaGlobalObj::check(device->getJavaObject(), E_FILE_LINE);
+        TrafficSnapshot ts;
+        if( !device->getTrafficSnapshot(ts, JNI_TRUE == link) ) {
+            return nullptr;
+        }
+        std::vector<jlong> stats = { (jlong)ts.startTime, (jlong)ts.timestamp,
+                                     (jlong)ts.pdusIn, (jlong)ts.bytesIn, (jlong)ts.pdusOut, (jlong)ts.bytesOut,
+                                     (jlong)ts.notifications, (jlong)ts.retries, (jlong)ts.timeouts,
+                                     (jlong)ts.rttSamples, (jlong)ts.rttSum };
+        for(size_t i=0; i<ts.opcodes.size(); i++) {
+            const TrafficSnapshot::OpcodeCount & o = ts.opcodes[i];
+            stats.push_back((jlong)o.opcode);
+            stats.push_back((jlong)o.pdusIn);
+            stats.push_back((jlong)o.bytesIn);
+            stats.push_back((jlong)o.pdusOut);
+            stats.push_back((jlong)o.bytesOut);
+        }
+        const jsize count = (jsize)stats.size();
+        jlongArray res = env->NewLongArray(count);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        env->SetLongArrayRegion(res, 0, count, stats.data());
+        return res;
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+    return nullptr;
+}
+
+jint Java_direct_1bt_tinyb_DBTDevice_getAdvertisedSnapshotImpl(JNIEnv *env, jobject obj, jobject jbuffer, jint offset)
+{
+    try {
+        DBTDevice *device = getDBTObject<DBTDevice>(env, obj);
+        JavaGlobalObj::check(device->getJavaObject(), E_FILE_LINE);
+        if( nullptr == jbuffer ) {
+            throw IllegalArgumentException("buffer argument is null", E_FILE_LINE);
+        }
+        uint8_t * buffer = (uint8_t *) env->GetDirectBufferAddress(jbuffer);
+        const jlong capacity = env->GetDirectBufferCapacity(jbuffer);
+        if( nullptr == buffer || 0 > offset || offset > capacity ) {
+            throw IllegalArgumentException("buffer not direct or offset "+std::to_string(offset)+" out of bounds", E_FILE_LINE);
+        }
+        // Immutable copy-on-write snapshot, no mtx_data locking
+        std::shared_ptr<const DBTDevice::AdvertisedData> ad = device->getAdvertisedData();
+        const size_t name_size = std::min<size_t>(ad->name->size(), 0xffff);
+        const size_t msd_size = nullptr != ad->msd ? std::min<size_t>(ad->msd->data.getSize(), 0xffff) : 0;
+        const size_t services_count = std::min<size_t>(ad->services.size(), 0xffff);
+        const size_t size = 32 + name_size + msd_size + services_count * 17;
+        if( size > static_cast<size_t>( capacity - offset ) ) {
+            return -(jint)size;
+        }
+        uint8_t * p = buffer + offset;
+        const uint64_t ts_discovery = device->getLastDiscoveryTimestamp();
+        const uint64_t ts_update = device->getLastUpdateTimestamp();
+        put_uint32(p,  0, (uint32_t)ts_discovery, true /* littleEndian */);
+        put_uint32(p,  4, (uint32_t)(ts_discovery >> 32), true /* littleEndian */);
+        put_uint32(p,  8, (uint32_t)ts_update, true /* littleEndian */);
+        put_uint32(p, 12, (uint32_t)(ts_update >> 32), true /* littleEndian */);
+        put_uint8(p, 16, (uint8_t)ad->rssi);
+        put_uint8(p, 17, (uint8_t)ad->rssi_smoothed);
+        put_uint8(p, 18, (uint8_t)ad->tx_power);
+        put_uint8(p, 19, nullptr != ad->msd ? 1 : 0);
+        put_uint16(p, 20, static_cast<uint16_t>(ad->appearance), true /* littleEndian */);
+        put_uint16(p, 22, nullptr != ad->msd ? ad->msd->company : 0, true /* littleEndian */);
+        put_uint16(p, 24, (uint16_t)name_size, true /* littleEndian */);
+        put_uint16(p, 26, (uint16_t)msd_size, true /* littleEndian */);
+        put_uint16(p, 28, (uint16_t)services_count, true /* littleEndian */);
+        put_uint16(p, 30, 0, true /* littleEndian */); // reserved
+        size_t i = 32;
+        memcpy(p + i, ad->name->data(), name_size);
+        i += name_size;
+        if( 0 < msd_size ) {
+            memcpy(p + i, ad->msd->data.get_ptr(), msd_size);
+            i += msd_size;
+        }
+        for(size_t j=0; j<services_count; j++, i+=17) {
+            const uuid_value_t & u = ad->services[j];
+            p[i] = static_cast<uint8_t>(u.getTypeSize());
+            memset(p + i + 1, 0, 16);
+            memcpy(p + i + 1, u.data(), u.getTypeSize());
+        }
+        return (jint)size;
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+    return 0;
+}
+
 jshort Java_direct_1bt_tinyb_DBTDevice_getTxPower(JNIEnv *env, jobject obj)
 {
     try {
@@ -591,10 +829,10 @@ typedef std::shared_ptr<BooleanDeviceCBContext> BooleanDeviceCBContextRef;
 
 static void disableBlockedNotifications(JNIEnv *env, jobject obj, DBTManager &mgmt)
 {
-    InvocationFunc<bool, std::shared_ptr<MgmtEvent>> * funcptr =
-            getObjectRef<InvocationFunc<bool, std::shared_ptr<MgmtEvent>>>(env, obj, "blockedNotificationRef");
+    InvocationFunc<bool, const MgmtEvent&> * funcptr =
+            getObjectRef<InvocationFunc<bool, const MgmtEvent&>>(env, obj, "blockedNotificationRef");
     if( nullptr != funcptr ) {
-        FunctionDef<bool, std::shared_ptr<MgmtEvent>> funcDef( funcptr );
+        FunctionDef<bool, const MgmtEvent&> funcDef( funcptr );
         funcptr = nullptr;
         setObjectRef(env, obj, funcptr, "blockedNotificationRef"); // clear java ref
         int count;
@@ -628,17 +866,17 @@ void Java_direct_1bt_tinyb_DBTDevice_enableBlockedNotificationsImpl(JNIEnv *env,
 
         disableBlockedNotifications(env, obj, mgmt);
 
-        bool(*nativeCallback)(BooleanDeviceCBContextRef&, std::shared_ptr<MgmtEvent>) =
-                [](BooleanDeviceCBContextRef& ctx_ref, std::shared_ptr<MgmtEvent> e)->bool {
+        bool(*nativeCallback)(BooleanDeviceCBContextRef&, const MgmtEvent&) =
+                [](BooleanDeviceCBContextRef& ctx_ref, const MgmtEvent& e)->bool {
             bool isBlocked = false;
-            if( MgmtEvent::Opcode::DEVICE_BLOCKED == e->getOpcode() ) {
-                const MgmtEvtDeviceBlocked &event = *static_cast<const MgmtEvtDeviceBlocked *>(e.get());
+            if( MgmtEvent::Opcode::DEVICE_BLOCKED == e.getOpcode() ) {
+                const MgmtEvtDeviceBlocked &event = static_cast<const MgmtEvtDeviceBlocked &>(e);
                 if( event.getAddress() != ctx_ref->deviceAddress ) {
                     return false; // not this device
                 }
                 isBlocked = true;
-            } else if( MgmtEvent::Opcode::DEVICE_UNBLOCKED == e->getOpcode() ) {
-                const MgmtEvtDeviceUnblocked &event = *static_cast<const MgmtEvtDeviceUnblocked *>(e.get());
+            } else if( MgmtEvent::Opcode::DEVICE_UNBLOCKED == e.getOpcode() ) {
+                const MgmtEvtDeviceUnblocked &event = static_cast<const MgmtEvtDeviceUnblocked &>(e);
                 if( event.getAddress() != ctx_ref->deviceAddress ) {
                     return false; // not this device
                 }
@@ -666,7 +904,7 @@ void Java_direct_1bt_tinyb_DBTDevice_enableBlockedNotificationsImpl(JNIEnv *env,
         jni_env->DeleteLocalRef(boolean_cls);
 
         // move BooleanDeviceCBContextRef into CaptureInvocationFunc and operator== includes javaCallback comparison
-        FunctionDef<bool, std::shared_ptr<MgmtEvent>> funcDef = bindCaptureFunc(BooleanDeviceCBContextRef(ctx), nativeCallback);
+        FunctionDef<bool, const MgmtEvent&> funcDef = bindCaptureFunc(BooleanDeviceCBContextRef(ctx), nativeCallback);
         setObjectRef(env, obj, funcDef.cloneFunction(), "blockedNotificationRef"); // set java ref
         mgmt.addMgmtEventCallback(adapter.dev_id, MgmtEvent::Opcode::DEVICE_BLOCKED, funcDef);
         mgmt.addMgmtEventCallback(adapter.dev_id, MgmtEvent::Opcode::DEVICE_UNBLOCKED, funcDef);
@@ -681,10 +919,10 @@ void Java_direct_1bt_tinyb_DBTDevice_enableBlockedNotificationsImpl(JNIEnv *env,
 
 static void disablePairedNotifications(JNIEnv *env, jobject obj, DBTManager &mgmt)
 {
-    InvocationFunc<bool, std::shared_ptr<MgmtEvent>> * funcptr =
-            getObjectRef<InvocationFunc<bool, std::shared_ptr<MgmtEvent>>>(env, obj, "pairedNotificationRef");
+    InvocationFunc<bool, const MgmtEvent&> * funcptr =
+            getObjectRef<InvocationFunc<bool, const MgmtEvent&>>(env, obj, "pairedNotificationRef");
     if( nullptr != funcptr ) {
-        FunctionDef<bool, std::shared_ptr<MgmtEvent>> funcDef( funcptr );
+        FunctionDef<bool, const MgmtEvent&> funcDef( funcptr );
         funcptr = nullptr;
         setObjectRef(env, obj, funcptr, "pairedNotificationRef"); // clear java ref
         int count;
@@ -715,9 +953,9 @@ void Java_direct_1bt_tinyb_DBTDevice_enablePairedNotificationsImpl(JNIEnv *env,
 
         disablePairedNotifications(env, obj, mgmt);
 
-        bool(*nativeCallback)(BooleanDeviceCBContextRef&, std::shared_ptr<MgmtEvent>) =
-                [](BooleanDeviceCBContextRef& ctx_ref, std::shared_ptr<MgmtEvent> e)->bool {
-            const MgmtEvtDeviceUnpaired &event = *static_cast<const MgmtEvtDeviceUnpaired *>(e.get());
+        bool(*nativeCallback)(BooleanDeviceCBContextRef&, const MgmtEvent&) =
+                [](BooleanDeviceCBContextRef& ctx_ref, const MgmtEvent& e)->bool {
+            const MgmtEvtDeviceUnpaired &event = static_cast<const MgmtEvtDeviceUnpaired &>(e);
             if( event.getAddress() != ctx_ref->deviceAddress ) {
                 return false; // not this device
             }
@@ -740,7 +978,7 @@ void Java_direct_1bt_tinyb_DBTDevice_enablePairedNotificationsImpl(JNIEnv *env,
         jni_env->DeleteLocalRef(boolean_cls);
 
         // move BooleanDeviceCBContextRef into CaptureInvocationFunc and operator== includes javaCallback comparison
-        FunctionDef<bool, std::shared_ptr<MgmtEvent>> funcDef = bindCaptureFunc(BooleanDeviceCBContextRef(ctx), nativeCallback);
+        FunctionDef<bool, const MgmtEvent&> funcDef = bindCaptureFunc(BooleanDeviceCBContextRef(ctx), nativeCallback);
         setObjectRef(env, obj, funcDef.cloneFunction(), "pairedNotificationRef"); // set java ref
         // FIXME: Figure out paired:=true, as currently we only attach to unpaired
         mgmt.addMgmtEventCallback(adapter.dev_id, MgmtEvent::Opcode::DEVICE_UNPAIRED, funcDef);
@@ -82,8 +82,7 @@ jobject Java_direct_1bt_tinyb_DBTGattCharacteristic_getDescriptorsImpl(JNIEnv *e
                     jobject jcharacteristic = JavaGlobalObj::GetObject(characteristic->getJavaObject());
 
                     const jstring uuid = from_string_to_jstring(env,
-                            directBTJNISettings.getUnifyUUID128Bit() ? descriptor->type->toUUID128String() :
-                                                                       descriptor->type->toString());
+                            descriptor->getTypeString(directBTJNISettings.getUnifyUUID128Bit()));
                     java_exception_check_and_throw(env, E_FILE_LINE);
 
                     const size_t value_size = descriptor->value.getSize();
@@ -97,6 +96,10 @@ jobject Java_direct_1bt_tinyb_DBTGattCharacteristic_getDescriptorsImpl(JNIEnv *e
                     JNIGlobalRef::check(jchar, E_FILE_LINE);
                     std::shared_ptr<JavaAnonObj> jCharRef = descriptor->getJavaObject();
                     JavaGlobalObj::check(jCharRef, E_FILE_LINE);
+                    // the global reference holds the Java peer, release the per descriptor local references
+                    env->DeleteLocalRef(jchar);
+                    env->DeleteLocalRef(uuid);
+                    env->DeleteLocalRef(jvalue);
 
                     return JavaGlobalObj::GetObject(jCharRef);
                 };
@@ -112,9 +115,14 @@ jbyteArray Java_direct_1bt_tinyb_DBTGattCharacteristic_readValueImpl(JNIEnv *env
         GATTCharacteristic *characteristic = getDBTObject<GATTCharacteristic>(env, obj);
         JavaGlobalObj::check(characteristic->getJavaObject(), E_FILE_LINE);
 
+        // Routine failures are raised w/o a native exception
         POctets res(GATTHandler::number(GATTHandler::Defaults::MAX_ATT_MTU), 0);
-        if( !characteristic->readValue(res) ) {
-            ERR_PRINT("Characteristic readValue failed: %s", characteristic->toString().c_str());
+        const GATTStatus status = characteristic->readValueStatus(res);
+        if( GATTStatus::SUCCESS != status ) {
+            if( raise_java_gatt_exception(env, status, "Characteristic readValue failed: "+characteristic->toString()) ) {
+                return nullptr;
+            }
+            ERR_PRINT("Characteristic readValue failed: %s: %s", getGATTStatusString(status).c_str(), characteristic->toString().c_str());
             return env->NewByteArray((jsize)0);
         }
 
@@ -142,21 +150,53 @@ jboolean Java_direct_1bt_tinyb_DBTGattCharacteristic_writeValueImpl(JNIEnv *env,
         GATTCharacteristic *characteristic = getDBTObject<GATTCharacteristic>(env, obj);
         JavaGlobalObj::check(characteristic->getJavaObject(), E_FILE_LINE);
 
-        JNICriticalArray<uint8_t, jbyteArray> criticalArray(env); // RAII - release
-        uint8_t * value_ptr = criticalArray.get(jvalue, criticalArray.Mode::NO_UPDATE_AND_RELEASE);
-        if( NULL == value_ptr ) {
-            throw InternalError("GetPrimitiveArrayCritical(byte array) is null", E_FILE_LINE);
-        }
-        TROOctets value(value_ptr, value_size);
-        bool res;
-        if( withResponse ) {
-            res = characteristic->writeValue(value);
-        } else {
-            res = characteristic->writeValueNoResp(value);
-        }
-        if( !res ) {
-            ERR_PRINT("Characteristic writeValue(withResponse %d) failed: %s",
-                    withResponse, characteristic->toString().c_str());
+        // Copies the array region once, directly into the ATT PDU, w/o holding a critical region during the write
+        const GATTStatus status = characteristic->writeValueStatus(value_size, [env, jvalue](uint8_t * dest, const int size) -> bool {
+            env->GetByteArrayRegion(jvalue, 0, (jsize)size, (jbyte *)dest);
+            return JNI_FALSE == env->ExceptionCheck();
+        }, JNI_TRUE == withResponse);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        if( GATTStatus::SUCCESS != status ) {
+            if( raise_java_gatt_exception(env, status, "Characteristic writeValue failed: "+characteristic->toString()) ) {
+                return JNI_FALSE;
+            }
+            ERR_PRINT("Characteristic writeValue(withResponse %d) failed: %s: %s",
+                    withResponse, getGATTStatusString(status).c_str(), characteristic->toString().c_str());
+            return JNI_FALSE;
+        }
+        return JNI_TRUE;
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+    return JNI_FALSE;
+}
+
+jboolean Java_direct_1bt_tinyb_DBTGattCharacteristic_writeValueDirectImpl(JNIEnv *env, jobject obj, jobject jbuffer, jint offset, jint length, jboolean withResponse) {
+    try {
+        if( nullptr == jbuffer ) {
+            throw IllegalArgumentException("buffer argument is null", E_FILE_LINE);
+        }
+        const uint8_t * buffer = (const uint8_t *) env->GetDirectBufferAddress(jbuffer);
+        const jlong capacity = env->GetDirectBufferCapacity(jbuffer);
+        if( nullptr == buffer || 0 > offset || 0 > length || offset + (jlong)length > capacity ) {
+            throw IllegalArgumentException("buffer not direct or range ["+std::to_string(offset)+", "+std::to_string(length)+
+                                           "] out of bounds "+std::to_string(capacity), E_FILE_LINE);
+        }
+        if( 0 == length ) {
+            return JNI_TRUE;
+        }
+        GATTCharacteristic *characteristic = getDBTObject<GATTCharacteristic>(env, obj);
+        JavaGlobalObj::check(characteristic->getJavaObject(), E_FILE_LINE);
+
+        // Native memory of the direct buffer is passed through, only copied into the ATT PDU
+        const TROOctets value(buffer + offset, length);
+        const GATTStatus status = characteristic->writeValueStatus(value, JNI_TRUE == withResponse);
+        if( GATTStatus::SUCCESS != status ) {
+            if( raise_java_gatt_exception(env, status, "Characteristic writeValue failed: "+characteristic->toString()) ) {
+                return JNI_FALSE;
+            }
+            ERR_PRINT("Characteristic writeValue(direct, withResponse %d) failed: %s: %s",
+                    withResponse, getGATTStatusString(status).c_str(), characteristic->toString().c_str());
             return JNI_FALSE;
         }
         return JNI_TRUE;
@@ -166,6 +206,110 @@ jboolean Java_direct_1bt_tinyb_DBTGattCharacteristic_writeValueImpl(JNIEnv *env,
     return JNI_FALSE;
 }
 
+/**
+ * Completes the given CompletableFuture with the given value,
+ * or exceptionally with a BluetoothException of the given message if the value is nullptr.
+ * <p>
+ * Invoked on the GATTHandler's async worker thread, hence any pending Java exception is only logged.
+ * </p>
+ */
+static void completeFuture(JNIEnv *env, const DirectBTJNICache & ids, jobject future, jobject value, const std::string & failureMsg) {
+    if( nullptr != value ) {
+        env->CallBooleanMethod(future, ids.futureComplete, value);
+    } else {
+        jstring jmsg = from_string_to_jstring(env, failureMsg);
+        jobject jex = env->NewObject(ids.bluetoothExceptionClazz.getClass(), ids.bluetoothExceptionCtor, jmsg);
+        env->CallBooleanMethod(future, ids.futureCompleteExceptionally, jex);
+        env->DeleteLocalRef(jex);
+        env->DeleteLocalRef(jmsg);
+    }
+    if( env->ExceptionCheck() ) {
+        ERR_PRINT("DBTGattCharacteristic::completeFuture: Java exception caught");
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+}
+
+static std::shared_ptr<GATTHandler> getGATTHandlerForAsync(GATTCharacteristic *characteristic) {
+    std::shared_ptr<DBTDevice> device = characteristic->getDeviceUnchecked();
+    return nullptr != device ? device->getGATTHandler() : nullptr;
+}
+
+void Java_direct_1bt_tinyb_DBTGattCharacteristic_readValueAsyncImpl(JNIEnv *env, jobject obj, jobject jfuture) {
+    try {
+        GATTCharacteristic *characteristic = getDBTObject<GATTCharacteristic>(env, obj);
+        JavaGlobalObj::check(characteristic->getJavaObject(), E_FILE_LINE);
+        if( nullptr == jfuture ) {
+            throw IllegalArgumentException("future null", E_FILE_LINE);
+        }
+        const DirectBTJNICache & ids = DirectBTJNICache::get(env);
+        const std::string charString = characteristic->toString();
+        std::shared_ptr<GATTHandler> gatt = getGATTHandlerForAsync(characteristic);
+        if( nullptr == gatt ) {
+            completeFuture(env, ids, jfuture, nullptr, "Characteristic's device GATTHandle not connected: "+charString);
+            return;
+        }
+        JNIGlobalRef futureRef(jfuture);
+        gatt->readValueAsync(characteristic->value_handle, -1, [&ids, futureRef, charString](std::shared_ptr<POctets> value) {
+            JNIEnv *env = *jni_env;
+            jbyteArray jvalue = nullptr;
+            if( nullptr != value ) {
+                const size_t value_size = value->getSize();
+                jvalue = env->NewByteArray((jsize)value_size);
+                env->SetByteArrayRegion(jvalue, 0, (jsize)value_size, (const jbyte *)value->get_ptr());
+            }
+            completeFuture(env, ids, futureRef.getObject(), jvalue, "Characteristic readValue failed: "+charString);
+            if( nullptr != jvalue ) {
+                env->DeleteLocalRef(jvalue);
+            }
+        });
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+}
+
+void Java_direct_1bt_tinyb_DBTGattCharacteristic_writeValueAsyncImpl(JNIEnv *env, jobject obj, jbyteArray jvalue, jboolean withResponse, jobject jfuture) {
+    try {
+        if( nullptr == jvalue ) {
+            throw IllegalArgumentException("byte array null", E_FILE_LINE);
+        }
+        if( nullptr == jfuture ) {
+            throw IllegalArgumentException("future null", E_FILE_LINE);
+        }
+        GATTCharacteristic *characteristic = getDBTObject<GATTCharacteristic>(env, obj);
+        JavaGlobalObj::check(characteristic->getJavaObject(), E_FILE_LINE);
+        const DirectBTJNICache & ids = DirectBTJNICache::get(env);
+        const std::string charString = characteristic->toString();
+        std::shared_ptr<GATTHandler> gatt = getGATTHandlerForAsync(characteristic);
+        if( nullptr == gatt ) {
+            completeFuture(env, ids, jfuture, nullptr, "Characteristic's device GATTHandle not connected: "+charString);
+            return;
+        }
+        const int value_size = env->GetArrayLength(jvalue);
+        if( 0 == value_size ) {
+            jobject jres = env->CallStaticObjectMethod(ids.booleanClazz.getClass(), ids.booleanValueOf, JNI_TRUE);
+            completeFuture(env, ids, jfuture, jres, "");
+            env->DeleteLocalRef(jres);
+            return;
+        }
+        POctets value(value_size, value_size);
+        env->GetByteArrayRegion(jvalue, 0, value_size, (jbyte *)value.get_wptr());
+        java_exception_check_and_throw(env, E_FILE_LINE);
+
+        JNIGlobalRef futureRef(jfuture);
+        gatt->writeValueAsync(characteristic->value_handle, value, JNI_TRUE == withResponse, [&ids, futureRef, charString](bool success) {
+            JNIEnv *env = *jni_env;
+            jobject jres = success ? env->CallStaticObjectMethod(ids.booleanClazz.getClass(), ids.booleanValueOf, JNI_TRUE) : nullptr;
+            completeFuture(env, ids, futureRef.getObject(), jres, "Characteristic writeValue failed: "+charString);
+            if( nullptr != jres ) {
+                env->DeleteLocalRef(jres);
+            }
+        });
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+}
+
 jboolean Java_direct_1bt_tinyb_DBTGattCharacteristic_configNotificationIndicationImpl(JNIEnv *env, jobject obj,
                         jboolean enableNotification, jboolean enableIndication, jbooleanArray jEnabledState) {
     try {
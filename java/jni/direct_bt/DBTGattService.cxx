@@ -92,6 +92,7 @@ jobject Java_direct_1bt_tinyb_DBTGattService_getCharacteristicsImpl(JNIEnv *env,
                     for (unsigned int i = 0; i < props_size; ++i) {
                         jobject elem = from_string_to_jstring(env, *props[i].get());
                         env->SetObjectArrayElement(jproperties, i, elem);
+                        env->DeleteLocalRef(elem);
                     }
                     java_exception_check_and_throw(env, E_FILE_LINE);
 
@@ -99,8 +100,7 @@ jobject Java_direct_1bt_tinyb_DBTGattService_getCharacteristicsImpl(JNIEnv *env,
                     const bool hasIndicate = characteristic->hasProperties(GATTCharacteristic::PropertyBitVal::Indicate);
 
                     const jstring uuid = from_string_to_jstring(env,
-                            directBTJNISettings.getUnifyUUID128Bit() ? characteristic->value_type->toUUID128String() :
-                                                                       characteristic->value_type->toString());
+                            characteristic->getValueTypeString(directBTJNISettings.getUnifyUUID128Bit()));
                     java_exception_check_and_throw(env, E_FILE_LINE);
 
                     jobject jchar = env->NewObject(clazz, clazz_ctor, (jlong)characteristic, jservice,
@@ -110,6 +110,10 @@ jobject Java_direct_1bt_tinyb_DBTGattService_getCharacteristicsImpl(JNIEnv *env,
                     JNIGlobalRef::check(jchar, E_FILE_LINE);
                     std::shared_ptr<JavaAnonObj> jCharRef = characteristic->getJavaObject();
                     JavaGlobalObj::check(jCharRef, E_FILE_LINE);
+                    // the global reference holds the Java peer, release the per characteristic local references
+                    env->DeleteLocalRef(jchar);
+                    env->DeleteLocalRef(uuid);
+                    env->DeleteLocalRef(jproperties);
 
                     return JavaGlobalObj::GetObject(jCharRef);
                 };
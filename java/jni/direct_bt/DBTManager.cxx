@@ -54,6 +54,26 @@ void Java_direct_1bt_tinyb_DBTManager_initImpl(JNIEnv *env, jobject obj, jboolea
     }
 }
 
+jlongArray Java_direct_1bt_tinyb_DBTManager_getCallbackDispatchStatistics(JNIEnv *env, jclass clazz)
+{
+    (void)clazz;
+    try {
+        const DirectBTJNIDispatcher & dispatcher = DirectBTJNIDispatcher::get();
+        const jlong stats[] = { dispatcher.THREAD_COUNT, dispatcher.QUEUE_CAPACITY,
+                                (jlong)dispatcher.getQueueDepth(), (jlong)dispatcher.getQueueDepthMax(),
+                                (jlong)dispatcher.getDispatchCount(), (jlong)dispatcher.getStallCount(),
+                                (jlong)dispatcher.getLatencyMeanUS(), (jlong)dispatcher.getLatencyMaxUS() };
+        const jsize count = sizeof(stats) / sizeof(jlong);
+        jlongArray res = env->NewLongArray(count);
+        java_exception_check_and_throw(env, E_FILE_LINE);
+        env->SetLongArrayRegion(res, 0, count, stats);
+        return res;
+    } catch(...) {
+        rethrow_and_raise_java_exception(env);
+    }
+    return nullptr;
+}
+
 void Java_direct_1bt_tinyb_DBTManager_deleteImpl(JNIEnv *env, jobject obj, jlong nativeInstance)
 {
     (void)obj;
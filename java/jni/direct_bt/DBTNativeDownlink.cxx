@@ -40,16 +40,7 @@ void Java_direct_1bt_tinyb_DBTNativeDownlink_initNativeJavaObject(JNIEnv *env, j
 {
     try {
         JavaUplink *javaUplink = castInstance<JavaUplink>(nativeInstance);
-        jclass javaClazz = search_class(env, obj);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == javaClazz ) {
-            throw InternalError("DBTNativeDownlink class not found", E_FILE_LINE);
-        }
-        jmethodID  mNotifyDeleted = search_method(env, javaClazz, "notifyDeleted", "()V", false);
-        java_exception_check_and_throw(env, E_FILE_LINE);
-        if( nullptr == mNotifyDeleted ) {
-            throw InternalError("DBTNativeDownlink class has no notifyDeleted() method, for "+javaUplink->toString(), E_FILE_LINE);
-        }
+        jmethodID  mNotifyDeleted = DirectBTJNICache::get(env).nativeDownlinkNotifyDeleted;
         std::shared_ptr<JavaGlobalObj> jobjRef( new JavaGlobalObj(obj, mNotifyDeleted) );
         javaUplink->setJavaObject( jobjRef );
         JavaGlobalObj::check(javaUplink->getJavaObject(), E_FILE_LINE);
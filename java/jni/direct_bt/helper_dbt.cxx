@@ -30,10 +30,181 @@
 
 #include "helper_dbt.hpp"
 
+// #define VERBOSE_ON 1
+#include <dbt_debug.hpp>
+
+#include "direct_bt/DBTEnv.hpp"
+
 using namespace direct_bt;
 
 DirectBTJNISettings direct_bt::directBTJNISettings;
 
+std::atomic<bool> DirectBTJNICache::initialized(false);
+std::mutex DirectBTJNICache::mtx_init;
+
+static const bool directBTJNICacheRegistered = registerJNIOnLoadCallback(DirectBTJNICache::onLoad);
+
+static JNIGlobalRef findGlobalClass(JNIEnv *env, const char *clazz_name) {
+    jclass clazz = search_class(env, clazz_name);
+    JNIGlobalRef res(clazz);
+    env->DeleteLocalRef(clazz);
+    return res;
+}
+
+void DirectBTJNICache::init(JNIEnv *env) {
+    adapterSettingsClazz = findGlobalClass(env, "org/tinyb/AdapterSettings");
+    adapterSettingsCtor = search_method(env, adapterSettingsClazz.getClass(), "<init>", "(I)V", false);
+    eirDataTypeSetClazz = findGlobalClass(env, "org/tinyb/EIRDataTypeSet");
+    eirDataTypeSetCtor = search_method(env, eirDataTypeSetClazz.getClass(), "<init>", "(I)V", false);
+    hciStatusCodeClazz = findGlobalClass(env, "org/tinyb/HCIStatusCode");
+    hciStatusCodeGet = search_method(env, hciStatusCodeClazz.getClass(), "get", "(B)Lorg/tinyb/HCIStatusCode;", true);
+
+    deviceClazz = findGlobalClass(env, "direct_bt/tinyb/DBTDevice");
+    deviceArrayClazz = findGlobalClass(env, "[Ldirect_bt/tinyb/DBTDevice;");
+    deviceCtor = search_method(env, deviceClazz.getClass(), "<init>", "(JLdirect_bt/tinyb/DBTAdapter;Ljava/lang/String;IILjava/lang/String;J)V", false);
+    deviceTSLastDiscoveryField = search_field(env, deviceClazz.getClass(), "ts_last_discovery", "J", false);
+    deviceTSLastUpdateField = search_field(env, deviceClazz.getClass(), "ts_last_update", "J", false);
+    deviceConnectionHandleField = search_field(env, deviceClazz.getClass(), "hciConnHandle", "S", false);
+    {
+        JNIGlobalRef nativeDownlinkClazz = findGlobalClass(env, "direct_bt/tinyb/DBTNativeDownlink");
+        nativeDownlinkNotifyDeleted = search_method(env, nativeDownlinkClazz.getClass(), "notifyDeleted", "()V", false);
+    }
+
+    adapterStatusListenerClazz = findGlobalClass(env, "org/tinyb/AdapterStatusListener");
+    jclass c = adapterStatusListenerClazz.getClass();
+    adapterSettingsChanged = search_method(env, c, "adapterSettingsChanged", "(Lorg/tinyb/BluetoothAdapter;Lorg/tinyb/AdapterSettings;Lorg/tinyb/AdapterSettings;Lorg/tinyb/AdapterSettings;J)V", false);
+    discoveringChanged = search_method(env, c, "discoveringChanged", "(Lorg/tinyb/BluetoothAdapter;ZZJ)V", false);
+    deviceFound = search_method(env, c, "deviceFound", "(Lorg/tinyb/BluetoothDevice;J)V", false);
+    deviceUpdated = search_method(env, c, "deviceUpdated", "(Lorg/tinyb/BluetoothDevice;Lorg/tinyb/EIRDataTypeSet;J)V", false);
+    deviceConnected = search_method(env, c, "deviceConnected", "(Lorg/tinyb/BluetoothDevice;SJ)V", false);
+    deviceDisconnected = search_method(env, c, "deviceDisconnected", "(Lorg/tinyb/BluetoothDevice;Lorg/tinyb/HCIStatusCode;SJ)V", false);
+
+    adapterStatusBatchListenerClazz = findGlobalClass(env, "org/tinyb/AdapterStatusBatchListener");
+    c = adapterStatusBatchListenerClazz.getClass();
+    batchSizeField = search_field(env, c, "batchSize", "I", false);
+    batchDelayField = search_field(env, c, "batchDelay", "I", false);
+    batchDevicesField = search_field(env, c, "devices", "[Lorg/tinyb/BluetoothDevice;", false);
+    batchUpdateMasksField = search_field(env, c, "updateMasks", "[I", false);
+    batchTimestampsField = search_field(env, c, "timestamps", "[J", false);
+    batchRSSIField = search_field(env, c, "rssi", "[B", false);
+    devicesDiscovered = search_method(env, c, "devicesDiscovered", "([Lorg/tinyb/BluetoothDevice;[I[J[BI)V", false);
+
+    characteristicListenerClazz = findGlobalClass(env, "org/tinyb/GATTCharacteristicListener");
+    c = characteristicListenerClazz.getClass();
+    notificationReceived = search_method(env, c, "notificationReceived", "(Lorg/tinyb/BluetoothGattCharacteristic;[BJ)V", false);
+    indicationReceived = search_method(env, c, "indicationReceived", "(Lorg/tinyb/BluetoothGattCharacteristic;[BJZ)V", false);
+
+    characteristicBufferListenerClazz = findGlobalClass(env, "org/tinyb/GATTCharacteristicBufferListener");
+    c = characteristicBufferListenerClazz.getClass();
+    bufferField = search_field(env, c, "buffer", "Ljava/nio/ByteBuffer;", false);
+    notificationReceivedBuffer = search_method(env, c, "notificationReceived", "(Lorg/tinyb/BluetoothGattCharacteristic;Ljava/nio/ByteBuffer;IIJ)V", false);
+    indicationReceivedBuffer = search_method(env, c, "indicationReceived", "(Lorg/tinyb/BluetoothGattCharacteristic;Ljava/nio/ByteBuffer;IIJZ)V", false);
+
+    completableFutureClazz = findGlobalClass(env, "java/util/concurrent/CompletableFuture");
+    futureComplete = search_method(env, completableFutureClazz.getClass(), "complete", "(Ljava/lang/Object;)Z", false);
+    futureCompleteExceptionally = search_method(env, completableFutureClazz.getClass(), "completeExceptionally", "(Ljava/lang/Throwable;)Z", false);
+    booleanClazz = findGlobalClass(env, "java/lang/Boolean");
+    booleanValueOf = search_method(env, booleanClazz.getClass(), "valueOf", "(Z)Ljava/lang/Boolean;", true);
+    bluetoothExceptionClazz = findGlobalClass(env, "org/tinyb/BluetoothException");
+    bluetoothExceptionCtor = search_method(env, bluetoothExceptionClazz.getClass(), "<init>", "(Ljava/lang/String;)V", false);
+}
+
+void DirectBTJNICache::onLoad(JNIEnv *env) {
+    get(env);
+}
+
+DirectBTJNICache & DirectBTJNICache::get(JNIEnv *env) {
+    static DirectBTJNICache * instance = new DirectBTJNICache();
+    if( !initialized ) {
+        const std::lock_guard<std::mutex> lock(mtx_init); // RAII-style acquire and relinquish via destructor
+        if( !initialized ) {
+            instance->init(env);
+            initialized = true;
+        }
+    }
+    return *instance;
+}
+
+DirectBTJNIDispatcher::DirectBTJNIDispatcher()
+: dispatchCount(0), stallCount(0), latencySumUS(0), latencyMaxUS(0), queueDepth(0), queueDepthMax(0),
+  THREAD_COUNT( DBTEnv::getInt32Property("direct_bt.jni.dispatch.threads", 0, 0 /* min */, 16 /* max */) ),
+  QUEUE_CAPACITY( DBTEnv::getInt32Property("direct_bt.jni.dispatch.queue", 1024, 16 /* min */, 65536 /* max */) )
+{
+    for(int32_t i=0; i<THREAD_COUNT; i++) {
+        workers.push_back( std::unique_ptr<Worker>( new Worker() ) );
+    }
+    for(int32_t i=0; i<THREAD_COUNT; i++) {
+        Worker & w = *workers[i];
+        w.thread = std::thread(&DirectBTJNIDispatcher::workerLoop, this, std::ref(w));
+        w.thread.detach();
+    }
+}
+
+DirectBTJNIDispatcher & DirectBTJNIDispatcher::get() {
+    static DirectBTJNIDispatcher * instance = new DirectBTJNIDispatcher();
+    return *instance;
+}
+
+void DirectBTJNIDispatcher::workerLoop(Worker & w) {
+    (void) *jni_env; // attach once, permanently for this thread's lifetime
+    while( true ) {
+        Item item;
+        {
+            std::unique_lock<std::mutex> lock(w.mtx); // RAII-style acquire and relinquish via destructor
+            while( w.queue.empty() ) {
+                w.cvPop.wait(lock);
+            }
+            item = std::move( w.queue.front() );
+            w.queue.pop_front();
+            queueDepth--;
+        }
+        w.cvPush.notify_one();
+
+        const uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - item.enqueued ).count();
+        latencySumUS += latency;
+        uint64_t max = latencyMaxUS;
+        while( latency > max && !latencyMaxUS.compare_exchange_weak(max, latency) ) { }
+
+        try {
+            item.task();
+        } catch (std::exception &e) {
+            ERR_PRINT("DirectBTJNIDispatcher: Caught exception %s", e.what());
+        }
+    }
+}
+
+void DirectBTJNIDispatcher::dispatch(const void * key, Task && task) {
+    Worker & w = *workers[ std::hash<const void*>()(key) % workers.size() ];
+    {
+        std::unique_lock<std::mutex> lock(w.mtx); // RAII-style acquire and relinquish via destructor
+        if( w.queue.size() >= static_cast<size_t>(QUEUE_CAPACITY) ) {
+            stallCount++;
+            while( w.queue.size() >= static_cast<size_t>(QUEUE_CAPACITY) ) {
+                w.cvPush.wait(lock);
+            }
+        }
+        w.queue.push_back( Item { std::move(task), std::chrono::steady_clock::now() } );
+        dispatchCount++;
+        const size_t depth = ++queueDepth;
+        size_t max = queueDepthMax;
+        while( depth > max && !queueDepthMax.compare_exchange_weak(max, depth) ) { }
+    }
+    w.cvPop.notify_one();
+}
+
+uint64_t DirectBTJNIDispatcher::getLatencyMeanUS() const {
+    const uint64_t count = dispatchCount - queueDepth; // executed
+    return 0 < count ? latencySumUS / count : 0;
+}
+
+std::string DirectBTJNIDispatcher::toString() const {
+    return "JNIDispatcher[threads "+std::to_string(THREAD_COUNT)+", capacity "+std::to_string(QUEUE_CAPACITY)+
+           ", queue[depth "+std::to_string(getQueueDepth())+", max "+std::to_string(getQueueDepthMax())+
+           "], dispatched "+std::to_string(getDispatchCount())+", stalls "+std::to_string(getStallCount())+
+           ", latency[mean "+std::to_string(getLatencyMeanUS())+", max "+std::to_string(getLatencyMaxUS())+"] us]";
+}
+
 jclass direct_bt::search_class(JNIEnv *env, JavaUplink &object)
 {
     return search_class(env, object.get_java_class().c_str());
@@ -68,6 +239,25 @@ jstring direct_bt::fromBDAddressTypeToJavaAddressType(JNIEnv *env, BDAddressType
     }
 }
 
+bool direct_bt::raise_java_gatt_exception(JNIEnv *env, const GATTStatus status, const std::string & msg) {
+    if( !isGATTTransportFailure(status) ) {
+        return false;
+    }
+    const std::string m = msg+": "+getGATTStatusString(status);
+    switch( status ) {
+        case GATTStatus::INVALID_STATE:
+            env->ThrowNew(env->FindClass("java/lang/IllegalStateException"), m.c_str());
+            break;
+        case GATTStatus::PDU_TOO_LARGE:
+            env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), m.c_str());
+            break;
+        default:
+            env->ThrowNew(DirectBTJNICache::get(env).bluetoothExceptionClazz.getClass(), m.c_str());
+            break;
+    }
+    return true;
+}
+
 JavaGlobalObj::~JavaGlobalObj() {
     jobject obj = javaObjectRef.getObject();
     if( nullptr == obj || nullptr == mNotifyDeleted ) {
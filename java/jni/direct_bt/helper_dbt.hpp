@@ -26,12 +26,21 @@
 #ifndef HELPER_DBT_HPP_
 #define HELPER_DBT_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+
 #include "JNIMem.hpp"
 #include "helper_base.hpp"
 
 #include "direct_bt/JavaUplink.hpp"
 #include "direct_bt/BasicTypes.hpp"
 #include "direct_bt/BTAddress.hpp"
+#include "direct_bt/ATTPDUTypes.hpp"
 
 namespace direct_bt {
 
@@ -52,6 +61,168 @@ namespace direct_bt {
     };
     extern DirectBTJNISettings directBTJNISettings;
 
+    /**
+     * Global cache of JNI class references, method and field IDs of the direct_bt JNI bridge,
+     * initialized once via JNI_OnLoad, see registerJNIOnLoadCallback().
+     * <p>
+     * Hence listener registration and Java device peer creation on first deviceFound
+     * require no reflective class, method or field lookup.
+     * </p>
+     * <p>
+     * Listener method IDs are resolved against the abstract Java listener classes,
+     * CallVoidMethod dispatches them virtually to the user's implementation.
+     * </p>
+     */
+    class DirectBTJNICache {
+        private:
+            static std::atomic<bool> initialized;
+            static std::mutex mtx_init;
+
+            void init(JNIEnv *env);
+
+        public:
+            JNIGlobalRef adapterSettingsClazz;
+            jmethodID adapterSettingsCtor = nullptr;
+            JNIGlobalRef eirDataTypeSetClazz;
+            jmethodID eirDataTypeSetCtor = nullptr;
+            JNIGlobalRef hciStatusCodeClazz;
+            jmethodID hciStatusCodeGet = nullptr;
+
+            JNIGlobalRef deviceClazz;
+            JNIGlobalRef deviceArrayClazz;
+            jmethodID deviceCtor = nullptr;
+            jfieldID deviceTSLastDiscoveryField = nullptr;
+            jfieldID deviceTSLastUpdateField = nullptr;
+            jfieldID deviceConnectionHandleField = nullptr;
+
+            jmethodID nativeDownlinkNotifyDeleted = nullptr;
+
+            JNIGlobalRef adapterStatusListenerClazz;
+            jmethodID adapterSettingsChanged = nullptr;
+            jmethodID discoveringChanged = nullptr;
+            jmethodID deviceFound = nullptr;
+            jmethodID deviceUpdated = nullptr;
+            jmethodID deviceConnected = nullptr;
+            jmethodID deviceDisconnected = nullptr;
+
+            JNIGlobalRef adapterStatusBatchListenerClazz;
+            jfieldID batchSizeField = nullptr;
+            jfieldID batchDelayField = nullptr;
+            jfieldID batchDevicesField = nullptr;
+            jfieldID batchUpdateMasksField = nullptr;
+            jfieldID batchTimestampsField = nullptr;
+            jfieldID batchRSSIField = nullptr;
+            jmethodID devicesDiscovered = nullptr;
+
+            JNIGlobalRef characteristicListenerClazz;
+            jmethodID notificationReceived = nullptr;
+            jmethodID indicationReceived = nullptr;
+
+            JNIGlobalRef characteristicBufferListenerClazz;
+            jfieldID bufferField = nullptr;
+            jmethodID notificationReceivedBuffer = nullptr;
+            jmethodID indicationReceivedBuffer = nullptr;
+
+            JNIGlobalRef completableFutureClazz;
+            jmethodID futureComplete = nullptr;
+            jmethodID futureCompleteExceptionally = nullptr;
+            JNIGlobalRef booleanClazz;
+            jmethodID booleanValueOf = nullptr;
+            JNIGlobalRef bluetoothExceptionClazz;
+            jmethodID bluetoothExceptionCtor = nullptr;
+
+            /** JNIOnLoadCallback, initializing the global instance. */
+            static void onLoad(JNIEnv *env);
+
+            /**
+             * Returns the initialized global instance.
+             * <p>
+             * Initializes it lazily, if JNI_OnLoad has not done so.
+             * </p>
+             * <p>
+             * The instance is never destructed, avoiding JNI global reference deletion at process exit.
+             * </p>
+             */
+            static DirectBTJNICache & get(JNIEnv *env);
+    };
+
+    /**
+     * Optional dispatch of JNI listener upcalls to a small pool of permanently attached Java callback threads,
+     * decoupling the native reader threads (HCI, L2CAP) from GC pauses and slow Java handlers.
+     * <p>
+     * Each listener is bound to one thread via its key, preserving its event order.
+     * A full queue blocks the producer, i.e. the queue capacity shall absorb expected Java pauses.
+     * </p>
+     * <p>
+     * Environment variables:
+     * <ul>
+     *   <li>'direct_bt.jni.dispatch.threads': Number of callback threads, default 0 disables dispatching.</li>
+     *   <li>'direct_bt.jni.dispatch.queue': Queue capacity per callback thread, default 1024.</li>
+     * </ul>
+     * </p>
+     */
+    class DirectBTJNIDispatcher {
+        public:
+            typedef std::function<void()> Task;
+
+        private:
+            struct Item {
+                Task task;
+                std::chrono::steady_clock::time_point enqueued;
+            };
+            struct Worker {
+                std::mutex mtx;
+                std::condition_variable cvPush;
+                std::condition_variable cvPop;
+                std::deque<Item> queue;
+                std::thread thread;
+            };
+            std::vector<std::unique_ptr<Worker>> workers;
+
+            std::atomic<uint64_t> dispatchCount;
+            std::atomic<uint64_t> stallCount;
+            std::atomic<uint64_t> latencySumUS;
+            std::atomic<uint64_t> latencyMaxUS;
+            std::atomic<size_t> queueDepth;
+            std::atomic<size_t> queueDepthMax;
+
+            DirectBTJNIDispatcher();
+
+            void workerLoop(Worker & w);
+
+        public:
+            /** Number of callback threads, zero if disabled. */
+            const int32_t THREAD_COUNT;
+            /** Queue capacity per callback thread. */
+            const int32_t QUEUE_CAPACITY;
+
+            /** Returns the global instance, which is never destructed. */
+            static DirectBTJNIDispatcher & get();
+
+            bool isEnabled() const { return 0 < THREAD_COUNT; }
+
+            /**
+             * Queues the task on the callback thread bound to the given key,
+             * blocking while its queue is full.
+             */
+            void dispatch(const void * key, Task && task);
+
+            /** Current number of queued tasks over all threads. */
+            size_t getQueueDepth() const { return queueDepth; }
+            /** Maximum number of queued tasks over all threads. */
+            size_t getQueueDepthMax() const { return queueDepthMax; }
+            /** Number of dispatched tasks. */
+            uint64_t getDispatchCount() const { return dispatchCount; }
+            /** Number of dispatch calls blocked by a full queue. */
+            uint64_t getStallCount() const { return stallCount; }
+            /** Mean latency from queuing to execution in microseconds. */
+            uint64_t getLatencyMeanUS() const;
+            /** Maximum latency from queuing to execution in microseconds. */
+            uint64_t getLatencyMaxUS() const { return latencyMaxUS; }
+
+            std::string toString() const;
+    };
+
     /**
      * Implementation for JavaAnonObj,
      * by simply wrapping a JNIGlobalRef instance.
@@ -149,6 +320,13 @@ namespace direct_bt {
     BDAddressType fromJavaAdressTypeToBDAddressType(JNIEnv *env, jstring jAddressType);
     jstring fromBDAddressTypeToJavaAddressType(JNIEnv *env, BDAddressType bdAddressType);
 
+    /**
+     * Raises the Java exception of the given GATTStatus transport failure, see isGATTTransportFailure(),
+     * matching the exception of the throwing GATTHandler API w/o throwing a native exception.
+     * @return true if a Java exception has been raised, otherwise false
+     */
+    bool raise_java_gatt_exception(JNIEnv *env, const GATTStatus status, const std::string & msg);
+
     template <typename T>
     T *getDBTObject(JNIEnv *env, jobject obj)
     {
@@ -137,15 +137,14 @@ void Java_tinyb_dbus_DBusGattCharacteristic_enableValueNotifications(JNIEnv *env
         BluetoothGattCharacteristic *obj_gatt_char =
                                     getInstance<BluetoothGattCharacteristic>(env, obj);
         std::shared_ptr<JNIGlobalRef> callback_ptr(new JNIGlobalRef(callback));
-        obj_gatt_char->enable_value_notifications([ callback_ptr ] (std::vector<unsigned char> &v)
+        obj_gatt_char->enable_raw_value_notifications([ callback_ptr ] (const unsigned char *data, size_t size)
             {
                 jclass notification = search_class(*jni_env, **callback_ptr);
                 jmethodID  method = search_method(*jni_env, notification, "run", "(Ljava/lang/Object;)V", false);
                 jni_env->DeleteLocalRef(notification);
-                unsigned int size = v.size();
 
                 jbyteArray result = jni_env->NewByteArray((jsize)size);
-                jni_env->SetByteArrayRegion(result, 0, (jsize)size, (const jbyte *)&v[0]);
+                jni_env->SetByteArrayRegion(result, 0, (jsize)size, (const jbyte *)data);
 
                 jni_env->CallVoidMethod(**callback_ptr, method, result);
                 jni_env->DeleteLocalRef(result);
@@ -0,0 +1,102 @@
+/**
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package org.tinyb;
+
+/**
+ * {@link AdapterStatusListener} receiving {@link #deviceFound(BluetoothDevice, long) deviceFound}
+ * and {@link #deviceUpdated(BluetoothDevice, EIRDataTypeSet, long) deviceUpdated} events
+ * in batches via {@link #devicesDiscovered(BluetoothDevice[], int[], long[], byte[], int)}.
+ * <p>
+ * The native stack queues these events and delivers them with one upcall
+ * once {@link #getBatchSize()} events are queued or the oldest queued event is older than {@link #getBatchDelay()},
+ * checked at each new event.
+ * Pending events are also delivered before any other event of this listener, preserving their order.
+ * </p>
+ * <p>
+ * The event arrays are allocated once by this instance and reused for each batch,
+ * i.e. they are only valid within the callback. No {@link EIRDataTypeSet} instance is created per event,
+ * {@link #deviceFound(BluetoothDevice, long) deviceFound} and {@link #deviceUpdated(BluetoothDevice, EIRDataTypeSet, long) deviceUpdated}
+ * are not called for this listener.
+ * </p>
+ */
+public abstract class AdapterStatusBatchListener extends AdapterStatusListener {
+    /** Default batch size, {@value} events. */
+    public static final int DEFAULT_BATCH_SIZE = 64;
+
+    /** Default batch delay, {@value} milliseconds. */
+    public static final int DEFAULT_BATCH_DELAY = 100;
+
+    private final int batchSize;
+    private final int batchDelay;
+
+    /** Filled by the native stack for each batch. */
+    private final BluetoothDevice[] devices;
+    private final int[] updateMasks;
+    private final long[] timestamps;
+    private final byte[] rssi;
+
+    /**
+     * @param batchSize maximum number of events per batch, must be greater than zero
+     * @param batchDelay maximum age of a queued event in milliseconds before its batch is delivered, must not be negative
+     * @throws IllegalArgumentException if batchSize or batchDelay is out of range
+     */
+    public AdapterStatusBatchListener(final int batchSize, final int batchDelay) throws IllegalArgumentException {
+        if( 0 >= batchSize || 0 > batchDelay ) {
+            throw new IllegalArgumentException("batchSize "+batchSize+", batchDelay "+batchDelay);
+        }
+        this.batchSize = batchSize;
+        this.batchDelay = batchDelay;
+        this.devices = new BluetoothDevice[batchSize];
+        this.updateMasks = new int[batchSize];
+        this.timestamps = new long[batchSize];
+        this.rssi = new byte[batchSize];
+    }
+
+    /** Using {@link #DEFAULT_BATCH_SIZE} and {@link #DEFAULT_BATCH_DELAY}. */
+    public AdapterStatusBatchListener() {
+        this(DEFAULT_BATCH_SIZE, DEFAULT_BATCH_DELAY);
+    }
+
+    /** Returns the maximum number of events per batch. */
+    public final int getBatchSize() { return batchSize; }
+
+    /** Returns the maximum age of a queued event in milliseconds before its batch is delivered. */
+    public final int getBatchDelay() { return batchDelay; }
+
+    /**
+     * A batch of newly discovered and updated {@link BluetoothDevice}s, in event order.
+     * <p>
+     * All arrays have the length {@link #getBatchSize()}, only the first {@code count} elements are valid.
+     * </p>
+     * @param devices the found or updated devices
+     * @param updateMasks the {@link EIRDataTypeSet} mask of changed data, zero for a newly found device
+     * @param timestamps the time in monotonic milliseconds when each event occurred. See {@link BluetoothUtils#getCurrentMilliseconds()}.
+     * @param rssi the device's RSSI at the time of each event
+     * @param count number of valid events
+     */
+    public void devicesDiscovered(final BluetoothDevice[] devices, final int[] updateMasks,
+                                  final long[] timestamps, final byte[] rssi, final int count) { }
+};
@@ -0,0 +1,121 @@
+/**
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package org.tinyb;
+
+import java.nio.ByteBuffer;
+
+/**
+ * {@link GATTCharacteristicListener} receiving notification and indication values
+ * within its own reusable direct {@link ByteBuffer}, avoiding one Java heap array per event.
+ * <p>
+ * The native stack copies each value into this listener's {@link #getBuffer() buffer},
+ * used as a ring of consecutive values. Each callback passes the {@code offset} and {@code length}
+ * of the value within the buffer. The buffer's position and limit are not modified.
+ * </p>
+ * <p>
+ * A value region stays intact until the ring wraps around,
+ * i.e. at least for the next {@code capacity / MAX_VALUE_SIZE - 1} callbacks of this listener.
+ * A consumer passing the value to another thread beyond this bound must copy it.
+ * </p>
+ * <p>
+ * Values exceeding the buffer's capacity are delivered via the
+ * {@code byte[]} based methods of {@link GATTCharacteristicListener}.
+ * </p>
+ */
+public abstract class GATTCharacteristicBufferListener extends GATTCharacteristicListener {
+    /** Maximum attribute value size, 512 bytes. */
+    public static final int MAX_VALUE_SIZE = 512;
+
+    /** Default buffer capacity of {@value}, i.e. eight values of {@link #MAX_VALUE_SIZE}. */
+    public static final int DEFAULT_CAPACITY = 8 * MAX_VALUE_SIZE;
+
+    /** Written into by the native stack, see {@link #getBuffer()}. */
+    private final ByteBuffer buffer;
+
+    /**
+     * @param associatedCharacteristic weakly associates this listener instance to one {@link BluetoothGattCharacteristic},
+     *        may be {@code null} for no association.
+     * @param capacity the direct buffer capacity, must be at least {@link #MAX_VALUE_SIZE}
+     * @throws IllegalArgumentException if capacity is less than {@link #MAX_VALUE_SIZE}
+     */
+    public GATTCharacteristicBufferListener(final BluetoothGattCharacteristic associatedCharacteristic, final int capacity)
+        throws IllegalArgumentException
+    {
+        super(associatedCharacteristic);
+        if( MAX_VALUE_SIZE > capacity ) {
+            throw new IllegalArgumentException("capacity "+capacity+" < "+MAX_VALUE_SIZE);
+        }
+        this.buffer = ByteBuffer.allocateDirect(capacity);
+    }
+
+    /**
+     * Using {@link #DEFAULT_CAPACITY}.
+     * @param associatedCharacteristic weakly associates this listener instance to one {@link BluetoothGattCharacteristic},
+     *        may be {@code null} for no association.
+     */
+    public GATTCharacteristicBufferListener(final BluetoothGattCharacteristic associatedCharacteristic) {
+        this(associatedCharacteristic, DEFAULT_CAPACITY);
+    }
+
+    /** Returns the direct buffer all values of this listener are delivered in. */
+    public final ByteBuffer getBuffer() { return buffer; }
+
+    /**
+     * Called from native BLE stack, initiated by a received notification associated
+     * with the given {@link BluetoothGattCharacteristic}.
+     * @param charDecl {@link BluetoothGattCharacteristic} related to this notification
+     * @param value this listener's {@link #getBuffer() buffer}
+     * @param offset the notification value's offset within value
+     * @param length the notification value's length
+     * @param timestamp the notification monotonic timestamp, see {@link BluetoothUtils#getCurrentMilliseconds()}
+     */
+    public void notificationReceived(final BluetoothGattCharacteristic charDecl,
+                                     final ByteBuffer value, final int offset, final int length,
+                                     final long timestamp) {
+    }
+
+    /**
+     * Called from native BLE stack, initiated by a received indication associated
+     * with the given {@link BluetoothGattCharacteristic}.
+     * @param charDecl {@link BluetoothGattCharacteristic} related to this indication
+     * @param value this listener's {@link #getBuffer() buffer}
+     * @param offset the indication value's offset within value
+     * @param length the indication value's length
+     * @param timestamp the indication monotonic timestamp, see {@link BluetoothUtils#getCurrentMilliseconds()}
+     * @param confirmationSent if true, the native stack has sent the confirmation, otherwise user is required to do so.
+     */
+    public void indicationReceived(final BluetoothGattCharacteristic charDecl,
+                                   final ByteBuffer value, final int offset, final int length,
+                                   final long timestamp, final boolean confirmationSent) {
+    }
+
+    @Override
+    public String toString() {
+        final BluetoothGattCharacteristic c = getAssociatedCharacteristic();
+        final String cs = null != c ? c.toString() : "null";
+        return "GATTCharacteristicBufferListener[capacity "+buffer.capacity()+", associated "+cs+"]";
+    }
+};
@@ -82,6 +82,29 @@ std::string AttPDUMsg::getOpcodeString(const Opcode opc) {
     return "Unknown Opcode";
 }
 
+#define GATTSTATUS_ENUM(X) \
+    X(GATTStatus,SUCCESS) \
+    X(GATTStatus,INVALID_STATE) \
+    X(GATTStatus,PDU_TOO_LARGE) \
+    X(GATTStatus,IO_ERROR) \
+    X(GATTStatus,WRITE_COUNT_MISMATCH) \
+    X(GATTStatus,TIMEOUT) \
+    X(GATTStatus,ERROR_RSP) \
+    X(GATTStatus,UNEXPECTED_REPLY) \
+    X(GATTStatus,INVALID_VALUE) \
+    X(GATTStatus,ABORTED) \
+    X(GATTStatus,INTERNAL_ERROR)
+
+#define CASE2_TO_STRING(U,V) case U::V: return #V;
+
+std::string direct_bt::getGATTStatusString(const GATTStatus s) {
+    switch(s) {
+        GATTSTATUS_ENUM(CASE2_TO_STRING)
+        default: ; // fall through intended
+    }
+    return "Unknown GATTStatus";
+}
+
 std::string AttErrorRsp::getPlainErrorString(const ErrorCode errorCode) {
     switch(errorCode) {
         case INVALID_HANDLE: return "Invalid Handle";
@@ -125,7 +148,7 @@ AttPDUMsg* AttPDUMsg::getSpecialized(const uint8_t * buffer, int const buffer_si
         case ATT_FIND_INFORMATION_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
         case ATT_FIND_INFORMATION_RSP: res = new AttFindInfoRsp(buffer, buffer_size); break;
         case ATT_FIND_BY_TYPE_VALUE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
-        case ATT_FIND_BY_TYPE_VALUE_RSP: res = new AttPDUMsg(buffer, buffer_size); break;
+        case ATT_FIND_BY_TYPE_VALUE_RSP: res = new AttFindByTypeValueRsp(buffer, buffer_size); break;
         case ATT_READ_BY_TYPE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
         case ATT_READ_BY_TYPE_RSP: res = new AttReadByTypeRsp(buffer, buffer_size); break;
         case ATT_READ_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
@@ -133,19 +156,19 @@ AttPDUMsg* AttPDUMsg::getSpecialized(const uint8_t * buffer, int const buffer_si
         case ATT_READ_BLOB_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
         case ATT_READ_BLOB_RSP: res = new AttReadBlobRsp(buffer, buffer_size); break;
         case ATT_READ_MULTIPLE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
-        case ATT_READ_MULTIPLE_RSP: res = new AttPDUMsg(buffer, buffer_size); break;
+        case ATT_READ_MULTIPLE_RSP: res = new AttReadMultipleRsp(buffer, buffer_size); break;
         case ATT_READ_BY_GROUP_TYPE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
         case ATT_READ_BY_GROUP_TYPE_RSP: res = new AttReadByGroupTypeRsp(buffer, buffer_size); break;
         case ATT_WRITE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
         case ATT_WRITE_RSP: res = new AttWriteRsp(buffer, buffer_size); break;
         case ATT_WRITE_CMD: res = new AttPDUMsg(buffer, buffer_size); break;
         case ATT_PREPARE_WRITE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
-        case ATT_PREPARE_WRITE_RSP: res = new AttPDUMsg(buffer, buffer_size); break;
+        case ATT_PREPARE_WRITE_RSP: res = new AttPrepareWriteRsp(buffer, buffer_size); break;
         case ATT_EXECUTE_WRITE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
-        case ATT_EXECUTE_WRITE_RSP: res = new AttPDUMsg(buffer, buffer_size); break;
+        case ATT_EXECUTE_WRITE_RSP: res = new AttExecuteWriteRsp(buffer, buffer_size); break;
         case ATT_READ_MULTIPLE_VARIABLE_REQ: res = new AttPDUMsg(buffer, buffer_size); break;
-        case ATT_READ_MULTIPLE_VARIABLE_RSP: res = new AttPDUMsg(buffer, buffer_size); break;
-        case ATT_MULTIPLE_HANDLE_VALUE_NTF: res = new AttPDUMsg(buffer, buffer_size); break;
+        case ATT_READ_MULTIPLE_VARIABLE_RSP: res = new AttMultipleValueList(buffer, buffer_size); break;
+        case ATT_MULTIPLE_HANDLE_VALUE_NTF: res = new AttMultipleValueList(buffer, buffer_size); break;
         case ATT_HANDLE_VALUE_NTF: res = new AttHandleValueRcv(buffer, buffer_size); break;
         case ATT_HANDLE_VALUE_IND: res = new AttHandleValueRcv(buffer, buffer_size); break;
         case ATT_HANDLE_VALUE_CFM: res = new AttPDUMsg(buffer, buffer_size); break;
@@ -154,3 +177,64 @@ AttPDUMsg* AttPDUMsg::getSpecialized(const uint8_t * buffer, int const buffer_si
     }
     return res;
 }
+
+AttPDUPool::AttPDUPool(const int capacity_, const int pduCapacity_)
+: capacity(capacity_), pduCapacity(pduCapacity_), allocCount(0), fallbackCount(0)
+{
+    for(int i=0; i<Kind::COUNT; i++) {
+        pool[i].reserve(capacity);
+        nextIdx[i] = 0;
+    }
+}
+
+template<typename T>
+std::shared_ptr<AttPDUMsg> AttPDUPool::acquire(const Kind kind, const uint8_t * buffer, int const buffer_size) {
+    std::vector<std::shared_ptr<AttPDUMsg>> & p = pool[kind];
+    const int size = p.size();
+    for(int j=0; j<size; j++) {
+        const int i = ( nextIdx[kind] + j ) % size;
+        std::shared_ptr<AttPDUMsg> & e = p[i];
+        if( 1 == e.use_count() ) {
+            // Only referenced by this pool: Synchronize with the last user's release before reuse.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            e->reset(buffer, buffer_size);
+            nextIdx[kind] = ( i + 1 ) % size;
+            return e;
+        }
+    }
+    std::shared_ptr<AttPDUMsg> e( new T(buffer, buffer_size) );
+    if( size < capacity ) {
+        if( e->pdu.getCapacity() < pduCapacity ) {
+            e->pdu.recapacity(pduCapacity);
+        }
+        p.push_back(e);
+        allocCount++;
+    } else {
+        fallbackCount++;
+    }
+    return e;
+}
+
+std::shared_ptr<AttPDUMsg> AttPDUPool::getSpecialized(const uint8_t * buffer, int const buffer_size) {
+    const uint8_t opc = 0 < buffer_size ? *buffer : static_cast<uint8_t>(AttPDUMsg::ATT_PDU_UNDEFINED);
+    switch( opc ) {
+        case AttPDUMsg::ATT_PDU_UNDEFINED: return acquire<AttPDUUndefined>(Kind::UNDEFINED, buffer, buffer_size);
+        case AttPDUMsg::ATT_ERROR_RSP: return acquire<AttErrorRsp>(Kind::ERROR_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_EXCHANGE_MTU_RSP: return acquire<AttExchangeMTU>(Kind::EXCHANGE_MTU, buffer, buffer_size);
+        case AttPDUMsg::ATT_FIND_INFORMATION_RSP: return acquire<AttFindInfoRsp>(Kind::FIND_INFO_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_RSP: return acquire<AttFindByTypeValueRsp>(Kind::FIND_BY_TYPE_VALUE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_READ_BY_TYPE_RSP: return acquire<AttReadByTypeRsp>(Kind::READ_BY_TYPE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_READ_RSP: return acquire<AttReadRsp>(Kind::READ_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_READ_BLOB_RSP: return acquire<AttReadBlobRsp>(Kind::READ_BLOB_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_READ_MULTIPLE_RSP: return acquire<AttReadMultipleRsp>(Kind::READ_MULTIPLE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_READ_BY_GROUP_TYPE_RSP: return acquire<AttReadByGroupTypeRsp>(Kind::READ_BY_GROUP_TYPE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_WRITE_RSP: return acquire<AttWriteRsp>(Kind::WRITE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_PREPARE_WRITE_RSP: return acquire<AttPrepareWriteRsp>(Kind::PREPARE_WRITE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_EXECUTE_WRITE_RSP: return acquire<AttExecuteWriteRsp>(Kind::EXECUTE_WRITE_RSP, buffer, buffer_size);
+        case AttPDUMsg::ATT_READ_MULTIPLE_VARIABLE_RSP: return acquire<AttMultipleValueList>(Kind::MULTIPLE_VALUE_LIST, buffer, buffer_size);
+        case AttPDUMsg::ATT_MULTIPLE_HANDLE_VALUE_NTF: return acquire<AttMultipleValueList>(Kind::MULTIPLE_VALUE_LIST, buffer, buffer_size);
+        case AttPDUMsg::ATT_HANDLE_VALUE_NTF: return acquire<AttHandleValueRcv>(Kind::HANDLE_VALUE_RCV, buffer, buffer_size);
+        case AttPDUMsg::ATT_HANDLE_VALUE_IND: return acquire<AttHandleValueRcv>(Kind::HANDLE_VALUE_RCV, buffer, buffer_size);
+        default: return acquire<AttPDUMsg>(Kind::GENERIC, buffer, buffer_size);
+    }
+}
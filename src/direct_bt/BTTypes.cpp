@@ -34,6 +34,7 @@
 #include  <algorithm>
 
 #include "BTTypes.hpp"
+#include "dfa_utf8_decode.hpp"
 
 using namespace direct_bt;
 
@@ -145,35 +146,16 @@ BLERandomAddressType EUI48::getBLERandomAddressType(const BDAddressType addressT
 }
 
 std::string EUI48::toString() const {
-    const int length = 17;
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-
-    const int count = snprintf(&str[0], str.capacity(), "%2.2X:%2.2X:%2.2X:%2.2X:%2.2X:%2.2X",
-                                b[5], b[4], b[3], b[2], b[1], b[0]);
-    if( length != count ) {
-        throw direct_bt::InternalError("EUI48 string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
-    }
-    return str;
+    char str[STRING_LENGTH+1];
+    return std::string(toChars(str), STRING_LENGTH);
 }
 
-EUI48::EUI48(const std::string str) {
-    if( 17 != str.length() ) {
-        std::string msg("EUI48 string not of length 17 but ");
-        msg.append(std::to_string(str.length()));
-        msg.append(": "+str);
-        throw direct_bt::IllegalArgumentException(msg, E_FILE_LINE);
-    }
-    if ( sscanf(str.c_str(), "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx",
-                     &b[5], &b[4], &b[3], &b[2], &b[1], &b[0]) != 6 )
-    {
-        std::string msg("EUI48 string not in format '00:00:00:00:00:00' but "+str);
+EUI48::EUI48(const std::string & str) {
+    if( !scanString(str, *this) ) {
+        std::string msg("EUI48 string not in format '00:00:00:00:00:00' but ");
+        msg.append(str);
         throw direct_bt::IllegalArgumentException(msg, E_FILE_LINE);
     }
-
-    // sscanf provided host data type, in which we store the values,
-    // hence no endian conversion
 }
 
 EUI48::EUI48(const uint8_t * _b) {
@@ -181,10 +163,8 @@ EUI48::EUI48(const uint8_t * _b) {
 }
 
 const EUI48 direct_bt::EUI48_ANY_DEVICE; // default ctor is zero bytes!
-static uint8_t _EUI48_ALL_DEVICE[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
-static uint8_t _EUI48_LOCAL_DEVICE[] = {0x00, 0x00, 0x00, 0xff, 0xff, 0xff};
-const EUI48 direct_bt::EUI48_ALL_DEVICE( _EUI48_ALL_DEVICE );
-const EUI48 direct_bt::EUI48_LOCAL_DEVICE( _EUI48_LOCAL_DEVICE );
+const EUI48 direct_bt::EUI48_ALL_DEVICE( 0xff, 0xff, 0xff, 0xff, 0xff, 0xff );
+const EUI48 direct_bt::EUI48_LOCAL_DEVICE( 0x00, 0x00, 0x00, 0xff, 0xff, 0xff );
 
 // *************************************************
 // *************************************************
@@ -357,6 +337,98 @@ std::string ManufactureSpecificData::toString() const {
 // *************************************************
 // *************************************************
 
+uint8_t * ADWriter::addField(const GAP_T type, const int length) noexcept {
+    // length octet covers the type octet and the data
+    if( 0 > length || 254 < length || size + 2 + length > buffer.getSize() ) {
+        overflow = true;
+        return nullptr;
+    }
+    uint8_t * p = buffer.get_wptr() + size;
+    p[0] = static_cast<uint8_t>( 1 + length );
+    p[1] = static_cast<uint8_t>(type);
+    size += 2 + length;
+    return p + 2;
+}
+
+bool ADWriter::add(const GAP_T type, const uint8_t * data, const int length) noexcept {
+    uint8_t * p = addField(type, length);
+    if( nullptr == p ) {
+        return false;
+    }
+    if( 0 < length ) {
+        memcpy(p, data, length);
+    }
+    return true;
+}
+
+bool ADWriter::addFlags(const uint8_t flags) noexcept {
+    return add(GAP_T::FLAGS, &flags, 1);
+}
+
+bool ADWriter::addName(const std::string & name) noexcept {
+    const int len = static_cast<int>( name.size() );
+    if( size + 2 + len <= buffer.getSize() ) {
+        return add(GAP_T::NAME_LOCAL_COMPLETE, reinterpret_cast<const uint8_t*>(name.c_str()), len);
+    }
+    const int shortLen = std::min(254, getRemaining() - 2);
+    if( 0 >= shortLen ) {
+        overflow = true;
+        return false;
+    }
+    return add(GAP_T::NAME_LOCAL_SHORT, reinterpret_cast<const uint8_t*>(name.c_str()), shortLen);
+}
+
+bool ADWriter::addTxPower(const int8_t txPower) noexcept {
+    const uint8_t v = static_cast<uint8_t>(txPower);
+    return add(GAP_T::TX_POWER_LEVEL, &v, 1);
+}
+
+bool ADWriter::addAppearance(const AppearanceCat appearance) noexcept {
+    uint8_t * p = addField(GAP_T::GAP_APPEARANCE, 2);
+    if( nullptr == p ) {
+        return false;
+    }
+    put_uint16(p, 0, static_cast<uint16_t>(appearance), true /* littleEndian */);
+    return true;
+}
+
+bool ADWriter::addServiceUUID(const uuid_t & uuid) noexcept {
+    GAP_T type;
+    switch( uuid.getTypeSize() ) {
+        case uuid_t::TypeSize::UUID16_SZ: type = GAP_T::UUID16_COMPLETE; break;
+        case uuid_t::TypeSize::UUID32_SZ: type = GAP_T::UUID32_COMPLETE; break;
+        default: type = GAP_T::UUID128_COMPLETE; break;
+    }
+    uint8_t * p = addField(type, uuid.getTypeSize());
+    if( nullptr == p ) {
+        return false;
+    }
+    put_uuid(p, 0, uuid, true /* littleEndian */);
+    return true;
+}
+
+uint8_t * ADWriter::addServiceData(const uint16_t uuid16, const int length) noexcept {
+    uint8_t * p = addField(GAP_T::SVC_DATA_UUID16, 2 + length);
+    if( nullptr == p ) {
+        return nullptr;
+    }
+    put_uint16(p, 0, uuid16, true /* littleEndian */);
+    return p + 2;
+}
+
+uint8_t * ADWriter::addManufacturerData(const uint16_t company, const int length) noexcept {
+    uint8_t * p = addField(GAP_T::MANUFACTURE_SPECIFIC, 2 + length);
+    if( nullptr == p ) {
+        return nullptr;
+    }
+    put_uint16(p, 0, company, true /* littleEndian */);
+    return p + 2;
+}
+
+// *************************************************
+// *************************************************
+// *************************************************
+
 #define EIRDATATYPE_ENUM(X) \
     X(EIRDataType,NONE) \
     X(EIRDataType,EVT_TYPE) \
@@ -436,31 +508,147 @@ void EInfoReport::setAddressType(BDAddressType at) {
     set(EIRDataType::BDADDR_TYPE);
 }
 
+/** Maximum number of name bytes retained of an advertising report */
+static const int EIR_NAME_MAX_LEN = 30;
+
+static std::string decodeName(const uint8_t *buffer, int buffer_len) {
+    return dfa_utf8_decode(buffer, static_cast<size_t>( std::max(0, std::min(buffer_len, EIR_NAME_MAX_LEN)) ));
+}
+
 void EInfoReport::setName(const uint8_t *buffer, int buffer_len) {
-    name = get_string(buffer, buffer_len, 30);
+    name = decodeName(buffer, buffer_len);
     set(EIRDataType::NAME);
 }
 
 void EInfoReport::setShortName(const uint8_t *buffer, int buffer_len) {
-    name_short = get_string(buffer, buffer_len, 30);
+    name_short = decodeName(buffer, buffer_len);
     set(EIRDataType::NAME_SHORT);
 }
 
-void EInfoReport::addService(std::shared_ptr<uuid_t> const &uuid)
+bool EInfoReport::isNameEqual(const std::string & other) const {
+    if( isEIRDataTypeSet(static_cast<EIRDataType>( lazy_pending.load() ), EIRDataType::NAME) && 0 <= lazy_name_offset ) {
+        // compare the raw bytes up to EOS, a valid UTF-8 name decodes to itself
+        const uint8_t * data = lazy_data.get_ptr() + lazy_name_offset;
+        const size_t max_len = static_cast<size_t>( std::max(0, std::min(data[0] - 1, EIR_NAME_MAX_LEN)) );
+        const size_t len = strnlen(reinterpret_cast<const char*>(data + 2), max_len);
+        return len == other.length() && 0 == memcmp(data + 2, other.data(), len);
+    }
+    return getName() == other;
+}
+
+void EInfoReport::addService(std::vector<uuid_value_t> & list, uuid_value_t const &uuid)
 {
-    auto begin = services.begin();
-    auto it = std::find_if(begin, services.end(), [&](std::shared_ptr<uuid_t> const& p) {
-        return *p == *uuid;
-    });
-    if ( it == std::end(services) ) {
-        services.push_back(uuid);
+    if ( std::find(list.begin(), list.end(), uuid) == list.end() ) {
+        list.push_back(uuid);
+    }
+}
+
+bool EInfoReport::addServices(std::vector<uuid_value_t> & list, const uint8_t elem_type, uint8_t const * elem_data, const int elem_len) {
+    switch ( static_cast<GAP_T>(elem_type) ) {
+        case GAP_T::UUID16_INCOMPLETE:
+        case GAP_T::UUID16_COMPLETE:
+            for(int j=0; j<elem_len/2; j++) {
+                addService(list, uuid_value_t(uuid_t::TypeSize::UUID16_SZ, elem_data, j*2));
+            }
+            return true;
+        case GAP_T::UUID32_INCOMPLETE:
+        case GAP_T::UUID32_COMPLETE:
+            for(int j=0; j<elem_len/4; j++) {
+                addService(list, uuid_value_t(uuid_t::TypeSize::UUID32_SZ, elem_data, j*4));
+            }
+            return true;
+        case GAP_T::UUID128_INCOMPLETE:
+        case GAP_T::UUID128_COMPLETE:
+            for(int j=0; j<elem_len/16; j++) {
+                addService(list, uuid_value_t(uuid_t::TypeSize::UUID128_SZ, elem_data, j*16));
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+void EInfoReport::materialize_lazy(const uint32_t fields) const {
+    const std::lock_guard<std::mutex> lock(mtx_lazy); // RAII-style acquire and relinquish via destructor
+    const uint32_t pending_bits = lazy_pending.load() & fields;
+    const EIRDataType pending = static_cast<EIRDataType>( pending_bits );
+    if( EIRDataType::NONE == pending ) {
+        return; // materialized concurrently
+    }
+    const uint8_t * data = lazy_data.get_ptr();
+    if( isEIRDataTypeSet(pending, EIRDataType::NAME) && 0 <= lazy_name_offset ) {
+        name = decodeName(data + lazy_name_offset + 2, data[lazy_name_offset] - 1);
+    }
+    if( isEIRDataTypeSet(pending, EIRDataType::NAME_SHORT) && 0 <= lazy_name_short_offset ) {
+        name_short = decodeName(data + lazy_name_short_offset + 2, data[lazy_name_short_offset] - 1);
+    }
+    if( isEIRDataTypeSet(pending, EIRDataType::MANUF_DATA) && 0 <= lazy_msd_offset ) {
+        const uint8_t * elem_data = data + lazy_msd_offset + 2;
+        const int elem_len = data[lazy_msd_offset] - 1;
+        msd = std::shared_ptr<ManufactureSpecificData>(new ManufactureSpecificData(
+                get_uint16(elem_data, 0, true /* littleEndian */), elem_data+2, elem_len-2));
+    }
+    if( isEIRDataTypeSet(pending, EIRDataType::SERVICE_UUID) ) {
+        int offset = 0;
+        uint8_t elem_len, elem_type;
+        uint8_t const *elem_data;
+        while( 0 < ( offset = next_data_elem( &elem_len, &elem_type, &elem_data, data, offset, lazy_data.getSize() ) ) ) {
+            addServices(services, elem_type, elem_data, elem_len);
+        }
     }
+    lazy_pending.fetch_and( ~pending_bits ); // publishes the materialized fields
+}
+
+EInfoReport::EInfoReport(const EInfoReport & o)
+: source(o.source), timestamp(o.timestamp), eir_data_mask(o.eir_data_mask),
+  evt_type(o.evt_type), ad_address_type(o.ad_address_type), addressType(o.addressType), address(o.address),
+  flags(o.flags), rssi(o.rssi), tx_power(o.tx_power),
+  device_class(o.device_class), appearance(o.appearance), hash(o.hash), randomizer(o.randomizer),
+  did_source(o.did_source), did_vendor(o.did_vendor), did_product(o.did_product), did_version(o.did_version),
+  lazy_data(), lazy_pending(0)
+{
+    o.materialize();
+    name = o.name;
+    name_short = o.name_short;
+    msd = o.msd;
+    services = o.services;
+}
+
+void EInfoReport::reset() {
+    lazy_pending = 0;
+    source = Source::NA;
+    timestamp = 0;
+    eir_data_mask = EIRDataType::NONE;
+    evt_type = AD_PDU_Type::ADV_UNDEFINED;
+    ad_address_type = 0;
+    addressType = BDAddressType::BDADDR_UNDEFINED;
+    address = EUI48();
+    flags = 0;
+    name.clear();
+    name_short.clear();
+    rssi = 127;
+    tx_power = 127;
+    msd = nullptr;
+    services.clear();
+    device_class = 0;
+    appearance = AppearanceCat::UNKNOWN;
+    hash.resize(0);
+    randomizer.resize(0);
+    did_source = 0;
+    did_vendor = 0;
+    did_product = 0;
+    did_version = 0;
+    lazy_data.resize(0);
+    lazy_name_offset = -1;
+    lazy_name_short_offset = -1;
+    lazy_msd_offset = -1;
 }
 
 std::string EInfoReport::eirDataMaskToString() const {
     return std::string("DataSet"+ direct_bt::getEIRDataMaskString(eir_data_mask) );
 }
 std::string EInfoReport::toString(const bool includeServices) const {
+    materialize();
     std::string msdstr = nullptr != msd ? msd->toString() : "MSD[null]";
     std::string out("EInfoReport::"+getSourceString()+
                     "[address["+getAddressString()+", "+getBDAddressTypeString(getAddressType())+"/"+std::to_string(ad_address_type)+
@@ -480,8 +668,8 @@ std::string EInfoReport::toString(const bool includeServices) const {
     if( includeServices && services.size() > 0 ) {
         out.append("\n");
         for(auto it = services.begin(); it != services.end(); it++) {
-            std::shared_ptr<uuid_t> p = *it;
-            out.append("  ").append(p->toUUID128String()).append(", ").append(std::to_string(static_cast<int>(p->getTypeSize()))).append(" bytes\n");
+            const uuid_value_t & p = *it;
+            out.append("  ").append(p.toUUID128String()).append(", ").append(std::to_string(static_cast<int>(p.getTypeSize()))).append(" bytes\n");
         }
     }
     return out;
@@ -540,11 +728,19 @@ int EInfoReport::next_data_elem(uint8_t *eir_elem_len, uint8_t *eir_elem_type, u
     return -ENOENT;
 }
 
-int EInfoReport::read_data(uint8_t const * data, uint8_t const data_length) {
+int EInfoReport::read_data(uint8_t const * data, int const data_length, const bool lazy) {
     int count = 0;
     int offset = 0;
     uint8_t elem_len, elem_type;
     uint8_t const *elem_data;
+    uint32_t pending = 0;
+
+    materialize(); // complete a previous lazy read
+    if( lazy ) {
+        lazy_data.resize(0);
+        lazy_data += TROOctets(data, std::max(0, data_length));
+        data = lazy_data.get_ptr();
+    }
 
     while( 0 < ( offset = next_data_elem( &elem_len, &elem_type, &elem_data, data, offset, data_length ) ) )
     {
@@ -559,30 +755,33 @@ int EInfoReport::read_data(uint8_t const * data, uint8_t const data_length) {
                 break;
             case GAP_T::UUID16_INCOMPLETE:
             case GAP_T::UUID16_COMPLETE:
-                for(int j=0; j<elem_len/2; j++) {
-                    const std::shared_ptr<uuid_t> uuid(new uuid16_t(elem_data, j*2, true));
-                    addService(std::move(uuid));
-                }
-                break;
             case GAP_T::UUID32_INCOMPLETE:
             case GAP_T::UUID32_COMPLETE:
-                for(int j=0; j<elem_len/4; j++) {
-                    const std::shared_ptr<uuid_t> uuid(new uuid32_t(elem_data, j*4, true));
-                    addService(std::move(uuid));
-                }
-                break;
             case GAP_T::UUID128_INCOMPLETE:
             case GAP_T::UUID128_COMPLETE:
-                for(int j=0; j<elem_len/16; j++) {
-                    const std::shared_ptr<uuid_t> uuid(new uuid128_t(elem_data, j*16, true));
-                    addService(std::move(uuid));
+                if( lazy ) {
+                    pending |= static_cast<uint32_t>(EIRDataType::SERVICE_UUID);
+                } else {
+                    addServices(services, elem_type, elem_data, elem_len);
                 }
                 break;
             case GAP_T::NAME_LOCAL_SHORT:
-                setShortName(elem_data, elem_len);
+                if( lazy ) {
+                    lazy_name_short_offset = static_cast<int16_t>( elem_data - 2 - data );
+                    pending |= static_cast<uint32_t>(EIRDataType::NAME_SHORT);
+                    set(EIRDataType::NAME_SHORT);
+                } else {
+                    setShortName(elem_data, elem_len);
+                }
                 break;
             case GAP_T::NAME_LOCAL_COMPLETE:
-                setName(elem_data, elem_len);
+                if( lazy ) {
+                    lazy_name_offset = static_cast<int16_t>( elem_data - 2 - data );
+                    pending |= static_cast<uint32_t>(EIRDataType::NAME);
+                    set(EIRDataType::NAME);
+                } else {
+                    setName(elem_data, elem_len);
+                }
                 break;
             case GAP_T::TX_POWER_LEVEL:
                 if( 1 <= elem_len ) {
@@ -632,8 +831,14 @@ int EInfoReport::read_data(uint8_t const * data, uint8_t const data_length) {
                 break;
             case GAP_T::MANUFACTURE_SPECIFIC:
                 if( 2 <= elem_len ) {
-                    uint16_t company = get_uint16(elem_data, 0, true /* littleEndian */);
-                    setManufactureSpecificData(company, elem_data+2, elem_len-2);
+                    if( lazy ) {
+                        lazy_msd_offset = static_cast<int16_t>( elem_data - 2 - data );
+                        pending |= static_cast<uint32_t>(EIRDataType::MANUF_DATA);
+                        set(EIRDataType::MANUF_DATA);
+                    } else {
+                        uint16_t company = get_uint16(elem_data, 0, true /* littleEndian */);
+                        setManufactureSpecificData(company, elem_data+2, elem_len-2);
+                    }
                 }
                 break;
             default:
@@ -643,10 +848,12 @@ int EInfoReport::read_data(uint8_t const * data, uint8_t const data_length) {
                 break;
         }
     }
+    lazy_pending = pending;
     return count;
 }
 
-std::vector<std::shared_ptr<EInfoReport>> EInfoReport::read_ad_reports(uint8_t const * data, uint8_t const data_length) {
+std::vector<std::shared_ptr<EInfoReport>> EInfoReport::read_ad_reports(uint8_t const * data, uint8_t const data_length, const bool lazy,
+                                                                      const uint64_t timestamp, EInfoReportPool * pool) {
     int const num_reports = (int) data[0];
     std::vector<std::shared_ptr<EInfoReport>> ad_reports;
 
@@ -660,12 +867,12 @@ std::vector<std::shared_ptr<EInfoReport>> EInfoReport::read_ad_reports(uint8_t c
     const int segment_count = 6;
     int read_segments = 0;
     int i;
-    const uint64_t timestamp = getCurrentMilliseconds();
+    const uint64_t ts = 0 < timestamp ? timestamp : getCurrentMilliseconds();
 
     for(i = 0; i < num_reports && i_octets < limes; i++) {
-        ad_reports.push_back(std::shared_ptr<EInfoReport>(new EInfoReport()));
+        ad_reports.push_back( nullptr != pool ? pool->acquire() : std::shared_ptr<EInfoReport>(new EInfoReport()) );
         ad_reports[i]->setSource(Source::AD);
-        ad_reports[i]->setTimestamp(timestamp);
+        ad_reports[i]->setTimestamp(ts);
         ad_reports[i]->setEvtType(static_cast<AD_PDU_Type>(*i_octets++));
         read_segments++;
     }
@@ -683,7 +890,7 @@ std::vector<std::shared_ptr<EInfoReport>> EInfoReport::read_ad_reports(uint8_t c
         read_segments++;
     }
     for(i = 0; i < num_reports && i_octets + ad_data_len[i] < limes; i++) {
-        ad_reports[i]->read_data(i_octets, ad_data_len[i]);
+        ad_reports[i]->read_data(i_octets, ad_data_len[i], lazy);
         i_octets += ad_data_len[i];
         read_segments++;
     }
@@ -701,6 +908,35 @@ std::vector<std::shared_ptr<EInfoReport>> EInfoReport::read_ad_reports(uint8_t c
     return ad_reports;
 }
 
+EInfoReportPool::EInfoReportPool(const int capacity_)
+: capacity(capacity_), nextIdx(0), allocCount(0), fallbackCount(0)
+{
+    pool.reserve(capacity);
+}
+
+std::shared_ptr<EInfoReport> EInfoReportPool::acquire() {
+    const int size = pool.size();
+    for(int j=0; j<size; j++) {
+        const int i = ( nextIdx + j ) % size;
+        std::shared_ptr<EInfoReport> & e = pool[i];
+        if( 1 == e.use_count() ) {
+            // Only referenced by this pool: Synchronize with the last user's release before reuse.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            e->reset();
+            nextIdx = ( i + 1 ) % size;
+            return e;
+        }
+    }
+    std::shared_ptr<EInfoReport> e( new EInfoReport() );
+    if( size < capacity ) {
+        pool.push_back(e);
+        allocCount++;
+    } else {
+        fallbackCount++;
+    }
+    return e;
+}
+
 // *************************************************
 // *************************************************
 // *************************************************
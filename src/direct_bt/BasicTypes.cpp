@@ -42,6 +42,9 @@ using namespace direct_bt;
 
 static const int64_t NanoPerMilli = 1000000L;
 static const int64_t MilliPerOne = 1000L;
+static const int64_t NanoPerMicro = 1000L;
+static const int64_t MicroPerOne = 1000000L;
+static const int64_t NanoPerOne = 1000000000L;
 
 /**
  * See <http://man7.org/linux/man-pages/man2/clock_gettime.2.html>
@@ -57,6 +60,26 @@ int64_t direct_bt::getCurrentMilliseconds() {
     return t.tv_sec * MilliPerOne + t.tv_nsec / NanoPerMilli;
 }
 
+int64_t direct_bt::getCurrentMicroseconds() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * MicroPerOne + t.tv_nsec / NanoPerMicro;
+}
+
+int64_t direct_bt::getCurrentNanoseconds() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * NanoPerOne + t.tv_nsec;
+}
+
+int64_t direct_bt::getMonotonicNanoseconds(const int64_t realtimeNS) {
+    struct timespec r, m;
+    clock_gettime(CLOCK_REALTIME, &r);
+    clock_gettime(CLOCK_MONOTONIC, &m);
+    const int64_t age = r.tv_sec * NanoPerOne + r.tv_nsec - realtimeNS;
+    return m.tv_sec * NanoPerOne + m.tv_nsec - ( 0 < age ? age : 0 );
+}
+
 const char* direct_bt::RuntimeException::what() const noexcept {
 #if    _USE_BACKTRACE_
     // std::string out(std::runtime_error::what());
@@ -156,91 +179,100 @@ uint128_t direct_bt::merge_uint128(uint32_t const uuid32, uint128_t const & base
     return dest;
 }
 
-std::string direct_bt::uint8HexString(const uint8_t v, const bool leading0X) {
-    const int length = leading0X ? 4 : 2; // ( '0x00' | '00' )
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-
-    const int count = snprintf(&str[0], str.capacity(), ( leading0X ? "0x%.2X" : "%.2X" ), v);
-    if( length != count ) {
-        throw InternalError("uint8_t string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
+/** Two uppercase hex characters of each byte value, constant initialized */
+static const char HEX_PAIRS[] =
+    "000102030405060708090A0B0C0D0E0F"
+    "101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F"
+    "303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F"
+    "505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F"
+    "707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F"
+    "909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+    "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+    "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+    "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+/** Writes the hex characters of the given value's byteCount bytes MSB first, optionally prefixed by '0x'. */
+static std::string uintHexString(uint64_t v, const int byteCount, const bool leading0X) {
+    const int prefix = leading0X ? 2 : 0;
+    std::string str(prefix + 2 * byteCount, '0');
+    if( leading0X ) {
+        str[1] = 'x';
+    }
+    char * d = &str[prefix + 2 * byteCount];
+    for(int i=0; i<byteCount; i++, v >>= 8) {
+        const char * p = HEX_PAIRS + 2 * ( v & 0xFF );
+        *--d = p[1];
+        *--d = p[0];
     }
     return str;
 }
 
-std::string direct_bt::uint16HexString(const uint16_t v, const bool leading0X) {
-    const int length = leading0X ? 6 : 4; // ( '0x0000' | '0000' )
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
+std::string direct_bt::uint8HexString(const uint8_t v, const bool leading0X) {
+    return uintHexString(v, 1, leading0X); // ( '0x00' | '00' )
+}
 
-    const int count = snprintf(&str[0], str.capacity(), ( leading0X ? "0x%.4X" : "%.4X" ), v);
-    if( length != count ) {
-        throw InternalError("uint16_t string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
-    }
-    return str;
+std::string direct_bt::uint16HexString(const uint16_t v, const bool leading0X) {
+    return uintHexString(v, 2, leading0X); // ( '0x0000' | '0000' )
 }
 
 std::string direct_bt::uint32HexString(const uint32_t v, const bool leading0X) {
-    const int length = leading0X ? 10 : 8; // ( '0x00000000' | '00000000' )
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-
-    const int count = snprintf(&str[0], str.capacity(), ( leading0X ? "0x%.8X" : "%.8X" ), v);
-    if( length != count ) {
-        throw InternalError("uint32_t string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
-    }
-    return str;
+    return uintHexString(v, 4, leading0X); // ( '0x00000000' | '00000000' )
 }
 
 std::string direct_bt::uint64HexString(const uint64_t v, const bool leading0X) {
-    const int length = leading0X ? 18 : 16; // ( '0x0000000000000000' | '0000000000000000' )
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-
-    const int count = snprintf(&str[0], str.capacity(), ( leading0X ? "0x%.16" PRIX64 : "%.16" PRIX64 ), v);
-    if( length != count ) {
-        throw InternalError("uint64_t string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
-    }
-    return str;
+    return uintHexString(v, 8, leading0X); // ( '0x0000000000000000' | '0000000000000000' )
 }
 
-static const char* HEX_ARRAY = "0123456789ABCDEF";
-
-std::string direct_bt::bytesHexString(const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, const bool leading0X) {
-    std::string str;
-
-    if( nullptr == bytes ) {
-        return "null";
-    }
-    if( 0 == length ) {
-        return "nil";
-    }
-    if( leading0X ) {
-        str.reserve(2 + length * 2 +1);
-        str.push_back('0');
-        str.push_back('x');
-    } else {
-        str.reserve(length * 2 +1);
-    }
+char * direct_bt::bytesHexChars(const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, char * dest) noexcept {
+    const uint8_t * b = bytes + offset;
     if( lsbFirst ) {
         // LSB left -> MSB right
         for (int j = 0; j < length; j++) {
-            const int v = bytes[offset+j] & 0xFF;
-            str.push_back(HEX_ARRAY[v >> 4]);
-            str.push_back(HEX_ARRAY[v & 0x0F]);
+            const char * p = HEX_PAIRS + 2 * b[j];
+            *dest++ = p[0];
+            *dest++ = p[1];
         }
     } else {
         // MSB left -> LSB right
         for (int j = length-1; j >= 0; j--) {
-            const int v = bytes[offset+j] & 0xFF;
-            str.push_back(HEX_ARRAY[v >> 4]);
-            str.push_back(HEX_ARRAY[v & 0x0F]);
+            const char * p = HEX_PAIRS + 2 * b[j];
+            *dest++ = p[0];
+            *dest++ = p[1];
         }
     }
+    return dest;
+}
+
+void direct_bt::appendBytesHexString(std::string & dest, const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, const bool leading0X) {
+    if( nullptr == bytes ) {
+        dest.append("null");
+        return;
+    }
+    if( 0 >= length ) {
+        dest.append("nil");
+        return;
+    }
+    const size_t pos = dest.size();
+    const size_t prefix = leading0X ? 2 : 0;
+    dest.resize(pos + prefix + 2 * static_cast<size_t>(length));
+    char * d = &dest[pos];
+    if( leading0X ) {
+        *d++ = '0';
+        *d++ = 'x';
+    }
+    bytesHexChars(bytes, offset, length, lsbFirst, d);
+}
+
+std::string direct_bt::bytesHexString(const uint8_t * bytes, const int offset, const int length, const bool lsbFirst, const bool leading0X) {
+    std::string str;
+    appendBytesHexString(str, bytes, offset, length, lsbFirst, leading0X);
     return str;
 }
 
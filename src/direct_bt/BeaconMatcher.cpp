@@ -0,0 +1,221 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+#include <algorithm>
+
+#include "BeaconMatcher.hpp"
+#include "BTTypes.hpp"
+#include "BasicTypes.hpp"
+
+using namespace direct_bt;
+
+constexpr int BeaconRecord::MAX_DATA_LEN;
+constexpr int BeaconMatcher::MAX_PREFIX_LEN;
+
+#define BEACONTYPE_ENUM(X) \
+    X(BeaconType,CUSTOM) \
+    X(BeaconType,IBEACON) \
+    X(BeaconType,EDDYSTONE_UID) \
+    X(BeaconType,EDDYSTONE_URL) \
+    X(BeaconType,EDDYSTONE_TLM)
+
+#define CASE2_TO_STRING(U,V) case U::V: return #V;
+
+std::string direct_bt::getBeaconTypeString(const BeaconType v) {
+    switch(v) {
+        BEACONTYPE_ENUM(CASE2_TO_STRING)
+        default: ; // fall through intended
+    }
+    return "Unknown BeaconType";
+}
+
+std::string BeaconRecord::toString() const {
+    return "Beacon["+getBeaconTypeString(type)+", pattern "+std::to_string(pattern)+", "+address.toString()+
+           ", rssi "+std::to_string(rssi)+", tx "+std::to_string(txPower)+
+           ", id "+bytesHexString(id, 0, sizeof(id), false /* lsbFirst */, true /* leading0X */)+
+           ", major "+std::to_string(major)+", minor "+std::to_string(minor)+
+           ", data "+bytesHexString(data, 0, dataLength, false /* lsbFirst */, true /* leading0X */)+"]";
+}
+
+BeaconMatcher::BeaconMatcher(const bool consume_)
+: patterns(), keyBits( ( 2 << 16 ) / 64, 0 ), consume(consume_)
+{ }
+
+int BeaconMatcher::add(const Kind kind, const uint16_t key, const uint8_t * prefix, const int prefixLength, const BeaconType type) {
+    if( 0 > prefixLength || MAX_PREFIX_LEN < prefixLength ) {
+        throw IllegalArgumentException("Prefix length "+std::to_string(prefixLength)+" not within [0.."+
+                                       std::to_string(MAX_PREFIX_LEN)+"]", E_FILE_LINE);
+    }
+    Pattern p;
+    p.kind = kind;
+    p.key = key;
+    p.prefixLength = static_cast<uint8_t>(prefixLength);
+    memset(p.prefix, 0, sizeof(p.prefix));
+    if( 0 < prefixLength ) {
+        memcpy(p.prefix, prefix, prefixLength);
+    }
+    p.type = type;
+    p.index = static_cast<uint16_t>(patterns.size());
+    patterns.push_back(p);
+    std::sort(patterns.begin(), patterns.end(), [](const Pattern & a, const Pattern & b) {
+        if( a.kind != b.kind ) { return a.kind < b.kind; }
+        if( a.key != b.key ) { return a.key < b.key; }
+        return a.prefixLength > b.prefixLength;
+    });
+    const int bit = ( static_cast<int>(kind) << 16 ) | key;
+    keyBits[bit >> 6] |= static_cast<uint64_t>(1) << ( bit & 63 );
+    return p.index;
+}
+
+int BeaconMatcher::addManufacturer(const uint16_t company, const std::vector<uint8_t> & prefix, const BeaconType type) {
+    return add(Kind::MANUFACTURER, company, prefix.data(), static_cast<int>(prefix.size()), type);
+}
+
+int BeaconMatcher::addServiceData(const uint16_t uuid16, const std::vector<uint8_t> & prefix, const BeaconType type) {
+    return add(Kind::SERVICE_DATA, uuid16, prefix.data(), static_cast<int>(prefix.size()), type);
+}
+
+int BeaconMatcher::addIBeacon() {
+    return addManufacturer(0x004C, { 0x02, 0x15 }, BeaconType::IBEACON);
+}
+
+void BeaconMatcher::addEddystone() {
+    addServiceData(0xFEAA, { 0x00 }, BeaconType::EDDYSTONE_UID);
+    addServiceData(0xFEAA, { 0x10 }, BeaconType::EDDYSTONE_URL);
+    addServiceData(0xFEAA, { 0x20 }, BeaconType::EDDYSTONE_TLM);
+}
+
+bool BeaconMatcher::decode(const Pattern & p, const uint8_t * data, const int length, BeaconRecord & rec) {
+    rec.type = p.type;
+    rec.pattern = p.index;
+    rec.txPower = 127;
+    rec.major = 0;
+    rec.minor = 0;
+    memset(rec.id, 0, sizeof(rec.id));
+    rec.dataLength = 0;
+
+    int dataOffset = -1;
+    switch( p.type ) {
+        case BeaconType::IBEACON:
+            // 0x02 0x15, proximity UUID, major, minor (big endian) and measured power at 1m
+            if( 23 > length ) {
+                return false;
+            }
+            memcpy(rec.id, data + 2, 16);
+            rec.major = get_uint16(data, 18, false /* littleEndian */);
+            rec.minor = get_uint16(data, 20, false /* littleEndian */);
+            rec.txPower = static_cast<int8_t>(data[22]);
+            return true;
+        case BeaconType::EDDYSTONE_UID:
+            // frame type, ranging data at 0m, 10 octet namespace and 6 octet instance
+            if( 18 > length ) {
+                return false;
+            }
+            rec.txPower = static_cast<int8_t>(data[1]);
+            memcpy(rec.id, data + 2, 16);
+            return true;
+        case BeaconType::EDDYSTONE_URL:
+            // frame type, ranging data at 0m, URL scheme prefix and encoded URL
+            if( 3 > length ) {
+                return false;
+            }
+            rec.txPower = static_cast<int8_t>(data[1]);
+            dataOffset = 2;
+            break;
+        case BeaconType::EDDYSTONE_TLM:
+            // frame type, version, battery voltage, temperature, advertising count and uptime
+            if( 14 > length ) {
+                return false;
+            }
+            dataOffset = 1;
+            break;
+        default:
+            dataOffset = p.prefixLength;
+            break;
+    }
+    const int n = std::min(BeaconRecord::MAX_DATA_LEN, length - dataOffset);
+    if( 0 < n ) {
+        memcpy(rec.data, data + dataOffset, n);
+        rec.dataLength = static_cast<uint8_t>(n);
+    }
+    return true;
+}
+
+bool BeaconMatcher::matchField(const Kind kind, const uint16_t key, const uint8_t * data, const int length, BeaconRecord & rec) const {
+    Pattern k = Pattern();
+    k.kind = kind;
+    k.key = key;
+    auto it = std::lower_bound(patterns.begin(), patterns.end(), k, [](const Pattern & a, const Pattern & b) {
+        return a.kind != b.kind ? a.kind < b.kind : a.key < b.key;
+    });
+    for(; it != patterns.end() && it->kind == kind && it->key == key; ++it) {
+        if( it->prefixLength <= length && 0 == memcmp(it->prefix, data, it->prefixLength) ) {
+            return decode(*it, data, length, rec);
+        }
+    }
+    return false;
+}
+
+bool BeaconMatcher::match(const uint8_t * data, const int length, BeaconRecord & rec) const {
+    if( 0 == patterns.size() ) {
+        return false;
+    }
+    int offset = 0;
+    while( offset + 1 < length ) {
+        const int len = data[offset]; // covers type and field data
+        if( 0 == len || offset + 1 + len > length ) {
+            return false; // end of significant part or malformed
+        }
+        const uint8_t type = data[offset+1];
+        const uint8_t * field = data + offset + 2;
+        const int fieldLength = len - 1;
+        offset += 1 + len;
+
+        Kind kind;
+        if( static_cast<uint8_t>(GAP_T::MANUFACTURE_SPECIFIC) == type ) {
+            kind = Kind::MANUFACTURER;
+        } else if( static_cast<uint8_t>(GAP_T::SVC_DATA_UUID16) == type ) {
+            kind = Kind::SERVICE_DATA;
+        } else {
+            continue;
+        }
+        if( 2 > fieldLength ) {
+            continue;
+        }
+        const uint16_t key = get_uint16(field, 0, true /* littleEndian */);
+        if( testKey(kind, key) && matchField(kind, key, field + 2, fieldLength - 2, rec) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string BeaconMatcher::toString() const {
+    return "BeaconMatcher["+std::to_string(patterns.size())+" patterns, consume "+std::to_string(consume)+"]";
+}
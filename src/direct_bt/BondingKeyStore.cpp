@@ -0,0 +1,231 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include  <algorithm>
+
+extern "C" {
+    #include <fcntl.h>
+    #include <unistd.h>
+}
+
+#include "BondingKeyStore.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+namespace {
+    bool isSameLTK(const MgmtLongTermKeyInfo & a, const MgmtLongTermKeyInfo & b) {
+        return a.address == b.address && a.address_type == b.address_type && a.master == b.master;
+    }
+}
+
+BondingKeyStore::BondingKeyStore(const std::string & directory_)
+: directory(directory_)
+{ }
+
+std::string BondingKeyStore::getFilename(const EUI48 & adapter) const {
+    std::string name = adapter.toString();
+    name.erase(std::remove(name.begin(), name.end(), ':'), name.end());
+    return directory+"/"+name+".keys";
+}
+
+std::shared_ptr<const POctets> BondingKeyStore::serialize(const std::vector<MgmtLongTermKeyInfo> & ltks,
+                                                          const std::vector<MgmtIdentityResolvingKeyInfo> & irks)
+{
+    const int size = 4 + 1 + 2 + ltks.size() * MgmtLongTermKeyInfo::SIZE + 2 + irks.size() * MgmtIdentityResolvingKeyInfo::SIZE;
+    std::shared_ptr<POctets> record(new POctets(size));
+    int offset = 0;
+    record->put_uint8(offset++, 'D'); record->put_uint8(offset++, 'B'); record->put_uint8(offset++, 'T'); record->put_uint8(offset++, 'K');
+    record->put_uint8(offset++, RECORD_VERSION);
+    record->put_uint16(offset, ltks.size()); offset+=2;
+    for(const MgmtLongTermKeyInfo & k : ltks) {
+        k.put(*record, offset); offset+=MgmtLongTermKeyInfo::SIZE;
+    }
+    record->put_uint16(offset, irks.size()); offset+=2;
+    for(const MgmtIdentityResolvingKeyInfo & k : irks) {
+        k.put(*record, offset); offset+=MgmtIdentityResolvingKeyInfo::SIZE;
+    }
+    return record;
+}
+
+bool BondingKeyStore::deserialize(const TROOctets & record, std::vector<MgmtLongTermKeyInfo> & ltks,
+                                  std::vector<MgmtIdentityResolvingKeyInfo> & irks)
+{
+    try {
+        if( 'D' != record.get_uint8(0) || 'B' != record.get_uint8(1) || 'T' != record.get_uint8(2) || 'K' != record.get_uint8(3) ||
+            RECORD_VERSION != record.get_uint8(4) )
+        {
+            WARN_PRINT("BondingKeyStore::deserialize: Unknown record format");
+            return false;
+        }
+        int offset = 5;
+        std::vector<MgmtLongTermKeyInfo> rltks;
+        const int ltkCount = record.get_uint16(offset); offset+=2;
+        for(int i=0; i<ltkCount; i++) {
+            rltks.push_back( MgmtLongTermKeyInfo::get(record, offset) ); offset+=MgmtLongTermKeyInfo::SIZE;
+        }
+        std::vector<MgmtIdentityResolvingKeyInfo> rirks;
+        const int irkCount = record.get_uint16(offset); offset+=2;
+        for(int i=0; i<irkCount; i++) {
+            rirks.push_back( MgmtIdentityResolvingKeyInfo::get(record, offset) ); offset+=MgmtIdentityResolvingKeyInfo::SIZE;
+        }
+        ltks = rltks;
+        irks = rirks;
+        return true;
+    } catch (std::exception &e) {
+        WARN_PRINT("BondingKeyStore::deserialize: Corrupt record: %s", e.what());
+    }
+    return false;
+}
+
+BondingKeyStore::AdapterKeys & BondingKeyStore::getAdapterKeys(const EUI48 & adapter) {
+    auto it = keys.find(adapter);
+    if( keys.end() != it ) {
+        return it->second;
+    }
+    AdapterKeys & ak = keys[adapter];
+    if( 0 == directory.size() ) {
+        return ak;
+    }
+    const std::string fname = getFilename(adapter);
+    FILE * f = fopen(fname.c_str(), "rb");
+    if( nullptr == f ) {
+        return ak;
+    }
+    std::shared_ptr<POctets> record = nullptr;
+    if( 0 == fseek(f, 0, SEEK_END) ) {
+        const long size = ftell(f);
+        if( 0 < size && size <= UINT16_MAX * 64 && 0 == fseek(f, 0, SEEK_SET) ) {
+            record = std::shared_ptr<POctets>(new POctets(size));
+            if( static_cast<size_t>(size) != fread(record->get_wptr(), 1, size, f) ) {
+                record = nullptr;
+            }
+        }
+    }
+    fclose(f);
+    if( nullptr == record || !deserialize(*record, ak.ltks, ak.irks) ) {
+        WARN_PRINT("BondingKeyStore::getAdapterKeys: Failed to read %s", fname.c_str());
+    } else {
+        DBG_PRINT("BondingKeyStore::getAdapterKeys: %s: %zd LTKs, %zd IRKs", adapter.toString().c_str(), ak.ltks.size(), ak.irks.size());
+    }
+    return ak;
+}
+
+bool BondingKeyStore::writeRecord(const EUI48 & adapter, const AdapterKeys & ak) {
+    if( 0 == directory.size() ) {
+        return false;
+    }
+    std::shared_ptr<const POctets> record = serialize(ak.ltks, ak.irks);
+    const std::string fname = getFilename(adapter);
+    const std::string fname_tmp = fname+".tmp";
+    // Secret keys, readable by the owner only
+    const int fd = ::open(fname_tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    FILE * f = 0 <= fd ? fdopen(fd, "wb") : nullptr;
+    if( nullptr == f ) {
+        WARN_PRINT("BondingKeyStore::writeRecord: Failed to create %s", fname_tmp.c_str());
+        if( 0 <= fd ) {
+            ::close(fd);
+        }
+        return false;
+    }
+    const bool written = static_cast<size_t>(record->getSize()) == fwrite(record->get_ptr(), 1, record->getSize(), f);
+    if( 0 != fclose(f) || !written || 0 != rename(fname_tmp.c_str(), fname.c_str()) ) {
+        WARN_PRINT("BondingKeyStore::writeRecord: Failed to write %s", fname.c_str());
+        ::remove(fname_tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void BondingKeyStore::putLongTermKey(const EUI48 & adapter, const MgmtLongTermKeyInfo & key) {
+    const std::lock_guard<std::mutex> lock(mtx_keys); // RAII-style acquire and relinquish via destructor
+    AdapterKeys & ak = getAdapterKeys(adapter);
+    ak.ltks.erase(std::remove_if(ak.ltks.begin(), ak.ltks.end(),
+            [&key](const MgmtLongTermKeyInfo & k) { return isSameLTK(k, key); }), ak.ltks.end());
+    ak.ltks.push_back(key);
+    writeRecord(adapter, ak);
+    DBG_PRINT("BondingKeyStore::putLongTermKey: %s: %s", adapter.toString().c_str(), key.toString().c_str());
+}
+
+void BondingKeyStore::putIdentityResolvingKey(const EUI48 & adapter, const MgmtIdentityResolvingKeyInfo & key) {
+    const std::lock_guard<std::mutex> lock(mtx_keys); // RAII-style acquire and relinquish via destructor
+    AdapterKeys & ak = getAdapterKeys(adapter);
+    ak.irks.erase(std::remove_if(ak.irks.begin(), ak.irks.end(),
+            [&key](const MgmtIdentityResolvingKeyInfo & k) { return k.address == key.address && k.address_type == key.address_type; }),
+            ak.irks.end());
+    ak.irks.push_back(key);
+    writeRecord(adapter, ak);
+    DBG_PRINT("BondingKeyStore::putIdentityResolvingKey: %s: %s", adapter.toString().c_str(), key.toString().c_str());
+}
+
+int BondingKeyStore::remove(const EUI48 & adapter, const EUI48 & address, const BDAddressType addressType) {
+    const std::lock_guard<std::mutex> lock(mtx_keys); // RAII-style acquire and relinquish via destructor
+    AdapterKeys & ak = getAdapterKeys(adapter);
+    const uint8_t type = static_cast<uint8_t>(addressType);
+    const size_t count = ak.ltks.size() + ak.irks.size();
+    ak.ltks.erase(std::remove_if(ak.ltks.begin(), ak.ltks.end(),
+            [&](const MgmtLongTermKeyInfo & k) { return k.address == address && k.address_type == type; }), ak.ltks.end());
+    ak.irks.erase(std::remove_if(ak.irks.begin(), ak.irks.end(),
+            [&](const MgmtIdentityResolvingKeyInfo & k) { return k.address == address && k.address_type == type; }), ak.irks.end());
+    const int removed = count - ( ak.ltks.size() + ak.irks.size() );
+    if( 0 < removed ) {
+        writeRecord(adapter, ak);
+    }
+    return removed;
+}
+
+bool BondingKeyStore::isBonded(const EUI48 & adapter, const EUI48 & address, const BDAddressType addressType) {
+    const std::lock_guard<std::mutex> lock(mtx_keys); // RAII-style acquire and relinquish via destructor
+    const AdapterKeys & ak = getAdapterKeys(adapter);
+    const uint8_t type = static_cast<uint8_t>(addressType);
+    for(const MgmtLongTermKeyInfo & k : ak.ltks) {
+        if( k.address == address && k.address_type == type ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<MgmtLongTermKeyInfo> BondingKeyStore::getLongTermKeys(const EUI48 & adapter, const size_t maxCount) {
+    const std::lock_guard<std::mutex> lock(mtx_keys); // RAII-style acquire and relinquish via destructor
+    const AdapterKeys & ak = getAdapterKeys(adapter);
+    const size_t count = std::min(maxCount, ak.ltks.size());
+    return std::vector<MgmtLongTermKeyInfo>(ak.ltks.end() - count, ak.ltks.end());
+}
+
+std::vector<MgmtIdentityResolvingKeyInfo> BondingKeyStore::getIdentityResolvingKeys(const EUI48 & adapter, const size_t maxCount) {
+    const std::lock_guard<std::mutex> lock(mtx_keys); // RAII-style acquire and relinquish via destructor
+    const AdapterKeys & ak = getAdapterKeys(adapter);
+    const size_t count = std::min(maxCount, ak.irks.size());
+    return std::vector<MgmtIdentityResolvingKeyInfo>(ak.irks.end() - count, ak.irks.end());
+}
@@ -31,6 +31,10 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 
 #include <dbt_debug.hpp>
 
@@ -51,42 +55,9 @@ extern "C" {
 
 using namespace direct_bt;
 
-int DBTAdapter::findDeviceIdx(std::vector<std::shared_ptr<DBTDevice>> & devices, EUI48 const & mac, const BDAddressType macType) {
-    const size_t size = devices.size();
-    for (size_t i = 0; i < size; i++) {
-        std::shared_ptr<DBTDevice> & e = devices[i];
-        if ( nullptr != e && mac == e->getAddress() && macType == e->getAddressType() ) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-std::shared_ptr<DBTDevice> DBTAdapter::findDevice(std::vector<std::shared_ptr<DBTDevice>> & devices, EUI48 const & mac, const BDAddressType macType) {
-    const size_t size = devices.size();
-    for (size_t i = 0; i < size; i++) {
-        std::shared_ptr<DBTDevice> & e = devices[i];
-        if ( nullptr != e && mac == e->getAddress() && macType == e->getAddressType() ) {
-            return e;
-        }
-    }
-    return nullptr;
-}
-
-std::shared_ptr<DBTDevice> DBTAdapter::findDevice(std::vector<std::shared_ptr<DBTDevice>> & devices, DBTDevice const & device) {
-    const size_t size = devices.size();
-    for (size_t i = 0; i < size; i++) {
-        std::shared_ptr<DBTDevice> & e = devices[i];
-        if ( nullptr != e && device == *e ) {
-            return e;
-        }
-    }
-    return nullptr;
-}
-
 bool DBTAdapter::addConnectedDevice(const std::shared_ptr<DBTDevice> & device) {
     const std::lock_guard<std::recursive_mutex> lock(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
-    if( nullptr != findDevice(connectedDevices, *device) ) {
+    if( !connectedDevicesIndex.put(getDeviceKey(*device), device) ) {
         return false;
     }
     connectedDevices.push_back(device);
@@ -95,6 +66,9 @@ bool DBTAdapter::addConnectedDevice(const std::shared_ptr<DBTDevice> & device) {
 
 bool DBTAdapter::removeConnectedDevice(const DBTDevice & device) {
     const std::lock_guard<std::recursive_mutex> lock(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
+    if( !connectedDevicesIndex.remove(getDeviceKey(device)) ) {
+        return false;
+    }
     for (auto it = connectedDevices.begin(); it != connectedDevices.end(); ) {
         if ( nullptr != *it && device == **it ) {
             it = connectedDevices.erase(it);
@@ -122,8 +96,7 @@ int DBTAdapter::disconnectAllDevices(const HCIStatusCode reason) {
 }
 
 std::shared_ptr<DBTDevice> DBTAdapter::findConnectedDevice (EUI48 const & mac, const BDAddressType macType) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
-    return findDevice(connectedDevices, mac, macType);
+    return connectedDevicesIndex.get(BDAddressKey(mac, macType));
 }
 
 
@@ -141,11 +114,12 @@ std::shared_ptr<HCIHandler> DBTAdapter::getHCI()
             ERR_PRINT("Could not open HCIHandler: %s of %s", hci->toString().c_str(), toString().c_str());
             hci = nullptr;
         } else {
-            hci->addMgmtEventCallback(MgmtEvent::Opcode::DISCOVERING, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDiscoveringHCI));
-            hci->addMgmtEventCallback(MgmtEvent::Opcode::DEVICE_CONNECTED, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceConnectedHCI));
-            hci->addMgmtEventCallback(MgmtEvent::Opcode::CONNECT_FAILED, bindMemberFunc(this, &DBTAdapter::mgmtEvConnectFailedHCI));
-            hci->addMgmtEventCallback(MgmtEvent::Opcode::DEVICE_DISCONNECTED, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDisconnectedHCI));
-            hci->addMgmtEventCallback(MgmtEvent::Opcode::DEVICE_FOUND, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceFoundHCI));
+            adapterInfo->setControllerCaps(hci->getControllerCaps());
+            hci->addMgmtEventHandler(bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDiscoveringHCI));
+            hci->addMgmtEventHandler(bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceConnectedHCI));
+            hci->addMgmtEventHandler(bindMemberFunc(this, &DBTAdapter::mgmtEvConnectFailedHCI));
+            hci->addMgmtEventHandler(bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDisconnectedHCI));
+            hci->addAdvertisingReportBatchCallback(bindMemberFunc(this, &DBTAdapter::advertisingReportBatchHCI));
         }
     }
     return hci;
@@ -179,6 +153,10 @@ bool DBTAdapter::validateDevInfo() {
         return false;
     }
 
+    if( !mgmt.ensureAdapterInitialized(dev_id) ) {
+        ERR_PRINT("DBTAdapter::validateDevInfo: Adapter[%d] initialization failed", dev_id);
+        return false;
+    }
     adapterInfo = mgmt.getAdapterInfo(dev_id);
 
     btMode = adapterInfo->getCurrentBTMode();
@@ -187,34 +165,89 @@ bool DBTAdapter::validateDevInfo() {
         return false;
     }
 
-    mgmt.addMgmtEventCallback(dev_id, MgmtEvent::Opcode::DISCOVERING, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDiscoveringMgmt));
-    mgmt.addMgmtEventCallback(dev_id, MgmtEvent::Opcode::NEW_SETTINGS, bindMemberFunc(this, &DBTAdapter::mgmtEvNewSettingsMgmt));
-    mgmt.addMgmtEventCallback(dev_id, MgmtEvent::Opcode::LOCAL_NAME_CHANGED, bindMemberFunc(this, &DBTAdapter::mgmtEvLocalNameChangedMgmt));
+    mgmt.addMgmtEventHandler(dev_id, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDiscoveringMgmt));
+    mgmt.addMgmtEventHandler(dev_id, bindMemberFunc(this, &DBTAdapter::mgmtEvNewSettingsMgmt));
+    mgmt.addMgmtEventHandler(dev_id, bindMemberFunc(this, &DBTAdapter::mgmtEvLocalNameChangedMgmt));
+
+    if( rpaResolution ) {
+        const std::vector<MgmtIdentityResolvingKeyInfo> irks = mgmt.getBondingKeyStore().getIdentityResolvingKeys(adapterInfo->address, SIZE_MAX);
+        for(const MgmtIdentityResolvingKeyInfo & irk : irks) {
+            rpaResolver.add(irk);
+        }
+        mgmt.addMgmtEventHandler(dev_id, bindMemberFunc(this, &DBTAdapter::mgmtEvNewIdentityResolvingKeyMgmt));
+        mgmt.addMgmtEventHandler(dev_id, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceUnpairedMgmt));
+        DBG_PRINT("DBTAdapter::validateDevInfo: Adapter[%d] %zd IRKs, accelerated %d", dev_id, irks.size(), AES128::isAccelerated());
+    }
 
 #ifdef VERBOSE_ON
-    mgmt.addMgmtEventCallback(dev_id, MgmtEvent::Opcode::DEVICE_DISCONNECTED, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDisconnectedMgmt));
+    mgmt.addMgmtEventHandler(dev_id, bindMemberFunc(this, &DBTAdapter::mgmtEvDeviceDisconnectedMgmt));
 #endif
     return true;
 }
 
 DBTAdapter::DBTAdapter()
 : debug_event(DBTEnv::getBooleanProperty("direct_bt.debug.adapter.event", false)),
-  mgmt(DBTManager::get(BTMode::NONE /* already initialized */)), dev_id(nullptr != mgmt.getDefaultAdapterInfo() ? 0 : -1)
+  rpaResolution(DBTEnv::getBooleanProperty("direct_bt.adapter.rpa", true)),
+  evictionPolicy(), scanScheduler(),
+  mgmt(DBTManager::get(BTMode::NONE /* already initialized */)),
+  advertiser(*this),
+  discoveredDevicesJournal( DBTEnv::getInt32Property("direct_bt.adapter.devices.journal", 1024, 1 /* min */, 65536 /* max */) ),
+  sightings( evictionPolicy.MAX_SIGHTINGS ),
+  dev_id(nullptr != mgmt.getDefaultAdapterInfo() ? 0 : -1)
 {
+    ts_last_eviction = 0;
+    scanPauseCount = 0;
+    workerTasks = 0;
+    workerRunning = false;
+    ts_discovery_start_req = 0;
+    ts_discovery_stop_req = 0;
+    ts_discovery_native_off = 0;
+    discoveryFilter = std::make_shared<const DiscoveryFilter>();
+    initDeviceMetrics();
     valid = validateDevInfo();
 }
 
 DBTAdapter::DBTAdapter(EUI48 &mac) 
 : debug_event(DBTEnv::getBooleanProperty("direct_bt.debug.adapter.event", false)),
-  mgmt(DBTManager::get(BTMode::NONE /* already initialized */)), dev_id(mgmt.findAdapterInfoIdx(mac))
+  rpaResolution(DBTEnv::getBooleanProperty("direct_bt.adapter.rpa", true)),
+  evictionPolicy(), scanScheduler(),
+  mgmt(DBTManager::get(BTMode::NONE /* already initialized */)),
+  advertiser(*this),
+  discoveredDevicesJournal( DBTEnv::getInt32Property("direct_bt.adapter.devices.journal", 1024, 1 /* min */, 65536 /* max */) ),
+  sightings( evictionPolicy.MAX_SIGHTINGS ),
+  dev_id(mgmt.findAdapterInfoIdx(mac))
 {
+    ts_last_eviction = 0;
+    scanPauseCount = 0;
+    workerTasks = 0;
+    workerRunning = false;
+    ts_discovery_start_req = 0;
+    ts_discovery_stop_req = 0;
+    ts_discovery_native_off = 0;
+    discoveryFilter = std::make_shared<const DiscoveryFilter>();
+    initDeviceMetrics();
     valid = validateDevInfo();
 }
 
 DBTAdapter::DBTAdapter(const int dev_id) 
 : debug_event(DBTEnv::getBooleanProperty("direct_bt.debug.adapter.event", false)),
-  mgmt(DBTManager::get(BTMode::NONE /* already initialized */)), dev_id(dev_id)
+  rpaResolution(DBTEnv::getBooleanProperty("direct_bt.adapter.rpa", true)),
+  evictionPolicy(), scanScheduler(),
+  mgmt(DBTManager::get(BTMode::NONE /* already initialized */)),
+  advertiser(*this),
+  discoveredDevicesJournal( DBTEnv::getInt32Property("direct_bt.adapter.devices.journal", 1024, 1 /* min */, 65536 /* max */) ),
+  sightings( evictionPolicy.MAX_SIGHTINGS ),
+  dev_id(dev_id)
 {
+    ts_last_eviction = 0;
+    scanPauseCount = 0;
+    workerTasks = 0;
+    workerRunning = false;
+    ts_discovery_start_req = 0;
+    ts_discovery_stop_req = 0;
+    ts_discovery_native_off = 0;
+    discoveryFilter = std::make_shared<const DiscoveryFilter>();
+    initDeviceMetrics();
     valid = validateDevInfo();
 }
 
@@ -227,9 +260,19 @@ DBTAdapter::~DBTAdapter() {
         DBG_PRINT("DBTAdapter removeMgmtEventCallback(DISCOVERING): %d callbacks", count);
         (void)count;
     }
+    stopKeepAlive();
+    stopWorker();
+    updateCoalescer.stop();
     statusListenerList.clear();
 
+    sessionResumption = false;
     poweredOff();
+    {
+        // release the recorded devices while the adapter is still intact
+        const std::lock_guard<std::mutex> lock(mtx_session); // RAII-style acquire and relinquish via destructor
+        sessionRecords.clear();
+        pendingSession = DBTSession();
+    }
 
     DBG_PRINT("DBTAdapter::dtor: XXX");
 }
@@ -242,14 +285,37 @@ void DBTAdapter::poweredOff() {
 
     if( nullptr != hci ) {
         hci->clearAllMgmtEventCallbacks();
+        // no more devices found while powering off, i.e. re-added after removeDiscoveredDevices()
+        hci->removeAdvertisingReportBatchCallback(bindMemberFunc(this, &DBTAdapter::advertisingReportBatchHCI));
     }
 
     // Removes all device references from the lists: connectedDevices, discoveredDevices, sharedDevices
     stopDiscovery();
+    poweringOff = true; // record the session of all devices, see recordSessionDevice()
     disconnectAllDevices();
+    poweringOff = false;
+    if( sessionResumption ) {
+        const uint64_t t0 = getCurrentMilliseconds();
+        const std::lock_guard<std::mutex> lock(mtx_session); // RAII-style acquire and relinquish via destructor
+        pendingSession = DBTSession();
+        pendingSession.timestamp = t0;
+        for(auto it = sessionRecords.begin(); it != sessionRecords.end(); it++) {
+            if( it->second.timestamp + sessionWindowMS >= t0 ) {
+                pendingSession.devices.push_back(it->second);
+            }
+        }
+        sessionRecords.clear();
+        DBG_PRINT("DBTAdapter::poweredOff: Recorded %s", pendingSession.toString().c_str());
+    }
+    advertiser.close();
     closeHCI();
     removeDiscoveredDevices();
-    sharedDevices.clear();
+    {
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
+        sharedDevices.clear();
+        sharedDevicesIndex.clear();
+    }
+    updateDeviceMetrics();
 
     currentNativeScanType = ScanType::NONE;
     currentMetaScanType = ScanType::NONE;
@@ -259,8 +325,8 @@ void DBTAdapter::poweredOff() {
 
 void DBTAdapter::printSharedPtrListOfDevices() {
     const std::lock_guard<std::recursive_mutex> lock0(mtx_connectedDevices);
-    const std::lock_guard<std::recursive_mutex> lock1(mtx_discoveredDevices);
-    const std::lock_guard<std::recursive_mutex> lock2(mtx_sharedDevices);
+    const std::lock_guard<DBTRecursiveMutex> lock1(mtx_discoveredDevices);
+    const std::lock_guard<DBTRecursiveMutex> lock2(mtx_sharedDevices);
 
     printSharedPtrList("SharedDevices", sharedDevices);
     printSharedPtrList("DiscoveredDevices", discoveredDevices);
@@ -311,21 +377,262 @@ bool DBTAdapter::removeDeviceFromWhitelist(const EUI48 &address, const BDAddress
     return mgmt.removeDeviceFromWhitelist(dev_id, address, address_type);
 }
 
+std::string AutoConnectStats::toString() const {
+    return "AutoConnect["+address.toString()+", "+getBDAddressTypeString(addressType)+", connected "+std::to_string(connected)+
+           ", count "+std::to_string(connectCount)+", latency[last "+std::to_string(lastLatencyMS)+", avg "+std::to_string(getAverageLatencyMS())+
+           ", max "+std::to_string(maxLatencyMS)+"]ms]";
+}
+
+bool DBTAdapter::addAutoConnectDevice(const EUI48 &address, const BDAddressType address_type,
+                                      const uint16_t conn_interval_min, const uint16_t conn_interval_max,
+                                      const uint16_t conn_latency, const uint16_t timeout) {
+    if( BDAddressType::BDADDR_LE_PUBLIC != address_type && BDAddressType::BDADDR_LE_RANDOM != address_type ) {
+        ERR_PRINT("DBTAdapter::addAutoConnectDevice: Not an LE address type %s: %s",
+                getBDAddressTypeString(address_type).c_str(), address.toString().c_str());
+        return false;
+    }
+    const std::lock_guard<std::mutex> lock(mtx_autoConnect); // RAII-style acquire and relinquish via destructor
+    const BDAddressKey key(address, address_type);
+    if( autoConnectDevices.end() != autoConnectDevices.find(key) ) {
+        return true;
+    }
+    if( !addDeviceToWhitelist(address, address_type, HCIWhitelistConnectType::HCI_AUTO_CONN_ALWAYS,
+                              conn_interval_min, conn_interval_max, conn_latency, timeout) ) {
+        return false;
+    }
+    AutoConnectStats stats(address, address_type, getCurrentMilliseconds());
+    stats.connected = nullptr != findConnectedDevice(address, address_type);
+    autoConnectDevices.insert( std::make_pair(key, stats) );
+    return true;
+}
+
+bool DBTAdapter::removeAutoConnectDevice(const EUI48 &address, const BDAddressType address_type) {
+    const std::lock_guard<std::mutex> lock(mtx_autoConnect); // RAII-style acquire and relinquish via destructor
+    if( 0 == autoConnectDevices.erase(BDAddressKey(address, address_type)) ) {
+        return false;
+    }
+    if( !removeDeviceFromWhitelist(address, address_type) ) {
+        WARN_PRINT("DBTAdapter::removeAutoConnectDevice: Removing %s from whitelist failed", address.toString().c_str());
+    }
+    return true;
+}
+
+int DBTAdapter::removeAllAutoConnectDevices() {
+    const std::lock_guard<std::mutex> lock(mtx_autoConnect); // RAII-style acquire and relinquish via destructor
+    const int count = autoConnectDevices.size();
+    for(auto it = autoConnectDevices.begin(); it != autoConnectDevices.end(); ++it) {
+        if( !removeDeviceFromWhitelist(it->first.address, it->first.addressType) ) {
+            WARN_PRINT("DBTAdapter::removeAllAutoConnectDevices: Removing %s from whitelist failed", it->first.address.toString().c_str());
+        }
+    }
+    autoConnectDevices.clear();
+    return count;
+}
+
+std::vector<AutoConnectStats> DBTAdapter::getAutoConnectStats() {
+    const std::lock_guard<std::mutex> lock(mtx_autoConnect); // RAII-style acquire and relinquish via destructor
+    std::vector<AutoConnectStats> res;
+    res.reserve(autoConnectDevices.size());
+    for(auto it = autoConnectDevices.begin(); it != autoConnectDevices.end(); ++it) {
+        res.push_back(it->second);
+    }
+    return res;
+}
+
+void DBTAdapter::autoConnectChanged(const DBTDevice & device, const bool connected, const uint64_t timestamp) {
+    const std::lock_guard<std::mutex> lock(mtx_autoConnect); // RAII-style acquire and relinquish via destructor
+    if( autoConnectDevices.empty() ) {
+        return;
+    }
+    auto it = autoConnectDevices.find(getDeviceKey(device));
+    if( autoConnectDevices.end() == it || it->second.connected == connected ) {
+        return;
+    }
+    AutoConnectStats & s = it->second;
+    s.connected = connected;
+    if( connected ) {
+        s.lastLatencyMS = timestamp > s.ts_lost ? timestamp - s.ts_lost : 0;
+        s.maxLatencyMS = std::max(s.maxLatencyMS, s.lastLatencyMS);
+        s.sumLatencyMS += s.lastLatencyMS;
+        s.connectCount++;
+        COND_PRINT(debug_event, "DBTAdapter::autoConnectChanged: Reconnected %s", s.toString().c_str());
+    } else {
+        s.ts_lost = timestamp;
+    }
+}
+
+std::string DiscoveryStats::toString() const {
+    return "DiscoveryStats[start "+std::to_string(lastStartMS)+", stop "+std::to_string(lastStopMS)+
+           ", restart[count "+std::to_string(restartCount)+", last "+std::to_string(lastRestartMS)+
+           ", avg "+std::to_string(getAverageRestartMS())+", max "+std::to_string(maxRestartMS)+"]]ms";
+}
+
+void DBTAdapter::postWorkerTask(const WorkerTask task) {
+    const std::lock_guard<std::mutex> lock(mtx_worker); // RAII-style acquire and relinquish via destructor
+    workerTasks |= static_cast<uint32_t>(task);
+    if( !workerRunning ) {
+        if( worker.joinable() ) {
+            worker.join(); // previously stopped, not from within the worker
+        }
+        workerRunning = true;
+        worker = std::thread(&DBTAdapter::workerImpl, this);
+    } else {
+        cv_worker.notify_all();
+    }
+}
+
+void DBTAdapter::workerImpl() {
+    std::unique_lock<std::mutex> lock(mtx_worker); // RAII-style acquire and relinquish via destructor
+    while( workerRunning ) {
+        if( 0 == workerTasks ) {
+            cv_worker.wait(lock);
+            continue;
+        }
+        const uint32_t tasks = workerTasks;
+        workerTasks = 0;
+        lock.unlock();
+        if( 0 != ( tasks & static_cast<uint32_t>(WorkerTask::POWERED_OFF) ) ) {
+            poweredOff();
+        }
+        if( 0 != ( tasks & static_cast<uint32_t>(WorkerTask::CHECK_SCAN_PARAMETER) ) ) {
+            checkScanParameter();
+        }
+        if( 0 != ( tasks & static_cast<uint32_t>(WorkerTask::START_DISCOVERY) ) ) {
+            startDiscoveryBackground();
+        }
+        if( 0 != ( tasks & static_cast<uint32_t>(WorkerTask::RESUME_SESSION) ) ) {
+            resumePendingSession();
+        }
+        if( 0 != ( tasks & static_cast<uint32_t>(WorkerTask::KEEP_ALIVE) ) ) {
+            keepAliveNextDevice();
+        }
+        lock.lock();
+    }
+}
+
+bool DBTAdapter::startKeepAlive(const KeepAliveMode mode, const uint32_t intervalMS) {
+    if( 100 > intervalMS ) {
+        ERR_PRINT("DBTAdapter::startKeepAlive: interval %u ms < 100 ms: %s", intervalMS, toString().c_str());
+        return false;
+    }
+    TimerWheel::TimerID oldId;
+    {
+        // replace a running timer within one critical section, i.e. concurrent calls leave exactly one timer scheduled
+        const std::lock_guard<std::mutex> lock(mtx_keepAlive); // RAII-style acquire and relinquish via destructor
+        oldId = keepAliveTimer;
+        keepAliveMode = mode;
+        keepAliveIntervalMS = intervalMS;
+        keepAliveTimer = mgmt.getTimerWheel().schedule(getKeepAliveDelay(), [this]() -> uint32_t {
+            postWorkerTask(WorkerTask::KEEP_ALIVE);
+            return getKeepAliveDelay();
+        });
+    }
+    if( 0 != oldId ) {
+        // w/o holding mtx_keepAlive, see stopKeepAlive()
+        mgmt.getTimerWheel().cancel(oldId, true /* wait */);
+    }
+    DBG_PRINT("DBTAdapter::startKeepAlive: %s, interval %u ms", getKeepAliveModeString(mode).c_str(), intervalMS);
+    return true;
+}
+
+void DBTAdapter::stopKeepAlive() {
+    TimerWheel::TimerID id;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_keepAlive); // RAII-style acquire and relinquish via destructor
+        id = keepAliveTimer;
+        keepAliveTimer = 0;
+    }
+    if( 0 != id ) {
+        // w/o holding mtx_keepAlive, as a running callback may acquire it
+        mgmt.getTimerWheel().cancel(id, true /* wait */);
+    }
+}
+
+bool DBTAdapter::isKeepAliveRunning() {
+    const std::lock_guard<std::mutex> lock(mtx_keepAlive); // RAII-style acquire and relinquish via destructor
+    return 0 != keepAliveTimer;
+}
+
+uint32_t DBTAdapter::getKeepAliveDelay() {
+    size_t count;
+    {
+        const std::lock_guard<std::recursive_mutex> lock(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
+        count = connectedDevices.size();
+    }
+    // keepAliveIntervalMS is atomic, as a replaced timer's callback may still run while startKeepAlive() sets it
+    return std::max<uint32_t>(1, keepAliveIntervalMS.load() / std::max<size_t>(1, count));
+}
+
+void DBTAdapter::keepAliveNextDevice() {
+    std::shared_ptr<DBTDevice> device;
+    KeepAliveMode mode;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_keepAlive); // RAII-style acquire and relinquish via destructor
+        if( 0 == keepAliveTimer ) {
+            return;
+        }
+        mode = keepAliveMode;
+        const std::lock_guard<std::recursive_mutex> lock2(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
+        if( 0 == connectedDevices.size() ) {
+            return;
+        }
+        device = connectedDevices[ keepAliveNext++ % connectedDevices.size() ];
+    }
+    if( !device->ping(mode) ) {
+        DBG_PRINT("DBTAdapter::keepAliveNextDevice: %s ping failed: %s", getKeepAliveModeString(mode).c_str(), device->toString().c_str());
+    }
+}
+
+void DBTAdapter::stopWorker() {
+    {
+        const std::lock_guard<std::mutex> lock(mtx_worker); // RAII-style acquire and relinquish via destructor
+        workerRunning = false;
+        workerTasks = 0;
+        cv_worker.notify_all();
+    }
+    if( worker.joinable() ) {
+        if( worker.get_id() == std::this_thread::get_id() ) {
+            worker.detach(); // stopped from a task
+        } else {
+            worker.join();
+        }
+    }
+}
+
+void DBTAdapter::discoveringChanged(const bool enabled, const uint64_t timestamp) {
+    const std::lock_guard<std::mutex> lock(mtx_discoveryStats); // RAII-style acquire and relinquish via destructor
+    if( enabled ) {
+        if( 0 < ts_discovery_start_req ) {
+            discoveryStats.lastStartMS = timestamp > ts_discovery_start_req ? timestamp - ts_discovery_start_req : 0;
+            ts_discovery_start_req = 0;
+        } else if( 0 < ts_discovery_native_off ) {
+            const uint64_t d = timestamp > ts_discovery_native_off ? timestamp - ts_discovery_native_off : 0;
+            discoveryStats.restartCount++;
+            discoveryStats.lastRestartMS = d;
+            discoveryStats.maxRestartMS = std::max(discoveryStats.maxRestartMS, d);
+            discoveryStats.sumRestartMS += d;
+        }
+        ts_discovery_native_off = 0;
+    } else {
+        if( 0 < ts_discovery_stop_req ) {
+            discoveryStats.lastStopMS = timestamp > ts_discovery_stop_req ? timestamp - ts_discovery_stop_req : 0;
+            ts_discovery_stop_req = 0;
+            ts_discovery_native_off = 0;
+        } else if( keepDiscoveringAlive ) {
+            ts_discovery_native_off = timestamp;
+        }
+    }
+}
+
 bool DBTAdapter::addStatusListener(std::shared_ptr<AdapterStatusListener> l) {
     checkValidAdapter();
     if( nullptr == l ) {
         throw IllegalArgumentException("DBTAdapterStatusListener ref is null", E_FILE_LINE);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_statusListenerList); // RAII-style acquire and relinquish via destructor
-    for(auto it = statusListenerList.begin(); it != statusListenerList.end(); ) {
-        if ( **it == *l ) {
-            return false; // already included
-        } else {
-            ++it;
-        }
-    }
-    statusListenerList.push_back(l);
-    return true;
+    return statusListenerList.push_back_unique(l,
+            [](const std::shared_ptr<AdapterStatusListener> &a, const std::shared_ptr<AdapterStatusListener> &b) {
+                return *a == *b;
+            });
 }
 
 bool DBTAdapter::removeStatusListener(std::shared_ptr<AdapterStatusListener> l) {
@@ -333,16 +640,7 @@ bool DBTAdapter::removeStatusListener(std::shared_ptr<AdapterStatusListener> l)
     if( nullptr == l ) {
         throw IllegalArgumentException("DBTAdapterStatusListener ref is null", E_FILE_LINE);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_statusListenerList); // RAII-style acquire and relinquish via destructor
-    for(auto it = statusListenerList.begin(); it != statusListenerList.end(); ) {
-        if ( **it == *l ) {
-            it = statusListenerList.erase(it);
-            return true;
-        } else {
-            ++it;
-        }
-    }
-    return false;
+    return removeStatusListener( l.get() );
 }
 
 bool DBTAdapter::removeStatusListener(const AdapterStatusListener * l) {
@@ -350,23 +648,19 @@ bool DBTAdapter::removeStatusListener(const AdapterStatusListener * l) {
     if( nullptr == l ) {
         throw IllegalArgumentException("DBTAdapterStatusListener ref is null", E_FILE_LINE);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_statusListenerList); // RAII-style acquire and relinquish via destructor
-    for(auto it = statusListenerList.begin(); it != statusListenerList.end(); ) {
-        if ( **it == *l ) {
-            it = statusListenerList.erase(it);
-            return true;
-        } else {
-            ++it;
-        }
-    }
-    return false;
+    updateCoalescer.removeListener(l);
+    return 0 < statusListenerList.erase_matching(false /* all */,
+            [l](const std::shared_ptr<AdapterStatusListener> &it) {
+                return *it == *l;
+            });
 }
 
 int DBTAdapter::removeAllStatusListener() {
     checkValidAdapter();
-    const std::lock_guard<std::recursive_mutex> lock(mtx_statusListenerList); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<std::recursive_mutex> lock(statusListenerList.get_write_mutex()); // RAII-style acquire and relinquish via destructor
     int count = statusListenerList.size();
     statusListenerList.clear();
+    updateCoalescer.clear();
     return count;
 }
 
@@ -417,9 +711,8 @@ bool DBTAdapter::startDiscovery(const bool keepAlive, const HCILEOwnAddressType
         checkDiscoveryState();
         return true;
     }
-    (void)own_mac_type;
-    (void)le_scan_interval;
-    (void)le_scan_window;
+    scanRequested = ScanParameter(false /* passive */, le_scan_interval, le_scan_window);
+    scanOwnAddressType = own_mac_type;
 
     DBG_PRINT("DBTAdapter::startDiscovery: Start: keepAlive %d -> %d, currentScanType[native %s, meta %s] ...",
             keepDiscoveringAlive.load(), keepAlive,
@@ -427,6 +720,11 @@ bool DBTAdapter::startDiscovery(const bool keepAlive, const HCILEOwnAddressType
 
     removeDiscoveredDevices();
     keepDiscoveringAlive = keepAlive;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_discoveryStats); // RAII-style acquire and relinquish via destructor
+        ts_discovery_start_req = getCurrentMilliseconds();
+        ts_discovery_stop_req = 0;
+    }
 
     std::shared_ptr<HCIHandler> hci = getHCI();
     if( nullptr == hci ) {
@@ -434,7 +732,7 @@ bool DBTAdapter::startDiscovery(const bool keepAlive, const HCILEOwnAddressType
         return false;
     }
 
-    HCIStatusCode status = hci->le_set_scan_param();
+    HCIStatusCode status = applyScanParameter(*hci);
     if( HCIStatusCode::SUCCESS != status ) {
         ERR_PRINT("DBTAdapter::startDiscovery: le_set_scan_param failed: %s", getHCIStatusCodeString(status).c_str());
     }
@@ -459,12 +757,18 @@ bool DBTAdapter::startDiscovery(const bool keepAlive, const HCILEOwnAddressType
 
 void DBTAdapter::startDiscoveryBackground() {
     const std::lock_guard<std::recursive_mutex> lock(mtx_discovery); // RAII-style acquire and relinquish via destructor
-    if( ScanType::NONE == currentNativeScanType && keepDiscoveringAlive ) { // still?
+    if( ScanType::NONE == currentNativeScanType && keepDiscoveringAlive && 0 == scanPauseCount ) { // still and not paused?
         std::shared_ptr<HCIHandler> hci = getHCI();
         if( nullptr == hci ) {
             ERR_PRINT("DBTAdapter::startDiscoveryBackground: HCI not available: %s", toString().c_str());
             return;
         }
+        if( scanScheduler.adapt(scanRequested, getConnectedDeviceCount()) != scanCurrent ) {
+            HCIStatusCode status = applyScanParameter(*hci);
+            if( HCIStatusCode::SUCCESS != status ) {
+                ERR_PRINT("DBTAdapter::startDiscoveryBackground: le_set_scan_param failed: %s", getHCIStatusCodeString(status).c_str());
+            }
+        }
         // Will issue 'mgmtEvDeviceDiscoveringHCI(..)' immediately, don't change current scan-type state here
         HCIStatusCode status = hci->le_enable_scan(true /* enable */);
         if( HCIStatusCode::SUCCESS != status ) {
@@ -474,6 +778,77 @@ void DBTAdapter::startDiscoveryBackground() {
     }
 }
 
+HCIStatusCode DBTAdapter::applyScanParameter(HCIHandler & hci) {
+    const ScanParameter p = scanScheduler.adapt(scanRequested, getConnectedDeviceCount());
+    HCIStatusCode status = hci.le_set_scan_param(p.active, scanOwnAddressType, p.interval, p.window);
+    if( HCIStatusCode::SUCCESS == status ) {
+        scanCurrent = p;
+    }
+    DBG_PRINT("DBTAdapter::applyScanParameter: %s -> %s: %s", scanRequested.toString().c_str(), p.toString().c_str(),
+            getHCIStatusCodeString(status).c_str());
+    return status;
+}
+
+void DBTAdapter::checkScanParameter() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx_discovery); // RAII-style acquire and relinquish via destructor
+    if( ScanType::NONE == currentNativeScanType || !keepDiscoveringAlive || 0 < scanPauseCount ) {
+        return;
+    }
+    if( scanScheduler.adapt(scanRequested, getConnectedDeviceCount()) == scanCurrent ) {
+        return;
+    }
+    std::shared_ptr<HCIHandler> hci = getHCI();
+    if( nullptr == hci ) {
+        return;
+    }
+    // Will issue 'mgmtEvDeviceDiscoveringHCI(..)', restarting the kept-alive discovery via startDiscoveryBackground()
+    HCIStatusCode status = hci->le_enable_scan(false /* enable */);
+    if( HCIStatusCode::SUCCESS != status ) {
+        ERR_PRINT("DBTAdapter::checkScanParameter: le_enable_scan failed: %s", getHCIStatusCodeString(status).c_str());
+    }
+}
+
+bool DBTAdapter::pauseDiscoveryForConnect() {
+    if( !scanScheduler.PAUSE_ON_CONNECT ) {
+        return false;
+    }
+    const std::lock_guard<std::recursive_mutex> lock(mtx_discovery); // RAII-style acquire and relinquish via destructor
+    if( !keepDiscoveringAlive || ScanType::NONE == currentMetaScanType ) {
+        return false;
+    }
+    if( 0 == scanPauseCount++ && ScanType::NONE != currentNativeScanType ) {
+        std::shared_ptr<HCIHandler> hci = getHCI();
+        if( nullptr != hci ) {
+            // Will issue 'mgmtEvDeviceDiscoveringHCI(..)', startDiscoveryBackground() won't restart while paused
+            HCIStatusCode status = hci->le_enable_scan(false /* enable */);
+            if( HCIStatusCode::SUCCESS != status ) {
+                ERR_PRINT("DBTAdapter::pauseDiscoveryForConnect: le_enable_scan failed: %s", getHCIStatusCodeString(status).c_str());
+            }
+        }
+    }
+    DBG_PRINT("DBTAdapter::pauseDiscoveryForConnect: paused %d", scanPauseCount.load());
+    return true;
+}
+
+void DBTAdapter::resumeDiscoveryAfterConnect() {
+    int count = scanPauseCount.load();
+    while( 0 < count && !scanPauseCount.compare_exchange_weak(count, count-1) ) { }
+    DBG_PRINT("DBTAdapter::resumeDiscoveryAfterConnect: paused %d -> %d", count, std::max(0, count-1));
+    if( 1 == count ) {
+        // Off-thread, as we may be called from the HCI reader thread
+        postWorkerTask(WorkerTask::START_DISCOVERY);
+    }
+}
+
+void DBTAdapter::connectCompleted(const std::shared_ptr<DBTDevice> & device) {
+    if( nullptr != device && device->discoveryPaused.exchange(false) ) {
+        resumeDiscoveryAfterConnect(); // applies the adapted scan parameter
+    } else if( scanScheduler.isAdaptive() ) {
+        // Off-thread, as we may be called from the HCI reader thread
+        postWorkerTask(WorkerTask::CHECK_SCAN_PARAMETER);
+    }
+}
+
 bool DBTAdapter::stopDiscovery() {
     const std::lock_guard<std::recursive_mutex> lock(mtx_discovery); // RAII-style acquire and relinquish via destructor
     /**
@@ -514,6 +889,11 @@ bool DBTAdapter::stopDiscovery() {
         return false;
     }
 
+    {
+        const std::lock_guard<std::mutex> lock(mtx_discoveryStats); // RAII-style acquire and relinquish via destructor
+        ts_discovery_stop_req = getCurrentMilliseconds();
+        ts_discovery_start_req = 0;
+    }
     bool res;
     if( discoveryTempDisabled ) {
         // meta state transition [4] -> [5], w/o native disabling
@@ -545,24 +925,28 @@ bool DBTAdapter::stopDiscovery() {
 }
 
 std::shared_ptr<DBTDevice> DBTAdapter::findDiscoveredDevice (EUI48 const & mac, const BDAddressType macType) {
-    const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTAdapter*>(this)->mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
-    return findDevice(discoveredDevices, mac, macType);
+    return discoveredDevicesIndex.get(BDAddressKey(mac, macType));
 }
 
 bool DBTAdapter::addDiscoveredDevice(std::shared_ptr<DBTDevice> const &device) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
-    if( nullptr != findDevice(discoveredDevices, *device) ) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    if( !discoveredDevicesIndex.put(getDeviceKey(*device), device) ) {
         // already discovered
         return false;
     }
     discoveredDevices.push_back(device);
+    discoveredDevicesJournal.added(device);
     return true;
 }
 
 bool DBTAdapter::removeDiscoveredDevice(const DBTDevice & device) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    if( !discoveredDevicesIndex.remove(getDeviceKey(device)) ) {
+        return false;
+    }
     for (auto it = discoveredDevices.begin(); it != discoveredDevices.end(); ) {
         if ( nullptr != *it && device == **it ) {
+            discoveredDevicesJournal.removed(*it);
             it = discoveredDevices.erase(it);
             return true;
         } else {
@@ -574,38 +958,69 @@ bool DBTAdapter::removeDiscoveredDevice(const DBTDevice & device) {
 
 
 int DBTAdapter::removeDiscoveredDevices() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    {
+        // mtx_hci before mtx_discoveredDevices as in poweredOff(): re-discover the removed devices via full advertising reports
+        const std::lock_guard<std::recursive_mutex> lock(mtx_hci); // RAII-style acquire and relinquish via destructor
+        if( nullptr != hci ) {
+            hci->clearAdvDedupCache();
+        }
+    }
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
     int res = discoveredDevices.size();
     discoveredDevices.clear();
+    discoveredDevicesIndex.clear();
+    discoveredDevicesJournal.reset();
+    sightings.clear();
+    updateDeviceMetrics();
     return res;
 }
 
 std::vector<std::shared_ptr<DBTDevice>> DBTAdapter::getDiscoveredDevices() const {
-    const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTAdapter*>(this)->mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(const_cast<DBTAdapter*>(this)->mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
     std::vector<std::shared_ptr<DBTDevice>> res = discoveredDevices;
     return res;
 }
 
+std::vector<std::shared_ptr<DBTDevice>> DBTAdapter::getDiscoveredDevices(uint64_t & version) const {
+    const std::lock_guard<DBTRecursiveMutex> lock(const_cast<DBTAdapter*>(this)->mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    version = discoveredDevicesJournal.getVersion();
+    std::vector<std::shared_ptr<DBTDevice>> res = discoveredDevices;
+    return res;
+}
+
+bool DBTAdapter::getDiscoveredDevicesDelta(const uint64_t since, uint64_t & version,
+                                           std::vector<std::shared_ptr<DBTDevice>> & added,
+                                           std::vector<std::shared_ptr<DBTDevice>> & removed) const
+{
+    const std::lock_guard<DBTRecursiveMutex> lock(const_cast<DBTAdapter*>(this)->mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+    version = discoveredDevicesJournal.getVersion();
+    return discoveredDevicesJournal.getChanges(since, added, removed);
+}
+
 bool DBTAdapter::addSharedDevice(std::shared_ptr<DBTDevice> const &device) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
-    if( nullptr != findDevice(sharedDevices, *device) ) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
+    if( !sharedDevicesIndex.put(getDeviceKey(*device), device) ) {
         // already shared
         return false;
     }
     sharedDevices.push_back(device);
+    updateDeviceMetrics();
     return true;
 }
 
 std::shared_ptr<DBTDevice> DBTAdapter::getSharedDevice(const DBTDevice & device) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
-    return findDevice(sharedDevices, device);
+    return sharedDevicesIndex.get(getDeviceKey(device));
 }
 
 void DBTAdapter::removeSharedDevice(const DBTDevice & device) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
+    if( !sharedDevicesIndex.remove(getDeviceKey(device)) ) {
+        return;
+    }
     for (auto it = sharedDevices.begin(); it != sharedDevices.end(); ) {
         if ( nullptr != *it && device == **it ) {
             it = sharedDevices.erase(it);
+            updateDeviceMetrics();
             return; // unique set
         } else {
             ++it;
@@ -614,8 +1029,190 @@ void DBTAdapter::removeSharedDevice(const DBTDevice & device) {
 }
 
 std::shared_ptr<DBTDevice> DBTAdapter::findSharedDevice (EUI48 const & mac, const BDAddressType macType) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
-    return findDevice(sharedDevices, mac, macType);
+    return sharedDevicesIndex.get(BDAddressKey(mac, macType));
+}
+
+bool DBTAdapter::setDiscoveryFilter(const DiscoveryFilter & filter, const bool useWhitelist) {
+    const std::lock_guard<std::mutex> lock(mtx_discoveryFilter); // RAII-style acquire and relinquish via destructor
+    bool res = true;
+    for(auto it = discoveryFilterWhitelist.begin(); it != discoveryFilterWhitelist.end(); ++it) {
+        if( !removeDeviceFromWhitelist(it->address, it->addressType) ) {
+            WARN_PRINT("DBTAdapter::setDiscoveryFilter: Removing %s from whitelist failed", it->address.toString().c_str());
+        }
+    }
+    discoveryFilterWhitelist.clear();
+
+    std::atomic_store(&discoveryFilter, std::shared_ptr<const DiscoveryFilter>(new DiscoveryFilter(filter)));
+
+    if( useWhitelist && filter.isAddressOnly() ) {
+        const std::unordered_set<BDAddressKey> & addresses = filter.getAddresses();
+        for(auto it = addresses.begin(); it != addresses.end(); ++it) {
+            if( isDeviceWhitelisted(it->address) ) {
+                continue; // user managed
+            }
+            if( addDeviceToWhitelist(it->address, it->addressType, HCIWhitelistConnectType::HCI_AUTO_CONN_REPORT) ) {
+                discoveryFilterWhitelist.push_back(*it);
+            } else {
+                res = false;
+            }
+        }
+    }
+    DBG_PRINT("DBTAdapter::setDiscoveryFilter: whitelisted %zd, res %d: %s",
+            discoveryFilterWhitelist.size(), res, filter.toString().c_str());
+    return res;
+}
+
+DeviceEvictionPolicy::DeviceEvictionPolicy()
+: MAX_DEVICES( DBTEnv::getInt32Property("direct_bt.adapter.devices.max", 0, 0, INT32_MAX) ),
+  DEVICE_TTL( DBTEnv::getInt32Property("direct_bt.adapter.devices.ttl", 0, 0, INT32_MAX) ),
+  NRPA_TTL( DBTEnv::getInt32Property("direct_bt.adapter.devices.ttl.nrpa", 0, 0, INT32_MAX) ),
+  SWEEP_INTERVAL( DBTEnv::getInt32Property("direct_bt.adapter.devices.sweep", 1000, 0, INT32_MAX) ),
+  MAX_SIGHTINGS( DBTEnv::getInt32Property("direct_bt.adapter.sightings.max", 0, 0, INT32_MAX) )
+{ }
+
+DeviceEvictionPolicy::DeviceEvictionPolicy(const int32_t maxDevices, const int32_t deviceTTL, const int32_t nrpaTTL, const int32_t sweepInterval,
+                                           const int32_t maxSightings)
+: MAX_DEVICES( std::max<int32_t>(0, maxDevices) ), DEVICE_TTL( std::max<int32_t>(0, deviceTTL) ),
+  NRPA_TTL( std::max<int32_t>(0, nrpaTTL) ), SWEEP_INTERVAL( std::max<int32_t>(0, sweepInterval) ),
+  MAX_SIGHTINGS( std::max<int32_t>(0, maxSightings) )
+{ }
+
+bool DeviceEvictionPolicy::isExpired(const DBTDevice & device, const uint64_t ts_now) const {
+    const int32_t ttl = getTTL(device.getBLERandomAddressType());
+    if( 0 >= ttl ) {
+        return false;
+    }
+    const uint64_t ts_last = device.getLastUpdateTimestamp();
+    return ts_now > ts_last && ts_now - ts_last > static_cast<uint64_t>(ttl);
+}
+
+std::string DeviceEvictionPolicy::toString() const {
+    return "DeviceEvictionPolicy[max "+std::to_string(MAX_DEVICES)+", ttl[device "+std::to_string(DEVICE_TTL)+
+           " ms, nrpa "+std::to_string(NRPA_TTL)+" ms], sweep "+std::to_string(SWEEP_INTERVAL)+" ms, sightings "+std::to_string(MAX_SIGHTINGS)+"]";
+}
+
+int DBTAdapter::evictDevices(const uint64_t ts_now) {
+    if( !evictionPolicy.isEnabled() ) {
+        return 0;
+    }
+    ts_last_eviction = ts_now;
+    const size_t maxDevices = static_cast<size_t>( evictionPolicy.MAX_DEVICES );
+    std::vector<std::shared_ptr<DBTDevice>> evicted; // released after relinquishing the locks
+    {
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+        size_t keptCount = 0; // connected
+        std::vector<std::shared_ptr<DBTDevice>> candidates; // not expired, but evictable
+        for(auto it = discoveredDevices.begin(); it != discoveredDevices.end(); ++it) {
+            std::shared_ptr<DBTDevice> & d = *it;
+            if( nullptr == d ) {
+                continue;
+            }
+            if( nullptr != connectedDevicesIndex.get(getDeviceKey(*d)) ) {
+                ++keptCount;
+            } else if( evictionPolicy.isExpired(*d, ts_now) ) {
+                evicted.push_back(d);
+            } else {
+                candidates.push_back(d);
+            }
+        }
+        if( 0 < maxDevices && keptCount + candidates.size() > maxDevices ) {
+            // evict the least recently updated candidates exceeding maxDevices
+            const size_t excess = std::min(candidates.size(), keptCount + candidates.size() - maxDevices);
+            std::nth_element(candidates.begin(), candidates.begin() + excess, candidates.end(),
+                    [](const std::shared_ptr<DBTDevice> & a, const std::shared_ptr<DBTDevice> & b) {
+                        return a->getLastUpdateTimestamp() < b->getLastUpdateTimestamp();
+                    });
+            evicted.insert(evicted.end(), candidates.begin(), candidates.begin() + excess);
+        }
+        if( evicted.size() > 0 ) {
+            for(auto it = evicted.begin(); it != evicted.end(); ++it) {
+                discoveredDevicesIndex.remove(getDeviceKey(**it));
+                discoveredDevicesJournal.removed(*it);
+            }
+            // erase evicted devices, preserving the discovery order
+            discoveredDevices.erase(std::remove_if(discoveredDevices.begin(), discoveredDevices.end(),
+                    [&](const std::shared_ptr<DBTDevice> & d) {
+                        return nullptr == d || nullptr == discoveredDevicesIndex.get(getDeviceKey(*d));
+                    }), discoveredDevices.end());
+        }
+    }
+    const int discoveredCount = evicted.size();
+    evicted.clear();
+    {
+        // Shared devices are referenced by sharedDevices and sharedDevicesIndex only, if not used elsewhere
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
+        size_t count = sharedDevices.size();
+        for(auto it = sharedDevices.begin(); it != sharedDevices.end(); ) {
+            std::shared_ptr<DBTDevice> & d = *it;
+            if( nullptr == d ) {
+                ++it;
+                continue;
+            }
+            const BDAddressKey key = getDeviceKey(*d);
+            if( 2 == d.use_count() &&
+                nullptr == connectedDevicesIndex.get(key) && nullptr == discoveredDevicesIndex.get(key) &&
+                ( evictionPolicy.isExpired(*d, ts_now) || ( 0 < maxDevices && count > maxDevices ) ) )
+            {
+                sharedDevicesIndex.remove(key);
+                evicted.push_back(d);
+                it = sharedDevices.erase(it);
+                --count;
+            } else {
+                ++it;
+            }
+        }
+    }
+    const int sightingCount = sightings.evictExpired(ts_now, evictionPolicy.DEVICE_TTL, evictionPolicy.NRPA_TTL);
+    const int res = discoveredCount + evicted.size();
+    if( 0 < res || 0 < sightingCount ) {
+        updateDeviceMetrics();
+    }
+    COND_PRINT(debug_event, "DBTAdapter::evictDevices: Evicted discovered %d, shared %zd, sightings %d: %s",
+            discoveredCount, evicted.size(), sightingCount, evictionPolicy.toString().c_str());
+    return res;
+}
+
+void DBTAdapter::initDeviceMetrics() {
+    DBTMetrics & metrics = DBTMetrics::get();
+    if( metrics.isEnabled() ) {
+        const std::string id = std::to_string(dev_id);
+        metricDevices = &metrics.getGauge("adapter_devices", "dev_id", id);
+        metricDeviceBytes = &metrics.getGauge("adapter_device_bytes", "dev_id", id);
+        metricSightings = &metrics.getGauge("adapter_sightings", "dev_id", id);
+        metricSightingBytes = &metrics.getGauge("adapter_sighting_bytes", "dev_id", id);
+    }
+}
+
+void DBTAdapter::updateDeviceMetrics() {
+    if( nullptr == metricDevices ) {
+        return;
+    }
+    size_t deviceCount;
+    {
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_sharedDevices); // RAII-style acquire and relinquish via destructor
+        deviceCount = sharedDevices.size();
+    }
+    // fixed footprint of each shared device and its list entry, excluding heap allocated names, data and services
+    metricDevices->set( static_cast<int64_t>(deviceCount) );
+    metricDeviceBytes->set( static_cast<int64_t>( deviceCount * ( sizeof(DBTDevice) + sizeof(std::shared_ptr<DBTDevice>) ) ) );
+    metricSightings->set( static_cast<int64_t>( sightings.size() ) );
+    metricSightingBytes->set( static_cast<int64_t>( sightings.getMemoryFootprint() ) );
+}
+
+void DBTAdapter::checkDeviceEviction(const uint64_t ts_now) {
+    if( !evictionPolicy.isEnabled() ) {
+        return;
+    }
+    const bool sweep = ( 0 < evictionPolicy.DEVICE_TTL || 0 < evictionPolicy.NRPA_TTL ) &&
+                       ts_now - ts_last_eviction >= static_cast<uint64_t>(evictionPolicy.SWEEP_INTERVAL);
+    bool exceeded = false;
+    if( 0 < evictionPolicy.MAX_DEVICES ) {
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
+        exceeded = discoveredDevices.size() > static_cast<size_t>(evictionPolicy.MAX_DEVICES);
+    }
+    if( sweep || exceeded ) {
+        evictDevices(ts_now);
+    }
 }
 
 std::string DBTAdapter::toString() const {
@@ -638,12 +1235,11 @@ std::string DBTAdapter::toString() const {
 
 // *************************************************
 
-bool DBTAdapter::mgmtEvDeviceDiscoveringHCI(std::shared_ptr<MgmtEvent> e) {
-    return mgmtEvDeviceDiscoveringMgmt(e);
+bool DBTAdapter::mgmtEvDeviceDiscoveringHCI(const MgmtEvtDiscovering &event) {
+    return mgmtEvDeviceDiscoveringMgmt(event);
 }
 
-bool DBTAdapter::mgmtEvDeviceDiscoveringMgmt(std::shared_ptr<MgmtEvent> e) {
-    const MgmtEvtDiscovering &event = *static_cast<const MgmtEvtDiscovering *>(e.get());
+bool DBTAdapter::mgmtEvDeviceDiscoveringMgmt(const MgmtEvtDiscovering &event) {
     const bool enabled = event.getEnabled();
     if( enabled ) {
         // also catches case where discovery got enabled w/o user issuing startDiscovery(..)
@@ -655,14 +1251,15 @@ bool DBTAdapter::mgmtEvDeviceDiscoveringMgmt(std::shared_ptr<MgmtEvent> e) {
             currentMetaScanType = ScanType::NONE;
         }
     }
+    discoveringChanged(enabled, event.getTimestamp());
     COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceDiscovering(dev_id %d, keepDiscoveringAlive %d, currentScanType[native %s, meta %s]): %s",
         dev_id, keepDiscoveringAlive.load(),
         getScanTypeString(currentNativeScanType).c_str(), getScanTypeString(currentMetaScanType).c_str(),
-        e->toString().c_str());
+        event.toString().c_str());
     checkDiscoveryState();
 
     int i=0;
-    for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
         try {
             l->discoveringChanged(*this, enabled, keepDiscoveringAlive, event.getTimestamp());
         } catch (std::exception &e) {
@@ -673,15 +1270,13 @@ bool DBTAdapter::mgmtEvDeviceDiscoveringMgmt(std::shared_ptr<MgmtEvent> e) {
         i++;
     });
     if( ScanType::NONE == currentNativeScanType && keepDiscoveringAlive ) {
-        std::thread bg(&DBTAdapter::startDiscoveryBackground, this);
-        bg.detach();
+        postWorkerTask(WorkerTask::START_DISCOVERY);
     }
     return true;
 }
 
-bool DBTAdapter::mgmtEvNewSettingsMgmt(std::shared_ptr<MgmtEvent> e) {
-    COND_PRINT(debug_event, "DBTAdapter::EventCB:NewSettings: %s", e->toString().c_str());
-    const MgmtEvtNewSettings &event = *static_cast<const MgmtEvtNewSettings *>(e.get());
+bool DBTAdapter::mgmtEvNewSettingsMgmt(const MgmtEvtNewSettings &event) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:NewSettings: %s", event.toString().c_str());
     AdapterSetting old_setting = adapterInfo->getCurrentSetting();
     AdapterSetting changes = adapterInfo->setCurrentSetting(event.getSettings());
     COND_PRINT(debug_event, "DBTAdapter::EventCB:NewSettings: %s -> %s, changes %s",
@@ -690,7 +1285,7 @@ bool DBTAdapter::mgmtEvNewSettingsMgmt(std::shared_ptr<MgmtEvent> e) {
             getAdapterSettingsString(changes).c_str() );
 
     int i=0;
-    for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
         try {
             l->adapterSettingsChanged(*this, old_setting, adapterInfo->getCurrentSetting(), changes, event.getTimestamp());
         } catch (std::exception &e) {
@@ -703,15 +1298,16 @@ bool DBTAdapter::mgmtEvNewSettingsMgmt(std::shared_ptr<MgmtEvent> e) {
 
     if( !isPowered() ) {
         // Adapter has been powered off, close connections and cleanup off-thread.
-        std::thread bg(&DBTAdapter::poweredOff, this);
-        bg.detach();
+        postWorkerTask(WorkerTask::POWERED_OFF);
+    } else if( isAdapterSettingSet(changes, AdapterSetting::POWERED) && sessionResumption ) {
+        // Powered on again, resume the session recorded at power off off-thread.
+        postWorkerTask(WorkerTask::RESUME_SESSION);
     }
     return true;
 }
 
-bool DBTAdapter::mgmtEvLocalNameChangedMgmt(std::shared_ptr<MgmtEvent> e) {
-    COND_PRINT(debug_event, "DBTAdapter::EventCB:LocalNameChanged: %s", e->toString().c_str());
-    const MgmtEvtLocalNameChanged &event = *static_cast<const MgmtEvtLocalNameChanged *>(e.get());
+bool DBTAdapter::mgmtEvLocalNameChangedMgmt(const MgmtEvtLocalNameChanged &event) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:LocalNameChanged: %s", event.toString().c_str());
     std::string old_name = localName.getName();
     std::string old_shortName = localName.getShortName();
     bool nameChanged = old_name != event.getName();
@@ -732,10 +1328,10 @@ bool DBTAdapter::mgmtEvLocalNameChangedMgmt(std::shared_ptr<MgmtEvent> e) {
 
 void DBTAdapter::sendDeviceUpdated(std::string cause, std::shared_ptr<DBTDevice> device, uint64_t timestamp, EIRDataType updateMask) {
     int i=0;
-    for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
         try {
             if( l->matchDevice(*device) ) {
-                l->deviceUpdated(device, updateMask, timestamp);
+                updateCoalescer.update(l, l->getDeviceUpdatePolicy(), device, updateMask, timestamp);
             }
         } catch (std::exception &e) {
             ERR_PRINT("DBTAdapter::sendDeviceUpdated-CBs (%s) %d/%zd: %s of %s: Caught exception %s",
@@ -746,31 +1342,32 @@ void DBTAdapter::sendDeviceUpdated(std::string cause, std::shared_ptr<DBTDevice>
     });
 }
 
-bool DBTAdapter::mgmtEvDeviceConnectedHCI(std::shared_ptr<MgmtEvent> e) {
-    const MgmtEvtDeviceConnected &event = *static_cast<const MgmtEvtDeviceConnected *>(e.get());
+bool DBTAdapter::mgmtEvDeviceConnectedHCI(const MgmtEvtDeviceConnected &event) {
+    const BDAddressKey id = resolveIdentity(event.getAddress(), event.getAddressType());
     EInfoReport ad_report;
     {
         ad_report.setSource(EInfoReport::Source::EIR);
         ad_report.setTimestamp(event.getTimestamp());
-        ad_report.setAddressType(event.getAddressType());
-        ad_report.setAddress( event.getAddress() );
+        ad_report.setAddressType(id.addressType);
+        ad_report.setAddress( id.address );
         ad_report.read_data(event.getData(), event.getDataSize());
     }
     int new_connect = 0;
-    std::shared_ptr<DBTDevice> device = findConnectedDevice(event.getAddress(), event.getAddressType());
+    std::shared_ptr<DBTDevice> device = findConnectedDevice(id.address, id.addressType);
     if( nullptr == device ) {
-        device = findDiscoveredDevice(event.getAddress(), event.getAddressType());
+        device = findDiscoveredDevice(id.address, id.addressType);
         new_connect = nullptr != device ? 1 : 0;
     }
     if( nullptr == device ) {
-        device = findSharedDevice(event.getAddress(), event.getAddressType());
+        device = findSharedDevice(id.address, id.addressType);
         if( nullptr != device ) {
             addDiscoveredDevice(device);
             new_connect = 2;
         }
     }
     if( nullptr == device ) {
-        // a whitelist auto-connect w/o previous discovery
+        // a whitelist auto-connect w/o previous discovery or of a merely sighted device
+        sightings.remove(id.address, id.addressType);
         device = std::shared_ptr<DBTDevice>(new DBTDevice(*this, ad_report));
         addDiscoveredDevice(device);
         addSharedDevice(device);
@@ -801,9 +1398,11 @@ bool DBTAdapter::mgmtEvDeviceConnectedHCI(std::shared_ptr<MgmtEvent> e) {
     }
 
     device->notifyConnected(event.getHCIHandle());
+    connectCompleted(device);
+    autoConnectChanged(*device, true, event.getTimestamp());
 
     int i=0;
-    for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
         try {
             if( l->matchDevice(*device) ) {
                 if( EIRDataType::NONE != updateMask ) {
@@ -823,21 +1422,23 @@ bool DBTAdapter::mgmtEvDeviceConnectedHCI(std::shared_ptr<MgmtEvent> e) {
     return true;
 }
 
-bool DBTAdapter::mgmtEvConnectFailedHCI(std::shared_ptr<MgmtEvent> e) {
-    COND_PRINT(debug_event, "DBTAdapter::EventHCI:ConnectFailed: %s", e->toString().c_str());
-    const MgmtEvtDeviceConnectFailed &event = *static_cast<const MgmtEvtDeviceConnectFailed *>(e.get());
-    std::shared_ptr<DBTDevice> device = findConnectedDevice(event.getAddress(), event.getAddressType());
+bool DBTAdapter::mgmtEvConnectFailedHCI(const MgmtEvtDeviceConnectFailed &event) {
+    COND_PRINT(debug_event, "DBTAdapter::EventHCI:ConnectFailed: %s", event.toString().c_str());
+    const BDAddressKey id = resolveIdentity(event.getAddress(), event.getAddressType());
+    std::shared_ptr<DBTDevice> device = findConnectedDevice(id.address, id.addressType);
     if( nullptr != device ) {
         const uint16_t handle = device->getConnectionHandle();
         COND_PRINT(debug_event, "DBTAdapter::EventHCI:ConnectFailed(dev_id %d): %s, handle %s -> zero,\n    -> %s",
             dev_id, event.toString().c_str(), uint16HexString(handle).c_str(),
             device->toString().c_str());
 
+        device->failPendingGATT(event.getHCIStatus());
         device->notifyDisconnected();
         removeConnectedDevice(*device);
+        connectCompleted(device);
 
         int i=0;
-        for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+        for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
             try {
                 if( l->matchDevice(*device) ) {
                     l->deviceDisconnected(device, event.getHCIStatus(), handle, event.getTimestamp());
@@ -851,15 +1452,16 @@ bool DBTAdapter::mgmtEvConnectFailedHCI(std::shared_ptr<MgmtEvent> e) {
         });
         removeDiscoveredDevice(*device); // ensure device will cause a deviceFound event after disconnect
     } else {
+        connectCompleted( findSharedDevice(id.address, id.addressType) ); // pending connection creation
         INFO_PRINT("DBTAdapter::EventHCI:DeviceDisconnected(dev_id %d): %s\n    -> Device not tracked",
             dev_id, event.toString().c_str());
     }
     return true;
 }
 
-bool DBTAdapter::mgmtEvDeviceDisconnectedHCI(std::shared_ptr<MgmtEvent> e) {
-    const MgmtEvtDeviceDisconnected &event = *static_cast<const MgmtEvtDeviceDisconnected *>(e.get());
-    std::shared_ptr<DBTDevice> device = findConnectedDevice(event.getAddress(), event.getAddressType());
+bool DBTAdapter::mgmtEvDeviceDisconnectedHCI(const MgmtEvtDeviceDisconnected &event) {
+    const BDAddressKey id = resolveIdentity(event.getAddress(), event.getAddressType());
+    std::shared_ptr<DBTDevice> device = findConnectedDevice(id.address, id.addressType);
     if( nullptr != device ) {
         if( device->getConnectionHandle() != event.getHCIHandle() ) {
             INFO_PRINT("DBTAdapter::EventHCI:DeviceDisconnected(dev_id %d): ConnHandle mismatch %s\n    -> %s",
@@ -872,9 +1474,11 @@ bool DBTAdapter::mgmtEvDeviceDisconnectedHCI(std::shared_ptr<MgmtEvent> e) {
 
         device->notifyDisconnected();
         removeConnectedDevice(*device);
+        connectCompleted(device);
+        autoConnectChanged(*device, false, event.getTimestamp());
 
         int i=0;
-        for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+        for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
             try {
                 if( l->matchDevice(*device) ) {
                     l->deviceDisconnected(device, event.getHCIReason(), event.getHCIHandle(), event.getTimestamp());
@@ -894,16 +1498,33 @@ bool DBTAdapter::mgmtEvDeviceDisconnectedHCI(std::shared_ptr<MgmtEvent> e) {
     return true;
 }
 
-bool DBTAdapter::mgmtEvDeviceDisconnectedMgmt(std::shared_ptr<MgmtEvent> e) {
-    COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceDisconnected: %s", e->toString().c_str());
-    const MgmtEvtDeviceDisconnected &event = *static_cast<const MgmtEvtDeviceDisconnected *>(e.get());
-    (void)event;
+bool DBTAdapter::mgmtEvDeviceDisconnectedMgmt(const MgmtEvtDeviceDisconnected &event) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceDisconnected: %s", event.toString().c_str());
     return true;
 }
 
-bool DBTAdapter::mgmtEvDeviceFoundHCI(std::shared_ptr<MgmtEvent> e) {
-    COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound(dev_id %d): %s", dev_id, e->toString().c_str());
-    const MgmtEvtDeviceFound &deviceFoundEvent = *static_cast<const MgmtEvtDeviceFound *>(e.get());
+bool DBTAdapter::mgmtEvNewIdentityResolvingKeyMgmt(const MgmtEvtNewIdentityResolvingKey &event) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:NewIdentityResolvingKey: %s", event.toString().c_str());
+    rpaResolver.add(event.getKey());
+    return true;
+}
+
+bool DBTAdapter::mgmtEvDeviceUnpairedMgmt(const MgmtEvtDeviceUnpaired &event) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceUnpaired: %s", event.toString().c_str());
+    rpaResolver.remove(event.getAddress(), event.getAddressType());
+    return true;
+}
+
+BDAddressKey DBTAdapter::resolveIdentity(const EUI48 & address, const BDAddressType addressType) {
+    BDAddressKey identity(address, addressType);
+    if( rpaResolution ) {
+        rpaResolver.resolve(address, addressType, identity);
+    }
+    return identity;
+}
+
+bool DBTAdapter::mgmtEvDeviceFoundHCI(const MgmtEvtDeviceFound &deviceFoundEvent) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound(dev_id %d): %s", dev_id, deviceFoundEvent.toString().c_str());
 
     std::shared_ptr<EInfoReport> eir = deviceFoundEvent.getEIR();
     if( nullptr == eir ) {
@@ -916,25 +1537,54 @@ bool DBTAdapter::mgmtEvDeviceFoundHCI(std::shared_ptr<MgmtEvent> e) {
         eir->setAddress( deviceFoundEvent.getAddress() );
         eir->setRSSI( deviceFoundEvent.getRSSI() );
         eir->read_data(deviceFoundEvent.getData(), deviceFoundEvent.getDataSize());
-    } // else: Sourced from HCIHandler via LE_ADVERTISING_REPORT (default!)
+        deviceFoundEIR(eir, true /* movable: solely owned */);
+    } else {
+        // Sourced from HCIHandler via LE_ADVERTISING_REPORT
+        deviceFoundEIR(eir, false);
+    }
+    return true;
+}
 
-    // std::shared_ptr<DBTDevice> dev = findDiscoveredDevice(ad_report.getAddress());
-    std::shared_ptr<DBTDevice> dev;
-    {
-        const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTAdapter*>(this)->mtx_discoveredDevices); // RAII-style acquire and relinquish via destructor
-        dev = findDiscoveredDevice(eir->getAddress(), eir->getAddressType());
+bool DBTAdapter::advertisingReportBatchHCI(const EInfoReportBatch & batch) {
+    COND_PRINT(debug_event, "DBTAdapter::EventCB:AdvertisingReportBatch(dev_id %d): %zd reports", dev_id, batch.size());
+    // Sourced from HCIHandler via LE_ADVERTISING_REPORT (default!)
+    for(size_t i=0; i<batch.size(); i++) {
+        deviceFoundEIR(batch[i], false /* shared with other batch callbacks */);
+    }
+    return true;
+}
+
+void DBTAdapter::deviceFoundEIR(const std::shared_ptr<EInfoReport> & eir0, const bool movable0) {
+    std::shared_ptr<EInfoReport> eir = eir0;
+    bool movable = movable0;
+    if( rpaResolution ) {
+        BDAddressKey identity(eir->getAddress(), eir->getAddressType());
+        if( rpaResolver.resolve(eir->getAddress(), eir->getAddressType(), identity) ) {
+            // Map the rotating RPA to its stable identity device, before any lookup or allocation
+            COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound: Resolved %s -> %s",
+                    eir->getAddress().toString().c_str(), identity.address.toString().c_str());
+            if( !movable ) {
+                // rewrite a private copy, the pooled report is shared with other batch callbacks
+                eir = std::make_shared<EInfoReport>(*eir0);
+                movable = true;
+            }
+            eir->setAddress(identity.address);
+            eir->setAddressType(identity.addressType);
+        }
     }
+    // std::shared_ptr<DBTDevice> dev = findDiscoveredDevice(ad_report.getAddress());
+    std::shared_ptr<DBTDevice> dev = findDiscoveredDevice(eir->getAddress(), eir->getAddressType()); // sharded index lookup
     if( nullptr != dev ) {
         //
         // drop existing device
         //
-        EIRDataType updateMask = dev->update(*eir);
         COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound: Drop already discovered %s, %s",
                 dev->getAddressString().c_str(), eir->toString().c_str());
+        EIRDataType updateMask = movable ? dev->update(std::move(*eir)) : dev->update(*eir);
         if( EIRDataType::NONE != updateMask ) {
             sendDeviceUpdated("DiscoveredDeviceFound", dev, eir->getTimestamp(), updateMask);
         }
-        return true;
+        return;
     }
 
     dev = findSharedDevice(eir->getAddress(), eir->getAddressType());
@@ -945,14 +1595,14 @@ bool DBTAdapter::mgmtEvDeviceFoundHCI(std::shared_ptr<MgmtEvent> e) {
         // - issue deviceFound, allowing receivers to recognize the re-discovered device
         // - issue deviceUpdate if data has changed, allowing receivers to act upon
         //
-        EIRDataType updateMask = dev->update(*eir);
-        addDiscoveredDevice(dev); // re-add to discovered devices!
-        dev->ts_last_discovery = eir->getTimestamp();
         COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound: Use already shared %s, %s",
                 dev->getAddressString().c_str(), eir->toString().c_str());
+        EIRDataType updateMask = movable ? dev->update(std::move(*eir)) : dev->update(*eir);
+        addDiscoveredDevice(dev); // re-add to discovered devices!
+        dev->ts_last_discovery = eir->getTimestamp();
 
         int i=0;
-        for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+        for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
             try {
                 if( l->matchDevice(*dev) ) {
                     l->deviceFound(dev, eir->getTimestamp());
@@ -967,23 +1617,73 @@ bool DBTAdapter::mgmtEvDeviceFoundHCI(std::shared_ptr<MgmtEvent> e) {
         if( EIRDataType::NONE != updateMask ) {
             sendDeviceUpdated("SharedDeviceFound", dev, eir->getTimestamp(), updateMask);
         }
-        return true;
+        return;
     }
 
     //
-    // new device
+    // new device, subject to the DiscoveryFilter
     //
-    dev = std::shared_ptr<DBTDevice>(new DBTDevice(*this, *eir));
-    addDiscoveredDevice(dev);
+    std::shared_ptr<const DiscoveryFilter> filter = std::atomic_load(&discoveryFilter);
+    if( !filter->isEmpty() && !filter->match(*eir) ) {
+        COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound: Filtered %s", eir->toString().c_str());
+        return;
+    }
+    if( sightings.isEnabled() ) {
+        //
+        // new device, merely tracked as sighting unless retained by any listener
+        //
+        bool created;
+        const EIRDataType newData = sightings.add(*eir, created);
+        if( EIRDataType::NONE == newData || !isDeviceRetained(*eir) ) {
+            if( created ) {
+                COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound: Sighting %s", eir->toString().c_str());
+                updateDeviceMetrics();
+                checkDeviceEviction(eir->getTimestamp());
+            }
+            return;
+        }
+        sightings.remove(eir->getAddress(), eir->getAddressType());
+    }
+    addNewDevice(*eir);
+}
+
+bool DBTAdapter::isDeviceRetained(const EInfoReport & eir) {
+    bool res = false;
+    int i=0;
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
+        try {
+            if( !res && l->retainDevice(eir) ) {
+                res = true;
+            }
+        } catch (std::exception &e) {
+            ERR_PRINT("DBTAdapter::isDeviceRetained %d/%zd: %s of %s: Caught exception %s",
+                    i+1, statusListenerList.size(),
+                    l->toString().c_str(), eir.toString().c_str(), e.what());
+        }
+        i++;
+    });
+    return res;
+}
+
+std::shared_ptr<DBTDevice> DBTAdapter::addNewDevice(const EInfoReport & eir) {
+    std::shared_ptr<DBTDevice> dev(new DBTDevice(*this, eir));
+    if( !addDiscoveredDevice(dev) ) {
+        // concurrently added, e.g. via retainSighting()
+        std::shared_ptr<DBTDevice> other = findDiscoveredDevice(eir.getAddress(), eir.getAddressType());
+        if( nullptr != other ) {
+            return other;
+        }
+    }
     addSharedDevice(dev);
+    checkDeviceEviction(eir.getTimestamp());
     COND_PRINT(debug_event, "DBTAdapter::EventCB:DeviceFound: Use new %s, %s",
-            dev->getAddressString().c_str(), eir->toString().c_str());
+            dev->getAddressString().c_str(), eir.toString().c_str());
 
     int i=0;
-    for_each_idx_mtx(mtx_statusListenerList, statusListenerList, [&](std::shared_ptr<AdapterStatusListener> &l) {
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
         try {
             if( l->matchDevice(*dev) ) {
-                l->deviceFound(dev, eir->getTimestamp());
+                l->deviceFound(dev, eir.getTimestamp());
             }
         } catch (std::exception &e) {
             ERR_PRINT("DBTAdapter::EventCB:DeviceFound-CBs %d/%zd: %s of %s: Caught exception %s",
@@ -992,6 +1692,424 @@ bool DBTAdapter::mgmtEvDeviceFoundHCI(std::shared_ptr<MgmtEvent> e) {
         }
         i++;
     });
+    return dev;
+}
 
-    return true;
+std::shared_ptr<DBTDevice> DBTAdapter::retainSighting(const EUI48 & address, const BDAddressType addressType) {
+    std::shared_ptr<DBTDevice> dev = findDiscoveredDevice(address, addressType);
+    if( nullptr == dev ) {
+        dev = findSharedDevice(address, addressType);
+    }
+    if( nullptr != dev ) {
+        return dev;
+    }
+    DeviceSighting s;
+    if( !sightings.get(address, addressType, s) ) {
+        return nullptr;
+    }
+    EInfoReport eir;
+    eir.setSource(EInfoReport::Source::NA);
+    eir.setTimestamp(s.ts_last);
+    eir.setEvtType(s.evtType);
+    eir.setAddressType(addressType);
+    eir.setAddress(address);
+    eir.setRSSI(s.rssi);
+    if( isEIRDataTypeSet(s.eirMask, EIRDataType::TX_POWER) ) {
+        eir.setTxPower(s.tx_power);
+    }
+    sightings.remove(address, addressType);
+    return addNewDevice(eir);
+}
+
+std::string ConnectPipelineReport::getStageString(const Stage v) {
+    switch(v) {
+        case Stage::NONE: return "NONE";
+        case Stage::HCI_CONNECTED: return "HCI_CONNECTED";
+        case Stage::GATT_CONNECTED: return "GATT_CONNECTED";
+        case Stage::GATT_DISCOVERED: return "GATT_DISCOVERED";
+        case Stage::SESSION_RESTORED: return "SESSION_RESTORED";
+    }
+    return "Unknown Stage";
+}
+
+std::string ConnectPipelineReport::toString() const {
+    return "ConnectPipeline["+( nullptr != device ? device->getAddressString() : "null" )+
+           ", stage "+getStageString(stage)+", status "+getHCIStatusCodeString(status)+
+           ", ms[queued "+std::to_string(queuedMS)+", hci "+std::to_string(hciConnectMS)+
+           ", gatt "+std::to_string(gattConnectMS)+", discovery "+std::to_string(gattDiscoveryMS)+
+           ", restore "+std::to_string(restoreMS)+", total "+std::to_string(totalMS)+"]]";
+}
+
+std::string SessionDevice::toString() const {
+    size_t bound = 0;
+    for(auto it = boundListeners.begin(); it != boundListeners.end(); it++) {
+        bound += it->second.size();
+    }
+    return "SessionDevice["+( nullptr != device ? device->getAddressString() : "null" )+
+           ", subscriptions "+std::to_string(subscriptions.size())+", listener[unbound "+std::to_string(listeners.size())+
+           ", bound "+std::to_string(bound)+"]]";
+}
+
+std::string DBTSession::toString() const {
+    std::string res = "DBTSession[devices "+std::to_string(devices.size())+", ts "+std::to_string(timestamp);
+    for(auto it = devices.begin(); it != devices.end(); it++) {
+        res.append(", ").append(it->toString());
+    }
+    return res+"]";
+}
+
+namespace direct_bt {
+
+/**
+ * Shared state of one DBTAdapter::connectDevices() invocation:
+ * The HCI connection creation permits and the connect and disconnect events of the pipelines' devices.
+ */
+class ConnectPipelineListener : public AdapterStatusListener {
+    private:
+        std::mutex mtx;
+        std::condition_variable cv;
+        int permits;
+        std::map<EUI48, HCIStatusCode> failed;
+
+    public:
+        ConnectPipelineListener(const int permits) : permits(permits) {}
+
+        void acquirePermit() {
+            std::unique_lock<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+            while( 0 >= permits ) {
+                cv.wait(lock);
+            }
+            permits--;
+        }
+        void releasePermit() {
+            {
+                const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+                permits++;
+            }
+            cv.notify_all();
+        }
+        void clearFailed(const DBTDevice & device) {
+            const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+            failed.erase(device.getAddress());
+        }
+
+        /** Waits until the device is connected, returning SUCCESS, its disconnect reason or INTERNAL_TIMEOUT. */
+        HCIStatusCode waitConnected(DBTDevice & device, const int timeoutMS) {
+            std::unique_lock<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+            const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            while( !device.getConnected() ) {
+                auto it = failed.find(device.getAddress());
+                if( it != failed.end() ) {
+                    return it->second;
+                }
+                if( std::cv_status::timeout == cv.wait_until(lock, t0 + std::chrono::milliseconds(timeoutMS)) && !device.getConnected() ) {
+                    return HCIStatusCode::INTERNAL_TIMEOUT;
+                }
+            }
+            return HCIStatusCode::SUCCESS;
+        }
+
+        void adapterSettingsChanged(DBTAdapter const &a, const AdapterSetting oldmask, const AdapterSetting newmask,
+                                    const AdapterSetting changedmask, const uint64_t timestamp) override {
+            (void)a; (void)oldmask; (void)newmask; (void)changedmask; (void)timestamp;
+        }
+        void discoveringChanged(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) override {
+            (void)a; (void)enabled; (void)keepAlive; (void)timestamp;
+        }
+        void deviceFound(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) override {
+            (void)device; (void)timestamp;
+        }
+        void deviceUpdated(std::shared_ptr<DBTDevice> device, const EIRDataType updateMask, const uint64_t timestamp) override {
+            (void)device; (void)updateMask; (void)timestamp;
+        }
+        void deviceConnected(std::shared_ptr<DBTDevice> device, const uint16_t handle, const uint64_t timestamp) override {
+            (void)device; (void)handle; (void)timestamp;
+            {
+                // no state to change, but synchronize with waitConnected()'s predicate test
+                const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+            }
+            cv.notify_all();
+        }
+        void deviceDisconnected(std::shared_ptr<DBTDevice> device, const HCIStatusCode reason, const uint16_t handle, const uint64_t timestamp) override {
+            (void)handle; (void)timestamp;
+            {
+                const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+                failed[device->getAddress()] = reason;
+            }
+            cv.notify_all();
+        }
+
+        std::string toString() const override {
+            return "ConnectPipelineListener";
+        }
+};
+
+} // namespace direct_bt
+
+std::vector<ConnectPipelineReport> DBTAdapter::connectDevices(const std::vector<std::shared_ptr<DBTDevice>> & devices,
+                                                              const int maxConcurrency, const bool discoverGATT)
+{
+    return connectDevicesImpl(devices, maxConcurrency, discoverGATT, std::vector<bool>(), nullptr);
+}
+
+std::vector<ConnectPipelineReport> DBTAdapter::connectDevicesImpl(const std::vector<std::shared_ptr<DBTDevice>> & devices,
+                                                                  const int maxConcurrency, const bool discoverGATT,
+                                                                  const std::vector<bool> & awaitAutoConnect,
+                                                                  const std::function<bool(ConnectPipelineReport &)> & restore)
+{
+    checkValidAdapter();
+    const int pendingLimit = DBTEnv::getInt32Property("direct_bt.adapter.connect.pending", 1, 1 /* min */, 16 /* max */);
+    std::vector<ConnectPipelineReport> reports;
+    for(auto it = devices.begin(); it != devices.end(); it++) {
+        reports.push_back(ConnectPipelineReport(*it));
+    }
+    std::shared_ptr<ConnectPipelineListener> listener(new ConnectPipelineListener(pendingLimit));
+    addStatusListener(listener);
+
+    std::atomic<int> nextIdx(0);
+    auto pipeline = [&]() {
+        for(int i = nextIdx++; i < static_cast<int>(reports.size()); i = nextIdx++) {
+            ConnectPipelineReport & r = reports[i];
+            if( nullptr == r.device ) {
+                r.status = HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+                continue;
+            }
+            const uint64_t t0 = getCurrentMilliseconds();
+            bool hasPermit = false;
+            try {
+                if( r.device->getConnected() ) {
+                    r.status = HCIStatusCode::SUCCESS;
+                } else if( static_cast<size_t>(i) < awaitAutoConnect.size() && awaitAutoConnect[i] ) {
+                    // the kernel connects whitelisted devices, a concurrent LE Create Connection would be rejected
+                    const uint64_t t1 = getCurrentMilliseconds();
+                    r.status = listener->waitConnected(*r.device, number(HCIConstInt::LE_CONN_TIMEOUT_MS));
+                    r.hciConnectMS = getCurrentMilliseconds() - t1;
+                } else {
+                    listener->acquirePermit();
+                    hasPermit = true;
+                    const uint64_t t1 = getCurrentMilliseconds();
+                    r.queuedMS = t1 - t0;
+                    listener->clearFailed(*r.device);
+                    r.status = r.device->connectDefault();
+                    if( HCIStatusCode::SUCCESS == r.status ) {
+                        r.status = listener->waitConnected(*r.device, number(HCIConstInt::LE_CONN_TIMEOUT_MS));
+                        if( HCIStatusCode::INTERNAL_TIMEOUT == r.status ) {
+                            r.device->disconnect(HCIStatusCode::REMOTE_USER_TERMINATED_CONNECTION);
+                        }
+                    }
+                    listener->releasePermit();
+                    hasPermit = false;
+                    r.hciConnectMS = getCurrentMilliseconds() - t1;
+                }
+                if( HCIStatusCode::SUCCESS == r.status ) {
+                    r.stage = ConnectPipelineReport::Stage::HCI_CONNECTED;
+                    const uint64_t t2 = getCurrentMilliseconds();
+                    if( nullptr != r.device->connectGATT() ) {
+                        r.stage = ConnectPipelineReport::Stage::GATT_CONNECTED;
+                        const uint64_t t3 = getCurrentMilliseconds();
+                        r.gattConnectMS = t3 - t2;
+                        if( discoverGATT ) {
+                            if( r.device->getGATTServices().size() > 0 ) {
+                                r.stage = ConnectPipelineReport::Stage::GATT_DISCOVERED;
+                            }
+                            const uint64_t t4 = getCurrentMilliseconds();
+                            r.gattDiscoveryMS = t4 - t3;
+                            if( ConnectPipelineReport::Stage::GATT_DISCOVERED == r.stage && nullptr != restore ) {
+                                if( restore(r) ) {
+                                    r.stage = ConnectPipelineReport::Stage::SESSION_RESTORED;
+                                }
+                                r.restoreMS = getCurrentMilliseconds() - t4;
+                            }
+                        }
+                    } else {
+                        r.gattConnectMS = getCurrentMilliseconds() - t2;
+                    }
+                }
+            } catch (std::exception &e) {
+                ERR_PRINT("DBTAdapter::connectDevices: %s: Caught exception %s", r.device->toString().c_str(), e.what());
+                if( hasPermit ) {
+                    listener->releasePermit();
+                }
+            }
+            r.totalMS = getCurrentMilliseconds() - t0;
+            DBG_PRINT("DBTAdapter::connectDevices: %s", r.toString().c_str());
+        }
+    };
+    const int threadCount = std::max(1, std::min(getControllerCaps().getMaxConcurrentConnections(maxConcurrency),
+                                                 static_cast<int>(reports.size())));
+    std::vector<std::thread> workers;
+    for(int i=1; i<threadCount; i++) {
+        workers.push_back(std::thread(pipeline));
+    }
+    pipeline(); // the calling thread serves as one pipeline
+    for(auto it = workers.begin(); it != workers.end(); it++) {
+        it->join();
+    }
+    removeStatusListener(listener);
+    return reports;
+}
+
+SessionDevice DBTAdapter::captureSessionDevice(const std::shared_ptr<DBTDevice> & device) {
+    SessionDevice sd(device);
+    sd.timestamp = getCurrentMilliseconds();
+    std::shared_ptr<GATTHandler> gatt = device->getGATTHandler();
+    if( nullptr == gatt ) {
+        return sd;
+    }
+    sd.listeners = gatt->getCharacteristicListeners();
+    sd.boundListeners = gatt->getBoundCharacteristicListeners();
+    const std::vector<GATTServiceRef> & services = gatt->getServices();
+    for(size_t i=0; i<services.size(); i++) {
+        const std::vector<GATTCharacteristicRef> & characteristics = services[i]->characteristicList;
+        for(size_t j=0; j<characteristics.size(); j++) {
+            const GATTCharacteristic & c = *characteristics[j];
+            if( c.isNotificationEnabled() || c.isIndicationEnabled() ) {
+                sd.subscriptions.push_back( { c.value_handle, c.isNotificationEnabled(), c.isIndicationEnabled() } );
+            }
+        }
+    }
+    return sd;
+}
+
+void DBTAdapter::recordSessionDevice(DBTDevice & device, const bool unsolicited) {
+    if( !sessionResumption ) {
+        return;
+    }
+    const BDAddressKey key = getDeviceKey(device);
+    std::shared_ptr<DBTDevice> sharedInstance = getSharedDevice(device);
+    const std::lock_guard<std::mutex> lock(mtx_session); // RAII-style acquire and relinquish via destructor
+    sessionRecords.erase(key);
+    if( ( unsolicited || poweringOff ) && nullptr != sharedInstance ) {
+        SessionDevice sd = captureSessionDevice(sharedInstance);
+        DBG_PRINT("DBTAdapter::recordSessionDevice: %s", sd.toString().c_str());
+        sessionRecords.insert( std::make_pair(key, std::move(sd)) );
+    }
+}
+
+DBTSession DBTAdapter::getSession() {
+    std::vector<std::shared_ptr<DBTDevice>> devices;
+    {
+        const std::lock_guard<std::recursive_mutex> lock(mtx_connectedDevices); // RAII-style acquire and relinquish via destructor
+        devices = connectedDevices; // copy!
+    }
+    DBTSession session;
+    session.timestamp = getCurrentMilliseconds();
+    for(auto it = devices.begin(); it != devices.end(); it++) {
+        if( nullptr != *it ) {
+            session.devices.push_back( captureSessionDevice(*it) );
+        }
+    }
+    return session;
+}
+
+DBTSession DBTAdapter::getPendingSession() {
+    const std::lock_guard<std::mutex> lock(mtx_session); // RAII-style acquire and relinquish via destructor
+    return pendingSession;
+}
+
+bool DBTAdapter::restoreSessionDevice(const SessionDevice & sd, DBTDevice & device) {
+    std::shared_ptr<GATTHandler> gatt = device.getGATTHandler();
+    if( nullptr == gatt ) {
+        return false;
+    }
+    for(auto it = sd.listeners.begin(); it != sd.listeners.end(); it++) {
+        gatt->addCharacteristicListener(*it);
+    }
+    for(auto it = sd.boundListeners.begin(); it != sd.boundListeners.end(); it++) {
+        const std::vector<uint16_t> valueHandles { it->first };
+        for(auto jt = it->second.begin(); jt != it->second.end(); jt++) {
+            gatt->addCharacteristicListener(*jt, valueHandles);
+        }
+    }
+    // One pipelined CCCD write batch per enabled state combination
+    std::vector<GATTCharacteristicRef> batches[3]; // notify, indicate, both
+    bool res = true;
+    for(auto it = sd.subscriptions.begin(); it != sd.subscriptions.end(); it++) {
+        GATTCharacteristicRef c = gatt->findCharacterisicsByValueHandle(it->valueHandle);
+        if( nullptr == c ) {
+            WARN_PRINT("DBTAdapter::restoreSessionDevice: Value handle %s not found, changed database: %s",
+                    uint16HexString(it->valueHandle).c_str(), device.getAddressString().c_str());
+            res = false;
+            continue;
+        }
+        batches[ it->notify && it->indicate ? 2 : ( it->indicate ? 1 : 0 ) ].push_back(c);
+    }
+    for(int i=0; i<3; i++) {
+        if( batches[i].size() > 0 ) {
+            const int count = gatt->configNotificationIndication(batches[i], 1 != i /* notify */, 0 != i /* indicate */);
+            res = res && count == static_cast<int>(batches[i].size());
+        }
+    }
+    return res;
+}
+
+std::vector<ConnectPipelineReport> DBTAdapter::resumeSession(const DBTSession & session, const int maxConcurrency) {
+    checkValidAdapter();
+    std::vector<std::shared_ptr<DBTDevice>> devices;
+    std::vector<bool> awaitAutoConnect;
+    std::unordered_map<BDAddressKey, const SessionDevice *> records;
+    for(auto it = session.devices.begin(); it != session.devices.end(); it++) {
+        std::shared_ptr<DBTDevice> device = it->device;
+        if( nullptr == device ) {
+            continue;
+        }
+        const BDAddressKey key = getDeviceKey(*device);
+        std::shared_ptr<DBTDevice> tracked = findSharedDevice(key.address, key.addressType);
+        if( nullptr != tracked ) {
+            // already re-created, e.g. by an auto-connect
+            device = tracked;
+        } else if( &device->getAdapter() != this ) {
+            EInfoReport eir;
+            eir.setTimestamp(getCurrentMilliseconds());
+            eir.setAddressType(key.addressType);
+            eir.setAddress(key.address);
+            std::shared_ptr<const DBTProfile> p = it->device->getProfile();
+            device = std::shared_ptr<DBTDevice>(new DBTDevice(*this, eir));
+            device->setProfile(p);
+            addSharedDevice(device);
+        } else {
+            // the application's instance of the previous power cycle
+            addSharedDevice(device);
+        }
+        devices.push_back(device);
+        records[key] = &(*it);
+        {
+            const std::lock_guard<std::mutex> lock(mtx_autoConnect); // RAII-style acquire and relinquish via destructor
+            awaitAutoConnect.push_back( autoConnectDevices.end() != autoConnectDevices.find(key) );
+        }
+    }
+    updateDeviceMetrics();
+    const uint64_t t0 = getCurrentMilliseconds();
+    std::vector<ConnectPipelineReport> reports = connectDevicesImpl(devices, maxConcurrency, true /* discoverGATT */, awaitAutoConnect,
+        [&](ConnectPipelineReport & r) -> bool {
+            // records is immutable while the pipelines are running
+            auto it = records.find(getDeviceKey(*r.device));
+            return records.end() != it && restoreSessionDevice(*it->second, *r.device);
+        });
+    int restored = 0;
+    for(auto it = reports.begin(); it != reports.end(); it++) {
+        if( ConnectPipelineReport::Stage::SESSION_RESTORED == it->stage ) {
+            restored++;
+        }
+    }
+    INFO_PRINT("DBTAdapter::resumeSession: %d/%zu devices restored in %" PRIu64 " ms",
+            restored, reports.size(), getCurrentMilliseconds() - t0);
+    return reports;
+}
+
+void DBTAdapter::resumePendingSession() {
+    DBTSession session;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_session); // RAII-style acquire and relinquish via destructor
+        session = std::move(pendingSession);
+        pendingSession = DBTSession();
+    }
+    if( !sessionResumption || session.isEmpty() || !isPowered() ) {
+        return;
+    }
+    try {
+        resumeSession(session);
+    } catch (std::exception &e) {
+        ERR_PRINT("DBTAdapter::resumePendingSession: %s: Caught exception %s", session.toString().c_str(), e.what());
+    }
 }
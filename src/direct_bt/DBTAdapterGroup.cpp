@@ -0,0 +1,314 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include <algorithm>
+
+#include <dbt_debug.hpp>
+
+#include "DBTAdapterGroup.hpp"
+#include "DBTManager.hpp"
+
+using namespace direct_bt;
+
+class DBTAdapterGroup::GroupListener : public AdapterStatusListener {
+    private:
+        DBTAdapterGroup & group;
+        const int adapterIdx;
+
+        template<typename F>
+        void forward(const DBTDevice * device, F f) {
+            int i=0;
+            for_each_cow(group.statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
+                try {
+                    if( nullptr == device || l->matchDevice(*device) ) {
+                        f(l);
+                    }
+                } catch (std::exception &e) {
+                    ERR_PRINT("DBTAdapterGroup::CB %d/%zd: %s of %s: Caught exception %s",
+                            i+1, group.statusListenerList.size(),
+                            l->toString().c_str(), group.toString().c_str(), e.what());
+                }
+                i++;
+            });
+        }
+
+    public:
+        GroupListener(DBTAdapterGroup & group_, const int adapterIdx_)
+        : group(group_), adapterIdx(adapterIdx_) {}
+
+        void adapterSettingsChanged(DBTAdapter const &a, const AdapterSetting oldmask, const AdapterSetting newmask,
+                                    const AdapterSetting changedmask, const uint64_t timestamp) override {
+            forward(nullptr, [&](const std::shared_ptr<AdapterStatusListener> &l) {
+                l->adapterSettingsChanged(a, oldmask, newmask, changedmask, timestamp);
+            });
+        }
+
+        void discoveringChanged(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) override {
+            forward(nullptr, [&](const std::shared_ptr<AdapterStatusListener> &l) {
+                l->discoveringChanged(a, enabled, keepAlive, timestamp);
+            });
+        }
+
+        void deviceFound(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) override {
+            group.deviceFound(adapterIdx, device, timestamp);
+        }
+
+        void deviceUpdated(std::shared_ptr<DBTDevice> device, const EIRDataType updateMask, const uint64_t timestamp) override {
+            if( group.isPrimary(adapterIdx, *device) ) {
+                forward(device.get(), [&](const std::shared_ptr<AdapterStatusListener> &l) {
+                    l->deviceUpdated(device, updateMask, timestamp);
+                });
+            }
+        }
+
+        void deviceConnected(std::shared_ptr<DBTDevice> device, const uint16_t handle, const uint64_t timestamp) override {
+            forward(device.get(), [&](const std::shared_ptr<AdapterStatusListener> &l) {
+                l->deviceConnected(device, handle, timestamp);
+            });
+        }
+
+        void deviceDisconnected(std::shared_ptr<DBTDevice> device, const HCIStatusCode reason, const uint16_t handle, const uint64_t timestamp) override {
+            forward(device.get(), [&](const std::shared_ptr<AdapterStatusListener> &l) {
+                l->deviceDisconnected(device, reason, handle, timestamp);
+            });
+        }
+
+        std::string toString() const override {
+            return "DBTAdapterGroup::GroupListener[adapter "+std::to_string(adapterIdx)+"]";
+        }
+};
+
+DBTAdapterGroup::DBTAdapterGroup(const std::vector<std::shared_ptr<DBTAdapter>> & adapters_)
+: MAX_CONNECTIONS( DBTEnv::getInt32Property("direct_bt.group.connections.max", 5, 1 /* min */, 100 /* max */) )
+{
+    for(auto it = adapters_.begin(); it != adapters_.end(); it++) {
+        if( nullptr != *it && (*it)->isValid() ) {
+            adapters.push_back(*it);
+        }
+    }
+    for(size_t i=0; i<adapters.size(); i++) {
+        std::shared_ptr<GroupListener> l = std::make_shared<GroupListener>(*this, static_cast<int>(i));
+        groupListeners.push_back(l);
+        adapters[i]->addStatusListener(l);
+    }
+}
+
+static std::vector<std::shared_ptr<DBTAdapter>> createAdapters(DBTManager & mgmt) {
+    std::vector<std::shared_ptr<DBTAdapter>> res;
+    const std::vector<std::shared_ptr<AdapterInfo>> infos = mgmt.getAdapterInfos();
+    for(auto it = infos.begin(); it != infos.end(); it++) {
+        std::shared_ptr<DBTAdapter> a = std::make_shared<DBTAdapter>( (*it)->dev_id );
+        if( a->isValid() ) {
+            res.push_back(a);
+        } else {
+            WARN_PRINT("DBTAdapterGroup: Skipping invalid %s", (*it)->toString().c_str());
+        }
+    }
+    return res;
+}
+
+DBTAdapterGroup::DBTAdapterGroup(DBTManager & mgmt)
+: DBTAdapterGroup( createAdapters(mgmt) )
+{ }
+
+DBTAdapterGroup::~DBTAdapterGroup() {
+    for(size_t i=0; i<adapters.size(); i++) {
+        if( adapters[i]->isValid() ) {
+            adapters[i]->removeStatusListener(groupListeners[i].get());
+        }
+    }
+    groupListeners.clear();
+    statusListenerList.clear();
+}
+
+bool DBTAdapterGroup::addStatusListener(std::shared_ptr<AdapterStatusListener> l) {
+    if( nullptr == l ) {
+        throw IllegalArgumentException("DBTAdapterStatusListener ref is null", E_FILE_LINE);
+    }
+    return statusListenerList.push_back_unique(l,
+            [](const std::shared_ptr<AdapterStatusListener> &a, const std::shared_ptr<AdapterStatusListener> &b) {
+                return *a == *b;
+            });
+}
+
+bool DBTAdapterGroup::removeStatusListener(const AdapterStatusListener * l) {
+    if( nullptr == l ) {
+        throw IllegalArgumentException("DBTAdapterStatusListener ref is null", E_FILE_LINE);
+    }
+    return 0 < statusListenerList.erase_matching(false /* all */,
+            [l](const std::shared_ptr<AdapterStatusListener> &it) {
+                return *it == *l;
+            });
+}
+
+void DBTAdapterGroup::deviceFound(const int adapterIdx, std::shared_ptr<DBTDevice> device, const uint64_t timestamp) {
+    bool first;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_sightings); // RAII-style acquire and relinquish via destructor
+        const BDAddressKey key(device->getAddress(), device->getAddressType());
+        auto it = sightings.find(key);
+        if( sightings.end() == it ) {
+            it = sightings.insert( std::make_pair(key, Sighting{ adapterIdx, std::vector<std::weak_ptr<DBTDevice>>(adapters.size()) }) ).first;
+            first = true;
+        } else {
+            std::shared_ptr<DBTDevice> prim = it->second.devices[it->second.primary].lock();
+            first = nullptr == prim;
+            if( first ) {
+                // previous primary device is gone, hand over
+                it->second.primary = adapterIdx;
+            }
+        }
+        it->second.devices[adapterIdx] = device;
+    }
+    if( !first ) {
+        return;
+    }
+    int i=0;
+    for_each_cow(statusListenerList, [&](const std::shared_ptr<AdapterStatusListener> &l) {
+        try {
+            if( l->matchDevice(*device) ) {
+                l->deviceFound(device, timestamp);
+            }
+        } catch (std::exception &e) {
+            ERR_PRINT("DBTAdapterGroup::deviceFound-CBs %d/%zd: %s of %s: Caught exception %s",
+                    i+1, statusListenerList.size(),
+                    l->toString().c_str(), toString().c_str(), e.what());
+        }
+        i++;
+    });
+}
+
+bool DBTAdapterGroup::isPrimary(const int adapterIdx, const DBTDevice & device) {
+    const std::lock_guard<std::mutex> lock(mtx_sightings); // RAII-style acquire and relinquish via destructor
+    auto it = sightings.find( BDAddressKey(device.getAddress(), device.getAddressType()) );
+    return sightings.end() != it && it->second.primary == adapterIdx;
+}
+
+int DBTAdapterGroup::startDiscovery(const bool keepAlive, const HCILEOwnAddressType own_mac_type,
+                                    const uint16_t le_scan_interval, const uint16_t le_scan_window)
+{
+    {
+        const std::lock_guard<std::mutex> lock(mtx_sightings); // RAII-style acquire and relinquish via destructor
+        sightings.clear();
+    }
+    int count = 0;
+    for(auto it = adapters.begin(); it != adapters.end(); it++) {
+        if( (*it)->startDiscovery(keepAlive, own_mac_type, le_scan_interval, le_scan_window) ) {
+            count++;
+        } else {
+            WARN_PRINT("DBTAdapterGroup::startDiscovery: Failed on %s", (*it)->toString().c_str());
+        }
+    }
+    return count;
+}
+
+int DBTAdapterGroup::stopDiscovery() {
+    int count = 0;
+    for(auto it = adapters.begin(); it != adapters.end(); it++) {
+        if( (*it)->stopDiscovery() ) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t DBTAdapterGroup::getSightingCount() {
+    const std::lock_guard<std::mutex> lock(mtx_sightings); // RAII-style acquire and relinquish via destructor
+    return sightings.size();
+}
+
+std::shared_ptr<DBTDevice> DBTAdapterGroup::selectDevice(const EUI48 & address, const BDAddressType addressType) {
+    std::vector<std::shared_ptr<DBTDevice>> devices;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_sightings); // RAII-style acquire and relinquish via destructor
+        auto it = sightings.find( BDAddressKey(address, addressType) );
+        if( sightings.end() == it ) {
+            return nullptr;
+        }
+        for(auto dit = it->second.devices.begin(); dit != it->second.devices.end(); dit++) {
+            devices.push_back( dit->lock() );
+        }
+    }
+    std::shared_ptr<DBTDevice> best = nullptr;
+    int bestFree = 0;
+    int bestRSSI = 0;
+    for(size_t i=0; i<devices.size(); i++) {
+        const std::shared_ptr<DBTDevice> & d = devices[i];
+        if( nullptr == d ) {
+            continue;
+        }
+        if( d->getConnected() ) {
+            return d;
+        }
+        const int freeCount = MAX_CONNECTIONS - adapters[i]->getConnectedDeviceCount();
+        const int8_t smoothed = d->getSmoothedRSSI();
+        const int rssi = RSSIHistory::RSSI_NONE == smoothed ? INT8_MIN : smoothed;
+        const int freeClamped = std::max(0, freeCount);
+        if( nullptr == best || freeClamped > bestFree || ( freeClamped == bestFree && rssi > bestRSSI ) ) {
+            best = d;
+            bestFree = freeClamped;
+            bestRSSI = rssi;
+        }
+    }
+    return best;
+}
+
+HCIStatusCode DBTAdapterGroup::connect(const EUI48 & address, const BDAddressType addressType) {
+    std::shared_ptr<DBTDevice> device = selectDevice(address, addressType);
+    if( nullptr == device ) {
+        return HCIStatusCode::UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    if( device->getConnected() ) {
+        return HCIStatusCode::CONNECTION_ALREADY_EXISTS;
+    }
+    DBG_PRINT("DBTAdapterGroup::connect: %s on %s", device->toString().c_str(), device->getAdapter().toString().c_str());
+    return device->connectDefault();
+}
+
+int DBTAdapterGroup::getConnectedDeviceCount() {
+    int count = 0;
+    for(auto it = adapters.begin(); it != adapters.end(); it++) {
+        count += (*it)->getConnectedDeviceCount();
+    }
+    return count;
+}
+
+std::string DBTAdapterGroup::toString() const {
+    std::string res = "AdapterGroup[max_conn "+std::to_string(MAX_CONNECTIONS)+", adapter [";
+    for(size_t i=0; i<adapters.size(); i++) {
+        if( 0 < i ) {
+            res += ", ";
+        }
+        res += std::to_string(adapters[i]->dev_id);
+    }
+    return res + "]]";
+}
@@ -0,0 +1,499 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstddef>
+#include <climits>
+
+#include <dbt_debug.hpp>
+
+#include "DBTBroker.hpp"
+#include "DBTEnv.hpp"
+#include "DBTDevice.hpp"
+#include "HCIHandler.hpp"
+#include "BasicTypes.hpp"
+
+extern "C" {
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    #include <sys/un.h>
+    #include <time.h>
+}
+
+#ifndef F_SEAL_FUTURE_WRITE
+    #define F_SEAL_FUTURE_WRITE 0x0010
+#endif
+
+using namespace direct_bt;
+
+/** FUTEX_WAIT and FUTEX_WAKE w/o FUTEX_PRIVATE_FLAG as shared across processes, <linux/futex.h> clashes with linux_kernel_types.hpp. */
+static const int FUTEX_OP_WAIT_SHARED = 0;
+static const int FUTEX_OP_WAKE_SHARED = 1;
+
+static uint32_t roundUpPowerOfTwo(const uint32_t v) {
+    uint32_t r = 1;
+    while( r < v ) {
+        r <<= 1;
+    }
+    return r;
+}
+
+static uint32_t getBrokerSlotCount(const uint32_t slotCount) {
+    const uint32_t v = 0 < slotCount ? slotCount :
+                       static_cast<uint32_t>( DBTEnv::getInt32Property("direct_bt.broker.slots", 1024, 2 /* min */, 1024*1024 /* max */) );
+    return roundUpPowerOfTwo( std::max<uint32_t>(2, v) );
+}
+
+static bool setSocketPath(struct sockaddr_un & addr, const std::string & path) {
+    bzero(&addr, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if( path.size() >= sizeof(addr.sun_path) ) {
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+int DBTBrokerRing::Record::decode(EInfoReport & eir) const {
+    eir.setSource(EInfoReport::Source::AD);
+    eir.setTimestamp(timestamp);
+    eir.setEvtType(static_cast<AD_PDU_Type>(evtType));
+    eir.setAddressType(getAddressType());
+    eir.setAddress(address);
+    eir.setRSSI(rssi);
+    return eir.read_data(data, length);
+}
+
+std::string DBTBrokerRing::Record::toString() const {
+    std::string res("Record[type "+std::to_string(static_cast<int>(type))+", ts "+std::to_string(timestamp)+
+                    ", address["+address.toString()+", "+getBDAddressTypeString(getAddressType())+"]");
+    if( RecordType::ADV_SIGHTING == type ) {
+        res.append(", "+getAD_PDU_TypeString(static_cast<AD_PDU_Type>(evtType))+", rssi "+std::to_string(rssi));
+    } else {
+        res.append(", handle "+uint16HexString(handle));
+    }
+    res.append(", len "+std::to_string(length)+"/"+std::to_string(origLength)+"]");
+    return res;
+}
+
+DBTBrokerPublisher::DBTBrokerPublisher(const std::string & path_, const uint32_t slotCount_)
+: path(path_), slotCount(getBrokerSlotCount(slotCount_)), memfd(-1), serverSocket(-1),
+  mapSize(DBTBrokerRing::getMapSize(slotCount)), map(nullptr), header(nullptr), slots(nullptr), slotMask(slotCount-1),
+  clientCount(0), running(false), hci(nullptr),
+  notificationListener(std::make_shared<NotificationListener>(*this))
+{
+    memfd = static_cast<int>( ::syscall(SYS_memfd_create, "direct_bt.broker", MFD_CLOEXEC | MFD_ALLOW_SEALING) );
+    if( 0 > memfd ) {
+        throw InternalError("DBTBrokerPublisher: memfd_create failed, errno "+std::to_string(errno), E_FILE_LINE);
+    }
+    void * m = MAP_FAILED;
+    if( 0 == ::ftruncate(memfd, static_cast<off_t>(mapSize)) ) {
+        m = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    }
+    if( MAP_FAILED == m ) {
+        const int err = errno;
+        ::close(memfd);
+        throw InternalError("DBTBrokerPublisher: Mapping "+std::to_string(mapSize)+" bytes failed, errno "+std::to_string(err), E_FILE_LINE);
+    }
+    map = static_cast<uint8_t*>(m);
+    header = new (map) DBTBrokerRing::Header();
+    header->magic = DBTBrokerRing::MAGIC;
+    header->version = DBTBrokerRing::VERSION;
+    header->slotCount = slotCount;
+    header->slotSize = sizeof(DBTBrokerRing::Slot);
+    header->writeCount.store(0, std::memory_order_relaxed);
+    header->futexWord.store(0, std::memory_order_relaxed);
+    slots = reinterpret_cast<DBTBrokerRing::Slot*>(map + sizeof(DBTBrokerRing::Header));
+    for(uint32_t i=0; i<slotCount; i++) {
+        new (&slots[i]) DBTBrokerRing::Slot();
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    // Our writable mapping persists, clients are limited to read-only mappings if F_SEAL_FUTURE_WRITE is supported (Linux >= 5.1)
+    if( 0 != ::fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) ) {
+        WARN_PRINT("DBTBrokerPublisher: F_SEAL_FUTURE_WRITE not supported, errno %d", errno);
+        ::fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+    }
+
+    struct sockaddr_un addr;
+    serverSocket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool ok = 0 <= serverSocket && setSocketPath(addr, path);
+    if( ok ) {
+        ::unlink(path.c_str());
+        ok = 0 == ::bind(serverSocket, (struct sockaddr *) &addr, sizeof(addr)) && 0 == ::listen(serverSocket, 16);
+    }
+    if( !ok ) {
+        const int err = errno;
+        if( 0 <= serverSocket ) {
+            ::close(serverSocket);
+        }
+        ::munmap(map, mapSize);
+        ::close(memfd);
+        throw InternalError("DBTBrokerPublisher: Serving at '"+path+"' failed, errno "+std::to_string(err), E_FILE_LINE);
+    }
+    running = true;
+    serverThread = std::thread(&DBTBrokerPublisher::serverImpl, this);
+    INFO_PRINT("DBTBrokerPublisher: Started at %s, %u slots, %zd bytes", path.c_str(), slotCount, mapSize);
+}
+
+DBTBrokerPublisher::~DBTBrokerPublisher() {
+    DBG_PRINT("DBTBrokerPublisher: Stopping: %s", toString().c_str());
+    detach();
+    running = false;
+    ::shutdown(serverSocket, SHUT_RDWR); // unblocks accept
+    if( serverThread.joinable() ) {
+        serverThread.join();
+    }
+    ::close(serverSocket);
+    ::unlink(path.c_str());
+    ::munmap(map, mapSize);
+    ::close(memfd);
+}
+
+void DBTBrokerPublisher::serverImpl() {
+    while( running ) {
+        const int fd = ::accept4(serverSocket, nullptr, nullptr, SOCK_CLOEXEC);
+        if( 0 > fd ) {
+            if( running && ( EINTR == errno || ECONNABORTED == errno ) ) {
+                continue;
+            }
+            if( running ) {
+                ERR_PRINT("DBTBrokerPublisher::server: accept failed, errno %d", errno);
+            }
+            break;
+        }
+        // One marker octet carrying the memfd as ancillary data
+        uint8_t marker = 'B';
+        struct iovec iov = { &marker, 1 };
+        union {
+            struct cmsghdr align;
+            uint8_t buf[CMSG_SPACE(sizeof(int))];
+        } control;
+        bzero(&control, sizeof(control));
+        struct msghdr msg;
+        bzero(&msg, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+        clientCount++; // before the client may observe the ring
+        if( 0 > ::sendmsg(fd, &msg, MSG_NOSIGNAL) ) {
+            WARN_PRINT("DBTBrokerPublisher::server: Sending ring failed, errno %d", errno);
+            clientCount--;
+        }
+        ::close(fd);
+    }
+    DBG_PRINT("DBTBrokerPublisher::server: Ended: %s", path.c_str());
+}
+
+void DBTBrokerPublisher::attach(HCIHandler & hci_) {
+    detach();
+    hci = &hci_;
+    hci->addAdvertisingReportBatchCallback(bindMemberFunc(this, &DBTBrokerPublisher::advertisingReportBatchHCI));
+}
+
+void DBTBrokerPublisher::detach() {
+    if( nullptr != hci ) {
+        hci->removeAdvertisingReportBatchCallback(bindMemberFunc(this, &DBTBrokerPublisher::advertisingReportBatchHCI));
+        hci = nullptr;
+    }
+}
+
+bool DBTBrokerPublisher::advertisingReportBatchHCI(const EInfoReportBatch & batch) {
+    publish(batch);
+    return true;
+}
+
+DBTBrokerRing::Slot & DBTBrokerPublisher::claim(uint64_t & n) {
+    n = header->writeCount.fetch_add(1, std::memory_order_acq_rel);
+    DBTBrokerRing::Slot & slot = slots[n & slotMask];
+    slot.sequence.store(2*n+1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // odd sequence visible before any record data
+    return slot;
+}
+
+void DBTBrokerPublisher::commit(DBTBrokerRing::Slot & slot, const uint64_t n) {
+    slot.sequence.store(2*n+2, std::memory_order_release);
+}
+
+void DBTBrokerPublisher::wake() {
+    header->futexWord.fetch_add(1, std::memory_order_release);
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&header->futexWord), FUTEX_OP_WAKE_SHARED, INT_MAX, nullptr, nullptr, 0);
+}
+
+void DBTBrokerPublisher::encode(const EInfoReport & eir) {
+    uint64_t n;
+    DBTBrokerRing::Slot & slot = claim(n);
+    DBTBrokerRing::Record & r = slot.record;
+    r.timestamp = eir.getTimestamp();
+    r.address = eir.getAddress();
+    r.addressType = static_cast<uint8_t>(eir.getAddressType());
+    r.type = DBTBrokerRing::RecordType::ADV_SIGHTING;
+    r.handle = 0;
+    r.rssi = eir.getRSSI();
+    r.evtType = static_cast<uint8_t>(eir.getEvtType());
+
+    TOctets buffer(r.data, DBTBrokerRing::SLOT_DATA_SIZE);
+    ADWriter w(buffer);
+    if( eir.isSet(EIRDataType::FLAGS) ) {
+        w.addFlags(eir.getFlags());
+    }
+    if( eir.isSet(EIRDataType::NAME) ) {
+        const std::string & name = eir.getName();
+        w.add(GAP_T::NAME_LOCAL_COMPLETE, reinterpret_cast<const uint8_t*>(name.c_str()), static_cast<int>(name.size()));
+    } else if( eir.isSet(EIRDataType::NAME_SHORT) ) {
+        const std::string & name = eir.getShortName();
+        w.add(GAP_T::NAME_LOCAL_SHORT, reinterpret_cast<const uint8_t*>(name.c_str()), static_cast<int>(name.size()));
+    }
+    if( eir.isSet(EIRDataType::TX_POWER) ) {
+        w.addTxPower(eir.getTxPower());
+    }
+    if( eir.isSet(EIRDataType::APPEARANCE) ) {
+        w.addAppearance(eir.getAppearance());
+    }
+    if( eir.isSet(EIRDataType::MANUF_DATA) ) {
+        const std::shared_ptr<ManufactureSpecificData> msd = eir.getManufactureSpecificData();
+        if( nullptr != msd ) {
+            uint8_t * p = w.addManufacturerData(msd->company, msd->data.getSize());
+            if( nullptr != p && 0 < msd->data.getSize() ) {
+                memcpy(p, msd->data.get_ptr(), msd->data.getSize());
+            }
+        }
+    }
+    // One complete service UUID list per UUID size, SERVICE_UUID is not part of the EIRDataType mask
+    const std::vector<uuid_value_t> & services = eir.getServices();
+    static const uuid_t::TypeSize sizes[] = { uuid_t::TypeSize::UUID16_SZ, uuid_t::TypeSize::UUID32_SZ, uuid_t::TypeSize::UUID128_SZ };
+    static const GAP_T types[] = { GAP_T::UUID16_COMPLETE, GAP_T::UUID32_COMPLETE, GAP_T::UUID128_COMPLETE };
+    for(int i=0; i<3; i++) {
+        int count = 0;
+        for(const uuid_value_t & u : services) {
+            count += sizes[i] == u.getTypeSize() ? 1 : 0;
+        }
+        uint8_t * p = 0 < count ? w.addField(types[i], count * sizes[i]) : nullptr;
+        if( nullptr != p ) {
+            for(const uuid_value_t & u : services) {
+                if( sizes[i] == u.getTypeSize() ) {
+                    memcpy(p, u.data(), sizes[i]);
+                    p += sizes[i];
+                }
+            }
+        }
+    }
+    r.length = static_cast<uint16_t>( w.getSize() );
+    r.origLength = r.length;
+    commit(slot, n);
+}
+
+void DBTBrokerPublisher::publish(const EInfoReportBatch & batch) {
+    for(size_t i=0; i<batch.size(); i++) {
+        encode(*batch[i]);
+    }
+    if( 0 < batch.size() ) {
+        wake();
+    }
+}
+
+void DBTBrokerPublisher::publish(const EInfoReport & eir) {
+    encode(eir);
+    wake();
+}
+
+void DBTBrokerPublisher::publish(const EUI48 & address, const BDAddressType addressType, const uint16_t handle,
+                                 const TROOctets & value, const uint64_t timestamp, const bool indication) {
+    uint64_t n;
+    DBTBrokerRing::Slot & slot = claim(n);
+    DBTBrokerRing::Record & r = slot.record;
+    r.timestamp = timestamp;
+    r.address = address;
+    r.addressType = static_cast<uint8_t>(addressType);
+    r.type = indication ? DBTBrokerRing::RecordType::GATT_INDICATION : DBTBrokerRing::RecordType::GATT_NOTIFICATION;
+    r.handle = handle;
+    r.rssi = 127;
+    r.evtType = 0;
+    r.origLength = static_cast<uint16_t>( value.getSize() );
+    r.length = static_cast<uint16_t>( std::min<int>(value.getSize(), DBTBrokerRing::SLOT_DATA_SIZE) );
+    if( 0 < r.length ) {
+        memcpy(r.data, value.get_ptr(), r.length);
+    }
+    commit(slot, n);
+    wake();
+}
+
+void DBTBrokerPublisher::NotificationListener::notificationValueReceived(GATTCharacteristicRef charDecl,
+                                                                         const TROOctets & charValue, const uint64_t timestamp) {
+    const std::shared_ptr<DBTDevice> device = charDecl->getDeviceUnchecked();
+    if( nullptr != device ) {
+        publisher.publish(device->getAddress(), device->getAddressType(), charDecl->value_handle, charValue, timestamp, false);
+    }
+}
+
+void DBTBrokerPublisher::NotificationListener::indicationValueReceived(GATTCharacteristicRef charDecl,
+                                                                       const TROOctets & charValue, const uint64_t timestamp,
+                                                                       const bool confirmationSent) {
+    (void)confirmationSent;
+    const std::shared_ptr<DBTDevice> device = charDecl->getDeviceUnchecked();
+    if( nullptr != device ) {
+        publisher.publish(device->getAddress(), device->getAddressType(), charDecl->value_handle, charValue, timestamp, true);
+    }
+}
+
+std::string DBTBrokerPublisher::toString() const {
+    return "DBTBrokerPublisher["+path+", slots "+std::to_string(slotCount)+", published "+std::to_string(getWriteCount())+
+           ", clients "+std::to_string(getClientCount())+"]";
+}
+
+DBTBrokerClient::DBTBrokerClient(const std::string & path)
+: memfd(-1), mapSize(0), map(nullptr), header(nullptr), slots(nullptr), slotMask(0),
+  readPos(0), readCount(0), lostCount(0)
+{
+    struct sockaddr_un addr;
+    const int sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if( 0 > sock || !setSocketPath(addr, path) || 0 != ::connect(sock, (struct sockaddr *) &addr, sizeof(addr)) ) {
+        const int err = errno;
+        if( 0 <= sock ) {
+            ::close(sock);
+        }
+        throw InternalError("DBTBrokerClient: Connecting to '"+path+"' failed, errno "+std::to_string(err), E_FILE_LINE);
+    }
+    uint8_t marker;
+    struct iovec iov = { &marker, 1 };
+    union {
+        struct cmsghdr align;
+        uint8_t buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr msg;
+    bzero(&msg, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    const ssize_t len = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    ::close(sock);
+    const struct cmsghdr * cmsg = 0 < len ? CMSG_FIRSTHDR(&msg) : nullptr;
+    if( nullptr == cmsg || SOL_SOCKET != cmsg->cmsg_level || SCM_RIGHTS != cmsg->cmsg_type ) {
+        throw InternalError("DBTBrokerClient: No ring received from '"+path+"'", E_FILE_LINE);
+    }
+    memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+
+    const off_t size = ::lseek(memfd, 0, SEEK_END); // w/o fstat, <sys/stat.h> clashes with linux_kernel_types.hpp
+    void * m = MAP_FAILED;
+    if( 0 < size && sizeof(DBTBrokerRing::Header) <= static_cast<size_t>(size) ) {
+        mapSize = static_cast<size_t>(size);
+        m = ::mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, memfd, 0);
+    }
+    if( MAP_FAILED == m ) {
+        const int err = errno;
+        ::close(memfd);
+        throw InternalError("DBTBrokerClient: Mapping ring of '"+path+"' failed, errno "+std::to_string(err), E_FILE_LINE);
+    }
+    map = static_cast<const uint8_t*>(m);
+    header = reinterpret_cast<const DBTBrokerRing::Header*>(map);
+    if( DBTBrokerRing::MAGIC != header->magic || DBTBrokerRing::VERSION != header->version ||
+        sizeof(DBTBrokerRing::Slot) != header->slotSize || 0 == header->slotCount ||
+        DBTBrokerRing::getMapSize(header->slotCount) > mapSize )
+    {
+        ::munmap(const_cast<uint8_t*>(map), mapSize);
+        ::close(memfd);
+        throw InternalError("DBTBrokerClient: Incompatible ring of '"+path+"'", E_FILE_LINE);
+    }
+    slots = reinterpret_cast<const DBTBrokerRing::Slot*>(map + sizeof(DBTBrokerRing::Header));
+    slotMask = header->slotCount - 1;
+    readPos = header->writeCount.load(std::memory_order_acquire);
+}
+
+DBTBrokerClient::~DBTBrokerClient() {
+    ::munmap(const_cast<uint8_t*>(map), mapSize);
+    ::close(memfd);
+}
+
+uint64_t DBTBrokerClient::getAvailable() const {
+    const uint64_t wc = header->writeCount.load(std::memory_order_acquire);
+    return std::min<uint64_t>(wc - readPos, header->slotCount);
+}
+
+bool DBTBrokerClient::next(DBTBrokerRing::Record & dest, const int timeoutMS) {
+    const uint64_t t0 = 0 < timeoutMS ? getCurrentMilliseconds() : 0;
+    for(;;) {
+        const int futexValue = header->futexWord.load(std::memory_order_acquire);
+        const uint64_t wc = header->writeCount.load(std::memory_order_acquire);
+        if( readPos < wc ) {
+            if( wc - readPos > header->slotCount ) {
+                // Lagging more than the ring's capacity, skip to the oldest retained record
+                lostCount += wc - header->slotCount - readPos;
+                readPos = wc - header->slotCount;
+            }
+            const DBTBrokerRing::Slot & slot = slots[readPos & slotMask];
+            const uint64_t expSeq = 2*readPos+2;
+            const uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            if( expSeq == seq ) {
+                const size_t hdrSize = offsetof(DBTBrokerRing::Record, data);
+                memcpy(static_cast<void*>(&dest), &slot.record, hdrSize);
+                dest.length = std::min<uint16_t>(dest.length, DBTBrokerRing::SLOT_DATA_SIZE);
+                memcpy(dest.data, slot.record.data, dest.length);
+                std::atomic_thread_fence(std::memory_order_acquire); // record data read before re-validation
+                if( expSeq == slot.sequence.load(std::memory_order_relaxed) ) {
+                    readPos++;
+                    readCount++;
+                    return true;
+                }
+                lostCount++; // overwritten while copying
+                readPos++;
+                continue;
+            } else if( expSeq < seq ) {
+                lostCount++; // overwritten by a later record
+                readPos++;
+                continue;
+            } // else claimed but not yet committed, wait for its wake-up
+        }
+        if( 0 == timeoutMS ) {
+            return false;
+        }
+        struct timespec ts;
+        struct timespec * tsp = nullptr;
+        if( 0 < timeoutMS ) {
+            const int64_t left = static_cast<int64_t>(t0) + timeoutMS - getCurrentMilliseconds();
+            if( 0 >= left ) {
+                return false;
+            }
+            ts.tv_sec = left / 1000;
+            ts.tv_nsec = ( left % 1000 ) * 1000000L;
+            tsp = &ts;
+        }
+        // Returns immediately with EAGAIN if a publish happened meanwhile, spurious wake-ups are handled by the loop
+        ::syscall(SYS_futex, reinterpret_cast<const int*>(&header->futexWord), FUTEX_OP_WAIT_SHARED, futexValue, tsp, nullptr, 0);
+    }
+}
@@ -31,6 +31,7 @@
 #include <cstdio>
 
 #include  <algorithm>
+#include <cstdlib>
 
 // #define VERBOSE_ON 1
 #include <dbt_debug.hpp>
@@ -39,18 +40,22 @@
 
 #include "DBTDevice.hpp"
 #include "DBTAdapter.hpp"
+#include "DBTMetrics.hpp"
 
 using namespace direct_bt;
 
 DBTDevice::DBTDevice(DBTAdapter & a, EInfoReport const & r)
-: adapter(a), ts_creation(r.getTimestamp()),
+: adapter(a), rssiHistory(HCIEnv::get().HCI_RSSI_WEIGHT), ts_creation(r.getTimestamp()),
   address(r.getAddress()), addressType(r.getAddressType()),
   leRandomAddressType(address.getBLERandomAddressType(addressType))
 {
     ts_last_discovery = ts_creation;
+    ts_connected_us = 0;
     hciConnHandle = 0;
+    advData = std::make_shared<const AdvertisedData>();
     isConnected = false;
     allowDisconnect = false;
+    discoveryPaused = false;
     if( !r.isSet(EIRDataType::BDADDR) ) {
         throw IllegalArgumentException("Address not set: "+r.toString(), E_FILE_LINE);
     }
@@ -75,8 +80,6 @@ DBTDevice::DBTDevice(DBTAdapter & a, EInfoReport const & r)
 DBTDevice::~DBTDevice() {
     DBG_PRINT("DBTDevice::dtor: ... %p %s", this, getAddressString().c_str());
     remove();
-    advServices.clear();
-    advMSD = nullptr;
     DBG_PRINT("DBTDevice::dtor: XXX %p %s", this, getAddressString().c_str());
 }
 
@@ -87,81 +90,81 @@ void DBTDevice::releaseSharedInstance() const {
     adapter.removeSharedDevice(*this);
 }
 
-bool DBTDevice::addAdvService(std::shared_ptr<uuid_t> const &uuid)
-{
-    if( 0 > findAdvService(uuid) ) {
-        advServices.push_back(uuid);
+bool DBTDevice::addRSSISample(const uint64_t timestamp, const int8_t rssi, const bool changed) {
+    rssiHistory.add(timestamp, rssi);
+    const int32_t delta = HCIEnv::get().HCI_RSSI_DELTA;
+    if( 0 >= delta ) {
+        return changed;
+    }
+    const int8_t smoothed = rssiHistory.getSmoothed();
+    if( RSSIHistory::RSSI_NONE == smoothed ) {
+        return false;
+    }
+    if( RSSIHistory::RSSI_NONE == rssi_notified || std::abs( smoothed - rssi_notified ) >= delta ) {
+        rssi_notified = smoothed;
         return true;
     }
     return false;
 }
-bool DBTDevice::addAdvServices(std::vector<std::shared_ptr<uuid_t>> const & services)
-{
-    bool res = false;
-    for(size_t j=0; j<services.size(); j++) {
-        const std::shared_ptr<uuid_t> uuid = services.at(j);
-        res = addAdvService(uuid) || res;
-    }
-    return res;
-}
 
-int DBTDevice::findAdvService(std::shared_ptr<uuid_t> const &uuid) const
-{
-    const size_t size = advServices.size();
-    for (size_t i = 0; i < size; i++) {
-        const std::shared_ptr<uuid_t> & e = advServices[i];
-        if ( nullptr != e && *uuid == *e ) {
-            return i;
-        }
-    }
-    return -1;
+std::vector<RSSIHistory::Sample> DBTDevice::getRSSIHistory() const {
+    const std::lock_guard<DBTRecursiveMutex> lock(const_cast<DBTDevice*>(this)->mtx_data); // RAII-style acquire and relinquish via destructor
+    return rssiHistory.toVector();
 }
 
-std::string const DBTDevice::getName() const {
-    const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTDevice*>(this)->mtx_data); // RAII-style acquire and relinquish via destructor
-    return name;
+uint32_t DBTDevice::getAdvertisingInterval() const {
+    const std::lock_guard<DBTRecursiveMutex> lock(const_cast<DBTDevice*>(this)->mtx_data); // RAII-style acquire and relinquish via destructor
+    return advInterval.getInterval();
 }
 
-std::shared_ptr<ManufactureSpecificData> const DBTDevice::getManufactureSpecificData() const {
-    const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTDevice*>(this)->mtx_data); // RAII-style acquire and relinquish via destructor
-    return advMSD;
+int DBTDevice::AdvertisedData::findService(uuid_value_t const &uuid) const
+{
+    const auto it = std::find(services.begin(), services.end(), uuid);
+    return it != services.end() ? static_cast<int>( it - services.begin() ) : -1;
 }
 
-std::vector<std::shared_ptr<uuid_t>> DBTDevice::getAdvertisedServices() const {
-    const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTDevice*>(this)->mtx_data); // RAII-style acquire and relinquish via destructor
-    return advServices;
+bool DBTDevice::addAdvServices(AdvertisedData & ad, std::vector<uuid_value_t> const & services)
+{
+    bool res = false;
+    for(size_t j=0; j<services.size(); j++) {
+        if( 0 > ad.findService(services[j]) ) {
+            ad.services.push_back(services[j]);
+            res = true;
+        }
+    }
+    return res;
 }
 
 std::string DBTDevice::toString(bool includeDiscoveredServices) const {
-    const std::lock_guard<std::recursive_mutex> lock(const_cast<DBTDevice*>(this)->mtx_data); // RAII-style acquire and relinquish via destructor
+    const std::shared_ptr<const AdvertisedData> ad = getAdvertisedData();
     const uint64_t t0 = getCurrentMilliseconds();
     std::string leaddrtype;
     if( BLERandomAddressType::UNDEFINED != leRandomAddressType ) {
         leaddrtype = ", random "+getBLERandomAddressTypeString(leRandomAddressType);
     }
-    std::string msdstr = nullptr != advMSD ? advMSD->toString() : "MSD[null]";
-    std::string out("Device[address["+getAddressString()+", "+getBDAddressTypeString(getAddressType())+leaddrtype+"], name['"+name+
-            "'], age[total "+std::to_string(t0-ts_creation)+", ldisc "+std::to_string(t0-ts_last_discovery)+", lup "+std::to_string(t0-ts_last_update)+
-            "]ms, connected["+std::to_string(allowDisconnect)+"/"+std::to_string(isConnected)+", "+uint16HexString(hciConnHandle)+"], rssi "+std::to_string(getRSSI())+
-            ", tx-power "+std::to_string(tx_power)+
-            ", appearance "+uint16HexString(static_cast<uint16_t>(appearance))+" ("+getAppearanceCatString(appearance)+
+    std::string msdstr = nullptr != ad->msd ? ad->msd->toString() : "MSD[null]";
+    std::string out("Device[address["+getAddressString()+", "+getBDAddressTypeString(getAddressType())+leaddrtype+"], name['"+*ad->name+
+            "'], age[total "+std::to_string(t0-ts_creation)+", ldisc "+std::to_string(t0-ts_last_discovery.load())+", lup "+std::to_string(t0-ts_last_update.load())+
+            "]ms, connected["+std::to_string(allowDisconnect)+"/"+std::to_string(isConnected)+", "+uint16HexString(hciConnHandle)+"], rssi "+std::to_string(ad->rssi)+" (smoothed "+std::to_string(ad->rssi_smoothed)+")"+
+            ", tx-power "+std::to_string(ad->tx_power)+
+            ", appearance "+uint16HexString(static_cast<uint16_t>(ad->appearance))+" ("+getAppearanceCatString(ad->appearance)+
             "), "+msdstr+", "+javaObjectToString()+"]");
-    if(includeDiscoveredServices && advServices.size() > 0 ) {
+    if(includeDiscoveredServices && ad->services.size() > 0 ) {
         out.append("\n");
-        const size_t size = advServices.size();
+        const size_t size = ad->services.size();
         for (size_t i = 0; i < size; i++) {
-            const std::shared_ptr<uuid_t> & e = advServices[i];
+            const uuid_value_t & e = ad->services[i];
             if( 0 < i ) {
                 out.append("\n");
             }
-            out.append("  ").append(e->toUUID128String()).append(", ").append(std::to_string(static_cast<int>(e->getTypeSize()))).append(" bytes");
+            out.append("  ").append(e.toUUID128String()).append(", ").append(std::to_string(static_cast<int>(e.getTypeSize()))).append(" bytes");
         }
     }
     return out;
 }
 
-EIRDataType DBTDevice::update(EInfoReport const & data) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_data); // RAII-style acquire and relinquish via destructor
+EIRDataType DBTDevice::update(EInfoReport const & data, EInfoReport * movable) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_data); // RAII-style acquire and relinquish via destructor
 
     EIRDataType res = EIRDataType::NONE;
     ts_last_update = data.getTimestamp();
@@ -177,61 +180,98 @@ EIRDataType DBTDevice::update(EInfoReport const & data) {
                     data.toString().c_str(), this->toString().c_str());
         }
     }
-    if( data.isSet(EIRDataType::NAME) ) {
-        if( 0 == name.length() || data.getName().length() > name.length() ) {
-            name = data.getName();
+    // Modify an unpublished copy, only published if changed
+    const std::shared_ptr<const AdvertisedData> cur = getAdvertisedData();
+    std::shared_ptr<AdvertisedData> ad = nullptr;
+    auto mod = [&]() -> AdvertisedData & {
+        if( nullptr == ad ) {
+            ad = std::make_shared<AdvertisedData>(*cur);
+        }
+        return *ad;
+    };
+    InternTable & internTable = adapter.getInternTable();
+    if( data.isSet(EIRDataType::NAME) && !data.isNameEqual(*cur->name) ) {
+        // an unchanged name is compared w/o materializing it
+        if( 0 == cur->name->length() || data.getName().length() > cur->name->length() ) {
+            mod().name = nullptr != movable ? internTable.intern(movable->takeName()) : internTable.intern(data.getName());
             setEIRDataTypeSet(res, EIRDataType::NAME);
         }
     }
     if( data.isSet(EIRDataType::NAME_SHORT) ) {
-        if( 0 == name.length() ) {
-            name = data.getShortName();
+        if( 0 == ( nullptr != ad ? ad->name : cur->name )->length() ) {
+            mod().name = nullptr != movable ? internTable.intern(movable->takeShortName()) : internTable.intern(data.getShortName());
             setEIRDataTypeSet(res, EIRDataType::NAME_SHORT);
         }
     }
     if( data.isSet(EIRDataType::RSSI) ) {
-        if( rssi != data.getRSSI() ) {
-            rssi = data.getRSSI();
+        // only advertising reports carry the RSSI, i.e. are sightings of an advertising event
+        advInterval.add(data.getTimestamp());
+        if( addRSSISample(data.getTimestamp(), data.getRSSI(), cur->rssi != data.getRSSI()) ) {
             setEIRDataTypeSet(res, EIRDataType::RSSI);
         }
+        const int8_t smoothed = rssiHistory.getSmoothed();
+        if( cur->rssi != data.getRSSI() || cur->rssi_smoothed != smoothed ) {
+            AdvertisedData & m = mod();
+            m.rssi = data.getRSSI();
+            m.rssi_smoothed = smoothed;
+        }
     }
     if( data.isSet(EIRDataType::TX_POWER) ) {
-        if( tx_power != data.getTxPower() ) {
-            tx_power = data.getTxPower();
+        if( cur->tx_power != data.getTxPower() ) {
+            mod().tx_power = data.getTxPower();
             setEIRDataTypeSet(res, EIRDataType::TX_POWER);
         }
     }
     if( data.isSet(EIRDataType::APPEARANCE) ) {
-        if( appearance != data.getAppearance() ) {
-            appearance = data.getAppearance();
+        if( cur->appearance != data.getAppearance() ) {
+            mod().appearance = data.getAppearance();
             setEIRDataTypeSet(res, EIRDataType::APPEARANCE);
         }
     }
     if( data.isSet(EIRDataType::MANUF_DATA) ) {
-        if( advMSD != data.getManufactureSpecificData() ) {
-            advMSD = data.getManufactureSpecificData();
+        std::shared_ptr<ManufactureSpecificData> msd = internTable.intern(
+                nullptr != movable ? movable->takeManufactureSpecificData() : data.getManufactureSpecificData() );
+        // interned instances are compared by pointer, large payloads by content
+        if( cur->msd != msd && ( nullptr == cur->msd || nullptr == msd || *cur->msd != *msd ) ) {
+            mod().msd = std::move(msd);
             setEIRDataTypeSet(res, EIRDataType::MANUF_DATA);
         }
     }
-    if( addAdvServices( data.getServices() ) ) {
-        setEIRDataTypeSet(res, EIRDataType::SERVICE_UUID);
+    const std::vector<uuid_value_t> & services = data.getServices();
+    for(size_t j=0; j<services.size(); j++) {
+        if( 0 > cur->findService(services[j]) ) {
+            if( nullptr != movable && 0 == cur->services.size() ) {
+                mod().services = movable->takeServices(); // unique set already
+            } else {
+                addAdvServices(mod(), services);
+            }
+            setEIRDataTypeSet(res, EIRDataType::SERVICE_UUID);
+            break;
+        }
+    }
+    if( nullptr != ad ) {
+        setAdvertisedData(ad);
     }
     return res;
 }
 
 EIRDataType DBTDevice::update(GenericAccess const &data, const uint64_t timestamp) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_data); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_data); // RAII-style acquire and relinquish via destructor
 
     EIRDataType res = EIRDataType::NONE;
     ts_last_update = timestamp;
-    if( 0 == name.length() || data.deviceName.length() > name.length() ) {
-        name = data.deviceName;
+    std::shared_ptr<AdvertisedData> ad = std::make_shared<AdvertisedData>(*getAdvertisedData());
+    if( 0 == ad->name->length() || data.deviceName.length() > ad->name->length() ) {
+        ad->name = adapter.getInternTable().intern(data.deviceName);
         setEIRDataTypeSet(res, EIRDataType::NAME);
     }
-    if( appearance != data.appearance ) {
-        appearance = data.appearance;
+    if( ad->appearance != data.appearance ) {
+        ad->appearance = data.appearance;
         setEIRDataTypeSet(res, EIRDataType::APPEARANCE);
     }
+    if( EIRDataType::NONE != res ) {
+        setAdvertisedData(ad);
+    }
     return res;
 }
 
@@ -240,13 +280,23 @@ std::shared_ptr<ConnectionInfo> DBTDevice::getConnectionInfo() {
     std::shared_ptr<ConnectionInfo> connInfo = mgmt.getConnectionInfo(adapter.dev_id, address, addressType);
     if( nullptr != connInfo ) {
         EIRDataType updateMask = EIRDataType::NONE;
-        if( rssi != connInfo->getRSSI() ) {
-            rssi = connInfo->getRSSI();
-            setEIRDataTypeSet(updateMask, EIRDataType::RSSI);
-        }
-        if( tx_power != connInfo->getTxPower() ) {
-            tx_power = connInfo->getTxPower();
-            setEIRDataTypeSet(updateMask, EIRDataType::TX_POWER);
+        {
+            const std::lock_guard<DBTRecursiveMutex> lock(mtx_data); // RAII-style acquire and relinquish via destructor
+            std::shared_ptr<AdvertisedData> ad = std::make_shared<AdvertisedData>(*getAdvertisedData());
+            const bool rssiChanged = ad->rssi != connInfo->getRSSI();
+            if( addRSSISample(getCurrentMilliseconds(), connInfo->getRSSI(), rssiChanged) ) {
+                setEIRDataTypeSet(updateMask, EIRDataType::RSSI);
+            }
+            const bool smoothedChanged = ad->rssi_smoothed != rssiHistory.getSmoothed();
+            ad->rssi = connInfo->getRSSI();
+            ad->rssi_smoothed = rssiHistory.getSmoothed();
+            if( ad->tx_power != connInfo->getTxPower() ) {
+                ad->tx_power = connInfo->getTxPower();
+                setEIRDataTypeSet(updateMask, EIRDataType::TX_POWER);
+            }
+            if( EIRDataType::NONE != updateMask || rssiChanged || smoothedChanged ) {
+                setAdvertisedData(ad);
+            }
         }
         if( EIRDataType::NONE != updateMask ) {
             std::shared_ptr<DBTDevice> sharedInstance = getSharedInstance();
@@ -264,7 +314,7 @@ HCIStatusCode DBTDevice::connectLE(uint16_t le_scan_interval, uint16_t le_scan_w
                                    uint16_t conn_interval_min, uint16_t conn_interval_max,
                                    uint16_t conn_latency, uint16_t supervision_timeout)
 {
-    const std::lock_guard<std::recursive_mutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
     adapter.checkValid();
 
     HCILEOwnAddressType hci_own_mac_type;
@@ -309,6 +359,12 @@ HCIStatusCode DBTDevice::connectLE(uint16_t le_scan_interval, uint16_t le_scan_w
             }
     }
 
+    // A resolved identity device is only reachable via its currently advertised RPA
+    EUI48 peerAddress = address;
+    if( adapter.getRPAResolver().getPrivateAddress(address, addressType, peerAddress) ) {
+        hci_peer_mac_type = HCILEPeerAddressType::RANDOM;
+    }
+
     if( isConnected ) {
         ERR_PRINT("DBTDevice::connectLE: Already connected: %s", toString().c_str());
         return HCIStatusCode::CONNECTION_ALREADY_EXISTS;
@@ -319,7 +375,10 @@ HCIStatusCode DBTDevice::connectLE(uint16_t le_scan_interval, uint16_t le_scan_w
         ERR_PRINT("DBTDevice::connectLE: HCI not available: %s", toString().c_str());
         return HCIStatusCode::INTERNAL_FAILURE;
     }
-    HCIStatusCode status = hci->le_create_conn(address,
+    if( !discoveryPaused && adapter.pauseDiscoveryForConnect() ) {
+        discoveryPaused = true; // resumed by the adapter on connect, failure or disconnect
+    }
+    HCIStatusCode status = hci->le_create_conn(peerAddress,
                                       hci_peer_mac_type, hci_own_mac_type,
                                       le_scan_interval, le_scan_window, conn_interval_min, conn_interval_max,
                                       conn_latency, supervision_timeout);
@@ -336,6 +395,9 @@ HCIStatusCode DBTDevice::connectLE(uint16_t le_scan_interval, uint16_t le_scan_w
         return 0;
     }
 #endif
+    if( HCIStatusCode::SUCCESS != status && discoveryPaused.exchange(false) ) {
+        adapter.resumeDiscoveryAfterConnect();
+    }
     if( HCIStatusCode::COMMAND_DISALLOWED == status ) {
         WARN_PRINT("DBTDevice::connectLE: Could not yet create connection: status 0x%2.2X (%s), errno %d, hci-atype[peer %s, own %s] %s on %s",
                 static_cast<uint8_t>(status), getHCIStatusCodeString(status).c_str(), errno, strerror(errno),
@@ -354,7 +416,7 @@ HCIStatusCode DBTDevice::connectLE(uint16_t le_scan_interval, uint16_t le_scan_w
 
 HCIStatusCode DBTDevice::connectBREDR(const uint16_t pkt_type, const uint16_t clock_offset, const uint8_t role_switch)
 {
-    const std::lock_guard<std::recursive_mutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
     adapter.checkValid();
 
     if( isConnected ) {
@@ -380,13 +442,39 @@ HCIStatusCode DBTDevice::connectBREDR(const uint16_t pkt_type, const uint16_t cl
     return status;
 }
 
+std::shared_ptr<const DBTProfile> DBTDevice::getEffectiveProfile() const {
+    std::shared_ptr<const DBTProfile> p = std::atomic_load(&profile);
+    return nullptr != p ? p : adapter.getProfile();
+}
+
+HCIStatusCode DBTDevice::connectLEAuto(const uint16_t conn_interval_min, const uint16_t conn_interval_max,
+                                       const uint16_t conn_latency, const uint16_t supervision_timeout)
+{
+    const uint32_t advIntervalMS = getAdvertisingInterval();
+    const uint16_t le_scan_window = AdvIntervalEstimator::getConnectScanWindow(advIntervalMS);
+    DBG_PRINT("DBTDevice::connectLEAuto: advInterval %u ms -> scan interval/window %u: %s",
+            advIntervalMS, le_scan_window, toString().c_str());
+    return connectLE(le_scan_window, le_scan_window, conn_interval_min, conn_interval_max, conn_latency, supervision_timeout);
+}
+
 HCIStatusCode DBTDevice::connectDefault()
 {
     switch( addressType ) {
         case BDAddressType::BDADDR_LE_PUBLIC:
             /* fall through intended */
-        case BDAddressType::BDADDR_LE_RANDOM:
-            return connectLE();
+        case BDAddressType::BDADDR_LE_RANDOM: {
+            const std::shared_ptr<const DBTProfile> p = getEffectiveProfile();
+            if( nullptr == p ) {
+                return connectLE();
+            }
+            // Unset profile values use the connectLE() defaults
+            return connectLE(0 < p->le_scan_interval ? p->le_scan_interval : 48,
+                             0 < p->le_scan_window ? p->le_scan_window : 48,
+                             0 < p->conn_interval_min ? p->conn_interval_min : 0x000F,
+                             0 < p->conn_interval_max ? p->conn_interval_max : 0x000F,
+                             0 <= p->conn_latency ? static_cast<uint16_t>(p->conn_latency) : 0x0000,
+                             0 < p->supervision_timeout ? p->supervision_timeout : number(HCIConstInt::LE_CONN_TIMEOUT_MS)/10);
+        }
         case BDAddressType::BDADDR_BREDR:
             return connectBREDR();
         default:
@@ -395,17 +483,82 @@ HCIStatusCode DBTDevice::connectDefault()
     }
 }
 
+HCIStatusCode DBTDevice::optimizeLink(const char * profile, const bool maxDataLength,
+                                      const uint16_t conn_interval_min, const uint16_t conn_interval_max)
+{
+    const std::lock_guard<DBTRecursiveMutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
+    adapter.checkValid();
+
+    const uint16_t handle = hciConnHandle;
+    if( !isConnected || 0 == handle ) {
+        ERR_PRINT("DBTDevice::%s: Not connected: %s", profile, toString().c_str());
+        return HCIStatusCode::UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    if( !isLEAddressType() ) {
+        ERR_PRINT("DBTDevice::%s: Not a BDADDR_LE_PUBLIC or BDADDR_LE_RANDOM address: %s", profile, toString().c_str());
+        return HCIStatusCode::UNACCEPTABLE_CONNECTION_PARAM;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        ERR_PRINT("DBTDevice::%s: HCI not available: %s", profile, toString().c_str());
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCIStatusCode res = HCIStatusCode::SUCCESS;
+    if( maxDataLength && hci->isLEDataLenExtSupported() ) {
+        const ControllerCaps & caps = hci->getControllerCaps();
+        const HCIStatusCode status = hci->le_set_data_length(handle, caps.getDataLenTxOctets(), caps.getDataLenTxTime());
+        if( HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("DBTDevice::%s: le_set_data_length: status 0x%2.2X (%s) on %s", profile,
+                    number(status), getHCIStatusCodeString(status).c_str(), toString().c_str());
+            res = status;
+        }
+    }
+    if( hci->isLE2MPHYSupported() ) {
+        const HCIStatusCode status = hci->le_set_phy(handle, HCI_LE_SET_PHY_2M, HCI_LE_SET_PHY_2M);
+        if( HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("DBTDevice::%s: le_set_phy: status 0x%2.2X (%s) on %s", profile,
+                    number(status), getHCIStatusCodeString(status).c_str(), toString().c_str());
+            if( HCIStatusCode::SUCCESS == res ) {
+                res = status;
+            }
+        }
+    }
+    {
+        const HCIStatusCode status = hci->le_conn_update(handle, conn_interval_min, conn_interval_max);
+        if( HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("DBTDevice::%s: le_conn_update: status 0x%2.2X (%s) on %s", profile,
+                    number(status), getHCIStatusCodeString(status).c_str(), toString().c_str());
+            if( HCIStatusCode::SUCCESS == res ) {
+                res = status;
+            }
+        }
+    }
+    DBG_PRINT("DBTDevice::%s: status 0x%2.2X (%s) on %s", profile, number(res), getHCIStatusCodeString(res).c_str(), toString().c_str());
+    return res;
+}
+
+HCIStatusCode DBTDevice::optimizeForThroughput() {
+    return optimizeLink("optimizeForThroughput", true /* maxDataLength */, 0x0006 /* 7.5ms */, 0x000C /* 15ms */);
+}
+
+HCIStatusCode DBTDevice::optimizeForLatency() {
+    return optimizeLink("optimizeForLatency", false /* maxDataLength */, 0x0006 /* 7.5ms */, 0x0006 /* 7.5ms */);
+}
+
 void DBTDevice::notifyConnected(const uint16_t handle) {
     DBG_PRINT("DBTDevice::notifyConnected: handle %s -> %s, %s",
             uint16HexString(hciConnHandle).c_str(), uint16HexString(handle).c_str(), toString().c_str());
     isConnected = true;
     allowDisconnect = true;
     hciConnHandle = handle;
+    ts_connected_us = getCurrentMicroseconds();
+    openPendingGATT();
 }
 
 void DBTDevice::notifyDisconnected() {
     DBG_PRINT("DBTDevice::notifyDisconnected: handle %s -> zero, %s",
             uint16HexString(hciConnHandle).c_str(), toString().c_str());
+    failPendingGATT(HCIStatusCode::UNSPECIFIED_ERROR);
     try {
         // coming from disconnect callback, ensure cleaning up!
         disconnect(true /* fromDisconnectCB */, false /* ioErrorCause */);
@@ -414,7 +567,9 @@ void DBTDevice::notifyDisconnected() {
     }
     isConnected = false;
     allowDisconnect = false;
+    discoveryPaused = false;
     hciConnHandle = 0;
+    ts_connected_us = 0;
 }
 
 HCIStatusCode DBTDevice::disconnect(const bool fromDisconnectCB, const bool ioErrorCause, const HCIStatusCode reason) {
@@ -429,12 +584,14 @@ HCIStatusCode DBTDevice::disconnect(const bool fromDisconnectCB, const bool ioEr
         return HCIStatusCode::CONNECTION_TERMINATED_BY_LOCAL_HOST;
     }
     // Lock to avoid other threads connecting while disconnecting
-    const std::lock_guard<std::recursive_mutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock_conn(mtx_connect); // RAII-style acquire and relinquish via destructor
 
     INFO_PRINT("DBTDevice::disconnect: Start: isConnected %d/%d, fromDisconnectCB %d, ioError %d, reason 0x%X (%s), gattHandler %d, hciConnHandle %s",
             allowDisconnect.load(), isConnected.load(), fromDisconnectCB, ioErrorCause,
             static_cast<uint8_t>(reason), getHCIStatusCodeString(reason).c_str(),
             (nullptr != gattHandler), uint16HexString(hciConnHandle).c_str());
+    // Record the GATT session before its teardown, if not requested by the application
+    adapter.recordSessionDevice(*this, fromDisconnectCB || ioErrorCause);
     disconnectGATT();
 
     std::shared_ptr<HCIHandler> hci = adapter.getHCI();
@@ -480,13 +637,13 @@ void DBTDevice::remove() {
     releaseSharedInstance();
 }
 
-std::shared_ptr<GATTHandler> DBTDevice::connectGATT() {
+std::shared_ptr<GATTHandler> DBTDevice::connectGATT(const uint16_t clientMTU) {
     std::shared_ptr<DBTDevice> sharedInstance = getSharedInstance();
     if( nullptr == sharedInstance ) {
         throw InternalError("DBTDevice::connectGATT: Device unknown to adapter and not tracked: "+toString(), E_FILE_LINE);
     }
 
-    const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
     if( nullptr != gattHandler ) {
         if( gattHandler->isOpen() ) {
             return gattHandler;
@@ -499,21 +656,136 @@ std::shared_ptr<GATTHandler> DBTDevice::connectGATT() {
         return nullptr;
     }
 
-    gattHandler = std::shared_ptr<GATTHandler>(new GATTHandler(sharedInstance));
-    if( !gattHandler->connect() ) {
+    gattHandler = GATTHandler::create(sharedInstance, clientMTU);
+    const bool ok = gattHandler->connect();
+    if( !ok ) {
         DBG_PRINT("DBTDevice::connectGATT: Connection failed");
         gattHandler = nullptr;
     }
+    const uint64_t t0 = ts_connected_us.exchange(0); // once per link
+    if( 0 < t0 && DBTMetrics::get().isEnabled() ) {
+        DBTMetrics::get().getHistogram("gatt_connect_ready", "device", getAddressString()).recordSince(t0, ok);
+    }
     return gattHandler;
 }
 
+std::string GATTOpenReport::toString() const {
+    return "GATTOpen[status "+getHCIStatusCodeString(status)+", gatt "+std::to_string(nullptr != gatt)+
+           ", us[hci "+std::to_string(hciConnectUS)+", dispatch "+std::to_string(dispatchUS)+
+           ", l2cap "+std::to_string(l2capConnectUS)+", mtu "+std::to_string(mtuExchangeUS)+
+           ", total "+std::to_string(totalUS)+"]]";
+}
+
+std::future<GATTOpenReport> DBTDevice::connectAndOpenGATT(const uint16_t clientMTU) {
+    std::shared_ptr<std::promise<GATTOpenReport>> promise(new std::promise<GATTOpenReport>());
+    std::future<GATTOpenReport> res = promise->get_future();
+    failPendingGATT(HCIStatusCode::UNSPECIFIED_ERROR); // replaced
+    const uint64_t t0 = getCurrentMicroseconds();
+    {
+        const std::lock_guard<std::mutex> lock(mtx_gattOpen); // RAII-style acquire and relinquish via destructor
+        gattOpenPromise = promise;
+        gattOpenClientMTU = clientMTU;
+        gattOpenT0 = t0;
+    }
+    if( isConnected ) {
+        openPendingGATT(); // LE connection already established
+        return res;
+    }
+    const HCIStatusCode status = connectLE();
+    if( HCIStatusCode::SUCCESS != status ) {
+        failPendingGATT(status);
+    }
+    return res;
+}
+
+void DBTDevice::failPendingGATT(const HCIStatusCode status) {
+    std::shared_ptr<std::promise<GATTOpenReport>> promise;
+    GATTOpenReport report;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_gattOpen); // RAII-style acquire and relinquish via destructor
+        if( nullptr == gattOpenPromise ) {
+            return;
+        }
+        promise.swap(gattOpenPromise);
+        report.totalUS = getCurrentMicroseconds() - gattOpenT0;
+    }
+    report.status = status;
+    DBG_PRINT("DBTDevice::connectAndOpenGATT: Failed: %s: %s", report.toString().c_str(), toString().c_str());
+    promise->set_value(report);
+}
+
+void DBTDevice::openPendingGATT() {
+    std::shared_ptr<std::promise<GATTOpenReport>> promise;
+    uint16_t clientMTU;
+    uint64_t t0;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_gattOpen); // RAII-style acquire and relinquish via destructor
+        if( nullptr == gattOpenPromise ) {
+            return;
+        }
+        promise.swap(gattOpenPromise);
+        clientMTU = gattOpenClientMTU;
+        t0 = gattOpenT0;
+    }
+    std::shared_ptr<DBTDevice> sharedInstance = getSharedInstance();
+    const uint64_t t1 = getCurrentMicroseconds();
+    if( nullptr == sharedInstance ) {
+        GATTOpenReport report;
+        report.status = HCIStatusCode::INTERNAL_FAILURE;
+        report.hciConnectUS = t1 - t0;
+        report.totalUS = report.hciConnectUS;
+        promise->set_value(report);
+        return;
+    }
+    // Off the HCI event reader, as the L2CAP connect blocks
+    std::thread worker([sharedInstance, promise, clientMTU, t0, t1]() {
+        GATTOpenReport report;
+        report.status = HCIStatusCode::SUCCESS;
+        report.hciConnectUS = t1 - t0;
+        report.dispatchUS = getCurrentMicroseconds() - t1;
+        try {
+            report.gatt = sharedInstance->connectGATT(clientMTU);
+        } catch (std::exception &e) {
+            ERR_PRINT("DBTDevice::connectAndOpenGATT: Caught exception %s on %s", e.what(), sharedInstance->toString().c_str());
+        }
+        if( nullptr != report.gatt ) {
+            report.l2capConnectUS = report.gatt->getConnectL2CAPTime();
+            report.mtuExchangeUS = report.gatt->getConnectMTUTime();
+        }
+        report.totalUS = getCurrentMicroseconds() - t0;
+        DBG_PRINT("DBTDevice::connectAndOpenGATT: %s: %s", report.toString().c_str(), sharedInstance->toString().c_str());
+        promise->set_value(report);
+    });
+    worker.detach();
+}
+
+void DBTDevice::cancelConnectGATT() {
+    std::shared_ptr<GATTHandler> _gattHandler = gattHandler; // local instance w/o mtx_gatt, held by connectGATT(..)
+    if( nullptr != _gattHandler ) {
+        _gattHandler->cancelConnect();
+    }
+}
+
 std::shared_ptr<GATTHandler> DBTDevice::getGATTHandler() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
     return gattHandler;
 }
 
+bool DBTDevice::getTrafficSnapshot(TrafficSnapshot & res, const bool link) {
+    if( link ) {
+        std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+        return nullptr != hci && hci->getTrafficSnapshot(address, addressType, res);
+    }
+    std::shared_ptr<GATTHandler> gh = getGATTHandler();
+    if( nullptr == gh ) {
+        return false;
+    }
+    res = gh->getTrafficStats().getSnapshot();
+    return true;
+}
+
 std::vector<std::shared_ptr<GATTService>> DBTDevice::getGATTServices() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
     try {
         if( nullptr == gattHandler || !gattHandler->isOpen() ) {
             connectGATT();
@@ -531,20 +803,8 @@ std::vector<std::shared_ptr<GATTService>> DBTDevice::getGATTServices() {
             return gattServices;
         }
         // discovery success, retrieve and parse GenericAccess
-        gattGenericAccess = gattHandler->getGenericAccess(gattServices);
-        if( nullptr != gattGenericAccess ) {
-            const uint64_t ts = getCurrentMilliseconds();
-            EIRDataType updateMask = update(*gattGenericAccess, ts);
-            DBG_PRINT("DBTDevice::getGATTServices: updated %s:\n    %s\n    -> %s",
-                getEIRDataMaskString(updateMask).c_str(), gattGenericAccess->toString().c_str(), toString().c_str());
-            if( EIRDataType::NONE != updateMask ) {
-                std::shared_ptr<DBTDevice> sharedInstance = getSharedInstance();
-                if( nullptr == sharedInstance ) {
-                    ERR_PRINT("DBTDevice::getGATTServices: Device unknown to adapter and not tracked: %s", toString().c_str());
-                } else {
-                    adapter.sendDeviceUpdated("getGATTServices", sharedInstance, ts, updateMask);
-                }
-            }
+        if( !GATTEnv::get().GATT_GENERIC_ACCESS_LAZY ) {
+            readGATTGenericAccess(gattServices);
         }
         return gattServices;
     } catch (std::exception &e) {
@@ -553,8 +813,26 @@ std::vector<std::shared_ptr<GATTService>> DBTDevice::getGATTServices() {
     return std::vector<std::shared_ptr<GATTService>>();
 }
 
+void DBTDevice::readGATTGenericAccess(std::vector<GATTServiceRef> & gattServices) {
+    gattGenericAccess = gattHandler->getGenericAccess(gattServices);
+    if( nullptr != gattGenericAccess ) {
+        const uint64_t ts = getCurrentMilliseconds();
+        EIRDataType updateMask = update(*gattGenericAccess, ts);
+        DBG_PRINT("DBTDevice::getGATTServices: updated %s:\n    %s\n    -> %s",
+            getEIRDataMaskString(updateMask).c_str(), gattGenericAccess->toString().c_str(), toString().c_str());
+        if( EIRDataType::NONE != updateMask ) {
+            std::shared_ptr<DBTDevice> sharedInstance = getSharedInstance();
+            if( nullptr == sharedInstance ) {
+                ERR_PRINT("DBTDevice::getGATTServices: Device unknown to adapter and not tracked: %s", toString().c_str());
+            } else {
+                adapter.sendDeviceUpdated("getGATTServices", sharedInstance, ts, updateMask);
+            }
+        }
+    }
+}
+
 std::shared_ptr<GATTService> DBTDevice::findGATTService(std::shared_ptr<uuid_t> const &uuid) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
     const std::vector<std::shared_ptr<GATTService>> & gattServices = getGATTServices(); // reference of the GATTHandler's list
     const size_t size = gattServices.size();
     for (size_t i = 0; i < size; i++) {
@@ -567,7 +845,7 @@ std::shared_ptr<GATTService> DBTDevice::findGATTService(std::shared_ptr<uuid_t>
 }
 
 bool DBTDevice::pingGATT() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
     try {
         if( nullptr == gattHandler || !gattHandler->isOpen() ) {
             INFO_PRINT("DBTDevice::pingGATT: GATTHandler not connected -> disconnected on %s", toString().c_str());
@@ -587,8 +865,53 @@ bool DBTDevice::pingGATT() {
     return false;
 }
 
+bool DBTDevice::ping(const KeepAliveMode mode) {
+    if( KeepAliveMode::GATT == mode ) {
+        return pingGATT();
+    }
+    const uint16_t handle = hciConnHandle;
+    if( !isConnected || 0 == handle ) {
+        return false;
+    }
+    if( KeepAliveMode::LINK == mode ) {
+        return true;
+    }
+    try {
+        std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+        if( nullptr == hci ) {
+            ERR_PRINT("DBTDevice::ping: HCI not available: %s", toString().c_str());
+            return false;
+        }
+        int8_t rssi;
+        const HCIStatusCode status = hci->read_rssi(handle, rssi);
+        if( HCIStatusCode::SUCCESS == status ) {
+            return true;
+        }
+        if( HCIStatusCode::UNKNOWN_CONNECTION_IDENTIFIER == status ) {
+            INFO_PRINT("DBTDevice::ping: Unknown connection handle %s -> disconnected on %s",
+                    uint16HexString(handle).c_str(), toString().c_str());
+            disconnect(false /* fromDisconnectCB */, true /* ioErrorCause */, HCIStatusCode::REMOTE_USER_TERMINATED_CONNECTION);
+        } else {
+            DBG_PRINT("DBTDevice::ping: read_rssi: status 0x%2.2X (%s) on %s",
+                    number(status), getHCIStatusCodeString(status).c_str(), toString().c_str());
+        }
+    } catch (std::exception &e) {
+        INFO_PRINT("DBTDevice::ping: Potential disconnect, exception: '%s' on %s", e.what(), toString().c_str());
+    }
+    return false;
+}
+
 std::shared_ptr<GenericAccess> DBTDevice::getGATTGenericAccess() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+    if( nullptr == gattGenericAccess && GATTEnv::get().GATT_GENERIC_ACCESS_LAZY &&
+        nullptr != gattHandler && gattHandler->isOpen() && 0 < gattHandler->getServices().size() )
+    {
+        try {
+            readGATTGenericAccess(gattHandler->getServices());
+        } catch (std::exception &e) {
+            WARN_PRINT("DBTDevice::getGATTGenericAccess: Caught exception: '%s' on %s", e.what(), toString().c_str());
+        }
+    }
     return gattGenericAccess;
 }
 
@@ -601,7 +924,7 @@ void DBTDevice::disconnectGATT() {
     if( nullptr != _gattHandler ) {
         // interrupt GATT's L2CAP ::connect(..), avoiding prolonged hang
         _gattHandler->disconnect(false /* disconnectDevice */, false /* ioErrorCause */);
-        const std::lock_guard<std::recursive_mutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_gatt); // RAII-style acquire and relinquish via destructor
         _gattHandler = nullptr;
         gattHandler = nullptr;
     }
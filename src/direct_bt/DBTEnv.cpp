@@ -28,18 +28,52 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <map>
 #include <cstdio>
+#include <mutex>
 
 #include "direct_bt/DBTEnv.hpp"
 #include "direct_bt/dbt_debug.hpp"
 
+extern "C" {
+    #include <pthread.h>
+    #include <sched.h>
+}
+
 using namespace direct_bt;
 
 const uint64_t DBTEnv::startupTimeMilliseconds = direct_bt::getCurrentMilliseconds();
 
 bool DBTEnv::debug = false;
 
+static std::mutex & getPropertyMutex() {
+    static std::mutex mtx;
+    return mtx;
+}
+
+/**
+ * Properties set at runtime via setProperty() or exploded via getExplodingProperties(),
+ * taking precedence over the environment, which is never modified to avoid racing concurrent getenv() calls.
+ */
+static std::map<std::string, std::string> & getPropertyOverrides() {
+    static std::map<std::string, std::string> overrides;
+    return overrides;
+}
+
+static void setPropertyOverride(const std::string & name, const std::string & value) {
+    const std::lock_guard<std::mutex> lock(getPropertyMutex()); // RAII-style acquire and relinquish via destructor
+    getPropertyOverrides()[name] = value;
+}
+
 std::string DBTEnv::getProperty(const std::string & name) {
+    {
+        const std::lock_guard<std::mutex> lock(getPropertyMutex()); // RAII-style acquire and relinquish via destructor
+        const std::map<std::string, std::string> & overrides = getPropertyOverrides();
+        auto it = overrides.find(name);
+        if( overrides.end() != it ) {
+            return it->second;
+        }
+    }
     const char * value = getenv(name.c_str());
     if( nullptr != value ) {
         return std::string( value );
@@ -153,6 +187,34 @@ uint32_t DBTEnv::getUint32Property(const std::string & name, const uint32_t defa
     }
 }
 
+static std::vector<DBTEnv::PropertyListener> & getPropertyListener() {
+    static std::vector<DBTEnv::PropertyListener> listener;
+    return listener;
+}
+
+bool DBTEnv::setProperty(const std::string & name, const std::string & value) {
+    std::vector<PropertyListener> listener;
+    {
+        const std::lock_guard<std::mutex> lock(getPropertyMutex()); // RAII-style acquire and relinquish via destructor
+        if( 0 == name.length() || std::string::npos != name.find('=') ) {
+            ERR_PRINT("DBTEnv::setProperty %s: %s failed: Invalid name", name.c_str(), value.c_str());
+            return false;
+        }
+        getPropertyOverrides()[name] = value;
+        listener = getPropertyListener();
+    }
+    INFO_PRINT("DBTEnv::setProperty %s: %s", name.c_str(), value.c_str());
+    for(PropertyListener l : listener) {
+        l(name);
+    }
+    return true;
+}
+
+void DBTEnv::addPropertyListener(PropertyListener l) {
+    const std::lock_guard<std::mutex> lock(getPropertyMutex()); // RAII-style acquire and relinquish via destructor
+    getPropertyListener().push_back(l);
+}
+
 void DBTEnv::envSet(std::string prefixDomain, std::string basepair) {
     trimInPlace(basepair);
     if( basepair.length() > 0 ) {
@@ -166,16 +228,16 @@ void DBTEnv::envSet(std::string prefixDomain, std::string basepair) {
             if( name.length() > 0 ) {
                 if( value.length() > 0 ) {
                     COND_PRINT(debug, "DBTEnv::setProperty %s -> %s (explode)", name.c_str(), value.c_str());
-                    setenv(name.c_str(), value.c_str(), 1 /* overwrite */);
+                    setPropertyOverride(name, value);
                 } else {
                     COND_PRINT(debug, "DBTEnv::setProperty %s -> true (explode default-1)", name.c_str());
-                    setenv(name.c_str(), "true", 1 /* overwrite */);
+                    setPropertyOverride(name, "true");
                 }
             }
         } else {
             const std::string name = prefixDomain+"."+basepair;
             COND_PRINT(debug, "DBTEnv::setProperty %s -> true (explode default-0)", name.c_str());
-            setenv(name.c_str(), "true", 1 /* overwrite */);
+            setPropertyOverride(name, "true");
         }
     }
 }
@@ -192,7 +254,7 @@ void DBTEnv::envExplodeProperties(std::string prefixDomain, std::string list) {
         envSet(prefixDomain, list.substr(start, elem_len));
     }
     COND_PRINT(debug, "DBTEnv::setProperty %s -> true (explode default)", prefixDomain.c_str());
-    setenv(prefixDomain.c_str(), "true", 1 /* overwrite */);
+    setPropertyOverride(prefixDomain, "true");
 }
 
 bool DBTEnv::getExplodingProperties(const std::string & prefixDomain) {
@@ -215,3 +277,114 @@ DBTEnv::DBTEnv()
   VERBOSE( getExplodingProperties("direct_bt.verbose") || DBTEnv::DEBUG )
 {
 }
+
+DBTThreadOptions::DBTThreadOptions(const std::string & prefix, const std::string & defaultName)
+: FIFO_PRIORITY( DBTEnv::getInt32Property(prefix+".sched.fifo", 0, 0 /* min */, 99 /* max */) ),
+  CPU_AFFINITY( DBTEnv::getProperty(prefix+".cpus", "") ),
+  NAME( DBTEnv::getProperty(prefix+".name", defaultName).substr(0, 15) )
+{
+}
+
+bool DBTThreadOptions::applyToCurrentThread() const {
+    const pthread_t self = pthread_self();
+    bool res = true;
+    int err;
+
+    if( NAME.length() > 0 ) {
+        if( 0 != ( err = pthread_setname_np(self, NAME.c_str()) ) ) {
+            WARN_PRINT("DBTThreadOptions: pthread_setname_np '%s' failed: %d, %s", NAME.c_str(), err, strerror(err));
+            res = false;
+        }
+    }
+    if( CPU_AFFINITY.length() > 0 ) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        int count = 0;
+        size_t start = 0;
+        while( start < CPU_AFFINITY.length() ) {
+            size_t end = CPU_AFFINITY.find_first_of(":,", start);
+            if( std::string::npos == end ) {
+                end = CPU_AFFINITY.length();
+            }
+            const std::string elem = CPU_AFFINITY.substr(start, end-start);
+            start = end + 1;
+            if( 0 == elem.length() ) {
+                continue;
+            }
+            int first, last;
+            const size_t dash = elem.find('-');
+            char * endp;
+            first = static_cast<int>( strtol(elem.c_str(), &endp, 10) );
+            last = std::string::npos != dash ? static_cast<int>( strtol(elem.c_str()+dash+1, &endp, 10) ) : first;
+            if( 0 > first || first > last || last >= CPU_SETSIZE ) {
+                WARN_PRINT("DBTThreadOptions: Invalid cpu set element '%s' of '%s'", elem.c_str(), CPU_AFFINITY.c_str());
+                res = false;
+                continue;
+            }
+            for(int i=first; i<=last; i++) {
+                CPU_SET(i, &cpus);
+                count++;
+            }
+        }
+        if( 0 < count ) {
+            if( 0 != ( err = pthread_setaffinity_np(self, sizeof(cpus), &cpus) ) ) {
+                WARN_PRINT("DBTThreadOptions: pthread_setaffinity_np '%s' failed: %d, %s", CPU_AFFINITY.c_str(), err, strerror(err));
+                res = false;
+            }
+        }
+    }
+    if( 0 < FIFO_PRIORITY ) {
+        struct sched_param param;
+        bzero(&param, sizeof(param));
+        param.sched_priority = FIFO_PRIORITY;
+        if( 0 != ( err = pthread_setschedparam(self, SCHED_FIFO, &param) ) ) {
+            WARN_PRINT("DBTThreadOptions: pthread_setschedparam SCHED_FIFO %d failed: %d, %s", FIFO_PRIORITY, err, strerror(err));
+            res = false;
+        }
+    }
+    DBG_PRINT("DBTThreadOptions: Applied %s: %d", toString().c_str(), res);
+    return res;
+}
+
+std::string DBTThreadOptions::toString() const {
+    return "ThreadOptions[name '"+NAME+"', fifo "+std::to_string(FIFO_PRIORITY)+", cpus '"+CPU_AFFINITY+"']";
+}
+
+std::string DBTRingOptions::getOverflowPolicyString(const OverflowPolicy v) {
+    switch(v) {
+        case OverflowPolicy::DROP_OLDEST: return "drop_oldest";
+        case OverflowPolicy::DROP_NEWEST: return "drop_newest";
+        case OverflowPolicy::BLOCK: return "block";
+        case OverflowPolicy::GROW: return "grow";
+        default: ; // fall through intended
+    }
+    return "unknown";
+}
+
+static DBTRingOptions::OverflowPolicy toOverflowPolicy(const std::string & prefix, const std::string & v, const DBTRingOptions::OverflowPolicy def) {
+    if( "drop_oldest" == v ) {
+        return DBTRingOptions::OverflowPolicy::DROP_OLDEST;
+    } else if( "drop_newest" == v ) {
+        return DBTRingOptions::OverflowPolicy::DROP_NEWEST;
+    } else if( "block" == v ) {
+        return DBTRingOptions::OverflowPolicy::BLOCK;
+    } else if( "grow" == v ) {
+        return DBTRingOptions::OverflowPolicy::GROW;
+    } else if( 0 < v.length() ) {
+        WARN_PRINT("DBTRingOptions: Unknown '%s.policy' value '%s', using '%s'",
+                prefix.c_str(), v.c_str(), DBTRingOptions::getOverflowPolicyString(def).c_str());
+    }
+    return def;
+}
+
+DBTRingOptions::DBTRingOptions(const std::string & prefix, const OverflowPolicy defaultPolicy, const int32_t defaultTimeout, const int32_t defaultMaxCapacity)
+: POLICY( toOverflowPolicy(prefix, DBTEnv::getProperty(prefix+".policy", ""), defaultPolicy) ),
+  BLOCK_TIMEOUT( DBTEnv::getInt32Property(prefix+".timeout", defaultTimeout, 0 /* min */, INT32_MAX /* max */) ),
+  MAX_CAPACITY( DBTEnv::getInt32Property(prefix+".max", defaultMaxCapacity, 1 /* min */, 65536 /* max */) )
+{
+}
+
+std::string DBTRingOptions::toString() const {
+    return "RingOptions[policy "+getOverflowPolicyString(POLICY)+", timeout "+std::to_string(BLOCK_TIMEOUT)+
+           " ms, max "+std::to_string(MAX_CAPACITY)+"]";
+}
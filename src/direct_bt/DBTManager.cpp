@@ -31,6 +31,7 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <chrono>
 
 // #define PERF_PRINT_ON 1
 #include <dbt_debug.hpp>
@@ -41,6 +42,8 @@
 #include "HCIIoctl.hpp"
 #include "HCIComm.hpp"
 #include "DBTTypes.hpp"
+#include "DBTTrace.hpp"
+#include "DBTMetrics.hpp"
 
 extern "C" {
     #include <inttypes.h>
@@ -54,18 +57,82 @@ using namespace direct_bt;
 MgmtEnv::MgmtEnv()
 : DEBUG_GLOBAL( DBTEnv::get().DEBUG ),
   exploding( DBTEnv::getExplodingProperties("direct_bt.mgmt") ),
-  MGMT_READER_THREAD_POLL_TIMEOUT( DBTEnv::getInt32Property("direct_bt.mgmt.reader.timeout", 10000, 1500 /* min */, INT32_MAX /* max */) ),
-  MGMT_COMMAND_REPLY_TIMEOUT( DBTEnv::getInt32Property("direct_bt.mgmt.cmd.timeout", 3000, 1500 /* min */, INT32_MAX /* max */) ),
-  MGMT_EVT_RING_CAPACITY( DBTEnv::getInt32Property("direct_bt.mgmt.ringsize", 64, 64 /* min */, 1024 /* max */) ),
+  MGMT_READER_THREAD_POLL_TIMEOUT( 0 ),
+  MGMT_COMMAND_REPLY_TIMEOUT( 0 ),
   DEBUG_EVENT( DBTEnv::getBooleanProperty("direct_bt.debug.mgmt.event", false) ),
-  MGMT_READ_PACKET_MAX_RETRY( MGMT_EVT_RING_CAPACITY )
+  MGMT_READER_THREAD_OPTIONS( "direct_bt.mgmt.reader", "dbt_mgmt_rdr" ),
+  MGMT_ADAPTER_INIT_LAZY( DBTEnv::getBooleanProperty("direct_bt.mgmt.adapter.lazy", false) ),
+  MGMT_ADAPTER_INIT_PIPELINED( DBTEnv::getBooleanProperty("direct_bt.mgmt.adapter.pipelined", true) ),
+  MGMT_RX_TIMESTAMPS( DBTEnv::getBooleanProperty("direct_bt.mgmt.timestamps", true) ),
+  MGMT_READER_EXTERNAL( DBTEnv::getBooleanProperty("direct_bt.mgmt.reader.external", false) ),
+  MGMT_BONDING_KEY_DIR( DBTEnv::getProperty("direct_bt.mgmt.bonding.dir", "") ),
+  MGMT_TIMER_TICK( DBTEnv::getInt32Property("direct_bt.mgmt.timer.tick", 10, 1 /* min */, 1000 /* max */) ),
+  MGMT_PAIR_DEVICE_TIMEOUT( 0 )
 {
+    reload();
+    DBTEnv::addPropertyListener(onPropertyChanged);
+}
+
+void MgmtEnv::onPropertyChanged(const std::string & name) {
+    if( 0 == name.find("direct_bt.mgmt") ) {
+        get().reload();
+    }
+}
+
+void MgmtEnv::reload() {
+    MGMT_READER_THREAD_POLL_TIMEOUT = DBTEnv::getInt32Property("direct_bt.mgmt.reader.timeout", 10000, 1500 /* min */, INT32_MAX /* max */);
+    MGMT_COMMAND_REPLY_TIMEOUT = DBTEnv::getInt32Property("direct_bt.mgmt.cmd.timeout", 3000, 1500 /* min */, INT32_MAX /* max */);
+    MGMT_PAIR_DEVICE_TIMEOUT = DBTEnv::getInt32Property("direct_bt.mgmt.pair.timeout", 30000, 1500 /* min */, INT32_MAX /* max */);
 }
 
 const pid_t DBTManager::pidSelf = getpid();
 std::mutex DBTManager::mtx_singleton;
 
+static bool getReplyReqOpcode(const MgmtEvent & reply, MgmtOpcode & opc) {
+    if( MgmtEvent::Opcode::CMD_COMPLETE == reply.getOpcode() ) {
+        opc = static_cast<const MgmtEvtCmdComplete &>(reply).getReqOpcode();
+        return true;
+    } else if( MgmtEvent::Opcode::CMD_STATUS == reply.getOpcode() ) {
+        opc = static_cast<const MgmtEvtCmdStatus &>(reply).getReqOpcode();
+        return true;
+    }
+    return false;
+}
+
+void DBTManager::dispatchEvent(const int len, const uint64_t timestampNS, LatencyHistogram * metricDispatch) {
+    const uint16_t paramSize = len >= 6 ? rbuffer.get_uint16(4) : 0;
+    if( len < 6 + paramSize ) {
+        WARN_PRINT("DBTManager::reader: length mismatch %d < 6 + %d", len, paramSize);
+        return; // discard data
+    }
+    const uint64_t t0 = nullptr != metricDispatch ? getCurrentMicroseconds() : 0;
+    std::shared_ptr<MgmtEvent> event( MgmtEvent::getSpecialized(rbuffer.get_ptr(), len) );
+    event->setTimestampNS(timestampNS);
+    const MgmtEvent::Opcode opc = event->getOpcode();
+    {
+        MgmtOpcode reqOpc = MgmtOpcode::READ_VERSION;
+        const bool isReply = getReplyReqOpcode(*event, reqOpc);
+        DBTTrace::get().record(TraceSource::MGMT_EVT, event->getTimestamp(), static_cast<uint16_t>(opc),
+                               isReply ? static_cast<uint16_t>(reqOpc) : 0, event->getDevID(), paramSize);
+    }
+    if( MgmtEvent::Opcode::CMD_COMPLETE == opc || MgmtEvent::Opcode::CMD_STATUS == opc ) {
+        COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV (CMD) %s", event->toString().c_str());
+        if( !completePendingReply( event ) ) {
+            // This could occur due to an earlier timeout, i.e. the late reply naturally not-matching.
+            COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV (CMD) no pending request (drop evt): %s", event->toString().c_str());
+        }
+    } else {
+        // issue a callback
+        COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV (CB) %s", event->toString().c_str());
+        sendMgmtEvent(event);
+    }
+    if( nullptr != metricDispatch ) {
+        metricDispatch->recordSince(t0, true);
+    }
+}
+
 void DBTManager::mgmtReaderThreadImpl() {
+    env.MGMT_READER_THREAD_OPTIONS.applyToCurrentThread();
     {
         const std::lock_guard<std::mutex> lock(mtx_mgmtReaderInit); // RAII-style acquire and relinquish via destructor
         mgmtReaderShallStop = false;
@@ -73,6 +140,8 @@ void DBTManager::mgmtReaderThreadImpl() {
         DBG_PRINT("DBTManager::reader: Started");
         cv_mgmtReaderInit.notify_all();
     }
+    const bool metrics = DBTMetrics::get().isEnabled();
+    LatencyHistogram & metricDispatch = DBTMetrics::get().getHistogram("mgmt_reader_dispatch");
 
     while( !mgmtReaderShallStop ) {
         int len;
@@ -83,118 +152,272 @@ void DBTManager::mgmtReaderThreadImpl() {
             break;
         }
 
-        len = comm.read(rbuffer.get_wptr(), rbuffer.getSize(), env.MGMT_READER_THREAD_POLL_TIMEOUT);
+        uint64_t timestampNS = 0;
+        len = comm.read(rbuffer.get_wptr(), rbuffer.getSize(),
+                        env.MGMT_READER_EXTERNAL ? static_cast<int32_t>(EXTERNAL_HANDOVER_TIMEOUT) : env.MGMT_READER_THREAD_POLL_TIMEOUT.load(),
+                        timestampNS);
         if( 0 < len ) {
-            const uint16_t paramSize = len >= 6 ? rbuffer.get_uint16(4) : 0;
-            if( len < 6 + paramSize ) {
-                WARN_PRINT("DBTManager::reader: length mismatch %d < 6 + %d", len, paramSize);
-                continue; // discard data
-            }
-            std::shared_ptr<MgmtEvent> event( MgmtEvent::getSpecialized(rbuffer.get_ptr(), len) );
-            const MgmtEvent::Opcode opc = event->getOpcode();
-            if( MgmtEvent::Opcode::CMD_COMPLETE == opc || MgmtEvent::Opcode::CMD_STATUS == opc ) {
-                COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV (CMD) %s", event->toString().c_str());
-                if( mgmtEventRing.isFull() ) {
-                    const int dropCount = mgmtEventRing.capacity()/4;
-                    mgmtEventRing.drop(dropCount);
-                    WARN_PRINT("DBTManager-IO RECV Drop (%d oldest elements of %d capacity, ring full)", dropCount, mgmtEventRing.capacity());
-                }
-                mgmtEventRing.putBlocking( event );
-            } else {
-                // issue a callback
-                COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV (CB) %s", event->toString().c_str());
-                sendMgmtEvent(event);
-            }
+            dispatchEvent(len, timestampNS, metrics ? &metricDispatch : nullptr);
         } else if( ETIMEDOUT != errno && !mgmtReaderShallStop ) { // expected exits
             ERR_PRINT("DBTManager::reader: HCIComm read error");
         }
     }
+    if( mgmtReaderExternal ) {
+        // Handed over to the external event loop, which continues reading, see attachExternalReader()
+        INFO_PRINT("DBTManager::reader: Ended, handed over to external event loop");
+        return;
+    }
 
-    INFO_PRINT("DBTManager::reader: Ended. Ring has %d entries flushed", mgmtEventRing.getSize());
+    INFO_PRINT("DBTManager::reader: Ended");
     mgmtReaderRunning = false;
-    mgmtEventRing.clear();
+    clearPendingReplies();
 }
 
-void DBTManager::sendMgmtEvent(std::shared_ptr<MgmtEvent> event) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
-    const int dev_id = event->getDevID();
-    MgmtAdapterEventCallbackList & mgmtEventCallbackList = mgmtAdapterEventCallbackLists[static_cast<uint16_t>(event->getOpcode())];
-    int invokeCount = 0;
-    for (auto it = mgmtEventCallbackList.begin(); it != mgmtEventCallbackList.end(); ++it) {
-        if( 0 > it->getDevID() || dev_id == it->getDevID() ) {
-            try {
-                it->getCallback().invoke(event);
-            } catch (std::exception &e) {
-                ERR_PRINT("DBTManager::sendMgmtEvent-CBs %d/%zd: MgmtAdapterEventCallback %s : Caught exception %s",
-                        invokeCount+1, mgmtEventCallbackList.size(),
-                        it->toString().c_str(), e.what());
-            }
-            invokeCount++;
+bool DBTManager::attachExternalReader() {
+    const std::lock_guard<std::mutex> lock(mtx_mgmtReaderInit); // RAII-style acquire and relinquish via destructor
+    if( mgmtReaderExternal ) {
+        return true;
+    }
+    if( !env.MGMT_READER_EXTERNAL || !mgmtReaderRunning || !mgmtReaderThread.joinable() ||
+        std::this_thread::get_id() == mgmtReaderThread.get_id() )
+    {
+        ERR_PRINT("DBTManager::attachExternalReader: Not enabled, not running or called by reader thread");
+        return false;
+    }
+    mgmtReaderExternal = true;
+    mgmtReaderShallStop = true;
+    comm.interrupt();
+    mgmtReaderThread.join();
+    mgmtReaderThread = std::thread(); // empty
+    metricExternalDispatch = DBTMetrics::get().isEnabled() ? &DBTMetrics::get().getHistogram("mgmt_reader_dispatch") : nullptr;
+    DBG_PRINT("DBTManager::attachExternalReader: fd %d", comm.poll_dd());
+    return true;
+}
+
+int DBTManager::processReadable() {
+    if( !mgmtReaderExternal || !mgmtReaderRunning ) {
+        return -1;
+    }
+    int count = 0;
+    while( count < HCIComm::MAX_READ_BATCH ) {
+        if( !comm.isOpen() ) {
+            ERR_PRINT("DBTManager::processReadable: Not connected");
+            return -1;
         }
+        struct pollfd p;
+        p.fd = comm.poll_dd(); p.events = POLLIN; p.revents = 0;
+        if( 0 >= poll(&p, 1, 0) ) {
+            break; // drained
+        }
+        // Readable, hence read w/o timeout returns at once
+        uint64_t timestampNS = 0;
+        const int len = comm.read(rbuffer.get_wptr(), rbuffer.getSize(), 0 /* timeout */, timestampNS);
+        if( 0 > len ) {
+            ERR_PRINT("DBTManager::processReadable: HCIComm read error");
+            return -1;
+        }
+        dispatchEvent(len, timestampNS, metricExternalDispatch);
+        count++;
     }
-    COND_PRINT(env.DEBUG_EVENT, "DBTManager::sendMgmtEvent: Event %s -> %d/%zd callbacks", event->toString().c_str(), invokeCount, mgmtEventCallbackList.size());
-    (void)invokeCount;
+    return count;
 }
 
-static void mgmthandler_sigaction(int sig, siginfo_t *info, void *ucontext) {
-    bool pidMatch = info->si_pid == DBTManager::pidSelf;
-    INFO_PRINT("DBTManager.sigaction: sig %d, info[code %d, errno %d, signo %d, pid %d, uid %d, fd %d], pid-self %d (match %d)",
-            sig, info->si_code, info->si_errno, info->si_signo,
-            info->si_pid, info->si_uid, info->si_fd,
-            DBTManager::pidSelf, pidMatch);
-    (void)ucontext;
+int DBTManager::invokeMgmtEventCallbacks(const MgmtAdapterEventCallbackList::snapshot_t & list, const MgmtEvent & event) {
+    int invokeCount = 0;
+    for (auto it = list->begin(); it != list->end(); ++it) {
+        try {
+            it->getCallback().invoke(event);
+        } catch (std::exception &e) {
+            ERR_PRINT("DBTManager::sendMgmtEvent-CBs %d/%zd: MgmtAdapterEventCallback %s : Caught exception %s",
+                    invokeCount+1, list->size(),
+                    it->toString().c_str(), e.what());
+        }
+        invokeCount++;
+    }
+    return invokeCount;
+}
 
-    if( !pidMatch || SIGALRM != sig ) {
+void DBTManager::sendMgmtEvent(const std::shared_ptr<MgmtEvent> & event) {
+    const uint16_t opc = static_cast<uint16_t>(event->getOpcode());
+    if( opc >= mgmtAdapterEventCallbackLists.size() ) {
         return;
     }
-#if 0
-    // We do not de-install the handler on single use,
-    // as we act for multiple SIGALRM events within direct-bt
+    const int dev_id = event->getDevID();
+    MgmtAdapterEventCallbackIndex & index = mgmtAdapterEventCallbackLists[opc];
+    int invokeCount = invokeMgmtEventCallbacks(index.wildcard.get_snapshot(), *event);
+
+    const COWVector<std::shared_ptr<MgmtAdapterEventCallbackList>>::snapshot_t byDevID = index.byDevID.get_snapshot();
+    if( 0 <= dev_id && dev_id < static_cast<int>(byDevID->size()) ) {
+        invokeCount += invokeMgmtEventCallbacks((*byDevID)[dev_id]->get_snapshot(), *event);
+    }
+    COND_PRINT(env.DEBUG_EVENT, "DBTManager::sendMgmtEvent: Event %s -> %d callbacks", event->toString().c_str(), invokeCount);
+    (void)invokeCount;
+}
+
+bool DBTManager::completePendingReply(std::shared_ptr<MgmtEvent> & reply) {
+    MgmtOpcode opc;
+    if( !getReplyReqOpcode(*reply, opc) ) {
+        return false;
+    }
+    const uint16_t dev_id = reply->getDevID();
+    std::shared_ptr<PendingReply> pending = nullptr;
     {
-        struct sigaction sa_setup;
-        bzero(&sa_setup, sizeof(sa_setup));
-        sa_setup.sa_handler = SIG_DFL;
-        sigemptyset(&(sa_setup.sa_mask));
-        sa_setup.sa_flags = 0;
-        if( 0 != sigaction( SIGALRM, &sa_setup, NULL ) ) {
-            ERR_PRINT("DBTManager.sigaction: Resetting sighandler");
+        const std::lock_guard<std::mutex> lock(mtx_pendingReplies); // RAII-style acquire and relinquish via destructor
+        auto it = std::find_if(pendingReplies.begin(), pendingReplies.end(), [&](const std::shared_ptr<PendingReply> &p) {
+            return p->opcode == opc && p->dev_id == dev_id;
+        });
+        if( pendingReplies.end() == it ) {
+            return false;
         }
+        pending = *it;
+        pendingReplies.erase(it);
     }
-#endif
+    if( DBTMetrics::get().isEnabled() ) {
+        DBTMetrics::get().getHistogram("mgmt_command", "opcode", getMgmtOpcodeString(opc)).recordSince(pending->ts_sent, true);
+    }
+    pending->promise.set_value(reply);
+    return true;
 }
 
-std::shared_ptr<MgmtEvent> DBTManager::sendWithReply(MgmtCommand &req) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sendReply); // RAII-style acquire and relinquish via destructor
+static void recordMgmtCommandError(const MgmtOpcode opc) {
+    if( DBTMetrics::get().isEnabled() ) {
+        DBTMetrics::get().getHistogram("mgmt_command", "opcode", getMgmtOpcodeString(opc)).recordError();
+    }
+}
+
+bool DBTManager::removePendingReply(const std::shared_ptr<PendingReply> & pending) {
+    const std::lock_guard<std::mutex> lock(mtx_pendingReplies); // RAII-style acquire and relinquish via destructor
+    auto it = std::find(pendingReplies.begin(), pendingReplies.end(), pending);
+    if( pendingReplies.end() == it ) {
+        return false;
+    }
+    pendingReplies.erase(it);
+    return true;
+}
+
+void DBTManager::clearPendingReplies() {
+    std::vector<std::shared_ptr<PendingReply>> pending;
     {
+        const std::lock_guard<std::mutex> lock(mtx_pendingReplies); // RAII-style acquire and relinquish via destructor
+        pending.swap(pendingReplies);
+    }
+    for(auto it = pending.begin(); it != pending.end(); it++) {
+        (*it)->promise.set_value(nullptr);
+    }
+}
+
+std::future<std::shared_ptr<MgmtEvent>> DBTManager::sendAsync(MgmtCommand &req, std::shared_ptr<PendingReply> & pending) {
+    pending = std::make_shared<PendingReply>(req.getOpcode(), req.getDevID());
+    std::future<std::shared_ptr<MgmtEvent>> reply = pending->promise.get_future();
+    {
+        // register before sending, as the reply may arrive right away
+        const std::lock_guard<std::mutex> lock(mtx_pendingReplies); // RAII-style acquire and relinquish via destructor
+        pendingReplies.push_back(pending);
+    }
+    bool ok;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
         COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO SENT %s", req.toString().c_str());
         TROOctets & pdu = req.getPDU();
-        if ( comm.write( pdu.get_ptr(), pdu.getSize() ) < 0 ) {
-            ERR_PRINT("DBTManager::sendWithReply: HCIComm write error, req %s", req.toString().c_str());
-            return nullptr;
+        DBTTrace::get().record(TraceSource::MGMT_CMD, getCurrentMilliseconds(), static_cast<uint16_t>(req.getOpcode()), 0,
+                               req.getDevID(), req.getParamSize());
+        ok = comm.write( pdu.get_ptr(), pdu.getSize() ) >= 0;
+    }
+    if( !ok ) {
+        ERR_PRINT("DBTManager::sendAsync: HCIComm write error, req %s", req.toString().c_str());
+        if( removePendingReply(pending) ) {
+            pending->promise.set_value(nullptr);
         }
+        recordMgmtCommandError(req.getOpcode());
     }
+    return reply;
+}
 
-    // Ringbuffer read is thread safe
-    int32_t retryCount = 0;
-    while( retryCount < env.MGMT_READ_PACKET_MAX_RETRY ) {
-        std::shared_ptr<MgmtEvent> res = mgmtEventRing.getBlocking(env.MGMT_COMMAND_REPLY_TIMEOUT);
-        // std::shared_ptr<MgmtEvent> res = receiveNext();
-        if( nullptr == res ) {
+std::future<std::shared_ptr<MgmtEvent>> DBTManager::sendAsync(MgmtCommand &req, const int32_t timeoutMS) {
+    const int32_t timeout = 0 <= timeoutMS ? timeoutMS : env.MGMT_COMMAND_REPLY_TIMEOUT.load();
+    std::shared_ptr<PendingReply> pending;
+    std::future<std::shared_ptr<MgmtEvent>> reply = sendAsync(req, pending);
+    // Expire the pending command w/o a waiting caller, as it would take the reply of a later command.
+    // A stopped TimerWheel implies close(), which completes all pending commands itself.
+    const std::weak_ptr<PendingReply> wpending(pending);
+    const MgmtOpcode opc = req.getOpcode();
+    timerWheel.schedule(static_cast<uint32_t>(timeout), [this, wpending, opc]() -> uint32_t {
+        std::shared_ptr<PendingReply> p = wpending.lock();
+        if( nullptr != p && removePendingReply(p) ) {
+            WARN_PRINT("DBTManager::sendAsync: Timeout: %s", getMgmtOpcodeString(opc).c_str());
+            recordMgmtCommandError(opc);
+            p->promise.set_value(nullptr);
+        }
+        return 0;
+    });
+    return reply;
+}
+
+std::shared_ptr<MgmtEvent> DBTManager::waitForReply(const MgmtCommand &req, std::shared_ptr<PendingReply> & pending,
+                                                    std::future<std::shared_ptr<MgmtEvent>> & reply, const int32_t timeoutMS)
+{
+    if( std::future_status::ready != reply.wait_for(std::chrono::milliseconds(timeoutMS)) ) {
+        if( removePendingReply(pending) ) {
             errno = ETIMEDOUT;
             ERR_PRINT("DBTManager::sendWithReply.X: nullptr result (timeout -> abort): req %s", req.toString().c_str());
+            recordMgmtCommandError(req.getOpcode());
             return nullptr;
-        } else if( !res->validate(req) ) {
-            // This could occur due to an earlier timeout w/ a nullptr == res (see above),
-            // i.e. the pending reply processed here and naturally not-matching.
-            COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV sendWithReply: res mismatch (drop evt, retryCount %d): res %s; req %s",
-                    retryCount, res->toString().c_str(), req.toString().c_str());
-            retryCount++;
-        } else {
-            COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV sendWithReply: res %s; req %s", res->toString().c_str(), req.toString().c_str());
-            return res;
         }
+        // completed concurrently
     }
-    return nullptr;
+    std::shared_ptr<MgmtEvent> res = reply.get();
+    if( nullptr != res ) {
+        COND_PRINT(env.DEBUG_EVENT, "DBTManager-IO RECV sendWithReply: res %s; req %s", res->toString().c_str(), req.toString().c_str());
+    }
+    return res;
+}
+
+std::shared_ptr<MgmtEvent> DBTManager::sendWithReply(MgmtCommand &req) {
+    std::shared_ptr<PendingReply> pending;
+    std::future<std::shared_ptr<MgmtEvent>> reply = sendAsync(req, pending);
+    return waitForReply(req, pending, reply, env.MGMT_COMMAND_REPLY_TIMEOUT);
+}
+
+std::vector<std::shared_ptr<MgmtEvent>> DBTManager::sendWithReplies(const std::vector<std::shared_ptr<MgmtCommand>> &reqs) {
+    std::vector<std::shared_ptr<PendingReply>> pending(reqs.size(), nullptr);
+    std::vector<std::future<std::shared_ptr<MgmtEvent>>> replies;
+    for(size_t i = 0; i < reqs.size(); i++) {
+        replies.push_back( sendAsync(*reqs[i], pending[i]) );
+    }
+    std::vector<std::shared_ptr<MgmtEvent>> res;
+    for(size_t i = 0; i < reqs.size(); i++) {
+        res.push_back( waitForReply(*reqs[i], pending[i], replies[i], env.MGMT_COMMAND_REPLY_TIMEOUT) );
+    }
+    return res;
+}
+
+static bool isModeSuccess(const std::shared_ptr<MgmtEvent> &res) {
+    if( nullptr != res ) {
+        if( res->getOpcode() == MgmtEvent::Opcode::CMD_COMPLETE ) {
+            const MgmtEvtCmdComplete &res1 = *static_cast<const MgmtEvtCmdComplete *>(res.get());
+            return MgmtStatus::SUCCESS == res1.getStatus();
+        } else if( res->getOpcode() == MgmtEvent::Opcode::CMD_STATUS ) {
+            const MgmtEvtCmdStatus &res1 = *static_cast<const MgmtEvtCmdStatus *>(res.get());
+            return MgmtStatus::SUCCESS == res1.getStatus();
+        }
+    }
+    return false;
+}
+
+static std::shared_ptr<AdapterInfo> toAdapterInfo(const uint16_t dev_id, const std::shared_ptr<MgmtEvent> &res) {
+    if( nullptr == res ) {
+        return nullptr;
+    }
+    if( MgmtEvent::Opcode::CMD_COMPLETE != res->getOpcode() || res->getTotalSize() < MgmtEvtAdapterInfo::getRequiredSize()) {
+        ERR_PRINT("Insufficient data for adapter info: req %d, res %s", MgmtEvtAdapterInfo::getRequiredSize(), res->toString().c_str());
+        return nullptr;
+    }
+    const MgmtEvtAdapterInfo * res1 = static_cast<MgmtEvtAdapterInfo*>(res.get());
+    std::shared_ptr<AdapterInfo> adapterInfo = res1->toAdapterInfo();
+    if( dev_id != adapterInfo->dev_id ) {
+        throw InternalError("AdapterInfo dev_id="+std::to_string(adapterInfo->dev_id)+" != dev_id="+std::to_string(dev_id)+"]: "+adapterInfo->toString(), E_FILE_LINE);
+    }
+    return adapterInfo;
 }
 
 void DBTManager::setAdapterMode(const uint16_t dev_id, const uint8_t ssp, const uint8_t bredr, const uint8_t le) {
@@ -209,24 +432,16 @@ void DBTManager::setAdapterMode(const uint16_t dev_id, const uint8_t ssp, const
     DBG_PRINT("setAdapterMode[%d]: SET_LE(%d): result %d", dev_id, le, res);
 }
 
+std::shared_ptr<AdapterInfo> DBTManager::readAdapterInfo(const uint16_t dev_id) {
+    MgmtCommand req0(MgmtOpcode::READ_INFO, dev_id);
+    return toAdapterInfo(dev_id, sendWithReply(req0));
+}
+
 std::shared_ptr<AdapterInfo> DBTManager::initAdapter(const uint16_t dev_id, const BTMode btMode) {
-    std::shared_ptr<AdapterInfo> adapterInfo = nullptr;
+    std::shared_ptr<AdapterInfo> adapterInfo = readAdapterInfo(dev_id);
     bool powered;
-    MgmtCommand req0(MgmtOpcode::READ_INFO, dev_id);
-    {
-        std::shared_ptr<MgmtEvent> res = sendWithReply(req0);
-        if( nullptr == res ) {
-            goto fail;
-        }
-        if( MgmtEvent::Opcode::CMD_COMPLETE != res->getOpcode() || res->getTotalSize() < MgmtEvtAdapterInfo::getRequiredSize()) {
-            ERR_PRINT("Insufficient data for adapter info: req %d, res %s", MgmtEvtAdapterInfo::getRequiredSize(), res->toString().c_str());
-            goto fail;
-        }
-        const MgmtEvtAdapterInfo * res1 = static_cast<MgmtEvtAdapterInfo*>(res.get());
-        adapterInfo = res1->toAdapterInfo();
-        if( dev_id != adapterInfo->dev_id ) {
-            throw InternalError("AdapterInfo dev_id="+std::to_string(adapterInfo->dev_id)+" != dev_id="+std::to_string(dev_id)+"]: "+adapterInfo->toString(), E_FILE_LINE);
-        }
+    if( nullptr == adapterInfo ) {
+        return nullptr;
     }
     DBG_PRINT("initAdapter[%d]: Start: %s", dev_id, adapterInfo->toString().c_str());
 
@@ -249,33 +464,166 @@ std::shared_ptr<AdapterInfo> DBTManager::initAdapter(const uint16_t dev_id, cons
 
     removeDeviceFromWhitelist(dev_id, EUI48_ANY_DEVICE, BDAddressType::BDADDR_BREDR); // flush whitelist!
 
+    {
+        std::vector<std::shared_ptr<MgmtCommand>> reqs;
+        addBondingKeyCommands(reqs, dev_id, adapterInfo->address);
+        std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+        for(size_t i=0; i<reqs.size(); i++) {
+            DBG_PRINT("initAdapter[%d]: %s: result %d", dev_id, reqs[i]->getOpcodeString().c_str(), isModeSuccess(res[i]));
+        }
+    }
+
     powered = setMode(dev_id, MgmtOpcode::SET_POWERED, 1);
     DBG_PRINT("setAdapterMode[%d]: SET_POWERED(1): result %d", dev_id, powered);
+    (void)powered;
 
     /**
      * Update AdapterSettings post settings
      */
-    {
-        adapterInfo = nullptr; // flush
+    adapterInfo = readAdapterInfo(dev_id);
+    if( nullptr != adapterInfo ) {
+        DBG_PRINT("initAdapter[%d]: End: %s", dev_id, adapterInfo->toString().c_str());
+    }
+    return adapterInfo;
+}
 
-        std::shared_ptr<MgmtEvent> res = sendWithReply(req0);
-        if( nullptr == res ) {
-            goto fail;
+void DBTManager::addAdapterModeCommands(std::vector<std::shared_ptr<MgmtCommand>> &reqs, const uint16_t dev_id, const BTMode btMode) {
+    uint8_t ssp, bredr, le;
+    switch ( btMode ) {
+        case BTMode::DUAL:
+            ssp = 1; bredr = 1; le = 1;
+            break;
+        case BTMode::BREDR:
+            ssp = 1; bredr = 1; le = 0;
+            break;
+        case BTMode::NONE:
+            // fall through intended, map NONE -> LE
+        case BTMode::LE:
+        default:
+            ssp = 0; bredr = 0; le = 1;
+            break;
+    }
+    // Same order as setAdapterMode(), the kernel processes the commands of one socket in order
+    reqs.push_back( std::make_shared<MgmtUint8Cmd>(MgmtOpcode::SET_SSP, dev_id, ssp) );
+    reqs.push_back( std::make_shared<MgmtUint8Cmd>(MgmtOpcode::SET_BREDR, dev_id, bredr) );
+    reqs.push_back( std::make_shared<MgmtUint8Cmd>(MgmtOpcode::SET_LE, dev_id, le) );
+    reqs.push_back( std::make_shared<MgmtUint8Cmd>(MgmtOpcode::SET_CONNECTABLE, dev_id, 0) );
+    reqs.push_back( std::make_shared<MgmtUint8Cmd>(MgmtOpcode::SET_FAST_CONNECTABLE, dev_id, 0) );
+}
+
+void DBTManager::addBondingKeyCommands(std::vector<std::shared_ptr<MgmtCommand>> &reqs, const uint16_t dev_id, const EUI48 &adapterAddress) {
+    const std::vector<MgmtLongTermKeyInfo> ltks = bondingKeys.getLongTermKeys(adapterAddress, MgmtLoadLongTermKeyCmd::MAX_KEY_COUNT);
+    const std::vector<MgmtIdentityResolvingKeyInfo> irks = bondingKeys.getIdentityResolvingKeys(adapterAddress, MgmtLoadIdentityResolvingKeyCmd::MAX_KEY_COUNT);
+    // Both commands replace the adapter's keys, hence nothing to clear w/o stored keys
+    if( 0 < ltks.size() ) {
+        reqs.push_back( std::make_shared<MgmtLoadLongTermKeyCmd>(dev_id, ltks) );
+    }
+    if( 0 < irks.size() ) {
+        reqs.push_back( std::make_shared<MgmtLoadIdentityResolvingKeyCmd>(dev_id, irks) );
+    }
+    DBG_PRINT("DBTManager::addBondingKeyCommands[%d]: %zd LTKs, %zd IRKs", dev_id, ltks.size(), irks.size());
+}
+
+bool DBTManager::initAdaptersPipelined(const std::vector<uint16_t> &dev_ids, const BTMode btMode) {
+    std::vector<std::shared_ptr<MgmtCommand>> reqs;
+    for(auto it = dev_ids.begin(); it != dev_ids.end(); it++) {
+        addAdapterModeCommands(reqs, *it, btMode);
+        std::shared_ptr<AdapterInfo> adapterInfo = getAdapterInfo(*it);
+        if( nullptr != adapterInfo ) {
+            addBondingKeyCommands(reqs, *it, adapterInfo->address);
         }
-        if( MgmtEvent::Opcode::CMD_COMPLETE != res->getOpcode() || res->getTotalSize() < MgmtEvtAdapterInfo::getRequiredSize()) {
-            ERR_PRINT("Insufficient data for adapter info: req %d, res %s", MgmtEvtAdapterInfo::getRequiredSize(), res->toString().c_str());
-            goto fail;
+    }
+    {
+        std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+        for(size_t i=0; i<reqs.size(); i++) {
+            DBG_PRINT("initAdaptersPipelined: %s: result %d", reqs[i]->toString().c_str(), isModeSuccess(res[i]));
         }
-        const MgmtEvtAdapterInfo * res1 = static_cast<MgmtEvtAdapterInfo*>(res.get());
-        adapterInfo = res1->toAdapterInfo();
-        if( dev_id != adapterInfo->dev_id ) {
-            throw InternalError("AdapterInfo dev_id="+std::to_string(adapterInfo->dev_id)+" != dev_id="+std::to_string(dev_id)+"]: "+adapterInfo->toString(), E_FILE_LINE);
+    }
+    for(auto it = dev_ids.begin(); it != dev_ids.end(); it++) {
+        removeDeviceFromWhitelist(*it, EUI48_ANY_DEVICE, BDAddressType::BDADDR_BREDR); // flush whitelist!
+    }
+    // Power on all adapters at once, being the most time consuming command
+    reqs.clear();
+    for(auto it = dev_ids.begin(); it != dev_ids.end(); it++) {
+        reqs.push_back( std::make_shared<MgmtUint8Cmd>(MgmtOpcode::SET_POWERED, *it, 1) );
+    }
+    {
+        std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+        for(size_t i=0; i<reqs.size(); i++) {
+            DBG_PRINT("initAdaptersPipelined[%d]: SET_POWERED(1): result %d", dev_ids[i], isModeSuccess(res[i]));
         }
     }
-    DBG_PRINT("initAdapter[%d]: End: %s", dev_id, adapterInfo->toString().c_str());
 
-fail:
-    return adapterInfo;
+    /**
+     * Update AdapterSettings post settings
+     */
+    reqs.clear();
+    for(auto it = dev_ids.begin(); it != dev_ids.end(); it++) {
+        reqs.push_back( std::make_shared<MgmtCommand>(MgmtOpcode::READ_INFO, *it) );
+    }
+    std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+    bool ok = true;
+    for(size_t i=0; i<dev_ids.size(); i++) {
+        std::shared_ptr<AdapterInfo> adapterInfo = toAdapterInfo(dev_ids[i], res[i]);
+        if( nullptr != adapterInfo ) {
+            DBG_PRINT("initAdaptersPipelined[%d]: End: %s", dev_ids[i], adapterInfo->toString().c_str());
+            setAdapterInfo(dev_ids[i], adapterInfo);
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void DBTManager::setAdapterInfo(const uint16_t dev_id, std::shared_ptr<AdapterInfo> adapterInfo) {
+    const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
+    adapterInfos[dev_id] = adapterInfo;
+}
+
+bool DBTManager::ensureAdapterInitialized(const int dev_id) {
+    const std::lock_guard<std::mutex> lock(mtx_adapterInit); // RAII-style acquire and relinquish via destructor
+    if( 0 > dev_id || dev_id >= static_cast<int>(adapterInitDone.size()) ) {
+        return false;
+    }
+    if( adapterInitDone[dev_id] ) {
+        return true;
+    }
+    const uint64_t t0 = getCurrentMilliseconds();
+    bool ok;
+    if( env.MGMT_ADAPTER_INIT_PIPELINED ) {
+        ok = initAdaptersPipelined(std::vector<uint16_t>{ static_cast<uint16_t>(dev_id) }, defaultBTMode);
+    } else {
+        std::shared_ptr<AdapterInfo> adapterInfo = initAdapter(dev_id, defaultBTMode);
+        ok = nullptr != adapterInfo;
+        if( ok ) {
+            setAdapterInfo(dev_id, adapterInfo);
+        }
+    }
+    const uint64_t td = getCurrentMilliseconds() - t0;
+    adapterInitDone[dev_id] = ok;
+    {
+        const std::lock_guard<std::mutex> lock2(mtx_startupStats); // RAII-style acquire and relinquish via destructor
+        startupStats.td_adapter[dev_id] = td;
+    }
+    DBG_PRINT("DBTManager::ensureAdapterInitialized[%d]: Lazy init in %" PRIu64 " ms, ok %d", dev_id, td, ok);
+    return ok;
+}
+
+ManagerStartupStats DBTManager::getStartupStats() const {
+    const std::lock_guard<std::mutex> lock(mtx_startupStats); // RAII-style acquire and relinquish via destructor
+    return startupStats;
+}
+
+std::string ManagerStartupStats::toString() const {
+    std::string res = "StartupStats[open "+std::to_string(td_open)+" ms, adapter "+std::to_string(td_adapters)+" ms [";
+    for(size_t i=0; i<td_adapter.size(); i++) {
+        if( 0 < i ) {
+            res += ", ";
+        }
+        res += std::to_string(td_adapter[i]);
+    }
+    return res + "], total "+std::to_string(td_total)+" ms, first discovery "+std::to_string(td_first_discovery)+
+            " ms, lazy "+std::to_string(lazy)+", pipelined "+std::to_string(pipelined)+"]";
 }
 
 void DBTManager::shutdownAdapter(const uint16_t dev_id) {
@@ -289,24 +637,23 @@ DBTManager::DBTManager(const BTMode _defaultBTMode)
 : env(MgmtEnv::get()),
   defaultBTMode(BTMode::NONE != _defaultBTMode ? _defaultBTMode : BTMode::LE),
   rbuffer(ClientMaxMTU), comm(HCI_DEV_NONE, HCI_CHANNEL_CONTROL),
-  mgmtEventRing(env.MGMT_EVT_RING_CAPACITY), mgmtReaderRunning(false), mgmtReaderShallStop(false)
+  mgmtReaderRunning(false), mgmtReaderShallStop(false), mgmtReaderExternal(false), metricExternalDispatch(nullptr),
+  firstDiscoveryDone(false),
+  bondingKeys(env.MGMT_BONDING_KEY_DIR),
+  timerWheel(env.MGMT_TIMER_TICK)
 {
+    startupStats.ts_start = getCurrentMilliseconds();
+    startupStats.lazy = env.MGMT_ADAPTER_INIT_LAZY;
+    startupStats.pipelined = env.MGMT_ADAPTER_INIT_PIPELINED;
     INFO_PRINT("DBTManager.ctor: pid %d", DBTManager::pidSelf);
     if( !comm.isOpen() ) {
         ERR_PRINT("DBTManager::open: Could not open mgmt control channel");
         return;
     }
-
-    {
-        struct sigaction sa_setup;
-        bzero(&sa_setup, sizeof(sa_setup));
-        sa_setup.sa_sigaction = mgmthandler_sigaction;
-        sigemptyset(&(sa_setup.sa_mask));
-        sa_setup.sa_flags = SA_SIGINFO;
-        if( 0 != sigaction( SIGALRM, &sa_setup, NULL ) ) {
-            ERR_PRINT("DBTManager::ctor: Setting sighandler");
-        }
+    if( env.MGMT_RX_TIMESTAMPS && !comm.enableRxTimestamps() ) {
+        WARN_PRINT("DBTManager::ctor: setsockopt SO_TIMESTAMPNS failed -> using read timestamps");
     }
+
     {
         std::unique_lock<std::mutex> lock(mtx_mgmtReaderInit); // RAII-style acquire and relinquish via destructor
         mgmtReaderThread = std::thread(&DBTManager::mgmtReaderThreadImpl, this);
@@ -387,7 +734,15 @@ next1:
             ERR_PRINT("Insufficient data for %d adapter indices: res %s", num_adapter, res->toString().c_str());
             goto fail;
         }
-        adapterInfos.resize(num_adapter, nullptr);
+        const uint64_t t1 = getCurrentMilliseconds();
+        startupStats.td_open = t1 - startupStats.ts_start;
+        startupStats.td_adapter.resize(num_adapter, 0);
+        {
+            const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
+            adapterInfos.resize(num_adapter, nullptr);
+        }
+        adapterInitDone.resize(num_adapter, false);
+        std::vector<uint16_t> dev_ids;
         for(int i=0; ok && i < num_adapter; i++) {
             const uint16_t dev_id = get_uint16(data, 2+i*2, true /* littleEndian */);
             if( dev_id >= num_adapter ) {
@@ -396,34 +751,63 @@ next1:
             if( adapterInfos[dev_id] != nullptr ) {
                 throw InternalError("adapters[dev_id="+std::to_string(dev_id)+"] != nullptr: "+adapterInfos[dev_id]->toString(), E_FILE_LINE);
             }
-            std::shared_ptr<AdapterInfo> adapterInfo = initAdapter(dev_id, defaultBTMode);
-            adapterInfos[dev_id] = adapterInfo;
+            const uint64_t t2 = getCurrentMilliseconds();
+            std::shared_ptr<AdapterInfo> adapterInfo;
+            if( env.MGMT_ADAPTER_INIT_LAZY || env.MGMT_ADAPTER_INIT_PIPELINED ) {
+                // setup deferred to ensureAdapterInitialized() or the pipelined batch below
+                adapterInfo = readAdapterInfo(dev_id);
+            } else {
+                adapterInfo = initAdapter(dev_id, defaultBTMode);
+                adapterInitDone[dev_id] = nullptr != adapterInfo;
+                startupStats.td_adapter[dev_id] = getCurrentMilliseconds() - t2;
+            }
+            setAdapterInfo(dev_id, adapterInfo);
             if( nullptr != adapterInfo ) {
                 DBG_PRINT("DBTManager::adapters %d/%d: dev_id %d: %s", i, num_adapter, dev_id, adapterInfo->toString().c_str());
+                dev_ids.push_back(dev_id);
                 ok = true;
             } else {
                 DBG_PRINT("DBTManager::adapters %d/%d: dev_id %d: FAILED", i, num_adapter, dev_id);
                 ok = false;
             }
         }
+        if( ok && !env.MGMT_ADAPTER_INIT_LAZY && env.MGMT_ADAPTER_INIT_PIPELINED && dev_ids.size() > 0 ) {
+            const uint64_t t2 = getCurrentMilliseconds();
+            ok = initAdaptersPipelined(dev_ids, defaultBTMode);
+            const uint64_t td = getCurrentMilliseconds() - t2;
+            for(auto it = dev_ids.begin(); it != dev_ids.end(); it++) {
+                adapterInitDone[*it] = ok;
+                startupStats.td_adapter[*it] = td;
+            }
+        }
+        startupStats.td_adapters = getCurrentMilliseconds() - t1;
     }
 
     if( ok ) {
         if( env.DEBUG_EVENT ) {
             addMgmtEventCallback(-1, MgmtEvent::Opcode::CLASS_OF_DEV_CHANGED, bindMemberFunc(this, &DBTManager::mgmtEvClassOfDeviceChangedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DISCOVERING, bindMemberFunc(this, &DBTManager::mgmtEvDeviceDiscoveringCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_FOUND, bindMemberFunc(this, &DBTManager::mgmtEvDeviceFoundCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_DISCONNECTED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceDisconnectedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_CONNECTED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceConnectedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::CONNECT_FAILED, bindMemberFunc(this, &DBTManager::mgmtEvConnectFailedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_BLOCKED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceBlockedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_UNBLOCKED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceUnblockedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_UNPAIRED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceUnpairedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::NEW_CONN_PARAM, bindMemberFunc(this, &DBTManager::mgmtEvNewConnectionParamCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_WHITELIST_ADDED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceWhitelistAddedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::DEVICE_WHITELIST_REMOVED, bindMemberFunc(this, &DBTManager::mgmtEvDeviceWhilelistRemovedCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::PIN_CODE_REQUEST, bindMemberFunc(this, &DBTManager::mgmtEvPinCodeRequestCB));
-            addMgmtEventCallback(-1, MgmtEvent::Opcode::USER_PASSKEY_REQUEST, bindMemberFunc(this, &DBTManager::mgmtEvUserPasskeyRequestCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceDiscoveringCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceFoundCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceDisconnectedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceConnectedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvConnectFailedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceBlockedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceUnblockedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceUnpairedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvNewConnectionParamCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceWhitelistAddedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceWhilelistRemovedCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvPinCodeRequestCB));
+            addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvUserPasskeyRequestCB));
+        }
+        addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvFirstDiscoveringCB));
+        addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvNewLongTermKeyCB));
+        addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvNewIdentityResolvingKeyCB));
+        addMgmtEventHandler(-1, bindMemberFunc(this, &DBTManager::mgmtEvDeviceUnpairedKeysCB));
+        {
+            const std::lock_guard<std::mutex> lock(mtx_startupStats); // RAII-style acquire and relinquish via destructor
+            startupStats.td_total = getCurrentMilliseconds() - startupStats.ts_start;
+            INFO_PRINT("DBTManager: %s", startupStats.toString().c_str());
         }
         PERF_TS_TD("DBTManager::open.ok");
         return;
@@ -442,15 +826,28 @@ void DBTManager::close() {
 
     clearAllMgmtEventCallbacks();
 
-    for (auto it = adapterInfos.begin(); it != adapterInfos.end(); it++) {
-        shutdownAdapter((*it)->dev_id);
+    {
+        const std::lock_guard<std::mutex> lock(mtx_adapterInit); // RAII-style acquire and relinquish via destructor
+        for (size_t dev_id = 0; dev_id < adapterInitDone.size(); dev_id++) {
+            if( adapterInitDone[dev_id] ) {
+                shutdownAdapter(dev_id);
+            }
+        }
+        adapterInitDone.clear();
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
+        adapterInfos.clear();
     }
-    adapterInfos.clear();
 
     if( mgmtReaderRunning && mgmtReaderThread.joinable() ) {
         mgmtReaderShallStop = true;
-        pthread_t tid = mgmtReaderThread.native_handle();
-        pthread_kill(tid, SIGALRM);
+        comm.interrupt(); // wake up the reader at once
+    } else if( mgmtReaderExternal && mgmtReaderRunning ) {
+        // No reader thread, the external event loop shall remove our fd
+        mgmtReaderShallStop = true;
+        mgmtReaderRunning = false;
+        clearPendingReplies();
     }
     comm.close();
 
@@ -460,20 +857,12 @@ void DBTManager::close() {
         mgmtReaderThread.join();
     }
     mgmtReaderThread = std::thread(); // empty
-    {
-        struct sigaction sa_setup;
-        bzero(&sa_setup, sizeof(sa_setup));
-        sa_setup.sa_handler = SIG_DFL;
-        sigemptyset(&(sa_setup.sa_mask));
-        sa_setup.sa_flags = 0;
-        if( 0 != sigaction( SIGALRM, &sa_setup, NULL ) ) {
-            ERR_PRINT("DBTManager.sigaction: Resetting sighandler");
-        }
-    }
+    timerWheel.stop();
     DBG_PRINT("DBTManager::close: End");
 }
 
 int DBTManager::findAdapterInfoIdx(const EUI48 &mac) const {
+    const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
     auto begin = adapterInfos.begin();
     auto it = std::find_if(begin, adapterInfos.end(), [&](std::shared_ptr<AdapterInfo> const& p) {
         return p->address == mac;
@@ -485,6 +874,7 @@ int DBTManager::findAdapterInfoIdx(const EUI48 &mac) const {
     }
 }
 std::shared_ptr<AdapterInfo> DBTManager::findAdapterInfo(const EUI48 &mac) const {
+    const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
     auto begin = adapterInfos.begin();
     auto it = std::find_if(begin, adapterInfos.end(), [&](std::shared_ptr<AdapterInfo> const& p) {
         return p->address == mac;
@@ -496,6 +886,7 @@ std::shared_ptr<AdapterInfo> DBTManager::findAdapterInfo(const EUI48 &mac) const
     }
 }
 std::shared_ptr<AdapterInfo> DBTManager::getAdapterInfo(const int idx) const {
+    const std::lock_guard<std::mutex> lock(mtx_adapterInfos); // RAII-style acquire and relinquish via destructor
     if( 0 > idx || idx >= static_cast<int>(adapterInfos.size()) ) {
         throw IndexOutOfBoundsException(idx, adapterInfos.size(), 1, E_FILE_LINE);
     }
@@ -505,17 +896,7 @@ std::shared_ptr<AdapterInfo> DBTManager::getAdapterInfo(const int idx) const {
 
 bool DBTManager::setMode(const int dev_id, const MgmtOpcode opc, const uint8_t mode) {
     MgmtUint8Cmd req(opc, dev_id, mode);
-    std::shared_ptr<MgmtEvent> res = sendWithReply(req);
-    if( nullptr != res ) {
-        if( res->getOpcode() == MgmtEvent::Opcode::CMD_COMPLETE ) {
-            const MgmtEvtCmdComplete &res1 = *static_cast<const MgmtEvtCmdComplete *>(res.get());
-            return MgmtStatus::SUCCESS == res1.getStatus();
-        } else if( res->getOpcode() == MgmtEvent::Opcode::CMD_STATUS ) {
-            const MgmtEvtCmdStatus &res1 = *static_cast<const MgmtEvtCmdStatus *>(res.get());
-            return MgmtStatus::SUCCESS == res1.getStatus();
-        }
-    }
-    return false;
+    return isModeSuccess( sendWithReply(req) );
 }
 
 ScanType DBTManager::startDiscovery(const int dev_id, const BTMode btMode) {
@@ -557,6 +938,25 @@ bool DBTManager::uploadConnParam(const int dev_id, const EUI48 &address, const B
     return false;
 }
 
+bool DBTManager::uploadConnParam(const int dev_id, const std::vector<std::shared_ptr<MgmtConnParam>> & connParams) {
+    std::vector<std::shared_ptr<MgmtCommand>> reqs;
+    for(size_t i = 0; i < connParams.size(); i += MgmtLoadConnParamCmd::MAX_PARAM_COUNT) {
+        const size_t count = std::min<size_t>(connParams.size() - i, MgmtLoadConnParamCmd::MAX_PARAM_COUNT);
+        std::vector<std::shared_ptr<MgmtConnParam>> chunk(connParams.begin() + i, connParams.begin() + i + count);
+        reqs.push_back( std::make_shared<MgmtLoadConnParamCmd>(dev_id, chunk) );
+    }
+    const std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+    bool ok = true;
+    for(size_t i = 0; i < res.size(); i++) {
+        if( nullptr == res[i] || res[i]->getOpcode() != MgmtEvent::Opcode::CMD_COMPLETE ||
+            MgmtStatus::SUCCESS != static_cast<const MgmtEvtCmdComplete *>(res[i].get())->getStatus() ) {
+            ERR_PRINT("DBTManager::uploadConnParam: Failed %zd/%zd: %s", i+1, res.size(), reqs[i]->toString().c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 bool DBTManager::isDeviceWhitelisted(const int dev_id, const EUI48 &address) {
     for(auto it = whitelist.begin(); it != whitelist.end(); ) {
         std::shared_ptr<WhitelistElem> wle = *it;
@@ -589,6 +989,58 @@ bool DBTManager::addDeviceToWhitelist(const int dev_id, const EUI48 &address, co
     return false;
 }
 
+static bool isCmdCompleteSuccess(const std::shared_ptr<MgmtEvent> &res) {
+    return nullptr != res && res->getOpcode() == MgmtEvent::Opcode::CMD_COMPLETE &&
+           MgmtStatus::SUCCESS == static_cast<const MgmtEvtCmdComplete *>(res.get())->getStatus();
+}
+
+int DBTManager::addDevicesToWhitelist(const int dev_id, const std::vector<BDAddressKey> & devices, const HCIWhitelistConnectType ctype) {
+    std::vector<std::shared_ptr<MgmtCommand>> reqs;
+    std::vector<const BDAddressKey*> reqDevices;
+    for(auto it = devices.begin(); it != devices.end(); ++it) {
+        if( isDeviceWhitelisted(dev_id, it->address) ) {
+            DBG_PRINT("DBTManager::addDevicesToWhitelist: Already in local whitelist, skipped: %s", it->address.toString().c_str());
+            continue;
+        }
+        reqs.push_back( std::make_shared<MgmtAddDeviceToWhitelistCmd>(dev_id, it->address, it->addressType, ctype) );
+        reqDevices.push_back( &(*it) );
+    }
+    const std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+    int count = 0;
+    for(size_t i = 0; i < res.size(); i++) {
+        if( isCmdCompleteSuccess(res[i]) ) {
+            std::shared_ptr<WhitelistElem> wle( new WhitelistElem{dev_id, reqDevices[i]->address, reqDevices[i]->addressType, ctype} );
+            whitelist.push_back(wle);
+            count++;
+        }
+    }
+    DBG_PRINT("DBTManager::addDevicesToWhitelist: Added %d/%zd devices", count, devices.size());
+    return count;
+}
+
+int DBTManager::removeDevicesFromWhitelist(const int dev_id, const std::vector<BDAddressKey> & devices) {
+    std::vector<std::shared_ptr<MgmtCommand>> reqs;
+    for(auto it = devices.begin(); it != devices.end(); ++it) {
+        reqs.push_back( std::make_shared<MgmtRemoveDeviceFromWhitelistCmd>(dev_id, it->address, it->addressType) );
+    }
+    // Remove from our local whitelist first
+    whitelist.erase( std::remove_if(whitelist.begin(), whitelist.end(), [&](const std::shared_ptr<WhitelistElem> &wle) {
+        return wle->dev_id == dev_id && devices.end() != std::find_if(devices.begin(), devices.end(), [&](const BDAddressKey &k) {
+            return k.address == wle->address;
+        });
+    }), whitelist.end() );
+
+    const std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+    int count = 0;
+    for(size_t i = 0; i < res.size(); i++) {
+        if( isCmdCompleteSuccess(res[i]) ) {
+            count++;
+        }
+    }
+    DBG_PRINT("DBTManager::removeDevicesFromWhitelist: Removed %d/%zd devices", count, devices.size());
+    return count;
+}
+
 int DBTManager::removeAllDevicesFromWhitelist() {
 #if 0
     std::vector<std::shared_ptr<WhitelistElem>> whitelist_copy = whitelist;
@@ -604,8 +1056,16 @@ int DBTManager::removeAllDevicesFromWhitelist() {
     int count = whitelist.size();
     DBG_PRINT("DBTManager::removeAllDevicesFromWhitelist.B: Start %d elements", count);
     whitelist.clear();
-    for (auto it = adapterInfos.begin(); it != adapterInfos.end(); it++) {
-        removeDeviceFromWhitelist((*it)->dev_id, EUI48_ANY_DEVICE, BDAddressType::BDADDR_BREDR); // flush whitelist!
+    {
+        // flush whitelist of all adapters at once
+        std::vector<std::shared_ptr<MgmtCommand>> reqs;
+        const std::vector<std::shared_ptr<AdapterInfo>> infos = getAdapterInfos();
+        for (auto it = infos.begin(); it != infos.end(); it++) {
+            if( nullptr != *it ) {
+                reqs.push_back( std::make_shared<MgmtRemoveDeviceFromWhitelistCmd>((*it)->dev_id, EUI48_ANY_DEVICE, BDAddressType::BDADDR_BREDR) );
+            }
+        }
+        sendWithReplies(reqs);
     }
 #endif
 
@@ -691,147 +1151,249 @@ std::shared_ptr<NameAndShortName> DBTManager::setLocalName(const int dev_id, con
     return nullptr;
 }
 
+static MgmtStatus getReplyStatus(const std::shared_ptr<MgmtEvent> &res) {
+    if( nullptr != res ) {
+        if( res->getOpcode() == MgmtEvent::Opcode::CMD_COMPLETE ) {
+            return static_cast<const MgmtEvtCmdComplete *>(res.get())->getStatus();
+        } else if( res->getOpcode() == MgmtEvent::Opcode::CMD_STATUS ) {
+            return static_cast<const MgmtEvtCmdStatus *>(res.get())->getStatus();
+        }
+    }
+    return MgmtStatus::TIMEOUT;
+}
+
+MgmtStatus DBTManager::pairDevice(const int dev_id, const EUI48 &address, const BDAddressType address_type, const SMPIOCapability iocap) {
+    MgmtPairDeviceCmd req(dev_id, address, address_type, iocap);
+    std::shared_ptr<PendingReply> pending;
+    std::future<std::shared_ptr<MgmtEvent>> reply = sendAsync(req, pending);
+    // The kernel replies once pairing completed, i.e. after the SMP exchange including user interaction
+    std::shared_ptr<MgmtEvent> res = waitForReply(req, pending, reply, env.MGMT_PAIR_DEVICE_TIMEOUT);
+    if( nullptr == res ) {
+        uint8_t addr_info[6+1]; // mgmt_addr_info
+        memcpy(addr_info, address.b, 6);
+        addr_info[6] = address_type;
+        MgmtCommand req1(MgmtOpcode::CANCEL_PAIR_DEVICE, dev_id, sizeof(addr_info), addr_info);
+        sendWithReply(req1);
+        return MgmtStatus::TIMEOUT;
+    }
+    const MgmtStatus status = getReplyStatus(res);
+    DBG_PRINT("DBTManager::pairDevice: %s: %s", getMgmtStatusString(status).c_str(), req.toString().c_str());
+    return status;
+}
+
+bool DBTManager::unpairDevice(const int dev_id, const EUI48 &address, const BDAddressType address_type, const bool disconnect) {
+    MgmtUnpairDeviceCmd req(dev_id, address, address_type, disconnect);
+    std::shared_ptr<AdapterInfo> adapterInfo = getAdapterInfo(dev_id);
+    if( nullptr != adapterInfo ) {
+        bondingKeys.remove(adapterInfo->address, address, address_type);
+    }
+    const MgmtStatus status = getReplyStatus( sendWithReply(req) );
+    return MgmtStatus::SUCCESS == status || MgmtStatus::NOT_PAIRED == status;
+}
+
+bool DBTManager::loadLongTermKeys(const int dev_id, const std::vector<MgmtLongTermKeyInfo> & keys) {
+    if( keys.size() > MgmtLoadLongTermKeyCmd::MAX_KEY_COUNT ) {
+        ERR_PRINT("DBTManager::loadLongTermKeys: %zd keys exceed maximum %d", keys.size(), MgmtLoadLongTermKeyCmd::MAX_KEY_COUNT);
+        return false;
+    }
+    MgmtLoadLongTermKeyCmd req(dev_id, keys);
+    return isCmdCompleteSuccess( sendWithReply(req) );
+}
+
+bool DBTManager::loadIdentityResolvingKeys(const int dev_id, const std::vector<MgmtIdentityResolvingKeyInfo> & keys) {
+    if( keys.size() > MgmtLoadIdentityResolvingKeyCmd::MAX_KEY_COUNT ) {
+        ERR_PRINT("DBTManager::loadIdentityResolvingKeys: %zd keys exceed maximum %d", keys.size(), MgmtLoadIdentityResolvingKeyCmd::MAX_KEY_COUNT);
+        return false;
+    }
+    MgmtLoadIdentityResolvingKeyCmd req(dev_id, keys);
+    return isCmdCompleteSuccess( sendWithReply(req) );
+}
+
+bool DBTManager::loadBondingKeys(const int dev_id) {
+    std::shared_ptr<AdapterInfo> adapterInfo = getAdapterInfo(dev_id);
+    if( nullptr == adapterInfo ) {
+        return false;
+    }
+    std::vector<std::shared_ptr<MgmtCommand>> reqs;
+    addBondingKeyCommands(reqs, dev_id, adapterInfo->address);
+    const std::vector<std::shared_ptr<MgmtEvent>> res = sendWithReplies(reqs);
+    bool ok = true;
+    for(size_t i = 0; i < res.size(); i++) {
+        if( !isCmdCompleteSuccess(res[i]) ) {
+            ERR_PRINT("DBTManager::loadBondingKeys: Failed %zd/%zd: %s", i+1, res.size(), reqs[i]->toString().c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 /***
  *
  * MgmtEventCallback section
  *
  */
 
-void DBTManager::addMgmtEventCallback(const int dev_id, const MgmtEvent::Opcode opc, const MgmtEventCallback &cb) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
-    checkMgmtEventCallbackListsIndex(opc);
-    MgmtAdapterEventCallbackList &l = mgmtAdapterEventCallbackLists[static_cast<uint16_t>(opc)];
-    for (auto it = l.begin(); it != l.end(); ++it) {
-        if ( it->getDevID() == dev_id && it->getCallback() == cb ) {
-            // already exists for given adapter
-            return;
+MgmtAdapterEventCallbackList & DBTManager::getMgmtEventCallbackList(const MgmtEvent::Opcode opc, const int dev_id) {
+    MgmtAdapterEventCallbackIndex & index = mgmtAdapterEventCallbackLists[static_cast<uint16_t>(opc)];
+    if( 0 > dev_id ) {
+        return index.wildcard;
+    }
+    COWVector<std::shared_ptr<MgmtAdapterEventCallbackList>>::snapshot_t byDevID = index.byDevID.get_snapshot();
+    if( dev_id >= static_cast<int>(byDevID->size()) ) {
+        std::shared_ptr<std::vector<std::shared_ptr<MgmtAdapterEventCallbackList>>> store = index.byDevID.copy_store();
+        while( dev_id >= static_cast<int>(store->size()) ) {
+            store->push_back( std::make_shared<MgmtAdapterEventCallbackList>() );
         }
+        index.byDevID.set_store(std::move(store));
+        byDevID = index.byDevID.get_snapshot();
     }
-    l.push_back( MgmtAdapterEventCallback(dev_id, cb) );
+    return *(*byDevID)[dev_id];
+}
+
+void DBTManager::addMgmtEventCallback(const int dev_id, const MgmtEvent::Opcode opc, const MgmtEventCallback &cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    checkMgmtEventCallbackListsIndex(opc);
+    MgmtAdapterEventCallbackList &l = getMgmtEventCallbackList(opc, dev_id);
+    // no-op if already existing for given adapter
+    l.push_back_unique( MgmtAdapterEventCallback(dev_id, cb),
+            [](const MgmtAdapterEventCallback &a, const MgmtAdapterEventCallback &b) { return a == b; } );
 }
 int DBTManager::removeMgmtEventCallback(const MgmtEvent::Opcode opc, const MgmtEventCallback &cb) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     checkMgmtEventCallbackListsIndex(opc);
-    int count = 0;
-    MgmtAdapterEventCallbackList &l = mgmtAdapterEventCallbackLists[static_cast<uint16_t>(opc)];
-    for (auto it = l.begin(); it != l.end(); ) {
-        if ( it->getCallback() == cb ) {
-            it = l.erase(it);
-            count++;
-        } else {
-            ++it;
-        }
+    MgmtAdapterEventCallbackIndex &index = mgmtAdapterEventCallbackLists[static_cast<uint16_t>(opc)];
+    int count = index.wildcard.erase_matching(true /* all */, [&cb](const MgmtAdapterEventCallback &it) { return it.getCallback() == cb; });
+    const COWVector<std::shared_ptr<MgmtAdapterEventCallbackList>>::snapshot_t byDevID = index.byDevID.get_snapshot();
+    for(auto lit = byDevID->begin(); lit != byDevID->end(); ++lit) {
+        count += (*lit)->erase_matching(true /* all */, [&cb](const MgmtAdapterEventCallback &it) { return it.getCallback() == cb; });
     }
     return count;
 }
 int DBTManager::removeMgmtEventCallback(const int dev_id) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     int count = 0;
     for(size_t i=0; i<mgmtAdapterEventCallbackLists.size(); i++) {
-        MgmtAdapterEventCallbackList &l = mgmtAdapterEventCallbackLists[i];
-        for (auto it = l.begin(); it != l.end(); ) {
-            if ( it->getDevID() == dev_id ) {
-                it = l.erase(it);
-                count++;
-            } else {
-                ++it;
+        MgmtAdapterEventCallbackIndex &index = mgmtAdapterEventCallbackLists[i];
+        if( 0 > dev_id ) {
+            count += index.wildcard.erase_matching(true /* all */, [dev_id](const MgmtAdapterEventCallback &it) { return it.getDevID() == dev_id; });
+        } else {
+            const COWVector<std::shared_ptr<MgmtAdapterEventCallbackList>>::snapshot_t byDevID = index.byDevID.get_snapshot();
+            if( dev_id < static_cast<int>(byDevID->size()) ) {
+                MgmtAdapterEventCallbackList &l = *(*byDevID)[dev_id];
+                count += l.size();
+                l.clear();
             }
         }
     }
     return count;
 }
 void DBTManager::clearMgmtEventCallbacks(const MgmtEvent::Opcode opc) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     checkMgmtEventCallbackListsIndex(opc);
-    mgmtAdapterEventCallbackLists[static_cast<uint16_t>(opc)].clear();
+    MgmtAdapterEventCallbackIndex &index = mgmtAdapterEventCallbackLists[static_cast<uint16_t>(opc)];
+    index.wildcard.clear();
+    index.byDevID.clear();
 }
 void DBTManager::clearAllMgmtEventCallbacks() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     for(size_t i=0; i<mgmtAdapterEventCallbackLists.size(); i++) {
-        mgmtAdapterEventCallbackLists[i].clear();
+        mgmtAdapterEventCallbackLists[i].wildcard.clear();
+        mgmtAdapterEventCallbackLists[i].byDevID.clear();
     }
 }
 
-bool DBTManager::mgmtEvClassOfDeviceChangedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:ClassOfDeviceChanged: %s", e->toString().c_str());
+bool DBTManager::mgmtEvClassOfDeviceChangedCB(const MgmtEvent& e) {
+    PLAIN_PRINT("DBTManager::EventCB:ClassOfDeviceChanged: %s", e.toString().c_str());
     (void)e;
     return true;
 }
-bool DBTManager::mgmtEvDeviceDiscoveringCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceDiscovering: %s", e->toString().c_str());
-    const MgmtEvtDiscovering &event = *static_cast<const MgmtEvtDiscovering *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceDiscoveringCB(const MgmtEvtDiscovering &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceDiscovering: %s", event.toString().c_str());
+    return true;
+}
+bool DBTManager::mgmtEvDeviceFoundCB(const MgmtEvtDeviceFound &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceFound: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceFoundCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceFound: %s", e->toString().c_str());
-    const MgmtEvtDeviceFound &event = *static_cast<const MgmtEvtDeviceFound *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceDisconnectedCB(const MgmtEvtDeviceDisconnected &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceDisconnected: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceDisconnectedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceDisconnected: %s", e->toString().c_str());
-    const MgmtEvtDeviceDisconnected &event = *static_cast<const MgmtEvtDeviceDisconnected *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceConnectedCB(const MgmtEvtDeviceConnected &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceConnected: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceConnectedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceConnected: %s", e->toString().c_str());
-    const MgmtEvtDeviceConnected &event = *static_cast<const MgmtEvtDeviceConnected *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvConnectFailedCB(const MgmtEvtDeviceConnectFailed &event) {
+    PLAIN_PRINT("DBTManager::EventCB:ConnectFailed: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvConnectFailedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:ConnectFailed: %s", e->toString().c_str());
-    const MgmtEvtDeviceConnectFailed &event = *static_cast<const MgmtEvtDeviceConnectFailed *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceBlockedCB(const MgmtEvtDeviceBlocked &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceBlocked: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceBlockedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceBlocked: %s", e->toString().c_str());
-    const MgmtEvtDeviceBlocked &event = *static_cast<const MgmtEvtDeviceBlocked *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceUnblockedCB(const MgmtEvtDeviceUnblocked &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceUnblocked: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceUnblockedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceUnblocked: %s", e->toString().c_str());
-    const MgmtEvtDeviceUnblocked &event = *static_cast<const MgmtEvtDeviceUnblocked *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceUnpairedCB(const MgmtEvtDeviceUnpaired &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceUnpaired: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceUnpairedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceUnpaired: %s", e->toString().c_str());
-    const MgmtEvtDeviceUnpaired &event = *static_cast<const MgmtEvtDeviceUnpaired *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvNewConnectionParamCB(const MgmtEvtNewConnectionParam &event) {
+    PLAIN_PRINT("DBTManager::EventCB:NewConnectionParam: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvNewConnectionParamCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:NewConnectionParam: %s", e->toString().c_str());
-    const MgmtEvtNewConnectionParam &event = *static_cast<const MgmtEvtNewConnectionParam *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceWhitelistAddedCB(const MgmtEvtDeviceWhitelistAdded &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceWhitelistAdded: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceWhitelistAddedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceWhitelistAdded: %s", e->toString().c_str());
-    const MgmtEvtDeviceWhitelistAdded &event = *static_cast<const MgmtEvtDeviceWhitelistAdded *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvDeviceWhilelistRemovedCB(const MgmtEvtDeviceWhitelistRemoved &event) {
+    PLAIN_PRINT("DBTManager::EventCB:DeviceWhitelistRemoved: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvDeviceWhilelistRemovedCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:DeviceWhitelistRemoved: %s", e->toString().c_str());
-    const MgmtEvtDeviceWhitelistRemoved &event = *static_cast<const MgmtEvtDeviceWhitelistRemoved *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvFirstDiscoveringCB(const MgmtEvtDiscovering &event) {
+    bool expected = false;
+    if( event.getEnabled() && firstDiscoveryDone.compare_exchange_strong(expected, true) ) {
+        const std::lock_guard<std::mutex> lock(mtx_startupStats); // RAII-style acquire and relinquish via destructor
+        startupStats.td_first_discovery = event.getTimestamp() - startupStats.ts_start;
+        INFO_PRINT("DBTManager: First discovery of dev_id %d after %" PRIu64 " ms", event.getDevID(), startupStats.td_first_discovery);
+    }
     return true;
 }
-bool DBTManager::mgmtEvPinCodeRequestCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:PinCodeRequest: %s", e->toString().c_str());
-    const MgmtEvtPinCodeRequest &event = *static_cast<const MgmtEvtPinCodeRequest *>(e.get());
-    (void)event;
+
+bool DBTManager::mgmtEvPinCodeRequestCB(const MgmtEvtPinCodeRequest &event) {
+    PLAIN_PRINT("DBTManager::EventCB:PinCodeRequest: %s", event.toString().c_str());
     return true;
 }
-bool DBTManager::mgmtEvUserPasskeyRequestCB(std::shared_ptr<MgmtEvent> e) {
-    PLAIN_PRINT("DBTManager::EventCB:UserPasskeyRequest: %s", e->toString().c_str());
-    const MgmtEvtUserPasskeyRequest &event = *static_cast<const MgmtEvtUserPasskeyRequest *>(e.get());
-    (void)event;
+bool DBTManager::mgmtEvUserPasskeyRequestCB(const MgmtEvtUserPasskeyRequest &event) {
+    PLAIN_PRINT("DBTManager::EventCB:UserPasskeyRequest: %s", event.toString().c_str());
+    return true;
+}
+
+bool DBTManager::mgmtEvNewLongTermKeyCB(const MgmtEvtNewLongTermKey &event) {
+    COND_PRINT(env.DEBUG_EVENT, "DBTManager::EventCB:NewLongTermKey: %s", event.toString().c_str());
+    if( event.getStoreHint() ) {
+        std::shared_ptr<AdapterInfo> adapterInfo = getAdapterInfo(event.getDevID());
+        if( nullptr != adapterInfo ) {
+            bondingKeys.putLongTermKey(adapterInfo->address, event.getKey());
+        }
+    }
+    return true;
+}
+bool DBTManager::mgmtEvNewIdentityResolvingKeyCB(const MgmtEvtNewIdentityResolvingKey &event) {
+    COND_PRINT(env.DEBUG_EVENT, "DBTManager::EventCB:NewIdentityResolvingKey: %s", event.toString().c_str());
+    if( event.getStoreHint() ) {
+        std::shared_ptr<AdapterInfo> adapterInfo = getAdapterInfo(event.getDevID());
+        if( nullptr != adapterInfo ) {
+            bondingKeys.putIdentityResolvingKey(adapterInfo->address, event.getKey());
+        }
+    }
+    return true;
+}
+bool DBTManager::mgmtEvDeviceUnpairedKeysCB(const MgmtEvtDeviceUnpaired &event) {
+    std::shared_ptr<AdapterInfo> adapterInfo = getAdapterInfo(event.getDevID());
+    if( nullptr != adapterInfo ) {
+        bondingKeys.remove(adapterInfo->address, event.getAddress(), event.getAddressType());
+    }
     return true;
 }
@@ -0,0 +1,255 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <cinttypes>
+#include <cstdio>
+#include <algorithm>
+
+#include "DBTMetrics.hpp"
+#include "DBTEnv.hpp"
+#include "BasicTypes.hpp"
+
+using namespace direct_bt;
+
+uint64_t LatencyHistogram::getBucketLowerBound(const int index) {
+    if( index < SUB_BUCKET_COUNT ) {
+        return static_cast<uint64_t>(index);
+    }
+    const int group = index / SUB_BUCKET_COUNT;
+    const uint64_t sub = static_cast<uint64_t>( index % SUB_BUCKET_COUNT );
+    return ( SUB_BUCKET_COUNT + sub ) << ( group - 1 );
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound(const int index) {
+    if( index < SUB_BUCKET_COUNT ) {
+        return static_cast<uint64_t>(index) + 1;
+    }
+    return getBucketLowerBound(index) + ( static_cast<uint64_t>(1) << ( index / SUB_BUCKET_COUNT - 1 ) );
+}
+
+LatencyHistogram::LatencyHistogram()
+: count(0), errors(0), sum(0), max(0)
+{
+    for(int i=0; i<BUCKET_COUNT; i++) {
+        buckets[i] = 0;
+    }
+}
+
+void LatencyHistogram::recordSince(const uint64_t t0, const bool success) {
+    if( success ) {
+        const uint64_t t1 = getCurrentMicroseconds();
+        record( t1 > t0 ? t1 - t0 : 0 );
+    } else {
+        recordError();
+    }
+}
+
+void LatencyHistogram::getSnapshot(LatencySnapshot & res) const {
+    res.buckets.resize(BUCKET_COUNT);
+    uint64_t c = 0;
+    for(int i=0; i<BUCKET_COUNT; i++) {
+        res.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        c += res.buckets[i];
+    }
+    res.count = c; // consistent with the buckets
+    res.errors = errors.load(std::memory_order_relaxed);
+    res.sum = sum.load(std::memory_order_relaxed);
+    res.max = max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencySnapshot::getPercentile(const double q) const {
+    if( 0 == count ) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>( q * static_cast<double>(count) + 0.5 ));
+    uint64_t c = 0;
+    for(size_t i=0; i<buckets.size(); i++) {
+        c += buckets[i];
+        if( c >= rank ) {
+            return std::min(max + 1, LatencyHistogram::getBucketUpperBound(static_cast<int>(i)));
+        }
+    }
+    return max + 1;
+}
+
+std::string LatencySnapshot::toString() const {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "count %" PRIu64 ", errors %" PRIu64 ", mean %.1f us, p50 %" PRIu64 " us, p99 %" PRIu64 " us, max %" PRIu64 " us",
+             count, errors, getMean(), getPercentile(0.50), getPercentile(0.99), max);
+    return name+( label.empty() ? "" : "{"+label+"}" )+"["+std::string(buf)+"]";
+}
+
+void RTTEstimator::addSample(const uint64_t rttUSec) noexcept {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( 0 == samples ) {
+        srtt = rttUSec;
+        rttvar = rttUSec / 2;
+    } else {
+        const uint64_t delta = srtt > rttUSec ? srtt - rttUSec : rttUSec - srtt;
+        rttvar = ( 3 * rttvar + delta ) / 4;
+        srtt = ( 7 * srtt + rttUSec ) / 8;
+    }
+    samples++;
+}
+
+void RTTEstimator::reset() noexcept {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    srtt = 0;
+    rttvar = 0;
+    samples = 0;
+}
+
+uint64_t RTTEstimator::getSampleCount() const noexcept {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return samples;
+}
+
+uint64_t RTTEstimator::getSmoothedRTT() const noexcept {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return srtt;
+}
+
+uint64_t RTTEstimator::getRTTVariation() const noexcept {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return rttvar;
+}
+
+int32_t RTTEstimator::getTimeout(const int32_t defaultMS, const int32_t minMS, const int32_t maxMS) const noexcept {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( 0 == samples ) {
+        return defaultMS;
+    }
+    const uint64_t ms = ( srtt + 4 * rttvar + 999 ) / 1000; // round up
+    return static_cast<int32_t>( std::max<uint64_t>(minMS, std::min<uint64_t>(maxMS, ms)) );
+}
+
+std::string RTTEstimator::toString() const {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return "RTT[srtt "+std::to_string(srtt)+" us, rttvar "+std::to_string(rttvar)+" us, samples "+std::to_string(samples)+"]";
+}
+
+DBTMetrics::DBTMetrics(const bool enabled_)
+: enabled(enabled_)
+{ }
+
+DBTMetrics& DBTMetrics::get() {
+    /**
+     * Thread safe starting with C++11 6.7:
+     *
+     * If control enters the declaration concurrently while the variable is being initialized,
+     * the concurrent execution shall wait for completion of the initialization.
+     *
+     * (Magic Statics)
+     */
+    static DBTMetrics m( DBTEnv::getBooleanProperty("direct_bt.metrics", true) );
+    return m;
+}
+
+LatencyHistogram& DBTMetrics::getHistogram(const std::string & name, const std::string & labelName, const std::string & labelValue) {
+    const std::string label = labelName.empty() ? "" : labelName+"=\""+labelValue+"\"";
+    const std::lock_guard<std::mutex> lock(mtx_registry); // RAII-style acquire and relinquish via destructor
+    std::unique_ptr<LatencyHistogram> & h = registry[name][label];
+    if( nullptr == h ) {
+        h = std::unique_ptr<LatencyHistogram>(new LatencyHistogram());
+    }
+    return *h;
+}
+
+MetricGauge& DBTMetrics::getGauge(const std::string & name, const std::string & labelName, const std::string & labelValue) {
+    const std::string label = labelName.empty() ? "" : labelName+"=\""+labelValue+"\"";
+    const std::lock_guard<std::mutex> lock(mtx_registry); // RAII-style acquire and relinquish via destructor
+    std::unique_ptr<MetricGauge> & g = gauges[name][label];
+    if( nullptr == g ) {
+        g = std::unique_ptr<MetricGauge>(new MetricGauge());
+    }
+    return *g;
+}
+
+std::vector<LatencySnapshot> DBTMetrics::getSnapshot() const {
+    std::vector<LatencySnapshot> res;
+    const std::lock_guard<std::mutex> lock(mtx_registry); // RAII-style acquire and relinquish via destructor
+    for(auto it = registry.begin(); it != registry.end(); it++) {
+        for(auto lit = it->second.begin(); lit != it->second.end(); lit++) {
+            res.push_back(LatencySnapshot());
+            LatencySnapshot & s = res.back();
+            s.name = it->first;
+            s.label = lit->first;
+            lit->second->getSnapshot(s);
+        }
+    }
+    return res;
+}
+
+std::string DBTMetrics::toPrometheus() const {
+    const int groups = LatencyHistogram::BUCKET_COUNT / LatencyHistogram::SUB_BUCKET_COUNT;
+    const std::vector<LatencySnapshot> snapshot = getSnapshot();
+    std::string res;
+    char buf[64];
+    for(size_t i=0; i<snapshot.size(); i++) {
+        const LatencySnapshot & s = snapshot[i];
+        const std::string metric = "direct_bt_"+s.name+"_microseconds";
+        const std::string sep = s.label.empty() ? "" : ",";
+        const std::string labels = s.label.empty() ? "" : "{"+s.label+"}";
+        if( 0 == i || snapshot[i-1].name != s.name ) {
+            res.append("# TYPE "+metric+" histogram\n");
+        }
+        // Bucket bounds at powers of two align with the log-linear buckets, 'le' being inclusive.
+        uint64_t c = 0;
+        int b = 0;
+        for(int g=0; g<groups; g++) {
+            const uint64_t upper = LatencyHistogram::getBucketUpperBound( ( g + 1 ) * LatencyHistogram::SUB_BUCKET_COUNT - 1 );
+            for(; b < ( g + 1 ) * LatencyHistogram::SUB_BUCKET_COUNT; b++) {
+                c += s.buckets[b];
+            }
+            snprintf(buf, sizeof(buf), "%" PRIu64 "\"} %" PRIu64 "\n", upper - 1, c);
+            res.append(metric+"_bucket{"+s.label+sep+"le=\""+buf);
+        }
+        res.append(metric+"_bucket{"+s.label+sep+"le=\"+Inf\"} "+std::to_string(s.count)+"\n");
+        res.append(metric+"_sum"+labels+" "+std::to_string(s.sum)+"\n");
+        res.append(metric+"_count"+labels+" "+std::to_string(s.count)+"\n");
+    }
+    for(size_t i=0; i<snapshot.size(); i++) {
+        const LatencySnapshot & s = snapshot[i];
+        const std::string metric = "direct_bt_"+s.name+"_errors_total";
+        if( 0 == i || snapshot[i-1].name != s.name ) {
+            res.append("# TYPE "+metric+" counter\n");
+        }
+        res.append(metric+( s.label.empty() ? "" : "{"+s.label+"}" )+" "+std::to_string(s.errors)+"\n");
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mtx_registry); // RAII-style acquire and relinquish via destructor
+        for(auto it = gauges.begin(); it != gauges.end(); it++) {
+            const std::string metric = "direct_bt_"+it->first;
+            res.append("# TYPE "+metric+" gauge\n");
+            for(auto lit = it->second.begin(); lit != it->second.end(); lit++) {
+                res.append(metric+( lit->first.empty() ? "" : "{"+lit->first+"}" )+" "+std::to_string(lit->second->get())+"\n");
+            }
+        }
+    }
+    return res;
+}
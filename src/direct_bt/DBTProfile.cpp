@@ -0,0 +1,68 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+#include "direct_bt/DBTProfile.hpp"
+#include "direct_bt/dbt_debug.hpp"
+
+extern "C" {
+    #include <pthread.h>
+    #include <sched.h>
+}
+
+using namespace direct_bt;
+
+bool DBTProfile::applyReaderPriorityToCurrentThread() const {
+    if( 0 > readerFIFOPriority ) {
+        return true;
+    }
+    struct sched_param param;
+    bzero(&param, sizeof(param));
+    int policy = SCHED_OTHER;
+    if( 0 < readerFIFOPriority ) {
+        policy = SCHED_FIFO;
+        param.sched_priority = readerFIFOPriority < 99 ? readerFIFOPriority : 99;
+    }
+    const int err = pthread_setschedparam(pthread_self(), policy, &param);
+    if( 0 != err ) {
+        WARN_PRINT("DBTProfile '%s': pthread_setschedparam %d, priority %d failed: %d, %s",
+                name.c_str(), policy, param.sched_priority, err, strerror(err));
+        return false;
+    }
+    return true;
+}
+
+std::string DBTProfile::toString() const {
+    return "Profile['"+name+"', mtu "+std::to_string(clientMTU)+
+           ", conn[scan "+std::to_string(le_scan_interval)+"/"+std::to_string(le_scan_window)+
+           ", interval "+std::to_string(conn_interval_min)+"-"+std::to_string(conn_interval_max)+
+           ", latency "+std::to_string(conn_latency)+", timeout "+std::to_string(supervision_timeout)+
+           "], timeout[read "+std::to_string(readTimeout)+", write "+std::to_string(writeTimeout)+", init "+std::to_string(initialTimeout)+
+           "], ring "+std::to_string(attPDURingCapacity)+", fifo "+std::to_string(readerFIFOPriority)+
+           ", dispatch "+( hasNotifyDispatch ? std::to_string(static_cast<int>(notifyDispatch)) : std::string("env") )+"]";
+}
@@ -0,0 +1,115 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+#include "DBTTrace.hpp"
+#include "DBTEnv.hpp"
+#include "BasicTypes.hpp"
+#include "MgmtTypes.hpp"
+#include "HCITypes.hpp"
+
+using namespace direct_bt;
+
+std::string direct_bt::getTraceSourceString(const TraceSource s) {
+    switch(s) {
+        case TraceSource::MGMT_CMD: return "MGMT_CMD";
+        case TraceSource::MGMT_EVT: return "MGMT_EVT";
+        case TraceSource::HCI_CMD: return "HCI_CMD";
+        case TraceSource::HCI_EVT: return "HCI_EVT";
+    }
+    return "Unknown TraceSource";
+}
+
+std::string TraceRecord::toString() const {
+    std::string op;
+    switch(source) {
+        case TraceSource::MGMT_CMD:
+            op = getMgmtOpcodeString(static_cast<MgmtOpcode>(opcode));
+            break;
+        case TraceSource::MGMT_EVT:
+            op = MgmtEvent::getOpcodeString(static_cast<MgmtEvent::Opcode>(opcode));
+            if( 0 != subcode ) {
+                op += " "+getMgmtOpcodeString(static_cast<MgmtOpcode>(subcode));
+            }
+            break;
+        case TraceSource::HCI_CMD:
+            op = getHCIOpcodeString(static_cast<HCIOpcode>(opcode));
+            break;
+        case TraceSource::HCI_EVT:
+            op = getHCIEventTypeString(static_cast<HCIEventType>(opcode));
+            if( 0 != subcode ) {
+                op += " "+getHCIMetaEventTypeString(static_cast<HCIMetaEventType>(subcode));
+            }
+            break;
+    }
+    return "["+std::to_string(timestamp)+" ms, "+getTraceSourceString(source)+", dev_id "+std::to_string(dev_id)+
+           ", "+uint16HexString(opcode)+" "+op+", size "+std::to_string(size)+"]";
+}
+
+DBTTrace::DBTTrace(const size_t capacity)
+: ring(capacity), writeCount(0)
+{ }
+
+DBTTrace& DBTTrace::get() {
+    /**
+     * Thread safe starting with C++11 6.7:
+     *
+     * If control enters the declaration concurrently while the variable is being initialized,
+     * the concurrent execution shall wait for completion of the initialization.
+     *
+     * (Magic Statics)
+     */
+    static DBTTrace t( DBTEnv::getInt32Property("direct_bt.trace.size", 1024, 0 /* min */, 1024*1024 /* max */) );
+    return t;
+}
+
+std::vector<TraceRecord> DBTTrace::getRecords() const {
+    std::vector<TraceRecord> res;
+    const uint64_t count = writeCount.load();
+    const size_t size = ring.size();
+    if( 0 == size ) {
+        return res;
+    }
+    const uint64_t first = count > size ? count - size : 0;
+    for(uint64_t i = first; i < count; i++) {
+        res.push_back( ring[ i % size ] );
+    }
+    return res;
+}
+
+void DBTTrace::dump(FILE *out) const {
+    const std::vector<TraceRecord> records = getRecords();
+    fprintf(out, "DBTTrace: %zd of %" PRIu64 " records, capacity %zd\n", records.size(), getWriteCount(), capacity());
+    for(size_t i=0; i<records.size(); i++) {
+        fprintf(out, "DBTTrace[%zd]: %s\n", i, records[i].toString().c_str());
+    }
+    fflush(out);
+}
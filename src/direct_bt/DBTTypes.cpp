@@ -109,3 +109,137 @@ BTMode direct_bt::getAdapterSettingsBTMode(const AdapterSetting settingMask) {
         return BTMode::NONE;
     }
 }
+
+std::string direct_bt::getKeepAliveModeString(const KeepAliveMode mode) {
+    switch(mode) {
+        case KeepAliveMode::GATT: return "GATT";
+        case KeepAliveMode::RSSI: return "RSSI";
+        case KeepAliveMode::LINK: return "LINK";
+    }
+    return "Unknown KeepAliveMode";
+}
+
+constexpr int8_t RSSIHistory::RSSI_NONE;
+
+void RSSIHistory::add(const uint64_t timestamp, const int8_t rssi) {
+    if( RSSI_NONE == rssi ) {
+        return;
+    }
+    if( 0 == count ) {
+        smoothed = rssi;
+    } else {
+        smoothed += ( static_cast<float>(rssi) - smoothed ) * static_cast<float>(weight) / 100.0f;
+    }
+    samples[next] = { timestamp, rssi };
+    next = ( next + 1 ) % CAPACITY;
+    if( CAPACITY > count ) {
+        ++count;
+    }
+}
+
+int8_t RSSIHistory::getSmoothed() const {
+    if( 0 == count ) {
+        return RSSI_NONE;
+    }
+    return static_cast<int8_t>( smoothed < 0 ? smoothed - 0.5f : smoothed + 0.5f );
+}
+
+std::vector<RSSIHistory::Sample> RSSIHistory::toVector() const {
+    std::vector<Sample> res;
+    res.reserve(count);
+    for(int i=0; i<count; ++i) {
+        res.push_back(get(i));
+    }
+    return res;
+}
+
+std::string RSSIHistory::toString() const {
+    return "RSSIHistory[size "+std::to_string(count)+", last "+std::to_string(getLast())+
+           ", smoothed "+std::to_string(getSmoothed())+", weight "+std::to_string(weight)+"%]";
+}
+
+void AdvIntervalEstimator::add(const uint64_t timestamp) {
+    if( 0 == lastTimestamp || timestamp < lastTimestamp ) {
+        lastTimestamp = timestamp;
+        return;
+    }
+    const uint64_t gap = timestamp - lastTimestamp;
+    if( MIN_INTERVAL_MS > gap ) {
+        // same advertising event, keep the event's first timestamp
+        return;
+    }
+    lastTimestamp = timestamp;
+    if( MAX_INTERVAL_MS + MAX_ADV_DELAY_MS < gap ) {
+        return;
+    }
+    gaps[next] = static_cast<uint32_t>(gap);
+    next = ( next + 1 ) % CAPACITY;
+    if( CAPACITY > count ) {
+        ++count;
+    }
+}
+
+uint32_t AdvIntervalEstimator::getInterval() const {
+    if( 0 == count ) {
+        return 0;
+    }
+    uint32_t res = UINT32_MAX;
+    for(int i=0; i<count; ++i) {
+        res = std::min(res, gaps[i]);
+    }
+    return res;
+}
+
+uint16_t AdvIntervalEstimator::getConnectScanWindow(const uint32_t advIntervalMS) {
+    if( 0 == advIntervalMS ) {
+        return 48;
+    }
+    // ceil( ms / 0.625 )
+    const uint32_t v = ( ( std::min<uint32_t>(advIntervalMS, MAX_INTERVAL_MS) + MAX_ADV_DELAY_MS ) * 8 + 4 ) / 5;
+    return static_cast<uint16_t>( std::max<uint32_t>(48, std::min<uint32_t>(0x4000, v)) );
+}
+
+std::string AdvIntervalEstimator::toString() const {
+    return "AdvIntervalEstimator[size "+std::to_string(count)+", interval "+std::to_string(getInterval())+"ms]";
+}
+
+int32_t ControllerCaps::getPipelineDepth(const int32_t configured) const {
+    if( 0 == le_acl_pkts ) {
+        return std::max<int32_t>(1, configured);
+    }
+    if( 0 >= configured ) {
+        return std::min<int32_t>(MAX_PIPELINE_DEPTH, le_acl_pkts);
+    }
+    return std::min<int32_t>(configured, le_acl_pkts);
+}
+
+int32_t ControllerCaps::getRingCapacity(const int32_t configured) const {
+    return std::max<int32_t>(configured, std::min<int32_t>(MAX_RING_CAPACITY, RING_BUFFER_FACTOR * le_acl_pkts));
+}
+
+int ControllerCaps::getMaxConcurrentConnections(const int requested) const {
+    const int res = std::max(1, requested);
+    return 0 == le_acl_pkts ? res : std::min<int>(res, le_acl_pkts);
+}
+
+uint16_t ControllerCaps::getDataLenTxOctets() const {
+    // valid range [27..251], BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.33
+    return 27 <= max_tx_octets && max_tx_octets <= 251 ? max_tx_octets : static_cast<uint16_t>(DEF_DATA_LEN_TX_OCTETS);
+}
+
+uint16_t ControllerCaps::getDataLenTxTime() const {
+    // valid range [328..17040], BT Core Spec v5.2: Vol 4, Part E HCI: 7.8.33
+    return 328 <= max_tx_time && max_tx_time <= 17040 ? max_tx_time : static_cast<uint16_t>(DEF_DATA_LEN_TX_TIME);
+}
+
+std::string ControllerCaps::toString() const {
+    if( !probed ) {
+        return "ControllerCaps[n/a]";
+    }
+    return "ControllerCaps[hci "+std::to_string(hci_version)+" (rev "+std::to_string(hci_revision)+
+           "), lmp "+std::to_string(lmp_version)+" (subver "+std::to_string(lmp_subversion)+"), manuf "+uint16HexString(manufacturer)+
+           ", le_features "+uint64HexString(le_features)+", le_acl[mtu "+std::to_string(le_acl_mtu)+", pkts "+std::to_string(le_acl_pkts)+
+           "], lists[white "+std::to_string(white_list_size)+", resolv "+std::to_string(resolv_list_size)+
+           "], max_data_len[tx "+std::to_string(max_tx_octets)+" / "+std::to_string(max_tx_time)+
+           "us, rx "+std::to_string(max_rx_octets)+" / "+std::to_string(max_rx_time)+"us]]";
+}
@@ -0,0 +1,225 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <exception>
+
+// #define VERBOSE_ON 1
+#include <dbt_debug.hpp>
+
+#include "DBTWorkflow.hpp"
+
+using namespace direct_bt;
+
+DBTExecutor::DBTExecutor(const int threadCount_, const DBTThreadOptions & threadOptions_)
+: threadCount(threadCount_), threadOptions(threadOptions_), workersRunning(0), running(true), executedCount(0)
+{ }
+
+std::shared_ptr<DBTExecutor> DBTExecutor::create(const int threadCount, const DBTThreadOptions & threadOptions) {
+    std::shared_ptr<DBTExecutor> e( new DBTExecutor(std::max(1, threadCount), threadOptions) );
+    const std::lock_guard<std::mutex> lock(e->mtx_jobs); // RAII-style acquire and relinquish via destructor
+    for(int i=0; i<e->threadCount; i++) {
+        // Each worker holds a reference until it has ended, hence the executor outlives its detached workers.
+        std::thread worker = std::thread([e]() { e->workerImpl(); });
+        e->workerIds.push_back(worker.get_id());
+        e->workersRunning++;
+        worker.detach();
+    }
+    return e;
+}
+
+std::shared_ptr<DBTExecutor> DBTExecutor::getShared() {
+    static std::shared_ptr<DBTExecutor> shared =
+            create(DBTEnv::getInt32Property("direct_bt.workflow.threads", 2, 1 /* min */, 64 /* max */),
+                   DBTThreadOptions("direct_bt.workflow", "dbt_workflow"));
+    return shared;
+}
+
+void DBTExecutor::workerImpl() {
+    threadOptions.applyToCurrentThread();
+    std::unique_lock<std::mutex> lock(mtx_jobs); // RAII-style acquire and relinquish via destructor
+    while( running ) {
+        if( jobs.empty() ) {
+            cv_jobs.wait(lock);
+            continue;
+        }
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        try {
+            job();
+        } catch (std::exception &e) {
+            ERR_PRINT("DBTExecutor::worker: Caught exception %s", e.what());
+        }
+        job = nullptr; // release captured references w/o lock
+        executedCount++;
+        lock.lock();
+    }
+    workersRunning--;
+    cv_jobs.notify_all();
+}
+
+bool DBTExecutor::post(std::function<void()> job) {
+    {
+        const std::lock_guard<std::mutex> lock(mtx_jobs); // RAII-style acquire and relinquish via destructor
+        if( !running ) {
+            return false;
+        }
+        jobs.push_back(std::move(job));
+    }
+    cv_jobs.notify_one();
+    return true;
+}
+
+void DBTExecutor::stop(const bool wait) {
+    std::deque<std::function<void()>> discarded;
+    std::unique_lock<std::mutex> lock(mtx_jobs); // RAII-style acquire and relinquish via destructor
+    running = false;
+    discarded.swap(jobs);
+    cv_jobs.notify_all();
+    if( wait && workerIds.end() == std::find(workerIds.begin(), workerIds.end(), std::this_thread::get_id()) ) {
+        while( 0 < workersRunning ) {
+            cv_jobs.wait(lock);
+        }
+    }
+    lock.unlock();
+    discarded.clear(); // release captured references w/o lock
+}
+
+bool DBTExecutor::isRunning() {
+    const std::lock_guard<std::mutex> lock(mtx_jobs); // RAII-style acquire and relinquish via destructor
+    return running;
+}
+
+int DBTExecutor::getQueueSize() {
+    const std::lock_guard<std::mutex> lock(mtx_jobs); // RAII-style acquire and relinquish via destructor
+    return static_cast<int>(jobs.size());
+}
+
+std::string DBTExecutor::toString() {
+    const std::lock_guard<std::mutex> lock(mtx_jobs); // RAII-style acquire and relinquish via destructor
+    return "DBTExecutor[running "+std::to_string(running)+", threads "+std::to_string(workersRunning)+"/"+std::to_string(threadCount)+
+           ", queue "+std::to_string(jobs.size())+", executed "+std::to_string(executedCount.load())+"]";
+}
+
+// *************************************************
+// *************************************************
+// *************************************************
+
+void DBTWorkflow::Continuation::resume() const {
+    workflow->proceed(step, true, "");
+}
+
+void DBTWorkflow::Continuation::fail(const std::string & cause) const {
+    workflow->proceed(step, false, cause);
+}
+
+DBTWorkflow::DBTWorkflow(std::shared_ptr<DBTExecutor> executor_)
+: executor(executor_), started(false), done(false), current(0)
+{ }
+
+std::shared_ptr<DBTWorkflow> DBTWorkflow::create(std::shared_ptr<DBTExecutor> executor) {
+    return std::shared_ptr<DBTWorkflow>( new DBTWorkflow(executor) );
+}
+
+DBTWorkflow & DBTWorkflow::then(Step step) {
+    if( !started ) {
+        steps.push_back(std::move(step));
+    }
+    return *this;
+}
+
+DBTWorkflow & DBTWorkflow::thenBlocking(BlockingStep step, const std::string & cause) {
+    return then([step, cause](const Continuation & next) {
+        if( step() ) {
+            next.resume();
+        } else {
+            next.fail(cause);
+        }
+    });
+}
+
+bool DBTWorkflow::start(Completion completion_) {
+    bool expStarted = false; // C++11, exp as value since C++20
+    if( !started.compare_exchange_strong(expStarted, true) ) {
+        return false;
+    }
+    completion = std::move(completion_);
+    std::shared_ptr<DBTWorkflow> self = shared_from_this();
+    if( steps.empty() ) {
+        return executor->post([self]() { self->complete(true, ""); });
+    }
+    return executor->post([self]() { self->run(0); });
+}
+
+void DBTWorkflow::run(const size_t step) {
+    const Continuation next(shared_from_this(), step);
+    try {
+        steps[step](next);
+    } catch (std::exception &e) {
+        next.fail(e.what());
+    }
+}
+
+void DBTWorkflow::proceed(const size_t step, const bool success, const std::string & cause) {
+    size_t expStep = step; // C++11, exp as value since C++20
+    if( !current.compare_exchange_strong(expStep, step + 1) ) {
+        DBG_PRINT("DBTWorkflow::proceed: Ignored stale continuation of step %zu, current %zu", step, expStep);
+        return;
+    }
+    std::shared_ptr<DBTWorkflow> self = shared_from_this();
+    const size_t nextStep = step + 1;
+    bool posted;
+    if( !success || steps.size() == nextStep ) {
+        posted = executor->post([self, success, cause]() { self->complete(success, cause); });
+    } else {
+        posted = executor->post([self, nextStep]() { self->run(nextStep); });
+    }
+    if( !posted ) {
+        complete(false, "executor stopped");
+    }
+}
+
+void DBTWorkflow::complete(const bool success, const std::string & cause) {
+    bool expDone = false; // C++11, exp as value since C++20
+    if( !done.compare_exchange_strong(expDone, true) ) {
+        return;
+    }
+    Completion c = std::move(completion);
+    completion = nullptr;
+    if( nullptr != c ) {
+        try {
+            c(success, cause);
+        } catch (std::exception &e) {
+            ERR_PRINT("DBTWorkflow::complete: Caught exception %s", e.what());
+        }
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+#include <algorithm>
+
+#include "DeviceSighting.hpp"
+#include "BasicTypes.hpp"
+
+using namespace direct_bt;
+
+constexpr size_t DeviceSightingTable::ENTRY_SIZE;
+
+std::string DeviceSighting::toString() const {
+    return "DeviceSighting["+address.toString()+", "+getBDAddressTypeString(addressType)+
+           ", count "+std::to_string(count)+", rssi "+std::to_string(rssi)+
+           ", ts["+std::to_string(ts_first)+".."+std::to_string(ts_last)+"], "+getEIRDataMaskString(eirMask)+"]";
+}
+
+DeviceSightingTable::DeviceSightingTable(const int32_t capacity_)
+: capacity( 0 < capacity_ ? static_cast<size_t>(capacity_) : 0 )
+{ }
+
+void DeviceSightingTable::trim() {
+    if( sightings.size() <= capacity ) {
+        return;
+    }
+    const size_t excess = std::max<size_t>( sightings.size() - capacity, capacity / 8 );
+    std::vector<std::pair<uint64_t, BDAddressKey>> lru;
+    lru.reserve(sightings.size());
+    for(auto it = sightings.begin(); it != sightings.end(); ++it) {
+        lru.push_back( std::make_pair(it->second.ts_last, it->first) );
+    }
+    const size_t n = std::min(excess, lru.size());
+    std::nth_element(lru.begin(), lru.begin() + ( n - 1 ), lru.end(),
+            [](const std::pair<uint64_t, BDAddressKey> & a, const std::pair<uint64_t, BDAddressKey> & b) {
+                return a.first < b.first;
+            });
+    for(size_t i=0; i<n; i++) {
+        sightings.erase(lru[i].second);
+    }
+}
+
+EIRDataType DeviceSightingTable::add(const EInfoReport & eir, bool & created) {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const BDAddressKey key(eir.getAddress(), eir.getAddressType());
+    auto it = sightings.find(key);
+    created = sightings.end() == it;
+    if( created ) {
+        DeviceSighting s;
+        s.ts_first = eir.getTimestamp();
+        s.eirMask = EIRDataType::NONE;
+        s.count = 0;
+        s.address = eir.getAddress();
+        s.addressType = eir.getAddressType();
+        s.tx_power = 0;
+        it = sightings.insert( std::make_pair(key, s) ).first;
+    }
+    DeviceSighting & s = it->second;
+    const EIRDataType mask = eir.getEIRDataMask();
+    const EIRDataType newData = mask & static_cast<EIRDataType>( ~static_cast<uint32_t>(s.eirMask) );
+    s.eirMask = s.eirMask | mask;
+    s.ts_last = eir.getTimestamp();
+    s.count++;
+    s.evtType = eir.getEvtType();
+    s.rssi = eir.getRSSI();
+    if( eir.isSet(EIRDataType::TX_POWER) ) {
+        s.tx_power = eir.getTxPower();
+    }
+    if( created ) {
+        trim(); // evicts the least recently seen sightings
+    }
+    return newData;
+}
+
+bool DeviceSightingTable::get(const EUI48 & address, const BDAddressType addressType, DeviceSighting & res) const {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    auto it = sightings.find(BDAddressKey(address, addressType));
+    if( sightings.end() == it ) {
+        return false;
+    }
+    res = it->second;
+    return true;
+}
+
+bool DeviceSightingTable::remove(const EUI48 & address, const BDAddressType addressType) {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return 0 < sightings.erase(BDAddressKey(address, addressType));
+}
+
+int DeviceSightingTable::evictExpired(const uint64_t ts_now, const int32_t ttl, const int32_t nrpaTTL) {
+    if( 0 >= ttl && 0 >= nrpaTTL ) {
+        return 0;
+    }
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    int count = 0;
+    for(auto it = sightings.begin(); it != sightings.end(); ) {
+        const DeviceSighting & s = it->second;
+        const bool nrpa = BLERandomAddressType::UNRESOLVABLE_PRIVAT == s.address.getBLERandomAddressType(s.addressType);
+        const int32_t t = ( nrpa && 0 < nrpaTTL ) ? nrpaTTL : ttl;
+        if( 0 < t && ts_now > s.ts_last && ts_now - s.ts_last > static_cast<uint64_t>(t) ) {
+            it = sightings.erase(it);
+            count++;
+        } else {
+            ++it;
+        }
+    }
+    return count;
+}
+
+void DeviceSightingTable::clear() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    sightings.clear();
+}
+
+size_t DeviceSightingTable::size() const {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return sightings.size();
+}
+
+size_t DeviceSightingTable::getMemoryFootprint() const {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return sightings.size() * ENTRY_SIZE + sightings.bucket_count() * sizeof(void*);
+}
+
+std::vector<DeviceSighting> DeviceSightingTable::getSightings() const {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    std::vector<DeviceSighting> res;
+    res.reserve(sightings.size());
+    for(auto it = sightings.begin(); it != sightings.end(); ++it) {
+        res.push_back(it->second);
+    }
+    return res;
+}
+
+std::string DeviceSightingTable::toString() const {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return "DeviceSightingTable[size "+std::to_string(sightings.size())+", capacity "+std::to_string(capacity)+"]";
+}
@@ -0,0 +1,205 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include  <algorithm>
+
+#include "DeviceUpdateCoalescer.hpp"
+#include "DBTAdapter.hpp"
+#include "DBTDevice.hpp"
+#include "DBTEnv.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+const DeviceUpdatePolicy & DeviceUpdatePolicy::getDefault() {
+    static const DeviceUpdatePolicy policy(
+        static_cast<uint32_t>( DBTEnv::getInt32Property("direct_bt.adapter.updates.interval", 0, 0 /* min */, INT32_MAX /* max */) ),
+        static_cast<EIRDataType>( DBTEnv::getInt32Property("direct_bt.adapter.updates.immediate",
+                static_cast<int32_t>( EIRDataType::NAME | EIRDataType::NAME_SHORT | EIRDataType::MANUF_DATA |
+                                      EIRDataType::SERVICE_UUID | EIRDataType::APPEARANCE ), 0 /* min */, INT32_MAX /* max */) ) );
+    return policy;
+}
+
+std::string DeviceUpdatePolicy::toString() const {
+    return "DeviceUpdatePolicy[interval "+std::to_string(minIntervalMS)+" ms, immediate "+getEIRDataMaskString(immediateMask)+"]";
+}
+
+DeviceUpdateCoalescer::~DeviceUpdateCoalescer() {
+    stop();
+}
+
+void DeviceUpdateCoalescer::deliver(const std::shared_ptr<AdapterStatusListener> & l, const std::shared_ptr<DBTDevice> & device,
+                                    const EIRDataType updateMask, const uint64_t timestamp) {
+    try {
+        l->deviceUpdated(device, updateMask, timestamp);
+    } catch (std::exception &e) {
+        ERR_PRINT("DeviceUpdateCoalescer::deliver: %s of %s: Caught exception %s",
+                l->toString().c_str(), device->toString().c_str(), e.what());
+    }
+}
+
+void DeviceUpdateCoalescer::update(const std::shared_ptr<AdapterStatusListener> & l, const DeviceUpdatePolicy & policy,
+                                   const std::shared_ptr<DBTDevice> & device, const EIRDataType updateMask, const uint64_t timestamp) {
+    if( !policy.isCoalescing() ) {
+        deliver(l, device, updateMask, timestamp);
+        return;
+    }
+    const uint64_t now = getCurrentMilliseconds();
+    EIRDataType sendMask = EIRDataType::NONE;
+    {
+        State & s = *state;
+        const std::lock_guard<std::mutex> lock(s.mtx_entries); // RAII-style acquire and relinquish via destructor
+        if( s.stopped ) {
+            return;
+        }
+        const key_t key(l.get(), device.get());
+        auto it = s.entries.find(key);
+        if( s.entries.end() == it || it->second.device.expired() ) {
+            // new pair or a stale entry of a destroyed device at the same address
+            const Entry e { l, device, policy.minIntervalMS, EIRDataType::NONE, 0, 0 };
+            if( s.entries.end() == it ) {
+                it = s.entries.insert( std::make_pair(key, e) ).first;
+            } else {
+                it->second = e;
+            }
+        }
+        Entry & e = it->second;
+        e.minIntervalMS = policy.minIntervalMS;
+        const EIRDataType merged = e.pendingMask | updateMask;
+        if( EIRDataType::NONE != ( updateMask & policy.immediateMask ) || now - e.ts_last_sent >= e.minIntervalMS ) {
+            sendMask = merged;
+            e.pendingMask = EIRDataType::NONE;
+            e.ts_last_sent = now;
+        } else {
+            const bool wasIdle = EIRDataType::NONE == e.pendingMask;
+            e.pendingMask = merged;
+            e.pendingTimestamp = timestamp;
+            if( !s.running ) {
+                s.running = true;
+                timerThread = std::thread(&DeviceUpdateCoalescer::timerImpl, state);
+            } else if( wasIdle ) {
+                s.cv_entries.notify_all();
+            }
+        }
+    }
+    if( EIRDataType::NONE != sendMask ) {
+        deliver(l, device, sendMask, timestamp);
+    }
+}
+
+void DeviceUpdateCoalescer::timerImpl(const std::shared_ptr<State> s) {
+    struct Job {
+        std::shared_ptr<AdapterStatusListener> listener;
+        std::shared_ptr<DBTDevice> device;
+        EIRDataType updateMask;
+        uint64_t timestamp;
+    };
+    std::unique_lock<std::mutex> lock(s->mtx_entries); // RAII-style acquire and relinquish via destructor
+    while( s->running ) {
+        const uint64_t now = getCurrentMilliseconds();
+        uint64_t next = UINT64_MAX;
+        std::vector<Job> jobs;
+        for(auto it = s->entries.begin(); it != s->entries.end(); ) {
+            Entry & e = it->second;
+            const uint64_t deadline = e.ts_last_sent + e.minIntervalMS;
+            if( deadline > now ) {
+                next = std::min(next, deadline); // pending delivery or idle cleanup
+                ++it;
+            } else if( EIRDataType::NONE != e.pendingMask ) {
+                std::shared_ptr<DBTDevice> device = e.device.lock();
+                if( nullptr != device ) {
+                    jobs.push_back( Job { e.listener, device, e.pendingMask, e.pendingTimestamp } );
+                }
+                e.pendingMask = EIRDataType::NONE;
+                e.ts_last_sent = now;
+                next = std::min(next, now + e.minIntervalMS);
+                ++it;
+            } else {
+                it = s->entries.erase(it); // idle for at least its interval
+            }
+        }
+        if( jobs.size() > 0 ) {
+            lock.unlock();
+            for(auto it = jobs.begin(); it != jobs.end(); ++it) {
+                deliver(it->listener, it->device, it->updateMask, it->timestamp);
+            }
+            jobs.clear(); // release references while unlocked
+            lock.lock();
+            continue;
+        }
+        if( UINT64_MAX == next ) {
+            s->cv_entries.wait(lock);
+        } else {
+            s->cv_entries.wait_for(lock, std::chrono::milliseconds(next - now));
+        }
+    }
+}
+
+void DeviceUpdateCoalescer::removeListener(const AdapterStatusListener * l) {
+    const std::lock_guard<std::mutex> lock(state->mtx_entries); // RAII-style acquire and relinquish via destructor
+    for(auto it = state->entries.begin(); it != state->entries.end(); ) {
+        if( it->first.first == l || *it->second.listener == *l ) {
+            it = state->entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DeviceUpdateCoalescer::clear() {
+    const std::lock_guard<std::mutex> lock(state->mtx_entries); // RAII-style acquire and relinquish via destructor
+    state->entries.clear();
+}
+
+void DeviceUpdateCoalescer::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(state->mtx_entries); // RAII-style acquire and relinquish via destructor
+        state->stopped = true;
+        state->running = false;
+        state->entries.clear();
+        state->cv_entries.notify_all();
+    }
+    if( timerThread.joinable() ) {
+        if( timerThread.get_id() == std::this_thread::get_id() ) {
+            // stopped from a callback: the timer thread holds the shared state and ends after the callback has returned
+            timerThread.detach();
+        } else {
+            timerThread.join();
+        }
+    }
+}
+
+size_t DeviceUpdateCoalescer::size() {
+    const std::lock_guard<std::mutex> lock(state->mtx_entries); // RAII-style acquire and relinquish via destructor
+    return state->entries.size();
+}
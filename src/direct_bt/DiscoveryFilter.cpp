@@ -0,0 +1,166 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+#include "DiscoveryFilter.hpp"
+#include "DBTDevice.hpp"
+
+using namespace direct_bt;
+
+constexpr int8_t DiscoveryFilter::RSSI_NONE;
+
+bool DiscoveryFilter::isAddressOnly() const {
+    if( addresses.empty() || !addressTypes.empty() || !services.empty() ||
+        !companies.empty() || !namePrefixes.empty() || RSSI_NONE != minRSSI )
+    {
+        return false;
+    }
+    for(auto it = addresses.begin(); it != addresses.end(); ++it) {
+        if( BDAddressType::BDADDR_LE_PUBLIC != it->addressType && BDAddressType::BDADDR_LE_RANDOM != it->addressType ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DiscoveryFilter::match(const EInfoReport & eir) const {
+    // cheap criteria first, keeping lazy EIR data unparsed if rejected
+    if( RSSI_NONE != minRSSI && ( !eir.isSet(EIRDataType::RSSI) || eir.getRSSI() < minRSSI ) ) {
+        return false;
+    }
+    if( !addressTypes.empty() &&
+        addressTypes.end() == std::find(addressTypes.begin(), addressTypes.end(), eir.getAddressType()) )
+    {
+        return false;
+    }
+    if( !addresses.empty() &&
+        addresses.end() == addresses.find(BDAddressKey(eir.getAddress(), eir.getAddressType())) &&
+        addresses.end() == addresses.find(BDAddressKey(eir.getAddress(), BDAddressType::BDADDR_UNDEFINED)) )
+    {
+        return false;
+    }
+    if( !companies.empty() ) {
+        if( !eir.isSet(EIRDataType::MANUF_DATA) ) {
+            return false;
+        }
+        std::shared_ptr<ManufactureSpecificData> msd = eir.getManufactureSpecificData();
+        if( nullptr == msd || companies.end() == std::find(companies.begin(), companies.end(), msd->company) ) {
+            return false;
+        }
+    }
+    if( !services.empty() ) {
+        // EIRDataType::SERVICE_UUID isn't flagged by EInfoReport, hence query the list
+        const std::vector<uuid_value_t> & eirServices = eir.getServices();
+        if( eirServices.end() == std::find_first_of(eirServices.begin(), eirServices.end(), services.begin(), services.end()) ) {
+            return false;
+        }
+    }
+    if( !namePrefixes.empty() ) {
+        const bool hasName = eir.isSet(EIRDataType::NAME);
+        const bool hasShortName = eir.isSet(EIRDataType::NAME_SHORT);
+        if( !hasName && !hasShortName ) {
+            return false;
+        }
+        bool found = false;
+        for(auto it = namePrefixes.begin(); !found && it != namePrefixes.end(); ++it) {
+            found = ( hasName && hasPrefix(eir.getName(), *it) ) || ( hasShortName && hasPrefix(eir.getShortName(), *it) );
+        }
+        if( !found ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DiscoveryFilter::match(const DBTDevice & device) const {
+    std::shared_ptr<const DBTDevice::AdvertisedData> ad = device.getAdvertisedData();
+    if( RSSI_NONE != minRSSI && ( 127 == ad->rssi || ad->rssi < minRSSI ) ) {
+        return false;
+    }
+    if( !addressTypes.empty() &&
+        addressTypes.end() == std::find(addressTypes.begin(), addressTypes.end(), device.getAddressType()) )
+    {
+        return false;
+    }
+    if( !addresses.empty() &&
+        addresses.end() == addresses.find(BDAddressKey(device.getAddress(), device.getAddressType())) &&
+        addresses.end() == addresses.find(BDAddressKey(device.getAddress(), BDAddressType::BDADDR_UNDEFINED)) )
+    {
+        return false;
+    }
+    if( !companies.empty() &&
+        ( nullptr == ad->msd || companies.end() == std::find(companies.begin(), companies.end(), ad->msd->company) ) )
+    {
+        return false;
+    }
+    if( !services.empty() &&
+        ad->services.end() == std::find_first_of(ad->services.begin(), ad->services.end(), services.begin(), services.end()) )
+    {
+        return false;
+    }
+    if( !namePrefixes.empty() ) {
+        bool found = false;
+        for(auto it = namePrefixes.begin(); !found && it != namePrefixes.end(); ++it) {
+            found = hasPrefix(*ad->name, *it);
+        }
+        if( !found ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string DiscoveryFilter::toString() const {
+    std::string out("DiscoveryFilter[");
+    if( isEmpty() ) {
+        return out.append("none]");
+    }
+    out.append("addresses[");
+    for(auto it = addresses.begin(); it != addresses.end(); ++it) {
+        out.append(it->address.toString()).append(" ").append(getBDAddressTypeString(it->addressType)).append(", ");
+    }
+    out.append("], types[");
+    for(auto it = addressTypes.begin(); it != addressTypes.end(); ++it) {
+        out.append(getBDAddressTypeString(*it)).append(", ");
+    }
+    out.append("], services[");
+    for(auto it = services.begin(); it != services.end(); ++it) {
+        out.append(it->toString()).append(", ");
+    }
+    out.append("], companies[");
+    for(auto it = companies.begin(); it != companies.end(); ++it) {
+        out.append(uint16HexString(*it, true)).append(", ");
+    }
+    out.append("], names[");
+    for(auto it = namePrefixes.begin(); it != namePrefixes.end(); ++it) {
+        out.append("'").append(*it).append("', ");
+    }
+    out.append("], rssi ").append(RSSI_NONE != minRSSI ? std::to_string(minRSSI) : "none").append("]");
+    return out;
+}
@@ -0,0 +1,137 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include  <algorithm>
+
+#include "GATTAttributeTable.hpp"
+#include "GATTNumbers.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+GATTServiceRef GATTAttributeTable::Attribute::getService() const {
+    if( !isValid() || Kind::SERVICE != getKind() ) {
+        return nullptr;
+    }
+    return std::static_pointer_cast<GATTService>(table->objects[index]);
+}
+
+GATTCharacteristicRef GATTAttributeTable::Attribute::getCharacteristic() const {
+    if( !isValid() || Kind::CHARACTERISTIC != getKind() ) {
+        return nullptr;
+    }
+    return std::static_pointer_cast<GATTCharacteristic>(table->objects[index]);
+}
+
+GATTDescriptorRef GATTAttributeTable::Attribute::getDescriptor() const {
+    if( !isValid() || Kind::DESCRIPTOR != getKind() ) {
+        return nullptr;
+    }
+    return std::static_pointer_cast<GATTDescriptor>(table->objects[index]);
+}
+
+GATTAttributeTable::GATTAttributeTable(const std::vector<GATTServiceRef> & services)
+: serviceChangedHandle(0), handleOrdered(true)
+{
+    int count = 0;
+    for(const GATTServiceRef & s : services) {
+        count++;
+        for(const GATTCharacteristicRef & c : s->characteristicList) {
+            count += 1 + c->descriptorList.size();
+        }
+    }
+    entries.reserve(count);
+    objects.reserve(count);
+
+    const uuid16_t serviceChanged(GattCharacteristicType::SERVICE_CHANGED);
+    for(const GATTServiceRef & s : services) {
+        const int32_t si = static_cast<int32_t>(entries.size());
+        entries.push_back( Entry { uuid_value_t(*s->type), s->startHandle, s->endHandle, -1, Kind::SERVICE, static_cast<uint8_t>(s->isPrimary ? 1 : 0) } );
+        objects.push_back(s);
+        for(const GATTCharacteristicRef & c : s->characteristicList) {
+            const int32_t ci = static_cast<int32_t>(entries.size());
+            entries.push_back( Entry { uuid_value_t(*c->value_type), c->handle, c->value_handle, si, Kind::CHARACTERISTIC, static_cast<uint8_t>(c->properties) } );
+            objects.push_back(c);
+            valueHandleIndex.push_back(ci);
+            if( serviceChanged == *c->value_type ) {
+                serviceChangedHandle = c->value_handle;
+            }
+            for(const GATTDescriptorRef & d : c->descriptorList) {
+                entries.push_back( Entry { uuid_value_t(*d->type), d->handle, d->handle, ci, Kind::DESCRIPTOR, 0 } );
+                objects.push_back(d);
+            }
+        }
+    }
+    handleOrdered = std::is_sorted(entries.begin(), entries.end(),
+            [](const Entry & a, const Entry & b) { return a.handle < b.handle; });
+    std::sort(valueHandleIndex.begin(), valueHandleIndex.end(),
+            [&](const int32_t a, const int32_t b) { return entries[a].aux_handle < entries[b].aux_handle; });
+}
+
+GATTAttributeTable::Attribute GATTAttributeTable::findByHandle(const uint16_t handle) const noexcept {
+    if( handleOrdered ) {
+        auto it = std::lower_bound(entries.begin(), entries.end(), handle,
+                [](const Entry & e, const uint16_t h) { return e.handle < h; });
+        if( it != entries.end() && it->handle == handle ) {
+            return Attribute(this, static_cast<int>(it - entries.begin()));
+        }
+        return Attribute(this, -1);
+    }
+    for(size_t i=0; i<entries.size(); i++) {
+        if( entries[i].handle == handle ) {
+            return Attribute(this, static_cast<int>(i));
+        }
+    }
+    return Attribute(this, -1);
+}
+
+GATTAttributeTable::Attribute GATTAttributeTable::findCharacteristicByValueHandle(const uint16_t valueHandle) const noexcept {
+    auto it = std::lower_bound(valueHandleIndex.begin(), valueHandleIndex.end(), valueHandle,
+            [&](const int32_t i, const uint16_t h) { return entries[i].aux_handle < h; });
+    if( it != valueHandleIndex.end() && entries[*it].aux_handle == valueHandle ) {
+        return Attribute(this, *it);
+    }
+    return Attribute(this, -1);
+}
+
+std::string GATTAttributeTable::toString() const {
+    static const char * kinds[] = { "srv", "chr", "dsc" };
+    std::string res = "GATTAttributeTable[entries "+std::to_string(entries.size())+", entry size "+std::to_string(sizeof(Entry))+"\n";
+    for(size_t i=0; i<entries.size(); i++) {
+        const Entry & e = entries[i];
+        res += "  ["+std::to_string(i)+"] "+kinds[static_cast<int>(e.kind)]+" "+uint16HexString(e.handle, true)+
+               " aux "+uint16HexString(e.aux_handle, true)+", parent "+std::to_string(e.parent)+
+               ", props "+uint8HexString(e.properties, true)+", uuid "+e.uuid.toString()+"\n";
+    }
+    return res+"]";
+}
@@ -0,0 +1,320 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include  <algorithm>
+
+#include "GATTCache.hpp"
+#include "GATTNumbers.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+namespace {
+
+    /** Appends to a POctets record, growing its capacity as required. */
+    class RecordWriter {
+        private:
+            POctets & out;
+
+            int grow(const int n) {
+                const int i = out.getSize();
+                if( out.getCapacity() < i + n ) {
+                    out.recapacity( std::max(2 * out.getCapacity(), i + n) );
+                }
+                out.resize(i + n);
+                return i;
+            }
+
+        public:
+            RecordWriter(POctets & out_) : out(out_) {}
+
+            void put_uint8(const uint8_t v) { out.put_uint8(grow(1), v); }
+            void put_uint16(const uint16_t v) { out.put_uint16(grow(2), v); }
+            void put_octets(const uint8_t * v, const int size) {
+                if( 0 < size ) {
+                    memcpy(out.get_wptr() + grow(size), v, size);
+                }
+            }
+            void put_uuid(const uuid_t & v) {
+                put_uint8(v.getTypeSize());
+                out.put_uuid(grow(v.getTypeSize()), v);
+            }
+    };
+
+    /** Reads a serialized record, throwing an IndexOutOfBoundsException if exhausted. */
+    class RecordReader {
+        private:
+            const TROOctets & in;
+            int offset;
+
+        public:
+            RecordReader(const TROOctets & in_) : in(in_), offset(0) {}
+
+            uint8_t get_uint8() { const uint8_t v = in.get_uint8(offset); offset += 1; return v; }
+            uint16_t get_uint16() { const uint16_t v = in.get_uint16(offset); offset += 2; return v; }
+            const uint8_t * get_octets(const int size) {
+                in.check_range(offset, size);
+                const uint8_t * v = in.get_ptr() + offset;
+                offset += size;
+                return v;
+            }
+            std::shared_ptr<const uuid_t> get_uuid() {
+                const uuid_t::TypeSize tsize = static_cast<uuid_t::TypeSize>(get_uint8());
+                std::shared_ptr<const uuid_t> v = in.get_uuid(offset, tsize);
+                offset += tsize;
+                return v;
+            }
+    };
+
+    bool hasServiceChanged(const std::vector<GATTServiceRef> & services) {
+        const uuid16_t serviceChanged(GattCharacteristicType::SERVICE_CHANGED);
+        for(const GATTServiceRef & s : services) {
+            for(const GATTCharacteristicRef & c : s->characteristicList) {
+                if( serviceChanged == *c->value_type ) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+GATTCache::GATTCache(const std::string & directory_)
+: directory(directory_)
+{ }
+
+std::string GATTCache::getFilename(const EUI48 & address) const {
+    std::string name = address.toString();
+    name.erase(std::remove(name.begin(), name.end(), ':'), name.end());
+    return directory+"/"+name+".gatt";
+}
+
+std::shared_ptr<const POctets> GATTCache::serialize(const TROOctets & dbHash, const std::vector<GATTServiceRef> & services) {
+    std::shared_ptr<POctets> record(new POctets(1024, 0));
+    RecordWriter w(*record);
+    w.put_uint8('D'); w.put_uint8('B'); w.put_uint8('T'); w.put_uint8('G');
+    w.put_uint8(RECORD_VERSION);
+    w.put_uint8(dbHash.getSize());
+    w.put_octets(dbHash.get_ptr(), dbHash.getSize());
+    w.put_uint16(services.size());
+    for(const GATTServiceRef & s : services) {
+        w.put_uint8(s->isPrimary);
+        w.put_uint16(s->startHandle);
+        w.put_uint16(s->endHandle);
+        w.put_uuid(*s->type);
+        w.put_uint16(s->characteristicList.size());
+        for(const GATTCharacteristicRef & c : s->characteristicList) {
+            w.put_uint16(c->handle);
+            w.put_uint8(c->properties);
+            w.put_uint16(c->value_handle);
+            w.put_uuid(*c->value_type);
+            w.put_uint16(c->descriptorList.size());
+            for(const GATTDescriptorRef & d : c->descriptorList) {
+                w.put_uint16(d->handle);
+                w.put_uuid(*d->type);
+                w.put_uint16(d->value.getSize());
+                w.put_octets(d->value.get_ptr(), d->value.getSize());
+            }
+        }
+    }
+    return record;
+}
+
+bool GATTCache::deserialize(const TROOctets & record, const std::shared_ptr<DBTDevice> & device,
+                            POctets & dbHash, std::vector<GATTServiceRef> & services)
+{
+    try {
+        RecordReader r(record);
+        if( 'D' != r.get_uint8() || 'B' != r.get_uint8() || 'T' != r.get_uint8() || 'G' != r.get_uint8() ||
+            RECORD_VERSION != r.get_uint8() )
+        {
+            return false;
+        }
+        const int hashSize = r.get_uint8();
+        dbHash.resize(0);
+        dbHash += TROOctets(r.get_octets(hashSize), hashSize);
+
+        std::vector<GATTServiceRef> result;
+        const int serviceCount = r.get_uint16();
+        for(int i=0; i<serviceCount; i++) {
+            const bool isPrimary = 0 != r.get_uint8();
+            const uint16_t startHandle = r.get_uint16();
+            const uint16_t endHandle = r.get_uint16();
+            std::shared_ptr<const uuid_t> type = r.get_uuid();
+            GATTServiceRef s( new GATTService(device, isPrimary, startHandle, endHandle, type) );
+
+            const int charCount = r.get_uint16();
+            for(int j=0; j<charCount; j++) {
+                const uint16_t handle = r.get_uint16();
+                const GATTCharacteristic::PropertyBitVal properties = static_cast<GATTCharacteristic::PropertyBitVal>(r.get_uint8());
+                const uint16_t valueHandle = r.get_uint16();
+                std::shared_ptr<const uuid_t> valueType = r.get_uuid();
+                GATTCharacteristicRef c( new GATTCharacteristic(s, startHandle, handle, properties, valueHandle, valueType) );
+
+                const int descCount = r.get_uint16();
+                for(int k=0; k<descCount; k++) {
+                    const uint16_t descHandle = r.get_uint16();
+                    std::shared_ptr<const uuid_t> descType = r.get_uuid();
+                    GATTDescriptorRef d( new GATTDescriptor(c, descType, descHandle) );
+                    const int valueSize = r.get_uint16();
+                    d->value += TROOctets(r.get_octets(valueSize), valueSize);
+                    if( d->isClientCharacteristicConfiguration() ) {
+                        c->clientCharacteristicsConfigIndex = c->descriptorList.size();
+                    }
+                    c->descriptorList.push_back(d);
+                }
+                s->characteristicList.push_back(c);
+            }
+            result.push_back(s);
+        }
+        services = result;
+        return true;
+    } catch (std::exception &e) {
+        WARN_PRINT("GATTCache::deserialize: Corrupt record: %s", e.what());
+    }
+    return false;
+}
+
+std::shared_ptr<const POctets> GATTCache::readRecord(const EUI48 & address) {
+    if( 0 == directory.size() ) {
+        return nullptr;
+    }
+    const std::string fname = getFilename(address);
+    FILE * f = fopen(fname.c_str(), "rb");
+    if( nullptr == f ) {
+        return nullptr;
+    }
+    std::shared_ptr<POctets> record = nullptr;
+    if( 0 == fseek(f, 0, SEEK_END) ) {
+        const long size = ftell(f);
+        if( 0 < size && size <= UINT16_MAX * 16 && 0 == fseek(f, 0, SEEK_SET) ) {
+            record = std::shared_ptr<POctets>(new POctets(size));
+            if( static_cast<size_t>(size) != fread(record->get_wptr(), 1, size, f) ) {
+                record = nullptr;
+            }
+        }
+    }
+    fclose(f);
+    if( nullptr == record ) {
+        WARN_PRINT("GATTCache::readRecord: Failed to read %s", fname.c_str());
+    }
+    return record;
+}
+
+bool GATTCache::writeRecord(const EUI48 & address, const POctets & record) {
+    if( 0 == directory.size() ) {
+        return false;
+    }
+    const std::string fname = getFilename(address);
+    const std::string fname_tmp = fname+".tmp";
+    FILE * f = fopen(fname_tmp.c_str(), "wb");
+    if( nullptr == f ) {
+        WARN_PRINT("GATTCache::writeRecord: Failed to create %s", fname_tmp.c_str());
+        return false;
+    }
+    const bool written = static_cast<size_t>(record.getSize()) == fwrite(record.get_ptr(), 1, record.getSize(), f);
+    if( 0 != fclose(f) || !written || 0 != rename(fname_tmp.c_str(), fname.c_str()) ) {
+        WARN_PRINT("GATTCache::writeRecord: Failed to write %s", fname.c_str());
+        remove(fname_tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void GATTCache::put(const EUI48 & address, const TROOctets & dbHash, const std::vector<GATTServiceRef> & services) {
+    std::shared_ptr<const POctets> record = serialize(dbHash, services);
+    {
+        const std::lock_guard<std::mutex> lock(mtx_records); // RAII-style acquire and relinquish via destructor
+        records[address] = record;
+    }
+    writeRecord(address, *record);
+    DBG_PRINT("GATTCache::put: %s, dbHash %d, %zd services, record size %d",
+            address.toString().c_str(), dbHash.getSize(), services.size(), record->getSize());
+}
+
+bool GATTCache::get(const EUI48 & address, const TROOctets * dbHash, const std::shared_ptr<DBTDevice> & device,
+                    std::vector<GATTServiceRef> & services)
+{
+    std::shared_ptr<const POctets> record = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_records); // RAII-style acquire and relinquish via destructor
+        auto it = records.find(address);
+        if( records.end() != it ) {
+            record = it->second;
+        }
+    }
+    if( nullptr == record ) {
+        record = readRecord(address);
+        if( nullptr == record ) {
+            return false;
+        }
+        const std::lock_guard<std::mutex> lock(mtx_records); // RAII-style acquire and relinquish via destructor
+        records[address] = record;
+    }
+    POctets storedHash(DB_HASH_SIZE, 0);
+    std::vector<GATTServiceRef> restored;
+    if( !deserialize(*record, device, storedHash, restored) ) {
+        invalidate(address);
+        return false;
+    }
+    bool valid;
+    if( nullptr != dbHash ) {
+        valid = storedHash.getSize() == dbHash->getSize() &&
+                0 == memcmp(storedHash.get_ptr(), dbHash->get_ptr(), storedHash.getSize());
+    } else {
+        valid = 0 == storedHash.getSize() && hasServiceChanged(restored);
+    }
+    if( !valid ) {
+        DBG_PRINT("GATTCache::get: Stale entry: %s, dbHash %d", address.toString().c_str(), nullptr != dbHash);
+        invalidate(address);
+        return false;
+    }
+    services = restored;
+    DBG_PRINT("GATTCache::get: %s, dbHash %d, %zd services", address.toString().c_str(), nullptr != dbHash, services.size());
+    return true;
+}
+
+void GATTCache::invalidate(const EUI48 & address) {
+    {
+        const std::lock_guard<std::mutex> lock(mtx_records); // RAII-style acquire and relinquish via destructor
+        records.erase(address);
+    }
+    if( 0 < directory.size() ) {
+        remove(getFilename(address).c_str());
+    }
+}
+
+void GATTCache::clear() {
+    const std::lock_guard<std::mutex> lock(mtx_records); // RAII-style acquire and relinquish via destructor
+    records.clear();
+}
@@ -132,7 +132,7 @@ std::string GATTCharacteristic::toString() const {
     }
     desc_str += " ]";
     return "handle "+uint16HexString(handle)+", props "+uint8HexString(properties)+" "+getPropertiesString()+
-           ", value[type 0x"+value_type->toString()+", handle "+uint16HexString(value_handle)+char_name+desc_str+
+           ", value[type 0x"+getValueTypeString(false)+", handle "+uint16HexString(value_handle)+char_name+desc_str+
            "], service[type 0x"+service_uuid_str+
            ", handle[ "+uint16HexString(service_handle)+".."+uint16HexString(service_handle_end)+" ]"+
            service_name+", enabled[notify "+std::to_string(enabledNotifyState)+", indicate "+std::to_string(enabledIndicateState)+"] ]";
@@ -209,6 +209,18 @@ bool GATTCharacteristic::configNotificationIndication(const bool enableNotificat
     }
 
     GATTDescriptorRef cccd = this->getClientCharacteristicConfig();
+    if( nullptr == cccd && 0 == descriptorList.size() ) {
+        // descriptors not discovered: locate the CCCD on demand
+        std::shared_ptr<GATTService> service = getServiceUnchecked();
+        if( nullptr != service ) {
+            for(auto it = service->characteristicList.begin(); it != service->characteristicList.end(); it++) {
+                if( it->get() == this ) {
+                    cccd = gatt->findClientCharacteristicConfig(*it);
+                    break;
+                }
+            }
+        }
+    }
     if( nullptr == cccd ) {
         DBG_PRINT("Characteristic has no ClientCharacteristicConfig descriptor: %s", toString().c_str());
         return false;
@@ -272,6 +284,24 @@ bool GATTCharacteristic::readValue(POctets & res, int expectedLength) {
     }
     return gatt->readCharacteristicValue(*this, res, expectedLength);
 }
+
+static std::shared_ptr<GATTHandler> getGATTHandlerUnchecked(const GATTCharacteristic & c) {
+    std::shared_ptr<DBTDevice> device = c.getDeviceUnchecked();
+    return nullptr != device ? device->getGATTHandler() : nullptr;
+}
+
+GATTStatus GATTCharacteristic::readValueStatus(POctets & res, int expectedLength) noexcept {
+    std::shared_ptr<GATTHandler> gatt = getGATTHandlerUnchecked(*this);
+    if( nullptr == gatt ) {
+        return GATTStatus::INVALID_STATE;
+    }
+    return gatt->readCharacteristicValueStatus(*this, res, expectedLength);
+}
+
+bool GATTCharacteristic::readValueInto(POctets & buf, int expectedLength) {
+    buf.resize(0); // keep capacity
+    return readValue(buf, expectedLength);
+}
 /**
  * BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.3 Write Characteristic Value
  */
@@ -295,3 +325,28 @@ bool GATTCharacteristic::writeValueNoResp(const TROOctets & value) {
     }
     return gatt->writeCharacteristicValueNoResp(*this, value);
 }
+
+bool GATTCharacteristic::writeValue(const int valueSize, const ValueFill & fill, const bool withResponse) {
+    std::shared_ptr<DBTDevice> device = getDeviceChecked();
+    std::shared_ptr<GATTHandler> gatt = device->getGATTHandler();
+    if( nullptr == gatt ) {
+        throw IllegalStateException("Characteristic's device GATTHandle not connected: "+toSafeString(), E_FILE_LINE);
+    }
+    return gatt->writeCharacteristicValue(*this, valueSize, fill, withResponse);
+}
+
+GATTStatus GATTCharacteristic::writeValueStatus(const TROOctets & value, const bool withResponse) noexcept {
+    std::shared_ptr<GATTHandler> gatt = getGATTHandlerUnchecked(*this);
+    if( nullptr == gatt ) {
+        return GATTStatus::INVALID_STATE;
+    }
+    return gatt->writeCharacteristicValueStatus(*this, value, withResponse);
+}
+
+GATTStatus GATTCharacteristic::writeValueStatus(const int valueSize, const ValueFill & fill, const bool withResponse) noexcept {
+    std::shared_ptr<GATTHandler> gatt = getGATTHandlerUnchecked(*this);
+    if( nullptr == gatt ) {
+        return GATTStatus::INVALID_STATE;
+    }
+    return gatt->writeCharacteristicValueStatus(*this, valueSize, fill, withResponse);
+}
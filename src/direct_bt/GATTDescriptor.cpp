@@ -39,6 +39,47 @@
 
 using namespace direct_bt;
 
+void GATTValueCache::setTTL(const int32_t ttlMS_) {
+    const std::lock_guard<std::mutex> lock(mtx_value); // RAII-style acquire and relinquish via destructor
+    ttlMS = ttlMS_ < 0 ? TTL::PERMANENT : ttlMS_;
+    if( TTL::DISABLED == ttlMS ) {
+        value = nullptr;
+    }
+}
+
+int32_t GATTValueCache::getTTL() const {
+    const std::lock_guard<std::mutex> lock(mtx_value); // RAII-style acquire and relinquish via destructor
+    return ttlMS;
+}
+
+void GATTValueCache::put(const TROOctets & v, const uint64_t timestamp_) {
+    const std::lock_guard<std::mutex> lock(mtx_value); // RAII-style acquire and relinquish via destructor
+    if( TTL::DISABLED == ttlMS ) {
+        return;
+    }
+    value = std::shared_ptr<const POctets>( new POctets(v) );
+    timestamp = timestamp_;
+}
+
+bool GATTValueCache::get(POctets & res) const {
+    std::shared_ptr<const POctets> v;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_value); // RAII-style acquire and relinquish via destructor
+        if( nullptr == value ||
+            ( 0 < ttlMS && static_cast<uint64_t>(getCurrentMilliseconds()) - timestamp > static_cast<uint64_t>(ttlMS) ) ) {
+            return false;
+        }
+        v = value;
+    }
+    res += *v;
+    return true;
+}
+
+void GATTValueCache::invalidate() {
+    const std::lock_guard<std::mutex> lock(mtx_value); // RAII-style acquire and relinquish via destructor
+    value = nullptr;
+}
+
 const uuid16_t GATTDescriptor::TYPE_EXT_PROP(Type::CHARACTERISTIC_EXTENDED_PROPERTIES);
 const uuid16_t GATTDescriptor::TYPE_USER_DESC(Type::CHARACTERISTIC_USER_DESCRIPTION);
 const uuid16_t GATTDescriptor::TYPE_CCC_DESC(Type::CLIENT_CHARACTERISTIC_CONFIGURATION);
@@ -74,7 +115,7 @@ bool GATTDescriptor::writeValue() {
 }
 
 std::string GATTDescriptor::toString() const {
-    return "[type 0x"+type->toString()+", handle "+uint16HexString(handle)+", value["+value.toString()+"]]";
+    return "[type 0x"+getTypeString(false)+", handle "+uint16HexString(handle)+", value["+value.toString()+"]]";
 }
 
 std::string GATTDescriptor::toSafeString() const {
@@ -62,18 +62,84 @@ extern "C" {
 #include "HCIComm.hpp"
 #include "DBTTypes.hpp"
 #include "DBTDevice.hpp"
+#include "DBTAdapter.hpp"
+#include "HCIHandler.hpp"
 
 using namespace direct_bt;
 
+static GATTEnv::NotifyDispatch toNotifyDispatch(const std::string & v) {
+    if( "device" == v ) {
+        return GATTEnv::NotifyDispatch::DEVICE;
+    } else if( "shared" == v ) {
+        return GATTEnv::NotifyDispatch::SHARED;
+    } else if( "reader" != v ) {
+        WARN_PRINT("GATTEnv: Unknown 'direct_bt.gatt.notify.dispatch' value '%s', using 'reader'", v.c_str());
+    }
+    return GATTEnv::NotifyDispatch::READER;
+}
+
 GATTEnv::GATTEnv()
 : exploding( DBTEnv::getExplodingProperties("direct_bt.gatt") ),
-  L2CAP_READER_THREAD_POLL_TIMEOUT( DBTEnv::getInt32Property("direct_bt.gatt.reader.timeout", 10000, 1500 /* min */, INT32_MAX /* max */) ),
-  GATT_READ_COMMAND_REPLY_TIMEOUT( DBTEnv::getInt32Property("direct_bt.gatt.cmd.read.timeout", 500, 250 /* min */, INT32_MAX /* max */) ),
-  GATT_WRITE_COMMAND_REPLY_TIMEOUT(  DBTEnv::getInt32Property("direct_bt.gatt.cmd.write.timeout", 500, 250 /* min */, INT32_MAX /* max */) ),
-  GATT_INITIAL_COMMAND_REPLY_TIMEOUT( DBTEnv::getInt32Property("direct_bt.gatt.cmd.init.timeout", 2500, 2000 /* min */, INT32_MAX /* max */) ),
-  ATTPDU_RING_CAPACITY( DBTEnv::getInt32Property("direct_bt.gatt.ringsize", 128, 64 /* min */, 1024 /* max */) ),
+  L2CAP_READER_THREAD_POLL_TIMEOUT( 0 ),
+  GATT_READ_COMMAND_REPLY_TIMEOUT( 0 ),
+  GATT_WRITE_COMMAND_REPLY_TIMEOUT( 0 ),
+  GATT_INITIAL_COMMAND_REPLY_TIMEOUT( 0 ),
+  GATT_COMMAND_RETRIES( 0 ),
+  GATT_COMMAND_RETRY_BACKOFF( 0 ),
+  GATT_COMMAND_TIMEOUT_DISCONNECT( 0 ),
+  GATT_ADAPTIVE_TIMEOUT( DBTEnv::getBooleanProperty("direct_bt.gatt.cmd.timeout.adaptive", false) ),
+  GATT_ADAPTIVE_TIMEOUT_MIN( 0 ),
+  GATT_ADAPTIVE_TIMEOUT_MAX( 0 ),
+  GATT_L2CAP_CONNECT_TIMEOUT( 0 ),
+  L2CAP_SOCKET_OPTIONS( "direct_bt.gatt.l2cap" ),
+  GATT_PREPARE_WRITE_WINDOW( DBTEnv::getInt32Property("direct_bt.gatt.write.prepare.window", 1, 0 /* min */, 32 /* max */) ),
+  GATT_READ_BLOB_WINDOW( DBTEnv::getInt32Property("direct_bt.gatt.read.blob.window", 1, 0 /* min */, 32 /* max */) ),
+  GATT_CCCD_WRITE_WINDOW( DBTEnv::getInt32Property("direct_bt.gatt.write.cccd.window", 1, 0 /* min */, 32 /* max */) ),
+  GATT_READ_WINDOW( DBTEnv::getInt32Property("direct_bt.gatt.read.window", 1, 0 /* min */, 32 /* max */) ),
+  GATT_WRITE_QUEUE_LATENCY( DBTEnv::getInt32Property("direct_bt.gatt.write.queue.latency", 0, 0 /* min */, 1000 /* max */) ),
+  GATT_WRITE_QUEUE_BATCH( DBTEnv::getInt32Property("direct_bt.gatt.write.queue.batch", 16, 1 /* min */, 256 /* max */) ),
+  ATTPDU_RING_CAPACITY( 0 ),
+  ATTPDU_RING_OPTIONS( "direct_bt.gatt.ring", DBTRingOptions::OverflowPolicy::BLOCK, 500 /* timeout */, 1024 /* max */ ),
+  GATT_READER_VIA_HCI( DBTEnv::getBooleanProperty("direct_bt.gatt.reader.hci", false) ),
+  GATT_READER_REACTOR_THREADS( DBTEnv::getInt32Property("direct_bt.gatt.reader.reactor", 0, 0 /* min */, 16 /* max */) ),
+  GATT_READER_EXTERNAL( DBTEnv::getBooleanProperty("direct_bt.gatt.reader.external", false) ),
+  L2CAP_READER_THREAD_OPTIONS( "direct_bt.gatt.reader", "dbt_gatt_rdr" ),
+  GATT_CACHE( DBTEnv::getBooleanProperty("direct_bt.gatt.cache", false) ),
+  GATT_CACHE_DIR( DBTEnv::getProperty("direct_bt.gatt.cache.dir", "") ),
+  GATT_DISCOVER_BATCHED( DBTEnv::getBooleanProperty("direct_bt.gatt.discover.batched", false) ),
+  GATT_NOTIFY_DISPATCH( toNotifyDispatch( DBTEnv::getProperty("direct_bt.gatt.notify.dispatch", "reader") ) ),
+  GATT_NOTIFY_QUEUE_CAPACITY( DBTEnv::getInt32Property("direct_bt.gatt.notify.queue", 256, 16 /* min */, 8192 /* max */) ),
+  GATT_NOTIFY_DROP_OLDEST( DBTEnv::getBooleanProperty("direct_bt.gatt.notify.drop.oldest", false) ),
+  GATT_VALUE_CACHE_STATIC( DBTEnv::getBooleanProperty("direct_bt.gatt.value.cache.static", false) ),
+  GATT_GENERIC_ACCESS_LAZY( DBTEnv::getBooleanProperty("direct_bt.gatt.genericaccess.lazy", false) ),
+  GATT_CLIENT_MTU( DBTEnv::getInt32Property("direct_bt.gatt.mtu", GATTHandler::number(GATTHandler::Defaults::MAX_ATT_MTU),
+                                            GATTHandler::number(GATTHandler::Defaults::MIN_ATT_MTU) /* min */,
+                                            GATTHandler::number(GATTHandler::Defaults::MAX_ATT_MTU) /* max */) ),
   DEBUG_DATA( DBTEnv::getBooleanProperty("direct_bt.debug.gatt.data", false) )
 {
+    reload();
+    DBTEnv::addPropertyListener(onPropertyChanged);
+}
+
+void GATTEnv::onPropertyChanged(const std::string & name) {
+    if( 0 == name.find("direct_bt.gatt") ) {
+        get().reload();
+    }
+}
+
+void GATTEnv::reload() {
+    L2CAP_READER_THREAD_POLL_TIMEOUT = DBTEnv::getInt32Property("direct_bt.gatt.reader.timeout", 10000, 1500 /* min */, INT32_MAX /* max */);
+    GATT_READ_COMMAND_REPLY_TIMEOUT = DBTEnv::getInt32Property("direct_bt.gatt.cmd.read.timeout", 500, 250 /* min */, INT32_MAX /* max */);
+    GATT_WRITE_COMMAND_REPLY_TIMEOUT = DBTEnv::getInt32Property("direct_bt.gatt.cmd.write.timeout", 500, 250 /* min */, INT32_MAX /* max */);
+    GATT_INITIAL_COMMAND_REPLY_TIMEOUT = DBTEnv::getInt32Property("direct_bt.gatt.cmd.init.timeout", 2500, 2000 /* min */, INT32_MAX /* max */);
+    GATT_COMMAND_RETRIES = DBTEnv::getInt32Property("direct_bt.gatt.cmd.retries", 0, 0 /* min */, 8 /* max */);
+    GATT_COMMAND_RETRY_BACKOFF = DBTEnv::getInt32Property("direct_bt.gatt.cmd.retry.backoff", 2, 1 /* min */, 8 /* max */);
+    GATT_COMMAND_TIMEOUT_DISCONNECT = DBTEnv::getInt32Property("direct_bt.gatt.cmd.timeout.disconnect", 1, 1 /* min */, 100 /* max */);
+    GATT_ADAPTIVE_TIMEOUT_MIN = DBTEnv::getInt32Property("direct_bt.gatt.cmd.timeout.min", 100, 10 /* min */, INT32_MAX /* max */);
+    GATT_ADAPTIVE_TIMEOUT_MAX = DBTEnv::getInt32Property("direct_bt.gatt.cmd.timeout.max", 30000, 250 /* min */, INT32_MAX /* max */);
+    GATT_L2CAP_CONNECT_TIMEOUT = DBTEnv::getInt32Property("direct_bt.gatt.connect.timeout",
+                                 L2CAPComm::number(L2CAPComm::Defaults::L2CAP_CONNECT_TIMEOUT), 500 /* min */, INT32_MAX /* max */);
+    ATTPDU_RING_CAPACITY = DBTEnv::getInt32Property("direct_bt.gatt.ringsize", 128, 64 /* min */, 1024 /* max */);
 }
 
 #define CASE_TO_STRING(V) case V: return #V;
@@ -100,16 +166,60 @@ bool GATTHandler::addCharacteristicListener(std::shared_ptr<GATTCharacteristicLi
     if( nullptr == l ) {
         throw IllegalArgumentException("GATTEventListener ref is null", E_FILE_LINE);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
-    for(auto it = characteristicListenerList.begin(); it != characteristicListenerList.end(); ) {
-        if ( **it == *l ) {
-            return false; // already included
-        } else {
-            ++it;
+    return characteristicListenerList.push_back_unique(l,
+            [](const std::shared_ptr<GATTCharacteristicListener> &a, const std::shared_ptr<GATTCharacteristicListener> &b) {
+                return *a == *b;
+            });
+}
+
+bool GATTHandler::addCharacteristicListener(std::shared_ptr<GATTCharacteristicListener> l, const std::vector<uint16_t> & valueHandles) {
+    if( nullptr == l ) {
+        throw IllegalArgumentException("GATTEventListener ref is null", E_FILE_LINE);
+    }
+    const std::lock_guard<std::recursive_mutex> lock(characteristicListenerList.get_write_mutex()); // RAII-style acquire and relinquish via destructor
+    std::shared_ptr<const BoundListenerIndex> old_index = std::atomic_load(&boundListenerIndex);
+    std::shared_ptr<BoundListenerIndex> index( nullptr != old_index ? new BoundListenerIndex(*old_index) : new BoundListenerIndex() );
+    bool added = false;
+    for(auto it = valueHandles.begin(); it != valueHandles.end(); it++) {
+        std::vector<std::shared_ptr<GATTCharacteristicListener>> & bound = (*index)[*it];
+        auto jt = std::find_if(bound.begin(), bound.end(),
+                [&l](const std::shared_ptr<GATTCharacteristicListener> &b) { return *b == *l; });
+        if( bound.end() == jt ) {
+            bound.push_back(l);
+            added = true;
         }
     }
-    characteristicListenerList.push_back(l);
-    return true;
+    if( added ) {
+        std::atomic_store(&boundListenerIndex, std::shared_ptr<const BoundListenerIndex>(index));
+    }
+    return added;
+}
+
+int GATTHandler::unbindCharacteristicListener(const uint16_t valueHandle, std::function<bool(const std::shared_ptr<GATTCharacteristicListener> &)> match) {
+    const std::lock_guard<std::recursive_mutex> lock(characteristicListenerList.get_write_mutex()); // RAII-style acquire and relinquish via destructor
+    std::shared_ptr<const BoundListenerIndex> old_index = std::atomic_load(&boundListenerIndex);
+    if( nullptr == old_index ) {
+        return 0;
+    }
+    std::shared_ptr<BoundListenerIndex> index( new BoundListenerIndex() );
+    int count = 0;
+    for(auto it = old_index->begin(); it != old_index->end(); it++) {
+        std::vector<std::shared_ptr<GATTCharacteristicListener>> bound;
+        for(auto jt = it->second.begin(); jt != it->second.end(); jt++) {
+            if( ( 0 == valueHandle || it->first == valueHandle ) && match(*jt) ) {
+                count++;
+            } else {
+                bound.push_back(*jt);
+            }
+        }
+        if( bound.size() > 0 ) {
+            (*index)[it->first] = std::move(bound);
+        }
+    }
+    if( 0 < count ) {
+        std::atomic_store(&boundListenerIndex, std::shared_ptr<const BoundListenerIndex>(index));
+    }
+    return count;
 }
 
 bool GATTHandler::removeCharacteristicListener(std::shared_ptr<GATTCharacteristicListener> l) {
@@ -123,16 +233,15 @@ bool GATTHandler::removeCharacteristicListener(const GATTCharacteristicListener
     if( nullptr == l ) {
         throw IllegalArgumentException("GATTEventListener ref is null", E_FILE_LINE);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
-    for(auto it = characteristicListenerList.begin(); it != characteristicListenerList.end(); ) {
-        if ( **it == *l ) {
-            it = characteristicListenerList.erase(it);
-            return true;
-        } else {
-            ++it;
-        }
-    }
-    return false;
+    const std::lock_guard<std::recursive_mutex> lock(characteristicListenerList.get_write_mutex()); // RAII-style acquire and relinquish via destructor
+    const int unbound = unbindCharacteristicListener(0 /* all handles */,
+            [l](const std::shared_ptr<GATTCharacteristicListener> &it) {
+                return *it == *l;
+            });
+    return 0 < characteristicListenerList.erase_matching(false /* all */,
+            [l](const std::shared_ptr<GATTCharacteristicListener> &it) {
+                return *it == *l;
+            }) || 0 < unbound;
 }
 
 int GATTHandler::removeAllAssociatedCharacteristicListener(std::shared_ptr<GATTCharacteristic> associatedCharacteristic) {
@@ -146,37 +255,288 @@ int GATTHandler::removeAllAssociatedCharacteristicListener(const GATTCharacteris
     if( nullptr == associatedCharacteristic ) {
         throw IllegalArgumentException("GATTCharacteristic ref is null", E_FILE_LINE);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
-    for(auto it = characteristicListenerList.begin(); it != characteristicListenerList.end(); ) {
-        if ( (*it)->match(*associatedCharacteristic) ) {
-            it = characteristicListenerList.erase(it);
-            return true;
-        } else {
-            ++it;
-        }
-    }
-    return false;
+    const std::lock_guard<std::recursive_mutex> lock(characteristicListenerList.get_write_mutex()); // RAII-style acquire and relinquish via destructor
+    const int unbound = unbindCharacteristicListener(associatedCharacteristic->value_handle,
+            [](const std::shared_ptr<GATTCharacteristicListener> &it) {
+                (void)it;
+                return true;
+            });
+    return unbound + characteristicListenerList.erase_matching(true /* all */,
+            [associatedCharacteristic](const std::shared_ptr<GATTCharacteristicListener> &it) {
+                return it->match(*associatedCharacteristic);
+            });
 }
 
 int GATTHandler::removeAllCharacteristicListener() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<std::recursive_mutex> lock(characteristicListenerList.get_write_mutex()); // RAII-style acquire and relinquish via destructor
     int count = characteristicListenerList.size();
     characteristicListenerList.clear();
+    std::shared_ptr<const BoundListenerIndex> index = std::atomic_load(&boundListenerIndex);
+    if( nullptr != index ) {
+        for(auto it = index->begin(); it != index->end(); it++) {
+            count += it->second.size();
+        }
+        std::atomic_store(&boundListenerIndex, std::shared_ptr<const BoundListenerIndex>());
+    }
     return count;
 }
 
 void GATTHandler::setSendIndicationConfirmation(const bool v) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
     sendIndicationConfirmation = v;
 }
 
 bool GATTHandler::getSendIndicationConfirmation() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_eventListenerList); // RAII-style acquire and relinquish via destructor
     return sendIndicationConfirmation;
 }
 
+void GATTHandler::invokeCharacteristicListener(GATTCharacteristicListener & l, GATTCharacteristicRef decl, std::shared_ptr<TROOctets> & data,
+                                               const bool isNotification, const TROOctets & value, const uint64_t timestamp, const bool cfmSent) {
+    if( l.isValueViewListener() ) {
+        GATTCharacteristicValueListener & vl = static_cast<GATTCharacteristicValueListener&>(l);
+        if( isNotification ) {
+            vl.notificationValueReceived(decl, value, timestamp);
+        } else {
+            vl.indicationValueReceived(decl, value, timestamp, cfmSent);
+        }
+    } else {
+        if( nullptr == data ) {
+            data = std::shared_ptr<TROOctets>(new POctets(value));
+        }
+        if( isNotification ) {
+            l.notificationReceived(decl, data, timestamp);
+        } else {
+            l.indicationReceived(decl, data, timestamp, cfmSent);
+        }
+    }
+}
+
+void GATTHandler::dispatchHandleValue(const bool isNotification, const uint16_t handle, const TROOctets & value,
+                                      const uint64_t timestamp, const bool cfmSent) {
+    GATTCharacteristicRef decl = findCharacterisicsByValueHandle(handle);
+    std::shared_ptr<TROOctets> data; // shared owning copy, created on demand
+
+    if( nullptr != decl && decl->valueCache.isEnabled() ) {
+        if( value.getSize() < usedMTU - 3 ) { // opcode + handle
+            decl->valueCache.put(value, timestamp);
+        } else {
+            decl->valueCache.invalidate(); // potentially truncated by the ATT_MTU
+        }
+    }
+
+    const std::shared_ptr<const BoundListenerIndex> index = std::atomic_load(&boundListenerIndex);
+    if( nullptr != index && nullptr != decl ) {
+        auto bt = index->find(handle);
+        if( index->end() != bt ) {
+            int i=0;
+            for_each_idx(bt->second, [&](const std::shared_ptr<GATTCharacteristicListener> &l) {
+                try {
+                    invokeCharacteristicListener(*l, decl, data, isNotification, value, timestamp, cfmSent);
+                } catch (std::exception &e) {
+                    ERR_PRINT("GATTHandler::%sReceived-CBs bound %d/%zd: GATTCharacteristicListener %s, cfmSent %d: Caught exception %s",
+                            isNotification ? "notification" : "indication", i+1, bt->second.size(),
+                            aptrHexString((void*)l.get()).c_str(), cfmSent, e.what());
+                }
+                i++;
+            });
+        }
+    }
+
+    const COWVector<std::shared_ptr<GATTCharacteristicListener>>::snapshot_t listener = characteristicListenerList.get_snapshot();
+    int i=0;
+    for_each_idx(*listener, [&](const std::shared_ptr<GATTCharacteristicListener> &l) {
+        try {
+            if( l->match(*decl) ) {
+                invokeCharacteristicListener(*l, decl, data, isNotification, value, timestamp, cfmSent);
+            }
+        } catch (std::exception &e) {
+            ERR_PRINT("GATTHandler::%sReceived-CBs %d/%zd: GATTCharacteristicListener %s, cfmSent %d: Caught exception %s",
+                    isNotification ? "notification" : "indication", i+1, listener->size(),
+                    aptrHexString((void*)l.get()).c_str(), cfmSent, e.what());
+        }
+        i++;
+    });
+}
+
+GATTNotificationExecutor::GATTNotificationExecutor(const int capacity, const bool dropOldest)
+: queue(capacity), dropOldest(dropOldest), running(true), enqueuedCount(0), droppedCount(0), workerEnded(false)
+{ }
+
+std::shared_ptr<GATTNotificationExecutor> GATTNotificationExecutor::create(const int capacity, const bool dropOldest) {
+    std::shared_ptr<GATTNotificationExecutor> e( new GATTNotificationExecutor(capacity, dropOldest) );
+    // The worker holds a reference until it has ended, hence the executor outlives a detached worker.
+    std::thread worker = std::thread([e]() { e->workerImpl(); });
+    e->workerId = worker.get_id();
+    worker.detach();
+    return e;
+}
+
+std::shared_ptr<GATTNotificationExecutor> GATTNotificationExecutor::getShared() {
+    static std::shared_ptr<GATTNotificationExecutor> shared =
+            create(GATTEnv::get().GATT_NOTIFY_QUEUE_CAPACITY, GATTEnv::get().GATT_NOTIFY_DROP_OLDEST);
+    return shared;
+}
+
+void GATTNotificationExecutor::workerImpl() {
+    // Drain the queue in batches, one synchronization with the producers per batch
+    std::shared_ptr<const Event> batch[16];
+    while( running ) {
+        const int count = queue.getAll(batch, 16, 0 /* infinite */);
+        for(int i=0; i<count; i++) {
+            std::shared_ptr<const Event> e = std::move(batch[i]);
+            if( nullptr == e || !running ) {
+                goto exit;
+            }
+            std::shared_ptr<GATTHandler> h = e->handler.lock();
+            if( nullptr != h ) {
+                h->dispatchHandleValue(e->isNotification, e->handle, e->value, e->timestamp, e->cfmSent);
+            }
+        }
+    }
+exit:
+    for(std::shared_ptr<const Event> & e : batch) {
+        e = nullptr;
+    }
+    queue.clear();
+    {
+        const std::lock_guard<std::mutex> lock(mtx_worker); // RAII-style acquire and relinquish via destructor
+        workerEnded = true;
+    }
+    cv_worker.notify_all();
+}
+
+bool GATTNotificationExecutor::enqueue(const std::shared_ptr<const Event> & e) {
+    if( !running ) {
+        droppedCount++;
+        return false;
+    }
+    if( queue.put(e) ) {
+        enqueuedCount++;
+        return true;
+    }
+    droppedCount++;
+    if( dropOldest ) {
+        queue.drop(1);
+        if( queue.put(e) ) {
+            enqueuedCount++;
+        }
+    }
+    return false;
+}
+
+void GATTNotificationExecutor::stop(const bool wait) {
+    bool expRunning = true; // C++11, exp as value since C++20
+    if( running.compare_exchange_strong(expRunning, false) ) {
+        // wake up the worker with a stale event, making room if full
+        const std::shared_ptr<const Event> wakeUp( new Event(std::weak_ptr<GATTHandler>(), true, 0, TROOctets(nullptr, 0), 0, false) );
+        while( !queue.put(wakeUp) ) {
+            queue.drop(1);
+        }
+    }
+    if( wait && std::this_thread::get_id() != workerId ) {
+        std::unique_lock<std::mutex> lock(mtx_worker); // RAII-style acquire and relinquish via destructor
+        while( !workerEnded ) {
+            cv_worker.wait(lock);
+        }
+    }
+}
+
+std::string GATTNotificationExecutor::toString() const {
+    return "GATTNotificationExecutor[running "+std::to_string(running.load())+", dropOldest "+std::to_string(dropOldest)+
+           ", queue "+std::to_string(getQueueSize())+"/"+std::to_string(getQueueCapacity())+
+           ", enqueued "+std::to_string(enqueuedCount.load())+", dropped "+std::to_string(droppedCount.load())+"]";
+}
+
+std::shared_ptr<GATTNotificationExecutor> GATTHandler::getNotificationExecutor() {
+    switch( getNotifyDispatch() ) {
+        case GATTEnv::NotifyDispatch::DEVICE: return std::atomic_load(&notificationExecutor);
+        case GATTEnv::NotifyDispatch::SHARED: return GATTNotificationExecutor::getShared();
+        default: return nullptr;
+    }
+}
+
+void GATTHandler::deliverHandleValue(const bool isNotification, const uint16_t handle, const TROOctets & value,
+                                     const uint64_t timestamp, const bool cfmSent) {
+    std::shared_ptr<GATTNotificationExecutor> executor = getNotificationExecutor();
+    if( nullptr == executor ) {
+        dispatchHandleValue(isNotification, handle, value, timestamp, cfmSent);
+        return;
+    }
+    const std::shared_ptr<GATTHandler> self = wbr_self.lock();
+    if( nullptr == self ) {
+        return; // not created via create() or being destructed
+    }
+    const std::shared_ptr<const GATTNotificationExecutor::Event> e(
+            new GATTNotificationExecutor::Event(self, isNotification, handle, value, timestamp, cfmSent) );
+    if( !executor->enqueue(e) ) {
+        notificationDropCount++;
+        COND_PRINT(env.DEBUG_DATA, "GATTHandler: %s dropped: handle %s, %s",
+                isNotification ? "NTF" : "IND", uint16HexString(handle).c_str(), executor->toString().c_str());
+    }
+}
+
+void GATTHandler::processAttPDU(const uint8_t * buffer, const int len, const uint64_t timestampNS) {
+    const AttPDUMsg::Opcode opc0 = 0 < len ? static_cast<AttPDUMsg::Opcode>(buffer[0]) : AttPDUMsg::Opcode::ATT_PDU_UNDEFINED;
+    if( 0 < len ) {
+        traffic.countIn(buffer[0], len);
+    }
+
+    // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.7.1 and 3.4.7.2: opcode, handle and value
+    if( ( AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF == opc0 || AttPDUMsg::Opcode::ATT_HANDLE_VALUE_IND == opc0 ) && 3 <= len ) {
+        // Dispatch directly from the receive buffer, copying the value only for owning listener.
+        const bool isNotification = AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF == opc0;
+        const uint16_t handle = get_uint16(buffer, 1, true /* littleEndian */);
+        const TROOctets value(buffer + 3, len - 3);
+        COND_PRINT(env.DEBUG_DATA, "GATTHandler: %s: handle %s, value %s, sendIndicationConfirmation %d, listener %zd",
+                isNotification ? "NTF" : "IND", uint16HexString(handle).c_str(), value.toString().c_str(),
+                sendIndicationConfirmation, characteristicListenerList.size());
+        bool cfmSent = false;
+        if( !isNotification && sendIndicationConfirmation ) {
+            AttHandleValueCfm cfm;
+            send(cfm);
+            cfmSent = true;
+        }
+        if( !isNotification && env.GATT_CACHE && 0 != handle && serviceChangedHandle == handle ) {
+            // BT Core Spec v5.2: Vol 3, Part G GATT: 7.1 Service Changed
+            std::shared_ptr<DBTDevice> device = getDevice();
+            if( nullptr != device ) {
+                INFO_PRINT("GATTHandler: Service Changed -> invalidate cache: %s", deviceString.c_str());
+                getCache().invalidate(device->getAddress());
+            }
+        }
+        deliverHandleValue(isNotification, handle, value, timestampNS / 1000000, cfmSent);
+        return;
+    }
+
+    std::shared_ptr<AttPDUMsg> attPDU = attPDUPool.getSpecialized(buffer, len);
+    attPDU->setTimestampNS(timestampNS);
+    const AttPDUMsg::Opcode opc = attPDU->getOpcode();
+
+    if( AttPDUMsg::Opcode::ATT_MULTIPLE_HANDLE_VALUE_NTF == opc ) {
+        const AttMultipleValueList * a = static_cast<const AttMultipleValueList*>(attPDU.get());
+        COND_PRINT(env.DEBUG_DATA, "GATTHandler: MULTI-NTF: %s, listener %zd", a->toString().c_str(), characteristicListenerList.size());
+        const int count = a->getValueCount();
+        for(int i=0; i<count; i++) {
+            const TOctetSlice v = a->getValue(i);
+            const TROOctets value(v.getParent().get_ptr() + v.getOffset(), v.getSize());
+            deliverHandleValue(true /* isNotification */, a->getValueHandle(i), value, a->ts_creation, false /* cfmSent */);
+        }
+    } else {
+        if( !attPDURing.offer( std::move(attPDU) ) ) {
+            WARN_PRINT("GATTHandler::processAttPDU: Drop (ring full, %d capacity, %s): %s: %s", attPDURing.capacity(),
+                    DBTRingOptions::getOverflowPolicyString(env.ATTPDU_RING_OPTIONS.POLICY).c_str(), attPDU->toString().c_str(), deviceString.c_str());
+        }
+    }
+}
+
 void GATTHandler::l2capReaderThreadImpl() {
+    env.L2CAP_READER_THREAD_OPTIONS.applyToCurrentThread();
+    if( nullptr != profile ) {
+        profile->applyReaderPriorityToCurrentThread();
+    }
     bool ioErrorCause = false;
+    bool cancelled = false;
     {
         const std::lock_guard<std::mutex> lock(mtx_l2capReaderInit); // RAII-style acquire and relinquish via destructor
         l2capReaderShallStop = false;
@@ -193,67 +553,20 @@ void GATTHandler::l2capReaderThreadImpl() {
             break;
         }
 
-        len = l2cap.read(rbuffer.get_wptr(), rbuffer.getSize(), env.L2CAP_READER_THREAD_POLL_TIMEOUT);
-        if( 0 < len ) {
-            const AttPDUMsg * attPDU = AttPDUMsg::getSpecialized(rbuffer.get_ptr(), len);
-            const AttPDUMsg::Opcode opc = attPDU->getOpcode();
-
-            if( AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF == opc ) {
-                const AttHandleValueRcv * a = static_cast<const AttHandleValueRcv*>(attPDU);
-                COND_PRINT(env.DEBUG_DATA, "GATTHandler: NTF: %s, listener %zd", a->toString().c_str(), characteristicListenerList.size());
-                GATTCharacteristicRef decl = findCharacterisicsByValueHandle(a->getHandle());
-                const std::shared_ptr<TROOctets> data(new POctets(a->getValue()));
-                const uint64_t timestamp = a->ts_creation;
-                int i=0;
-                for_each_idx_mtx(mtx_eventListenerList, characteristicListenerList, [&](std::shared_ptr<GATTCharacteristicListener> &l) {
-                    try {
-                        if( l->match(*decl) ) {
-                            l->notificationReceived(decl, data, timestamp);
-                        }
-                    } catch (std::exception &e) {
-                        ERR_PRINT("GATTHandler::notificationReceived-CBs %d/%zd: GATTCharacteristicListener %s: Caught exception %s",
-                                i+1, characteristicListenerList.size(),
-                                aptrHexString((void*)l.get()).c_str(), e.what());
-                    }
-                    i++;
-                });
-                attPDU = nullptr;
-            } else if( AttPDUMsg::Opcode::ATT_HANDLE_VALUE_IND == opc ) {
-                const AttHandleValueRcv * a = static_cast<const AttHandleValueRcv*>(attPDU);
-                COND_PRINT(env.DEBUG_DATA, "GATTHandler: IND: %s, sendIndicationConfirmation %d, listener %zd", a->toString().c_str(), sendIndicationConfirmation, characteristicListenerList.size());
-                bool cfmSent = false;
-                if( sendIndicationConfirmation ) {
-                    AttHandleValueCfm cfm;
-                    send(cfm);
-                    cfmSent = true;
-                }
-                GATTCharacteristicRef decl = findCharacterisicsByValueHandle(a->getHandle());
-                const std::shared_ptr<TROOctets> data(new POctets(a->getValue()));
-                const uint64_t timestamp = a->ts_creation;
-                int i=0;
-                for_each_idx_mtx(mtx_eventListenerList, characteristicListenerList, [&](std::shared_ptr<GATTCharacteristicListener> &l) {
-                    try {
-                        if( l->match(*decl) ) {
-                            l->indicationReceived(decl, data, timestamp, cfmSent);
-                        }
-                    } catch (std::exception &e) {
-                        ERR_PRINT("GATTHandler::indicationReceived-CBs %d/%zd: GATTCharacteristicListener %s, cfmSent %d: Caught exception %s",
-                                i+1, characteristicListenerList.size(),
-                                aptrHexString((void*)l.get()).c_str(), cfmSent, e.what());
-                    }
-                    i++;
-                });
-                attPDU = nullptr;
-            } else if( AttPDUMsg::Opcode::ATT_MULTIPLE_HANDLE_VALUE_NTF == opc ) {
-                // FIXME TODO ..
-                ERR_PRINT("GATTHandler: MULTI-NTF not implemented: %s", attPDU->toString().c_str());
-            } else {
-                attPDURing.putBlocking( std::shared_ptr<const AttPDUMsg>( attPDU ) );
-                attPDU = nullptr;
-            }
-            if( nullptr != attPDU ) {
-                delete attPDU; // free unhandled PDU
+        {
+            const int targetSize = rbufferTargetSize;
+            if( targetSize != rbuffer.getSize() ) {
+                rbuffer.resize(targetSize, targetSize);
             }
+        }
+        uint64_t timestampNS = 0;
+        len = l2cap.read(rbuffer.get_wptr(), rbuffer.getSize(), env.L2CAP_READER_THREAD_POLL_TIMEOUT, timestampNS);
+        if( 0 < len ) {
+            processAttPDU(rbuffer.get_ptr(), len, timestampNS);
+        } else if( ECANCELED == errno ) {
+            // woken up by l2cap.disconnect(), i.e. our disconnect() is in progress
+            l2capReaderShallStop = true;
+            cancelled = true;
         } else if( ETIMEDOUT != errno && !l2capReaderShallStop ) { // expected exits
             ERR_PRINT("GATTHandler::l2capReaderThread: l2cap read error -> Stop");
             l2capReaderShallStop = true;
@@ -261,24 +574,161 @@ void GATTHandler::l2capReaderThreadImpl() {
         }
     }
 
-    INFO_PRINT("l2capReaderThreadImpl Ended. Ring has %d entries flushed", attPDURing.getSize());
+    INFO_PRINT("l2capReaderThreadImpl Ended. Ring has %d entries, %s", attPDURing.getSize(), attPDURing.getStats().toString().c_str());
     l2capReaderRunning = false;
-    attPDURing.clear();
-    disconnect(true /* disconnectDevice */, ioErrorCause);
+    if( !cancelled ) {
+        disconnect(true /* disconnectDevice */, ioErrorCause);
+    }
+}
+
+bool GATTHandler::l2capFrameReceived(uint16_t handle, uint16_t cid, const TROOctets & payload) {
+    (void)handle;
+    (void)cid;
+    if( !isConnected || 0 == payload.getSize() ) {
+        return false;
+    }
+    processAttPDU(payload.get_ptr(), payload.getSize(), getCurrentNanoseconds());
+    return true;
+}
+
+bool GATTHandler::startHCIReader() {
+    std::shared_ptr<DBTDevice> device = getDevice();
+    if( nullptr == device || 0 == device->getConnectionHandle() ) {
+        return false;
+    }
+    std::shared_ptr<HCIHandler> hci = device->getAdapter().getHCI();
+    if( nullptr == hci ||
+        !hci->setL2CAPFrameCallback(device->getConnectionHandle(), L2CAP_CID_ATT, number(Defaults::MAX_ATT_MTU),
+                                    bindMemberFunc(this, &GATTHandler::l2capFrameReceived)) )
+    {
+        return false;
+    }
+    hciReader = hci;
+    hciReaderHandle = device->getConnectionHandle();
+    DBG_PRINT("GATTHandler::connect: Using HCI reader for handle 0x%x: %s", hciReaderHandle, deviceString.c_str());
+    return true;
+}
+
+static std::shared_ptr<L2CAPReactor> getSharedReactor() {
+    static std::shared_ptr<L2CAPReactor> shared =
+            L2CAPReactor::create(GATTEnv::get().GATT_READER_EXTERNAL ? 0 : GATTEnv::get().GATT_READER_REACTOR_THREADS,
+                                 GATTEnv::get().L2CAP_READER_THREAD_OPTIONS);
+    return shared;
+}
+
+std::shared_ptr<L2CAPReactor> GATTHandler::getExternalReactor() {
+    return GATTEnv::get().GATT_READER_EXTERNAL ? getSharedReactor() : nullptr;
+}
+
+bool GATTHandler::l2capReactorReceived(const uint8_t * data, int len) {
+    if( !isConnected ) {
+        return false;
+    }
+    if( 0 > len ) {
+        ERR_PRINT("GATTHandler::l2capReactorReceived: l2cap read error -> disconnect: %s", deviceString.c_str());
+        disconnect(true /* disconnectDevice */, true /* ioErrorCause */);
+        return false;
+    }
+    processAttPDU(data, len, getCurrentNanoseconds());
+    return true;
+}
+
+bool GATTHandler::startReactorReader() {
+    std::shared_ptr<L2CAPReactor> reactor = getSharedReactor();
+    const uint64_t id = reactor->add(l2cap.dd(), number(Defaults::MAX_ATT_MTU),
+                                     bindMemberFunc(this, &GATTHandler::l2capReactorReceived));
+    if( 0 == id ) {
+        return false;
+    }
+    reactorReader = reactor;
+    reactorReaderId = id;
+    DBG_PRINT("GATTHandler::connect: Using reactor reader id %" PRIu64 ", %s: %s",
+              id, reactor->toString().c_str(), deviceString.c_str());
+    return true;
+}
+
+void GATTHandler::stopReactorReader(const bool wait) {
+    std::shared_ptr<L2CAPReactor> reactor = std::atomic_exchange(&reactorReader, std::shared_ptr<L2CAPReactor>());
+    if( nullptr != reactor ) {
+        reactor->remove(reactorReaderId, wait);
+    }
 }
 
-GATTHandler::GATTHandler(const std::shared_ptr<DBTDevice> &device)
-: env(GATTEnv::get()),
-  wbr_device(device), deviceString(device->getAddressString()), rbuffer(number(Defaults::MAX_ATT_MTU)),
-  l2cap(device, L2CAP_PSM_UNDEF, L2CAP_CID_ATT),
+static uint16_t resolveClientMTU(const GATTEnv & env, const std::shared_ptr<const DBTProfile> & profile, const uint16_t clientMTU) {
+    if( 0 < clientMTU ) {
+        return clientMTU;
+    }
+    return nullptr != profile && 0 < profile->clientMTU ? profile->clientMTU : env.GATT_CLIENT_MTU;
+}
+
+static int32_t resolveATTPDURingCapacity(const GATTEnv & env, const std::shared_ptr<const DBTProfile> & profile, const ControllerCaps & caps) {
+    return nullptr != profile && 0 < profile->attPDURingCapacity ? profile->attPDURingCapacity : caps.getRingCapacity(env.ATTPDU_RING_CAPACITY.load());
+}
+
+int32_t GATTHandler::getReadCommandReplyTimeout() const {
+    return nullptr != profile && 0 < profile->readTimeout ? profile->readTimeout : env.GATT_READ_COMMAND_REPLY_TIMEOUT.load();
+}
+
+int32_t GATTHandler::getWriteCommandReplyTimeout() const {
+    return nullptr != profile && 0 < profile->writeTimeout ? profile->writeTimeout : env.GATT_WRITE_COMMAND_REPLY_TIMEOUT.load();
+}
+
+int32_t GATTHandler::getInitialCommandReplyTimeout() const {
+    return nullptr != profile && 0 < profile->initialTimeout ? profile->initialTimeout : env.GATT_INITIAL_COMMAND_REPLY_TIMEOUT.load();
+}
+
+GATTEnv::NotifyDispatch GATTHandler::getNotifyDispatch() const {
+    return nullptr != profile && profile->hasNotifyDispatch ? profile->notifyDispatch : env.GATT_NOTIFY_DISPATCH;
+}
+
+GATTHandler::GATTHandler(const std::shared_ptr<DBTDevice> &device, const uint16_t clientMTU_)
+: env(GATTEnv::get()), profile(device->getEffectiveProfile()), controllerCaps(device->getAdapter().getControllerCaps()),
+  prepareWriteWindow(controllerCaps.getPipelineDepth(env.GATT_PREPARE_WRITE_WINDOW)),
+  readBlobWindow(controllerCaps.getPipelineDepth(env.GATT_READ_BLOB_WINDOW)),
+  cccdWriteWindow(controllerCaps.getPipelineDepth(env.GATT_CCCD_WRITE_WINDOW)),
+  readWindow(controllerCaps.getPipelineDepth(env.GATT_READ_WINDOW)),
+  wbr_device(device), deviceString(device->getAddressString()),
+  metricRead(DBTMetrics::get().getHistogram("gatt_read", "device", deviceString)),
+  metricWrite(DBTMetrics::get().getHistogram("gatt_write", "device", deviceString)),
+  metricDiscovery(DBTMetrics::get().getHistogram("gatt_discovery", "device", deviceString)),
+  metricRTT(DBTMetrics::get().getHistogram("gatt_rtt", "device", deviceString)),
+  rbuffer( resolveClientMTU(env, profile, clientMTU_) ),
+  l2cap(device, L2CAP_PSM_UNDEF, L2CAP_CID_ATT, env.L2CAP_SOCKET_OPTIONS),
   isConnected(false), hasIOError(false),
-  attPDURing(env.ATTPDU_RING_CAPACITY),
-  l2capReaderThreadId(0), l2capReaderRunning(false), l2capReaderShallStop(false),
-  serverMTU(number(Defaults::MIN_ATT_MTU)), usedMTU(number(Defaults::MIN_ATT_MTU))
-{ }
+  attPDUPool(resolveATTPDURingCapacity(env, profile, controllerCaps), number(Defaults::MAX_ATT_MTU)),
+  attPDURing(resolveATTPDURingCapacity(env, profile, controllerCaps), env.ATTPDU_RING_OPTIONS, true /* spsc */),
+  l2capReaderThreadId(0), l2capReaderRunning(false), l2capReaderShallStop(false), hciReaderHandle(0), reactorReaderId(0),
+  serverMTU(number(Defaults::MIN_ATT_MTU)), usedMTU(number(Defaults::MIN_ATT_MTU)),
+  clientMTU( resolveClientMTU(env, profile, clientMTU_) ), rbufferTargetSize(rbuffer.getSize()), readMultipleVariableSupported(true),
+  readBlobPipelineSupported(true), cacheDBHash(GATTCache::DB_HASH_SIZE, 0),
+  serviceChangedHandle(0), notificationDropCount(0),
+  connectL2CAPUS(0), connectMTUUS(0),
+  consecutiveReplyTimeouts(0), replyRetryCount(0), replyTimeoutCount(0), writeQueueT0(0), writeQueueWorkerShallStop(false), asyncWorkerShallStop(false)
+{
+    if( clientMTU < number(Defaults::MIN_ATT_MTU) || clientMTU > number(Defaults::MAX_ATT_MTU) ) {
+        throw IllegalArgumentException("clientMTU "+std::to_string(clientMTU)+" not within ["+
+                std::to_string(number(Defaults::MIN_ATT_MTU))+".."+std::to_string(number(Defaults::MAX_ATT_MTU))+"]", E_FILE_LINE);
+    }
+}
+
+std::shared_ptr<GATTHandler> GATTHandler::create(const std::shared_ptr<DBTDevice> & device, const uint16_t clientMTU) {
+    std::shared_ptr<GATTHandler> h( new GATTHandler(device, clientMTU) );
+    h->wbr_self = h;
+    return h;
+}
 
 GATTHandler::~GATTHandler() {
+    stopReactorReader(true /* wait */);
     disconnect(false /* disconnectDevice */, false /* ioErrorCause */);
+    stopWriteQueueWorker(true /* wait */);
+    stopAsyncWorker(true /* wait */);
+    {
+        std::shared_ptr<GATTNotificationExecutor> executor = std::atomic_load(&notificationExecutor);
+        if( nullptr != executor ) {
+            executor->stop(true /* wait */);
+        }
+    }
+    std::atomic_store(&attributeTable, std::shared_ptr<const GATTAttributeTable>());
     services.clear();
 }
 
@@ -292,21 +742,29 @@ bool GATTHandler::connect() {
         return true;
     }
     // Lock to avoid other threads using instance while connecting
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
 
     hasIOError = false;
+    consecutiveReplyTimeouts = 0;
+    abandonedRequests.clear();
+    readMultipleVariableSupported = true;
+    readBlobPipelineSupported = true;
+    if( GATTEnv::NotifyDispatch::DEVICE == getNotifyDispatch() ) {
+        std::atomic_store(&notificationExecutor, GATTNotificationExecutor::create(env.GATT_NOTIFY_QUEUE_CAPACITY, env.GATT_NOTIFY_DROP_OLDEST));
+    }
     DBG_PRINT("GATTHandler::connect: Start: GattHandler[%s], l2cap[%s]: %s",
                 getStateString().c_str(), l2cap.getStateString().c_str(), deviceString.c_str());
 
-    if( !l2cap.connect() || !validateConnected() ) {
+    const uint64_t t0 = getCurrentMicroseconds();
+    connectL2CAPUS = 0;
+    connectMTUUS = 0;
+    if( !l2cap.connect(env.GATT_L2CAP_CONNECT_TIMEOUT) || !validateConnected() ) {
         DBG_PRINT("GATTHandler.connect: Could not connect");
         return false;
     }
 
-    /**
-     * We utilize DBTManager's mgmthandler_sigaction SIGALRM handler,
-     * as we only can install one handler.
-     */
+    if( ( !env.GATT_READER_VIA_HCI || !startHCIReader() ) &&
+        ( ( 0 == env.GATT_READER_REACTOR_THREADS && !env.GATT_READER_EXTERNAL ) || !startReactorReader() ) )
     {
         std::unique_lock<std::mutex> lock(mtx_l2capReaderInit); // RAII-style acquire and relinquish via destructor
 
@@ -321,10 +779,13 @@ bool GATTHandler::connect() {
         }
     }
 
+    const uint64_t t1 = getCurrentMicroseconds();
+    connectL2CAPUS = t1 - t0;
+
     // First point of failure if device exposes no GATT functionality. Allow a longer timeout!
-    serverMTU = exchangeMTU(number(Defaults::MAX_ATT_MTU));
-    usedMTU = std::min(number(Defaults::MAX_ATT_MTU), (int)serverMTU);
-    if( 0 == serverMTU ) {
+    const bool mtuOK = negotiateMTU();
+    connectMTUUS = getCurrentMicroseconds() - t1;
+    if( !mtuOK ) {
         ERR_PRINT("GATTHandler::connect: Zero serverMTU -> disconnect: %s", deviceString.c_str());
         disconnect(true /* disconnectDevice */, false /* ioErrorCause */);
         return false;
@@ -333,6 +794,9 @@ bool GATTHandler::connect() {
 }
 
 bool GATTHandler::disconnect(const bool disconnectDevice, const bool ioErrorCause) {
+    // Remove our channel from the reactor before closing it, not waiting as a callback may wait for mtx_command
+    stopReactorReader(false /* wait */);
+
     // Interrupt GATT's L2CAP ::connect(..), avoiding prolonged hang
     // and pull all underlying l2cap read operations!
     l2cap.disconnect();
@@ -343,11 +807,21 @@ bool GATTHandler::disconnect(const bool disconnectDevice, const bool ioErrorCaus
         // not connected
         DBG_PRINT("GATTHandler::disconnect: Not connected: disconnectDevice %d, ioErrorCause %d: GattHandler[%s], l2cap[%s]: %s",
                   disconnectDevice, ioErrorCause, getStateString().c_str(), l2cap.getStateString().c_str(), deviceString.c_str());
-        characteristicListenerList.clear();
+        removeAllCharacteristicListener();
         return false;
     }
+    // Not waiting for the async worker, as its current job may wait for mtx_command
+    stopAsyncWorker(false /* wait */);
+    stopWriteQueueWorker(false /* wait */);
+    {
+        std::shared_ptr<GATTNotificationExecutor> executor = std::atomic_load(&notificationExecutor);
+        if( nullptr != executor ) {
+            executor->stop(false /* wait */); // ditto, a listener may wait for mtx_command
+        }
+    }
+
     // Lock to avoid other threads using instance while disconnecting
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
 
     hasIOError = false;
     DBG_PRINT("GATTHandler::disconnect: Start: disconnectDevice %d, ioErrorCause %d: GattHandler[%s], l2cap[%s]: %s",
@@ -360,13 +834,16 @@ bool GATTHandler::disconnect(const bool disconnectDevice, const bool ioErrorCaus
     DBG_PRINT("GATTHandler.disconnect: l2capReader[running %d, shallStop %d, isReader %d, tid %p)",
               l2capReaderRunning.load(), l2capReaderShallStop.load(), is_l2capReader, (void*)tid_l2capReader);
     if( l2capReaderRunning ) {
+        // l2cap.disconnect() above already woke up a blocked l2capReader
         l2capReaderShallStop = true;
-        if( !is_l2capReader && 0 != tid_l2capReader ) {
-            int kerr;
-            if( 0 != ( kerr = pthread_kill(tid_l2capReader, SIGALRM) ) ) {
-                ERR_PRINT("GATTHandler::disconnect: pthread_kill %p FAILED: %d", (void*)tid_l2capReader, kerr);
-            }
+    }
+    {
+        std::shared_ptr<HCIHandler> hci = hciReader.lock();
+        if( nullptr != hci ) {
+            hci->removeL2CAPFrameCallback(hciReaderHandle);
         }
+        hciReader.reset();
+        hciReaderHandle = 0;
     }
     removeAllCharacteristicListener();
 
@@ -385,13 +862,46 @@ bool GATTHandler::disconnect(const bool disconnectDevice, const bool ioErrorCaus
     return true;
 }
 
-void GATTHandler::send(const AttPDUMsg & msg) {
+/**
+ * Invokes the given GATTStatus returning implementation,
+ * mapping any unexpected exception to GATTStatus::INTERNAL_ERROR.
+ */
+template<typename Impl>
+static GATTStatus catchGATTStatus(const char * what, const std::string & deviceString, Impl impl) noexcept {
+    try {
+        return impl();
+    } catch (std::exception & e) {
+        ERR_PRINT("%s: Caught exception %s: %s", what, e.what(), deviceString.c_str());
+    } catch (...) {
+        ERR_PRINT("%s: Caught unknown exception: %s", what, deviceString.c_str());
+    }
+    return GATTStatus::INTERNAL_ERROR;
+}
+
+void GATTHandler::throwOnTransportFailure(const GATTStatus status, const char * what, const char* file, int line) const {
+    switch( status ) {
+        case GATTStatus::INVALID_STATE:
+            throw IllegalStateException(std::string(what)+": Invalid IO State to "+deviceString, file, line);
+        case GATTStatus::PDU_TOO_LARGE:
+            throw IllegalArgumentException(std::string(what)+": PDU exceeds usedMTU "+std::to_string(usedMTU)+" to "+deviceString, file, line);
+        case GATTStatus::IO_ERROR:
+        case GATTStatus::WRITE_COUNT_MISMATCH:
+        case GATTStatus::TIMEOUT:
+        case GATTStatus::INTERNAL_ERROR:
+            throw BluetoothException(std::string(what)+": "+getGATTStatusString(status)+" -> "+deviceString, file, line);
+        default: ; // fall through intended
+    }
+}
+
+GATTStatus GATTHandler::sendImpl(const AttPDUMsg & msg) {
     if( !validateConnected() ) {
-        throw IllegalStateException("GATTHandler::send: Invalid IO State: req "+msg.toString()+" to "+deviceString, E_FILE_LINE);
+        ERR_PRINT("GATTHandler::send: Invalid IO State: req %s to %s", msg.toString().c_str(), deviceString.c_str());
+        return GATTStatus::INVALID_STATE;
     }
     if( msg.pdu.getSize() > usedMTU ) {
-        throw IllegalArgumentException("clientMaxMTU "+std::to_string(msg.pdu.getSize())+" > usedMTU "+std::to_string(usedMTU)+
-                                       " to "+deviceString, E_FILE_LINE);
+        ERR_PRINT("GATTHandler::send: clientMaxMTU %d > usedMTU %d: req %s to %s",
+                msg.pdu.getSize(), usedMTU, msg.toString().c_str(), deviceString.c_str());
+        return GATTStatus::PDU_TOO_LARGE;
     }
 
     // Thread safe l2cap.write(..) operation..
@@ -400,32 +910,166 @@ void GATTHandler::send(const AttPDUMsg & msg) {
         ERR_PRINT("GATTHandler::send: l2cap write error -> disconnect: %s to %s", msg.toString().c_str(), deviceString.c_str());
         hasIOError = true;
         disconnect(true /* disconnectDevice */, true /* ioErrorCause */); // state -> Disconnected
-        throw BluetoothException("GATTHandler::send: l2cap write error: req "+msg.toString()+" to "+deviceString, E_FILE_LINE);
+        return GATTStatus::IO_ERROR;
     }
     if( res != msg.pdu.getSize() ) {
         ERR_PRINT("GATTHandler::send: l2cap write count error, %d != %d: %s -> disconnect: %s",
                 res, msg.pdu.getSize(), msg.toString().c_str(), deviceString.c_str());
         hasIOError = true;
         disconnect(true /* disconnectDevice */, true /* ioErrorCause */); // state -> Disconnected
-        throw BluetoothException("GATTHandler::send: l2cap write count error, "+std::to_string(res)+" != "+std::to_string(res)
-                                 +": "+msg.toString()+" -> disconnect: "+deviceString, E_FILE_LINE);
+        return GATTStatus::WRITE_COUNT_MISMATCH;
     }
+    traffic.countOut(msg.pdu.get_uint8(0), res);
+    return GATTStatus::SUCCESS;
 }
 
-std::shared_ptr<const AttPDUMsg> GATTHandler::sendWithReply(const AttPDUMsg & msg, const int timeout) {
-    send( msg );
+void GATTHandler::send(const AttPDUMsg & msg) {
+    throwOnTransportFailure(sendImpl(msg), "GATTHandler::send", E_FILE_LINE);
+}
 
-    // Ringbuffer read is thread safe
-    std::shared_ptr<const AttPDUMsg> res = attPDURing.getBlocking(timeout);
-    if( nullptr == res ) {
-        errno = ETIMEDOUT;
-        ERR_PRINT("GATTHandler::sendWithReply: nullptr result (timeout %d): req %s to %s", timeout, msg.toString().c_str(), deviceString.c_str());
-        disconnect(true /* disconnectDevice */, true /* ioErrorCause */);
-        throw BluetoothException("GATTHandler::sendWithReply: nullptr result (timeout "+std::to_string(timeout)+"): req "+msg.toString()+" to "+deviceString, E_FILE_LINE);
+GATTStatus GATTHandler::receiveReplyImpl(const AttPDUMsg::Opcode reqOpcode, const AttPDUMsg * req, const int timeout0,
+                                         std::shared_ptr<const AttPDUMsg> & res) {
+    uint64_t t0 = getCurrentMilliseconds();
+    int timeout = getReplyTimeout(timeout0);
+    int retries = ( nullptr != req && AttPDUMsg::ATT_EXECUTE_WRITE_REQ != reqOpcode ) ? env.GATT_COMMAND_RETRIES.load() : 0;
+    for(;;) {
+        const int64_t left = timeout - static_cast<int64_t>( getCurrentMilliseconds() - t0 );
+        res = 0 < left ? attPDURing.getBlocking(left) : nullptr;
+        if( nullptr == res ) {
+            errno = ETIMEDOUT;
+            if( 0 < retries ) {
+                // Only one request may be outstanding per bearer (Vol 3 Part F 3.3.2), hence keep waiting w/o resending.
+                retries--;
+                replyRetryCount++;
+                traffic.countRetry();
+                timeout *= env.GATT_COMMAND_RETRY_BACKOFF;
+                WARN_PRINT("GATTHandler::sendWithReply: Timeout, waiting again w/ timeout %d: req %s to %s",
+                           timeout, req->toString().c_str(), deviceString.c_str());
+                t0 = getCurrentMilliseconds();
+                continue;
+            }
+            replyTimeoutCount++;
+            traffic.countTimeout();
+            const std::string reqString = nullptr != req ? req->toString() : AttPDUMsg::getOpcodeString(reqOpcode)+" (pipelined)";
+            const std::string msg = "GATTHandler::sendWithReply: nullptr result (timeout "+std::to_string(timeout)+"): req "+reqString+" to "+deviceString;
+            const int failed = ++consecutiveReplyTimeouts;
+            const int disconnectCount = env.GATT_COMMAND_TIMEOUT_DISCONNECT;
+            if( nullptr != req && failed < disconnectCount ) {
+                // The request stays outstanding, its late reply must not be taken for the reply of a following request.
+                abandonedRequests.push_back(reqOpcode);
+                WARN_PRINT("%s, consecutive timeouts %d < %d, abandoned requests %zu",
+                           msg.c_str(), failed, disconnectCount, abandonedRequests.size());
+                return GATTStatus::TIMEOUT;
+            }
+            // Pipelined requests leave an unknown number of requests outstanding
+            ERR_PRINT("%s, consecutive timeouts %d -> disconnect", msg.c_str(), failed);
+            consecutiveReplyTimeouts = 0;
+            disconnect(true /* disconnectDevice */, true /* ioErrorCause */);
+            return GATTStatus::TIMEOUT;
+        }
+        if( discardAbandonedReply(*res) ) {
+            continue;
+        }
+        if( res->isReplyTo(reqOpcode) ) {
+            consecutiveReplyTimeouts = 0;
+            return GATTStatus::SUCCESS;
+        }
+        WARN_PRINT("GATTHandler::sendWithReply: Discarding stale reply %s, waiting for reply to %s: %s",
+                   res->toString().c_str(), AttPDUMsg::getOpcodeString(reqOpcode).c_str(), deviceString.c_str());
+    }
+}
+
+std::shared_ptr<const AttPDUMsg> GATTHandler::receiveReply(const AttPDUMsg::Opcode reqOpcode, const AttPDUMsg * req, const int timeout) {
+    std::shared_ptr<const AttPDUMsg> res;
+    throwOnTransportFailure(receiveReplyImpl(reqOpcode, req, timeout, res), "GATTHandler::sendWithReply", E_FILE_LINE);
+    return res;
+}
+
+bool GATTHandler::discardAbandonedReply(const AttPDUMsg & pdu) {
+    // ATT replies arrive in request order, hence the oldest abandoned request is answered first
+    if( abandonedRequests.empty() || !pdu.isReplyTo(abandonedRequests.front()) ) {
+        return false;
+    }
+    abandonedRequests.pop_front();
+    consecutiveReplyTimeouts = 0;
+    WARN_PRINT("GATTHandler::sendWithReply: Discarding late reply %s to abandoned request, %zu remaining: %s",
+               pdu.toString().c_str(), abandonedRequests.size(), deviceString.c_str());
+    return true;
+}
+
+void GATTHandler::discardStaleReplies() {
+    std::shared_ptr<const AttPDUMsg> res;
+    while( nullptr != ( res = attPDURing.get() ) ) {
+        if( !discardAbandonedReply(*res) ) {
+            WARN_PRINT("GATTHandler::sendWithReply: Discarding stale reply %s: %s", res->toString().c_str(), deviceString.c_str());
+        }
+    }
+}
+
+GATTStatus GATTHandler::sendWithReplyImpl(const AttPDUMsg & msg, const int timeout, std::shared_ptr<const AttPDUMsg> & res) {
+    flushWriteQueue();
+    discardStaleReplies();
+    const uint64_t t0 = getCurrentMicroseconds();
+    GATTStatus s = sendImpl( msg );
+    if( GATTStatus::SUCCESS != s ) {
+        res = nullptr;
+        return s;
+    }
+    s = receiveReplyImpl(msg.getOpcode(), &msg, timeout, res);
+    if( GATTStatus::SUCCESS == s ) { // unambiguous, as the request is never resent
+        const uint64_t t1 = getCurrentMicroseconds();
+        const uint64_t rtt = t1 > t0 ? t1 - t0 : 0;
+        metricRTT.record(rtt);
+        rttEstimator.addSample(rtt);
+        traffic.addRTT(rtt);
     }
+    return s;
+}
+
+std::shared_ptr<const AttPDUMsg> GATTHandler::sendWithReply(const AttPDUMsg & msg, const int timeout) {
+    std::shared_ptr<const AttPDUMsg> res;
+    throwOnTransportFailure(sendWithReplyImpl(msg, timeout, res), "GATTHandler::sendWithReply", E_FILE_LINE);
     return res;
 }
 
+bool GATTHandler::negotiateMTU() {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const uint16_t mtu0 = clientMTU;
+    // Received PDUs may use the larger MTU right after the server's response
+    rbufferTargetSize = std::max(mtu0, usedMTU);
+    const uint16_t smtu = exchangeMTU(mtu0);
+    if( 0 == smtu ) {
+        rbufferTargetSize = usedMTU;
+        return false;
+    }
+    serverMTU = smtu;
+    usedMTU = std::max(number(Defaults::MIN_ATT_MTU), std::min((int)mtu0, (int)serverMTU));
+    rbufferTargetSize = usedMTU;
+    DBG_PRINT("GATTHandler::negotiateMTU: client %u, server %u -> used %u: %s", mtu0, serverMTU, usedMTU, deviceString.c_str());
+    return true;
+}
+
+void GATTHandler::setClientMTU(const uint16_t mtu) {
+    if( mtu < number(Defaults::MIN_ATT_MTU) || mtu > number(Defaults::MAX_ATT_MTU) ) {
+        throw IllegalArgumentException("clientMTU "+std::to_string(mtu)+" not within ["+
+                std::to_string(number(Defaults::MIN_ATT_MTU))+".."+std::to_string(number(Defaults::MAX_ATT_MTU))+"]", E_FILE_LINE);
+    }
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    clientMTU = mtu;
+}
+
+uint16_t GATTHandler::updateMTU() {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    if( !validateConnected() ) {
+        return 0;
+    }
+    if( !negotiateMTU() ) {
+        WARN_PRINT("GATTHandler::updateMTU: Exchange failed, retaining used MTU %u: %s", usedMTU, deviceString.c_str());
+        return 0;
+    }
+    return usedMTU;
+}
+
 uint16_t GATTHandler::exchangeMTU(const uint16_t clientMaxMTU) {
     /***
      * BT Core Spec v5.2: Vol 3, Part G GATT: 4.3.1 Exchange MTU (Server configuration)
@@ -434,13 +1078,13 @@ uint16_t GATTHandler::exchangeMTU(const uint16_t clientMaxMTU) {
         throw IllegalArgumentException("clientMaxMTU "+std::to_string(clientMaxMTU)+" > ClientMaxMTU "+std::to_string(number(Defaults::MAX_ATT_MTU)), E_FILE_LINE);
     }
     const AttExchangeMTU req(clientMaxMTU);
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
     PERF_TS_T0();
 
     uint16_t mtu = 0;
     DBG_PRINT("GATT send: %s", req.toString().c_str());
 
-    std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, env.GATT_INITIAL_COMMAND_REPLY_TIMEOUT);
+    std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getInitialCommandReplyTimeout());
     if( nullptr != pdu ) {
         if( pdu->getOpcode() == AttPDUMsg::ATT_EXCHANGE_MTU_RSP ) {
             const AttExchangeMTU * p = static_cast<const AttExchangeMTU*>(pdu.get());
@@ -454,7 +1098,31 @@ uint16_t GATTHandler::exchangeMTU(const uint16_t clientMaxMTU) {
     return mtu;
 }
 
+void GATTHandler::updateAttributeTable() {
+    const uuid16_t genericAccess(GattServiceType::GENERIC_ACCESS);
+    const uuid16_t deviceInformation(GattServiceType::DEVICE_INFORMATION);
+    if( env.GATT_VALUE_CACHE_STATIC ) {
+        for(auto it = services.begin(); it != services.end(); it++) {
+            if( genericAccess == *(*it)->type || deviceInformation == *(*it)->type ) {
+                for(auto jt = (*it)->characteristicList.begin(); jt != (*it)->characteristicList.end(); jt++) {
+                    (*jt)->valueCache.setTTL(GATTValueCache::TTL::PERMANENT);
+                }
+            }
+        }
+    }
+    std::shared_ptr<const GATTAttributeTable> table(new GATTAttributeTable(services));
+    serviceChangedHandle = table->getServiceChangedHandle();
+    std::atomic_store(&attributeTable, table);
+}
+
 GATTCharacteristicRef GATTHandler::findCharacterisicsByValueHandle(const uint16_t charValueHandle) {
+    std::shared_ptr<const GATTAttributeTable> table = std::atomic_load(&attributeTable);
+    if( nullptr != table ) {
+        GATTCharacteristicRef decl = table->getCharacteristicByValueHandle(charValueHandle);
+        if( nullptr != decl ) {
+            return decl;
+        }
+    }
     return findCharacterisicsByValueHandle(charValueHandle, services);
 }
 
@@ -478,20 +1146,164 @@ GATTCharacteristicRef GATTHandler::findCharacterisicsByValueHandle(const uint16_
     return nullptr;
 }
 
+GATTCache & GATTHandler::getCache() {
+    /**
+     * Thread safe starting with C++11 6.7, see GATTEnv::get().
+     */
+    static GATTCache cache(GATTEnv::get().GATT_CACHE_DIR);
+    return cache;
+}
+
+bool GATTHandler::readDatabaseHash(POctets & res) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.2 Read Using Characteristic UUID */
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+
+    const AttReadByNTypeReq req(false /* group */, 0x0001, 0xffff, uuid16_t(GattCharacteristicType::DATABASE_HASH));
+    COND_PRINT(env.DEBUG_DATA, "GATT DB HASH send: %s", req.toString().c_str());
+    std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+    COND_PRINT(env.DEBUG_DATA, "GATT DB HASH recv: %s", pdu->toString().c_str());
+    if( pdu->getOpcode() == AttPDUMsg::ATT_READ_BY_TYPE_RSP ) {
+        const AttReadByTypeRsp * p = static_cast<const AttReadByTypeRsp*>(pdu.get());
+        if( 0 < p->getElementCount() && GATTCache::DB_HASH_SIZE == p->getElementValueSize() ) {
+            const AttReadByTypeRsp::Element e = p->getElement(0);
+            res.resize(0);
+            res += TROOctets(e.getValuePtr(), e.getValueSize());
+            return true;
+        }
+    }
+    return false; // e.g. ATT_ERROR_RSP w/ ATTRIBUTE_NOT_FOUND
+}
+
 std::vector<GATTServiceRef> & GATTHandler::discoverCompletePrimaryServices() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    std::atomic_store(&attributeTable, std::shared_ptr<const GATTAttributeTable>()); // stale until rebuilt
+
+    const uint64_t t0 = getCurrentMicroseconds();
+    std::shared_ptr<DBTDevice> device = env.GATT_CACHE ? getDevice() : nullptr;
+    POctets dbHash(GATTCache::DB_HASH_SIZE, 0);
+    bool hasDBHash = false;
+    if( nullptr != device ) {
+        hasDBHash = readDatabaseHash(dbHash);
+        if( getCache().get(device->getAddress(), hasDBHash ? &dbHash : nullptr, device, services) ) {
+            cacheDBHash = dbHash;
+            updateAttributeTable();
+            DBG_PRINT("GATTHandler::discoverCompletePrimaryServices: Restored %zd services from cache: %s",
+                    services.size(), deviceString.c_str());
+            metricDiscovery.recordSince(t0, true);
+            return services;
+        }
+    }
     if( !discoverPrimaryServices(services) ) {
+        metricDiscovery.recordSince(t0, false);
         return services;
     }
-    for(auto it = services.begin(); it != services.end(); it++) {
-        GATTServiceRef primSrv = *it;
-        if( discoverCharacteristics(primSrv) ) {
-            discoverDescriptors(primSrv);
+    if( env.GATT_DISCOVER_BATCHED ) {
+        if( discoverAllCharacteristics(services) ) {
+            discoverAllDescriptors(services);
+        }
+    } else {
+        for(auto it = services.begin(); it != services.end(); it++) {
+            GATTServiceRef primSrv = *it;
+            if( discoverCharacteristics(primSrv) ) {
+                discoverDescriptors(primSrv);
+            }
         }
     }
+    updateAttributeTable();
+    if( nullptr != device && 0 < services.size() ) {
+        getCache().put(device->getAddress(), dbHash /* empty if none */, services);
+        cacheDBHash = dbHash;
+    }
+    metricDiscovery.recordSince(t0, true);
     return services;
 }
 
+GATTServiceRef GATTHandler::findService(const uuid_t & type) {
+    /***
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.4.2 Discover Primary Service by Service UUID
+     *
+     * This sub-procedure is complete when the ATT_ERROR_RSP PDU is received
+     * and the error code is set to Attribute Not Found.
+     */
+    const uuid16_t groupType = uuid16_t(GattAttributeType::PRIMARY_SERVICE);
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    for(auto it = services.begin(); it != services.end(); it++) {
+        if( *(*it)->type == type ) {
+            return *it;
+        }
+    }
+    std::shared_ptr<DBTDevice> device = getDevice();
+    if( nullptr == device ) {
+        ERR_PRINT("GATT findService: Device destructed: %s", deviceString.c_str());
+        return nullptr;
+    }
+    if( type.getTypeSize() != uuid_t::TypeSize::UUID16_SZ && type.getTypeSize() != uuid_t::TypeSize::UUID128_SZ ) {
+        ERR_PRINT("GATT findService: Only UUID16 and UUID128 allowed: %s - %s", type.toString().c_str(), deviceString.c_str());
+        return nullptr;
+    }
+    PERF_TS_T0();
+
+    const AttFindByTypeValueReq req(0x0001, 0xffff, groupType, type);
+    COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV find send: %s", req.toString().c_str());
+
+    GATTServiceRef res = nullptr;
+    std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+    if( nullptr != pdu ) {
+        COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV find recv: %s", pdu->toString().c_str());
+        if( pdu->getOpcode() == AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_RSP ) {
+            const AttFindByTypeValueRsp * p = static_cast<const AttFindByTypeValueRsp*>(pdu.get());
+            // first instance only, the service type is assumed unique
+            res = GATTServiceRef( new GATTService( device, true,
+                    p->getElementFoundHandle(0), // start-handle
+                    p->getElementGroupEndHandle(0), // end-handle
+                    req.pdu.get_uuid(req.getPDUValueOffset(), type.getTypeSize()) ) );
+            auto it = services.begin();
+            while( it != services.end() && (*it)->startHandle < res->startHandle ) {
+                it++;
+            }
+            services.insert(it, res); // keep services sorted by handle
+            COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV found: %s", res->toString().c_str());
+        } else if( pdu->getOpcode() != AttPDUMsg::ATT_ERROR_RSP ) {
+            WARN_PRINT("GATT findService unexpected reply %s", pdu->toString().c_str());
+        }
+    } else {
+        ERR_PRINT("GATT findService send failed: %s - %s", req.toString().c_str(), deviceString.c_str());
+    }
+    PERF_TS_TD("GATT findService");
+
+    return res;
+}
+
+GATTCharacteristicRef GATTHandler::findCharacteristic(GATTServiceRef service, const uuid_t & value_type) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    if( nullptr == service ) {
+        return nullptr;
+    }
+    if( 0 == service->characteristicList.size() ) {
+        if( !discoverCharacteristics(service) ) {
+            return nullptr;
+        }
+        updateAttributeTable();
+    }
+    const int charCount = service->characteristicList.size();
+    for(int i=0; i<charCount; i++) {
+        GATTCharacteristicRef c = service->characteristicList[i];
+        if( *c->value_type != value_type ) {
+            continue;
+        }
+        if( 0 == c->descriptorList.size() ) {
+            // descriptors are located between the value handle and the next characteristic declaration
+            const uint16_t endHandle = i+1 < charCount ? service->characteristicList[i+1]->handle - 1 : service->endHandle;
+            if( c->value_handle < endHandle ) {
+                std::vector<GATTServiceRef> scope { service };
+                discoverDescriptorRange(scope, c->value_handle + 1, endHandle);
+            }
+        }
+        return c;
+    }
+    return nullptr;
+}
+
 bool GATTHandler::discoverPrimaryServices(std::vector<GATTServiceRef> & result) {
     /***
      * BT Core Spec v5.2: Vol 3, Part G GATT: 4.4.1 Discover All Primary Services
@@ -501,7 +1313,7 @@ bool GATTHandler::discoverPrimaryServices(std::vector<GATTServiceRef> & result)
      * in the Read by Type Group Response is 0xFFFF.
      */
     const uuid16_t groupType = uuid16_t(GattAttributeType::PRIMARY_SERVICE);
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
     PERF_TS_T0();
 
     std::shared_ptr<DBTDevice> device = getDevice();
@@ -516,22 +1328,21 @@ bool GATTHandler::discoverPrimaryServices(std::vector<GATTServiceRef> & result)
         const AttReadByNTypeReq req(true /* group */, startHandle, 0xffff, groupType);
         COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV discover send: %s", req.toString().c_str());
 
-        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, env.GATT_READ_COMMAND_REPLY_TIMEOUT);
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
         if( nullptr != pdu ) {
             COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV discover recv: %s", pdu->toString().c_str());
             if( pdu->getOpcode() == AttPDUMsg::ATT_READ_BY_GROUP_TYPE_RSP ) {
                 const AttReadByGroupTypeRsp * p = static_cast<const AttReadByGroupTypeRsp*>(pdu.get());
                 const int count = p->getElementCount();
 
-                for(int i=0; i<count; i++) {
-                    const int ePDUOffset = p->getElementPDUOffset(i);
-                    const int esz = p->getElementTotalSize();
+                int i=0;
+                for(const AttElementSlice e : *p) {
                     result.push_back( GATTServiceRef( new GATTService( device, true,
-                            p->pdu.get_uint16(ePDUOffset), // start-handle
-                            p->pdu.get_uint16(ePDUOffset + 2), // end-handle
-                            p->pdu.get_uuid( ePDUOffset + 2 + 2, uuid_t::toTypeSize(esz-2-2) ) // uuid
+                            e.getHandle(), // start-handle
+                            e.getEndHandle(), // end-handle
+                            e.getUUID().toUUID() // uuid
                         ) ) );
-                    COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV discovered[%d/%d]: %s", i, count, result.at(result.size()-1)->toString().c_str());
+                    COND_PRINT(env.DEBUG_DATA, "GATT PRIM SRV discovered[%d/%d]: %s", i++, count, result.at(result.size()-1)->toString().c_str());
                 }
                 startHandle = p->getElementEndHandle(count-1);
                 if( startHandle < 0xffff ) {
@@ -566,7 +1377,7 @@ bool GATTHandler::discoverCharacteristics(GATTServiceRef & service) {
      * </p>
      */
     const uuid16_t characteristicTypeReq = uuid16_t(GattAttributeType::CHARACTERISTIC);
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
     COND_PRINT(env.DEBUG_DATA, "GATT discoverCharacteristics Service: %s", service->toString().c_str());
 
     PERF_TS_T0();
@@ -578,26 +1389,25 @@ bool GATTHandler::discoverCharacteristics(GATTServiceRef & service) {
         const AttReadByNTypeReq req(false /* group */, handle, service->endHandle, characteristicTypeReq);
         COND_PRINT(env.DEBUG_DATA, "GATT C discover send: %s", req.toString().c_str());
 
-        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, env.GATT_READ_COMMAND_REPLY_TIMEOUT);
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
         if( nullptr != pdu ) {
             COND_PRINT(env.DEBUG_DATA, "GATT C discover recv: %s", pdu->toString().c_str());
             if( pdu->getOpcode() == AttPDUMsg::ATT_READ_BY_TYPE_RSP ) {
                 const AttReadByTypeRsp * p = static_cast<const AttReadByTypeRsp*>(pdu.get());
                 const int e_count = p->getElementCount();
 
-                for(int e_iter=0; e_iter<e_count; e_iter++) {
+                int e_iter=0;
+                for(const AttElementSlice e : *p) {
                     // handle: handle for the Characteristics declaration
                     // value: Characteristics Property, Characteristics Value Handle _and_ Characteristics UUID
-                    const int ePDUOffset = p->getElementPDUOffset(e_iter);
-                    const int esz = p->getElementTotalSize();
                     service->characteristicList.push_back( GATTCharacteristicRef( new GATTCharacteristic(
                         service,
-                        p->pdu.get_uint16(ePDUOffset), // Characteristics's Service Handle
-                        p->getElementHandle(e_iter), // Characteristic Handle
-                        static_cast<GATTCharacteristic::PropertyBitVal>(p->pdu.get_uint8(ePDUOffset  + 2)), // Characteristics Property
-                        p->pdu.get_uint16(ePDUOffset + 2 + 1), // Characteristics Value Handle
-                        p->pdu.get_uuid(ePDUOffset   + 2 + 1 + 2, uuid_t::toTypeSize(esz-2-1-2) ) ) ) ); // Characteristics Value Type UUID
-                    COND_PRINT(env.DEBUG_DATA, "GATT C discovered[%d/%d]: %s", e_iter, e_count, service->characteristicList.at(service->characteristicList.size()-1)->toString().c_str());
+                        e.getHandle(), // Characteristics's Service Handle
+                        e.getHandle(), // Characteristic Handle
+                        static_cast<GATTCharacteristic::PropertyBitVal>(e.get_uint8(2)), // Characteristics Property
+                        e.get_uint16(2 + 1), // Characteristics Value Handle
+                        e.getUUID(2 + 1 + 2).toUUID() ) ) ); // Characteristics Value Type UUID
+                    COND_PRINT(env.DEBUG_DATA, "GATT C discovered[%d/%d]: %s", e_iter++, e_count, service->characteristicList.at(service->characteristicList.size()-1)->toString().c_str());
                 }
                 handle = p->getElementHandle(e_count-1); // Last Characteristic Handle
                 if( handle < service->endHandle ) {
@@ -631,7 +1441,7 @@ bool GATTHandler::discoverDescriptors(GATTServiceRef & service) {
      * </p>
      */
     COND_PRINT(env.DEBUG_DATA, "GATT discoverDescriptors Service: %s", service->toString().c_str());
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
     PERF_TS_T0();
 
     bool done=false;
@@ -653,7 +1463,7 @@ bool GATTHandler::discoverDescriptors(GATTServiceRef & service) {
             const AttFindInfoReq req(cd_handle_iter, cd_handle_end);
             COND_PRINT(env.DEBUG_DATA, "GATT CD discover send: %s", req.toString().c_str());
 
-            std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, env.GATT_READ_COMMAND_REPLY_TIMEOUT);
+            std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
             if( nullptr == pdu ) {
                 ERR_PRINT("GATT discoverDescriptors send failed: %s - %s", req.toString().c_str(), deviceString.c_str());
                 done = true;
@@ -665,13 +1475,14 @@ bool GATTHandler::discoverDescriptors(GATTServiceRef & service) {
                 const AttFindInfoRsp * p = static_cast<const AttFindInfoRsp*>(pdu.get());
                 const int e_count = p->getElementCount();
 
-                for(int e_iter=0; e_iter<e_count; e_iter++) {
+                int e_iter=0;
+                for(const AttElementSlice e : *p) {
                     // handle: handle of Characteristic Descriptor.
                     // value: Characteristic Descriptor UUID.
-                    const uint16_t cd_handle = p->getElementHandle(e_iter);
-                    const std::shared_ptr<const uuid_t> cd_uuid = p->getElementValue(e_iter);
+                    const int e_idx = e_iter++;
+                    const uint16_t cd_handle = e.getHandle();
 
-                    std::shared_ptr<GATTDescriptor> cd( new GATTDescriptor(charDecl, cd_uuid, cd_handle) );
+                    std::shared_ptr<GATTDescriptor> cd( new GATTDescriptor(charDecl, e.getUUID().toUUID(), cd_handle) );
                     if( cd_handle <= charDecl->value_handle || cd_handle > cd_handle_end ) { // should never happen!
                         ERR_PRINT("GATT discoverDescriptors CD handle %s not in range ]%s..%s]: %s - %s",
                                 uint16HexString(cd_handle).c_str(),
@@ -691,7 +1502,7 @@ bool GATTHandler::discoverDescriptors(GATTServiceRef & service) {
                         charDecl->clientCharacteristicsConfigIndex = charDecl->descriptorList.size();
                     }
                     charDecl->descriptorList.push_back(cd);
-                    COND_PRINT(env.DEBUG_DATA, "GATT CD discovered[%d/%d]: %s", e_iter, e_count, cd->toString().c_str());
+                    COND_PRINT(env.DEBUG_DATA, "GATT CD discovered[%d/%d]: %s", e_idx, e_count, cd->toString().c_str());
                 }
                 cd_handle_iter = p->getElementHandle(e_count-1); // Last Descriptor Handle
                 if( cd_handle_iter < cd_handle_end ) {
@@ -712,27 +1523,276 @@ bool GATTHandler::discoverDescriptors(GATTServiceRef & service) {
     return service->characteristicList.size() > 0;
 }
 
+static GATTServiceRef findEnclosingService(std::vector<GATTServiceRef> & services, const uint16_t handle) {
+    for(auto it = services.begin(); it != services.end(); it++) {
+        if( (*it)->startHandle <= handle && handle <= (*it)->endHandle ) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+bool GATTHandler::discoverAllCharacteristics(std::vector<GATTServiceRef> & services) {
+    /***
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.6.1 Discover All Characteristics of a Service,
+     * applied to the handle range of all services at once.
+     */
+    const uuid16_t characteristicTypeReq = uuid16_t(GattAttributeType::CHARACTERISTIC);
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    if( 0 == services.size() ) {
+        return false;
+    }
+    uint16_t startHandle = 0xffff, endHandle = 0x0001;
+    for(auto it = services.begin(); it != services.end(); it++) {
+        (*it)->characteristicList.clear();
+        startHandle = std::min(startHandle, (*it)->startHandle);
+        endHandle = std::max(endHandle, (*it)->endHandle);
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT discoverAllCharacteristics: %zd services, handles %s..%s",
+            services.size(), uint16HexString(startHandle).c_str(), uint16HexString(endHandle).c_str());
+
+    PERF_TS_T0();
+
+    int count = 0;
+    bool done=false;
+    uint16_t handle=startHandle;
+    while(!done) {
+        const AttReadByNTypeReq req(false /* group */, handle, endHandle, characteristicTypeReq);
+        COND_PRINT(env.DEBUG_DATA, "GATT C discover send: %s", req.toString().c_str());
+
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+        if( nullptr != pdu ) {
+            COND_PRINT(env.DEBUG_DATA, "GATT C discover recv: %s", pdu->toString().c_str());
+            if( pdu->getOpcode() == AttPDUMsg::ATT_READ_BY_TYPE_RSP ) {
+                const AttReadByTypeRsp * p = static_cast<const AttReadByTypeRsp*>(pdu.get());
+                const int e_count = p->getElementCount();
+
+                int e_iter=0;
+                for(const AttElementSlice e : *p) {
+                    const int e_idx = e_iter++;
+                    const uint16_t c_handle = e.getHandle();
+                    GATTServiceRef service = findEnclosingService(services, c_handle);
+                    if( nullptr == service ) {
+                        WARN_PRINT("GATT discoverAllCharacteristics: Characteristic handle %s not within any service - %s",
+                                uint16HexString(c_handle).c_str(), deviceString.c_str());
+                        continue;
+                    }
+                    // handle: handle for the Characteristics declaration
+                    // value: Characteristics Property, Characteristics Value Handle _and_ Characteristics UUID
+                    service->characteristicList.push_back( GATTCharacteristicRef( new GATTCharacteristic(
+                        service,
+                        c_handle, // Characteristics's Service Handle
+                        c_handle, // Characteristic Handle
+                        static_cast<GATTCharacteristic::PropertyBitVal>(e.get_uint8(2)), // Characteristics Property
+                        e.get_uint16(2 + 1), // Characteristics Value Handle
+                        e.getUUID(2 + 1 + 2).toUUID() ) ) ); // Characteristics Value Type UUID
+                    count++;
+                    COND_PRINT(env.DEBUG_DATA, "GATT C discovered[%d/%d]: %s", e_idx, e_count, service->characteristicList.at(service->characteristicList.size()-1)->toString().c_str());
+                }
+                handle = p->getElementHandle(e_count-1); // Last Characteristic Handle
+                if( handle < endHandle ) {
+                    handle++;
+                } else {
+                    done = true; // OK by spec: End of communication
+                }
+            } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
+                done = true; // OK by spec: End of communication
+            } else {
+                WARN_PRINT("GATT discoverAllCharacteristics unexpected reply %s", pdu->toString().c_str());
+                done = true;
+            }
+        } else {
+            ERR_PRINT("GATT discoverAllCharacteristics send failed: %s - %s", req.toString().c_str(), deviceString.c_str());
+            for(auto it = services.begin(); it != services.end(); it++) {
+                (*it)->characteristicList.clear();
+            }
+            count = 0;
+            done = true;
+        }
+    }
+
+    PERF_TS_TD("GATT discoverAllCharacteristics");
+
+    return count > 0;
+}
+
+bool GATTHandler::discoverAllDescriptors(std::vector<GATTServiceRef> & services) {
+    /***
+     * BT Core Spec v5.2: Vol 3, Part G GATT: 4.7.1 Discover All Characteristic Descriptors,
+     * applied to the handle range of all services at once.
+     * <p>
+     * The ATT_FIND_INFORMATION_RSP covers all attributes within the range,
+     * hence service, include and characteristic declarations as well as characteristic values are skipped.
+     * </p>
+     */
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    uint16_t startHandle = 0xffff, endHandle = 0x0001;
+    for(auto it = services.begin(); it != services.end(); it++) {
+        for(auto itc = (*it)->characteristicList.begin(); itc != (*it)->characteristicList.end(); itc++) {
+            (*itc)->clearDescriptors();
+            startHandle = std::min(startHandle, (*itc)->value_handle);
+            endHandle = std::max(endHandle, (*it)->endHandle);
+        }
+    }
+    if( startHandle >= endHandle ) {
+        return false; // no characteristics or no room for descriptors
+    }
+    PERF_TS_T0();
+    // Start @ first Characteristic Value Handle + 1
+    const bool res = discoverDescriptorRange(services, startHandle+1, endHandle);
+    PERF_TS_TD("GATT discoverAllDescriptors");
+    return res;
+}
+
+bool GATTHandler::discoverDescriptorRange(std::vector<GATTServiceRef> & services, const uint16_t startHandle, const uint16_t endHandle) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    COND_PRINT(env.DEBUG_DATA, "GATT discoverDescriptorRange: handles %s..%s",
+            uint16HexString(startHandle).c_str(), uint16HexString(endHandle).c_str());
+
+    bool done=false;
+    uint16_t cd_handle_iter = startHandle;
+    while( !done && cd_handle_iter <= endHandle ) {
+        const AttFindInfoReq req(cd_handle_iter, endHandle);
+        COND_PRINT(env.DEBUG_DATA, "GATT CD discover send: %s", req.toString().c_str());
+
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+        if( nullptr == pdu ) {
+            ERR_PRINT("GATT discoverDescriptorRange send failed: %s - %s", req.toString().c_str(), deviceString.c_str());
+            return false;
+        }
+        COND_PRINT(env.DEBUG_DATA, "GATT CD discover recv: %s", pdu->toString().c_str());
+
+        if( pdu->getOpcode() == AttPDUMsg::ATT_FIND_INFORMATION_RSP ) {
+            const AttFindInfoRsp * p = static_cast<const AttFindInfoRsp*>(pdu.get());
+            const int e_count = p->getElementCount();
+
+            int e_iter=0;
+            for(const AttElementSlice e : *p) {
+                // handle: handle of Characteristic Descriptor.
+                // value: Characteristic Descriptor UUID.
+                const int e_idx = e_iter++;
+                const uint16_t cd_handle = e.getHandle();
+
+                if( uuid_t::TypeSize::UUID16_SZ == e.getValueSize() ) {
+                    const uint16_t t = e.get_uint16(2);
+                    if( GattAttributeType::PRIMARY_SERVICE <= t && t <= GattAttributeType::CHARACTERISTIC ) {
+                        continue; // service, include or characteristic declaration
+                    }
+                }
+                GATTServiceRef service = findEnclosingService(services, cd_handle);
+                if( nullptr == service ) {
+                    continue;
+                }
+                // enclosing characteristic: last declaration before cd_handle within the service
+                GATTCharacteristicRef charDecl = nullptr;
+                for(auto itc = service->characteristicList.begin(); itc != service->characteristicList.end() && (*itc)->handle < cd_handle; itc++) {
+                    charDecl = *itc;
+                }
+                if( nullptr == charDecl || cd_handle <= charDecl->value_handle ) {
+                    continue; // characteristic value or attribute preceding the first characteristic
+                }
+                std::shared_ptr<GATTDescriptor> cd( new GATTDescriptor(charDecl, e.getUUID().toUUID(), cd_handle) );
+                if( !readDescriptorValue(*cd, 0) ) {
+                    ERR_PRINT("GATT discoverDescriptorRange readDescriptorValue failed: %s . %s - %s",
+                            req.toString().c_str(), cd->toString().c_str(), deviceString.c_str());
+                    return false;
+                }
+                if( cd->isClientCharacteristicConfiguration() ) {
+                    charDecl->clientCharacteristicsConfigIndex = charDecl->descriptorList.size();
+                }
+                charDecl->descriptorList.push_back(cd);
+                COND_PRINT(env.DEBUG_DATA, "GATT CD discovered[%d/%d]: %s", e_idx, e_count, cd->toString().c_str());
+            }
+            cd_handle_iter = p->getElementHandle(e_count-1); // Last Attribute Handle
+            if( cd_handle_iter < endHandle ) {
+                cd_handle_iter++;
+            } else {
+                done = true; // OK by spec: End of communication
+            }
+        } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
+            done = true; // OK by spec: End of communication
+        } else {
+            WARN_PRINT("GATT discoverDescriptorRange unexpected opcode reply %s", pdu->toString().c_str());
+            done = true;
+        }
+    }
+    return true;
+}
+
 bool GATTHandler::readDescriptorValue(GATTDescriptor & desc, int expectedLength) {
     COND_PRINT(env.DEBUG_DATA, "GATTHandler::readDescriptorValue expLen %d, desc %s", expectedLength, desc.toString().c_str());
-    return readValue(desc.handle, desc.value, expectedLength);
+    if( desc.valueCache.get(desc.value) ) {
+        // appended like a read value, see readCharacteristicValue()
+        COND_PRINT(env.DEBUG_DATA, "GATTHandler::readDescriptorValue cached: %s", desc.toString().c_str());
+        return true;
+    }
+    const int size0 = desc.value.getSize();
+    const bool res = readValue(desc.handle, desc.value, expectedLength);
+    if( res && 0 != expectedLength ) { // complete value only
+        desc.valueCache.put(TROOctets(desc.value.get_ptr() + size0, desc.value.getSize() - size0), getCurrentMilliseconds());
+    }
+    return res;
 }
 
-bool GATTHandler::readCharacteristicValue(const GATTCharacteristic & decl, POctets & res, int expectedLength) {
+GATTStatus GATTHandler::readCharacteristicValueImpl(const GATTCharacteristic & decl, POctets & res, int expectedLength) {
     COND_PRINT(env.DEBUG_DATA, "GATTHandler::readCharacteristicValue expLen %d, decl %s", expectedLength, decl.toString().c_str());
-    return readValue(decl.value_handle, res, expectedLength);
+    if( decl.valueCache.get(res) ) {
+        COND_PRINT(env.DEBUG_DATA, "GATTHandler::readCharacteristicValue cached: %s", res.toString().c_str());
+        return GATTStatus::SUCCESS;
+    }
+    const int size0 = res.getSize();
+    const int lastLength = decl.valueLength.load(std::memory_order_relaxed);
+    if( 0 > expectedLength && 0 < lastLength && res.getCapacity() < size0 + lastLength ) {
+        res.recapacity( size0 + lastLength ); // presize for the likely unchanged length
+    }
+    const GATTStatus status = readValueImpl(decl.value_handle, res, expectedLength);
+    if( GATTStatus::SUCCESS == status && 0 != expectedLength ) { // complete value only
+        decl.valueLength.store(res.getSize() - size0, std::memory_order_relaxed);
+        decl.valueCache.put(TROOctets(res.get_ptr() + size0, res.getSize() - size0), getCurrentMilliseconds());
+    }
+    return status;
+}
+
+bool GATTHandler::readCharacteristicValue(const GATTCharacteristic & decl, POctets & res, int expectedLength) {
+    const GATTStatus status = readCharacteristicValueImpl(decl, res, expectedLength);
+    throwOnTransportFailure(status, "GATTHandler::readCharacteristicValue", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
+}
+
+GATTStatus GATTHandler::readCharacteristicValueStatus(const GATTCharacteristic & decl, POctets & res, int expectedLength) noexcept {
+    return catchGATTStatus("GATTHandler::readCharacteristicValue", deviceString, [&]() {
+        return readCharacteristicValueImpl(decl, res, expectedLength);
+    });
 }
 
 bool GATTHandler::readValue(const uint16_t handle, POctets & res, int expectedLength) {
+    const GATTStatus status = readValueImpl(handle, res, expectedLength);
+    throwOnTransportFailure(status, "GATTHandler::readValue", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
+}
+
+GATTStatus GATTHandler::readValueStatus(const uint16_t handle, POctets & res, int expectedLength) noexcept {
+    return catchGATTStatus("GATTHandler::readValue", deviceString, [&]() {
+        return readValueImpl(handle, res, expectedLength);
+    });
+}
+
+GATTStatus GATTHandler::readValueImpl(const uint16_t handle, POctets & res, int expectedLength) {
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.1 Read Characteristic Value */
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.3 Read Long Characteristic Value */
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const uint64_t t0 = getCurrentMicroseconds();
     PERF2_TS_T0();
 
     bool done=false;
     int offset=0;
+    GATTStatus status = GATTStatus::SUCCESS; // last failure
 
     COND_PRINT(env.DEBUG_DATA, "GATTHandler::readValue expLen %d, handle %s", expectedLength, uint16HexString(handle).c_str());
 
+    if( 0 < expectedLength && res.getCapacity() < res.getSize() + expectedLength ) {
+        res.recapacity( res.getSize() + expectedLength ); // assemble in place
+    }
     while(!done) {
         if( 0 < expectedLength && expectedLength <= offset ) {
             break; // done
@@ -740,19 +1800,27 @@ bool GATTHandler::readValue(const uint16_t handle, POctets & res, int expectedLe
             break; // done w/ only one request
         } // else 0 > expectedLength: implicit
 
+        if( 0 < offset && 1 < readBlobWindow && readBlobPipelineSupported ) {
+            bool ended = false;
+            status = readLongValuePipelined(handle, res, offset, expectedLength, ended);
+            if( GATTStatus::SUCCESS != status || ended ) {
+                break; // done or transport failure
+            } // else continue stop-and-wait at offset
+        }
+
         std::shared_ptr<const AttPDUMsg> pdu = nullptr;
 
         if( 0 == offset ) {
             const AttReadReq req (handle);
             COND_PRINT(env.DEBUG_DATA, "GATT RV send: %s", req.toString().c_str());
-            pdu = sendWithReply(req, env.GATT_READ_COMMAND_REPLY_TIMEOUT);
+            status = sendWithReplyImpl(req, getReadCommandReplyTimeout(), pdu);
         } else {
             const AttReadBlobReq req (handle, offset);
             COND_PRINT(env.DEBUG_DATA, "GATT RV send: %s", req.toString().c_str());
-            pdu = sendWithReply(req, env.GATT_READ_COMMAND_REPLY_TIMEOUT);
+            status = sendWithReplyImpl(req, getReadCommandReplyTimeout(), pdu);
         }
 
-        if( nullptr != pdu ) {
+        if( GATTStatus::SUCCESS == status ) {
             COND_PRINT(env.DEBUG_DATA, "GATT RV recv: %s", pdu->toString().c_str());
             if( pdu->getOpcode() == AttPDUMsg::ATT_READ_RSP ) {
                 const AttReadRsp * p = static_cast<const AttReadRsp*>(pdu.get());
@@ -788,20 +1856,643 @@ bool GATTHandler::readValue(const uint16_t handle, POctets & res, int expectedLe
                     done = true; // OK by spec: No more data - end of communication
                 } else {
                     WARN_PRINT("GATT readValue unexpected error %s", pdu->toString().c_str());
+                    status = GATTStatus::ERROR_RSP;
                     done = true;
                 }
             } else {
                 WARN_PRINT("GATT readValue unexpected reply %s", pdu->toString().c_str());
+                status = GATTStatus::UNEXPECTED_REPLY;
                 done = true;
             }
         } else {
-            ERR_PRINT("GATT readValue send failed: handle %u, offset %d: %s", handle, offset, deviceString.c_str());
+            ERR_PRINT("GATT readValue send failed: %s, handle %u, offset %d: %s",
+                    getGATTStatusString(status).c_str(), handle, offset, deviceString.c_str());
             done = true;
         }
     }
     PERF2_TS_TD("GATT readValue");
 
-    return offset > 0;
+    metricRead.recordSince(t0, offset > 0);
+    if( isGATTTransportFailure(status) ) {
+        return status;
+    }
+    // A partially read value is reported as read, an empty value as failed
+    return offset > 0 ? GATTStatus::SUCCESS : ( GATTStatus::SUCCESS != status ? status : GATTStatus::INVALID_VALUE );
+}
+
+GATTStatus GATTHandler::readLongValuePipelined(const uint16_t handle, POctets & res, int & offset, const int expectedLength, bool & done) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.3 Read Long Characteristic Value, pipelined */
+    const int maxChunkSize = usedMTU - 1; // opcode
+    int sendOffset = offset; // next offset to request
+    int outstanding = 0;
+    bool ended = false;      // end of value reached
+    bool rejected = false;   // server rejected pipelining
+
+    if( 0 > expectedLength && res.getCapacity() < res.getSize() + number(Defaults::MAX_ATT_MTU) - offset ) {
+        res.recapacity( res.getSize() + number(Defaults::MAX_ATT_MTU) - offset ); // Maximum length of an attribute value
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT RVP handle %s, offset %d, expLen %d, window %d",
+            uint16HexString(handle).c_str(), offset, expectedLength, readBlobWindow);
+    flushWriteQueue();
+    discardStaleReplies();
+
+    for(;;) {
+        // Fill the window of outstanding blob requests
+        while( !ended && !rejected && outstanding < readBlobWindow &&
+               ( 0 > expectedLength || sendOffset < expectedLength ) &&
+               sendOffset < number(Defaults::MAX_ATT_MTU) )
+        {
+            const AttReadBlobReq req (handle, sendOffset);
+            COND_PRINT(env.DEBUG_DATA, "GATT RVP send: %s", req.toString().c_str());
+            const GATTStatus s = sendImpl( req );
+            if( GATTStatus::SUCCESS != s ) {
+                return s;
+            }
+            sendOffset += maxChunkSize;
+            outstanding++;
+        }
+        if( 0 == outstanding ) {
+            break;
+        }
+        std::shared_ptr<const AttPDUMsg> pdu;
+        const GATTStatus s = receiveReplyImpl(AttPDUMsg::ATT_READ_BLOB_REQ, nullptr /* pipelined */, getReadCommandReplyTimeout(), pdu);
+        if( GATTStatus::SUCCESS != s ) {
+            return s;
+        }
+        outstanding--;
+        COND_PRINT(env.DEBUG_DATA, "GATT RVP recv: %s", pdu->toString().c_str());
+        if( ended || rejected ) {
+            continue; // drain replies beyond the end or after a rejection
+        }
+        if( pdu->getOpcode() == AttPDUMsg::ATT_READ_BLOB_RSP ) {
+            const AttReadBlobRsp * p = static_cast<const AttReadBlobRsp*>(pdu.get());
+            const TOctetSlice & v = p->getValue();
+            res += v;
+            offset += v.getSize();
+            if( p->getPDUValueSize() < p->getMaxPDUValueSize(usedMTU) ) {
+                ended = true; // No full ATT_MTU PDU used, incl. zero - end of communication
+            }
+        } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
+            const AttErrorRsp * p = static_cast<const AttErrorRsp *>(pdu.get());
+            if( AttErrorRsp::ATTRIBUTE_NOT_LONG == p->getErrorCode() || AttErrorRsp::INVALID_OFFSET == p->getErrorCode() ) {
+                ended = true; // OK by spec: Requested offset beyond the value - end of communication
+            } else {
+                WARN_PRINT("GATT readValue pipelined error at offset %d, falling back to stop-and-wait: %s", offset, pdu->toString().c_str());
+                rejected = true;
+            }
+        } else {
+            WARN_PRINT("GATT readValue pipelined unexpected reply at offset %d, falling back to stop-and-wait: %s", offset, pdu->toString().c_str());
+            rejected = true;
+        }
+    }
+    if( rejected ) {
+        readBlobPipelineSupported = false;
+        done = false;
+    } else {
+        done = ended || ( 0 < expectedLength && expectedLength <= offset ) || number(Defaults::MAX_ATT_MTU) <= offset;
+    }
+    return GATTStatus::SUCCESS;
+}
+
+void GATTHandler::asyncWorkerImpl() {
+    for(;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx_async); // RAII-style acquire and relinquish via destructor
+            while( !asyncWorkerShallStop && asyncJobs.empty() ) {
+                cv_async.wait(lock);
+            }
+            if( asyncWorkerShallStop ) {
+                break;
+            }
+            job = asyncJobs.front();
+            asyncJobs.pop_front();
+        }
+        job();
+    }
+    DBG_PRINT("GATTHandler::asyncWorker: Ended: %s", deviceString.c_str());
+}
+
+void GATTHandler::postAsync(std::function<void()> job) {
+    if( !validateConnected() ) {
+        throw IllegalStateException("GATTHandler::postAsync: Invalid IO State: "+deviceString, E_FILE_LINE);
+    }
+    std::thread stale;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_async); // RAII-style acquire and relinquish via destructor
+        if( asyncWorkerShallStop && asyncWorker.joinable() ) {
+            if( asyncWorker.get_id() == std::this_thread::get_id() ) {
+                // stopped by a previous disconnect from within the worker: keep it, resuming after its current job
+                asyncWorkerShallStop = false;
+            } else {
+                stale.swap(asyncWorker); // stopped by a previous disconnect, ending after its current job
+            }
+        }
+    }
+    if( stale.joinable() ) {
+        stale.join();
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mtx_async); // RAII-style acquire and relinquish via destructor
+        if( !asyncWorker.joinable() ) {
+            asyncWorkerShallStop = false;
+            asyncWorker = std::thread(&GATTHandler::asyncWorkerImpl, this);
+        }
+        asyncJobs.push_back(job);
+    }
+    cv_async.notify_all();
+}
+
+void GATTHandler::stopAsyncWorker(const bool wait) {
+    std::thread worker;
+    std::deque<std::function<void()>> dropped; // breaking all pending promises and completions outside of the lock
+    {
+        const std::lock_guard<std::mutex> lock(mtx_async); // RAII-style acquire and relinquish via destructor
+        asyncWorkerShallStop = true;
+        dropped.swap(asyncJobs);
+        if( wait && asyncWorker.joinable() ) {
+            if( asyncWorker.get_id() == std::this_thread::get_id() ) {
+                asyncWorker.detach(); // destructed by the worker itself
+            } else {
+                worker.swap(asyncWorker);
+            }
+        } // else keep the worker, ending after its current job
+    }
+    cv_async.notify_all();
+    if( worker.joinable() ) {
+        worker.join();
+    }
+}
+
+void GATTHandler::writeQueueWorkerImpl() {
+    std::unique_lock<std::mutex> lock(mtx_writeQueue); // RAII-style acquire and relinquish via destructor
+    for(;;) {
+        while( !writeQueueWorkerShallStop && writeQueue.empty() ) {
+            cv_writeQueue.wait(lock);
+        }
+        // Gather a batch, bounded by the latency of the oldest queued write
+        while( !writeQueueWorkerShallStop && !writeQueue.empty() &&
+               writeQueue.size() < static_cast<size_t>(env.GATT_WRITE_QUEUE_BATCH) )
+        {
+            const uint64_t td = getCurrentMilliseconds() - writeQueueT0;
+            if( td >= static_cast<uint64_t>(env.GATT_WRITE_QUEUE_LATENCY) ) {
+                break;
+            }
+            cv_writeQueue.wait_for(lock, std::chrono::milliseconds(env.GATT_WRITE_QUEUE_LATENCY - td));
+        }
+        if( writeQueueWorkerShallStop ) {
+            break;
+        }
+        if( writeQueue.empty() ) {
+            continue; // flushed by the command path
+        }
+        lock.unlock();
+        try {
+            flushWriteQueue();
+        } catch (std::exception & e) {
+            WARN_PRINT("GATTHandler::writeQueueWorker: Caught exception %s: %s", e.what(), deviceString.c_str());
+        }
+        lock.lock();
+    }
+    DBG_PRINT("GATTHandler::writeQueueWorker: Ended: %s", deviceString.c_str());
+}
+
+GATTStatus GATTHandler::queueWrite(const uint16_t handle, const TROOctets & value) {
+    if( !validateConnected() ) {
+        ERR_PRINT("GATTHandler::queueWrite: Invalid IO State: %s", deviceString.c_str());
+        return GATTStatus::INVALID_STATE;
+    }
+    std::shared_ptr<const AttWriteCmd> req( new AttWriteCmd(handle, value) );
+    COND_PRINT(env.DEBUG_DATA, "GATT WV queue: %s", req->toString().c_str());
+    std::thread stale;
+    {
+        std::unique_lock<std::mutex> lock(mtx_writeQueue); // RAII-style acquire and relinquish via destructor
+        if( writeQueueWorkerShallStop && writeQueueWorker.joinable() ) {
+            stale.swap(writeQueueWorker); // stopped by a previous disconnect
+        }
+    }
+    if( stale.joinable() ) {
+        if( stale.get_id() == std::this_thread::get_id() ) {
+            stale.detach();
+        } else {
+            stale.join();
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx_writeQueue); // RAII-style acquire and relinquish via destructor
+        if( !writeQueueWorker.joinable() ) {
+            writeQueueWorkerShallStop = false;
+            writeQueueWorker = std::thread(&GATTHandler::writeQueueWorkerImpl, this);
+        }
+        const size_t capacity = 4 * env.GATT_WRITE_QUEUE_BATCH;
+        while( !writeQueueWorkerShallStop && writeQueue.size() >= capacity ) {
+            cv_writeQueue.wait(lock); // backpressure until flushed
+        }
+        if( writeQueueWorkerShallStop ) {
+            ERR_PRINT("GATTHandler::queueWrite: Disconnected: %s", deviceString.c_str());
+            return GATTStatus::INVALID_STATE;
+        }
+        if( writeQueue.empty() ) {
+            writeQueueT0 = getCurrentMilliseconds();
+        }
+        writeQueue.push_back(req);
+    }
+    cv_writeQueue.notify_all();
+    return GATTStatus::SUCCESS;
+}
+
+int GATTHandler::flushWriteQueue() {
+    if( 0 >= env.GATT_WRITE_QUEUE_LATENCY ) {
+        return 0;
+    }
+    const std::lock_guard<std::mutex> lockFlush(mtx_writeQueueFlush); // RAII-style acquire and relinquish via destructor
+    std::deque<std::shared_ptr<const AttWriteCmd>> batch;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_writeQueue); // RAII-style acquire and relinquish via destructor
+        batch.swap(writeQueue);
+    }
+    if( batch.empty() ) {
+        return 0;
+    }
+    cv_writeQueue.notify_all(); // wake up blocked writers
+    const uint64_t t0 = getCurrentMicroseconds();
+    int count = 0;
+    for(const std::shared_ptr<const AttWriteCmd> & req : batch) {
+        if( GATTStatus::SUCCESS != sendImpl( *req ) ) {
+            break; // connection closed, drop the remainder
+        }
+        count++;
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT WV flushed %d/%zd queued writes", count, batch.size());
+    metricWrite.recordSince(t0, count == static_cast<int>(batch.size()));
+    return count;
+}
+
+void GATTHandler::stopWriteQueueWorker(const bool wait) {
+    std::thread worker;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_writeQueue); // RAII-style acquire and relinquish via destructor
+        writeQueueWorkerShallStop = true;
+        writeQueue.clear();
+        if( wait && writeQueueWorker.joinable() ) {
+            if( writeQueueWorker.get_id() == std::this_thread::get_id() ) {
+                writeQueueWorker.detach(); // destructed by the worker itself
+            } else {
+                worker.swap(writeQueueWorker);
+            }
+        } // else keep the worker, ending after its current flush
+    }
+    cv_writeQueue.notify_all();
+    if( worker.joinable() ) {
+        worker.join();
+    }
+}
+
+std::future<std::shared_ptr<POctets>> GATTHandler::readValueAsync(const uint16_t handle, int expectedLength) {
+    std::shared_ptr<std::promise<std::shared_ptr<POctets>>> promise(new std::promise<std::shared_ptr<POctets>>());
+    std::future<std::shared_ptr<POctets>> res = promise->get_future();
+    postAsync([this, promise, handle, expectedLength]() {
+        try {
+            std::shared_ptr<POctets> value(new POctets(number(Defaults::MAX_ATT_MTU), 0));
+            promise->set_value( readValue(handle, *value, expectedLength) ? value : nullptr );
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return res;
+}
+
+std::future<bool> GATTHandler::writeValueAsync(const uint16_t handle, const TROOctets & value, const bool withResponse) {
+    std::shared_ptr<std::promise<bool>> promise(new std::promise<bool>());
+    std::shared_ptr<POctets> valueCopy(new POctets(value));
+    std::future<bool> res = promise->get_future();
+    postAsync([this, promise, handle, valueCopy, withResponse]() {
+        try {
+            promise->set_value( writeValue(handle, *valueCopy, withResponse) );
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return res;
+}
+
+namespace direct_bt {
+    /**
+     * Invokes the completion callback of an async request exactly once,
+     * using the failure result if destructed before completion, i.e. the request has been dropped.
+     */
+    template<typename T> class AsyncCompletion {
+        private:
+            std::function<void(T)> cb;
+            const T failure;
+            std::atomic<bool> done;
+
+        public:
+            AsyncCompletion(std::function<void(T)> cb_, T failure_) : cb(cb_), failure(failure_), done(false) {}
+
+            ~AsyncCompletion() noexcept {
+                try {
+                    complete(failure);
+                } catch (std::exception &e) {
+                    ERR_PRINT("GATTHandler::AsyncCompletion: Caught exception %s", e.what());
+                }
+            }
+
+            void complete(T v) {
+                if( !done.exchange(true) && nullptr != cb ) {
+                    cb(v);
+                }
+            }
+    };
+}
+
+void GATTHandler::readValueAsync(const uint16_t handle, int expectedLength, ReadValueCallback cb) {
+    std::shared_ptr<AsyncCompletion<std::shared_ptr<POctets>>> completion(new AsyncCompletion<std::shared_ptr<POctets>>(cb, nullptr));
+    try {
+        postAsync([this, completion, handle, expectedLength]() {
+            std::shared_ptr<POctets> value(new POctets(number(Defaults::MAX_ATT_MTU), 0));
+            bool ok = false;
+            try {
+                ok = readValue(handle, *value, expectedLength);
+            } catch (std::exception &e) {
+                ERR_PRINT("GATTHandler::readValueAsync: Caught exception %s: %s", e.what(), deviceString.c_str());
+            }
+            completion->complete( ok ? value : nullptr );
+        });
+    } catch (IllegalStateException &e) {
+        DBG_PRINT("GATTHandler::readValueAsync: %s", e.what());
+    }
+}
+
+void GATTHandler::writeValueAsync(const uint16_t handle, const TROOctets & value, const bool withResponse, WriteValueCallback cb) {
+    std::shared_ptr<AsyncCompletion<bool>> completion(new AsyncCompletion<bool>(cb, false));
+    std::shared_ptr<POctets> valueCopy(new POctets(value));
+    try {
+        postAsync([this, completion, handle, valueCopy, withResponse]() {
+            bool ok = false;
+            try {
+                ok = writeValue(handle, *valueCopy, withResponse);
+            } catch (std::exception &e) {
+                ERR_PRINT("GATTHandler::writeValueAsync: Caught exception %s: %s", e.what(), deviceString.c_str());
+            }
+            completion->complete( ok );
+        });
+    } catch (IllegalStateException &e) {
+        DBG_PRINT("GATTHandler::writeValueAsync: %s", e.what());
+    }
+}
+
+bool GATTHandler::readValues(const std::vector<uint16_t> & handles, std::vector<std::shared_ptr<POctets>> & res) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.5 Read Multiple Variable Length Characteristic Values */
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    PERF2_TS_T0();
+
+    COND_PRINT(env.DEBUG_DATA, "GATTHandler::readValues count %zd", handles.size());
+    res.assign(handles.size(), nullptr);
+
+    size_t idx=0;
+    while( idx < handles.size() ) {
+        const size_t remaining = handles.size() - idx;
+        if( 1 == remaining || !readMultipleVariableSupported ) {
+            // Request requires two or more handles
+            std::shared_ptr<POctets> v(new POctets(number(Defaults::MAX_ATT_MTU), 0));
+            if( !readValue(handles[idx], *v) ) {
+                return false;
+            }
+            res[idx] = v;
+            idx++;
+            continue;
+        }
+        const size_t count = std::min<size_t>(remaining, ( usedMTU - 1 ) / 2);
+        const std::vector<uint16_t> reqHandles(handles.begin() + idx, handles.begin() + idx + count);
+        const AttReadMultipleReq req(reqHandles, true /* variableLength */);
+        COND_PRINT(env.DEBUG_DATA, "GATT RMV send: %s", req.toString().c_str());
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+
+        if( nullptr == pdu ) {
+            ERR_PRINT("GATT readValues send failed: count %zd: %s", count, deviceString.c_str());
+            return false;
+        }
+        COND_PRINT(env.DEBUG_DATA, "GATT RMV recv: %s", pdu->toString().c_str());
+        if( pdu->getOpcode() == AttPDUMsg::ATT_READ_MULTIPLE_VARIABLE_RSP ) {
+            const AttMultipleValueList * p = static_cast<const AttMultipleValueList*>(pdu.get());
+            const size_t received = std::min<size_t>(count, p->getValueCount());
+            if( 0 == received ) {
+                WARN_PRINT("GATT readValues empty reply %s", pdu->toString().c_str());
+                return false;
+            }
+            for(size_t i=0; i<received; i++) {
+                const int len = p->getValueLength(i);
+                std::shared_ptr<POctets> v(new POctets(std::max(1, len), 0));
+                if( p->isValueTruncated(i) ) {
+                    // Last value exceeded the ATT_MTU: Read it completely
+                    if( !readValue(handles[idx], *v, len) ) {
+                        return false;
+                    }
+                } else {
+                    *v += p->getValue(i);
+                }
+                res[idx] = v;
+                idx++;
+            }
+        } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP &&
+                   AttErrorRsp::UNSUPPORTED_REQUEST == static_cast<const AttErrorRsp *>(pdu.get())->getErrorCode() )
+        {
+            DBG_PRINT("GATT readValues: ATT_READ_MULTIPLE_VARIABLE_REQ not supported, reading single values: %s", deviceString.c_str());
+            readMultipleVariableSupported = false;
+        } else {
+            WARN_PRINT("GATT readValues unexpected reply %s", pdu->toString().c_str());
+            return false;
+        }
+    }
+    PERF2_TS_TD("GATT readValues");
+
+    return true;
+}
+
+bool GATTHandler::readValues(const std::vector<uint16_t> & handles, const std::vector<int> & valueLengths,
+                             std::vector<std::shared_ptr<POctets>> & res) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.4 Read Multiple Characteristic Values */
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    PERF2_TS_T0();
+
+    if( handles.size() != valueLengths.size() ) {
+        throw IllegalArgumentException("handles count "+std::to_string(handles.size())+
+                                       " != valueLengths count "+std::to_string(valueLengths.size()), E_FILE_LINE);
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATTHandler::readValues fixed count %zd", handles.size());
+    res.assign(handles.size(), nullptr);
+
+    const int maxValueSize = usedMTU - 1; // opcode
+    size_t idx=0;
+    while( idx < handles.size() ) {
+        // Collect as many values as fit into one response and their handles into one request
+        size_t count = 0;
+        int totalSize = 0;
+        while( idx + count < handles.size() &&
+               totalSize + valueLengths[idx+count] <= maxValueSize &&
+               1 + 2 * int(count + 1) <= usedMTU )
+        {
+            totalSize += valueLengths[idx+count];
+            count++;
+        }
+        if( 2 > count ) {
+            // Request requires two or more handles, or single value not fitting into ATT_MTU
+            std::shared_ptr<POctets> v(new POctets(std::max(1, valueLengths[idx]), 0));
+            if( !readValue(handles[idx], *v, valueLengths[idx]) ) {
+                return false;
+            }
+            res[idx] = v;
+            idx++;
+            continue;
+        }
+        const std::vector<uint16_t> reqHandles(handles.begin() + idx, handles.begin() + idx + count);
+        const AttReadMultipleReq req(reqHandles, false /* variableLength */);
+        COND_PRINT(env.DEBUG_DATA, "GATT RM send: %s", req.toString().c_str());
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+
+        if( nullptr == pdu ) {
+            ERR_PRINT("GATT readValues send failed: count %zd: %s", count, deviceString.c_str());
+            return false;
+        }
+        COND_PRINT(env.DEBUG_DATA, "GATT RM recv: %s", pdu->toString().c_str());
+        if( pdu->getOpcode() != AttPDUMsg::ATT_READ_MULTIPLE_RSP ) {
+            WARN_PRINT("GATT readValues unexpected reply %s", pdu->toString().c_str());
+            return false;
+        }
+        const AttReadMultipleRsp * p = static_cast<const AttReadMultipleRsp*>(pdu.get());
+        const TOctetSlice & value = p->getValue();
+        if( value.getSize() != totalSize ) {
+            WARN_PRINT("GATT readValues size %d != expected %d: %s", value.getSize(), totalSize, pdu->toString().c_str());
+            return false;
+        }
+        int offset = 0;
+        for(size_t i=0; i<count; i++) {
+            const int len = valueLengths[idx];
+            std::shared_ptr<POctets> v(new POctets(std::max(1, len), 0));
+            *v += TROOctets(p->pdu.get_ptr() + p->getPDUValueOffset() + offset, len);
+            res[idx] = v;
+            offset += len;
+            idx++;
+        }
+    }
+    PERF2_TS_TD("GATT readValues");
+
+    return true;
+}
+
+void GATTHandler::readValuesPipelined(const std::vector<uint16_t> & handles, std::vector<std::shared_ptr<POctets>> & res) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.8.1 Read Characteristic Value */
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const size_t idx0 = res.size();
+    std::vector<size_t> longValues; // indices into res
+    size_t sendIdx = 0; // next read to send
+    size_t rspIdx = 0;  // next read to be answered
+
+    flushWriteQueue();
+    discardStaleReplies();
+
+    while( rspIdx < handles.size() ) {
+        // Fill the window of outstanding read requests
+        while( sendIdx - rspIdx < static_cast<size_t>(readWindow) && sendIdx < handles.size() ) {
+            const AttReadReq req(handles[sendIdx]);
+            COND_PRINT(env.DEBUG_DATA, "GATT RV pipelined send: %s", req.toString().c_str());
+            send( req );
+            sendIdx++;
+        }
+        // Replies arrive in request order, BT Core Spec v5.2: Vol 3, Part F 3.3.2
+        const std::shared_ptr<const AttPDUMsg> pdu = receiveReply(AttPDUMsg::ATT_READ_REQ, nullptr /* pipelined */, getReadCommandReplyTimeout());
+        COND_PRINT(env.DEBUG_DATA, "GATT RV pipelined recv: %s", pdu->toString().c_str());
+        std::shared_ptr<POctets> v = nullptr;
+        if( pdu->getOpcode() == AttPDUMsg::ATT_READ_RSP ) {
+            const AttReadRsp * p = static_cast<const AttReadRsp*>(pdu.get());
+            const TOctetSlice & value = p->getValue();
+            v = std::shared_ptr<POctets>(new POctets(std::max(1, value.getSize()), 0));
+            *v += value;
+            if( value.getSize() >= usedMTU - 1 ) {
+                longValues.push_back(res.size()); // may be truncated by the ATT_MTU
+            }
+        } else {
+            DBG_PRINT("GATT readValuesPipelined handle %s: %s", uint16HexString(handles[rspIdx]).c_str(), pdu->toString().c_str());
+        }
+        res.push_back(v);
+        rspIdx++;
+    }
+    for(const size_t i : longValues) {
+        std::shared_ptr<POctets> v(new POctets(number(Defaults::MAX_ATT_MTU), 0));
+        res[i] = readValue(handles[i - idx0], *v) ? v : nullptr;
+    }
+}
+
+int GATTHandler::prefetchValues(const std::vector<GATTCharacteristicRef> & characteristics, PrefetchCallback cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const uint64_t t0 = getCurrentMicroseconds();
+    std::vector<std::shared_ptr<POctets>> values(characteristics.size());
+    std::vector<size_t> pending; // indices of values to be read
+    std::vector<uint16_t> handles;
+    int count = 0;
+
+    for(size_t i=0; i<characteristics.size(); i++) {
+        std::shared_ptr<POctets> v(new POctets(number(Defaults::MAX_ATT_MTU), 0));
+        if( characteristics[i]->valueCache.get(*v) ) {
+            values[i] = v;
+            count++;
+        } else {
+            pending.push_back(i);
+            handles.push_back(characteristics[i]->value_handle);
+        }
+    }
+    std::vector<std::shared_ptr<POctets>> res(handles.size());
+    bool readAll = false;
+    if( 1 < handles.size() && readMultipleVariableSupported ) {
+        readAll = readValues(handles, res);
+    }
+    if( !readAll ) {
+        // One rejected value fails the whole read multiple request, read the unread values singly
+        std::vector<size_t> unread; // indices into res
+        std::vector<uint16_t> unreadHandles;
+        for(size_t j=0; j<res.size(); j++) {
+            if( nullptr == res[j] ) {
+                unread.push_back(j);
+                unreadHandles.push_back(handles[j]);
+            }
+        }
+        if( unread.size() > 0 ) {
+            std::vector<std::shared_ptr<POctets>> unreadValues;
+            unreadValues.reserve(unread.size());
+            readValuesPipelined(unreadHandles, unreadValues);
+            for(size_t j=0; j<unread.size() && j<unreadValues.size(); j++) {
+                res[unread[j]] = unreadValues[j];
+            }
+        }
+    }
+    const uint64_t ts = getCurrentMilliseconds();
+    for(size_t j=0; j<pending.size() && j<res.size(); j++) {
+        if( nullptr != res[j] ) {
+            characteristics[pending[j]]->valueCache.put(*res[j], ts);
+            values[pending[j]] = res[j];
+            count++;
+        }
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT prefetchValues: %d/%zd values, %zd read, %" PRIu64 " us: %s",
+            count, characteristics.size(), handles.size(), getCurrentMicroseconds() - t0, deviceString.c_str());
+    if( nullptr != cb ) {
+        cb(characteristics, values);
+    }
+    return count;
+}
+
+int GATTHandler::prefetchValues(PrefetchCallback cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    std::vector<GATTCharacteristicRef> characteristics;
+    for(const GATTServiceRef & s : services) {
+        for(const GATTCharacteristicRef & c : s->characteristicList) {
+            if( c->hasProperties(GATTCharacteristic::PropertyBitVal::Read) ) {
+                characteristics.push_back(c);
+            }
+        }
+    }
+    return prefetchValues(characteristics, cb);
 }
 
 bool GATTHandler::writeDescriptorValue(const GATTDescriptor & cd) {
@@ -810,22 +2501,90 @@ bool GATTHandler::writeDescriptorValue(const GATTDescriptor & cd) {
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.11 Characteristic Value Indication */
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.12.3 Write Characteristic Descriptor */
     COND_PRINT(env.DEBUG_DATA, "GATTHandler::writeDesccriptorValue desc %s", cd.toString().c_str());
+    cd.valueCache.invalidate();
     return writeValue(cd.handle, cd.value, true);
 }
 
+GATTStatus GATTHandler::writeCharacteristicValueImpl(const GATTCharacteristic & c, const TROOctets & value, const bool withResponse) {
+    if( withResponse ) {
+        /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.3 Write Characteristic Value */
+        COND_PRINT(env.DEBUG_DATA, "GATTHandler::writeCharacteristicValue desc %s, value %s", c.toString().c_str(), value.toString().c_str());
+        c.valueCache.invalidate();
+        return writeValueImpl(c.value_handle, value, true);
+    }
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.1 Write Characteristic Value Without Response */
+    COND_PRINT(env.DEBUG_DATA, "GATT writeCharacteristicValueNoResp decl %s, value %s", c.toString().c_str(), value.toString().c_str());
+    c.valueCache.invalidate();
+    if( 0 < env.GATT_WRITE_QUEUE_LATENCY && 0 < value.getSize() && value.getSize() <= usedMTU - 1 - 2 ) {
+        return queueWrite(c.value_handle, value);
+    }
+    return writeValueImpl(c.value_handle, value, false);
+}
+
 bool GATTHandler::writeCharacteristicValue(const GATTCharacteristic & c, const TROOctets & value) {
-    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.3 Write Characteristic Value */
-    COND_PRINT(env.DEBUG_DATA, "GATTHandler::writeCharacteristicValue desc %s, value %s", c.toString().c_str(), value.toString().c_str());
-    return writeValue(c.value_handle, value, true);
+    const GATTStatus status = writeCharacteristicValueImpl(c, value, true);
+    throwOnTransportFailure(status, "GATTHandler::writeCharacteristicValue", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
 }
 
 bool GATTHandler::writeCharacteristicValueNoResp(const GATTCharacteristic & c, const TROOctets & value) {
-    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.1 Write Characteristic Value Without Response */
-    COND_PRINT(env.DEBUG_DATA, "GATT writeCharacteristicValueNoResp decl %s, value %s", c.toString().c_str(), value.toString().c_str());
-    return writeValue(c.value_handle, value, false);
+    const GATTStatus status = writeCharacteristicValueImpl(c, value, false);
+    throwOnTransportFailure(status, "GATTHandler::writeCharacteristicValueNoResp", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
 }
 
-bool GATTHandler::writeValue(const uint16_t handle, const TROOctets & value, const bool withResponse) {
+GATTStatus GATTHandler::writeCharacteristicValueStatus(const GATTCharacteristic & c, const TROOctets & value, const bool withResponse) noexcept {
+    return catchGATTStatus("GATTHandler::writeCharacteristicValue", deviceString, [&]() {
+        return writeCharacteristicValueImpl(c, value, withResponse);
+    });
+}
+
+GATTStatus GATTHandler::writeCharacteristicValueImpl(const GATTCharacteristic & c, const int valueSize,
+                                                     const GATTCharacteristic::ValueFill & fill, const bool withResponse) {
+    COND_PRINT(env.DEBUG_DATA, "GATT writeCharacteristicValue(fill) decl %s, size %d, resp %d", c.toString().c_str(), valueSize, withResponse);
+    if( valueSize <= 0 ) {
+        WARN_PRINT("GATT writeCharacteristicValue(fill) size <= 0, no-op: %s", c.toString().c_str());
+        return GATTStatus::INVALID_VALUE;
+    }
+    if( valueSize > usedMTU - 1 - 2 || ( !withResponse && 0 < env.GATT_WRITE_QUEUE_LATENCY ) ) {
+        // Long value or queued write command, assembled in an intermediate buffer
+        POctets value(valueSize, valueSize);
+        if( !fill(value.get_wptr(), valueSize) ) {
+            return GATTStatus::ABORTED;
+        }
+        return writeCharacteristicValueImpl(c, value, withResponse);
+    }
+    c.valueCache.invalidate();
+    const uint64_t t0 = getCurrentMicroseconds();
+    if( !withResponse ) {
+        AttWriteCmd req(c.value_handle, valueSize);
+        if( !fill(req.getValueWPtr(), valueSize) ) {
+            return GATTStatus::ABORTED;
+        }
+        return sendWriteCmd(req, t0);
+    }
+    AttWriteReq req(c.value_handle, valueSize);
+    if( !fill(req.getValueWPtr(), valueSize) ) {
+        return GATTStatus::ABORTED;
+    }
+    return sendWriteReq(req, t0);
+}
+
+bool GATTHandler::writeCharacteristicValue(const GATTCharacteristic & c, const int valueSize,
+                                           const GATTCharacteristic::ValueFill & fill, const bool withResponse) {
+    const GATTStatus status = writeCharacteristicValueImpl(c, valueSize, fill, withResponse);
+    throwOnTransportFailure(status, "GATTHandler::writeCharacteristicValue", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
+}
+
+GATTStatus GATTHandler::writeCharacteristicValueStatus(const GATTCharacteristic & c, const int valueSize,
+                                                       const GATTCharacteristic::ValueFill & fill, const bool withResponse) noexcept {
+    return catchGATTStatus("GATTHandler::writeCharacteristicValue", deviceString, [&]() {
+        return writeCharacteristicValueImpl(c, valueSize, fill, withResponse);
+    });
+}
+
+GATTStatus GATTHandler::writeValueImpl(const uint16_t handle, const TROOctets & value, const bool withResponse) {
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3 Client Characteristic Configuration */
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.3 Write Characteristic Value */
     /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.11 Characteristic Value Indication */
@@ -833,45 +2592,246 @@ bool GATTHandler::writeValue(const uint16_t handle, const TROOctets & value, con
 
     if( value.getSize() <= 0 ) {
         WARN_PRINT("GATT writeValue size <= 0, no-op: %s", value.toString().c_str());
-        return false;
+        return GATTStatus::INVALID_VALUE;
+    }
+    const uint64_t t0 = getCurrentMicroseconds();
+    if( withResponse && value.getSize() > usedMTU - 1 - 2 ) {
+        const GATTStatus res = writeLongValueImpl(handle, value, false /* reliable */);
+        metricWrite.recordSince(t0, GATTStatus::SUCCESS == res);
+        return res;
+    }
+    if( !withResponse ) {
+        const AttWriteCmd req(handle, value);
+        return sendWriteCmd(req, t0);
     }
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const AttWriteReq req(handle, value);
+    return sendWriteReq(req, t0);
+}
 
-    // FIXME TODO: Long Value if value.getSize() > ( ATT_MTU - 3 )
-    PERF2_TS_T0();
+bool GATTHandler::writeValue(const uint16_t handle, const TROOctets & value, const bool withResponse) {
+    const GATTStatus status = writeValueImpl(handle, value, withResponse);
+    throwOnTransportFailure(status, "GATTHandler::writeValue", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
+}
 
-    if( !withResponse ) {
-        AttWriteCmd req(handle, value);
-        COND_PRINT(env.DEBUG_DATA, "GATT WV send(resp %d): %s", withResponse, req.toString().c_str());
+GATTStatus GATTHandler::writeValueStatus(const uint16_t handle, const TROOctets & value, const bool withResponse) noexcept {
+    return catchGATTStatus("GATTHandler::writeValue", deviceString, [&]() {
+        return writeValueImpl(handle, value, withResponse);
+    });
+}
 
-        send( req );
-        PERF2_TS_TD("GATT writeValue (no-resp)");
-        return true;
-    }
+GATTStatus GATTHandler::sendWriteCmd(const AttWriteCmd & req, const uint64_t t0) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    PERF2_TS_T0();
+    COND_PRINT(env.DEBUG_DATA, "GATT WV send(resp 0): %s", req.toString().c_str());
 
-    AttWriteReq req(handle, value);
-    COND_PRINT(env.DEBUG_DATA, "GATT WV send(resp %d): %s", withResponse, req.toString().c_str());
+    flushWriteQueue();
+    const GATTStatus res = sendImpl( req );
+    PERF2_TS_TD("GATT writeValue (no-resp)");
+    metricWrite.recordSince(t0, GATTStatus::SUCCESS == res);
+    return res;
+}
 
-    bool res = false;
-    std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, env.GATT_WRITE_COMMAND_REPLY_TIMEOUT);
-    if( nullptr != pdu ) {
+GATTStatus GATTHandler::sendWriteReq(const AttWriteReq & req, const uint64_t t0) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    PERF2_TS_T0();
+    COND_PRINT(env.DEBUG_DATA, "GATT WV send(resp 1): %s", req.toString().c_str());
+
+    std::shared_ptr<const AttPDUMsg> pdu;
+    GATTStatus res = sendWithReplyImpl(req, getWriteCommandReplyTimeout(), pdu);
+    if( GATTStatus::SUCCESS == res ) {
         COND_PRINT(env.DEBUG_DATA, "GATT WV recv: %s", pdu->toString().c_str());
         if( pdu->getOpcode() == AttPDUMsg::ATT_WRITE_RSP ) {
             // OK
-            res = true;
         } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
             const AttErrorRsp * p = static_cast<const AttErrorRsp *>(pdu.get());
             WARN_PRINT("GATT writeValue unexpected error %s", p->toString().c_str());
+            res = GATTStatus::ERROR_RSP;
         } else {
             WARN_PRINT("GATT writeValue unexpected reply %s", pdu->toString().c_str());
+            res = GATTStatus::UNEXPECTED_REPLY;
         }
     } else {
-        ERR_PRINT("GATT writeValue send failed: handle %u: %s", handle, deviceString.c_str());
+        ERR_PRINT("GATT writeValue send failed: %s, handle %u: %s", getGATTStatusString(res).c_str(), req.getHandle(), deviceString.c_str());
     }
     PERF2_TS_TD("GATT writeValue (with-resp)");
+    metricWrite.recordSince(t0, GATTStatus::SUCCESS == res);
+    return res;
+}
+
+bool GATTHandler::writeLongValue(const uint16_t handle, const TROOctets & value, const bool reliable) {
+    const GATTStatus status = writeLongValueImpl(handle, value, reliable);
+    throwOnTransportFailure(status, "GATTHandler::writeLongValue", E_FILE_LINE);
+    return GATTStatus::SUCCESS == status;
+}
+
+GATTStatus GATTHandler::writeLongValueImpl(const uint16_t handle, const TROOctets & value, const bool reliable) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.4 Write Long Characteristic Values */
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.5 Reliable Writes */
+
+    if( value.getSize() <= 0 ) {
+        WARN_PRINT("GATT writeLongValue size <= 0, no-op: %s", value.toString().c_str());
+        return GATTStatus::INVALID_VALUE;
+    }
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    PERF2_TS_T0();
+
+    const int size = value.getSize();
+    const int maxChunkSize = usedMTU - 1 - 2 - 2; // opcode + handle + value_offset
+    bool prepared = true;
+    GATTStatus status = GATTStatus::SUCCESS; // first failure
+    int sendOffset = 0; // next offset to prepare
+    int rspOffset = 0;  // next offset to be acknowledged
+    int outstanding = 0;
+
+    COND_PRINT(env.DEBUG_DATA, "GATT WLV handle %s, size %d, reliable %d, window %d",
+            uint16HexString(handle).c_str(), size, reliable, prepareWriteWindow);
+    flushWriteQueue();
+    discardStaleReplies();
+
+    while( prepared && rspOffset < size ) {
+        // Fill the window of outstanding prepare requests
+        while( outstanding < prepareWriteWindow && sendOffset < size ) {
+            const int len = std::min(maxChunkSize, size - sendOffset);
+            const AttPrepareWriteReq req(handle, sendOffset, TROOctets(value.get_ptr() + sendOffset, len));
+            COND_PRINT(env.DEBUG_DATA, "GATT WLV send: %s", req.toString().c_str());
+            status = sendImpl( req );
+            if( GATTStatus::SUCCESS != status ) {
+                return status; // connection closed
+            }
+            sendOffset += len;
+            outstanding++;
+        }
+        std::shared_ptr<const AttPDUMsg> pdu;
+        const GATTStatus s = receiveReplyImpl(AttPDUMsg::ATT_PREPARE_WRITE_REQ, nullptr /* pipelined */, getWriteCommandReplyTimeout(), pdu);
+        if( GATTStatus::SUCCESS != s ) {
+            return s;
+        }
+        outstanding--;
+        COND_PRINT(env.DEBUG_DATA, "GATT WLV recv: %s", pdu->toString().c_str());
+        const int len = std::min(maxChunkSize, size - rspOffset);
+        if( pdu->getOpcode() == AttPDUMsg::ATT_PREPARE_WRITE_RSP ) {
+            const AttPrepareWriteRsp * p = static_cast<const AttPrepareWriteRsp*>(pdu.get());
+            if( reliable &&
+                ( p->getHandle() != handle || p->getValueOffset() != rspOffset || p->getValue().getSize() != len ||
+                  0 != memcmp(p->pdu.get_ptr() + p->getPDUValueOffset(), value.get_ptr() + rspOffset, len) ) )
+            {
+                WARN_PRINT("GATT writeLongValue reliable mismatch at offset %d: %s", rspOffset, pdu->toString().c_str());
+                status = GATTStatus::UNEXPECTED_REPLY;
+                prepared = false;
+            }
+        } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
+            WARN_PRINT("GATT writeLongValue unexpected error at offset %d: %s", rspOffset, pdu->toString().c_str());
+            status = GATTStatus::ERROR_RSP;
+            prepared = false;
+        } else {
+            WARN_PRINT("GATT writeLongValue unexpected reply at offset %d: %s", rspOffset, pdu->toString().c_str());
+            status = GATTStatus::UNEXPECTED_REPLY;
+            prepared = false;
+        }
+        rspOffset += len;
+    }
+    // Drain replies of outstanding prepare requests after a failure
+    while( 0 < outstanding ) {
+        std::shared_ptr<const AttPDUMsg> pdu;
+        const GATTStatus s = receiveReplyImpl(AttPDUMsg::ATT_PREPARE_WRITE_REQ, nullptr /* pipelined */, getWriteCommandReplyTimeout(), pdu);
+        if( GATTStatus::SUCCESS != s ) {
+            return s;
+        }
+        COND_PRINT(env.DEBUG_DATA, "GATT WLV recv (drain): %s", pdu->toString().c_str());
+        outstanding--;
+    }
+
+    const AttExecuteWriteReq req(prepared /* commit */);
+    COND_PRINT(env.DEBUG_DATA, "GATT WLV send: %s", req.toString().c_str());
+
+    std::shared_ptr<const AttPDUMsg> pdu;
+    const GATTStatus s = sendWithReplyImpl(req, getWriteCommandReplyTimeout(), pdu);
+    if( GATTStatus::SUCCESS != s ) {
+        return s;
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT WLV recv: %s", pdu->toString().c_str());
+    if( pdu->getOpcode() == AttPDUMsg::ATT_EXECUTE_WRITE_RSP ) {
+        // status holds the prepare failure, if any
+    } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
+        WARN_PRINT("GATT writeLongValue unexpected error %s", pdu->toString().c_str());
+        status = GATTStatus::SUCCESS != status ? status : GATTStatus::ERROR_RSP;
+    } else {
+        WARN_PRINT("GATT writeLongValue unexpected reply %s", pdu->toString().c_str());
+        status = GATTStatus::SUCCESS != status ? status : GATTStatus::UNEXPECTED_REPLY;
+    }
+    PERF2_TS_TD("GATT writeLongValue");
+    return status;
+}
+
+GATTWriteStream::GATTWriteStream(std::shared_ptr<GATTHandler> gatt_, const uint16_t handle_, const int32_t stallTimeoutMS_)
+: gatt(gatt_), handle(handle_), stallTimeoutMS(stallTimeoutMS_),
+  pdu(GATTHandler::number(GATTHandler::Defaults::MAX_ATT_MTU), 0),
+  bytesWritten(0), pduCount(0), backpressureCount(0), backpressureMS(0), elapsedMS(0)
+{
+    if( nullptr == gatt ) {
+        throw IllegalArgumentException("GATTWriteStream: nullptr GATTHandler", E_FILE_LINE);
+    }
+}
+
+bool GATTWriteStream::write(const TROOctets & value) {
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 4.9.1 Write Characteristic Value without Response */
+    const uint64_t t0 = getCurrentMilliseconds();
+    const int maxChunkSize = gatt->usedMTU - 1 - 2; // opcode + handle
+    bool res = true;
+
+    pdu.resize(1+2);
+    pdu.put_uint8(0, AttPDUMsg::ATT_WRITE_CMD);
+    pdu.put_uint16(1, handle);
+
+    int offset = 0;
+    while( offset < value.getSize() ) {
+        if( !gatt->validateConnected() ) {
+            res = false;
+            break;
+        }
+        const int chunkSize = std::min(maxChunkSize, value.getSize() - offset);
+        pdu.resize(1+2+chunkSize);
+        memcpy(pdu.get_wptr() + 1 + 2, value.get_ptr() + offset, chunkSize);
+
+        int waitCount = 0;
+        const uint64_t tw0 = getCurrentMilliseconds();
+        const int len = gatt->l2cap.write_nonblock(pdu.get_ptr(), pdu.getSize(), stallTimeoutMS, &waitCount);
+        if( 0 < waitCount ) {
+            backpressureCount += waitCount;
+            backpressureMS += getCurrentMilliseconds() - tw0;
+        }
+        if( 0 == len ) {
+            ERR_PRINT("GATTWriteStream::write: send queue stalled for %d ms, offset %d/%d: %s",
+                    stallTimeoutMS, offset, value.getSize(), gatt->deviceString.c_str());
+            res = false;
+            break;
+        }
+        if( len != pdu.getSize() ) {
+            ERR_PRINT("GATTWriteStream::write: l2cap write error %d != %d, offset %d/%d -> disconnect: %s",
+                    len, pdu.getSize(), offset, value.getSize(), gatt->deviceString.c_str());
+            gatt->hasIOError = true;
+            gatt->disconnect(true /* disconnectDevice */, true /* ioErrorCause */); // state -> Disconnected
+            res = false;
+            break;
+        }
+        gatt->traffic.countOut(pdu.get_uint8(0), len);
+        offset += chunkSize;
+        bytesWritten += chunkSize;
+        pduCount++;
+    }
+    elapsedMS += getCurrentMilliseconds() - t0;
+    COND_PRINT(gatt->env.DEBUG_DATA, "GATTWriteStream::write: res %d, size %d: %s", res, value.getSize(), toString().c_str());
     return res;
 }
 
+std::string GATTWriteStream::toString() const {
+    return "GATTWriteStream[handle "+uint16HexString(handle)+", written[bytes "+std::to_string(bytesWritten)+
+            ", pdus "+std::to_string(pduCount)+"], elapsed "+std::to_string(elapsedMS)+" ms, "+
+            std::to_string(getThroughput())+" bytes/s, backpressure[count "+std::to_string(backpressureCount)+
+            ", "+std::to_string(backpressureMS)+" ms]]";
+}
+
 bool GATTHandler::configNotificationIndication(GATTDescriptor & cccd, const bool enableNotification, const bool enableIndication) {
     if( !cccd.isClientCharacteristicConfiguration() ) {
         throw IllegalArgumentException("Not a ClientCharacteristicConfiguration: "+cccd.toString(), E_FILE_LINE);
@@ -895,6 +2855,149 @@ bool GATTHandler::configNotificationIndication(GATTDescriptor & cccd, const bool
     }
 }
 
+GATTDescriptorRef GATTHandler::findClientCharacteristicConfig(GATTCharacteristicRef c) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    if( nullptr == c ) {
+        return nullptr;
+    }
+    GATTDescriptorRef cccd = c->getClientCharacteristicConfig();
+    if( nullptr != cccd || 0 < c->descriptorList.size() ) {
+        return cccd; // descriptors already discovered
+    }
+    if( !c->hasProperties(GATTCharacteristic::PropertyBitVal::Notify) &&
+        !c->hasProperties(GATTCharacteristic::PropertyBitVal::Indicate) )
+    {
+        return nullptr; // BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3: CCCD mandatory if either is set
+    }
+    GATTServiceRef service = c->getServiceUnchecked();
+    if( nullptr == service ) {
+        return nullptr;
+    }
+    // descriptors are located between the value handle and the next characteristic declaration
+    uint16_t endHandle = service->endHandle;
+    for(auto it = service->characteristicList.begin(); it != service->characteristicList.end(); it++) {
+        if( (*it)->handle > c->value_handle && (*it)->handle <= endHandle ) {
+            endHandle = (*it)->handle - 1;
+        }
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT CCCD find: handles %s..%s: %s",
+            uint16HexString(c->value_handle + 1).c_str(), uint16HexString(endHandle).c_str(), c->toString().c_str());
+
+    uint16_t cd_handle_iter = c->value_handle + 1;
+    bool done = false;
+    while( !done && nullptr == cccd && cd_handle_iter <= endHandle ) {
+        const AttFindInfoReq req(cd_handle_iter, endHandle);
+        std::shared_ptr<const AttPDUMsg> pdu = sendWithReply(req, getReadCommandReplyTimeout());
+        if( nullptr == pdu ) {
+            ERR_PRINT("GATT findClientCharacteristicConfig send failed: %s - %s", req.toString().c_str(), deviceString.c_str());
+            return nullptr;
+        }
+        COND_PRINT(env.DEBUG_DATA, "GATT CCCD find recv: %s", pdu->toString().c_str());
+
+        if( pdu->getOpcode() == AttPDUMsg::ATT_FIND_INFORMATION_RSP ) {
+            const AttFindInfoRsp * p = static_cast<const AttFindInfoRsp*>(pdu.get());
+            const int e_count = p->getElementCount();
+            for(const AttElementSlice e : *p) {
+                if( uuid_t::TypeSize::UUID16_SZ == e.getValueSize() &&
+                    GATTDescriptor::Type::CLIENT_CHARACTERISTIC_CONFIGURATION == e.get_uint16(2) )
+                {
+                    cccd = GATTDescriptorRef( new GATTDescriptor(c, e.getUUID().toUUID(), e.getHandle()) );
+                    break;
+                }
+            }
+            cd_handle_iter = p->getElementHandle(e_count-1); // Last Descriptor Handle
+            if( cd_handle_iter < endHandle ) {
+                cd_handle_iter++;
+            } else {
+                done = true; // OK by spec: End of communication
+            }
+        } else if( pdu->getOpcode() == AttPDUMsg::ATT_ERROR_RSP ) {
+            done = true; // OK by spec: End of communication
+        } else {
+            WARN_PRINT("GATT findClientCharacteristicConfig unexpected opcode reply %s", pdu->toString().c_str());
+            done = true;
+        }
+    }
+    if( nullptr == cccd ) {
+        DBG_PRINT("GATT findClientCharacteristicConfig: None: %s", c->toString().c_str());
+        return nullptr;
+    }
+    c->clientCharacteristicsConfigIndex = c->descriptorList.size();
+    c->descriptorList.push_back(cccd);
+    updateAttributeTable();
+    if( env.GATT_CACHE ) {
+        std::shared_ptr<DBTDevice> device = getDevice();
+        if( nullptr != device ) {
+            getCache().put(device->getAddress(), cacheDBHash /* empty if none */, services);
+        }
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT CCCD found: %s", cccd->toString().c_str());
+    return cccd;
+}
+
+int GATTHandler::configNotificationIndication(const std::vector<GATTCharacteristicRef> & characteristics,
+                                              const bool enableNotification, const bool enableIndication)
+{
+    /* BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3 Client Characteristic Configuration */
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    PERF2_TS_T0();
+
+    struct PendingWrite {
+        GATTCharacteristicRef c;
+        bool notification;
+        bool indication;
+    };
+    std::vector<PendingWrite> writes;
+    writes.reserve(characteristics.size());
+    int count = 0;
+    for(const GATTCharacteristicRef & c : characteristics) {
+        const bool resEnableNotification = enableNotification && c->hasProperties(GATTCharacteristic::PropertyBitVal::Notify);
+        const bool resEnableIndication = enableIndication && c->hasProperties(GATTCharacteristic::PropertyBitVal::Indicate);
+        if( resEnableNotification == c->enabledNotifyState && resEnableIndication == c->enabledIndicateState ) {
+            count++; // unchanged
+            continue;
+        }
+        GATTDescriptorRef cccd = findClientCharacteristicConfig(c);
+        if( nullptr == cccd ) {
+            DBG_PRINT("GATT configNotificationIndication: No ClientCharacteristicConfig descriptor: %s", c->toString().c_str());
+            continue;
+        }
+        cccd->value.resize(2, 2);
+        cccd->value.put_uint16(0, resEnableNotification | ( resEnableIndication << 1 ));
+        writes.push_back( PendingWrite { c, resEnableNotification, resEnableIndication } );
+    }
+    COND_PRINT(env.DEBUG_DATA, "GATT CCCD bulk: %zd characteristics, %zd writes, window %d",
+            characteristics.size(), writes.size(), cccdWriteWindow);
+    flushWriteQueue();
+    discardStaleReplies();
+
+    size_t sendIdx = 0; // next write to send
+    size_t rspIdx = 0;  // next write to be acknowledged
+    while( rspIdx < writes.size() ) {
+        // Fill the window of outstanding write requests
+        while( sendIdx - rspIdx < static_cast<size_t>(cccdWriteWindow) && sendIdx < writes.size() ) {
+            const GATTDescriptor & cccd = *writes[sendIdx].c->getClientCharacteristicConfig();
+            const AttWriteReq req(cccd.handle, cccd.value);
+            COND_PRINT(env.DEBUG_DATA, "GATT CCCD bulk send: %s", req.toString().c_str());
+            send( req );
+            sendIdx++;
+        }
+        // Replies arrive in request order, BT Core Spec v5.2: Vol 3, Part F 3.3.2
+        const std::shared_ptr<const AttPDUMsg> pdu = receiveReply(AttPDUMsg::ATT_WRITE_REQ, nullptr /* pipelined */, getWriteCommandReplyTimeout());
+        PendingWrite & w = writes[rspIdx++];
+        COND_PRINT(env.DEBUG_DATA, "GATT CCCD bulk recv: %s", pdu->toString().c_str());
+        if( pdu->getOpcode() == AttPDUMsg::ATT_WRITE_RSP ) {
+            w.c->enabledNotifyState = w.notification;
+            w.c->enabledIndicateState = w.indication;
+            count++;
+        } else {
+            WARN_PRINT("GATT configNotificationIndication unexpected reply %s: %s", pdu->toString().c_str(), w.c->toString().c_str());
+        }
+    }
+    PERF2_TS_TD("GATT configNotificationIndication (bulk)");
+    return count;
+}
+
 /*********************************************************************************************************************/
 /*********************************************************************************************************************/
 /*********************************************************************************************************************/
@@ -922,7 +3025,7 @@ std::shared_ptr<GenericAccess> GATTHandler::getGenericAccess(std::vector<GATTCha
     AppearanceCat appearance = AppearanceCat::UNKNOWN;
     PeriphalPreferredConnectionParameters * prefConnParam = nullptr;
 
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
 
     for(size_t i=0; i<genericAccessCharDeclList.size(); i++) {
         const GATTCharacteristic & charDecl = *genericAccessCharDeclList.at(i);
@@ -962,7 +3065,7 @@ std::shared_ptr<GenericAccess> GATTHandler::getGenericAccess(std::vector<GATTSer
 }
 
 bool GATTHandler::ping() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
 
     for(size_t i=0; i<services.size(); i++) {
         std::vector<GATTCharacteristicRef> & genericAccessCharDeclList = services.at(i)->characteristicList;
@@ -999,7 +3102,7 @@ std::shared_ptr<DeviceInformation> GATTHandler::getDeviceInformation(std::vector
     PnP_ID * pnpID = nullptr;
     bool found = false;
 
-    const std::lock_guard<std::recursive_mutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_command); // RAII-style acquire and relinquish via destructor
 
     for(size_t i=0; i<characteristicDeclList.size(); i++) {
         const GATTCharacteristic & charDecl = *characteristicDeclList.at(i);
@@ -200,9 +200,13 @@ const std::vector<const GattServiceCharacteristic*> direct_bt::GATT_SERVICES = {
 
 #define SERVICE_TYPE_ENUM(X) \
     X(GENERIC_ACCESS) \
+    X(GENERIC_ATTRIBUTE) \
     X(HEALTH_THERMOMETER) \
 	X(DEVICE_INFORMATION) \
-    X(BATTERY_SERVICE)
+    X(BATTERY_SERVICE) \
+    X(HEART_RATE) \
+    X(BLOOD_PRESSURE) \
+    X(CYCLING_POWER)
 
 std::string direct_bt::GattServiceTypeToString(const GattServiceType v) {
     switch(v) {
@@ -218,6 +222,8 @@ std::string direct_bt::GattServiceTypeToString(const GattServiceType v) {
     X(PERIPHERAL_PRIVACY_FLAG) \
     X(RECONNECTION_ADDRESS) \
     X(PERIPHERAL_PREFERRED_CONNECTION_PARAMETERS) \
+    X(SERVICE_CHANGED) \
+    X(DATABASE_HASH) \
     X(TEMPERATURE) \
     X(TEMPERATURE_CELSIUS) \
     X(TEMPERATURE_FAHRENHEIT) \
@@ -233,7 +239,12 @@ std::string direct_bt::GattServiceTypeToString(const GattServiceType v) {
     X(SOFTWARE_REVISION_STRING) \
     X(MANUFACTURER_NAME_STRING) \
     X(REGULATORY_CERT_DATA_LIST) \
-    X(PNP_ID)
+    X(PNP_ID) \
+    X(HEART_RATE_MEASUREMENT) \
+    X(BODY_SENSOR_LOCATION) \
+    X(BLOOD_PRESSURE_MEASUREMENT) \
+    X(INTERMEDIATE_CUFF_PRESSURE) \
+    X(CYCLING_POWER_MEASUREMENT)
 
 
 std::string direct_bt::GattCharacteristicTypeToString(const GattCharacteristicType v) {
@@ -313,33 +324,62 @@ std::string GattServiceCharacteristic::toString() const {
     return res;
 }
 
-const GattServiceCharacteristic * direct_bt::findGattServiceChar(const uint16_t uuid16) {
-    for(size_t i=0; i<GATT_SERVICES.size(); i++) {
-        const GattServiceCharacteristic & serviceChar = *GATT_SERVICES.at(i);
-        if( uuid16 == serviceChar.service ) {
-            return &serviceChar;
+namespace {
+    /**
+     * uuid16 sorted index of GATT_SERVICES, built once on first lookup.
+     * <p>
+     * Equal uuid16 keys keep the GATT_SERVICES declaration order,
+     * hence lookups return the same entry as a linear scan would.
+     * </p>
+     */
+    struct GattUUID16Index {
+        template<typename V> using Entry = std::pair<uint16_t, const V*>;
+
+        /** GattServiceType and GattCharacteristicType keys to their GattServiceCharacteristic */
+        std::vector<Entry<GattServiceCharacteristic>> serviceChars;
+        /** GattCharacteristicType keys to their GattCharacteristicSpec */
+        std::vector<Entry<GattCharacteristicSpec>> charSpecs;
+
+        template<typename V>
+        static void sort(std::vector<Entry<V>> & v) {
+            std::stable_sort(v.begin(), v.end(), [](const Entry<V> & a, const Entry<V> & b) { return a.first < b.first; });
+        }
+
+        template<typename V>
+        static const V * find(const std::vector<Entry<V>> & v, const uint16_t uuid16) {
+            auto it = std::lower_bound(v.begin(), v.end(), uuid16, [](const Entry<V> & a, const uint16_t k) { return a.first < k; });
+            return ( it != v.end() && it->first == uuid16 ) ? it->second : nullptr;
         }
-        for(size_t j=0; j<serviceChar.characteristics.size(); j++) {
-            const GattCharacteristicSpec & charSpec = serviceChar.characteristics.at(i);
-            if( uuid16 == charSpec.characteristic ) {
-                return &serviceChar;
+
+        GattUUID16Index() {
+            for(size_t i=0; i<GATT_SERVICES.size(); i++) {
+                const GattServiceCharacteristic & serviceChar = *GATT_SERVICES[i];
+                serviceChars.push_back( Entry<GattServiceCharacteristic>(serviceChar.service, &serviceChar) );
+                for(size_t j=0; j<serviceChar.characteristics.size(); j++) {
+                    const GattCharacteristicSpec & charSpec = serviceChar.characteristics[j];
+                    serviceChars.push_back( Entry<GattServiceCharacteristic>(charSpec.characteristic, &serviceChar) );
+                    charSpecs.push_back( Entry<GattCharacteristicSpec>(charSpec.characteristic, &charSpec) );
+                }
             }
+            sort(serviceChars);
+            sort(charSpecs);
         }
+    };
+
+    const GattUUID16Index & getGattUUID16Index() {
+        static const GattUUID16Index index; // thread safe initialization
+        return index;
     }
-    return nullptr;
+}
+
+const GattServiceCharacteristic * direct_bt::findGattServiceChar(const uint16_t uuid16) {
+    const GattUUID16Index & index = getGattUUID16Index();
+    return GattUUID16Index::find(index.serviceChars, uuid16);
 }
 
 const GattCharacteristicSpec * direct_bt::findGattCharSpec(const uint16_t uuid16) {
-    for(size_t i=0; i<GATT_SERVICES.size(); i++) {
-        const GattServiceCharacteristic & serviceChar = *GATT_SERVICES.at(i);
-        for(size_t j=0; j<serviceChar.characteristics.size(); j++) {
-            const GattCharacteristicSpec & charSpec = serviceChar.characteristics.at(i);
-            if( uuid16 == charSpec.characteristic ) {
-                return &charSpec;
-            }
-        }
-    }
-    return nullptr;
+    const GattUUID16Index & index = getGattUUID16Index();
+    return GattUUID16Index::find(index.charSpecs, uuid16);
 }
 
 /********************************************************/
@@ -438,3 +478,181 @@ std::string TemperatureMeasurementCharateristic::toString() const {
     }
     return res;
 }
+
+HeartRateMeasurement::HeartRateMeasurement(const uint8_t * source, const int size_) noexcept
+: data(source), size(size_), rrOffset(0), valid(false)
+{
+    if( 1 > size ) {
+        return;
+    }
+    const uint8_t flags = data[0];
+    rrOffset = 1 + ( 0 != ( flags & Bits::VALUE_FORMAT_UINT16 ) ? 2 : 1 );
+    if( 0 != ( flags & Bits::HAS_ENERGY_EXPENDED ) ) {
+        rrOffset += 2;
+    }
+    valid = rrOffset <= size;
+}
+
+int HeartRateMeasurement::getRRIntervals(uint16_t * dest, const int maxCount) const noexcept {
+    const int count = std::min(maxCount, getRRIntervalCount());
+    for(int i=0; i<count; i++) {
+        dest[i] = getRRInterval(i);
+    }
+    return count;
+}
+
+int HeartRateMeasurement::getRRIntervalsSeconds(float * dest, const int maxCount) const noexcept {
+    const int count = std::min(maxCount, getRRIntervalCount());
+    const uint8_t * p = data + rrOffset;
+    for(int i=0; i<count; i++, p+=2) {
+        dest[i] = static_cast<uint16_t>( p[0] | ( p[1] << 8 ) ) / 1024.0f;
+    }
+    return count;
+}
+
+std::string HeartRateMeasurement::toString() const {
+    if( !valid ) {
+        return "HeartRate[invalid]";
+    }
+    std::string res = "HeartRate["+std::to_string(getHeartRate())+" bpm";
+    if( isSensorContactSupported() ) {
+        res += isSensorContactDetected() ? ", contact" : ", no contact";
+    }
+    if( hasEnergyExpended() ) {
+        res += ", energy "+std::to_string(getEnergyExpended())+" kJ";
+    }
+    const int rrCount = getRRIntervalCount();
+    if( 0 < rrCount ) {
+        res += ", rr[";
+        for(int i=0; i<rrCount; i++) {
+            if( 0 < i ) {
+                res += ", ";
+            }
+            res += std::to_string(getRRInterval(i));
+        }
+        res += "]/1024 s";
+    }
+    return res+"]";
+}
+
+BloodPressureMeasurement::BloodPressureMeasurement(const uint8_t * source, const int size) noexcept
+: data(source), pulseRateOffset(0), userIDOffset(0), statusOffset(0), valid(false)
+{
+    if( 1 + 3*2 > size ) {
+        // min size: flags + compound value
+        return;
+    }
+    const uint8_t flags = data[0];
+    int offset = 1 + 3*2;
+    if( 0 != ( flags & Bits::HAS_TIMESTAMP ) ) {
+        offset += 7;
+    }
+    pulseRateOffset = offset;
+    if( 0 != ( flags & Bits::HAS_PULSE_RATE ) ) {
+        offset += 2;
+    }
+    userIDOffset = offset;
+    if( 0 != ( flags & Bits::HAS_USER_ID ) ) {
+        offset += 1;
+    }
+    statusOffset = offset;
+    if( 0 != ( flags & Bits::HAS_MEASUREMENT_STATUS ) ) {
+        offset += 2;
+    }
+    valid = offset <= size;
+}
+
+std::string BloodPressureMeasurement::toString() const {
+    if( !valid ) {
+        return "BloodPressure[invalid]";
+    }
+    float compound[3];
+    getCompoundValue(compound);
+    const char * unit = isKPa() ? " kPa" : " mmHg";
+    std::string res = "BloodPressure["+std::to_string(compound[0])+" / "+std::to_string(compound[1])+unit+
+                      ", mean "+std::to_string(compound[2])+unit;
+    if( hasTimestamp() ) {
+        res += ", "+getTimestamp().toString();
+    }
+    if( hasPulseRate() ) {
+        res += ", pulse "+std::to_string(getPulseRate())+" bpm";
+    }
+    if( hasUserID() ) {
+        res += ", user "+std::to_string(getUserID());
+    }
+    if( hasMeasurementStatus() ) {
+        res += ", status "+uint16HexString(getMeasurementStatus(), true);
+    }
+    return res+"]";
+}
+
+CyclingPowerMeasurement::CyclingPowerMeasurement(const uint8_t * source, const int size) noexcept
+: data(source), pedalPowerBalanceOffset(0), accumulatedTorqueOffset(0), wheelRevolutionOffset(0),
+  crankRevolutionOffset(0), accumulatedEnergyOffset(0), valid(false)
+{
+    if( 2 + 2 > size ) {
+        // min size: flags + instantaneous power
+        return;
+    }
+    const uint16_t flags = getFlags();
+    int offset = 2 + 2;
+    pedalPowerBalanceOffset = offset;
+    if( 0 != ( flags & Bits::HAS_PEDAL_POWER_BALANCE ) ) {
+        offset += 1;
+    }
+    accumulatedTorqueOffset = offset;
+    if( 0 != ( flags & Bits::HAS_ACCUMULATED_TORQUE ) ) {
+        offset += 2;
+    }
+    wheelRevolutionOffset = offset;
+    if( 0 != ( flags & Bits::HAS_WHEEL_REVOLUTION_DATA ) ) {
+        offset += 4 + 2;
+    }
+    crankRevolutionOffset = offset;
+    if( 0 != ( flags & Bits::HAS_CRANK_REVOLUTION_DATA ) ) {
+        offset += 2 + 2;
+    }
+    if( 0 != ( flags & Bits::HAS_EXTREME_FORCE_MAGNITUDES ) ) {
+        offset += 2 + 2;
+    }
+    if( 0 != ( flags & Bits::HAS_EXTREME_TORQUE_MAGNITUDES ) ) {
+        offset += 2 + 2;
+    }
+    if( 0 != ( flags & Bits::HAS_EXTREME_ANGLES ) ) {
+        offset += 3;
+    }
+    if( 0 != ( flags & Bits::HAS_TOP_DEAD_SPOT_ANGLE ) ) {
+        offset += 2;
+    }
+    if( 0 != ( flags & Bits::HAS_BOTTOM_DEAD_SPOT_ANGLE ) ) {
+        offset += 2;
+    }
+    accumulatedEnergyOffset = offset;
+    if( 0 != ( flags & Bits::HAS_ACCUMULATED_ENERGY ) ) {
+        offset += 2;
+    }
+    valid = offset <= size;
+}
+
+std::string CyclingPowerMeasurement::toString() const {
+    if( !valid ) {
+        return "CyclingPower[invalid]";
+    }
+    std::string res = "CyclingPower["+std::to_string(getInstantaneousPower())+" W";
+    if( isSet(Bits::HAS_PEDAL_POWER_BALANCE) ) {
+        res += ", balance "+std::to_string(getPedalPowerBalance())+" %";
+    }
+    if( isSet(Bits::HAS_ACCUMULATED_TORQUE) ) {
+        res += ", torque "+std::to_string(getAccumulatedTorque())+" Nm";
+    }
+    if( isSet(Bits::HAS_WHEEL_REVOLUTION_DATA) ) {
+        res += ", wheel["+std::to_string(getCumulativeWheelRevolutions())+", "+std::to_string(getLastWheelEventTime())+"/2048 s]";
+    }
+    if( isSet(Bits::HAS_CRANK_REVOLUTION_DATA) ) {
+        res += ", crank["+std::to_string(getCumulativeCrankRevolutions())+", "+std::to_string(getLastCrankEventTime())+"/1024 s]";
+    }
+    if( isSet(Bits::HAS_ACCUMULATED_ENERGY) ) {
+        res += ", energy "+std::to_string(getAccumulatedEnergy())+" kJ";
+    }
+    return res+"]";
+}
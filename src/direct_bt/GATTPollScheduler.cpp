@@ -0,0 +1,260 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include  <algorithm>
+
+#include "GATTPollScheduler.hpp"
+#include "GATTHandler.hpp"
+#include "DBTDevice.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+void GATTPollScheduler::Statistics::add(const Statistics & o) {
+    count += o.count;
+    failedCount += o.failedCount;
+    missedCount += o.missedCount;
+    jitterSumMS += o.jitterSumMS;
+    jitterMaxMS = std::max(jitterMaxMS, o.jitterMaxMS);
+    latencySumMS += o.latencySumMS;
+    latencyMaxMS = std::max(latencyMaxMS, o.latencyMaxMS);
+}
+
+std::string GATTPollScheduler::Statistics::toString() const {
+    const uint64_t n = std::max<uint64_t>(1, count);
+    return "PollStats[count "+std::to_string(count)+", failed "+std::to_string(failedCount)+", missed "+std::to_string(missedCount)+
+           ", jitter[avg "+std::to_string(jitterSumMS/n)+", max "+std::to_string(jitterMaxMS)+"]ms"+
+           ", latency[avg "+std::to_string(latencySumMS/n)+", max "+std::to_string(latencyMaxMS)+"]ms]";
+}
+
+GATTPollScheduler::GATTPollScheduler(const int threadCount, const int coalesceMS_)
+: coalesceMS(std::max(0, coalesceMS_)), nextId(1), running(true)
+{
+    const int n = std::max(1, threadCount);
+    for(int i=0; i<n; i++) {
+        workers.push_back( std::thread(&GATTPollScheduler::workerImpl, this) );
+    }
+}
+
+GATTPollScheduler::~GATTPollScheduler() {
+    stop();
+}
+
+void GATTPollScheduler::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+        running = false;
+        cv_entries.notify_all();
+    }
+    for(auto it = workers.begin(); it != workers.end(); it++) {
+        if( it->joinable() ) {
+            if( it->get_id() == std::this_thread::get_id() ) {
+                it->detach(); // stopped from a callback
+            } else {
+                it->join();
+            }
+        }
+    }
+    workers.clear();
+}
+
+int GATTPollScheduler::add(GATTCharacteristicRef characteristic, const uint32_t periodMS, PollCallback callback) {
+    if( nullptr == characteristic ) {
+        throw IllegalArgumentException("GATTPollScheduler: characteristic is null", E_FILE_LINE);
+    }
+    if( 0 == periodMS ) {
+        throw IllegalArgumentException("GATTPollScheduler: periodMS is zero", E_FILE_LINE);
+    }
+    std::shared_ptr<DBTDevice> device = characteristic->getDeviceUnchecked();
+    if( nullptr == device ) {
+        throw IllegalArgumentException("GATTPollScheduler: characteristic's device is gone: "+characteristic->toString(), E_FILE_LINE);
+    }
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    const int id = nextId++;
+    Entry e;
+    e.characteristic = characteristic;
+    e.device = device;
+    e.deviceKey = device.get();
+    e.periodMS = periodMS;
+    e.callback = callback;
+    e.deadline = getCurrentMilliseconds() + ( static_cast<uint64_t>(id) * STAGGER_MS ) % periodMS;
+    entries[id] = e;
+    cv_entries.notify_all();
+    return id;
+}
+
+bool GATTPollScheduler::remove(const int id) {
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    return 0 < entries.erase(id);
+}
+
+int GATTPollScheduler::removeAll(const DBTDevice & device) {
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    int count = 0;
+    for(auto it = entries.begin(); it != entries.end(); ) {
+        if( it->second.deviceKey == &device ) {
+            it = entries.erase(it);
+            count++;
+        } else {
+            it++;
+        }
+    }
+    return count;
+}
+
+int GATTPollScheduler::size() {
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    return entries.size();
+}
+
+GATTPollScheduler::Statistics GATTPollScheduler::getStatistics(const int id) {
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    auto it = entries.find(id);
+    return entries.end() != it ? it->second.stats : Statistics();
+}
+
+GATTPollScheduler::Statistics GATTPollScheduler::getStatistics() {
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    Statistics res;
+    for(auto it = entries.begin(); it != entries.end(); it++) {
+        res.add(it->second.stats);
+    }
+    return res;
+}
+
+void GATTPollScheduler::workerImpl() {
+    std::unique_lock<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    while( running ) {
+        // Earliest deadline of all idle devices
+        auto next = entries.end();
+        for(auto it = entries.begin(); it != entries.end(); it++) {
+            if( busyDevices.end() == busyDevices.find(it->second.deviceKey) &&
+                ( entries.end() == next || it->second.deadline < next->second.deadline ) ) {
+                next = it;
+            }
+        }
+        if( entries.end() == next ) {
+            cv_entries.wait(lock);
+            continue;
+        }
+        const uint64_t t0 = getCurrentMilliseconds();
+        if( next->second.deadline > t0 ) {
+            cv_entries.wait_for(lock, std::chrono::milliseconds(next->second.deadline - t0));
+            continue;
+        }
+        // Coalesce all entries of this device due within the window
+        const DBTDevice * deviceKey = next->second.deviceKey;
+        std::shared_ptr<DBTDevice> device = next->second.device.lock();
+        std::vector<Job> jobs;
+        for(auto it = entries.begin(); it != entries.end(); it++) {
+            const Entry & e = it->second;
+            if( e.deviceKey == deviceKey && e.deadline <= t0 + coalesceMS ) {
+                jobs.push_back( Job { it->first, e.characteristic, e.callback, e.deadline, e.periodMS } );
+            }
+        }
+        busyDevices.insert(deviceKey);
+        lock.unlock();
+
+        poll(jobs, device, t0);
+
+        lock.lock();
+        busyDevices.erase(deviceKey);
+        cv_entries.notify_all();
+    }
+}
+
+void GATTPollScheduler::poll(std::vector<Job> & jobs, const std::shared_ptr<DBTDevice> & device, const uint64_t t0) {
+    std::vector<std::shared_ptr<POctets>> values;
+    std::shared_ptr<GATTHandler> gatt = nullptr != device ? device->getGATTHandler() : nullptr;
+    if( nullptr != gatt && gatt->isOpen() ) {
+        try {
+            if( 1 == jobs.size() ) {
+                std::shared_ptr<POctets> value(new POctets(GATTHandler::number(GATTHandler::Defaults::MAX_ATT_MTU), 0));
+                if( gatt->readValue(jobs[0].characteristic->value_handle, *value) ) {
+                    values.push_back(value);
+                }
+            } else {
+                std::vector<uint16_t> handles;
+                for(auto it = jobs.begin(); it != jobs.end(); it++) {
+                    handles.push_back(it->characteristic->value_handle);
+                }
+                gatt->readValues(handles, values);
+            }
+        } catch (std::exception &e) {
+            WARN_PRINT("GATTPollScheduler::poll: Caught exception %s", e.what());
+        }
+    }
+    const uint64_t t1 = getCurrentMilliseconds();
+
+    // Update statistics and deadlines of entries not removed meanwhile
+    {
+        const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+        for(size_t i=0; i<jobs.size(); i++) {
+            auto it = entries.find(jobs[i].id);
+            if( entries.end() == it ) {
+                jobs[i].callback = nullptr; // removed
+                continue;
+            }
+            Entry & e = it->second;
+            const uint64_t jitter = t0 > e.deadline ? t0 - e.deadline : 0;
+            const uint64_t latency = t1 - t0;
+            e.stats.count++;
+            if( i >= values.size() || nullptr == values[i] ) {
+                e.stats.failedCount++;
+            }
+            e.stats.jitterSumMS += jitter;
+            e.stats.jitterMaxMS = std::max(e.stats.jitterMaxMS, jitter);
+            e.stats.latencySumMS += latency;
+            e.stats.latencyMaxMS = std::max(e.stats.latencyMaxMS, latency);
+            e.deadline += e.periodMS;
+            if( e.deadline <= t1 ) {
+                // Skip missed periods instead of bursting to catch up
+                const uint64_t missed = ( t1 - e.deadline ) / e.periodMS + 1;
+                e.stats.missedCount += missed;
+                e.deadline += missed * e.periodMS;
+            }
+        }
+    }
+    for(size_t i=0; i<jobs.size(); i++) {
+        if( nullptr == jobs[i].callback ) {
+            continue;
+        }
+        try {
+            std::shared_ptr<const POctets> value = i < values.size() ? values[i] : nullptr;
+            jobs[i].callback(jobs[i].characteristic, value, t1);
+        } catch (std::exception &e) {
+            ERR_PRINT("GATTPollScheduler::poll: Callback of %s: Caught exception %s",
+                    jobs[i].characteristic->toString().c_str(), e.what());
+        }
+    }
+}
@@ -0,0 +1,896 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include  <algorithm>
+
+extern "C" {
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <poll.h>
+    #include <sys/eventfd.h>
+}
+
+#include "BTIoctl.hpp"
+#include "L2CAPIoctl.hpp"
+
+#include "GATTServer.hpp"
+#include "GATTTypes.hpp"
+#include "ATTPDUTypes.hpp"
+#include "DBTEnv.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+/** ATT only knows 16 and 128 bit UUIDs, BT Core Spec v5.2: Vol 3, Part F ATT: 3.2.1 Attribute Type */
+static std::shared_ptr<const uuid_t> toAttributeType(const std::shared_ptr<const uuid_t> & type) {
+    if( uuid_t::TypeSize::UUID32_SZ == type->getTypeSize() ) {
+        return std::make_shared<uuid128_t>(type->toUUID128());
+    }
+    return type;
+}
+
+/**
+ * Sends the given PDU truncated to the given ATT_MTU, non-blocking.
+ * Returns 1 if sent, 0 if the socket would block and -1 on error.
+ */
+static int sendPDU(const int fd, const POctets & pdu, const int mtu) {
+    const int len = std::min(pdu.getSize(), mtu);
+    ssize_t n;
+    do {
+        n = ::send(fd, pdu.get_ptr(), len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while( 0 > n && EINTR == errno );
+    if( 0 <= n ) {
+        return 1;
+    }
+    if( EAGAIN == errno || EWOULDBLOCK == errno ) {
+        return 0;
+    }
+    return -1;
+}
+
+GATTServer::Connection::Connection(const uint64_t id_, const int fd_, const int handleCount)
+: id(id_), fd(fd_), mtu(GATTServer::number(GATTServer::Defaults::DEFAULT_ATT_MTU)),
+  ccc(new std::atomic<uint8_t>[handleCount]), open(true), reactorId(0), backlogged(false),
+  indicationPending(false), sent(0), dropped(0)
+{
+    for(int i=0; i<handleCount; i++) {
+        ccc[i] = 0;
+    }
+}
+
+GATTServer::Connection::~Connection() {
+    ::close(fd);
+}
+
+GATTServer::GATTServer(const int queueCapacity_)
+: queueCapacity( 0 < queueCapacity_ ? queueCapacity_ :
+                 DBTEnv::getInt32Property("direct_bt.gatt.server.queue", number(Defaults::QUEUE_CAPACITY), 1 /* min */, 65536 /* max */) ),
+  nextConnectionId(1), running(false), wakefd(-1), stopfd(-1), listenfd(-1)
+{
+    // handle 0x0000 is reserved, BT Core Spec v5.2: Vol 3, Part F ATT: 3.2.2 Attribute Handle
+    attrs.push_back( Attr { uuid_value_t(), AttrKind::DESCRIPTOR, 0, 0 } );
+    values.push_back(nullptr);
+}
+
+GATTServer::~GATTServer() {
+    stop();
+}
+
+void GATTServer::addAttr(const uuid_value_t & type, const AttrKind kind, const uint8_t properties, const uint16_t aux_handle,
+                         std::shared_ptr<const POctets> value) {
+    attrs.push_back( Attr { type, kind, properties, aux_handle } );
+    values.push_back(value);
+}
+
+GATTServiceRef GATTServer::addService(std::shared_ptr<const uuid_t> type, const bool isPrimary, const std::vector<CharacteristicSpec> & characteristics) {
+    const std::lock_guard<std::mutex> lock(mtx_lifecycle); // RAII-style acquire and relinquish via destructor
+    if( running ) {
+        throw IllegalStateException("GATTServer::addService: Server already started", E_FILE_LINE);
+    }
+    int count = 1;
+    for(const CharacteristicSpec & cs : characteristics) {
+        count += 0 != ( cs.properties & ( GATTCharacteristic::Notify | GATTCharacteristic::Indicate ) ) ? 3 : 2;
+    }
+    if( static_cast<int>(attrs.size()) + count > 0x10000 ) {
+        throw IllegalArgumentException("GATTServer::addService: Handle space exhausted, "+std::to_string(attrs.size()-1)+" + "+
+                                       std::to_string(count)+" attributes", E_FILE_LINE);
+    }
+    const uint16_t startHandle = nextHandle();
+    const uint16_t endHandle = static_cast<uint16_t>( startHandle + count - 1 );
+    const std::shared_ptr<const uuid_t> serviceType = toAttributeType(type);
+
+    GATTServiceRef service = std::make_shared<GATTService>(nullptr, isPrimary, startHandle, endHandle, serviceType);
+    std::shared_ptr<POctets> serviceDecl = std::make_shared<POctets>(serviceType->getTypeSize());
+    serviceDecl->put_uuid(0, *serviceType);
+    addAttr(uuid_value_t( uuid16_t( isPrimary ? GattAttributeType::PRIMARY_SERVICE : GattAttributeType::SECONDARY_SERVICE ) ),
+            AttrKind::SERVICE, 0, endHandle, serviceDecl);
+
+    for(const CharacteristicSpec & cs : characteristics) {
+        const uint16_t declHandle = nextHandle();
+        const uint16_t valueHandle = static_cast<uint16_t>( declHandle + 1 );
+        const std::shared_ptr<const uuid_t> valueType = toAttributeType(cs.type);
+
+        // BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.1 Characteristic Declaration
+        GATTCharacteristicRef c = std::make_shared<GATTCharacteristic>(service, startHandle, declHandle, cs.properties, valueHandle, valueType);
+        std::shared_ptr<POctets> charDecl = std::make_shared<POctets>(3 + valueType->getTypeSize());
+        charDecl->put_uint8(0, cs.properties);
+        charDecl->put_uint16(1, valueHandle);
+        charDecl->put_uuid(3, *valueType);
+        addAttr(uuid_value_t( uuid16_t( GattAttributeType::CHARACTERISTIC ) ), AttrKind::CHAR_DECL, 0, 0, charDecl);
+        addAttr(uuid_value_t(*valueType), AttrKind::CHAR_VALUE, cs.properties, 0, std::make_shared<POctets>(cs.value));
+
+        if( 0 != ( cs.properties & ( GATTCharacteristic::Notify | GATTCharacteristic::Indicate ) ) ) {
+            // BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3 Client Characteristic Configuration, value is per connection
+            GATTDescriptorRef d = std::make_shared<GATTDescriptor>(c, std::make_shared<uuid16_t>(GATTDescriptor::TYPE_CCC_DESC), nextHandle());
+            c->clientCharacteristicsConfigIndex = static_cast<int>(c->descriptorList.size());
+            c->descriptorList.push_back(d);
+            addAttr(uuid_value_t(GATTDescriptor::TYPE_CCC_DESC), AttrKind::DESCRIPTOR, cs.properties, valueHandle, nullptr);
+        }
+        service->characteristicList.push_back(c);
+    }
+    services.push_back(service);
+    DBG_PRINT("GATTServer::addService: %s", service->toString().c_str());
+    return service;
+}
+
+GATTCharacteristicRef GATTServer::findCharacteristic(const uuid_t & type) const {
+    for(const GATTServiceRef & s : services) {
+        for(const GATTCharacteristicRef & c : s->characteristicList) {
+            if( type == *c->value_type ) {
+                return c;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool GATTServer::start() {
+    const std::lock_guard<std::mutex> lock(mtx_lifecycle); // RAII-style acquire and relinquish via destructor
+    if( running ) {
+        return true;
+    }
+    table.reset( new GATTAttributeTable(services) );
+    reactor = L2CAPReactor::create(DBTEnv::getInt32Property("direct_bt.gatt.server.reactor", 1, 1 /* min */, 16 /* max */),
+                                   DBTThreadOptions("direct_bt.gatt.server", "dbt_gatt_server"));
+    if( !reactor->isRunning() ) {
+        ERR_PRINT("GATTServer::start: Reactor not running");
+        reactor = nullptr;
+        return false;
+    }
+    wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    stopfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if( 0 > wakefd || 0 > stopfd ) {
+        ERR_PRINT("GATTServer::start: eventfd failed");
+        if( 0 <= wakefd ) { ::close(wakefd); wakefd = -1; }
+        if( 0 <= stopfd ) { ::close(stopfd); stopfd = -1; }
+        reactor->stop();
+        reactor = nullptr;
+        return false;
+    }
+    running = true;
+    senderThread = std::thread(&GATTServer::senderImpl, this);
+    DBG_PRINT("GATTServer::start: %s", toString().c_str());
+    return true;
+}
+
+void GATTServer::stop() {
+    const std::lock_guard<std::mutex> lock(mtx_lifecycle); // RAII-style acquire and relinquish via destructor
+    if( !running ) {
+        return;
+    }
+    running = false;
+    const uint64_t one = 1;
+    if( sizeof(one) != ::write(stopfd, &one, sizeof(one)) ) {
+        ERR_PRINT("GATTServer::stop: eventfd write failed");
+    }
+    if( acceptThread.joinable() ) {
+        acceptThread.join();
+    }
+    if( 0 <= listenfd ) {
+        ::close(listenfd);
+        listenfd = -1;
+    }
+    if( senderThread.joinable() ) {
+        senderThread.join();
+    }
+    const COWVector<std::shared_ptr<Connection>>::snapshot_t snapshot = connections.get_snapshot();
+    for(const std::shared_ptr<Connection> & c : *snapshot) {
+        reactor->remove(c->reactorId, true /* wait */);
+        closed(c);
+    }
+    reactor->stop();
+    reactor = nullptr;
+    ::close(wakefd);
+    ::close(stopfd);
+    wakefd = -1;
+    stopfd = -1;
+    DBG_PRINT("GATTServer::stop: %s", toString().c_str());
+}
+
+bool GATTServer::listen(const EUI48 & adapterAddress, const bool pubaddrAdapter) {
+    const std::lock_guard<std::mutex> lock(mtx_lifecycle); // RAII-style acquire and relinquish via destructor
+    if( !running ) {
+        return false;
+    }
+    if( 0 <= listenfd ) {
+        return true;
+    }
+    const int dd = ::socket(AF_BLUETOOTH, SOCK_SEQPACKET | SOCK_CLOEXEC, BTPROTO_L2CAP);
+    if( 0 > dd ) {
+        ERR_PRINT("GATTServer::listen: socket failed");
+        return false;
+    }
+    // BT Core Spec v5.2: Vol 3, Part G GATT: 5.2.2 LE channel requirements, fixed ATT channel
+    sockaddr_l2 a;
+    bzero((void *)&a, sizeof(a));
+    a.l2_family = AF_BLUETOOTH;
+    a.l2_psm = 0;
+    a.l2_bdaddr = adapterAddress;
+    a.l2_cid = cpu_to_le(L2CAP_CID_ATT);
+    a.l2_bdaddr_type = pubaddrAdapter ? BDADDR_LE_PUBLIC : BDADDR_LE_RANDOM;
+    if( 0 > ::bind(dd, (struct sockaddr *) &a, sizeof(a)) ) {
+        ERR_PRINT("GATTServer::listen: bind failed");
+        ::close(dd);
+        return false;
+    }
+    if( 0 > ::listen(dd, 8) ) {
+        ERR_PRINT("GATTServer::listen: listen failed");
+        ::close(dd);
+        return false;
+    }
+    listenfd = dd;
+    acceptThread = std::thread(&GATTServer::acceptImpl, this);
+    DBG_PRINT("GATTServer::listen: Listening on %s", adapterAddress.toString().c_str());
+    return true;
+}
+
+void GATTServer::acceptImpl() {
+    struct pollfd pfds[2] = { { stopfd, POLLIN, 0 }, { listenfd, POLLIN, 0 } };
+    while( running ) {
+        pfds[0].revents = 0;
+        pfds[1].revents = 0;
+        if( 0 > ::poll(pfds, 2, -1) ) {
+            if( EINTR == errno ) {
+                continue;
+            }
+            ERR_PRINT("GATTServer::accept: poll failed");
+            break;
+        }
+        if( !running || 0 != pfds[0].revents ) {
+            break;
+        }
+        if( 0 != ( pfds[1].revents & ( POLLERR | POLLHUP | POLLNVAL ) ) ) {
+            ERR_PRINT("GATTServer::accept: listening socket failed, revents %d", pfds[1].revents);
+            break;
+        }
+        const int fd = ::accept4(listenfd, nullptr, nullptr, SOCK_CLOEXEC);
+        if( 0 > fd ) {
+            if( EINTR != errno && EAGAIN != errno && ECONNABORTED != errno ) {
+                ERR_PRINT("GATTServer::accept: accept failed");
+            }
+            continue;
+        }
+        addConnection(fd);
+    }
+}
+
+uint64_t GATTServer::addConnection(const int fd) {
+    if( 0 > fd ) {
+        return 0;
+    }
+    if( !running ) {
+        ::close(fd);
+        return 0;
+    }
+    std::shared_ptr<Connection> c = std::make_shared<Connection>(nextConnectionId++, fd, static_cast<int>(attrs.size()));
+    connections.push_back(c);
+    const uint64_t reactorId = reactor->add(fd, number(Defaults::SERVER_ATT_MTU),
+            bindStdFunc(c->id, std::function<bool(const uint8_t *, int)>( [this, c](const uint8_t * data, int len) -> bool {
+                return received(c, data, len);
+            } )));
+    if( 0 == reactorId ) {
+        ERR_PRINT("GATTServer::addConnection: Reactor refused connection %" PRIu64, c->id);
+        c->open = false;
+        connections.erase_matching(false /* all */, [&](const std::shared_ptr<Connection> & e) { return e == c; });
+        return 0;
+    }
+    c->reactorId = reactorId;
+    DBG_PRINT("GATTServer::addConnection: Connection %" PRIu64 ", fd %d", c->id, fd);
+    return c->id;
+}
+
+bool GATTServer::removeConnection(const uint64_t connectionId) {
+    const COWVector<std::shared_ptr<Connection>>::snapshot_t snapshot = connections.get_snapshot();
+    for(const std::shared_ptr<Connection> & c : *snapshot) {
+        if( connectionId == c->id ) {
+            if( nullptr != reactor ) {
+                reactor->remove(c->reactorId, true /* wait */);
+            }
+            closed(c);
+            return true;
+        }
+    }
+    return false;
+}
+
+void GATTServer::closed(const std::shared_ptr<Connection> & c) {
+    bool expected = true;
+    if( !c->open.compare_exchange_strong(expected, false) ) {
+        return;
+    }
+    connections.erase_matching(false /* all */, [&](const std::shared_ptr<Connection> & e) { return e == c; });
+    {
+        const std::lock_guard<std::mutex> lock(c->mtx_queue); // RAII-style acquire and relinquish via destructor
+        c->queue.clear();
+        c->indications.clear();
+        c->backlogged = false;
+    }
+    DBG_PRINT("GATTServer::closed: Connection %" PRIu64 ", sent %" PRIu64 ", dropped %" PRIu64,
+              c->id, c->sent.load(), c->dropped.load());
+    for_each_cow(listeners, [&](const std::shared_ptr<GATTServerListener> & l) {
+        try {
+            l->connectionClosed(*this, c->id);
+        } catch (std::exception &e) {
+            ERR_PRINT("GATTServer::closed: Connection %" PRIu64 ": Caught exception %s", c->id, e.what());
+        }
+    });
+}
+
+std::vector<GATTServer::ConnectionStats> GATTServer::getConnectionStats() const {
+    std::vector<ConnectionStats> res;
+    const COWVector<std::shared_ptr<Connection>>::snapshot_t snapshot = connections.get_snapshot();
+    for(const std::shared_ptr<Connection> & c : *snapshot) {
+        const std::lock_guard<std::mutex> lock(c->mtx_queue); // RAII-style acquire and relinquish via destructor
+        res.push_back( ConnectionStats { c->id, c->mtu.load(), static_cast<int>(c->queue.size() + c->indications.size()),
+                                         c->sent.load(), c->dropped.load() } );
+    }
+    return res;
+}
+
+bool GATTServer::addListener(std::shared_ptr<GATTServerListener> l) {
+    if( nullptr == l ) {
+        throw IllegalArgumentException("GATTServerListener ref is null", E_FILE_LINE);
+    }
+    return listeners.push_back_unique(l, [](const std::shared_ptr<GATTServerListener> &a, const std::shared_ptr<GATTServerListener> &b) -> bool { return a == b; });
+}
+
+bool GATTServer::removeListener(std::shared_ptr<GATTServerListener> l) {
+    if( nullptr == l ) {
+        throw IllegalArgumentException("GATTServerListener ref is null", E_FILE_LINE);
+    }
+    return 0 < listeners.erase_matching(false /* all */, [&](const std::shared_ptr<GATTServerListener> & e) { return e == l; });
+}
+
+bool GATTServer::setValue(const uint16_t valueHandle, const TROOctets & value) {
+    if( valueHandle >= attrs.size() || AttrKind::CHAR_VALUE != attrs[valueHandle].kind ) {
+        return false;
+    }
+    std::atomic_store(&values[valueHandle], std::shared_ptr<const POctets>( std::make_shared<POctets>(value) ) );
+    return true;
+}
+
+std::shared_ptr<const POctets> GATTServer::getValue(const uint16_t valueHandle) const {
+    if( valueHandle >= attrs.size() || AttrKind::CHAR_VALUE != attrs[valueHandle].kind ) {
+        return nullptr;
+    }
+    return std::atomic_load(&values[valueHandle]);
+}
+
+std::shared_ptr<const POctets> GATTServer::readValue(const Connection & c, const uint16_t handle) const {
+    const Attr & a = attrs[handle];
+    if( AttrKind::DESCRIPTOR == a.kind && 0 != a.aux_handle ) {
+        std::shared_ptr<POctets> v = std::make_shared<POctets>(2);
+        v->put_uint16(0, c.ccc[a.aux_handle].load());
+        return v;
+    }
+    return std::atomic_load(&values[handle]);
+}
+
+// *************************************************
+// *************************************************
+// *************************************************
+
+void GATTServer::wakeSender() {
+    const uint64_t one = 1;
+    if( sizeof(one) != ::write(wakefd, &one, sizeof(one)) ) {
+        ERR_PRINT("GATTServer::wakeSender: eventfd write failed");
+    }
+}
+
+bool GATTServer::flushLocked(Connection & c) {
+    const int mtu = c.mtu;
+    int res = 1;
+    while( !c.queue.empty() && 0 < ( res = sendPDU(c.fd, *c.queue.front().first, mtu) ) ) {
+        c.queue.pop_front();
+        c.sent++;
+    }
+    if( 0 < res && !c.indicationPending && !c.indications.empty() &&
+        0 < ( res = sendPDU(c.fd, *c.indications.front(), mtu) ) )
+    {
+        c.indications.pop_front();
+        c.indicationPending = true;
+        c.sent++;
+    }
+    if( 0 > res ) {
+        // connection failed, pending PDUs are void; the reactor reports the hangup
+        DBG_PRINT("GATTServer::flush: Connection %" PRIu64 ": send failed, errno %d %s", c.id, errno, strerror(errno));
+        c.queue.clear();
+        c.indications.clear();
+    }
+    c.backlogged = 0 == res;
+    return c.backlogged;
+}
+
+void GATTServer::flush(Connection & c) {
+    const std::lock_guard<std::mutex> lock(c.mtx_queue); // RAII-style acquire and relinquish via destructor
+    flushLocked(c);
+}
+
+void GATTServer::enqueue(Connection & c, std::shared_ptr<const POctets> pdu, const bool notification) {
+    bool wake = false;
+    {
+        const std::lock_guard<std::mutex> lock(c.mtx_queue); // RAII-style acquire and relinquish via destructor
+        if( notification && static_cast<int>(c.queue.size()) >= queueCapacity ) {
+            // drop the oldest notification, responses are kept
+            auto it = std::find_if(c.queue.begin(), c.queue.end(),
+                    [](const std::pair<std::shared_ptr<const POctets>, bool> & e) { return e.second; });
+            if( c.queue.end() != it ) {
+                c.queue.erase(it);
+                c.dropped++;
+            }
+        }
+        c.queue.push_back( std::make_pair(std::move(pdu), notification) );
+        if( !c.backlogged ) {
+            // send directly on the calling thread, the sender thread only serves backlogged connections
+            wake = flushLocked(c);
+        }
+    }
+    if( wake ) {
+        wakeSender();
+    }
+}
+
+void GATTServer::senderImpl() {
+    std::vector<struct pollfd> pfds;
+    std::vector<std::shared_ptr<Connection>> pending;
+    while( running ) {
+        pfds.clear();
+        pending.clear();
+        pfds.push_back( { stopfd, POLLIN, 0 } );
+        pfds.push_back( { wakefd, POLLIN, 0 } );
+        const COWVector<std::shared_ptr<Connection>>::snapshot_t snapshot = connections.get_snapshot();
+        for(const std::shared_ptr<Connection> & c : *snapshot) {
+            if( c->backlogged ) {
+                pfds.push_back( { c->fd, POLLOUT, 0 } );
+                pending.push_back(c);
+            }
+        }
+        if( 0 > ::poll(pfds.data(), pfds.size(), -1) ) {
+            if( EINTR == errno ) {
+                continue;
+            }
+            ERR_PRINT("GATTServer::sender: poll failed");
+            break;
+        }
+        if( !running || 0 != pfds[0].revents ) {
+            break;
+        }
+        if( 0 != pfds[1].revents ) {
+            uint64_t v;
+            if( sizeof(v) != ::read(wakefd, &v, sizeof(v)) ) {
+                DBG_PRINT("GATTServer::sender: eventfd read failed");
+            }
+        }
+        for(size_t i=0; i<pending.size(); i++) {
+            if( 0 != pfds[i+2].revents ) {
+                flush(*pending[i]);
+            }
+        }
+    }
+}
+
+int GATTServer::fanOut(const uint16_t valueHandle, const TROOctets & value, const bool indication) {
+    if( !setValue(valueHandle, value) ) {
+        return -1;
+    }
+    if( !running ) {
+        return 0;
+    }
+    // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.7.1 and 3.4.7.2, encoded once and shared by all connections
+    std::shared_ptr<POctets> encoded = std::make_shared<POctets>(3 + value.getSize());
+    encoded->put_uint8(0, indication ? AttPDUMsg::ATT_HANDLE_VALUE_IND : AttPDUMsg::ATT_HANDLE_VALUE_NTF);
+    encoded->put_uint16(1, valueHandle);
+    encoded->put_octets(3, value);
+    const std::shared_ptr<const POctets> pdu = encoded;
+
+    // BT Core Spec v5.2: Vol 3, Part G GATT: 3.3.3.3 Client Characteristic Configuration bit 0 notification, bit 1 indication
+    const uint8_t mask = indication ? 0x02 : 0x01;
+    int count = 0;
+    const COWVector<std::shared_ptr<Connection>>::snapshot_t snapshot = connections.get_snapshot();
+    for(const std::shared_ptr<Connection> & c : *snapshot) {
+        if( !c->open || 0 == ( c->ccc[valueHandle] & mask ) ) {
+            continue;
+        }
+        if( indication ) {
+            bool wake = false;
+            {
+                const std::lock_guard<std::mutex> lock(c->mtx_queue); // RAII-style acquire and relinquish via destructor
+                if( static_cast<int>(c->indications.size()) >= queueCapacity ) {
+                    c->indications.pop_front();
+                    c->dropped++;
+                }
+                c->indications.push_back(pdu);
+                if( !c->backlogged ) {
+                    wake = flushLocked(*c);
+                }
+            }
+            if( wake ) {
+                wakeSender();
+            }
+        } else {
+            enqueue(*c, pdu, true /* notification */);
+        }
+        count++;
+    }
+    return count;
+}
+
+int GATTServer::notify(const uint16_t valueHandle, const TROOctets & value) {
+    return fanOut(valueHandle, value, false /* indication */);
+}
+
+int GATTServer::indicate(const uint16_t valueHandle, const TROOctets & value) {
+    return fanOut(valueHandle, value, true /* indication */);
+}
+
+// *************************************************
+// *************************************************
+// *************************************************
+
+bool GATTServer::received(const std::shared_ptr<Connection> & c, const uint8_t * data, const int len) {
+    if( nullptr == data || 0 > len ) {
+        closed(c);
+        return false;
+    }
+    if( 0 < len && c->open ) {
+        try {
+            handleRequest(*c, data, len);
+        } catch (std::exception &e) {
+            ERR_PRINT("GATTServer::received: Connection %" PRIu64 ": Caught exception %s", c->id, e.what());
+        }
+    }
+    return c->open;
+}
+
+void GATTServer::sendError(Connection & c, const uint8_t reqOpcode, const uint16_t handle, const uint8_t errorCode) {
+    // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.1.1 ATT_ERROR_RSP
+    std::shared_ptr<POctets> rsp = std::make_shared<POctets>(5);
+    rsp->put_uint8(0, AttPDUMsg::ATT_ERROR_RSP);
+    rsp->put_uint8(1, reqOpcode);
+    rsp->put_uint16(2, handle);
+    rsp->put_uint8(4, errorCode);
+    enqueue(c, rsp, false /* notification */);
+}
+
+void GATTServer::handleRequest(Connection & c, const uint8_t * pdu, const int len) {
+    const uint8_t opcode = pdu[0];
+    const int mtu = c.mtu;
+    const uint16_t lastHandle = static_cast<uint16_t>( attrs.size() - 1 );
+
+    switch( opcode ) {
+        case AttPDUMsg::ATT_EXCHANGE_MTU_REQ: {
+            // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.2.1 ATT_EXCHANGE_MTU_REQ
+            if( 3 != len ) {
+                sendError(c, opcode, 0, AttErrorRsp::INVALID_PDU);
+                return;
+            }
+            const int clientMTU = get_uint16(pdu, 1, true /* littleEndian */);
+            std::shared_ptr<POctets> rsp = std::make_shared<POctets>(3);
+            rsp->put_uint8(0, AttPDUMsg::ATT_EXCHANGE_MTU_RSP);
+            rsp->put_uint16(1, number(Defaults::SERVER_ATT_MTU));
+            enqueue(c, rsp, false /* notification */);
+            c.mtu = static_cast<uint16_t>( std::max(number(Defaults::DEFAULT_ATT_MTU),
+                                                    std::min(clientMTU, number(Defaults::SERVER_ATT_MTU))) );
+            return;
+        }
+        case AttPDUMsg::ATT_FIND_INFORMATION_REQ:
+        case AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_REQ:
+        case AttPDUMsg::ATT_READ_BY_TYPE_REQ:
+        case AttPDUMsg::ATT_READ_BY_GROUP_TYPE_REQ:
+            break; // handle range requests below
+        case AttPDUMsg::ATT_READ_REQ:
+        case AttPDUMsg::ATT_READ_BLOB_REQ: {
+            // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.4.3 ATT_READ_REQ and 3.4.4.5 ATT_READ_BLOB_REQ
+            const bool blob = AttPDUMsg::ATT_READ_BLOB_REQ == opcode;
+            if( ( blob ? 5 : 3 ) != len ) {
+                sendError(c, opcode, 0, AttErrorRsp::INVALID_PDU);
+                return;
+            }
+            const uint16_t handle = get_uint16(pdu, 1, true /* littleEndian */);
+            if( 0 == handle || handle > lastHandle ) {
+                sendError(c, opcode, handle, AttErrorRsp::INVALID_HANDLE);
+                return;
+            }
+            const Attr & a = attrs[handle];
+            if( AttrKind::CHAR_VALUE == a.kind && 0 == ( a.properties & GATTCharacteristic::Read ) ) {
+                sendError(c, opcode, handle, AttErrorRsp::NO_READ_PERM);
+                return;
+            }
+            const std::shared_ptr<const POctets> v = readValue(c, handle);
+            const int offset = blob ? get_uint16(pdu, 3, true /* littleEndian */) : 0;
+            const int size = nullptr != v ? v->getSize() : 0;
+            if( offset > size ) {
+                sendError(c, opcode, handle, AttErrorRsp::INVALID_OFFSET);
+                return;
+            }
+            const int n = std::min(size - offset, mtu - 1);
+            std::shared_ptr<POctets> rsp = std::make_shared<POctets>(1 + n);
+            rsp->put_uint8(0, blob ? AttPDUMsg::ATT_READ_BLOB_RSP : AttPDUMsg::ATT_READ_RSP);
+            if( 0 < n ) {
+                memcpy(rsp->get_wptr(1), v->get_ptr() + offset, n);
+            }
+            enqueue(c, rsp, false /* notification */);
+            return;
+        }
+        case AttPDUMsg::ATT_WRITE_REQ:
+        case AttPDUMsg::ATT_WRITE_CMD:
+            handleWrite(c, opcode, pdu, len);
+            return;
+        case AttPDUMsg::ATT_HANDLE_VALUE_CFM: {
+            // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.7.3 ATT_HANDLE_VALUE_CFM
+            bool wake = false;
+            {
+                const std::lock_guard<std::mutex> lock(c.mtx_queue); // RAII-style acquire and relinquish via destructor
+                c.indicationPending = false;
+                if( !c.backlogged ) {
+                    wake = flushLocked(c);
+                }
+            }
+            if( wake ) {
+                wakeSender();
+            }
+            return;
+        }
+        default:
+            if( 0 == ( opcode & AttPDUMsg::ATT_COMMAND_FLAG ) ) {
+                sendError(c, opcode, 0, AttErrorRsp::UNSUPPORTED_REQUEST);
+            } // else commands are ignored, BT Core Spec v5.2: Vol 3, Part F ATT: 3.3 Attribute PDU
+            return;
+    }
+
+    // Range requests: start handle, end handle, ..., BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.3 and 3.4.4
+    const bool validLen =
+            ( AttPDUMsg::ATT_FIND_INFORMATION_REQ == opcode && 5 == len ) ||
+            ( AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_REQ == opcode && 7 <= len ) ||
+            ( ( AttPDUMsg::ATT_READ_BY_TYPE_REQ == opcode || AttPDUMsg::ATT_READ_BY_GROUP_TYPE_REQ == opcode ) && ( 7 == len || 21 == len ) );
+    if( !validLen ) {
+        sendError(c, opcode, 0, AttErrorRsp::INVALID_PDU);
+        return;
+    }
+    const uint16_t startHandle = get_uint16(pdu, 1, true /* littleEndian */);
+    const uint16_t endHandle = std::min(get_uint16(pdu, 3, true /* littleEndian */), lastHandle);
+    if( 0 == startHandle || startHandle > get_uint16(pdu, 3, true /* littleEndian */) ) {
+        sendError(c, opcode, startHandle, AttErrorRsp::INVALID_HANDLE);
+        return;
+    }
+    std::shared_ptr<POctets> rsp = std::make_shared<POctets>(mtu);
+    int pos = 0;
+
+    if( AttPDUMsg::ATT_FIND_INFORMATION_REQ == opcode ) {
+        // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.3.2 ATT_FIND_INFORMATION_RSP, format 0x01 16 bit or 0x02 128 bit UUIDs
+        int typeSize = 0;
+        pos = 2;
+        for(int h=startHandle; h <= endHandle; h++) {
+            const uuid_value_t & type = attrs[h].type;
+            if( 0 == typeSize ) {
+                typeSize = type.getTypeSize();
+            } else if( typeSize != type.getTypeSize() ) {
+                break;
+            }
+            if( pos + 2 + typeSize > mtu ) {
+                break;
+            }
+            rsp->put_uint16(pos, static_cast<uint16_t>(h));
+            memcpy(rsp->get_wptr(pos + 2), type.data(), typeSize);
+            pos += 2 + typeSize;
+        }
+        if( 0 == typeSize ) {
+            sendError(c, opcode, startHandle, AttErrorRsp::ATTRIBUTE_NOT_FOUND);
+            return;
+        }
+        rsp->put_uint8(0, AttPDUMsg::ATT_FIND_INFORMATION_RSP);
+        rsp->put_uint8(1, uuid_t::TypeSize::UUID16_SZ == typeSize ? 0x01 : 0x02);
+
+    } else if( AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_REQ == opcode ) {
+        // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.3.4 ATT_FIND_BY_TYPE_VALUE_RSP, handle and group end handle
+        const uuid_value_t type(uuid_t::TypeSize::UUID16_SZ, pdu, 5);
+        const int valueLen = len - 7;
+        pos = 1;
+        for(int h=startHandle; h <= endHandle && pos + 4 <= mtu; h++) {
+            const Attr & a = attrs[h];
+            if( type != a.type ) {
+                continue;
+            }
+            const std::shared_ptr<const POctets> v = readValue(c, static_cast<uint16_t>(h));
+            if( nullptr == v || v->getSize() != valueLen || 0 != memcmp(v->get_ptr(), pdu + 7, valueLen) ) {
+                continue;
+            }
+            rsp->put_uint16(pos, static_cast<uint16_t>(h));
+            rsp->put_uint16(pos + 2, AttrKind::SERVICE == a.kind ? a.aux_handle : static_cast<uint16_t>(h));
+            pos += 4;
+        }
+        if( 1 == pos ) {
+            sendError(c, opcode, startHandle, AttErrorRsp::ATTRIBUTE_NOT_FOUND);
+            return;
+        }
+        rsp->put_uint8(0, AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_RSP);
+
+    } else {
+        // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.4.2 ATT_READ_BY_TYPE_RSP and 3.4.4.10 ATT_READ_BY_GROUP_TYPE_RSP,
+        // all pairs of equal length with values truncated to fit one response
+        const bool group = AttPDUMsg::ATT_READ_BY_GROUP_TYPE_REQ == opcode;
+        const uuid_value_t type(7 == len ? uuid_t::TypeSize::UUID16_SZ : uuid_t::TypeSize::UUID128_SZ, pdu, 5);
+        if( group && type != uuid_value_t( uuid16_t( GattAttributeType::PRIMARY_SERVICE ) ) &&
+                     type != uuid_value_t( uuid16_t( GattAttributeType::SECONDARY_SERVICE ) ) )
+        {
+            sendError(c, opcode, startHandle, AttErrorRsp::UNSUPPORTED_GROUP_TYPE);
+            return;
+        }
+        const int headerLen = group ? 4 : 2;
+        const int maxValueLen = std::min(mtu - 2 - headerLen, 255 - headerLen);
+        int pairLen = 0;
+        pos = 2;
+        for(int h=startHandle; h <= endHandle; h++) {
+            const Attr & a = attrs[h];
+            if( type != a.type ) {
+                continue;
+            }
+            if( AttrKind::CHAR_VALUE == a.kind && 0 == ( a.properties & GATTCharacteristic::Read ) ) {
+                if( 0 == pairLen ) {
+                    sendError(c, opcode, static_cast<uint16_t>(h), AttErrorRsp::NO_READ_PERM);
+                    return;
+                }
+                break;
+            }
+            const std::shared_ptr<const POctets> v = readValue(c, static_cast<uint16_t>(h));
+            const int valueLen = std::min(nullptr != v ? v->getSize() : 0, maxValueLen);
+            if( 0 == pairLen ) {
+                pairLen = headerLen + valueLen;
+            } else if( pairLen != headerLen + valueLen || pos + pairLen > mtu ) {
+                break;
+            }
+            rsp->put_uint16(pos, static_cast<uint16_t>(h));
+            if( group ) {
+                rsp->put_uint16(pos + 2, a.aux_handle);
+            }
+            if( 0 < valueLen ) {
+                memcpy(rsp->get_wptr(pos + headerLen), v->get_ptr(), valueLen);
+            }
+            pos += pairLen;
+        }
+        if( 0 == pairLen ) {
+            sendError(c, opcode, startHandle, AttErrorRsp::ATTRIBUTE_NOT_FOUND);
+            return;
+        }
+        rsp->put_uint8(0, group ? AttPDUMsg::ATT_READ_BY_GROUP_TYPE_RSP : AttPDUMsg::ATT_READ_BY_TYPE_RSP);
+        rsp->put_uint8(1, static_cast<uint8_t>(pairLen));
+    }
+    rsp->resize(pos);
+    enqueue(c, rsp, false /* notification */);
+}
+
+void GATTServer::handleWrite(Connection & c, const uint8_t opcode, const uint8_t * pdu, const int len) {
+    // BT Core Spec v5.2: Vol 3, Part F ATT: 3.4.5.1 ATT_WRITE_REQ and 3.4.5.3 ATT_WRITE_CMD
+    const bool isCmd = AttPDUMsg::ATT_WRITE_CMD == opcode;
+    if( 3 > len ) {
+        if( !isCmd ) {
+            sendError(c, opcode, 0, AttErrorRsp::INVALID_PDU);
+        }
+        return;
+    }
+    const uint16_t handle = get_uint16(pdu, 1, true /* littleEndian */);
+    const TROOctets value(pdu + 3, len - 3);
+    uint8_t error = 0;
+
+    if( 0 == handle || handle >= attrs.size() ) {
+        error = AttErrorRsp::INVALID_HANDLE;
+    } else {
+        const Attr & a = attrs[handle];
+        if( AttrKind::DESCRIPTOR == a.kind && 0 != a.aux_handle ) {
+            if( 2 != value.getSize() ) {
+                error = AttErrorRsp::INVALID_ATTRIBUTE_VALUE_LEN;
+            } else {
+                // only enable what the characteristic supports
+                uint8_t ccc = 0;
+                if( 0 != ( a.properties & GATTCharacteristic::Notify ) ) {
+                    ccc |= value.get_uint8(0) & 0x01;
+                }
+                if( 0 != ( a.properties & GATTCharacteristic::Indicate ) ) {
+                    ccc |= value.get_uint8(0) & 0x02;
+                }
+                const uint8_t old = c.ccc[a.aux_handle].exchange(ccc);
+                if( old != ccc ) {
+                    const GATTCharacteristicRef characteristic = table->getCharacteristicByValueHandle(a.aux_handle);
+                    for_each_cow(listeners, [&](const std::shared_ptr<GATTServerListener> & l) {
+                        try {
+                            l->subscriptionChanged(*this, c.id, characteristic, 0 != ( ccc & 0x01 ), 0 != ( ccc & 0x02 ));
+                        } catch (std::exception &e) {
+                            ERR_PRINT("GATTServer::handleWrite: Caught exception %s", e.what());
+                        }
+                    });
+                }
+            }
+        } else if( AttrKind::CHAR_VALUE == a.kind &&
+                   0 != ( a.properties & ( isCmd ? GATTCharacteristic::WriteNoAck : GATTCharacteristic::WriteWithAck ) ) )
+        {
+            if( value.getSize() > number(Defaults::SERVER_ATT_MTU) ) {
+                // BT Core Spec v5.2: Vol 3, Part F ATT: 3.2.9 Long attribute values, maximum length 512
+                error = AttErrorRsp::INVALID_ATTRIBUTE_VALUE_LEN;
+            } else {
+                const GATTCharacteristicRef characteristic = table->getCharacteristicByValueHandle(handle);
+                bool accepted = true;
+                for_each_cow(listeners, [&](const std::shared_ptr<GATTServerListener> & l) {
+                    try {
+                        accepted = l->writeRequest(*this, c.id, characteristic, value) && accepted;
+                    } catch (std::exception &e) {
+                        ERR_PRINT("GATTServer::handleWrite: Caught exception %s", e.what());
+                        accepted = false;
+                    }
+                });
+                if( accepted ) {
+                    setValue(handle, value);
+                } else {
+                    error = AttErrorRsp::NO_WRITE_PERM;
+                }
+            }
+        } else {
+            error = AttErrorRsp::NO_WRITE_PERM;
+        }
+    }
+    if( isCmd ) {
+        return;
+    }
+    if( 0 != error ) {
+        sendError(c, opcode, handle, error);
+        return;
+    }
+    std::shared_ptr<POctets> rsp = std::make_shared<POctets>(1);
+    rsp->put_uint8(0, AttPDUMsg::ATT_WRITE_RSP);
+    enqueue(c, rsp, false /* notification */);
+}
+
+std::string GATTServer::toString() const {
+    return "GATTServer[running "+std::to_string(running.load())+", services "+std::to_string(services.size())+
+           ", handles "+std::to_string(attrs.size()-1)+", connections "+std::to_string(connections.size())+
+           ", queue "+std::to_string(queueCapacity)+"]";
+}
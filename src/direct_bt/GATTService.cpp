@@ -52,7 +52,7 @@ std::string GATTService::toString() const {
         const uint16_t uuid16 = (static_cast<const uuid16_t*>(type.get()))->value;
         name = " - "+GattServiceTypeToString(static_cast<GattServiceType>(uuid16));
     }
-    return "type 0x"+type->toString()+", handle ["+uint16HexString(startHandle, true)+".."+uint16HexString(endHandle, true)+"]"+
+    return "type 0x"+getTypeString(false)+", handle ["+uint16HexString(startHandle, true)+".."+uint16HexString(endHandle, true)+"]"+
                 name+", "+std::to_string(characteristicList.size())+" characteristics";
 }
 
@@ -31,11 +31,13 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <atomic>
 
 // #define VERBOSE_ON 1
 #include <dbt_debug.hpp>
 
 #include "HCIComm.hpp"
+#include "PacketCapture.hpp"
 
 extern "C" {
     #include <inttypes.h>
@@ -46,6 +48,7 @@ extern "C" {
     #include <sys/ioctl.h>
     #include <sys/socket.h>
     #include <poll.h>
+    #include <sys/eventfd.h>
 }
 
 namespace direct_bt {
@@ -95,15 +98,141 @@ int HCIComm::hci_close_dev(int dd)
 	return ::close(dd);
 }
 
+static std::atomic<HCIComm::TransportOpenFunc> hciTransportOpen( nullptr );
+
+void HCIComm::setTransport(TransportOpenFunc open) {
+    hciTransportOpen = open;
+}
+
+int HCIComm::transport_open(const uint16_t dev_id, const uint16_t channel, bool & kernelSocket) {
+    const TransportOpenFunc open = hciTransportOpen;
+    kernelSocket = nullptr == open;
+    if( nullptr != open ) {
+        return open(dev_id, channel);
+    }
+    return hci_open_dev(dev_id, channel);
+}
+
+/** Control messages of one received packet: HCI_CMSG_DIR and a HCI_CMSG_TSTAMP or SCM_TIMESTAMPNS timestamp */
+#define HCI_RX_CONTROL_SIZE ( CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(struct timespec)) )
+
+HCIComm::HCIComm(const uint16_t dev_id_, const uint16_t channel_)
+: dev_id(dev_id_), channel(channel_), kernelSocket(true), _dd(-1), wakefd(-1)
+{
+    _dd = transport_open(dev_id, channel, kernelSocket);
+    if( 0 <= _dd ) {
+        wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if( 0 > wakefd ) {
+            ERR_PRINT("HCIComm: dev_id %u, channel %u: eventfd failed, reader only stops on poll timeout", dev_id, channel);
+        }
+    }
+    if( 0 <= _dd && IOUringReceiver::isEnabled() ) {
+        // Packet type prefixed HCI frames, as well as Mgmt packets limited by the kernel
+        receiver = IOUringReceiver::create(_dd, 1 + HCI_MAX_FRAME_SIZE, HCI_RX_CONTROL_SIZE);
+        if( nullptr == receiver ) {
+            WARN_PRINT("HCIComm: dev_id %u, channel %u: io_uring receiver unavailable, using recvmmsg", dev_id, channel);
+        }
+    }
+}
+
+bool HCIComm::enableRxTimestamps() {
+    if( 0 > _dd || !kernelSocket ) {
+        return false;
+    }
+    const int opt = 1;
+    if( HCI_CHANNEL_RAW == channel ) {
+        // HCI_CMSG_TSTAMP, as SO_TIMESTAMP* are not served on the raw channel
+        return 0 <= setsockopt(_dd, SOL_HCI, HCI_TIME_STAMP, &opt, sizeof(opt));
+    }
+    return 0 <= setsockopt(_dd, SOL_SOCKET, SO_TIMESTAMPNS, &opt, sizeof(opt));
+}
+
+uint64_t HCIComm::getRxTimestamp(struct msghdr * msg, const uint64_t def) {
+    for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); nullptr != cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if( SOL_HCI == cmsg->cmsg_level && HCI_CMSG_TSTAMP == cmsg->cmsg_type && CMSG_LEN(sizeof(struct timeval)) == cmsg->cmsg_len ) {
+            struct timeval tv;
+            memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+            return getMonotonicNanoseconds( static_cast<int64_t>(tv.tv_sec) * 1000000000L + static_cast<int64_t>(tv.tv_usec) * 1000L );
+        }
+        if( SOL_SOCKET == cmsg->cmsg_level && SCM_TIMESTAMPNS == cmsg->cmsg_type && CMSG_LEN(sizeof(struct timespec)) == cmsg->cmsg_len ) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return getMonotonicNanoseconds( static_cast<int64_t>(ts.tv_sec) * 1000000000L + static_cast<int64_t>(ts.tv_nsec) );
+        }
+    }
+    return def;
+}
+
+HCIComm::~HCIComm() {
+    close();
+    if( 0 <= wakefd ) {
+        ::close(wakefd);
+    }
+}
+
 void HCIComm::close() {
     const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
     if( 0 > _dd ) {
         return;
     }
+    if( nullptr != receiver ) {
+        receiver->cancel(); // releases the socket and wakes up the reader
+    }
     hci_close_dev(_dd);
     _dd = -1;
 }
 
+void HCIComm::interrupt() {
+    if( 0 > wakefd ) {
+        return;
+    }
+    uint64_t one = 1;
+    if( sizeof(one) != ::write(wakefd, &one, sizeof(one)) ) {
+        ERR_PRINT("HCIComm::interrupt: dev_id %u, channel %u: wakeup failed", dev_id, channel);
+    }
+}
+
+int HCIComm::wait_readable(const int32_t timeoutMS) {
+    struct pollfd p[2];
+    int nfds = 1, n;
+
+    p[0].fd = _dd; p[0].events = POLLIN; p[0].revents = 0;
+    if( 0 <= wakefd ) {
+        p[1].fd = wakefd; p[1].events = POLLIN; p[1].revents = 0;
+        nfds = 2;
+    }
+    while ((n = poll(p, nfds, timeoutMS)) < 0) {
+        if (errno == EAGAIN || errno == EINTR ) {
+            // cont temp unavail or interruption
+            continue;
+        }
+        return -1;
+    }
+    if( 2 == nfds && 0 != p[1].revents ) {
+        uint64_t v;
+        while( sizeof(v) == ::read(wakefd, &v, sizeof(v)) ) { } // consume the wakeup
+        errno = ECANCELED;
+        return -1;
+    }
+    if( 0 == n ) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    return n;
+}
+
+static void capturePacket(const uint16_t dev_id, const uint16_t channel, const uint8_t* buffer, const int len, const bool incoming) {
+    PacketCapture & pc = PacketCapture::get();
+    if( !pc.isEnabled() || 0 >= len ) {
+        return;
+    }
+    if( HCI_CHANNEL_CONTROL == channel ) {
+        pc.captureMgmt(buffer, len, incoming);
+    } else {
+        pc.captureHCI(dev_id, buffer, len, incoming);
+    }
+}
+
 int HCIComm::read(uint8_t* buffer, const int capacity, const int32_t timeoutMS) {
     int len = 0;
     if( 0 > _dd || 0 > capacity ) {
@@ -112,45 +241,132 @@ int HCIComm::read(uint8_t* buffer, const int capacity, const int32_t timeoutMS)
     if( 0 == capacity ) {
         goto done;
     }
+    if( nullptr != receiver ) {
+        uint64_t timestamp;
+        return read(buffer, capacity, timeoutMS, timestamp);
+    }
+
+    if( timeoutMS && 0 > wait_readable(timeoutMS) ) {
+        goto errout;
+    }
+
+    while ((len = ::read(_dd, buffer, capacity)) < 0) {
+        if (errno == EAGAIN || errno == EINTR ) {
+            // cont temp unavail or interruption
+            continue;
+        }
+        goto errout;
+    }
+    capturePacket(dev_id, channel, buffer, len, true /* incoming */);
+
+done:
+    return len;
+
+errout:
+    return -1;
+}
+
+int HCIComm::read(uint8_t* buffer, const int capacity, const int32_t timeoutMS, uint64_t & timestamp) {
+    int len = 0;
+    const int res = read_batch(buffer, capacity, &len, 1, timeoutMS, nullptr, &timestamp);
+    if( 0 == res ) {
+        errno = ETIMEDOUT; // spurious wakeup
+        return -1;
+    }
+    return 0 < res ? len : res;
+}
+
+int HCIComm::read_batch(uint8_t* buffers, const int buffer_capacity, int* lengths, const int count, const int32_t timeoutMS,
+                        int* incoming, uint64_t* timestamps) {
+    struct mmsghdr msgs[MAX_READ_BATCH];
+    struct iovec iovs[MAX_READ_BATCH];
+    uint8_t ctrls[MAX_READ_BATCH][HCI_RX_CONTROL_SIZE];
+    const int n_max = count < MAX_READ_BATCH ? count : static_cast<int>(MAX_READ_BATCH);
+    int res = 0;
 
-    if( timeoutMS ) {
-        struct pollfd p;
-        int n;
-
-        p.fd = _dd; p.events = POLLIN;
-#if 0
-        sigset_t sigmask;
-        sigemptyset(&sigmask);
-        // sigaddset(&sigmask, SIGALRM);
-        struct timespec timeout_ts;
-        timeout_ts.tv_sec=0;
-        timeout_ts.tv_nsec=(long)timeoutMS*1000000L;
-        while ((n = ppoll(&p, 1, &timeout_ts, &sigmask)) < 0) {
-#else
-        while ((n = poll(&p, 1, timeoutMS)) < 0) {
-#endif
-            if (errno == EAGAIN || errno == EINTR ) {
-                // cont temp unavail or interruption
+    if( 0 > _dd || 0 > buffer_capacity || 0 > n_max ) {
+        goto errout;
+    }
+    if( 0 == buffer_capacity || 0 == n_max ) {
+        goto done;
+    }
+
+    bzero((void*)msgs, sizeof(struct mmsghdr)*n_max);
+    if( nullptr != receiver ) {
+        int ctrlLengths[MAX_READ_BATCH];
+        const bool ctrl = nullptr != incoming || nullptr != timestamps;
+        while( ( res = receiver->receive(buffers, buffer_capacity, lengths, n_max, timeoutMS,
+                                         ctrl ? &ctrls[0][0] : nullptr, ctrlLengths) ) < 0 ) {
+            if( errno == EINTR ) {
+                // cont interruption
                 continue;
             }
             goto errout;
         }
-        if (!n) {
-            errno = ETIMEDOUT;
-            goto errout;
+        for(int i=0; i<res; i++) {
+            msgs[i].msg_len = lengths[i];
+            if( ctrl ) {
+                msgs[i].msg_hdr.msg_control = ctrls[i];
+                msgs[i].msg_hdr.msg_controllen = ctrlLengths[i];
+            }
         }
+        goto received;
     }
 
-    while ((len = ::read(_dd, buffer, capacity)) < 0) {
-        if (errno == EAGAIN || errno == EINTR ) {
-            // cont temp unavail or interruption
+    if( timeoutMS && 0 > wait_readable(timeoutMS) ) {
+        goto errout;
+    }
+
+    for(int i=0; i<n_max; i++) {
+        iovs[i].iov_base = buffers + i * buffer_capacity;
+        iovs[i].iov_len = buffer_capacity;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if( nullptr != incoming || nullptr != timestamps ) {
+            msgs[i].msg_hdr.msg_control = ctrls[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(ctrls[i]);
+        }
+    }
+    // Block for the first packet only w/o poll, otherwise drain all pending.
+    while ((res = ::recvmmsg(_dd, msgs, n_max, timeoutMS ? MSG_DONTWAIT : MSG_WAITFORONE, nullptr)) < 0) {
+        if( errno == EAGAIN ) {
+            res = 0; // spurious wakeup
+            goto done;
+        }
+        if( errno == EINTR ) {
+            // cont interruption
             continue;
         }
         goto errout;
     }
 
+received:
+    {
+        const uint64_t now = nullptr != timestamps ? getCurrentNanoseconds() : 0; // w/o kernel timestamps
+        for(int i=0; i<res; i++) {
+            if( nullptr != timestamps ) {
+                timestamps[i] = getRxTimestamp(&msgs[i].msg_hdr, now);
+            }
+        }
+    }
+    for(int i=0; i<res; i++) {
+        lengths[i] = msgs[i].msg_len;
+        if( nullptr != incoming ) {
+            incoming[i] = -1;
+            for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); nullptr != cmsg; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if( SOL_HCI == cmsg->cmsg_level && HCI_CMSG_DIR == cmsg->cmsg_type ) {
+                    int dir;
+                    memcpy(&dir, CMSG_DATA(cmsg), sizeof(dir));
+                    incoming[i] = 0 != dir ? 1 : 0;
+                }
+            }
+        }
+        capturePacket(dev_id, channel, buffers + i * buffer_capacity, lengths[i],
+                      nullptr == incoming || 0 != incoming[i] /* assume incoming if unknown */);
+    }
+
 done:
-    return len;
+    return res;
 
 errout:
     return -1;
@@ -172,6 +388,7 @@ int HCIComm::write(const uint8_t* buffer, const int size) {
         }
         goto errout;
     }
+    capturePacket(dev_id, channel, buffer, len, false /* incoming */);
 
 done:
     return len;
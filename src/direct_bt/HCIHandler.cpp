@@ -31,6 +31,7 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <chrono>
 
 // #define PERF_PRINT_ON 1
 #include <dbt_debug.hpp>
@@ -43,6 +44,8 @@
 #include "HCIComm.hpp"
 #include "HCIHandler.hpp"
 #include "DBTTypes.hpp"
+#include "DBTTrace.hpp"
+#include "DBTMetrics.hpp"
 #include "BasicAlgos.hpp"
 
 extern "C" {
@@ -56,13 +59,43 @@ using namespace direct_bt;
 
 HCIEnv::HCIEnv()
 : exploding( DBTEnv::getExplodingProperties("direct_bt.hci") ),
-  HCI_READER_THREAD_POLL_TIMEOUT( DBTEnv::getInt32Property("direct_bt.hci.reader.timeout", 10000, 1500 /* min */, INT32_MAX /* max */) ),
-  HCI_COMMAND_STATUS_REPLY_TIMEOUT( DBTEnv::getInt32Property("direct_bt.hci.cmd.status.timeout", 3000, 1500 /* min */, INT32_MAX /* max */) ),
-  HCI_COMMAND_COMPLETE_REPLY_TIMEOUT( DBTEnv::getInt32Property("direct_bt.hci.cmd.complete.timeout", 10000, 1500 /* min */, INT32_MAX /* max */) ),
-  HCI_EVT_RING_CAPACITY( DBTEnv::getInt32Property("direct_bt.hci.ringsize", 64, 64 /* min */, 1024 /* max */) ),
+  HCI_READER_THREAD_POLL_TIMEOUT( 0 ),
+  HCI_COMMAND_STATUS_REPLY_TIMEOUT( 0 ),
+  HCI_COMMAND_COMPLETE_REPLY_TIMEOUT( 0 ),
+  HCI_EVT_RING_CAPACITY( 0 ),
+  HCI_EVT_RING_OPTIONS( "direct_bt.hci.ring", DBTRingOptions::OverflowPolicy::DROP_NEWEST, 0 /* timeout */, 1024 /* max */ ),
+  HCI_READER_BATCH_SIZE( DBTEnv::getInt32Property("direct_bt.hci.reader.batch", 16, 1 /* min */, HCIComm::MAX_READ_BATCH /* max */) ),
+  HCI_ACL_DEMUX( DBTEnv::getBooleanProperty("direct_bt.hci.acl", false) ),
+  HCI_RX_TIMESTAMPS( DBTEnv::getBooleanProperty("direct_bt.hci.timestamps", true) ),
+  HCI_EXT_SCAN( DBTEnv::getBooleanProperty("direct_bt.hci.scan.ext", true) ),
+  HCI_READER_THREAD_OPTIONS( "direct_bt.hci.reader", "dbt_hci_rdr" ),
+  HCI_READER_EXTERNAL( DBTEnv::getBooleanProperty("direct_bt.hci.reader.external", false) ),
+  HCI_ADV_DEDUP_WINDOW( DBTEnv::getInt32Property("direct_bt.hci.adv.dedup.window", 0, 0 /* min */, INT32_MAX /* max */) ),
+  HCI_ADV_DEDUP_RSSI_DELTA( DBTEnv::getInt32Property("direct_bt.hci.adv.dedup.rssi", 5, 1 /* min */, 255 /* max */) ),
+  HCI_ADV_DEDUP_CACHE_SIZE( DBTEnv::getInt32Property("direct_bt.hci.adv.dedup.size", 256, 1 /* min */, 65536 /* max */) ),
+  HCI_EIR_LAZY( DBTEnv::getBooleanProperty("direct_bt.hci.eir.lazy", false) ),
+  HCI_RSSI_WEIGHT( DBTEnv::getInt32Property("direct_bt.hci.rssi.weight", 100, 1 /* min */, 100 /* max */) ),
+  HCI_RSSI_DELTA( 0 ),
   DEBUG_EVENT( DBTEnv::getBooleanProperty("direct_bt.debug.hci.event", false) ),
-  HCI_READ_PACKET_MAX_RETRY( HCI_EVT_RING_CAPACITY )
+  HCI_READ_PACKET_MAX_RETRY( 0 )
 {
+    reload();
+    DBTEnv::addPropertyListener(onPropertyChanged);
+}
+
+void HCIEnv::onPropertyChanged(const std::string & name) {
+    if( 0 == name.find("direct_bt.hci") ) {
+        get().reload();
+    }
+}
+
+void HCIEnv::reload() {
+    HCI_READER_THREAD_POLL_TIMEOUT = DBTEnv::getInt32Property("direct_bt.hci.reader.timeout", 10000, 1500 /* min */, INT32_MAX /* max */);
+    HCI_COMMAND_STATUS_REPLY_TIMEOUT = DBTEnv::getInt32Property("direct_bt.hci.cmd.status.timeout", 3000, 1500 /* min */, INT32_MAX /* max */);
+    HCI_COMMAND_COMPLETE_REPLY_TIMEOUT = DBTEnv::getInt32Property("direct_bt.hci.cmd.complete.timeout", 10000, 1500 /* min */, INT32_MAX /* max */);
+    HCI_EVT_RING_CAPACITY = DBTEnv::getInt32Property("direct_bt.hci.ringsize", 64, 64 /* min */, 1024 /* max */);
+    HCI_RSSI_DELTA = DBTEnv::getInt32Property("direct_bt.hci.rssi.delta", 0, 0 /* min */, 255 /* max */);
+    HCI_READ_PACKET_MAX_RETRY = HCI_EVT_RING_CAPACITY.load();
 }
 
 const pid_t HCIHandler::pidSelf = getpid();
@@ -71,175 +104,674 @@ struct hci_rp_status {
     __u8    status;
 } __packed;
 
+void HCIHandler::setTrackerHandleIndex(const uint16_t handle, const HCIConnectionRef & conn) {
+    if( 0 != handle ) {
+        std::atomic_store(&connectionHandleIndex[handle & ( CONNECTION_HANDLE_INDEX_SIZE - 1 )], conn);
+    }
+}
+
 HCIConnectionRef HCIHandler::addOrUpdateTrackerConnection(const EUI48 & address, BDAddressType addrType, const uint16_t handle) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
-    // remove all old entry with given address first
-    for (auto it = connectionList.begin(); it != connectionList.end(); ) {
-        HCIConnectionRef conn = *it;
-        if ( conn->equals(address, addrType) ) {
-            // reuse same entry
-            INFO_PRINT("HCIHandler::addTrackerConnection: address[%s, %s], handle %s: reuse entry %s",
-               address.toString().c_str(), getBDAddressTypeString(addrType).c_str(), uint16HexString(handle).c_str(), conn->toString().c_str());
-            // Overwrite tracked connection handle with given _valid_ handle only, i.e. non zero!
-            if( 0 != handle ) {
-                if( 0 != conn->getHandle() && handle != conn->getHandle() ) {
-                    WARN_PRINT("HCIHandler::addTrackerConnection: address[%s, %s], handle %s: reusing entry %s, overwriting non-zero handle",
-                       address.toString().c_str(), getBDAddressTypeString(addrType).c_str(), uint16HexString(handle).c_str(), conn->toString().c_str());
-                }
-                conn->setHandle( handle );
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
+    const std::shared_ptr<const TrackerAddressIndex> index = std::atomic_load(&connectionAddressIndex);
+    auto it = index->find(TrackerAddressKey(address, addrType));
+    if( it != index->end() ) {
+        HCIConnectionRef conn = it->second;
+        // reuse same entry
+        INFO_PRINT("HCIHandler::addTrackerConnection: address[%s, %s], handle %s: reuse entry %s",
+           address.toString().c_str(), getBDAddressTypeString(addrType).c_str(), uint16HexString(handle).c_str(), conn->toString().c_str());
+        // Overwrite tracked connection handle with given _valid_ handle only, i.e. non zero!
+        if( 0 != handle ) {
+            const uint16_t oldHandle = conn->getHandle();
+            if( 0 != oldHandle && handle != oldHandle ) {
+                WARN_PRINT("HCIHandler::addTrackerConnection: address[%s, %s], handle %s: reusing entry %s, overwriting non-zero handle",
+                   address.toString().c_str(), getBDAddressTypeString(addrType).c_str(), uint16HexString(handle).c_str(), conn->toString().c_str());
+                setTrackerHandleIndex(oldHandle, nullptr);
             }
-            return conn; // done
-        } else {
-            ++it;
+            conn->setHandle( handle );
+            setTrackerHandleIndex(handle, conn);
         }
+        return conn; // done
     }
     HCIConnectionRef res( new HCIConnection(address, addrType, handle) );
-    connectionList.push_back( res );
+    std::shared_ptr<TrackerAddressIndex> index2( new TrackerAddressIndex(*index) );
+    (*index2)[TrackerAddressKey(address, addrType)] = res;
+    std::atomic_store(&connectionAddressIndex, std::shared_ptr<const TrackerAddressIndex>(index2));
+    setTrackerHandleIndex(handle, res);
     return res;
 }
 
 HCIConnectionRef HCIHandler::findTrackerConnection(const EUI48 & address, BDAddressType addrType) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
-    const size_t size = connectionList.size();
-    for (size_t i = 0; i < size; i++) {
-        HCIConnectionRef & e = connectionList[i];
-        if( e->equals(address, addrType) ) {
-            return e;
-        }
-    }
-    return nullptr;
+    const std::shared_ptr<const TrackerAddressIndex> index = std::atomic_load(&connectionAddressIndex);
+    auto it = index->find(TrackerAddressKey(address, addrType));
+    return it != index->end() ? it->second : nullptr;
 }
 
 HCIConnectionRef HCIHandler::findTrackerConnection(const uint16_t handle) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
-    const size_t size = connectionList.size();
-    for (size_t i = 0; i < size; i++) {
-        HCIConnectionRef & e = connectionList[i];
-        if ( handle == e->getHandle() ) {
-            return e;
+    if( 0 == handle ) {
+        // zero handle not indexed, rare case
+        const std::shared_ptr<const TrackerAddressIndex> index = std::atomic_load(&connectionAddressIndex);
+        for(auto it = index->begin(); it != index->end(); ++it) {
+            if( 0 == it->second->getHandle() ) {
+                return it->second;
+            }
         }
+        return nullptr;
+    }
+    HCIConnectionRef e = std::atomic_load(&connectionHandleIndex[handle & ( CONNECTION_HANDLE_INDEX_SIZE - 1 )]);
+    if( nullptr != e && handle == e->getHandle() ) {
+        return e;
     }
     return nullptr;
 }
 
 HCIConnectionRef HCIHandler::removeTrackerConnection(const HCIConnectionRef conn) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
-    for (auto it = connectionList.begin(); it != connectionList.end(); ) {
-        HCIConnectionRef e = *it;
-        if ( *e == *conn ) {
-            it = connectionList.erase(it); // old entry
-            return e; // done
-        } else {
-            ++it;
-        }
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
+    const std::shared_ptr<const TrackerAddressIndex> index = std::atomic_load(&connectionAddressIndex);
+    auto it = index->find(TrackerAddressKey(conn->getAddress(), conn->getAddressType()));
+    if( it == index->end() ) {
+        return nullptr;
     }
-    return nullptr;
+    HCIConnectionRef e = it->second;
+    std::shared_ptr<TrackerAddressIndex> index2( new TrackerAddressIndex(*index) );
+    index2->erase(TrackerAddressKey(conn->getAddress(), conn->getAddressType()));
+    std::atomic_store(&connectionAddressIndex, std::shared_ptr<const TrackerAddressIndex>(index2));
+    const uint16_t handle = e->getHandle();
+    if( 0 != handle && e == std::atomic_load(&connectionHandleIndex[handle & ( CONNECTION_HANDLE_INDEX_SIZE - 1 )]) ) {
+        setTrackerHandleIndex(handle, nullptr);
+    }
+    return e; // done
 }
 
 HCIConnectionRef HCIHandler::removeTrackerConnection(const uint16_t handle) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
-    for (auto it = connectionList.begin(); it != connectionList.end(); ) {
-        HCIConnectionRef e = *it;
-        if ( e->getHandle() == handle ) {
-            it = connectionList.erase(it); // old entry
-            return e; // done
-        } else {
-            ++it;
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
+    HCIConnectionRef e = findTrackerConnection(handle);
+    if( nullptr == e ) {
+        return nullptr;
+    }
+    return removeTrackerConnection(e);
+}
+
+template<typename hci_event_struct,
+         std::shared_ptr<MgmtEvent> (HCIHandler::*fn)(const HCIEvent & ev, const hci_event_struct & s, const HCIStatusCode status)>
+std::shared_ptr<MgmtEvent> HCIHandler::translateStruct(std::shared_ptr<HCIEvent> ev) {
+    HCIStatusCode status;
+    const hci_event_struct * s = getReplyStruct<hci_event_struct>(ev, ev->getEventType(), &status);
+    if( nullptr == s ) {
+        ERR_PRINT("HCIHandler::translate(reader): %s: Null reply-struct: %s",
+                getHCIEventTypeString(ev->getEventType()).c_str(), ev->toString().c_str());
+        return nullptr;
+    }
+    return (this->*fn)(*ev, *s, status);
+}
+
+template<typename hci_event_struct,
+         std::shared_ptr<MgmtEvent> (HCIHandler::*fn)(const HCIEvent & ev, const hci_event_struct & s, const HCIStatusCode status)>
+std::shared_ptr<MgmtEvent> HCIHandler::translateMetaStruct(std::shared_ptr<HCIEvent> ev) {
+    HCIStatusCode status;
+    const hci_event_struct * s = getMetaReplyStruct<hci_event_struct>(ev, ev->getMetaEventType(), &status);
+    if( nullptr == s ) {
+        ERR_PRINT("HCIHandler::translate(reader): %s: Null reply-struct: %s",
+                getHCIMetaEventTypeString(ev->getMetaEventType()).c_str(), ev->toString().c_str());
+        return nullptr;
+    }
+    return (this->*fn)(*ev, *s, status);
+}
+
+const HCIHandler::HCIEventTranslation HCIHandler::translations[] = {
+    { HCIEventType::CONN_COMPLETE, HCIMetaEventType::INVALID, MgmtEvent::Opcode::DEVICE_CONNECTED,
+      &HCIHandler::translateStruct<hci_ev_conn_complete, &HCIHandler::translateConnComplete> },
+    { HCIEventType::DISCONN_COMPLETE, HCIMetaEventType::INVALID, MgmtEvent::Opcode::DEVICE_DISCONNECTED,
+      &HCIHandler::translateStruct<hci_ev_disconn_complete, &HCIHandler::translateDisconnComplete> },
+    { HCIEventType::CMD_COMPLETE, HCIMetaEventType::INVALID, MgmtEvent::Opcode::CMD_COMPLETE, nullptr },
+    { HCIEventType::CMD_STATUS, HCIMetaEventType::INVALID, MgmtEvent::Opcode::CMD_STATUS, nullptr },
+    { HCIEventType::LE_META, HCIMetaEventType::LE_CONN_COMPLETE, MgmtEvent::Opcode::DEVICE_CONNECTED,
+      &HCIHandler::translateMetaStruct<hci_ev_le_conn_complete, &HCIHandler::translateLEConnComplete> }
+};
+
+const HCIHandler::HCIEventTranslation * HCIHandler::findTranslation(HCIEventType evt, HCIMetaEventType met) {
+    if( HCIEventType::LE_META != evt ) {
+        met = HCIMetaEventType::INVALID;
+    }
+    for(const HCIEventTranslation & t : translations) {
+        if( t.evt == evt && t.met == met ) {
+            return &t;
         }
     }
     return nullptr;
 }
 
 MgmtEvent::Opcode HCIHandler::translate(HCIEventType evt, HCIMetaEventType met) {
-    if( HCIEventType::LE_META == evt ) {
-        switch( met ) {
-            case HCIMetaEventType::LE_CONN_COMPLETE: return MgmtEvent::Opcode::DEVICE_CONNECTED;
-            default: return MgmtEvent::Opcode::INVALID;
+    const HCIEventTranslation * t = findTranslation(evt, met);
+    return nullptr != t ? t->opc : MgmtEvent::Opcode::INVALID;
+}
+
+std::shared_ptr<MgmtEvent> HCIHandler::translate(std::shared_ptr<HCIEvent> ev) {
+    const HCIEventTranslation * t = findTranslation(ev->getEventType(), ev->getMetaEventType());
+    if( nullptr == t || nullptr == t->translator ) {
+        return nullptr;
+    }
+    return (this->*(t->translator))(ev);
+}
+
+std::shared_ptr<MgmtEvent> HCIHandler::translateConnComplete(const HCIEvent & ev, const hci_ev_conn_complete & s, const HCIStatusCode status) {
+    (void)ev;
+    HCIConnectionRef conn = addOrUpdateTrackerConnection(s.bdaddr, BDAddressType::BDADDR_BREDR, s.handle);
+    if( HCIStatusCode::SUCCESS == status ) {
+        return std::make_shared<MgmtEvtDeviceConnected>(dev_id, s.bdaddr, BDAddressType::BDADDR_BREDR, s.handle);
+    }
+    removeTrackerConnection(conn);
+    return std::make_shared<MgmtEvtDeviceConnectFailed>(dev_id, s.bdaddr, BDAddressType::BDADDR_BREDR, status);
+}
+
+std::shared_ptr<MgmtEvent> HCIHandler::translateDisconnComplete(const HCIEvent & ev, const hci_ev_disconn_complete & s, const HCIStatusCode status) {
+    HCIConnectionRef conn = removeTrackerConnection(s.handle);
+    if( nullptr == conn ) {
+        INFO_PRINT("HCIHandler::translate(reader): DISCONN_COMPLETE: Not tracked handle %s: %s",
+                   uint16HexString(s.handle).c_str(), ev.toString().c_str());
+        return nullptr;
+    }
+    if( HCIStatusCode::SUCCESS != status ) {
+        // FIXME: Ever occuring? Still sending out essential disconnect event!
+        ERR_PRINT("HCIHandler::translate(reader): DISCONN_COMPLETE: !SUCCESS[%s, %s], %s: %s",
+                uint8HexString(static_cast<uint8_t>(status)).c_str(), getHCIStatusCodeString(status).c_str(),
+                conn->toString().c_str(), ev.toString().c_str());
+    }
+    const HCIStatusCode hciRootReason = static_cast<HCIStatusCode>(s.reason);
+    return std::make_shared<MgmtEvtDeviceDisconnected>(dev_id, conn->getAddress(), conn->getAddressType(), hciRootReason, s.handle);
+}
+
+std::shared_ptr<MgmtEvent> HCIHandler::translateLEConnComplete(const HCIEvent & ev, const hci_ev_le_conn_complete & s, const HCIStatusCode status) {
+    (void)ev;
+    const BDAddressType addrType = getBDAddressType(static_cast<HCILEPeerAddressType>(s.bdaddr_type));
+    HCIConnectionRef conn = addOrUpdateTrackerConnection(s.bdaddr, addrType, s.handle);
+    if( HCIStatusCode::SUCCESS == status ) {
+        return std::make_shared<MgmtEvtDeviceConnected>(dev_id, s.bdaddr, addrType, s.handle);
+    }
+    removeTrackerConnection(conn);
+    return std::make_shared<MgmtEvtDeviceConnectFailed>(dev_id, s.bdaddr, addrType, status);
+}
+
+void HCIHandler::processPacket(const uint8_t * buffer, const int len, const uint64_t timestampNS) {
+    const uint16_t paramSize = len >= 3 ? buffer[2] : 0;
+    if( len < number(HCIConstU8::EVENT_HDR_SIZE) + paramSize ) {
+        WARN_PRINT("HCIHandler::reader: length mismatch %d < %d + %d",
+                len, number(HCIConstU8::EVENT_HDR_SIZE), paramSize);
+        return; // discard data
+    }
+    std::shared_ptr<HCIEvent> event = hciEventPool.getSpecialized(buffer, len);
+    if( nullptr == event ) {
+        // not an event ...
+        ERR_PRINT("HCIHandler-IO RECV Drop (non-event) %s", bytesHexString(buffer, 0, len, true /* lsbFirst*/).c_str());
+        return;
+    }
+    event->setTimestampNS(timestampNS);
+
+    const HCIMetaEventType mec = event->getMetaEventType();
+    DBTTrace::get().record(TraceSource::HCI_EVT, event->getTimestamp(), number(event->getEventType()),
+                           HCIMetaEventType::INVALID != mec ? number(mec) : 0, dev_id, paramSize);
+    if( HCIMetaEventType::INVALID != mec && !filter_test_metaev(mec) ) {
+        // DROP
+        COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV Drop (meta filter) %s", event->toString().c_str());
+        return; // next packet
+    }
+
+    if( event->isEvent(HCIEventType::CMD_STATUS) || event->isEvent(HCIEventType::CMD_COMPLETE) )
+    {
+        COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV (CMD) %s", event->toString().c_str());
+        if( completePendingCommand(event) ) {
+            return; // asynchronous command reply
+        }
+        // Stale replies are discarded by the consumer before sending the next command,
+        // hence a full ring only holds unsolicited replies.
+        if( !hciEventRing.offer( std::move(event) ) ) {
+            WARN_PRINT("HCIHandler-IO RECV Drop (ring full, %d capacity, %s): %s", hciEventRing.capacity(),
+                    DBTRingOptions::getOverflowPolicyString(env.HCI_EVT_RING_OPTIONS.POLICY).c_str(), event->toString().c_str());
+        }
+    } else if( event->isMetaEvent(HCIMetaEventType::LE_ADVERTISING_REPORT) ) {
+        // match beacons on the raw AD data first, consumed reports won't be parsed
+        const std::shared_ptr<const BeaconMatcher> matcher = std::atomic_load(&beaconMatcher);
+        EUI48 consumed[0x19];
+        int consumedCount = 0;
+        if( nullptr != matcher ) {
+            const int num_reports = matchBeacons(*matcher, event->getParam(), event->getParamSize(), event->getTimestamp(),
+                                                 consumed, consumedCount);
+            if( 0 < consumedCount && consumedCount == num_reports ) {
+                return; // next packet
+            }
+        }
+        // issue callbacks for the translated AD events
+        EInfoReportBatch eirlist;
+        if( advDedupCacheClearReq && advDedupCacheClearReq.exchange(false) ) {
+            advDedupCache.clear();
+        }
+        if( advDedupCache.isEnabled() ) {
+            eirlist = read_ad_reports_dedup(event->getParam(), event->getParamSize(), event->getTimestamp());
+        } else {
+            eirlist = EInfoReport::read_ad_reports(event->getParam(), event->getParamSize(), env.HCI_EIR_LAZY,
+                                                   event->getTimestamp(), &eirPool);
+        }
+        if( 0 < consumedCount ) {
+            eirlist.erase(std::remove_if(eirlist.begin(), eirlist.end(), [&](const std::shared_ptr<EInfoReport> & eir) {
+                return consumed + consumedCount != std::find(consumed, consumed + consumedCount, eir->getAddress());
+            }), eirlist.end());
+        }
+        if( eirlist.size() > 0 ) {
+            sendAdvertisingReportBatch( eirlist );
         }
+    } else if( event->isMetaEvent(HCIMetaEventType::LE_PERIODIC_ADV_REPORT) ) {
+        // routed per sync, delivered at the end of the read batch
+        periodicAdvSyncs.processReport(event->getParam(), event->getParamSize(), event->getTimestamp());
+    } else if( event->isMetaEvent(HCIMetaEventType::LE_PERIODIC_ADV_SYNC_ESTABLISHED) ) {
+        periodicAdvSyncs.processSyncEstablished(event->getParam(), event->getParamSize());
+    } else if( event->isMetaEvent(HCIMetaEventType::LE_PERIODIC_ADV_SYNC_LOST) ) {
+        periodicAdvSyncs.processSyncLost(event->getParam(), event->getParamSize());
+    } else if( event->isMetaEvent(HCIMetaEventType::LE_EXT_ADV_REPORT) ) {
+        // issue callbacks for the complete extended AD events, fragments are held back
+        const EInfoReportBatch eirlist = read_ext_ad_reports(event->getParam(), event->getParamSize(), event->getTimestamp());
+        if( eirlist.size() > 0 ) {
+            sendAdvertisingReportBatch( eirlist );
+        }
+    } else {
+        // issue a callback for the translated event
+        std::shared_ptr<MgmtEvent> mevent = translate(event);
+        if( nullptr != mevent ) {
+            mevent->setTimestampNS(event->getTimestampNS());
+            COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV (CB) %s", event->toString().c_str());
+            sendMgmtEvent( mevent );
+        } else {
+            COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV Drop (no translation) %s", event->toString().c_str());
+        }
+    }
+}
+
+EInfoReportBatch HCIHandler::read_ad_reports_dedup(uint8_t const * data, const int data_length, const uint64_t timestamp) {
+    // BT Core Spec v5.2: Vol 4, Part E HCI: 7.7.65.2 LE Advertising Report event, column ordered per field
+    const int num_reports = 0 < data_length ? data[0] : 0;
+    if( 0 >= num_reports || num_reports > 0x19 || data_length < 1 + 10 * num_reports ) {
+        return EInfoReport::read_ad_reports(data, data_length, env.HCI_EIR_LAZY, timestamp, &eirPool); // let it fail verbosely
     }
-    switch( evt ) {
-        case HCIEventType::CONN_COMPLETE: return MgmtEvent::Opcode::DEVICE_CONNECTED;
-        case HCIEventType::DISCONN_COMPLETE: return MgmtEvent::Opcode::DEVICE_DISCONNECTED;
-        case HCIEventType::CMD_COMPLETE: return MgmtEvent::Opcode::CMD_COMPLETE;
-        case HCIEventType::CMD_STATUS: return MgmtEvent::Opcode::CMD_STATUS;
-        default: return MgmtEvent::Opcode::INVALID;
+    const uint8_t * evt_types = data + 1;
+    const uint8_t * addr_types = evt_types + num_reports;
+    const uint8_t * addrs = addr_types + num_reports;
+    const uint8_t * ad_lens = addrs + 6 * num_reports;
+    const uint8_t * ad_data = ad_lens + num_reports;
+    int ad_total = 0;
+    for(int i = 0; i < num_reports; i++) {
+        ad_total += ad_lens[i];
+    }
+    const uint8_t * rssis = ad_data + ad_total;
+    if( rssis + num_reports > data + data_length ) {
+        return EInfoReport::read_ad_reports(data, data_length, env.HCI_EIR_LAZY, timestamp, &eirPool); // let it fail verbosely
+    }
+
+    HCIAdvDedupCache::Result results[0x19];
+    int newCount = 0;
+    {
+        const uint8_t * ad = ad_data;
+        for(int i = 0; i < num_reports; i++) {
+            results[i] = advDedupCache.check(*reinterpret_cast<const EUI48 *>(addrs + 6 * i), addr_types[i], evt_types[i],
+                                             ad, ad_lens[i], static_cast<int8_t>(rssis[i]), timestamp);
+            if( HCIAdvDedupCache::Result::NEW == results[i] ) {
+                newCount++;
+            }
+            ad += ad_lens[i];
+        }
     }
+    EInfoReportBatch full;
+    if( 0 < newCount ) {
+        full = EInfoReport::read_ad_reports(data, data_length, env.HCI_EIR_LAZY, timestamp, &eirPool);
+        if( num_reports != static_cast<int>(full.size()) ) {
+            return full;
+        }
+    }
+    EInfoReportBatch ad_reports;
+    for(int i = 0; i < num_reports; i++) {
+        switch( results[i] ) {
+            case HCIAdvDedupCache::Result::NEW:
+                ad_reports.push_back(full[i]);
+                break;
+            case HCIAdvDedupCache::Result::RSSI_UPDATE: {
+                std::shared_ptr<EInfoReport> eir = eirPool.acquire();
+                eir->setSource(EInfoReport::Source::AD);
+                eir->setTimestamp(timestamp);
+                eir->setEvtType(static_cast<AD_PDU_Type>(evt_types[i]));
+                eir->setADAddressType(addr_types[i]);
+                eir->setAddress(*reinterpret_cast<const EUI48 *>(addrs + 6 * i));
+                eir->setRSSI(static_cast<int8_t>(rssis[i]));
+                ad_reports.push_back(eir);
+            } break;
+            case HCIAdvDedupCache::Result::DUPLICATE:
+                break;
+        }
+    }
+    return ad_reports;
 }
 
-std::shared_ptr<MgmtEvent> HCIHandler::translate(std::shared_ptr<HCIEvent> ev) {
-    const HCIEventType evt = ev->getEventType();
-    const HCIMetaEventType mevt = ev->getMetaEventType();
-
-    if( HCIEventType::LE_META == evt ) {
-        switch( mevt ) {
-            case HCIMetaEventType::LE_CONN_COMPLETE: {
-                HCIStatusCode status;
-                const hci_ev_le_conn_complete * ev_cc = getMetaReplyStruct<hci_ev_le_conn_complete>(ev, mevt, &status);
-                if( nullptr == ev_cc ) {
-                    ERR_PRINT("HCIHandler::translate(reader): LE_CONN_COMPLETE: Null reply-struct: %s", ev->toString().c_str());
-                    return nullptr;
+/**
+ * Maps the LE_EXT_ADV_REPORT event type bit mask to the legacy AD_PDU_Type,
+ * BT Core Spec v5.2: Vol 4, Part E HCI: 7.7.65.13 LE Extended Advertising Report event
+ */
+static AD_PDU_Type getExtADPDUType(const uint16_t evt_type) {
+    if( 0 != ( evt_type & LE_EXT_ADV_SCAN_RSP ) ) {
+        return AD_PDU_Type::SCAN_RSP;
+    } else if( 0 != ( evt_type & LE_EXT_ADV_DIRECT_IND ) ) {
+        return AD_PDU_Type::ADV_DIRECT_IND;
+    } else if( 0 != ( evt_type & LE_EXT_ADV_CONN_IND ) ) {
+        return AD_PDU_Type::ADV_IND;
+    } else if( 0 != ( evt_type & LE_EXT_ADV_SCAN_IND ) ) {
+        return AD_PDU_Type::ADV_SCAN_IND;
+    } else {
+        return AD_PDU_Type::ADV_NONCONN_IND;
+    }
+}
+
+bool HCIHandler::matchBeacon(const BeaconMatcher & matcher, const uint8_t * data, const int length,
+                             const EUI48 & address, const uint8_t ad_address_type, const int8_t rssi, const uint64_t timestamp)
+{
+    beaconRecords.emplace_back(); // reuses the capacity of previous read batches
+    BeaconRecord & rec = beaconRecords.back();
+    if( !matcher.match(data, length, rec) ) {
+        beaconRecords.pop_back();
+        return false;
+    }
+    rec.timestamp = timestamp;
+    rec.address = address;
+    rec.ad_address_type = ad_address_type;
+    rec.rssi = rssi;
+    return true;
+}
+
+int HCIHandler::matchBeacons(const BeaconMatcher & matcher, const uint8_t * data, const int data_length, const uint64_t timestamp,
+                             EUI48 * consumed, int & consumedCount)
+{
+    // BT Core Spec v5.2: Vol 4, Part E HCI: 7.7.65.2 LE Advertising Report event, column ordered per field
+    consumedCount = 0;
+    const int num_reports = 0 < data_length ? data[0] : 0;
+    if( 0 >= num_reports || num_reports > 0x19 || data_length < 1 + 10 * num_reports ) {
+        return num_reports;
+    }
+    const uint8_t * addr_types = data + 1 + num_reports;
+    const uint8_t * addrs = addr_types + num_reports;
+    const uint8_t * ad_lens = addrs + 6 * num_reports;
+    const uint8_t * ad = ad_lens + num_reports;
+    const uint8_t * rssis = ad;
+    for(int i = 0; i < num_reports; i++) {
+        rssis += ad_lens[i];
+    }
+    if( rssis + num_reports > data + data_length ) {
+        return num_reports; // let the regular path fail verbosely
+    }
+    for(int i = 0; i < num_reports; i++) {
+        const EUI48 & address = *reinterpret_cast<const EUI48 *>(addrs + 6 * i);
+        if( matchBeacon(matcher, ad, ad_lens[i], address, addr_types[i], static_cast<int8_t>(rssis[i]), timestamp) &&
+            matcher.isConsuming() )
+        {
+            consumed[consumedCount++] = address;
+        }
+        ad += ad_lens[i];
+    }
+    return num_reports;
+}
+
+void HCIHandler::sendBeaconRecords() {
+    if( 0 == beaconRecords.size() ) {
+        return;
+    }
+    const BeaconRecordCallbackList::snapshot_t callbacks = beaconRecordCallbackList.get_snapshot();
+    int invokeCount = 0;
+    for (auto it = callbacks->begin(); it != callbacks->end(); ++it) {
+        try {
+            it->invoke(beaconRecords);
+        } catch (std::exception &e) {
+            ERR_PRINT("HCIHandler::sendBeaconRecords-CBs %d/%zd: BeaconRecordCallback %s : Caught exception %s",
+                    invokeCount+1, callbacks->size(),
+                    it->toString().c_str(), e.what());
+        }
+        invokeCount++;
+    }
+    COND_PRINT(env.DEBUG_EVENT, "HCIHandler::sendBeaconRecords: %zd records -> %d/%zd callbacks", beaconRecords.size(), invokeCount, callbacks->size());
+    (void)invokeCount;
+    beaconRecords.clear();
+}
+
+EInfoReportBatch HCIHandler::read_ext_ad_reports(uint8_t const * data, const int data_length, const uint64_t timestamp) {
+    EInfoReportBatch ad_reports;
+    if( 1 > data_length ) {
+        return ad_reports;
+    }
+    const std::shared_ptr<const BeaconMatcher> matcher = std::atomic_load(&beaconMatcher);
+    const int num_reports = data[0];
+    const int report_hdr_size = sizeof(hci_ev_le_ext_adv_report);
+    int offset = 1;
+
+    for(int i = 0; i < num_reports; i++) {
+        if( offset + report_hdr_size > data_length ) {
+            WARN_PRINT("HCIHandler::read_ext_ad_reports: Incomplete report %d/%d header within %d bytes", i+1, num_reports, data_length);
+            break;
+        }
+        const hci_ev_le_ext_adv_report * r = reinterpret_cast<const hci_ev_le_ext_adv_report *>(data + offset);
+        offset += report_hdr_size;
+        if( offset + r->length > data_length ) {
+            WARN_PRINT("HCIHandler::read_ext_ad_reports: Incomplete report %d/%d data %d within %d bytes", i+1, num_reports, r->length, data_length);
+            break;
+        }
+        const uint8_t * ad_data = data + offset;
+        offset += r->length;
+
+        const uint16_t evt_type = le_to_cpu(r->evt_type);
+        // 0x00 complete, 0x01 incomplete w/ more data to come, 0x02 incomplete and truncated
+        const uint8_t data_status = ( evt_type >> 5 ) & 0x03;
+
+        ExtAdvFragment * frag = nullptr;
+        ExtAdvFragment * freeFrag = nullptr;
+        for(auto it = extAdvFragments.begin(); it != extAdvFragments.end(); ++it) {
+            if( it->inUse ) {
+                if( it->address == r->bdaddr && it->addressType == r->bdaddr_type && it->sid == r->sid ) {
+                    frag = &(*it);
+                    break;
                 }
-                const HCILEPeerAddressType hciAddrType = static_cast<HCILEPeerAddressType>(ev_cc->bdaddr_type);
-                const BDAddressType addrType = getBDAddressType(hciAddrType);
-                HCIConnectionRef conn = addOrUpdateTrackerConnection(ev_cc->bdaddr, addrType, ev_cc->handle);
-                if( HCIStatusCode::SUCCESS == status ) {
-                    return std::shared_ptr<MgmtEvent>( new MgmtEvtDeviceConnected(dev_id, ev_cc->bdaddr, addrType, ev_cc->handle) );
-                } else {
-                    std::shared_ptr<MgmtEvent> res( new MgmtEvtDeviceConnectFailed(dev_id, ev_cc->bdaddr, addrType, status) );
-                    removeTrackerConnection(conn);
-                    return res;
+            } else if( nullptr == freeFrag ) {
+                freeFrag = &(*it);
+            }
+        }
+        if( 0x01 == data_status && nullptr == frag ) {
+            if( nullptr == freeFrag ) {
+                // evict the oldest pending fragment
+                freeFrag = &extAdvFragments[0];
+                for(auto it = extAdvFragments.begin(); it != extAdvFragments.end(); ++it) {
+                    if( it->timestamp < freeFrag->timestamp ) {
+                        freeFrag = &(*it);
+                    }
                 }
+                WARN_PRINT("HCIHandler::read_ext_ad_reports: Drop pending fragment of %s, all %d slots in use",
+                        freeFrag->address.toString().c_str(), static_cast<int>(extAdvFragments.size()));
             }
-            default:
-                return nullptr;
+            frag = freeFrag;
+            frag->inUse = true;
+            frag->timestamp = timestamp;
+            frag->address = r->bdaddr;
+            frag->addressType = r->bdaddr_type;
+            frag->sid = r->sid;
+            frag->data.resize(0);
         }
-    }
-    switch( evt ) {
-        case HCIEventType::CONN_COMPLETE: {
-            HCIStatusCode status;
-            const hci_ev_conn_complete * ev_cc = getReplyStruct<hci_ev_conn_complete>(ev, evt, &status);
-            if( nullptr == ev_cc ) {
-                ERR_PRINT("HCIHandler::translate(reader): CONN_COMPLETE: Null reply-struct: %s", ev->toString().c_str());
-                return nullptr;
+        if( nullptr != frag ) {
+            const int size = frag->data.getSize();
+            const int append = std::min<int>(r->length, frag->data.getCapacity() - size);
+            if( append < r->length ) {
+                WARN_PRINT("HCIHandler::read_ext_ad_reports: Truncated fragmented data of %s at %d bytes",
+                        frag->address.toString().c_str(), frag->data.getCapacity());
             }
-            HCIConnectionRef conn = addOrUpdateTrackerConnection(ev_cc->bdaddr, BDAddressType::BDADDR_BREDR, ev_cc->handle);
-            if( HCIStatusCode::SUCCESS == status ) {
-                return std::shared_ptr<MgmtEvent>( new MgmtEvtDeviceConnected(dev_id, conn->getAddress(), conn->getAddressType(), conn->getHandle()) );
-            } else {
-                std::shared_ptr<MgmtEvent> res( new MgmtEvtDeviceConnectFailed(dev_id, conn->getAddress(), conn->getAddressType(), status) );
-                removeTrackerConnection(conn);
-                return res;
+            frag->data.resize(size + append);
+            memcpy(frag->data.get_wptr() + size, ad_data, append);
+            if( 0x01 == data_status ) {
+                continue; // more data to come
             }
         }
-        case HCIEventType::DISCONN_COMPLETE: {
-            HCIStatusCode status;
-            const hci_ev_disconn_complete * ev_cc = getReplyStruct<hci_ev_disconn_complete>(ev, evt, &status);
-            if( nullptr == ev_cc ) {
-                ERR_PRINT("HCIHandler::translate(reader): DISCONN_COMPLETE: Null reply-struct: %s", ev->toString().c_str());
-                return nullptr;
+
+        if( nullptr != matcher ) {
+            const uint8_t * eir_data = nullptr != frag ? frag->data.get_ptr() : ad_data;
+            const int eir_length = nullptr != frag ? frag->data.getSize() : r->length;
+            if( matchBeacon(*matcher, eir_data, eir_length, r->bdaddr, r->bdaddr_type, r->rssi, timestamp) && matcher->isConsuming() ) {
+                if( nullptr != frag ) {
+                    frag->inUse = false;
+                }
+                continue; // consumed
             }
-            HCIConnectionRef conn = removeTrackerConnection(ev_cc->handle);
-            if( nullptr == conn ) {
-                INFO_PRINT("HCIHandler::translate(reader): DISCONN_COMPLETE: Not tracked handle %s: %s",
-                           uint16HexString(ev_cc->handle).c_str(), ev->toString().c_str());
-                return nullptr;
-            } else {
-                if( HCIStatusCode::SUCCESS != status ) {
-                    // FIXME: Ever occuring? Still sending out essential disconnect event!
-                    ERR_PRINT("HCIHandler::translate(reader): DISCONN_COMPLETE: !SUCCESS[%s, %s], %s: %s",
-                            uint8HexString(static_cast<uint8_t>(status)).c_str(), getHCIStatusCodeString(status).c_str(),
-                            conn->toString().c_str(), ev->toString().c_str());
+        }
+
+        std::shared_ptr<EInfoReport> eir = eirPool.acquire();
+        eir->setSource(EInfoReport::Source::AD);
+        eir->setTimestamp(timestamp);
+        eir->setEvtType(getExtADPDUType(evt_type));
+        eir->setADAddressType(r->bdaddr_type);
+        eir->setAddress(r->bdaddr);
+        eir->setRSSI(r->rssi);
+        if( 127 != static_cast<int8_t>(r->tx_power) ) {
+            eir->setTxPower(static_cast<int8_t>(r->tx_power));
+        }
+        if( nullptr != frag ) {
+            eir->read_data(frag->data.get_ptr(), frag->data.getSize(), env.HCI_EIR_LAZY);
+            frag->inUse = false;
+        } else {
+            eir->read_data(ad_data, r->length, env.HCI_EIR_LAZY);
+        }
+        ad_reports.push_back(eir);
+    }
+    return ad_reports;
+}
+
+void HCIHandler::processACLData(const uint8_t * buffer, const int len) {
+    const int hdrSize = number(HCIConstU8::ACL_HDR_SIZE);
+    const int l2capHdrSize = number(HCIConstU8::L2CAP_BASIC_HDR_SIZE);
+    if( len < hdrSize ) {
+        WARN_PRINT("HCIHandler::reader: ACL length mismatch %d < %d", len, hdrSize);
+        return; // discard data
+    }
+    const uint16_t handle_flags = get_uint16(buffer, 1, true /* littleEndian */);
+    const uint16_t handle = handle_flags & 0x0fff;
+    const uint8_t pb_flag = ( handle_flags >> 12 ) & 0x03;
+    const int dataSize = get_uint16(buffer, 3, true /* littleEndian */);
+    if( len < hdrSize + dataSize ) {
+        WARN_PRINT("HCIHandler::reader: ACL length mismatch %d < %d + %d", len, hdrSize, dataSize);
+        return; // discard data
+    }
+    const uint8_t * data = buffer + hdrSize;
+
+    std::shared_ptr<ACLChannel> ch;
+    {
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+        auto it = aclChannels.find(handle);
+        if( it == aclChannels.end() ) {
+            return; // not demultiplexed
+        }
+        ch = it->second; // keeps the channel alive while callback removes it
+    }
+
+    if( ACL_CONT != pb_flag ) {
+        // start of a new L2CAP frame
+        if( 0 < ch->expected ) {
+            WARN_PRINT("HCIHandler::reader: ACL handle 0x%x: Drop incomplete L2CAP frame %d/%d", handle, ch->filled, ch->expected);
+        }
+        ch->expected = 0;
+        if( dataSize < l2capHdrSize ) {
+            WARN_PRINT("HCIHandler::reader: ACL handle 0x%x: L2CAP header size mismatch %d < %d", handle, dataSize, l2capHdrSize);
+            return; // discard data
+        }
+        const int frameSize = l2capHdrSize + get_uint16(data, 0, true /* littleEndian */);
+        if( frameSize == dataSize ) {
+            // complete frame within one ACL packet, deliver w/o copy
+            const uint16_t cid = get_uint16(data, 2, true /* littleEndian */);
+            if( cid == ch->cid ) {
+                const TROOctets payload(data + l2capHdrSize, frameSize - l2capHdrSize);
+                try {
+                    ch->cb.invoke(handle, cid, payload);
+                } catch (std::exception &e) {
+                    ERR_PRINT("HCIHandler::reader: L2CAPFrameCallback %s: Caught exception %s", ch->cb.toString().c_str(), e.what());
                 }
-                const HCIStatusCode hciRootReason = static_cast<HCIStatusCode>(ev_cc->reason);
-                return std::shared_ptr<MgmtEvent>( new MgmtEvtDeviceDisconnected(dev_id, conn->getAddress(), conn->getAddressType(), hciRootReason, conn->getHandle()) );
             }
+            return;
         }
-        default:
-            return nullptr;
+        if( frameSize > ch->frame.getSize() || frameSize < dataSize ) {
+            WARN_PRINT("HCIHandler::reader: ACL handle 0x%x: Drop L2CAP frame size %d, fragment %d, capacity %d",
+                    handle, frameSize, dataSize, ch->frame.getSize());
+            return; // discard data
+        }
+        ch->filled = 0;
+        ch->expected = frameSize;
+    } else if( 0 == ch->expected ) {
+        return; // continuation of a dropped frame
+    } else if( ch->filled + dataSize > ch->expected ) {
+        WARN_PRINT("HCIHandler::reader: ACL handle 0x%x: Drop overflowing L2CAP frame %d + %d > %d",
+                handle, ch->filled, dataSize, ch->expected);
+        ch->expected = 0;
+        return; // discard data
+    }
+    memcpy(ch->frame.get_wptr() + ch->filled, data, dataSize);
+    ch->filled += dataSize;
+
+    if( ch->filled == ch->expected ) {
+        ch->expected = 0;
+        const uint16_t cid = get_uint16(ch->frame.get_ptr(), 2, true /* littleEndian */);
+        if( cid == ch->cid ) {
+            const TROOctets payload(ch->frame.get_ptr() + l2capHdrSize, ch->filled - l2capHdrSize);
+            try {
+                ch->cb.invoke(handle, cid, payload);
+            } catch (std::exception &e) {
+                ERR_PRINT("HCIHandler::reader: L2CAPFrameCallback %s: Caught exception %s", ch->cb.toString().c_str(), e.what());
+            }
+        }
+    }
+}
+
+void HCIHandler::countACLTraffic(const uint8_t * buffer, const int len, const bool incoming) {
+    const int hdrSize = number(HCIConstU8::ACL_HDR_SIZE);
+    const int l2capHdrSize = number(HCIConstU8::L2CAP_BASIC_HDR_SIZE);
+    if( len < hdrSize ) {
+        return;
+    }
+    const uint16_t handle_flags = get_uint16(buffer, 1, true /* littleEndian */);
+    HCIConnectionRef conn = findTrackerConnection(static_cast<uint16_t>(handle_flags & 0x0fff));
+    if( nullptr == conn ) {
+        return;
+    }
+    const uint8_t pb_flag = ( handle_flags >> 12 ) & 0x03;
+    const int dataSize = std::min<int>(get_uint16(buffer, 3, true /* littleEndian */), len - hdrSize);
+    const uint8_t * data = buffer + hdrSize;
+    // Only the first fragment carries the L2CAP header, i.e. the ATT PDU size and opcode
+    if( ACL_CONT == pb_flag || dataSize <= l2capHdrSize || L2CAP_CID_ATT != get_uint16(data, 2, true /* littleEndian */) ) {
+        return;
+    }
+    const uint8_t opcode = data[l2capHdrSize];
+    const uint16_t pduSize = get_uint16(data, 0, true /* littleEndian */);
+    if( incoming ) {
+        conn->getTrafficStats().countIn(opcode, pduSize);
+    } else {
+        conn->getTrafficStats().countOut(opcode, pduSize);
     }
 }
 
+void HCIHandler::dispatchBatch(const int count, LatencyHistogram * metricDispatch) {
+    for(int i=0; i<count && ( !hciReaderShallStop || hciReaderExternal ); i++) {
+        const uint8_t * buffer = rbuffer.get_ptr() + i * rbufferSlotSize;
+        const uint64_t t0 = nullptr != metricDispatch ? getCurrentMicroseconds() : 0;
+        if( aclDemux && 0 < rbufferLengths[i] && number(HCIPacketType::ACLDATA) == buffer[0] ) {
+            countACLTraffic(buffer, rbufferLengths[i], 1 == rbufferIncoming[i]);
+            if( 1 == rbufferIncoming[i] ) {
+                processACLData(buffer, rbufferLengths[i]);
+            }
+        } else {
+            processPacket(buffer, rbufferLengths[i], rbufferTimestamps[i]);
+        }
+        if( nullptr != metricDispatch ) {
+            metricDispatch->recordSince(t0, true);
+        }
+    }
+    periodicAdvSyncs.flush();
+    sendBeaconRecords();
+}
+
 void HCIHandler::hciReaderThreadImpl() {
+    env.HCI_READER_THREAD_OPTIONS.applyToCurrentThread();
     {
         const std::lock_guard<std::mutex> lock(mtx_hciReaderInit); // RAII-style acquire and relinquish via destructor
         hciReaderShallStop = false;
@@ -247,9 +779,11 @@ void HCIHandler::hciReaderThreadImpl() {
         DBG_PRINT("HCIHandler::reader: Started");
         cv_hciReaderInit.notify_all();
     }
+    const bool metrics = DBTMetrics::get().isEnabled();
+    LatencyHistogram & metricDispatch = DBTMetrics::get().getHistogram("hci_reader_dispatch", "dev_id", std::to_string(dev_id));
+    const int32_t handoverTimeout = EXTERNAL_HANDOVER_TIMEOUT;
 
     while( !hciReaderShallStop ) {
-        int len;
         if( !comm.isOpen() ) {
             // not open
             ERR_PRINT("HCIHandler::reader: Not connected");
@@ -257,90 +791,252 @@ void HCIHandler::hciReaderThreadImpl() {
             break;
         }
 
-        len = comm.read(rbuffer.get_wptr(), rbuffer.getSize(), env.HCI_READER_THREAD_POLL_TIMEOUT);
-        if( 0 < len ) {
-            const uint16_t paramSize = len >= 3 ? rbuffer.get_uint8(2) : 0;
-            if( len < number(HCIConstU8::EVENT_HDR_SIZE) + paramSize ) {
-                WARN_PRINT("HCIHandler::reader: length mismatch %d < %d + %d",
-                        len, number(HCIConstU8::EVENT_HDR_SIZE), paramSize);
-                continue; // discard data
-            }
-            std::shared_ptr<HCIEvent> event( HCIEvent::getSpecialized(rbuffer.get_ptr(), len) );
-            if( nullptr == event ) {
-                // not an event ...
-                ERR_PRINT("HCIHandler-IO RECV Drop (non-event) %s", bytesHexString(rbuffer.get_ptr(), 0, len, true /* lsbFirst*/).c_str());
-                continue;
-            }
-
-            const HCIMetaEventType mec = event->getMetaEventType();
-            if( HCIMetaEventType::INVALID != mec && !filter_test_metaev(mec) ) {
-                // DROP
-                COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV Drop (meta filter) %s", event->toString().c_str());
-                continue; // next packet
-            }
+        expirePendingCommands(false);
 
-            if( event->isEvent(HCIEventType::CMD_STATUS) || event->isEvent(HCIEventType::CMD_COMPLETE) )
-            {
-                COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV (CMD) %s", event->toString().c_str());
-                if( hciEventRing.isFull() ) {
-                    const int dropCount = hciEventRing.capacity()/4;
-                    hciEventRing.drop(dropCount);
-                    WARN_PRINT("HCIHandler-IO RECV Drop (%d oldest elements of %d capacity, ring full)", dropCount, hciEventRing.capacity());
-                }
-                hciEventRing.putBlocking( event );
-            } else if( event->isMetaEvent(HCIMetaEventType::LE_ADVERTISING_REPORT) ) {
-                // issue callbacks for the translated AD events
-                std::vector<std::shared_ptr<EInfoReport>> eirlist = EInfoReport::read_ad_reports(event->getParam(), event->getParamSize());
-                int i=0;
-                for_each_idx(eirlist, [&](std::shared_ptr<EInfoReport> &eir) {
-                    // COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV (AD EIR) %s", eir->toString().c_str());
-                    std::shared_ptr<MgmtEvent> mevent( new MgmtEvtDeviceFound(dev_id, eir) );
-                    sendMgmtEvent( mevent );
-                    i++;
-                });
-            } else {
-                // issue a callback for the translated event
-                std::shared_ptr<MgmtEvent> mevent = translate(event);
-                if( nullptr != mevent ) {
-                    COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV (CB) %s", event->toString().c_str());
-                    sendMgmtEvent( mevent );
-                } else {
-                    COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV Drop (no translation) %s", event->toString().c_str());
-                }
-            }
+        const int count = comm.read_batch(rbuffer.get_wptr(), rbufferSlotSize, rbufferLengths, env.HCI_READER_BATCH_SIZE,
+                                          env.HCI_READER_EXTERNAL ? handoverTimeout : env.HCI_READER_THREAD_POLL_TIMEOUT.load(),
+                                          aclDemux ? rbufferIncoming : nullptr, rbufferTimestamps);
+        if( 0 <= count ) {
+            dispatchBatch(count, metrics ? &metricDispatch : nullptr);
         } else if( ETIMEDOUT != errno && !hciReaderShallStop ) { // expected exits
             ERR_PRINT("HCIHandler::reader: HCIComm read error");
         }
     }
-    INFO_PRINT("HCIHandler::reader: Ended. Ring has %d entries flushed", hciEventRing.getSize());
+    if( hciReaderExternal ) {
+        // Handed over to the external event loop, which continues reading, see attachExternalReader()
+        const std::lock_guard<std::mutex> lock(mtx_hciReaderInit); // RAII-style acquire and relinquish via destructor
+        INFO_PRINT("HCIHandler::reader: Ended, handed over to external event loop");
+        hciReaderThreadId = 0;
+        cv_hciReaderInit.notify_all();
+        return;
+    }
+    expirePendingCommands(true);
+    INFO_PRINT("HCIHandler::reader: Ended. Ring has %d entries, %s, %s, %s, %s", hciEventRing.getSize(),
+            hciEventRing.getStats().toString().c_str(), hciEventPool.toString().c_str(), eirPool.toString().c_str(),
+            advDedupCache.toString().c_str());
     hciReaderRunning = false;
-    hciEventRing.clear();
 }
 
-void HCIHandler::sendMgmtEvent(std::shared_ptr<MgmtEvent> event) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
-    MgmtEventCallbackList & mgmtEventCallbackList = mgmtEventCallbackLists[static_cast<uint16_t>(event->getOpcode())];
+bool HCIHandler::attachExternalReader() {
+    std::unique_lock<std::mutex> lock(mtx_hciReaderInit); // RAII-style acquire and relinquish via destructor
+    if( hciReaderExternal ) {
+        return true;
+    }
+    if( !env.HCI_READER_EXTERNAL || !hciReaderRunning || pthread_self() == hciReaderThreadId ) {
+        ERR_PRINT("HCIHandler::attachExternalReader: Not enabled, not running or called by reader thread");
+        return false;
+    }
+    hciReaderExternal = true;
+    hciReaderShallStop = true;
+    comm.interrupt();
+    while( 0 != hciReaderThreadId ) {
+        cv_hciReaderInit.wait(lock);
+    }
+    metricExternalDispatch = DBTMetrics::get().isEnabled() ?
+            &DBTMetrics::get().getHistogram("hci_reader_dispatch", "dev_id", std::to_string(dev_id)) : nullptr;
+    DBG_PRINT("HCIHandler::attachExternalReader: fd %d", comm.poll_dd());
+    return true;
+}
+
+int HCIHandler::processReadable() {
+    if( !hciReaderExternal || !hciReaderRunning ) {
+        return -1;
+    }
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::processReadable: Not connected");
+        return -1;
+    }
+    struct pollfd p;
+    p.fd = comm.poll_dd(); p.events = POLLIN; p.revents = 0;
+    if( 0 >= poll(&p, 1, 0) ) {
+        return 0; // spurious wakeup
+    }
+    // Readable, hence read_batch w/o timeout returns at once with all pending packets
+    const int count = comm.read_batch(rbuffer.get_wptr(), rbufferSlotSize, rbufferLengths, env.HCI_READER_BATCH_SIZE, 0 /* timeout */,
+                                      aclDemux ? rbufferIncoming : nullptr, rbufferTimestamps);
+    if( 0 > count ) {
+        ERR_PRINT("HCIHandler::processReadable: HCIComm read error");
+        return -1;
+    }
+    dispatchBatch(count, metricExternalDispatch);
+    return count;
+}
+
+int32_t HCIHandler::processTimeouts() {
+    expirePendingCommands(false);
+    const uint64_t now = getCurrentMilliseconds();
+    int64_t next = -1;
+    std::unique_lock<std::mutex> lock(mtx_pendingCmdList); // RAII-style acquire and relinquish via destructor
+    for (auto it = pendingCmdList.begin(); it != pendingCmdList.end(); ++it) {
+        const int64_t left = it->deadline > now ? static_cast<int64_t>( it->deadline - now ) : 0;
+        if( 0 > next || left < next ) {
+            next = left;
+        }
+    }
+    return static_cast<int32_t>( std::min<int64_t>(next, INT32_MAX) );
+}
+
+void HCIHandler::sendMgmtEvent(const std::shared_ptr<MgmtEvent> & event) {
+    const MgmtEventCallbackList::snapshot_t mgmtEventCallbackList = mgmtEventCallbackLists[static_cast<uint16_t>(event->getOpcode())].get_snapshot();
     int invokeCount = 0;
-    if( mgmtEventCallbackList.size() > 0 ) {
-        for (auto it = mgmtEventCallbackList.begin(); it != mgmtEventCallbackList.end(); ++it) {
-            try {
-                it->invoke(event);
-            } catch (std::exception &e) {
-                ERR_PRINT("HCIHandler::sendMgmtEvent-CBs %d/%zd: MgmtEventCallback %s : Caught exception %s",
-                        invokeCount+1, mgmtEventCallbackList.size(),
-                        it->toString().c_str(), e.what());
-            }
-            invokeCount++;
+    for (auto it = mgmtEventCallbackList->begin(); it != mgmtEventCallbackList->end(); ++it) {
+        try {
+            it->invoke(*event);
+        } catch (std::exception &e) {
+            ERR_PRINT("HCIHandler::sendMgmtEvent-CBs %d/%zd: MgmtEventCallback %s : Caught exception %s",
+                    invokeCount+1, mgmtEventCallbackList->size(),
+                    it->toString().c_str(), e.what());
         }
+        invokeCount++;
     }
-    COND_PRINT(env.DEBUG_EVENT, "HCIHandler::sendMgmtEvent: Event %s -> %d/%zd callbacks", event->toString().c_str(), invokeCount, mgmtEventCallbackList.size());
+    COND_PRINT(env.DEBUG_EVENT, "HCIHandler::sendMgmtEvent: Event %s -> %d/%zd callbacks", event->toString().c_str(), invokeCount, mgmtEventCallbackList->size());
     (void)invokeCount;
 }
 
+void HCIHandler::sendAdvertisingReportBatch(const EInfoReportBatch & batch) {
+    if( 0 == batch.size() ) {
+        return;
+    }
+    const AdvertisingReportBatchCallbackList::snapshot_t callbacks = advReportBatchCallbackList.get_snapshot();
+    int invokeCount = 0;
+    for (auto it = callbacks->begin(); it != callbacks->end(); ++it) {
+        try {
+            it->invoke(batch);
+        } catch (std::exception &e) {
+            ERR_PRINT("HCIHandler::sendAdvertisingReportBatch-CBs %d/%zd: AdvertisingReportBatchCallback %s : Caught exception %s",
+                    invokeCount+1, callbacks->size(),
+                    it->toString().c_str(), e.what());
+        }
+        invokeCount++;
+    }
+    COND_PRINT(env.DEBUG_EVENT, "HCIHandler::sendAdvertisingReportBatch: %zd reports -> %d/%zd callbacks", batch.size(), invokeCount, callbacks->size());
+    (void)invokeCount;
+
+    if( mgmtEventCallbackLists[static_cast<uint16_t>(MgmtEvent::Opcode::DEVICE_FOUND)].size() > 0 ) {
+        // legacy per report delivery
+        for(size_t i=0; i<batch.size(); i++) {
+            std::shared_ptr<MgmtEvent> mevent( new MgmtEvtDeviceFound(dev_id, batch[i]) );
+            sendMgmtEvent( mevent );
+        }
+    }
+}
+
+bool HCIHandler::completePendingCommand(std::shared_ptr<HCIEvent> event) {
+    HCIOpcode opc;
+    uint8_t ncmd;
+    bool pending = false; // CMD_STATUS SUCCESS for CMD_COMPLETE command
+    if( event->isEvent(HCIEventType::CMD_COMPLETE) ) {
+        const HCICommandCompleteEvent * ev_cc = static_cast<const HCICommandCompleteEvent*>(event.get());
+        opc = ev_cc->getOpcode();
+        ncmd = ev_cc->getNumCommandPackets();
+    } else {
+        const HCICommandStatusEvent * ev_cs = static_cast<const HCICommandStatusEvent*>(event.get());
+        opc = ev_cs->getOpcode();
+        ncmd = ev_cs->getNumCommandPackets();
+        pending = HCIStatusCode::SUCCESS == ev_cs->getStatus();
+    }
+    bool found = false;
+    HCICommandReplyCallback * cb = nullptr;
+    std::vector<PendingCommand> done; // at most one
+    {
+        std::unique_lock<std::mutex> lock(mtx_pendingCmdList); // RAII-style acquire and relinquish via destructor
+        cmdCredits = ncmd;
+        for (auto it = pendingCmdList.begin(); it != pendingCmdList.end(); ++it) {
+            if( it->opcode == opc ) {
+                found = true;
+                if( !( pending && it->expectComplete ) ) {
+                    done.push_back(*it);
+                    pendingCmdList.erase(it);
+                    cb = &done[0].cb;
+                }
+                break;
+            }
+        }
+        cv_cmdCredits.notify_all();
+    }
+    if( nullptr != cb ) {
+        try {
+            cb->invoke(event);
+        } catch (std::exception &e) {
+            ERR_PRINT("HCIHandler::completePendingCommand: HCICommandReplyCallback %s: Caught exception %s",
+                    cb->toString().c_str(), e.what());
+        }
+    }
+    return found;
+}
+
+void HCIHandler::expirePendingCommands(const bool all) {
+    std::vector<PendingCommand> done;
+    {
+        const uint64_t now = getCurrentMilliseconds();
+        std::unique_lock<std::mutex> lock(mtx_pendingCmdList); // RAII-style acquire and relinquish via destructor
+        for (auto it = pendingCmdList.begin(); it != pendingCmdList.end(); ) {
+            if( all || now >= it->deadline ) {
+                done.push_back(*it);
+                it = pendingCmdList.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if( all ) {
+            cv_cmdCredits.notify_all();
+        }
+    }
+    for(size_t i=0; i<done.size(); i++) {
+        WARN_PRINT("HCIHandler::expirePendingCommands: %s: Timeout", getHCIOpcodeString(done[i].opcode).c_str());
+        try {
+            done[i].cb.invoke(nullptr);
+        } catch (std::exception &e) {
+            ERR_PRINT("HCIHandler::expirePendingCommands: HCICommandReplyCallback %s: Caught exception %s",
+                    done[i].cb.toString().c_str(), e.what());
+        }
+    }
+}
+
+bool HCIHandler::sendCommandAsync(HCICommand &req, const bool expectComplete, const HCICommandReplyCallback & cb, const int32_t timeoutMS) {
+    if( !comm.isOpen() || !hciReaderRunning ) {
+        ERR_PRINT("HCIHandler::sendCommandAsync: device not open");
+        return false;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx_pendingCmdList); // RAII-style acquire and relinquish via destructor
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        while( 0 >= cmdCredits ) {
+            if( std::cv_status::timeout == cv_cmdCredits.wait_until(lock, t0 + std::chrono::milliseconds(timeoutMS)) ) {
+                if( 0 < cmdCredits ) {
+                    break;
+                }
+                errno = ETIMEDOUT;
+                ERR_PRINT("HCIHandler::sendCommandAsync: No command credit (timeout %d ms): req %s", timeoutMS, req.toString().c_str());
+                return false;
+            }
+            if( !hciReaderRunning ) {
+                return false;
+            }
+        }
+        // Register before sending, as the reply may overtake us
+        pendingCmdList.push_back( PendingCommand(req.getOpcode(), expectComplete, getCurrentMilliseconds() + timeoutMS, cb) );
+        cmdCredits--;
+    }
+    if( !sendCommand(req) ) {
+        std::unique_lock<std::mutex> lock(mtx_pendingCmdList); // RAII-style acquire and relinquish via destructor
+        for (auto it = pendingCmdList.begin(); it != pendingCmdList.end(); ++it) {
+            if( it->opcode == req.getOpcode() && it->cb == cb ) {
+                pendingCmdList.erase(it);
+                break;
+            }
+        }
+        cmdCredits++;
+        return false;
+    }
+    return true;
+}
+
 bool HCIHandler::sendCommand(HCICommand &req) {
     COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO SENT %s", req.toString().c_str());
 
     TROOctets & pdu = req.getPDU();
+    DBTTrace::get().record(TraceSource::HCI_CMD, getCurrentMilliseconds(), number(req.getOpcode()), 0, dev_id, req.getParamSize());
     if ( comm.write( pdu.get_ptr(), pdu.getSize() ) < 0 ) {
         ERR_PRINT("HCIHandler::sendCommand: HCIComm write error, req %s", req.toString().c_str());
         return false;
@@ -348,6 +1044,13 @@ bool HCIHandler::sendCommand(HCICommand &req) {
     return true;
 }
 
+void HCIHandler::discardStaleReplies() {
+    std::shared_ptr<HCIEvent> ev;
+    while( nullptr != ( ev = hciEventRing.get() ) ) {
+        COND_PRINT(env.DEBUG_EVENT, "HCIHandler-IO RECV discard stale reply %s", ev->toString().c_str());
+    }
+}
+
 std::shared_ptr<HCIEvent> HCIHandler::getNextReply(HCICommand &req, int32_t & retryCount, const int32_t replyTimeoutMS)
 {
     // Ringbuffer read is thread safe
@@ -373,13 +1076,15 @@ std::shared_ptr<HCIEvent> HCIHandler::getNextReply(HCICommand &req, int32_t & re
 }
 
 std::shared_ptr<HCIEvent> HCIHandler::sendWithCmdCompleteReply(HCICommand &req, HCICommandCompleteEvent **res) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sendReply); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_sendReply); // RAII-style acquire and relinquish via destructor
 
     *res = nullptr;
 
+    const uint64_t t0 = getCurrentMicroseconds();
     int32_t retryCount = 0;
     std::shared_ptr<HCIEvent> ev = nullptr;
 
+    discardStaleReplies();
     if( !sendCommand(req) ) {
         goto exit;
     }
@@ -417,20 +1122,43 @@ std::shared_ptr<HCIEvent> HCIHandler::sendWithCmdCompleteReply(HCICommand &req,
     }
 
 exit:
+    if( DBTMetrics::get().isEnabled() ) {
+        DBTMetrics::get().getHistogram("hci_command", "opcode", getHCIOpcodeString(req.getOpcode())).recordSince(t0, nullptr != *res);
+    }
     return ev;
 }
 
 HCIHandler::HCIHandler(const BTMode btMode, const uint16_t dev_id)
 : env(HCIEnv::get()),
-  btMode(btMode), dev_id(dev_id), rbuffer(HCI_MAX_MTU),
-  comm(dev_id, HCI_CHANNEL_RAW),
-  hciEventRing(env.HCI_EVT_RING_CAPACITY), hciReaderRunning(false), hciReaderShallStop(false)
+  btMode(btMode), dev_id(dev_id),
+  rbufferSlotSize(env.HCI_ACL_DEMUX ? HCI_MAX_ACL_MTU : HCI_MAX_MTU), rbuffer(rbufferSlotSize * env.HCI_READER_BATCH_SIZE),
+  comm(dev_id, HCI_CHANNEL_RAW), metaev_filter_mask(0), opcbit_filter_mask(0),
+  hciEventPool(env.HCI_EVT_RING_CAPACITY), eirPool(env.HCI_EVT_RING_CAPACITY), hciEventRing(env.HCI_EVT_RING_CAPACITY, env.HCI_EVT_RING_OPTIONS, true /* spsc */), hciReaderRunning(false), hciReaderShallStop(false),
+  hciReaderExternal(false), metricExternalDispatch(nullptr),
+  cmdCredits(1),
+  connectionHandleIndex(CONNECTION_HANDLE_INDEX_SIZE), connectionAddressIndex(new TrackerAddressIndex()),
+  aclDemux(false), leExtAdvSupported(false), leCodedPHYSupported(false), le2MPHYSupported(false), leDataLenExtSupported(false),
+  advDedupCache(env.HCI_ADV_DEDUP_CACHE_SIZE, env.HCI_ADV_DEDUP_WINDOW, env.HCI_ADV_DEDUP_RSSI_DELTA), advDedupCacheClearReq(false),
+  extAdvFragments(HCI_EXT_ADV_FRAGMENT_SLOTS)
 {
     INFO_PRINT("HCIHandler.ctor: pid %d", HCIHandler::pidSelf);
+    HCIComm::filter_clear(&filter_mask);
     if( !comm.isOpen() ) {
         ERR_PRINT("HCIHandler::ctor: Could not open hci control channel");
         return;
     }
+    if( env.HCI_ACL_DEMUX ) {
+        // Required to distinguish received ACL data from our own sent ACL data
+        const int opt = 1;
+        if( setsockopt(comm.dd(), SOL_HCI, HCI_DATA_DIR, &opt, sizeof(opt)) < 0 ) {
+            ERR_PRINT("HCIHandler::ctor: setsockopt HCI_DATA_DIR -> ACL data demultiplexing disabled");
+        } else {
+            aclDemux = true;
+        }
+    }
+    if( env.HCI_RX_TIMESTAMPS && !comm.enableRxTimestamps() ) {
+        WARN_PRINT("HCIHandler::ctor: setsockopt HCI_TIME_STAMP failed -> using read timestamps");
+    }
 
     {
         std::unique_lock<std::mutex> lock(mtx_hciReaderInit); // RAII-style acquire and relinquish via destructor
@@ -448,46 +1176,14 @@ HCIHandler::HCIHandler(const BTMode btMode, const uint16_t dev_id)
 
     PERF_TS_T0();
 
-    // Mandatory socket filter (not adapter filter!)
+    // Mandatory socket filter (not adapter filter!) and own LE_META filter,
+    // minimal set as no MgmtEventCallback has been registered yet.
     {
-#if 0
-        // No use for pre-existing hci_ufilter
-        hci_ufilter of;
-        socklen_t olen;
-
-        olen = sizeof(of);
-        if (getsockopt(comm.dd(), SOL_HCI, HCI_FILTER, &of, &olen) < 0) {
-            ERR_PRINT("HCIHandler::ctor: getsockopt");
-            goto fail;
-        }
-#endif
-        HCIComm::filter_clear(&filter_mask);
-        HCIComm::filter_set_ptype(number(HCIPacketType::EVENT),  &filter_mask); // only EVENTs
-        // Setup generic filter mask for all events, this is also required for
-        // HCIComm::filter_all_events(&filter_mask); // all events
-        HCIComm::filter_set_event(number(HCIEventType::CONN_COMPLETE), &filter_mask);
-        HCIComm::filter_set_event(number(HCIEventType::DISCONN_COMPLETE), &filter_mask);
-        HCIComm::filter_set_event(number(HCIEventType::CMD_COMPLETE), &filter_mask);
-        HCIComm::filter_set_event(number(HCIEventType::CMD_STATUS), &filter_mask);
-        HCIComm::filter_set_event(number(HCIEventType::HARDWARE_ERROR), &filter_mask);
-        HCIComm::filter_set_event(number(HCIEventType::LE_META), &filter_mask);
-        // HCIComm::filter_set_event(number(HCIEventType::DISCONN_PHY_LINK_COMPLETE), &filter_mask);
-        // HCIComm::filter_set_event(number(HCIEventType::DISCONN_LOGICAL_LINK_COMPLETE), &filter_mask);
-        HCIComm::filter_set_opcode(0, &filter_mask); // all opcode
-
-        if (setsockopt(comm.dd(), SOL_HCI, HCI_FILTER, &filter_mask, sizeof(filter_mask)) < 0) {
-            ERR_PRINT("HCIHandler::ctor: setsockopt");
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+        if( !updateEventFilter() ) {
             goto fail;
         }
     }
-    // Mandatory own LE_META filter
-    {
-        uint32_t mask = 0;
-        // filter_all_metaevs(mask);
-        filter_set_metaev(HCIMetaEventType::LE_CONN_COMPLETE, mask);
-        filter_set_metaev(HCIMetaEventType::LE_ADVERTISING_REPORT, mask);
-        filter_put_metaevs(mask);
-    }
     // Mandatory own HCIOpcodeBit/HCIOpcode filter
     {
         uint64_t mask = 0;
@@ -496,24 +1192,79 @@ HCIHandler::HCIHandler(const BTMode btMode, const uint16_t dev_id)
         filter_set_opcbit(HCIOpcodeBit::DISCONNECT, mask);
         filter_set_opcbit(HCIOpcodeBit::RESET, mask);
         filter_set_opcbit(HCIOpcodeBit::READ_LOCAL_VERSION, mask);
+        filter_set_opcbit(HCIOpcodeBit::READ_RSSI, mask);
+        filter_set_opcbit(HCIOpcodeBit::READ_TX_POWER, mask);
         filter_set_opcbit(HCIOpcodeBit::LE_SET_SCAN_PARAM, mask);
         filter_set_opcbit(HCIOpcodeBit::LE_SET_SCAN_ENABLE, mask);
         filter_set_opcbit(HCIOpcodeBit::LE_CREATE_CONN, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_LOCAL_FEATURES, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_BUFFER_SIZE, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_WHITE_LIST_SIZE, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_CLEAR_WHITE_LIST, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_ADD_TO_WHITE_LIST, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_DEL_FROM_WHITE_LIST, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_RESOLV_LIST_SIZE, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_MAX_DATA_LEN, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_CONN_UPDATE, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_DATA_LEN, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_PHY, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_PHY, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_EXT_SCAN_PARAMS, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_EXT_SCAN_ENABLE, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_ADV_SET_RANDOM_ADDR, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_EXT_ADV_PARAMS, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_EXT_ADV_DATA, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_EXT_SCAN_RSP_DATA, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_SET_EXT_ADV_ENABLE, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_MAX_ADV_DATA_LEN, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_READ_NUM_SUPPORTED_ADV_SETS, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_REMOVE_ADV_SET, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_CLEAR_ADV_SETS, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_PERIODIC_ADV_CREATE_SYNC, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_PERIODIC_ADV_CREATE_SYNC_CANCEL, mask);
+        filter_set_opcbit(HCIOpcodeBit::LE_PERIODIC_ADV_TERMINATE_SYNC, mask);
         filter_put_opcbit(mask);
     }
     {
         HCICommand req0(HCIOpcode::READ_LOCAL_VERSION, 0);
-        const hci_rp_read_local_version * ev_lv;
-        HCIStatusCode status;
-        std::shared_ptr<HCIEvent> ev = processCommandComplete(req0, &ev_lv, &status);
-        if( nullptr == ev || nullptr == ev_lv ) {
+        HCIReplyView<hci_rp_read_local_version> ev_lv;
+        HCIStatusCode status = processCommandComplete(req0, ev_lv);
+        if( !ev_lv.isValid() ) {
             ERR_PRINT("HCIHandler::ctor: failed READ_LOCAL_VERSION: 0x%x (%s)", number(status), getHCIStatusCodeString(status).c_str());
             goto fail;
         }
         INFO_PRINT("HCIHandler: LOCAL_VERSION: %d (rev %d), manuf 0x%x, lmp %d (subver %d)",
                 ev_lv->hci_ver, le_to_cpu(ev_lv->hci_rev), le_to_cpu(ev_lv->manufacturer),
                 ev_lv->lmp_ver, le_to_cpu(ev_lv->lmp_subver));
+        controllerCaps.probed = true;
+        controllerCaps.hci_version = ev_lv->hci_ver;
+        controllerCaps.hci_revision = le_to_cpu(ev_lv->hci_rev);
+        controllerCaps.lmp_version = ev_lv->lmp_ver;
+        controllerCaps.lmp_subversion = le_to_cpu(ev_lv->lmp_subver);
+        controllerCaps.manufacturer = le_to_cpu(ev_lv->manufacturer);
     }
+    {
+        HCICommand req0(HCIOpcode::LE_READ_LOCAL_FEATURES, 0);
+        HCIReplyView<hci_rp_le_read_local_features> ev_lf;
+        HCIStatusCode status = processCommandComplete(req0, ev_lf);
+        if( !ev_lf.isValid() || HCIStatusCode::SUCCESS != status ) {
+            // Not fatal, legacy scanning only
+            WARN_PRINT("HCIHandler::ctor: failed LE_READ_LOCAL_FEATURES: 0x%x (%s)", number(status), getHCIStatusCodeString(status).c_str());
+        } else {
+            leExtAdvSupported = 0 != ( ev_lf->features[1] & HCI_LE_EXT_ADV );
+            leCodedPHYSupported = 0 != ( ev_lf->features[1] & HCI_LE_PHY_CODED );
+            le2MPHYSupported = 0 != ( ev_lf->features[1] & HCI_LE_PHY_2M );
+            leDataLenExtSupported = 0 != ( ev_lf->features[0] & HCI_LE_DATA_LEN_EXT );
+            for(int i=sizeof(ev_lf->features)-1; i>=0; --i) {
+                controllerCaps.le_features = ( controllerCaps.le_features << 8 ) | ev_lf->features[i];
+            }
+            INFO_PRINT("HCIHandler: LE_FEATURES: %s, ext-adv %d, coded-phy %d, 2m-phy %d, data-len-ext %d",
+                    bytesHexString(ev_lf->features, 0, sizeof(ev_lf->features), true /* lsbFirst */).c_str(),
+                    leExtAdvSupported, leCodedPHYSupported, le2MPHYSupported, leDataLenExtSupported);
+        }
+    }
+
+    probeControllerCaps();
 
     PERF_TS_TD("HCIHandler::open.ok");
     return;
@@ -524,11 +1275,129 @@ fail:
     return;
 }
 
+void HCIHandler::probeControllerCaps() {
+    // All probes are optional, an unsupported command leaves its capability unknown, i.e. zero.
+    {
+        HCICommand req0(HCIOpcode::LE_READ_BUFFER_SIZE, 0);
+        HCIReplyView<hci_rp_le_read_buffer_size> ev_bs;
+        HCIStatusCode status = processCommandComplete(req0, ev_bs);
+        if( !ev_bs.isValid() || HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("HCIHandler::ctor: failed LE_READ_BUFFER_SIZE: 0x%x (%s)", number(status), getHCIStatusCodeString(status).c_str());
+        } else {
+            controllerCaps.le_acl_mtu = le_to_cpu(ev_bs->le_mtu);
+            controllerCaps.le_acl_pkts = ev_bs->le_max_pkt;
+        }
+    }
+    {
+        HCICommand req0(HCIOpcode::LE_READ_WHITE_LIST_SIZE, 0);
+        HCIReplyView<hci_rp_le_read_white_list_size> ev_wl;
+        HCIStatusCode status = processCommandComplete(req0, ev_wl);
+        if( !ev_wl.isValid() || HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("HCIHandler::ctor: failed LE_READ_WHITE_LIST_SIZE: 0x%x (%s)", number(status), getHCIStatusCodeString(status).c_str());
+        } else {
+            controllerCaps.white_list_size = ev_wl->size;
+        }
+    }
+    if( controllerCaps.isLEFeatureSupported(ControllerCaps::LEFeature::LL_PRIVACY) ) {
+        HCICommand req0(HCIOpcode::LE_READ_RESOLV_LIST_SIZE, 0);
+        HCIReplyView<hci_rp_le_read_resolv_list_size> ev_rl;
+        HCIStatusCode status = processCommandComplete(req0, ev_rl);
+        if( !ev_rl.isValid() || HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("HCIHandler::ctor: failed LE_READ_RESOLV_LIST_SIZE: 0x%x (%s)", number(status), getHCIStatusCodeString(status).c_str());
+        } else {
+            controllerCaps.resolv_list_size = ev_rl->size;
+        }
+    }
+    if( leDataLenExtSupported ) {
+        HCICommand req0(HCIOpcode::LE_READ_MAX_DATA_LEN, 0);
+        HCIReplyView<hci_rp_le_read_max_data_len> ev_dl;
+        HCIStatusCode status = processCommandComplete(req0, ev_dl);
+        if( !ev_dl.isValid() || HCIStatusCode::SUCCESS != status ) {
+            WARN_PRINT("HCIHandler::ctor: failed LE_READ_MAX_DATA_LEN: 0x%x (%s)", number(status), getHCIStatusCodeString(status).c_str());
+        } else {
+            controllerCaps.max_tx_octets = le_to_cpu(ev_dl->tx_len);
+            controllerCaps.max_tx_time = le_to_cpu(ev_dl->tx_time);
+            controllerCaps.max_rx_octets = le_to_cpu(ev_dl->rx_len);
+            controllerCaps.max_rx_time = le_to_cpu(ev_dl->rx_time);
+        }
+    }
+    INFO_PRINT("HCIHandler: %s", controllerCaps.toString().c_str());
+}
+
+bool HCIHandler::hasMgmtEventCallback(const MgmtEvent::Opcode opc) const {
+    return mgmtEventCallbackLists[static_cast<uint16_t>(opc)].size() > 0;
+}
+
+bool HCIHandler::updateEventFilter() {
+    const bool listenConnect = hasMgmtEventCallback(MgmtEvent::Opcode::DEVICE_CONNECTED) ||
+                               hasMgmtEventCallback(MgmtEvent::Opcode::CONNECT_FAILED);
+    const bool listenDisconnect = hasMgmtEventCallback(MgmtEvent::Opcode::DEVICE_DISCONNECTED);
+    const bool listenAdvertising = hasMgmtEventCallback(MgmtEvent::Opcode::DEVICE_FOUND) ||
+                                   advReportBatchCallbackList.size() > 0 || beaconRecordCallbackList.size() > 0;
+    const bool listenPeriodic = listenPeriodicAdv;
+
+    hci_ufilter mask;
+    HCIComm::filter_clear(&mask);
+    HCIComm::filter_set_ptype(number(HCIPacketType::EVENT),  &mask); // EVENTs
+    if( aclChannels.size() > 0 ) {
+        HCIComm::filter_set_ptype(number(HCIPacketType::ACLDATA),  &mask); // ACL data of demultiplexed connections
+    }
+    // Mandatory for sequential command processing
+    HCIComm::filter_set_event(number(HCIEventType::CMD_COMPLETE), &mask);
+    HCIComm::filter_set_event(number(HCIEventType::CMD_STATUS), &mask);
+    HCIComm::filter_set_event(number(HCIEventType::HARDWARE_ERROR), &mask);
+    if( listenConnect ) {
+        HCIComm::filter_set_event(number(HCIEventType::CONN_COMPLETE), &mask);
+    }
+    if( listenDisconnect ) {
+        HCIComm::filter_set_event(number(HCIEventType::DISCONN_COMPLETE), &mask);
+    }
+    if( listenConnect || listenAdvertising || listenPeriodic ) {
+        HCIComm::filter_set_event(number(HCIEventType::LE_META), &mask);
+    }
+    // HCIComm::filter_set_event(number(HCIEventType::DISCONN_PHY_LINK_COMPLETE), &mask);
+    // HCIComm::filter_set_event(number(HCIEventType::DISCONN_LOGICAL_LINK_COMPLETE), &mask);
+    HCIComm::filter_set_opcode(0, &mask); // all opcode
+
+    uint32_t metaMask = 0;
+    if( listenConnect ) {
+        filter_set_metaev(HCIMetaEventType::LE_CONN_COMPLETE, metaMask);
+    }
+    if( listenAdvertising ) {
+        filter_set_metaev(HCIMetaEventType::LE_ADVERTISING_REPORT, metaMask);
+        filter_set_metaev(HCIMetaEventType::LE_EXT_ADV_REPORT, metaMask);
+    }
+    if( listenPeriodic ) {
+        filter_set_metaev(HCIMetaEventType::LE_PERIODIC_ADV_SYNC_ESTABLISHED, metaMask);
+        filter_set_metaev(HCIMetaEventType::LE_PERIODIC_ADV_REPORT, metaMask);
+        filter_set_metaev(HCIMetaEventType::LE_PERIODIC_ADV_SYNC_LOST, metaMask);
+    }
+    // Allow new meta events before receiving them, but drop unwanted only after the kernel filter has been installed.
+    filter_put_metaevs(metaev_filter_mask | metaMask);
+
+    if( 0 != memcmp(&mask, &filter_mask, sizeof(mask)) ) {
+        // A pluggable transport has no kernel filter, relying on the own filter only
+        if( comm.isKernelSocket() && setsockopt(comm.dd(), SOL_HCI, HCI_FILTER, &mask, sizeof(mask)) < 0 ) {
+            ERR_PRINT("HCIHandler::updateEventFilter: setsockopt");
+            return false;
+        }
+        filter_mask = mask;
+        COND_PRINT(env.DEBUG_EVENT, "HCIHandler::updateEventFilter: connect %d, disconnect %d, advertising %d",
+                listenConnect, listenDisconnect, listenAdvertising);
+    }
+    filter_put_metaevs(metaMask);
+    return true;
+}
+
 void HCIHandler::close() {
     const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
     DBG_PRINT("HCIHandler::close: Start");
 
     clearAllMgmtEventCallbacks();
+    clearAdvertisingReportBatchCallbacks();
+    clearBeaconRecordCallbacks();
+    periodicAdvSyncs.clear();
+    clearL2CAPFrameCallbacks();
 
     const pthread_t tid_self = pthread_self();
     const pthread_t tid_reader = hciReaderThreadId;
@@ -536,13 +1405,17 @@ void HCIHandler::close() {
     const bool is_reader = tid_reader == tid_self;
     DBG_PRINT("HCIHandler.disconnect: Start hciReader[running %d, shallStop %d, isReader %d, tid %p)",
             hciReaderRunning.load(), hciReaderShallStop.load(), is_reader, (void*)tid_reader);
-    if( hciReaderRunning ) {
+    if( hciReaderExternal ) {
+        // No reader thread, the external event loop shall remove our fd
         hciReaderShallStop = true;
-        if( !is_reader && 0 != tid_reader ) {
-            int kerr;
-            if( 0 != ( kerr = pthread_kill(tid_reader, SIGALRM) ) ) {
-                ERR_PRINT("HCIHandler::disconnect: pthread_kill %p FAILED: %d", (void*)tid_reader, kerr);
-            }
+        if( hciReaderRunning ) {
+            expirePendingCommands(true);
+            hciReaderRunning = false;
+        }
+    } else if( hciReaderRunning ) {
+        hciReaderShallStop = true;
+        if( !is_reader ) {
+            comm.interrupt(); // wake up the reader at once
         }
     }
     comm.close();
@@ -568,6 +1441,10 @@ HCIStatusCode HCIHandler::le_set_scan_param(const bool le_scan_active,
                                             const HCILEOwnAddressType own_mac_type,
                                             const uint16_t le_scan_interval, const uint16_t le_scan_window,
                                             const uint8_t filter_policy) {
+    if( env.HCI_EXT_SCAN && leExtAdvSupported ) {
+        const uint8_t le_scan_phys = LE_SCAN_PHY_1M | ( leCodedPHYSupported ? LE_SCAN_PHY_CODED : 0 );
+        return le_set_ext_scan_param(le_scan_active, own_mac_type, le_scan_interval, le_scan_window, filter_policy, le_scan_phys);
+    }
     const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
     if( !comm.isOpen() ) {
         ERR_PRINT("HCIHandler::le_set_scan_param: device not open");
@@ -581,31 +1458,314 @@ HCIStatusCode HCIHandler::le_set_scan_param(const bool le_scan_active,
     cp->own_address_type = static_cast<uint8_t>(own_mac_type);
     cp->filter_policy = filter_policy;
 
-    const hci_rp_status * ev_status;
-    HCIStatusCode status;
-    std::shared_ptr<HCIEvent> ev = processCommandComplete(req0, &ev_status, &status);
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_enable_scan(const bool enable, const bool filter_dup) {
+    if( env.HCI_EXT_SCAN && leExtAdvSupported ) {
+        return le_enable_ext_scan(enable, filter_dup);
+    }
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_enable_scan: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( enable ) {
+        clearAdvDedupCache(); // report all advertisers of the new scan session
+    }
+    HCIStructCommand<hci_cp_le_set_scan_enable> req0(HCIOpcode::LE_SET_SCAN_ENABLE);
+    hci_cp_le_set_scan_enable * cp = req0.getWStruct();
+    cp->enable = enable ? LE_SCAN_ENABLE : LE_SCAN_DISABLE;
+    cp->filter_dup = filter_dup ? LE_SCAN_FILTER_DUP_ENABLE : LE_SCAN_FILTER_DUP_DISABLE;
+
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+
+    if( HCIStatusCode::SUCCESS == status ) {
+        MgmtEvtDiscovering *e = new MgmtEvtDiscovering(dev_id, ScanType::LE, enable);
+        sendMgmtEvent(std::shared_ptr<MgmtEvent>(e));
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_set_ext_scan_param(const bool le_scan_active,
+                                                const HCILEOwnAddressType own_mac_type,
+                                                const uint16_t le_scan_interval, const uint16_t le_scan_window,
+                                                const uint8_t filter_policy, const uint8_t le_scan_phys) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_set_ext_scan_param: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    // LE 2M PHY is not allowed for scanning
+    if( 0 == le_scan_phys || 0 != ( le_scan_phys & ~( LE_SCAN_PHY_1M | LE_SCAN_PHY_CODED ) ) ) {
+        ERR_PRINT("HCIHandler::le_set_ext_scan_param: invalid scanning PHYs 0x%x", le_scan_phys);
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCILESetExtScanParamsCmd req0(static_cast<uint8_t>(own_mac_type), filter_policy, le_scan_phys,
+                                  le_scan_active ? LE_SCAN_ACTIVE : LE_SCAN_PASSIVE, le_scan_interval, le_scan_window);
+
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_enable_ext_scan(const bool enable, const bool filter_dup,
+                                             const uint16_t duration, const uint16_t period) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_enable_ext_scan: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( enable ) {
+        clearAdvDedupCache(); // report all advertisers of the new scan session
+    }
+    HCIStructCommand<hci_cp_le_set_ext_scan_enable> req0(HCIOpcode::LE_SET_EXT_SCAN_ENABLE);
+    hci_cp_le_set_ext_scan_enable * cp = req0.getWStruct();
+    cp->enable = enable ? LE_SCAN_ENABLE : LE_SCAN_DISABLE;
+    cp->filter_dup = filter_dup ? LE_SCAN_FILTER_DUP_ENABLE : LE_SCAN_FILTER_DUP_DISABLE;
+    cp->duration = cpu_to_le(duration);
+    cp->period = cpu_to_le(period);
+
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+
+    if( HCIStatusCode::SUCCESS == status ) {
+        MgmtEvtDiscovering *e = new MgmtEvtDiscovering(dev_id, ScanType::LE, enable);
+        sendMgmtEvent(std::shared_ptr<MgmtEvent>(e));
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_read_num_supported_adv_sets(uint8_t & num_sets) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    num_sets = 0;
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_read_num_supported_adv_sets: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCICommand req0(HCIOpcode::LE_READ_NUM_SUPPORTED_ADV_SETS, 0);
+    HCIReplyView<hci_rp_le_read_num_supported_adv_sets> ev_res;
+    HCIStatusCode status = processCommandComplete(req0, ev_res);
+    if( ev_res.isValid() && HCIStatusCode::SUCCESS == status ) {
+        num_sets = ev_res->num_of_sets;
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_read_max_adv_data_len(uint16_t & max_len) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    max_len = 0;
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_read_max_adv_data_len: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCICommand req0(HCIOpcode::LE_READ_MAX_ADV_DATA_LEN, 0);
+    HCIReplyView<hci_rp_le_read_max_adv_data_len> ev_res;
+    HCIStatusCode status = processCommandComplete(req0, ev_res);
+    if( ev_res.isValid() && HCIStatusCode::SUCCESS == status ) {
+        max_len = le_to_cpu(ev_res->max_len);
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_set_ext_adv_params(const uint8_t handle, const uint16_t evt_properties,
+                                                const uint32_t interval_min, const uint32_t interval_max,
+                                                const HCILEOwnAddressType own_mac_type, const uint8_t channel_map,
+                                                const int8_t tx_power, const uint8_t primary_phy, const uint8_t secondary_phy,
+                                                const uint8_t sid, int8_t & selected_tx_power) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    selected_tx_power = 0;
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_set_ext_adv_params: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( 0xEF < handle || 0x0F < sid || 0x20 > interval_min || interval_min > interval_max || 0xFFFFFF < interval_max ||
+        0 == ( channel_map & 0x07 ) )
+    {
+        ERR_PRINT("HCIHandler::le_set_ext_adv_params: invalid parameter: handle %u, sid %u, interval [%u..%u], channels 0x%x",
+                  handle, sid, interval_min, interval_max, channel_map);
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCIStructCommand<hci_cp_le_set_ext_adv_params> req0(HCIOpcode::LE_SET_EXT_ADV_PARAMS);
+    hci_cp_le_set_ext_adv_params * cp = req0.getWStruct();
+    cp->handle = handle;
+    cp->evt_properties = cpu_to_le(evt_properties);
+    // 24 bit little endian intervals
+    for(int i=0; i<3; i++) {
+        cp->min_interval[i] = static_cast<uint8_t>( interval_min >> ( 8 * i ) );
+        cp->max_interval[i] = static_cast<uint8_t>( interval_max >> ( 8 * i ) );
+    }
+    cp->channel_map = channel_map & 0x07;
+    cp->own_addr_type = static_cast<uint8_t>(own_mac_type);
+    cp->tx_power = static_cast<uint8_t>(tx_power);
+    cp->primary_phy = primary_phy;
+    cp->secondary_phy = secondary_phy;
+    cp->sid = sid;
+
+    HCIReplyView<hci_rp_le_set_ext_adv_params> ev_res;
+    HCIStatusCode status = processCommandComplete(req0, ev_res);
+    if( ev_res.isValid() && HCIStatusCode::SUCCESS == status ) {
+        selected_tx_power = static_cast<int8_t>(ev_res->tx_power);
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_set_ext_adv_data(const bool scanRsp, const uint8_t handle, const uint8_t * data, const int length) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_set_ext_adv_data: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( 0 > length ) {
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    const int max = HCILESetExtAdvDataCmd::MAX_DATA_LEN;
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = HCIStatusCode::SUCCESS;
+    if( length <= max ) {
+        HCILESetExtAdvDataCmd req0(scanRsp, handle, HCILESetExtAdvDataCmd::OP_COMPLETE, HCILESetExtAdvDataCmd::FRAG_MINIMIZE, data, length);
+        status = processCommandComplete(req0, ev_status);
+        return status;
+    }
+    for(int offset = 0; offset < length && HCIStatusCode::SUCCESS == status; offset += max) {
+        const int n = std::min(max, length - offset);
+        const uint8_t op = 0 == offset ? HCILESetExtAdvDataCmd::OP_FIRST :
+                           ( offset + n == length ? HCILESetExtAdvDataCmd::OP_LAST : HCILESetExtAdvDataCmd::OP_INTERMEDIATE );
+        HCILESetExtAdvDataCmd req0(scanRsp, handle, op, HCILESetExtAdvDataCmd::FRAG_ALLOWED, data + offset, n);
+        status = processCommandComplete(req0, ev_status);
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_enable_ext_adv(const bool enable, const HCILESetExtAdvEnableCmd::Set * sets, const int count) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_enable_ext_adv: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( 0 > count || 63 < count || ( enable && 0 == count ) ) {
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCILESetExtAdvEnableCmd req0(enable, sets, count);
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_remove_adv_set(const uint8_t handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_remove_adv_set: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCIStructCommand<hci_cp_le_remove_adv_set> req0(HCIOpcode::LE_REMOVE_ADV_SET);
+    req0.getWStruct()->handle = handle;
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_clear_adv_sets() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_clear_adv_sets: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCICommand req0(HCIOpcode::LE_CLEAR_ADV_SETS, 0);
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
     return status;
 }
 
-HCIStatusCode HCIHandler::le_enable_scan(const bool enable, const bool filter_dup) {
+HCIStatusCode HCIHandler::le_set_adv_set_random_addr(const uint8_t handle, const EUI48 & address) {
     const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
     if( !comm.isOpen() ) {
-        ERR_PRINT("HCIHandler::le_enable_scan: device not open");
+        ERR_PRINT("HCIHandler::le_set_adv_set_random_addr: device not open");
         return HCIStatusCode::INTERNAL_FAILURE;
     }
-    HCIStructCommand<hci_cp_le_set_scan_enable> req0(HCIOpcode::LE_SET_SCAN_ENABLE);
-    hci_cp_le_set_scan_enable * cp = req0.getWStruct();
-    cp->enable = enable ? LE_SCAN_ENABLE : LE_SCAN_DISABLE;
-    cp->filter_dup = filter_dup ? LE_SCAN_FILTER_DUP_ENABLE : LE_SCAN_FILTER_DUP_DISABLE;
+    HCIStructCommand<hci_cp_le_set_adv_set_rand_addr> req0(HCIOpcode::LE_SET_ADV_SET_RANDOM_ADDR);
+    hci_cp_le_set_adv_set_rand_addr * cp = req0.getWStruct();
+    cp->handle = handle;
+    cp->bdaddr = address;
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
 
-    const hci_rp_status * ev_status;
+HCIStatusCode HCIHandler::le_create_periodic_sync(const uint8_t sid, const EUI48 & address, const HCILEPeerAddressType address_type,
+                                                  const std::shared_ptr<PeriodicAdvSyncListener> & listener, uint16_t & sync_handle,
+                                                  const uint16_t skip, const uint16_t sync_timeout, const int32_t timeoutMS)
+{
+    if( nullptr == listener || 0x0F < sid || 0x01F3 < skip || 0x000A > sync_timeout || 0x4000 < sync_timeout ) {
+        ERR_PRINT("HCIHandler::le_create_periodic_sync: invalid parameter: sid %u, skip %u, sync_timeout %u, listener %p",
+                  sid, skip, sync_timeout, listener.get());
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    // w/o holding mtx while waiting, allowing other commands to pass
+    const std::lock_guard<std::mutex> lockCreate(mtx_periodicAdvCreate); // RAII-style acquire and relinquish via destructor
+    if( !listenPeriodicAdv ) {
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+        listenPeriodicAdv = true;
+        updateEventFilter();
+    }
+    if( !periodicAdvSyncs.beginCreate(sid, static_cast<uint8_t>(address_type), address, listener) ) {
+        return HCIStatusCode::COMMAND_DISALLOWED;
+    }
     HCIStatusCode status;
-    std::shared_ptr<HCIEvent> ev = processCommandComplete(req0, &ev_status, &status);
-
+    {
+        const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+        if( !comm.isOpen() ) {
+            ERR_PRINT("HCIHandler::le_create_periodic_sync: device not open");
+            periodicAdvSyncs.endCreate();
+            return HCIStatusCode::INTERNAL_FAILURE;
+        }
+        HCIStructCommand<hci_cp_le_pa_create_sync> req0(HCIOpcode::LE_PERIODIC_ADV_CREATE_SYNC);
+        hci_cp_le_pa_create_sync * cp = req0.getWStruct();
+        cp->options = 0; // use given advertiser, reporting enabled
+        cp->sid = sid;
+        cp->addr_type = static_cast<uint8_t>(address_type);
+        cp->addr = address;
+        cp->skip = cpu_to_le(skip);
+        cp->sync_timeout = cpu_to_le(sync_timeout);
+        cp->sync_cte_type = 0;
+        std::shared_ptr<HCIEvent> ev = processCommandStatus(req0, &status);
+    }
     if( HCIStatusCode::SUCCESS == status ) {
-        MgmtEvtDiscovering *e = new MgmtEvtDiscovering(dev_id, ScanType::LE, enable);
-        sendMgmtEvent(std::shared_ptr<MgmtEvent>(e));
+        status = periodicAdvSyncs.awaitCreate(timeoutMS, sync_handle);
+        if( HCIStatusCode::INTERNAL_TIMEOUT == status ) {
+            // cancelling completes the request with OPERATION_CANCELLED_BY_HOST, unless it raced with the establishment
+            {
+                const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+                HCICommand req1(HCIOpcode::LE_PERIODIC_ADV_CREATE_SYNC_CANCEL, 0);
+                HCIReplyView<hci_rp_status> ev_status;
+                processCommandComplete(req1, ev_status); // best effort, the sync establishment is awaited below
+            }
+            status = periodicAdvSyncs.awaitCreate(env.HCI_COMMAND_COMPLETE_REPLY_TIMEOUT, sync_handle);
+            if( HCIStatusCode::OPERATION_CANCELLED_BY_HOST == status ) {
+                status = HCIStatusCode::INTERNAL_TIMEOUT;
+            }
+        }
+    }
+    periodicAdvSyncs.endCreate();
+    DBG_PRINT("HCIHandler::le_create_periodic_sync: sid %u, %s: status %s, handle %s",
+            sid, address.toString().c_str(), getHCIStatusCodeString(status).c_str(), uint16HexString(sync_handle, true).c_str());
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_terminate_periodic_sync(const uint16_t sync_handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    periodicAdvSyncs.remove(sync_handle);
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_terminate_periodic_sync: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
     }
+    HCIStructCommand<hci_cp_le_pa_term_sync> req0(HCIOpcode::LE_PERIODIC_ADV_TERMINATE_SYNC);
+    req0.getWStruct()->handle = cpu_to_le(sync_handle);
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
     return status;
 }
 
@@ -684,7 +1844,7 @@ HCIStatusCode HCIHandler::disconnect(const bool ioErrorCause,
     }
     HCIConnectionRef conn;
     {
-        const std::lock_guard<std::recursive_mutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
+        const std::lock_guard<DBTRecursiveMutex> lock(mtx_connectionList); // RAII-style acquire and relinquish via destructor
         conn = findTrackerConnection(conn_handle);
         if( nullptr == conn ) {
             // disconnect called w/o being connected through this HCIHandler
@@ -728,15 +1888,489 @@ HCIStatusCode HCIHandler::disconnect(const bool ioErrorCause,
     return status;
 }
 
+HCIStatusCode HCIHandler::le_conn_update(const uint16_t conn_handle,
+                                         const uint16_t conn_interval_min, const uint16_t conn_interval_max,
+                                         const uint16_t conn_latency, const uint16_t supervision_timeout) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_conn_update: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( 0 == conn_handle || conn_interval_min < 0x0006 || conn_interval_min > conn_interval_max || conn_interval_max > 0x0C80 ) {
+        ERR_PRINT("HCIHandler::le_conn_update: invalid parameter: handle %s, interval[%u..%u]",
+                uint16HexString(conn_handle).c_str(), conn_interval_min, conn_interval_max);
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCIStructCommand<hci_cp_le_conn_update> req0(HCIOpcode::LE_CONN_UPDATE);
+    hci_cp_le_conn_update * cp = req0.getWStruct();
+    cp->handle = cpu_to_le(conn_handle);
+    cp->conn_interval_min = cpu_to_le(conn_interval_min);
+    cp->conn_interval_max = cpu_to_le(conn_interval_max);
+    cp->conn_latency = cpu_to_le(conn_latency);
+    cp->supervision_timeout = cpu_to_le(supervision_timeout);
+    cp->min_ce_len = cpu_to_le((uint16_t)0x0000);
+    cp->max_ce_len = cpu_to_le((uint16_t)0x0000);
+
+    HCIStatusCode status;
+    std::shared_ptr<HCIEvent> ev = processCommandStatus(req0, &status);
+    return status;
+}
+
+std::vector<HCIStatusCode> HCIHandler::le_conn_update(const std::vector<uint16_t> & conn_handles,
+                                                      const uint16_t conn_interval_min, const uint16_t conn_interval_max,
+                                                      const uint16_t conn_latency, const uint16_t supervision_timeout,
+                                                      const int32_t timeoutMS) {
+    if( conn_interval_min < 0x0006 || conn_interval_min > conn_interval_max || conn_interval_max > 0x0C80 ) {
+        ERR_PRINT("HCIHandler::le_conn_update: invalid parameter: %zu handles, interval[%u..%u]",
+                conn_handles.size(), conn_interval_min, conn_interval_max);
+        return std::vector<HCIStatusCode>(conn_handles.size(), HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS);
+    }
+    std::vector<HCIStatusCode> res(conn_handles.size(), HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS);
+    std::vector<std::shared_ptr<HCICommand>> reqs;
+    std::vector<size_t> reqIdx;
+    for(size_t i=0; i<conn_handles.size(); i++) {
+        const uint16_t conn_handle = conn_handles[i];
+        if( 0 == conn_handle ) {
+            continue;
+        }
+        std::shared_ptr<HCIStructCommand<hci_cp_le_conn_update>> req0 =
+                std::make_shared<HCIStructCommand<hci_cp_le_conn_update>>(HCIOpcode::LE_CONN_UPDATE);
+        hci_cp_le_conn_update * cp = req0->getWStruct();
+        cp->handle = cpu_to_le(conn_handle);
+        cp->conn_interval_min = cpu_to_le(conn_interval_min);
+        cp->conn_interval_max = cpu_to_le(conn_interval_max);
+        cp->conn_latency = cpu_to_le(conn_latency);
+        cp->supervision_timeout = cpu_to_le(supervision_timeout);
+        cp->min_ce_len = cpu_to_le((uint16_t)0x0000);
+        cp->max_ce_len = cpu_to_le((uint16_t)0x0000);
+        reqs.push_back(req0);
+        reqIdx.push_back(i);
+    }
+    const int32_t timeout = 0 <= timeoutMS ? timeoutMS : env.HCI_COMMAND_STATUS_REPLY_TIMEOUT.load();
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const std::vector<HCIStatusCode> res0 = processCommandsPipelined(reqs, false /* expectComplete */, timeout, "le_conn_update");
+    for(size_t i=0; i<res0.size(); i++) {
+        res[reqIdx[i]] = res0[i];
+    }
+    return res;
+}
+
+/** Maps the given BDAddressType to the HCI white list address type, returns false if not an LE address type. */
+static bool getWhiteListAddressType(const BDAddressType address_type, uint8_t & res) {
+    switch( address_type ) {
+        case BDAddressType::BDADDR_LE_PUBLIC: res = static_cast<uint8_t>(HCILEPeerAddressType::PUBLIC); return true;
+        case BDAddressType::BDADDR_LE_RANDOM: res = static_cast<uint8_t>(HCILEPeerAddressType::RANDOM); return true;
+        default: return false;
+    }
+}
+
+HCIStatusCode HCIHandler::le_clear_white_list() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_clear_white_list: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCICommand req0(HCIOpcode::LE_CLEAR_WHITE_LIST, 0);
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_add_to_white_list(const EUI48 & address, const BDAddressType address_type) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_add_to_white_list: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    uint8_t hci_addr_type;
+    if( !getWhiteListAddressType(address_type, hci_addr_type) ) {
+        ERR_PRINT("HCIHandler::le_add_to_white_list: Not an LE address type %s: %s",
+                getBDAddressTypeString(address_type).c_str(), address.toString().c_str());
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCIStructCommand<hci_cp_le_add_to_white_list> req0(HCIOpcode::LE_ADD_TO_WHITE_LIST);
+    hci_cp_le_add_to_white_list * cp = req0.getWStruct();
+    cp->bdaddr_type = hci_addr_type;
+    cp->bdaddr = address;
+
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_del_from_white_list(const EUI48 & address, const BDAddressType address_type) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_del_from_white_list: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    uint8_t hci_addr_type;
+    if( !getWhiteListAddressType(address_type, hci_addr_type) ) {
+        ERR_PRINT("HCIHandler::le_del_from_white_list: Not an LE address type %s: %s",
+                getBDAddressTypeString(address_type).c_str(), address.toString().c_str());
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCIStructCommand<hci_cp_le_del_from_white_list> req0(HCIOpcode::LE_DEL_FROM_WHITE_LIST);
+    hci_cp_le_del_from_white_list * cp = req0.getWStruct();
+    cp->bdaddr_type = hci_addr_type;
+    cp->bdaddr = address;
+
+    HCIReplyView<hci_rp_status> ev_status;
+    HCIStatusCode status = processCommandComplete(req0, ev_status);
+    return status;
+}
+
+template<typename hci_cp_white_list>
+static std::vector<HCIStatusCode> whiteListCommands(const std::vector<BDAddressKey> & devices, const HCIOpcode opc,
+                                                    std::vector<std::shared_ptr<HCICommand>> & reqs, std::vector<size_t> & reqIdx)
+{
+    std::vector<HCIStatusCode> res(devices.size(), HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS);
+    for(size_t i=0; i<devices.size(); i++) {
+        uint8_t hci_addr_type;
+        if( !getWhiteListAddressType(devices[i].addressType, hci_addr_type) ) {
+            ERR_PRINT("HCIHandler::%s: Not an LE address type %s: %s", getHCIOpcodeString(opc).c_str(),
+                    getBDAddressTypeString(devices[i].addressType).c_str(), devices[i].address.toString().c_str());
+            continue;
+        }
+        std::shared_ptr<HCIStructCommand<hci_cp_white_list>> req0 = std::make_shared<HCIStructCommand<hci_cp_white_list>>(opc);
+        hci_cp_white_list * cp = req0->getWStruct();
+        cp->bdaddr_type = hci_addr_type;
+        cp->bdaddr = devices[i].address;
+        reqs.push_back(req0);
+        reqIdx.push_back(i);
+    }
+    return res;
+}
+
+std::vector<HCIStatusCode> HCIHandler::le_add_to_white_list(const std::vector<BDAddressKey> & devices, const int32_t timeoutMS) {
+    std::vector<std::shared_ptr<HCICommand>> reqs;
+    std::vector<size_t> reqIdx;
+    std::vector<HCIStatusCode> res = whiteListCommands<hci_cp_le_add_to_white_list>(devices, HCIOpcode::LE_ADD_TO_WHITE_LIST, reqs, reqIdx);
+    const int32_t timeout = 0 <= timeoutMS ? timeoutMS : env.HCI_COMMAND_COMPLETE_REPLY_TIMEOUT.load();
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const std::vector<HCIStatusCode> res0 = processCommandsPipelined(reqs, true /* expectComplete */, timeout, "le_add_to_white_list");
+    for(size_t i=0; i<res0.size(); i++) {
+        res[reqIdx[i]] = res0[i];
+    }
+    return res;
+}
+
+std::vector<HCIStatusCode> HCIHandler::le_del_from_white_list(const std::vector<BDAddressKey> & devices, const int32_t timeoutMS) {
+    std::vector<std::shared_ptr<HCICommand>> reqs;
+    std::vector<size_t> reqIdx;
+    std::vector<HCIStatusCode> res = whiteListCommands<hci_cp_le_del_from_white_list>(devices, HCIOpcode::LE_DEL_FROM_WHITE_LIST, reqs, reqIdx);
+    const int32_t timeout = 0 <= timeoutMS ? timeoutMS : env.HCI_COMMAND_COMPLETE_REPLY_TIMEOUT.load();
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const std::vector<HCIStatusCode> res0 = processCommandsPipelined(reqs, true /* expectComplete */, timeout, "le_del_from_white_list");
+    for(size_t i=0; i<res0.size(); i++) {
+        res[reqIdx[i]] = res0[i];
+    }
+    return res;
+}
+
+HCIStatusCode HCIHandler::le_set_data_length(const uint16_t conn_handle, const uint16_t tx_octets, const uint16_t tx_time) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_set_data_length: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( !leDataLenExtSupported ) {
+        DBG_PRINT("HCIHandler::le_set_data_length: LE Data Packet Length Extension not supported");
+        return HCIStatusCode::UNSUPPORTED_FEATURE_OR_PARAM_VALUE;
+    }
+    if( 0 == conn_handle || tx_octets < 27 || tx_octets > 251 || tx_time < 328 || tx_time > 17040 ) {
+        ERR_PRINT("HCIHandler::le_set_data_length: invalid parameter: handle %s, tx[octets %u, time %u]",
+                uint16HexString(conn_handle).c_str(), tx_octets, tx_time);
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    HCIStructCommand<hci_cp_le_set_data_len> req0(HCIOpcode::LE_SET_DATA_LEN);
+    hci_cp_le_set_data_len * cp = req0.getWStruct();
+    cp->handle = cpu_to_le(conn_handle);
+    cp->tx_len = cpu_to_le(tx_octets);
+    cp->tx_time = cpu_to_le(tx_time);
+
+    HCIReplyView<hci_rp_le_set_data_len> ev_res;
+    HCIStatusCode status = processCommandComplete(req0, ev_res);
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_read_phy(const uint16_t conn_handle, uint8_t & tx_phy, uint8_t & rx_phy) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    tx_phy = 0;
+    rx_phy = 0;
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_read_phy: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCIStructCommand<hci_cp_le_read_phy> req0(HCIOpcode::LE_READ_PHY);
+    hci_cp_le_read_phy * cp = req0.getWStruct();
+    cp->handle = cpu_to_le(conn_handle);
+
+    HCIReplyView<hci_rp_le_read_phy> ev_phy;
+    HCIStatusCode status = processCommandComplete(req0, ev_phy);
+    if( ev_phy.isValid() && HCIStatusCode::SUCCESS == status ) {
+        tx_phy = ev_phy->tx_phy;
+        rx_phy = ev_phy->rx_phy;
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::le_set_phy(const uint16_t conn_handle, const uint8_t tx_phys, const uint8_t rx_phys) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::le_set_phy: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    const uint8_t valid_phys = HCI_LE_SET_PHY_1M | HCI_LE_SET_PHY_2M | HCI_LE_SET_PHY_CODED;
+    if( 0 == conn_handle || 0 == tx_phys || 0 == rx_phys || 0 != ( ( tx_phys | rx_phys ) & ~valid_phys ) ) {
+        ERR_PRINT("HCIHandler::le_set_phy: invalid parameter: handle %s, phys[tx 0x%x, rx 0x%x]",
+                uint16HexString(conn_handle).c_str(), tx_phys, rx_phys);
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    if( ( 0 != ( ( tx_phys | rx_phys ) & HCI_LE_SET_PHY_2M ) && !le2MPHYSupported ) ||
+        ( 0 != ( ( tx_phys | rx_phys ) & HCI_LE_SET_PHY_CODED ) && !leCodedPHYSupported ) ) {
+        DBG_PRINT("HCIHandler::le_set_phy: PHYs not supported: tx 0x%x, rx 0x%x", tx_phys, rx_phys);
+        return HCIStatusCode::UNSUPPORTED_FEATURE_OR_PARAM_VALUE;
+    }
+    HCIStructCommand<hci_cp_le_set_phy> req0(HCIOpcode::LE_SET_PHY);
+    hci_cp_le_set_phy * cp = req0.getWStruct();
+    cp->handle = cpu_to_le(conn_handle);
+    cp->all_phys = 0x00; // both tx_phys and rx_phys given
+    cp->tx_phys = tx_phys;
+    cp->rx_phys = rx_phys;
+    cp->phy_opts = cpu_to_le((uint16_t)0x0000); // no preferred coding
+
+    HCIStatusCode status;
+    std::shared_ptr<HCIEvent> ev = processCommandStatus(req0, &status);
+    return status;
+}
+
+HCIStatusCode HCIHandler::read_rssi(const uint16_t conn_handle, int8_t & rssi) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    rssi = 127;
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::read_rssi: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCIStructCommand<hci_cp_read_rssi> req0(HCIOpcode::READ_RSSI);
+    hci_cp_read_rssi * cp = req0.getWStruct();
+    cp->handle = cpu_to_le(conn_handle);
+
+    HCIReplyView<hci_rp_read_rssi> ev_rssi;
+    HCIStatusCode status = processCommandComplete(req0, ev_rssi);
+    if( ev_rssi.isValid() && HCIStatusCode::SUCCESS == status ) {
+        rssi = ev_rssi->rssi;
+    }
+    return status;
+}
+
+HCIStatusCode HCIHandler::read_tx_power_level(const uint16_t conn_handle, const bool maxLevel, int8_t & tx_power) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    tx_power = 127;
+    if( !comm.isOpen() ) {
+        ERR_PRINT("HCIHandler::read_tx_power_level: device not open");
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    HCIStructCommand<hci_cp_read_tx_power> req0(HCIOpcode::READ_TX_POWER);
+    hci_cp_read_tx_power * cp = req0.getWStruct();
+    cp->handle = cpu_to_le(conn_handle);
+    cp->type = maxLevel ? 0x01 : 0x00;
+
+    HCIReplyView<hci_rp_read_tx_power> ev_tx;
+    HCIStatusCode status = processCommandComplete(req0, ev_tx);
+    if( ev_tx.isValid() && HCIStatusCode::SUCCESS == status ) {
+        tx_power = ev_tx->tx_power;
+    }
+    return status;
+}
+
+/** Shared state of one read_link_quality_all() call, outliving a timed out caller. */
+struct HCILinkQualityPoll {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<HCILinkQuality> res;
+    /** Number of outstanding replies */
+    int pending = 0;
+};
+
+static HCILinkQuality * findLinkQuality(std::vector<HCILinkQuality> & res, const uint16_t handle) {
+    for(size_t i=0; i<res.size(); i++) {
+        if( res[i].handle == handle ) {
+            return &res[i];
+        }
+    }
+    return nullptr;
+}
+
+static bool linkQualityReply(std::shared_ptr<HCILinkQualityPoll> & poll, std::shared_ptr<HCIEvent> event) {
+    std::unique_lock<std::mutex> lock(poll->mtx); // RAII-style acquire and relinquish via destructor
+    // A CMD_STATUS reply or timeout carries no handle, leaving its entry at INTERNAL_TIMEOUT
+    if( nullptr != event && event->isEvent(HCIEventType::CMD_COMPLETE) ) {
+        const HCICommandCompleteEvent * ev_cc = static_cast<const HCICommandCompleteEvent*>(event.get());
+        if( HCIOpcode::READ_RSSI == ev_cc->getOpcode() && ev_cc->getReturnParamSize() >= sizeof(hci_rp_read_rssi) ) {
+            const hci_rp_read_rssi * rp = reinterpret_cast<const hci_rp_read_rssi *>(ev_cc->getReturnParam());
+            HCILinkQuality * lq = findLinkQuality(poll->res, le_to_cpu(rp->handle));
+            if( nullptr != lq ) {
+                lq->rssiStatus = static_cast<HCIStatusCode>(rp->status);
+                lq->rssi = HCIStatusCode::SUCCESS == lq->rssiStatus ? rp->rssi : 127;
+            }
+        } else if( HCIOpcode::READ_TX_POWER == ev_cc->getOpcode() && ev_cc->getReturnParamSize() >= sizeof(hci_rp_read_tx_power) ) {
+            const hci_rp_read_tx_power * rp = reinterpret_cast<const hci_rp_read_tx_power *>(ev_cc->getReturnParam());
+            HCILinkQuality * lq = findLinkQuality(poll->res, le_to_cpu(rp->handle));
+            if( nullptr != lq ) {
+                lq->txPowerStatus = static_cast<HCIStatusCode>(rp->status);
+                lq->txPower = HCIStatusCode::SUCCESS == lq->txPowerStatus ? rp->tx_power : 127;
+            }
+        }
+    }
+    if( 0 == --poll->pending ) {
+        poll->cv.notify_all();
+    }
+    return true;
+}
+
+std::vector<HCILinkQuality> HCIHandler::read_link_quality_all(const bool readTxPower, const int32_t timeoutMS) {
+    const int32_t timeout = 0 <= timeoutMS ? timeoutMS : env.HCI_COMMAND_COMPLETE_REPLY_TIMEOUT.load();
+    std::shared_ptr<HCILinkQualityPoll> poll = std::make_shared<HCILinkQualityPoll>();
+    {
+        const std::shared_ptr<const TrackerAddressIndex> index = std::atomic_load(&connectionAddressIndex);
+        poll->res.reserve(index->size());
+        for(auto it = index->begin(); it != index->end(); ++it) {
+            const HCIConnectionRef & conn = it->second;
+            if( 0 != conn->getHandle() ) {
+                poll->res.push_back( HCILinkQuality(conn->getAddress(), conn->getAddressType(), conn->getHandle()) );
+            }
+        }
+    }
+    const int count = static_cast<int>( poll->res.size() );
+    const HCICommandReplyCallback cb = bindCaptureFunc(poll, linkQualityReply);
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for(int i=0; i<count; i++) {
+        // Immutable after population, hence read w/o lock
+        const uint16_t handle = poll->res[i].handle;
+        {
+            std::unique_lock<std::mutex> lock(poll->mtx); // RAII-style acquire and relinquish via destructor
+            poll->pending++;
+        }
+        HCIStructCommand<hci_cp_read_rssi> req0(HCIOpcode::READ_RSSI);
+        req0.getWStruct()->handle = cpu_to_le(handle);
+        if( !sendCommandAsync(req0, true /* expectComplete */, cb, timeout) ) {
+            std::unique_lock<std::mutex> lock(poll->mtx); // RAII-style acquire and relinquish via destructor
+            poll->pending--;
+            break;
+        }
+        if( readTxPower ) {
+            {
+                std::unique_lock<std::mutex> lock(poll->mtx); // RAII-style acquire and relinquish via destructor
+                poll->pending++;
+            }
+            HCIStructCommand<hci_cp_read_tx_power> req1(HCIOpcode::READ_TX_POWER);
+            req1.getWStruct()->handle = cpu_to_le(handle);
+            req1.getWStruct()->type = 0x00; // current level
+            if( !sendCommandAsync(req1, true /* expectComplete */, cb, timeout) ) {
+                std::unique_lock<std::mutex> lock(poll->mtx); // RAII-style acquire and relinquish via destructor
+                poll->pending--;
+                break;
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(poll->mtx); // RAII-style acquire and relinquish via destructor
+    while( 0 < poll->pending ) {
+        if( std::cv_status::timeout == poll->cv.wait_until(lock, t0 + std::chrono::milliseconds(timeout)) ) {
+            WARN_PRINT("HCIHandler::read_link_quality_all: Timeout (%d ms): %d connections, %d replies pending",
+                    timeout, count, poll->pending);
+            break;
+        }
+    }
+    DBG_PRINT("HCIHandler::read_link_quality_all: %d connections in %" PRIu64 " ms", count,
+            static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count() ));
+    return poll->res;
+}
+
+/** Shared state of one processCommandsPipelined() call, outliving a timed out caller. */
+struct HCICommandBatch {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<HCIStatusCode> res;
+    /** Number of outstanding replies */
+    int pending = 0;
+};
+
+/** One command of a HCICommandBatch, unique per command for the HCICommandReplyCallback identity. */
+struct HCICommandBatchEntry {
+    std::shared_ptr<HCICommandBatch> batch;
+    size_t idx;
+
+    HCICommandBatchEntry(const std::shared_ptr<HCICommandBatch> & batch_, const size_t idx_)
+    : batch(batch_), idx(idx_) {}
+
+    bool operator==(const HCICommandBatchEntry& rhs) const
+    { return batch == rhs.batch && idx == rhs.idx; }
+};
+
+static bool commandBatchReply(HCICommandBatchEntry & e, std::shared_ptr<HCIEvent> event) {
+    HCIStatusCode status = HCIStatusCode::INTERNAL_TIMEOUT;
+    if( nullptr != event ) {
+        if( event->isEvent(HCIEventType::CMD_COMPLETE) ) {
+            const HCICommandCompleteEvent * ev_cc = static_cast<const HCICommandCompleteEvent*>(event.get());
+            status = 0 < ev_cc->getReturnParamSize() ? static_cast<HCIStatusCode>(ev_cc->getReturnParam()[0]) : HCIStatusCode::UNSPECIFIED_ERROR;
+        } else {
+            status = static_cast<const HCICommandStatusEvent*>(event.get())->getStatus();
+        }
+    }
+    std::unique_lock<std::mutex> lock(e.batch->mtx); // RAII-style acquire and relinquish via destructor
+    e.batch->res[e.idx] = status;
+    if( 0 == --e.batch->pending ) {
+        e.batch->cv.notify_all();
+    }
+    return true;
+}
+
+std::vector<HCIStatusCode> HCIHandler::processCommandsPipelined(std::vector<std::shared_ptr<HCICommand>> & reqs,
+                                                                const bool expectComplete, const int32_t timeoutMS, const char * caller)
+{
+    std::shared_ptr<HCICommandBatch> batch = std::make_shared<HCICommandBatch>();
+    batch->res.resize(reqs.size(), HCIStatusCode::INTERNAL_TIMEOUT);
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    size_t sent = 0;
+    for(; sent<reqs.size(); sent++) {
+        {
+            std::unique_lock<std::mutex> lock(batch->mtx); // RAII-style acquire and relinquish via destructor
+            batch->pending++;
+        }
+        const HCICommandReplyCallback cb = bindCaptureFunc(HCICommandBatchEntry(batch, sent), commandBatchReply);
+        if( !sendCommandAsync(*reqs[sent], expectComplete, cb, timeoutMS) ) {
+            std::unique_lock<std::mutex> lock(batch->mtx); // RAII-style acquire and relinquish via destructor
+            batch->pending--;
+            break;
+        }
+    }
+    std::unique_lock<std::mutex> lock(batch->mtx); // RAII-style acquire and relinquish via destructor
+    for(size_t i=sent; i<reqs.size(); i++) {
+        batch->res[i] = HCIStatusCode::INTERNAL_FAILURE;
+    }
+    while( 0 < batch->pending ) {
+        if( std::cv_status::timeout == batch->cv.wait_until(lock, t0 + std::chrono::milliseconds(timeoutMS)) ) {
+            WARN_PRINT("HCIHandler::%s: Timeout (%d ms): %zu commands, %d replies pending",
+                    caller, timeoutMS, reqs.size(), batch->pending);
+            break;
+        }
+    }
+    DBG_PRINT("HCIHandler::%s: %zu of %zu commands in %" PRIu64 " ms", caller, sent, reqs.size(),
+            static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count() ));
+    return batch->res;
+}
+
 std::shared_ptr<HCIEvent> HCIHandler::processCommandStatus(HCICommand &req, HCIStatusCode *status)
 {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_sendReply); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_sendReply); // RAII-style acquire and relinquish via destructor
 
     *status = HCIStatusCode::INTERNAL_FAILURE;
 
     int32_t retryCount = 0;
     std::shared_ptr<HCIEvent> ev = nullptr;
 
+    discardStaleReplies();
     if( !sendCommand(req) ) {
         goto exit;
     }
@@ -774,44 +2408,34 @@ exit:
 }
 
 template<typename hci_cmd_event_struct>
-std::shared_ptr<HCIEvent> HCIHandler::processCommandComplete(HCICommand &req,
-                                                             const hci_cmd_event_struct **res, HCIStatusCode *status)
+HCIStatusCode HCIHandler::processCommandComplete(HCICommand &req, HCIReplyView<hci_cmd_event_struct> & res)
 {
-    *res = nullptr;
-    *status = HCIStatusCode::INTERNAL_FAILURE;
+    res.clear();
 
     const HCIEventType evc = HCIEventType::CMD_COMPLETE;
     HCICommandCompleteEvent * ev_cc;
     std::shared_ptr<HCIEvent> ev = sendWithCmdCompleteReply(req, &ev_cc);
     if( nullptr == ev ) {
-        *status = HCIStatusCode::INTERNAL_TIMEOUT;
+        const HCIStatusCode status = HCIStatusCode::INTERNAL_TIMEOUT;
         WARN_PRINT("HCIHandler::processCommandComplete %s -> %s: Status 0x%2.2X (%s), errno %d %s: res nullptr, req %s",
                 getHCIOpcodeString(req.getOpcode()).c_str(), getHCIEventTypeString(evc).c_str(),
-                number(*status), getHCIStatusCodeString(*status).c_str(), errno, strerror(errno),
+                number(status), getHCIStatusCodeString(status).c_str(), errno, strerror(errno),
                 req.toString().c_str());
-        return nullptr; // timeout
-    } else if( nullptr == ev_cc ) {
+        return status; // timeout
+    } else if( nullptr == ev_cc || !res.set(*ev_cc) ) {
+        const HCIStatusCode status = HCIStatusCode::INTERNAL_FAILURE;
         WARN_PRINT("HCIHandler::processCommandComplete %s -> %s: Status 0x%2.2X (%s), errno %d %s: res %s, req %s",
                 getHCIOpcodeString(req.getOpcode()).c_str(), getHCIEventTypeString(evc).c_str(),
-                number(*status), getHCIStatusCodeString(*status).c_str(), errno, strerror(errno),
+                number(status), getHCIStatusCodeString(status).c_str(), errno, strerror(errno),
                 ev->toString().c_str(), req.toString().c_str());
-        return ev;
-    }
-    const uint8_t returnParamSize = ev_cc->getReturnParamSize();
-    if( returnParamSize < sizeof(hci_cmd_event_struct) ) {
-        WARN_PRINT("HCIHandler::processCommandComplete %s -> %s: Status 0x%2.2X (%s), errno %d %s: res %s, req %s",
-                getHCIOpcodeString(req.getOpcode()).c_str(), getHCIEventTypeString(evc).c_str(),
-                number(*status), getHCIStatusCodeString(*status).c_str(), errno, strerror(errno),
-                ev_cc->toString().c_str(), req.toString().c_str());
-        return ev;
+        return status;
     }
-    *res = (const hci_cmd_event_struct*)(ev_cc->getReturnParam());
-    *status = static_cast<HCIStatusCode>((*res)->status);
+    const HCIStatusCode status = res.getStatus();
     DBG_PRINT("HCIHandler::processCommandComplete %s -> %s: Status 0x%2.2X (%s): res %s, req %s",
             getHCIOpcodeString(req.getOpcode()).c_str(), getHCIEventTypeString(evc).c_str(),
-            number(*status), getHCIStatusCodeString(*status).c_str(),
+            number(status), getHCIStatusCodeString(status).c_str(),
             ev_cc->toString().c_str(), req.toString().c_str());
-    return ev;
+    return status; // the event returns to hciEventPool here, the reply has been copied
 }
 
 template<typename hci_cmd_event_struct>
@@ -861,40 +2485,131 @@ const hci_cmd_event_struct* HCIHandler::getMetaReplyStruct(std::shared_ptr<HCIEv
  */
 
 void HCIHandler::addMgmtEventCallback(const MgmtEvent::Opcode opc, const MgmtEventCallback &cb) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     checkMgmtEventCallbackListsIndex(opc);
     MgmtEventCallbackList &l = mgmtEventCallbackLists[static_cast<uint16_t>(opc)];
-    for (auto it = l.begin(); it != l.end(); ++it) {
-        if ( *it == cb ) {
-            // already exists for given adapter
-            return;
-        }
+    if( !l.push_back_unique(cb, [](const MgmtEventCallback &a, const MgmtEventCallback &b) { return a == b; }) ) {
+        // already exists for given adapter
+        return;
     }
-    l.push_back( cb );
+    updateEventFilter();
 }
 int HCIHandler::removeMgmtEventCallback(const MgmtEvent::Opcode opc, const MgmtEventCallback &cb) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     checkMgmtEventCallbackListsIndex(opc);
-    int count = 0;
     MgmtEventCallbackList &l = mgmtEventCallbackLists[static_cast<uint16_t>(opc)];
-    for (auto it = l.begin(); it != l.end(); ) {
-        if ( *it == cb ) {
-            it = l.erase(it);
-            count++;
-        } else {
-            ++it;
-        }
+    const int count = l.erase_matching(true /* all */, [&cb](const MgmtEventCallback &it) { return it == cb; });
+    if( 0 < count ) {
+        updateEventFilter();
     }
     return count;
 }
 void HCIHandler::clearMgmtEventCallbacks(const MgmtEvent::Opcode opc) {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     checkMgmtEventCallbackListsIndex(opc);
     mgmtEventCallbackLists[static_cast<uint16_t>(opc)].clear();
+    updateEventFilter();
 }
 void HCIHandler::clearAllMgmtEventCallbacks() {
-    const std::lock_guard<std::recursive_mutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
     for(size_t i=0; i<mgmtEventCallbackLists.size(); i++) {
         mgmtEventCallbackLists[i].clear();
     }
+    updateEventFilter();
+}
+
+/***
+ *
+ * AdvertisingReportBatchCallback section
+ *
+ */
+
+void HCIHandler::addAdvertisingReportBatchCallback(const AdvertisingReportBatchCallback &cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    if( !advReportBatchCallbackList.push_back_unique(cb,
+            [](const AdvertisingReportBatchCallback &a, const AdvertisingReportBatchCallback &b) { return a == b; }) ) {
+        // already exists
+        return;
+    }
+    updateEventFilter();
+}
+int HCIHandler::removeAdvertisingReportBatchCallback(const AdvertisingReportBatchCallback &cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const int count = advReportBatchCallbackList.erase_matching(true /* all */,
+            [&cb](const AdvertisingReportBatchCallback &it) { return it == cb; });
+    if( 0 < count ) {
+        updateEventFilter();
+    }
+    return count;
+}
+void HCIHandler::clearAdvertisingReportBatchCallbacks() {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    advReportBatchCallbackList.clear();
+    updateEventFilter();
+}
+
+/**
+ * BeaconRecordCallback section
+ */
+
+void HCIHandler::addBeaconRecordCallback(const BeaconRecordCallback &cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    if( !beaconRecordCallbackList.push_back_unique(cb,
+            [](const BeaconRecordCallback &a, const BeaconRecordCallback &b) { return a == b; }) ) {
+        // already exists
+        return;
+    }
+    updateEventFilter();
+}
+int HCIHandler::removeBeaconRecordCallback(const BeaconRecordCallback &cb) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    const int count = beaconRecordCallbackList.erase_matching(true /* all */,
+            [&cb](const BeaconRecordCallback &it) { return it == cb; });
+    if( 0 < count ) {
+        updateEventFilter();
+    }
+    return count;
+}
+void HCIHandler::clearBeaconRecordCallbacks() {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    beaconRecordCallbackList.clear();
+    updateEventFilter();
+}
+
+/**
+ * L2CAPFrameCallback handling
+ */
+
+bool HCIHandler::setL2CAPFrameCallback(const uint16_t handle, const uint16_t cid, const int maxPayloadSize, const L2CAPFrameCallback &cb) {
+    if( !aclDemux ) {
+        return false;
+    }
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    aclChannels[handle] = std::shared_ptr<ACLChannel>(new ACLChannel(cid, cb, maxPayloadSize));
+    updateEventFilter();
+    return true;
+}
+
+bool HCIHandler::removeL2CAPFrameCallback(const uint16_t handle) {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    if( 0 == aclChannels.erase(handle) ) {
+        return false;
+    }
+    updateEventFilter();
+    return true;
+}
+
+bool HCIHandler::getTrafficSnapshot(const EUI48 & address, const BDAddressType addressType, TrafficSnapshot & res) {
+    HCIConnectionRef conn = findTrackerConnection(address, addressType);
+    if( nullptr == conn ) {
+        return false;
+    }
+    res = conn->getTrafficStats().getSnapshot();
+    return true;
+}
+
+void HCIHandler::clearL2CAPFrameCallbacks() {
+    const std::lock_guard<DBTRecursiveMutex> lock(mtx_callbackLists); // RAII-style acquire and relinquish via destructor
+    aclChannels.clear();
+    updateEventFilter();
 }
@@ -31,6 +31,7 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <atomic>
 
 // #define VERBOSE_ON 1
 #include <dbt_debug.hpp>
@@ -50,6 +51,8 @@ extern "C" {
 
 namespace direct_bt {
 
+constexpr int HCILESetExtAdvDataCmd::MAX_DATA_LEN;
+
 #define HCI_STATUS_CODE(X) \
         X(SUCCESS) \
         X(UNKNOWN_HCI_COMMAND) \
@@ -155,7 +158,9 @@ std::string getHCIOGFString(const HCIOGF op) {
     X(DISCONNECT) \
     X(SET_EVENT_MASK) \
     X(RESET) \
+    X(READ_TX_POWER) \
     X(READ_LOCAL_VERSION) \
+    X(READ_RSSI) \
     X(LE_SET_EVENT_MASK) \
     X(LE_READ_BUFFER_SIZE) \
     X(LE_READ_LOCAL_FEATURES) \
@@ -175,7 +180,27 @@ std::string getHCIOGFString(const HCIOGF op) {
     X(LE_DEL_FROM_WHITE_LIST) \
     X(LE_CONN_UPDATE) \
     X(LE_READ_REMOTE_FEATURES) \
-    X(LE_START_ENC)
+    X(LE_START_ENC) \
+    X(LE_SET_DATA_LEN) \
+    X(LE_READ_RESOLV_LIST_SIZE) \
+    X(LE_READ_MAX_DATA_LEN) \
+    X(LE_READ_PHY) \
+    X(LE_SET_DEFAULT_PHY) \
+    X(LE_SET_PHY) \
+    X(LE_SET_ADV_SET_RANDOM_ADDR) \
+    X(LE_SET_EXT_ADV_PARAMS) \
+    X(LE_SET_EXT_ADV_DATA) \
+    X(LE_SET_EXT_SCAN_RSP_DATA) \
+    X(LE_SET_EXT_ADV_ENABLE) \
+    X(LE_READ_MAX_ADV_DATA_LEN) \
+    X(LE_READ_NUM_SUPPORTED_ADV_SETS) \
+    X(LE_REMOVE_ADV_SET) \
+    X(LE_CLEAR_ADV_SETS) \
+    X(LE_SET_EXT_SCAN_PARAMS) \
+    X(LE_SET_EXT_SCAN_ENABLE) \
+    X(LE_PERIODIC_ADV_CREATE_SYNC) \
+    X(LE_PERIODIC_ADV_CREATE_SYNC_CANCEL) \
+    X(LE_PERIODIC_ADV_TERMINATE_SYNC)
 
 #define HCI_OPCODE_CASE_TO_STRING(V) case HCIOpcode::V: return #V;
 
@@ -297,4 +322,113 @@ HCIEvent* HCIEvent::getSpecialized(const uint8_t * buffer, int const buffer_size
     }
 }
 
+HCIEventPool::HCIEventPool(const int capacity_)
+: capacity(capacity_), allocCount(0), fallbackCount(0)
+{
+    for(int i=0; i<Kind::COUNT; i++) {
+        pool[i].reserve(capacity);
+        nextIdx[i] = 0;
+    }
+}
+
+template<typename T>
+std::shared_ptr<HCIEvent> HCIEventPool::acquire(const Kind kind, const uint8_t * buffer, int const buffer_size) {
+    std::vector<std::shared_ptr<HCIEvent>> & p = pool[kind];
+    const int size = p.size();
+    for(int j=0; j<size; j++) {
+        const int i = ( nextIdx[kind] + j ) % size;
+        std::shared_ptr<HCIEvent> & e = p[i];
+        if( 1 == e.use_count() ) {
+            // Only referenced by this pool: Synchronize with the last user's release before reuse.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            e->reset(buffer, buffer_size);
+            nextIdx[kind] = ( i + 1 ) % size;
+            return e;
+        }
+    }
+    std::shared_ptr<HCIEvent> e( new T(buffer, buffer_size) );
+    if( size < capacity ) {
+        p.push_back(e);
+        allocCount++;
+    } else {
+        fallbackCount++;
+    }
+    return e;
+}
+
+std::shared_ptr<HCIEvent> HCIEventPool::getSpecialized(const uint8_t * buffer, int const buffer_size) {
+    const HCIPacketType pc = static_cast<HCIPacketType>( get_uint8(buffer, 0) );
+    if( HCIPacketType::EVENT != pc ) {
+        return nullptr;
+    }
+    const HCIEventType ec = static_cast<HCIEventType>( get_uint8(buffer, 1) );
+
+    switch( ec ) {
+        case HCIEventType::DISCONN_COMPLETE:
+            return acquire<HCIDisconnectionCompleteEvent>(Kind::DISCONN_COMPLETE, buffer, buffer_size);
+        case HCIEventType::CMD_COMPLETE:
+            return acquire<HCICommandCompleteEvent>(Kind::CMD_COMPLETE, buffer, buffer_size);
+        case HCIEventType::CMD_STATUS:
+            return acquire<HCICommandStatusEvent>(Kind::CMD_STATUS, buffer, buffer_size);
+        case HCIEventType::LE_META:
+            return acquire<HCIMetaEvent>(Kind::LE_META, buffer, buffer_size);
+        default:
+            return acquire<HCIEvent>(Kind::GENERIC, buffer, buffer_size);
+    }
+}
+
+HCIAdvDedupCache::HCIAdvDedupCache(const int capacity, const int32_t windowMS_, const int rssiDelta_)
+: entries(capacity > 0 ? capacity : 0), windowMS(windowMS_), rssiDelta(rssiDelta_), dropCount(0), rssiUpdateCount(0)
+{
+    clear();
+}
+
+void HCIAdvDedupCache::clear() {
+    for(auto it = entries.begin(); it != entries.end(); ++it) {
+        it->valid = false;
+    }
+}
+
+HCIAdvDedupCache::Result HCIAdvDedupCache::check(const EUI48 & address, const uint8_t addressType, const uint8_t evtType,
+                                                 const uint8_t * ad_data, const int ad_data_len, const int8_t rssi, const uint64_t timestamp)
+{
+    if( 0 == entries.size() ) {
+        return Result::NEW;
+    }
+    // FNV-1a over the key and the payload
+    uint32_t h = 2166136261U;
+    for(int i=0; i<6; i++) {
+        h = ( h ^ address.b[i] ) * 16777619U;
+    }
+    h = ( h ^ addressType ) * 16777619U;
+    h = ( h ^ evtType ) * 16777619U;
+    const uint32_t keyHash = h;
+    for(int i=0; i<ad_data_len; i++) {
+        h = ( h ^ ad_data[i] ) * 16777619U;
+    }
+    const uint32_t adHash = h;
+
+    Entry & e = entries[keyHash % entries.size()];
+    if( e.valid && e.adHash == adHash && e.address == address && e.addressType == addressType && e.evtType == evtType &&
+        timestamp - e.timestamp < static_cast<uint64_t>(windowMS) )
+    {
+        const int d = static_cast<int>(rssi) - static_cast<int>(e.rssi);
+        if( ( d < 0 ? -d : d ) < rssiDelta ) {
+            dropCount++;
+            return Result::DUPLICATE;
+        }
+        e.rssi = rssi;
+        rssiUpdateCount++;
+        return Result::RSSI_UPDATE;
+    }
+    e.address = address;
+    e.addressType = addressType;
+    e.evtType = evtType;
+    e.valid = true;
+    e.rssi = rssi;
+    e.adHash = adHash;
+    e.timestamp = timestamp;
+    return Result::NEW;
+}
+
 } /* namespace direct_bt */
@@ -0,0 +1,368 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+
+// #define VERBOSE_ON 1
+#include <dbt_debug.hpp>
+
+#include "IOUring.hpp"
+#include "DBTEnv.hpp"
+
+extern "C" {
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    #include <linux/io_uring.h>
+}
+
+using namespace direct_bt;
+
+/** Provided buffer group of the receive buffers, one group per ring */
+static const uint16_t BUFFER_GROUP = 1;
+/** user_data of the multishot recvmsg request */
+static const uint64_t RECV_TAG = 1;
+/** user_data of the cancel request */
+static const uint64_t CANCEL_TAG = 2;
+
+static int sys_io_uring_setup(const unsigned entries, struct io_uring_params * p) {
+    return static_cast<int>( ::syscall(__NR_io_uring_setup, entries, p) );
+}
+
+static int sys_io_uring_enter(const int fd, const unsigned to_submit, const unsigned min_complete, const unsigned flags,
+                              const void * arg, const size_t argsz) {
+    return static_cast<int>( ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz) );
+}
+
+static int sys_io_uring_register(const int fd, const unsigned opcode, const void * arg, const unsigned nr_args) {
+    return static_cast<int>( ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args) );
+}
+
+static void * mapRing(const size_t size, const int fd, const off_t offset) {
+    void * p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return MAP_FAILED == p ? nullptr : p;
+}
+
+static void * mapAnonymous(const size_t size) {
+    void * p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return MAP_FAILED == p ? nullptr : p;
+}
+
+bool IOUringReceiver::isSupported() {
+    static const bool supported = [] {
+        int fds[2];
+        if( 0 > ::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) ) {
+            return false;
+        }
+        bool res = false;
+        {
+            std::unique_ptr<IOUringReceiver> r = create(fds[0], 16, 0);
+            const uint8_t probe = 0x01;
+            uint8_t buffer[16];
+            int len = 0;
+            if( nullptr != r && 1 == ::write(fds[1], &probe, 1) ) {
+                res = 1 == r->receive(buffer, sizeof(buffer), &len, 1, 100 /* timeoutMS */) && 1 == len && probe == buffer[0];
+            }
+            if( nullptr != r ) {
+                r->cancel();
+            }
+        }
+        ::close(fds[0]);
+        ::close(fds[1]);
+        DBG_PRINT("IOUringReceiver::isSupported: %d", res);
+        return res;
+    }();
+    return supported;
+}
+
+bool IOUringReceiver::isEnabled() {
+    static const bool enabled = DBTEnv::getBooleanProperty("direct_bt.io_uring", false) && isSupported();
+    return enabled;
+}
+
+std::unique_ptr<IOUringReceiver> IOUringReceiver::create(const int sockFD, const int payloadSize, const int controlSize) {
+    if( 0 > sockFD || 0 >= payloadSize || 0 > controlSize ) {
+        return nullptr;
+    }
+    std::unique_ptr<IOUringReceiver> r( new IOUringReceiver(sockFD, payloadSize, controlSize) );
+    if( !r->setup() ) {
+        DBG_PRINT("IOUringReceiver::create: fd %d: setup failed, errno %d %s", sockFD, errno, strerror(errno));
+        return nullptr;
+    }
+    return r;
+}
+
+IOUringReceiver::IOUringReceiver(const int sockFD_, const int payloadSize_, const int controlSize_)
+: sockFD(sockFD_), payloadSize(payloadSize_), controlSize(controlSize_),
+  slotSize(static_cast<int>(sizeof(struct io_uring_recvmsg_out)) + controlSize_ + payloadSize_), ringFD(-1),
+  sqRing(nullptr), sqRingSize(0), cqRing(nullptr), cqRingSize(0), sqes(nullptr), sqesSize(0),
+  sqTail(nullptr), sqMask(nullptr), sqArray(nullptr), cqHead(nullptr), cqTail(nullptr), cqMask(nullptr), cqes(nullptr),
+  bufRing(nullptr), bufRingSize(0), bufPool(nullptr), bufTail(0),
+  msgTemplate(new struct msghdr), armed(false), eof(false), cancelled(false)
+{
+    bzero(msgTemplate.get(), sizeof(struct msghdr));
+    msgTemplate->msg_controllen = controlSize;
+}
+
+IOUringReceiver::~IOUringReceiver() {
+    if( 0 <= ringFD ) {
+        ::close(ringFD); // cancels all pending requests
+    }
+    if( nullptr != sqes ) {
+        ::munmap(sqes, sqesSize);
+    }
+    if( nullptr != cqRing && cqRing != sqRing ) {
+        ::munmap(cqRing, cqRingSize);
+    }
+    if( nullptr != sqRing ) {
+        ::munmap(sqRing, sqRingSize);
+    }
+    if( nullptr != bufRing ) {
+        ::munmap(bufRing, bufRingSize);
+    }
+    if( nullptr != bufPool ) {
+        ::munmap(bufPool, static_cast<size_t>(slotSize) * BUFFER_COUNT);
+    }
+}
+
+bool IOUringReceiver::setup() {
+    struct io_uring_params p;
+    bzero(&p, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = 2 * BUFFER_COUNT; // all buffers in flight plus cancel and termination completions
+    ringFD = sys_io_uring_setup(4, &p);
+    if( 0 > ringFD ) {
+        return false;
+    }
+    sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if( 0 != ( p.features & IORING_FEAT_SINGLE_MMAP ) ) {
+        sqRingSize = std::max(sqRingSize, cqRingSize);
+        sqRing = mapRing(sqRingSize, ringFD, IORING_OFF_SQ_RING);
+        cqRing = sqRing;
+    } else {
+        sqRing = mapRing(sqRingSize, ringFD, IORING_OFF_SQ_RING);
+        cqRing = mapRing(cqRingSize, ringFD, IORING_OFF_CQ_RING);
+    }
+    sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = static_cast<struct io_uring_sqe *>( mapRing(sqesSize, ringFD, IORING_OFF_SQES) );
+    if( nullptr == sqRing || nullptr == cqRing || nullptr == sqes ) {
+        return false;
+    }
+    uint8_t * sq = static_cast<uint8_t *>(sqRing);
+    uint8_t * cq = static_cast<uint8_t *>(cqRing);
+    sqTail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+    cqHead = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe *>(cq + p.cq_off.cqes);
+
+    // Provided buffer ring, page aligned
+    bufRingSize = BUFFER_COUNT * sizeof(struct io_uring_buf);
+    bufRing = static_cast<struct io_uring_buf_ring *>( mapAnonymous(bufRingSize) );
+    bufPool = static_cast<uint8_t *>( mapAnonymous(static_cast<size_t>(slotSize) * BUFFER_COUNT) );
+    if( nullptr == bufRing || nullptr == bufPool ) {
+        return false;
+    }
+    struct io_uring_buf_reg reg;
+    bzero(&reg, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufRing);
+    reg.ring_entries = BUFFER_COUNT;
+    reg.bgid = BUFFER_GROUP;
+    if( 0 > sys_io_uring_register(ringFD, IORING_REGISTER_PBUF_RING, &reg, 1) ) {
+        return false;
+    }
+    for(uint16_t bid = 0; bid < BUFFER_COUNT; bid++) {
+        recycle(bid);
+    }
+    const std::lock_guard<std::mutex> lock(mtx_submit); // RAII-style acquire and relinquish via destructor
+    armed = submit(IORING_OP_RECVMSG, RECV_TAG);
+    return armed;
+}
+
+bool IOUringReceiver::submit(const uint8_t opcode, const uint64_t userData) {
+    const unsigned tail = *sqTail; // only written by us, under mtx_submit
+    const unsigned idx = tail & *sqMask;
+    struct io_uring_sqe * sqe = &sqes[idx];
+    bzero(sqe, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->user_data = userData;
+    if( IORING_OP_RECVMSG == opcode ) {
+        sqe->fd = sockFD;
+        sqe->addr = reinterpret_cast<uint64_t>(msgTemplate.get());
+        sqe->len = 1;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+    } else { // IORING_OP_ASYNC_CANCEL
+        sqe->fd = -1;
+        sqe->addr = RECV_TAG;
+    }
+    sqArray[idx] = idx;
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    int res;
+    while( ( res = sys_io_uring_enter(ringFD, 1, 0, 0, nullptr, 0) ) < 0 && EINTR == errno ) {
+        // cont interruption
+    }
+    return 0 <= res;
+}
+
+void IOUringReceiver::recycle(const uint16_t bid) {
+    // Not using io_uring_buf_ring::bufs, its __DECLARE_FLEX_ARRAY is misplaced in C++ by the empty struct
+    struct io_uring_buf * buf = reinterpret_cast<struct io_uring_buf *>(bufRing) + ( bufTail & ( BUFFER_COUNT - 1 ) );
+    buf->addr = reinterpret_cast<uint64_t>(bufPool + static_cast<size_t>(slotSize) * bid);
+    buf->len = slotSize;
+    buf->bid = bid;
+    bufTail++;
+    __atomic_store_n(&bufRing->tail, bufTail, __ATOMIC_RELEASE);
+}
+
+int IOUringReceiver::receive(uint8_t* buffers, const int buffer_capacity, int* lengths, const int count, const int32_t timeoutMS,
+                             uint8_t* controls, int* controlLengths) {
+    if( 0 > buffer_capacity || 0 > count ) {
+        errno = EINVAL;
+        return -1;
+    }
+    if( 0 == count ) {
+        return 0;
+    }
+    bool waited = false;
+    for(;;) {
+        int n = 0;
+        int err = 0;
+        unsigned head = *cqHead; // only written by us
+        const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while( head != tail && n < count ) {
+            const struct io_uring_cqe * cqe = &cqes[head & *cqMask];
+            head++;
+            if( RECV_TAG != cqe->user_data ) {
+                continue; // cancel completion
+            }
+            const bool more = 0 != ( cqe->flags & IORING_CQE_F_MORE );
+            if( !more ) {
+                armed = false;
+            }
+            if( 0 > cqe->res ) {
+                if( -ENOBUFS != cqe->res && -ECANCELED != cqe->res ) { // ENOBUFS: all buffers pending, re-armed below
+                    err = -cqe->res;
+                }
+                continue;
+            }
+            if( 0 == ( cqe->flags & IORING_CQE_F_BUFFER ) ) {
+                continue;
+            }
+            const uint16_t bid = static_cast<uint16_t>( cqe->flags >> IORING_CQE_BUFFER_SHIFT );
+            const uint8_t * slot = bufPool + static_cast<size_t>(slotSize) * bid;
+            const struct io_uring_recvmsg_out * out = reinterpret_cast<const struct io_uring_recvmsg_out *>(slot);
+            const uint8_t * control = slot + sizeof(struct io_uring_recvmsg_out) + msgTemplate->msg_namelen;
+            const uint8_t * payload = control + controlSize;
+            const int len = std::min( std::min( static_cast<int>(out->payloadlen), payloadSize ), buffer_capacity );
+            memcpy(buffers + n * buffer_capacity, payload, len);
+            lengths[n] = len;
+            if( nullptr != controls ) {
+                const int clen = std::min( static_cast<int>(out->controllen), controlSize );
+                memcpy(controls + n * controlSize, control, clen);
+                controlLengths[n] = clen;
+            }
+            if( 0 == out->payloadlen && !more ) {
+                eof = true; // end of file, multishot terminated
+            }
+            recycle(bid);
+            n++;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+        if( 0 < n ) {
+            return n;
+        }
+        if( 0 != err ) {
+            errno = err;
+            return -1;
+        }
+        if( cancelled ) {
+            errno = ECANCELED;
+            return -1;
+        }
+        if( eof ) {
+            lengths[0] = 0;
+            if( nullptr != controls ) {
+                controlLengths[0] = 0;
+            }
+            return 1;
+        }
+        if( !armed ) {
+            const std::lock_guard<std::mutex> lock(mtx_submit); // RAII-style acquire and relinquish via destructor
+            if( !cancelled ) {
+                if( !submit(IORING_OP_RECVMSG, RECV_TAG) ) {
+                    return -1;
+                }
+                armed = true;
+            }
+        }
+        if( waited && 0 != timeoutMS ) {
+            return 0; // spurious wakeup
+        }
+        int res;
+        if( 0 != timeoutMS ) {
+            struct __kernel_timespec ts;
+            ts.tv_sec = timeoutMS / 1000;
+            ts.tv_nsec = static_cast<long long>( timeoutMS % 1000 ) * 1000000LL;
+            struct io_uring_getevents_arg arg;
+            bzero(&arg, sizeof(arg));
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+            res = sys_io_uring_enter(ringFD, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        } else {
+            res = sys_io_uring_enter(ringFD, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        }
+        if( 0 > res ) {
+            if( ETIME == errno ) {
+                errno = ETIMEDOUT;
+            }
+            return -1;
+        }
+        waited = true;
+    }
+}
+
+void IOUringReceiver::cancel() {
+    const std::lock_guard<std::mutex> lock(mtx_submit); // RAII-style acquire and relinquish via destructor
+    if( cancelled ) {
+        return;
+    }
+    cancelled = true;
+    if( !submit(IORING_OP_ASYNC_CANCEL, CANCEL_TAG) ) {
+        ERR_PRINT("IOUringReceiver::cancel: fd %d: submit failed", sockFD);
+    }
+}
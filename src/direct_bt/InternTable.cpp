@@ -0,0 +1,138 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+#include <algorithm>
+
+#include "InternTable.hpp"
+
+using namespace direct_bt;
+
+constexpr size_t InternTable::MAX_MSD_SIZE;
+constexpr size_t InternTable::MIN_SWEEP_SIZE;
+
+/** FNV-1a 32 bit hash of the given bytes, continuing the given hash. */
+static size_t hashBytes(const uint8_t * data, const size_t size, size_t h=2166136261u) {
+    for(size_t i=0; i<size; i++) {
+        h = ( h ^ data[i] ) * 16777619u;
+    }
+    return h;
+}
+
+static size_t hashMSD(const ManufactureSpecificData & msd) {
+    const uint8_t company[] = { static_cast<uint8_t>( msd.company & 0xff ), static_cast<uint8_t>( msd.company >> 8 ) };
+    return hashBytes(msd.data.get_ptr(), msd.data.getSize(), hashBytes(company, sizeof(company)));
+}
+
+/** Removes all expired entries of the given table, returning the next table size triggering a sweep. */
+template<typename T>
+static size_t sweepTable(std::unordered_multimap<size_t, std::weak_ptr<T>> & table, const size_t minSweepSize) {
+    for(auto it = table.begin(); it != table.end(); ) {
+        if( it->second.expired() ) {
+            it = table.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return std::max(minSweepSize, 2 * table.size());
+}
+
+const InternTable::StringRef & InternTable::getEmptyString() {
+    static const StringRef empty = std::make_shared<const std::string>();
+    return empty;
+}
+
+InternTable::StringRef InternTable::intern(std::string && s) {
+    if( 0 == s.length() ) {
+        return getEmptyString();
+    }
+    const size_t h = hashBytes(reinterpret_cast<const uint8_t*>(s.data()), s.length());
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    auto range = strings.equal_range(h);
+    for(auto it = range.first; it != range.second; ++it) {
+        StringRef e = it->second.lock();
+        if( nullptr != e && *e == s ) {
+            return e;
+        }
+    }
+    if( strings.size() >= stringsSweepSize ) {
+        stringsSweepSize = sweepTable(strings, MIN_SWEEP_SIZE);
+    }
+    StringRef e = std::make_shared<const std::string>(std::move(s));
+    strings.emplace(h, e);
+    return e;
+}
+
+InternTable::MSDRef InternTable::intern(const MSDRef & msd) {
+    if( nullptr == msd || MAX_MSD_SIZE < static_cast<size_t>( msd->data.getSize() ) ) {
+        return msd;
+    }
+    const size_t h = hashMSD(*msd);
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    auto range = msds.equal_range(h);
+    for(auto it = range.first; it != range.second; ++it) {
+        MSDRef e = it->second.lock();
+        if( nullptr != e && *e == *msd ) {
+            return e;
+        }
+    }
+    if( msds.size() >= msdsSweepSize ) {
+        msdsSweepSize = sweepTable(msds, MIN_SWEEP_SIZE);
+    }
+    msds.emplace(h, msd);
+    return msd;
+}
+
+size_t InternTable::getStringCount() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return strings.size();
+}
+
+size_t InternTable::getMSDCount() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return msds.size();
+}
+
+void InternTable::sweep() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    stringsSweepSize = sweepTable(strings, MIN_SWEEP_SIZE);
+    msdsSweepSize = sweepTable(msds, MIN_SWEEP_SIZE);
+}
+
+void InternTable::clear() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    strings.clear();
+    msds.clear();
+    stringsSweepSize = MIN_SWEEP_SIZE;
+    msdsSweepSize = MIN_SWEEP_SIZE;
+}
+
+std::string InternTable::toString() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return "InternTable[strings "+std::to_string(strings.size())+", msd "+std::to_string(msds.size())+"]";
+}
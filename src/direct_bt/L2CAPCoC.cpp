@@ -0,0 +1,135 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
+
+#include  <algorithm>
+
+#include "L2CAPIoctl.hpp"
+#include "L2CAPCoC.hpp"
+#include "DBTDevice.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+L2CAPSocketOptions L2CAPCoC::toSocketOptions(const uint16_t receiveMTU, const int32_t securityLevel) {
+    return L2CAPSocketOptions(-1 /* sndbuf */, -1 /* rcvbuf */, -1 /* priority */, securityLevel, false /* defer */,
+                              0 < receiveMTU ? receiveMTU : -1);
+}
+
+L2CAPCoC::L2CAPCoC(const std::shared_ptr<DBTDevice> & device, const uint16_t psm, const uint16_t receiveMTU, const int32_t securityLevel)
+: deviceString(device->getAddressString()),
+  l2cap(device, psm, 0 /* cid */, toSocketOptions(receiveMTU, securityLevel)),
+  rbuffer(number(Defaults::MIN_MTU), 0), rpos(0),
+  bytesRead(0), bytesWritten(0), sduReadCount(0), sduWriteCount(0), backpressureCount(0)
+{
+    if( L2CAP_PSM_UNDEF == psm || L2CAP_PSM_LE_DYN_END < psm ) {
+        throw IllegalArgumentException("psm "+uint16HexString(psm)+" not within [0x0001..0x00ff]", E_FILE_LINE);
+    }
+    if( 0 != receiveMTU && number(Defaults::MIN_MTU) > receiveMTU ) {
+        throw IllegalArgumentException("receiveMTU "+std::to_string(receiveMTU)+" not within ["+
+                std::to_string(number(Defaults::MIN_MTU))+".."+std::to_string(number(Defaults::MAX_MTU))+"]", E_FILE_LINE);
+    }
+}
+
+bool L2CAPCoC::connect(const int32_t timeoutMS) {
+    if( !l2cap.connect(timeoutMS) ) {
+        DBG_PRINT("L2CAPCoC::connect: Could not connect psm %s: %s", uint16HexString(getPSM()).c_str(), deviceString.c_str());
+        return false;
+    }
+    const int rmtu = l2cap.getReceiveMTU();
+    rbuffer.resize(0, number(Defaults::MIN_MTU) <= rmtu ? rmtu : number(Defaults::MAX_MTU));
+    rpos = 0;
+    DBG_PRINT("L2CAPCoC::connect: %s", toString().c_str());
+    return true;
+}
+
+bool L2CAPCoC::disconnect() {
+    rbuffer.resize(0);
+    rpos = 0;
+    return l2cap.disconnect();
+}
+
+int L2CAPCoC::write(const uint8_t * data, const int length, const int32_t timeoutMS) {
+    const int smtu = l2cap.getSendMTU();
+    if( 0 >= smtu || 0 > length ) {
+        return -1;
+    }
+    int offset = 0;
+    while( offset < length ) {
+        const int sduSize = std::min(smtu, length - offset);
+        int waitCount = 0;
+        const int len = l2cap.write_nonblock(data + offset, sduSize, timeoutMS, &waitCount);
+        backpressureCount += waitCount;
+        if( 0 == len ) {
+            DBG_PRINT("L2CAPCoC::write: send queue stalled for %d ms, offset %d/%d: %s", timeoutMS, offset, length, deviceString.c_str());
+            break;
+        }
+        if( len != sduSize ) {
+            ERR_PRINT("L2CAPCoC::write: l2cap write error %d != %d, offset %d/%d: %s", len, sduSize, offset, length, deviceString.c_str());
+            return -1;
+        }
+        offset += sduSize;
+        bytesWritten += sduSize;
+        sduWriteCount++;
+    }
+    return offset;
+}
+
+int L2CAPCoC::read(uint8_t * buffer, const int capacity, const int32_t timeoutMS) {
+    if( 0 > capacity ) {
+        return -1;
+    }
+    if( rpos >= rbuffer.getSize() ) {
+        rbuffer.resize(rbuffer.getCapacity());
+        const int len = l2cap.read(rbuffer.get_wptr(), rbuffer.getSize(), timeoutMS);
+        if( 0 >= len ) {
+            const bool timeout = 0 > len && ETIMEDOUT == errno;
+            rbuffer.resize(0);
+            rpos = 0;
+            return timeout ? 0 : -1; // zero length read: remote closed the channel
+        }
+        rbuffer.resize(len);
+        rpos = 0;
+        sduReadCount++;
+    }
+    const int count = std::min(capacity, rbuffer.getSize() - rpos);
+    memcpy(buffer, rbuffer.get_ptr() + rpos, count);
+    rpos += count;
+    bytesRead += count;
+    return count;
+}
+
+std::string L2CAPCoC::toString() const {
+    return "L2CAPCoC[psm "+uint16HexString(getPSM())+", mtu[tx "+std::to_string(getSendMTU())+", rx "+std::to_string(getReceiveMTU())+
+           "], read[bytes "+std::to_string(bytesRead)+", sdus "+std::to_string(sduReadCount)+
+           "], written[bytes "+std::to_string(bytesWritten)+", sdus "+std::to_string(sduWriteCount)+
+           "], backpressure "+std::to_string(backpressureCount)+", "+l2cap.getStateString()+", "+deviceString+"]";
+}
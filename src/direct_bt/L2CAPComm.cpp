@@ -39,19 +39,105 @@
 #include "HCIComm.hpp"
 #include "L2CAPComm.hpp"
 #include "DBTAdapter.hpp"
+#include "PacketCapture.hpp"
 
 extern "C" {
     #include <unistd.h>
+    #include <fcntl.h>
     #include <sys/socket.h>
+    #include <sys/ioctl.h>
+    #include <linux/sockios.h>
     #include <poll.h>
     #include <signal.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
 }
 
 #include <dbt_debug.hpp>
 
 using namespace direct_bt;
 
-int L2CAPComm::l2cap_open_dev(const EUI48 & adapterAddress, const uint16_t psm, const uint16_t cid, const bool pubaddrAdapter) {
+L2CAPSocketOptions::L2CAPSocketOptions()
+: SEND_BUFFER_SIZE(-1), RECEIVE_BUFFER_SIZE(-1), PRIORITY(-1), SECURITY_LEVEL(-1), DEFER_SETUP(false), RECEIVE_MTU(-1),
+  RX_TIMESTAMPS(false)
+{
+}
+
+L2CAPSocketOptions::L2CAPSocketOptions(const int32_t sendBufferSize, const int32_t receiveBufferSize, const int32_t priority,
+                                       const int32_t securityLevel, const bool deferSetup, const int32_t receiveMTU,
+                                       const bool rxTimestamps)
+: SEND_BUFFER_SIZE(sendBufferSize), RECEIVE_BUFFER_SIZE(receiveBufferSize), PRIORITY(priority),
+  SECURITY_LEVEL(securityLevel), DEFER_SETUP(deferSetup), RECEIVE_MTU(receiveMTU), RX_TIMESTAMPS(rxTimestamps)
+{
+}
+
+L2CAPSocketOptions::L2CAPSocketOptions(const std::string & prefix)
+: SEND_BUFFER_SIZE( DBTEnv::getInt32Property(prefix+".sndbuf", -1, -1 /* min */, INT32_MAX /* max */) ),
+  RECEIVE_BUFFER_SIZE( DBTEnv::getInt32Property(prefix+".rcvbuf", -1, -1 /* min */, INT32_MAX /* max */) ),
+  PRIORITY( DBTEnv::getInt32Property(prefix+".priority", -1, -1 /* min */, 6 /* max */) ),
+  SECURITY_LEVEL( DBTEnv::getInt32Property(prefix+".security", -1, -1 /* min */, BT_SECURITY_FIPS /* max */) ),
+  DEFER_SETUP( DBTEnv::getBooleanProperty(prefix+".defer", false) ),
+  RECEIVE_MTU( DBTEnv::getInt32Property(prefix+".rcvmtu", -1, -1 /* min */, UINT16_MAX /* max */) ),
+  RX_TIMESTAMPS( DBTEnv::getBooleanProperty(prefix+".timestamps", true) )
+{
+}
+
+bool L2CAPSocketOptions::applyTo(const int dd) const {
+    bool res = true;
+    if( 0 <= SEND_BUFFER_SIZE && 0 > setsockopt(dd, SOL_SOCKET, SO_SNDBUF, &SEND_BUFFER_SIZE, sizeof(SEND_BUFFER_SIZE)) ) {
+        ERR_PRINT("L2CAPSocketOptions: SO_SNDBUF %d failed", SEND_BUFFER_SIZE);
+        res = false;
+    }
+    if( 0 <= RECEIVE_BUFFER_SIZE && 0 > setsockopt(dd, SOL_SOCKET, SO_RCVBUF, &RECEIVE_BUFFER_SIZE, sizeof(RECEIVE_BUFFER_SIZE)) ) {
+        ERR_PRINT("L2CAPSocketOptions: SO_RCVBUF %d failed", RECEIVE_BUFFER_SIZE);
+        res = false;
+    }
+    if( 0 <= PRIORITY && 0 > setsockopt(dd, SOL_SOCKET, SO_PRIORITY, &PRIORITY, sizeof(PRIORITY)) ) {
+        ERR_PRINT("L2CAPSocketOptions: SO_PRIORITY %d failed", PRIORITY);
+        res = false;
+    }
+    if( BT_SECURITY_LOW <= SECURITY_LEVEL ) {
+        struct bt_security sec;
+        bzero((void *)&sec, sizeof(sec));
+        sec.level = static_cast<uint8_t>(SECURITY_LEVEL);
+        if( 0 > setsockopt(dd, SOL_BLUETOOTH, BT_SECURITY, &sec, sizeof(sec)) ) {
+            ERR_PRINT("L2CAPSocketOptions: BT_SECURITY %d failed", SECURITY_LEVEL);
+            res = false;
+        }
+    }
+    if( DEFER_SETUP ) {
+        const uint32_t v = 1;
+        if( 0 > setsockopt(dd, SOL_BLUETOOTH, BT_DEFER_SETUP, &v, sizeof(v)) ) {
+            ERR_PRINT("L2CAPSocketOptions: BT_DEFER_SETUP failed");
+            res = false;
+        }
+    }
+    if( 0 <= RECEIVE_MTU ) {
+        const uint16_t v = static_cast<uint16_t>(RECEIVE_MTU);
+        if( 0 > setsockopt(dd, SOL_BLUETOOTH, BT_RCVMTU, &v, sizeof(v)) ) {
+            ERR_PRINT("L2CAPSocketOptions: BT_RCVMTU %d failed", RECEIVE_MTU);
+            res = false;
+        }
+    }
+    if( RX_TIMESTAMPS ) {
+        const int v = 1;
+        if( 0 > setsockopt(dd, SOL_SOCKET, SO_TIMESTAMPNS, &v, sizeof(v)) ) {
+            ERR_PRINT("L2CAPSocketOptions: SO_TIMESTAMPNS failed");
+            res = false;
+        }
+    }
+    return res;
+}
+
+std::string L2CAPSocketOptions::toString() const {
+    return "L2CAPSocketOptions[sndbuf "+std::to_string(SEND_BUFFER_SIZE)+", rcvbuf "+std::to_string(RECEIVE_BUFFER_SIZE)+
+           ", priority "+std::to_string(PRIORITY)+", security "+std::to_string(SECURITY_LEVEL)+
+           ", defer "+std::to_string(DEFER_SETUP)+", rcvmtu "+std::to_string(RECEIVE_MTU)+
+           ", timestamps "+std::to_string(RX_TIMESTAMPS)+"]";
+}
+
+int L2CAPComm::l2cap_open_dev(const EUI48 & adapterAddress, const uint16_t cid, const bool pubaddrAdapter,
+                              const L2CAPSocketOptions & options) {
     sockaddr_l2 a;
     int dd, err;
 
@@ -63,12 +149,13 @@ int L2CAPComm::l2cap_open_dev(const EUI48 & adapterAddress, const uint16_t psm,
         ERR_PRINT("L2CAPComm::l2cap_open_dev: socket failed");
         return dd;
     }
+    options.applyTo(dd);
 
     // Bind socket to the L2CAP adapter
     // BT Core Spec v5.2: Vol 3, Part A: L2CAP_CONNECTION_REQ
     bzero((void *)&a, sizeof(a));
     a.l2_family=AF_BLUETOOTH;
-    a.l2_psm = cpu_to_le(psm);
+    a.l2_psm = 0; // local psm, the remote's psm is given at connect
     a.l2_bdaddr = adapterAddress;
     a.l2_cid = cpu_to_le(cid);
     a.l2_bdaddr_type = pubaddrAdapter ? BDADDR_LE_PUBLIC : BDADDR_LE_RANDOM;
@@ -91,17 +178,120 @@ int L2CAPComm::l2cap_close_dev(int dd)
     return close(dd);
 }
 
+static std::atomic<L2CAPComm::TransportConnectFunc> l2capTransportConnect( nullptr );
+
+void L2CAPComm::setTransport(TransportConnectFunc connect) {
+    l2capTransportConnect = connect;
+}
+
 
 // *************************************************
 // *************************************************
 // *************************************************
 
-L2CAPComm::L2CAPComm(std::shared_ptr<DBTDevice> device, const uint16_t psm, const uint16_t cid)
-: device(device), deviceString(device->getAddressString()), psm(psm), cid(cid),
-  _dd(-1), isConnected(false), hasIOError(false), interruptFlag(false), tid_connect(0)
-{ }
+L2CAPComm::L2CAPComm(std::shared_ptr<DBTDevice> device, const uint16_t psm, const uint16_t cid, const L2CAPSocketOptions & options)
+: device(device), deviceString(device->getAddressString()), psm(psm), cid(cid), options(options),
+  _dd(-1), isConnected(false), hasIOError(false), interruptFlag(false), cancelfd(-1), receiverTried(false)
+{
+    cancelfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if( 0 > cancelfd ) {
+        ERR_PRINT("L2CAPComm: eventfd failed, connect not cancellable: %s", deviceString.c_str());
+    }
+}
+
+L2CAPComm::~L2CAPComm() {
+    disconnect();
+    if( 0 <= cancelfd ) {
+        close(cancelfd);
+    }
+}
+
+int L2CAPComm::connect_wait(const int32_t timeoutMS) {
+    struct pollfd p[2];
+    int nfds = 1, n;
+    const int64_t t0 = getCurrentMilliseconds();
 
-bool L2CAPComm::connect() {
+    p[0].fd = _dd; p[0].events = POLLOUT; p[0].revents = 0;
+    if( 0 <= cancelfd ) {
+        p[1].fd = cancelfd; p[1].events = POLLIN; p[1].revents = 0;
+        nfds = 2;
+    }
+    for(;;) {
+        if( interruptFlag ) {
+            errno = ECANCELED;
+            return -1;
+        }
+        const int64_t left = static_cast<int64_t>(timeoutMS) - ( getCurrentMilliseconds() - t0 );
+        if( 0 >= left ) {
+            errno = ETIMEDOUT;
+            return -2;
+        }
+        n = poll(p, nfds, static_cast<int>(left));
+        if( 0 > n ) {
+            if( EINTR == errno || EAGAIN == errno ) {
+                continue;
+            }
+            return -1;
+        }
+        if( 0 == n ) {
+            errno = ETIMEDOUT;
+            return -2;
+        }
+        if( 2 == nfds && 0 != p[1].revents ) {
+            errno = ECANCELED;
+            return -1;
+        }
+        if( 0 != p[0].revents ) {
+            int soerr = 0;
+            socklen_t len = sizeof(soerr);
+            if( 0 > getsockopt(_dd, SOL_SOCKET, SO_ERROR, &soerr, &len) ) {
+                return -1;
+            }
+            if( 0 != soerr ) {
+                errno = soerr;
+                return -1;
+            }
+            return 0;
+        }
+    }
+}
+
+int L2CAPComm::wait_readable(const int32_t timeoutMS) {
+    struct pollfd p[2];
+    int nfds = 1, n = 0;
+
+    p[0].fd = _dd; p[0].events = POLLIN; p[0].revents = 0;
+    if( 0 <= cancelfd ) {
+        p[1].fd = cancelfd; p[1].events = POLLIN; p[1].revents = 0;
+        nfds = 2;
+    }
+    for(;;) {
+        if( interruptFlag ) {
+            errno = ECANCELED;
+            return -1;
+        }
+        n = poll(p, nfds, timeoutMS);
+        if( 0 <= n ) {
+            break;
+        }
+        if( EINTR != errno && EAGAIN != errno ) {
+            return -1;
+        }
+        // cont temp unavail or interruption
+    }
+    if( 2 == nfds && 0 != p[1].revents ) {
+        // left signalled until the next connect(), hence all readers wake up
+        errno = ECANCELED;
+        return -1;
+    }
+    if( 0 == n ) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    return n;
+}
+
+bool L2CAPComm::connect(const int32_t timeoutMS) {
     const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
 
     /** BT Core Spec v5.2: Vol 3, Part A: L2CAP_CONNECTION_REQ */
@@ -113,20 +303,32 @@ bool L2CAPComm::connect() {
         return true;
     }
     hasIOError = false;
-    DBG_PRINT("L2CAPComm::connect: Start: %s, dd %d, %s, psm %u, cid %u, pubDevice %d",
-              getStateString().c_str(), _dd.load(), deviceString.c_str(), psm, cid, true);
+    interruptFlag = false;
+    {
+        const std::lock_guard<std::mutex> lock(mtx_receiver); // RAII-style acquire and relinquish via destructor
+        receiver = nullptr; // of the previous connection, its reader has ended
+        receiverTried = false;
+    }
+    if( 0 <= cancelfd ) {
+        uint64_t v;
+        while( sizeof(v) == ::read(cancelfd, &v, sizeof(v)) ) { } // drain stale cancellation
+    }
+    DBG_PRINT("L2CAPComm::connect: Start: %s, dd %d, %s, psm %u, cid %u, pubDevice %d, timeout %d ms",
+              getStateString().c_str(), _dd.load(), deviceString.c_str(), psm, cid, true, timeoutMS);
 
     sockaddr_l2 req;
-    int err, res;
+    int err, res, flags;
     int to_retry_count=0; // ETIMEDOUT retry count
 
-    _dd = l2cap_open_dev(device->getAdapter().getAddress(), psm, cid, true /* pubaddrAdapter */);
-    if( 0 > _dd ) {
-        goto failure; // open failed
+    const TransportConnectFunc transportConnect = l2capTransportConnect;
+    if( nullptr != transportConnect ) {
+        _dd = transportConnect(*device, psm, cid);
+        if( 0 > _dd ) {
+            goto failure;
+        }
+        return true;
     }
 
-    tid_connect = pthread_self(); // temporary safe tid to allow interruption
-
     // actual request to connect to remote device
     bzero((void *)&req, sizeof(req));
     req.l2_family = AF_BLUETOOTH;
@@ -136,8 +338,27 @@ bool L2CAPComm::connect() {
     req.l2_bdaddr_type = device->getAddressType();
 
     while( !interruptFlag ) {
-        // blocking
+        if( 0 > _dd ) {
+            _dd = l2cap_open_dev(device->getAdapter().getAddress(), cid, true /* pubaddrAdapter */, options);
+            if( 0 > _dd ) {
+                goto failure; // open failed
+            }
+        }
+        flags = fcntl(_dd, F_GETFL, 0);
+        if( 0 > flags || 0 > fcntl(_dd, F_SETFL, flags | O_NONBLOCK) ) {
+            ERR_PRINT("L2CAPComm::connect: fcntl O_NONBLOCK failed");
+            goto failure;
+        }
         res = ::connect(_dd, (struct sockaddr*)&req, sizeof(req));
+        if( 0 > res && EINPROGRESS == errno ) {
+            res = connect_wait(timeoutMS);
+        }
+        err = errno;
+        if( 0 > fcntl(_dd, F_SETFL, flags) ) { // restore blocking mode for read and write
+            ERR_PRINT("L2CAPComm::connect: fcntl restore failed");
+            goto failure;
+        }
+        errno = err;
 
         DBG_PRINT("L2CAPComm::connect: Result %d, errno 0%X %s, %s", res, errno, strerror(errno), deviceString.c_str());
 
@@ -145,10 +366,21 @@ bool L2CAPComm::connect() {
         {
             break; // done
 
+        } else if( ECANCELED == errno ) {
+            INFO_PRINT("L2CAPComm::connect: cancelled: %s", deviceString.c_str());
+            goto failure; // exit
+
+        } else if( -2 == res ) {
+            ERR_PRINT("L2CAPComm::connect: timeout after %d ms: %s", timeoutMS, deviceString.c_str());
+            goto failure; // exit
+
         } else if( ETIMEDOUT == errno ) {
             to_retry_count++;
             if( to_retry_count < number(Defaults::L2CAP_CONNECT_MAX_RETRY) ) {
                 INFO_PRINT("L2CAPComm::connect: timeout, retry %d", to_retry_count);
+                // a failed non-blocking connect leaves the socket unusable
+                l2cap_close_dev(_dd);
+                _dd = -1;
                 continue;
             } else {
                 ERR_PRINT("L2CAPComm::connect: timeout, retried %d", to_retry_count);
@@ -161,19 +393,35 @@ bool L2CAPComm::connect() {
             goto failure; // exit
         }
     }
-    tid_connect = 0;
+    if( interruptFlag ) {
+        errno = ECANCELED;
+        goto failure;
+    }
 
     return true;
 
 failure:
-    tid_connect = 0;
     err = errno;
     disconnect();
     errno = err;
     return false;
 }
 
+void L2CAPComm::cancelConnect() {
+    interruptFlag = true;
+    if( 0 <= cancelfd ) {
+        uint64_t one = 1;
+        if( sizeof(one) != ::write(cancelfd, &one, sizeof(one)) ) {
+            ERR_PRINT("L2CAPComm::cancelConnect: wakeup failed: %s", deviceString.c_str());
+        }
+    }
+}
+
 bool L2CAPComm::disconnect() {
+    // interrupt a pending L2CAP connect(..) before waiting for its lock, avoiding prolonged hang
+    if( isConnected ) {
+        cancelConnect();
+    }
     const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
 
     bool expConn = true; // C++11, exp as value since C++20
@@ -186,27 +434,108 @@ bool L2CAPComm::disconnect() {
     DBG_PRINT("L2CAPComm::disconnect: Start: %s, dd %d, %s, psm %u, cid %u, pubDevice %d",
               getStateString().c_str(), _dd.load(), deviceString.c_str(), psm, cid, true);
     interruptFlag = true;
-
-    // interrupt L2CAP ::connect(..), avoiding prolonged hang
-    pthread_t _tid_connect = tid_connect;
-    tid_connect = 0;
-    if( 0 != _tid_connect ) {
-        pthread_t tid_self = pthread_self();
-        if( tid_self != _tid_connect ) {
-            int kerr;
-            if( 0 != ( kerr = pthread_kill(_tid_connect, SIGALRM) ) ) {
-                ERR_PRINT("L2CAP::disconnect: pthread_kill %p FAILED: %d", (void*)_tid_connect, kerr);
-            }
+    {
+        const std::lock_guard<std::mutex> lock(mtx_receiver); // RAII-style acquire and relinquish via destructor
+        if( nullptr != receiver ) {
+            receiver->cancel(); // releases the socket and wakes up the reader
         }
     }
 
-    l2cap_close_dev(_dd);
+    if( 0 <= _dd ) {
+        l2cap_close_dev(_dd);
+    }
     _dd = -1;
     interruptFlag = false;
     DBG_PRINT("L2CAPComm::disconnect: End: dd %d", _dd.load());
     return true;
 }
 
+int L2CAPComm::getSendMTU() const {
+    const int dd = _dd;
+    uint16_t v = 0;
+    socklen_t len = sizeof(v);
+    if( 0 > dd || 0 > getsockopt(dd, SOL_BLUETOOTH, BT_SNDMTU, &v, &len) ) {
+        return -1;
+    }
+    return v;
+}
+
+int L2CAPComm::getReceiveMTU() const {
+    const int dd = _dd;
+    uint16_t v = 0;
+    socklen_t len = sizeof(v);
+    if( 0 > dd || 0 > getsockopt(dd, SOL_BLUETOOTH, BT_RCVMTU, &v, &len) ) {
+        return -1;
+    }
+    return v;
+}
+
+int L2CAPComm::getSendQueueSize() const {
+    const int dd = _dd;
+    int outq = 0;
+    if( 0 > dd || 0 > ioctl(dd, SIOCOUTQ, &outq) ) {
+        return -1;
+    }
+    return outq;
+}
+
+static void capturePacket(const DBTDevice & device, const uint16_t cid, const uint8_t * buffer, const int len, const bool incoming) {
+    PacketCapture & pc = PacketCapture::get();
+    if( !pc.isEnabled() || 0 >= len ) {
+        return;
+    }
+    pc.captureL2CAP(device.getAdapter().dev_id, device.getConnectionHandle(), cid, buffer, len, incoming);
+}
+
+/** Control messages of one received packet: SCM_TIMESTAMPNS timestamp */
+#define L2CAP_RX_CONTROL_SIZE ( CMSG_SPACE(sizeof(struct timespec)) )
+
+IOUringReceiver * L2CAPComm::getReceiver(const int capacity) {
+    if( !receiverTried && IOUringReceiver::isEnabled() ) {
+        const std::lock_guard<std::mutex> lock(mtx_receiver); // RAII-style acquire and relinquish via destructor
+        if( !interruptFlag && 0 <= _dd ) {
+            receiverTried = true;
+            receiver = IOUringReceiver::create(_dd, capacity, L2CAP_RX_CONTROL_SIZE);
+            if( nullptr == receiver ) {
+                WARN_PRINT("L2CAPComm: io_uring receiver unavailable, using poll: %s", deviceString.c_str());
+            }
+        }
+    }
+    return receiver.get();
+}
+
+int L2CAPComm::receive(IOUringReceiver * r, uint8_t* buffers, const int buffer_capacity, int* lengths, const int count,
+                       const int32_t timeoutMS, uint64_t* timestamps) {
+    uint8_t ctrls[static_cast<int>(Defaults::MAX_READ_BATCH)][L2CAP_RX_CONTROL_SIZE];
+    int ctrlLengths[static_cast<int>(Defaults::MAX_READ_BATCH)];
+    const int n_max = std::min(count, number(Defaults::MAX_READ_BATCH));
+    int res;
+
+    while( ( res = r->receive(buffers, buffer_capacity, lengths, n_max, timeoutMS,
+                              nullptr != timestamps ? &ctrls[0][0] : nullptr, ctrlLengths) ) < 0 ) {
+        if ( !interruptFlag && errno == EINTR ) {
+            // cont interruption
+            continue;
+        }
+        if( errno != ETIMEDOUT ) {
+            hasIOError = true;
+        }
+        return -1;
+    }
+    const uint64_t now = nullptr != timestamps ? getCurrentNanoseconds() : 0; // w/o kernel timestamps
+    for(int i=0; i<res; i++) {
+        if( nullptr != timestamps ) {
+            struct msghdr msg;
+            bzero((void*)&msg, sizeof(msg));
+            msg.msg_control = ctrls[i];
+            msg.msg_controllen = ctrlLengths[i];
+            timestamps[i] = HCIComm::getRxTimestamp(&msg, now);
+        }
+        capturePacket(*device, cid, buffers + i * buffer_capacity, lengths[i], true /* incoming */);
+    }
+    return res;
+}
+
 int L2CAPComm::read(uint8_t* buffer, const int capacity, const int32_t timeoutMS) {
     int len = 0;
     if( 0 > _dd || 0 > capacity ) {
@@ -215,42 +544,150 @@ int L2CAPComm::read(uint8_t* buffer, const int capacity, const int32_t timeoutMS
     if( 0 == capacity ) {
         goto done;
     }
+    {
+        IOUringReceiver * r = getReceiver(capacity);
+        if( nullptr != r ) {
+            const int res = receive(r, buffer, capacity, &len, 1, timeoutMS, nullptr);
+            if( 0 == res ) {
+                errno = ETIMEDOUT; // spurious wakeup
+            }
+            return 0 < res ? len : -1;
+        }
+    }
 
-    if( timeoutMS ) {
-        struct pollfd p;
-        int n;
+    if( timeoutMS && 0 > wait_readable(timeoutMS) ) {
+        goto errout;
+    }
 
-        p.fd = _dd; p.events = POLLIN;
-        while ( !interruptFlag && (n = poll(&p, 1, timeoutMS)) < 0 ) {
-            if ( !interruptFlag && ( errno == EAGAIN || errno == EINTR ) ) {
-                // cont temp unavail or interruption
-                continue;
-            }
-            goto errout;
+    while ((len = ::read(_dd, buffer, capacity)) < 0) {
+        if (errno == EAGAIN || errno == EINTR ) {
+            // cont temp unavail or interruption
+            continue;
         }
-        if (!n) {
-            errno = ETIMEDOUT;
-            goto errout;
+        goto errout;
+    }
+    capturePacket(*device, cid, buffer, len, true /* incoming */);
+
+done:
+    return len;
+
+errout:
+    if( errno != ETIMEDOUT && errno != ECANCELED ) {
+        hasIOError = true;
+    }
+    return -1;
+
+}
+
+int L2CAPComm::read(uint8_t* buffer, const int capacity, const int32_t timeoutMS, uint64_t & timestamp) {
+    struct msghdr msg;
+    struct iovec iov;
+    uint8_t ctrl[CMSG_SPACE(sizeof(struct timespec))];
+    int len = 0;
+    if( 0 > _dd || 0 > capacity ) {
+        goto errout;
+    }
+    if( 0 == capacity ) {
+        timestamp = getCurrentNanoseconds();
+        goto done;
+    }
+    {
+        IOUringReceiver * r = getReceiver(capacity);
+        if( nullptr != r ) {
+            const int res = receive(r, buffer, capacity, &len, 1, timeoutMS, &timestamp);
+            if( 0 == res ) {
+                errno = ETIMEDOUT; // spurious wakeup
+            }
+            return 0 < res ? len : -1;
         }
     }
 
-    while ((len = ::read(_dd, buffer, capacity)) < 0) {
+    if( timeoutMS && 0 > wait_readable(timeoutMS) ) {
+        goto errout;
+    }
+
+    bzero((void*)&msg, sizeof(msg));
+    iov.iov_base = buffer;
+    iov.iov_len = capacity;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    while ((len = ::recvmsg(_dd, &msg, 0)) < 0) {
         if (errno == EAGAIN || errno == EINTR ) {
             // cont temp unavail or interruption
             continue;
         }
         goto errout;
     }
+    timestamp = HCIComm::getRxTimestamp(&msg, getCurrentNanoseconds());
+    capturePacket(*device, cid, buffer, len, true /* incoming */);
 
 done:
     return len;
 
 errout:
-    if( errno != ETIMEDOUT ) {
+    if( errno != ETIMEDOUT && errno != ECANCELED ) {
         hasIOError = true;
     }
     return -1;
+}
+
+int L2CAPComm::read_batch(uint8_t* buffers, const int buffer_capacity, int* lengths, const int count, const int32_t timeoutMS) {
+    struct mmsghdr msgs[static_cast<int>(Defaults::MAX_READ_BATCH)];
+    struct iovec iovs[static_cast<int>(Defaults::MAX_READ_BATCH)];
+    const int n_max = std::min(count, number(Defaults::MAX_READ_BATCH));
+    int res = 0;
 
+    if( 0 > _dd || 0 > buffer_capacity || 0 > n_max ) {
+        goto errout;
+    }
+    if( 0 == buffer_capacity || 0 == n_max ) {
+        goto done;
+    }
+    {
+        IOUringReceiver * r = getReceiver(buffer_capacity);
+        if( nullptr != r ) {
+            return receive(r, buffers, buffer_capacity, lengths, n_max, timeoutMS, nullptr);
+        }
+    }
+
+    if( timeoutMS && 0 > wait_readable(timeoutMS) ) {
+        goto errout;
+    }
+
+    bzero((void*)msgs, sizeof(struct mmsghdr)*n_max);
+    for(int i=0; i<n_max; i++) {
+        iovs[i].iov_base = buffers + i * buffer_capacity;
+        iovs[i].iov_len = buffer_capacity;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // Block for the first packet only w/o poll, otherwise drain all pending.
+    while ((res = ::recvmmsg(_dd, msgs, n_max, timeoutMS ? MSG_DONTWAIT : MSG_WAITFORONE, nullptr)) < 0) {
+        if( errno == EAGAIN ) {
+            res = 0; // spurious wakeup
+            goto done;
+        }
+        if( errno == EINTR ) {
+            // cont interruption
+            continue;
+        }
+        goto errout;
+    }
+    for(int i=0; i<res; i++) {
+        lengths[i] = msgs[i].msg_len;
+        capturePacket(*device, cid, buffers + i * buffer_capacity, lengths[i], true /* incoming */);
+    }
+
+done:
+    return res;
+
+errout:
+    if( errno != ETIMEDOUT && errno != ECANCELED ) {
+        hasIOError = true;
+    }
+    return -1;
 }
 
 int L2CAPComm::write(const uint8_t * buffer, const int length) {
@@ -269,6 +706,7 @@ int L2CAPComm::write(const uint8_t * buffer, const int length) {
         }
         goto errout;
     }
+    capturePacket(*device, cid, buffer, len, false /* incoming */);
 
 done:
     return len;
@@ -278,3 +716,289 @@ errout:
     return -1;
 }
 
+int L2CAPComm::write_nonblock(const uint8_t * buffer, const int length, const int32_t timeoutMS, int* waitCount) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx_write); // RAII-style acquire and relinquish via destructor
+    if( 0 > _dd || 0 > length ) {
+        hasIOError = true;
+        return -1;
+    }
+    if( 0 == length ) {
+        return 0;
+    }
+    for(;;) {
+        const ssize_t len = ::send(_dd, buffer, length, MSG_DONTWAIT);
+        if( 0 <= len ) {
+            capturePacket(*device, cid, buffer, len, false /* incoming */);
+            return len;
+        }
+        if( EINTR == errno ) {
+            continue;
+        }
+        if( EAGAIN != errno && EWOULDBLOCK != errno ) {
+            break;
+        }
+        // send queue full: wait until writable
+        if( nullptr != waitCount ) {
+            (*waitCount)++;
+        }
+        struct pollfd p;
+        int n = 0;
+
+        p.fd = _dd; p.events = POLLOUT; p.revents = 0;
+        while ( !interruptFlag && (n = poll(&p, 1, timeoutMS)) < 0 ) {
+            if ( !interruptFlag && errno == EINTR ) {
+                // cont interruption
+                continue;
+            }
+            break;
+        }
+        if( interruptFlag || 0 > n ) {
+            break;
+        }
+        if( 0 == n ) {
+            errno = ETIMEDOUT;
+            return 0;
+        }
+        if( 0 != ( p.revents & ( POLLERR | POLLHUP | POLLNVAL ) ) ) {
+            break;
+        }
+    }
+    hasIOError = true;
+    return -1;
+}
+
+// *************************************************
+// *************************************************
+// *************************************************
+
+L2CAPReactor::Entry::~Entry() {
+    close(fd);
+}
+
+L2CAPReactor::L2CAPReactor(const int threadCount, const DBTThreadOptions & threadOptions)
+: threadCount(threadCount), threadOptions(threadOptions), epfd(-1), wakefd(-1), running(false), nextId(1)
+{
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if( 0 > epfd ) {
+        ERR_PRINT("L2CAPReactor: epoll_create1 failed");
+        return;
+    }
+    // Level triggered and never read, waking all workers once stopped
+    wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if( 0 > wakefd ) {
+        ERR_PRINT("L2CAPReactor: eventfd failed");
+        return;
+    }
+    struct epoll_event ev;
+    bzero(&ev, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    if( 0 > epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev) ) {
+        ERR_PRINT("L2CAPReactor: epoll_ctl wakefd failed");
+        return;
+    }
+    running = true;
+}
+
+L2CAPReactor::~L2CAPReactor() {
+    stop();
+    if( 0 <= wakefd ) {
+        close(wakefd);
+    }
+    if( 0 <= epfd ) {
+        close(epfd);
+    }
+}
+
+std::shared_ptr<L2CAPReactor> L2CAPReactor::create(const int threadCount, const DBTThreadOptions & threadOptions) {
+    std::shared_ptr<L2CAPReactor> r( new L2CAPReactor(std::max(0, threadCount), threadOptions) );
+    if( r->running ) {
+        // Each worker holds a reference until it has ended, hence the reactor outlives its detached workers.
+        for(int i=0; i<r->threadCount; i++) {
+            std::thread worker = std::thread([r]() { r->workerImpl(); });
+            worker.detach();
+        }
+    }
+    return r;
+}
+
+uint64_t L2CAPReactor::add(const int dd, const int capacity, const ReadCallback & callback) {
+    if( !running || 0 > dd || 0 >= capacity ) {
+        return 0;
+    }
+    const int fd = fcntl(dd, F_DUPFD_CLOEXEC, 0);
+    if( 0 > fd ) {
+        ERR_PRINT("L2CAPReactor::add: dup of dd %d failed", dd);
+        return 0;
+    }
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    std::shared_ptr<Entry> e( new Entry(nextId++, fd, capacity, callback) );
+    struct epoll_event ev;
+    bzero(&ev, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.u64 = e->id;
+    if( 0 > epoll_ctl(epfd, EPOLL_CTL_ADD, e->fd, &ev) ) {
+        ERR_PRINT("L2CAPReactor::add: epoll_ctl of dd %d failed", dd);
+        return 0;
+    }
+    entries[e->id] = e;
+    DBG_PRINT("L2CAPReactor::add: id %" PRIu64 ", dd %d, capacity %d, channels %zd", e->id, dd, capacity, entries.size());
+    return e->id;
+}
+
+bool L2CAPReactor::remove(const uint64_t id, const bool wait) {
+    std::unique_lock<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    auto it = entries.find(id);
+    if( entries.end() == it ) {
+        return false;
+    }
+    std::shared_ptr<Entry> e = it->second;
+    entries.erase(it);
+    epoll_ctl(epfd, EPOLL_CTL_DEL, e->fd, nullptr);
+    if( wait ) {
+        const std::thread::id self = std::this_thread::get_id();
+        while( std::thread::id() != e->worker && self != e->worker ) {
+            cv_entries.wait(lock);
+        }
+    }
+    return true;
+}
+
+void L2CAPReactor::stop() {
+    bool expRunning = true; // C++11, exp as value since C++20
+    if( !running.compare_exchange_strong(expRunning, false) ) {
+        return;
+    }
+    uint64_t one = 1;
+    if( sizeof(one) != ::write(wakefd, &one, sizeof(one)) ) {
+        ERR_PRINT("L2CAPReactor::stop: wakeup failed");
+    }
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    for(auto it = entries.begin(); it != entries.end(); it++) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+    }
+    entries.clear();
+}
+
+int L2CAPReactor::size() {
+    const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    return static_cast<int>(entries.size());
+}
+
+void L2CAPReactor::serve(const std::shared_ptr<Entry> & e, const uint32_t events, std::vector<uint8_t> & buffer) {
+    bool keep = true;
+    bool ioError = false;
+    int count = 0;
+
+    if( static_cast<int>(buffer.size()) < e->capacity ) {
+        buffer.resize(e->capacity);
+    }
+    while( keep && running && count < L2CAPComm::number(L2CAPComm::Defaults::MAX_READ_BATCH) ) {
+        const int len = ::recv(e->fd, buffer.data(), e->capacity, MSG_DONTWAIT);
+        if( 0 < len ) {
+            count++;
+            keep = e->callback.invoke(buffer.data(), len);
+        } else if( 0 == len ) {
+            break; // nothing more to read or orderly shutdown, see below
+        } else if( EINTR == errno ) {
+            continue;
+        } else {
+            ioError = EAGAIN != errno && EWOULDBLOCK != errno;
+            break;
+        }
+    }
+    if( keep && running && ( ioError || ( 0 == count && 0 != ( events & ( EPOLLERR | EPOLLHUP | EPOLLRDHUP ) ) ) ) ) {
+        e->callback.invoke(nullptr, -1);
+        keep = false;
+    }
+
+    std::unique_lock<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+    e->worker = std::thread::id();
+    auto it = entries.find(e->id);
+    if( entries.end() != it && it->second == e ) {
+        if( keep ) {
+            struct epoll_event ev;
+            bzero(&ev, sizeof(ev));
+            ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+            ev.data.u64 = e->id;
+            if( 0 > epoll_ctl(epfd, EPOLL_CTL_MOD, e->fd, &ev) ) {
+                ERR_PRINT("L2CAPReactor::serve: re-arm of id %" PRIu64 " failed", e->id);
+                lock.unlock();
+                e->callback.invoke(nullptr, -1);
+                lock.lock();
+                keep = false;
+            }
+        }
+        if( !keep ) {
+            it = entries.find(e->id);
+            if( entries.end() != it ) {
+                entries.erase(it);
+                epoll_ctl(epfd, EPOLL_CTL_DEL, e->fd, nullptr);
+            }
+        }
+    }
+    cv_entries.notify_all();
+}
+
+int L2CAPReactor::dispatch(const struct epoll_event * events, const int count, std::vector<uint8_t> & buffer) {
+    int served = 0;
+    for(int i=0; i<count && running; i++) {
+        if( 0 == events[i].data.u64 ) {
+            continue; // wakefd
+        }
+        std::shared_ptr<Entry> e;
+        {
+            const std::lock_guard<std::mutex> lock(mtx_entries); // RAII-style acquire and relinquish via destructor
+            auto it = entries.find(events[i].data.u64);
+            if( entries.end() != it ) {
+                e = it->second;
+                e->worker = std::this_thread::get_id();
+            }
+        }
+        if( nullptr != e ) {
+            serve(e, events[i].events, buffer);
+            served++;
+        }
+    }
+    return served;
+}
+
+void L2CAPReactor::workerImpl() {
+    threadOptions.applyToCurrentThread();
+    std::vector<uint8_t> buffer;
+    struct epoll_event events[MAX_EVENTS];
+    DBG_PRINT("L2CAPReactor::worker: Started");
+
+    while( running ) {
+        const int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if( 0 > n ) {
+            if( EINTR == errno ) {
+                continue;
+            }
+            ERR_PRINT("L2CAPReactor::worker: epoll_wait failed -> Stop");
+            break;
+        }
+        dispatch(events, n, buffer);
+    }
+    DBG_PRINT("L2CAPReactor::worker: Ended");
+}
+
+int L2CAPReactor::process(const int32_t timeoutMS) {
+    if( !running ) {
+        return -1;
+    }
+    struct epoll_event events[MAX_EVENTS];
+    int n;
+    while( 0 > ( n = epoll_wait(epfd, events, MAX_EVENTS, timeoutMS) ) ) {
+        if( EINTR != errno ) {
+            ERR_PRINT("L2CAPReactor::process: epoll_wait failed");
+            return -1;
+        }
+    }
+    return dispatch(events, n, processBuffer);
+}
+
+std::string L2CAPReactor::toString() {
+    return "L2CAPReactor[running "+std::to_string(running.load())+", threads "+std::to_string(threadCount)+
+           ", channels "+std::to_string(size())+"]";
+}
@@ -0,0 +1,297 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+#include <algorithm>
+
+#include "LEAdvertiser.hpp"
+#include "DBTAdapter.hpp"
+#include "HCIHandler.hpp"
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+constexpr uint16_t AdvertisingParameter::CONNECTABLE;
+constexpr uint16_t AdvertisingParameter::SCANNABLE;
+constexpr uint16_t AdvertisingParameter::DIRECTED;
+constexpr uint16_t AdvertisingParameter::HIGH_DUTY;
+constexpr uint16_t AdvertisingParameter::LEGACY;
+constexpr uint16_t AdvertisingParameter::ANONYMOUS;
+constexpr uint16_t AdvertisingParameter::INCL_TXPOWER;
+constexpr uint32_t AdvertisingParameter::MIN_INTERVAL;
+constexpr uint32_t AdvertisingParameter::MAX_INTERVAL;
+constexpr int AdvertisingParameter::LEGACY_MAX_DATA_LEN;
+
+std::string AdvertisingParameter::toString() const {
+    return "AdvertisingParameter[props "+uint16HexString(properties, true)+
+           ", interval ["+std::to_string(interval_min)+".."+std::to_string(interval_max)+
+           "], channels "+uint8HexString(channel_map, true)+", sid "+std::to_string(sid)+
+           ", tx "+std::to_string(tx_power)+"dBm, phy "+std::to_string(primary_phy)+"/"+std::to_string(secondary_phy)+"]";
+}
+
+LEAdvertiser::Set * LEAdvertiser::findSet(const uint8_t handle) {
+    for(Set & s : sets) {
+        if( s.handle == handle ) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+int LEAdvertiser::getMaxSets() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( 0 < maxSets ) {
+        return maxSets;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci || !hci->isLEExtAdvSupported() ) {
+        return 0;
+    }
+    uint8_t n;
+    if( HCIStatusCode::SUCCESS == hci->le_read_num_supported_adv_sets(n) ) {
+        maxSets = std::min<int>(n, 0xF0); // handle range [0x00..0xEF]
+    }
+    return maxSets;
+}
+
+int LEAdvertiser::getSetCount() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return static_cast<int>(sets.size());
+}
+
+HCIStatusCode LEAdvertiser::createSet(const AdvertisingParameter & param, uint8_t & handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( !param.isValid() ) {
+        ERR_PRINT("LEAdvertiser::createSet: invalid %s", param.toString().c_str());
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    const int max = getMaxSets();
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    if( 0 == max ) {
+        return HCIStatusCode::UNSUPPORTED_FEATURE_OR_PARAM_VALUE;
+    }
+    int h = 0;
+    while( h < max && nullptr != findSet(static_cast<uint8_t>(h)) ) {
+        h++;
+    }
+    if( h >= max ) {
+        return HCIStatusCode::LIMIT_REACHED;
+    }
+    Set s { static_cast<uint8_t>(h), false, 127, 0, 0, param };
+    const HCIStatusCode res = hci->le_set_ext_adv_params(s.handle, param.properties, param.interval_min, param.interval_max,
+                                                         param.own_address_type, param.channel_map, param.tx_power,
+                                                         param.primary_phy, param.secondary_phy, param.sid, s.selected_tx_power);
+    if( HCIStatusCode::SUCCESS != res ) {
+        return res;
+    }
+    sets.push_back(s);
+    handle = s.handle;
+    DBG_PRINT("LEAdvertiser::createSet: handle %u, %s, tx %d dBm", handle, param.toString().c_str(), s.selected_tx_power);
+    return HCIStatusCode::SUCCESS;
+}
+
+HCIStatusCode LEAdvertiser::setDataImpl(const bool scanRsp, const uint8_t handle, const uint8_t * data, const int length) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    Set * s = findSet(handle);
+    if( nullptr == s ) {
+        return HCIStatusCode::UNKNOWN_ADVERTISING_IDENTIFIER;
+    }
+    if( s->param.isLegacy() && length > AdvertisingParameter::LEGACY_MAX_DATA_LEN ) {
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    if( s->enabled && length > s->param.getMaxDataLength() ) {
+        // fragmented data is rejected by the controller while the set is enabled
+        return HCIStatusCode::COMMAND_DISALLOWED;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    return hci->le_set_ext_adv_data(scanRsp, handle, data, length);
+}
+
+HCIStatusCode LEAdvertiser::setData(const uint8_t handle, const TROOctets & data) {
+    return setDataImpl(false, handle, data.get_ptr(), data.getSize());
+}
+
+HCIStatusCode LEAdvertiser::setScanResponseData(const uint8_t handle, const TROOctets & data) {
+    return setDataImpl(true, handle, data.get_ptr(), data.getSize());
+}
+
+HCIStatusCode LEAdvertiser::enableImpl(HCIHandler & hci, Set & s, const bool enable) {
+    const HCILESetExtAdvEnableCmd::Set es { s.handle, s.duration, s.max_events };
+    const HCIStatusCode res = hci.le_enable_ext_adv(enable, &es, 1);
+    if( HCIStatusCode::SUCCESS == res ) {
+        s.enabled = enable;
+    }
+    return res;
+}
+
+HCIStatusCode LEAdvertiser::setInterval(const uint8_t handle, const uint32_t interval_min, const uint32_t interval_max) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    Set * s = findSet(handle);
+    if( nullptr == s ) {
+        return HCIStatusCode::UNKNOWN_ADVERTISING_IDENTIFIER;
+    }
+    AdvertisingParameter param = s->param;
+    param.interval_min = interval_min;
+    param.interval_max = interval_max;
+    if( !param.isValid() ) {
+        return HCIStatusCode::INVALID_HCI_COMMAND_PARAMETERS;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    const bool wasEnabled = s->enabled;
+    if( wasEnabled ) {
+        const HCIStatusCode res = enableImpl(*hci, *s, false);
+        if( HCIStatusCode::SUCCESS != res ) {
+            return res;
+        }
+    }
+    HCIStatusCode res = hci->le_set_ext_adv_params(handle, param.properties, param.interval_min, param.interval_max,
+                                                   param.own_address_type, param.channel_map, param.tx_power,
+                                                   param.primary_phy, param.secondary_phy, param.sid, s->selected_tx_power);
+    if( HCIStatusCode::SUCCESS == res ) {
+        s->param = param;
+    }
+    if( wasEnabled ) {
+        // re-enable even if the new parameter got rejected, keeping the previous interval
+        const HCIStatusCode res2 = enableImpl(*hci, *s, true);
+        if( HCIStatusCode::SUCCESS == res ) {
+            res = res2;
+        }
+    }
+    return res;
+}
+
+HCIStatusCode LEAdvertiser::setRandomAddress(const uint8_t handle, const EUI48 & address) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( nullptr == findSet(handle) ) {
+        return HCIStatusCode::UNKNOWN_ADVERTISING_IDENTIFIER;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    return hci->le_set_adv_set_random_addr(handle, address);
+}
+
+HCIStatusCode LEAdvertiser::enable(const uint8_t handle, const uint16_t duration, const uint8_t max_events) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    Set * s = findSet(handle);
+    if( nullptr == s ) {
+        return HCIStatusCode::UNKNOWN_ADVERTISING_IDENTIFIER;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    s->duration = duration;
+    s->max_events = max_events;
+    return enableImpl(*hci, *s, true);
+}
+
+HCIStatusCode LEAdvertiser::disable(const uint8_t handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    Set * s = findSet(handle);
+    if( nullptr == s ) {
+        return HCIStatusCode::UNKNOWN_ADVERTISING_IDENTIFIER;
+    }
+    if( !s->enabled ) {
+        return HCIStatusCode::SUCCESS;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    return enableImpl(*hci, *s, false);
+}
+
+bool LEAdvertiser::isEnabled(const uint8_t handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const Set * s = findSet(handle);
+    return nullptr != s && s->enabled;
+}
+
+int8_t LEAdvertiser::getSelectedTxPower(const uint8_t handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const Set * s = findSet(handle);
+    return nullptr != s ? s->selected_tx_power : 127;
+}
+
+HCIStatusCode LEAdvertiser::removeSet(const uint8_t handle) {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    HCIStatusCode res = disable(handle);
+    if( HCIStatusCode::SUCCESS != res ) {
+        return res;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    res = hci->le_remove_adv_set(handle);
+    if( HCIStatusCode::SUCCESS == res ) {
+        sets.erase(std::remove_if(sets.begin(), sets.end(), [&](const Set & s) { return s.handle == handle; }), sets.end());
+    }
+    return res;
+}
+
+HCIStatusCode LEAdvertiser::clear() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( 0 == sets.size() ) {
+        return HCIStatusCode::SUCCESS;
+    }
+    std::shared_ptr<HCIHandler> hci = adapter.getHCI();
+    if( nullptr == hci ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    // disabling w/o any set disables all sets
+    HCIStatusCode res = hci->le_enable_ext_adv(false, nullptr, 0);
+    if( HCIStatusCode::SUCCESS != res ) {
+        return res;
+    }
+    for(Set & s : sets) {
+        s.enabled = false;
+    }
+    res = hci->le_clear_adv_sets();
+    if( HCIStatusCode::SUCCESS == res ) {
+        sets.clear();
+    }
+    return res;
+}
+
+void LEAdvertiser::close() {
+    const std::lock_guard<std::recursive_mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    sets.clear();
+    maxSets = 0;
+}
@@ -268,6 +268,10 @@ MgmtEvent* MgmtEvent::getSpecialized(const uint8_t * buffer, int const buffer_si
             return new MgmtEvtDeviceUnpaired(buffer, buffer_size);
         case MgmtEvent::Opcode::LOCAL_NAME_CHANGED:
             return new MgmtEvtLocalNameChanged(buffer, buffer_size);
+        case MgmtEvent::Opcode::NEW_LONG_TERM_KEY:
+            return new MgmtEvtNewLongTermKey(buffer, buffer_size);
+        case MgmtEvent::Opcode::NEW_IRK:
+            return new MgmtEvtNewIdentityResolvingKey(buffer, buffer_size);
         default:
             return new MgmtEvent(buffer, buffer_size);
     }
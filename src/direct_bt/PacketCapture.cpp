@@ -0,0 +1,286 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include <thread>
+#include <chrono>
+
+#include <dbt_debug.hpp>
+
+#include "PacketCapture.hpp"
+#include "DBTEnv.hpp"
+#include "BasicTypes.hpp"
+
+extern "C" {
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/time.h>
+}
+
+using namespace direct_bt;
+
+/** btsnoop timestamps are in microseconds since midnight January 1st, 0 AD */
+static const uint64_t BTSNOOP_EPOCH_DELTA = 0x00dcddb30f2f8000ULL;
+static const uint32_t BTSNOOP_DATALINK_MONITOR = 2001;
+static const size_t BTSNOOP_HEADER_SIZE = 16;
+static const size_t BTSNOOP_RECORD_HEADER_SIZE = 24;
+
+static inline void put_be32(uint8_t * p, const uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24); p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >>  8); p[3] = static_cast<uint8_t>(v);
+}
+
+static inline void put_be64(uint8_t * p, const uint64_t v) {
+    put_be32(p, static_cast<uint32_t>(v >> 32));
+    put_be32(p+4, static_cast<uint32_t>(v));
+}
+
+static size_t roundUpPowerOfTwo(const size_t v) {
+    size_t r = 1;
+    while( r < v ) {
+        r <<= 1;
+    }
+    return r;
+}
+
+PacketCapture::PacketCapture(const std::string & path_, const size_t fileSize_, const int fileCount_, const size_t slotCount)
+: path(path_), fileSize(std::max(fileSize_, BTSNOOP_HEADER_SIZE + BTSNOOP_RECORD_HEADER_SIZE + SLOT_DATA_SIZE)),
+  fileCount(std::max(1, fileCount_)), slotMask(roundUpPowerOfTwo(std::max<size_t>(2, slotCount)) - 1),
+  slots(nullptr), enqueuePos(0), dequeuePos(0), dropCount(0), writeCount(0), running(false),
+  fileIndex(0), fd(-1), map(nullptr), mapUsed(0)
+{
+    if( path.empty() ) {
+        return;
+    }
+    slots = std::unique_ptr<Slot[]>( new Slot[slotMask+1] );
+    for(size_t i=0; i<=slotMask; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    if( !openFile() ) {
+        return;
+    }
+    running = true;
+    writerThread = std::thread(&PacketCapture::writerImpl, this);
+    INFO_PRINT("PacketCapture: Started to %s, %zd bytes x %d files, %zd slots", getFileName(0).c_str(), fileSize, fileCount, slotMask+1);
+}
+
+PacketCapture::~PacketCapture() {
+    stop();
+}
+
+PacketCapture& PacketCapture::get() {
+    /**
+     * Thread safe starting with C++11 6.7:
+     *
+     * If control enters the declaration concurrently while the variable is being initialized,
+     * the concurrent execution shall wait for completion of the initialization.
+     *
+     * (Magic Statics)
+     */
+    static PacketCapture pc( DBTEnv::getProperty("direct_bt.capture", ""),
+                             DBTEnv::getInt32Property("direct_bt.capture.file.size", 16*1024*1024, 64*1024 /* min */, INT32_MAX /* max */),
+                             DBTEnv::getInt32Property("direct_bt.capture.files", 4, 1 /* min */, 1000 /* max */),
+                             DBTEnv::getInt32Property("direct_bt.capture.slots", 1024, 2 /* min */, 1024*1024 /* max */) );
+    return pc;
+}
+
+std::string PacketCapture::getFileName(const int index) const {
+    return path+"."+std::to_string(index)+".btsnoop";
+}
+
+bool PacketCapture::openFile() {
+    const std::string fname = getFileName(fileIndex);
+    fd = ::open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if( 0 > fd ) {
+        ERR_PRINT("PacketCapture: Could not open %s", fname.c_str());
+        return false;
+    }
+    if( 0 != ::ftruncate(fd, fileSize) ) {
+        ERR_PRINT("PacketCapture: Could not resize %s to %zd bytes", fname.c_str(), fileSize);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    void * p = ::mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if( MAP_FAILED == p ) {
+        ERR_PRINT("PacketCapture: Could not map %s", fname.c_str());
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    map = static_cast<uint8_t*>(p);
+    memcpy(map, "btsnoop\0", 8);
+    put_be32(map+8, 1); // version
+    put_be32(map+12, BTSNOOP_DATALINK_MONITOR);
+    mapUsed = BTSNOOP_HEADER_SIZE;
+    return true;
+}
+
+void PacketCapture::closeFile() {
+    if( nullptr != map ) {
+        ::munmap(map, fileSize);
+        map = nullptr;
+    }
+    if( 0 <= fd ) {
+        if( 0 != ::ftruncate(fd, mapUsed) ) { // cut the unused remainder
+            ERR_PRINT("PacketCapture: Could not truncate %s to %zd bytes", getFileName(fileIndex).c_str(), mapUsed);
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    mapUsed = 0;
+}
+
+void PacketCapture::writeRecord(const Slot & slot) {
+    const size_t need = BTSNOOP_RECORD_HEADER_SIZE + slot.incl_len;
+    if( mapUsed + need > fileSize ) {
+        closeFile();
+        fileIndex = ( fileIndex + 1 ) % fileCount;
+        openFile();
+    }
+    if( nullptr == map ) {
+        return;
+    }
+    uint8_t * p = map + mapUsed;
+    put_be32(p, slot.orig_len);
+    put_be32(p+4, slot.incl_len);
+    put_be32(p+8, slot.flags);
+    put_be32(p+12, static_cast<uint32_t>(dropCount.load()));
+    put_be64(p+16, slot.timestamp + BTSNOOP_EPOCH_DELTA);
+    memcpy(p+BTSNOOP_RECORD_HEADER_SIZE, slot.data, slot.incl_len);
+    mapUsed += need;
+    writeCount++;
+}
+
+void PacketCapture::writerImpl() {
+    for(;;) {
+        Slot & slot = slots[dequeuePos & slotMask];
+        if( slot.sequence.load(std::memory_order_acquire) == dequeuePos + 1 ) {
+            writeRecord(slot);
+            slot.sequence.store(dequeuePos + slotMask + 1, std::memory_order_release);
+            dequeuePos++;
+        } else if( running ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        } else {
+            break; // drained
+        }
+    }
+    closeFile();
+}
+
+void PacketCapture::stop() {
+    bool expected = true;
+    if( !running.compare_exchange_strong(expected, false) ) {
+        return;
+    }
+    if( writerThread.joinable() ) {
+        writerThread.join();
+    }
+    INFO_PRINT("PacketCapture: Stopped, %" PRIu64 " packets written, %" PRIu64 " dropped", getWriteCount(), getDropCount());
+}
+
+bool PacketCapture::capture(const uint16_t index, const Opcode opcode, const uint8_t * prefix, const int prefixLen,
+                            const uint8_t * data, const int len)
+{
+    if( !running || 0 > len ) {
+        return false;
+    }
+    // Bounded multi producer queue, claiming a slot via its sequence number
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot * slot;
+    for(;;) {
+        slot = &slots[pos & slotMask];
+        const size_t seq = slot->sequence.load(std::memory_order_acquire);
+        const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if( 0 == dif ) {
+            if( enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) ) {
+                break;
+            }
+        } else if( 0 > dif ) {
+            dropCount++; // full
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    slot->timestamp = static_cast<uint64_t>(tv.tv_sec) * 1000000ULL + static_cast<uint64_t>(tv.tv_usec);
+    slot->flags = ( static_cast<uint32_t>(index) << 16 ) | static_cast<uint16_t>(opcode);
+    const int orig_len = prefixLen + len;
+    const int plen = std::min<int>(prefixLen, SLOT_DATA_SIZE);
+    const int dlen = std::min<int>(len, SLOT_DATA_SIZE - plen);
+    memcpy(slot->data, prefix, plen);
+    memcpy(slot->data + plen, data, dlen);
+    slot->orig_len = orig_len;
+    slot->incl_len = plen + dlen;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void PacketCapture::captureHCI(const uint16_t dev_id, const uint8_t * buffer, const int len, const bool incoming) {
+    if( !running || 1 > len ) {
+        return;
+    }
+    Opcode opc;
+    switch( buffer[0] ) {
+        case 0x01: opc = Opcode::COMMAND_PKT; break; // HCI_COMMAND_PKT
+        case 0x02: opc = incoming ? Opcode::ACL_RX_PKT : Opcode::ACL_TX_PKT; break; // HCI_ACLDATA_PKT
+        case 0x04: opc = Opcode::EVENT_PKT; break; // HCI_EVENT_PKT
+        default: return; // not captured
+    }
+    capture(dev_id, opc, nullptr, 0, buffer + 1, len - 1);
+}
+
+void PacketCapture::captureMgmt(const uint8_t * buffer, const int len, const bool incoming) {
+    if( !running || 6 > len ) {
+        return;
+    }
+    // Monitor control packets: cookie, opcode and parameter, w/o the Mgmt index and length
+    const uint8_t prefix[] = { 0, 0, 0, 0, buffer[0], buffer[1] };
+    const uint16_t index = get_uint16(buffer, 2, true /* littleEndian */);
+    capture(index, incoming ? Opcode::CTRL_EVENT : Opcode::CTRL_COMMAND, prefix, sizeof(prefix), buffer + 6, len - 6);
+}
+
+void PacketCapture::captureL2CAP(const uint16_t dev_id, const uint16_t handle, const uint16_t cid,
+                                 const uint8_t * buffer, const int len, const bool incoming)
+{
+    if( !running || 0 > len ) {
+        return;
+    }
+    uint8_t prefix[8];
+    put_uint16(prefix, 0, ( handle & 0x0fff ) | 0x2000 /* first automatically flushable */, true /* littleEndian */);
+    put_uint16(prefix, 2, static_cast<uint16_t>(4 + len), true /* littleEndian */);
+    put_uint16(prefix, 4, static_cast<uint16_t>(len), true /* littleEndian */);
+    put_uint16(prefix, 6, cid, true /* littleEndian */);
+    capture(dev_id, incoming ? Opcode::ACL_RX_PKT : Opcode::ACL_TX_PKT, prefix, sizeof(prefix), buffer, len);
+}
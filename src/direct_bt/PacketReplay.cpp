@@ -0,0 +1,399 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+
+#include <thread>
+#include <chrono>
+
+#include <dbt_debug.hpp>
+
+#include "PacketReplay.hpp"
+#include "PacketCapture.hpp"
+#include "HCIComm.hpp"
+#include "L2CAPComm.hpp"
+#include "BasicTypes.hpp"
+
+extern "C" {
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+}
+
+using namespace direct_bt;
+
+static const uint32_t BTSNOOP_DATALINK_MONITOR = 2001;
+static const size_t BTSNOOP_HEADER_SIZE = 16;
+static const size_t BTSNOOP_RECORD_HEADER_SIZE = 24;
+
+/** Largest packet read from the host, covers HCI commands and an ATT PDU of maximum MTU */
+static const size_t MAX_PACKET_SIZE = 1024;
+
+static const uint8_t ATT_ERROR_RSP = 0x01;
+static const uint8_t ATT_EXCHANGE_MTU_REQ = 0x02;
+static const uint8_t ATT_EXCHANGE_MTU_RSP = 0x03;
+static const uint8_t ATT_HANDLE_VALUE_NTF = 0x1b;
+static const uint8_t ATT_HANDLE_VALUE_IND = 0x1d;
+static const uint8_t ATT_HANDLE_VALUE_CFM = 0x1e;
+static const uint8_t ATT_COMMAND_FLAG = 0x40;
+static const uint8_t ATT_REQUEST_NOT_SUPPORTED = 0x06;
+
+/** The started replay, served by the static transport functions */
+static std::atomic<PacketReplay*> activeReplay( nullptr );
+
+static inline uint32_t get_be32(const uint8_t * p) {
+    return ( static_cast<uint32_t>(p[0]) << 24 ) | ( static_cast<uint32_t>(p[1]) << 16 ) |
+           ( static_cast<uint32_t>(p[2]) <<  8 ) |   static_cast<uint32_t>(p[3]);
+}
+
+static inline uint64_t get_be64(const uint8_t * p) {
+    return ( static_cast<uint64_t>(get_be32(p)) << 32 ) | get_be32(p+4);
+}
+
+/** Sends one packet w/o raising SIGPIPE if the host end has been closed. */
+static bool sendPacket(const int fd, const uint8_t * prefix, const int prefixLen, const uint8_t * data, const int len) {
+    if( 0 > fd ) {
+        return false;
+    }
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<uint8_t*>(prefix);
+    iov[0].iov_len = prefixLen;
+    iov[1].iov_base = const_cast<uint8_t*>(data);
+    iov[1].iov_len = len;
+    struct msghdr msg;
+    bzero((void*)&msg, sizeof(msg));
+    msg.msg_iov = 0 < prefixLen ? iov : iov + 1;
+    msg.msg_iovlen = 0 < prefixLen ? 2 : 1;
+    ssize_t res;
+    while( ( res = ::sendmsg(fd, &msg, MSG_NOSIGNAL) ) < 0 ) {
+        if( EINTR == errno ) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+static int openChannel(std::atomic<int> & replayFD) {
+    int fds[2];
+    if( 0 > ::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) ) {
+        ERR_PRINT("PacketReplay: socketpair failed");
+        return -1;
+    }
+    const int old = replayFD.exchange(fds[1]);
+    if( 0 <= old ) {
+        ::shutdown(old, SHUT_RDWR);
+        ::close(old);
+    }
+    return fds[0];
+}
+
+static void closeChannel(std::atomic<int> & replayFD) {
+    const int old = replayFD.exchange(-1);
+    if( 0 <= old ) {
+        ::shutdown(old, SHUT_RDWR);
+        ::close(old);
+    }
+}
+
+PacketReplay::PacketReplay(const std::string & path_, const double speed_, const uint16_t dev_id_, const uint16_t traceIndex_)
+: path(path_), speed(speed_), dev_id(dev_id_), traceIndex(traceIndex_),
+  fd(-1), map(nullptr), mapSize(0), hciFD(-1), attFD(-1), running(false), done(false),
+  hciCount(0), attCount(0), skipCount(0)
+{
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if( 0 > fd ) {
+        ERR_PRINT("PacketReplay: Could not open %s", path.c_str());
+        return;
+    }
+    const off_t size = ::lseek(fd, 0, SEEK_END);
+    if( 0 > size || BTSNOOP_HEADER_SIZE > static_cast<size_t>(size) ) {
+        ERR_PRINT("PacketReplay: Invalid size of %s", path.c_str());
+        return;
+    }
+    void * p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if( MAP_FAILED == p ) {
+        ERR_PRINT("PacketReplay: Could not map %s", path.c_str());
+        return;
+    }
+    const uint8_t * header = static_cast<const uint8_t*>(p);
+    if( 0 != memcmp(header, "btsnoop\0", 8) || BTSNOOP_DATALINK_MONITOR != get_be32(header+12) ) {
+        ERR_PRINT("PacketReplay: Not a btsnoop monitor trace: %s", path.c_str());
+        ::munmap(p, size);
+        return;
+    }
+    map = static_cast<uint8_t*>(p);
+    mapSize = size;
+    (void)::madvise(map, mapSize, MADV_SEQUENTIAL);
+}
+
+PacketReplay::~PacketReplay() {
+    stop();
+    if( nullptr != map ) {
+        ::munmap(map, mapSize);
+        map = nullptr;
+    }
+    if( 0 <= fd ) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+int PacketReplay::openHCI(const uint16_t dev_id, const uint16_t channel) {
+    PacketReplay * r = activeReplay;
+    if( nullptr == r || dev_id != r->dev_id || HCI_CHANNEL_RAW != channel ) {
+        errno = ENODEV;
+        return -1;
+    }
+    const int res = openChannel(r->hciFD);
+    {
+        std::unique_lock<std::mutex> lock(r->mtx_state); // RAII-style acquire and relinquish via destructor
+        r->cv_state.notify_all();
+    }
+    return res;
+}
+
+int PacketReplay::connectL2CAP(const DBTDevice & device, const uint16_t psm, const uint16_t cid) {
+    (void)device;
+    (void)psm;
+    PacketReplay * r = activeReplay;
+    if( nullptr == r || L2CAP_CID_ATT != cid ) {
+        errno = ECONNREFUSED;
+        return -1;
+    }
+    return openChannel(r->attFD);
+}
+
+bool PacketReplay::start() {
+    if( !isValid() ) {
+        return false;
+    }
+    PacketReplay * expected = nullptr;
+    if( !activeReplay.compare_exchange_strong(expected, this) ) {
+        ERR_PRINT("PacketReplay::start: Another replay is running");
+        return false;
+    }
+    done = false;
+    running = true;
+    HCIComm::setTransport(openHCI);
+    L2CAPComm::setTransport(connectL2CAP);
+    responderThread = std::thread(&PacketReplay::responderImpl, this);
+    replayThread = std::thread(&PacketReplay::replayImpl, this);
+    return true;
+}
+
+void PacketReplay::stop() {
+    bool expected = true;
+    if( !running.compare_exchange_strong(expected, false) ) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx_state); // RAII-style acquire and relinquish via destructor
+        cv_state.notify_all();
+    }
+    // unblock pending writes to a stalled reader
+    const int h = hciFD, a = attFD;
+    if( 0 <= h ) { ::shutdown(h, SHUT_RDWR); }
+    if( 0 <= a ) { ::shutdown(a, SHUT_RDWR); }
+
+    if( replayThread.joinable() ) {
+        replayThread.join();
+    }
+    if( responderThread.joinable() ) {
+        responderThread.join();
+    }
+    HCIComm::setTransport(nullptr);
+    L2CAPComm::setTransport(nullptr);
+    closeChannel(hciFD);
+    closeChannel(attFD);
+    activeReplay = nullptr;
+    INFO_PRINT("PacketReplay: Stopped %s, %" PRIu64 " HCI events, %" PRIu64 " ATT PDUs, %" PRIu64 " skipped",
+            path.c_str(), getHCICount(), getATTCount(), getSkipCount());
+}
+
+bool PacketReplay::waitUntilDone(const int32_t timeoutMS) {
+    std::unique_lock<std::mutex> lock(mtx_state); // RAII-style acquire and relinquish via destructor
+    if( 0 < timeoutMS ) {
+        cv_state.wait_for(lock, std::chrono::milliseconds(timeoutMS), [&]{ return done.load() || !running; });
+    } else {
+        cv_state.wait(lock, [&]{ return done.load() || !running; });
+    }
+    return done;
+}
+
+void PacketReplay::replayImpl() {
+    {
+        std::unique_lock<std::mutex> lock(mtx_state); // RAII-style acquire and relinquish via destructor
+        cv_state.wait(lock, [&]{ return 0 <= hciFD || !running; });
+    }
+    const uint8_t hciPrefix[] = { 0x04 }; // HCI_EVENT_PKT
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    uint64_t ts0 = 0;
+    bool first = true;
+    size_t pos = BTSNOOP_HEADER_SIZE;
+
+    while( running && pos + BTSNOOP_RECORD_HEADER_SIZE <= mapSize ) {
+        const uint8_t * rec = map + pos;
+        const uint32_t incl_len = get_be32(rec+4);
+        const uint32_t flags = get_be32(rec+8);
+        const uint64_t ts = get_be64(rec+16); // microseconds
+        const uint8_t * data = rec + BTSNOOP_RECORD_HEADER_SIZE;
+        if( pos + BTSNOOP_RECORD_HEADER_SIZE + incl_len > mapSize ) {
+            WARN_PRINT("PacketReplay: Truncated record at %zd of %s", pos, path.c_str());
+            break;
+        }
+        pos += BTSNOOP_RECORD_HEADER_SIZE + incl_len;
+
+        const uint16_t index = static_cast<uint16_t>( flags >> 16 );
+        const PacketCapture::Opcode opc = static_cast<PacketCapture::Opcode>( flags & 0xffff );
+        if( ( INDEX_ANY != traceIndex && index != traceIndex ) ||
+            ( PacketCapture::Opcode::EVENT_PKT != opc && PacketCapture::Opcode::ACL_RX_PKT != opc ) ) {
+            continue;
+        }
+        if( 0 < speed ) {
+            if( first ) {
+                ts0 = ts;
+                first = false;
+            }
+            const uint64_t td_us = static_cast<uint64_t>( static_cast<double>(ts - ts0) / speed );
+            std::this_thread::sleep_until(t0 + std::chrono::microseconds(td_us));
+        }
+        if( PacketCapture::Opcode::EVENT_PKT == opc ) {
+            if( 1 > incl_len || HCI_EV_CMD_COMPLETE == data[0] || HCI_EV_CMD_STATUS == data[0] ) {
+                skipCount++; // solicited, answered by responderImpl()
+            } else if( sendPacket(hciFD, hciPrefix, sizeof(hciPrefix), data, incl_len) ) {
+                hciCount++;
+            } else {
+                skipCount++;
+            }
+        } else {
+            // ACL header (4) and L2CAP basic header (4), ATT channel only
+            if( 9 > incl_len || L2CAP_CID_ATT != get_uint16(data, 6, true /* littleEndian */) ||
+                ( ATT_HANDLE_VALUE_NTF != data[8] && ATT_HANDLE_VALUE_IND != data[8] ) )
+            {
+                skipCount++;
+            } else if( sendPacket(attFD, nullptr, 0, data + 8, incl_len - 8) ) {
+                attCount++;
+            } else {
+                skipCount++;
+            }
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(mtx_state); // RAII-style acquire and relinquish via destructor
+        done = true;
+        cv_state.notify_all();
+    }
+    DBG_PRINT("PacketReplay: Done %s, %" PRIu64 " HCI events, %" PRIu64 " ATT PDUs, %" PRIu64 " skipped",
+            path.c_str(), getHCICount(), getATTCount(), getSkipCount());
+}
+
+void PacketReplay::respondHCI(const uint8_t * buffer, const int len) {
+    if( 4 > len || 0x01 != buffer[0] ) { // HCI_COMMAND_PKT
+        return;
+    }
+    const uint16_t opc = get_uint16(buffer, 1, true /* littleEndian */);
+    switch( opc ) {
+        case 0x0405: // CREATE_CONN
+        case 0x0406: // DISCONNECT
+        case 0x200D: // LE_CREATE_CONN
+        case 0x2013: // LE_CONN_UPDATE
+        case 0x2032: // LE_SET_PHY
+        {
+            const uint8_t ev[] = { 0x04, HCI_EV_CMD_STATUS, 4, 0x00 /* status */, 0x01 /* ncmd */, buffer[1], buffer[2] };
+            sendPacket(hciFD, nullptr, 0, ev, sizeof(ev));
+            break;
+        }
+        default:
+        {
+            // ncmd, opcode, status and zeroed return parameter of the largest fixed size replies
+            uint8_t ev[3+4+64];
+            bzero(ev, sizeof(ev));
+            ev[0] = 0x04;
+            ev[1] = HCI_EV_CMD_COMPLETE;
+            ev[2] = sizeof(ev) - 3;
+            ev[3] = 0x01;
+            ev[4] = buffer[1];
+            ev[5] = buffer[2];
+            sendPacket(hciFD, nullptr, 0, ev, sizeof(ev));
+            break;
+        }
+    }
+}
+
+void PacketReplay::respondATT(const uint8_t * buffer, const int len) {
+    if( 1 > len ) {
+        return;
+    }
+    const uint8_t opc = buffer[0];
+    if( ATT_EXCHANGE_MTU_REQ == opc && 3 <= len ) {
+        const uint8_t rsp[] = { ATT_EXCHANGE_MTU_RSP, buffer[1], buffer[2] };
+        sendPacket(attFD, nullptr, 0, rsp, sizeof(rsp));
+    } else if( 0 == ( opc & ATT_COMMAND_FLAG ) && ATT_HANDLE_VALUE_CFM != opc ) {
+        const uint8_t handle_lo = 3 <= len ? buffer[1] : 0;
+        const uint8_t handle_hi = 3 <= len ? buffer[2] : 0;
+        const uint8_t rsp[] = { ATT_ERROR_RSP, opc, handle_lo, handle_hi, ATT_REQUEST_NOT_SUPPORTED };
+        sendPacket(attFD, nullptr, 0, rsp, sizeof(rsp));
+    }
+}
+
+void PacketReplay::responderImpl() {
+    uint8_t buffer[MAX_PACKET_SIZE];
+    while( running ) {
+        struct pollfd p[2];
+        const int fds[2] = { hciFD, attFD };
+        int n = 0;
+        for(int i=0; i<2; i++) {
+            p[i].fd = fds[i]; // negative descriptors are ignored by poll
+            p[i].events = POLLIN;
+            p[i].revents = 0;
+        }
+        n = ::poll(p, 2, 50 /* ms, picking up new channels */);
+        if( 0 >= n ) {
+            continue;
+        }
+        for(int i=0; i<2; i++) {
+            if( 0 == ( p[i].revents & POLLIN ) ) {
+                continue;
+            }
+            const ssize_t len = ::recv(fds[i], buffer, sizeof(buffer), MSG_DONTWAIT);
+            if( 0 >= len ) {
+                continue;
+            }
+            if( 0 == i ) {
+                respondHCI(buffer, static_cast<int>(len));
+            } else {
+                respondATT(buffer, static_cast<int>(len));
+            }
+        }
+    }
+}
@@ -0,0 +1,259 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include <algorithm>
+
+#include "PeriodicAdvSync.hpp"
+#include "HCIIoctl.hpp"
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+constexpr int PeriodicAdvSyncTable::MAX_DATA_LEN;
+
+std::string PeriodicAdvSyncInfo::toString() const {
+    return "PeriodicAdvSync[handle "+uint16HexString(handle, true)+", sid "+std::to_string(sid)+
+           ", address["+address.toString()+", type "+std::to_string(ad_address_type)+
+           "], phy "+std::to_string(phy)+", interval "+std::to_string(interval)+"]";
+}
+
+bool PeriodicAdvSyncTable::beginCreate(const uint8_t sid, const uint8_t ad_address_type, const EUI48 & address,
+                                       const std::shared_ptr<PeriodicAdvSyncListener> & listener)
+{
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( nullptr != pending ) {
+        return false;
+    }
+    pending = std::make_shared<Entry>(fragmentCapacity);
+    pending->info.sid = sid;
+    pending->info.ad_address_type = ad_address_type;
+    pending->info.address = address;
+    pending->listener = listener;
+    pendingDone = false;
+    pendingStatus = HCIStatusCode::UNKNOWN;
+    return true;
+}
+
+HCIStatusCode PeriodicAdvSyncTable::awaitCreate(const int32_t timeoutMS, uint16_t & handle) {
+    std::unique_lock<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( nullptr == pending ) {
+        return HCIStatusCode::INTERNAL_FAILURE;
+    }
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    while( !pendingDone ) {
+        if( std::cv_status::timeout == cv.wait_until(lock, t0 + std::chrono::milliseconds(timeoutMS)) && !pendingDone ) {
+            return HCIStatusCode::INTERNAL_TIMEOUT;
+        }
+    }
+    handle = pending->info.handle;
+    return pendingStatus;
+}
+
+void PeriodicAdvSyncTable::endCreate() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    pending = nullptr;
+    pendingDone = false;
+}
+
+bool PeriodicAdvSyncTable::remove(const uint16_t handle) {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return 0 < syncs.erase(handle);
+}
+
+void PeriodicAdvSyncTable::clear() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    syncs.clear();
+    if( nullptr != pending && !pendingDone ) {
+        pendingStatus = HCIStatusCode::INTERNAL_FAILURE;
+        pendingDone = true;
+        cv.notify_all();
+    }
+}
+
+int PeriodicAdvSyncTable::size() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return static_cast<int>(syncs.size());
+}
+
+std::vector<PeriodicAdvSyncInfo> PeriodicAdvSyncTable::getSyncs() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    std::vector<PeriodicAdvSyncInfo> res;
+    res.reserve(syncs.size());
+    for(auto it = syncs.begin(); it != syncs.end(); ++it) {
+        res.push_back(it->second->info);
+    }
+    return res;
+}
+
+std::shared_ptr<PeriodicAdvSyncTable::Entry> PeriodicAdvSyncTable::find(const uint16_t handle) {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    auto it = syncs.find(handle);
+    return it != syncs.end() ? it->second : nullptr;
+}
+
+void PeriodicAdvSyncTable::processSyncEstablished(const uint8_t * data, const int data_length) {
+    if( static_cast<int>( sizeof(hci_ev_le_pa_sync_established) ) > data_length ) {
+        WARN_PRINT("PeriodicAdvSyncTable::processSyncEstablished: Incomplete event of %d bytes", data_length);
+        return;
+    }
+    const hci_ev_le_pa_sync_established * ev = reinterpret_cast<const hci_ev_le_pa_sync_established *>(data);
+    const HCIStatusCode status = static_cast<HCIStatusCode>(ev->status);
+    const uint16_t handle = le_to_cpu(ev->handle);
+
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( nullptr == pending || pendingDone ) {
+        if( HCIStatusCode::SUCCESS == status ) {
+            WARN_PRINT("PeriodicAdvSyncTable::processSyncEstablished: Unrequested sync handle %s of %s",
+                    uint16HexString(handle, true).c_str(), ev->bdaddr.toString().c_str());
+        }
+        return;
+    }
+    if( HCIStatusCode::SUCCESS == status ) {
+        pending->info.handle = handle;
+        pending->info.sid = ev->sid;
+        pending->info.ad_address_type = ev->bdaddr_type;
+        pending->info.address = ev->bdaddr;
+        pending->info.phy = ev->phy;
+        pending->info.interval = le_to_cpu(ev->interval);
+        // route reports following in the same read batch
+        syncs[handle] = pending;
+    }
+    pendingStatus = status;
+    pendingDone = true;
+    cv.notify_all();
+}
+
+void PeriodicAdvSyncTable::processReport(const uint8_t * data, const int data_length, const uint64_t timestamp) {
+    const int report_hdr_size = sizeof(hci_ev_le_per_adv_report);
+    if( report_hdr_size > data_length ) {
+        WARN_PRINT("PeriodicAdvSyncTable::processReport: Incomplete report header within %d bytes", data_length);
+        return;
+    }
+    const hci_ev_le_per_adv_report * r = reinterpret_cast<const hci_ev_le_per_adv_report *>(data);
+    if( report_hdr_size + r->length > data_length ) {
+        WARN_PRINT("PeriodicAdvSyncTable::processReport: Incomplete report data %d within %d bytes", r->length, data_length);
+        return;
+    }
+    std::shared_ptr<Entry> e = find( le_to_cpu(r->sync_handle) );
+    if( nullptr == e ) {
+        return; // terminated or unknown sync
+    }
+    const uint8_t * ad_data = data + report_hdr_size;
+    int ad_length = r->length;
+
+    // 0x00 complete, 0x01 incomplete w/ more data to come, 0x02 incomplete and truncated
+    if( 0x01 == r->data_status || e->fragmentPending ) {
+        if( !e->fragmentPending ) {
+            e->fragment.resize(0);
+            e->fragmentPending = true;
+        }
+        const int size = e->fragment.getSize();
+        const int append = std::min<int>(ad_length, e->fragment.getCapacity() - size);
+        if( append < ad_length ) {
+            WARN_PRINT("PeriodicAdvSyncTable::processReport: Truncated fragmented data of %s at %d bytes",
+                    e->info.toString().c_str(), e->fragment.getCapacity());
+        }
+        e->fragment.resize(size + append);
+        memcpy(e->fragment.get_wptr() + size, ad_data, append);
+        if( 0x01 == r->data_status ) {
+            return; // more data to come
+        }
+        e->fragmentPending = false;
+        ad_data = e->fragment.get_ptr();
+        ad_length = e->fragment.getSize();
+    }
+
+    std::shared_ptr<EInfoReport> eir(new EInfoReport());
+    eir->setSource(EInfoReport::Source::AD);
+    eir->setTimestamp(timestamp);
+    eir->setEvtType(AD_PDU_Type::ADV_NONCONN_IND);
+    eir->setADAddressType(e->info.ad_address_type);
+    eir->setAddress(e->info.address);
+    if( 127 != r->rssi ) {
+        eir->setRSSI(r->rssi);
+    }
+    if( 127 != r->tx_power ) {
+        eir->setTxPower(r->tx_power);
+    }
+    eir->read_data(ad_data, ad_length);
+
+    if( 0 == e->batch.size() ) {
+        dirty.push_back(e);
+    }
+    e->batch.push_back(eir);
+}
+
+void PeriodicAdvSyncTable::processSyncLost(const uint8_t * data, const int data_length) {
+    if( static_cast<int>( sizeof(hci_ev_le_pa_sync_lost) ) > data_length ) {
+        WARN_PRINT("PeriodicAdvSyncTable::processSyncLost: Incomplete event of %d bytes", data_length);
+        return;
+    }
+    const hci_ev_le_pa_sync_lost * ev = reinterpret_cast<const hci_ev_le_pa_sync_lost *>(data);
+    std::shared_ptr<Entry> e;
+    {
+        const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+        auto it = syncs.find( le_to_cpu(ev->handle) );
+        if( it == syncs.end() ) {
+            return;
+        }
+        e = it->second;
+        syncs.erase(it);
+    }
+    // deliver the reports received before losing the sync
+    flush(*e);
+    try {
+        e->listener->periodicAdvSyncLost(e->info);
+    } catch (std::exception &ex) {
+        ERR_PRINT("PeriodicAdvSyncTable::processSyncLost: %s: Caught exception %s", e->info.toString().c_str(), ex.what());
+    }
+}
+
+void PeriodicAdvSyncTable::flush(Entry & e) {
+    if( 0 == e.batch.size() ) {
+        return;
+    }
+    EInfoReportBatch batch;
+    batch.swap(e.batch);
+    try {
+        e.listener->periodicAdvReports(e.info, batch);
+    } catch (std::exception &ex) {
+        ERR_PRINT("PeriodicAdvSyncTable::flush: %s: Caught exception %s", e.info.toString().c_str(), ex.what());
+    }
+}
+
+void PeriodicAdvSyncTable::flush() {
+    if( 0 == dirty.size() ) {
+        return;
+    }
+    for(auto it = dirty.begin(); it != dirty.end(); ++it) {
+        flush(**it);
+    }
+    dirty.clear();
+}
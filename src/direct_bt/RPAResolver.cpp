@@ -0,0 +1,261 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <vector>
+
+#include  <algorithm>
+
+#if defined(__AES__)
+    #include <wmmintrin.h>
+#elif defined(__ARM_FEATURE_CRYPTO)
+    #include <arm_neon.h>
+#endif
+
+#include "RPAResolver.hpp"
+
+#include "dbt_debug.hpp"
+
+using namespace direct_bt;
+
+namespace {
+    const uint8_t sbox[256] = {
+        0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+        0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+        0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+        0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+        0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+        0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+        0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+        0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+        0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+        0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+        0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+        0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+        0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+        0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+        0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+        0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+    };
+
+    inline uint8_t xtime(const uint8_t v) {
+        return static_cast<uint8_t>( ( v << 1 ) ^ ( ( v & 0x80 ) ? 0x1b : 0x00 ) );
+    }
+
+#if !defined(__AES__) && !defined(__ARM_FEATURE_CRYPTO)
+    /** SubBytes and ShiftRows of the column-major state */
+    inline void subShift(uint8_t s[AES128::BLOCK_SIZE]) {
+        uint8_t t[AES128::BLOCK_SIZE];
+        for(int c=0; c<4; c++) {
+            for(int r=0; r<4; r++) {
+                t[c*4+r] = sbox[ s[ ( ( c + r ) % 4 ) * 4 + r ] ];
+            }
+        }
+        memcpy(s, t, sizeof(t));
+    }
+
+    inline void mixColumns(uint8_t s[AES128::BLOCK_SIZE]) {
+        for(int c=0; c<4; c++) {
+            uint8_t * a = s + c*4;
+            const uint8_t a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+            const uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+            a[0] = a0 ^ all ^ xtime(a0 ^ a1);
+            a[1] = a1 ^ all ^ xtime(a1 ^ a2);
+            a[2] = a2 ^ all ^ xtime(a2 ^ a3);
+            a[3] = a3 ^ all ^ xtime(a3 ^ a0);
+        }
+    }
+
+    inline void addRoundKey(uint8_t s[AES128::BLOCK_SIZE], const uint8_t * rk) {
+        for(int i=0; i<AES128::BLOCK_SIZE; i++) {
+            s[i] ^= rk[i];
+        }
+    }
+#endif
+}
+
+AES128::AES128(const uint8_t key[BLOCK_SIZE]) {
+    memcpy(roundKeys, key, BLOCK_SIZE);
+    uint8_t rcon = 0x01;
+    for(int i = 4; i < 4*(ROUNDS+1); i++) {
+        uint8_t t[4];
+        memcpy(t, roundKeys + (i-1)*4, 4);
+        if( 0 == i % 4 ) {
+            const uint8_t t0 = t[0];
+            t[0] = sbox[t[1]] ^ rcon;
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[t0];
+            rcon = xtime(rcon);
+        }
+        for(int j=0; j<4; j++) {
+            roundKeys[i*4+j] = roundKeys[(i-4)*4+j] ^ t[j];
+        }
+    }
+}
+
+void AES128::encrypt(const uint8_t in[BLOCK_SIZE], uint8_t out[BLOCK_SIZE]) const {
+#if defined(__AES__)
+    __m128i s = _mm_xor_si128( _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)),
+                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys)) );
+    for(int r=1; r<ROUNDS; r++) {
+        s = _mm_aesenc_si128(s, _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + r*BLOCK_SIZE)));
+    }
+    s = _mm_aesenclast_si128(s, _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + ROUNDS*BLOCK_SIZE)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), s);
+#elif defined(__ARM_FEATURE_CRYPTO)
+    uint8x16_t s = vld1q_u8(in);
+    for(int r=0; r<ROUNDS-1; r++) {
+        s = vaesmcq_u8( vaeseq_u8(s, vld1q_u8(roundKeys + r*BLOCK_SIZE)) );
+    }
+    s = vaeseq_u8(s, vld1q_u8(roundKeys + (ROUNDS-1)*BLOCK_SIZE));
+    s = veorq_u8(s, vld1q_u8(roundKeys + ROUNDS*BLOCK_SIZE));
+    vst1q_u8(out, s);
+#else
+    uint8_t s[BLOCK_SIZE];
+    memcpy(s, in, BLOCK_SIZE);
+    addRoundKey(s, roundKeys);
+    for(int r=1; r<ROUNDS; r++) {
+        subShift(s);
+        mixColumns(s);
+        addRoundKey(s, roundKeys + r*BLOCK_SIZE);
+    }
+    subShift(s);
+    addRoundKey(s, roundKeys + ROUNDS*BLOCK_SIZE);
+    memcpy(out, s, BLOCK_SIZE);
+#endif
+}
+
+bool AES128::isAccelerated() {
+#if defined(__AES__) || defined(__ARM_FEATURE_CRYPTO)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t RPAResolver::ah(const AES128 & cipher, const uint32_t prand) {
+    // r' = padding || r, most significant octet first
+    uint8_t r[AES128::BLOCK_SIZE] = { 0 };
+    r[13] = static_cast<uint8_t>( prand >> 16 );
+    r[14] = static_cast<uint8_t>( prand >>  8 );
+    r[15] = static_cast<uint8_t>( prand       );
+    cipher.encrypt(r, r);
+    return ( static_cast<uint32_t>(r[13]) << 16 ) | ( static_cast<uint32_t>(r[14]) << 8 ) | r[15];
+}
+
+AES128 RPAResolver::createCipher(const uint8_t irk[AES128::BLOCK_SIZE]) {
+    uint8_t key[AES128::BLOCK_SIZE];
+    for(int i=0; i<AES128::BLOCK_SIZE; i++) {
+        key[i] = irk[AES128::BLOCK_SIZE-1-i];
+    }
+    return AES128(key);
+}
+
+void RPAResolver::add(const MgmtIdentityResolvingKeyInfo & key) {
+    const BDAddressKey identity(key.address, static_cast<BDAddressType>(key.address_type));
+    const AES128 cipher = createCipher(key.irk);
+    const std::lock_guard<std::mutex> lock(mtx_irks); // RAII-style acquire and relinquish via destructor
+    irks.erase(std::remove_if(irks.begin(), irks.end(), [&](const IRKEntry & e) { return e.identity == identity; }), irks.end());
+    irks.push_back(IRKEntry(identity, cipher));
+    cache.clear(); // previously unresolvable RPAs may resolve now, indices changed
+}
+
+bool RPAResolver::remove(const EUI48 & address, const BDAddressType addressType) {
+    const BDAddressKey identity(address, addressType);
+    const std::lock_guard<std::mutex> lock(mtx_irks); // RAII-style acquire and relinquish via destructor
+    const size_t size = irks.size();
+    irks.erase(std::remove_if(irks.begin(), irks.end(), [&](const IRKEntry & e) { return e.identity == identity; }), irks.end());
+    if( irks.size() == size ) {
+        return false;
+    }
+    cache.clear();
+    return true;
+}
+
+void RPAResolver::clear() {
+    const std::lock_guard<std::mutex> lock(mtx_irks); // RAII-style acquire and relinquish via destructor
+    irks.clear();
+    cache.clear();
+}
+
+size_t RPAResolver::size() const {
+    const std::lock_guard<std::mutex> lock(mtx_irks); // RAII-style acquire and relinquish via destructor
+    return irks.size();
+}
+
+bool RPAResolver::resolve(const EUI48 & address, const BDAddressType addressType, BDAddressKey & identity) {
+    if( !isResolvablePrivateAddress(address, addressType) ) {
+        return false;
+    }
+    const std::lock_guard<std::mutex> lock(mtx_irks); // RAII-style acquire and relinquish via destructor
+    if( 0 == irks.size() ) {
+        return false;
+    }
+    int idx;
+    auto it = cache.find(address);
+    if( cache.end() != it ) {
+        idx = it->second;
+    } else {
+        // RPA = prand (most significant 24 bits) || hash (least significant 24 bits), EUI48 is little endian
+        const uint32_t hash  = address.b[0] | ( address.b[1] << 8 ) | ( address.b[2] << 16 );
+        const uint32_t prand = address.b[3] | ( address.b[4] << 8 ) | ( address.b[5] << 16 );
+        idx = -1;
+        for(size_t i=0; i<irks.size(); i++) {
+            if( hash == ah(irks[i].cipher, prand) ) {
+                idx = i;
+                break;
+            }
+        }
+        if( cache.size() >= CACHE_CAPACITY ) {
+            cache.clear();
+        }
+        cache[address] = idx;
+        if( 0 <= idx ) {
+            irks[idx].lastRPA = address;
+            DBG_PRINT("RPAResolver::resolve: %s -> %s", address.toString().c_str(), irks[idx].identity.address.toString().c_str());
+        }
+    }
+    if( 0 > idx ) {
+        return false;
+    }
+    identity = irks[idx].identity;
+    return true;
+}
+
+bool RPAResolver::getPrivateAddress(const EUI48 & address, const BDAddressType addressType, EUI48 & rpa) const {
+    const BDAddressKey identity(address, addressType);
+    const std::lock_guard<std::mutex> lock(mtx_irks); // RAII-style acquire and relinquish via destructor
+    for(const IRKEntry & e : irks) {
+        if( e.identity == identity && EUI48_ANY_DEVICE != e.lastRPA ) {
+            rpa = e.lastRPA;
+            return true;
+        }
+    }
+    return false;
+}
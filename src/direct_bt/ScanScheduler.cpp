@@ -0,0 +1,85 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+
+#include  <algorithm>
+
+#include "ScanScheduler.hpp"
+#include "DBTEnv.hpp"
+
+using namespace direct_bt;
+
+constexpr uint16_t ScanParameter::MIN_VALUE;
+constexpr uint16_t ScanParameter::MAX_VALUE;
+
+std::string ScanParameter::toString() const {
+    return "ScanParameter["+std::string(active ? "active" : "passive")+", interval "+std::to_string(interval)+
+           ", window "+std::to_string(window)+", duty "+std::to_string(getDutyCycle())+"%]";
+}
+
+ScanScheduler::ScanScheduler()
+: DUTY_CYCLE_MAX( DBTEnv::getInt32Property("direct_bt.adapter.scan.duty.max", 100, 1 /* min */, 100 /* max */) ),
+  DUTY_CYCLE_MIN( DBTEnv::getInt32Property("direct_bt.adapter.scan.duty.min", 10, 1 /* min */, 100 /* max */) ),
+  DUTY_CYCLE_PER_CONNECTION( DBTEnv::getInt32Property("direct_bt.adapter.scan.duty.conn", 0, 0 /* min */, 100 /* max */) ),
+  PASSIVE_WHEN_CONNECTED( DBTEnv::getBooleanProperty("direct_bt.adapter.scan.passive.conn", false) ),
+  PAUSE_ON_CONNECT( DBTEnv::getBooleanProperty("direct_bt.adapter.scan.pause", false) )
+{ }
+
+ScanScheduler::ScanScheduler(const int32_t dutyCycleMax, const int32_t dutyCycleMin, const int32_t dutyCyclePerConnection,
+                             const bool passiveWhenConnected, const bool pauseOnConnect)
+: DUTY_CYCLE_MAX( std::max<int32_t>(1, std::min<int32_t>(100, dutyCycleMax)) ),
+  DUTY_CYCLE_MIN( std::max<int32_t>(1, std::min<int32_t>(100, dutyCycleMin)) ),
+  DUTY_CYCLE_PER_CONNECTION( std::max<int32_t>(0, std::min<int32_t>(100, dutyCyclePerConnection)) ),
+  PASSIVE_WHEN_CONNECTED( passiveWhenConnected ), PAUSE_ON_CONNECT( pauseOnConnect )
+{ }
+
+int32_t ScanScheduler::getDutyCycle(const int connectedCount) const {
+    int32_t duty = 100 - std::max(0, connectedCount) * DUTY_CYCLE_PER_CONNECTION;
+    if( 0 < connectedCount ) {
+        duty = std::max(DUTY_CYCLE_MIN, duty);
+    }
+    return std::max<int32_t>(1, std::min(DUTY_CYCLE_MAX, duty));
+}
+
+ScanParameter ScanScheduler::adapt(const ScanParameter & requested, const int connectedCount) const {
+    ScanParameter res(requested);
+    res.interval = std::max(ScanParameter::MIN_VALUE, std::min(ScanParameter::MAX_VALUE, requested.interval));
+    const uint32_t window = ( static_cast<uint32_t>(res.interval) * getDutyCycle(connectedCount) ) / 100;
+    res.window = static_cast<uint16_t>( std::max<uint32_t>(ScanParameter::MIN_VALUE, std::min<uint32_t>(requested.window, window)) );
+    res.window = std::min(res.window, res.interval);
+    if( PASSIVE_WHEN_CONNECTED && 0 < connectedCount ) {
+        res.active = false;
+    }
+    return res;
+}
+
+std::string ScanScheduler::toString() const {
+    return "ScanScheduler[duty[max "+std::to_string(DUTY_CYCLE_MAX)+"%, min "+std::to_string(DUTY_CYCLE_MIN)+
+           "%, per connection "+std::to_string(DUTY_CYCLE_PER_CONNECTION)+"%], passive when connected "+std::to_string(PASSIVE_WHEN_CONNECTED)+
+           ", pause on connect "+std::to_string(PAUSE_ON_CONNECT)+"]";
+}
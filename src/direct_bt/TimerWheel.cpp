@@ -0,0 +1,343 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+// #define VERBOSE_ON 1
+#include <dbt_debug.hpp>
+
+#include "BasicTypes.hpp"
+#include "TimerWheel.hpp"
+
+using namespace direct_bt;
+
+constexpr uint32_t TimerWheel::NIL;
+
+TimerWheel::TimerWheel(const uint32_t tickMS_)
+: tickMS( std::max<uint32_t>(1, tickMS_) ), freeList(NIL), count(0), t0(getCurrentMilliseconds()), currentTick(0),
+  wakeTick(UINT64_MAX), running(NIL), runningGeneration(0), runningCancelled(false),
+  threadRunning(false), shallStop(false), expiredCount(0), wakeupCount(0)
+{
+    for(uint32_t l=0; l<LEVELS; l++) {
+        for(uint32_t s=0; s<SLOTS; s++) {
+            heads[l][s] = NIL;
+        }
+        occupied[l] = 0;
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+uint64_t TimerWheel::getNowTick() const {
+    return ( getCurrentMilliseconds() - t0 ) / tickMS;
+}
+
+void TimerWheel::link(const uint32_t idx) {
+    Node & n = nodes[idx];
+    const uint64_t delta = n.expires > currentTick ? n.expires - currentTick : 0;
+    uint64_t e = n.expires;
+    uint32_t level = 0;
+    while( level < LEVELS && delta >= ( static_cast<uint64_t>(1) << ( SLOT_BITS * ( level + 1 ) ) ) ) {
+        level++;
+    }
+    if( LEVELS == level ) {
+        // Beyond the wheels' span, re-cascaded from the highest wheel's farthest slot
+        level = LEVELS - 1;
+        e = currentTick + ( static_cast<uint64_t>(1) << ( SLOT_BITS * LEVELS ) ) - 1;
+    } else if( n.expires < currentTick ) {
+        e = currentTick;
+    }
+    const uint32_t slot = static_cast<uint32_t>( e >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 );
+    n.level = level;
+    n.slot = slot;
+    n.prev = NIL;
+    n.next = heads[level][slot];
+    if( NIL != n.next ) {
+        nodes[n.next].prev = idx;
+    }
+    heads[level][slot] = idx;
+    occupied[level] |= static_cast<uint64_t>(1) << slot;
+}
+
+void TimerWheel::unlink(const uint32_t idx) {
+    Node & n = nodes[idx];
+    if( NIL != n.prev ) {
+        nodes[n.prev].next = n.next;
+    } else {
+        heads[n.level][n.slot] = n.next;
+        if( NIL == n.next ) {
+            occupied[n.level] &= ~( static_cast<uint64_t>(1) << n.slot );
+        }
+    }
+    if( NIL != n.next ) {
+        nodes[n.next].prev = n.prev;
+    }
+    n.prev = NIL;
+    n.next = NIL;
+    n.level = NIL;
+}
+
+uint32_t TimerWheel::allocNode() {
+    uint32_t idx;
+    if( NIL != freeList ) {
+        idx = freeList;
+        freeList = nodes[idx].next;
+    } else {
+        idx = static_cast<uint32_t>( nodes.size() );
+        nodes.push_back( Node { nullptr, 0, NIL, NIL, 0, NIL, 0 } );
+    }
+    Node & n = nodes[idx];
+    n.prev = NIL;
+    n.next = NIL;
+    n.level = NIL;
+    return idx;
+}
+
+void TimerWheel::freeNode(const uint32_t idx) {
+    Node & n = nodes[idx];
+    n.generation++;
+    n.level = NIL;
+    n.prev = NIL;
+    n.next = freeList;
+    freeList = idx;
+}
+
+void TimerWheel::cascade(const uint32_t level) {
+    const uint32_t slot = static_cast<uint32_t>( currentTick >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 );
+    uint32_t idx = heads[level][slot];
+    heads[level][slot] = NIL;
+    occupied[level] &= ~( static_cast<uint64_t>(1) << slot );
+    while( NIL != idx ) {
+        const uint32_t next = nodes[idx].next;
+        link(idx);
+        idx = next;
+    }
+}
+
+uint64_t TimerWheel::getNextTick() const {
+    uint64_t res = UINT64_MAX;
+    for(uint32_t l=0; l<LEVELS; l++) {
+        if( 0 == occupied[l] ) {
+            continue;
+        }
+        // Slot (base + k) & (SLOTS - 1) is due at tick (base + k) << shift, k in [1, SLOTS]
+        const uint32_t shift = SLOT_BITS * l;
+        const uint64_t base = currentTick >> shift;
+        const uint32_t r = static_cast<uint32_t>( base + 1 ) & ( SLOTS - 1 );
+        const uint64_t rot = 0 == r ? occupied[l] : ( occupied[l] >> r ) | ( occupied[l] << ( SLOTS - r ) );
+        const uint64_t k = __builtin_ctzll(rot) + 1;
+        res = std::min(res, ( base + k ) << shift);
+    }
+    return res;
+}
+
+void TimerWheel::expire(std::unique_lock<std::mutex> & lock) {
+    const uint32_t slot = static_cast<uint32_t>( currentTick ) & ( SLOTS - 1 );
+    while( !shallStop && NIL != heads[0][slot] ) {
+        const uint32_t idx = heads[0][slot];
+        unlink(idx);
+        Callback cb = std::move(nodes[idx].cb);
+        running = idx;
+        runningGeneration = nodes[idx].generation;
+        runningCancelled = false;
+        lock.unlock();
+
+        uint32_t nextMS = 0;
+        try {
+            nextMS = cb();
+        } catch (std::exception &e) {
+            ERR_PRINT("TimerWheel::expire: Caught exception %s", e.what());
+        }
+
+        lock.lock();
+        expiredCount++;
+        const bool again = 0 < nextMS && !runningCancelled && !shallStop;
+        if( again ) {
+            Node & n = nodes[idx];
+            n.cb = std::move(cb);
+            n.expires = std::max( currentTick + 1, ( getCurrentMilliseconds() - t0 + nextMS + tickMS - 1 ) / tickMS );
+            link(idx);
+        } else {
+            freeNode(idx);
+            count--;
+        }
+        running = NIL;
+        cv_done.notify_all();
+        if( !again ) {
+            // Release captured resources unlocked, their destruction may use this wheel
+            lock.unlock();
+            cb = nullptr;
+            lock.lock();
+        }
+    }
+}
+
+void TimerWheel::threadImpl() {
+    std::unique_lock<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    while( !shallStop ) {
+        const uint64_t next = getNextTick();
+        wakeTick = next;
+        if( UINT64_MAX == next ) {
+            cv.wait(lock);
+            wakeupCount++;
+            continue;
+        }
+        const uint64_t now = getCurrentMilliseconds() - t0;
+        const uint64_t due = next * tickMS;
+        if( due > now ) {
+            cv.wait_for(lock, std::chrono::milliseconds(due - now));
+            wakeupCount++;
+            continue; // re-evaluate, an earlier timer may have been scheduled
+        }
+        // Skipped ticks have neither a due timer nor a non-empty slot to cascade
+        currentTick = next;
+        for(uint32_t l=LEVELS-1; l>0; l--) {
+            if( 0 == ( currentTick & ( ( static_cast<uint64_t>(1) << ( SLOT_BITS * l ) ) - 1 ) ) ) {
+                cascade(l);
+            }
+        }
+        expire(lock);
+    }
+    threadRunning = false;
+    DBG_PRINT("TimerWheel::thread: Ended");
+}
+
+TimerWheel::TimerID TimerWheel::schedule(const uint32_t delayMS, Callback cb) {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    if( shallStop ) {
+        return 0;
+    }
+    const uint32_t idx = allocNode();
+    Node & n = nodes[idx];
+    n.cb = std::move(cb);
+    n.expires = std::max( currentTick + 1, ( getCurrentMilliseconds() - t0 + delayMS + tickMS - 1 ) / tickMS );
+    link(idx);
+    count++;
+    if( !threadRunning ) {
+        if( thread.joinable() ) {
+            thread.join(); // ended before, never while shallStop is false
+        }
+        threadRunning = true;
+        thread = std::thread(&TimerWheel::threadImpl, this);
+        threadId = thread.get_id();
+    } else if( n.expires < wakeTick ) {
+        cv.notify_all();
+    }
+    return toID(idx, n.generation);
+}
+
+bool TimerWheel::cancel(const TimerID id, const bool wait) {
+    Callback dropped; // destructed unlocked
+    std::unique_lock<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const uint32_t idx = static_cast<uint32_t>( id & 0xffffffffU ) - 1;
+    const uint32_t generation = static_cast<uint32_t>( id >> 32 );
+    if( 0 == id || idx >= nodes.size() || nodes[idx].generation != generation ) {
+        return false;
+    }
+    if( running == idx && runningGeneration == generation ) {
+        runningCancelled = true;
+        if( wait && std::this_thread::get_id() != threadId ) {
+            while( running == idx && runningGeneration == generation ) {
+                cv_done.wait(lock);
+            }
+        }
+        return true;
+    }
+    if( NIL == nodes[idx].level ) {
+        return false;
+    }
+    unlink(idx);
+    dropped = std::move(nodes[idx].cb);
+    freeNode(idx);
+    count--;
+    return true;
+}
+
+bool TimerWheel::isScheduled(const TimerID id) {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    const uint32_t idx = static_cast<uint32_t>( id & 0xffffffffU ) - 1;
+    const uint32_t generation = static_cast<uint32_t>( id >> 32 );
+    if( 0 == id || idx >= nodes.size() || nodes[idx].generation != generation ) {
+        return false;
+    }
+    return NIL != nodes[idx].level || ( running == idx && !runningCancelled );
+}
+
+size_t TimerWheel::size() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return count;
+}
+
+uint64_t TimerWheel::getExpiredCount() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return expiredCount;
+}
+
+uint64_t TimerWheel::getWakeupCount() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return wakeupCount;
+}
+
+void TimerWheel::stop() {
+    std::vector<Callback> dropped; // destructed unlocked
+    {
+        const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+        shallStop = true;
+        for(uint32_t l=0; l<LEVELS; l++) {
+            for(uint32_t s=0; s<SLOTS; s++) {
+                uint32_t idx = heads[l][s];
+                while( NIL != idx ) {
+                    const uint32_t next = nodes[idx].next;
+                    dropped.push_back( std::move(nodes[idx].cb) );
+                    freeNode(idx);
+                    count--;
+                    idx = next;
+                }
+                heads[l][s] = NIL;
+            }
+            occupied[l] = 0;
+        }
+        cv.notify_all();
+    }
+    if( thread.joinable() ) {
+        if( thread.get_id() == std::this_thread::get_id() ) {
+            thread.detach(); // stopped from a callback
+        } else {
+            thread.join();
+        }
+    }
+}
+
+std::string TimerWheel::toString() {
+    const std::lock_guard<std::mutex> lock(mtx); // RAII-style acquire and relinquish via destructor
+    return "TimerWheel[tick "+std::to_string(tickMS)+"ms, timers "+std::to_string(count)+
+           ", expired "+std::to_string(expiredCount)+", wakeups "+std::to_string(wakeupCount)+"]";
+}
@@ -0,0 +1,122 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com>
+ * Copyright (c) 2020 Gothel Software e.K.
+ * Copyright (c) 2020 ZAFENA AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <string>
+#include <cstdint>
+#include <cinttypes>
+#include <cstdio>
+
+#include "TrafficStats.hpp"
+#include "BasicTypes.hpp"
+
+using namespace direct_bt;
+
+double TrafficSnapshot::getNotificationRate() const noexcept {
+    return timestamp > startTime ? ( notifications * 1000.0 ) / ( timestamp - startTime ) : 0.0;
+}
+
+double TrafficSnapshot::getNotificationRate(const TrafficSnapshot & earlier) const noexcept {
+    if( timestamp <= earlier.timestamp || notifications < earlier.notifications ) {
+        return 0.0; // same snapshot or reset in between
+    }
+    return ( ( notifications - earlier.notifications ) * 1000.0 ) / ( timestamp - earlier.timestamp );
+}
+
+std::string TrafficSnapshot::toString() const {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "in[pdus %" PRIu64 ", bytes %" PRIu64 "], out[pdus %" PRIu64 ", bytes %" PRIu64 "], ntf %" PRIu64 " (%.1f/s), "
+                               "retries %" PRIu64 ", timeouts %" PRIu64 ", rtt avg %" PRIu64 " us",
+             pdusIn, bytesIn, pdusOut, bytesOut, notifications, getNotificationRate(), retries, timeouts, getAverageRTT());
+    std::string res("Traffic["+std::string(buf));
+    for(size_t i=0; i<opcodes.size(); i++) {
+        const OpcodeCount & o = opcodes[i];
+        snprintf(buf, sizeof(buf), ", 0x%2.2X[in %" PRIu64 "/%" PRIu64 ", out %" PRIu64 "/%" PRIu64 "]",
+                 o.opcode, o.pdusIn, o.bytesIn, o.pdusOut, o.bytesOut);
+        res.append(buf);
+    }
+    res.append("]");
+    return res;
+}
+
+TrafficStats::TrafficStats() noexcept
+: startTime(getCurrentMilliseconds()), pdusIn(0), bytesIn(0), pdusOut(0), bytesOut(0),
+  notifications(0), retries(0), timeouts(0), rttSamples(0), rttSum(0)
+{
+    for(int i=0; i<256; i++) {
+        opcodePDUsIn[i] = 0;
+        opcodeBytesIn[i] = 0;
+        opcodePDUsOut[i] = 0;
+        opcodeBytesOut[i] = 0;
+    }
+}
+
+void TrafficStats::reset() noexcept {
+    pdusIn.store(0, std::memory_order_relaxed);
+    bytesIn.store(0, std::memory_order_relaxed);
+    pdusOut.store(0, std::memory_order_relaxed);
+    bytesOut.store(0, std::memory_order_relaxed);
+    notifications.store(0, std::memory_order_relaxed);
+    retries.store(0, std::memory_order_relaxed);
+    timeouts.store(0, std::memory_order_relaxed);
+    rttSamples.store(0, std::memory_order_relaxed);
+    rttSum.store(0, std::memory_order_relaxed);
+    for(int i=0; i<256; i++) {
+        opcodePDUsIn[i].store(0, std::memory_order_relaxed);
+        opcodeBytesIn[i].store(0, std::memory_order_relaxed);
+        opcodePDUsOut[i].store(0, std::memory_order_relaxed);
+        opcodeBytesOut[i].store(0, std::memory_order_relaxed);
+    }
+    startTime.store(getCurrentMilliseconds(), std::memory_order_relaxed);
+}
+
+TrafficSnapshot TrafficStats::getSnapshot() const {
+    TrafficSnapshot res;
+    res.startTime = startTime.load(std::memory_order_relaxed);
+    res.timestamp = getCurrentMilliseconds();
+    res.pdusIn = pdusIn.load(std::memory_order_relaxed);
+    res.bytesIn = bytesIn.load(std::memory_order_relaxed);
+    res.pdusOut = pdusOut.load(std::memory_order_relaxed);
+    res.bytesOut = bytesOut.load(std::memory_order_relaxed);
+    res.notifications = notifications.load(std::memory_order_relaxed);
+    res.retries = retries.load(std::memory_order_relaxed);
+    res.timeouts = timeouts.load(std::memory_order_relaxed);
+    res.rttSamples = rttSamples.load(std::memory_order_relaxed);
+    res.rttSum = rttSum.load(std::memory_order_relaxed);
+    for(int i=0; i<256; i++) {
+        const uint64_t pIn = opcodePDUsIn[i].load(std::memory_order_relaxed);
+        const uint64_t pOut = opcodePDUsOut[i].load(std::memory_order_relaxed);
+        if( 0 < pIn || 0 < pOut ) {
+            TrafficSnapshot::OpcodeCount o;
+            o.opcode = static_cast<uint8_t>(i);
+            o.pdusIn = pIn;
+            o.bytesIn = opcodeBytesIn[i].load(std::memory_order_relaxed);
+            o.pdusOut = pOut;
+            o.bytesOut = opcodeBytesOut[i].load(std::memory_order_relaxed);
+            res.opcodes.push_back(o);
+        }
+    }
+    return res;
+}
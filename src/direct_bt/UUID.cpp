@@ -34,6 +34,39 @@ static uint8_t bt_base_uuid_be[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0
                                      0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB };
 uuid128_t direct_bt::BT_BASE_UUID( bt_base_uuid_be, 0, false );
 
+/** String length of uuid128_t, '00000000-0000-1000-8000-00805F9B34FB' */
+static const int UUID128_STRING_LENGTH = 36;
+
+/** Lower case hex digit pairs of all octet values, avoiding snprintf. */
+static const char hex_digits[] = "0123456789abcdef";
+
+/** Hex digit value per ASCII code, -1 if not a hex digit, avoiding sscanf. */
+static const struct hex_value_table {
+    int8_t v[256];
+    hex_value_table() {
+        memset(v, -1, sizeof(v));
+        for(int i=0; i<10; i++) { v['0'+i] = i; }
+        for(int i=0; i<6; i++) { v['a'+i] = 10+i; v['A'+i] = 10+i; }
+    }
+    int operator[](const uint8_t c) const { return v[c]; }
+} hex_value;
+
+static inline void put_hex(char * dest, const uint8_t v) {
+    dest[0] = hex_digits[v >> 4];
+    dest[1] = hex_digits[v & 0x0f];
+}
+
+/** Returns the uint128_t::data index of the i-th octet in string order, i.e. the most significant first. */
+static constexpr int uuid128_octet_index(const int i) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+    return i;
+#elif __BYTE_ORDER == __LITTLE_ENDIAN
+    return 15 - i;
+#else
+#error "Unexpected __BYTE_ORDER"
+#endif
+}
+
 uuid_t::TypeSize uuid_t::toTypeSize(const int size) {
     switch(size) {
         case TypeSize::UUID16_SZ: return TypeSize::UUID16_SZ;
@@ -54,6 +87,28 @@ std::shared_ptr<const uuid_t> uuid_t::create(TypeSize t, uint8_t const * const b
     throw IllegalArgumentException("Unknown Type "+std::to_string(static_cast<int>(t)), E_FILE_LINE);
 }
 
+std::shared_ptr<const uuid_t> uuid_t::create(const std::string & str) {
+    const int len = static_cast<int>( str.length() );
+    if( UUID128_STRING_LENGTH == len ) {
+        return std::shared_ptr<const uuid_t>(new uuid128_t(str));
+    }
+    if( 4 != len && 8 != len ) {
+        throw IllegalArgumentException("UUID string not of length 4, 8 or 36 but "+std::to_string(len)+": "+str, E_FILE_LINE);
+    }
+    uint32_t v = 0;
+    for(int i=0; i<len; i++) {
+        const int d = hex_value[static_cast<uint8_t>(str[i])];
+        if( 0 > d ) {
+            throw IllegalArgumentException("UUID string contains non hex digit: "+str, E_FILE_LINE);
+        }
+        v = ( v << 4 ) | static_cast<uint32_t>(d);
+    }
+    if( 4 == len ) {
+        return std::shared_ptr<const uuid_t>(new uuid16_t(static_cast<uint16_t>(v)));
+    }
+    return std::shared_ptr<const uuid_t>(new uuid32_t(v));
+}
+
 uuid128_t uuid_t::toUUID128(uuid128_t const & base_uuid, int const uuid32_le_octet_index) const {
     switch(type) {
         case TypeSize::UUID16_SZ: return uuid128_t(*((uuid16_t*)this), base_uuid, uuid32_le_octet_index);
@@ -76,16 +131,10 @@ uuid128_t::uuid128_t(uuid32_t const & uuid32, uuid128_t const & base_uuid, int c
 : uuid_t(TypeSize::UUID128_SZ), value(merge_uint128(uuid32.value, base_uuid.value, uuid32_le_octet_index)) {}
 
 std::string uuid16_t::toString() const {
-    const int length = 4;
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-
-    const int count = snprintf(&str[0], str.capacity(), "%.4x", value);
-    if( length != count ) {
-        throw InternalError("UUID16 string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
-    }
-    return str;
+    char str[4];
+    put_hex(str, static_cast<uint8_t>(value >> 8));
+    put_hex(str+2, static_cast<uint8_t>(value));
+    return std::string(str, sizeof(str));
 }
 
 std::string uuid16_t::toUUID128String(uuid128_t const & base_uuid, int const le_octet_index) const
@@ -95,16 +144,11 @@ std::string uuid16_t::toUUID128String(uuid128_t const & base_uuid, int const le_
 }
 
 std::string uuid32_t::toString() const {
-    const int length = 8;
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-
-    const int count = snprintf(&str[0], str.capacity(), "%.8x", value);
-    if( length != count ) {
-        throw InternalError("UUID32 string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
+    char str[8];
+    for(int i=0; i<4; i++) {
+        put_hex(str+2*i, static_cast<uint8_t>(value >> (24-8*i)));
     }
-    return str;
+    return std::string(str, sizeof(str));
 }
 
 std::string uuid32_t::toUUID128String(uuid128_t const & base_uuid, int const le_octet_index) const
@@ -122,78 +166,55 @@ std::string uuid128_t::toString() const {
     // BE: low-mem - 87654321-0000-1000-8000-00805F9B34FB - high-mem
     //                   0      1    2    3      4    5
     //
-    const int length = 36;
-    std::string str;
-    str.reserve(length+1); // including EOS for snprintf
-    str.resize(length);
-    uint32_t part0, part4;
-    uint16_t part1, part2, part3, part5;
-
-    // snprintf uses host data type, in which values are stored,
-    // hence no endian conversion
-#if __BYTE_ORDER == __BIG_ENDIAN
-    part0 = get_uint32(value.data,  0);
-    part1 = get_uint16(value.data,  4);
-    part2 = get_uint16(value.data,  6);
-    part3 = get_uint16(value.data,  8);
-    part4 = get_uint32(value.data, 10);
-    part5 = get_uint16(value.data, 14);
-#elif __BYTE_ORDER == __LITTLE_ENDIAN
-    part5 = get_uint16(value.data,  0);
-    part4 = get_uint32(value.data,  2);
-    part3 = get_uint16(value.data,  6);
-    part2 = get_uint16(value.data,  8);
-    part1 = get_uint16(value.data, 10);
-    part0 = get_uint32(value.data, 12);
-#else
-#error "Unexpected __BYTE_ORDER"
-#endif
-    const int count = snprintf(&str[0], str.capacity(), "%.8x-%.4x-%.4x-%.4x-%.8x%.4x",
-                                part0, part1, part2, part3, part4, part5);
-    if( length != count ) {
-        throw InternalError("UUID128 string not of length "+std::to_string(length)+" but "+std::to_string(count), E_FILE_LINE);
+    char str[UUID128_STRING_LENGTH];
+    int j=0;
+    for(int i=0; i<16; i++) {
+        if( 4 == i || 6 == i || 8 == i || 10 == i ) {
+            str[j++] = '-';
+        }
+        put_hex(str+j, value.data[uuid128_octet_index(i)]);
+        j+=2;
     }
-    return str;
+    return std::string(str, sizeof(str));
 }
 
 uuid128_t::uuid128_t(const std::string str)
 : uuid_t(TypeSize::UUID128_SZ)
 {
-    uint32_t part0, part4;
-    uint16_t part1, part2, part3, part5;
-
-    if( 36 != str.length() ) {
+    if( UUID128_STRING_LENGTH != str.length() ) {
         std::string msg("UUID128 string not of length 36 but ");
         msg.append(std::to_string(str.length()));
         msg.append(": "+str);
         throw IllegalArgumentException(msg, E_FILE_LINE);
     }
-    if ( sscanf(str.c_str(), "%08x-%04hx-%04hx-%04hx-%08x%04hx",
-                     &part0, &part1, &part2, &part3, &part4, &part5) != 6 )
-    {
+    const char * s = str.c_str();
+    int j=0;
+    for(int i=0; i<16; i++) {
+        if( 4 == i || 6 == i || 8 == i || 10 == i ) {
+            if( '-' != s[j++] ) {
+                j = -1;
+                break;
+            }
+        }
+        const int hi = hex_value[static_cast<uint8_t>(s[j])];
+        const int lo = hex_value[static_cast<uint8_t>(s[j+1])];
+        if( 0 > ( hi | lo ) ) {
+            j = -1;
+            break;
+        }
+        value.data[uuid128_octet_index(i)] = static_cast<uint8_t>( ( hi << 4 ) | lo );
+        j+=2;
+    }
+    if( 0 > j ) {
         std::string msg("UUID128 string not in format '00000000-0000-1000-8000-00805F9B34FB' but "+str);
         throw IllegalArgumentException(msg, E_FILE_LINE);
     }
-    uint128_t value;
+}
 
-    // sscanf provided host data type, in which we store the values,
-    // hence no endian conversion
-#if __BYTE_ORDER == __BIG_ENDIAN
-    put_uint32(value.data,  0, part0);
-    put_uint16(value.data,  4, part1);
-    put_uint16(value.data,  6, part2);
-    put_uint16(value.data,  8, part3);
-    put_uint32(value.data, 10, part4);
-    put_uint16(value.data, 14, part5);
-#elif __BYTE_ORDER == __LITTLE_ENDIAN
-    put_uint16(value.data,  0, part5);
-    put_uint32(value.data,  2, part4);
-    put_uint16(value.data,  6, part3);
-    put_uint16(value.data,  8, part2);
-    put_uint16(value.data, 10, part1);
-    put_uint32(value.data, 12, part0);
-#else
-#error "Unexpected __BYTE_ORDER"
-#endif
+std::string uuid_value_t::toString() const {
+    return toUUID()->toString();
 }
 
+std::string uuid_value_t::toUUID128String(uuid128_t const & base_uuid, int const le_octet_index) const {
+    return toUUID()->toUUID128String(base_uuid, le_octet_index);
+}
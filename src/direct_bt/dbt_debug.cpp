@@ -29,28 +29,24 @@
 
 using namespace direct_bt;
 
-void direct_bt::DBG_PRINT(const char * format, ...) {
-    if(direct_bt::DBTEnv::get().DEBUG) {
-        fprintf(stderr, "[%'9" PRIu64 "] Debug: ", DBTEnv::getElapsedMillisecond());
-        va_list args;
-        va_start (args, format);
-        vfprintf(stderr, format, args);
-        va_end (args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
-    }
+void direct_bt::DBG_PRINT_impl(const char * format, ...) {
+    fprintf(stderr, "[%'9" PRIu64 "] Debug: ", DBTEnv::getElapsedMillisecond());
+    va_list args;
+    va_start (args, format);
+    vfprintf(stderr, format, args);
+    va_end (args);
+    fprintf(stderr, "\n");
+    fflush(stderr);
 }
 
-void direct_bt::INFO_PRINT(const char * format, ...) {
-    if(direct_bt::DBTEnv::get().VERBOSE) {
-        fprintf(stderr, "[%'9" PRIu64 "] Info: ", DBTEnv::getElapsedMillisecond());
-        va_list args;
-        va_start (args, format);
-        vfprintf(stderr, format, args);
-        va_end (args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
-    }
+void direct_bt::INFO_PRINT_impl(const char * format, ...) {
+    fprintf(stderr, "[%'9" PRIu64 "] Info: ", DBTEnv::getElapsedMillisecond());
+    va_list args;
+    va_start (args, format);
+    vfprintf(stderr, format, args);
+    va_end (args);
+    fprintf(stderr, "\n");
+    fflush(stderr);
 }
 
 void direct_bt::ERR_PRINTv(const char *file, const int line, const char * format, va_list args) {
@@ -96,15 +92,3 @@ void direct_bt::PLAIN_PRINT(const char * format, ...) {
     fprintf(stderr, "\n");
     fflush(stderr);
 }
-
-void direct_bt::COND_PRINT(const bool condition, const char * format, ...) {
-    if( condition ) {
-        fprintf(stderr, "[%'9" PRIu64 "] ", DBTEnv::getElapsedMillisecond());
-        va_list args;
-        va_start (args, format);
-        vfprintf(stderr, format, args);
-        va_end (args);
-        fprintf(stderr, "\n");
-        fflush(stderr);
-    }
-}
@@ -24,15 +24,41 @@
  * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <cstring>
+
 #include "direct_bt/dfa_utf8_decode.hpp"
 
+size_t dfa_utf8_ascii_prefix(const uint8_t *buffer, const size_t buffer_size) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    size_t byte_count = 0;
+
+    // eight bytes at once, stopping at the first word containing a non ASCII or EOS byte
+    for( ; byte_count + sizeof(uint64_t) <= buffer_size; byte_count += sizeof(uint64_t) ) {
+        uint64_t w;
+        memcpy(&w, buffer + byte_count, sizeof(w)); // unaligned
+        if( 0 != ( ( w | ( ( w - ones ) & ~w ) ) & highs ) ) {
+            break;
+        }
+    }
+    while( byte_count < buffer_size && 0 != buffer[byte_count] && 0 == ( buffer[byte_count] & 0x80 ) ) {
+        byte_count++;
+    }
+    return byte_count;
+}
+
 std::string dfa_utf8_decode(const uint8_t *buffer, const size_t buffer_size) {
     uint32_t codepoint;
     uint32_t state = DFA_UTF8_ACCEPT;
-    size_t byte_count;
-    const uint8_t *ibuffer = buffer;
+    size_t byte_count = dfa_utf8_ascii_prefix(buffer, buffer_size);
+
+    if( byte_count == buffer_size || 0 == buffer[byte_count] ) {
+        // pure ASCII up to EOS, no decoding required
+        return std::string( (const char*)buffer, byte_count );
+    }
+    const uint8_t *ibuffer = buffer + byte_count;
 
-    for( byte_count = 0; byte_count < buffer_size && *ibuffer; byte_count++ ) {
+    for( ; byte_count < buffer_size && *ibuffer; byte_count++ ) {
         if ( DFA_UTF8_REJECT == dfa_utf8_decode(state, codepoint, *ibuffer++) ) {
             break; // not a valid byte for a utf8 stream, end here!
         } // else DFA_UTF8_ACCEPT -> valid_utf8_chars++
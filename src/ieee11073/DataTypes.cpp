@@ -74,27 +74,38 @@ static const uint32_t FIRST_S_RESERVED_VALUE = FloatTypes::ReservedSFloatValues:
 
 static const float reserved_float_values[5] = {INFINITY, NAN, NAN, NAN, -INFINITY};
 
-float FloatTypes::float16_IEEE11073_to_IEEE754(const uint16_t raw_bt_float16_le) {
-    uint16_t mantissa = raw_bt_float16_le & 0x0FFF;
-    int8_t exponent = raw_bt_float16_le >> 12;
+/**
+ * Powers of ten for all exponents, indexed by the raw unsigned exponent bits,
+ * i.e. 4 bits for SFLOAT and 8 bits for FLOAT, shared by the scalar and batch decoder for identical results.
+ */
+static const struct Pow10Table {
+    float sfloat[16];
+    float float32[256];
 
-    if( exponent >= 0x0008) {
-        exponent = - ( (0x000F + 1) - exponent );
+    Pow10Table() {
+        for(int i=0; i<16; i++) {
+            sfloat[i] = powf(10.0f, i < 8 ? i : i - 16);
+        }
+        for(int i=0; i<256; i++) {
+            float32[i] = powf(10.0f, static_cast<int8_t>(i));
+        }
     }
+} pow10_table;
+
+float FloatTypes::float16_IEEE11073_to_IEEE754(const uint16_t raw_bt_float16_le) {
+    const uint16_t mantissa = raw_bt_float16_le & 0x0FFF;
 
     if( mantissa >= FIRST_S_RESERVED_VALUE &&
         mantissa <= ReservedSFloatValues::MDER_S_NEGATIVE_INFINITY ) {
         return reserved_float_values[mantissa - FIRST_S_RESERVED_VALUE];
     }
-    if ( mantissa >= 0x0800 ) {
-        mantissa = - ( ( 0x0FFF + 1 ) - mantissa );
-    }
-    return mantissa * powf(10.0f, exponent);
+    // 12 bit two's complement, sign extended
+    const int32_t smantissa = mantissa >= 0x0800 ? static_cast<int32_t>(mantissa) - ( 0x0FFF + 1 ) : mantissa;
+    return smantissa * pow10_table.sfloat[raw_bt_float16_le >> 12];
 }
 
 float FloatTypes::float32_IEEE11073_to_IEEE754(const uint32_t raw_bt_float32_le) {
     int32_t mantissa = raw_bt_float32_le & 0xFFFFFF;
-    int8_t expoent = raw_bt_float32_le >> 24;
 
     if( mantissa >= FIRST_RESERVED_VALUE &&
         mantissa <= ReservedFloatValues::MDER_NEGATIVE_INFINITY ) {
@@ -103,5 +114,143 @@ float FloatTypes::float32_IEEE11073_to_IEEE754(const uint32_t raw_bt_float32_le)
     if( mantissa >= 0x800000 ) {
         mantissa = - ( ( 0xFFFFFF + 1 ) - mantissa );
     }
-    return mantissa * powf(10.0f, expoent);
+    return mantissa * pow10_table.float32[raw_bt_float32_le >> 24];
+}
+
+static inline uint16_t get_uint16_le(const uint8_t * p) {
+    return static_cast<uint16_t>( p[0] | ( p[1] << 8 ) );
+}
+static inline uint32_t get_uint32_le(const uint8_t * p) {
+    return static_cast<uint32_t>(p[0]) | ( static_cast<uint32_t>(p[1]) << 8 ) |
+           ( static_cast<uint32_t>(p[2]) << 16 ) | ( static_cast<uint32_t>(p[3]) << 24 );
+}
+
+#if defined(__SSE2__) && __BYTE_ORDER == __LITTLE_ENDIAN
+    #include <emmintrin.h>
+    #define IEEE11073_SIMD_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON) && __BYTE_ORDER == __LITTLE_ENDIAN
+    // AArch64 only, as ARMv7 NEON flushes denormals, deviating from the scalar results
+    #include <arm_neon.h>
+    #define IEEE11073_SIMD_NEON 1
+#endif
+
+/**
+ * Decodes 4 values per iteration: sign extended mantissa and power of ten are computed in SIMD,
+ * the latter gathered from pow10_table. Lanes holding reserved values are patched by the scalar decoder.
+ * Returns the number of decoded values, a multiple of 4.
+ */
+static size_t float16_batch_simd(const uint8_t * src_le, float * dest, const size_t count) {
+    size_t i=0;
+#if defined(IEEE11073_SIMD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask_mantissa = _mm_set1_epi32(0x0FFF);
+    const __m128i resv_lo = _mm_set1_epi32(FIRST_S_RESERVED_VALUE - 1);
+    const __m128i resv_hi = _mm_set1_epi32(FloatTypes::ReservedSFloatValues::MDER_S_NEGATIVE_INFINITY + 1);
+    for(; i+4 <= count; i+=4) {
+        const __m128i raw = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_le + 2*i)), zero);
+        const __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(raw, 20), 20);
+        const __m128i umantissa = _mm_and_si128(raw, mask_mantissa);
+        const __m128i reserved = _mm_and_si128(_mm_cmpgt_epi32(umantissa, resv_lo), _mm_cmplt_epi32(umantissa, resv_hi));
+        alignas(16) uint32_t e[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(e), _mm_srli_epi32(raw, 12));
+        const __m128 p = _mm_set_ps(pow10_table.sfloat[e[3]], pow10_table.sfloat[e[2]], pow10_table.sfloat[e[1]], pow10_table.sfloat[e[0]]);
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(mantissa), p));
+        const int resv_mask = _mm_movemask_ps(_mm_castsi128_ps(reserved));
+        if( 0 != resv_mask ) {
+            for(int j=0; j<4; j++) {
+                if( resv_mask & ( 1 << j ) ) {
+                    dest[i+j] = FloatTypes::float16_IEEE11073_to_IEEE754(get_uint16_le(src_le + 2*(i+j)));
+                }
+            }
+        }
+    }
+#elif defined(IEEE11073_SIMD_NEON)
+    const uint32x4_t mask_mantissa = vdupq_n_u32(0x0FFF);
+    const uint32x4_t resv_lo = vdupq_n_u32(FIRST_S_RESERVED_VALUE);
+    const uint32x4_t resv_hi = vdupq_n_u32(FloatTypes::ReservedSFloatValues::MDER_S_NEGATIVE_INFINITY);
+    for(; i+4 <= count; i+=4) {
+        const uint32x4_t raw = vmovl_u16(vreinterpret_u16_u8(vld1_u8(src_le + 2*i)));
+        const int32x4_t mantissa = vshrq_n_s32(vshlq_n_s32(vreinterpretq_s32_u32(raw), 20), 20);
+        const uint32x4_t umantissa = vandq_u32(raw, mask_mantissa);
+        const uint32x4_t reserved = vandq_u32(vcgeq_u32(umantissa, resv_lo), vcleq_u32(umantissa, resv_hi));
+        uint32_t e[4];
+        vst1q_u32(e, vshrq_n_u32(raw, 12));
+        const float pa[4] = { pow10_table.sfloat[e[0]], pow10_table.sfloat[e[1]], pow10_table.sfloat[e[2]], pow10_table.sfloat[e[3]] };
+        vst1q_f32(dest + i, vmulq_f32(vcvtq_f32_s32(mantissa), vld1q_f32(pa)));
+        if( 0 != vmaxvq_u32(reserved) ) {
+            for(size_t j=0; j<4; j++) {
+                dest[i+j] = FloatTypes::float16_IEEE11073_to_IEEE754(get_uint16_le(src_le + 2*(i+j)));
+            }
+        }
+    }
+#else
+    (void)src_le;
+    (void)dest;
+    (void)count;
+#endif
+    return i;
+}
+
+/** See float16_batch_simd() */
+static size_t float32_batch_simd(const uint8_t * src_le, float * dest, const size_t count) {
+    size_t i=0;
+#if defined(IEEE11073_SIMD_SSE2)
+    const __m128i mask_mantissa = _mm_set1_epi32(0xFFFFFF);
+    const __m128i resv_lo = _mm_set1_epi32(FIRST_RESERVED_VALUE - 1);
+    const __m128i resv_hi = _mm_set1_epi32(FloatTypes::ReservedFloatValues::MDER_NEGATIVE_INFINITY + 1);
+    for(; i+4 <= count; i+=4) {
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_le + 4*i));
+        const __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(raw, 8), 8);
+        const __m128i umantissa = _mm_and_si128(raw, mask_mantissa);
+        const __m128i reserved = _mm_and_si128(_mm_cmpgt_epi32(umantissa, resv_lo), _mm_cmplt_epi32(umantissa, resv_hi));
+        alignas(16) uint32_t e[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(e), _mm_srli_epi32(raw, 24));
+        const __m128 p = _mm_set_ps(pow10_table.float32[e[3]], pow10_table.float32[e[2]], pow10_table.float32[e[1]], pow10_table.float32[e[0]]);
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(mantissa), p));
+        const int resv_mask = _mm_movemask_ps(_mm_castsi128_ps(reserved));
+        if( 0 != resv_mask ) {
+            for(int j=0; j<4; j++) {
+                if( resv_mask & ( 1 << j ) ) {
+                    dest[i+j] = FloatTypes::float32_IEEE11073_to_IEEE754(get_uint32_le(src_le + 4*(i+j)));
+                }
+            }
+        }
+    }
+#elif defined(IEEE11073_SIMD_NEON)
+    const uint32x4_t mask_mantissa = vdupq_n_u32(0xFFFFFF);
+    const uint32x4_t resv_lo = vdupq_n_u32(FIRST_RESERVED_VALUE);
+    const uint32x4_t resv_hi = vdupq_n_u32(FloatTypes::ReservedFloatValues::MDER_NEGATIVE_INFINITY);
+    for(; i+4 <= count; i+=4) {
+        const uint32x4_t raw = vreinterpretq_u32_u8(vld1q_u8(src_le + 4*i));
+        const int32x4_t mantissa = vshrq_n_s32(vshlq_n_s32(vreinterpretq_s32_u32(raw), 8), 8);
+        const uint32x4_t umantissa = vandq_u32(raw, mask_mantissa);
+        const uint32x4_t reserved = vandq_u32(vcgeq_u32(umantissa, resv_lo), vcleq_u32(umantissa, resv_hi));
+        uint32_t e[4];
+        vst1q_u32(e, vshrq_n_u32(raw, 24));
+        const float pa[4] = { pow10_table.float32[e[0]], pow10_table.float32[e[1]], pow10_table.float32[e[2]], pow10_table.float32[e[3]] };
+        vst1q_f32(dest + i, vmulq_f32(vcvtq_f32_s32(mantissa), vld1q_f32(pa)));
+        if( 0 != vmaxvq_u32(reserved) ) {
+            for(size_t j=0; j<4; j++) {
+                dest[i+j] = FloatTypes::float32_IEEE11073_to_IEEE754(get_uint32_le(src_le + 4*(i+j)));
+            }
+        }
+    }
+#else
+    (void)src_le;
+    (void)dest;
+    (void)count;
+#endif
+    return i;
+}
+
+void FloatTypes::float16_IEEE11073_to_IEEE754(const uint8_t * src_le, float * dest, const size_t count) {
+    for(size_t i = float16_batch_simd(src_le, dest, count); i<count; i++) {
+        dest[i] = float16_IEEE11073_to_IEEE754(get_uint16_le(src_le + 2*i));
+    }
+}
+
+void FloatTypes::float32_IEEE11073_to_IEEE754(const uint8_t * src_le, float * dest, const size_t count) {
+    for(size_t i = float32_batch_simd(src_le, dest, count); i<count; i++) {
+        dest[i] = float32_IEEE11073_to_IEEE754(get_uint32_le(src_le + 4*i));
+    }
 }
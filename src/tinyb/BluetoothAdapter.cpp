@@ -433,13 +433,18 @@ std::unique_ptr<BluetoothDevice> BluetoothAdapter::connect_device (
 
     if( result && nullptr != object_path ) {
 
-        Device1 *device = device1_proxy_new_for_bus_sync(
-            G_BUS_TYPE_SYSTEM,
-            G_DBUS_PROXY_FLAGS_NONE,
-            "org.bluez",
-            object_path,
-            NULL,
-            &error);
+        Device1 *device = NULL;
+        GDBusInterface *cached = get_cached_interface(object_path, "org.bluez.Device1");
+        if (cached != NULL)
+            device = DEVICE1(cached);
+        else
+            device = device1_proxy_new_for_bus_sync(
+                G_BUS_TYPE_SYSTEM,
+                G_DBUS_PROXY_FLAGS_NONE,
+                "org.bluez",
+                object_path,
+                NULL,
+                &error);
         g_free(object_path);
         handle_error(error);
 
@@ -510,14 +510,19 @@ std::unique_ptr<std::string> BluetoothDevice::get_modalias ()
 BluetoothAdapter BluetoothDevice::get_adapter ()
 {
     GError *error = NULL;
-
-    Adapter1 *adapter = adapter1_proxy_new_for_bus_sync(
-        G_BUS_TYPE_SYSTEM,
-        G_DBUS_PROXY_FLAGS_NONE,
-        "org.bluez",
-        device1_get_adapter (object),
-        NULL,
-        &error);
+    Adapter1 *adapter = NULL;
+
+    GDBusInterface *cached = get_cached_interface(device1_get_adapter (object), "org.bluez.Adapter1");
+    if (cached != NULL)
+        adapter = ADAPTER1(cached);
+    else
+        adapter = adapter1_proxy_new_for_bus_sync(
+            G_BUS_TYPE_SYSTEM,
+            G_DBUS_PROXY_FLAGS_NONE,
+            "org.bluez",
+            device1_get_adapter (object),
+            NULL,
+            &error);
 
    if (adapter == NULL) {
         std::string error_msg("Error occured while instantiating adapter: ");
@@ -35,22 +35,30 @@ using namespace tinyb;
 void BluetoothNotificationHandler::on_properties_changed_characteristic(GDBusProxy *proxy, GVariant *changed_properties, GStrv invalidated_properties, gpointer userdata) {
 
     auto c = static_cast<BluetoothGattCharacteristic*>(userdata);
-
-    if(g_variant_n_children(changed_properties) > 0) {
-        GVariantIter *iter = NULL;
-
-        GVariant *value;
-        const gchar *key;
-        g_variant_get(changed_properties, "a{sv}", &iter);
-        while (iter != nullptr && g_variant_iter_loop(iter, "{&sv}", &key, &value)) {
-            auto value_callback = c->value_changed_callback;
-            if (value_callback != nullptr && g_ascii_strncasecmp(key, "value", 5) == 0) {
-                std::vector<unsigned char> new_value = from_iter_to_vector(value);
-                value_callback(new_value);
-            }
-        }
-        g_variant_iter_free (iter);
+    auto raw_callback = c->value_changed_raw_callback;
+    auto value_callback = c->value_changed_callback;
+
+    if (raw_callback == nullptr && value_callback == nullptr)
+        return;
+
+    /* Only the last Value of all batched property changes of this signal is of interest,
+     * look it up directly instead of iterating and referencing all changed properties. */
+    GVariant *value = g_variant_lookup_value(changed_properties, "Value", G_VARIANT_TYPE_BYTESTRING);
+    if (value == nullptr)
+        return;
+
+    gsize size = 0;
+    const unsigned char *data = static_cast<const unsigned char *>(
+        g_variant_get_fixed_array(value, &size, sizeof(guchar)));
+
+    if (raw_callback != nullptr) {
+        /* data is owned by the GVariant, only valid while the callback runs */
+        raw_callback(data, size);
+    } else {
+        std::vector<unsigned char> new_value(data, data + size);
+        value_callback(new_value);
     }
+    g_variant_unref(value);
 }
 
 std::string BluetoothGattCharacteristic::get_class_name() const
@@ -192,6 +200,7 @@ bool BluetoothGattCharacteristic::enable_value_notifications(
     std::function<void(BluetoothGattCharacteristic &, std::vector<unsigned char> &,void *)> callback,
     void *userdata)
 {
+    value_changed_raw_callback = nullptr;
     value_changed_callback = std::bind(callback, std::ref(*this), std::placeholders::_1, userdata);
     start_notify();
     return true;
@@ -200,15 +209,26 @@ bool BluetoothGattCharacteristic::enable_value_notifications(
 bool BluetoothGattCharacteristic::enable_value_notifications(
     std::function<void(std::vector<unsigned char> &)> callback)
 {
+    value_changed_raw_callback = nullptr;
     value_changed_callback = callback;
     start_notify();
     return true;
 }
 
+bool BluetoothGattCharacteristic::enable_raw_value_notifications(
+    std::function<void(const unsigned char *, size_t)> callback)
+{
+    value_changed_callback = nullptr;
+    value_changed_raw_callback = callback;
+    start_notify();
+    return true;
+}
+
 bool BluetoothGattCharacteristic::disable_value_notifications()
 {
     stop_notify();
     value_changed_callback = nullptr;
+    value_changed_raw_callback = nullptr;
     return true;
 }
 
@@ -249,14 +269,19 @@ std::string BluetoothGattCharacteristic::get_uuid ()
 BluetoothGattService BluetoothGattCharacteristic::get_service ()
 {
     GError *error = NULL;
-
-    GattService1 *service = gatt_service1_proxy_new_for_bus_sync(
-        G_BUS_TYPE_SYSTEM,
-        G_DBUS_PROXY_FLAGS_NONE,
-        "org.bluez",
-        gatt_characteristic1_get_service (object),
-        NULL,
-        &error);
+    GattService1 *service = NULL;
+
+    GDBusInterface *cached = get_cached_interface(gatt_characteristic1_get_service (object), "org.bluez.GattService1");
+    if (cached != NULL)
+        service = GATT_SERVICE1(cached);
+    else
+        service = gatt_service1_proxy_new_for_bus_sync(
+            G_BUS_TYPE_SYSTEM,
+            G_DBUS_PROXY_FLAGS_NONE,
+            "org.bluez",
+            gatt_characteristic1_get_service (object),
+            NULL,
+            &error);
 
     if (service == nullptr) {
         std::string error_msg("Error occured while instantiating service: ");
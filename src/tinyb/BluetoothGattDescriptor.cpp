@@ -212,14 +212,19 @@ std::string BluetoothGattDescriptor::get_uuid ()
 BluetoothGattCharacteristic BluetoothGattDescriptor::get_characteristic ()
 {
     GError *error = NULL;
-
-    GattCharacteristic1* characteristic = gatt_characteristic1_proxy_new_for_bus_sync(
-        G_BUS_TYPE_SYSTEM,
-        G_DBUS_PROXY_FLAGS_NONE,
-        "org.bluez",
-        gatt_descriptor1_get_characteristic (object),
-        NULL,
-        &error);
+    GattCharacteristic1* characteristic = NULL;
+
+    GDBusInterface *cached = get_cached_interface(gatt_descriptor1_get_characteristic (object), "org.bluez.GattCharacteristic1");
+    if (cached != NULL)
+        characteristic = GATT_CHARACTERISTIC1(cached);
+    else
+        characteristic = gatt_characteristic1_proxy_new_for_bus_sync(
+            G_BUS_TYPE_SYSTEM,
+            G_DBUS_PROXY_FLAGS_NONE,
+            "org.bluez",
+            gatt_descriptor1_get_characteristic (object),
+            NULL,
+            &error);
 
     if (characteristic == NULL) {
         std::string error_msg("Error occured while instantiating characteristic: ");
@@ -102,14 +102,19 @@ std::string BluetoothGattService::get_uuid ()
 BluetoothDevice BluetoothGattService::get_device ()
 {
     GError *error = NULL;
-
-    Device1 *device = device1_proxy_new_for_bus_sync(
-        G_BUS_TYPE_SYSTEM,
-        G_DBUS_PROXY_FLAGS_NONE,
-        "org.bluez",
-        gatt_service1_get_device (object),
-        NULL,
-        &error);
+    Device1 *device = NULL;
+
+    GDBusInterface *cached = get_cached_interface(gatt_service1_get_device (object), "org.bluez.Device1");
+    if (cached != NULL)
+        device = DEVICE1(cached);
+    else
+        device = device1_proxy_new_for_bus_sync(
+            G_BUS_TYPE_SYSTEM,
+            G_DBUS_PROXY_FLAGS_NONE,
+            "org.bluez",
+            gatt_service1_get_device (object),
+            NULL,
+            &error);
 
     if (device == nullptr) {
         std::string error_msg("Error occured while instantiating device: ");
@@ -34,9 +34,136 @@
 #include "version.h"
 
 #include <cassert>
+#include <mutex>
+#include <unordered_map>
 
 using namespace tinyb;
 
+/* Index of the managed objects by object path, type, identifier and parent path,
+ * maintained from the object manager signals. It allows get_object() to only
+ * instantiate the candidates instead of wrapping every managed object. */
+class BluetoothObjectIndex {
+private:
+    struct Entry {
+        BluetoothType type;
+        std::string identifier;
+        std::string parent_path;
+    };
+
+    std::mutex lock;
+    std::unordered_map<std::string, Entry> by_path;
+    std::unordered_multimap<std::string, std::string> by_identifier;
+
+    void remove_locked(const std::string &path) {
+        auto it = by_path.find(path);
+        if (it == by_path.end())
+            return;
+        auto range = by_identifier.equal_range(it->second.identifier);
+        for (auto id = range.first; id != range.second; ++id) {
+            if (id->second == path) {
+                by_identifier.erase(id);
+                break;
+            }
+        }
+        by_path.erase(it);
+    }
+
+    static bool matches(const Entry &entry, BluetoothType type,
+        const std::string *parent_path) {
+        return (type == BluetoothType::NONE || type == entry.type) &&
+               (parent_path == nullptr || *parent_path == entry.parent_path);
+    }
+
+public:
+    void add(const std::string &path, BluetoothType type,
+        const std::string &identifier, const std::string &parent_path) {
+        std::lock_guard<std::mutex> guard(lock);
+        remove_locked(path);
+        by_path[path] = Entry { type, identifier, parent_path };
+        by_identifier.emplace(identifier, path);
+    }
+
+    void remove(const std::string &path) {
+        std::lock_guard<std::mutex> guard(lock);
+        remove_locked(path);
+    }
+
+    std::vector<std::string> candidates(BluetoothType type,
+        const std::string *identifier, const std::string *parent_path) {
+        std::vector<std::string> paths;
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (identifier != nullptr) {
+            auto range = by_identifier.equal_range(*identifier);
+            for (auto it = range.first; it != range.second; ++it) {
+                auto entry = by_path.find(it->second);
+                if (entry != by_path.end() && matches(entry->second, type, parent_path))
+                    paths.push_back(it->second);
+            }
+        } else {
+            for (auto it = by_path.begin(); it != by_path.end(); ++it) {
+                if (matches(it->second, type, parent_path))
+                    paths.push_back(it->first);
+            }
+        }
+        return paths;
+    }
+};
+
+static BluetoothObjectIndex object_index;
+
+static std::string to_index_string(const gchar *value)
+{
+    return value != NULL ? std::string(value) : std::string();
+}
+
+static void index_interface(GDBusInterface *interface)
+{
+    if (!G_IS_DBUS_PROXY(interface))
+        return;
+    std::string path(g_dbus_proxy_get_object_path(G_DBUS_PROXY(interface)));
+
+    if(IS_GATT_SERVICE1_PROXY(interface)) {
+        GattService1 *service = GATT_SERVICE1(interface);
+        object_index.add(path, BluetoothType::GATT_SERVICE,
+            to_index_string(gatt_service1_get_uuid(service)),
+            to_index_string(gatt_service1_get_device(service)));
+    }
+    else if(IS_GATT_CHARACTERISTIC1_PROXY(interface)) {
+        GattCharacteristic1 *characteristic = GATT_CHARACTERISTIC1(interface);
+        object_index.add(path, BluetoothType::GATT_CHARACTERISTIC,
+            to_index_string(gatt_characteristic1_get_uuid(characteristic)),
+            to_index_string(gatt_characteristic1_get_service(characteristic)));
+    }
+    else if(IS_GATT_DESCRIPTOR1_PROXY(interface)) {
+        GattDescriptor1 *descriptor = GATT_DESCRIPTOR1(interface);
+        object_index.add(path, BluetoothType::GATT_DESCRIPTOR,
+            to_index_string(gatt_descriptor1_get_uuid(descriptor)),
+            to_index_string(gatt_descriptor1_get_characteristic(descriptor)));
+    }
+    else if(IS_DEVICE1_PROXY(interface)) {
+        Device1 *device = DEVICE1(interface);
+        object_index.add(path, BluetoothType::DEVICE,
+            to_index_string(device1_get_address(device)),
+            to_index_string(device1_get_adapter(device)));
+    }
+    else if(IS_ADAPTER1_PROXY(interface)) {
+        Adapter1 *adapter = ADAPTER1(interface);
+        object_index.add(path, BluetoothType::ADAPTER,
+            to_index_string(adapter1_get_address(adapter)), std::string());
+    }
+}
+
+static void index_object(GDBusObject *object)
+{
+    GList *l, *interfaces = g_dbus_object_get_interfaces(object);
+
+    for(l = interfaces; l != NULL; l = l->next)
+        index_interface((GDBusInterface *)l->data);
+
+    g_list_free_full(interfaces, g_object_unref);
+}
+
 class tinyb::BluetoothEventManager {
 public:
     static void on_interface_added (GDBusObject *object,
@@ -49,30 +176,32 @@ public:
         if (info == NULL)
             return;
 
+        index_interface(interface);
+
         if(IS_GATT_SERVICE1_PROXY(interface)) {
             type = BluetoothType::GATT_SERVICE;
-            auto obj = new BluetoothGattService(GATT_SERVICE1(interface));
+            std::unique_ptr<BluetoothGattService> obj(new BluetoothGattService(GATT_SERVICE1(interface)));
             auto uuid = obj->get_uuid();
             auto parent = obj->get_device();
             manager->handle_event(type, nullptr, &uuid, &parent, *obj);
         }
         else if(IS_GATT_CHARACTERISTIC1_PROXY(interface)) {
             type = BluetoothType::GATT_CHARACTERISTIC;
-            auto obj = new BluetoothGattCharacteristic(GATT_CHARACTERISTIC1(interface));
+            std::unique_ptr<BluetoothGattCharacteristic> obj(new BluetoothGattCharacteristic(GATT_CHARACTERISTIC1(interface)));
             auto uuid = obj->get_uuid();
             auto parent = obj->get_service();
             manager->handle_event(type, nullptr, &uuid, &parent, *obj);
         }
         else if(IS_GATT_DESCRIPTOR1_PROXY(interface)) {
             type = BluetoothType::GATT_DESCRIPTOR;
-            auto obj = new BluetoothGattDescriptor(GATT_DESCRIPTOR1(interface));
+            std::unique_ptr<BluetoothGattDescriptor> obj(new BluetoothGattDescriptor(GATT_DESCRIPTOR1(interface)));
             auto uuid = obj->get_uuid();
             auto parent = obj->get_characteristic();
             manager->handle_event(type, nullptr, &uuid, &parent, *obj);
         }
         else if(IS_DEVICE1_PROXY(interface)) {
             type = BluetoothType::DEVICE;
-            auto obj = new BluetoothDevice(DEVICE1(interface));
+            std::unique_ptr<BluetoothDevice> obj(new BluetoothDevice(DEVICE1(interface)));
             auto name = obj->get_name();
             auto uuid = obj->get_address();
             auto parent = obj->get_adapter();
@@ -80,7 +209,7 @@ public:
         }
         else if(IS_ADAPTER1_PROXY(interface)) {
             type = BluetoothType::ADAPTER;
-            auto obj = new BluetoothAdapter(ADAPTER1(interface));
+            std::unique_ptr<BluetoothAdapter> obj(new BluetoothAdapter(ADAPTER1(interface)));
             auto name = obj->get_name();
             auto uuid = obj->get_address();
             manager->handle_event(type, &name, &uuid, nullptr, *obj);
@@ -96,6 +225,17 @@ public:
 
         g_list_free_full(interfaces, g_object_unref);
     }
+
+    static void on_interface_removed (GDBusObjectManager *manager,
+        GDBusObject *object, GDBusInterface *interface, gpointer user_data) {
+        /* Each BlueZ object implements a single indexed interface */
+        object_index.remove(std::string(g_dbus_object_get_object_path(object)));
+    }
+
+    static void on_object_removed (GDBusObjectManager *manager,
+        GDBusObject *object, gpointer user_data) {
+        object_index.remove(std::string(g_dbus_object_get_object_path(object)));
+    }
 };
 
 GDBusObjectManager *gdbus_manager = NULL;
@@ -134,10 +274,35 @@ std::unique_ptr<BluetoothObject> BluetoothManager::get_object(
     BluetoothType type, std::string *name, std::string *identifier,
     BluetoothObject *parent)
 {
-    auto list = get_objects(type, name, identifier, parent);
-    if (list.empty())
-        return std::unique_ptr<BluetoothObject>();
-    return std::move(list.front());
+    std::string parent_path;
+    if (parent != nullptr)
+        parent_path = parent->get_object_path();
+
+    auto paths = object_index.candidates(type, identifier,
+        parent != nullptr ? &parent_path : nullptr);
+
+    for (auto it = paths.begin(); it != paths.end(); ++it) {
+        GDBusObject *gobject = g_dbus_object_manager_get_object(gdbus_manager, it->c_str());
+        if (gobject == NULL)
+            continue; /* removed meanwhile */
+
+        Object *object = OBJECT(gobject);
+        std::unique_ptr<BluetoothObject> result =
+            BluetoothGattService::make(object, type, name, identifier, parent);
+        if (result == nullptr)
+            result = BluetoothGattCharacteristic::make(object, type, name, identifier, parent);
+        if (result == nullptr)
+            result = BluetoothGattDescriptor::make(object, type, name, identifier, parent);
+        if (result == nullptr)
+            result = BluetoothDevice::make(object, type, name, identifier, parent);
+        if (result == nullptr)
+            result = BluetoothAdapter::make(object, type, name, identifier, parent);
+
+        g_object_unref(gobject);
+        if (result != nullptr)
+            return result;
+    }
+    return std::unique_ptr<BluetoothObject>();
 }
 
 std::vector<std::unique_ptr<BluetoothObject>> BluetoothManager::get_objects(
@@ -207,32 +372,28 @@ std::weak_ptr<BluetoothEvent> BluetoothManager::find(BluetoothType type,
 void BluetoothManager::handle_event(BluetoothType type, std::string *name,
     std::string *identifier, BluetoothObject *parent, BluetoothObject &object)
 {
-    for (auto it = event_list.begin();
-        it != event_list.end();) {
-        if ((*it)->get_type() != BluetoothType::NONE && ((*it)->get_type()) != type) {
-            ++it;
+    /* Callbacks run without holding the lock, as they may add or remove events */
+    std::list<std::shared_ptr<BluetoothEvent>> events;
+    {
+        std::lock_guard<std::mutex> lock(event_list_lock);
+        events = event_list;
+    }
+
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        if ((*it)->get_type() != BluetoothType::NONE && ((*it)->get_type()) != type)
             continue; /* this event does not match */
-        }
         if ((*it)->get_name() != NULL)
-            if (name == NULL || *((*it)->get_name()) != *name) {
-                ++it;
+            if (name == NULL || *((*it)->get_name()) != *name)
                 continue; /* this event does not match */
-            }
         if ((*it)->get_identifier() != NULL)
-            if (identifier == NULL || *((*it)->get_identifier()) != *identifier) {
-                ++it;
+            if (identifier == NULL || *((*it)->get_identifier()) != *identifier)
                 continue; /* this event does not match */
-            }
         if ((*it)->get_parent() != NULL)
-            if (parent == NULL || *((*it)->get_parent()) != *parent) {
-                ++it;
+            if (parent == NULL || *((*it)->get_parent()) != *parent)
                 continue; /* this event does not match */
-            }
         /* The event matches, execute and see if it needs to reexecute */
         if ((*it)->execute_callback(object))
-            it = event_list.erase(it);
-        else
-            ++it;
+            remove_event(*it);
     }
 }
 
@@ -255,6 +416,16 @@ static gpointer init_manager_thread(void *data)
          G_CALLBACK(BluetoothEventManager::on_object_added),
          NULL);
 
+    g_signal_connect(gdbus_manager,
+        "interface-removed",
+         G_CALLBACK(BluetoothEventManager::on_interface_removed),
+         NULL);
+
+    g_signal_connect(gdbus_manager,
+        "object-removed",
+         G_CALLBACK(BluetoothEventManager::on_object_removed),
+         NULL);
+
     g_main_context_pop_thread_default(manager_context);
 
     g_main_loop_run(loop);
@@ -294,12 +465,13 @@ BluetoothManager::BluetoothManager() : event_list()
     default_adapter = nullptr;
     for (l = objects; l != NULL; l = l->next) {
         Object *object = (Object *) l->data;
+        index_object(G_DBUS_OBJECT(object));
+
         Adapter1 *adapter = object_get_adapter1(object);
-        if (adapter != NULL) {
+        if (adapter != NULL && default_adapter == nullptr)
             default_adapter = std::unique_ptr<BluetoothAdapter>(new BluetoothAdapter(adapter));
+        if (adapter != NULL)
             g_object_unref(adapter);
-            break;
-        }
     }
     g_list_free_full(objects, g_object_unref);
 
@@ -93,3 +93,10 @@ void tinyb::handle_error(GError *error)
         throw e;
     }
 }
+
+GDBusInterface *tinyb::get_cached_interface(const gchar *object_path, const gchar *interface_name)
+{
+    if (gdbus_manager == nullptr || object_path == nullptr)
+        return nullptr;
+    return g_dbus_object_manager_get_interface(gdbus_manager, object_path, interface_name);
+}
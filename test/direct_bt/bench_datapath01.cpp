@@ -0,0 +1,384 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <cppunit.h>
+
+#include <direct_bt/BasicTypes.hpp>
+#include <direct_bt/BTTypes.hpp>
+#include <direct_bt/HCITypes.hpp>
+#include <direct_bt/MgmtTypes.hpp>
+#include <direct_bt/ATTPDUTypes.hpp>
+#include <direct_bt/FunctionDef.hpp>
+#include <direct_bt/DiscoveryFilter.hpp>
+#include <direct_bt/ShardedHashMap.hpp>
+#include <direct_bt/GATTNumbers.hpp>
+#include <direct_bt/GATTAttributeTable.hpp>
+#include <direct_bt/PacketCapture.hpp>
+
+using namespace direct_bt;
+
+/**
+ * Micro benchmarks of the direct_bt receive data path,
+ * fed by a synthetic packet corpus and optionally by a recorded btsnoop capture of PacketCapture.
+ * <p>
+ * Usage: bench_datapath01 [-loops <n>] [-devices <n>] [-btsnoop <file>]
+ * </p>
+ * <p>
+ * Each benchmark prints its average duration per operation.
+ * The defaults are small, so that ctest only verifies the corpus and the benchmarks themselves.
+ * </p>
+ */
+static int loops = 10;
+static int deviceCount = 64;
+static std::string btsnoopFile;
+
+typedef std::vector<uint8_t> Packet;
+typedef std::vector<Packet> Corpus;
+
+static void printResult(const std::string & name, const int64_t t0_ns, const size_t ops) {
+    const int64_t td_ns = getCurrentNanoseconds() - t0_ns;
+    fprintf(stderr, "bench %-40s: %10zu ops, %10.1f ns/op\n", name.c_str(), ops,
+            0 < ops ? (double)td_ns / (double)ops : 0.0);
+}
+
+static uint32_t get_be32(const uint8_t * p, const int offset) {
+    p += offset;
+    return ( (uint32_t)p[0] << 24 ) | ( (uint32_t)p[1] << 16 ) | ( (uint32_t)p[2] << 8 ) | (uint32_t)p[3];
+}
+
+static EUI48 getDeviceAddress(const int i) {
+    const uint8_t b[6] = { (uint8_t)(i & 0xff), (uint8_t)((i >> 8) & 0xff), 0x33, 0x22, 0x11, 0xc0 };
+    return EUI48(b);
+}
+
+/** AD data of device i: flags, complete 16-bit UUIDs, complete name, manufacturer specific data and tx power */
+static Packet getADData(const int i) {
+    const std::string name = "Dev"+std::to_string(i);
+    Packet ad = { 0x02, 0x01, 0x06,
+                  0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18 };
+    ad.push_back( (uint8_t)(name.size() + 1) );
+    ad.push_back( 0x09 );
+    ad.insert(ad.end(), name.begin(), name.end());
+    const uint8_t msd[] = { 0x05, 0xff, 0x59, 0x00, (uint8_t)i, 0xbb, 0x02, 0x0a, 0xf4 };
+    ad.insert(ad.end(), msd, msd + sizeof(msd));
+    return ad;
+}
+
+/** HCI LE_ADVERTISING_REPORT event with one report of device i, including the HCI_EVENT_PKT type */
+static Packet getHCIAdvReport(const int i) {
+    const Packet ad = getADData(i);
+    Packet p = { 0x04, 0x3e, 0x00, 0x02 /* LE_ADVERTISING_REPORT */, 0x01 /* num_reports */,
+                 0x00 /* ADV_IND */, 0x01 /* random */ };
+    const EUI48 addr = getDeviceAddress(i);
+    p.insert(p.end(), addr.b, addr.b + 6);
+    p.push_back( (uint8_t)ad.size() );
+    p.insert(p.end(), ad.begin(), ad.end());
+    p.push_back( (uint8_t)(-40 - ( i % 40 )) ); // rssi
+    p[2] = (uint8_t)(p.size() - 3);
+    return p;
+}
+
+/** Mgmt DEVICE_FOUND event of device i */
+static Packet getMgmtDeviceFound(const int i) {
+    const Packet ad = getADData(i);
+    const EUI48 addr = getDeviceAddress(i);
+    Packet p(MGMT_HEADER_SIZE + 14 + ad.size(), 0);
+    put_uint16(p.data(), 0, static_cast<uint16_t>(MgmtEvent::Opcode::DEVICE_FOUND), true /* littleEndian */);
+    put_uint16(p.data(), 2, 0 /* dev_id */, true /* littleEndian */);
+    put_uint16(p.data(), 4, (uint16_t)(14 + ad.size()), true /* littleEndian */);
+    memcpy(p.data() + MGMT_HEADER_SIZE, addr.b, 6);
+    p[MGMT_HEADER_SIZE+6] = static_cast<uint8_t>(BDAddressType::BDADDR_LE_RANDOM);
+    p[MGMT_HEADER_SIZE+7] = (uint8_t)(-40 - ( i % 40 ));
+    put_uint16(p.data(), MGMT_HEADER_SIZE+12, (uint16_t)ad.size(), true /* littleEndian */);
+    memcpy(p.data() + MGMT_HEADER_SIZE + 14, ad.data(), ad.size());
+    return p;
+}
+
+/** ATT PDUs of the notification and read path */
+static Corpus getATTCorpus() {
+    Corpus c;
+    c.push_back( { (uint8_t)AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF, 0x03, 0x00, 0x64 } );
+    c.push_back( { (uint8_t)AttPDUMsg::Opcode::ATT_HANDLE_VALUE_IND, 0x13, 0x00, 0x01, 0x02, 0x03, 0x04 } );
+    c.push_back( { (uint8_t)AttPDUMsg::Opcode::ATT_READ_RSP, 'd', 'i', 'r', 'e', 'c', 't', '_', 'b', 't' } );
+    c.push_back( { (uint8_t)AttPDUMsg::Opcode::ATT_WRITE_RSP } );
+    c.push_back( { (uint8_t)AttPDUMsg::Opcode::ATT_ERROR_RSP, (uint8_t)AttPDUMsg::Opcode::ATT_READ_REQ, 0x03, 0x00, 0x0a } );
+    return c;
+}
+
+/**
+ * Appends the packets of a btsnoop file using the Linux Bluetooth Monitor datalink, as written by PacketCapture:
+ * HCI events to hciCorpus, Mgmt events to mgmtCorpus and received ATT PDUs to attCorpus.
+ */
+static bool readBTSnoop(const std::string & fname, Corpus & hciCorpus, Corpus & mgmtCorpus, Corpus & attCorpus) {
+    std::ifstream in(fname, std::ios::binary);
+    uint8_t header[16];
+    if( !in.read(reinterpret_cast<char*>(header), sizeof(header)) || 0 != memcmp(header, "btsnoop\0", 8) ) {
+        fprintf(stderr, "bench: Not a btsnoop file: %s\n", fname.c_str());
+        return false;
+    }
+    uint8_t rec[24];
+    while( in.read(reinterpret_cast<char*>(rec), sizeof(rec)) ) {
+        const uint32_t incl_len = get_be32(rec, 4);
+        const uint32_t flags = get_be32(rec, 8);
+        Packet data(incl_len);
+        if( !in.read(reinterpret_cast<char*>(data.data()), incl_len) ) {
+            break;
+        }
+        const uint16_t index = (uint16_t)( flags >> 16 );
+        switch( static_cast<PacketCapture::Opcode>( flags & 0xffff ) ) {
+            case PacketCapture::Opcode::EVENT_PKT:
+                data.insert(data.begin(), 0x04); // HCI_EVENT_PKT
+                hciCorpus.push_back(data);
+                break;
+            case PacketCapture::Opcode::ACL_RX_PKT:
+                // ACL header (4) and L2CAP header (4), keep the ATT channel only
+                if( 8 < data.size() && L2CAP_CID_ATT == get_uint16(data.data(), 6, true /* littleEndian */) ) {
+                    attCorpus.push_back( Packet(data.begin() + 8, data.end()) );
+                }
+                break;
+            case PacketCapture::Opcode::CTRL_EVENT:
+                // cookie (4), opcode (2) and parameter -> opcode, index, length and parameter
+                if( 6 <= data.size() ) {
+                    Packet p(MGMT_HEADER_SIZE + data.size() - 6);
+                    p[0] = data[4];
+                    p[1] = data[5];
+                    put_uint16(p.data(), 2, index, true /* littleEndian */);
+                    put_uint16(p.data(), 4, (uint16_t)(data.size() - 6), true /* littleEndian */);
+                    std::copy(data.begin() + 6, data.end(), p.begin() + MGMT_HEADER_SIZE);
+                    mgmtCorpus.push_back(p);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    fprintf(stderr, "bench: %s: %zu HCI events, %zu Mgmt events, %zu ATT PDUs\n",
+            fname.c_str(), hciCorpus.size(), mgmtCorpus.size(), attCorpus.size());
+    return true;
+}
+
+class Cppunit_tests : public Cppunit {
+  private:
+    Corpus hciCorpus, mgmtCorpus, attCorpus;
+    int dispatched = 0;
+
+    bool mgmtEvent(const MgmtEvent & e) {
+        dispatched += static_cast<int>(e.getOpcode());
+        return true;
+    }
+
+    void bench_read_ad_reports() {
+        const bool lazyModes[] = { false, true };
+        for(const bool lazy : lazyModes) {
+            size_t ops = 0, ok = 0;
+            const int64_t t0 = getCurrentNanoseconds();
+            for(int l=0; l<loops; l++) {
+                for(const Packet & p : hciCorpus) {
+                    if( 5 < p.size() && 0x3e == p[1] && 0x02 == p[3] ) {
+                        auto reports = EInfoReport::read_ad_reports(p.data() + 4, (uint8_t)(p.size() - 4), lazy, 1);
+                        ok += 0 < reports.size() ? 1 : 0;
+                        ops++;
+                    }
+                }
+            }
+            printResult(std::string("EInfoReport::read_ad_reports")+( lazy ? " lazy" : ""), t0, ops);
+            CHECK( ok, ops );
+        }
+    }
+
+    void bench_hci_getSpecialized() {
+        size_t ops = 0, ok = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        for(int l=0; l<loops; l++) {
+            for(const Packet & p : hciCorpus) {
+                std::unique_ptr<HCIEvent> e( HCIEvent::getSpecialized(p.data(), (int)p.size()) );
+                ok += nullptr != e ? 1 : 0;
+                ops++;
+            }
+        }
+        printResult("HCIEvent::getSpecialized", t0, ops);
+        CHECK( ok, ops );
+    }
+
+    void bench_att_getSpecialized() {
+        size_t ops = 0, ok = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        for(int l=0; l<loops; l++) {
+            for(const Packet & p : attCorpus) {
+                std::unique_ptr<const AttPDUMsg> e( AttPDUMsg::getSpecialized(p.data(), (int)p.size()) );
+                ok += nullptr != e ? 1 : 0;
+                ops++;
+            }
+        }
+        printResult("AttPDUMsg::getSpecialized", t0, ops);
+        CHECK( ok, ops );
+    }
+
+    void bench_mgmt_getSpecialized() {
+        size_t ops = 0, ok = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        for(int l=0; l<loops; l++) {
+            for(const Packet & p : mgmtCorpus) {
+                std::unique_ptr<MgmtEvent> e( MgmtEvent::getSpecialized(p.data(), (int)p.size()) );
+                ok += nullptr != e ? 1 : 0;
+                ops++;
+            }
+        }
+        printResult("MgmtEvent::getSpecialized", t0, ops);
+        CHECK( ok, ops );
+    }
+
+    /**
+     * The steps of DBTAdapter::mgmtEvDeviceFoundHCI() and DBTAdapter::deviceFoundEIR() not requiring an adapter:
+     * EInfoReport creation from the Mgmt event, the DiscoveryFilter and the discovered device index lookup.
+     */
+    void bench_device_found() {
+        DiscoveryFilter filter;
+        filter.addService(uuid_value_t(uuid16_t(0x180f))).setMinRSSI(-100);
+        ShardedHashMap<BDAddressKey, std::shared_ptr<EInfoReport>> discovered;
+
+        size_t ops = 0, found = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        for(int l=0; l<loops; l++) {
+            for(const Packet & p : mgmtCorpus) {
+                std::unique_ptr<MgmtEvent> e( MgmtEvent::getSpecialized(p.data(), (int)p.size()) );
+                if( MgmtEvent::Opcode::DEVICE_FOUND != e->getOpcode() ) {
+                    continue;
+                }
+                const MgmtEvtDeviceFound & df = *static_cast<const MgmtEvtDeviceFound *>(e.get());
+                std::shared_ptr<EInfoReport> eir(new EInfoReport());
+                eir->setSource(EInfoReport::Source::EIR_MGMT);
+                eir->setTimestamp(df.getTimestamp());
+                eir->setEvtType(AD_PDU_Type::ADV_IND);
+                eir->setAddressType(df.getAddressType());
+                eir->setAddress(df.getAddress());
+                eir->setRSSI(df.getRSSI());
+                eir->read_data(df.getData(), df.getDataSize());
+                ops++;
+                if( !filter.match(*eir) ) {
+                    continue;
+                }
+                const BDAddressKey key(eir->getAddress(), eir->getAddressType());
+                if( nullptr != discovered.get(key) ) {
+                    found++;
+                } else {
+                    discovered.put(key, eir);
+                }
+            }
+        }
+        printResult("DeviceFound "+std::to_string(deviceCount)+" devices", t0, ops);
+        CHECKT( found <= ops );
+    }
+
+    /** Value handle of the l-th characteristic modulo all, layed out by bench_find_characteristic() */
+    static uint16_t getValueHandle(const int l, const int serviceCount, const int charPerService) {
+        const int i = l % ( serviceCount * charPerService );
+        return (uint16_t)( 1 + ( i / charPerService ) * ( 1 + 2 * charPerService ) + 2 * ( i % charPerService ) + 2 );
+    }
+
+    static GATTCharacteristicRef findLinear(const uint16_t valueHandle, std::vector<GATTServiceRef> & services) {
+        // Same as GATTHandler::findCharacterisicsByValueHandle(handle, services)
+        for(auto it = services.begin(); it != services.end(); it++) {
+            for(auto jt = (*it)->characteristicList.begin(); jt != (*it)->characteristicList.end(); jt++) {
+                if( valueHandle == (*jt)->value_handle ) {
+                    return *jt;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void bench_find_characteristic() {
+        const int serviceCount = 8, charPerService = 8;
+        std::shared_ptr<DBTDevice> device = nullptr;
+        std::vector<GATTServiceRef> services;
+        uint16_t handle = 1;
+        for(int i=0; i<serviceCount; i++) {
+            const uint16_t start = handle++;
+            GATTServiceRef s( new GATTService(device, true, start, (uint16_t)(start + 2*charPerService),
+                                              std::shared_ptr<const uuid_t>(new uuid16_t((uint16_t)(0x1800+i)))) );
+            for(int j=0; j<charPerService; j++) {
+                const uint16_t decl = handle++;
+                const uint16_t value = handle++;
+                s->characteristicList.push_back( GATTCharacteristicRef( new GATTCharacteristic(s, start, decl, GATTCharacteristic::Notify, value,
+                                                 std::shared_ptr<const uuid_t>(new uuid16_t((uint16_t)(0x2a00+j)))) ) );
+            }
+            services.push_back(s);
+        }
+        const GATTAttributeTable table(services);
+        const int lookups = loops * 1000;
+        {
+            int ok = 0;
+            const int64_t t0 = getCurrentNanoseconds();
+            for(int l=0; l<lookups; l++) {
+                const uint16_t h = getValueHandle(l, serviceCount, charPerService);
+                ok += nullptr != findLinear(h, services) ? 1 : 0;
+            }
+            printResult("findCharacterisicsByValueHandle linear", t0, lookups);
+            CHECK( ok, lookups );
+        }
+        {
+            int ok = 0;
+            const int64_t t0 = getCurrentNanoseconds();
+            for(int l=0; l<lookups; l++) {
+                const uint16_t h = getValueHandle(l, serviceCount, charPerService);
+                ok += nullptr != table.getCharacteristicByValueHandle(h) ? 1 : 0;
+            }
+            printResult("findCharacterisicsByValueHandle table", t0, lookups);
+            CHECK( ok, lookups );
+        }
+    }
+
+    void bench_functiondef() {
+        FunctionDef<bool, const MgmtEvent&> f = bindMemberFunc(this, &Cppunit_tests::mgmtEvent);
+        std::unique_ptr<MgmtEvent> e( MgmtEvent::getSpecialized(mgmtCorpus[0].data(), (int)mgmtCorpus[0].size()) );
+        const int invocations = loops * 10000;
+        dispatched = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        for(int l=0; l<invocations; l++) {
+            f.invoke(*e);
+        }
+        printResult("FunctionDef::invoke", t0, invocations);
+        CHECK( dispatched, invocations * static_cast<int>(e->getOpcode()) );
+    }
+
+  public:
+    void single_test() override {
+        for(int i=0; i<deviceCount; i++) {
+            hciCorpus.push_back(getHCIAdvReport(i));
+            mgmtCorpus.push_back(getMgmtDeviceFound(i));
+        }
+        attCorpus = getATTCorpus();
+        if( 0 < btsnoopFile.size() ) {
+            CHECKT( readBTSnoop(btsnoopFile, hciCorpus, mgmtCorpus, attCorpus) );
+        }
+        bench_read_ad_reports();
+        bench_hci_getSpecialized();
+        bench_att_getSpecialized();
+        bench_mgmt_getSpecialized();
+        bench_device_found();
+        bench_find_characteristic();
+        bench_functiondef();
+    }
+};
+
+int main(int argc, char *argv[]) {
+    for(int i=1; i<argc; i++) {
+        if( !strcmp("-loops", argv[i]) && argc > (i+1) ) {
+            loops = atoi(argv[++i]);
+        } else if( !strcmp("-devices", argv[i]) && argc > (i+1) ) {
+            deviceCount = std::max(1, atoi(argv[++i]));
+        } else if( !strcmp("-btsnoop", argv[i]) && argc > (i+1) ) {
+            btsnoopFile = std::string(argv[++i]);
+        }
+    }
+    fprintf(stderr, "bench: loops %d, devices %d, btsnoop '%s'\n", loops, deviceCount, btsnoopFile.c_str());
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,346 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <cppunit.h>
+
+#include <direct_bt/BasicTypes.hpp>
+#include <direct_bt/BTTypes.hpp>
+#include <direct_bt/HCIComm.hpp>
+#include <direct_bt/HCITypes.hpp>
+#include <direct_bt/ATTPDUTypes.hpp>
+
+extern "C" {
+    #include <unistd.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+}
+
+using namespace direct_bt;
+
+/**
+ * End-to-end benchmark of the HCI transport against a simulated controller and peripheral,
+ * connected via a SOCK_SEQPACKET socketpair plugged in as HCIComm transport, see HCIComm::setTransport().
+ * <p>
+ * Measures the scan event throughput, the LE connect latency and the ATT notification throughput
+ * as received by HCIComm::read_batch() and decoded by HCIEvent::getSpecialized(),
+ * EInfoReport::read_ad_reports() and AttPDUMsg::getSpecialized(), without requiring any Bluetooth hardware.
+ * </p>
+ * <p>
+ * Usage: bench_loopback01 [-devices <n>] [-events <n>] [-reports <n>] [-connects <n>] [-notifications <n>] [-ntfsize <n>]
+ * </p>
+ */
+static int deviceCount = 64;
+static int advEventCount = 1000;
+static int reportsPerEvent = 1;
+static int connectCount = 100;
+static int notificationCount = 1000;
+static int notificationSize = 20;
+
+static const uint16_t OPC_LE_SET_SCAN_ENABLE = 0x200C;
+static const uint16_t OPC_LE_CREATE_CONN = 0x200D;
+static const uint16_t CONN_HANDLE = 0x0040;
+static const uint16_t NTF_HANDLE = 0x0003;
+static const int BUFFER_SIZE = 1028;
+
+/**
+ * Simulated controller and peripheral, answering HCI commands and ATT requests:
+ * <pre>
+ * - LE_SET_SCAN_ENABLE: CMD_COMPLETE, then advEventCount LE_ADVERTISING_REPORT events cycling through deviceCount devices
+ * - LE_CREATE_CONN: CMD_STATUS, then LE_CONN_COMPLETE
+ * - ATT_WRITE_REQ: ATT_WRITE_RSP, then notificationCount ATT_HANDLE_VALUE_NTF of notificationSize
+ * - any other command: CMD_COMPLETE
+ * </pre>
+ */
+class SimController {
+    private:
+        int fd;
+        std::thread thread;
+
+        static void put16(std::vector<uint8_t> & p, const uint16_t v) {
+            p.push_back( (uint8_t)( v & 0xff ) );
+            p.push_back( (uint8_t)( v >> 8 ) );
+        }
+
+        void send(const std::vector<uint8_t> & p) {
+            while( 0 > ::write(fd, p.data(), p.size()) && ( EINTR == errno || EAGAIN == errno ) ) { }
+        }
+
+        void sendCmdComplete(const uint16_t opc) {
+            std::vector<uint8_t> p = { 0x04, 0x0e, 0x04, 0x01 };
+            put16(p, opc);
+            p.push_back(0x00); // status
+            send(p);
+        }
+
+        void sendCmdStatus(const uint16_t opc) {
+            std::vector<uint8_t> p = { 0x04, 0x0f, 0x04, 0x00, 0x01 };
+            put16(p, opc);
+            send(p);
+        }
+
+        void sendAdvertising() {
+            const uint8_t ad[] = { 0x02, 0x01, 0x06,
+                                   0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18,
+                                   0x05, 0x09, 'S', 'i', 'm', '0',
+                                   0x05, 0xff, 0x59, 0x00, 0xaa, 0xbb };
+            int dev = 0;
+            for(int e=0; e<advEventCount; e++) {
+                const int n = reportsPerEvent;
+                std::vector<uint8_t> p = { 0x04, 0x3e, 0x00, 0x02 /* LE_ADVERTISING_REPORT */, (uint8_t)n };
+                for(int i=0; i<n; i++) { p.push_back(0x00); } // ADV_IND
+                for(int i=0; i<n; i++) { p.push_back(0x01); } // random
+                for(int i=0; i<n; i++) {
+                    const int d = ( dev + i ) % deviceCount;
+                    const uint8_t addr[] = { (uint8_t)(d & 0xff), (uint8_t)(d >> 8), 0x33, 0x22, 0x11, 0xc0 };
+                    p.insert(p.end(), addr, addr + 6);
+                }
+                for(int i=0; i<n; i++) { p.push_back(sizeof(ad)); }
+                for(int i=0; i<n; i++) { p.insert(p.end(), ad, ad + sizeof(ad)); }
+                for(int i=0; i<n; i++) { p.push_back( (uint8_t)(-50) ); }
+                p[2] = (uint8_t)(p.size() - 3);
+                send(p);
+                dev = ( dev + n ) % deviceCount;
+            }
+        }
+
+        void sendConnComplete(const uint8_t * peer) {
+            std::vector<uint8_t> p = { 0x04, 0x3e, 19, 0x01 /* LE_CONN_COMPLETE */, 0x00 /* status */ };
+            put16(p, CONN_HANDLE);
+            p.push_back(0x00); // role master
+            p.push_back(0x01); // random
+            p.insert(p.end(), peer, peer + 6);
+            put16(p, 24); // interval
+            put16(p, 0);  // latency
+            put16(p, 500); // supervision timeout
+            p.push_back(0x00); // clock accuracy
+            send(p);
+        }
+
+        void sendACL(const std::vector<uint8_t> & att) {
+            std::vector<uint8_t> p = { 0x02 };
+            put16(p, CONN_HANDLE | 0x2000); // first automatically flushable
+            put16(p, (uint16_t)( 4 + att.size() ));
+            put16(p, (uint16_t)att.size());
+            put16(p, L2CAP_CID_ATT);
+            p.insert(p.end(), att.begin(), att.end());
+            send(p);
+        }
+
+        void sendNotifications() {
+            std::vector<uint8_t> ntf = { AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF };
+            put16(ntf, NTF_HANDLE);
+            for(int i=0; i<notificationSize; i++) { ntf.push_back( (uint8_t)i ); }
+            for(int i=0; i<notificationCount; i++) {
+                ntf[3] = (uint8_t)i;
+                sendACL(ntf);
+            }
+        }
+
+        void run() {
+            uint8_t buffer[BUFFER_SIZE];
+            for(;;) {
+                const ssize_t len = ::read(fd, buffer, sizeof(buffer));
+                if( 0 >= len ) {
+                    if( 0 > len && EINTR == errno ) {
+                        continue;
+                    }
+                    break; // host closed
+                }
+                if( 0x01 == buffer[0] && 4 <= len ) {
+                    const uint16_t opc = get_uint16(buffer, 1, true /* littleEndian */);
+                    if( OPC_LE_SET_SCAN_ENABLE == opc ) {
+                        sendCmdComplete(opc);
+                        if( 0 != buffer[4] ) {
+                            sendAdvertising();
+                        }
+                    } else if( OPC_LE_CREATE_CONN == opc && 4+25 <= len ) {
+                        sendCmdStatus(opc);
+                        sendConnComplete(buffer + 4 + 6);
+                    } else {
+                        sendCmdComplete(opc);
+                    }
+                } else if( 0x02 == buffer[0] && 10 <= len && AttPDUMsg::Opcode::ATT_WRITE_REQ == buffer[9] ) {
+                    sendACL( { AttPDUMsg::Opcode::ATT_WRITE_RSP } );
+                    sendNotifications();
+                }
+            }
+        }
+
+    public:
+        SimController(const int fd_) : fd(fd_) {
+            thread = std::thread(&SimController::run, this);
+        }
+
+        ~SimController() {
+            ::shutdown(fd, SHUT_RDWR);
+            thread.join();
+            ::close(fd);
+        }
+};
+
+/** Host end of the socketpair, handed to the next HCIComm via transportOpen() */
+static int hostFD = -1;
+
+static int transportOpen(const uint16_t dev_id, const uint16_t channel) {
+    (void)dev_id;
+    (void)channel;
+    const int fd = hostFD;
+    hostFD = -1;
+    if( 0 > fd ) {
+        errno = ENODEV;
+    }
+    return fd;
+}
+
+class Cppunit_tests : public Cppunit {
+  private:
+    uint8_t buffers[HCIComm::MAX_READ_BATCH * BUFFER_SIZE];
+    int lengths[HCIComm::MAX_READ_BATCH];
+
+    static void printRate(const std::string & name, const int64_t t0_ns, const int count, const std::string & unit) {
+        const int64_t td_ns = getCurrentNanoseconds() - t0_ns;
+        fprintf(stderr, "bench %-28s: %8d %s in %8.3f ms, %12.1f %s/s\n", name.c_str(), count, unit.c_str(),
+                (double)td_ns / 1000000.0, 0 < td_ns ? (double)count * 1000000000.0 / (double)td_ns : 0.0, unit.c_str());
+    }
+
+    void writeCommand(HCIComm & hci, const uint16_t opc, const std::vector<uint8_t> & param) {
+        std::vector<uint8_t> p = { 0x01, (uint8_t)( opc & 0xff ), (uint8_t)( opc >> 8 ), (uint8_t)param.size() };
+        p.insert(p.end(), param.begin(), param.end());
+        CHECK( hci.write(p.data(), (int)p.size()), (int)p.size() );
+    }
+
+    void bench_scan(HCIComm & hci) {
+        int events = 0, reports = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        writeCommand(hci, OPC_LE_SET_SCAN_ENABLE, { 0x01, 0x00 });
+        while( events < advEventCount ) {
+            const int n = hci.read_batch(buffers, BUFFER_SIZE, lengths, HCIComm::MAX_READ_BATCH, 1000);
+            if( 0 > n ) {
+                break;
+            }
+            for(int i=0; i<n; i++) {
+                std::unique_ptr<HCIEvent> e( HCIEvent::getSpecialized(buffers + i * BUFFER_SIZE, lengths[i]) );
+                if( nullptr != e && e->isMetaEvent(HCIMetaEventType::LE_ADVERTISING_REPORT) ) {
+                    reports += EInfoReport::read_ad_reports(e->getParam(), e->getParamSize(), false, 1).size();
+                    events++;
+                }
+            }
+        }
+        printRate("scan events", t0, events, "events");
+        printRate("scan reports", t0, reports, "reports");
+        CHECK( events, advEventCount );
+        CHECK( reports, advEventCount * reportsPerEvent );
+    }
+
+    void bench_connect(HCIComm & hci) {
+        const std::vector<uint8_t> param = { 0x60, 0x00, 0x30, 0x00, 0x00 /* filter */, 0x01 /* random */,
+                                             0x01, 0x00, 0x33, 0x22, 0x11, 0xc0,
+                                             0x00 /* own public */, 0x18, 0x00, 0x28, 0x00, 0x00, 0x00, 0xf4, 0x01, 0x00, 0x00, 0x00, 0x00 };
+        int connected = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        for(int c=0; c<connectCount; c++) {
+            writeCommand(hci, OPC_LE_CREATE_CONN, param);
+            bool done = false;
+            while( !done ) {
+                const int n = hci.read_batch(buffers, BUFFER_SIZE, lengths, HCIComm::MAX_READ_BATCH, 1000);
+                if( 0 > n ) {
+                    break;
+                }
+                for(int i=0; i<n; i++) {
+                    std::unique_ptr<HCIEvent> e( HCIEvent::getSpecialized(buffers + i * BUFFER_SIZE, lengths[i]) );
+                    if( nullptr != e && e->isMetaEvent(HCIMetaEventType::LE_CONN_COMPLETE) ) {
+                        done = true;
+                        connected++;
+                    }
+                }
+            }
+            if( !done ) {
+                break;
+            }
+        }
+        const int64_t td_ns = getCurrentNanoseconds() - t0;
+        fprintf(stderr, "bench %-28s: %8d connects, %12.1f us/connect\n", "connect latency", connected,
+                0 < connected ? (double)td_ns / 1000.0 / (double)connected : 0.0);
+        CHECK( connected, connectCount );
+    }
+
+    void bench_notifications(HCIComm & hci) {
+        // ACL: ATT_WRITE_REQ of the notification's CCCD, enabling notifications
+        const uint8_t req[] = { 0x02, (uint8_t)( CONN_HANDLE & 0xff ), (uint8_t)( ( CONN_HANDLE >> 8 ) | 0x20 ), 9, 0,
+                                5, 0, L2CAP_CID_ATT, 0,
+                                AttPDUMsg::Opcode::ATT_WRITE_REQ, NTF_HANDLE+1, 0, 0x01, 0x00 };
+        int notifications = 0;
+        size_t bytes = 0;
+        const int64_t t0 = getCurrentNanoseconds();
+        CHECK( hci.write(req, sizeof(req)), (int)sizeof(req) );
+        while( notifications < notificationCount ) {
+            const int n = hci.read_batch(buffers, BUFFER_SIZE, lengths, HCIComm::MAX_READ_BATCH, 1000);
+            if( 0 > n ) {
+                break;
+            }
+            for(int i=0; i<n; i++) {
+                const uint8_t * p = buffers + i * BUFFER_SIZE;
+                if( 0x02 != p[0] || 9 >= lengths[i] || L2CAP_CID_ATT != get_uint16(p, 7, true /* littleEndian */) ) {
+                    continue;
+                }
+                std::unique_ptr<const AttPDUMsg> pdu( AttPDUMsg::getSpecialized(p + 9, lengths[i] - 9) );
+                if( nullptr != pdu && AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF == pdu->getOpcode() ) {
+                    const AttHandleValueRcv * ntf = static_cast<const AttHandleValueRcv*>(pdu.get());
+                    bytes += ntf->getValue().getSize();
+                    notifications++;
+                }
+            }
+        }
+        printRate("notifications", t0, notifications, "ntf");
+        printRate("notification payload", t0, (int)bytes, "bytes");
+        CHECK( notifications, notificationCount );
+    }
+
+  public:
+    void single_test() override {
+        int fds[2];
+        CHECK( ::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0 );
+        hostFD = fds[0];
+        SimController controller(fds[1]);
+
+        HCIComm::setTransport(transportOpen);
+        {
+            HCIComm hci(0, HCI_CHANNEL_RAW);
+            HCIComm::setTransport(nullptr);
+            CHECKT( hci.isOpen() );
+
+            bench_scan(hci);
+            bench_connect(hci);
+            bench_notifications(hci);
+            hci.close();
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    for(int i=1; i<argc; i++) {
+        if( !strcmp("-devices", argv[i]) && argc > (i+1) ) {
+            deviceCount = std::max(1, atoi(argv[++i]));
+        } else if( !strcmp("-events", argv[i]) && argc > (i+1) ) {
+            advEventCount = atoi(argv[++i]);
+        } else if( !strcmp("-reports", argv[i]) && argc > (i+1) ) {
+            reportsPerEvent = std::min(std::max(1, atoi(argv[++i])), 8); // fitting into one event
+        } else if( !strcmp("-connects", argv[i]) && argc > (i+1) ) {
+            connectCount = atoi(argv[++i]);
+        } else if( !strcmp("-notifications", argv[i]) && argc > (i+1) ) {
+            notificationCount = atoi(argv[++i]);
+        } else if( !strcmp("-ntfsize", argv[i]) && argc > (i+1) ) {
+            notificationSize = std::min(std::max(1, atoi(argv[++i])), 512);
+        }
+    }
+    fprintf(stderr, "bench: devices %d, events %d, reports/event %d, connects %d, notifications %d of %d bytes\n",
+            deviceCount, advEventCount, reportsPerEvent, connectCount, notificationCount, notificationSize);
+
+    Cppunit_tests test1;
+    return test1.run();
+}
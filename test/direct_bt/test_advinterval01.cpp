@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTTypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            AdvIntervalEstimator e;
+            CHECK( e.getInterval(), 0 );
+            e.add(1000);
+            CHECK( e.size(), 0 );
+            CHECK( e.getInterval(), 0 );
+            // scan response of the same event
+            e.add(1003);
+            CHECK( e.size(), 0 );
+            e.add(1105);
+            e.add(1108);
+            e.add(1210);
+            CHECK( e.size(), 2 );
+            CHECK( e.getInterval(), 105 );
+        }
+        {
+            // missed events and advDelay, the minimum gap wins
+            AdvIntervalEstimator e;
+            const uint64_t ts[] = { 5000, 5307, 5410, 5718, 5822, 6028 };
+            for(uint64_t t : ts) {
+                e.add(t);
+            }
+            CHECK( e.size(), 5 );
+            CHECK( e.getInterval(), 103 );
+            // discovery pause is ignored
+            e.add(60000);
+            CHECK( e.size(), 5 );
+            e.add(60250);
+            CHECK( e.size(), 6 );
+            CHECK( e.getInterval(), 103 );
+            // recent gaps only
+            for(int i=1; i<=AdvIntervalEstimator::CAPACITY; ++i) {
+                e.add(60250 + i*1000);
+            }
+            CHECK( e.size(), AdvIntervalEstimator::CAPACITY );
+            CHECK( e.getInterval(), 1000 );
+            e.clear();
+            CHECK( e.getInterval(), 0 );
+        }
+        {
+            CHECK( AdvIntervalEstimator::getConnectScanWindow(0), 48 );
+            CHECK( AdvIntervalEstimator::getConnectScanWindow(20), 48 );
+            CHECK( AdvIntervalEstimator::getConnectScanWindow(100), 176 );
+            CHECK( AdvIntervalEstimator::getConnectScanWindow(1000), 1616 );
+            CHECK( AdvIntervalEstimator::getConnectScanWindow(10240), 0x4000 );
+            CHECK( AdvIntervalEstimator::getConnectScanWindow(20000), 0x4000 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
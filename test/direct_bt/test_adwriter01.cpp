@@ -0,0 +1,146 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/BTTypes.hpp>
+#include <direct_bt/HCITypes.hpp>
+#include <direct_bt/LEAdvertiser.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            // AD fields round trip via EInfoReport
+            uint8_t storage[AdvertisingParameter::LEGACY_MAX_DATA_LEN];
+            TOctets buffer(storage, sizeof(storage));
+            ADWriter w(buffer);
+            CHECK( w.getCapacity(), 31 );
+            CHECKT( w.addFlags(AD_FLAGS_GENERAL_MODE_BIT) );
+            CHECKT( w.addTxPower(-4) );
+            uint8_t * value = w.addManufacturerData(0x0059, 4);
+            CHECKT( nullptr != value );
+            CHECK( w.getSize(), 3 + 3 + 8 );
+            CHECKT( w.addName("TestDevice") );
+            CHECK( w.getSize(), 14 + 12 );
+            CHECKT( !w.hasOverflow() );
+
+            value[0] = 0x01; value[1] = 0x02; value[2] = 0x03; value[3] = 0x04;
+            EInfoReport eir;
+            const TROOctets data = w.getData();
+            eir.read_data(data.get_ptr(), data.getSize());
+            CHECK( eir.getFlags(), AD_FLAGS_GENERAL_MODE_BIT );
+            CHECK( eir.getTxPower(), -4 );
+            CHECKT( eir.getName() == "TestDevice" );
+            std::shared_ptr<ManufactureSpecificData> msd = eir.getManufactureSpecificData();
+            CHECKT( nullptr != msd );
+            CHECK( msd->company, 0x0059 );
+            CHECK( msd->data.getSize(), 4 );
+            CHECK( msd->data.get_uint8(3), 0x04 );
+
+            // in place payload update w/o re-encoding the other fields
+            value[3] = 0x05;
+            EInfoReport eir2;
+            eir2.read_data(data.get_ptr(), data.getSize());
+            CHECK( eir2.getManufactureSpecificData()->data.get_uint8(3), 0x05 );
+        }
+        {
+            // overflow drops the field, name falls back to the shortened name
+            uint8_t storage[16];
+            TOctets buffer(storage, sizeof(storage));
+            ADWriter w(buffer);
+            CHECKT( w.addFlags(AD_FLAGS_GENERAL_MODE_BIT) );
+            CHECKT( nullptr == w.addServiceData(0x180f, 12) );
+            CHECKT( w.hasOverflow() );
+            CHECK( w.getSize(), 3 );
+            CHECKT( w.addName("A_Long_Device_Name") );
+            CHECK( w.getSize(), 16 );
+            CHECK( w.getRemaining(), 0 );
+            EInfoReport eir;
+            eir.read_data(w.getData().get_ptr(), w.getSize());
+            CHECKT( eir.getShortName() == "A_Long_Devi" );
+            CHECKT( !w.addTxPower(0) );
+            w.clear();
+            CHECK( w.getSize(), 0 );
+            CHECKT( !w.hasOverflow() );
+            CHECKT( w.addServiceUUID(uuid16_t(0x180f)) );
+            CHECK( w.getSize(), 4 );
+        }
+        {
+            // LE Set Extended Advertising Data command encoding
+            const uint8_t data[] = { 0x02, 0x01, 0x06 };
+            HCILESetExtAdvDataCmd cmd(false, 3, HCILESetExtAdvDataCmd::OP_COMPLETE, HCILESetExtAdvDataCmd::FRAG_MINIMIZE, data, sizeof(data));
+            CHECK( static_cast<uint16_t>(cmd.getOpcode()), 0x2037 );
+            CHECK( cmd.getParamSize(), 4 + 3 );
+            const uint8_t * p = cmd.getParam();
+            CHECK( p[0], 3 );
+            CHECK( p[1], 0x03 );
+            CHECK( p[2], 0x01 );
+            CHECK( p[3], 3 );
+            CHECK( p[6], 0x06 );
+
+            HCILESetExtAdvDataCmd rsp(true, 0, HCILESetExtAdvDataCmd::OP_LAST, HCILESetExtAdvDataCmd::FRAG_ALLOWED, data, 0);
+            CHECK( static_cast<uint16_t>(rsp.getOpcode()), 0x2038 );
+            CHECK( rsp.getParamSize(), 4 );
+
+            uint8_t big[HCILESetExtAdvDataCmd::MAX_DATA_LEN+1];
+            memset(big, 0, sizeof(big));
+            HCILESetExtAdvDataCmd max(false, 0, HCILESetExtAdvDataCmd::OP_FIRST, HCILESetExtAdvDataCmd::FRAG_ALLOWED, big, HCILESetExtAdvDataCmd::MAX_DATA_LEN);
+            CHECK( max.getParamSize(), 255 );
+            bool thrown = false;
+            try {
+                HCILESetExtAdvDataCmd tooBig(false, 0, HCILESetExtAdvDataCmd::OP_FIRST, HCILESetExtAdvDataCmd::FRAG_ALLOWED, big, sizeof(big));
+            } catch (IllegalArgumentException &e) {
+                thrown = true;
+            }
+            CHECKT( thrown );
+        }
+        {
+            // LE Set Extended Advertising Enable command encoding
+            const HCILESetExtAdvEnableCmd::Set sets[] = { { 1, 0x0102, 0 }, { 2, 0, 5 } };
+            HCILESetExtAdvEnableCmd cmd(true, sets, 2);
+            CHECK( static_cast<uint16_t>(cmd.getOpcode()), 0x2039 );
+            CHECK( cmd.getParamSize(), 2 + 2 * 4 );
+            const uint8_t * p = cmd.getParam();
+            CHECK( p[0], 1 );
+            CHECK( p[1], 2 );
+            CHECK( p[2], 1 );
+            CHECK( p[3], 0x02 );
+            CHECK( p[4], 0x01 );
+            CHECK( p[6], 2 );
+            CHECK( p[9], 5 );
+
+            HCILESetExtAdvEnableCmd all(false, nullptr, 0);
+            CHECK( all.getParamSize(), 2 );
+        }
+        {
+            // AdvertisingParameter
+            AdvertisingParameter p;
+            CHECKT( p.isValid() );
+            CHECKT( p.isLegacy() );
+            CHECK( p.getMaxDataLength(), 31 );
+            p.properties = AdvertisingParameter::CONNECTABLE;
+            CHECK( p.getMaxDataLength(), HCILESetExtAdvDataCmd::MAX_DATA_LEN );
+            p.interval_min = 0x10;
+            CHECKT( !p.isValid() );
+            p.interval_min = 0x100;
+            p.interval_max = 0x80;
+            CHECKT( !p.isValid() );
+            p.interval_max = 0x100;
+            p.channel_map = 0;
+            CHECKT( !p.isValid() );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -28,6 +28,18 @@ class Cppunit_tests: public Cppunit {
 
         CHECK(req.getStartHandle(), 1);
         CHECK(req.getEndHandle(), 0xffff);
+
+        // Write PDUs filled in place equal those copying the value
+        const uint8_t v[] = { 0x01, 0x02, 0x03, 0x04 };
+        const AttWriteReq wreq(0x0042, TROOctets(v, sizeof(v)));
+        AttWriteReq wreqFill(0x0042, static_cast<int>(sizeof(v)));
+        memcpy(wreqFill.getValueWPtr(), v, sizeof(v));
+        CHECK(wreqFill.getHandle(), 0x0042);
+        CHECK(wreqFill.getValue().getSize(), 4);
+        CHECKT( wreq.pdu == wreqFill.pdu );
+        AttWriteCmd wcmdFill(0x0042, static_cast<int>(sizeof(v)));
+        memcpy(wcmdFill.getValueWPtr(), v, sizeof(v));
+        CHECKT( AttWriteCmd(0x0042, TROOctets(v, sizeof(v))).pdu == wcmdFill.pdu );
     }
 };
 
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/ATTPDUTypes.hpp>
+#include <direct_bt/HCIIoctl.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            const std::vector<uint16_t> handles = { 0x0003, 0x0010, 0x002a };
+            const AttReadMultipleReq req(handles, true /* variableLength */);
+            CHECKT( req.isVariableLength() );
+            CHECKT( AttPDUMsg::ATT_READ_MULTIPLE_VARIABLE_REQ == req.getOpcode() );
+            CHECK(req.getHandleCount(), 3);
+            CHECK(req.getHandle(0), 0x0003);
+            CHECK(req.getHandle(2), 0x002a);
+        }
+        {
+            const uint8_t data[] = { 0x01, 0x02, 0x03 };
+            const AttPrepareWriteReq req(0x0021, 0x0012, TROOctets(data, sizeof(data)));
+            CHECK(req.getHandle(), 0x0021);
+            CHECK(req.getValueOffset(), 0x0012);
+            CHECK(req.getValue().getSize(), 3);
+            CHECK(req.getValue().get_uint8(2), 0x03);
+
+            // Echoed by the server
+            POctets echo(req.pdu);
+            echo.put_uint8(0, AttPDUMsg::ATT_PREPARE_WRITE_RSP);
+            const AttPrepareWriteRsp rsp(echo.get_ptr(), echo.getSize());
+            CHECK(rsp.getHandle(), 0x0021);
+            CHECK(rsp.getValueOffset(), 0x0012);
+            CHECK(rsp.getValue().get_uint8(0), 0x01);
+
+            const AttExecuteWriteReq cancel(false /* commit */);
+            CHECKT( !cancel.isCommit() );
+            CHECK(cancel.pdu.getSize(), 2);
+        }
+        {
+            // ATT_MULTIPLE_HANDLE_VALUE_NTF: [handle, length, value]...
+            const uint8_t ntf[] = { AttPDUMsg::ATT_MULTIPLE_HANDLE_VALUE_NTF,
+                                    0x03, 0x00, 0x02, 0x00, 0xaa, 0xbb,
+                                    0x10, 0x00, 0x00, 0x00,
+                                    0x2a, 0x00, 0x01, 0x00, 0xcc };
+            const AttMultipleValueList p(ntf, sizeof(ntf));
+            CHECKT( p.isNotification() );
+            CHECK(p.getValueCount(), 3);
+            CHECK(p.getValueHandle(0), 0x0003);
+            CHECK(p.getValueLength(0), 2);
+            CHECK(p.getValue(0).get_uint8(1), 0xbb);
+            CHECK(p.getValueHandle(1), 0x0010);
+            CHECK(p.getValue(1).getSize(), 0);
+            CHECK(p.getValueHandle(2), 0x002a);
+            CHECK(p.getValue(2).get_uint8(0), 0xcc);
+            CHECKT( !p.isValueTruncated(2) );
+        }
+        {
+            // ATT_READ_MULTIPLE_VARIABLE_RSP: [length, value]..., last value truncated
+            const uint8_t rsp[] = { AttPDUMsg::ATT_READ_MULTIPLE_VARIABLE_RSP,
+                                    0x01, 0x00, 0x11,
+                                    0x05, 0x00, 0x21, 0x22 };
+            const AttMultipleValueList p(rsp, sizeof(rsp));
+            CHECKT( !p.isNotification() );
+            CHECK(p.getValueCount(), 2);
+            CHECK(p.getValueLength(0), 1);
+            CHECK(p.getValue(0).get_uint8(0), 0x11);
+            CHECKT( !p.isValueTruncated(0) );
+            CHECK(p.getValueLength(1), 5);
+            CHECK(p.getValue(1).getSize(), 2);
+            CHECKT( p.isValueTruncated(1) );
+        }
+        {
+            // ATT_FIND_BY_TYPE_VALUE_REQ: [start, end, type, uuid], ATT_FIND_BY_TYPE_VALUE_RSP: [found, group-end]...
+            const AttFindByTypeValueReq req(0x0001, 0xffff, uuid16_t(0x2800 /* primary service */), uuid16_t(0x180f));
+            CHECK(req.pdu.getSize(), 1+2+2+2+2);
+            CHECK(req.getAttributeType(), 0x2800);
+            CHECK(req.pdu.get_uint16(7), 0x180f);
+
+            const uint8_t rsp[] = { AttPDUMsg::ATT_FIND_BY_TYPE_VALUE_RSP,
+                                    0x10, 0x00, 0x14, 0x00,
+                                    0x30, 0x00, 0xff, 0xff };
+            const AttFindByTypeValueRsp p(rsp, sizeof(rsp));
+            CHECK(p.getElementCount(), 2);
+            CHECK(p.getElementFoundHandle(0), 0x0010);
+            CHECK(p.getElementGroupEndHandle(0), 0x0014);
+            CHECK(p.getElementGroupEndHandle(1), 0xffff);
+        }
+        {
+            // Outgoing PDUs use the inline storage, larger SOctets fall back to the heap.
+            const AttReadReq req(0x0021);
+            CHECKT( req.pdu.get_ptr() >= reinterpret_cast<const uint8_t*>(&req) &&
+                    req.pdu.get_ptr() <  reinterpret_cast<const uint8_t*>(&req) + sizeof(req) );
+            CHECK(req.pdu.getCapacity(), AttPDUMsg::PDU_INLINE_CAPACITY);
+
+            SOctets<32> o(2);
+            const uint8_t * inl = o.get_ptr();
+            o.put_uint16(0, 0x1234);
+            o.recapacity(64);
+            CHECKT( inl != o.get_ptr() );
+            CHECK(o.getCapacity(), 64);
+            CHECK(o.get_uint16(0), 0x1234);
+            o.recapacity(2);
+            CHECKT( inl == o.get_ptr() );
+            CHECK(o.getCapacity(), 32);
+            CHECK(o.get_uint16(0), 0x1234);
+
+            SOctets<32> m(std::move(o));
+            CHECK(m.get_uint16(0), 0x1234);
+            CHECKT( inl != m.get_ptr() );
+            CHECK(o.getSize(), 0);
+
+            // Small POctets stay inline, copied on move
+            POctets s0(5);
+            CHECK(s0.getCapacity(), POctets::INLINE_CAPACITY);
+            s0.put_uint8(4, 0x42);
+            POctets s1(std::move(s0));
+            CHECK(s1.get_uint8(4), 0x42);
+            CHECKT( s0.get_ptr() != s1.get_ptr() );
+            s1.recapacity(POctets::INLINE_CAPACITY+1);
+            CHECK(s1.getCapacity(), POctets::INLINE_CAPACITY+1);
+            CHECK(s1.get_uint8(4), 0x42);
+            const POctets s2(TOctetSlice(s1, 4, 1));
+            CHECK(s2.getCapacity(), POctets::INLINE_CAPACITY);
+            CHECK(s2.get_uint8(0), 0x42);
+        }
+        {
+            // TOctetReader: extent checked once, unchecked field reads
+            const uint8_t data[] = { 0xAA, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+            const TROOctets o(data, sizeof(data));
+            TOctetReader r(o, 1, 12);
+            CHECK(r.getSize(), 12);
+            CHECK(r.get_uint16(0), 0x1234);
+            CHECK(r.get_uint32(2), 0x12345678);
+            CHECKT( r.get_eui48(6) == EUI48(data+7) );
+            CHECK(r.read_uint16(), 0x1234);
+            CHECK(r.read_uint32(), 0x12345678);
+            CHECK(r.getRemaining(), 6);
+            r.skip(6);
+            CHECK(r.getRemaining(), 0);
+
+            bool thrown = false;
+            try {
+                TOctetReader r2(o, 2, 12);
+                (void)r2;
+            } catch (const IndexOutOfBoundsException &) {
+                thrown = true;
+            }
+            CHECKT( thrown );
+
+            // memcpy based packed struct view at odd offset
+            const uint8_t ev[] = { 0xFF, 0x00, 0x40, 0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x18, 0x00, 0x00, 0x00, 0x48, 0x00, 0x05 };
+            const TROOctets evo(ev, sizeof(ev));
+            const hci_ev_le_conn_complete cc = evo.get_struct<hci_ev_le_conn_complete>(1);
+            CHECK(cc.status, 0);
+            CHECK(le_to_cpu(cc.handle), 0x0040);
+            CHECK(cc.role, 1);
+            CHECK(le_to_cpu(cc.interval), 0x0018);
+            CHECK(le_to_cpu(cc.supervision_timeout), 0x0048);
+            CHECK(cc.clk_accurancy, 5);
+            CHECKT( TOctetReader(evo).get_struct<hci_ev_le_conn_complete>(1).handle == cc.handle );
+
+            uint8_t wbuf[sizeof(hci_ev_le_conn_complete)+1];
+            TOctets w(wbuf, sizeof(wbuf));
+            w.put_struct(1, cc);
+            CHECKT( 0 == memcmp(w.get_ptr(1), ev+1, sizeof(cc)) );
+        }
+        {
+            // Zero-copy element iteration: ATT_READ_BY_GROUP_TYPE_RSP, 2 primary services
+            const uint8_t data[] = { AttPDUMsg::ATT_READ_BY_GROUP_TYPE_RSP, 6,
+                                     0x01, 0x00, 0x05, 0x00, 0x00, 0x18,
+                                     0x06, 0x00, 0x0A, 0x00, 0x0F, 0x18 };
+            const AttReadByGroupTypeRsp rsp(data, sizeof(data));
+            int i=0;
+            for(const AttElementSlice e : rsp) {
+                CHECK(e.getHandle(), 0 == i ? 0x0001 : 0x0006);
+                CHECK(e.getEndHandle(), 0 == i ? 0x0005 : 0x000A);
+                CHECKT( e.getUUID() == uuid_value_t(uuid16_t(0 == i ? 0x1800 : 0x180F)) );
+                i++;
+            }
+            CHECK(i, rsp.getElementCount());
+        }
+        {
+            // Zero-copy element iteration: ATT_FIND_INFORMATION_RSP with uuid128
+            uint8_t data[2 + 2*(2+16)] = { AttPDUMsg::ATT_FIND_INFORMATION_RSP, 0x02 };
+            const uuid128_t u0(uuid16_t(0x2902));
+            const uuid128_t u1(uuid16_t(0x2901));
+            put_uint16(data, 2, 0x0003, true);
+            put_uuid(data, 4, u0, true);
+            put_uint16(data, 20, 0x0004, true);
+            put_uuid(data, 22, u1, true);
+            const AttFindInfoRsp rsp(data, sizeof(data));
+            int i=0;
+            for(const AttElementSlice e : rsp) {
+                CHECK(e.getHandle(), 0x0003 + i);
+                CHECK(e.getEndHandle(), 0x0003 + i);
+                CHECK(e.getValueSize(), 16);
+                CHECKT( e.getUUID() == uuid_value_t(0 == i ? u0 : u1) );
+                CHECKT( *e.getUUID().toUUID() == *rsp.getElementValue(i) );
+                i++;
+            }
+            CHECK(i, 2);
+        }
+        {
+            // Transport failures are thrown by the convenience API, all others returned as false
+            CHECKT( !isGATTTransportFailure(GATTStatus::SUCCESS) );
+            CHECKT( isGATTTransportFailure(GATTStatus::INVALID_STATE) );
+            CHECKT( isGATTTransportFailure(GATTStatus::PDU_TOO_LARGE) );
+            CHECKT( isGATTTransportFailure(GATTStatus::IO_ERROR) );
+            CHECKT( isGATTTransportFailure(GATTStatus::WRITE_COUNT_MISMATCH) );
+            CHECKT( isGATTTransportFailure(GATTStatus::TIMEOUT) );
+            CHECKT( isGATTTransportFailure(GATTStatus::INTERNAL_ERROR) );
+            CHECKT( !isGATTTransportFailure(GATTStatus::ERROR_RSP) );
+            CHECKT( !isGATTTransportFailure(GATTStatus::UNEXPECTED_REPLY) );
+            CHECKT( !isGATTTransportFailure(GATTStatus::INVALID_VALUE) );
+            CHECKT( !isGATTTransportFailure(GATTStatus::ABORTED) );
+            CHECKT( "TIMEOUT" == getGATTStatusString(GATTStatus::TIMEOUT) );
+            CHECKT( "ERROR_RSP" == getGATTStatusString(GATTStatus::ERROR_RSP) );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
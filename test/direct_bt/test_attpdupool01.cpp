@@ -0,0 +1,72 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/ATTPDUTypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        // ATT_READ_RSP w/ value 0x01 0x02 0x03
+        const uint8_t read_rsp[] = { AttPDUMsg::ATT_READ_RSP, 0x01, 0x02, 0x03 };
+        // ATT_MULTIPLE_HANDLE_VALUE_NTF: handle 0x0003 len 1 value 0xaa, handle 0x0005 len 2 value 0xbb 0xcc
+        const uint8_t multi_ntf[] = { AttPDUMsg::ATT_MULTIPLE_HANDLE_VALUE_NTF,
+                                      0x03, 0x00, 0x01, 0x00, 0xaa,
+                                      0x05, 0x00, 0x02, 0x00, 0xbb, 0xcc };
+        AttPDUPool pool(2, 512);
+
+        AttPDUMsg * p0;
+        {
+            std::shared_ptr<AttPDUMsg> e0 = pool.getSpecialized(read_rsp, sizeof(read_rsp));
+            CHECKT( AttPDUMsg::ATT_READ_RSP == e0->getOpcode() );
+            CHECK( static_cast<AttReadRsp*>(e0.get())->getValue().getSize(), 3 );
+            CHECK( e0->pdu.getCapacity(), 512 );
+            p0 = e0.get();
+        }
+        CHECK( pool.getAllocCount(), 1 );
+        {
+            // released above, hence recycled in place w/ the new value
+            const uint8_t read_rsp2[] = { AttPDUMsg::ATT_READ_RSP, 0x07 };
+            std::shared_ptr<AttPDUMsg> e0 = pool.getSpecialized(read_rsp2, sizeof(read_rsp2));
+            CHECKT( p0 == e0.get() );
+            CHECK( pool.getAllocCount(), 1 );
+            CHECK( static_cast<AttReadRsp*>(e0.get())->getValue().getSize(), 1 );
+            CHECK( static_cast<AttReadRsp*>(e0.get())->getValue().get_uint8(0), 0x07 );
+
+            // in use, hence next pooled and then fallback instance
+            std::shared_ptr<AttPDUMsg> e1 = pool.getSpecialized(read_rsp, sizeof(read_rsp));
+            std::shared_ptr<AttPDUMsg> e2 = pool.getSpecialized(read_rsp, sizeof(read_rsp));
+            CHECKT( e0.get() != e1.get() );
+            CHECKT( e1.get() != e2.get() );
+            CHECK( pool.getAllocCount(), 2 );
+            CHECK( pool.getFallbackCount(), 1 );
+        }
+        {
+            // recycled tuple list is re-parsed
+            std::shared_ptr<AttPDUMsg> e0 = pool.getSpecialized(multi_ntf, sizeof(multi_ntf));
+            const AttMultipleValueList * a = static_cast<const AttMultipleValueList*>(e0.get());
+            CHECK( a->getValueCount(), 2 );
+            CHECK( a->getValueHandle(1), 0x0005 );
+            CHECK( a->getValue(1).get_uint8(1), 0xcc );
+        }
+        {
+            std::shared_ptr<AttPDUMsg> e0 = pool.getSpecialized(multi_ntf, 1+2+2+1);
+            const AttMultipleValueList * a = static_cast<const AttMultipleValueList*>(e0.get());
+            CHECK( a->getValueCount(), 1 );
+            CHECK( a->getValueHandle(0), 0x0003 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <cinttypes>
 #include <cstring>
+#include <ctime>
 
 #include <cppunit.h>
 
@@ -57,6 +58,24 @@ class Cppunit_tests : public Cppunit {
             test_uint64_t("uint64_t thousand", 1000, 5, "1,000");
             test_uint64_t("UINT64_MAX", UINT64_MAX, 26, "18,446,744,073,709,551,615");
         }
+        {
+            // hex formatting
+            CHECKTM("uint8 hex", uint8HexString(0x0A) == "0x0A");
+            CHECKTM("uint16 hex", uint16HexString(0xBEEF, false) == "BEEF");
+            CHECKTM("uint32 hex", uint32HexString(0x0102ABCD) == "0x0102ABCD");
+            CHECKTM("uint64 hex", uint64HexString(UINT64_C(0xF0E1D2C3B4A59687)) == "0xF0E1D2C3B4A59687");
+            const uint8_t bytes[] = { 0x00, 0x01, 0x7F, 0x80, 0xAB, 0xFF };
+            CHECKTM("bytes lsb", bytesHexString(bytes, 0, sizeof(bytes), true) == "0x00017F80ABFF");
+            CHECKTM("bytes msb", bytesHexString(bytes, 1, 3, false, false) == "807F01");
+            CHECKTM("bytes nil", bytesHexString(bytes, 0, 0, true) == "nil");
+            CHECKTM("bytes null", bytesHexString(nullptr, 0, 1, true) == "null");
+            char buffer[8];
+            CHECKTM("bytes chars", bytesHexChars(bytes, 4, 2, true, buffer) == buffer + 4);
+            CHECKTM("bytes chars", 0 == memcmp(buffer, "ABFF", 4));
+            std::string res("data ");
+            appendBytesHexString(res, bytes, 0, 2, true);
+            CHECKTM("bytes append", res == "data 0x0001");
+        }
         {
             EUI48 mac01;
             PRINTM("EUI48 size: whole0 "+std::to_string(sizeof(EUI48)));
@@ -65,6 +84,53 @@ class Cppunit_tests : public Cppunit {
             CHECKM("EUI48 struct and data size not matching", sizeof(EUI48), sizeof(mac01));
             CHECKM("EUI48 struct and data size not matching", sizeof(mac01), sizeof(mac01.b));
         }
+        {
+            // EUI48 parse, format, packed compare and hash
+            const EUI48 mac01("01:02:03:0A:0B:0C");
+            const EUI48 mac02("01:02:03:0a:0b:0c");
+            const EUI48 mac03(0x0c, 0x0b, 0x0a, 0x03, 0x02, 0x01);
+            CHECKTM("EUI48 string", mac01.toString() == "01:02:03:0A:0B:0C");
+            CHECKTM("EUI48 lower case", mac01 == mac02);
+            CHECKTM("EUI48 byte ctor", mac01 == mac03);
+            CHECKM("EUI48 packed", mac01.toUint64(), UINT64_C(0x0102030A0B0C));
+            CHECKTM("EUI48 hash", std::hash<EUI48>()(mac01) == std::hash<EUI48>()(mac02));
+            CHECKTM("EUI48 all", EUI48_ALL_DEVICE.toString() == "FF:FF:FF:FF:FF:FF");
+
+            const EUI48 mac04("02:02:03:0A:0B:0B"); // larger b[5], smaller b[0]
+            CHECKTM("EUI48 order byte-wise", mac04 < mac01);
+            CHECKTM("EUI48 order byte-wise", !( mac01 < mac04 ) && mac01 != mac04);
+
+            EUI48 res;
+            CHECKTM("EUI48 scan short", !EUI48::scanString("01:02:03:0A:0B", res));
+            CHECKTM("EUI48 scan separator", !EUI48::scanString("01-02-03-0A-0B-0C", res));
+            CHECKTM("EUI48 scan digit", !EUI48::scanString("01:02:03:0A:0B:0G", res));
+            CHECKTM("EUI48 scan untouched", res == EUI48_ANY_DEVICE);
+            CHECKTM("EUI48 scan", EUI48::scanString("01:02:03:0A:0B:0C", res) && res == mac01);
+            bool thrown = false;
+            try {
+                EUI48 mac05("01:02:03:0A:0B:0X");
+                (void)mac05;
+            } catch (IllegalArgumentException &e) {
+                thrown = true;
+            }
+            CHECKTM("EUI48 invalid string throws", thrown);
+        }
+        {
+            // monotonic clocks of different resolution and realtime conversion
+            const int64_t ns0 = getCurrentNanoseconds();
+            const int64_t ms1 = getCurrentMilliseconds();
+            const int64_t ns1 = getCurrentNanoseconds();
+            CHECKT( ns0 / 1000000 <= ms1 && ms1 <= ns1 / 1000000 );
+
+            struct timespec r;
+            clock_gettime(CLOCK_REALTIME, &r);
+            const int64_t rt = r.tv_sec * 1000000000L + r.tv_nsec - 5000000L; // 5ms ago
+            const int64_t ns2 = getMonotonicNanoseconds(rt);
+            const int64_t ns3 = getCurrentNanoseconds();
+            CHECKT( ns2 < ns3 );
+            CHECKT( ns3 - ns2 >= 5000000L );
+            CHECKT( ns3 - ns2 < 1000000000L );
+        }
 
     }
 };
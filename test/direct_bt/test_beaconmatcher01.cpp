@@ -0,0 +1,143 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/BTTypes.hpp>
+#include <direct_bt/BeaconMatcher.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        BeaconMatcher m;
+        CHECKT( m.isConsuming() );
+        const int ibeacon = m.addIBeacon();
+        m.addEddystone();
+        const int custom = m.addManufacturer(0x0059, { 0xCA, 0xFE });
+        const int customShort = m.addManufacturer(0x0059, { 0xCA });
+        CHECK( m.size(), 6 );
+
+        uint8_t storage[31];
+        TOctets buffer(storage, sizeof(storage));
+        ADWriter w(buffer);
+        BeaconRecord rec;
+        {
+            // iBeacon
+            CHECKT( w.addFlags(AD_FLAGS_GENERAL_MODE_BIT) );
+            uint8_t * p = w.addManufacturerData(0x004C, 23);
+            CHECKT( nullptr != p );
+            p[0] = 0x02; p[1] = 0x15;
+            for(int i=0; i<16; i++) { p[2+i] = static_cast<uint8_t>(0xA0 + i); }
+            p[18] = 0x12; p[19] = 0x34; // major
+            p[20] = 0x56; p[21] = 0x78; // minor
+            p[22] = static_cast<uint8_t>(-59);
+            CHECK( w.getSize(), 30 );
+            CHECKT( m.match(storage, w.getSize(), rec) );
+            CHECKT( BeaconType::IBEACON == rec.type );
+            CHECK( rec.pattern, ibeacon );
+            CHECK( rec.id[0], 0xA0 );
+            CHECK( rec.id[15], 0xAF );
+            CHECK( rec.major, 0x1234 );
+            CHECK( rec.minor, 0x5678 );
+            CHECK( rec.txPower, -59 );
+            CHECK( rec.dataLength, 0 );
+
+            // truncated iBeacon frame is rejected
+            CHECKT( !m.match(storage, w.getSize() - 1, rec) );
+            // other company w/ same prefix
+            p[-2] = 0x4D;
+            CHECKT( !m.match(storage, w.getSize(), rec) );
+        }
+        {
+            // Eddystone-UID, -URL and -TLM
+            w.clear();
+            CHECKT( w.addServiceUUID(uuid16_t(0xFEAA)) );
+            uint8_t * p = w.addServiceData(0xFEAA, 20);
+            p[0] = 0x00; p[1] = static_cast<uint8_t>(-20);
+            for(int i=0; i<16; i++) { p[2+i] = static_cast<uint8_t>(i); }
+            p[18] = 0; p[19] = 0;
+            CHECKT( m.match(storage, w.getSize(), rec) );
+            CHECKT( BeaconType::EDDYSTONE_UID == rec.type );
+            CHECK( rec.txPower, -20 );
+            CHECK( rec.id[9], 9 );
+            CHECK( rec.id[10], 10 );
+
+            w.clear();
+            p = w.addServiceData(0xFEAA, 8);
+            p[0] = 0x10; p[1] = static_cast<uint8_t>(-10); p[2] = 0x03; // https://
+            memcpy(p+3, "abc", 3); p[6] = 0x07; p[7] = 'x'; // .com
+            CHECKT( m.match(storage, w.getSize(), rec) );
+            CHECKT( BeaconType::EDDYSTONE_URL == rec.type );
+            CHECK( rec.txPower, -10 );
+            CHECK( rec.dataLength, 6 );
+            CHECK( rec.data[0], 0x03 );
+            CHECK( rec.data[1], 'a' );
+
+            w.clear();
+            p = w.addServiceData(0xFEAA, 14);
+            memset(p, 0, 14);
+            p[0] = 0x20; p[2] = 0x0B; p[3] = 0xB8; // 3000 mV
+            CHECKT( m.match(storage, w.getSize(), rec) );
+            CHECKT( BeaconType::EDDYSTONE_TLM == rec.type );
+            CHECK( rec.dataLength, 13 );
+            CHECK( rec.data[1], 0x0B );
+            CHECK( rec.txPower, 127 );
+
+            // unknown frame type
+            p[0] = 0x30;
+            CHECKT( !m.match(storage, w.getSize(), rec) );
+        }
+        {
+            // custom patterns, the longest prefix wins
+            w.clear();
+            CHECKT( w.addName("sensor") );
+            uint8_t * p = w.addManufacturerData(0x0059, 5);
+            p[0] = 0xCA; p[1] = 0xFE; p[2] = 1; p[3] = 2; p[4] = 3;
+            CHECKT( m.match(storage, w.getSize(), rec) );
+            CHECKT( BeaconType::CUSTOM == rec.type );
+            CHECK( rec.pattern, custom );
+            CHECK( rec.dataLength, 3 );
+            CHECK( rec.data[2], 3 );
+
+            p[1] = 0x00;
+            CHECKT( m.match(storage, w.getSize(), rec) );
+            CHECK( rec.pattern, customShort );
+            CHECK( rec.dataLength, 4 );
+
+            p[0] = 0x00;
+            CHECKT( !m.match(storage, w.getSize(), rec) );
+        }
+        {
+            // malformed and empty AD data
+            const uint8_t bad[] = { 0x1F, 0xFF, 0x4C, 0x00, 0x02, 0x15 };
+            CHECKT( !m.match(bad, sizeof(bad), rec) );
+            CHECKT( !m.match(bad, 0, rec) );
+            const uint8_t zero[] = { 0x00, 0xFF };
+            CHECKT( !m.match(zero, sizeof(zero), rec) );
+
+            BeaconMatcher empty(false);
+            CHECKT( !empty.isConsuming() );
+            CHECKT( !empty.match(storage, w.getSize(), rec) );
+
+            bool thrown = false;
+            try {
+                empty.addServiceData(0x1234, std::vector<uint8_t>(BeaconMatcher::MAX_PREFIX_LEN+1, 0));
+            } catch (IllegalArgumentException &e) {
+                thrown = true;
+            }
+            CHECKT( thrown );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/BondingKeyStore.hpp>
+
+using namespace direct_bt;
+
+static MgmtLongTermKeyInfo makeLTK(const uint8_t last, const uint8_t master) {
+    MgmtLongTermKeyInfo k;
+    const uint8_t a[] = { last, 0x02, 0x03, 0x04, 0x05, 0x06 };
+    k.address = EUI48(a);
+    k.address_type = BDAddressType::BDADDR_LE_PUBLIC;
+    k.key_type = static_cast<uint8_t>(MgmtLTKType::AUTHENTICATED_P256);
+    k.master = master;
+    k.enc_size = 16;
+    k.ediv = 0x1234;
+    k.rand = 0x0102030405060708ULL;
+    for(int i=0; i<16; i++) {
+        k.ltk[i] = last + i;
+    }
+    return k;
+}
+
+static MgmtIdentityResolvingKeyInfo makeIRK(const uint8_t last) {
+    MgmtIdentityResolvingKeyInfo k;
+    const uint8_t a[] = { last, 0x02, 0x03, 0x04, 0x05, 0x06 };
+    k.address = EUI48(a);
+    k.address_type = BDAddressType::BDADDR_LE_RANDOM;
+    for(int i=0; i<16; i++) {
+        k.irk[i] = 0x80 + last + i;
+    }
+    return k;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const uint8_t adapterBytes[] = { 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6 };
+        const EUI48 adapter(adapterBytes);
+        {
+            // mgmt_ltk_info layout, little endian
+            MgmtLoadLongTermKeyCmd req(0, std::vector<MgmtLongTermKeyInfo>{ makeLTK(1, 1), makeLTK(2, 0) });
+            CHECK(req.getParamSize(), 2 + 2 * MgmtLongTermKeyInfo::SIZE);
+            CHECK(req.getKeyCount(), 2);
+            const uint8_t * p = req.getParam() + 2;
+            CHECK(p[0], 1);
+            CHECK(p[8], 1);
+            CHECK(p[9], 16);
+            CHECK(p[10], 0x34);
+            CHECK(p[11], 0x12);
+            CHECK(p[12], 0x08);
+            CHECK(p[19], 0x01);
+            CHECK(p[20], 1);
+            const MgmtLongTermKeyInfo k = req.getKey(1);
+            CHECKT( makeLTK(2, 0).address == k.address );
+            CHECK(k.master, 0);
+            CHECKT( 0x0102030405060708ULL == k.rand );
+            CHECKT( 0 == memcmp(makeLTK(2, 0).ltk, k.ltk, sizeof(k.ltk)) );
+
+            MgmtLoadIdentityResolvingKeyCmd req2(0, std::vector<MgmtIdentityResolvingKeyInfo>{ makeIRK(3) });
+            CHECK(req2.getParamSize(), 2 + MgmtIdentityResolvingKeyInfo::SIZE);
+            CHECKT( 0 == memcmp(makeIRK(3).irk, req2.getKey(0).irk, 16) );
+        }
+        {
+            std::shared_ptr<const POctets> record = BondingKeyStore::serialize(
+                    std::vector<MgmtLongTermKeyInfo>{ makeLTK(1, 1) }, std::vector<MgmtIdentityResolvingKeyInfo>{ makeIRK(1), makeIRK(2) });
+            std::vector<MgmtLongTermKeyInfo> ltks;
+            std::vector<MgmtIdentityResolvingKeyInfo> irks;
+            CHECKT( BondingKeyStore::deserialize(*record, ltks, irks) );
+            CHECK(ltks.size(), 1);
+            CHECK(irks.size(), 2);
+            CHECKT( 0 == memcmp(makeLTK(1, 1).ltk, ltks[0].ltk, 16) );
+            CHECKT( makeIRK(2).address == irks[1].address );
+
+            POctets corrupt(*record);
+            corrupt.resize(corrupt.getSize() - 1);
+            CHECKT( !BondingKeyStore::deserialize(corrupt, ltks, irks) );
+        }
+        {
+            BondingKeyStore store("");
+            store.putLongTermKey(adapter, makeLTK(1, 1));
+            store.putLongTermKey(adapter, makeLTK(2, 1));
+            store.putLongTermKey(adapter, makeLTK(1, 0));
+            store.putLongTermKey(adapter, makeLTK(1, 1)); // replaces, most recent
+            store.putIdentityResolvingKey(adapter, makeIRK(2));
+
+            std::vector<MgmtLongTermKeyInfo> ltks = store.getLongTermKeys(adapter, 8);
+            CHECK(ltks.size(), 3);
+            CHECKT( makeLTK(1, 1).address == ltks[2].address );
+            CHECK(ltks[2].master, 1);
+            ltks = store.getLongTermKeys(adapter, 1);
+            CHECK(ltks.size(), 1);
+            CHECK(ltks[0].master, 1);
+            CHECKT( store.isBonded(adapter, makeLTK(2, 1).address, BDAddressType::BDADDR_LE_PUBLIC) );
+            CHECKT( !store.isBonded(adapter, makeLTK(2, 1).address, BDAddressType::BDADDR_LE_RANDOM) );
+            CHECK(store.getLongTermKeys(EUI48_ANY_DEVICE, 8).size(), 0);
+
+            CHECK(store.remove(adapter, makeLTK(1, 1).address, BDAddressType::BDADDR_LE_PUBLIC), 2);
+            CHECK(store.getLongTermKeys(adapter, 8).size(), 1);
+            CHECK(store.getIdentityResolvingKeys(adapter, 8).size(), 1);
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTTypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            // not probed, configured values pass through
+            ControllerCaps c;
+            CHECK( c.probed, false );
+            CHECK( c.getPipelineDepth(0), 1 );
+            CHECK( c.getPipelineDepth(1), 1 );
+            CHECK( c.getPipelineDepth(8), 8 );
+            CHECK( c.getRingCapacity(128), 128 );
+            CHECK( c.getMaxConcurrentConnections(0), 1 );
+            CHECK( c.getMaxConcurrentConnections(4), 4 );
+            CHECK( c.getDataLenTxOctets(), 251 );
+            CHECK( c.getDataLenTxTime(), 2120 );
+            CHECK( c.isLEFeatureSupported(ControllerCaps::LEFeature::PHY_2M), false );
+        }
+        {
+            ControllerCaps c;
+            c.probed = true;
+            c.le_acl_pkts = 6;
+            c.le_features = 0x0000000000000121; // encryption, data length extension and 2M PHY
+            c.max_tx_octets = 251;
+            c.max_tx_time = 17040;
+            CHECK( c.isLEFeatureSupported(ControllerCaps::LEFeature::ENCRYPTION), true );
+            CHECK( c.isLEFeatureSupported(ControllerCaps::LEFeature::DATA_LEN_EXT), true );
+            CHECK( c.isLEFeatureSupported(ControllerCaps::LEFeature::PHY_2M), true );
+            CHECK( c.isLEFeatureSupported(ControllerCaps::LEFeature::PHY_CODED), false );
+            CHECK( c.getPipelineDepth(0), 6 );
+            CHECK( c.getPipelineDepth(1), 1 );
+            CHECK( c.getPipelineDepth(32), 6 );
+            CHECK( c.getRingCapacity(128), 128 );
+            CHECK( c.getRingCapacity(16), 24 );
+            CHECK( c.getMaxConcurrentConnections(4), 4 );
+            CHECK( c.getMaxConcurrentConnections(16), 6 );
+            CHECK( c.getDataLenTxOctets(), 251 );
+            CHECK( c.getDataLenTxTime(), 17040 );
+        }
+        {
+            // large buffer pools are capped, invalid data lengths fall back to the defaults
+            ControllerCaps c;
+            c.probed = true;
+            c.le_acl_pkts = 255;
+            c.max_tx_octets = 0x1B;
+            c.max_tx_time = 0x4291;
+            CHECK( c.getPipelineDepth(0), static_cast<int32_t>(ControllerCaps::MAX_PIPELINE_DEPTH) );
+            CHECK( c.getPipelineDepth(4), 4 );
+            CHECK( c.getRingCapacity(64), 1020 );
+            c.le_acl_pkts = 0;
+            CHECK( c.getRingCapacity(64), 64 );
+            CHECK( c.getDataLenTxOctets(), 27 );
+            CHECK( c.getDataLenTxTime(), 2120 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
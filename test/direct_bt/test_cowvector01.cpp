@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/COWVector.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        COWVector<int> v;
+        auto equal = [](const int a, const int b) { return a == b; };
+        CHECKT( v.empty() );
+        CHECKT( v.push_back_unique(1, equal) );
+        CHECKT( v.push_back_unique(2, equal) );
+        CHECKT( !v.push_back_unique(1, equal) );
+        v.push_back(3);
+        CHECK(v.size(), 3);
+
+        // snapshot is immutable while mutated within the iteration
+        const COWVector<int>::snapshot_t s0 = v.get_snapshot();
+        int sum = 0;
+        for_each_cow(v, [&](const int &e) {
+            sum += e;
+            v.push_back(10*e);
+        });
+        CHECK(sum, 1+2+3);
+        CHECK(s0->size(), 3);
+        CHECK(v.size(), 6);
+
+        CHECK(v.erase_matching(false /* all */, [](const int e) { return e >= 10; }), 1);
+        CHECK(v.size(), 5);
+        CHECK(v.erase_matching(true /* all */, [](const int e) { return e >= 10; }), 2);
+        CHECK(v.get_snapshot()->at(2), 3);
+        CHECK(v.erase_matching(true /* all */, [](const int e) { return e > 100; }), 0);
+
+        v.clear();
+        CHECKT( v.empty() );
+        CHECK(s0->at(0), 1);
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTBroker.hpp>
+#include <direct_bt/BasicTypes.hpp>
+
+extern "C" {
+    #include <unistd.h>
+    #include <sys/wait.h>
+}
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+  private:
+    static bool readChild(const std::string & path) {
+        DBTBrokerClient client(path);
+        DBTBrokerRing::Record r;
+        return client.next(r, 5000) && DBTBrokerRing::RecordType::GATT_NOTIFICATION == r.type &&
+               1 == r.length && 0x42 == r.data[0];
+    }
+
+  public:
+    void single_test() override {
+        const std::string path = "/tmp/test_dbtbroker01."+std::to_string(::getpid())+".sock";
+        const EUI48 addr(0x01, 0x02, 0x03, 0x04, 0x05, 0xc6);
+        DBTBrokerPublisher publisher(path, 5 /* rounded up to 8 */);
+        CHECK( publisher.getSlotCount(), 8 );
+
+        DBTBrokerClient client(path);
+        CHECK( client.getSlotCount(), 8 );
+        CHECKT( publisher.getClientCount() >= 1 );
+        DBTBrokerRing::Record r;
+        CHECKT( !client.next(r) );
+
+        // Advertising sighting, re-encoded AD fields
+        {
+            const uint8_t ad[] = { 0x02, 0x01, 0x06,
+                                   0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18,
+                                   0x05, 0x09, 'T', 'e', 's', 't',
+                                   0x05, 0xff, 0x59, 0x00, 0xaa, 0xbb,
+                                   0x02, 0x0a, 0xf4 };
+            EInfoReport eir;
+            eir.setTimestamp(1234);
+            eir.setEvtType(AD_PDU_Type::ADV_IND);
+            eir.setAddressType(BDAddressType::BDADDR_LE_RANDOM);
+            eir.setAddress(addr);
+            eir.setRSSI(-60);
+            CHECK( eir.read_data(ad, sizeof(ad), true /* lazy */), 5 );
+            publisher.publish(eir);
+            CHECK( client.getAvailable(), 1 );
+            CHECKT( client.next(r) );
+            CHECKT( DBTBrokerRing::RecordType::ADV_SIGHTING == r.type );
+            CHECKT( r.address == addr );
+            CHECKT( BDAddressType::BDADDR_LE_RANDOM == r.getAddressType() );
+
+            EInfoReport decoded;
+            CHECK( r.decode(decoded), 5 );
+            CHECKT( decoded.getAddress() == addr );
+            CHECK( decoded.getRSSI(), -60 );
+            CHECK( decoded.getTimestamp(), 1234 );
+            CHECK( decoded.getFlags(), 0x06 );
+            CHECK( decoded.getTxPower(), -12 );
+            CHECKT( decoded.getName() == "Test" );
+            CHECK( decoded.getServices().size(), 2 );
+            CHECKT( decoded.getServices()[0] == uuid_value_t(uuid16_t(0x180f)) );
+            CHECKT( *decoded.getManufactureSpecificData() == *eir.getManufactureSpecificData() );
+        }
+
+        // GATT notification, truncated to the slot size
+        {
+            POctets value(300, 300);
+            for(int i=0; i<300; i++) {
+                value.put_uint8(i, static_cast<uint8_t>(i));
+            }
+            publisher.publish(addr, BDAddressType::BDADDR_LE_PUBLIC, 0x0010, value, 4321, true /* indication */);
+            CHECKT( client.next(r) );
+            CHECKT( DBTBrokerRing::RecordType::GATT_INDICATION == r.type );
+            CHECK( r.handle, 0x0010 );
+            CHECK( r.origLength, 300 );
+            CHECK( r.length, DBTBrokerRing::SLOT_DATA_SIZE );
+            CHECKT( 0 == memcmp(r.data, value.get_ptr(), r.length) );
+            CHECK( client.getReadCount(), 2 );
+            CHECK( client.getLostCount(), 0 );
+        }
+
+        // Lagging client loses overwritten records only
+        {
+            for(int i=0; i<20; i++) {
+                const uint8_t v = static_cast<uint8_t>(i);
+                publisher.publish(addr, BDAddressType::BDADDR_LE_PUBLIC, 0x0020, TROOctets(&v, 1), i, false);
+            }
+            CHECK( client.getAvailable(), 8 );
+            int count = 0;
+            uint8_t last = 0;
+            while( client.next(r) ) {
+                count++;
+                last = r.data[0];
+            }
+            CHECK( count, 8 );
+            CHECK( last, 19 );
+            CHECK( client.getLostCount(), 12 );
+        }
+
+        // Blocking wait for the next record
+        {
+            std::thread producer([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                const uint8_t v = 0x33;
+                publisher.publish(addr, BDAddressType::BDADDR_LE_PUBLIC, 0x0030, TROOctets(&v, 1), 0, false);
+            });
+            const uint64_t t0 = getCurrentMilliseconds();
+            CHECKT( client.next(r, 5000) );
+            CHECKT( getCurrentMilliseconds() - t0 < 5000 );
+            CHECK( r.data[0], 0x33 );
+            producer.join();
+            CHECKT( !client.next(r, 10) );
+        }
+
+        // Client in another process
+        {
+            const uint64_t clients0 = publisher.getClientCount();
+            const pid_t pid = ::fork();
+            if( 0 == pid ) {
+                ::_exit( readChild(path) ? 0 : 1 );
+            }
+            CHECKT( 0 < pid );
+            // The child reads from its current position on, hence publish until it exits
+            const uint8_t v = 0x42;
+            const uint64_t t0 = getCurrentMilliseconds();
+            int status = -1;
+            pid_t res = 0;
+            while( 0 == res && getCurrentMilliseconds() - t0 < 10000 ) {
+                if( publisher.getClientCount() > clients0 ) {
+                    publisher.publish(addr, BDAddressType::BDADDR_LE_PUBLIC, 0x0040, TROOctets(&v, 1), 0, false);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                res = ::waitpid(pid, &status, WNOHANG);
+            }
+            CHECK( res, pid );
+            CHECKT( WIFEXITED(status) );
+            CHECK( WEXITSTATUS(status), 0 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTEnv.hpp>
+#include <direct_bt/HCIHandler.hpp>
+#include <direct_bt/GATTHandler.hpp>
+#include <direct_bt/DBTManager.hpp>
+
+using namespace direct_bt;
+
+static int listenerCount = 0;
+static std::string listenerName;
+
+static void myPropertyListener(const std::string & name) {
+    listenerCount++;
+    listenerName = name;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        GATTEnv & gattEnv = GATTEnv::get();
+        HCIEnv & hciEnv = HCIEnv::get();
+        MgmtEnv & mgmtEnv = MgmtEnv::get();
+        CHECK( gattEnv.GATT_READ_COMMAND_REPLY_TIMEOUT, 500 );
+        CHECK( hciEnv.HCI_COMMAND_STATUS_REPLY_TIMEOUT, 3000 );
+        CHECK( mgmtEnv.MGMT_COMMAND_REPLY_TIMEOUT, 3000 );
+
+        DBTEnv::addPropertyListener(myPropertyListener);
+
+        CHECKT( DBTEnv::setProperty("direct_bt.gatt.cmd.read.timeout", "1000") );
+        CHECK( gattEnv.GATT_READ_COMMAND_REPLY_TIMEOUT, 1000 );
+        CHECK( listenerCount, 1 );
+        CHECKT( listenerName == "direct_bt.gatt.cmd.read.timeout" );
+
+        // below its minimum -> default
+        CHECKT( DBTEnv::setProperty("direct_bt.gatt.cmd.read.timeout", "100") );
+        CHECK( gattEnv.GATT_READ_COMMAND_REPLY_TIMEOUT, 500 );
+
+        CHECKT( DBTEnv::setProperty("direct_bt.gatt.ringsize", "256") );
+        CHECK( gattEnv.ATTPDU_RING_CAPACITY, 256 );
+
+        CHECKT( DBTEnv::setProperty("direct_bt.hci.cmd.status.timeout", "2000") );
+        CHECK( hciEnv.HCI_COMMAND_STATUS_REPLY_TIMEOUT, 2000 );
+        CHECK( gattEnv.ATTPDU_RING_CAPACITY, 256 );
+
+        CHECKT( DBTEnv::setProperty("direct_bt.mgmt.cmd.timeout", "5000") );
+        CHECK( mgmtEnv.MGMT_COMMAND_REPLY_TIMEOUT, 5000 );
+        CHECK( hciEnv.HCI_COMMAND_STATUS_REPLY_TIMEOUT, 2000 );
+        CHECK( listenerCount, 5 );
+
+        CHECKT( !DBTEnv::setProperty("", "1") );
+        CHECK( listenerCount, 5 );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
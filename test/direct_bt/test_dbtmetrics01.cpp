@@ -0,0 +1,104 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTMetrics.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            // exact below SUB_BUCKET_COUNT, log-linear above, bounds contiguous
+            CHECK( LatencyHistogram::getBucketIndex(0), 0 );
+            CHECK( LatencyHistogram::getBucketIndex(7), 7 );
+            CHECK( LatencyHistogram::getBucketIndex(8), 8 );
+            CHECK( LatencyHistogram::getBucketIndex(16), 16 );
+            CHECK( LatencyHistogram::getBucketIndex(17), 16 );
+            CHECK( LatencyHistogram::getBucketIndex(UINT64_MAX), LatencyHistogram::BUCKET_COUNT - 1 );
+            for(int i=0; i<LatencyHistogram::BUCKET_COUNT; i++) {
+                const uint64_t lo = LatencyHistogram::getBucketLowerBound(i);
+                const uint64_t hi = LatencyHistogram::getBucketUpperBound(i);
+                CHECK( LatencyHistogram::getBucketIndex(lo), i );
+                CHECK( LatencyHistogram::getBucketIndex(hi-1), i );
+                if( i+1 < LatencyHistogram::BUCKET_COUNT ) {
+                    CHECK( LatencyHistogram::getBucketLowerBound(i+1), hi );
+                }
+            }
+        }
+        {
+            DBTMetrics m(true);
+            LatencyHistogram & h = m.getHistogram("test_op", "opcode", "READ_INFO");
+            CHECKT( &h == &m.getHistogram("test_op", "opcode", "READ_INFO") );
+            for(uint64_t i=1; i<=100; i++) {
+                h.record(i * 100);
+            }
+            h.recordError();
+            std::vector<LatencySnapshot> s = m.getSnapshot();
+            CHECK( s.size(), 1 );
+            CHECK( s[0].count, 100 );
+            CHECK( s[0].errors, 1 );
+            CHECK( s[0].max, 10000 );
+            CHECK( s[0].sum, 505000 );
+            const uint64_t p50 = s[0].getPercentile(0.5);
+            CHECKT( 5000 <= p50 && p50 <= 5000 + 5000/8 + 1 );
+            CHECK( s[0].getPercentile(1.0), 10001 );
+
+            const std::string p = m.toPrometheus();
+            CHECKT( std::string::npos != p.find("# TYPE direct_bt_test_op_microseconds histogram") );
+            CHECKT( std::string::npos != p.find("direct_bt_test_op_microseconds_bucket{opcode=\"READ_INFO\",le=\"+Inf\"} 100") );
+            CHECKT( std::string::npos != p.find("direct_bt_test_op_microseconds_bucket{opcode=\"READ_INFO\",le=\"8191\"} 81") );
+            CHECKT( std::string::npos != p.find("direct_bt_test_op_microseconds_count{opcode=\"READ_INFO\"} 100") );
+            CHECKT( std::string::npos != p.find("direct_bt_test_op_errors_total{opcode=\"READ_INFO\"} 1") );
+        }
+        {
+            DBTMetrics m(true);
+            MetricGauge & g = m.getGauge("test_objects", "dev_id", "0");
+            CHECKT( &g == &m.getGauge("test_objects", "dev_id", "0") );
+            CHECK( g.get(), 0 );
+            g.set(10);
+            g.add(-3);
+            CHECK( g.get(), 7 );
+            m.getGauge("test_objects", "dev_id", "1").set(2);
+            CHECK( m.getSnapshot().size(), 0 ); // histograms only
+
+            const std::string p = m.toPrometheus();
+            CHECKT( std::string::npos != p.find("# TYPE direct_bt_test_objects gauge\n") );
+            CHECKT( std::string::npos != p.find("direct_bt_test_objects{dev_id=\"0\"} 7\n") );
+            CHECKT( std::string::npos != p.find("direct_bt_test_objects{dev_id=\"1\"} 2\n") );
+        }
+        {
+            RTTEstimator e;
+            CHECK( e.getTimeout(500, 10, 30000), 500 ); // w/o samples
+            e.addSample(20000);
+            CHECK( e.getSmoothedRTT(), 20000 );
+            CHECK( e.getRTTVariation(), 10000 );
+            CHECK( e.getTimeout(500, 10, 30000), 60 );
+            e.addSample(20000);
+            CHECK( e.getSmoothedRTT(), 20000 );
+            CHECK( e.getRTTVariation(), 7500 );
+            CHECK( e.getTimeout(500, 10, 30000), 50 );
+            e.addSample(100000);
+            CHECK( e.getSmoothedRTT(), 30000 );
+            CHECK( e.getRTTVariation(), 25625 );
+            CHECK( e.getTimeout(500, 10, 30000), 133 );
+            CHECK( e.getTimeout(500, 10, 100), 100 );
+            CHECK( e.getTimeout(500, 200, 30000), 200 );
+            CHECK( e.getSampleCount(), 3 );
+            e.reset();
+            CHECK( e.getTimeout(500, 10, 30000), 500 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTMetrics.hpp>
+#include <direct_bt/DBTMutex.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        DBTRecursiveMutex mtx("test_mutex");
+        {
+            std::lock_guard<DBTRecursiveMutex> lock0(mtx);
+            std::lock_guard<DBTRecursiveMutex> lock1(mtx); // recursive
+            CHECKT( mtx.try_lock() );
+            mtx.unlock();
+        }
+        int counter = 0;
+        {
+            std::thread t0;
+            {
+                std::lock_guard<DBTRecursiveMutex> lock(mtx);
+                t0 = std::thread([&]() {
+                    std::lock_guard<DBTRecursiveMutex> lock2(mtx); // contended
+                    counter++;
+                });
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                CHECK( counter, 0 );
+            }
+            t0.join();
+            CHECK( counter, 1 );
+        }
+#ifdef DBT_LOCK_METRICS
+        if( DBTMetrics::get().isEnabled() ) {
+            LatencyHistogram & wait = DBTMetrics::get().getHistogram("lock_wait", "lock", "test_mutex");
+            LatencyHistogram & hold = DBTMetrics::get().getHistogram("lock_hold", "lock", "test_mutex");
+            CHECK( wait.getCount(), 1 );
+            CHECK( hold.getCount(), 3 ); // one outermost acquisition each, recursion not counted
+        }
+#endif
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTTrace.hpp>
+#include <direct_bt/MgmtTypes.hpp>
+#include <direct_bt/HCITypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            DBTTrace t(0);
+            CHECKT( !t.isEnabled() );
+            t.record(TraceSource::MGMT_CMD, 1, 0, 0, 0, 0);
+            CHECK( t.getWriteCount(), 0 );
+            CHECK( t.getRecords().size(), 0 );
+        }
+        {
+            DBTTrace t(4);
+            CHECKT( t.isEnabled() );
+            t.record(TraceSource::MGMT_CMD, 1, static_cast<uint16_t>(MgmtOpcode::READ_INFO), 0, 2, 0);
+            t.record(TraceSource::MGMT_EVT, 2, static_cast<uint16_t>(MgmtEvent::Opcode::CMD_COMPLETE),
+                     static_cast<uint16_t>(MgmtOpcode::READ_INFO), 2, 280);
+            std::vector<TraceRecord> r = t.getRecords();
+            CHECK( r.size(), 2 );
+            CHECK( r[0].timestamp, 1 );
+            CHECKT( r[0].source == TraceSource::MGMT_CMD );
+            CHECK( r[1].size, 280 );
+            CHECKT( std::string::npos != r[1].toString().find("READ_INFO") );
+        }
+        {
+            DBTTrace t(4);
+            for(int i=0; i<10; i++) {
+                t.record(TraceSource::HCI_EVT, i, number(HCIEventType::LE_META), number(HCIMetaEventType::LE_ADVERTISING_REPORT), 0, i);
+            }
+            CHECK( t.getWriteCount(), 10 );
+            std::vector<TraceRecord> r = t.getRecords();
+            CHECK( r.size(), 4 );
+            CHECK( r[0].timestamp, 6 ); // oldest first
+            CHECK( r[3].timestamp, 9 );
+            CHECKT( std::string::npos != r[3].toString().find("LE_ADVERTISING_REPORT") );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,181 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <vector>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTWorkflow.hpp>
+
+using namespace direct_bt;
+
+/** Simulated asynchronous operation, completing on its own thread like a GATTHandler async worker */
+class AsyncOperation {
+    private:
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> completions;
+        bool shallStop;
+        std::thread worker;
+
+        void workerImpl() {
+            std::unique_lock<std::mutex> lock(mtx);
+            while( !shallStop || !completions.empty() ) {
+                if( completions.empty() ) {
+                    cv.wait(lock);
+                    continue;
+                }
+                std::function<void()> c = std::move(completions.front());
+                completions.pop_front();
+                lock.unlock();
+                c();
+                lock.lock();
+            }
+        }
+
+    public:
+        AsyncOperation() : shallStop(false) {
+            worker = std::thread(&AsyncOperation::workerImpl, this);
+        }
+        ~AsyncOperation() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                shallStop = true;
+            }
+            cv.notify_all();
+            worker.join();
+        }
+        void start(std::function<void()> completion) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                completions.push_back(std::move(completion));
+            }
+            cv.notify_one();
+        }
+};
+
+static bool waitFor(const std::atomic<int> & v, const int exp) {
+    for(int i=0; i<500 && v < exp; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return v == exp;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const DBTThreadOptions opts("direct_bt.test.workflow", "dbt_test_wf");
+        std::shared_ptr<DBTExecutor> executor = DBTExecutor::create(2, opts);
+        CHECKT( executor->isRunning() );
+        CHECK( executor->getThreadCount(), 2 );
+        AsyncOperation op;
+
+        // many concurrent workflows of three async steps on two threads
+        {
+            const int count = 1000;
+            std::atomic<int> completed(0), succeeded(0), orderErrors(0);
+            std::vector<std::shared_ptr<DBTWorkflow>> workflows;
+            for(int i=0; i<count; i++) {
+                std::shared_ptr<std::atomic<int>> progress = std::make_shared<std::atomic<int>>(0);
+                std::shared_ptr<DBTWorkflow> wf = DBTWorkflow::create(executor);
+                for(int s=0; s<3; s++) {
+                    wf->then([&op, progress, s, &orderErrors](const DBTWorkflow::Continuation & next) {
+                        if( s != (*progress)++ ) {
+                            orderErrors++;
+                        }
+                        op.start([next]() { next.resume(); });
+                    });
+                }
+                CHECK( wf->getStepCount(), (size_t)3 );
+                workflows.push_back(wf);
+                CHECKT( wf->start([&completed, &succeeded](const bool success, const std::string & cause) {
+                    if( success && cause.empty() ) {
+                        succeeded++;
+                    }
+                    completed++;
+                }) );
+                CHECKT( !wf->start(nullptr) );
+            }
+            CHECKT( waitFor(completed, count) );
+            CHECK( succeeded.load(), count );
+            CHECK( orderErrors.load(), 0 );
+            for(std::shared_ptr<DBTWorkflow> & wf : workflows) {
+                CHECKT( wf->isDone() );
+                CHECK( wf->getFinishedStepCount(), (size_t)3 );
+            }
+        }
+
+        // failing blocking step skips the remaining steps, stale continuations are ignored
+        {
+            std::atomic<int> completed(0), lastRun(0);
+            std::string failCause;
+            bool failSuccess = true;
+            std::shared_ptr<DBTWorkflow> wf = DBTWorkflow::create(executor);
+            wf->thenBlocking([&lastRun]() { lastRun = 1; return true; }, "first")
+               .then([&lastRun](const DBTWorkflow::Continuation & next) {
+                    lastRun = 2;
+                    next.fail("second");
+                    next.resume(); // stale
+               })
+               .thenBlocking([&lastRun]() { lastRun = 3; return true; }, "third");
+            CHECKT( wf->start([&](const bool success, const std::string & cause) {
+                failSuccess = success;
+                failCause = cause;
+                completed++;
+            }) );
+            CHECKT( waitFor(completed, 1) );
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK( completed.load(), 1 );
+            CHECK( lastRun.load(), 2 );
+            CHECKT( !failSuccess );
+            CHECKT( "second" == failCause );
+            CHECKT( wf->isDone() );
+        }
+
+        // exception of a step fails the workflow, empty workflow completes
+        {
+            std::atomic<int> completed(0);
+            std::string cause0;
+            std::shared_ptr<DBTWorkflow> wf = DBTWorkflow::create(executor);
+            wf->then([](const DBTWorkflow::Continuation & next) {
+                (void)next;
+                throw std::runtime_error("thrown");
+            });
+            CHECKT( wf->start([&](const bool success, const std::string & cause) {
+                if( !success ) {
+                    cause0 = cause;
+                }
+                completed++;
+            }) );
+            std::shared_ptr<DBTWorkflow> empty = DBTWorkflow::create(executor);
+            CHECKT( empty->start([&](const bool success, const std::string & cause) {
+                (void)cause;
+                if( success ) {
+                    completed++;
+                }
+            }) );
+            CHECKT( waitFor(completed, 2) );
+            CHECKT( "thrown" == cause0 );
+        }
+
+        // stopped executor
+        executor->stop(true /* wait */);
+        CHECKT( !executor->isRunning() );
+        CHECKT( !executor->post([]() { }) );
+        std::shared_ptr<DBTWorkflow> wf = DBTWorkflow::create(executor);
+        wf->thenBlocking([]() { return true; }, "never");
+        CHECKT( !wf->start(nullptr) );
+        CHECKT( !wf->isDone() );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DeviceJournal.hpp>
+
+using namespace direct_bt;
+
+typedef std::shared_ptr<int> element_t;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const element_t a(new int(1)), b(new int(2)), c(new int(3));
+        {
+            DeviceJournal<int> j(8);
+            std::vector<element_t> added, removed;
+            CHECK( j.getVersion(), 0 );
+            CHECKT( j.getChanges(0, added, removed) );
+            CHECK( added.size(), 0 );
+
+            j.added(a);
+            j.added(b);
+            j.added(c);
+            CHECK( j.getVersion(), 3 );
+            CHECKT( j.getChanges(0, added, removed) );
+            CHECK( added.size(), 3 );
+            CHECKT( added[0] == a && added[1] == b && added[2] == c );
+            CHECK( removed.size(), 0 );
+
+            // b added and removed since 1: omitted
+            j.removed(b);
+            j.removed(a);
+            added.clear(); removed.clear();
+            CHECKT( j.getChanges(1, added, removed) );
+            CHECK( added.size(), 1 );
+            CHECKT( added[0] == c );
+            CHECK( removed.size(), 1 );
+            CHECKT( removed[0] == a );
+
+            // future version
+            CHECKT( !j.getChanges(6, added, removed) );
+        }
+        {
+            // capacity exceeded
+            DeviceJournal<int> j(2);
+            std::vector<element_t> added, removed;
+            j.added(a);
+            j.added(b);
+            j.added(c);
+            CHECK( j.size(), 2 );
+            CHECKT( !j.getChanges(0, added, removed) );
+            CHECKT( j.getChanges(1, added, removed) );
+            CHECK( added.size(), 2 );
+            CHECKT( added[0] == b && added[1] == c );
+        }
+        {
+            // reset
+            DeviceJournal<int> j(8);
+            std::vector<element_t> added, removed;
+            j.added(a);
+            j.reset();
+            CHECK( j.getVersion(), 2 );
+            CHECKT( !j.getChanges(1, added, removed) );
+            j.added(b);
+            CHECKT( j.getChanges(2, added, removed) );
+            CHECK( added.size(), 1 );
+            CHECKT( added[0] == b );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
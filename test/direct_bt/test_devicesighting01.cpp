@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/BTTypes.hpp>
+#include <direct_bt/DeviceSighting.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    static void setReport(EInfoReport & eir, const uint8_t id, const BDAddressType type, const uint8_t msb, const uint64_t ts) {
+        eir.setSource(EInfoReport::Source::AD);
+        eir.setTimestamp(ts);
+        eir.setEvtType(AD_PDU_Type::ADV_IND);
+        eir.setAddressType(type);
+        eir.setAddress(EUI48(id, 0x02, 0x03, 0x04, 0x05, msb));
+        eir.setRSSI(-60);
+    }
+
+    static EIRDataType add(DeviceSightingTable & t, const uint8_t id, const BDAddressType type, const uint8_t msb, const uint64_t ts, bool & created) {
+        EInfoReport eir;
+        setReport(eir, id, type, msb, ts);
+        return t.add(eir, created);
+    }
+
+    void single_test() override {
+        {
+            DeviceSightingTable disabled(0);
+            CHECKT( !disabled.isEnabled() );
+        }
+        DeviceSightingTable t(16);
+        CHECKT( t.isEnabled() );
+        CHECK( t.getCapacity(), 16 );
+        bool created = false;
+        {
+            // new data per sighting
+            EInfoReport eir;
+            setReport(eir, 0, BDAddressType::BDADDR_LE_PUBLIC, 0xC0, 1);
+            EIRDataType newData = t.add(eir, created);
+            CHECKT( created );
+            CHECKT( isEIRDataTypeSet(newData, EIRDataType::RSSI) );
+            CHECKT( !isEIRDataTypeSet(newData, EIRDataType::TX_POWER) );
+
+            newData = t.add(eir, created);
+            CHECKT( !created );
+            CHECKT( EIRDataType::NONE == newData );
+
+            eir.setTxPower(-4);
+            eir.setTimestamp(2);
+            newData = t.add(eir, created);
+            CHECKT( !created );
+            CHECKT( EIRDataType::TX_POWER == newData );
+
+            DeviceSighting s;
+            CHECKT( t.get(eir.getAddress(), eir.getAddressType(), s) );
+            CHECK( s.count, 3 );
+            CHECK( s.ts_first, 1 );
+            CHECK( s.ts_last, 2 );
+            CHECK( s.tx_power, -4 );
+            CHECKT( !t.get(eir.getAddress(), BDAddressType::BDADDR_LE_RANDOM, s) );
+        }
+        {
+            // capacity exceeded, evicting the least recently seen eighth
+            for(uint8_t i=1; i<16; i++) {
+                add(t, i, BDAddressType::BDADDR_LE_PUBLIC, 0xC0, 10+i, created);
+                CHECKT( created );
+            }
+            CHECK( t.size(), 16 );
+            add(t, 16, BDAddressType::BDADDR_LE_PUBLIC, 0xC0, 100, created);
+            CHECK( t.size(), 15 );
+            DeviceSighting s;
+            CHECKT( !t.get(EUI48(0, 0x02, 0x03, 0x04, 0x05, 0xC0), BDAddressType::BDADDR_LE_PUBLIC, s) );
+            CHECKT( !t.get(EUI48(1, 0x02, 0x03, 0x04, 0x05, 0xC0), BDAddressType::BDADDR_LE_PUBLIC, s) );
+            CHECKT( t.get(EUI48(2, 0x02, 0x03, 0x04, 0x05, 0xC0), BDAddressType::BDADDR_LE_PUBLIC, s) );
+            CHECKT( t.get(EUI48(16, 0x02, 0x03, 0x04, 0x05, 0xC0), BDAddressType::BDADDR_LE_PUBLIC, s) );
+            CHECKT( t.getMemoryFootprint() >= t.size() * DeviceSightingTable::ENTRY_SIZE );
+            CHECKT( DeviceSightingTable::ENTRY_SIZE > sizeof(DeviceSighting) );
+            CHECKT( t.remove(EUI48(16, 0x02, 0x03, 0x04, 0x05, 0xC0), BDAddressType::BDADDR_LE_PUBLIC) );
+            CHECKT( !t.remove(EUI48(16, 0x02, 0x03, 0x04, 0x05, 0xC0), BDAddressType::BDADDR_LE_PUBLIC) );
+            CHECK( t.getSightings().size(), 14 );
+            t.clear();
+            CHECK( t.size(), 0 );
+        }
+        {
+            // time to live, non-resolvable private addresses expire first
+            add(t, 1, BDAddressType::BDADDR_LE_PUBLIC, 0xC0, 1000, created);
+            add(t, 2, BDAddressType::BDADDR_LE_RANDOM, 0x00, 1000, created); // NRPA
+            add(t, 3, BDAddressType::BDADDR_LE_RANDOM, 0xC0, 1000, created); // static
+            CHECK( t.evictExpired(1500, 0, 0), 0 );
+            CHECK( t.evictExpired(1500, 1000, 200), 1 );
+            CHECK( t.size(), 2 );
+            CHECK( t.evictExpired(2500, 1000, 200), 2 );
+            CHECK( t.size(), 0 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
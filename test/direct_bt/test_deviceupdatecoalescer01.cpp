@@ -0,0 +1,224 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTAdapter.hpp>
+#include <direct_bt/DeviceUpdateCoalescer.hpp>
+#include <direct_bt/BasicTypes.hpp>
+
+using namespace direct_bt;
+
+/**
+ * Records deviceUpdated() notifications, optionally stopping the given coalescer from within the callback.
+ */
+class UpdateRecorder : public AdapterStatusListener {
+    public:
+        struct Update {
+            const DBTDevice * device;
+            EIRDataType updateMask;
+            uint64_t timestamp;
+            uint64_t received;
+            std::thread::id thread;
+        };
+        std::mutex mtx;
+        std::vector<Update> updates;
+        DeviceUpdateCoalescer * stopOnUpdate = nullptr;
+
+        void adapterSettingsChanged(DBTAdapter const &a, const AdapterSetting oldmask, const AdapterSetting newmask,
+                                    const AdapterSetting changedmask, const uint64_t timestamp) override {
+            (void)a; (void)oldmask; (void)newmask; (void)changedmask; (void)timestamp;
+        }
+        void discoveringChanged(DBTAdapter const &a, const bool enabled, const bool keepAlive, const uint64_t timestamp) override {
+            (void)a; (void)enabled; (void)keepAlive; (void)timestamp;
+        }
+        void deviceFound(std::shared_ptr<DBTDevice> device, const uint64_t timestamp) override {
+            (void)device; (void)timestamp;
+        }
+        void deviceUpdated(std::shared_ptr<DBTDevice> device, const EIRDataType updateMask, const uint64_t timestamp) override {
+            {
+                const std::lock_guard<std::mutex> lock(mtx);
+                updates.push_back( Update { device.get(), updateMask, timestamp, static_cast<uint64_t>(getCurrentMilliseconds()), std::this_thread::get_id() } );
+            }
+            if( nullptr != stopOnUpdate ) {
+                stopOnUpdate->stop();
+                std::this_thread::sleep_for(std::chrono::milliseconds(50)); // let the owner destroy the coalescer meanwhile
+            }
+        }
+        void deviceConnected(std::shared_ptr<DBTDevice> device, const uint16_t handle, const uint64_t timestamp) override {
+            (void)device; (void)handle; (void)timestamp;
+        }
+        void deviceDisconnected(std::shared_ptr<DBTDevice> device, const HCIStatusCode reason, const uint16_t handle, const uint64_t timestamp) override {
+            (void)device; (void)reason; (void)handle; (void)timestamp;
+        }
+        std::string toString() const override { return "UpdateRecorder"; }
+
+        size_t count() {
+            const std::lock_guard<std::mutex> lock(mtx);
+            return updates.size();
+        }
+        Update get(const size_t i) {
+            const std::lock_guard<std::mutex> lock(mtx);
+            return updates.at(i);
+        }
+        bool waitFor(const size_t n, const uint64_t timeoutMS) {
+            const uint64_t t0 = getCurrentMilliseconds();
+            while( count() < n && getCurrentMilliseconds() - t0 < timeoutMS ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            return count() >= n;
+        }
+};
+
+/**
+ * Returns an opaque device handle for the coalescer, which merely keys and tracks the lifetime of devices
+ * and never dereferences them. A DBTDevice itself requires a powered DBTAdapter.
+ */
+static std::shared_ptr<DBTDevice> createDeviceHandle() {
+    std::shared_ptr<uint64_t> owner = std::make_shared<uint64_t>(0);
+    return std::shared_ptr<DBTDevice>(owner, reinterpret_cast<DBTDevice*>(owner.get()));
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+  public:
+    void single_test() override {
+        const EIRDataType immediate = EIRDataType::NAME;
+
+        // No coalescing: delivered immediately on the caller's thread
+        {
+            DeviceUpdateCoalescer coalescer;
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d = createDeviceHandle();
+            const DeviceUpdatePolicy policy(0, immediate);
+            for(int i=0; i<3; i++) {
+                coalescer.update(l, policy, d, EIRDataType::RSSI, i);
+            }
+            CHECK( l->count(), 3 );
+            CHECKT( l->get(2).thread == std::this_thread::get_id() );
+            CHECK( coalescer.size(), 0 );
+        }
+
+        // Coalescing: first update immediately, following updates merged and flushed once after the interval
+        {
+            DeviceUpdateCoalescer coalescer;
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d = createDeviceHandle();
+            const DeviceUpdatePolicy policy(100, immediate);
+            const uint64_t t0 = getCurrentMilliseconds();
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 1);
+            CHECK( l->count(), 1 );
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 2);
+            coalescer.update(l, policy, d, EIRDataType::TX_POWER, 3);
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 4);
+            CHECK( l->count(), 1 );
+            CHECK( coalescer.size(), 1 );
+
+            CHECKT( l->waitFor(2, 5000) );
+            const UpdateRecorder::Update u = l->get(1);
+            CHECKT( u.device == d.get() );
+            CHECKT( ( EIRDataType::RSSI | EIRDataType::TX_POWER ) == u.updateMask );
+            CHECK( u.timestamp, 4 ); // of the latest merged update
+            CHECKT( u.received >= t0 + 100 );
+            CHECKT( u.received < t0 + 2000 );
+            CHECKT( u.thread != std::this_thread::get_id() );
+
+            // No further delivery w/o updates, idle entry dropped after its interval
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            CHECK( l->count(), 2 );
+            CHECK( coalescer.size(), 0 );
+        }
+
+        // Immediate mask: delivered w/o delay including all pending bits, nothing left to flush
+        {
+            DeviceUpdateCoalescer coalescer;
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d = createDeviceHandle();
+            const DeviceUpdatePolicy policy(200, immediate);
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 1);
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 2);
+            coalescer.update(l, policy, d, EIRDataType::NAME, 3);
+            CHECK( l->count(), 2 );
+            CHECKT( ( EIRDataType::RSSI | EIRDataType::NAME ) == l->get(1).updateMask );
+            CHECKT( l->get(1).thread == std::this_thread::get_id() );
+            std::this_thread::sleep_for(std::chrono::milliseconds(400));
+            CHECK( l->count(), 2 );
+        }
+
+        // Devices are coalesced independently, a pending update of a destroyed device is dropped
+        {
+            DeviceUpdateCoalescer coalescer;
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d1 = createDeviceHandle();
+            std::shared_ptr<DBTDevice> d2 = createDeviceHandle();
+            const DeviceUpdatePolicy policy(100, immediate);
+            coalescer.update(l, policy, d1, EIRDataType::RSSI, 1);
+            coalescer.update(l, policy, d2, EIRDataType::RSSI, 2);
+            CHECK( l->count(), 2 );
+            coalescer.update(l, policy, d1, EIRDataType::RSSI, 3);
+            coalescer.update(l, policy, d2, EIRDataType::RSSI, 4);
+            const DBTDevice * d2_ptr = d2.get();
+            d2 = nullptr;
+            CHECKT( l->waitFor(3, 5000) );
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            CHECK( l->count(), 3 );
+            CHECKT( l->get(2).device == d1.get() );
+            CHECKT( l->get(2).device != d2_ptr );
+        }
+
+        // Removed listener and clear() drop pending updates
+        {
+            DeviceUpdateCoalescer coalescer;
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d = createDeviceHandle();
+            const DeviceUpdatePolicy policy(100, immediate);
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 1);
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 2);
+            coalescer.removeListener(l.get());
+            CHECK( coalescer.size(), 0 );
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            CHECK( l->count(), 1 );
+        }
+
+        // Stopped and destroyed from within a deferred delivery on the timer thread
+        {
+            DeviceUpdateCoalescer * coalescer = new DeviceUpdateCoalescer();
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d = createDeviceHandle();
+            const DeviceUpdatePolicy policy(50, immediate);
+            coalescer->update(l, policy, d, EIRDataType::RSSI, 1);
+            l->stopOnUpdate = coalescer;
+            coalescer->update(l, policy, d, EIRDataType::RSSI, 2);
+            CHECKT( l->waitFor(2, 5000) );
+            delete coalescer; // while the detached timer thread still runs the callback
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            CHECK( l->count(), 2 );
+        }
+
+        // Stopped coalescer drops further updates
+        {
+            DeviceUpdateCoalescer coalescer;
+            std::shared_ptr<UpdateRecorder> l = std::make_shared<UpdateRecorder>();
+            std::shared_ptr<DBTDevice> d = createDeviceHandle();
+            const DeviceUpdatePolicy policy(50, immediate);
+            coalescer.stop();
+            coalescer.update(l, policy, d, EIRDataType::RSSI, 1);
+            CHECK( l->count(), 0 );
+            CHECK( coalescer.size(), 0 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
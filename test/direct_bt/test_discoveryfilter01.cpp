@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DiscoveryFilter.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        // flags, complete 16-bit UUIDs, complete name, manufacturer specific data
+        const uint8_t ad[] = { 0x02, 0x01, 0x06,
+                               0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18,
+                               0x05, 0x09, 'T', 'e', 's', 't',
+                               0x05, 0xff, 0x59, 0x00, 0xaa, 0xbb };
+        const EUI48 address("C0:26:DA:01:DA:B1");
+        EInfoReport eir;
+        eir.setAddress(address);
+        eir.setAddressType(BDAddressType::BDADDR_LE_PUBLIC);
+        eir.setRSSI(-60);
+        eir.read_data(ad, sizeof(ad), true /* lazy */);
+        {
+            DiscoveryFilter f;
+            CHECKT( f.isEmpty() );
+            CHECKT( f.match(eir) );
+        }
+        {
+            DiscoveryFilter f;
+            f.addAddress(address);
+            CHECKT( f.match(eir) );
+            CHECKT( !f.isAddressOnly() );
+            DiscoveryFilter g;
+            g.addAddress(address, BDAddressType::BDADDR_LE_RANDOM);
+            CHECKT( !g.match(eir) );
+            CHECKT( g.isAddressOnly() );
+            g.addAddressType(BDAddressType::BDADDR_LE_PUBLIC).addAddress(address, BDAddressType::BDADDR_LE_PUBLIC);
+            CHECKT( g.match(eir) );
+        }
+        {
+            DiscoveryFilter f;
+            f.setMinRSSI(-50);
+            CHECKT( !f.match(eir) );
+            f.setMinRSSI(-70);
+            CHECKT( f.match(eir) );
+            CHECKT( eir.isLazyPending() );
+        }
+        {
+            DiscoveryFilter f;
+            f.addCompany(0x0001);
+            CHECKT( !f.match(eir) );
+            f.addCompany(0x0059);
+            CHECKT( f.match(eir) );
+        }
+        {
+            DiscoveryFilter f;
+            f.addService(uuid_value_t(uuid16_t(0x180d)));
+            CHECKT( !f.match(eir) );
+            f.addService(uuid_value_t(uuid16_t(0x180a)));
+            CHECKT( f.match(eir) );
+        }
+        {
+            DiscoveryFilter f;
+            f.addNamePrefix("Tes").addService(uuid_value_t(uuid16_t(0x180f)));
+            CHECKT( f.match(eir) );
+            f.setMinRSSI(-50);
+            CHECKT( !f.match(eir) );
+            DiscoveryFilter g;
+            g.addNamePrefix("Testing");
+            CHECKT( !g.match(eir) );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/BTTypes.hpp>
+#include <direct_bt/dfa_utf8_decode.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        // flags, complete 16-bit UUIDs, complete name, manufacturer specific data, tx power
+        const uint8_t ad[] = { 0x02, 0x01, 0x06,
+                               0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18,
+                               0x05, 0x09, 'T', 'e', 's', 't',
+                               0x05, 0xff, 0x59, 0x00, 0xaa, 0xbb,
+                               0x02, 0x0a, 0xf4 };
+        EInfoReport eager;
+        CHECK( eager.read_data(ad, sizeof(ad)), 5 );
+        CHECKT( !eager.isLazyPending() );
+
+        EInfoReport lazy;
+        CHECK( lazy.read_data(ad, sizeof(ad), true /* lazy */), 5 );
+        CHECKT( lazy.isLazyPending() );
+        CHECKT( eager.getEIRDataMask() == lazy.getEIRDataMask() );
+        CHECK( lazy.getFlags(), 0x06 );
+        CHECK( lazy.getTxPower(), -12 );
+        CHECKT( lazy.isLazyPending() );
+
+        CHECKT( lazy.isNameEqual("Test") );
+        CHECKT( !lazy.isNameEqual("Tes") );
+        CHECKT( !lazy.isNameEqual("Test1") );
+        CHECKT( lazy.isLazyPending() );
+        CHECKT( lazy.getName() == "Test" );
+        CHECKT( lazy.isLazyPending() ); // fields are materialized individually
+        CHECKT( lazy.isNameEqual("Test") );
+        CHECK( lazy.getServices().size(), 2 );
+        CHECKT( lazy.getServices()[1] == eager.getServices()[1] );
+        CHECKT( lazy.getServices()[0] == uuid_value_t(uuid16_t(0x180f)) );
+        CHECK( lazy.getManufactureSpecificData()->company, 0x0059 );
+        CHECKT( *lazy.getManufactureSpecificData() == *eager.getManufactureSpecificData() );
+        CHECKT( lazy.toString() == eager.toString() );
+        CHECKT( !lazy.isLazyPending() );
+
+        // ASCII fast path and UTF-8 names, cut at EOS or the first invalid byte
+        const uint8_t ascii[] = "0123456789abcdefXYZ";
+        CHECK( dfa_utf8_ascii_prefix(ascii, sizeof(ascii)), sizeof(ascii)-1 );
+        CHECKT( dfa_utf8_decode(ascii, sizeof(ascii)-1) == "0123456789abcdefXYZ" );
+        CHECKT( dfa_utf8_decode(ascii, 9) == "012345678" );
+        const uint8_t utf8[] = { 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 0xC3, 0xA4, 'x', 0xFF, 'y' };
+        CHECK( dfa_utf8_ascii_prefix(utf8, sizeof(utf8)), 9 );
+        CHECKT( dfa_utf8_decode(utf8, sizeof(utf8)) == "ABCDEFGHI\xC3\xA4x" );
+        const uint8_t adUTF8[] = { 0x0f, 0x09, 'S', 'e', 'n', 's', 'o', 'r', ' ', 0xC3, 0xA4, ' ', 'T', 'a', 'g', 0xFF };
+        EInfoReport lazyUTF8;
+        CHECK( lazyUTF8.read_data(adUTF8, sizeof(adUTF8), true /* lazy */), 1 );
+        CHECKT( lazyUTF8.getName() == "Sensor \xC3\xA4 Tag" );
+
+        // a copy of a lazy report is materialized, leaving the source unmodified by rewriting the copy
+        {
+            EInfoReport shared;
+            CHECK( shared.read_data(ad, sizeof(ad), true /* lazy */), 5 );
+            shared.setAddress(EUI48("C0:11:22:33:44:55"));
+            EInfoReport copy(shared);
+            CHECKT( !copy.isLazyPending() );
+            CHECKT( copy.toString() == shared.toString() );
+            copy.setAddress(EUI48("C0:00:00:00:00:01"));
+            CHECKT( shared.getAddress() == EUI48("C0:11:22:33:44:55") );
+            CHECKT( copy.getName() == "Test" );
+            CHECK( copy.getServices().size(), 2 );
+        }
+
+        // take* moves the materialized payload out, reset() clears all fields for reuse
+        EInfoReport movable;
+        CHECK( movable.read_data(ad, sizeof(ad), true /* lazy */), 5 );
+        CHECKT( movable.takeName() == "Test" );
+        CHECK( movable.takeServices().size(), 2 );
+        CHECK( movable.takeManufactureSpecificData()->company, 0x0059 );
+        CHECKT( nullptr == movable.getManufactureSpecificData() );
+        movable.reset();
+        CHECKT( !movable.isLazyPending() );
+        CHECKT( EIRDataType::NONE == movable.getEIRDataMask() );
+        CHECKT( movable.getName().empty() );
+        CHECK( movable.getServices().size(), 0 );
+
+        // EInfoReportPool recycles instances once released by all consumers
+        EInfoReportPool pool(2);
+        EInfoReport * p0;
+        {
+            std::shared_ptr<EInfoReport> r0 = pool.acquire();
+            CHECK( r0->read_data(ad, sizeof(ad), true /* lazy */), 5 );
+            p0 = r0.get();
+            std::shared_ptr<EInfoReport> r1 = pool.acquire();
+            std::shared_ptr<EInfoReport> r2 = pool.acquire(); // exhausted
+            CHECKT( r0 != r1 && r1 != r2 );
+            CHECK( pool.getAllocCount(), 2 );
+            CHECK( pool.getFallbackCount(), 1 );
+        }
+        std::shared_ptr<EInfoReport> r3 = pool.acquire();
+        std::shared_ptr<EInfoReport> r4 = pool.acquire();
+        CHECKT( r3.get() == p0 || r4.get() == p0 );
+        CHECKT( EIRDataType::NONE == r3->getEIRDataMask() );
+        CHECKT( EIRDataType::NONE == r4->getEIRDataMask() );
+        CHECK( pool.getAllocCount(), 2 );
+        CHECK( pool.getFallbackCount(), 1 );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
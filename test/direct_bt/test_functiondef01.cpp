@@ -306,6 +306,29 @@ class Cppunit_tests : public Cppunit {
             test_FunctionPointer00("FuncPtr7ab_o100_capture_22", false, 1, 0, f7a_o100_2, f7b_o100_2);
             PRINTM("FuncPtr7_capture: bindCaptureFunc<int, IntOffset, int>: END");
         }
+        {
+            PRINTM("FuncPtr8_clone: cloneFunction/FunctionDef(InvocationFunc*): START");
+            MyClassFunction f8a_1 = bindMemberFunc(this, &Cppunit_tests::func2a_member);
+            MyClassFunction f8b_1 = bindPlainFunc(&Cppunit_tests::Func3b_static);
+
+            // round-trip through a naked InvocationFunc, as used by the JNI layer
+            MyClassFunction f8a_2( f8a_1.cloneFunction() );
+            MyClassFunction f8b_2( f8b_1.cloneFunction() );
+            test_FunctionPointer00("FuncPtr8a_clone_12", true, 1, 101, f8a_1, f8a_2);
+            test_FunctionPointer00("FuncPtr8b_clone_12", true, 1, 1001, f8b_1, f8b_2);
+            test_FunctionPointer00("FuncPtr8ab_clone_22", false, 1, 0, f8a_2, f8b_2);
+
+            // copy and move assignment preserve identity, moved-from becomes a null function
+            MyClassFunction f8a_3;
+            f8a_3 = f8a_2;
+            test_FunctionPointer00("FuncPtr8a_copy_13", true, 1, 101, f8a_1, f8a_3);
+            MyClassFunction f8a_4 = std::move(f8a_3);
+            test_FunctionPointer00("FuncPtr8a_move_14", true, 1, 101, f8a_1, f8a_4);
+            CHECKM("FuncPtr8a_moved_3", f8a_3.invoke(1), 0);
+            f8a_4 = f8b_2;
+            test_FunctionPointer00("FuncPtr8b_copy_14", true, 1, 1001, f8b_1, f8a_4);
+            PRINTM("FuncPtr8_clone: cloneFunction/FunctionDef(InvocationFunc*): END");
+        }
     }
 };
 
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/GATTCache.hpp>
+#include <direct_bt/GATTNumbers.hpp>
+#include <direct_bt/GATTAttributeTable.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        std::shared_ptr<DBTDevice> device = nullptr;
+        std::vector<GATTServiceRef> services;
+        {
+            GATTServiceRef s( new GATTService(device, true, 0x0001, 0x0009,
+                                              std::shared_ptr<const uuid_t>(new uuid16_t(GattServiceType::GENERIC_ATTRIBUTE))) );
+            GATTCharacteristicRef c( new GATTCharacteristic(s, 0x0001, 0x0002, GATTCharacteristic::Indicate, 0x0003,
+                                                            std::shared_ptr<const uuid_t>(new uuid16_t(GattCharacteristicType::SERVICE_CHANGED))) );
+            GATTDescriptorRef d( new GATTDescriptor(c, GATTDescriptor::getStaticType(GATTDescriptor::TYPE_CCC_DESC), 0x0004) );
+            const uint8_t cccd[] = { 0x02, 0x00 };
+            d->value += TROOctets(cccd, sizeof(cccd));
+            c->clientCharacteristicsConfigIndex = 0;
+            c->descriptorList.push_back(d);
+            s->characteristicList.push_back(c);
+            services.push_back(s);
+        }
+        {
+            GATTServiceRef s( new GATTService(device, true, 0x0010, 0x0020,
+                                              std::shared_ptr<const uuid_t>(new uuid128_t("d0ca6bf3-3d50-4760-98e5-fc5883e93712"))) );
+            services.push_back(s);
+        }
+        const uint8_t hash[GATTCache::DB_HASH_SIZE] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+        std::shared_ptr<const POctets> record = GATTCache::serialize(TROOctets(hash, sizeof(hash)), services);
+
+        POctets dbHash(GATTCache::DB_HASH_SIZE, 0);
+        std::vector<GATTServiceRef> restored;
+        CHECKT( GATTCache::deserialize(*record, device, dbHash, restored) );
+        CHECK(dbHash.getSize(), GATTCache::DB_HASH_SIZE);
+        CHECKT( 0 == memcmp(hash, dbHash.get_ptr(), sizeof(hash)) );
+        CHECK(restored.size(), 2);
+        CHECKT( *services[0]->type == *restored[0]->type );
+        CHECK(restored[0]->endHandle, 0x0009);
+        CHECK(restored[0]->characteristicList.size(), 1);
+        GATTCharacteristicRef c = restored[0]->characteristicList[0];
+        CHECK(c->value_handle, 0x0003);
+        CHECKT( GATTCharacteristic::Indicate == c->properties );
+        CHECK(c->descriptorList.size(), 1);
+        CHECKT( nullptr != c->getClientCharacteristicConfig() );
+        CHECK(c->getClientCharacteristicConfig()->value.get_uint8(0), 0x02);
+        CHECKT( *services[1]->type == *restored[1]->type );
+
+        // corrupt record
+        POctets truncated(record->get_ptr(), record->getSize() - 1);
+        CHECKT( !GATTCache::deserialize(truncated, device, dbHash, restored) );
+
+        // In-memory validation
+        GATTCache cache("");
+        const EUI48 address("01:02:03:04:05:06");
+        cache.put(address, TROOctets(hash, sizeof(hash)), services);
+        CHECKT( cache.get(address, &dbHash, device, restored) );
+        uint8_t hash2[GATTCache::DB_HASH_SIZE];
+        memcpy(hash2, hash, sizeof(hash2));
+        hash2[0] = 0xff;
+        const TROOctets changedHash(hash2, sizeof(hash2));
+        CHECKT( !cache.get(address, &changedHash, device, restored) );
+        CHECKT( !cache.get(address, &dbHash, device, restored) ); // invalidated
+
+        // w/o Database Hash, the Service Changed Characteristic is required
+        cache.put(address, TROOctets(hash, 0), services);
+        CHECKT( cache.get(address, nullptr, device, restored) );
+
+        // Flat attribute table
+        GATTAttributeTable table(restored);
+        CHECK(table.size(), 4);
+        CHECK(table.getServiceChangedHandle(), 0x0003);
+        GATTAttributeTable::Attribute a = table.findCharacteristicByValueHandle(0x0003);
+        CHECKT( a.isValid() );
+        CHECKT( GATTAttributeTable::Kind::CHARACTERISTIC == a.getKind() );
+        CHECKT( restored[0]->characteristicList[0] == a.getCharacteristic() );
+        CHECKT( restored[0] == a.getParent().getService() );
+        CHECKT( nullptr == a.getDescriptor() );
+        CHECKT( !table.findCharacteristicByValueHandle(0x0004).isValid() );
+        GATTAttributeTable::Attribute d = table.findByHandle(0x0004);
+        CHECKT( GATTAttributeTable::Kind::DESCRIPTOR == d.getKind() );
+        CHECK(d.getParent().getIndex(), a.getIndex());
+        CHECKT( restored[1] == table.findByHandle(0x0010).getService() );
+        CHECKT( !table.findByHandle(0x0011).isValid() );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/GATTNumbers.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests : public Cppunit {
+  public:
+    void single_test() override {
+
+        {
+            // flags uint8 value, sensor contact supported + detected: 72 bpm
+            const uint8_t data[] = { 0x06, 72 };
+            const HeartRateMeasurement hr(data, sizeof(data));
+            PRINTM(hr.toString());
+            CHECKT(hr.isValid());
+            CHECK(hr.getHeartRate(), 72);
+            CHECKT(hr.isSensorContactSupported());
+            CHECKT(hr.isSensorContactDetected());
+            CHECKT(!hr.hasEnergyExpended());
+            CHECK(hr.getRRIntervalCount(), 0);
+        }
+        {
+            // flags uint16 value + energy + rr: 300 bpm, 1000 kJ, rr { 1024, 512, 768 }
+            const uint8_t data[] = { 0x19, 0x2C, 0x01, 0xE8, 0x03, 0x00, 0x04, 0x00, 0x02, 0x00, 0x03 };
+            const TROOctets source(data, sizeof(data));
+            const HeartRateMeasurement hr(source);
+            PRINTM(hr.toString());
+            CHECKT(hr.isValid());
+            CHECK(hr.getHeartRate(), 300);
+            CHECKT(!hr.isSensorContactSupported());
+            CHECKT(hr.hasEnergyExpended());
+            CHECK(hr.getEnergyExpended(), 1000);
+            CHECK(hr.getRRIntervalCount(), 3);
+            CHECK(hr.getRRInterval(1), 512);
+
+            uint16_t rr[4];
+            CHECK(hr.getRRIntervals(rr, 4), 3);
+            CHECK(rr[0], 1024);
+            CHECK(rr[2], 768);
+            CHECK(hr.getRRIntervals(rr, 2), 2);
+
+            float rrs[4];
+            CHECK(hr.getRRIntervalsSeconds(rrs, 4), 3);
+            CHECKD("rr[0]", rrs[0], 1.0f);
+            CHECKD("rr[1]", rrs[1], 0.5f);
+            CHECKD("rr[2]", rrs[2], 0.75f);
+        }
+        {
+            // truncated: uint16 value announced, but only 1 byte
+            const uint8_t data[] = { 0x01, 0x2C };
+            CHECKT(!HeartRateMeasurement(data, sizeof(data)).isValid());
+            CHECKT(!HeartRateMeasurement(data, 0).isValid());
+        }
+        {
+            // mmHg, timestamp, pulse rate, user id, status: 120 / 80, mean 93, 2020-04-04 11:26:00, 60 bpm, user 1, status 0x0004
+            const uint8_t data[] = { 0x1E, 0x78, 0x00, 0x50, 0x00, 0x5D, 0x00,
+                                     0xE4, 0x07, 0x04, 0x04, 0x0B, 0x1A, 0x00,
+                                     0x3C, 0x00, 0x01, 0x04, 0x00 };
+            const BloodPressureMeasurement bp(data, sizeof(data));
+            PRINTM(bp.toString());
+            CHECKT(bp.isValid());
+            CHECKT(!bp.isKPa());
+            CHECKD("systolic", bp.getSystolic(), 120.0f);
+            CHECKD("diastolic", bp.getDiastolic(), 80.0f);
+            CHECKD("mean", bp.getMeanArterialPressure(), 93.0f);
+            float compound[3];
+            bp.getCompoundValue(compound);
+            CHECKD("compound[0]", compound[0], 120.0f);
+            CHECKD("compound[2]", compound[2], 93.0f);
+            CHECKT(bp.hasTimestamp());
+            CHECKTM(bp.getTimestamp().toString(), bp.getTimestamp().toString() == "2020-04-04 11:26:00");
+            CHECKT(bp.hasPulseRate());
+            CHECKD("pulse", bp.getPulseRate(), 60.0f);
+            CHECK(bp.getUserID(), 1);
+            CHECK(bp.getMeasurementStatus(), 0x0004);
+
+            CHECKT(!BloodPressureMeasurement(data, sizeof(data)-1).isValid());
+        }
+        {
+            // kPa w/o optional fields: 16.0 / 10.7, mean 12.5 via exponent -1
+            const uint8_t data[] = { 0x01, 0xA0, 0xF0, 0x6B, 0xF0, 0x7D, 0xF0 };
+            const BloodPressureMeasurement bp(data, sizeof(data));
+            PRINTM(bp.toString());
+            CHECKT(bp.isValid());
+            CHECKT(bp.isKPa());
+            CHECKT(!bp.hasPulseRate());
+            CHECKD("systolic", bp.getSystolic(), 160 * powf(10.0f, -1));
+            CHECKD("diastolic", bp.getDiastolic(), 107 * powf(10.0f, -1));
+        }
+        {
+            // flags: pedal balance, wheel, crank, extreme angles, accumulated energy
+            // -5 W, 50 %, wheel[100000, 2048], crank[42, 1024], angles, 12 kJ
+            const uint8_t data[] = { 0x31, 0x09, 0xFB, 0xFF, 0x64,
+                                     0xA0, 0x86, 0x01, 0x00, 0x00, 0x08,
+                                     0x2A, 0x00, 0x00, 0x04,
+                                     0x01, 0x02, 0x03,
+                                     0x0C, 0x00 };
+            const CyclingPowerMeasurement cp(data, sizeof(data));
+            PRINTM(cp.toString());
+            CHECKT(cp.isValid());
+            CHECK(cp.getInstantaneousPower(), -5);
+            CHECKT(cp.isSet(CyclingPowerMeasurement::Bits::HAS_PEDAL_POWER_BALANCE));
+            CHECKT(!cp.isSet(CyclingPowerMeasurement::Bits::HAS_ACCUMULATED_TORQUE));
+            CHECKD("balance", cp.getPedalPowerBalance(), 50.0f);
+            CHECK(cp.getCumulativeWheelRevolutions(), 100000);
+            CHECK(cp.getLastWheelEventTime(), 2048);
+            CHECK(cp.getCumulativeCrankRevolutions(), 42);
+            CHECK(cp.getLastCrankEventTime(), 1024);
+            CHECK(cp.getAccumulatedEnergy(), 12);
+
+            CHECKT(!CyclingPowerMeasurement(data, sizeof(data)-1).isValid());
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,322 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <vector>
+
+#include <cppunit.h>
+
+#include <direct_bt/GATTServer.hpp>
+
+extern "C" {
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <poll.h>
+}
+
+using namespace direct_bt;
+
+/** Client end of one ATT channel, using a local SOCK_SEQPACKET socket pair */
+class TestClient {
+    public:
+        int fd;
+        uint64_t id;
+
+        TestClient(GATTServer & server) : fd(-1), id(0) {
+            int sv[2];
+            if( 0 == ::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) ) {
+                fd = sv[0];
+                id = server.addConnection(sv[1]);
+            }
+        }
+        ~TestClient() {
+            if( 0 <= fd ) {
+                ::close(fd);
+            }
+        }
+
+        bool send(const std::vector<uint8_t> & pdu) {
+            return static_cast<ssize_t>(pdu.size()) == ::send(fd, pdu.data(), pdu.size(), MSG_NOSIGNAL);
+        }
+
+        /** Returns the next received PDU, empty on timeout */
+        std::vector<uint8_t> receive(const int timeoutMS=1000) {
+            struct pollfd p = { fd, POLLIN, 0 };
+            if( 0 >= ::poll(&p, 1, timeoutMS) ) {
+                return std::vector<uint8_t>();
+            }
+            std::vector<uint8_t> buf(1024);
+            const ssize_t n = ::recv(fd, buf.data(), buf.size(), 0);
+            buf.resize( 0 < n ? n : 0 );
+            return buf;
+        }
+
+        std::vector<uint8_t> request(const std::vector<uint8_t> & pdu) {
+            return send(pdu) ? receive() : std::vector<uint8_t>();
+        }
+};
+
+class TestListener : public GATTServerListener {
+    public:
+        std::atomic<int> writes, subscriptions, closed;
+        std::atomic<bool> accept;
+
+        TestListener() : writes(0), subscriptions(0), closed(0), accept(true) {}
+
+        bool writeRequest(GATTServer & server, const uint64_t connectionId,
+                          GATTCharacteristicRef characteristic, const TROOctets & value) override {
+            (void)server; (void)connectionId; (void)characteristic; (void)value;
+            writes++;
+            return accept;
+        }
+        void subscriptionChanged(GATTServer & server, const uint64_t connectionId,
+                                 GATTCharacteristicRef characteristic, const bool notify, const bool indicate) override {
+            (void)server; (void)connectionId; (void)characteristic; (void)notify; (void)indicate;
+            subscriptions++;
+        }
+        void connectionClosed(GATTServer & server, const uint64_t connectionId) override {
+            (void)server; (void)connectionId;
+            closed++;
+        }
+};
+
+static uint16_t get16(const std::vector<uint8_t> & v, const int i) {
+    return static_cast<uint16_t>( v[i] | ( v[i+1] << 8 ) );
+}
+
+static bool waitFor(const std::atomic<int> & v, const int exp) {
+    for(int i=0; i<500 && v < exp; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return v == exp;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        GATTServer server(8 /* queueCapacity */);
+        std::shared_ptr<TestListener> listener = std::make_shared<TestListener>();
+        CHECKT( server.addListener(listener) );
+
+        const uint8_t initA[] = { 'a', 'b', 'c' };
+        const uint8_t initB[] = { 0x01 };
+        std::vector<GATTServer::CharacteristicSpec> chars;
+        chars.push_back( GATTServer::CharacteristicSpec( std::make_shared<uuid16_t>(0x2A37),
+                static_cast<GATTCharacteristic::PropertyBitVal>(GATTCharacteristic::Read | GATTCharacteristic::Notify), TROOctets(initA, 3) ) );
+        chars.push_back( GATTServer::CharacteristicSpec( std::make_shared<uuid16_t>(0x2A38),
+                static_cast<GATTCharacteristic::PropertyBitVal>(GATTCharacteristic::Read | GATTCharacteristic::WriteWithAck | GATTCharacteristic::Indicate),
+                TROOctets(initB, 1) ) );
+        chars.push_back( GATTServer::CharacteristicSpec( uuid_t::create("d0ca6bf3-3d50-4760-98e5-fc5883e93712"),
+                static_cast<GATTCharacteristic::PropertyBitVal>(GATTCharacteristic::Read | GATTCharacteristic::WriteNoAck), TROOctets(initB, 1) ) );
+        GATTServiceRef service = server.addService(std::make_shared<uuid16_t>(0x1234), true /* primary */, chars);
+
+        // service 1, A decl 2 value 3 ccc 4, B decl 5 value 6 ccc 7, C decl 8 value 9
+        CHECK( service->startHandle, 1 );
+        CHECK( service->endHandle, 9 );
+        CHECK( static_cast<int>(service->characteristicList.size()), 3 );
+        CHECK( service->characteristicList[0]->value_handle, 3 );
+        CHECKT( nullptr != service->characteristicList[0]->getClientCharacteristicConfig() );
+        CHECK( service->characteristicList[0]->getClientCharacteristicConfig()->handle, 4 );
+        CHECK( static_cast<int>(service->characteristicList[2]->descriptorList.size()), 0 );
+        CHECKT( service->characteristicList[1] == server.findCharacteristic(uuid16_t(0x2A38)) );
+
+        CHECKT( 0 == server.addConnection(-1) );
+        CHECKT( server.start() );
+        CHECKT( nullptr != server.getAttributeTable() );
+        CHECKT( server.getAttributeTable()->getCharacteristicByValueHandle(6) == service->characteristicList[1] );
+        bool thrown = false;
+        try {
+            server.addService(std::make_shared<uuid16_t>(0x1235), true /* primary */, chars);
+        } catch (IllegalStateException &e) {
+            thrown = true;
+        }
+        CHECKT( thrown );
+
+        TestClient c0(server), c1(server), c2(server);
+        CHECKT( 0 != c0.id && 0 != c1.id && 0 != c2.id );
+        CHECK( server.getConnectionCount(), 3 );
+
+        // MTU exchange
+        std::vector<uint8_t> rsp = c0.request( { 0x02, 100, 0 } );
+        CHECK( static_cast<int>(rsp.size()), 3 );
+        CHECK( rsp[0], 0x03 );
+        CHECK( get16(rsp, 1), 512 );
+
+        // primary service discovery
+        rsp = c1.request( { 0x10, 0x01, 0x00, 0xff, 0xff, 0x00, 0x28 } );
+        CHECK( static_cast<int>(rsp.size()), 8 );
+        CHECK( rsp[0], 0x11 );
+        CHECK( rsp[1], 6 );
+        CHECK( get16(rsp, 2), 1 );
+        CHECK( get16(rsp, 4), 9 );
+        CHECK( get16(rsp, 6), 0x1234 );
+        rsp = c1.request( { 0x10, 0x0a, 0x00, 0xff, 0xff, 0x00, 0x28 } );
+        CHECK( rsp[0], 0x01 );
+        CHECK( rsp[4], AttErrorRsp::ATTRIBUTE_NOT_FOUND );
+        rsp = c1.request( { 0x10, 0x01, 0x00, 0xff, 0xff, 0x03, 0x28 } );
+        CHECK( rsp[4], AttErrorRsp::UNSUPPORTED_GROUP_TYPE );
+
+        // find by type value
+        rsp = c1.request( { 0x06, 0x01, 0x00, 0xff, 0xff, 0x00, 0x28, 0x34, 0x12 } );
+        CHECK( static_cast<int>(rsp.size()), 5 );
+        CHECK( get16(rsp, 1), 1 );
+        CHECK( get16(rsp, 3), 9 );
+
+        // characteristic discovery, the 16 bit declarations only as the third one has a different length
+        rsp = c1.request( { 0x08, 0x01, 0x00, 0x09, 0x00, 0x03, 0x28 } );
+        CHECK( rsp[0], 0x09 );
+        CHECK( rsp[1], 7 );
+        CHECK( static_cast<int>(rsp.size()), 2 + 2*7 );
+        CHECK( get16(rsp, 2), 2 );
+        CHECK( rsp[4], GATTCharacteristic::Read | GATTCharacteristic::Notify );
+        CHECK( get16(rsp, 5), 3 );
+        CHECK( get16(rsp, 7), 0x2A37 );
+        CHECK( get16(rsp, 9), 5 );
+        rsp = c1.request( { 0x08, 0x08, 0x00, 0x09, 0x00, 0x03, 0x28 } );
+        CHECK( rsp[1], 2 + 1 + 2 + 16 );
+        CHECK( get16(rsp, 2), 8 );
+
+        // descriptor discovery
+        rsp = c1.request( { 0x04, 0x01, 0x00, 0xff, 0xff } );
+        CHECK( rsp[0], 0x05 );
+        CHECK( rsp[1], 0x01 );
+        CHECK( static_cast<int>(rsp.size()), 2 + 5*4 ); // ATT_MTU 23
+        CHECK( get16(rsp, 2 + 3*4), 4 );
+        CHECK( get16(rsp, 4 + 3*4), 0x2902 );
+        rsp = c1.request( { 0x04, 0x09, 0x00, 0x09, 0x00 } );
+        CHECK( rsp[1], 0x02 );
+        CHECK( static_cast<int>(rsp.size()), 2 + 2 + 16 );
+        rsp = c1.request( { 0x04, 0x00, 0x00, 0x09, 0x00 } );
+        CHECK( rsp[4], AttErrorRsp::INVALID_HANDLE );
+
+        // reads
+        rsp = c1.request( { 0x0A, 0x03, 0x00 } );
+        CHECKT( rsp == std::vector<uint8_t>( { 0x0B, 'a', 'b', 'c' } ) );
+        rsp = c1.request( { 0x0C, 0x03, 0x00, 0x01, 0x00 } );
+        CHECKT( rsp == std::vector<uint8_t>( { 0x0D, 'b', 'c' } ) );
+        rsp = c1.request( { 0x0C, 0x03, 0x00, 0x04, 0x00 } );
+        CHECK( rsp[4], AttErrorRsp::INVALID_OFFSET );
+        rsp = c1.request( { 0x0A, 0x64, 0x00 } );
+        CHECK( rsp[0], 0x01 );
+        CHECK( get16(rsp, 2), 0x64 );
+        CHECK( rsp[4], AttErrorRsp::INVALID_HANDLE );
+        rsp = c1.request( { 0x0A, 0x04, 0x00 } );
+        CHECKT( rsp == std::vector<uint8_t>( { 0x0B, 0x00, 0x00 } ) );
+
+        // writes
+        rsp = c1.request( { 0x12, 0x03, 0x00, 0x05 } );
+        CHECK( rsp[4], AttErrorRsp::NO_WRITE_PERM );
+        rsp = c1.request( { 0x12, 0x06, 0x00, 0x07 } );
+        CHECKT( rsp == std::vector<uint8_t>( { 0x13 } ) );
+        CHECK( server.getValue(6)->get_uint8(0), 0x07 );
+        listener->accept = false;
+        rsp = c1.request( { 0x12, 0x06, 0x00, 0x08 } );
+        CHECK( rsp[4], AttErrorRsp::NO_WRITE_PERM );
+        CHECK( server.getValue(6)->get_uint8(0), 0x07 );
+        listener->accept = true;
+        CHECKT( c1.send( { 0x52, 0x09, 0x00, 0x42 } ) );
+        rsp = c1.request( { 0x0A, 0x09, 0x00 } );
+        CHECKT( rsp == std::vector<uint8_t>( { 0x0B, 0x42 } ) );
+        CHECK( listener->writes.load(), 3 );
+
+        // unsupported request, ignored command
+        CHECKT( c1.send( { 0x40 | 0x3f } ) );
+        rsp = c1.request( { 0x20, 0x03, 0x00, 0x06, 0x00 } );
+        CHECK( rsp[0], 0x01 );
+        CHECK( rsp[1], 0x20 );
+        CHECK( rsp[4], AttErrorRsp::UNSUPPORTED_REQUEST );
+
+        // subscribe c0 and c1 to notifications, c2 to indications
+        CHECKT( c0.request( { 0x12, 0x04, 0x00, 0x01, 0x00 } ) == std::vector<uint8_t>( { 0x13 } ) );
+        CHECKT( c1.request( { 0x12, 0x04, 0x00, 0x03, 0x00 } ) == std::vector<uint8_t>( { 0x13 } ) ); // indicate bit masked
+        CHECKT( c2.request( { 0x12, 0x07, 0x00, 0x02, 0x00 } ) == std::vector<uint8_t>( { 0x13 } ) );
+        CHECK( listener->subscriptions.load(), 3 );
+        CHECKT( c1.request( { 0x0A, 0x04, 0x00 } ) == std::vector<uint8_t>( { 0x0B, 0x01, 0x00 } ) );
+        CHECK( c1.request( { 0x12, 0x04, 0x00, 0x01 } )[4], AttErrorRsp::INVALID_ATTRIBUTE_VALUE_LEN );
+
+        // notification fan-out, truncated to c1's default ATT_MTU
+        std::vector<uint8_t> value(40);
+        for(size_t i=0; i<value.size(); i++) {
+            value[i] = static_cast<uint8_t>(i);
+        }
+        CHECK( server.notify(3, TROOctets(value.data(), value.size())), 2 );
+        rsp = c0.receive();
+        CHECK( static_cast<int>(rsp.size()), 3 + 40 );
+        CHECK( rsp[0], 0x1B );
+        CHECK( get16(rsp, 1), 3 );
+        CHECK( rsp[3+39], 39 );
+        rsp = c1.receive();
+        CHECK( static_cast<int>(rsp.size()), 23 );
+        CHECK( rsp[3+19], 19 );
+        CHECKT( c2.receive(100).empty() );
+        CHECK( server.notify(6, TROOctets(value.data(), 1)), 0 );
+        CHECK( server.notify(2, TROOctets(value.data(), 1)), -1 );
+        CHECK( server.getValue(3)->getSize(), 40 );
+
+        // indications, one outstanding until confirmed
+        CHECK( server.indicate(6, TROOctets(value.data(), 1)), 1 );
+        CHECK( server.indicate(6, TROOctets(value.data() + 1, 1)), 1 );
+        rsp = c2.receive();
+        CHECKT( rsp == std::vector<uint8_t>( { 0x1D, 0x06, 0x00, 0x00 } ) );
+        CHECKT( c2.receive(100).empty() );
+        CHECKT( c2.send( { 0x1E } ) );
+        rsp = c2.receive();
+        CHECKT( rsp == std::vector<uint8_t>( { 0x1D, 0x06, 0x00, 0x01 } ) );
+        CHECKT( c0.receive(100).empty() );
+
+        // a client not reading: bounded queue, dropping the oldest, not stalling the others
+        const int count = 5000;
+        for(int i=0; i<count; i++) {
+            value[0] = static_cast<uint8_t>(i);
+            value[1] = static_cast<uint8_t>(i >> 8);
+            CHECK( server.notify(3, TROOctets(value.data(), 2)), 2 );
+            if( 0 == i % 100 ) {
+                while( !c0.receive(0).empty() ) { }
+            }
+        }
+        uint64_t dropped1 = 0;
+        for(const GATTServer::ConnectionStats & s : server.getConnectionStats()) {
+            CHECKT( s.queued <= 8 );
+            if( s.id == c1.id ) {
+                dropped1 = s.dropped;
+            }
+        }
+        CHECKT( 0 < dropped1 );
+        int last = -1, received = 0;
+        for(rsp = c1.receive(); !rsp.empty(); rsp = c1.receive(200)) {
+            const int v = get16(rsp, 3);
+            CHECKT( v > last );
+            last = v;
+            received++;
+        }
+        CHECK( last, count - 1 );
+        CHECK( static_cast<uint64_t>(received) + dropped1, static_cast<uint64_t>(count) );
+        fprintf(stderr, "c1 received %d, dropped %" PRIu64 "\n", received, dropped1);
+
+        // connection close
+        ::close(c1.fd);
+        c1.fd = -1;
+        CHECKT( waitFor(listener->closed, 1) );
+        CHECK( server.getConnectionCount(), 2 );
+        CHECKT( server.removeConnection(c2.id) );
+        CHECKT( !server.removeConnection(c2.id) );
+        CHECK( listener->closed.load(), 2 );
+        CHECK( server.getConnectionCount(), 1 );
+
+        server.stop();
+        CHECKT( !server.isRunning() );
+        CHECK( listener->closed.load(), 3 );
+        CHECK( server.getConnectionCount(), 0 );
+        CHECK( server.notify(3, TROOctets(value.data(), 2)), 0 );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
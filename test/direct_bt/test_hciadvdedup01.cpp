@@ -0,0 +1,48 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/HCITypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const EUI48 addr0( "01:02:03:04:05:06" );
+        const EUI48 addr1( "01:02:03:04:05:07" );
+        const uint8_t ad0[] = { 0x02, 0x01, 0x06, 0x03, 0xff, 0x01, 0x02 };
+        const uint8_t ad1[] = { 0x02, 0x01, 0x06, 0x03, 0xff, 0x01, 0x03 };
+        HCIAdvDedupCache cache(16, 1000 /* windowMS */, 5 /* rssiDelta */);
+        CHECKT( cache.isEnabled() );
+
+        CHECKT( HCIAdvDedupCache::Result::NEW == cache.check(addr0, 0, 0, ad0, sizeof(ad0), -60, 100) );
+        CHECKT( HCIAdvDedupCache::Result::DUPLICATE == cache.check(addr0, 0, 0, ad0, sizeof(ad0), -62, 200) );
+        CHECKT( HCIAdvDedupCache::Result::RSSI_UPDATE == cache.check(addr0, 0, 0, ad0, sizeof(ad0), -70, 300) );
+        CHECKT( HCIAdvDedupCache::Result::DUPLICATE == cache.check(addr0, 0, 0, ad0, sizeof(ad0), -70, 400) );
+        CHECK( cache.getDropCount(), 2 );
+        CHECK( cache.getRSSIUpdateCount(), 1 );
+
+        // changed payload, other advertiser and expired window
+        CHECKT( HCIAdvDedupCache::Result::NEW == cache.check(addr0, 0, 0, ad1, sizeof(ad1), -70, 500) );
+        CHECKT( HCIAdvDedupCache::Result::NEW == cache.check(addr1, 0, 0, ad1, sizeof(ad1), -70, 500) );
+        CHECKT( HCIAdvDedupCache::Result::NEW == cache.check(addr1, 0, 0, ad1, sizeof(ad1), -70, 1500) );
+
+        cache.clear();
+        CHECKT( HCIAdvDedupCache::Result::NEW == cache.check(addr1, 0, 0, ad1, sizeof(ad1), -70, 1600) );
+
+        HCIAdvDedupCache disabled(16, 0 /* windowMS */, 5 /* rssiDelta */);
+        CHECKT( !disabled.isEnabled() );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
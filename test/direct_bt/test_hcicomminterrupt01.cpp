@@ -0,0 +1,102 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#include <cppunit.h>
+
+#include <direct_bt/HCIComm.hpp>
+#include <direct_bt/BasicTypes.hpp>
+
+extern "C" {
+    #include <unistd.h>
+    #include <sys/socket.h>
+}
+
+using namespace direct_bt;
+
+static int hciPeer = -1;
+
+static int openSocketPair(const uint16_t dev_id, const uint16_t channel) {
+    (void)dev_id;
+    (void)channel;
+    int sv[2];
+    if( 0 > socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) ) {
+        return -1;
+    }
+    hciPeer = sv[1];
+    return sv[0];
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        HCIComm::setTransport(openSocketPair);
+        {
+            HCIComm comm(0, 0);
+            HCIComm::setTransport(nullptr);
+            CHECKT( comm.isOpen() );
+
+            uint8_t buffers[4*32];
+            int lengths[4];
+
+            // timeout w/o pending packet
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 20 /* timeoutMS */), -1 );
+            CHECK( errno, ETIMEDOUT );
+
+            // interrupt wakes up a blocked read at once, long before its poll timeout
+            std::thread stopper([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                comm.interrupt();
+            });
+            const int64_t t0 = getCurrentMilliseconds();
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 10000 /* timeoutMS */), -1 );
+            CHECK( errno, ECANCELED );
+            const int64_t td = getCurrentMilliseconds() - t0;
+            stopper.join();
+            CHECKT( td < 5000 );
+
+            // the wakeup is consumed, the next read times out again
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 20 /* timeoutMS */), -1 );
+            CHECK( errno, ETIMEDOUT );
+
+            // an interrupt w/o blocked reader is consumed by the next waiting read
+            comm.interrupt();
+            comm.interrupt();
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 10000 /* timeoutMS */), -1 );
+            CHECK( errno, ECANCELED );
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 20 /* timeoutMS */), -1 );
+            CHECK( errno, ETIMEDOUT );
+
+            // packets are still received after an interrupt
+            const uint8_t pkt[4] = { 0x04, 0x0e, 0x01, 0x02 };
+            CHECK( (int)::write(hciPeer, pkt, sizeof(pkt)), (int)sizeof(pkt) );
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 1000 /* timeoutMS */), 1 );
+            CHECK( lengths[0], (int)sizeof(pkt) );
+            CHECK( memcmp(buffers, pkt, sizeof(pkt)), 0 );
+
+            // reads w/o timeout don't poll, leaving the wakeup pending
+            comm.interrupt();
+            CHECK( (int)::write(hciPeer, pkt, sizeof(pkt)), (int)sizeof(pkt) );
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 0 /* timeout */), 1 );
+            CHECK( comm.read_batch(buffers, 32, lengths, 4, 20 /* timeoutMS */), -1 );
+            CHECK( errno, ECANCELED );
+
+            comm.close();
+            CHECKT( !comm.isOpen() );
+            comm.interrupt(); // harmless after close
+        }
+        ::close(hciPeer);
+        hciPeer = -1;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
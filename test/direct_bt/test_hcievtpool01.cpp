@@ -0,0 +1,57 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/HCITypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        // HCI_EVENT, CMD_STATUS, plen 4: status, ncmd, opcode LE_SET_SCAN_ENABLE
+        const uint8_t cmd_status[] = { 0x04, 0x0f, 0x04, 0x00, 0x01, 0x0c, 0x20 };
+        HCIEventPool pool(2);
+
+        HCIEvent * p0;
+        {
+            std::shared_ptr<HCIEvent> e0 = pool.getSpecialized(cmd_status, sizeof(cmd_status));
+            CHECKT( nullptr != e0 );
+            CHECKT( e0->isEvent(HCIEventType::CMD_STATUS) );
+            CHECK( static_cast<HCICommandStatusEvent*>(e0.get())->getNumCommandPackets(), 1 );
+            p0 = e0.get();
+        }
+        CHECK( pool.getAllocCount(), 1 );
+        {
+            // released above, hence recycled
+            std::shared_ptr<HCIEvent> e0 = pool.getSpecialized(cmd_status, sizeof(cmd_status));
+            CHECKT( p0 == e0.get() );
+            CHECK( pool.getAllocCount(), 1 );
+
+            // in use, hence next pooled and then fallback instance
+            std::shared_ptr<HCIEvent> e1 = pool.getSpecialized(cmd_status, sizeof(cmd_status));
+            std::shared_ptr<HCIEvent> e2 = pool.getSpecialized(cmd_status, sizeof(cmd_status));
+            CHECKT( e0.get() != e1.get() );
+            CHECKT( e1.get() != e2.get() );
+            CHECK( pool.getAllocCount(), 2 );
+            CHECK( pool.getFallbackCount(), 1 );
+            CHECKT( static_cast<HCICommandStatusEvent*>(e2.get())->getOpcode() == HCIOpcode::LE_SET_SCAN_ENABLE );
+        }
+        {
+            // non event packet
+            const uint8_t acl[] = { 0x02, 0x00, 0x00 };
+            CHECKT( nullptr == pool.getSpecialized(acl, sizeof(acl)) );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
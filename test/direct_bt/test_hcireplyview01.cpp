@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/HCITypes.hpp>
+
+using namespace direct_bt;
+
+struct test_rp_status {
+    __u8    status;
+} __packed;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            HCIReplyView<hci_rp_read_rssi> v;
+            CHECK( v.isValid(), false );
+            CHECK( v.getStatus() == HCIStatusCode::INTERNAL_FAILURE, true );
+        }
+        {
+            // READ_RSSI command complete: ncmd 1, opcode 0x1405, status 0, handle 0x0040, rssi -42
+            const uint8_t buffer[] = { 0x04, 0x0E, 0x07, 0x01, 0x05, 0x14, 0x00, 0x40, 0x00, 0xD6 };
+            HCICommandCompleteEvent ev(buffer, sizeof(buffer));
+            HCIReplyView<hci_rp_read_rssi> v;
+            CHECK( v.set(ev), true );
+            CHECK( v.isValid(), true );
+            CHECK( v.getStatus() == HCIStatusCode::SUCCESS, true );
+            CHECK( le_to_cpu(v->handle), 0x0040 );
+            CHECK( v->rssi, -42 );
+            CHECK( v.get().rssi, -42 );
+
+            // the copy outlives the event's buffer
+            HCIReplyView<test_rp_status> s;
+            CHECK( s.set(ev), true );
+            CHECK( s.getStatus() == HCIStatusCode::SUCCESS, true );
+
+            v.clear();
+            CHECK( v.isValid(), false );
+            CHECK( v.getStatus() == HCIStatusCode::INTERNAL_FAILURE, true );
+        }
+        {
+            // undersized return parameter, e.g. a status-only error reply
+            const uint8_t buffer[] = { 0x04, 0x0E, 0x04, 0x01, 0x05, 0x14, 0x02 };
+            HCICommandCompleteEvent ev(buffer, sizeof(buffer));
+            HCIReplyView<hci_rp_read_rssi> v;
+            CHECK( v.set(ev), false );
+            CHECK( v.isValid(), false );
+            CHECK( v.getStatus() == HCIStatusCode::INTERNAL_FAILURE, true );
+
+            HCIReplyView<test_rp_status> s;
+            CHECK( s.set(ev), true );
+            CHECK( s.getStatus() == HCIStatusCode::UNKNOWN_CONNECTION_IDENTIFIER, true );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/InternTable.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            InternTable t;
+            InternTable::StringRef a = t.intern(std::string("Mi Band"));
+            InternTable::StringRef b = t.intern(std::string("Mi Band"));
+            InternTable::StringRef c = t.intern(std::string("iPhone"));
+            CHECK( a.get() == b.get(), true );
+            CHECK( a.get() == c.get(), false );
+            CHECK( *a == "Mi Band", true );
+            CHECK( *c == "iPhone", true );
+            CHECK( t.getStringCount(), 2 );
+
+            // the empty string is shared but never stored
+            InternTable::StringRef e = t.intern(std::string());
+            CHECK( e.get() == InternTable::getEmptyString().get(), true );
+            CHECK( t.getStringCount(), 2 );
+
+            // released entries expire and are swept
+            c = nullptr;
+            t.sweep();
+            CHECK( t.getStringCount(), 1 );
+            InternTable::StringRef c2 = t.intern(std::string("iPhone"));
+            CHECK( *c2 == "iPhone", true );
+            CHECK( t.getStringCount(), 2 );
+        }
+        {
+            InternTable t;
+            const uint8_t d0[] = { 0x01, 0x02, 0x03 };
+            const uint8_t d1[] = { 0x01, 0x02, 0x04 };
+            InternTable::MSDRef a = t.intern(std::make_shared<ManufactureSpecificData>(0x004c, d0, sizeof(d0)));
+            InternTable::MSDRef b = t.intern(std::make_shared<ManufactureSpecificData>(0x004c, d0, sizeof(d0)));
+            InternTable::MSDRef c = t.intern(std::make_shared<ManufactureSpecificData>(0x004c, d1, sizeof(d1)));
+            InternTable::MSDRef d = t.intern(std::make_shared<ManufactureSpecificData>(0x0075, d0, sizeof(d0)));
+            CHECK( a.get() == b.get(), true );
+            CHECK( a.get() == c.get(), false );
+            CHECK( a.get() == d.get(), false );
+            CHECK( t.getMSDCount(), 3 );
+
+            // large payloads and nullptr pass through
+            uint8_t large[InternTable::MAX_MSD_SIZE+1];
+            memset(large, 0x55, sizeof(large));
+            InternTable::MSDRef l0 = std::make_shared<ManufactureSpecificData>(0x004c, large, sizeof(large));
+            InternTable::MSDRef l1 = std::make_shared<ManufactureSpecificData>(0x004c, large, sizeof(large));
+            CHECK( t.intern(l0).get() == l0.get(), true );
+            CHECK( t.intern(l1).get() == l1.get(), true );
+            CHECK( t.intern(InternTable::MSDRef()) == nullptr, true );
+            CHECK( t.getMSDCount(), 3 );
+        }
+        {
+            // expired entries are swept automatically while growing
+            InternTable t;
+            for(int i=0; i<1000; i++) {
+                t.intern("device "+std::to_string(i));
+            }
+            CHECK( t.getStringCount() < 1000, true );
+            t.clear();
+            CHECK( t.getStringCount(), 0 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
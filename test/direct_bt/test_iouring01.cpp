@@ -0,0 +1,171 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#include <cppunit.h>
+
+#include <direct_bt/IOUring.hpp>
+#include <direct_bt/HCIComm.hpp>
+
+extern "C" {
+    #include <unistd.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+}
+
+using namespace direct_bt;
+
+static int hciPeer = -1;
+
+static int openSocketPair(const uint16_t dev_id, const uint16_t channel) {
+    (void)dev_id;
+    (void)channel;
+    int sv[2];
+    if( 0 > socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) ) {
+        return -1;
+    }
+    hciPeer = sv[1];
+    return sv[0];
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        if( !IOUringReceiver::isSupported() ) {
+            fprintf(stderr, "io_uring multishot recvmsg not supported, skipped\n");
+            return;
+        }
+        int sv[2];
+        CHECK( socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv), 0 );
+        std::unique_ptr<IOUringReceiver> r = IOUringReceiver::create(sv[0], 64, 0);
+        CHECKT( nullptr != r );
+        CHECK( r->getSocketFD(), sv[0] );
+        CHECKT( 0 <= r->getFD() );
+
+        uint8_t buffers[16*32];
+        int lengths[16];
+
+        // timeout w/o pending packet
+        CHECK( r->receive(buffers, 32, lengths, 16, 20 /* timeoutMS */), -1 );
+        CHECK( errno, ETIMEDOUT );
+
+        // batch of pending packets, ring descriptor readable
+        for(int i=0; i<10; i++) {
+            const uint8_t pkt[4] = { (uint8_t)i, 1, 2, 3 };
+            CHECK( (int)::write(sv[1], pkt, 1+i%4), 1+i%4 );
+        }
+        {
+            struct pollfd p;
+            p.fd = r->getFD(); p.events = POLLIN; p.revents = 0;
+            CHECK( poll(&p, 1, 1000), 1 );
+        }
+        int n = 0;
+        while( n < 10 ) {
+            const int res = r->receive(buffers + n*32, 32, lengths + n, 16 - n, 1000 /* timeoutMS */);
+            CHECKT( 0 <= res );
+            n += res;
+        }
+        CHECK( n, 10 );
+        for(int i=0; i<10; i++) {
+            CHECK( lengths[i], 1+i%4 );
+            CHECK( (int)buffers[i*32], i );
+        }
+
+        // more packets than provided buffers, truncated to the buffer capacity
+        const int total = 3 * IOUringReceiver::BUFFER_COUNT;
+        std::thread writer([&] {
+            uint8_t pkt[48];
+            memset(pkt, 0, sizeof(pkt));
+            for(int i=0; i<total; i++) {
+                pkt[0] = (uint8_t)i;
+                if( sizeof(pkt) != ::write(sv[1], pkt, sizeof(pkt)) ) {
+                    break;
+                }
+            }
+        });
+        n = 0;
+        int order_errors = 0;
+        while( n < total ) {
+            const int res = r->receive(buffers, 32, lengths, 16, 1000 /* timeoutMS */);
+            CHECKT( 0 <= res );
+            for(int i=0; i<res; i++) {
+                if( 32 != lengths[i] || (uint8_t)(n+i) != buffers[i*32] ) {
+                    order_errors++;
+                }
+            }
+            n += res;
+        }
+        writer.join();
+        CHECK( n, total );
+        CHECK( order_errors, 0 );
+
+        // cancel wakes up a blocked receive
+        std::thread canceller([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            r->cancel();
+        });
+        CHECK( r->receive(buffers, 32, lengths, 16, 0 /* w/o timeout */), -1 );
+        CHECK( errno, ECANCELED );
+        canceller.join();
+        r = nullptr;
+        ::close(sv[0]);
+        ::close(sv[1]);
+
+        // end of file
+        CHECK( socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv), 0 );
+        r = IOUringReceiver::create(sv[0], 64, 0);
+        CHECKT( nullptr != r );
+        ::close(sv[1]);
+        CHECK( r->receive(buffers, 32, lengths, 16, 1000 /* timeoutMS */), 1 );
+        CHECK( lengths[0], 0 );
+        CHECK( r->receive(buffers, 32, lengths, 16, 1000 /* timeoutMS */), 1 );
+        CHECK( lengths[0], 0 );
+        r->cancel();
+        r = nullptr;
+        ::close(sv[0]);
+
+        // HCIComm read_batch via io_uring, if enabled
+        setenv("direct_bt.io_uring", "true", 1);
+        CHECKT( IOUringReceiver::isEnabled() );
+        HCIComm::setTransport(openSocketPair);
+        {
+            HCIComm comm(0, HCI_CHANNEL_RAW);
+            CHECKT( comm.isOpen() );
+            CHECKT( comm.isIOUring() );
+            CHECKT( comm.poll_dd() != comm.dd() );
+            const uint8_t evt[5] = { 0x04, 0x0e, 0x02, 0x01, 0x00 };
+            CHECK( (int)::write(hciPeer, evt, sizeof(evt)), (int)sizeof(evt) );
+            CHECK( (int)::write(hciPeer, evt, 3), 3 );
+            uint64_t timestamps[16];
+            n = 0;
+            while( n < 2 ) {
+                const int res = comm.read_batch(buffers + n*32, 32, lengths + n, 16 - n, 1000 /* timeoutMS */, nullptr, timestamps + n);
+                CHECKT( 0 <= res );
+                n += res;
+            }
+            CHECK( lengths[0], 5 );
+            CHECK( lengths[1], 3 );
+            CHECKT( 0 < timestamps[0] );
+            CHECKT( 0 == memcmp(buffers, evt, sizeof(evt)) );
+
+            uint64_t ts = 0;
+            CHECK( comm.read(buffers, 32, 20 /* timeoutMS */, ts), -1 );
+            CHECK( errno, ETIMEDOUT );
+            comm.close();
+            CHECKT( !comm.isOpen() );
+        }
+        ::close(hciPeer);
+        HCIComm::setTransport(nullptr);
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#include <cppunit.h>
+
+#include <direct_bt/L2CAPComm.hpp>
+
+extern "C" {
+    #include <unistd.h>
+    #include <sys/socket.h>
+}
+
+using namespace direct_bt;
+
+class Receiver {
+    public:
+        std::atomic<int> count;
+        std::atomic<int> sum;
+        std::atomic<int> errors;
+
+        Receiver() : count(0), sum(0), errors(0) {}
+
+        bool received(const uint8_t * data, int len) {
+            if( 0 > len ) {
+                errors++;
+                return false;
+            }
+            count++;
+            sum += data[0] + len;
+            return true;
+        }
+};
+
+static bool waitFor(const std::atomic<int> & v, const int exp) {
+    for(int i=0; i<200 && v != exp; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return v == exp;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const DBTThreadOptions opts("direct_bt.test.reactor", "dbt_test_rct");
+        std::shared_ptr<L2CAPReactor> reactor = L2CAPReactor::create(2, opts);
+        CHECKT( reactor->isRunning() );
+        CHECK( reactor->getThreadCount(), 2 );
+
+        int sv0[2], sv1[2];
+        CHECK( socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv0), 0 );
+        CHECK( socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv1), 0 );
+        Receiver r0, r1;
+        const uint64_t id0 = reactor->add(sv0[0], 64, bindMemberFunc(&r0, &Receiver::received));
+        const uint64_t id1 = reactor->add(sv1[0], 64, bindMemberFunc(&r1, &Receiver::received));
+        CHECKT( 0 != id0 );
+        CHECKT( 0 != id1 && id0 != id1 );
+        CHECK( reactor->size(), 2 );
+        CHECK( reactor->add(-1, 64, bindMemberFunc(&r0, &Receiver::received)), (uint64_t)0 );
+
+        // packets of both channels, more than one read batch on the first
+        uint8_t pkt[3] = { 1, 2, 3 };
+        for(int i=0; i<100; i++) {
+            CHECK( (int)::write(sv0[1], pkt, 3), 3 );
+        }
+        CHECK( (int)::write(sv1[1], pkt, 2), 2 );
+        CHECKT( waitFor(r0.count, 100) );
+        CHECKT( waitFor(r1.count, 1) );
+        CHECK( r0.sum.load(), 100*(1+3) );
+        CHECK( r1.sum.load(), 1+2 );
+
+        // removed channel receives no more packets
+        CHECKT( reactor->remove(id1, true /* wait */) );
+        CHECKT( !reactor->remove(id1, true /* wait */) );
+        CHECK( (int)::write(sv1[1], pkt, 2), 2 );
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK( r1.count.load(), 1 );
+        close(sv1[0]);
+        close(sv1[1]);
+
+        // hangup of the peer signals an error and removes the channel
+        close(sv0[1]);
+        CHECKT( waitFor(r0.errors, 1) );
+        CHECK( reactor->size(), 0 );
+        close(sv0[0]);
+
+        reactor->stop();
+        CHECKT( !reactor->isRunning() );
+        CHECK( reactor->add(sv0[0], 64, bindMemberFunc(&r0, &Receiver::received)), (uint64_t)0 );
+
+        // w/o worker threads, driven by an external event loop on this thread
+        std::shared_ptr<L2CAPReactor> external = L2CAPReactor::create(0, opts);
+        CHECKT( external->isRunning() );
+        CHECK( external->getThreadCount(), 0 );
+        CHECKT( 0 <= external->getFD() );
+        CHECK( socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv0), 0 );
+        Receiver r2;
+        CHECKT( 0 != external->add(sv0[0], 64, bindMemberFunc(&r2, &Receiver::received)) );
+        CHECK( external->process(0), 0 );
+        for(int i=0; i<3; i++) {
+            CHECK( (int)::write(sv0[1], pkt, 3), 3 );
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK( r2.count.load(), 0 );
+        CHECK( external->process(100), 1 );
+        CHECK( r2.count.load(), 3 );
+        CHECK( external->process(0), 0 );
+        close(sv0[1]);
+        CHECK( external->process(100), 1 );
+        CHECK( r2.errors.load(), 1 );
+        CHECK( external->size(), 0 );
+        close(sv0[0]);
+        external->stop();
+        CHECK( external->process(0), -1 );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
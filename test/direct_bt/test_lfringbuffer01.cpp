@@ -32,6 +32,18 @@ class Integer {
 
 std::shared_ptr<Integer> NullInteger = nullptr;
 
+/** Plain value type w/ an empty state, constructible and assignable from nullptr. */
+class Slot {
+    public:
+        int value;
+
+        Slot() : value(-1) {}
+        Slot(std::nullptr_t) : value(-1) {}
+        Slot(int v) : value(v) {}
+
+        bool isEmpty() const { return 0 > value; }
+};
+
 typedef std::shared_ptr<Integer> SharedType;
 typedef Ringbuffer<SharedType> SharedTypeRingbuffer;
 typedef LFRingbuffer<SharedType, nullptr> SharedTypeLFRingbuffer;
@@ -227,6 +239,71 @@ class Cppunit_tests : public Cppunit {
         CHECKTM("Not empty "+rb->toString(), rb->isEmpty());
     }
 
+    void test07_BatchPutGet() {
+        int capacity = 11;
+        std::shared_ptr<Ringbuffer<SharedType>> rb = createEmpty(capacity);
+        std::vector<SharedType> source = createIntArray(capacity, 0);
+        SharedType dest[2*11];
+
+        CHECKM("Batch put count "+rb->toString(), 7, rb->putAll(source.data(), 7));
+        CHECKM("Batch put on almost full "+rb->toString(), 4, rb->putAll(source.data()+7, 7));
+        CHECKTM("Not full "+rb->toString(), rb->isFull());
+        CHECKM("Batch put on full "+rb->toString(), 0, rb->putAll(source.data(), 1));
+
+        CHECKM("Batch get count "+rb->toString(), 5, rb->getAll(dest, 5));
+        for(int i=0; i<5; i++) {
+            CHECKM("Wrong value "+rb->toString(), i, dest[i]->intValue());
+        }
+        // wrap around
+        CHECKM("Batch put wrap "+rb->toString(), 5, rb->putAll(source.data(), 5));
+        CHECKM("Batch get wrap "+rb->toString(), capacity, rb->getAll(dest, 2*capacity));
+        for(int i=0; i<capacity; i++) {
+            CHECKM("Wrong value "+rb->toString(), (5+i) % capacity, dest[i]->intValue());
+        }
+        CHECKTM("Not empty "+rb->toString(), rb->isEmpty());
+        CHECKM("Not empty size "+rb->toString(), 0, rb->getSize());
+
+        CHECKM("Batch get on empty "+rb->toString(), 0, rb->getAll(dest, 5));
+        CHECKM("Batch get timeout "+rb->toString(), 0, rb->getAll(dest, 5, 10));
+    }
+
+    void test08_MoveOnly() {
+        typedef std::unique_ptr<Integer> UniqueType;
+        LFRingbuffer<UniqueType, nullptr> rb(3);
+        UniqueType u0( new Integer(0) );
+        Integer * p0 = u0.get();
+        CHECKTM("Put failed "+rb.toString(), rb.put( std::move(u0) ));
+        CHECKTM("Not moved", nullptr == u0);
+        CHECKTM("Put failed "+rb.toString(), rb.putBlocking( UniqueType( new Integer(1) ) ));
+        CHECKTM("Put failed "+rb.toString(), rb.put( UniqueType( new Integer(2) ) ));
+
+        UniqueType u3( new Integer(3) );
+        CHECKTM("Put on full "+rb.toString(), !rb.put( std::move(u3) ));
+        CHECKTM("Moved on failure", nullptr != u3);
+
+        bool thrown = false;
+        try {
+            rb.peek();
+        } catch (UnsupportedOperationException &e) {
+            thrown = true;
+        }
+        CHECKTM("Copy of move-only element not rejected", thrown);
+
+        UniqueType r0 = rb.get();
+        CHECKTM("Not same instance", p0 == r0.get());
+        UniqueType dest[3];
+        CHECKM("Batch get count "+rb.toString(), 2, rb.getAll(dest, 3));
+        CHECKM("Wrong value", 1, dest[0]->intValue());
+        CHECKM("Wrong value", 2, dest[1]->intValue());
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+
+        LFRingbuffer<Slot, nullptr> rbv(2);
+        CHECKTM("Put failed "+rbv.toString(), rbv.put( Slot(7) ));
+        CHECKM("Wrong value", 7, rbv.peek().value);
+        CHECKM("Wrong value", 7, rbv.get().value);
+        CHECKTM("Not empty slot", rbv.get().isEmpty());
+    }
+
     void test_GrowFullImpl(int initialCapacity, int pos) {
         int growAmount = 5;
         int grownCapacity = initialCapacity+growAmount;
@@ -314,6 +391,8 @@ class Cppunit_tests : public Cppunit {
         test04_EmptyWriteClear();
         test05_ReadResetMid01();
         test06_ReadResetMid02();
+        test07_BatchPutGet();
+        test08_MoveOnly();
 
         test20_GrowFull01_Begin();
         test21_GrowFull02_Begin1();
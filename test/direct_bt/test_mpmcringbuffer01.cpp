@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#include <cppunit.h>
+
+#include <direct_bt/BasicTypes.hpp>
+#include <direct_bt/Ringbuffer.hpp>
+#include <direct_bt/LFRingbuffer.hpp>
+#include <direct_bt/MPMCRingbuffer.hpp>
+
+using namespace direct_bt;
+
+typedef std::shared_ptr<int> SharedType;
+typedef Ringbuffer<SharedType> SharedTypeRingbuffer;
+typedef LFRingbuffer<SharedType, nullptr> SharedTypeLFRingbuffer;
+typedef MPMCRingbuffer<SharedType, nullptr> SharedTypeMPMCRingbuffer;
+
+// Test examples.
+class Cppunit_tests : public Cppunit {
+  private:
+
+    static void getThreadType01(SharedTypeRingbuffer * rb, int len, std::atomic<uint64_t> * sum) {
+        uint64_t s = 0;
+        for(int i=0; i<len; i++) {
+            SharedType v = rb->getBlocking();
+            if( nullptr != v ) {
+                s += *v;
+            }
+        }
+        sum->fetch_add(s);
+    }
+
+    static void putThreadType01(SharedTypeRingbuffer * rb, int len, int startValue) {
+        for(int i=0; i<len; i++) {
+            rb->putBlocking( SharedType( new int(startValue+i) ) );
+        }
+    }
+
+    static void getThreadBatch01(SharedTypeMPMCRingbuffer * rb, int len, std::atomic<uint64_t> * sum) {
+        uint64_t s = 0;
+        SharedType batch[16];
+        for(int i=0; i<len; ) {
+            const int n = rb->getAll(batch, std::min(16, len-i), 0);
+            for(int j=0; j<n; j++) {
+                s += *batch[j];
+                batch[j] = nullptr;
+            }
+            i += n;
+        }
+        sum->fetch_add(s);
+    }
+
+    static void putThreadBatch01(SharedTypeMPMCRingbuffer * rb, int len, int startValue) {
+        SharedType batch[16];
+        for(int i=0; i<len; ) {
+            const int n = std::min(16, len-i);
+            for(int j=0; j<n; j++) {
+                batch[j] = SharedType( new int(startValue+i+j) );
+            }
+            rb->putBlocking(batch, n);
+            i += n;
+        }
+    }
+
+    /** Runs producer and consumer threads, checking all elements arrived; returns elapsed milliseconds. */
+    uint64_t runContention(SharedTypeRingbuffer * rb, SharedTypeMPMCRingbuffer * batchRB, const int threads, const int perThread) {
+        std::atomic<uint64_t> sum(0);
+        std::vector<std::thread> workers;
+        const uint64_t t0 = getCurrentMilliseconds();
+        for(int i=0; i<threads; i++) {
+            if( nullptr != batchRB ) {
+                workers.push_back( std::thread(getThreadBatch01, batchRB, perThread, &sum) );
+                workers.push_back( std::thread(putThreadBatch01, batchRB, perThread, i*perThread) );
+            } else {
+                workers.push_back( std::thread(getThreadType01, rb, perThread, &sum) );
+                workers.push_back( std::thread(putThreadType01, rb, perThread, i*perThread) );
+            }
+        }
+        for(std::thread & t : workers) {
+            t.join();
+        }
+        const uint64_t td = getCurrentMilliseconds() - t0;
+        const uint64_t n = static_cast<uint64_t>(threads) * perThread;
+        CHECKM("Wrong element sum", n*(n-1)/2, sum.load());
+        return td;
+    }
+
+  public:
+
+    void test01_EmptyFull() {
+        fprintf(stderr, "\n\ntest01_EmptyFull\n");
+        SharedTypeMPMCRingbuffer rb(4);
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+        CHECKTM("Not null "+rb.toString(), nullptr == rb.get());
+        for(int i=0; i<4; i++) {
+            CHECKTM("Put failed "+rb.toString(), rb.put( SharedType( new int(i) ) ));
+        }
+        CHECKTM("Not full "+rb.toString(), rb.isFull());
+        CHECKTM("Put on full "+rb.toString(), !rb.putBlocking( SharedType( new int(4) ), 10 ));
+        CHECKM("Wrong peek "+rb.toString(), 0, *rb.peek());
+        CHECKM("Wrong drop "+rb.toString(), 1, rb.drop(1));
+
+        SharedType batch[4];
+        CHECKM("Wrong batch get "+rb.toString(), 3, rb.getAll(batch, 4));
+        for(int i=0; i<3; i++) {
+            CHECKM("Wrong batch value", i+1, *batch[i]);
+        }
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+        CHECKM("Wrong batch put "+rb.toString(), 3, rb.putAll(batch, 3));
+        CHECKM("Wrong batch put on almost full "+rb.toString(), 1, rb.putAll(batch, 3));
+        rb.recapacity(8);
+        CHECKM("Wrong size "+rb.toString(), 4, rb.getSize());
+        CHECKM("Wrong value "+rb.toString(), 1, *rb.get());
+        rb.clear();
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+        CHECKM("Wrong timeout batch get "+rb.toString(), 0, rb.getAll(batch, 4, 10));
+
+        MPMCRingbuffer<std::unique_ptr<int>, nullptr> ru(2);
+        CHECKTM("Put failed "+ru.toString(), ru.put( std::unique_ptr<int>( new int(1) ) ));
+        CHECKM("Wrong moved value "+ru.toString(), 1, *ru.get());
+    }
+
+    void test02_Contention() {
+        fprintf(stderr, "\n\ntest02_Contention\n");
+        const int threads = 4;
+        const int perThread = 50000;
+        const int capacity = 256;
+        SharedTypeLFRingbuffer lf(capacity);
+        SharedTypeMPMCRingbuffer mpmc(capacity);
+        SharedTypeMPMCRingbuffer mpmcBatch(capacity);
+
+        const uint64_t tLF = runContention(&lf, nullptr, threads, perThread);
+        const uint64_t tMPMC = runContention(&mpmc, nullptr, threads, perThread);
+        const uint64_t tBatch = runContention(nullptr, &mpmcBatch, threads, perThread);
+        fprintf(stderr, "Contention %dP/%dC, %d elements each, capacity %d: LFRingbuffer %" PRIu64 " ms, MPMCRingbuffer %" PRIu64 " ms, batch(16) %" PRIu64 " ms\n",
+                threads, threads, perThread, capacity, tLF, tMPMC, tBatch);
+        CHECKTM("Not empty "+lf.toString(), lf.isEmpty());
+        CHECKTM("Not empty "+mpmc.toString(), mpmc.isEmpty());
+        CHECKTM("Not empty "+mpmcBatch.toString(), mpmcBatch.isEmpty());
+    }
+
+    void test_list() override {
+        test01_EmptyFull();
+        test02_Contention();
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+
+#include <cppunit.h>
+
+#include <direct_bt/BasicTypes.hpp>
+#include <direct_bt/DBTEnv.hpp>
+#include <direct_bt/OverflowRingbuffer.hpp>
+
+using namespace direct_bt;
+
+typedef std::shared_ptr<int> SharedType;
+typedef OverflowRingbuffer<SharedType, nullptr> SharedTypeRingbuffer;
+
+// Test examples.
+class Cppunit_tests : public Cppunit {
+  private:
+
+    static DBTRingOptions createOptions(const std::string & prefix, const std::string & policy) {
+        setenv((prefix+".policy").c_str(), policy.c_str(), 1);
+        return DBTRingOptions(prefix, DBTRingOptions::OverflowPolicy::DROP_NEWEST, 20 /* timeout */, 8 /* max */);
+    }
+
+    static void fill(SharedTypeRingbuffer & rb, const int count) {
+        for(int i=0; i<count; i++) {
+            rb.offer( SharedType( new int(i) ) );
+        }
+    }
+
+  public:
+
+    void test01_DropNewest() {
+        fprintf(stderr, "\n\ntest01_DropNewest\n");
+        SharedTypeRingbuffer rb(4, createOptions("direct_bt.test.ring.newest", "drop_newest"), true /* spsc */);
+        CHECKTM("Wrong policy", DBTRingOptions::OverflowPolicy::DROP_NEWEST == rb.getOptions().POLICY);
+        fill(rb, 4);
+        SharedType e( new int(4) );
+        CHECKTM("Offer on full "+rb.toString(), !rb.offer( std::move(e) ));
+        CHECKTM("Moved on drop", nullptr != e);
+        CHECKM("Wrong drops "+rb.toString(), (uint64_t)1, rb.getStats().drops.load());
+        CHECKM("Wrong high water "+rb.toString(), 4, rb.getStats().highWater.load());
+        CHECKM("Wrong oldest "+rb.toString(), 0, *rb.get());
+    }
+
+    void test02_DropOldest() {
+        fprintf(stderr, "\n\ntest02_DropOldest\n");
+        SharedTypeRingbuffer rb(4, createOptions("direct_bt.test.ring.oldest", "drop_oldest"), true /* spsc */);
+        fill(rb, 5);
+        CHECKM("Wrong drops "+rb.toString(), (uint64_t)1, rb.getStats().drops.load());
+        CHECKM("Wrong size "+rb.toString(), 4, rb.getSize());
+        CHECKM("Wrong oldest "+rb.toString(), 1, *rb.get());
+    }
+
+    void test03_Block() {
+        fprintf(stderr, "\n\ntest03_Block\n");
+        SharedTypeRingbuffer rb(4, createOptions("direct_bt.test.ring.block", "block"), true /* spsc */);
+        fill(rb, 4);
+        const uint64_t t0 = getCurrentMilliseconds();
+        CHECKTM("Offer on full "+rb.toString(), !rb.offer( SharedType( new int(4) ) ));
+        CHECKTM("Not blocked for timeout", getCurrentMilliseconds() - t0 >= 20);
+        CHECKM("Wrong blocked "+rb.toString(), (uint64_t)1, rb.getStats().blocked.load());
+        CHECKTM("Wrong blocked time "+rb.toString(), rb.getStats().blockedMicros.load() >= 20000);
+        CHECKM("Wrong drops "+rb.toString(), (uint64_t)1, rb.getStats().drops.load());
+    }
+
+    void test04_Grow() {
+        fprintf(stderr, "\n\ntest04_Grow\n");
+        SharedTypeRingbuffer rb(4, createOptions("direct_bt.test.ring.grow", "grow"), true /* spsc */);
+        fill(rb, 9);
+        CHECKM("Wrong capacity "+rb.toString(), 8, rb.capacity());
+        CHECKM("Wrong grows "+rb.toString(), 1, rb.getStats().grows.load());
+        CHECKM("Wrong drops "+rb.toString(), (uint64_t)1, rb.getStats().drops.load());
+        CHECKM("Wrong high water "+rb.toString(), 8, rb.getStats().highWater.load());
+        for(int i=0; i<8; i++) {
+            CHECKM("Wrong order "+rb.toString(), i, *rb.get());
+        }
+    }
+
+    void test_list() override {
+        test01_DropNewest();
+        test02_DropOldest();
+        test03_Block();
+        test04_Grow();
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
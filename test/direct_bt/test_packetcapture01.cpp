@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <cstdio>
+
+#include <cppunit.h>
+
+#include <direct_bt/PacketCapture.hpp>
+#include <direct_bt/BasicTypes.hpp>
+
+extern "C" {
+    #include <unistd.h>
+}
+
+using namespace direct_bt;
+
+static std::vector<uint8_t> readFile(const std::string & fname) {
+    std::vector<uint8_t> res;
+    FILE * f = fopen(fname.c_str(), "rb");
+    if( nullptr == f ) {
+        return res;
+    }
+    uint8_t b[4096];
+    size_t n;
+    while( 0 < ( n = fread(b, 1, sizeof(b), f) ) ) {
+        res.insert(res.end(), b, b+n);
+    }
+    fclose(f);
+    return res;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            PacketCapture pc("", 64*1024, 1, 16);
+            CHECKT( !pc.isEnabled() );
+            const uint8_t cmd[] = { 0x01, 0x03, 0x0c, 0x00 };
+            pc.captureHCI(0, cmd, sizeof(cmd), false);
+            CHECK( pc.getWriteCount(), 0 );
+        }
+        const std::string path = "/tmp/test_packetcapture01."+std::to_string(getpid());
+        {
+            PacketCapture pc(path, 64*1024, 2, 16);
+            CHECKT( pc.isEnabled() );
+            const uint8_t cmd[] = { 0x01, 0x03, 0x0c, 0x00 }; // HCI Reset
+            pc.captureHCI(0, cmd, sizeof(cmd), false);
+            const uint8_t mgmt[] = { 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 }; // Mgmt READ_INFO on hci0
+            pc.captureMgmt(mgmt, sizeof(mgmt), false);
+            const uint8_t att[] = { 0x0a, 0x03, 0x00 }; // ATT Read Request
+            pc.captureL2CAP(0, 0x0040, 0x0004, att, sizeof(att), false);
+            pc.stop();
+            CHECKT( !pc.isEnabled() );
+            CHECK( pc.getWriteCount(), 3 );
+            CHECK( pc.getDropCount(), 0 );
+        }
+        {
+            const std::string fname = path+".0.btsnoop";
+            std::vector<uint8_t> d = readFile(fname);
+            unlink(fname.c_str());
+            CHECK( d.size(), 16 + (24+3) + (24+6) + (24+11) );
+            CHECKT( 0 == memcmp(d.data(), "btsnoop\0", 8) );
+            CHECK( get_uint32(d.data(), 8, false), 1 );
+            CHECK( get_uint32(d.data(), 12, false), 2001 );
+            size_t o = 16;
+            // HCI command w/o H4 type
+            CHECK( get_uint32(d.data(), o, false), 3 );
+            CHECK( get_uint32(d.data(), o+8, false), 2 );
+            CHECK( d[o+24], 0x03 );
+            o += 24 + 3;
+            // Mgmt command: cookie, opcode and parameter
+            CHECK( get_uint32(d.data(), o, false), 6 );
+            CHECK( get_uint32(d.data(), o+8, false), 16 );
+            CHECK( get_uint16(d.data(), o+24+4, true), 0x0004 );
+            o += 24 + 6;
+            // ACL TX with synthesized ACL and L2CAP headers
+            CHECK( get_uint32(d.data(), o, false), 11 );
+            CHECK( get_uint32(d.data(), o+8, false), 4 );
+            CHECK( get_uint16(d.data(), o+24, true), 0x2040 );
+            CHECK( get_uint16(d.data(), o+24+2, true), 7 );
+            CHECK( get_uint16(d.data(), o+24+6, true), 0x0004 );
+            CHECK( d[o+24+8], 0x0a );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
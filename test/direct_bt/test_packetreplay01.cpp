@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <cstdio>
+
+#include <cppunit.h>
+
+#include <direct_bt/PacketCapture.hpp>
+#include <direct_bt/PacketReplay.hpp>
+#include <direct_bt/HCIComm.hpp>
+#include <direct_bt/BasicTypes.hpp>
+
+extern "C" {
+    #include <unistd.h>
+}
+
+using namespace direct_bt;
+
+static const int HCI_MAX_MTU = 260;
+
+static int readEvents(HCIComm & comm, uint8_t * buffers, int * lengths, const int count) {
+    int n = 0;
+    while( n < count ) {
+        const int res = comm.read_batch(buffers + n*HCI_MAX_MTU, HCI_MAX_MTU, lengths + n, count - n, 1000);
+        if( 0 > res ) {
+            break;
+        }
+        n += res;
+    }
+    return n;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const std::string path = "/tmp/test_packetreplay01."+std::to_string(getpid());
+        const std::string fname = path+".0.btsnoop";
+        {
+            PacketCapture pc(path, 64*1024, 1, 16);
+            CHECKT( pc.isEnabled() );
+            const uint8_t cmd[] = { 0x01, 0x03, 0x0c, 0x00 }; // HCI Reset, outgoing
+            pc.captureHCI(0, cmd, sizeof(cmd), false);
+            const uint8_t cmdComplete[] = { 0x04, 0x0e, 0x04, 0x01, 0x03, 0x0c, 0x00 }; // CMD_COMPLETE of HCI Reset
+            pc.captureHCI(0, cmdComplete, sizeof(cmdComplete), true);
+            const uint8_t advReport[] = { 0x04, 0x3e, 0x0c, 0x02, 0x01, 0x00, 0x00,
+                                          0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x00, 0xc0 }; // LE ADV_REPORT, w/o AD data
+            pc.captureHCI(0, advReport, sizeof(advReport), true);
+            pc.captureHCI(1, advReport, sizeof(advReport), true); // other adapter
+            const uint8_t ntf[] = { 0x1b, 0x03, 0x00, 0x42 }; // ATT Handle Value Notification
+            pc.captureL2CAP(0, 0x0040, 0x0004, ntf, sizeof(ntf), true);
+            const uint8_t disconnComplete[] = { 0x04, 0x05, 0x04, 0x00, 0x40, 0x00, 0x13 }; // DISCONN_COMPLETE
+            pc.captureHCI(0, disconnComplete, sizeof(disconnComplete), true);
+            pc.stop();
+            CHECK( pc.getWriteCount(), 6 );
+        }
+        {
+            PacketReplay invalid(path+".none", 0.0);
+            CHECKT( !invalid.isValid() );
+            CHECKT( !invalid.start() );
+        }
+        {
+            PacketReplay replay(fname, 0.0 /* as fast as possible */, 0, 0 /* traceIndex */);
+            CHECKT( replay.isValid() );
+            CHECKT( replay.start() );
+            {
+                PacketReplay second(fname, 0.0);
+                CHECKT( !second.start() );
+            }
+            {
+                HCIComm other(1, HCI_CHANNEL_RAW);
+                CHECKT( !other.isOpen() );
+            }
+            HCIComm comm(0, HCI_CHANNEL_RAW);
+            CHECKT( comm.isOpen() );
+            CHECKT( !comm.isKernelSocket() );
+            CHECKT( !comm.enableRxTimestamps() );
+            CHECKT( replay.waitUntilDone(2000) );
+
+            uint8_t buffers[4*HCI_MAX_MTU];
+            int lengths[4];
+            CHECK( readEvents(comm, buffers, lengths, 2), 2 );
+            CHECK( lengths[0], 15 );
+            CHECK( buffers[0], 0x04 );
+            CHECK( buffers[1], 0x3e );
+            CHECK( lengths[1], 7 );
+            CHECK( buffers[HCI_MAX_MTU+1], 0x05 );
+
+            CHECK( replay.getHCICount(), 2 );
+            CHECK( replay.getATTCount(), 0 );
+            CHECK( replay.getSkipCount(), 2 ); // CMD_COMPLETE answered locally, NTF w/o ATT channel
+
+            const uint8_t readVersion[] = { 0x01, 0x01, 0x10, 0x00 }; // READ_LOCAL_VERSION
+            CHECK( comm.write(readVersion, sizeof(readVersion)), (int)sizeof(readVersion) );
+            CHECK( readEvents(comm, buffers, lengths, 1), 1 );
+            CHECK( buffers[0], 0x04 );
+            CHECK( buffers[1], 0x0e );
+            CHECK( get_uint16(buffers, 4, true), 0x1001 );
+            CHECK( buffers[6], 0x00 );
+
+            const uint8_t leCreateConn[] = { 0x01, 0x0d, 0x20, 0x00 }; // LE_CREATE_CONN, parameter irrelevant
+            CHECK( comm.write(leCreateConn, sizeof(leCreateConn)), (int)sizeof(leCreateConn) );
+            CHECK( readEvents(comm, buffers, lengths, 1), 1 );
+            CHECK( lengths[0], 7 );
+            CHECK( buffers[1], 0x0f );
+            CHECK( get_uint16(buffers, 5, true), 0x200d );
+
+            replay.stop();
+            comm.close();
+            HCIComm closed(0, HCI_CHANNEL_RAW);
+            CHECKT( closed.isKernelSocket() );
+        }
+        unlink(fname.c_str());
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+
+#include <cppunit.h>
+
+#include <direct_bt/PeriodicAdvSync.hpp>
+
+using namespace direct_bt;
+
+class TestListener : public PeriodicAdvSyncListener {
+    public:
+        int batches = 0;
+        int reports = 0;
+        int lost = 0;
+        uint16_t lastHandle = 0;
+        EInfoReportBatch last;
+
+        void periodicAdvReports(const PeriodicAdvSyncInfo & sync, const EInfoReportBatch & r) override {
+            batches++;
+            reports += static_cast<int>(r.size());
+            lastHandle = sync.handle;
+            last = r;
+        }
+        void periodicAdvSyncLost(const PeriodicAdvSyncInfo & sync) override {
+            lost++;
+            lastHandle = sync.handle;
+        }
+};
+
+static std::vector<uint8_t> established(const uint8_t status, const uint16_t handle, const uint8_t sid, const uint8_t addr0) {
+    // status, handle, sid, addr type, addr, phy, interval, clock accuracy
+    return std::vector<uint8_t>{ status, static_cast<uint8_t>(handle), static_cast<uint8_t>(handle >> 8), sid, 0x01,
+                                 addr0, 0x02, 0x03, 0x04, 0x05, 0xC6, 0x02, 0x50, 0x00, 0x00 };
+}
+
+static std::vector<uint8_t> report(const uint16_t handle, const uint8_t data_status, const std::vector<uint8_t> & data) {
+    // sync handle, tx power, rssi, cte type, data status, length, data
+    std::vector<uint8_t> r{ static_cast<uint8_t>(handle), static_cast<uint8_t>(handle >> 8), 0x7F, 0xC4, 0xFF, data_status,
+                            static_cast<uint8_t>(data.size()) };
+    r.insert(r.end(), data.begin(), data.end());
+    return r;
+}
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    HCIStatusCode create(PeriodicAdvSyncTable & t, std::shared_ptr<TestListener> l, const uint16_t handle, const uint8_t sid, uint16_t & res) {
+        EUI48 addr;
+        CHECKT( t.beginCreate(sid, 0x01, addr, l) );
+        CHECKT( !t.beginCreate(sid, 0x01, addr, l) );
+        const std::vector<uint8_t> ev = established(0x00, handle, sid, static_cast<uint8_t>(handle));
+        std::thread reader([&]() { t.processSyncEstablished(ev.data(), static_cast<int>(ev.size())); });
+        const HCIStatusCode s = t.awaitCreate(2000, res);
+        reader.join();
+        t.endCreate();
+        return s;
+    }
+
+    void single_test() override {
+        PeriodicAdvSyncTable t(64);
+        std::shared_ptr<TestListener> l1 = std::make_shared<TestListener>();
+        std::shared_ptr<TestListener> l2 = std::make_shared<TestListener>();
+        uint16_t h;
+        {
+            // failed and timed out create requests
+            EUI48 addr;
+            CHECKT( t.beginCreate(1, 0x01, addr, l1) );
+            CHECKT( HCIStatusCode::INTERNAL_TIMEOUT == t.awaitCreate(10, h) );
+            const std::vector<uint8_t> ev = established(number(HCIStatusCode::OPERATION_CANCELLED_BY_HOST), 0x0000, 1, 0x01);
+            t.processSyncEstablished(ev.data(), static_cast<int>(ev.size()));
+            CHECKT( HCIStatusCode::OPERATION_CANCELLED_BY_HOST == t.awaitCreate(10, h) );
+            t.endCreate();
+            CHECK( t.size(), 0 );
+        }
+        CHECKT( HCIStatusCode::SUCCESS == create(t, l1, 0x0010, 1, h) );
+        CHECK( h, 0x0010 );
+        CHECKT( HCIStatusCode::SUCCESS == create(t, l2, 0x0020, 2, h) );
+        CHECK( h, 0x0020 );
+        CHECK( t.size(), 2 );
+        {
+            const std::vector<PeriodicAdvSyncInfo> syncs = t.getSyncs();
+            CHECK( syncs.size(), 2 );
+            const PeriodicAdvSyncInfo & i = 0x0010 == syncs[0].handle ? syncs[0] : syncs[1];
+            CHECK( i.sid, 1 );
+            CHECK( i.phy, 0x02 );
+            CHECK( i.interval, 0x0050 );
+            CHECK( i.address.b[0], 0x10 );
+        }
+        {
+            // routing per sync and one batch per sync and read batch
+            const std::vector<uint8_t> ad{ 0x05, 0xFF, 0x59, 0x00, 0x01, 0x02 };
+            for(int i=0; i<3; i++) {
+                const std::vector<uint8_t> r = report(0x0010, 0x00, ad);
+                t.processReport(r.data(), static_cast<int>(r.size()), 100+i);
+            }
+            const std::vector<uint8_t> r2 = report(0x0020, 0x00, ad);
+            t.processReport(r2.data(), static_cast<int>(r2.size()), 200);
+            const std::vector<uint8_t> r3 = report(0x0030, 0x00, ad); // unknown sync
+            t.processReport(r3.data(), static_cast<int>(r3.size()), 300);
+            CHECK( l1->batches, 0 );
+            t.flush();
+            CHECK( l1->batches, 1 );
+            CHECK( l1->reports, 3 );
+            CHECK( l2->batches, 1 );
+            CHECK( l2->reports, 1 );
+            t.flush();
+            CHECK( l1->batches, 1 );
+
+            const std::shared_ptr<EInfoReport> eir = l1->last[2];
+            CHECK( eir->getTimestamp(), 102 );
+            CHECK( eir->getRSSI(), -60 );
+            CHECK( eir->getAddress().b[0], 0x10 );
+            CHECKT( nullptr != eir->getManufactureSpecificData() );
+            CHECK( eir->getManufactureSpecificData()->company, 0x0059 );
+        }
+        {
+            // fragment reassembly, the held back fragment is delivered once complete
+            const std::vector<uint8_t> f0{ 0x07, 0xFF, 0x59, 0x00 };
+            const std::vector<uint8_t> f1{ 0x01, 0x02, 0x03, 0x04 };
+            const std::vector<uint8_t> r0 = report(0x0020, 0x01, f0);
+            const std::vector<uint8_t> r1 = report(0x0020, 0x00, f1);
+            t.processReport(r0.data(), static_cast<int>(r0.size()), 400);
+            t.flush();
+            CHECK( l2->reports, 1 );
+            t.processReport(r1.data(), static_cast<int>(r1.size()), 401);
+            t.flush();
+            CHECK( l2->reports, 2 );
+            CHECK( l2->last[0]->getManufactureSpecificData()->data.getSize(), 4 );
+            CHECK( l2->last[0]->getManufactureSpecificData()->data.get_uint8(3), 0x04 );
+
+            // truncated fragments are capped at the table's fragment capacity
+            const std::vector<uint8_t> big(40, 0x00);
+            const std::vector<uint8_t> r2 = report(0x0020, 0x01, big);
+            const std::vector<uint8_t> r3 = report(0x0020, 0x02, big);
+            t.processReport(r2.data(), static_cast<int>(r2.size()), 402);
+            t.processReport(r3.data(), static_cast<int>(r3.size()), 403);
+            t.flush();
+            CHECK( l2->reports, 3 );
+
+            // incomplete event
+            t.processReport(r1.data(), 8, 404);
+            t.flush();
+            CHECK( l2->reports, 3 );
+        }
+        {
+            // sync lost delivers pending reports first, removal stops routing
+            const std::vector<uint8_t> ad{ 0x02, 0x01, 0x06 };
+            const std::vector<uint8_t> r = report(0x0010, 0x00, ad);
+            t.processReport(r.data(), static_cast<int>(r.size()), 500);
+            const std::vector<uint8_t> lost{ 0x10, 0x00 };
+            t.processSyncLost(lost.data(), static_cast<int>(lost.size()));
+            CHECK( l1->batches, 2 );
+            CHECK( l1->lost, 1 );
+            CHECK( t.size(), 1 );
+            t.flush();
+            CHECK( l1->batches, 2 );
+
+            CHECKT( t.remove(0x0020) );
+            CHECKT( !t.remove(0x0020) );
+            const std::vector<uint8_t> r2 = report(0x0020, 0x00, ad);
+            t.processReport(r2.data(), static_cast<int>(r2.size()), 501);
+            t.flush();
+            CHECK( l2->reports, 3 );
+            CHECK( t.size(), 0 );
+        }
+        {
+            // dozens of concurrent syncs
+            std::shared_ptr<TestListener> l = std::make_shared<TestListener>();
+            for(int i=0; i<48; i++) {
+                CHECKT( HCIStatusCode::SUCCESS == create(t, l, static_cast<uint16_t>(0x100+i), static_cast<uint8_t>(i & 0x0F), h) );
+            }
+            CHECK( t.size(), 48 );
+            const std::vector<uint8_t> ad{ 0x02, 0x01, 0x06 };
+            for(int i=0; i<48; i++) {
+                const std::vector<uint8_t> r = report(static_cast<uint16_t>(0x100+i), 0x00, ad);
+                t.processReport(r.data(), static_cast<int>(r.size()), 600);
+            }
+            t.flush();
+            CHECK( l->batches, 48 );
+            CHECK( l->reports, 48 );
+            t.clear();
+            CHECK( t.size(), 0 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
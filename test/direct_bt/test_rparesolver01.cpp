@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/RPAResolver.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            // FIPS-197 Appendix C.1
+            const uint8_t key[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+            const uint8_t plain[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+            const uint8_t cipher[] = { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a };
+            uint8_t out[AES128::BLOCK_SIZE];
+            AES128 aes(key);
+            aes.encrypt(plain, out);
+            CHECKT( 0 == memcmp(cipher, out, sizeof(out)) );
+        }
+        // BT Core Spec v5.2: Vol 3, Part H SMP: D.7 ah Random Address Hash Function, IRK least significant octet first
+        const uint8_t irk[] = { 0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34, 0x05, 0xad, 0xc8, 0x57, 0xa3, 0x34, 0x02, 0xec };
+        CHECK(RPAResolver::ah(RPAResolver::createCipher(irk), 0x708194), 0x0dfbaa);
+
+        const uint8_t rpaBytes[] = { 0xaa, 0xfb, 0x0d, 0x94, 0x81, 0x70 }; // 70:81:94:0D:FB:AA
+        const EUI48 rpa(rpaBytes);
+        const uint8_t rpa2Bytes[] = { 0xab, 0xfb, 0x0d, 0x94, 0x81, 0x70 }; // hash mismatch
+        const EUI48 rpa2(rpa2Bytes);
+        const uint8_t identityBytes[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+        CHECKT( RPAResolver::isResolvablePrivateAddress(rpa, BDAddressType::BDADDR_LE_RANDOM) );
+        CHECKT( !RPAResolver::isResolvablePrivateAddress(rpa, BDAddressType::BDADDR_LE_PUBLIC) );
+
+        RPAResolver resolver;
+        BDAddressKey identity(EUI48_ANY_DEVICE, BDAddressType::BDADDR_UNDEFINED);
+        CHECKT( !resolver.resolve(rpa, BDAddressType::BDADDR_LE_RANDOM, identity) );
+
+        MgmtIdentityResolvingKeyInfo key;
+        key.address = EUI48(identityBytes);
+        key.address_type = BDAddressType::BDADDR_LE_PUBLIC;
+        memcpy(key.irk, irk, sizeof(irk));
+        resolver.add(key);
+        CHECK(resolver.size(), 1);
+
+        EUI48 last;
+        CHECKT( !resolver.getPrivateAddress(key.address, BDAddressType::BDADDR_LE_PUBLIC, last) );
+        CHECKT( !resolver.resolve(rpa2, BDAddressType::BDADDR_LE_RANDOM, identity) );
+        CHECKT( resolver.resolve(rpa, BDAddressType::BDADDR_LE_RANDOM, identity) );
+        CHECKT( key.address == identity.address );
+        CHECKT( BDAddressType::BDADDR_LE_PUBLIC == identity.addressType );
+        CHECKT( resolver.resolve(rpa, BDAddressType::BDADDR_LE_RANDOM, identity) ); // cached
+        CHECKT( resolver.getPrivateAddress(key.address, BDAddressType::BDADDR_LE_PUBLIC, last) );
+        CHECKT( rpa == last );
+
+        CHECKT( resolver.remove(key.address, BDAddressType::BDADDR_LE_PUBLIC) );
+        CHECKT( !resolver.resolve(rpa, BDAddressType::BDADDR_LE_RANDOM, identity) );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
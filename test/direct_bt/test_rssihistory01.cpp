@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/DBTTypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        {
+            RSSIHistory h;
+            CHECKT( h.isEmpty() );
+            CHECK( h.getSmoothed(), RSSIHistory::RSSI_NONE );
+            h.add(1, RSSIHistory::RSSI_NONE);
+            CHECKT( h.isEmpty() );
+            h.add(1, -40);
+            h.add(2, -60);
+            CHECK( h.size(), 2 );
+            CHECK( h.getLast(), -60 );
+            CHECK( h.getSmoothed(), -60 ); // weight 100%: no smoothing
+        }
+        {
+            RSSIHistory h(50);
+            h.add(1, -40);
+            CHECK( h.getSmoothed(), -40 );
+            h.add(2, -60);
+            CHECK( h.getSmoothed(), -50 );
+            h.add(3, -60);
+            CHECK( h.getSmoothed(), -55 );
+        }
+        {
+            RSSIHistory h(25);
+            for(int i=0; i<RSSIHistory::CAPACITY+4; ++i) {
+                h.add(i, static_cast<int8_t>(-30-i));
+            }
+            CHECK( h.size(), RSSIHistory::CAPACITY );
+            CHECK( h.get(0).timestamp, 4 );
+            CHECK( h.get(0).rssi, -34 );
+            CHECK( h.getLast(), -30-RSSIHistory::CAPACITY-3 );
+            const std::vector<RSSIHistory::Sample> v = h.toVector();
+            CHECK( v.size(), RSSIHistory::CAPACITY );
+            CHECK( v[RSSIHistory::CAPACITY-1].timestamp, RSSIHistory::CAPACITY+3 );
+            CHECKT( h.getSmoothed() > h.getLast() ); // lagging behind the falling RSSI
+            h.clear();
+            CHECKT( h.isEmpty() );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
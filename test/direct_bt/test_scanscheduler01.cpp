@@ -0,0 +1,62 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/ScanScheduler.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const ScanParameter req(true /* active */, 48, 48);
+        {
+            // defaults: unchanged request
+            ScanScheduler s(100, 10, 0, false, false);
+            CHECKT( !s.isAdaptive() );
+            CHECKT( s.adapt(req, 0) == req );
+            CHECKT( s.adapt(req, 3) == req );
+            CHECK( req.getDutyCycle(), 100 );
+        }
+        {
+            // power budget
+            ScanScheduler s(50, 10, 0, false, false);
+            const ScanParameter p = s.adapt(req, 0);
+            CHECK( p.interval, 48 );
+            CHECK( p.window, 24 );
+            CHECKT( p.active );
+        }
+        {
+            // per connection reduction down to the minimum, passive when connected
+            ScanScheduler s(100, 20, 30, true, true);
+            CHECKT( s.isAdaptive() );
+            CHECK( s.getDutyCycle(0), 100 );
+            CHECK( s.getDutyCycle(1), 70 );
+            CHECK( s.getDutyCycle(2), 40 );
+            CHECK( s.getDutyCycle(5), 20 );
+            CHECKT( s.adapt(req, 0) == req );
+            const ScanParameter p = s.adapt(req, 2);
+            CHECK( p.window, 19 );
+            CHECKT( !p.active );
+        }
+        {
+            // requested window is never exceeded, window clamped to the minimum value
+            ScanScheduler s(100, 1, 50, false, false);
+            const ScanParameter r(false, 400, 40);
+            CHECK( s.adapt(r, 1).window, 40 );
+            const ScanParameter small(false, 8, 8);
+            CHECK( s.adapt(small, 2).window, ScanParameter::MIN_VALUE );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
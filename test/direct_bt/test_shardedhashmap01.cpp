@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+
+#include <cppunit.h>
+
+#include <direct_bt/BTAddress.hpp>
+#include <direct_bt/ShardedHashMap.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        const EUI48 addr0( "01:02:03:04:05:06" );
+        const EUI48 addr1( "01:02:03:04:05:07" );
+        CHECKT( std::hash<EUI48>()(addr0) != std::hash<EUI48>()(addr1) );
+        CHECKT( BDAddressKey(addr0, BDADDR_LE_PUBLIC) != BDAddressKey(addr0, BDADDR_LE_RANDOM) );
+        CHECKT( std::hash<BDAddressKey>()(BDAddressKey(addr0, BDADDR_LE_PUBLIC)) ==
+                std::hash<BDAddressKey>()(BDAddressKey(EUI48("01:02:03:04:05:06"), BDADDR_LE_PUBLIC)) );
+
+        ShardedHashMap<BDAddressKey, std::shared_ptr<int>> map;
+        const std::shared_ptr<int> v0(new int(0));
+        CHECKT( map.put(BDAddressKey(addr0, BDADDR_LE_PUBLIC), v0) );
+        CHECKT( !map.put(BDAddressKey(addr0, BDADDR_LE_PUBLIC), std::shared_ptr<int>(new int(1))) );
+        CHECKT( v0 == map.get(BDAddressKey(addr0, BDADDR_LE_PUBLIC)) );
+        CHECKT( nullptr == map.get(BDAddressKey(addr0, BDADDR_LE_RANDOM)) );
+        CHECKT( nullptr == map.get(BDAddressKey(addr1, BDADDR_LE_PUBLIC)) );
+
+        // concurrent mutations and lookups of distinct keys
+        const int count = 1000;
+        std::thread writer([&]() {
+            for(int i=0; i<count; i++) {
+                uint8_t b[6] = { static_cast<uint8_t>(i & 0xff), static_cast<uint8_t>( i >> 8 ), 0, 0, 0, 0x10 };
+                map.put(BDAddressKey(EUI48(b), BDADDR_LE_RANDOM), std::shared_ptr<int>(new int(i)));
+            }
+        });
+        for(int i=0; i<count; i++) {
+            CHECKT( v0 == map.get(BDAddressKey(addr0, BDADDR_LE_PUBLIC)) );
+        }
+        writer.join();
+        CHECK( map.size(), count + 1 );
+        uint8_t b[6] = { 42, 0, 0, 0, 0, 0x10 };
+        CHECK( *map.get(BDAddressKey(EUI48(b), BDADDR_LE_RANDOM)), 42 );
+        CHECKT( map.remove(BDAddressKey(EUI48(b), BDADDR_LE_RANDOM)) );
+        CHECKT( !map.remove(BDAddressKey(EUI48(b), BDADDR_LE_RANDOM)) );
+        map.clear();
+        CHECK( map.size(), 0 );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
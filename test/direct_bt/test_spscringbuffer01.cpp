@@ -0,0 +1,116 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <cppunit.h>
+
+#include <direct_bt/BasicTypes.hpp>
+#include <direct_bt/Ringbuffer.hpp>
+#include <direct_bt/SPSCRingbuffer.hpp>
+
+using namespace direct_bt;
+
+typedef std::shared_ptr<int> SharedType;
+typedef SPSCRingbuffer<SharedType, nullptr> SharedTypeRingbuffer;
+
+// Test examples.
+class Cppunit_tests : public Cppunit {
+  private:
+
+    void getThreadType01(SharedTypeRingbuffer * rb, int len, int * errors) {
+        for(int i=0; i<len; i++) {
+            SharedType v = rb->getBlocking();
+            if( nullptr == v || i != *v ) {
+                (*errors)++;
+            }
+        }
+    }
+
+    void putThreadType01(SharedTypeRingbuffer * rb, int len) {
+        for(int i=0; i<len; i++) {
+            rb->putBlocking( SharedType( new int(i) ) );
+        }
+    }
+
+  public:
+
+    void test01_EmptyFull() {
+        fprintf(stderr, "\n\ntest01_EmptyFull\n");
+        SharedTypeRingbuffer rb(4);
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+        CHECKTM("Not null "+rb.toString(), nullptr == rb.get());
+        for(int i=0; i<4; i++) {
+            CHECKTM("Put failed "+rb.toString(), rb.put( SharedType( new int(i) ) ));
+        }
+        CHECKTM("Not full "+rb.toString(), rb.isFull());
+        CHECKM("Wrong size "+rb.toString(), 4, rb.getSize());
+        CHECKTM("Put on full "+rb.toString(), !rb.put( SharedType( new int(4) ) ));
+        CHECKTM("Put on full "+rb.toString(), !rb.putBlocking( SharedType( new int(4) ), 10 ));
+        CHECKM("Wrong peek "+rb.toString(), 0, *rb.peek());
+        CHECKM("Wrong drop "+rb.toString(), 2, rb.drop(2));
+        CHECKM("Wrong value "+rb.toString(), 2, *rb.get());
+        CHECKM("Wrong free slots "+rb.toString(), 3, rb.getFreeSlots());
+        SharedType batch[4] = { SharedType( new int(3) ), SharedType( new int(4) ), SharedType( new int(5) ), SharedType( new int(6) ) };
+        CHECKM("Wrong batch put "+rb.toString(), 3, rb.putAll(batch, 4));
+        CHECKTM("Not full "+rb.toString(), rb.isFull());
+        CHECKM("Wrong batch get "+rb.toString(), 4, rb.getAll(batch, 4));
+        CHECKM("Wrong batch value "+rb.toString(), 3, *batch[0]);
+        CHECKM("Wrong batch value "+rb.toString(), 5, *batch[3]);
+        rb.clear();
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+
+        const uint64_t t0 = getCurrentMilliseconds();
+        CHECKTM("Not null "+rb.toString(), nullptr == rb.getBlocking(20));
+        CHECKTM("Timeout too short", getCurrentMilliseconds() - t0 >= 20);
+    }
+
+    void test02_Recapacity() {
+        fprintf(stderr, "\n\ntest02_Recapacity\n");
+        SharedTypeRingbuffer rb(2);
+        rb.get(); // move positions
+        rb.put( SharedType( new int(0) ) );
+        rb.put( SharedType( new int(1) ) );
+        rb.recapacity(8);
+        CHECKM("Wrong capacity "+rb.toString(), 8, rb.capacity());
+        CHECKM("Wrong size "+rb.toString(), 2, rb.getSize());
+        CHECKM("Wrong value "+rb.toString(), 0, *rb.get());
+        CHECKM("Wrong value "+rb.toString(), 1, *rb.get());
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+
+        SPSCRingbuffer<std::unique_ptr<int>, nullptr> ru(2);
+        CHECKTM("Put failed "+ru.toString(), ru.put( std::unique_ptr<int>( new int(1) ) ));
+        CHECKM("Wrong moved value "+ru.toString(), 1, *ru.get());
+    }
+
+    void test03_Read1Write1() {
+        fprintf(stderr, "\n\ntest03_Read1Write1\n");
+        const int count = 100000;
+        SharedTypeRingbuffer rb(16);
+        int errors = 0;
+        std::thread getThread01(&Cppunit_tests::getThreadType01, this, &rb, count, &errors);
+        std::thread putThread01(&Cppunit_tests::putThreadType01, this, &rb, count);
+        putThread01.join();
+        getThread01.join();
+
+        CHECKM("Wrong order or missing elements", 0, errors);
+        CHECKTM("Not empty "+rb.toString(), rb.isEmpty());
+        CHECKM("Not empty size "+rb.toString(), 0, rb.getSize());
+    }
+
+    void test_list() override {
+        test01_EmptyFull();
+        test02_Recapacity();
+        test03_Read1Write1();
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <cppunit.h>
+
+#include <direct_bt/TimerWheel.hpp>
+#include <direct_bt/BasicTypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+  public:
+    void single_test() override {
+        // One-shot timer, not expiring before its delay
+        {
+            TimerWheel wheel(5);
+            std::atomic<uint64_t> fired(0);
+            const uint64_t t0 = getCurrentMilliseconds();
+            const TimerWheel::TimerID id = wheel.schedule(50, [&]() -> uint32_t {
+                fired = getCurrentMilliseconds();
+                return 0;
+            });
+            CHECKT( 0 != id );
+            CHECKT( wheel.isScheduled(id) );
+            CHECK( wheel.size(), 1 );
+            while( 0 == fired && getCurrentMilliseconds() - t0 < 5000 ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            CHECKT( fired >= t0 + 50 );
+            CHECKT( fired < t0 + 2000 );
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK( wheel.size(), 0 );
+            CHECKT( !wheel.isScheduled(id) );
+            CHECKT( !wheel.cancel(id) );
+
+            // Idle wheel never wakes up
+            const uint64_t wakeups = wheel.getWakeupCount();
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            CHECK( wheel.getWakeupCount(), wakeups );
+        }
+
+        // Cancelled timer never expires, its identifier is not reused
+        {
+            TimerWheel wheel(5);
+            std::atomic<int> fired(0);
+            const TimerWheel::TimerID id = wheel.schedule(30, [&]() -> uint32_t { fired++; return 0; });
+            CHECKT( wheel.cancel(id) );
+            CHECKT( !wheel.cancel(id) );
+            const TimerWheel::TimerID id2 = wheel.schedule(10000, [&]() -> uint32_t { fired++; return 0; });
+            CHECKT( id != id2 );
+            CHECKT( !wheel.isScheduled(id) );
+            CHECKT( wheel.isScheduled(id2) );
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            CHECK( fired, 0 );
+            CHECKT( wheel.cancel(id2) );
+            CHECK( wheel.size(), 0 );
+        }
+
+        // Periodic timer w/ adaptive period, ended by returning zero
+        {
+            TimerWheel wheel(1);
+            std::atomic<int> runs(0);
+            const uint64_t t0 = getCurrentMilliseconds();
+            wheel.schedule(10, [&]() -> uint32_t {
+                const int n = ++runs;
+                return n < 5 ? 10 * n : 0;
+            });
+            while( wheel.size() > 0 && getCurrentMilliseconds() - t0 < 5000 ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            CHECK( runs, 5 );
+            CHECKT( getCurrentMilliseconds() - t0 >= 10 + 10 + 20 + 30 + 40 );
+            CHECK( wheel.getExpiredCount(), 5 );
+        }
+
+        // Many timers across all cascading levels expire in order and not early
+        {
+            TimerWheel wheel(1);
+            const int count = 300;
+            std::vector<uint64_t> deadline(count, 0);
+            std::vector<uint64_t> fired(count, 0);
+            std::atomic<int> done(0);
+            const uint64_t t0 = getCurrentMilliseconds();
+            for(int i=0; i<count; i++) {
+                const uint32_t delay = ( i * 7919 ) % 4500; // up to level 2
+                deadline[i] = t0 + delay;
+                wheel.schedule(delay, [&, i]() -> uint32_t {
+                    fired[i] = getCurrentMilliseconds();
+                    done++;
+                    return 0;
+                });
+            }
+            // Beyond the wheels' span
+            const TimerWheel::TimerID far = wheel.schedule(UINT32_MAX, []() -> uint32_t { return 0; });
+            CHECK( wheel.size(), count + 1 );
+            while( done < count && getCurrentMilliseconds() - t0 < 15000 ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            CHECK( done, count );
+            int late = 0;
+            for(int i=0; i<count; i++) {
+                CHECKT( fired[i] >= deadline[i] );
+                if( fired[i] > deadline[i] + 200 ) {
+                    late++;
+                }
+            }
+            CHECK( late, 0 );
+            CHECKT( wheel.isScheduled(far) );
+            // Sleeping until due slots, not once per tick
+            CHECKT( wheel.getWakeupCount() < 4500 );
+            CHECKT( wheel.cancel(far) );
+        }
+
+        // Cancel waits for the running callback and prevents its rescheduling
+        {
+            TimerWheel wheel(1);
+            std::atomic<int> runs(0);
+            std::atomic<bool> inside(false);
+            const TimerWheel::TimerID id = wheel.schedule(1, [&]() -> uint32_t {
+                inside = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                runs++;
+                inside = false;
+                return 1;
+            });
+            while( !inside ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            CHECKT( wheel.cancel(id, true /* wait */) );
+            CHECKT( !inside );
+            CHECK( runs, 1 );
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            CHECK( runs, 1 );
+            CHECK( wheel.size(), 0 );
+        }
+
+        // Callbacks may schedule and cancel timers, stop drops all
+        {
+            TimerWheel wheel(1);
+            std::atomic<int> runs(0);
+            wheel.schedule(5, [&]() -> uint32_t {
+                wheel.schedule(5, [&]() -> uint32_t { runs++; return 0; });
+                runs++;
+                return 0;
+            });
+            const uint64_t t0 = getCurrentMilliseconds();
+            while( runs < 2 && getCurrentMilliseconds() - t0 < 5000 ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            CHECK( runs, 2 );
+            wheel.schedule(10000, []() -> uint32_t { return 0; });
+            wheel.stop();
+            CHECK( wheel.size(), 0 );
+            CHECK( wheel.schedule(1, []() -> uint32_t { return 0; }), 0 );
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
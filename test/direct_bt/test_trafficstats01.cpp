@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cassert>
+#include <cinttypes>
+#include <cstring>
+
+#include <cppunit.h>
+
+#include <direct_bt/TrafficStats.hpp>
+#include <direct_bt/ATTPDUTypes.hpp>
+
+using namespace direct_bt;
+
+// Test examples.
+class Cppunit_tests: public Cppunit {
+    void single_test() override {
+        TrafficStats stats;
+        stats.countOut(AttPDUMsg::Opcode::ATT_READ_REQ, 3);
+        stats.countIn(AttPDUMsg::Opcode::ATT_READ_RSP, 21);
+        stats.countOut(AttPDUMsg::Opcode::ATT_WRITE_CMD, 23);
+        stats.countOut(AttPDUMsg::Opcode::ATT_WRITE_CMD, 23);
+        stats.countIn(AttPDUMsg::Opcode::ATT_HANDLE_VALUE_NTF, 10);
+        stats.countIn(AttPDUMsg::Opcode::ATT_HANDLE_VALUE_IND, 10);
+        stats.countRetry();
+        stats.countTimeout();
+        stats.addRTT(1000);
+        stats.addRTT(3000);
+
+        TrafficSnapshot ts = stats.getSnapshot();
+        CHECK( ts.pdusIn, 3 );
+        CHECK( ts.bytesIn, 41 );
+        CHECK( ts.pdusOut, 3 );
+        CHECK( ts.bytesOut, 49 );
+        CHECK( ts.notifications, 2 );
+        CHECK( ts.retries, 1 );
+        CHECK( ts.timeouts, 1 );
+        CHECK( ts.getAverageRTT(), 2000 );
+        CHECK( ts.opcodes.size(), 5 );
+        // ordered by opcode: READ_REQ 0x0A, READ_RSP 0x0B, NTF 0x1B, IND 0x1D, WRITE_CMD 0x52
+        CHECK( ts.opcodes[0].opcode, AttPDUMsg::Opcode::ATT_READ_REQ );
+        CHECK( ts.opcodes[0].pdusOut, 1 );
+        CHECK( ts.opcodes[1].bytesIn, 21 );
+        CHECK( ts.opcodes[4].opcode, AttPDUMsg::Opcode::ATT_WRITE_CMD );
+        CHECK( ts.opcodes[4].pdusOut, 2 );
+        CHECK( ts.opcodes[4].bytesOut, 46 );
+        CHECK( ts.opcodes[4].pdusIn, 0 );
+        CHECKT( ts.toString().size() > 0 );
+
+        TrafficSnapshot ts2 = ts;
+        ts2.timestamp += 500;
+        ts2.notifications += 10;
+        CHECKT( 20.0 == ts2.getNotificationRate(ts) );
+        CHECKT( 0.0 == ts.getNotificationRate(ts2) );
+
+        stats.reset();
+        ts = stats.getSnapshot();
+        CHECK( ts.pdusIn, 0 );
+        CHECK( ts.bytesOut, 0 );
+        CHECK( ts.getAverageRTT(), 0 );
+        CHECK( ts.opcodes.size(), 0 );
+    }
+};
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Cppunit_tests test1;
+    return test1.run();
+}
@@ -60,6 +60,63 @@ class Cppunit_tests : public Cppunit {
             CHECKT( 0 == memcmp(v01.data(), v02->data(), 2) )
             CHECKT( v01.toString() == v02->toString() );
         }
+
+        {
+            const uuid_value_t v16(uuid16_t(0x1234));
+            const uuid_value_t v32(uuid32_t(0x1234));
+            const uuid_value_t v128(uuid128_t(uuid128_bytes, 0, true));
+            CHECK(v16.getTypeSize(), 2);
+            CHECKT( v16 != v32 );
+            CHECKT( v16 == uuid_value_t(uuid_t::TypeSize::UUID16_SZ, reinterpret_cast<const uint8_t*>("\x34\x12"), 0) );
+            CHECKT( v16.hash() == std::hash<uuid_value_t>()(uuid_value_t(uuid16_t(0x1234))) );
+            CHECKT( v16.toString() == uuid16_t(0x1234).toString() );
+            CHECKT( v128.toString() == uuid128_t(uuid128_bytes, 0, true).toString() );
+            CHECKT( *v128.toUUID() == uuid128_t(uuid128_bytes, 0, true) );
+            CHECKT( 0 == memcmp(uuid128_bytes, v128.data(), 16) );
+
+            constexpr uuid_value_t zero;
+            static_assert( zero == uuid_value_t(), "constexpr comparison" );
+            static_assert( std::is_trivially_copyable<uuid_value_t>::value, "trivially copyable" );
+        }
+
+        {
+            CHECKT( *uuid_t::create("180d") == uuid16_t(0x180d) );
+            CHECKT( *uuid_t::create("12345678") == uuid32_t(0x12345678) );
+            CHECKT( *uuid_t::create("00000000-0000-1000-8000-00805F9B34FB") == BT_BASE_UUID );
+            bool thrown = false;
+            try {
+                uuid_t::create("18g0");
+            } catch (IllegalArgumentException &e) {
+                thrown = true;
+            }
+            CHECKT( thrown );
+        }
+
+        {
+            // string format and parsing
+            CHECKT( uuid16_t(0x1a2b).toString() == "1a2b" );
+            CHECKT( uuid32_t(0x12ab34cd).toString() == "12ab34cd" );
+            CHECKT( BT_BASE_UUID.toString() == "00000000-0000-1000-8000-00805f9b34fb" );
+            CHECKT( uuid16_t(0x1234).toUUID128String() == "00001234-0000-1000-8000-00805f9b34fb" );
+
+            const uuid128_t v01("00001234-0000-1000-8000-00805F9B34FB");
+            CHECKT( v01 == uuid128_t(uuid16_t(0x1234)) );
+            CHECKT( uuid128_t(v01.toString()) == v01 );
+            bool thrown = false;
+            try {
+                uuid128_t v02("00001234-0000-1000-8000+00805F9B34FB");
+                (void)v02;
+            } catch (IllegalArgumentException &e) {
+                thrown = true;
+            }
+            CHECKT( thrown );
+
+            uuid_string_cache cache;
+            const std::string & s0 = cache.get(v01, false);
+            CHECKT( s0 == v01.toString() );
+            CHECKT( &s0 == &cache.get(v01, false) );
+            CHECKT( cache.get(uuid16_t(0x1234), true) == v01.toString() );
+        }
     }
 };
 
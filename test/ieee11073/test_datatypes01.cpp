@@ -2,6 +2,8 @@
 #include <cassert>
 #include <cinttypes>
 #include <cstring>
+#include <cmath>
+#include <vector>
 
 #include <cppunit.h>
 
@@ -19,6 +21,37 @@ class Cppunit_tests : public Cppunit {
         CHECKD(msg, has, expFloat);
     }
 
+    static bool equal_float(const float a, const float b) {
+        return ( std::isnan(a) && std::isnan(b) ) || a == b;
+    }
+
+    void test_float16_IEEE11073_to_IEEE754(const std::string msg, const uint16_t raw, const float expFloat) {
+        const float has = FloatTypes::float16_IEEE11073_to_IEEE754(raw);
+        PRINTM(msg+": has '"+std::to_string(has)+"', exp '"+std::to_string(expFloat)+"'");
+        CHECKTM(msg, equal_float(has, expFloat));
+    }
+
+    void test_float16_batch(const std::string msg, const uint8_t * data_le, const size_t count) {
+        std::vector<float> has(count);
+        FloatTypes::float16_IEEE11073_to_IEEE754(data_le, has.data(), count);
+        for(size_t i=0; i<count; i++) {
+            const uint16_t raw = static_cast<uint16_t>( data_le[2*i] | ( data_le[2*i+1] << 8 ) );
+            const float exp = FloatTypes::float16_IEEE11073_to_IEEE754(raw);
+            CHECKTM(msg+"["+std::to_string(i)+"]: has "+std::to_string(has[i])+", exp "+std::to_string(exp), equal_float(has[i], exp));
+        }
+    }
+
+    void test_float32_batch(const std::string msg, const uint8_t * data_le, const size_t count) {
+        std::vector<float> has(count);
+        FloatTypes::float32_IEEE11073_to_IEEE754(data_le, has.data(), count);
+        for(size_t i=0; i<count; i++) {
+            const uint32_t raw = static_cast<uint32_t>(data_le[4*i]) | ( static_cast<uint32_t>(data_le[4*i+1]) << 8 ) |
+                                 ( static_cast<uint32_t>(data_le[4*i+2]) << 16 ) | ( static_cast<uint32_t>(data_le[4*i+3]) << 24 );
+            const float exp = FloatTypes::float32_IEEE11073_to_IEEE754(raw);
+            CHECKTM(msg+"["+std::to_string(i)+"]: has "+std::to_string(has[i])+", exp "+std::to_string(exp), equal_float(has[i], exp));
+        }
+    }
+
     void test_AbsoluteTime_IEEE11073(const std::string msg, const uint8_t * data_le, const int size, const std::string expStr) {
         ieee11073::AbsoluteTime has(data_le, size);
         const std::string has_str = has.toString();
@@ -42,6 +75,45 @@ class Cppunit_tests : public Cppunit {
             // 640100FF -> 35.600002
             test_float32_IEEE11073_to_IEEE754("IEEE11073-float02", 0xFF000164, 35.600002f);
 
+            // 72 F0 -> 11.4f, FF FF -> -0.1f, 9C 0F -> -100.0f
+            test_float16_IEEE11073_to_IEEE754("IEEE11073-sfloat01", 0xF072, 114 * powf(10.0f, -1));
+            test_float16_IEEE11073_to_IEEE754("IEEE11073-sfloat02", 0xFFFF, -1 * powf(10.0f, -1));
+            test_float16_IEEE11073_to_IEEE754("IEEE11073-sfloat03", 0x0F9C, -100.0f);
+            test_float16_IEEE11073_to_IEEE754("IEEE11073-sfloat04", 0x07FE, INFINITY);
+            test_float16_IEEE11073_to_IEEE754("IEEE11073-sfloat05", 0x07FF, NAN);
+            test_float16_IEEE11073_to_IEEE754("IEEE11073-sfloat06", 0x0802, -INFINITY);
+
+            {
+                // 11 values: two full quadruples plus tail, reserved values mixed in
+                const uint8_t input[] = { 0x72, 0xF0, 0xFF, 0xFF, 0x9C, 0x0F, 0xFE, 0x07,
+                                          0xFF, 0x07, 0x00, 0x08, 0x01, 0x08, 0x02, 0x08,
+                                          0xFF, 0x7F, 0x01, 0x80, 0x55, 0xA5 };
+                for(size_t count=0; count<=11; count++) {
+                    test_float16_batch("IEEE11073-sfloat batch"+std::to_string(count), input, count);
+                }
+                float has[11];
+                FloatTypes::float16_IEEE11073_to_IEEE754(input, has, 11);
+                CHECKTM("IEEE11073-sfloat batch -0.1f", equal_float(has[1], -1 * powf(10.0f, -1)));
+                CHECKTM("IEEE11073-sfloat batch +inf", equal_float(has[3], INFINITY));
+                CHECKTM("IEEE11073-sfloat batch -inf", equal_float(has[7], -INFINITY));
+            }
+            {
+                // 9 values: two full quadruples plus tail, reserved and negative values mixed in
+                const uint8_t input[] = { 0x79, 0x09, 0x00, 0xFE, 0x67, 0x01, 0x00, 0xFF,
+                                          0xFE, 0xFF, 0x7F, 0x00, 0xFF, 0xFF, 0x7F, 0x00,
+                                          0x02, 0x00, 0x80, 0x00, 0xFF, 0xFF, 0xFF, 0xFD,
+                                          0x00, 0x00, 0x80, 0x7F, 0x01, 0x00, 0x80, 0x81,
+                                          0x64, 0x01, 0x00, 0xFF };
+                for(size_t count=0; count<=9; count++) {
+                    test_float32_batch("IEEE11073-float batch"+std::to_string(count), input, count);
+                }
+                float has[9];
+                FloatTypes::float32_IEEE11073_to_IEEE754(input, has, 9);
+                CHECKD("IEEE11073-float batch 24.25f", has[0], 24.25f);
+                CHECKTM("IEEE11073-float batch +inf", equal_float(has[2], INFINITY));
+                CHECKTM("IEEE11073-float batch -inf", equal_float(has[4], -INFINITY));
+                CHECKD("IEEE11073-float batch -0.001f", has[5], -1 * powf(10.0f, -3));
+            }
             {
                 // E40704040B1A00 -> 2020-04-04 11:26:00
                 const uint8_t input[] = { 0xE4, 0x07, 0x04, 0x04, 0x0B, 0x1A, 0x00 };